@@ -1843,6 +1843,18 @@ class Cursor(Structure):
             for descendant in child.walk_preorder():
                 yield descendant
 
+    def get_tree(self, include_usrs=False):
+        """Return a CursorTree with this cursor and all of its descendants.
+
+        The whole tree is built by a single call into libclang, which is much
+        faster than walk_preorder() on large trees.
+        """
+        options = 0x1 if include_usrs else 0x0
+        ptr = conf.lib.clang_getCursorTree(self, options)
+        if not ptr:
+            return None
+        return CursorTree(ptr, self._tu)
+
     def get_tokens(self):
         """Obtain Token instances formulating that compose this Cursor.
 
@@ -3118,6 +3130,83 @@ class File(ClangObject):
         res._tu = args[0]._tu
         return res
 
+class _CXCursorTreeNode(Structure):
+    """The layout of a node of a CursorTree."""
+    _fields_ = [("kind", c_int), ("parent", c_uint), ("file", c_uint),
+                ("begin_offset", c_uint), ("end_offset", c_uint),
+                ("begin_line", c_uint), ("begin_column", c_uint),
+                ("spelling", c_uint), ("usr", c_uint)]
+
+class CursorTree(ClangObject):
+    """
+    A cursor and all of its descendants, in preorder, as returned by
+    Cursor.get_tree().
+
+    Nodes are referred to by their index; node 0 is the root. Indexing the
+    tree gives the raw node, with the kind, parent, file, offsets, line and
+    column of its extent, and offsets into the string table; the methods below
+    decode them. Only cursor() builds a Cursor object.
+    """
+
+    def __init__(self, obj, tu):
+        ClangObject.__init__(self, obj)
+        self._tu = tu
+        self._nodes = conf.lib.clang_CursorTree_getNodes(self)
+        self._num_nodes = conf.lib.clang_CursorTree_getNumNodes(self)
+        size = c_uint()
+        strings = conf.lib.clang_CursorTree_getStrings(self, byref(size))
+        self._strings = string_at(strings, size.value)
+
+    def __del__(self):
+        conf.lib.clang_disposeCursorTree(self)
+
+    @property
+    def translation_unit(self):
+        """Returns the TranslationUnit to which this CursorTree belongs."""
+        return self._tu
+
+    def __len__(self):
+        return self._num_nodes
+
+    def __getitem__(self, index):
+        if index < 0 or index >= self._num_nodes:
+            raise IndexError
+        return self._nodes[index]
+
+    def _string(self, offset):
+        end = self._strings.index(b'\0', offset)
+        return c_interop_string(self._strings[offset:end]).value
+
+    def kind(self, index):
+        """Return the CursorKind of the given node."""
+        return CursorKind.from_id(self[index].kind)
+
+    def parent(self, index):
+        """Return the index of the parent of the given node, or None."""
+        parent = self[index].parent
+        return None if parent == 0xFFFFFFFF else parent
+
+    def spelling(self, index):
+        """Return the spelling of the given node."""
+        return self._string(self[index].spelling)
+
+    def usr(self, index):
+        """Return the USR of the given node, or an empty string if the tree
+        was built without USRs."""
+        return self._string(self[index].usr)
+
+    def file(self, index):
+        """Return the File that contains the start of the extent of the given
+        node, or None."""
+        file = self[index].file
+        if file == 0xFFFFFFFF:
+            return None
+        return conf.lib.clang_CursorTree_getFile(self, file)
+
+    def cursor(self, index):
+        """Return the Cursor of the given node."""
+        return conf.lib.clang_CursorTree_getCursor(self, index)
+
 class FileInclusion(object):
     """
     The FileInclusion class represents the inclusion of one source file by
@@ -3452,6 +3541,9 @@ functionList = [
   ("clang_disposeCodeCompleteResults",
    [CodeCompletionResults]),
 
+  ("clang_disposeCursorTree",
+   [CursorTree]),
+
 # ("clang_disposeCXTUResourceUsage",
 #  [CXTUResourceUsage]),
 
@@ -3614,6 +3706,10 @@ functionList = [
    Type,
    Type.from_result),
 
+  ("clang_getCursorTree",
+   [Cursor, c_uint],
+   c_object_p),
+
   ("clang_getCursorUSR",
    [Cursor],
    _CXString,
@@ -4009,6 +4105,28 @@ functionList = [
    [Cursor],
    c_longlong),
 
+  ("clang_CursorTree_getCursor",
+   [CursorTree, c_uint],
+   Cursor,
+   Cursor.from_result),
+
+  ("clang_CursorTree_getFile",
+   [CursorTree, c_uint],
+   c_object_p,
+   File.from_result),
+
+  ("clang_CursorTree_getNodes",
+   [CursorTree],
+   POINTER(_CXCursorTreeNode)),
+
+  ("clang_CursorTree_getNumNodes",
+   [CursorTree],
+   c_uint),
+
+  ("clang_CursorTree_getStrings",
+   [CursorTree, POINTER(c_uint)],
+   c_void_p),
+
   ("clang_Type_getAlignOf",
    [Type],
    c_longlong),
@@ -4199,6 +4317,7 @@ __all__ = [
     'CompileCommand',
     'CursorKind',
     'Cursor',
+    'CursorTree',
     'Diagnostic',
     'File',
     'FixIt',
@@ -554,6 +554,32 @@ class TestCursor(unittest.TestCase):
                 self.assertEqual(c.referenced.spelling, foo.spelling)
                 break
 
+    def test_get_tree(self):
+        tu = get_tu(kInput)
+        tree = tu.cursor.get_tree(include_usrs=True)
+        cursors = list(tu.cursor.walk_preorder())
+
+        self.assertEqual(len(tree), len(cursors))
+        for i, cursor in enumerate(cursors):
+            self.assertEqual(tree.kind(i), cursor.kind)
+            self.assertEqual(tree.spelling(i), cursor.spelling)
+            self.assertEqual(tree.usr(i), cursor.get_usr())
+            self.assertEqual(tree.cursor(i), cursor)
+
+        self.assertIsNone(tree.parent(0))
+        s0 = [i for i in range(len(tree)) if tree.spelling(i) == 's0'][0]
+        self.assertEqual(tree.parent(s0), 0)
+        self.assertEqual(tree.file(s0).name, 't.c')
+        self.assertEqual(tree[s0].begin_line, 1)
+        self.assertEqual(tree.kind(s0 + 1), CursorKind.FIELD_DECL)
+        self.assertEqual(tree.parent(s0 + 1), s0)
+
+    def test_get_tree_without_usrs(self):
+        tu = get_tu(kInput)
+        tree = tu.cursor.get_tree()
+        for i in range(len(tree)):
+            self.assertEqual(tree.usr(i), '')
+
     def test_mangled_name(self):
         kInputForMangling = """\
         int foo(int, int);
@@ -32,7 +32,7 @@
  * compatible, thus CINDEX_VERSION_MAJOR is expected to remain stable.
  */
 #define CINDEX_VERSION_MAJOR 0
-#define CINDEX_VERSION_MINOR 50
+#define CINDEX_VERSION_MINOR 57
 
 #define CINDEX_VERSION_ENCODE(major, minor) ( \
       ((major) * 10000)                       \
@@ -263,6 +263,12 @@ enum CXCursor_ExceptionSpecificationKind {
  * This process of creating the 'pch', loading it separately, and using it (via
  * -include-pch) allows 'excludeDeclsFromPCH' to remove redundant callbacks
  * (which gives the indexer the same performance benefit as the compiler).
+ *
+ * An index may be shared between threads. Translation units created from the
+ * same index may be created, reparsed, code-completed and disposed of
+ * concurrently, as long as each translation unit is only used by one thread at
+ * a time. The options of the index may be changed at any time; a change
+ * applies to the operations started after it.
  */
 CINDEX_LINKAGE CXIndex clang_createIndex(int excludeDeclarationsFromPCH,
                                          int displayDiagnostics);
@@ -305,7 +311,24 @@ typedef enum {
    */
   CXGlobalOpt_ThreadBackgroundPriorityForAll =
       CXGlobalOpt_ThreadBackgroundPriorityForIndexing |
-      CXGlobalOpt_ThreadBackgroundPriorityForEditing
+      CXGlobalOpt_ThreadBackgroundPriorityForEditing,
+
+  /**
+   * Used to indicate that the translation units created from the index should
+   * share one cache of the status and contents of the files they read, so that
+   * a header included by many translation units is only looked up and read
+   * once.
+   *
+   * The cache assumes that the files it has seen are not modified while the
+   * index exists; changes to them are not picked up by later parses or
+   * reparses. Unsaved files are not affected. This suits batch indexing of
+   * many translation units, possibly from several threads, rather than
+   * editing.
+   *
+   * Affects #clang_parseTranslationUnit and the reparses of the translation
+   * units it creates.
+   */
+  CXGlobalOpt_ShareFileSystemCache = 0x4
 
 } CXGlobalOptFlags;
 
@@ -1341,7 +1364,27 @@ enum CXTranslationUnit_Flags {
   /**
    * Used to indicate that implicit attributes should be visited.
    */
-  CXTranslationUnit_VisitImplicitAttributes = 0x2000
+  CXTranslationUnit_VisitImplicitAttributes = 0x2000,
+
+  /**
+   * Used to indicate that the detailed preprocessing record, if requested,
+   * should only contain macro definitions and inclusion directives, and not
+   * macro expansions.
+   *
+   * This makes the record of a large translation unit much smaller, for
+   * clients that do not need to visit macro expansions.
+   */
+  CXTranslationUnit_SkipMacroExpansionsInPreprocessingRecord = 0x4000,
+
+  /**
+   * Used to indicate that the translation unit should release the memory it
+   * only needs while parsing once each parse or reparse is done, as
+   * \c clang_compactTranslationUnit() does.
+   *
+   * This is meant for translation units that an IDE keeps open for a long
+   * time.
+   */
+  CXTranslationUnit_CompactAfterParse = 0x8000
 };
 
 /**
@@ -1609,6 +1652,94 @@ CINDEX_LINKAGE int clang_reparseTranslationUnit(CXTranslationUnit TU,
                                           struct CXUnsavedFile *unsaved_files,
                                                 unsigned options);
 
+/**
+ * A reparse of a translation unit that runs in the background, as started
+ * by \c clang_reparseTranslationUnitAsync().
+ */
+typedef struct CXReparseTaskImpl *CXReparseTask;
+
+/**
+ * Start reparsing the source files that produced this translation unit on
+ * a background thread.
+ *
+ * This behaves like \c clang_reparseTranslationUnit(), except that it
+ * returns immediately. The reparse can be cancelled with
+ * \c clang_ReparseTask_cancel(); it then stops at the next top-level
+ * declaration.
+ *
+ * Starting a reparse, with this function or with
+ * \c clang_reparseTranslationUnit(), cancels the reparses of the same
+ * translation unit that were started earlier and have not finished, since
+ * their results would be stale. Reparses of a translation unit run one at a
+ * time, so the new reparse starts as soon as the ones it cancelled have
+ * stopped, and a reparse that only gets to run after a later one has run is
+ * cancelled.
+ *
+ * Until the task has finished, the translation unit must not be used except
+ * through the \c clang_ReparseTask functions, to start another reparse, or
+ * to query its generation. The task must be disposed of before the
+ * translation unit.
+ *
+ * \param unsaved_files The files that have not yet been saved to disk. They
+ * are copied, so the client only needs to guarantee their validity until
+ * this function returns.
+ *
+ * \returns The task, which must be freed with \c clang_ReparseTask_dispose(),
+ * or NULL if the arguments are invalid.
+ */
+CINDEX_LINKAGE CXReparseTask
+clang_reparseTranslationUnitAsync(CXTranslationUnit TU,
+                                  unsigned num_unsaved_files,
+                                  struct CXUnsavedFile *unsaved_files,
+                                  unsigned options);
+
+/**
+ * Ask the reparse to stop as soon as possible. This does not wait for it to
+ * stop.
+ *
+ * A reparse that is cancelled before it starts leaves the translation unit
+ * as it was. A reparse that is cancelled while it runs leaves the
+ * translation unit without any AST, but it can be reparsed again.
+ */
+CINDEX_LINKAGE void clang_ReparseTask_cancel(CXReparseTask task);
+
+/**
+ * Determine whether the reparse has finished, without waiting for it.
+ */
+CINDEX_LINKAGE unsigned clang_ReparseTask_isFinished(CXReparseTask task);
+
+/**
+ * Wait for the reparse to finish.
+ *
+ * \returns The result that \c clang_reparseTranslationUnit() would have
+ * returned, or \c CXError_Cancelled if the reparse was cancelled.
+ */
+CINDEX_LINKAGE int clang_ReparseTask_wait(CXReparseTask task);
+
+/**
+ * Retrieve the generation of the reparse.
+ *
+ * Each reparse of a translation unit is given a generation when it is
+ * started, larger than that of all the reparses started before it. A
+ * reparse whose generation is less than that of the latest one is stale.
+ */
+CINDEX_LINKAGE unsigned long long
+clang_ReparseTask_getGeneration(CXReparseTask task);
+
+/**
+ * Wait for the reparse to finish, and free it.
+ */
+CINDEX_LINKAGE void clang_ReparseTask_dispose(CXReparseTask task);
+
+/**
+ * Retrieve the generation of the reparse that last ran on the translation
+ * unit, or 0 if it has not been reparsed since it was created.
+ *
+ * This may be called while a reparse task runs.
+ */
+CINDEX_LINKAGE unsigned long long
+clang_getTranslationUnitGeneration(CXTranslationUnit TU);
+
 /**
   * Categorizes how memory is being used by a translation unit.
   */
@@ -1627,12 +1758,14 @@ enum CXTUResourceUsageKind {
   CXTUResourceUsage_PreprocessingRecord = 12,
   CXTUResourceUsage_SourceManager_DataStructures = 13,
   CXTUResourceUsage_Preprocessor_HeaderSearch = 14,
+  CXTUResourceUsage_Preprocessor_TokenCaches = 15,
+  CXTUResourceUsage_StoredDiagnostics = 16,
+  CXTUResourceUsage_Preamble = 17,
   CXTUResourceUsage_MEMORY_IN_BYTES_BEGIN = CXTUResourceUsage_AST,
-  CXTUResourceUsage_MEMORY_IN_BYTES_END =
-    CXTUResourceUsage_Preprocessor_HeaderSearch,
+  CXTUResourceUsage_MEMORY_IN_BYTES_END = CXTUResourceUsage_Preamble,
 
   CXTUResourceUsage_First = CXTUResourceUsage_AST,
-  CXTUResourceUsage_Last = CXTUResourceUsage_Preprocessor_HeaderSearch
+  CXTUResourceUsage_Last = CXTUResourceUsage_Preamble
 };
 
 /**
@@ -1674,6 +1807,33 @@ CINDEX_LINKAGE CXTUResourceUsage clang_getCXTUResourceUsage(CXTranslationUnit TU
 
 CINDEX_LINKAGE void clang_disposeCXTUResourceUsage(CXTUResourceUsage usage);
 
+/**
+ * Release the memory that a translation unit only needs while parsing.
+ *
+ * This drops the cached code-completion results, which are rebuilt by the
+ * next reparse, and the token caches of the preprocessor. Cursors, tokens,
+ * diagnostics and the preprocessing record stay valid, and the translation
+ * unit can still be reparsed and saved.
+ *
+ * \returns 0 on success, otherwise an error code from \c CXErrorCode.
+ */
+CINDEX_LINKAGE int clang_compactTranslationUnit(CXTranslationUnit TU);
+
+/**
+ * Retrieve how the precompiled preamble of a translation unit was used.
+ *
+ * \param builds Set to the number of times the preamble was built, by
+ * parsing or reparsing the translation unit.
+ *
+ * \param reuses Set to the number of times a parse, reparse or code
+ * completion reused the preamble instead of building it again.
+ *
+ * \returns 0 on success, otherwise an error code from \c CXErrorCode.
+ */
+CINDEX_LINKAGE int
+clang_getTranslationUnitPreambleUsage(CXTranslationUnit TU, unsigned *builds,
+                                      unsigned *reuses);
+
 /**
  * Get target information for this translation unit.
  *
@@ -4149,6 +4309,125 @@ CINDEX_LINKAGE unsigned clang_visitChildrenWithBlock(CXCursor parent,
 #  endif
 #endif
 
+/**
+ * A flattened subtree of cursors, as built by clang_getCursorTree().
+ */
+typedef struct CXCursorTreeImpl *CXCursorTree;
+
+/**
+ * Describes one cursor of a \c CXCursorTree.
+ *
+ * The file, offsets, line and column describe the start and the end of the
+ * extent of the cursor, as given by clang_getExpansionLocation().
+ */
+typedef struct {
+  /**
+   * The kind of the cursor.
+   */
+  enum CXCursorKind kind;
+  /**
+   * The index of the parent node, or ~0U for the root of the tree.
+   */
+  unsigned parent;
+  /**
+   * The index of the file that contains the start of the extent, as passed
+   * to clang_CursorTree_getFile(), or ~0U if the extent is not in a file.
+   */
+  unsigned file;
+  /**
+   * The offsets into the file of the start and the end of the extent.
+   */
+  unsigned begin_offset;
+  unsigned end_offset;
+  /**
+   * The line and column of the start of the extent.
+   */
+  unsigned begin_line;
+  unsigned begin_column;
+  /**
+   * The offset of the spelling of the cursor into the string table returned
+   * by clang_CursorTree_getStrings().
+   */
+  unsigned spelling;
+  /**
+   * The offset of the USR of the cursor into the string table, if the tree
+   * was built with \c CXCursorTree_IncludeUSRs; otherwise, the offset of an
+   * empty string.
+   */
+  unsigned usr;
+} CXCursorTreeNode;
+
+/**
+ * Flags that control how a \c CXCursorTree is built.
+ */
+enum CXCursorTree_Flags {
+  CXCursorTree_None = 0x0,
+  /**
+   * Compute the USR of each cursor.
+   */
+  CXCursorTree_IncludeUSRs = 0x1
+};
+
+/**
+ * Visit the given cursor and all of its descendants, in the order in which
+ * a recursive clang_visitChildren() would visit them, and store them in a
+ * flat array.
+ *
+ * This gives language bindings the whole subtree in a single call, without a
+ * callback per cursor.
+ *
+ * \param root The cursor at the root of the tree. It is stored as node 0,
+ * and its descendants follow it in preorder.
+ *
+ * \param options A bitmask of \c CXCursorTree_Flags.
+ *
+ * \returns The tree, which must be freed with clang_disposeCursorTree(), or
+ * NULL if \p root is not a valid cursor.
+ */
+CINDEX_LINKAGE CXCursorTree clang_getCursorTree(CXCursor root,
+                                                unsigned options);
+
+/**
+ * Free a tree built by clang_getCursorTree().
+ */
+CINDEX_LINKAGE void clang_disposeCursorTree(CXCursorTree tree);
+
+/**
+ * Retrieve the number of nodes in the tree.
+ */
+CINDEX_LINKAGE unsigned clang_CursorTree_getNumNodes(CXCursorTree tree);
+
+/**
+ * Retrieve the array of the nodes in the tree, which is valid until the
+ * tree is disposed of.
+ */
+CINDEX_LINKAGE const CXCursorTreeNode *
+clang_CursorTree_getNodes(CXCursorTree tree);
+
+/**
+ * Retrieve the string table of the tree, which is valid until the tree is
+ * disposed of. It consists of null-terminated strings, which the nodes refer
+ * to by offset.
+ *
+ * \param size If non-NULL, set to the size of the table in bytes.
+ */
+CINDEX_LINKAGE const char *clang_CursorTree_getStrings(CXCursorTree tree,
+                                                       unsigned *size);
+
+/**
+ * Retrieve the file with the given index, or NULL if the index is out of
+ * range.
+ */
+CINDEX_LINKAGE CXFile clang_CursorTree_getFile(CXCursorTree tree,
+                                               unsigned index);
+
+/**
+ * Retrieve the cursor of the node with the given index, or a null cursor if
+ * the index is out of range.
+ */
+CINDEX_LINKAGE CXCursor clang_CursorTree_getCursor(CXCursorTree tree,
+                                                   unsigned index);
+
 /**
  * @}
  */
@@ -5713,6 +5992,34 @@ CXCodeCompleteResults *clang_codeCompleteAt(CXTranslationUnit TU,
                                             unsigned num_unsaved_files,
                                             unsigned options);
 
+/**
+ * Perform code completion at a given location, returning only the results
+ * that the client is going to show.
+ *
+ * This behaves like \c clang_codeCompleteAt(), except that the results are
+ * filtered while they are collected, and no completion string is built for
+ * a result that is filtered out. This is much cheaper than filtering the
+ * results of \c clang_codeCompleteAt() in contexts with many candidates,
+ * such as global scope in a translation unit that imports large modules.
+ *
+ * \param typed_prefix If neither NULL nor empty, only the results whose
+ * typed text starts with this prefix, ignoring case, are returned. Results
+ * whose typed text is not a plain name, such as constructors and operators,
+ * may be returned regardless of the prefix.
+ *
+ * \param max_results If non-zero, at most this many results are returned;
+ * when there are more, the ones with the best (lowest) priority are kept.
+ *
+ * The other parameters and the result are those of
+ * \c clang_codeCompleteAt().
+ */
+CINDEX_LINKAGE
+CXCodeCompleteResults *clang_codeCompleteAtWithFilter(
+    CXTranslationUnit TU, const char *complete_filename,
+    unsigned complete_line, unsigned complete_column,
+    struct CXUnsavedFile *unsaved_files, unsigned num_unsaved_files,
+    unsigned options, const char *typed_prefix, unsigned max_results);
+
 /**
  * Sort the code-completion results in case-insensitive alphabetical
  * order.
@@ -135,10 +135,25 @@ private:
     ~Vec() { delete[] Elts; }
   };
   struct Arr {
+    /// The initialized elements, followed by the filler if there is one.
+    ///
+    /// Copies of an array value share their elements, until one of the
+    /// copies is accessed through a non-const accessor. The number of array
+    /// values sharing the elements is stored in front of them.
     APValue *Elts;
     unsigned NumElts, ArrSize;
     Arr(unsigned NumElts, unsigned ArrSize);
+    Arr(const Arr &RHS);
+    Arr &operator=(const Arr &) = delete;
     ~Arr();
+
+    unsigned getNumStoredElts() const {
+      return NumElts + (NumElts != ArrSize ? 1 : 0);
+    }
+    unsigned &getNumUsers() const {
+      return *reinterpret_cast<unsigned *>(reinterpret_cast<char *>(Elts) -
+                                           ArrUsersOffset);
+    }
   };
   struct StructData {
     APValue *Elts;
@@ -165,6 +180,10 @@ private:
                                       UnionData, AddrLabelDiffData> DataType;
   static const size_t DataSize = sizeof(DataType);
 
+  /// The offset of the elements of an array from the start of their
+  /// allocation, which holds the number of array values sharing them.
+  static const size_t ArrUsersOffset = alignof(DataType);
+
   DataType Data;
 
 public:
@@ -322,13 +341,23 @@ public:
     return ((const Vec*)(const void *)Data.buffer)->NumElts;
   }
 
+  /// Get an initialized element of an array, for modification.
+  ///
+  /// Copying an array does not copy its elements; the copies share them
+  /// until the first call to this function or to the non-const
+  /// getArrayFiller, which gives the array its own copy of the elements. A
+  /// reference obtained this way must therefore not be used to modify the
+  /// array after the array has been copied. Use the const overload to only
+  /// read an element.
   APValue &getArrayInitializedElt(unsigned I) {
     assert(isArray() && "Invalid accessor");
     assert(I < getArrayInitializedElts() && "Index out of range");
-    return ((Arr*)(char*)Data.buffer)->Elts[I];
+    return getArrayEltsForModification()[I];
   }
   const APValue &getArrayInitializedElt(unsigned I) const {
-    return const_cast<APValue*>(this)->getArrayInitializedElt(I);
+    assert(isArray() && "Invalid accessor");
+    assert(I < getArrayInitializedElts() && "Index out of range");
+    return ((const Arr*)(const void *)Data.buffer)->Elts[I];
   }
   bool hasArrayFiller() const {
     return getArrayInitializedElts() != getArraySize();
@@ -336,10 +365,13 @@ public:
   APValue &getArrayFiller() {
     assert(isArray() && "Invalid accessor");
     assert(hasArrayFiller() && "No array filler");
-    return ((Arr*)(char*)Data.buffer)->Elts[getArrayInitializedElts()];
+    return getArrayEltsForModification()[getArrayInitializedElts()];
   }
   const APValue &getArrayFiller() const {
-    return const_cast<APValue*>(this)->getArrayFiller();
+    assert(isArray() && "Invalid accessor");
+    assert(hasArrayFiller() && "No array filler");
+    return ((const Arr*)(const void *)Data.buffer)
+        ->Elts[getArrayInitializedElts()];
   }
   unsigned getArrayInitializedElts() const {
     assert(isArray() && "Invalid accessor");
@@ -450,6 +482,14 @@ public:
   }
 
 private:
+  APValue *getArrayEltsForModification() {
+    Arr *A = (Arr*)(char*)Data.buffer;
+    if (A->getNumUsers() != 1)
+      unshareArray();
+    return A->Elts;
+  }
+  void unshareArray();
+
   void DestroyDataAndMakeUninit();
   void MakeUninit() {
     if (Kind != Uninitialized)
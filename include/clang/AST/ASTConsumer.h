@@ -62,6 +62,14 @@ public:
   /// the consumer. The default implementation forwards to HandleTopLevelDecl.
   virtual void HandleInterestingDecl(DeclGroupRef D);
 
+  /// Whether this consumer does anything with the declarations passed to
+  /// HandleInterestingDecl.
+  ///
+  /// A consumer that ignores them should return false, so that the AST
+  /// reader doesn't deserialize them, or the declarations they refer to,
+  /// just to hand them over.
+  virtual bool wantsInterestingDecls() { return true; }
+
   /// HandleTranslationUnit - This method is called when the ASTs for entire
   /// translation unit have been parsed.
   virtual void HandleTranslationUnit(ASTContext &Ctx) {}
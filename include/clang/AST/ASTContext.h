@@ -66,6 +66,7 @@
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <iterator>
 #include <memory>
 #include <string>
@@ -89,6 +90,9 @@ class AtomicExpr;
 class BlockExpr;
 class BuiltinTemplateDecl;
 class CharUnits;
+class ASTMemoryAttribution;
+class ConstexprCallMemo;
+class ConstexprInterpreter;
 class CXXABI;
 class CXXConstructorDecl;
 class CXXMethodDecl;
@@ -236,7 +240,8 @@ private:
 
   /// A cache mapping from RecordDecls to ASTRecordLayouts.
   ///
-  /// This is lazily created.  This is intentionally not serialized.
+  /// This is lazily created. The layouts of records from AST files are
+  /// loaded from the external source when it stored them.
   mutable llvm::DenseMap<const RecordDecl*, const ASTRecordLayout*>
     ASTRecordLayouts;
   mutable llvm::DenseMap<const ObjCContainerDecl*, const ASTRecordLayout*>
@@ -347,6 +352,9 @@ private:
   /// The identifier '__type_pack_element'.
   mutable IdentifierInfo *TypePackElementName = nullptr;
 
+  /// The identifier '__type_pack_slice'.
+  mutable IdentifierInfo *TypePackSliceName = nullptr;
+
   QualType ObjCConstantStringType;
   mutable RecordDecl *CFConstantStringTagDecl = nullptr;
   mutable TypedefDecl *CFConstantStringTypeDecl = nullptr;
@@ -509,6 +517,11 @@ private:
   llvm::MapVector<const NamedDecl *, unsigned> MangleNumbers;
   llvm::MapVector<const VarDecl *, unsigned> StaticLocalNumbers;
 
+  /// The names that the mangle contexts created for this AST gave to
+  /// declarations whose mangling does not depend on the state of the mangle
+  /// context. The names are allocated in this context.
+  llvm::DenseMap<const NamedDecl *, StringRef> MangledDeclNames;
+
   /// Mapping that stores parameterIndex values for ParmVarDecls when
   /// that value exceeds the bitfield size of ParmVarDeclBits.ParameterIndex.
   using ParameterIndexTable = llvm::DenseMap<const VarDecl *, unsigned>;
@@ -521,6 +534,7 @@ private:
   mutable ExternCContextDecl *ExternCContext = nullptr;
   mutable BuiltinTemplateDecl *MakeIntegerSeqDecl = nullptr;
   mutable BuiltinTemplateDecl *TypePackElementDecl = nullptr;
+  mutable BuiltinTemplateDecl *TypePackSliceDecl = nullptr;
 
   /// The associated SourceManager object.
   SourceManager &SourceMgr;
@@ -622,25 +636,28 @@ public:
 
   /// Returns the parents of the given node (within the traversal scope).
   ///
-  /// Note that this will lazily compute the parents of all nodes
-  /// and store them for later retrieval. Thus, the first call is O(n)
-  /// in the number of AST nodes.
+  /// The parent map is computed lazily, one top-level declaration at a
+  /// time: the declarations directly within the translation unit, or
+  /// within a namespace, linkage specification or export declaration lexically
+  /// inside it, are each traversed only once a node within them is asked
+  /// about. A declaration's top-level declaration is found through its
+  /// lexical declaration contexts, and any other node's through its source
+  /// location. The parents of namespaces, linkage specifications and export
+  /// declarations are never stored; they are their lexical declaration
+  /// contexts. If the parents of a node are not found in the top-level
+  /// declarations it was expected in, the parent map is completed for the
+  /// whole traversal scope.
   ///
   /// Caveats and FIXMEs:
-  /// Calculating the parent map over all AST nodes will need to load the
-  /// full AST. This can be undesirable in the case where the full AST is
-  /// expensive to create (for example, when using precompiled header
-  /// preambles). Thus, there are good opportunities for optimization here.
-  /// One idea is to walk the given node downwards, looking for references
-  /// to declaration contexts - once a declaration context is found, compute
-  /// the parent map for the declaration context; if that can satisfy the
-  /// request, loading the whole AST can be avoided. Note that this is made
-  /// more complex by statements in templates having multiple parents - those
-  /// problems can be solved by building closure over the templated parts of
-  /// the AST, which also avoids touching large parts of the AST.
-  /// Additionally, we will want to add an interface to already give a hint
-  /// where to search for the parents, for example when looking at a statement
-  /// inside a certain function.
+  /// A node that is reachable from several top-level declarations, which
+  /// only happens for nodes that are shared between parts of the AST, may
+  /// only report the parents within the top-level declarations that were
+  /// already traversed.
+  /// Nodes without source locations, and nodes whose parents are asked for
+  /// although they have none, still complete the parent map for the whole
+  /// traversal scope, which needs to load the full AST. This can be
+  /// undesirable in the case where the full AST is expensive to create (for
+  /// example, when using precompiled header preambles).
   ///
   /// 'NodeT' can be one of Decl, Stmt, Type, TypeLoc,
   /// NestedNameSpecifier or NestedNameSpecifierLoc.
@@ -650,6 +667,20 @@ public:
 
   DynTypedNodeList getParents(const ast_type_traits::DynTypedNode &Node);
 
+  /// Forget the parents of the nodes within the top-level declaration that
+  /// contains \p DC, so that they are computed again the next time they are
+  /// asked for. This must be called after the AST within \p DC has changed,
+  /// if parents were already computed for it. If \p DC is the translation
+  /// unit, a namespace, a linkage specification or an export declaration,
+  /// the entire parent map is dropped.
+  void invalidateParents(const DeclContext *DC);
+
+  /// Compute the parents of all nodes within the traversal scope now, rather
+  /// than when they are first asked for. Until the traversal scope changes or
+  /// parents are invalidated, getParents() then only reads the parent map, so
+  /// it may be called from several threads at once.
+  void computeAllParents();
+
   const clang::PrintingPolicy &getPrintingPolicy() const {
     return PrintingPolicy;
   }
@@ -666,7 +697,10 @@ public:
   }
 
   void *Allocate(size_t Size, unsigned Align = 8) const {
-    return BumpAlloc.Allocate(Size, Align);
+    void *Mem = BumpAlloc.Allocate(Size, Align);
+    if (MemoryAttribution)
+      noteAllocation(Mem, Size);
+    return Mem;
   }
   template <typename T> T *Allocate(size_t Num = 1) const {
     return static_cast<T *>(Allocate(Num * sizeof(T), alignof(T)));
@@ -682,6 +716,20 @@ public:
   /// Return the total memory used for various side tables.
   size_t getSideTableAllocatedMemory() const;
 
+  /// Start attributing the memory allocated for AST nodes to the kinds of
+  /// the nodes and to the source files they come from, for
+  /// PrintMemoryReport.
+  void enableMemoryAttribution();
+
+  /// Retrieve the memory attribution, if it is enabled.
+  ASTMemoryAttribution *getMemoryAttribution() const {
+    return MemoryAttribution.get();
+  }
+
+  /// Print the memory allocated for AST nodes by node kind and by source
+  /// file. Memory attribution must have been enabled.
+  void PrintMemoryReport(raw_ostream &OS) const;
+
   PartialDiagnostic::StorageAllocator &getDiagAllocator() {
     return DiagAllocator;
   }
@@ -1010,6 +1058,7 @@ public:
   ExternCContextDecl *getExternCContextDecl() const;
   BuiltinTemplateDecl *getMakeIntegerSeqDecl() const;
   BuiltinTemplateDecl *getTypePackElementDecl() const;
+  BuiltinTemplateDecl *getTypePackSliceDecl() const;
 
   // Builtin Types.
   CanQualType VoidTy;
@@ -1099,6 +1148,13 @@ public:
   void PrintStats() const;
   const SmallVectorImpl<Type *>& getTypes() const { return Types; }
 
+  /// Make room in the sets that unique types for the given number of
+  /// additional types of each type class, indexed by Type::TypeClass.
+  ///
+  /// This is a hint, used when loading an AST file, that avoids rehashing
+  /// the sets as the types it contains are deserialized.
+  void reserveTypes(ArrayRef<uint64_t> NumTypesByClass);
+
   BuiltinTemplateDecl *buildBuiltinTemplateDecl(BuiltinTemplateKind BTK,
                                                 const IdentifierInfo *II) const;
 
@@ -1724,6 +1780,12 @@ public:
     return TypePackElementName;
   }
 
+  IdentifierInfo *getTypePackSliceName() const {
+    if (!TypePackSliceName)
+      TypePackSliceName = &Idents.get("__type_pack_slice");
+    return TypePackSliceName;
+  }
+
   /// Retrieve the Objective-C "instancetype" type, if already known;
   /// otherwise, returns a NULL type;
   QualType getObjCInstanceType() {
@@ -2224,6 +2286,14 @@ public:
 
   VTableContextBase *getVTableContext();
 
+  /// Get the bytecode interpreter that the constant expression evaluator
+  /// uses when -fexperimental-new-constant-interpreter is enabled.
+  ConstexprInterpreter &getConstexprInterpreter();
+
+  /// Get the table in which the constant expression evaluator remembers the
+  /// results of constexpr function calls.
+  ConstexprCallMemo &getConstexprCallMemo();
+
   MangleContext *createMangleContext();
 
   void DeepCollectObjCIvars(const ObjCInterfaceDecl *OI, bool leafClass,
@@ -2760,6 +2830,18 @@ public:
   void setStaticLocalNumber(const VarDecl *VD, unsigned Number);
   unsigned getStaticLocalNumber(const VarDecl *VD) const;
 
+  /// Retrieve the mangled name that was recorded for \p ND, or an empty
+  /// string if there is none.
+  StringRef getMangledDeclName(const NamedDecl *ND) const {
+    return MangledDeclNames.lookup(ND);
+  }
+
+  /// Record \p Name as the mangled name of \p ND, so that every mangle
+  /// context for this AST reuses it.
+  ///
+  /// \returns the copy of \p Name owned by this context.
+  StringRef setMangledDeclName(const NamedDecl *ND, StringRef Name);
+
   /// Retrieve the context for computing mangling numbers in the given
   /// DeclContext.
   MangleNumberingContext &getManglingNumberContext(const DeclContext *DC);
@@ -2920,6 +3002,21 @@ private:
 
   std::unique_ptr<VTableContextBase> VTContext;
 
+  /// The bytecode interpreter for constexpr functions, created on first use.
+  std::unique_ptr<ConstexprInterpreter> ConstexprInterp;
+
+  /// The results of constexpr function calls, created on first use.
+  std::unique_ptr<ConstexprCallMemo> ConstexprCalls;
+
+  /// The attribution of allocated memory to AST nodes, if enabled.
+  std::unique_ptr<ASTMemoryAttribution> MemoryAttribution;
+
+  void noteAllocation(const void *Ptr, size_t Size) const;
+
+  /// The allocation counter of the time trace profiler that was in use
+  /// before this context replaced it with its own.
+  std::function<size_t()> PrevTimeTraceAllocationCounter;
+
   void ReleaseDeclContextMaps();
 
 public:
@@ -33,6 +33,7 @@
 namespace clang {
 
 class ASTContext;
+class ASTImporterLookupTable;
 class CXXBaseSpecifier;
 class CXXCtorInitializer;
 class Decl;
@@ -95,6 +96,15 @@ class Attr;
     /// Whether to perform a minimal import.
     bool Minimal;
 
+    /// Whether to leave out the members of imported records that are only
+    /// imported when they are used.
+    bool OnlyNeededMembers = false;
+
+    /// The lookup table of the "to" context, if any, which replaces the
+    /// lookups into its declaration contexts. It may be shared with other
+    /// importers into the same context.
+    ASTImporterLookupTable *LookupTable;
+
     /// Whether the last diagnostic came from the "from" context.
     bool LastDiagFromFrom = false;
 
@@ -137,9 +147,14 @@ class Attr;
     /// \param MinimalImport If true, the importer will attempt to import
     /// as little as it can, e.g., by importing declarations as forward
     /// declarations that can be completed at a later point.
+    ///
+    /// \param LookupTable If not null, the lookup table of the "to" context
+    /// that the importer looks up existing declarations in, and adds the
+    /// declarations it creates to.
     ASTImporter(ASTContext &ToContext, FileManager &ToFileManager,
                 ASTContext &FromContext, FileManager &FromFileManager,
-                bool MinimalImport);
+                bool MinimalImport,
+                ASTImporterLookupTable *LookupTable = nullptr);
 
     virtual ~ASTImporter();
 
@@ -147,6 +162,23 @@ class Attr;
     /// to-be-completed forward declarations when possible.
     bool isMinimalImport() const { return Minimal; }
 
+    /// Import only the members of a record definition that its layout and
+    /// the special member lookups depend on: fields, nested declarations,
+    /// constructors, destructors, assignment and conversion operators and
+    /// virtual methods. Other methods are imported when an imported
+    /// declaration or statement refers to them.
+    void setImportOnlyNeededMembers(bool Only) { OnlyNeededMembers = Only; }
+    bool importsOnlyNeededMembers() const { return OnlyNeededMembers; }
+
+    /// Find the declarations named \p Name in \p DC in the "to" context, as
+    /// DeclContext::localUncachedLookup on its redeclaration context does.
+    void findDeclsInToCtx(DeclContext *DC, DeclarationName Name,
+                          SmallVectorImpl<NamedDecl *> &Result);
+
+    /// Make \p ToD, a declaration created in the "to" context, visible in
+    /// the lookup table.
+    void addToLookupTable(NamedDecl *ToD);
+
     /// \brief Import the given object, returns the result.
     ///
     /// \param To Import the object into this variable.
@@ -0,0 +1,64 @@
+//===- ASTImporterLookupTable.h - Name lookup for the importer --*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file defines the ASTImporterLookupTable class, which finds the
+//  declarations that the ASTImporter may merge an imported declaration with.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_AST_ASTIMPORTERLOOKUPTABLE_H
+#define LLVM_CLANG_AST_ASTIMPORTERLOOKUPTABLE_H
+
+#include "clang/AST/DeclarationName.h"
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SetVector.h"
+#include <utility>
+
+namespace clang {
+
+class DeclContext;
+class NamedDecl;
+class TranslationUnitDecl;
+
+/// Maps the declaration contexts of a translation unit and the names in them
+/// to the declarations that name lookup into the context finds.
+///
+/// The ASTImporter looks up every declaration it imports in its declaration
+/// context in the "to" context. DeclContext::localUncachedLookup walks all
+/// the declarations of a context that has external storage, as the contexts
+/// of a translation unit that uses a PCH do, so importing into a large
+/// translation unit is quadratic. The table is built by walking the
+/// translation unit once, and the importers that share it add each
+/// declaration they create.
+class ASTImporterLookupTable {
+public:
+  using DeclList = llvm::SmallSetVector<NamedDecl *, 2>;
+
+  explicit ASTImporterLookupTable(TranslationUnitDecl &TU);
+
+  /// Make \p ND visible in its declaration context and, like
+  /// DeclContext::addDecl does, in the contexts it is transparent to.
+  void add(NamedDecl *ND);
+
+  /// Returns the declarations named \p Name that name lookup into \p DC
+  /// finds, in the order they were added.
+  const DeclList &lookup(DeclContext *DC, DeclarationName Name) const;
+
+private:
+  void add(DeclContext *DC, NamedDecl *ND);
+  void addDeclsOf(DeclContext *DC);
+
+  llvm::DenseMap<std::pair<DeclContext *, DeclarationName>, DeclList> Table;
+  DeclList NoDecls;
+};
+
+} // namespace clang
+
+#endif // LLVM_CLANG_AST_ASTIMPORTERLOOKUPTABLE_H
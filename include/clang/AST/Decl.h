@@ -3397,6 +3397,7 @@ class EnumDecl : public TagDecl {
 
 public:
   friend class ASTDeclReader;
+  friend class ASTDeclWriter;
 
   EnumDecl *getCanonicalDecl() override {
     return cast<EnumDecl>(TagDecl::getCanonicalDecl());
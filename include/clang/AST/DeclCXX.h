@@ -39,6 +39,7 @@
 #include "clang/Basic/Specifiers.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/PointerIntPair.h"
 #include "llvm/ADT/PointerUnion.h"
 #include "llvm/ADT/STLExtras.h"
@@ -569,6 +570,14 @@ class CXXRecordDecl : public RecordDecl {
     /// This is actually currently stored in reverse order.
     LazyDeclPtr FirstFriend;
 
+    /// The canonical declarations of the direct and indirect base classes,
+    /// each listed once and sorted by address, or null if they have not been
+    /// computed yet.
+    mutable const CXXRecordDecl **AllBases = nullptr;
+
+    /// The number of classes in AllBases.
+    mutable unsigned NumAllBases = 0;
+
     DefinitionData(CXXRecordDecl *D);
 
     /// Retrieve the set of direct base classes.
@@ -961,6 +970,13 @@ public:
            !data().DefaultedDestructorIsDeleted;
   }
 
+  /// \c true if the definition data alone shows that the destructor is
+  /// implicit, accessible and not deleted, so that it does not have to be
+  /// declared to find that out.
+  bool hasKnownSimpleDestructor() const {
+    return hasSimpleDestructor() && !needsOverloadResolutionForDestructor();
+  }
+
   /// Determine whether this class has any default constructors.
   bool hasDefaultConstructor() const {
     return (data().DeclaredSpecialMembers & SMF_DefaultConstructor) ||
@@ -1709,6 +1725,17 @@ public:
   /// the type \p Base.
   bool isProvablyNotDerivedFrom(const CXXRecordDecl *Base) const;
 
+  /// Retrieve the canonical declarations of all direct and indirect base
+  /// classes of this class, each listed once even if it is a base class
+  /// subobject more than once, in no particular order.
+  ///
+  /// The set is computed on first use and cached with the definition, so
+  /// that checking whether a class is derived from another one, or whether
+  /// any base class can declare a name, does not walk the class hierarchy
+  /// again. Returns None if the set is not known, because the class is
+  /// dependent or some base class has no definition.
+  Optional<ArrayRef<const CXXRecordDecl *>> getAllBases() const;
+
   /// Function type used by forallBases() as a callback.
   ///
   /// \param BaseDefinition the definition of the base class
@@ -2231,6 +2231,14 @@ public:
     return makeSpecIterator(getSpecializations(), true);
   }
 
+  /// Retrieve the specializations of this class template that are already
+  /// known, without loading any lazily-loaded ones from the external source.
+  spec_range noload_specializations() const {
+    auto &Specs = getCommonPtr()->Specializations;
+    return spec_range(makeSpecIterator(Specs, false),
+                      makeSpecIterator(Specs, true));
+  }
+
   // Implement isa/cast/dyncast support
   static bool classof(const Decl *D) { return classofKind(D->getKind()); }
   static bool classofKind(Kind K) { return K == ClassTemplate; }
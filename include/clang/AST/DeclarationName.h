@@ -682,6 +682,11 @@ struct DeclarationNameLoc {
 
   DeclarationNameLoc(DeclarationName Name);
 
+  /// Returns true if names of the kind of \p Name have any location
+  /// information here. Nodes that seldom refer to such names can leave the
+  /// DeclarationNameLoc out for all the others.
+  static bool isNeededFor(DeclarationName Name);
+
   // FIXME: this should go away once all DNLocs are properly initialized.
   DeclarationNameLoc() { memset((void*) this, 0, sizeof(*this)); }
 };
@@ -1039,10 +1039,15 @@ public:
 ///   DeclRefExprBits.RefersToEnclosingVariableOrCapture
 ///       Specifies when this declaration reference expression (validly)
 ///       refers to an enclosed local or a captured variable.
+///   DeclRefExprBits.HasNameLoc:
+///       Specifies when this declaration reference expression has the
+///       source/type location info of a C++ operator, conversion,
+///       constructor or destructor name.
 class DeclRefExpr final
     : public Expr,
       private llvm::TrailingObjects<DeclRefExpr, NestedNameSpecifierLoc,
-                                    NamedDecl *, ASTTemplateKWAndArgsInfo,
+                                    NamedDecl *, DeclarationNameLoc,
+                                    ASTTemplateKWAndArgsInfo,
                                     TemplateArgumentLoc> {
   friend class ASTStmtReader;
   friend class ASTStmtWriter;
@@ -1051,10 +1056,6 @@ class DeclRefExpr final
   /// The declaration that we are referencing.
   ValueDecl *D;
 
-  /// Provides source/type location info for the declaration name
-  /// embedded in D.
-  DeclarationNameLoc DNLoc;
-
   size_t numTrailingObjects(OverloadToken<NestedNameSpecifierLoc>) const {
     return hasQualifier();
   }
@@ -1063,6 +1064,10 @@ class DeclRefExpr final
     return hasFoundDecl();
   }
 
+  size_t numTrailingObjects(OverloadToken<DeclarationNameLoc>) const {
+    return hasNameLoc();
+  }
+
   size_t numTrailingObjects(OverloadToken<ASTTemplateKWAndArgsInfo>) const {
     return hasTemplateKWAndArgsInfo();
   }
@@ -1071,6 +1076,11 @@ class DeclRefExpr final
   /// this DRE.
   bool hasFoundDecl() const { return DeclRefExprBits.HasFoundDecl; }
 
+  /// Test whether the source/type location info of the name is attached to
+  /// the end of this DRE. Names that have none, such as identifiers, leave
+  /// it out, which keeps the most common DREs small.
+  bool hasNameLoc() const { return DeclRefExprBits.HasNameLoc; }
+
   DeclRefExpr(const ASTContext &Ctx, NestedNameSpecifierLoc QualifierLoc,
               SourceLocation TemplateKWLoc, ValueDecl *D,
               bool RefersToEnlosingVariableOrCapture,
@@ -1086,17 +1096,20 @@ class DeclRefExpr final
   void computeDependence(const ASTContext &Ctx);
 
 public:
+  /// Construct a declaration reference expression without any trailing
+  /// information. Use Create() for a name that needs the source/type
+  /// location info of a DeclarationNameLoc.
   DeclRefExpr(ValueDecl *D, bool RefersToEnclosingVariableOrCapture, QualType T,
-              ExprValueKind VK, SourceLocation L,
-              const DeclarationNameLoc &LocInfo = DeclarationNameLoc())
+              ExprValueKind VK, SourceLocation L)
       : Expr(DeclRefExprClass, T, VK, OK_Ordinary, false, false, false, false),
-        D(D), DNLoc(LocInfo) {
+        D(D) {
     DeclRefExprBits.HasQualifier = false;
     DeclRefExprBits.HasTemplateKWAndArgsInfo = false;
     DeclRefExprBits.HasFoundDecl = false;
     DeclRefExprBits.HadMultipleCandidates = false;
     DeclRefExprBits.RefersToEnclosingVariableOrCapture =
         RefersToEnclosingVariableOrCapture;
+    DeclRefExprBits.HasNameLoc = false;
     DeclRefExprBits.Loc = L;
     computeDependence(D->getASTContext());
   }
@@ -1118,7 +1131,7 @@ public:
 
   /// Construct an empty declaration reference expression.
   static DeclRefExpr *CreateEmpty(const ASTContext &Context, bool HasQualifier,
-                                  bool HasFoundDecl,
+                                  bool HasFoundDecl, bool HasNameLoc,
                                   bool HasTemplateKWAndArgsInfo,
                                   unsigned NumTemplateArgs);
 
@@ -1127,7 +1140,10 @@ public:
   void setDecl(ValueDecl *NewD) { D = NewD; }
 
   DeclarationNameInfo getNameInfo() const {
-    return DeclarationNameInfo(getDecl()->getDeclName(), getLocation(), DNLoc);
+    return DeclarationNameInfo(getDecl()->getDeclName(), getLocation(),
+                               hasNameLoc()
+                                   ? *getTrailingObjects<DeclarationNameLoc>()
+                                   : DeclarationNameLoc());
   }
 
   SourceLocation getLocation() const { return DeclRefExprBits.Loc; }
@@ -2589,6 +2605,7 @@ struct MemberExprNameQualifier {
 class MemberExpr final
     : public Expr,
       private llvm::TrailingObjects<MemberExpr, MemberExprNameQualifier,
+                                    DeclarationNameLoc,
                                     ASTTemplateKWAndArgsInfo,
                                     TemplateArgumentLoc> {
   friend class ASTReader;
@@ -2603,10 +2620,6 @@ class MemberExpr final
   /// In X.F, this is the decl referenced by F.
   ValueDecl *MemberDecl;
 
-  /// MemberDNLoc - Provides source/type location info for the
-  /// declaration name embedded in MemberDecl.
-  DeclarationNameLoc MemberDNLoc;
-
   /// MemberLoc - This is the location of the member name.
   SourceLocation MemberLoc;
 
@@ -2614,6 +2627,10 @@ class MemberExpr final
     return hasQualifierOrFoundDecl();
   }
 
+  size_t numTrailingObjects(OverloadToken<DeclarationNameLoc>) const {
+    return hasNameLoc();
+  }
+
   size_t numTrailingObjects(OverloadToken<ASTTemplateKWAndArgsInfo>) const {
     return hasTemplateKWAndArgsInfo();
   }
@@ -2626,23 +2643,29 @@ class MemberExpr final
     return MemberExprBits.HasTemplateKWAndArgsInfo;
   }
 
-public:
+  /// True if the source/type location info of the member name is allocated
+  /// after this MemberExpr.
+  bool hasNameLoc() const { return MemberExprBits.HasNameLoc; }
+
+  /// Build a MemberExpr with no trailing objects; Create() allocates and
+  /// fills in the ones that the expression needs.
   MemberExpr(Expr *base, bool isarrow, SourceLocation operatorloc,
              ValueDecl *memberdecl, const DeclarationNameInfo &NameInfo,
              QualType ty, ExprValueKind VK, ExprObjectKind OK)
       : Expr(MemberExprClass, ty, VK, OK, base->isTypeDependent(),
              base->isValueDependent(), base->isInstantiationDependent(),
              base->containsUnexpandedParameterPack()),
-        Base(base), MemberDecl(memberdecl), MemberDNLoc(NameInfo.getInfo()),
-        MemberLoc(NameInfo.getLoc()) {
+        Base(base), MemberDecl(memberdecl), MemberLoc(NameInfo.getLoc()) {
     assert(memberdecl->getDeclName() == NameInfo.getName());
     MemberExprBits.IsArrow = isarrow;
     MemberExprBits.HasQualifierOrFoundDecl = false;
     MemberExprBits.HasTemplateKWAndArgsInfo = false;
     MemberExprBits.HadMultipleCandidates = false;
+    MemberExprBits.HasNameLoc = false;
     MemberExprBits.OperatorLoc = operatorloc;
   }
 
+public:
   // NOTE: this constructor should be used only when it is known that
   // the member name can not provide additional syntactic info
   // (i.e., source locations for C++ operator names or type source info
@@ -2653,11 +2676,12 @@ public:
       : Expr(MemberExprClass, ty, VK, OK, base->isTypeDependent(),
              base->isValueDependent(), base->isInstantiationDependent(),
              base->containsUnexpandedParameterPack()),
-        Base(base), MemberDecl(memberdecl), MemberDNLoc(), MemberLoc(l) {
+        Base(base), MemberDecl(memberdecl), MemberLoc(l) {
     MemberExprBits.IsArrow = isarrow;
     MemberExprBits.HasQualifierOrFoundDecl = false;
     MemberExprBits.HasTemplateKWAndArgsInfo = false;
     MemberExprBits.HadMultipleCandidates = false;
+    MemberExprBits.HasNameLoc = false;
     MemberExprBits.OperatorLoc = operatorloc;
   }
 
@@ -2772,8 +2796,10 @@ public:
 
   /// Retrieve the member declaration name info.
   DeclarationNameInfo getMemberNameInfo() const {
-    return DeclarationNameInfo(MemberDecl->getDeclName(),
-                               MemberLoc, MemberDNLoc);
+    return DeclarationNameInfo(MemberDecl->getDeclName(), MemberLoc,
+                               hasNameLoc()
+                                   ? *getTrailingObjects<DeclarationNameLoc>()
+                                   : DeclarationNameLoc());
   }
 
   SourceLocation getOperatorLoc() const { return MemberExprBits.OperatorLoc; }
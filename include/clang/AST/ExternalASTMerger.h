@@ -16,6 +16,7 @@
 
 #include "clang/AST/ASTImporter.h"
 #include "clang/AST/ExternalASTSource.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/Support/raw_ostream.h"
 
 namespace clang {
@@ -59,6 +60,10 @@ public:
 private:
   /// One importer exists for each source.
   ImporterVector Importers;
+  /// The importer of each source, by source ASTContext.  Every imported
+  /// DeclContext looks up the importer of its origin, which must not cost a
+  /// scan of Importers when there are many sources.
+  llvm::DenseMap<const ASTContext *, ASTImporter *> ImporterIndex;
   /// Overrides in case name lookup would return nothing or would return
   /// the wrong thing.
   OriginMap Origins;
@@ -40,6 +40,7 @@ namespace clang {
 
 class ASTConsumer;
 class ASTContext;
+class ASTRecordLayout;
 class CXXBaseSpecifier;
 class CXXCtorInitializer;
 class CXXRecordDecl;
@@ -304,6 +305,17 @@ public:
       llvm::DenseMap<const CXXRecordDecl *, CharUnits> &BaseOffsets,
       llvm::DenseMap<const CXXRecordDecl *, CharUnits> &VirtualBaseOffsets);
 
+  /// Retrieve the layout of the given record that was computed when the
+  /// external source was built, if one was stored with it.
+  ///
+  /// Unlike \c layoutRecordType, the stored layout is used as is, without
+  /// laying out the record again.
+  ///
+  /// \returns the layout, allocated in the ASTContext, or null if the layout
+  /// has to be computed.
+  virtual const ASTRecordLayout *
+  getStoredRecordLayout(const RecordDecl *Record);
+
   //===--------------------------------------------------------------------===//
   // Queries for performance analysis.
   //===--------------------------------------------------------------------===//
@@ -58,6 +58,8 @@ private:
   llvm::DenseMap<const BlockDecl*, unsigned> LocalBlockIds;
   llvm::DenseMap<const TagDecl*, uint64_t> AnonStructIds;
 
+  void mangleNameUncached(const NamedDecl *D, raw_ostream &);
+
 public:
   ManglerKind getKind() const { return Kind; }
 
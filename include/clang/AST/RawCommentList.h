@@ -194,16 +194,33 @@ class RawCommentList {
 public:
   RawCommentList(SourceManager &SourceMgr) : SourceMgr(SourceMgr) {}
 
+  /// Add a comment that was just lexed. Comments that are next to each other
+  /// are merged the first time the comments are needed.
   void addComment(const RawComment &RC, const CommentOptions &CommentOpts,
                   llvm::BumpPtrAllocator &Allocator);
 
   ArrayRef<RawComment *> getComments() const {
+    if (!PendingComments.empty())
+      mergePendingComments();
     return Comments;
   }
 
 private:
   SourceManager &SourceMgr;
-  std::vector<RawComment *> Comments;
+  mutable std::vector<RawComment *> Comments;
+
+  /// Comments that were added, in order of appearance, but are not merged
+  /// into Comments yet. Deciding whether two comments merge needs the source
+  /// text between them and their columns, which is wasted work when nobody
+  /// asks for documentation.
+  mutable std::vector<RawComment> PendingComments;
+
+  /// The options and allocator that pending comments are merged with.
+  const CommentOptions *PendingCommentOpts = nullptr;
+  llvm::BumpPtrAllocator *PendingAllocator = nullptr;
+
+  void mergePendingComments() const;
+  void mergeComment(const RawComment &RC) const;
 
   void addDeserializedComments(ArrayRef<RawComment *> DeserializedComments);
 
@@ -61,6 +61,7 @@ public:
 
 private:
   friend class ASTContext;
+  friend class ASTReader;
 
   /// Size - Size of record in characters.
   CharUnits Size;
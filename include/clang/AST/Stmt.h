@@ -344,6 +344,10 @@ protected:
     unsigned HadMultipleCandidates : 1;
     unsigned RefersToEnclosingVariableOrCapture : 1;
 
+    /// True if a DeclarationNameLoc follows the DeclRefExpr. Only the names
+    /// that DeclarationNameLoc::isNeededFor() have one.
+    unsigned HasNameLoc : 1;
+
     /// The location of the declaration name itself.
     SourceLocation Loc;
   };
@@ -457,6 +461,11 @@ protected:
     /// was resolved from an overloaded set having size greater than 1.
     unsigned HadMultipleCandidates : 1;
 
+    /// True if a DeclarationNameLoc is allocated after the
+    /// MemberExprNameQualifier, if any. Only the member names that
+    /// DeclarationNameLoc::isNeededFor() have one.
+    unsigned HasNameLoc : 1;
+
     /// This is the location of the -> or . in the expression.
     SourceLocation OperatorLoc;
   };
@@ -766,6 +775,12 @@ private:
   /// Whether statistic collection is enabled.
   static bool StatisticsEnabled;
 
+  /// Whether new statements are reported to the memory attribution of an
+  /// ASTContext; see ASTContext::enableMemoryAttribution.
+  static bool MemoryAttributionEnabled;
+
+  void noteMemoryAttribution() const;
+
 protected:
   /// Construct an empty statement.
   explicit Stmt(StmtClass SC, EmptyShell) : Stmt(SC) {}
@@ -778,6 +793,7 @@ public:
                   "Insufficient alignment!");
     StmtBits.sClass = SC;
     if (StatisticsEnabled) Stmt::addStmtClass(SC);
+    if (MemoryAttributionEnabled) noteMemoryAttribution();
   }
 
   StmtClass getStmtClass() const {
@@ -796,6 +812,7 @@ public:
   // global temp stats (until we have a per-module visitor)
   static void addStmtClass(const StmtClass s);
   static void EnableStatistics();
+  static void EnableMemoryAttribution();
   static void PrintStats();
 
   /// Dumps the specified AST fragment and all subtrees to
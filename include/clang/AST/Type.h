@@ -3728,6 +3728,10 @@ class FunctionProtoType final
   // equal; ExtParameterInfos are used to model very uncommon features,
   // and it's better not to burden the more common paths.
 
+  /// The hash of the profile of this type, computed when the type was
+  /// uniqued. See ProfileHashFoldingSetTrait.
+  unsigned ProfileHash = 0;
+
 public:
   /// Holds information about the various types of exception specification.
   /// ExceptionSpecInfo is not stored as such in FunctionProtoType but is
@@ -4092,6 +4096,7 @@ public:
     return T->getTypeClass() == FunctionProto;
   }
 
+  unsigned getProfileHash() const { return ProfileHash; }
   void Profile(llvm::FoldingSetNodeID &ID, const ASTContext &Ctx);
   static void Profile(llvm::FoldingSetNodeID &ID, QualType Result,
                       param_type_iterator ArgTys, unsigned NumArgs,
@@ -4838,6 +4843,10 @@ class alignas(8) TemplateSpecializationType
   /// replacement must, recursively, be one of these).
   TemplateName Template;
 
+  /// The hash of the profile of this type, computed when the type was
+  /// uniqued. See ProfileHashFoldingSetTrait.
+  unsigned ProfileHash = 0;
+
   TemplateSpecializationType(TemplateName T,
                              ArrayRef<TemplateArgument> Args,
                              QualType Canon,
@@ -4915,6 +4924,7 @@ public:
     return isTypeAlias() ? getAliasedType() : getCanonicalTypeInternal();
   }
 
+  unsigned getProfileHash() const { return ProfileHash; }
   void Profile(llvm::FoldingSetNodeID &ID, const ASTContext &Ctx) {
     Profile(ID, Template, template_arguments(), Ctx);
     if (isTypeAlias())
@@ -5258,6 +5268,10 @@ class alignas(8) DependentTemplateSpecializationType
   /// The identifier of the template.
   const IdentifierInfo *Name;
 
+  /// The hash of the profile of this type, computed when the type was
+  /// uniqued. See ProfileHashFoldingSetTrait.
+  unsigned ProfileHash = 0;
+
   DependentTemplateSpecializationType(ElaboratedTypeKeyword Keyword,
                                       NestedNameSpecifier *NNS,
                                       const IdentifierInfo *Name,
@@ -5300,6 +5314,7 @@ public:
   bool isSugared() const { return false; }
   QualType desugar() const { return QualType(this, 0); }
 
+  unsigned getProfileHash() const { return ProfileHash; }
   void Profile(llvm::FoldingSetNodeID &ID, const ASTContext &Context) {
     Profile(ID, Context, getKeyword(), NNS, Name, {getArgs(), getNumArgs()});
   }
@@ -6814,4 +6829,45 @@ void FixedPointValueToString(SmallVectorImpl<char> &Str, llvm::APSInt Val,
 
 } // namespace clang
 
+namespace llvm {
+
+/// Traits for the sets that unique types whose profiles are expensive to
+/// compute, such as those with a list of template arguments. The type
+/// remembers the hash of its profile, so that growing the set does not have
+/// to profile every type in it again, and a lookup only profiles the types
+/// whose hash matches.
+template <typename T>
+struct ProfileHashFoldingSetTrait
+    : DefaultContextualFoldingSetTrait<T, clang::ASTContext &> {
+  static bool Equals(T &X, const FoldingSetNodeID &ID, unsigned IDHash,
+                     FoldingSetNodeID &TempID, clang::ASTContext &Context) {
+    if (X.getProfileHash() != IDHash)
+      return false;
+    X.Profile(TempID, Context);
+    return TempID == ID;
+  }
+
+  static unsigned ComputeHash(T &X, FoldingSetNodeID &TempID,
+                              clang::ASTContext &Context) {
+    return X.getProfileHash();
+  }
+};
+
+template <>
+struct ContextualFoldingSetTrait<clang::FunctionProtoType, clang::ASTContext &>
+    : ProfileHashFoldingSetTrait<clang::FunctionProtoType> {};
+
+template <>
+struct ContextualFoldingSetTrait<clang::TemplateSpecializationType,
+                                 clang::ASTContext &>
+    : ProfileHashFoldingSetTrait<clang::TemplateSpecializationType> {};
+
+template <>
+struct ContextualFoldingSetTrait<clang::DependentTemplateSpecializationType,
+                                 clang::ASTContext &>
+    : ProfileHashFoldingSetTrait<clang::DependentTemplateSpecializationType> {
+};
+
+} // namespace llvm
+
 #endif // LLVM_CLANG_AST_TYPE_H
@@ -121,6 +121,8 @@ public:
   };
 
   struct MatchFinderOptions {
+    MatchFinderOptions() : NumThreads(1) {}
+
     struct Profiling {
       Profiling(llvm::StringMap<llvm::TimeRecord> &Records)
           : Records(Records) {}
@@ -133,6 +135,16 @@ public:
     ///
     /// It prints a report after match.
     llvm::Optional<Profiling> CheckProfiling;
+
+    /// The number of threads that \c matchAST() matches the top-level
+    /// declarations of the traversal scope on.
+    ///
+    /// With more than one thread, the callbacks are still run on the calling
+    /// thread, in the same order, but only once all matching is done. The
+    /// matchers then run concurrently, so they must not change any state that
+    /// they share, including state of the AST that is computed or read from an
+    /// external source on demand.
+    unsigned NumThreads;
   };
 
   MatchFinder(MatchFinderOptions Options = MatchFinderOptions());
@@ -178,6 +178,9 @@ public:
   bool operator<(const BoundNodesMap &Other) const {
     return NodeMap < Other.NodeMap;
   }
+  bool operator==(const BoundNodesMap &Other) const {
+    return NodeMap == Other.NodeMap;
+  }
 
   /// A map from IDs to the bound nodes.
   ///
@@ -249,6 +252,9 @@ public:
   bool operator<(const BoundNodesTreeBuilder &Other) const {
     return Bindings < Other.Bindings;
   }
+  bool operator==(const BoundNodesTreeBuilder &Other) const {
+    return Bindings == Other.Bindings;
+  }
 
   /// Returns \c true if this \c BoundNodesTreeBuilder can be compared,
   /// i.e. all stored node maps have memoization data.
@@ -283,6 +289,26 @@ public:
   virtual bool dynMatches(const ast_type_traits::DynTypedNode &DynNode,
                           ASTMatchFinder *Finder,
                           BoundNodesTreeBuilder *Builder) const = 0;
+
+  /// Returns false if no node of kind \p Kind can be matched.
+  ///
+  /// Used by \c MatchFinder to skip the matcher on such nodes. Matchers that
+  /// are composed of other matchers should look at those; the default is not
+  /// to rule out any kind.
+  virtual bool canMatchNodesOfKind(ast_type_traits::ASTNodeKind Kind) const {
+    return true;
+  }
+
+  /// Returns true if the matcher only looks at the node itself, cheaply.
+  ///
+  /// Such a matcher neither recurses into the AST nor binds or reads bound
+  /// nodes, so \c DynTypedMatcher::compile() may match it before the other
+  /// inner matchers of an allOf(). The default is to assume it does.
+  virtual bool isCheapToMatch() const { return false; }
+
+  /// Returns an address that identifies the class of the matcher, for the
+  /// matchers that \c DynTypedMatcher::compile() looks into, or null.
+  virtual const void *dynamicClassID() const { return nullptr; }
 };
 
 /// Generic interface for matchers on an AST node of type T.
@@ -387,6 +413,18 @@ public:
   ///   restricts the node types for \p Kind.
   DynTypedMatcher dynCastTo(const ast_type_traits::ASTNodeKind Kind) const;
 
+  /// Returns an equivalent matcher that is cheaper to match.
+  ///
+  /// Nested allOf() and anyOf() matchers are folded into their outer ones,
+  /// the inner matchers of an allOf() that only check the node kind are
+  /// dropped, and those that are cheap to match are moved before the others.
+  /// Meant for matchers that are built at run time, once, and then matched
+  /// against many nodes.
+  DynTypedMatcher compile() const;
+
+  /// Returns true if the matcher only looks at the node itself, cheaply.
+  bool isCheapToMatch() const { return Implementation->isCheapToMatch(); }
+
   /// Returns true if the matcher matches the given \c DynNode.
   bool matches(const ast_type_traits::DynTypedNode &DynNode,
                ASTMatchFinder *Finder, BoundNodesTreeBuilder *Builder) const;
@@ -708,6 +746,8 @@ class HasNameMatcher : public SingleNodeMatcherInterface<NamedDecl> {
 
   bool matchesNode(const NamedDecl &Node) const override;
 
+  bool isCheapToMatch() const override { return true; }
+
  private:
   /// Unqualified match routine.
   ///
@@ -164,6 +164,7 @@ public:
   ///   Optional if an error occurred. In that case, \c Error will contain a
   ///   description of the error.
   ///   The caller takes ownership of the DynTypedMatcher object returned.
+  ///   It has been compiled with \c DynTypedMatcher::compile().
   static llvm::Optional<DynTypedMatcher>
   parseMatcherExpression(StringRef MatcherCode, Sema *S,
                          const NamedValueMap *NamedValues,
@@ -22,6 +22,7 @@
 #include "llvm/Support/GenericDomTree.h"
 #include "llvm/Support/GenericDomTreeConstruction.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 
 // FIXME: There is no good reason for the domtree to require a print method
 // which accepts an LLVM Module, so remove this (and the method's argument that
@@ -39,20 +40,26 @@ using DomTreeNode = llvm::DomTreeNodeBase<CFGBlock>;
 
 /// Concrete subclass of DominatorTreeBase for Clang
 /// This class implements the dominators tree functionality given a Clang CFG.
+/// With \p IsPostDom, it is the post-dominators tree.
 ///
-class DominatorTree : public ManagedAnalysis {
+/// The trees are ManagedAnalyses, so clients that ask an AnalysisDeclContext
+/// for them share one tree per CFG instead of each building their own.
+template <bool IsPostDom>
+class CFGDominatorTreeImpl : public ManagedAnalysis {
   virtual void anchor();
 
 public:
-  llvm::DomTreeBase<CFGBlock> *DT;
+  using DominatorTreeBase = llvm::DominatorTreeBase<CFGBlock, IsPostDom>;
 
-  DominatorTree() {
-    DT = new llvm::DomTreeBase<CFGBlock>();
+  DominatorTreeBase *DT;
+
+  CFGDominatorTreeImpl() {
+    DT = new DominatorTreeBase();
   }
 
-  ~DominatorTree() override { delete DT; }
+  ~CFGDominatorTreeImpl() override { delete DT; }
 
-  llvm::DomTreeBase<CFGBlock>& getBase() { return *DT; }
+  DominatorTreeBase& getBase() { return *DT; }
 
   /// This method returns the root CFGBlock of the dominators tree.
   CFGBlock *getRoot() const {
@@ -68,7 +75,7 @@ public:
   /// This method compares two dominator trees.
   /// The method returns false if the other dominator tree matches this
   /// dominator tree, otherwise returns true.
-  bool compare(DominatorTree &Other) const {
+  bool compare(CFGDominatorTreeImpl &Other) const {
     DomTreeNode *R = getRootNode();
     DomTreeNode *OtherR = Other.getRootNode();
 
@@ -91,13 +98,22 @@ public:
   /// This method dumps immediate dominators for each block,
   /// mainly used for debug purposes.
   void dump() {
-    llvm::errs() << "Immediate dominance tree (Node#,IDom#):\n";
+    llvm::errs() << "Immediate " << (IsPostDom ? "post " : "")
+                 << "dominance tree (Node#,IDom#):\n";
     for (CFG::const_iterator I = cfg->begin(),
         E = cfg->end(); I != E; ++I) {
-      if(DT->getNode(*I)->getIDom())
+      // Blocks that are unreachable from the entry, such as the branch of an
+      // 'if (0)', are not in a dominators tree.
+      DomTreeNode *Node = DT->getNode(*I);
+      if (!Node)
+        continue;
+      // The root of a post-dominators tree is a virtual node, with no block,
+      // whose children are the exits of the CFG.
+      DomTreeNode *IDom = Node->getIDom();
+      if (IDom && IDom->getBlock())
         llvm::errs() << "(" << (*I)->getBlockID()
                      << ","
-                     << DT->getNode(*I)->getIDom()->getBlock()->getBlockID()
+                     << IDom->getBlock()->getBlockID()
                      << ")\n";
       else llvm::errs() << "(" << (*I)->getBlockID()
                         << "," << (*I)->getBlockID() << ")\n";
@@ -150,17 +166,98 @@ public:
     DT->print(OS);
   }
 
+  // Used by AnalysisDeclContext to construct this object.
+  static const void *getTag();
+
+  static CFGDominatorTreeImpl *create(AnalysisDeclContext &AC);
+
 private:
   CFG *cfg;
 };
 
+extern template class CFGDominatorTreeImpl</*IsPostDom=*/false>;
+extern template class CFGDominatorTreeImpl</*IsPostDom=*/true>;
+
+using DominatorTree = CFGDominatorTreeImpl</*IsPostDom=*/false>;
+using PostDominatorTree = CFGDominatorTreeImpl</*IsPostDom=*/true>;
+
 } // namespace clang
 
+namespace llvm {
+
+//===-------------------------------------
+/// The edges of a CFG that are known never to be taken, such as the false
+/// branch of a 'while (1)' or the true branch of an 'if (0)', are null
+/// successors and predecessors. The dominator tree builder treats a null node
+/// as the virtual root of a post-dominators tree, so make it skip them.
+///
+namespace DomTreeBuilder {
+
+using ClangCFGDomChildrenGetter =
+    SemiNCAInfo<::clang::DominatorTree::DominatorTreeBase>::ChildrenGetter<
+        /*Inverse=*/false>;
+
+template <>
+template <>
+inline ClangCFGDomChildrenGetter::ResultTy ClangCFGDomChildrenGetter::Get(
+    ::clang::CFGBlock *N, std::integral_constant<bool, /*Inverse=*/false>) {
+  auto RChildren = reverse(children<NodePtr>(N));
+  ResultTy Ret(RChildren.begin(), RChildren.end());
+  Ret.erase(std::remove(Ret.begin(), Ret.end(), nullptr), Ret.end());
+  return Ret;
+}
+
+using ClangCFGDomReverseChildrenGetter =
+    SemiNCAInfo<::clang::DominatorTree::DominatorTreeBase>::ChildrenGetter<
+        /*Inverse=*/true>;
+
+template <>
+template <>
+inline ClangCFGDomReverseChildrenGetter::ResultTy
+ClangCFGDomReverseChildrenGetter::Get(
+    ::clang::CFGBlock *N, std::integral_constant<bool, /*Inverse=*/true>) {
+  auto IChildren = inverse_children<NodePtr>(N);
+  ResultTy Ret(IChildren.begin(), IChildren.end());
+  Ret.erase(std::remove(Ret.begin(), Ret.end(), nullptr), Ret.end());
+  return Ret;
+}
+
+using ClangCFGPostDomChildrenGetter =
+    SemiNCAInfo<::clang::PostDominatorTree::DominatorTreeBase>::ChildrenGetter<
+        /*Inverse=*/false>;
+
+template <>
+template <>
+inline ClangCFGPostDomChildrenGetter::ResultTy
+ClangCFGPostDomChildrenGetter::Get(
+    ::clang::CFGBlock *N, std::integral_constant<bool, /*Inverse=*/false>) {
+  auto RChildren = reverse(children<NodePtr>(N));
+  ResultTy Ret(RChildren.begin(), RChildren.end());
+  Ret.erase(std::remove(Ret.begin(), Ret.end(), nullptr), Ret.end());
+  return Ret;
+}
+
+using ClangCFGPostDomReverseChildrenGetter =
+    SemiNCAInfo<::clang::PostDominatorTree::DominatorTreeBase>::ChildrenGetter<
+        /*Inverse=*/true>;
+
+template <>
+template <>
+inline ClangCFGPostDomReverseChildrenGetter::ResultTy
+ClangCFGPostDomReverseChildrenGetter::Get(
+    ::clang::CFGBlock *N, std::integral_constant<bool, /*Inverse=*/true>) {
+  auto IChildren = inverse_children<NodePtr>(N);
+  ResultTy Ret(IChildren.begin(), IChildren.end());
+  Ret.erase(std::remove(Ret.begin(), Ret.end(), nullptr), Ret.end());
+  return Ret;
+}
+
+} // namespace DomTreeBuilder
+
 //===-------------------------------------
 /// DominatorTree GraphTraits specialization so the DominatorTree can be
 /// iterable by generic graph iterators.
 ///
-namespace llvm {
 
 template <> struct GraphTraits< ::clang::DomTreeNode* > {
   using NodeRef = ::clang::DomTreeNode *;
@@ -14,6 +14,7 @@
 #include "clang/AST/AST.h"
 #include "clang/ASTMatchers/ASTMatchers.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
 
 namespace clang {
 
@@ -44,6 +45,35 @@ private:
   using MutationFinder = const Stmt *(ExprMutationAnalyzer::*)(const Expr *);
   using ResultMap = llvm::DenseMap<const Expr *, const Stmt *>;
 
+  /// Every place in `Stm` that could mutate an expression, keyed by that
+  /// expression, and every DeclRefExpr in `Stm`, keyed by the referenced
+  /// declaration. Each list is in the order in which the sites appear in
+  /// `Stm`. The index is built with a single matcher pass the first time it
+  /// is needed, after which every query is a lookup instead of a traversal of
+  /// `Stm`.
+  struct SiteIndex {
+    struct ArgSite {
+      const Expr *Call;
+      const FunctionDecl *Func;
+      const ParmVarDecl *Parm;
+    };
+    template <class T>
+    using Map = llvm::DenseMap<const Expr *, llvm::SmallVector<T, 1>>;
+
+    llvm::DenseMap<const Decl *, llvm::SmallVector<const Expr *, 4>> DeclRefs;
+    Map<const Stmt *> Direct;
+    Map<const Expr *> Members;
+    Map<const Expr *> Subscripts;
+    Map<const Expr *> Casts;
+    Map<const Expr *> Moves;
+    Map<const Decl *> LoopVars;
+    Map<const Expr *> Derefs;
+    Map<const Decl *> RefVars;
+    Map<ArgSite> Args;
+  };
+
+  const SiteIndex &getSites();
+
   const Stmt *findMutationMemoized(const Expr *Exp,
                                    llvm::ArrayRef<MutationFinder> Finders,
                                    ResultMap &MemoizedResults);
@@ -51,12 +81,10 @@ private:
 
   bool isUnevaluated(const Expr *Exp);
 
-  const Stmt *findExprMutation(ArrayRef<ast_matchers::BoundNodes> Matches);
-  const Stmt *findDeclMutation(ArrayRef<ast_matchers::BoundNodes> Matches);
-  const Stmt *
-  findExprPointeeMutation(ArrayRef<ast_matchers::BoundNodes> Matches);
-  const Stmt *
-  findDeclPointeeMutation(ArrayRef<ast_matchers::BoundNodes> Matches);
+  const Stmt *findExprMutation(ArrayRef<const Expr *> Exps);
+  const Stmt *findDeclMutation(ArrayRef<const Decl *> Decs);
+  const Stmt *findExprPointeeMutation(ArrayRef<const Expr *> Exps);
+  const Stmt *findDeclPointeeMutation(ArrayRef<const Decl *> Decs);
 
   const Stmt *findDirectMutation(const Expr *Exp);
   const Stmt *findMemberMutation(const Expr *Exp);
@@ -73,6 +101,7 @@ private:
       FuncParmAnalyzer;
   ResultMap Results;
   ResultMap PointeeResults;
+  std::unique_ptr<SiteIndex> Sites;
 };
 
 // A convenient wrapper around ExprMutationAnalyzer for analyzing function
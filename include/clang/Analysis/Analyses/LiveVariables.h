@@ -16,7 +16,8 @@
 
 #include "clang/AST/Decl.h"
 #include "clang/Analysis/AnalysisDeclContext.h"
-#include "llvm/ADT/ImmutableSet.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/Optional.h"
 
 namespace clang {
 
@@ -28,28 +29,40 @@ class SourceManager;
 
 class LiveVariables : public ManagedAnalysis {
 public:
+  /// The bits that the statements, variables and bindings whose liveness is
+  /// tracked use in a LivenessValues.
+  class LivenessIndices;
+
   class LivenessValues {
   public:
+    LivenessValues() = default;
+    explicit LivenessValues(LivenessIndices &Indices) : Indices(&Indices) {}
 
-    llvm::ImmutableSet<const Stmt *> liveStmts;
-    llvm::ImmutableSet<const VarDecl *> liveDecls;
-    llvm::ImmutableSet<const BindingDecl *> liveBindings;
-
-    bool equals(const LivenessValues &V) const;
+    bool equals(const LivenessValues &V) const { return *this == V; }
 
-    LivenessValues()
-      : liveStmts(nullptr), liveDecls(nullptr), liveBindings(nullptr) {}
+    bool operator==(const LivenessValues &V) const { return Live == V.Live; }
 
-    LivenessValues(llvm::ImmutableSet<const Stmt *> LiveStmts,
-                   llvm::ImmutableSet<const VarDecl *> LiveDecls,
-                   llvm::ImmutableSet<const BindingDecl *> LiveBindings)
-        : liveStmts(LiveStmts), liveDecls(LiveDecls),
-          liveBindings(LiveBindings) {}
+    /// Merge the values of \p V into these ones.
+    LivenessValues &operator|=(const LivenessValues &V) {
+      Live |= V.Live;
+      return *this;
+    }
 
     bool isLive(const Stmt *S) const;
     bool isLive(const VarDecl *D) const;
+    bool isLive(const BindingDecl *BD) const;
+
+    void setLive(const Stmt *S, bool IsLive = true);
+    void setLive(const VarDecl *D, bool IsLive = true);
+    void setLive(const BindingDecl *BD, bool IsLive = true);
+
+  private:
+    bool test(Optional<unsigned> Index) const;
+    void set(unsigned Index);
+    void reset(Optional<unsigned> Index);
 
-    friend class LiveVariables;
+    LivenessIndices *Indices = nullptr;
+    llvm::BitVector Live;
   };
 
   class Observer {
@@ -0,0 +1,71 @@
+//===- SSAView.h - SSA form of a CFG ----------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines SSAView, the SSA form of the CFG of a function, in the
+// typed intermediate language (TIL) of the thread safety analysis.
+//
+// The SSA form is built on demand, the first time an analysis asks the
+// AnalysisDeclContext for it, and is then shared by every analysis of the
+// same function. All of it is allocated in one arena, which is released with
+// the AnalysisDeclContext.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_ANALYSIS_ANALYSES_SSAVIEW_H
+#define LLVM_CLANG_ANALYSIS_ANALYSES_SSAVIEW_H
+
+#include "clang/Analysis/Analyses/ThreadSafetyCommon.h"
+#include "clang/Analysis/Analyses/ThreadSafetyTIL.h"
+#include "clang/Analysis/AnalysisDeclContext.h"
+#include "clang/Basic/LLVM.h"
+#include "llvm/Support/Allocator.h"
+
+namespace clang {
+
+class CFGBlock;
+class Stmt;
+
+class SSAView : public ManagedAnalysis {
+  virtual void anchor();
+
+public:
+  ~SSAView() override;
+
+  /// Returns the SSA form of the CFG. Its basic blocks are in the reverse
+  /// post-order of the CFG blocks they were translated from.
+  const threadSafety::til::SCFG *getSCFG() const { return Graph; }
+
+  /// Returns the TIL expression that \p S was translated to, or null if
+  /// \p S is not a statement of the CFG.
+  const threadSafety::til::SExpr *lookupStmt(const Stmt *S) const;
+
+  /// Returns the basic block that \p B was translated to.
+  const threadSafety::til::BasicBlock *lookupBlock(const CFGBlock *B) const;
+
+  /// Print the SSA form to \p OS.
+  void print(raw_ostream &OS) const;
+
+  // Used by AnalysisDeclContext to construct this object.
+  static const void *getTag();
+
+  static SSAView *create(AnalysisDeclContext &AC);
+
+private:
+  SSAView();
+
+  llvm::BumpPtrAllocator Arena;
+  // The builder keeps the maps from statements and CFG blocks to what they
+  // were translated to.
+  mutable threadSafety::SExprBuilder Builder;
+  threadSafety::til::SCFG *Graph = nullptr;
+};
+
+} // namespace clang
+
+#endif // LLVM_CLANG_ANALYSIS_ANALYSES_SSAVIEW_H
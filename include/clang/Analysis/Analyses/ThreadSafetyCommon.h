@@ -32,6 +32,7 @@
 #include "clang/Basic/LLVM.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Casting.h"
 #include <sstream>
 #include <string>
@@ -286,12 +287,16 @@ public:
     return CapabilityExpr(CapExpr, !Negated);
   }
 
+  // Capability expressions are interned by the SExprBuilder, so equal ones
+  // usually share their til::SExpr, which is checked before comparing them.
   bool equals(const CapabilityExpr &other) const {
-    return (Negated == other.Negated) && sx::equals(CapExpr, other.CapExpr);
+    return (Negated == other.Negated) &&
+           (CapExpr == other.CapExpr || sx::equals(CapExpr, other.CapExpr));
   }
 
   bool matches(const CapabilityExpr &other) const {
-    return (Negated == other.Negated) && sx::matches(CapExpr, other.CapExpr);
+    return (Negated == other.Negated) &&
+           (CapExpr == other.CapExpr || sx::matches(CapExpr, other.CapExpr));
   }
 
   bool matchesUniv(const CapabilityExpr &CapE) const {
@@ -423,6 +428,14 @@ private:
 
   til::SExpr *translateDeclStmt(const DeclStmt *S, CallingContext *Ctx);
 
+  CapabilityExpr
+  translateAndCache(std::pair<const Expr *, const NamedDecl *> Key,
+                    CallingContext &Ctx, unsigned PrevContextSubstitutions);
+
+  // Returns the capability expression that was interned for the expressions
+  // equal to E, interning E if there is none.
+  const til::SExpr *internCapability(const til::SExpr *E);
+
   // Map from statements in the clang CFG to SExprs in the til::SCFG.
   using StatementMap = llvm::DenseMap<const Stmt *, til::SExpr *>;
 
@@ -490,6 +503,20 @@ private:
   // Variable to use for 'this'.  May be null.
   til::Variable *SelfVar = nullptr;
 
+  // The interned capability expressions, by the way they are printed.
+  // Unequal expressions may print alike, so this holds all of them.
+  llvm::StringMap<SmallVector<const til::SExpr *, 1>> InternedCapabilities;
+
+  // The translations of attribute expressions which did not depend on the
+  // arguments of a call, by the expression and the declaration that carries
+  // the attribute. These are the same at every call site.
+  llvm::DenseMap<std::pair<const Expr *, const NamedDecl *>, CapabilityExpr>
+      AttrExprTranslations;
+
+  // The number of function arguments and self arguments which were
+  // substituted while translating.
+  unsigned NumContextSubstitutions = 0;
+
   til::SCFG *Scfg = nullptr;
 
   // Map from Stmt to TIL Variables
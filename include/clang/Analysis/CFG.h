@@ -1062,6 +1062,15 @@ public:
   /// during CFG construction.
   void setIndirectGotoBlock(CFGBlock *B) { IndirectGotoBlock = B; }
 
+  /// Note that a condition or switch value was evaluated to a constant while
+  /// building the CFG, so that some edges may have been pruned.
+  void setMayHavePrunedEdges() { MayHavePrunedEdges = true; }
+
+  /// Returns false if no edges were pruned while building the CFG, in which
+  /// case it is the same as the CFG built without
+  /// BuildOptions::PruneTriviallyFalseEdges.
+  bool mayHavePrunedEdges() const { return MayHavePrunedEdges; }
+
   //===--------------------------------------------------------------------===//
   // Block Iterators
   //===--------------------------------------------------------------------===//
@@ -1204,6 +1213,8 @@ private:
 
   unsigned  NumBlockIDs = 0;
 
+  bool MayHavePrunedEdges = false;
+
   BumpVectorContext BlkBVC;
 
   CFGBlockListTy Blocks;
@@ -17,6 +17,8 @@
 
 #include "clang/AST/StmtVisitor.h"
 #include "llvm/Support/Regex.h"
+#include <cstdint>
+#include <string>
 #include <vector>
 
 namespace clang {
@@ -276,6 +278,97 @@ public:
   void constrain(std::vector<CloneDetector::CloneGroup> &Sequences);
 };
 
+/// A MinHash signature of the structure of a StmtSequence, together with the
+/// location of the sequence.
+///
+/// The signature is computed over the set of hashes of every statement
+/// subtree in the sequence, where each hash covers the same data as the
+/// RecursiveCloneTypeIIHashConstraint. The fraction of equal entries in two
+/// signatures estimates the Jaccard similarity of these sets, so that clones
+/// with small differences still have similar signatures.
+///
+/// Fingerprints only contain plain data, so they can be written out with
+/// print() while each translation unit is analyzed, and read back with parse()
+/// to search for clones across translation units with
+/// MinHashCloneConstraint::groupSimilar().
+class CloneFingerprint {
+public:
+  /// The file that contains the fingerprinted statements.
+  std::string Filename;
+  /// The first and last line of the statements in their file.
+  unsigned BeginLine = 0;
+  unsigned EndLine = 0;
+  /// The minimum of each of the hash functions over the subtree hashes.
+  std::vector<uint64_t> Signature;
+
+  CloneFingerprint() = default;
+
+  /// Computes the fingerprint of \p Seq with \p NumHashes hash functions.
+  ///
+  /// This method should only be called on a non-empty StmtSequence object.
+  CloneFingerprint(const StmtSequence &Seq, unsigned NumHashes);
+
+  /// Returns the fraction of equal entries in the signatures of this
+  /// fingerprint and \p Other, which must have as many entries.
+  double estimateSimilarity(const CloneFingerprint &Other) const;
+
+  /// Writes the fingerprint as a single line, without the line break.
+  ///
+  /// The line holds the number of entries in the signature, the entries in
+  /// hexadecimal, the begin and end lines and finally the file name, all
+  /// separated by a space.
+  void print(raw_ostream &OS) const;
+
+  /// Reads a fingerprint in the format that print() writes.
+  /// \return Returns false if \p Line is not a valid fingerprint.
+  static bool parse(StringRef Line, CloneFingerprint &Result);
+};
+
+/// This constraint moves clones with a similar structure into clone groups via
+/// locality-sensitive hashing of their fingerprints.
+///
+/// The signatures of the fingerprints are split into bands of a few entries,
+/// and two clones become candidates for the same group whenever one of their
+/// bands is equal. This finds the clones whose estimated similarity is at
+/// least the given one without comparing every clone with every other. Unlike
+/// the RecursiveCloneTypeIIHashConstraint, this constraint only looks at the
+/// passed sequences, not at their sub-statements, and it also finds clones
+/// that are not of type II.
+class MinHashCloneConstraint {
+  double MinSimilarity;
+  unsigned NumHashes;
+  unsigned RowsPerBand;
+
+public:
+  /// \param MinSimilarity The estimated similarity, between 0 and 1, that two
+  ///                      clones need to have to be in the same group.
+  /// \param NumHashes The number of entries in each signature.
+  /// \param RowsPerBand The number of signature entries in each band. Fewer
+  ///                    rows find less similar candidates, but make more
+  ///                    dissimilar ones collide.
+  MinHashCloneConstraint(double MinSimilarity = 0.8, unsigned NumHashes = 64,
+                         unsigned RowsPerBand = 4)
+      : MinSimilarity(MinSimilarity), NumHashes(NumHashes),
+        RowsPerBand(RowsPerBand) {
+    assert(RowsPerBand > 0 && NumHashes % RowsPerBand == 0 &&
+           "Signatures must split into whole bands");
+  }
+
+  void constrain(std::vector<CloneDetector::CloneGroup> &CloneGroups);
+
+  /// Groups the fingerprints that are similar to each other, which may come
+  /// from different translation units.
+  ///
+  /// A fingerprint is added to the group of a candidate when their estimated
+  /// similarity is at least the minimum similarity, so two fingerprints may
+  /// end up in the same group through a chain of similar ones.
+  ///
+  /// \return Returns the indices into \p Fingerprints of every group with at
+  ///         least two members, in increasing order.
+  std::vector<std::vector<unsigned>>
+  groupSimilar(ArrayRef<CloneFingerprint> Fingerprints) const;
+};
+
 /// Ensures that every clone has at least the given complexity.
 ///
 /// Complexity is here defined as the total amount of children of a statement.
@@ -0,0 +1,177 @@
+//===- BitVectorDataflow.h - Dense dataflow analyses over a CFG -*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines a worklist solver for dataflow analyses over source-level
+// CFGs whose values are dense bit vectors, merged with a bitwise OR.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_ANALYSIS_FLOWSENSITIVE_BITVECTORDATAFLOW_H
+#define LLVM_CLANG_ANALYSIS_FLOWSENSITIVE_BITVECTORDATAFLOW_H
+
+#include "clang/Analysis/Analyses/PostOrderCFGView.h"
+#include "clang/Analysis/CFG.h"
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/PriorityQueue.h"
+#include "llvm/ADT/SmallVector.h"
+#include <utility>
+#include <vector>
+
+namespace clang {
+
+/// The direction in which a dataflow analysis propagates its values.
+enum class DataflowDirection { Forward, Backward };
+
+/// A worklist of CFG blocks, which hands out the enqueued blocks in the order
+/// given by a PostOrderCFGView: in reverse post order for a forward analysis,
+/// so that a block is usually visited after all of its predecessors, and in
+/// post order for a backward one.
+class DataflowWorklist {
+  /// Orders the blocks in post order, or in reverse post order for a forward
+  /// analysis.
+  struct BlockOrderCompare {
+    PostOrderCFGView::BlockOrderCompare PostOrder;
+    bool Reversed;
+
+    bool operator()(const CFGBlock *LHS, const CFGBlock *RHS) const {
+      return Reversed ? PostOrder(RHS, LHS) : PostOrder(LHS, RHS);
+    }
+  };
+
+  llvm::BitVector EnqueuedBlocks;
+  DataflowDirection Direction;
+  llvm::PriorityQueue<const CFGBlock *, SmallVector<const CFGBlock *, 20>,
+                      BlockOrderCompare>
+      WorkList;
+
+public:
+  DataflowWorklist(const CFG &Cfg, const PostOrderCFGView &POV,
+                   DataflowDirection Direction);
+
+  void enqueueBlock(const CFGBlock *Block);
+
+  /// Enqueue the blocks whose value depends on the value of \p Block: its
+  /// successors in a forward analysis, and its predecessors in a backward one.
+  void enqueueDependents(const CFGBlock *Block);
+
+  /// Returns the next block to visit, or null if the worklist is empty.
+  const CFGBlock *dequeue();
+};
+
+/// Computes the fixed point of a dataflow analysis over a CFG.
+///
+/// \p ValueT is a dense bit vector, or a class wrapping one, that is merged
+/// with operator|= and compared with operator==. Every block starts out with
+/// the bottom value, except for the entry block of a forward analysis and the
+/// exit block of a backward one, which start out with the boundary value.
+///
+/// The solver keeps the value at both ends of every block, so that the values
+/// at the statements of a block can be recomputed from them when they are
+/// needed instead of being stored for every statement.
+template <typename ValueT> class BitVectorDataflow {
+  const CFG &Cfg;
+  const PostOrderCFGView &POV;
+  DataflowDirection Direction;
+  ValueT Bottom;
+  ValueT Boundary;
+
+  /// The values flowing into and out of each block in the direction of the
+  /// analysis, indexed by block ID.
+  std::vector<ValueT> InValues;
+  std::vector<ValueT> OutValues;
+
+  llvm::BitVector VisitedBlocks;
+  unsigned NumBlockVisits = 0;
+
+  bool isForward() const { return Direction == DataflowDirection::Forward; }
+
+public:
+  BitVectorDataflow(const CFG &Cfg, const PostOrderCFGView &POV,
+                    DataflowDirection Direction, const ValueT &Bottom)
+      : Cfg(Cfg), POV(POV), Direction(Direction), Bottom(Bottom),
+        Boundary(Bottom), InValues(Cfg.getNumBlockIDs(), Bottom),
+        OutValues(Cfg.getNumBlockIDs(), Bottom),
+        VisitedBlocks(Cfg.getNumBlockIDs()) {}
+
+  /// Set the value flowing into the entry block of a forward analysis, or
+  /// into the exit block of a backward one.
+  void setBoundaryValue(const ValueT &V) { Boundary = V; }
+
+  /// Iterate to a fixed point.
+  ///
+  /// \p Transfer is called as Transfer(const CFGBlock *Block, ValueT &Value)
+  /// with the value flowing into \p Block, and updates it to the value
+  /// flowing out of it. A forward analysis visits the blocks reachable from
+  /// the entry of the CFG; a backward one visits all of its blocks, since a
+  /// block that cannot be reached from the entry may still reach the exit.
+  template <typename TransferFn> void solve(TransferFn Transfer) {
+    DataflowWorklist Worklist(Cfg, POV, Direction);
+    if (isForward()) {
+      for (const CFGBlock *Block : POV)
+        Worklist.enqueueBlock(Block);
+    } else {
+      for (const CFGBlock *Block : Cfg)
+        Worklist.enqueueBlock(Block);
+    }
+
+    const CFGBlock *BoundaryBlock =
+        isForward() ? &Cfg.getEntry() : &Cfg.getExit();
+    while (const CFGBlock *Block = Worklist.dequeue()) {
+      unsigned ID = Block->getBlockID();
+      ValueT Value = Block == BoundaryBlock ? Boundary : Bottom;
+      if (isForward()) {
+        for (const CFGBlock *Pred : Block->preds())
+          if (Pred)
+            Value |= OutValues[Pred->getBlockID()];
+      } else {
+        for (const CFGBlock *Succ : Block->succs())
+          if (Succ)
+            Value |= OutValues[Succ->getBlockID()];
+      }
+
+      // Nothing changes unless the value flowing into the block did.
+      if (VisitedBlocks[ID] && Value == InValues[ID])
+        continue;
+      InValues[ID] = Value;
+
+      Transfer(Block, Value);
+      ++NumBlockVisits;
+      if (VisitedBlocks[ID] && Value == OutValues[ID])
+        continue;
+      VisitedBlocks.set(ID);
+      OutValues[ID] = std::move(Value);
+      Worklist.enqueueDependents(Block);
+    }
+  }
+
+  /// Returns the value flowing into \p Block, which is the value at its
+  /// start in a forward analysis and at its end in a backward one.
+  const ValueT &getInValue(const CFGBlock *Block) const {
+    return InValues[Block->getBlockID()];
+  }
+
+  /// Returns the value flowing out of \p Block, which is the value at its
+  /// end in a forward analysis and at its start in a backward one.
+  const ValueT &getOutValue(const CFGBlock *Block) const {
+    return OutValues[Block->getBlockID()];
+  }
+
+  /// Returns true if \p Block was visited while solving.
+  bool wasVisited(const CFGBlock *Block) const {
+    return VisitedBlocks[Block->getBlockID()];
+  }
+
+  /// Returns the number of times a transfer function was applied to a block.
+  unsigned getNumBlockVisits() const { return NumBlockVisits; }
+};
+
+} // namespace clang
+
+#endif // LLVM_CLANG_ANALYSIS_FLOWSENSITIVE_BITVECTORDATAFLOW_H
@@ -245,7 +245,10 @@ enum BuiltinTemplateKind : int {
   BTK__make_integer_seq,
 
   /// This names the __type_pack_element BuiltinTemplateDecl.
-  BTK__type_pack_element
+  BTK__type_pack_element,
+
+  /// This names the __type_pack_slice BuiltinTemplateDecl.
+  BTK__type_pack_slice
 };
 
 } // end namespace clang
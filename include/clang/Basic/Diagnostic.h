@@ -322,6 +322,7 @@ private:
       Files.clear();
       FirstDiagState = CurDiagState = nullptr;
       CurDiagStateLoc = SourceLocation();
+      LastLookupState = nullptr;
     }
 
     /// Produce a debugging dump of the diagnostic state.
@@ -371,6 +372,10 @@ private:
       llvm::SmallVector<DiagStatePoint, 4> StateTransitions;
 
       DiagState *lookup(unsigned Offset) const;
+
+      /// Like lookup(), but also returns the range of offsets [Begin, End)
+      /// over which the state is the same.
+      DiagState *lookup(unsigned Offset, unsigned &Begin, unsigned &End) const;
     };
 
     /// The diagnostic states for each file.
@@ -385,6 +390,16 @@ private:
     /// The location at which the current diagnostic state was established.
     SourceLocation CurDiagStateLoc;
 
+    /// The result of the last lookup, covering offsets [LastLookupBegin,
+    /// LastLookupEnd) of LastLookupFID. Diagnostics are usually queried at
+    /// nearby locations, so this spares most lookups the walk over the file
+    /// map and the transitions, which is costly in files with many pragmas.
+    /// Null if there is no usable result.
+    mutable DiagState *LastLookupState = nullptr;
+    mutable FileID LastLookupFID;
+    mutable unsigned LastLookupBegin = 0;
+    mutable unsigned LastLookupEnd = 0;
+
     /// Get the diagnostic state information for a file.
     File *getFile(SourceManager &SrcMgr, FileID ID) const;
   };
@@ -820,6 +835,18 @@ public:
            diag::Severity::Ignored;
   }
 
+  /// Determine whether the diagnostic is known to be ignored at every
+  /// location, taking all the diagnostic states established by pragmas so far
+  /// into account.
+  ///
+  /// Unlike \c isIgnored(), this does not depend on a location, so a check
+  /// that covers a large part of the source can be skipped with a single
+  /// query.  A false result does not mean that the diagnostic is emitted
+  /// anywhere.  The result only holds until the next diagnostic pragma.
+  bool isIgnoredEverywhere(unsigned DiagID) const {
+    return Diags->isIgnoredInEveryState(DiagID, *this);
+  }
+
   /// Based on the way the client configured the DiagnosticsEngine
   /// object, classify the specified diagnostic ID into a Level, consumable by
   /// the DiagnosticConsumer.
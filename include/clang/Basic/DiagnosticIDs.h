@@ -320,6 +320,9 @@ private:
   getDiagnosticSeverity(unsigned DiagID, SourceLocation Loc,
                         const DiagnosticsEngine &Diag) const LLVM_READONLY;
 
+  bool isIgnoredInEveryState(unsigned DiagID,
+                             const DiagnosticsEngine &Diag) const LLVM_READONLY;
+
   /// Used to report a diagnostic that is finally fully formed.
   ///
   /// \returns \c true if the diagnostic was emitted, \c false if it was
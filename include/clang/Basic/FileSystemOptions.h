@@ -25,6 +25,10 @@ public:
   /// If set, paths are resolved as if the working directory was
   /// set to the value of WorkingDir.
   std::string WorkingDir;
+
+  /// If set, the file in which stat results are shared between all of the
+  /// compiler processes of the current build session.
+  std::string BuildSessionStatCache;
 };
 
 } // end namespace clang
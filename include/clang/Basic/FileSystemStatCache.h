@@ -28,6 +28,8 @@
 
 namespace llvm {
 
+class MemoryBuffer;
+
 namespace vfs {
 
 class File;
@@ -143,6 +145,98 @@ public:
                        llvm::vfs::FileSystem &FS) override;
 };
 
+/// A stat cache that persists across all of the compiler processes that take
+/// part in one build session (see -fbuild-session-timestamp).
+///
+/// The cache is a single file that every process maps read-only.  It is only
+/// ever replaced as a whole, by an atomic rename, so parallel readers never
+/// see a partial update.  Each entry, positive or negative, records the
+/// modification time of its parent directory at the time it was made, and it
+/// is only trusted while that directory still has the same modification time.
+/// That costs one stat per directory per process instead of one per path.
+/// Adding, removing or renaming a file bumps its directory's modification
+/// time, so files appearing and disappearing are caught.  A file rewritten in
+/// place is assumed not to change within a build session, as with
+/// -fmodules-validate-once-per-build-session.
+///
+/// Only absolute paths are cached.
+class BuildSessionStatCache : public FileSystemStatCache {
+public:
+  /// What is known about a path.
+  struct Entry {
+    enum KindType : uint8_t {
+      /// A lookup for a file failed.
+      MissingFile,
+      /// A lookup for a directory failed.
+      MissingDirectory,
+      /// The path exists; Data is valid.
+      Exists
+    };
+
+    KindType Kind = MissingFile;
+
+    /// The modification time of the parent directory, in nanoseconds since
+    /// the epoch, or ~0 if the parent directory does not exist.
+    uint64_t DirModTime = 0;
+
+    uint64_t Size = 0;
+    time_t ModTime = 0;
+    llvm::sys::fs::UniqueID UniqueID;
+    bool IsDirectory = false;
+    bool IsNamedPipe = false;
+  };
+
+  class OnDiskTable;
+
+private:
+  std::string CacheFile;
+  uint64_t BuildSessionTimestamp;
+
+  /// The mapped cache file, if there was a valid one for this session.
+  std::unique_ptr<llvm::MemoryBuffer> Buffer;
+  std::unique_ptr<OnDiskTable> Table;
+
+  /// Entries that this process learned and that are not (correctly) in the
+  /// cache file yet.
+  llvm::StringMap<Entry, llvm::BumpPtrAllocator> NewEntries;
+
+  /// The current modification time of each directory that entries have been
+  /// validated against, using the encoding of Entry::DirModTime.
+  llvm::StringMap<uint64_t> DirModTimes;
+
+  unsigned NumHits = 0;
+  unsigned NumMisses = 0;
+
+  BuildSessionStatCache(StringRef CacheFile, uint64_t BuildSessionTimestamp);
+
+  uint64_t getDirModTime(StringRef Dir, llvm::vfs::FileSystem &FS);
+
+public:
+  ~BuildSessionStatCache() override;
+
+  /// Open the stat cache stored in \p CacheFile for the build session that
+  /// started at \p BuildSessionTimestamp.  A missing cache file, or one left
+  /// over from a different session, yields an empty cache.
+  static std::unique_ptr<BuildSessionStatCache>
+  create(StringRef CacheFile, uint64_t BuildSessionTimestamp);
+
+  LookupResult getStat(StringRef Path, FileData &Data, bool isFile,
+                       std::unique_ptr<llvm::vfs::File> *F,
+                       llvm::vfs::FileSystem &FS) override;
+
+  /// Merge the entries learned by this process with the ones already in the
+  /// cache file, and atomically replace the cache file with the result.
+  ///
+  /// \returns true on error.
+  bool writeToDisk();
+
+  /// The number of lookups that were answered from the cache file.
+  unsigned getNumHits() const { return NumHits; }
+
+  /// The number of lookups that had to go to the file system.
+  unsigned getNumMisses() const { return NumMisses; }
+};
+
 } // namespace clang
 
 #endif // LLVM_CLANG_BASIC_FILESYSTEMSTATCACHE_H
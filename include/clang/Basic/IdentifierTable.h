@@ -592,6 +592,11 @@ public:
 
   iterator begin() const { return HashTable.begin(); }
   iterator end() const   { return HashTable.end(); }
+
+  /// Returns the identifier called \p Name if the table has one, or end()
+  /// otherwise.  Unlike get(), this neither creates the identifier nor asks
+  /// the external identifier lookup for it.
+  iterator find(StringRef Name) const { return HashTable.find(Name); }
   unsigned size() const  { return HashTable.size(); }
 
   /// Print some statistics to stderr that indicate how well the
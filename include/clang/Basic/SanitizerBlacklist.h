@@ -19,6 +19,8 @@
 #include "clang/Basic/Sanitizers.h"
 #include "clang/Basic/SourceLocation.h"
 #include "clang/Basic/SourceManager.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include <memory>
 
@@ -28,6 +30,11 @@ class SanitizerBlacklist {
   std::unique_ptr<SanitizerSpecialCaseList> SSCL;
   SourceManager &SM;
 
+  /// The sanitizers that each file is blacklisted for, by category. Locations
+  /// are looked up once per function and global, and are usually in one of a
+  /// few files.
+  mutable llvm::StringMap<llvm::DenseMap<FileID, SanitizerMask>> FileKinds;
+
 public:
   SanitizerBlacklist(const std::vector<std::string> &BlacklistPaths,
                      SourceManager &SM);
@@ -40,6 +47,16 @@ public:
                          StringRef Category = StringRef()) const;
   bool isBlacklistedLocation(SanitizerMask Mask, SourceLocation Loc,
                              StringRef Category = StringRef()) const;
+
+  /// Return the sanitizers in \p Mask that \p FunctionName is blacklisted
+  /// for. This matches the function name once for all of them.
+  SanitizerMask getBlacklistedFunctionKinds(SanitizerMask Mask,
+                                            StringRef FunctionName) const;
+  /// Return the sanitizers in \p Mask that the file containing \p Loc is
+  /// blacklisted for.
+  SanitizerMask getBlacklistedLocationKinds(
+      SanitizerMask Mask, SourceLocation Loc,
+      StringRef Category = StringRef()) const;
 };
 
 }  // end namespace clang
@@ -34,6 +34,13 @@ public:
   bool inSection(SanitizerMask Mask, StringRef Prefix, StringRef Query,
                  StringRef Category = StringRef()) const;
 
+  // Return the sanitizers in Mask for which the entry is blacklisted, matching
+  // each section at most once. Sections that could only add sanitizers that
+  // are already in the result are not matched at all.
+  SanitizerMask inSections(SanitizerMask Mask, StringRef Prefix,
+                           StringRef Query,
+                           StringRef Category = StringRef()) const;
+
 protected:
   // Initialize SanitizerSections.
   void createSanitizerSections();
@@ -0,0 +1,120 @@
+//===--- TimeTraceProfiler.h - Hierarchical compile time trace --*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Defines a profiler that records how long the frontend spends in nested
+/// units of work, such as template instantiations, and writes them out in the
+/// Chrome trace event format, together with a summary of where the time went.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_BASIC_TIMETRACEPROFILER_H
+#define LLVM_CLANG_BASIC_TIMETRACEPROFILER_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace clang {
+
+class TimeTraceProfiler;
+
+/// The active profiler, or null if time tracing is disabled.
+extern TimeTraceProfiler *TimeTraceProfilerInstance;
+
+/// Start recording events.
+///
+/// \param GranularityInMicroseconds events shorter than this are left out of
+/// the trace, although they are still counted in the summary.
+void timeTraceProfilerInitialize(unsigned GranularityInMicroseconds);
+
+/// Stop recording events and discard the ones recorded.
+void timeTraceProfilerCleanup();
+
+/// Determine whether events are being recorded.
+inline bool timeTraceProfilerEnabled() {
+  return TimeTraceProfilerInstance != nullptr;
+}
+
+/// Write the recorded events and the summary to \p OS as JSON.
+void timeTraceProfilerWrite(raw_ostream &OS);
+
+/// Set the function used to sample the number of bytes allocated so far, or
+/// clear it if \p Counter is empty. Each event records how many bytes were
+/// allocated while it was active.
+///
+/// \returns the function that was set before, so that it can be restored.
+std::function<size_t()>
+timeTraceProfilerSetAllocationCounter(std::function<size_t()> Counter);
+
+/// The rows of the trace. Events on different tracks nest independently of
+/// each other.
+enum TimeTraceTrack {
+  /// The units of work done by the compiler, such as parsing a declaration or
+  /// instantiating a template.
+  TTT_Compilation,
+
+  /// The source files being lexed. The parser's lookahead can enter or leave
+  /// a file in the middle of a declaration, so these don't nest properly
+  /// with the events on the compilation track.
+  TTT_Sources,
+
+  TTT_NumTracks
+};
+
+/// Begin an event named \p Name, which nests inside the events on the same
+/// track that have begun but not yet ended.
+///
+/// \param Detail describes what the event works on, such as the particular
+/// template specialization being instantiated.
+///
+/// \param Group is what the summary attributes the cost of the event to,
+/// such as the template that is being instantiated. If empty, the event is
+/// only counted in the total for \p Name.
+void timeTraceProfilerBegin(StringRef Name, std::string Detail,
+                            std::string Group,
+                            TimeTraceTrack Track = TTT_Compilation);
+
+/// End the most recently begun event on \p Track.
+void timeTraceProfilerEnd(TimeTraceTrack Track = TTT_Compilation);
+
+/// RAII object that records an event for its lifetime, if time tracing is
+/// enabled. The description of the event is only computed if it is.
+class TimeTraceScope {
+  bool Active;
+
+public:
+  TimeTraceScope(StringRef Name, llvm::function_ref<std::string()> Detail)
+      : Active(timeTraceProfilerEnabled()) {
+    if (Active)
+      timeTraceProfilerBegin(Name, Detail(), std::string());
+  }
+
+  TimeTraceScope(StringRef Name, llvm::function_ref<std::string()> Detail,
+                 llvm::function_ref<std::string()> Group)
+      : Active(timeTraceProfilerEnabled()) {
+    if (Active)
+      timeTraceProfilerBegin(Name, Detail(), Group());
+  }
+
+  TimeTraceScope(const TimeTraceScope &) = delete;
+  TimeTraceScope &operator=(const TimeTraceScope &) = delete;
+
+  ~TimeTraceScope() {
+    if (Active)
+      timeTraceProfilerEnd();
+  }
+};
+
+} // end namespace clang
+
+#endif // LLVM_CLANG_BASIC_TIMETRACEPROFILER_H
@@ -17,6 +17,8 @@
 #include "clang/Basic/SourceLocation.h"
 #include "clang/Basic/SourceManager.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/SpecialCaseList.h"
 #include <memory>
@@ -30,10 +32,6 @@ class XRayFunctionFilter {
   SourceManager &SM;
 
 public:
-  XRayFunctionFilter(ArrayRef<std::string> AlwaysInstrumentPaths,
-                     ArrayRef<std::string> NeverInstrumentPaths,
-                     ArrayRef<std::string> AttrListPaths, SourceManager &SM);
-
   enum class ImbueAttribute {
     NONE,
     ALWAYS,
@@ -41,6 +39,15 @@ public:
     ALWAYS_ARG1,
   };
 
+private:
+  /// The result of shouldImbueLocation for each file, by category.
+  mutable llvm::StringMap<llvm::DenseMap<FileID, ImbueAttribute>> FileAttrs;
+
+public:
+  XRayFunctionFilter(ArrayRef<std::string> AlwaysInstrumentPaths,
+                     ArrayRef<std::string> NeverInstrumentPaths,
+                     ArrayRef<std::string> AttrListPaths, SourceManager &SM);
+
   ImbueAttribute shouldImbueFunction(StringRef FunctionName) const;
 
   ImbueAttribute
@@ -20,17 +20,27 @@
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Error.h"
+#include <list>
+
+namespace llvm {
+class Timer;
+}
 
 namespace clang {
 class CompilerInstance;
 class ASTContext;
 class ASTImporter;
+class ASTImporterLookupTable;
 class ASTUnit;
 class DeclContext;
 class FunctionDecl;
 class NamedDecl;
 class TranslationUnitDecl;
 
+namespace tooling {
+class CompilationDatabase;
+}
+
 namespace cross_tu {
 
 enum class index_error_code {
@@ -41,7 +51,9 @@ enum class index_error_code {
   missing_definition,
   failed_import,
   failed_to_get_external_ast,
-  failed_to_generate_usr
+  failed_to_generate_usr,
+  failed_to_load_compilation_database,
+  missing_compile_command
 };
 
 class IndexError : public llvm::ErrorInfo<IndexError> {
@@ -75,6 +87,17 @@ parseCrossTUIndex(StringRef IndexPath, StringRef CrossTUDir);
 
 std::string createCrossTUIndexString(const llvm::StringMap<std::string> &Index);
 
+/// Writes \p Index into \p IndexPath as a binary index file.
+///
+/// A binary index file is an on-disk hash table from USRs to file paths. It
+/// is mapped into memory and looked up entry by entry, so unlike a text index
+/// it does not have to be read whole before the first lookup. Wherever a text
+/// index file is accepted, a binary one can be used instead.
+llvm::Error writeCrossTUBinaryIndex(const llvm::StringMap<std::string> &Index,
+                                    StringRef IndexPath);
+
+class CrossTUBinaryIndex;
+
 /// This class is used for tools that requires cross translation
 ///        unit capability.
 ///
@@ -84,7 +107,15 @@ std::string createCrossTUIndexString(const llvm::StringMap<std::string> &Index);
 /// In order to use this class, an index file is required that describes
 /// the locations of the AST files for each function definition.
 ///
-/// Note that this class also implements caching.
+/// Note that this class also implements caching. The loaded AST files are
+/// kept in memory until their total size exceeds the limit set by
+/// setMaxLoadedASTSize(), when the least recently used ones are unloaded.
+/// The definitions imported from an unloaded AST file are still returned
+/// without loading it again.
+///
+/// The index may also name source files instead of AST files, if a
+/// compilation database is set with setOnDemandParsing(). These are parsed
+/// when a definition is first looked up in them.
 class CrossTranslationUnitContext {
 public:
   CrossTranslationUnitContext(CompilerInstance &CI);
@@ -139,18 +170,67 @@ public:
   /// Emit diagnostics for the user for potential configuration errors.
   void emitCrossTUDiagnostics(const IndexError &IE);
 
+  /// Limit the memory used by the loaded AST files to \p Bytes. A limit of
+  /// zero means that no AST file is ever unloaded.
+  void setMaxLoadedASTSize(uint64_t Bytes) { MaxLoadedASTSize = Bytes; }
+
+  /// Parse the source files named in the index with the commands listed for
+  /// them in \p CompilationDatabase, which is a compile_commands.json file or
+  /// the directory containing one. The entries of the index that end in
+  /// ".ast" are still loaded as AST files. If \p ASTCacheDir is not empty, the
+  /// parsed ASTs are saved there, and loaded instead of parsed while their
+  /// source files and headers do not change.
+  void setOnDemandParsing(StringRef CompilationDatabase,
+                          StringRef ASTCacheDir) {
+    CompilationDatabasePath = CompilationDatabase;
+    this->ASTCacheDir = ASTCacheDir;
+  }
+
+  /// Time the imports of definitions with \p T, if it is not null.
+  void setImportTimer(llvm::Timer *T) { ImportTimer = T; }
+
 private:
+  /// An AST file loaded into memory.
+  struct LoadedASTUnit {
+    std::unique_ptr<ASTUnit> Unit;
+    /// The size of the AST file, which stays in memory while it is loaded, or
+    /// for a unit parsed from source the memory held by its preprocessor.
+    uint64_t FileSize = 0;
+    /// The position of the file in ASTUnitUseOrder.
+    std::list<StringRef>::iterator UsePosition;
+  };
+
   ASTImporter &getOrCreateASTImporter(ASTContext &From);
   const FunctionDecl *findFunctionInDeclContext(const DeclContext *DC,
                                                 StringRef LookupFnName);
-
-  llvm::StringMap<std::unique_ptr<clang::ASTUnit>> FileASTUnitMap;
-  llvm::StringMap<clang::ASTUnit *> FunctionASTUnitMap;
+  std::unique_ptr<ASTUnit> loadFromASTFile(StringRef ASTFileName,
+                                           bool ReportErrors);
+  llvm::Expected<std::unique_ptr<ASTUnit>>
+  parseSourceFile(StringRef SourceFileName, uint64_t &ASTFileSize);
+  uint64_t getLoadedASTSize() const;
+  void unloadLeastRecentlyUsedASTUnits();
+
+  llvm::StringMap<LoadedASTUnit> FileASTUnitMap;
+  /// The names of the loaded AST files, the most recently used one first.
+  std::list<StringRef> ASTUnitUseOrder;
+  /// The definitions imported so far, by lookup name.
+  llvm::StringMap<const FunctionDecl *> ImportedFunctionMap;
   llvm::StringMap<std::string> FunctionFileMap;
+  /// The index, if it is a binary index file. FunctionFileMap is not used
+  /// then.
+  std::unique_ptr<CrossTUBinaryIndex> BinaryIndex;
   llvm::DenseMap<TranslationUnitDecl *, std::unique_ptr<ASTImporter>>
       ASTUnitImporterMap;
+  /// The lookup table of the current translation unit, which all importers
+  /// share.
+  std::unique_ptr<ASTImporterLookupTable> ImporterLookupTable;
   CompilerInstance &CI;
   ASTContext &Context;
+  std::string CompilationDatabasePath;
+  std::string ASTCacheDir;
+  std::unique_ptr<tooling::CompilationDatabase> CompilationDB;
+  uint64_t MaxLoadedASTSize = 0;
+  llvm::Timer *ImportTimer = nullptr;
 };
 
 } // namespace cross_tu
@@ -125,6 +125,19 @@ class Compilation {
   /// Whether to keep temporary files regardless of -save-temps.
   bool ForceKeepTempFiles = false;
 
+  /// Print \p C to \p OS for -v or CC_PRINT_OPTIONS, if requested.
+  ///
+  /// \return Whether the CC_PRINT_OPTIONS log, if any, could be opened.
+  bool PrintCommand(const Command &C, raw_ostream &OS) const;
+
+  /// Execute \p Jobs on up to \p NumThreads threads, starting each job
+  /// once the jobs producing its inputs have finished. The output of each
+  /// job is captured and printed in job order.
+  void ExecuteJobsInParallel(
+      const JobList &Jobs,
+      SmallVectorImpl<std::pair<int, const Command *>> &FailingCommands,
+      unsigned NumThreads) const;
+
 public:
   Compilation(const Driver &D, const ToolChain &DefaultToolChain,
               llvm::opt::InputArgList *Args,
@@ -281,6 +294,9 @@ public:
 
   /// ExecuteJob - Execute a single job.
   ///
+  /// With -parallel-jobs=<N>, up to N independent jobs run at once. CUDA and
+  /// HIP compilations run their independent jobs at once by default.
+  ///
   /// \param FailingCommands - For non-zero results, this will be a vector of
   /// failing commands and their associated result code.
   void ExecuteJobs(
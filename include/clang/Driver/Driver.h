@@ -235,6 +235,14 @@ public:
   /// or when using the -gen-reproducer driver flag.
   unsigned GenReproducer : 1;
 
+  /// Pointer to the -cc1 entry point of the driver executable, which takes
+  /// the full argument vector of the job with \c -cc1 in position one.
+  typedef int (*CC1ToolFunc)(ArrayRef<const char *> Argv);
+
+  /// If set, -cc1 jobs are run by calling this function in the driver's
+  /// process instead of spawning a new process for each one.
+  CC1ToolFunc CC1Main = nullptr;
+
 private:
   /// Certain options suppress the 'no input files' warning.
   unsigned SuppressMissingInputWarning : 1;
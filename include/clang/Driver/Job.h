@@ -74,6 +74,15 @@ class Command {
   /// See Command::setEnvironment
   std::vector<const char *> Environment;
 
+protected:
+  /// Whether the job runs in the driver's process rather than in a new one.
+  /// Only CC1Command can do so.
+  bool InProcess = false;
+
+  /// Print the input filenames, if PrintInputFilenames is set.
+  void PrintFileNames() const;
+
+private:
   /// When a response file is needed, we try to put most arguments in an
   /// exclusive file, while others remains as regular command line arguments.
   /// This functions fills a vector with the regular command line arguments,
@@ -131,6 +140,12 @@ public:
 
   /// Set whether to print the input filenames when executing.
   void setPrintInputFilenames(bool P) { PrintInputFilenames = P; }
+
+  bool isInProcess() const { return InProcess; }
+
+  /// Make a job that would run in the driver's process spawn a new one
+  /// instead.
+  void disableInProcess() { InProcess = false; }
 };
 
 /// Like Command, but with a fallback which is executed in case
@@ -168,6 +183,19 @@ public:
               bool *ExecutionFailed) const override;
 };
 
+/// Like Command, but a -cc1 job which the driver runs in its own process
+/// through Driver::CC1Main, recovering from crashes with a
+/// CrashRecoveryContext.
+class CC1Command : public Command {
+public:
+  CC1Command(const Action &Source, const Tool &Creator, const char *Executable,
+             const llvm::opt::ArgStringList &Arguments,
+             ArrayRef<InputInfo> Inputs);
+
+  int Execute(ArrayRef<Optional<StringRef>> Redirects, std::string *ErrMsg,
+              bool *ExecutionFailed) const override;
+};
+
 /// JobList - A sequence of jobs to perform.
 class JobList {
 public:
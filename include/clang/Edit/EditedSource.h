@@ -86,6 +86,21 @@ public:
 
   bool commit(const Commit &commit);
 
+  /// Commit all of \p Commits, with the same result as committing each of
+  /// them in order.
+  ///
+  /// When the commits only insert and remove text, and their edits neither
+  /// overlap each other nor any earlier edit, all edits are checked and merged
+  /// into the edit map in one sorted pass, and macro argument uses are only
+  /// looked up once per edit.  Otherwise the commits are committed one by one.
+  ///
+  /// Note that each commit only checked its own edits against the edits that
+  /// were committed when it was built, so batching is meant for commits that
+  /// leave each other's source ranges alone.
+  ///
+  /// \returns false if any of the commits was not commitable.
+  bool commitBatch(ArrayRef<Commit> Commits);
+
   void applyRewrites(EditsReceiver &receiver, bool adjustRemovals = true);
   void clearRewrites();
 
@@ -99,6 +114,10 @@ private:
                              FileOffset InsertFromRangeOffs, unsigned Len,
                              bool beforePreviousInsertions);
   void commitRemove(SourceLocation OrigLoc, FileOffset BeginOffs, unsigned Len);
+  bool tryCommitBatchInBulk(ArrayRef<Commit> Commits);
+  bool conflictsWithMacroArgUse(
+      const llvm::DenseMap<unsigned, SmallVector<MacroArgUse, 2>> &Uses,
+      SourceLocation ExpLoc, const MacroArgUse &ArgUse) const;
 
   StringRef getSourceText(FileOffset BeginOffs, FileOffset EndOffs,
                           bool &Invalid);
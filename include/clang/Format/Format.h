@@ -20,6 +20,7 @@
 #include "clang/Tooling/Inclusions/IncludeStyle.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/Support/Regex.h"
+#include <memory>
 #include <system_error>
 
 namespace llvm {
@@ -1967,6 +1968,37 @@ tooling::Replacements reformat(const FormatStyle &Style, StringRef Code,
                                StringRef FileName,
                                bool *IncompleteFormat);
 
+/// Reformats ranges of successive versions of one file, as an editor does
+/// that formats code while it is typed.
+///
+/// The formatter remembers the points of the last version of the file at
+/// which it can be split without changing how either part is formatted:
+/// the starts of top-level declarations, outside of any block but namespaces,
+/// that follow a blank line. For a later version, it lexes and parses only the
+/// code between the closest such points around the changes and around the
+/// ranges to format, and returns the same replacements as \c reformat().
+/// Whenever the points cannot be trusted, the whole file is reformatted.
+///
+/// Only C++ styles that derive nothing from the file as a whole, that is with
+/// ``DerivePointerAlignment`` off and ``Standard`` other than ``Auto``, and
+/// that neither indent nor compact namespaces are formatted incrementally.
+class IncrementalFormatter {
+public:
+  IncrementalFormatter(const FormatStyle &Style,
+                       StringRef FileName = "<stdin>");
+  ~IncrementalFormatter();
+
+  /// Reformats the given \p Ranges in \p Code, the current version of the
+  /// file, like \c reformat().
+  tooling::Replacements reformat(StringRef Code,
+                                 ArrayRef<tooling::Range> Ranges,
+                                 FormattingAttemptStatus *Status = nullptr);
+
+private:
+  class Impl;
+  std::unique_ptr<Impl> State;
+};
+
 /// Clean up any erroneous/redundant code in the given \p Ranges in \p
 /// Code.
 ///
@@ -2013,6 +2045,8 @@ extern const char *DefaultFormatStyle;
 /// Different builds can modify the value to the preferred styles.
 extern const char *DefaultFallbackStyle;
 
+class FormatStyleCache;
+
 /// Construct a FormatStyle based on ``StyleName``.
 ///
 /// ``StyleName`` can take several forms:
@@ -2033,6 +2067,8 @@ extern const char *DefaultFallbackStyle;
 /// language if the filename isn't sufficient.
 /// \param[in] FS The underlying file system, in which the file resides. By
 /// default, the file system is the real file system.
+/// \param[in] Cache If given, the configuration files found and parsed so far
+/// for ``FS`` are reused from it and new ones are added to it.
 ///
 /// \returns FormatStyle as specified by ``StyleName``. If ``StyleName`` is
 /// "file" and no file is found, returns ``FallbackStyle``. If no style could be
@@ -2040,7 +2076,31 @@ extern const char *DefaultFallbackStyle;
 llvm::Expected<FormatStyle> getStyle(StringRef StyleName, StringRef FileName,
                                      StringRef FallbackStyle,
                                      StringRef Code = "",
-                                     llvm::vfs::FileSystem *FS = nullptr);
+                                     llvm::vfs::FileSystem *FS = nullptr,
+                                     FormatStyleCache *Cache = nullptr);
+
+/// Remembers which configuration files ``getStyle`` found in which
+/// directories, and the styles it parsed from them, so that programs looking
+/// up the style of many files don't search for and parse the same files over
+/// and over.
+///
+/// Before anything is reused, the modification times of the directory and the
+/// configuration file are checked, so that changes to them are picked up. A
+/// cache may be shared between threads, but must only be used with one file
+/// system.
+class FormatStyleCache {
+public:
+  FormatStyleCache();
+  ~FormatStyleCache();
+
+private:
+  struct Entries;
+  std::unique_ptr<Entries> Impl;
+
+  friend llvm::Expected<FormatStyle>
+  getStyle(StringRef StyleName, StringRef FileName, StringRef FallbackStyle,
+           StringRef Code, llvm::vfs::FileSystem *FS, FormatStyleCache *Cache);
+};
 
 // Guesses the language from the ``FileName`` and ``Code`` to be formatted.
 // Defaults to FormatStyle::LK_Cpp.
@@ -39,9 +39,11 @@
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/iterator_range.h"
+#include <atomic>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <map>
 #include <memory>
 #include <string>
 #include <utility>
@@ -159,6 +161,9 @@ private:
   /// Whether the ASTUnit should delete the remapped buffers.
   bool OwnsRemappedFileBuffers = true;
 
+  /// If set, the flag through which the client abandons a parse.
+  const std::atomic<bool> *CancellationFlag = nullptr;
+
   /// Track the top-level decls which appeared in an ASTUnit which was loaded
   /// from a source file.
   //
@@ -208,6 +213,11 @@ private:
   /// some number of calls.
   unsigned PreambleRebuildCounter = 0;
 
+  /// The number of times a precompiled preamble was built, and the number of
+  /// times one was reused instead, over the lifetime of this unit.
+  unsigned NumPreambleBuilds = 0;
+  unsigned NumPreambleReuses = 0;
+
   /// Cache pairs "filename - source location"
   ///
   /// Cache contains only source locations from preamble so it is
@@ -328,6 +338,42 @@ private:
   /// type, which is used for type equality comparisons.
   llvm::StringMap<unsigned> CachedCompletionTypes;
 
+  /// The cached code-completion results for the declarations of one
+  /// submodule of an imported module file.
+  struct ModuleCompletionCache {
+    /// The allocator that owns the completion strings of the results.
+    std::shared_ptr<GlobalCodeCompletionAllocator> Allocator;
+
+    /// The cached results; their types are numbered by \c Types.
+    std::vector<CachedCodeCompletionResult> Results;
+
+    /// A mapping from the formatted type names of the results to the
+    /// numbers that their \c Type fields use.
+    llvm::StringMap<unsigned> Types;
+
+    /// The largest type number in use.
+    unsigned NumTypes = 0;
+
+    /// A hash of the declarations that the results were built for.
+    ///
+    /// Which submodule owns a merged declaration can change between
+    /// gatherings, so the results are only reused when the declarations
+    /// gathered for the submodule are the same.
+    size_t DeclsHash = 0;
+
+    /// True once every result of the submodule has been cached.
+    bool Complete = false;
+  };
+
+  /// The cached code-completion results of the imported modules, keyed by
+  /// the signature of the module file and the full name of the submodule.
+  ///
+  /// Unlike the rest of the cached results, these survive reparses and
+  /// rebuilds of the preamble. CacheCodeCompletionResults() merges them into
+  /// \c CachedCompletionResults.
+  std::map<std::pair<ASTFileSignature, std::string>, ModuleCompletionCache>
+      ModuleCompletionCaches;
+
   /// A string hash of the top-level declaration and macro definition
   /// names processed the last time that we reparsed the file.
   ///
@@ -421,6 +467,15 @@ public:
   bool isUnsafeToFree() const { return UnsafeToFree; }
   void setUnsafeToFree(bool Value) { UnsafeToFree = Value; }
 
+  /// Set the flag that abandons the parses done by later calls to Reparse().
+  ///
+  /// Once the flag is set, parsing stops at the next top-level declaration
+  /// and the reparse fails. The unit can be reparsed again after the flag
+  /// is cleared.
+  void setCancellationFlag(const std::atomic<bool> *Flag) {
+    CancellationFlag = Flag;
+  }
+
   const DiagnosticsEngine &getDiagnostics() const { return *Diagnostics; }
   DiagnosticsEngine &getDiagnostics() { return *Diagnostics; }
 
@@ -597,6 +652,9 @@ public:
 
   unsigned stored_diag_size() const { return StoredDiagnostics.size(); }
 
+  /// Returns the memory held by the stored diagnostics, approximately.
+  size_t getStoredDiagnosticsMemory() const;
+
   stored_diag_iterator stored_diag_afterDriver_begin() {
     if (NumStoredDiagnosticsFromDriver > StoredDiagnostics.size())
       NumStoredDiagnosticsFromDriver = 0;
@@ -634,6 +692,17 @@ public:
   /// \returns true if the iteration was complete or false if it was aborted.
   bool visitLocalTopLevelDecls(void *context, DeclVisitorFn Fn);
 
+  /// Returns the size, in bytes, that the precompiled preamble takes in
+  /// memory or on disk, or 0 if there is no preamble.
+  size_t getPreambleSize() const;
+
+  /// Returns how many times a precompiled preamble was built for this unit.
+  unsigned getNumPreambleBuilds() const { return NumPreambleBuilds; }
+
+  /// Returns how many times parsing, reparsing or code completion reused the
+  /// precompiled preamble instead of building one.
+  unsigned getNumPreambleReuses() const { return NumPreambleReuses; }
+
   /// Get the PCH file if one was included.
   const FileEntry *getPCHFile();
 
@@ -845,6 +914,15 @@ public:
   /// Preamble-related data is not affected.
   void ResetForParse();
 
+  /// Release memory that a parsed translation unit does not need in order
+  /// to answer queries about its AST.
+  ///
+  /// This drops the cached code-completion results, which are rebuilt on the
+  /// next reparse (code completion falls back to asking Sema for global
+  /// results in the meantime), and the preprocessor's token caches. The AST,
+  /// the macro definitions and the stored diagnostics are kept.
+  void compact();
+
   /// Perform code completion at the given file, line, and
   /// column within this translation unit.
   ///
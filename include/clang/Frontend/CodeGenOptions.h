@@ -184,6 +184,11 @@ public:
   /// in the backend for setting the name in the skeleton cu.
   std::string SplitDwarfFile;
 
+  /// The files to write the object code for all but the first partition of
+  /// the module to, when code generation runs on partitions of the module
+  /// in parallel. The first partition goes to the main output.
+  std::vector<std::string> ParallelCodeGenOutputs;
+
   /// The name of the relocation model to use.
   llvm::Reloc::Model RelocationModel;
 
@@ -23,6 +23,7 @@
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/BuryPointer.h"
+#include <atomic>
 #include <cassert>
 #include <list>
 #include <memory>
@@ -38,6 +39,7 @@ class TimerGroup;
 namespace clang {
 class ASTContext;
 class ASTReader;
+class BuildSessionStatCache;
 class CodeCompleteConsumer;
 class DiagnosticsEngine;
 class DiagnosticConsumer;
@@ -45,6 +47,7 @@ class ExternalASTSource;
 class FileEntry;
 class FileManager;
 class FrontendAction;
+class HeaderCostCollector;
 class MemoryBufferCache;
 class Module;
 class Preprocessor;
@@ -89,6 +92,10 @@ class CompilerInstance : public ModuleLoader {
   /// The file manager.
   IntrusiveRefCntPtr<FileManager> FileMgr;
 
+  /// The build session stat cache installed in FileMgr, if any.  It is owned
+  /// by FileMgr.
+  BuildSessionStatCache *SessionStatCache = nullptr;
+
   /// The source manager.
   IntrusiveRefCntPtr<SourceManager> SourceMgr;
 
@@ -104,6 +111,10 @@ class CompilerInstance : public ModuleLoader {
   /// An optional sema source that will be attached to sema.
   IntrusiveRefCntPtr<ExternalSemaSource> ExternalSemaSrc;
 
+  /// An optional flag through which the client can abandon the translation
+  /// unit; it is passed on to sema.
+  const std::atomic<bool> *CancellationFlag = nullptr;
+
   /// The AST consumer.
   std::unique_ptr<ASTConsumer> Consumer;
 
@@ -131,6 +142,9 @@ class CompilerInstance : public ModuleLoader {
   /// The dependency file generator.
   std::unique_ptr<DependencyFileGenerator> TheDependencyFileGenerator;
 
+  /// The collector of the costs of each header, for -header-cost-file.
+  std::unique_ptr<HeaderCostCollector> TheHeaderCostCollector;
+
   std::vector<std::shared_ptr<DependencyCollector>> DependencyCollectors;
 
   /// The set of top-level modules that has already been loaded,
@@ -414,11 +428,18 @@ public:
   void resetAndLeakFileManager() {
     llvm::BuryPointer(FileMgr.get());
     FileMgr.resetWithoutRelease();
+    SessionStatCache = nullptr;
   }
 
   /// Replace the current file manager and virtual file system.
   void setFileManager(FileManager *Value);
 
+  /// Return the build session stat cache used by the current file manager,
+  /// or null if there is none.
+  BuildSessionStatCache *getBuildSessionStatCache() const {
+    return SessionStatCache;
+  }
+
   /// }
   /// @name Source Manager
   /// {
@@ -460,6 +481,12 @@ public:
   /// Replace the current preprocessor.
   void setPreprocessor(std::shared_ptr<Preprocessor> Value);
 
+  /// Return the collector of the costs of each header of the current
+  /// translation unit, or null if they are not being collected.
+  HeaderCostCollector *getHeaderCostCollector() const {
+    return TheHeaderCostCollector.get();
+  }
+
   /// }
   /// @name ASTContext
   /// {
@@ -515,6 +542,12 @@ public:
   std::unique_ptr<Sema> takeSema();
   void resetAndLeakSema();
 
+  /// Set the flag that, once it is set, makes sema stop parsing at the next
+  /// top-level declaration. It must stay alive while the instance parses.
+  void setCancellationFlag(const std::atomic<bool> *Flag) {
+    CancellationFlag = Flag;
+  }
+
   /// }
   /// @name Module Management
   /// {
@@ -32,6 +32,9 @@ public:
                                      /// problems.
   unsigned AddMissingHeaderDeps : 1; ///< Add missing headers to dependency list
   unsigned IncludeModuleFiles : 1; ///< Include module file dependencies.
+  unsigned DependencyDirectivesOnly : 1; ///< Only lex the directives that can
+                                         /// affect dependencies; the rest of
+                                         /// each file is thrown away.
 
   /// Destination of cl.exe style /showIncludes info.
   ShowIncludesDestination ShowIncludesDest = ShowIncludesDestination::None;
@@ -61,13 +64,17 @@ public:
   /// The file to write GraphViz-formatted header dependencies to.
   std::string DOTOutputFile;
 
+  /// The file to write the costs attributed to each header to, in JSON.
+  std::string HeaderCostOutputFile;
+
   /// The directory to copy module dependencies to when collecting them.
   std::string ModuleDependencyOutputDir;
 
 public:
   DependencyOutputOptions()
       : IncludeSystemHeaders(0), ShowHeaderIncludes(0), UsePhonyTargets(0),
-        AddMissingHeaderDeps(0), IncludeModuleFiles(0) {}
+        AddMissingHeaderDeps(0), IncludeModuleFiles(0),
+        DependencyDirectivesOnly(0) {}
 };
 
 }  // end namespace clang
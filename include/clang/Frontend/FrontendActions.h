@@ -261,6 +261,18 @@ protected:
   void ExecuteAction() override;
 };
 
+/// Preprocess the input and print a key for caching the result of compiling
+/// it, followed by the files the key depends on.
+///
+/// The key hashes the preprocessed token stream, the source lines tokens
+/// come from, pragmas, the options that affect code generation, and the
+/// signatures of the modules that were imported. It does not render the
+/// preprocessed text.
+class PrintCacheKeyAction : public PreprocessorFrontendAction {
+protected:
+  void ExecuteAction() override;
+};
+
 class GeneratePTHAction : public PreprocessorFrontendAction {
 protected:
   void ExecuteAction() override;
@@ -106,6 +106,9 @@ enum ActionKind {
   /// Run a plugin action, \see ActionName.
   PluginAction,
 
+  /// Print the compile cache key of the input file and the files it uses.
+  PrintCacheKey,
+
   /// Print the "preamble" of the input file
   PrintPreamble,
 
@@ -257,9 +260,15 @@ public:
   /// Show frontend performance metrics and statistics.
   unsigned ShowStats : 1;
 
+  /// Show the memory used by AST nodes, by node kind and source file.
+  unsigned ShowASTMemory : 1;
+
   /// Show timers for individual actions.
   unsigned ShowTimers : 1;
 
+  /// Write a time trace of the compilation, as JSON.
+  unsigned TimeTrace : 1;
+
   /// Show the -version text.
   unsigned ShowVersion : 1;
 
@@ -282,6 +291,11 @@ public:
   /// them (e.g. with code completion).
   unsigned SkipFunctionBodies : 1;
 
+  /// When skipping function bodies, keep their tokens so that they can be
+  /// parsed on demand by the AST consumer, using
+  /// \c Sema::ParseDeferredFunctionBody.
+  unsigned DeferSkippedFunctionBodies : 1;
+
   /// Whether we can use the global module index if available.
   unsigned UseGlobalModuleIndex : 1;
 
@@ -303,9 +317,20 @@ public:
   /// Whether we should embed all used files into the PCM file.
   unsigned ModulesEmbedAllFiles : 1;
 
+  /// Whether the files embedded into the PCM file are stored uncompressed,
+  /// so that readers can use them without a copy.
+  unsigned ModulesEmbedUncompressed : 1;
+
   /// Whether timestamps should be written to the produced PCH file.
   unsigned IncludeTimestamps : 1;
 
+  /// Whether the produced PCH or module file should be compressed.
+  unsigned CompressASTFiles : 1;
+
+  /// Whether indexing into \c IndexStorePath skips the files that the index
+  /// store already has up-to-date records for.
+  unsigned IndexSkipIndexedFiles : 1;
+
   CodeCompleteOptions CodeCompleteOpts;
 
   enum {
@@ -424,6 +449,10 @@ public:
   /// The list of AST files to merge.
   std::vector<std::string> ASTMergeFiles;
 
+  /// The index store to write the symbols of the translation unit to, if not
+  /// empty.
+  std::string IndexStorePath;
+
   /// A list of arguments to forward to LLVM's option processing; this
   /// should only be used for debugging and experimental features.
   std::vector<std::string> LLVMArgs;
@@ -438,16 +467,24 @@ public:
   /// Filename to write statistics to.
   std::string StatsFile;
 
+  /// The minimum duration, in microseconds, of the events written to the
+  /// time trace.
+  unsigned TimeTraceGranularity;
+
 public:
   FrontendOptions()
       : DisableFree(false), RelocatablePCH(false), ShowHelp(false),
-        ShowStats(false), ShowTimers(false), ShowVersion(false),
+        ShowStats(false), ShowASTMemory(false), ShowTimers(false),
+        TimeTrace(false), ShowVersion(false),
         FixWhatYouCan(false), FixOnlyWarnings(false), FixAndRecompile(false),
         FixToTemporaries(false), ARCMTMigrateEmitARCErrors(false),
-        SkipFunctionBodies(false), UseGlobalModuleIndex(true),
+        SkipFunctionBodies(false), DeferSkippedFunctionBodies(false),
+        UseGlobalModuleIndex(true),
         GenerateGlobalModuleIndex(true), ASTDumpDecls(false),
         ASTDumpLookups(false), BuildingImplicitModule(false),
-        ModulesEmbedAllFiles(false), IncludeTimestamps(true) {}
+        ModulesEmbedAllFiles(false), ModulesEmbedUncompressed(false),
+        IncludeTimestamps(true), CompressASTFiles(false),
+        IndexSkipIndexedFiles(false), TimeTraceGranularity(500) {}
 
   /// getInputKindForExtension - Return the appropriate input kind for a file
   /// extension. For example, "c" would return InputKind::C.
@@ -0,0 +1,115 @@
+//===--- HeaderCostCollector.h - Attribute compile costs to headers -*- C++ -*-//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the HeaderCostCollector, which attributes what compiling a
+// translation unit costs to the files that it includes (-header-cost-file).
+// It is meant to help decide which headers are worth a precompiled header or
+// a module, and which ones are worth including less.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_FRONTEND_HEADERCOSTCOLLECTOR_H
+#define LLVM_CLANG_FRONTEND_HEADERCOSTCOLLECTOR_H
+
+#include "clang/Basic/LLVM.h"
+#include "clang/Basic/SourceLocation.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Optional.h"
+#include <chrono>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace clang {
+
+class ASTConsumer;
+class Decl;
+class DiagnosticsEngine;
+class FileEntry;
+class Preprocessor;
+class SourceManager;
+
+/// Attributes the costs of a translation unit to the files it includes.
+///
+/// For each file, the following are recorded:
+///
+/// - The time spent while the file was the one being read, which includes
+///   parsing and analyzing what it declares, but not what the files that it
+///   includes cost.
+/// - The tokens that the preprocessor returned while the file was the one
+///   being read, including those of the macros expanded in it.
+/// - The declarations written in the file.
+/// - The implicit instantiations of functions and classes that the file
+///   triggered, wherever the templates are declared.
+/// - The IR instructions generated for the functions declared in the file,
+///   including the instantiations of the templates declared in it.
+///
+/// The collector is fed by a preprocessor, an ASTConsumer and the code
+/// generator, and writes a JSON file when the translation unit is done.
+class HeaderCostCollector {
+public:
+  struct FileCost {
+    double Seconds = 0;
+    unsigned Tokens = 0;
+    unsigned Decls = 0;
+    unsigned Instantiations = 0;
+    unsigned IRInstructions = 0;
+  };
+
+  explicit HeaderCostCollector(StringRef OutputFile)
+      : OutputFile(OutputFile) {}
+
+  /// Starts timing and counting the tokens of the files that \p PP reads.
+  void attachToPreprocessor(Preprocessor &PP);
+
+  /// Creates a consumer that counts the declarations and instantiations of
+  /// the translation unit.
+  std::unique_ptr<ASTConsumer> createASTConsumer();
+
+  /// Attributes \p Count IR instructions to the file that declares \p D.
+  void addIRInstructions(const Decl *D, unsigned Count);
+
+  /// Attributes an implicit instantiation to the file that contains
+  /// \p PointOfInstantiation.
+  void addInstantiation(SourceLocation PointOfInstantiation);
+
+  /// Counts \p D and every declaration lexically within it, without
+  /// deserializing any.
+  void addDecls(const Decl *D);
+
+  /// Writes what has been collected to the output file, reporting an error
+  /// to \p Diags if it can't be written.
+  void writeOutput(DiagnosticsEngine &Diags);
+
+private:
+  friend class HeaderCostPPCallbacks;
+
+  /// Returns the index in Files of the file that contains \p Loc, if it is
+  /// in a file.
+  Optional<unsigned> getFileIndex(SourceLocation Loc);
+
+  /// Charges the time since the current file was entered to it, and makes
+  /// the file that contains \p Loc the current one.
+  void switchToFile(SourceLocation Loc);
+
+  std::string OutputFile;
+  SourceManager *SM = nullptr;
+  /// The files, in the order they were first charged.
+  std::vector<std::pair<const FileEntry *, FileCost>> Files;
+  llvm::DenseMap<const FileEntry *, unsigned> FileIndices;
+  /// The index in Files of the file being read, if any, and when it was
+  /// entered.
+  Optional<unsigned> CurrentFile;
+  std::chrono::steady_clock::time_point CurrentFileStart;
+};
+
+} // end namespace clang
+
+#endif
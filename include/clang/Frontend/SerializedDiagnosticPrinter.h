@@ -13,6 +13,8 @@
 #include "clang/Basic/LLVM.h"
 #include "clang/Frontend/SerializedDiagnostics.h"
 #include "llvm/Bitcode/BitstreamWriter.h"
+#include <string>
+#include <system_error>
 
 namespace llvm {
 class raw_ostream;
@@ -37,6 +39,16 @@ std::unique_ptr<DiagnosticConsumer> create(StringRef OutputFile,
                                            DiagnosticOptions *Diags,
                                            bool MergeChildRecords = false);
 
+/// Merges the serialized diagnostics files \p InputFiles into one file,
+/// \p OutputFile.
+///
+/// Each category, flag and file name is written once, however many of the
+/// inputs use it. The merged file ends with an index of the top-level
+/// diagnostics that were read from each input, which readers that don't know
+/// about it ignore.
+std::error_code mergeFiles(ArrayRef<std::string> InputFiles,
+                           StringRef OutputFile);
+
 } // end serialized_diags namespace
 } // end clang namespace
 
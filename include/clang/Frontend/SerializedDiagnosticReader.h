@@ -14,6 +14,7 @@
 #include "llvm/Bitcode/BitstreamReader.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/ErrorOr.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include <system_error>
 
 namespace clang {
@@ -66,6 +67,10 @@ public:
   /// Read the diagnostics in \c File
   std::error_code readDiagnostics(StringRef File);
 
+  /// Read the diagnostics in \c Buffer. The strings given to the visit*
+  /// methods point into \c Buffer, so they stay valid as long as it does.
+  std::error_code readDiagnostics(llvm::MemoryBufferRef Buffer);
+
 private:
   enum class Cursor;
 
@@ -124,6 +129,15 @@ protected:
 
   /// Visit the version of the set of diagnostics.
   virtual std::error_code visitVersionRecord(unsigned Version) { return {}; }
+
+  /// Visit an entry of the index of a merged file. The \c NumDiagnostics
+  /// top-level diagnostics starting at \c FirstDiagnostic were read from the
+  /// diagnostics file \c Source.
+  virtual std::error_code visitSourceIndexRecord(unsigned FirstDiagnostic,
+                                                 unsigned NumDiagnostics,
+                                                 StringRef Source) {
+    return {};
+  }
 };
 
 } // namespace serialized_diags
@@ -33,8 +33,9 @@ enum RecordIDs {
   RECORD_CATEGORY,
   RECORD_FILENAME,
   RECORD_FIXIT,
+  RECORD_SOURCE_INDEX,
   RECORD_FIRST = RECORD_VERSION,
-  RECORD_LAST = RECORD_FIXIT
+  RECORD_LAST = RECORD_SOURCE_INDEX
 };
 
 /// A stable version of DiagnosticIDs::Level.
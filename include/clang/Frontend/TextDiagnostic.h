@@ -17,6 +17,7 @@
 #define LLVM_CLANG_FRONTEND_TEXTDIAGNOSTIC_H
 
 #include "clang/Frontend/DiagnosticRenderer.h"
+#include <memory>
 
 namespace clang {
 
@@ -35,6 +36,11 @@ namespace clang {
 class TextDiagnostic : public DiagnosticRenderer {
   raw_ostream &OS;
 
+  /// The source line that a snippet was last emitted for, with its column
+  /// map. The notes of a diagnostic usually point into the same line again.
+  struct CachedSourceLine;
+  std::unique_ptr<CachedSourceLine> LastSourceLine;
+
 public:
   TextDiagnostic(raw_ostream &OS,
                  const LangOptions &LangOpts,
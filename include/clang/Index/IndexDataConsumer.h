@@ -17,6 +17,7 @@ namespace clang {
   class ASTContext;
   class DeclContext;
   class Expr;
+  class FileEntry;
   class FileID;
   class IdentifierInfo;
   class ImportDecl;
@@ -58,6 +59,10 @@ public:
                                      const Module *Mod,
                                      SymbolRoleSet Roles, SourceLocation Loc);
 
+  /// Called once for each file that is skipped because the file oracle of
+  /// the indexing options reports it as already indexed.
+  virtual void handleSkippedFile(const FileEntry &File) {}
+
   virtual void finish() {}
 };
 
@@ -0,0 +1,148 @@
+//===--- IndexStore.h - Persistent index data store -------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// An index store keeps the symbol occurrences found while compiling, so that
+// clients can read them later instead of indexing the sources again.
+//
+// A store is a directory with two kinds of files:
+//
+//   v1/units/<unit name>      One per compiled translation unit. It names the
+//                             main file, the output file, and the record of
+//                             each file that the translation unit indexed.
+//   v1/records/<record name>  The symbols and occurrences of one file. A
+//                             record is named after a hash of its contents,
+//                             so a header that is indexed the same way by
+//                             many translation units is only stored once.
+//
+// Both files are written atomically and have fixed-size entries, so that the
+// readers below can map them into memory and access any entry directly.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_INDEX_INDEXSTORE_H
+#define LLVM_CLANG_INDEX_INDEXSTORE_H
+
+#include "clang/Basic/LLVM.h"
+#include "clang/Index/IndexSymbol.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include <memory>
+#include <string>
+
+namespace llvm {
+class MemoryBuffer;
+}
+
+namespace clang {
+namespace index {
+class IndexDataConsumer;
+class IndexedFileOracle;
+
+/// Creates a data consumer that writes what it is given into the index store
+/// at \p StorePath, creating the store if needed.
+///
+/// Each file that contains occurrences gets a record. Records that the store
+/// already has are not written again. When the translation unit is finished,
+/// its unit is written, replacing the unit that an earlier compilation to the
+/// same \p OutputFile wrote.
+std::shared_ptr<IndexDataConsumer>
+createIndexStoreConsumer(StringRef StorePath, StringRef OutputFile);
+
+/// Creates a file oracle that considers a file indexed if a unit in the store
+/// at \p StorePath depends on it, and the file has not been modified since
+/// that unit was written. The units are read once, when the oracle is
+/// created.
+///
+/// This assumes that a header means the same in every translation unit that
+/// includes it. The unit that a compilation skipping a header writes still
+/// lists the header, with the record that was written when it was indexed.
+std::shared_ptr<IndexedFileOracle>
+createIndexStoreFileOracle(StringRef StorePath);
+
+/// Returns the name of the unit that a compilation of \p MainFile to
+/// \p OutputFile writes. If there is no output file, the unit is named after
+/// the main file.
+std::string getIndexStoreUnitName(StringRef MainFile, StringRef OutputFile);
+
+/// Reads a unit of an index store.
+class IndexUnitReader {
+public:
+  struct Dependency {
+    /// The absolute path of the file.
+    StringRef FilePath;
+    /// The name of the record with the occurrences in the file.
+    StringRef RecordName;
+  };
+
+  static llvm::Expected<std::unique_ptr<IndexUnitReader>>
+  create(StringRef StorePath, StringRef UnitName);
+
+  ~IndexUnitReader();
+
+  StringRef getMainFilePath() const { return MainFilePath; }
+  StringRef getOutputFile() const { return OutputFile; }
+
+  unsigned getNumDependencies() const { return NumDependencies; }
+  Dependency getDependency(unsigned I) const;
+
+private:
+  IndexUnitReader(std::unique_ptr<llvm::MemoryBuffer> Buffer);
+
+  std::unique_ptr<llvm::MemoryBuffer> Buffer;
+  StringRef MainFilePath, OutputFile;
+  unsigned NumDependencies = 0;
+  const char *Dependencies = nullptr;
+  StringRef Strings;
+};
+
+/// Reads a record of an index store.
+class IndexRecordReader {
+public:
+  struct Symbol {
+    StringRef USR;
+    StringRef Name;
+    SymbolKind Kind;
+    SymbolSubKind SubKind;
+    SymbolLanguage Lang;
+  };
+
+  struct Occurrence {
+    /// The index of the symbol, less than getNumSymbols().
+    unsigned SymbolIndex;
+    SymbolRoleSet Roles;
+    unsigned Line;
+    unsigned Column;
+  };
+
+  static llvm::Expected<std::unique_ptr<IndexRecordReader>>
+  create(StringRef StorePath, StringRef RecordName);
+
+  ~IndexRecordReader();
+
+  /// The symbols are sorted by USR.
+  unsigned getNumSymbols() const { return NumSymbols; }
+  Symbol getSymbol(unsigned I) const;
+
+  /// The occurrences are sorted by line and column.
+  unsigned getNumOccurrences() const { return NumOccurrences; }
+  Occurrence getOccurrence(unsigned I) const;
+
+private:
+  IndexRecordReader(std::unique_ptr<llvm::MemoryBuffer> Buffer);
+
+  std::unique_ptr<llvm::MemoryBuffer> Buffer;
+  unsigned NumSymbols = 0, NumOccurrences = 0;
+  const char *Symbols = nullptr, *Occurrences = nullptr;
+  StringRef Strings;
+};
+
+} // namespace index
+} // namespace clang
+
+#endif
@@ -21,6 +21,7 @@ namespace clang {
   class ASTReader;
   class ASTUnit;
   class Decl;
+  class FileEntry;
   class FrontendAction;
 
 namespace serialization {
@@ -30,6 +31,18 @@ namespace serialization {
 namespace index {
   class IndexDataConsumer;
 
+/// Tells indexing which files were already indexed elsewhere, for example by
+/// another translation unit, so that their contents can be skipped.
+class IndexedFileOracle {
+public:
+  virtual ~IndexedFileOracle();
+
+  /// Returns true if the occurrences in \p File are already known, so that
+  /// neither its declarations nor the occurrences located in it need to be
+  /// indexed again. This is never asked about the main file.
+  virtual bool isFileIndexed(const FileEntry &File) = 0;
+};
+
 struct IndexingOptions {
   enum class SystemSymbolFilterKind {
     None,
@@ -45,6 +58,10 @@ struct IndexingOptions {
   // callback is not available (e.g. after parsing has finished). Note that
   // macro references are not available in Proprocessor.
   bool IndexMacrosInPreprocessor = false;
+  // If set, the files that this says were already indexed are skipped: their
+  // top-level declarations are not visited and none of the occurrences
+  // located in them are reported.
+  std::shared_ptr<IndexedFileOracle> FileOracle;
 };
 
 /// Creates a frontend action that indexes all symbols (macros and AST decls).
@@ -12,8 +12,10 @@
 
 #include "clang/Basic/LLVM.h"
 #include "llvm/ADT/StringRef.h"
+#include <memory>
 
 namespace clang {
+class ASTContext;
 class Decl;
 class MacroDefinitionRecord;
 class Module;
@@ -30,6 +32,39 @@ static inline StringRef getUSRSpacePrefix() {
 /// \returns true if the results should be ignored, false otherwise.
 bool generateUSRForDecl(const Decl *D, SmallVectorImpl<char> &Buf);
 
+/// Memoizes the USRs of the declarations of one ASTContext, for clients that
+/// ask for the USR of the same declarations many times.
+///
+/// Each USR is generated once and kept until the cache is destroyed. The USR
+/// fragments of enclosing contexts are shared between the USRs of the
+/// declarations they contain. USRs depend on parts of the AST that are only
+/// known once their declarations are complete, such as the typedef names of
+/// anonymous structs, so use the cache on complete ASTs only.
+class USRCache {
+public:
+  explicit USRCache(ASTContext &Ctx);
+  ~USRCache();
+
+  ASTContext &getASTContext() const;
+
+  /// Returns the USR of \p D, including the USR prefix, or an empty string
+  /// if generateUSRForDecl() says that the USR should be ignored.
+  StringRef getUSR(const Decl *D);
+
+  /// Returns a 64-bit hash of the USR of \p D, or 0 if the USR should be
+  /// ignored. This is cheaper to store and compare than the USR, for clients
+  /// that only need to tell symbols apart.
+  uint64_t getUSRHash(const Decl *D);
+
+  class Impl;
+
+private:
+  std::unique_ptr<Impl> TheImpl;
+};
+
+/// Returns the hash that USRCache::getUSRHash() uses for \p USR.
+uint64_t hashUSR(StringRef USR);
+
 /// Generate a USR fragment for an Objective-C class.
 void generateUSRForObjCClass(StringRef Cls, raw_ostream &OS,
                              StringRef ExtSymbolDefinedIn = "",
@@ -0,0 +1,48 @@
+//===- DependencyDirectivesSourceMinimizer.h - Minimize source --*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file
+/// This file defines a routine that reduces a source file to the
+/// preprocessor directives that can affect which other files it depends on.
+/// Lexing the reduced form produces the same \#include graph as lexing the
+/// original, at a fraction of the cost.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LEX_DEPENDENCYDIRECTIVESSOURCEMINIMIZER_H
+#define LLVM_CLANG_LEX_DEPENDENCYDIRECTIVESSOURCEMINIMIZER_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+namespace clang {
+
+/// Minimize the input down to the preprocessor directives that might have an
+/// effect on the dependencies of a compilation unit.
+///
+/// The following directives are kept: \#include, \#include_next, \#import,
+/// \#__include_macros, \#define, \#undef, the conditional directives, and
+/// \#pragma once, system_header, push_macro, pop_macro, include_alias and
+/// clang module.  The Objective-C \@import declaration and the C++ module
+/// and import declarations are kept as well.  Everything else, including all
+/// comments, is dropped; escaped newlines are joined and each kept directive
+/// is printed on a single line.
+///
+/// \param Input the source to minimize.
+/// \param Output receives the minimized source.  It is cleared first.
+///
+/// \returns true on error, in which case \p Output is unspecified and the
+/// caller should fall back to the original source.
+bool minimizeSourceToDependencyDirectives(StringRef Input,
+                                          SmallVectorImpl<char> &Output);
+
+} // end namespace clang
+
+#endif // LLVM_CLANG_LEX_DEPENDENCYDIRECTIVESSOURCEMINIMIZER_H
@@ -16,6 +16,7 @@
 
 #include "clang/Basic/LLVM.h"
 #include "llvm/ADT/Optional.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include <memory>
@@ -32,6 +33,14 @@ class HeaderMapImpl {
   std::unique_ptr<const llvm::MemoryBuffer> FileBuffer;
   bool NeedsBSwap;
 
+  /// Maps the lowercased form of every key reachable by probing to the bucket
+  /// that holds it.  Built on the first lookup, so that large header maps are
+  /// not probed linearly for every \#include.
+  mutable llvm::StringMap<unsigned> KeyIndex;
+
+  /// Whether \c KeyIndex has been built.
+  mutable bool KeyIndexBuilt = false;
+
 public:
   HeaderMapImpl(std::unique_ptr<const llvm::MemoryBuffer> File, bool NeedsBSwap)
       : FileBuffer(std::move(File)), NeedsBSwap(NeedsBSwap) {}
@@ -51,6 +60,9 @@ public:
   void dump() const;
 
 private:
+  /// Populate \c KeyIndex from the on-disk hash table.
+  void buildKeyIndex() const;
+
   unsigned getEndianAdjustedWord(unsigned X) const;
   const HMapHeader &getHeader() const;
   HMapBucket getBucket(unsigned BucketNo) const;
@@ -27,6 +27,7 @@
 #include "llvm/Support/Allocator.h"
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <utility>
@@ -215,6 +216,51 @@ class HeaderSearch {
   };
   llvm::StringMap<LookupFileCacheInfo, llvm::BumpPtrAllocator> LookupFileCache;
 
+  /// A lookup that was resolved through SearchDirs, as recorded in the include
+  /// map shared by all compilations with the same search paths.
+  struct IncludeMapEntry {
+    /// The index in SearchDirs that the search started from.
+    unsigned StartIdx = 0;
+
+    /// The entry in SearchDirs that satisfied the query.
+    unsigned HitIdx = 0;
+  };
+
+  /// The include map: the entries loaded from the include map file, followed
+  /// by the ones resolved by this compilation.  Only used if
+  /// HeaderSearchOptions::IncludeMapPath is set.
+  llvm::StringMap<IncludeMapEntry, llvm::BumpPtrAllocator> IncludeMap;
+
+  /// Whether IncludeMap has been loaded for the current search paths.
+  bool IncludeMapLoaded = false;
+
+  /// Whether IncludeMap has entries that the include map file does not.
+  bool IncludeMapChanged = false;
+
+  /// A header's include guard, as recorded in the include guard database.
+  struct IncludeGuardEntry {
+    /// The name of the macro that guards the header.
+    std::string ControllingMacro;
+
+    /// The size, modification time and xxHash64 of the contents of the
+    /// header when the guard was found.
+    uint64_t Size = 0;
+    uint64_t ModTime = 0;
+    uint64_t ContentHash = 0;
+  };
+
+  /// The include guard database: the entries loaded from the database file,
+  /// updated with the guards found by this compilation, by absolute header
+  /// path.  Only used if HeaderSearchOptions::IncludeGuardDatabasePath is
+  /// set.
+  llvm::StringMap<IncludeGuardEntry> IncludeGuards;
+
+  /// Whether IncludeGuards has been loaded from the database file.
+  bool IncludeGuardsLoaded = false;
+
+  /// Whether IncludeGuards differs from the database file.
+  bool IncludeGuardsChanged = false;
+
   /// Collection mapping a framework or subframework
   /// name like "Carbon" to the Carbon.framework directory.
   llvm::StringMap<FrameworkCacheEntry, llvm::BumpPtrAllocator> FrameworkMap;
@@ -256,6 +302,9 @@ class HeaderSearch {
   unsigned NumMultiIncludeFileOptzn = 0;
   unsigned NumFrameworkLookups = 0;
   unsigned NumSubFrameworkLookups = 0;
+  unsigned NumIncludeMapHits = 0;
+  unsigned NumIncludeMapStaleHits = 0;
+  unsigned NumIncludeGuardDatabaseSkips = 0;
 
 public:
   HeaderSearch(std::shared_ptr<HeaderSearchOptions> HSOpts,
@@ -283,6 +332,7 @@ public:
     SystemDirIdx = systemDirIdx;
     NoCurDirSearch = noCurDirSearch;
     //LookupFileCache.clear();
+    resetIncludeMap();
   }
 
   /// Add an additional search path.
@@ -292,6 +342,7 @@ public:
     if (!isAngled)
       AngledDirIdx++;
     SystemDirIdx++;
+    resetIncludeMap();
   }
 
   /// Set the list of system header prefixes.
@@ -587,7 +638,67 @@ public:
   /// Load all known, top-level system modules.
   void loadTopLevelSystemModules();
 
+  /// Write the include map for the current search paths, merging in the
+  /// lookups that other compilations have written since it was loaded.
+  ///
+  /// Does nothing unless HeaderSearchOptions::IncludeMapPath and
+  /// HeaderSearchOptions::BuildSessionTimestamp are both set.
+  ///
+  /// \returns true if an error occurred, false otherwise.
+  bool writeIncludeMap();
+
+  /// Record in the include guard database that \p File, whose contents are
+  /// \p Contents, is guarded by \p ControllingMacro.
+  ///
+  /// Does nothing unless HeaderSearchOptions::IncludeGuardDatabasePath is
+  /// set.
+  void recordIncludeGuard(const FileEntry *File,
+                          const IdentifierInfo *ControllingMacro,
+                          StringRef Contents);
+
+  /// Write the include guard database, merging in the guards that other
+  /// compilations have written since it was loaded.
+  ///
+  /// \returns true if an error occurred, false otherwise.
+  bool writeIncludeGuardDatabase();
+
 private:
+  /// Return the include map file for the current search paths, or an empty
+  /// string if the include map is disabled.
+  std::string getIncludeMapFile() const;
+
+  /// Find a lookup of \p Filename starting at SearchDirs[\p StartIdx] that an
+  /// earlier compilation resolved.
+  const IncludeMapEntry *lookupIncludeMap(StringRef Filename,
+                                          unsigned StartIdx);
+
+  /// Record that a lookup of \p Filename starting at SearchDirs[\p StartIdx]
+  /// was satisfied by SearchDirs[\p HitIdx].
+  void recordIncludeMap(StringRef Filename, unsigned StartIdx,
+                        unsigned HitIdx);
+
+  /// Read the include guard database at \p Path into \p Entries.
+  ///
+  /// \returns true if the file is missing or malformed.
+  static bool
+  readIncludeGuardDatabase(StringRef Path,
+                           llvm::StringMap<IncludeGuardEntry> &Entries);
+
+  /// Load the include guard database, if that has not been done yet.
+  void loadIncludeGuardDatabase();
+
+  /// Return the controlling macro that the include guard database records
+  /// for \p File, provided the file has not changed since.
+  const IdentifierInfo *lookupIncludeGuard(Preprocessor &PP,
+                                           const FileEntry *File);
+
+  /// Forget the include map, because the search paths changed.
+  void resetIncludeMap() {
+    IncludeMap.clear();
+    IncludeMapLoaded = false;
+    IncludeMapChanged = false;
+  }
+
   /// Lookup a module with the given module name and search-name.
   ///
   /// \param ModuleName The name of the module we're looking for.
@@ -114,6 +114,20 @@ public:
   /// The directory used for a user build.
   std::string ModuleUserBuildPath;
 
+  /// If non-empty, the directory in which \#include lookups are shared
+  /// between the compilations of a build session that use the same search
+  /// paths.
+  std::string IncludeMapPath;
+
+  /// If non-empty, the file in which the include guards of the headers seen
+  /// by one compilation are recorded for the next ones.
+  std::string IncludeGuardDatabasePath;
+
+  /// If non-empty, the file in which the AST files whose input files were
+  /// validated are recorded, so that later compilations of the same build
+  /// session don't validate them again.
+  std::string ModulesValidationManifest;
+
   /// The mapping of module names to prebuilt module files.
   std::map<std::string, std::string> PrebuiltModuleFiles;
 
@@ -142,6 +156,12 @@ public:
   /// file.
   unsigned ModuleMapFileHomeIsCwd : 1;
 
+  /// Parse module map files lazily: the first read of a module map only
+  /// records where each top-level module declaration starts, and a
+  /// declaration is parsed when its module is looked up by name or when a
+  /// header below the module map's directory needs a module.
+  unsigned LazyModuleMaps : 1;
+
   /// The interval (in seconds) between pruning operations.
   ///
   /// This operation is expensive, because it requires Clang to walk through
@@ -203,14 +223,21 @@ public:
 
   unsigned ModulesHashContent : 1;
 
+  /// Whether a compilation that waits for another process to build a module
+  /// should build the modules that module imported last time, if nobody has
+  /// built them yet.
+  unsigned ModulesCooperativeBuild : 1;
+
   HeaderSearchOptions(StringRef _Sysroot = "/")
       : Sysroot(_Sysroot), ModuleFormat("raw"), DisableModuleHash(false),
         ImplicitModuleMaps(false), ModuleMapFileHomeIsCwd(false),
+        LazyModuleMaps(false),
         UseBuiltinIncludes(true), UseStandardSystemIncludes(true),
         UseStandardCXXIncludes(true), UseLibcxx(false), Verbose(false),
         ModulesValidateOncePerBuildSession(false),
         ModulesValidateSystemHeaders(false), UseDebugInfo(false),
-        ModulesValidateDiagnosticOptions(true), ModulesHashContent(false) {}
+        ModulesValidateDiagnosticOptions(true), ModulesHashContent(false),
+        ModulesCooperativeBuild(false) {}
 
   /// AddPath - Add the \p Path path to the specified \p Group list.
   void AddPath(StringRef Path, frontend::IncludeDirGroup Group,
@@ -46,8 +46,8 @@ class MacroArgs final
 
   /// PreExpArgTokens - Pre-expanded tokens for arguments that need them.  Empty
   /// if not yet computed.  This includes the EOF marker at the end of the
-  /// stream.
-  std::vector<std::vector<Token> > PreExpArgTokens;
+  /// stream.  The tokens are owned by the Preprocessor's macro argument arena.
+  std::vector<ArrayRef<Token>> PreExpArgTokens;
 
   /// StringifiedArgs - This contains arguments in 'stringified' form.  If the
   /// stringified form of an argument has not yet been computed, this is empty.
@@ -91,9 +91,8 @@ public:
   static unsigned getArgLength(const Token *ArgPtr);
 
   /// getPreExpArgument - Return the pre-expanded form of the specified
-  /// argument.
-  const std::vector<Token> &
-    getPreExpArgument(unsigned Arg, Preprocessor &PP);
+  /// argument.  The tokens remain valid until this object is destroyed.
+  ArrayRef<Token> getPreExpArgument(unsigned Arg, Preprocessor &PP);
 
   /// getStringifiedArgument - Compute, cache, and return the specified argument
   /// that has been 'stringified' as required by the # operator.
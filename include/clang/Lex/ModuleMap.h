@@ -32,6 +32,7 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace clang {
 
@@ -273,6 +274,67 @@ private:
   /// map.
   llvm::DenseMap<const FileEntry *, bool> ParsedModuleMap;
 
+  /// A top-level module declaration in a lazily-parsed module map file
+  /// (see \c HeaderSearchOptions::LazyModuleMaps).
+  struct PendingModuleDecl {
+    /// The location of the first token of the declaration.
+    SourceLocation Loc;
+
+    /// The module map file that contains the declaration.
+    const FileEntry *ModuleMapFile;
+
+    /// The directory that file names in the declaration are resolved
+    /// relative to.
+    const DirectoryEntry *Directory;
+
+    /// The module declaration scope that was current when the module map
+    /// file was read.
+    unsigned ScopeID;
+
+    /// Whether the module map file is in a system header directory.
+    unsigned IsSystem : 1;
+
+    /// Whether the declaration has been parsed.
+    unsigned Parsed : 1;
+  };
+
+  /// The top-level module declarations of lazily-parsed module map files, in
+  /// the order they were read.
+  mutable std::vector<PendingModuleDecl> PendingModuleDecls;
+
+  /// Indices into \c PendingModuleDecls of the declarations that have not
+  /// been parsed yet, by the name of the top-level module they declare.
+  mutable llvm::StringMap<SmallVector<unsigned, 1>> PendingModuleDeclsByName;
+
+  /// Indices into \c PendingModuleDecls of the declarations that have not
+  /// been parsed yet, by the directory their file names are resolved in.
+  mutable llvm::DenseMap<const DirectoryEntry *, SmallVector<unsigned, 2>>
+      PendingModuleDeclsByDir;
+
+  /// Record the top-level module declarations of the given module map file
+  /// without parsing them.
+  ///
+  /// \returns false if the file cannot be indexed and must be parsed
+  /// eagerly instead.
+  bool indexModuleMapFile(const FileEntry *File, bool IsSystem,
+                          const DirectoryEntry *Dir, FileID ID);
+
+  /// Parse the pending module declaration with the given index, unless it has
+  /// already been parsed.
+  void parsePendingModuleDecl(unsigned Index) const;
+
+  /// Parse the pending declarations of the top-level module with the given
+  /// name.
+  ///
+  /// \returns true if there were any.
+  bool parsePendingModuleDecls(StringRef Name) const;
+
+  /// Parse the pending module declarations that might cover the given header.
+  void parsePendingModuleDeclsForHeader(const FileEntry *File) const;
+
+  /// Parse all pending module declarations.
+  void parseAllPendingModuleDecls() const;
+
   /// Resolve the given export declaration into an actual export
   /// declaration.
   ///
@@ -677,7 +739,10 @@ public:
 
   using module_iterator = llvm::StringMap<Module *>::const_iterator;
 
-  module_iterator module_begin() const { return Modules.begin(); }
+  module_iterator module_begin() const {
+    parseAllPendingModuleDecls();
+    return Modules.begin();
+  }
   module_iterator module_end()   const { return Modules.end(); }
 };
 
@@ -282,6 +282,14 @@ public:
                           const FileEntry *File,
                           SrcMgr::CharacteristicKind FileType) {}
 
+  /// Hook called when a '#embed' directive is read.
+  ///
+  /// \param File The file whose bytes are embedded, or null if it was not
+  /// found.
+  virtual void EmbedDirective(SourceLocation HashLoc, StringRef FileName,
+                              bool IsAngled, const FileEntry *File,
+                              SrcMgr::CharacteristicKind FileType) {}
+
   /// Hook called when a source range is skipped.
   /// \param Range The SourceRange that was skipped. The range begins at the
   /// \#if/\#else directive and ends after the \#endif/\#else directive.
@@ -456,6 +464,13 @@ public:
     Second->HasInclude(Loc, FileName, IsAngled, File, FileType);
   }
 
+  void EmbedDirective(SourceLocation HashLoc, StringRef FileName,
+                      bool IsAngled, const FileEntry *File,
+                      SrcMgr::CharacteristicKind FileType) override {
+    First->EmbedDirective(HashLoc, FileName, IsAngled, File, FileType);
+    Second->EmbedDirective(HashLoc, FileName, IsAngled, File, FileType);
+  }
+
   void PragmaOpenCLExtension(SourceLocation NameLoc, const IdentifierInfo *Name,
                              SourceLocation StateLoc, unsigned State) override {
     First->PragmaOpenCLExtension(NameLoc, Name, StateLoc, State);
@@ -108,7 +108,7 @@ class PTHManager : public IdentifierInfoLookup {
 
 public:
   // The current PTH version.
-  enum { Version = 10 };
+  enum { Version = 11 };
 
   PTHManager(const PTHManager &) = delete;
   PTHManager &operator=(const PTHManager &) = delete;
@@ -311,9 +311,30 @@ class Token;
     /// Allocator used to store preprocessing objects.
     llvm::BumpPtrAllocator BumpAlloc;
 
-    /// The set of preprocessed entities in this record, in order they
-    /// were seen.
-    std::vector<PreprocessedEntity *> PreprocessedEntities;
+    /// What the record keeps for a local preprocessed entity besides its
+    /// source range: either the entity itself or, for an expansion of a
+    /// user-defined macro that nobody has asked for yet, the definition of
+    /// the macro.
+    using LocalEntityPayload =
+        llvm::PointerUnion<PreprocessedEntity *, MacroDefinitionRecord *>;
+
+    /// The source ranges of the local preprocessed entities in this record,
+    /// in the order they were seen.
+    ///
+    /// The local entities are stored as parallel arrays of ranges and
+    /// payloads, so that a large translation unit's worth of macro
+    /// expansions costs 16 bytes each rather than a separately allocated
+    /// object plus a pointer to it, and so that range searches only touch
+    /// the ranges.
+    std::vector<SourceRange> LocalEntityRanges;
+
+    /// The payloads of the local preprocessed entities, parallel to
+    /// \c LocalEntityRanges.
+    std::vector<LocalEntityPayload> LocalEntityPayloads;
+
+    /// Whether macro expansions and other macro references are recorded, or
+    /// only macro definitions and inclusion directives.
+    bool RecordMacroExpansions = true;
 
     /// The set of preprocessed entities in this record that have been
     /// loaded from external sources.
@@ -363,6 +384,14 @@ class Token;
     /// Retrieve the loaded preprocessed entity at the given index.
     PreprocessedEntity *getLoadedPreprocessedEntity(unsigned Index);
 
+    /// Retrieve the local preprocessed entity at the given index, creating
+    /// it if it is a macro expansion that has not been needed before.
+    PreprocessedEntity *getLocalPreprocessedEntity(unsigned Index);
+
+    /// Add a local preprocessed entity with the given range and payload.
+    PPEntityID addLocalEntity(SourceRange Range, LocalEntityPayload Payload,
+                              bool IsMacroDefinition);
+
     /// Determine the number of preprocessed entities that were
     /// loaded (or can be loaded) from an external source.
     unsigned getNumLoadedPreprocessedEntities() const {
@@ -409,6 +438,18 @@ class Token;
 
     size_t getTotalMemory() const;
 
+    /// Determine whether macro expansions and other macro references are
+    /// recorded.
+    bool recordsMacroExpansions() const { return RecordMacroExpansions; }
+
+    /// Set whether macro expansions and other macro references are
+    /// recorded.  When they are not, the record only holds macro definitions
+    /// and inclusion directives, which is much smaller for large translation
+    /// units.
+    void setRecordMacroExpansions(bool Record) {
+      RecordMacroExpansions = Record;
+    }
+
     SourceManager &getSourceManager() const { return SourceMgr; }
 
     /// Iteration over the preprocessed entities.
@@ -458,7 +499,7 @@ class Token;
 
     /// End iterator for all preprocessed entities.
     iterator end() {
-      return iterator(this, PreprocessedEntities.size());
+      return iterator(this, LocalEntityRanges.size());
     }
 
     /// Begin iterator for local, non-loaded, preprocessed entities.
@@ -468,7 +509,7 @@ class Token;
 
     /// End iterator for local, non-loaded, preprocessed entities.
     iterator local_end() {
-      return iterator(this, PreprocessedEntities.size());
+      return iterator(this, LocalEntityRanges.size());
     }
 
     /// iterator range for the given range of loaded
@@ -35,6 +35,7 @@
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/FoldingSet.h"
+#include "llvm/ADT/FunctionExtras.h"
 #include "llvm/ADT/None.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/PointerUnion.h"
@@ -151,6 +152,15 @@ class Preprocessor {
   /// objects internal to the Preprocessor.
   llvm::BumpPtrAllocator BP;
 
+  /// The spellings of the tokens that needed cleaning, keyed by the raw
+  /// encoding of the token location and the token length.
+  ///
+  /// The spellings are allocated in CleanedSpellingArena, and live as long
+  /// as the preprocessor. See getSpellingRef().
+  mutable llvm::DenseMap<std::pair<unsigned, unsigned>, StringRef>
+      CleanedSpellings;
+  mutable llvm::BumpPtrAllocator CleanedSpellingArena;
+
   /// Identifiers for builtin macros and other builtins.
   IdentifierInfo *Ident__LINE__, *Ident__FILE__;   // __LINE__, __FILE__
   IdentifierInfo *Ident__DATE__, *Ident__TIME__;   // __DATE__, __TIME__
@@ -195,6 +205,10 @@ class Preprocessor {
   bool KeepMacroComments : 1;
   bool SuppressIncludeNotFoundError : 1;
 
+  /// True if entered files are reduced to their dependency directives
+  /// before they are lexed.
+  bool MinimizeSourceToDependencyDirectives : 1;
+
   // State that changes while the preprocessor runs:
   bool InMacroArgs : 1;            // True if parsing fn macro invocation args.
 
@@ -268,6 +282,11 @@ class Preprocessor {
   /// The file that we're performing code-completion for, if any.
   const FileEntry *CodeCompletionFile = nullptr;
 
+  /// The files that have already been reduced to their dependency
+  /// directives.  The minimized contents themselves are owned by the
+  /// SourceManager, as overrides of the files' contents.
+  llvm::SmallPtrSet<const FileEntry *, 32> MinimizedFiles;
+
   /// The offset in file for the code-completion point.
   unsigned CodeCompletionOffset = 0;
 
@@ -465,6 +484,9 @@ private:
   /// encountered (e.g. a file is \#included, etc).
   std::unique_ptr<PPCallbacks> Callbacks;
 
+  /// Called for every token that Lex() returns, if set.
+  llvm::unique_function<void(const clang::Token &)> OnToken;
+
   struct MacroExpandsInfo {
     Token Tok;
     MacroDefinition MD;
@@ -693,6 +715,20 @@ private:
   /// reused for quick allocation.
   MacroArgs *MacroArgCache = nullptr;
 
+  /// The number of MacroArgs objects that have been created and not yet
+  /// destroyed, i.e. the function-like macro expansions in progress.
+  unsigned NumLiveMacroArgs = 0;
+
+  /// Storage for pre-expanded macro arguments (see
+  /// MacroArgs::getPreExpArgument).  It is reset and reused whenever the
+  /// outermost function-like macro expansion in progress is done.
+  llvm::BumpPtrAllocator MacroArgArena;
+
+  /// Scratch space into which macro arguments are pre-expanded before being
+  /// moved into MacroArgArena.  Pre-expansions nest, so this works like a
+  /// stack.
+  SmallVector<Token, 64> MacroArgPreExpansionBuffer;
+
   /// For each IdentifierInfo used in a \#pragma push_macro directive,
   /// we keep a MacroInfo stack used to restore the previous macro value.
   llvm::DenseMap<IdentifierInfo *, std::vector<MacroInfo *>>
@@ -715,6 +751,9 @@ private:
   unsigned NumTokenPaste = 0;
   unsigned NumFastTokenPaste = 0;
   unsigned NumSkipped = 0;
+  unsigned MaxNumLiveMacroArgs = 0;
+  unsigned NumPreExpandedArgTokens = 0;
+  unsigned NumExpandedArgTokens = 0;
 
   /// The predefined macros that preprocessor should use from the
   /// command line etc.
@@ -881,6 +920,19 @@ public:
     return SuppressIncludeNotFoundError;
   }
 
+  /// Sets whether each file is reduced to the directives that can affect its
+  /// dependencies (see minimizeSourceToDependencyDirectives) before it is
+  /// lexed.  This is only useful when all that is wanted from preprocessing
+  /// is the set of included files, and must be set before the main file is
+  /// entered.
+  void setMinimizeSourceToDependencyDirectives(bool Minimize) {
+    MinimizeSourceToDependencyDirectives = Minimize;
+  }
+
+  bool getMinimizeSourceToDependencyDirectives() const {
+    return MinimizeSourceToDependencyDirectives;
+  }
+
   /// Sets whether the preprocessor is responsible for producing output or if
   /// it is producing tokens to be consumed by Parse and Sema.
   void setPreprocessedOutput(bool IsPreprocessedOutput) {
@@ -927,6 +979,13 @@ public:
                                                 std::move(Callbacks));
     Callbacks = std::move(C);
   }
+
+  /// Sets a function that is called for every token that Lex() returns,
+  /// replacing any earlier one. Unlike PPCallbacks, this sees the tokens of
+  /// macro expansions as well.
+  void setTokenWatcher(llvm::unique_function<void(const clang::Token &)> F) {
+    OnToken = std::move(F);
+  }
   /// \}
 
   bool isMacroDefined(StringRef Id) {
@@ -1620,6 +1679,15 @@ public:
                         SmallVectorImpl<char> &Buffer,
                         bool *Invalid = nullptr) const;
 
+  /// Get the spelling of a token without copying it.
+  ///
+  /// The result points into the identifier table or the source buffer. If
+  /// the token needs cleaning, it points into a cache of cleaned spellings
+  /// instead, so that spelling the same token again costs a lookup. Either
+  /// way it lives as long as the preprocessor, and is followed by a
+  /// readable character.
+  StringRef getSpellingRef(const Token &Tok, bool *Invalid = nullptr) const;
+
   /// Relex the token at the specified location.
   /// \returns true if there was a failure, false on success.
   bool getRawToken(SourceLocation Loc, Token &Result,
@@ -1739,6 +1807,18 @@ public:
 
   size_t getTotalMemory() const;
 
+  /// Returns the memory held by the caches that the preprocessor keeps to
+  /// speed up lexing: cached tokens, macro expansion buffers and recycled
+  /// token lexers and macro arguments.
+  size_t getTokenCacheMemory() const;
+
+  /// Release the caches counted by getTokenCacheMemory().
+  ///
+  /// This only does something once the preprocessor has finished lexing,
+  /// when nothing refers to the cached tokens any more. It is meant for
+  /// clients that keep a preprocessor alive after parsing, such as IDEs.
+  void releaseTokenCaches();
+
   /// When the macro expander pastes together a comment (/##/) in Microsoft
   /// mode, this method handles updating the current state, returning the
   /// token on the next source line.
@@ -2064,6 +2144,11 @@ private:
   /// start getting tokens from it using the PTH cache.
   void EnterSourceFileWithPTH(PTHLexer *PL, const DirectoryLookup *Dir);
 
+  /// Return the minimized form of the file \p FID, whose contents are
+  /// \p InputFile, when minimizing source to dependency directives.
+  const llvm::MemoryBuffer *
+  getDependencyDirectivesBuffer(FileID FID, const llvm::MemoryBuffer *InputFile);
+
   /// Set the FileID for the preprocessor predefines.
   void setPredefinesFileID(FileID FID) {
     assert(PredefinesFileID.isInvalid() && "PredefinesFileID already set!");
@@ -2106,6 +2191,7 @@ private:
   }
 
   const Token &PeekAhead(unsigned N);
+  void compactCachedTokens();
   void AnnotatePreviousCachedTokens(const Token &Tok);
 
   //===--------------------------------------------------------------------===//
@@ -2129,6 +2215,7 @@ private:
   void HandleIncludeMacrosDirective(SourceLocation HashLoc, Token &Tok);
   void HandleImportDirective(SourceLocation HashLoc, Token &Tok);
   void HandleMicrosoftImportDirective(Token &Tok);
+  void HandleEmbedDirective(SourceLocation HashLoc, Token &Tok);
 
 public:
   /// Check that the given module is available, producing a diagnostic if not.
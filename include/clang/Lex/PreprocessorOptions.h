@@ -54,6 +54,10 @@ public:
   /// definitions and expansions.
   bool DetailedRecord = false;
 
+  /// Whether the detailed record includes macro expansions and other macro
+  /// references, or only macro definitions and inclusion directives.
+  bool DetailedRecordMacroExpansions = true;
+
   /// When true, we are creating or using a PCH where a #pragma hdrstop is
   /// expected to indicate the beginning or end of the PCH.
   bool PCHWithHdrStop = false;
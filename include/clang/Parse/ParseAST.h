@@ -44,8 +44,13 @@ namespace clang {
 
   /// Parse the main file known to the preprocessor, producing an
   /// abstract syntax tree.
+  ///
+  /// \param DeferSkippedFunctionBodies Whether skipped function bodies are
+  /// kept so that the AST consumer can parse them on demand from
+  /// HandleTranslationUnit.
   void ParseAST(Sema &S, bool PrintStats = false,
-                bool SkipFunctionBodies = false);
+                bool SkipFunctionBodies = false,
+                bool DeferSkippedFunctionBodies = false);
 
 }  // end namespace clang
 
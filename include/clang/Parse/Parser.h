@@ -255,6 +255,23 @@ class Parser : public CodeCompletionHandler {
   /// Identifiers which have been declared within a tentative parse.
   SmallVector<IdentifierInfo *, 8> TentativelyDeclaredIdentifiers;
 
+  /// The number of tentative parsing actions that are currently active.
+  unsigned TentativeParsingDepth = 0;
+
+  /// Answers to the disambiguation queries made so far within the outermost
+  /// active tentative parse, keyed by getTentativeParseMemoKey().  Bit 0 of
+  /// each entry holds the result and bit 1 whether it was ambiguous.
+  ///
+  /// The token stream cannot change while a tentative parse is active, so the
+  /// same query at the same position has the same answer.  The table is
+  /// cleared when any tentative parse is committed, since committed tokens
+  /// may have been acted upon, and when the outermost one is reverted.
+  llvm::DenseMap<uint64_t, unsigned> TentativeParseMemo;
+
+  /// Statistics on tentative parsing.
+  unsigned NumTentativeParses = 0;
+  unsigned NumTentativeParsesAvoided = 0;
+
   /// Tracker for '<' tokens that might have been intended to be treated as an
   /// angle bracket instead of a less-than comparison.
   ///
@@ -354,6 +371,13 @@ class Parser : public CodeCompletionHandler {
   /// declarations/definitions when indexing.
   bool SkipFunctionBodies;
 
+  /// Whether the bodies that are skipped are kept for parsing on demand.
+  ///
+  /// Their tokens are stored as for delayed template parsing, and are parsed
+  /// when \c Sema::ParseDeferredFunctionBody is called once the end of the
+  /// translation unit has been reached.
+  bool DeferSkippedFunctionBodies = false;
+
   /// The location of the expression statement that is being parsed right now.
   /// Used to determine if an expression that is being parsed is a statement or
   /// just a regular sub-expression.
@@ -366,6 +390,10 @@ public:
   const LangOptions &getLangOpts() const { return PP.getLangOpts(); }
   const TargetInfo &getTargetInfo() const { return PP.getTargetInfo(); }
   Preprocessor &getPreprocessor() const { return PP; }
+
+  void setDeferSkippedFunctionBodies(bool Defer) {
+    DeferSkippedFunctionBodies = Defer;
+  }
   Sema &getActions() const { return Actions; }
   AttributeFactory &getAttrFactory() { return AttrFactory; }
 
@@ -392,6 +420,9 @@ public:
   ///
   void Initialize();
 
+  /// Print statistics about the parser to stderr.
+  void PrintStats() const;
+
   /// Parse the first top-level declaration in a translation unit.
   bool ParseFirstTopLevelDecl(DeclGroupPtrTy &Result);
 
@@ -849,6 +880,8 @@ private:
       PrevBracketCount = P.BracketCount;
       PrevBraceCount = P.BraceCount;
       P.PP.EnableBacktrackAtThisPos();
+      ++P.TentativeParsingDepth;
+      ++P.NumTentativeParses;
       isActive = true;
     }
     void Commit() {
@@ -856,11 +889,15 @@ private:
       P.TentativelyDeclaredIdentifiers.resize(
           PrevTentativelyDeclaredIdentifierCount);
       P.PP.CommitBacktrackedTokens();
+      --P.TentativeParsingDepth;
+      P.TentativeParseMemo.clear();
       isActive = false;
     }
     void Revert() {
       assert(isActive && "Parsing action was finished!");
       P.PP.Backtrack();
+      if (--P.TentativeParsingDepth == 0)
+        P.TentativeParseMemo.clear();
       P.Tok = PrevTok;
       P.TentativelyDeclaredIdentifiers.resize(
           PrevTentativelyDeclaredIdentifierCount);
@@ -2080,6 +2117,12 @@ private:
   /// \returns true if the function body was skipped.
   bool trySkippingFunctionBody();
 
+  /// When deferring skipped function bodies, consume the body of \p D and
+  /// store its tokens so that it can be parsed on demand.
+  ///
+  /// \returns true if the function body was deferred.
+  bool tryDeferringFunctionBody(Decl *D);
+
   bool ParseImplicitInt(DeclSpec &DS, CXXScopeSpec *SS,
                         const ParsedTemplateInfo &TemplateInfo,
                         AccessSpecifier AS, DeclSpecContext DSC,
@@ -2239,6 +2282,28 @@ private:
     return isCXXTypeId(Context, isAmbiguous);
   }
 
+  /// Disambiguation queries whose answers are kept in TentativeParseMemo.
+  /// The type-id queries are offset by their TentativeCXXTypeIdContext.
+  enum TentativeParseMemoQuery {
+    TPMQ_FunctionDeclarator,
+    TPMQ_TypeId
+  };
+
+  /// Compute the key under which the answer to \p Query at the current token
+  /// is stored.  It covers the parser state the answer depends on.
+  uint64_t getTentativeParseMemoKey(unsigned Query) const;
+
+  /// Look up the answer to the query keyed by \p Key.  Returns false if it
+  /// has not been answered within the current tentative parse.
+  bool lookupTentativeParseMemo(uint64_t Key, bool &Result, bool &IsAmbiguous);
+
+  /// Remember the answer to the query keyed by \p Key, if a tentative parse
+  /// is active.
+  void recordTentativeParseMemo(uint64_t Key, bool Result, bool IsAmbiguous);
+
+  bool isCXXFunctionDeclaratorImpl(bool *IsAmbiguous);
+  bool isCXXTypeIdImpl(TentativeCXXTypeIdContext Context, bool &isAmbiguous);
+
   /// TPResult - Used as the result value for functions whose purpose is to
   /// disambiguate C++ constructs by "tentatively parsing" them.
   enum class TPResult {
@@ -16,6 +16,7 @@
 #define LLVM_CLANG_REWRITE_CORE_HTMLREWRITE_H
 
 #include "clang/Basic/SourceLocation.h"
+#include <memory>
 #include <string>
 
 namespace clang {
@@ -26,6 +27,16 @@ class Preprocessor;
 
 namespace html {
 
+  /// A cache of the highlighting that SyntaxHighlight and HighlightMacros
+  /// compute for each file, so that highlighting the same file again does not
+  /// relex or re-preprocess it. The cache is only valid for the preprocessor
+  /// and source manager it was filled with.
+  struct RelexRewriteCache;
+  using RelexRewriteCacheRef = std::shared_ptr<RelexRewriteCache>;
+
+  /// Create an empty RelexRewriteCache.
+  RelexRewriteCacheRef instantiateRelexRewriteCache();
+
   /// HighlightRange - Highlight a range in the source code with the specified
   /// start/end tags.  B/E must be in the same file.  This ensures that
   /// start/end tags are placed at the start/end of each line if the range is
@@ -67,14 +78,18 @@ namespace html {
                                          StringRef title);
 
   /// SyntaxHighlight - Relex the specified FileID and annotate the HTML with
-  /// information about keywords, comments, etc.
-  void SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP);
+  /// information about keywords, comments, etc.  If \p Cache is given, the
+  /// highlighting is taken from it, or stored in it for the next call.
+  void SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP,
+                       RelexRewriteCacheRef Cache = nullptr);
 
   /// HighlightMacros - This uses the macro table state from the end of the
   /// file, to reexpand macros and insert (into the HTML) information about the
   /// macro expansions.  This won't be perfectly perfect, but it will be
-  /// reasonably close.
-  void HighlightMacros(Rewriter &R, FileID FID, const Preprocessor &PP);
+  /// reasonably close.  If \p Cache is given, the highlighting is taken from
+  /// it, or stored in it for the next call.
+  void HighlightMacros(Rewriter &R, FileID FID, const Preprocessor &PP,
+                       RelexRewriteCacheRef Cache = nullptr);
 
 } // end html namespace
 } // end clang namespace
@@ -13,6 +13,7 @@
 #include "clang/Basic/LLVM.h"
 #include "clang/Rewrite/Core/DeltaTree.h"
 #include "clang/Rewrite/Core/RewriteRope.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringRef.h"
 
 namespace clang {
@@ -35,6 +36,14 @@ class RewriteBuffer {
 public:
   using iterator = RewriteRope::const_iterator;
 
+  /// Edit - A replacement of the \c Length characters at \c Offset in the
+  /// original buffer with \c Text.
+  struct Edit {
+    unsigned Offset;
+    unsigned Length;
+    StringRef Text;
+  };
+
   iterator begin() const { return Buffer.begin(); }
   iterator end() const { return Buffer.end(); }
   unsigned size() const { return Buffer.size(); }
@@ -89,7 +98,13 @@ public:
   void ReplaceText(unsigned OrigOffset, unsigned OrigLength,
                    StringRef NewStr);
 
+
 private:
+  /// ReplaceTextInBulk - Initialize a new buffer with \p Original after
+  /// applying all of \p Edits to it, in a single pass.  The edits must be
+  /// sorted, must not overlap, and must be in range.
+  void ReplaceTextInBulk(StringRef Original, ArrayRef<Edit> Edits);
+
   /// getMappedOffset - Given an offset into the original SourceBuffer that this
   /// RewriteBuffer is based on, map it into the offset space of the
   /// RewriteBuffer.  If AfterInserts is true and if the OrigOffset indicates a
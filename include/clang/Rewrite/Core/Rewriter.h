@@ -151,6 +151,15 @@ public:
   /// operation.
   bool ReplaceText(SourceRange range, SourceRange replacementRange);
 
+  /// ReplaceTextInBulk - Apply all of \p Edits to the file \p FID.  The edits
+  /// are offsets into the original file, sorted by offset and not
+  /// overlapping.  This gives the same result as calling ReplaceText for each
+  /// edit from the last to the first, but rewrites a file that has not been
+  /// changed yet in a single pass, however many edits there are.
+  ///
+  /// Returns true, without changing anything, if the edits cannot be applied.
+  bool ReplaceTextInBulk(FileID FID, ArrayRef<RewriteBuffer::Edit> Edits);
+
   /// Increase indentation for the lines between the given source range.
   /// To determine what the indentation should be, 'parentIndent' is used
   /// that should be at a source location with an indentation one degree
@@ -970,6 +970,13 @@ public:
   /// saved into Saved and the returned StringRef will refer to it.
   StringRef getOrderedName(std::string &Saved) const;
 
+  /// Determine whether the text that is typed to select this result may
+  /// start with \p Prefix, ignoring case.
+  ///
+  /// This does not build the code-completion string, so a result whose
+  /// typed text cannot be determined without it is assumed to match.
+  bool matchesTypedPrefix(StringRef Prefix) const;
+
 private:
   void computeCursorKindAndAvailability(bool Accessible = true);
 };
@@ -1004,6 +1011,13 @@ protected:
   /// binary.
   bool OutputIsBinary;
 
+  /// If not empty, only the results whose typed text starts with this
+  /// prefix, ignoring case, are wanted.
+  std::string ResultPrefix;
+
+  /// If not zero, the maximum number of results that are wanted.
+  unsigned MaxResults = 0;
+
 public:
   class OverloadCandidate {
   public:
@@ -1117,6 +1131,32 @@ public:
   /// Determine whether the output of this consumer is binary.
   bool isOutputBinary() const { return OutputIsBinary; }
 
+  /// Only report the results whose typed text starts with \p Prefix,
+  /// ignoring case, and no more than \p MaxResults of them, unless it is
+  /// zero.
+  ///
+  /// Sema drops the results that do not match the prefix as it finds them,
+  /// and applies both limits before the results are reported, so no
+  /// code-completion string is built for a result that is not wanted.
+  void setResultFilter(StringRef Prefix, unsigned MaxResults) {
+    ResultPrefix = Prefix;
+    this->MaxResults = MaxResults;
+  }
+
+  /// The prefix that the typed text of the wanted results starts with.
+  StringRef getResultPrefix() const { return ResultPrefix; }
+
+  /// The maximum number of results that are wanted, or zero.
+  unsigned getMaxResults() const { return MaxResults; }
+
+  /// Apply the result filter to \p Results, moving the wanted results to
+  /// the front. If there are too many of them, the ones with the best
+  /// priority are kept.
+  ///
+  /// \returns the number of wanted results.
+  unsigned filterResults(CodeCompletionResult *Results,
+                         unsigned NumResults) const;
+
   /// Deregisters and destroys this code-completion consumer.
   virtual ~CodeCompleteConsumer();
 
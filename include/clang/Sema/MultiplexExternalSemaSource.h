@@ -189,6 +189,11 @@ public:
                  llvm::DenseMap<const CXXRecordDecl *,
                                 CharUnits> &VirtualBaseOffsets) override;
 
+  /// Retrieve the layout of \p Record stored by the first source that has
+  /// one.
+  const ASTRecordLayout *
+  getStoredRecordLayout(const RecordDecl *Record) override;
+
   /// Return the amount of memory used by memory buffers, breaking down
   /// by heap-backed versus mmap'ed memory.
   void getMemoryBufferSizes(MemoryBufferSizes &sizes) const override;
@@ -869,6 +869,10 @@ public:
     Kind = SK_Lambda;
   }
 
+  /// Reset the scope to the state of a newly-created one, keeping the
+  /// memory that its containers have allocated.
+  void Clear();
+
   /// Note when all explicit captures have been added.
   void finishedExplicitCaptures() {
     NumExplicitCaptures = Captures.size();
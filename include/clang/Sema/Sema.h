@@ -55,6 +55,7 @@
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/TinyPtrVector.h"
+#include <atomic>
 #include <deque>
 #include <memory>
 #include <string>
@@ -184,6 +185,7 @@ namespace clang {
   class TypedefNameDecl;
   class TypeLoc;
   class TypoCorrectionConsumer;
+  class TypoCorrectionNameIndex;
   class UnqualifiedId;
   class UnresolvedLookupExpr;
   class UnresolvedMemberExpr;
@@ -325,6 +327,16 @@ public:
   /// Flag indicating whether or not to collect detailed statistics.
   bool CollectStats;
 
+  /// If set, the flag through which a client asks for the translation unit to
+  /// be abandoned. Once it is set, parsing stops at the next top-level
+  /// declaration and no end-of-translation-unit work is done.
+  const std::atomic<bool> *CancellationFlag = nullptr;
+
+  /// Whether the client asked for the translation unit to be abandoned.
+  bool isCancellationRequested() const {
+    return CancellationFlag && CancellationFlag->load(std::memory_order_relaxed);
+  }
+
   /// Code-completion consumer.
   CodeCompleteConsumer *CodeCompleter;
 
@@ -541,6 +553,12 @@ public:
 
   std::unique_ptr<sema::FunctionScopeInfo> PreallocatedFunctionScope;
 
+  /// Function and lambda scopes that have been popped, kept for reuse by
+  /// PushFunctionScope() and PushLambdaScope() so that nested functions and
+  /// lambdas neither allocate their scopes nor regrow their containers.
+  SmallVector<std::unique_ptr<sema::FunctionScopeInfo>, 4> FunctionScopePool;
+  SmallVector<std::unique_ptr<sema::LambdaScopeInfo>, 4> LambdaScopePool;
+
   /// Stack containing information about each of the nested
   /// function, block, and method scopes that are currently active.
   SmallVector<sema::FunctionScopeInfo *, 4> FunctionScopes;
@@ -1103,6 +1121,24 @@ public:
   /// The number of SFINAE diagnostics that have been trapped.
   unsigned NumSFINAEErrors;
 
+  /// Whether the last diagnostic that was suppressed in a SFINAE context was
+  /// dropped instead of being stored with the template-deduction information,
+  /// because it would have been ignored anyway. Its notes are dropped too.
+  bool DroppedSuppressedDiagnostic = false;
+
+  /// The number of overload candidates that were found not to be viable
+  /// from the number of call arguments alone, before any conversion sequence
+  /// was formed or any template argument deduced.
+  unsigned NumCandidatesRejectedEarly;
+
+  /// Statistics about the implicit instantiations performed from the queue
+  /// of pending instantiations. A wave is the set of instantiations that were
+  /// all queued before any of them was performed; the instantiations queued
+  /// while performing one wave make up the next.
+  unsigned NumPendingInstantiationsPerformed;
+  unsigned NumPendingInstantiationWaves;
+  unsigned MaxPendingInstantiationWave;
+
   typedef llvm::DenseMap<ParmVarDecl *, llvm::TinyPtrVector<ParmVarDecl *>>
     UnparsedDefaultArgInstantiationsMap;
 
@@ -2050,6 +2086,21 @@ public:
   Decl *ActOnFinishFunctionBody(Decl *Decl, Stmt *Body);
   Decl *ActOnFinishFunctionBody(Decl *Decl, Stmt *Body, bool IsInstantiation);
   Decl *ActOnSkippedFunctionBody(Decl *Decl);
+
+  /// Parse the body of \p FD if the parser deferred it.
+  ///
+  /// Bodies are only deferred when the parser was asked to skip function
+  /// bodies and to keep them.  They can be parsed once the end of the
+  /// translation unit has been reached, while the parser is still alive, for
+  /// instance from \c ASTConsumer::HandleTranslationUnit.  Names are looked up
+  /// as at the end of the translation unit.
+  ///
+  /// \returns true if the body of \p FD was parsed.
+  bool ParseDeferredFunctionBody(FunctionDecl *FD);
+
+  /// Parse the deferred bodies of all functions whose body overlaps
+  /// \p Range.
+  void ParseDeferredFunctionBodies(SourceRange Range);
   void ActOnFinishInlineFunctionDef(FunctionDecl *D);
 
   /// ActOnFinishDelayedAttribute - Invoked when we have finished parsing an
@@ -3225,6 +3276,7 @@ public:
   CXXMethodDecl *LookupMovingAssignment(CXXRecordDecl *Class, unsigned Quals,
                                         bool RValueThis, unsigned ThisQuals);
   CXXDestructorDecl *LookupDestructor(CXXRecordDecl *Class);
+  bool hasTrivialUsableDestructor(const CXXRecordDecl *Class);
 
   bool checkLiteralOperatorId(const CXXScopeSpec &SS, const UnqualifiedId &Id);
   LiteralOperatorLookupResult LookupLiteralOperator(Scope *S, LookupResult &R,
@@ -4241,6 +4293,10 @@ public:
   ExprResult ActOnStringLiteral(ArrayRef<Token> StringToks,
                                 Scope *UDLScope = nullptr);
 
+  /// ActOnEmbedExpr - The bytes of a file named by an \#embed directive,
+  /// which initialize an array of character type.
+  ExprResult ActOnEmbedExpr(SourceRange Range, StringRef Data);
+
   ExprResult ActOnGenericSelectionExpr(SourceLocation KeyLoc,
                                        SourceLocation DefaultLoc,
                                        SourceLocation RParenLoc,
@@ -7601,6 +7657,10 @@ public:
   /// given location are ignored if typo correction already failed for it.
   IdentifierSourceLocations TypoCorrectionFailures;
 
+  /// The names of the external identifier source, indexed for typo
+  /// correction. Built the first time a typo is corrected.
+  std::unique_ptr<TypoCorrectionNameIndex> ExternalTypoCorrectionNames;
+
   /// Worker object for performing CFG-based warnings.
   sema::AnalysisBasedWarnings AnalysisWarnings;
   threadSafety::BeforeSet *ThreadSafetyDeclCache;
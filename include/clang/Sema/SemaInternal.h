@@ -122,6 +122,33 @@ getDepthAndIndex(UnexpandedParameterPack UPP) {
   return getDepthAndIndex(UPP.first.get<NamedDecl *>());
 }
 
+/// The identifiers known to an external identifier source, grouped by
+/// length, for typo correction.
+///
+/// Walking the external identifier table is expensive when many modules or a
+/// large PCH are loaded, and most of its names are too long or too short to
+/// be within the edit distance that typo correction accepts. The names are
+/// read once, and read again only when new external sources are loaded.
+class TypoCorrectionNameIndex {
+public:
+  /// Make sure the index reflects the identifiers of \p External at
+  /// generation \p Generation of the external AST source.
+  void update(IdentifierInfoLookup &External, uint32_t Generation);
+
+  /// Get the names of exactly \p Length characters.
+  ArrayRef<StringRef> getNamesOfLength(unsigned Length) const {
+    if (Length >= NamesByLength.size())
+      return None;
+    return NamesByLength[Length];
+  }
+
+private:
+  llvm::BumpPtrAllocator Allocator;
+  std::vector<std::vector<StringRef>> NamesByLength;
+  uint32_t Generation = 0;
+  bool IsBuilt = false;
+};
+
 class TypoCorrectionConsumer : public VisibleDeclConsumer {
   typedef SmallVector<TypoCorrection, 1> TypoResultList;
   typedef llvm::StringMap<TypoResultList> TypoResultsMap;
@@ -42,7 +42,7 @@ namespace serialization {
     /// Version 4 of AST files also requires that the version control branch and
     /// revision match exactly, since there is no backward compatibility of
     /// AST files at this time.
-    const unsigned VERSION_MAJOR = 7;
+    const unsigned VERSION_MAJOR = 8;
 
     /// AST file minor version number supported by this version of
     /// Clang.
@@ -54,6 +54,16 @@ namespace serialization {
     /// should be increased.
     const unsigned VERSION_MINOR = 0;
 
+    /// The magic number of an AST file that was compressed as a whole.
+    ///
+    /// Such a file starts with this magic number, followed by the version
+    /// of the compressed format (u32) and the size of the uncompressed AST
+    /// file (u64), followed by the zlib-compressed AST file.
+    const char COMPRESSED_AST_FILE_MAGIC[] = {'C', 'P', 'C', 'Z'};
+
+    /// The version of the compressed AST file format.
+    const unsigned COMPRESSED_AST_FILE_VERSION = 1;
+
     /// An ID number that refers to an identifier in an AST file.
     ///
     /// The ID numbers of identifiers are consecutive (in order of discovery)
@@ -648,7 +658,24 @@ namespace serialization {
       PP_CONDITIONAL_STACK = 62,
 
       /// A table of skipped ranges within the preprocessing record.
-      PPD_SKIPPED_RANGES = 63
+      PPD_SKIPPED_RANGES = 63,
+
+      /// Record code for the number of types of each type class in the
+      /// TYPE_OFFSET record, indexed by Type::TypeClass.
+      TYPE_CLASS_COUNTS = 64,
+
+      /// Record code for the layouts of the records that were laid out
+      /// while building the AST file.
+      RECORD_LAYOUTS = 65,
+
+      /// Record code for the Bloom filter over the identifiers in the
+      /// IDENTIFIER_TABLE.
+      IDENTIFIER_FILTER = 66,
+
+      /// Record code for the first local redeclarations of imported
+      /// declarations, as pairs of the imported first declaration and the
+      /// local redeclaration.
+      IMPORTED_REDECLARATIONS = 67
     };
 
     /// Record types used within a source manager block.
@@ -1268,13 +1295,16 @@ namespace serialization {
 
       /// The internal '__type_pack_element' template.
       PREDEF_DECL_TYPE_PACK_ELEMENT_ID = 16,
+
+      /// The internal '__type_pack_slice' template.
+      PREDEF_DECL_TYPE_PACK_SLICE_ID = 17,
     };
 
     /// The number of declaration IDs that are predefined.
     ///
     /// For more information about predefined declarations, see the
     /// \c PredefinedDeclIDs type and the PREDEF_DECL_*_ID constants.
-    const unsigned int NUM_PREDEF_DECL_IDS = 17;
+    const unsigned int NUM_PREDEF_DECL_IDS = 18;
 
     /// Record of updates for a declaration that was modified after
     /// being deserialized. This can occur within DECLTYPES_BLOCK_ID.
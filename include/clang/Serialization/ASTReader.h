@@ -40,10 +40,12 @@
 #include "clang/Serialization/Module.h"
 #include "clang/Serialization/ModuleFileExtension.h"
 #include "clang/Serialization/ModuleManager.h"
+#include "clang/Serialization/SourceLocationEncoding.h"
 #include "llvm/ADT/APFloat.h"
 #include "llvm/ADT/APInt.h"
 #include "llvm/ADT/APSInt.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
@@ -332,6 +334,7 @@ class ReadMethodPoolVisitor;
 namespace reader {
 
 class ASTIdentifierLookupTrait;
+class InputValidationManifest;
 
 /// The on-disk hash table(s) used for DeclContext name lookup.
 struct DeclContextLookupTable;
@@ -528,6 +531,12 @@ private:
   /// to apply once we finish processing an import.
   llvm::SmallVector<PendingUpdateRecord, 16> PendingUpdateRecords;
 
+  /// The record layouts stored in the loaded AST files that have not been
+  /// read yet, by the global ID of their record. Each refers to the module
+  /// file and the index of the layout in its RECORD_LAYOUTS record.
+  llvm::DenseMap<serialization::DeclID, std::pair<ModuleFile *, unsigned>>
+      UnreadRecordLayouts;
+
   enum class PendingFakeDefinitionKind { NotFake, Fake, FakeLoaded };
 
   /// The DefinitionData pointers that we faked up for class definitions
@@ -934,6 +943,11 @@ private:
   /// Whether validate system input files.
   bool ValidateSystemInputs;
 
+  /// The AST files validated earlier in this build session, if
+  /// -fmodules-validation-manifest is in use and has been loaded.
+  std::unique_ptr<serialization::reader::InputValidationManifest>
+      ValidationManifest;
+
   /// Whether we are allowed to use the global module index.
   bool UseGlobalIndex;
 
@@ -980,6 +994,10 @@ private:
   /// The number of lookups into identifier tables that succeed.
   unsigned NumIdentifierLookupHits = 0;
 
+  /// The number of lookups into identifier tables that the identifier
+  /// filter of the AST file avoided.
+  unsigned NumIdentifierLookupsFiltered = 0;
+
   /// The number of selectors that have been read.
   unsigned NumSelectorsRead = 0;
 
@@ -1023,6 +1041,10 @@ private:
   /// passing decls to consumer.
   bool PassingDeclsToConsumer = false;
 
+  /// Whether the consumer wants the "interesting" decls at all.  Until the
+  /// consumer is known, they are collected in case it does.
+  bool ConsumerWantsInterestingDecls = true;
+
   /// The set of identifiers that were read while the AST reader was
   /// (recursively) loading declarations.
   ///
@@ -1137,6 +1159,22 @@ private:
   /// entity. These are the IDs that we use as keys when finding redecl chains.
   KeyDeclsMap KeyDecls;
 
+  /// A mapping from the global ID of an imported first declaration to the
+  /// global IDs of the first local redeclarations of it in the modules that
+  /// imported it, read from their IMPORTED_REDECLARATIONS records.
+  llvm::DenseMap<serialization::DeclID, SmallVector<serialization::DeclID, 2>>
+      ImportedRedecls;
+
+  /// For each canonical declaration whose redeclaration chain has been
+  /// completed, the number of loaded module files at the time.
+  llvm::DenseMap<const Decl *, unsigned> CompletedRedeclChains;
+
+  /// For each module file, the module files that import it or that it
+  /// imports, directly or indirectly, as a set of ModuleFile::Index values,
+  /// and the number of loaded module files that the set was computed for.
+  llvm::DenseMap<ModuleFile *, std::pair<unsigned, llvm::BitVector>>
+      RelatedModuleFiles;
+
   /// A mapping from DeclContexts to the semantic DeclContext that we
   /// are treating as the definition of the entity. This is used, for instance,
   /// when merging implicit instantiations of class templates across modules.
@@ -1202,6 +1240,11 @@ private:
 
   llvm::DenseMap<const Decl *, bool> DefinitionSource;
 
+  /// Whether this compilation provides the definitions that the given AST
+  /// file leaves to the object file built along with it, that is, whether
+  /// it builds that object file.
+  bool providesExternalDefinitions(const ModuleFile &F) const;
+
   /// Reads a statement from the specified cursor.
   Stmt *ReadStmtFromStream(ModuleFile &F);
 
@@ -1217,6 +1260,10 @@ private:
   /// Reads the stored information about an input file.
   InputFileInfo readInputFileInfo(ModuleFile &F, unsigned ID);
 
+  /// Load the input validation manifest of this build session, if any.
+  serialization::reader::InputValidationManifest *
+  getInputValidationManifest();
+
   /// Retrieve the file entry and 'overridden' bit for an input
   /// file in the given module file.
   serialization::InputFile getInputFile(ModuleFile &F, unsigned ID,
@@ -1256,6 +1303,16 @@ public:
         Visit(GetExistingDecl(ID));
   }
 
+  /// Returns the module files that import \p M or that \p M imports,
+  /// directly or indirectly.
+  const llvm::BitVector &getRelatedModuleFiles(ModuleFile &M);
+
+  /// Load the redeclarations of \p D that the IMPORTED_REDECLARATIONS
+  /// records of the loaded modules name, and return true if no module loaded
+  /// since its redeclaration chain was last completed can contain any other
+  /// redeclaration of it.
+  bool completeRedeclChainFromIndex(const Decl *D);
+
   /// Get the loaded lookup tables for \p Primary, if any.
   const serialization::reader::DeclContextLookupTable *
   getLoadedLookupTables(DeclContext *Primary) const;
@@ -1686,6 +1743,16 @@ public:
                           ASTReaderListener &Listener,
                           bool ValidateDiagnosticOptions);
 
+  /// Get the serialized AST out of the contents \p Bytes of an AST file's
+  /// container, decompressing it into \p Decompressed if the AST file was
+  /// compressed.
+  ///
+  /// \returns the serialized AST, or an empty string if the compressed
+  /// AST is damaged.
+  static StringRef
+  decompressASTFile(StringRef Bytes,
+                    std::unique_ptr<llvm::MemoryBuffer> &Decompressed);
+
   /// Determine whether the given AST file is acceptable to load into a
   /// translation unit with the given language and target options.
   static bool isAcceptableASTFile(StringRef Filename, FileManager &FileMgr,
@@ -1948,6 +2015,11 @@ public:
   /// the ASTConsumer.
   void StartTranslationUnit(ASTConsumer *Consumer) override;
 
+  /// Read the layout of \p Record, if the AST file that defines it stored
+  /// one.
+  const ASTRecordLayout *
+  getStoredRecordLayout(const RecordDecl *Record) override;
+
   /// Print some statistics about AST usage.
   void PrintStats() override;
 
@@ -2180,13 +2252,16 @@ public:
 
   /// Read a source location from raw form and return it in its
   /// originating module file's source location space.
-  SourceLocation ReadUntranslatedSourceLocation(uint32_t Raw) const {
-    return SourceLocation::getFromRawEncoding((Raw >> 1) | (Raw << 31));
+  SourceLocation
+  ReadUntranslatedSourceLocation(uint64_t Raw,
+                                 SourceLocationSequence *Seq = nullptr) const {
+    return Seq ? Seq->decode(Raw) : SourceLocationEncoding::decode(Raw);
   }
 
   /// Read a source location from raw form.
-  SourceLocation ReadSourceLocation(ModuleFile &ModuleFile, uint32_t Raw) const {
-    SourceLocation Loc = ReadUntranslatedSourceLocation(Raw);
+  SourceLocation ReadSourceLocation(ModuleFile &ModuleFile, uint64_t Raw,
+                                    SourceLocationSequence *Seq = nullptr) const {
+    SourceLocation Loc = ReadUntranslatedSourceLocation(Raw, Seq);
     return TranslateSourceLocation(ModuleFile, Loc);
   }
 
@@ -2203,16 +2278,19 @@ public:
     return Loc.getLocWithOffset(Remap);
   }
 
-  /// Read a source location.
+  /// Read a source location, which is part of the sequence \p Seq if
+  /// given.
   SourceLocation ReadSourceLocation(ModuleFile &ModuleFile,
                                     const RecordDataImpl &Record,
-                                    unsigned &Idx) {
-    return ReadSourceLocation(ModuleFile, Record[Idx++]);
+                                    unsigned &Idx,
+                                    SourceLocationSequence *Seq = nullptr) {
+    return ReadSourceLocation(ModuleFile, Record[Idx++], Seq);
   }
 
-  /// Read a source range.
+  /// Read a source range, which is part of the sequence \p Seq if given.
   SourceRange ReadSourceRange(ModuleFile &F,
-                              const RecordData &Record, unsigned &Idx);
+                              const RecordData &Record, unsigned &Idx,
+                              SourceLocationSequence *Seq = nullptr);
 
   /// Read an integral value
   llvm::APInt ReadAPInt(const RecordData &Record, unsigned &Idx);
@@ -2595,13 +2673,13 @@ public:
   }
 
   /// Read a source location, advancing Idx.
-  SourceLocation readSourceLocation() {
-    return Reader->ReadSourceLocation(*F, Record, Idx);
+  SourceLocation readSourceLocation(SourceLocationSequence *Seq = nullptr) {
+    return Reader->ReadSourceLocation(*F, Record, Idx, Seq);
   }
 
   /// Read a source range, advancing Idx.
-  SourceRange readSourceRange() {
-    return Reader->ReadSourceRange(*F, Record, Idx);
+  SourceRange readSourceRange(SourceLocationSequence *Seq = nullptr) {
+    return Reader->ReadSourceRange(*F, Record, Idx, Seq);
   }
 
   /// Read an integral value, advancing Idx.
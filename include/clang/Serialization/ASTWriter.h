@@ -30,6 +30,7 @@
 #include "clang/Sema/SemaConsumer.h"
 #include "clang/Serialization/ASTBitCodes.h"
 #include "clang/Serialization/ASTDeserializationListener.h"
+#include "clang/Serialization/SourceLocationEncoding.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DenseSet.h"
@@ -156,6 +157,11 @@ private:
   /// file is up to date, but not otherwise.
   bool IncludeTimestamps;
 
+  /// Indicates whether the contents of the source buffers stored in the
+  /// produced file are compressed. Uncompressed buffers are used in place by
+  /// the reader, rather than decompressed into a copy.
+  bool CompressEmbeddedBuffers;
+
   /// Indicates when the AST writing is actively performing
   /// serialization, rather than just queueing updates.
   bool WritingAST = false;
@@ -255,6 +261,10 @@ private:
   /// the type's ID.
   std::vector<uint32_t> TypeOffsets;
 
+  /// The number of types written to the bitstream, indexed by their
+  /// Type::TypeClass.
+  RecordData NumTypesByClass;
+
   /// The first ID number we can use for our own identifiers.
   serialization::IdentID FirstIdentID = serialization::NUM_PREDEF_IDENT_IDS;
 
@@ -400,6 +410,12 @@ private:
   SmallVector<uint64_t, 16> EagerlyDeserializedDecls;
   SmallVector<uint64_t, 16> ModularCodegenDecls;
 
+  /// Pairs of an imported first declaration and the first local
+  /// redeclaration of it, to be written to the IMPORTED_REDECLARATIONS record
+  /// so that readers can find the redeclarations of a declaration without
+  /// looking up its name in every module.
+  SmallVector<uint64_t, 16> ImportedRedeclarations;
+
   /// DeclContexts that have received extensions since their serialized
   /// form.
   ///
@@ -507,6 +523,7 @@ private:
   void WriteOpenCLExtensionDecls(Sema &SemaRef);
   void WriteCUDAPragmas(Sema &SemaRef);
   void WriteObjCCategories();
+  void WriteRecordLayouts();
   void WriteLateParsedTemplates(Sema &SemaRef);
   void WriteOptimizePragmaOptions(Sema &SemaRef);
   void WriteMSStructPragmaOptions(Sema &SemaRef);
@@ -545,11 +562,20 @@ public:
   ASTWriter(llvm::BitstreamWriter &Stream, SmallVectorImpl<char> &Buffer,
             MemoryBufferCache &PCMCache,
             ArrayRef<std::shared_ptr<ModuleFileExtension>> Extensions,
-            bool IncludeTimestamps = true);
+            bool IncludeTimestamps = true,
+            bool CompressEmbeddedBuffers = true);
   ~ASTWriter() override;
 
   const LangOptions &getLangOpts() const;
 
+  /// Whether the ODR hashes of the definitions in this AST file may be
+  /// needed by its readers.
+  ///
+  /// Readers only compare ODR hashes when they merge definitions from
+  /// different modules, so a hash that has not been computed yet is left
+  /// out of an AST file built without modules.
+  bool needsODRHashes() const { return getLangOpts().Modules; }
+
   /// Get a timestamp for output into the AST file. The actual timestamp
   /// of the specified file may be ignored if we have been instructed to not
   /// include timestamps in the output file.
@@ -576,11 +602,13 @@ public:
   /// Emit a token.
   void AddToken(const Token &Tok, RecordDataImpl &Record);
 
-  /// Emit a source location.
-  void AddSourceLocation(SourceLocation Loc, RecordDataImpl &Record);
+  /// Emit a source location, as part of the sequence \p Seq if given.
+  void AddSourceLocation(SourceLocation Loc, RecordDataImpl &Record,
+                         SourceLocationSequence *Seq = nullptr);
 
-  /// Emit a source range.
-  void AddSourceRange(SourceRange Range, RecordDataImpl &Record);
+  /// Emit a source range, as part of the sequence \p Seq if given.
+  void AddSourceRange(SourceRange Range, RecordDataImpl &Record,
+                      SourceLocationSequence *Seq = nullptr);
 
   /// Emit a reference to an identifier.
   void AddIdentifierRef(const IdentifierInfo *II, RecordDataImpl &Record);
@@ -844,13 +872,15 @@ public:
   void AddFunctionDefinition(const FunctionDecl *FD);
 
   /// Emit a source location.
-  void AddSourceLocation(SourceLocation Loc) {
-    return Writer->AddSourceLocation(Loc, *Record);
+  void AddSourceLocation(SourceLocation Loc,
+                         SourceLocationSequence *Seq = nullptr) {
+    return Writer->AddSourceLocation(Loc, *Record, Seq);
   }
 
   /// Emit a source range.
-  void AddSourceRange(SourceRange Range) {
-    return Writer->AddSourceRange(Range, *Record);
+  void AddSourceRange(SourceRange Range,
+                      SourceLocationSequence *Seq = nullptr) {
+    return Writer->AddSourceRange(Range, *Record, Seq);
   }
 
   /// Emit an integral value.
@@ -963,6 +993,13 @@ public:
   void AddAttributes(ArrayRef<const Attr*> Attrs);
 };
 
+/// Compress the serialized AST in \p Data as a whole, in the format that
+/// ASTReader::decompressASTFile() reads.
+///
+/// \returns true if the AST could not be compressed, in which case \p Data
+/// is left alone.
+bool compressASTFile(SmallVectorImpl<char> &Data);
+
 /// AST and semantic-analysis consumer that generates a
 /// precompiled header from the parsed source code.
 class PCHGenerator : public SemaConsumer {
@@ -974,6 +1011,7 @@ class PCHGenerator : public SemaConsumer {
   llvm::BitstreamWriter Stream;
   ASTWriter Writer;
   bool AllowASTWithErrors;
+  bool CompressAST;
 
 protected:
   ASTWriter &getWriter() { return Writer; }
@@ -984,7 +1022,8 @@ public:
   PCHGenerator(const Preprocessor &PP, StringRef OutputFile, StringRef isysroot,
                std::shared_ptr<PCHBuffer> Buffer,
                ArrayRef<std::shared_ptr<ModuleFileExtension>> Extensions,
-               bool AllowASTWithErrors = false, bool IncludeTimestamps = true);
+               bool AllowASTWithErrors = false, bool IncludeTimestamps = true,
+               bool CompressAST = false, bool CompressEmbeddedBuffers = true);
   ~PCHGenerator() override;
 
   void InitializeSema(Sema &S) override { SemaPtr = &S; }
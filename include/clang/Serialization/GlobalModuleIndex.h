@@ -16,6 +16,7 @@
 #ifndef LLVM_CLANG_SERIALIZATION_GLOBALMODULEINDEX_H
 #define LLVM_CLANG_SERIALIZATION_GLOBALMODULEINDEX_H
 
+#include "clang/Basic/Module.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
@@ -69,7 +70,7 @@ class GlobalModuleIndex {
 
   /// Information about a given module file.
   struct ModuleInfo {
-    ModuleInfo() : File(), Size(), ModTime() { }
+    ModuleInfo() : File(), Size(), ModTime(), Signature() { }
 
     /// The module file, once it has been resolved.
     ModuleFile *File;
@@ -87,6 +88,9 @@ class GlobalModuleIndex {
     /// The module IDs on which this module directly depends.
     /// FIXME: We don't really need a vector here.
     llvm::SmallVector<unsigned, 4> Dependencies;
+
+    /// The signature of the module file, if it has one.
+    ASTFileSignature Signature;
   };
 
   /// A mapping from module IDs to information about each module.
@@ -188,7 +192,11 @@ public:
   /// Print debugging view to standard error.
   void dump();
 
-  /// Write a global index into the given
+  /// Write a global index into the given directory.
+  ///
+  /// If the directory already has an index, the module files that haven't
+  /// changed since it was written are taken over from it rather than read
+  /// again, so that only new and rebuilt module files are loaded.
   ///
   /// \param FileMgr The file manager to use to load module files.
   /// \param PCHContainerRdr - The PCHContainerOperations to use for loading and
@@ -27,6 +27,7 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Bitcode/BitstreamReader.h"
 #include "llvm/Support/Endian.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include <cassert>
 #include <cstdint>
 #include <memory>
@@ -178,6 +179,9 @@ public:
   /// this AST file, owned by the PCMCache in the ModuleManager.
   llvm::MemoryBuffer *Buffer;
 
+  /// The decompressed serialized AST, if the AST file was compressed.
+  std::unique_ptr<llvm::MemoryBuffer> DecompressedBuffer;
+
   /// The size of this file, in bits.
   uint64_t SizeInBits = 0;
 
@@ -288,6 +292,10 @@ public:
   /// IdentifierHashTable.
   void *IdentifierLookupTable = nullptr;
 
+  /// The Bloom filter over the identifiers in IdentifierLookupTable, or
+  /// empty if the AST file has none.
+  StringRef IdentifierFilterData;
+
   /// Offsets of identifiers that we're going to preload within
   /// IdentifierTableData.
   std::vector<unsigned> PreloadIdentifierOffsets;
@@ -442,6 +450,12 @@ public:
   /// module.
   SmallVector<uint64_t, 1> ObjCCategories;
 
+  // === Record layouts ===
+
+  /// The layouts of the records that were laid out while building this
+  /// module, each prefixed with the local ID of its record and its length.
+  SmallVector<uint64_t, 1> RecordLayouts;
+
   // === Types ===
 
   /// The number of types in this AST file.
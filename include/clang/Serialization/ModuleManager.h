@@ -24,15 +24,23 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/iterator.h"
 #include "llvm/ADT/iterator_range.h"
 #include <cstdint>
 #include <ctime>
+#include <future>
 #include <memory>
 #include <string>
 #include <utility>
 
+namespace llvm {
+
+class ThreadPool;
+
+} // namespace llvm
+
 namespace clang {
 
 class FileEntry;
@@ -80,6 +88,28 @@ class ModuleManager {
   llvm::DenseMap<const FileEntry *, std::unique_ptr<llvm::MemoryBuffer>>
       InMemoryBuffers;
 
+  /// A module file that is being read in the background.
+  struct PrefetchedModuleFile {
+    /// Becomes ready once \c Buffer has been set.
+    std::shared_future<void> Ready;
+
+    /// The contents of the file, or null if it could not be read.
+    std::unique_ptr<llvm::MemoryBuffer> Buffer;
+  };
+
+  /// The module files that are being read in the background, by the names
+  /// that they will be loaded by.
+  llvm::StringMap<PrefetchedModuleFile> PrefetchedModuleFiles;
+
+  /// The threads that read the prefetched module files. It is declared after
+  /// the files, so that it finishes reading them before they are destroyed.
+  std::unique_ptr<llvm::ThreadPool> PrefetchPool;
+
+  /// Take the prefetched contents of the given module file, if they are
+  /// still those of \p Entry.
+  std::unique_ptr<llvm::MemoryBuffer>
+  takePrefetchedBuffer(StringRef FileName, const FileEntry *Entry);
+
   /// The visitation order.
   SmallVector<ModuleFile *, 4> VisitOrder;
 
@@ -255,6 +285,18 @@ public:
                             ModuleFile *&Module,
                             std::string &ErrorStr);
 
+  /// Start reading the given module files in the background.
+  ///
+  /// The AST reader calls this with all the files that a module file imports
+  /// before it loads them one after another, so that the contents of the
+  /// later ones are read while the earlier ones are validated and loaded.
+  /// addModule() still checks the files as usual and reads them itself if
+  /// they changed in the meantime.
+  void prefetchModuleFiles(ArrayRef<std::string> FileNames);
+
+  /// Drop the contents of the prefetched module files that were not loaded.
+  void clearPrefetchedModuleFiles();
+
   /// Remove the modules starting from First (to the end).
   void removeModules(ModuleIterator First,
                      llvm::SmallPtrSetImpl<ModuleFile *> &LoadedSuccessfully,
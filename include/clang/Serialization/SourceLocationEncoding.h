@@ -0,0 +1,97 @@
+//===--- SourceLocationEncoding.h - Source locations in AST files -*- C++ -*-=//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines how source locations are encoded in AST files.
+//
+// A source location is written as its raw encoding, rotated left by one bit
+// so that the macro bit becomes the lowest bit: nearby locations, whether
+// file or macro locations, then have similar small values, which the VBR
+// encoding of the records stores compactly.
+//
+// The locations of a sequence that are strongly correlated, such as those of
+// one TypeLoc, can further be written as the differences between consecutive
+// locations. The first valid location of the sequence is written as is and
+// each following one as the zig-zag encoded difference to the previous valid
+// location, plus one; an invalid location is written as zero.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_SERIALIZATION_SOURCELOCATIONENCODING_H
+#define LLVM_CLANG_SERIALIZATION_SOURCELOCATIONENCODING_H
+
+#include "clang/Basic/SourceLocation.h"
+#include <cstdint>
+
+namespace clang {
+
+/// Encodes and decodes single source locations.
+class SourceLocationEncoding {
+public:
+  /// Encode a raw source location.
+  static uint32_t encodeRaw(uint32_t Raw) { return (Raw << 1) | (Raw >> 31); }
+
+  /// Decode a raw source location.
+  static uint32_t decodeRaw(uint32_t Encoded) {
+    return (Encoded >> 1) | (Encoded << 31);
+  }
+
+  static uint64_t encode(SourceLocation Loc) {
+    return encodeRaw(Loc.getRawEncoding());
+  }
+
+  static SourceLocation decode(uint64_t Encoded) {
+    return SourceLocation::getFromRawEncoding(decodeRaw(Encoded));
+  }
+};
+
+/// Encodes or decodes a sequence of correlated source locations.
+///
+/// The same sequence of locations must be encoded and decoded in the same
+/// order; each record that uses a sequence owns it for the locations of one
+/// entity, so that the locations can still be read independently of those of
+/// the other entities.
+class SourceLocationSequence {
+  /// The encoded value of the previous valid location of the sequence, or
+  /// zero if there was none.
+  uint32_t Prev = 0;
+
+  static uint32_t zigZag(uint32_t V) {
+    return (V << 1) ^ (uint32_t)((int32_t)V >> 31);
+  }
+
+  static uint32_t unZigZag(uint32_t V) { return (V >> 1) ^ -(V & 1); }
+
+public:
+  uint64_t encode(SourceLocation Loc) {
+    uint32_t Encoded = SourceLocationEncoding::encode(Loc);
+    if (Encoded == 0)
+      return 0;
+    if (Prev == 0)
+      return Prev = Encoded;
+    uint32_t Delta = Encoded - Prev;
+    Prev = Encoded;
+    // Zero is the invalid location, so a zero difference is written as one.
+    // The largest difference thus needs 33 bits.
+    return uint64_t(zigZag(Delta)) + 1;
+  }
+
+  SourceLocation decode(uint64_t Encoded) {
+    if (Encoded == 0)
+      return SourceLocation();
+    if (Prev == 0)
+      Prev = Encoded;
+    else
+      Prev += unZigZag(uint32_t(Encoded - 1));
+    return SourceLocationEncoding::decode(Prev);
+  }
+};
+
+} // namespace clang
+
+#endif // LLVM_CLANG_SERIALIZATION_SOURCELOCATIONENCODING_H
@@ -126,6 +126,7 @@ enum class ExplorationStrategyKind {
   UnexploredFirstQueue,
   UnexploredFirstLocationQueue,
   BFSBlockDFSContents,
+  CoverageGuidedQueue,
 };
 
 /// Describes the kinds for high-level analyzer mode.
@@ -25,10 +25,12 @@
 #include "clang/StaticAnalyzer/Core/PathSensitive/SymExpr.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ExplodedGraph.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/FoldingSet.h"
 #include "llvm/ADT/ImmutableSet.h"
 #include "llvm/ADT/None.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringMap.h"
@@ -58,6 +60,7 @@ class BugType;
 class CheckerBase;
 class ExplodedGraph;
 class ExplodedNode;
+class TrimmedGraph;
 class ExprEngine;
 class MemRegion;
 class SValBuilder;
@@ -441,6 +444,11 @@ protected:
   BugReporter(BugReporterData& d, Kind k)
       : BugTypes(F.getEmptySet()), kind(k), D(d) {}
 
+  /// Returns the equivalence classes in the order they were created.
+  ArrayRef<BugReportEquivClass *> getEquivalenceClasses() const {
+    return EQClassesVector;
+  }
+
 public:
   BugReporter(BugReporterData& d)
       : BugTypes(F.getEmptySet()), kind(BaseBRKind), D(d) {}
@@ -513,9 +521,20 @@ private:
 class GRBugReporter : public BugReporter {
   ExprEngine& Eng;
 
+  /// The exploded graph trimmed to the error nodes of all the reports, which
+  /// is shared by the equivalence classes, since their paths mostly overlap.
+  std::unique_ptr<TrimmedGraph> SharedTrimmedGraph;
+
+  /// The number of nodes of the exploded graph when the trimmed graph was
+  /// created.
+  unsigned SharedTrimmedGraphSize = 0;
+
+  /// Returns the trimmed graph that contains all of \p ErrorNodes, creating
+  /// it from the error nodes of all the reports if needed.
+  TrimmedGraph &getTrimmedGraph(ArrayRef<const ExplodedNode *> ErrorNodes);
+
 public:
-  GRBugReporter(BugReporterData& d, ExprEngine& eng)
-      : BugReporter(d, GRBugReporterKind), Eng(eng) {}
+  GRBugReporter(BugReporterData& d, ExprEngine& eng);
 
   ~GRBugReporter() override;
 
@@ -554,15 +573,55 @@ public:
   }
 };
 
+/// The results of the bug reporter visitors at nodes of the original
+/// exploded graph that do not depend on the report being visited. They are
+/// shared by the reports of one equivalence class, whose paths mostly visit
+/// the same nodes.
+///
+/// A node of the original graph has the same predecessor on the paths of all
+/// the reports, as the paths are taken from the same trimmed graph.
+class VisitorResultCache {
+  /// Nodes at which ConditionBRVisitor found no branch condition to explain.
+  llvm::DenseSet<const ExplodedNode *> NodesWithoutConditions;
+
+  using TrackedValue = std::pair<const MemRegion *, SVal>;
+
+  /// Nodes at which FindLastStoreBRVisitor found that a value was not stored
+  /// to a region.
+  llvm::DenseMap<const ExplodedNode *, SmallVector<TrackedValue, 2>>
+      NodesWithoutStores;
+
+public:
+  bool hasNoCondition(const ExplodedNode *N) const {
+    return NodesWithoutConditions.count(N);
+  }
+
+  void noteNoCondition(const ExplodedNode *N) {
+    NodesWithoutConditions.insert(N);
+  }
+
+  bool hasNoStoreOf(const ExplodedNode *N, const MemRegion *R, SVal V) const {
+    auto I = NodesWithoutStores.find(N);
+    return I != NodesWithoutStores.end() &&
+           llvm::is_contained(I->second, TrackedValue(R, V));
+  }
+
+  void noteNoStoreOf(const ExplodedNode *N, const MemRegion *R, SVal V) {
+    NodesWithoutStores[N].push_back(TrackedValue(R, V));
+  }
+};
+
 class BugReporterContext {
   GRBugReporter &BR;
   NodeMapClosure NMC;
+  VisitorResultCache *Cache;
 
   virtual void anchor();
 
 public:
-  BugReporterContext(GRBugReporter &br, InterExplodedGraphMap &Backmap)
-      : BR(br), NMC(Backmap) {}
+  BugReporterContext(GRBugReporter &br, InterExplodedGraphMap &Backmap,
+                     VisitorResultCache *Cache = nullptr)
+      : BR(br), NMC(Backmap), Cache(Cache) {}
 
   virtual ~BugReporterContext() = default;
 
@@ -591,6 +650,10 @@ public:
   }
 
   NodeMapClosure& getNodeResolver() { return NMC; }
+
+  /// Returns the cache of the visitor results shared with the other reports
+  /// of the equivalence class, if there is one.
+  VisitorResultCache *getVisitorCache() { return Cache; }
 };
 
 } // namespace ento
@@ -132,9 +132,27 @@ public:
   /// PathDiagnostics that span multiple files.
   virtual bool supportsCrossFileDiagnostics() const { return false; }
 
+  /// Return true if the PathDiagnosticConsumer writes out each diagnostic
+  /// as soon as it is handed one, through StreamDiagnostic(), instead of
+  /// keeping all of them until FlushDiagnosticsImpl().
+  ///
+  /// Streamed diagnostics are not sorted, and of two equivalent diagnostics
+  /// the first one is kept rather than the one with the shorter path.
+  /// FlushDiagnosticsImpl() is still called, with no diagnostics, once they
+  /// have all been streamed.
+  virtual bool isStreaming() const { return false; }
+
+  /// Write out \p D. Only called if isStreaming() returns true.
+  virtual void StreamDiagnostic(const PathDiagnostic &D) {}
+
 protected:
   bool flushed = false;
   llvm::FoldingSet<PathDiagnostic> Diags;
+
+  /// The profiles of the diagnostics that have been streamed, used to drop
+  /// equivalent ones.
+  llvm::BumpPtrAllocator StreamedProfileAlloc;
+  std::set<llvm::FoldingSetNodeIDRef> StreamedProfiles;
 };
 
 //===----------------------------------------------------------------------===//
@@ -161,6 +161,40 @@ public:
   }
 };
 
+/// A checker that only handles some calls may define
+/// \code
+///   bool handlesCall(const CallEvent &Call) const;
+/// \endcode
+/// Its PreCall and PostCall callbacks then only run for the calls this
+/// returns true for. The filter runs once per call, rather than once for
+/// every node that reaches the call, and the calls it rejects add no nodes.
+class CallFilter {
+  template <typename CHECKER>
+  static bool _handlesCall(void *checker, const CallEvent &Call) {
+    return ((const CHECKER *)checker)->handlesCall(Call);
+  }
+
+  template <typename CHECKER>
+  static auto _get(CHECKER *checker, int)
+      -> decltype(std::declval<const CHECKER &>().handlesCall(
+                      std::declval<const CallEvent &>()),
+                  Optional<CheckerManager::HandlesCallFunc>()) {
+    return CheckerManager::HandlesCallFunc(checker, _handlesCall<CHECKER>);
+  }
+
+  template <typename CHECKER>
+  static Optional<CheckerManager::HandlesCallFunc> _get(CHECKER *, long) {
+    return None;
+  }
+
+public:
+  /// Returns the call filter of \p checker, if it defines one.
+  template <typename CHECKER>
+  static Optional<CheckerManager::HandlesCallFunc> get(CHECKER *checker) {
+    return _get(checker, 0);
+  }
+};
+
 class PreCall {
   template <typename CHECKER>
   static void _checkCall(void *checker, const CallEvent &msg,
@@ -172,7 +206,8 @@ public:
   template <typename CHECKER>
   static void _register(CHECKER *checker, CheckerManager &mgr) {
     mgr._registerForPreCall(
-     CheckerManager::CheckCallFunc(checker, _checkCall<CHECKER>));
+     CheckerManager::CheckCallFunc(checker, _checkCall<CHECKER>),
+     CallFilter::get(checker));
   }
 };
 
@@ -187,7 +222,8 @@ public:
   template <typename CHECKER>
   static void _register(CHECKER *checker, CheckerManager &mgr) {
     mgr._registerForPostCall(
-     CheckerManager::CheckCallFunc(checker, _checkCall<CHECKER>));
+     CheckerManager::CheckCallFunc(checker, _checkCall<CHECKER>),
+     CallFilter::get(checker));
   }
 };
 
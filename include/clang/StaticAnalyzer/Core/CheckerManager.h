@@ -20,8 +20,11 @@
 #include "clang/StaticAnalyzer/Core/PathSensitive/Store.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Timer.h"
+#include <map>
 #include <vector>
 
 namespace clang {
@@ -141,6 +144,44 @@ public:
   using CheckerTag = const void *;
   using CheckerDtor = CheckerFn<void ()>;
 
+//===----------------------------------------------------------------------===//
+// Checker profiling.
+//===----------------------------------------------------------------------===//
+
+  /// The cost of the callbacks of one checker, as recorded when profiling is
+  /// enabled.
+  struct CheckerProfile {
+    /// The time spent in the callbacks, and the memory they allocated.
+    llvm::TimeRecord Time;
+
+    /// The number of times a callback of the checker was run.
+    unsigned NumCallbacks = 0;
+
+    /// The number of nodes the callbacks added to the exploded graph, and how
+    /// many of these have a different state than their predecessor.
+    unsigned NumNodes = 0;
+    unsigned NumStateChanges = 0;
+  };
+
+  /// Start recording the cost of every checker callback.
+  void enableProfiling() { ProfilingEnabled = true; }
+
+  /// Returns the profile of \p Checker, or null if profiling is disabled.
+  ///
+  /// The profile stays where it is while the profiles of other checkers are
+  /// created, so that the callbacks that a callback runs can record theirs.
+  CheckerProfile *getProfile(const CheckerBase *Checker) {
+    return ProfilingEnabled ? &Profiles[Checker] : nullptr;
+  }
+
+  /// The time that the callbacks run by the callback being profiled have
+  /// taken, which is not charged to its checker; null outside of callbacks.
+  llvm::TimeRecord *NestedProfileTime = nullptr;
+
+  /// Print the recorded profile of each checker, the slowest first, either
+  /// as a table or as a JSON object.
+  void printProfile(raw_ostream &OS, bool AsJSON) const;
+
 //===----------------------------------------------------------------------===//
 // registerChecker
 //===----------------------------------------------------------------------===//
@@ -491,8 +532,14 @@ public:
 
   void _registerForObjCMessageNil(CheckObjCMessageFunc checkfn);
 
-  void _registerForPreCall(CheckCallFunc checkfn);
-  void _registerForPostCall(CheckCallFunc checkfn);
+  using HandlesCallFunc = CheckerFn<bool (const CallEvent &)>;
+
+  /// Register a callback for calls. If \p isForCallFn is given, the callback
+  /// only runs for the calls it accepts.
+  void _registerForPreCall(CheckCallFunc checkfn,
+                           Optional<HandlesCallFunc> isForCallFn = None);
+  void _registerForPostCall(CheckCallFunc checkfn,
+                            Optional<HandlesCallFunc> isForCallFn = None);
 
   void _registerForLocation(CheckLocationFunc checkfn);
 
@@ -586,9 +633,12 @@ private:
   };
   std::vector<StmtCheckerInfo> StmtCheckers;
 
+  /// The checkers for each kind of statement, indexed by statement class and
+  /// by whether they pre-visit it. Each entry is filled in the first time a
+  /// statement of its class is visited, since the checkers can only tell
+  /// which statements they handle from a statement.
   using CachedStmtCheckers = SmallVector<CheckStmtFunc, 4>;
-  using CachedStmtCheckersMapTy = llvm::DenseMap<unsigned, CachedStmtCheckers>;
-  CachedStmtCheckersMapTy CachedStmtCheckersMap;
+  std::vector<Optional<CachedStmtCheckers>> CachedStmtCheckersTable;
 
   const CachedStmtCheckers &getCachedStmtCheckersFor(const Stmt *S,
                                                      bool isPreVisit);
@@ -602,8 +652,12 @@ private:
   std::vector<CheckObjCMessageFunc> PostObjCMessageCheckers;
   std::vector<CheckObjCMessageFunc> ObjCMessageNilCheckers;
 
-  std::vector<CheckCallFunc> PreCallCheckers;
-  std::vector<CheckCallFunc> PostCallCheckers;
+  struct CallCheckerInfo {
+    CheckCallFunc CheckFn;
+    Optional<HandlesCallFunc> IsForCallFn;
+  };
+  std::vector<CallCheckerInfo> PreCallCheckers;
+  std::vector<CallCheckerInfo> PostCallCheckers;
 
   std::vector<CheckLocationFunc> LocationCheckers;
 
@@ -641,6 +695,9 @@ private:
 
   using EventsTy = llvm::DenseMap<EventTag, EventInfo>;
   EventsTy Events;
+
+  bool ProfilingEnabled = false;
+  std::map<const CheckerBase *, CheckerProfile> Profiles;
 };
 
 } // namespace ento
@@ -9,7 +9,11 @@
 #ifndef LLVM_CLANG_STATICANALYZER_CORE_ISSUE_HASH_H
 #define LLVM_CLANG_STATICANALYZER_CORE_ISSUE_HASH_H
 
+#include "clang/Basic/SourceLocation.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallString.h"
+#include <string>
+#include <utility>
 
 namespace clang {
 class Decl;
@@ -17,6 +21,25 @@ class SourceManager;
 class FullSourceLoc;
 class LangOptions;
 
+/// Remembers the parts of issue hashes that many reports share, so that
+/// computing the hashes of reports on the same line or in the same function
+/// does not lex the line or print the signature again.
+///
+/// A cache must only be used with one SourceManager and one set of
+/// LangOptions.
+class IssueHashCache {
+  friend std::string GetIssueString(const SourceManager &, FullSourceLoc &,
+                                    llvm::StringRef, llvm::StringRef,
+                                    const Decl *, const LangOptions &,
+                                    IssueHashCache *);
+
+  /// The normalized text of each line, by file and line number.
+  llvm::DenseMap<std::pair<FileID, unsigned>, std::string> NormalizedLines;
+
+  /// The signature of each enclosing declaration.
+  llvm::DenseMap<const Decl *, std::string> DeclSignatures;
+};
+
 /// Get an MD5 hash to help identify bugs.
 ///
 /// This function returns a hash that helps identify bugs within a source file.
@@ -35,17 +58,22 @@ class LangOptions;
 /// possible to introduce experimental hashes that may change in the future.
 /// Such hashes should be marked as experimental using a comment in the plist
 /// files.
+///
+/// If \p Cache is given, the parts of the hash that it has seen before are
+/// taken from it.
 llvm::SmallString<32> GetIssueHash(const SourceManager &SM,
                                    FullSourceLoc &IssueLoc,
                                    llvm::StringRef CheckerName,
                                    llvm::StringRef BugType, const Decl *D,
-                                   const LangOptions &LangOpts);
+                                   const LangOptions &LangOpts,
+                                   IssueHashCache *Cache = nullptr);
 
 /// Get the string representation of issue hash. See GetIssueHash() for
 /// more information.
 std::string GetIssueString(const SourceManager &SM, FullSourceLoc &IssueLoc,
                            llvm::StringRef CheckerName, llvm::StringRef BugType,
-                           const Decl *D, const LangOptions &LangOpts);
+                           const Decl *D, const LangOptions &LangOpts,
+                           IssueHashCache *Cache = nullptr);
 } // namespace clang
 
 #endif
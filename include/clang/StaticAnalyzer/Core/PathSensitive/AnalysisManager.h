@@ -20,6 +20,11 @@
 #include "clang/StaticAnalyzer/Core/BugReporter/BugReporter.h"
 #include "clang/StaticAnalyzer/Core/BugReporter/PathDiagnostic.h"
 #include "clang/StaticAnalyzer/Core/PathDiagnosticConsumers.h"
+#include <chrono>
+
+namespace llvm {
+class Timer;
+}
 
 namespace clang {
 
@@ -43,7 +48,26 @@ class AnalysisManager : public BugReporterData {
 
   CheckerManager *CheckerMgr;
 
+  /// Times the assumptions made by the constraint managers, if the analyzer
+  /// statistics are enabled.
+  llvm::Timer *ConstraintTimer = nullptr;
+
+  using BudgetClock = std::chrono::steady_clock;
+
+  /// The time budgets of a top-level function and of the translation unit,
+  /// in milliseconds, or 0 if there is none.
+  unsigned FunctionTimeBudget;
+  unsigned TUTimeBudget;
+
+  BudgetClock::time_point TUStartTime;
+  BudgetClock::time_point FunctionStartTime;
+
+  double getTimeUsage(BudgetClock::time_point Start, unsigned Budget) const;
+
 public:
+  /// The share of the time budget after which the analysis of a function
+  /// stops, rather than only stops inlining.
+  static constexpr double TimeBudgetHardLimit = 2.0;
   AnalyzerOptions &options;
 
   AnalysisManager(ASTContext &ctx, DiagnosticsEngine &diags,
@@ -77,6 +101,9 @@ public:
 
   CheckerManager *getCheckerManager() const { return CheckerMgr; }
 
+  llvm::Timer *getConstraintTimer() const { return ConstraintTimer; }
+  void setConstraintTimer(llvm::Timer *T) { ConstraintTimer = T; }
+
   ASTContext &getASTContext() override {
     return Ctx;
   }
@@ -99,6 +126,31 @@ public:
 
   void FlushDiagnostics();
 
+  /// Start measuring the time spent on the translation unit, once its AST
+  /// has been built.
+  void startTUTimeBudget() { TUStartTime = BudgetClock::now(); }
+
+  /// Start measuring the time spent on a new top-level function.
+  void startFunctionTimeBudget() { FunctionStartTime = BudgetClock::now(); }
+
+  /// Returns the share of the time budget of the current top-level function
+  /// that has been used, or 0 if it has no budget.
+  double getFunctionTimeUsage() const {
+    return getTimeUsage(FunctionStartTime, FunctionTimeBudget);
+  }
+
+  /// Returns the share of the time budget of the translation unit that has
+  /// been used, or 0 if it has no budget.
+  double getTUTimeUsage() const {
+    return getTimeUsage(TUStartTime, TUTimeBudget);
+  }
+
+  /// Returns the larger of the shares of the function and translation unit
+  /// time budgets that have been used.
+  double getTimeBudgetUsage() const {
+    return std::max(getFunctionTimeUsage(), getTUTimeUsage());
+  }
+
   bool shouldVisualize() const {
     return options.visualizeExplodedGraphWithGraphViz;
   }
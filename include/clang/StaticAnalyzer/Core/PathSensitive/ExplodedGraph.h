@@ -302,6 +302,10 @@ protected:
   /// Counter to determine when to reclaim nodes.
   unsigned ReclaimCounter;
 
+  /// Whether nodes are reclaimed even if path diagnostics use them to place
+  /// their notes and arrows.
+  bool AggressiveReclamation = false;
+
 public:
   ExplodedGraph();
   ~ExplodedGraph();
@@ -402,8 +406,13 @@ public:
 
   /// Enable tracking of recently allocated nodes for potential reclamation
   /// when calling reclaimRecentlyAllocatedNodes().
-  void enableNodeReclamation(unsigned Interval) {
+  ///
+  /// \param Aggressive Also reclaim the nodes for lvalue expressions and for
+  ///        expressions whose value is not consumed, which path diagnostics
+  ///        only use to make their notes and arrows more precise.
+  void enableNodeReclamation(unsigned Interval, bool Aggressive = false) {
     ReclaimCounter = ReclaimNodeInterval = Interval;
+    AggressiveReclamation = Aggressive;
   }
 
   /// Reclaim "uninteresting" nodes created since the last time this method
@@ -21,7 +21,10 @@
 #include "llvm/ADT/None.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallBitVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
 #include <cassert>
+#include <cstdint>
 #include <deque>
 #include <utility>
 
@@ -38,7 +41,7 @@ class FunctionSummariesTy {
     llvm::SmallBitVector VisitedBasicBlocks;
 
     /// Total number of blocks in the function.
-    unsigned TotalBasicBlocks : 30;
+    unsigned TotalBasicBlocks : 29;
 
     /// True if this function has been checked against the rules for which
     /// functions may be inlined.
@@ -47,12 +50,15 @@ class FunctionSummariesTy {
     /// True if this function may be inlined.
     unsigned MayInline : 1;
 
+    /// True if no path through this function returns.
+    unsigned NeverReturns : 1;
+
     /// The number of times the function has been inlined.
     unsigned TimesInlined : 32;
 
     FunctionSummary()
         : TotalBasicBlocks(0), InlineChecked(0), MayInline(0),
-          TimesInlined(0) {}
+          NeverReturns(0), TimesInlined(0) {}
   };
 
   using MapTy = llvm::DenseMap<const Decl *, FunctionSummary>;
@@ -105,6 +111,25 @@ public:
     Blocks.set(ID);
   }
 
+  bool isBasicBlockVisited(unsigned ID, const Decl *D) {
+    MapTy::const_iterator I = Map.find(D);
+    if (I != Map.end())
+      return ID < I->second.VisitedBasicBlocks.size() &&
+             I->second.VisitedBasicBlocks.test(ID);
+    return false;
+  }
+
+  /// Note that no path through \p D returns, so that a call to it ends the
+  /// path instead of being inlined or evaluated conservatively.
+  void markNeverReturns(const Decl *D) {
+    findOrInsertSummary(D)->second.NeverReturns = 1;
+  }
+
+  bool neverReturns(const Decl *D) {
+    MapTy::const_iterator I = Map.find(D);
+    return I != Map.end() && I->second.NeverReturns;
+  }
+
   unsigned getNumVisitedBasicBlocks(const Decl* D) {
     MapTy::const_iterator I = Map.find(D);
     if (I != Map.end())
@@ -137,6 +162,56 @@ public:
   unsigned getTotalNumVisitedBasicBlocks();
 };
 
+/// Function summaries that are kept from one invocation of the analyzer to
+/// the next in a file, so that they can be reused by the translation units
+/// that share the functions, and by later runs over changed sources.
+///
+/// Functions are identified by their cross translation unit lookup name. A
+/// summary records a hash of the function and of all the functions it may
+/// call, and only applies while that hash is unchanged.
+class PersistentFunctionSummaries {
+public:
+  struct Summary {
+    uint64_t Hash = 0;
+
+    /// True if the function was analyzed completely, and none of its paths
+    /// returned.
+    bool NeverReturns = false;
+  };
+
+private:
+  llvm::StringMap<Summary> Summaries;
+
+  /// A hash of the analyzer configuration the summaries were made with.
+  uint64_t ConfigHash;
+
+public:
+  explicit PersistentFunctionSummaries(uint64_t ConfigHash)
+      : ConfigHash(ConfigHash) {}
+
+  /// Read the summaries stored in \p Path. A file that is missing, cannot
+  /// be parsed or was written with a different configuration leaves the
+  /// summaries empty. Returns false if the file exists but is not used.
+  bool load(StringRef Path);
+
+  /// Write the summaries to \p Path, replacing its previous contents.
+  /// Returns false if the file could not be written.
+  bool save(StringRef Path) const;
+
+  /// Returns the summary of the function named \p Name, if it has one and
+  /// its hash is still \p Hash.
+  const Summary *lookup(StringRef Name, uint64_t Hash) const {
+    auto I = Summaries.find(Name);
+    if (I == Summaries.end() || I->second.Hash != Hash)
+      return nullptr;
+    return &I->second;
+  }
+
+  void insert(StringRef Name, const Summary &S) { Summaries[Name] = S; }
+
+  unsigned size() const { return Summaries.size(); }
+};
+
 } // namespace ento
 } // namespace clang
 
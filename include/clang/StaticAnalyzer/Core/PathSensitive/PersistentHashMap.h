@@ -0,0 +1,465 @@
+//===- PersistentHashMap.h - Uniqued persistent hash map --------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file defines PersistentHashMap, a persistent map implemented as a hash
+//  array mapped trie, which can be used in place of llvm::ImmutableMap for
+//  the components of a ProgramState.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_STATICANALYZER_CORE_PATHSENSITIVE_PERSISTENTHASHMAP_H
+#define LLVM_CLANG_STATICANALYZER_CORE_PATHSENSITIVE_PERSISTENTHASHMAP_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/FoldingSet.h"
+#include "llvm/ADT/ImmutableSet.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/MathExtras.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+namespace clang {
+namespace ento {
+
+/// A persistent map from \p KeyT to \p ValT, implemented as a hash array
+/// mapped trie.
+///
+/// Like llvm::ImmutableMap, a map is never changed. Adding or removing a key
+/// returns a new map, which shares all but the path to the changed key with
+/// the old one. The maps created by one Factory are uniqued: two maps with
+/// the same contents have the same root, so they compare equal, and profile
+/// the same, in constant time.
+///
+/// Unlike ImmutableMap, which is a balanced binary tree ordered by the keys,
+/// each node of the trie branches 32 ways on five bits of the hash of the
+/// keys. An update or lookup therefore visits at most seven nodes, rather
+/// than up to 1.44 * log2(N) of them. The entries are iterated in the order
+/// of their hashes, not of their keys.
+///
+/// Keys and values are profiled with llvm::ImutProfileInfo, and compared with
+/// operator==. Keys that compare unequal must profile differently. The nodes
+/// are allocated in the allocator of the factory and are never destroyed, so
+/// neither keys nor values may own memory that needs to be released.
+template <typename KeyT, typename ValT> class PersistentHashMap {
+public:
+  using key_type = KeyT;
+  using data_type = ValT;
+  using value_type = std::pair<KeyT, ValT>;
+
+  class Factory;
+  class iterator;
+
+  /// A node of the trie. Its layout is private to the map.
+  class TreeTy : public llvm::FoldingSetNode {
+    friend class PersistentHashMap;
+
+    bool IsLeaf;
+
+  protected:
+    explicit TreeTy(bool IsLeaf) : IsLeaf(IsLeaf) {}
+
+  public:
+    void Profile(llvm::FoldingSetNodeID &ID) const;
+  };
+
+private:
+  enum { BitsPerLevel = 5, LevelMask = (1U << BitsPerLevel) - 1 };
+
+  /// An entry of the map. The entries whose keys have the same hash are
+  /// chained together, ordered by the profile of their keys.
+  class Leaf : public TreeTy {
+  public:
+    value_type Entry;
+    unsigned Hash;
+    const Leaf *Next;
+
+    Leaf(const KeyT &K, const ValT &V, unsigned Hash, const Leaf *Next)
+        : TreeTy(/*IsLeaf=*/true), Entry(K, V), Hash(Hash), Next(Next) {}
+
+    static void Profile(llvm::FoldingSetNodeID &ID, const KeyT &K,
+                        const ValT &V, const Leaf *Next) {
+      ID.AddBoolean(true);
+      llvm::ImutProfileInfo<KeyT>::Profile(ID, K);
+      llvm::ImutProfileInfo<ValT>::Profile(ID, V);
+      ID.AddPointer(Next);
+    }
+  };
+
+  /// An inner node, which holds a child for every set bit of its bitmap.
+  ///
+  /// A subtrie is only a branch if its entries have different hashes, so
+  /// the shape of the trie depends only on the entries in it.
+  class Branch : public TreeTy {
+  public:
+    uint32_t Bitmap;
+    const TreeTy *const *Children;
+
+    Branch(uint32_t Bitmap, const TreeTy *const *Children)
+        : TreeTy(/*IsLeaf=*/false), Bitmap(Bitmap), Children(Children) {}
+
+    unsigned size() const { return llvm::countPopulation(Bitmap); }
+
+    ArrayRef<const TreeTy *> children() const {
+      return llvm::makeArrayRef(Children, size());
+    }
+
+    static void Profile(llvm::FoldingSetNodeID &ID, uint32_t Bitmap,
+                        ArrayRef<const TreeTy *> Children) {
+      ID.AddBoolean(false);
+      ID.AddInteger(Bitmap);
+      for (const TreeTy *Child : Children)
+        ID.AddPointer(Child);
+    }
+  };
+
+  static const Leaf *asLeaf(const TreeTy *N) {
+    return N && N->IsLeaf ? static_cast<const Leaf *>(N) : nullptr;
+  }
+
+  static const Branch *asBranch(const TreeTy *N) {
+    return N && !N->IsLeaf ? static_cast<const Branch *>(N) : nullptr;
+  }
+
+  static unsigned getHash(const KeyT &K) {
+    llvm::FoldingSetNodeID ID;
+    llvm::ImutProfileInfo<KeyT>::Profile(ID, K);
+    return ID.ComputeHash();
+  }
+
+  /// Returns the bit of a branch at depth \p Shift that selects the child
+  /// for \p Hash.
+  static uint32_t getBit(unsigned Hash, unsigned Shift) {
+    return 1U << ((Hash >> Shift) & LevelMask);
+  }
+
+  static unsigned getChildIndex(const Branch *B, uint32_t Bit) {
+    return llvm::countPopulation(B->Bitmap & (Bit - 1));
+  }
+
+  const TreeTy *Root;
+
+public:
+  explicit PersistentHashMap(const TreeTy *Root) : Root(Root) {}
+
+  /// Returns the value of \p K, or null if \p K is not in the map.
+  const ValT *lookup(const KeyT &K) const {
+    unsigned Hash = getHash(K);
+    const TreeTy *N = Root;
+    for (unsigned Shift = 0; const Branch *B = asBranch(N);
+         Shift += BitsPerLevel) {
+      uint32_t Bit = getBit(Hash, Shift);
+      if (!(B->Bitmap & Bit))
+        return nullptr;
+      N = B->Children[getChildIndex(B, Bit)];
+    }
+
+    const Leaf *L = asLeaf(N);
+    if (!L || L->Hash != Hash)
+      return nullptr;
+    for (; L; L = L->Next)
+      if (L->Entry.first == K)
+        return &L->Entry.second;
+    return nullptr;
+  }
+
+  bool contains(const KeyT &K) const { return lookup(K); }
+
+  bool isEmpty() const { return !Root; }
+
+  const TreeTy *getRoot() const { return Root; }
+
+  bool operator==(const PersistentHashMap &RHS) const {
+    return Root == RHS.Root;
+  }
+
+  bool operator!=(const PersistentHashMap &RHS) const {
+    return Root != RHS.Root;
+  }
+
+  static void Profile(llvm::FoldingSetNodeID &ID, const PersistentHashMap &M) {
+    ID.AddPointer(M.Root);
+  }
+
+  void Profile(llvm::FoldingSetNodeID &ID) const { Profile(ID, *this); }
+
+  /// Iterates over the entries of a map, in the order of their hashes.
+  class iterator {
+    /// The branches above the current entry, with the index of the next of
+    /// their children to visit.
+    SmallVector<std::pair<const Branch *, unsigned>, 8> Path;
+    const Leaf *Current = nullptr;
+
+    void descend(const TreeTy *N) {
+      while (const Branch *B = asBranch(N)) {
+        Path.push_back({B, 1});
+        N = B->Children[0];
+      }
+      Current = asLeaf(N);
+    }
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = PersistentHashMap::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type *;
+    using reference = const value_type &;
+
+    iterator() = default;
+
+    explicit iterator(const TreeTy *Root) {
+      if (Root)
+        descend(Root);
+    }
+
+    reference operator*() const { return Current->Entry; }
+    pointer operator->() const { return &Current->Entry; }
+
+    const KeyT &getKey() const { return Current->Entry.first; }
+    const ValT &getData() const { return Current->Entry.second; }
+
+    iterator &operator++() {
+      if (Current->Next) {
+        Current = Current->Next;
+        return *this;
+      }
+      while (!Path.empty()) {
+        const Branch *B = Path.back().first;
+        unsigned Index = Path.back().second;
+        if (Index != B->size()) {
+          ++Path.back().second;
+          descend(B->Children[Index]);
+          return *this;
+        }
+        Path.pop_back();
+      }
+      Current = nullptr;
+      return *this;
+    }
+
+    iterator operator++(int) {
+      iterator Tmp = *this;
+      ++*this;
+      return Tmp;
+    }
+
+    bool operator==(const iterator &RHS) const {
+      return Current == RHS.Current;
+    }
+
+    bool operator!=(const iterator &RHS) const {
+      return Current != RHS.Current;
+    }
+  };
+
+  iterator begin() const { return iterator(Root); }
+  iterator end() const { return iterator(); }
+
+  /// Creates and uniques the nodes of maps.
+  class Factory {
+    std::unique_ptr<llvm::BumpPtrAllocator> OwnedAllocator;
+    llvm::BumpPtrAllocator &Allocator;
+    llvm::FoldingSet<TreeTy> Nodes;
+
+    const Leaf *getLeaf(const KeyT &K, const ValT &V, unsigned Hash,
+                        const Leaf *Next) {
+      llvm::FoldingSetNodeID ID;
+      Leaf::Profile(ID, K, V, Next);
+      void *InsertPos;
+      if (TreeTy *N = Nodes.FindNodeOrInsertPos(ID, InsertPos))
+        return static_cast<const Leaf *>(N);
+      Leaf *L = new (Allocator.Allocate<Leaf>()) Leaf(K, V, Hash, Next);
+      Nodes.InsertNode(L, InsertPos);
+      return L;
+    }
+
+    const Branch *getBranch(uint32_t Bitmap,
+                            ArrayRef<const TreeTy *> Children) {
+      assert(llvm::countPopulation(Bitmap) == Children.size());
+      llvm::FoldingSetNodeID ID;
+      Branch::Profile(ID, Bitmap, Children);
+      void *InsertPos;
+      if (TreeTy *N = Nodes.FindNodeOrInsertPos(ID, InsertPos))
+        return static_cast<const Branch *>(N);
+      const TreeTy **Storage =
+          Allocator.Allocate<const TreeTy *>(Children.size());
+      std::copy(Children.begin(), Children.end(), Storage);
+      Branch *B = new (Allocator.Allocate<Branch>()) Branch(Bitmap, Storage);
+      Nodes.InsertNode(B, InsertPos);
+      return B;
+    }
+
+    /// Rebuilds a chain of entries that have the same hash.
+    const Leaf *getChain(ArrayRef<value_type> Entries, unsigned Hash) {
+      const Leaf *Next = nullptr;
+      for (const value_type &E : llvm::reverse(Entries))
+        Next = getLeaf(E.first, E.second, Hash, Next);
+      return Next;
+    }
+
+    static bool compareKeys(const KeyT &LHS, const KeyT &RHS) {
+      llvm::FoldingSetNodeID LHSID, RHSID;
+      llvm::ImutProfileInfo<KeyT>::Profile(LHSID, LHS);
+      llvm::ImutProfileInfo<KeyT>::Profile(RHSID, RHS);
+      return LHSID < RHSID;
+    }
+
+    /// Returns a subtrie at depth \p Shift that holds the entries of two
+    /// chains whose hashes differ.
+    const TreeTy *merge(const Leaf *A, const Leaf *B, unsigned Shift) {
+      assert(A->Hash != B->Hash);
+      uint32_t ABit = getBit(A->Hash, Shift), BBit = getBit(B->Hash, Shift);
+      if (ABit == BBit) {
+        const TreeTy *Child = merge(A, B, Shift + BitsPerLevel);
+        return getBranch(ABit, Child);
+      }
+      if (ABit > BBit)
+        std::swap(A, B);
+      const TreeTy *Children[] = {A, B};
+      return getBranch(ABit | BBit, Children);
+    }
+
+    const TreeTy *insert(const TreeTy *N, unsigned Shift, const KeyT &K,
+                         const ValT &V, unsigned Hash) {
+      if (!N)
+        return getLeaf(K, V, Hash, nullptr);
+
+      if (const Leaf *L = asLeaf(N)) {
+        if (L->Hash != Hash)
+          return merge(L, getLeaf(K, V, Hash, nullptr), Shift);
+
+        SmallVector<value_type, 2> Entries;
+        for (const Leaf *I = L; I; I = I->Next)
+          Entries.push_back(I->Entry);
+        auto It = std::find_if(
+            Entries.begin(), Entries.end(),
+            [&](const value_type &E) { return E.first == K; });
+        if (It != Entries.end()) {
+          if (It->second == V)
+            return L;
+          It->second = V;
+        } else {
+          It = std::find_if(Entries.begin(), Entries.end(),
+                            [&](const value_type &E) {
+                              return compareKeys(K, E.first);
+                            });
+          Entries.insert(It, value_type(K, V));
+        }
+        return getChain(Entries, Hash);
+      }
+
+      const Branch *B = asBranch(N);
+      uint32_t Bit = getBit(Hash, Shift);
+      unsigned Index = getChildIndex(B, Bit);
+      SmallVector<const TreeTy *, 8> Children(B->children().begin(),
+                                              B->children().end());
+      if (!(B->Bitmap & Bit)) {
+        Children.insert(Children.begin() + Index,
+                        getLeaf(K, V, Hash, nullptr));
+        return getBranch(B->Bitmap | Bit, Children);
+      }
+
+      const TreeTy *Child =
+          insert(Children[Index], Shift + BitsPerLevel, K, V, Hash);
+      if (Child == Children[Index])
+        return N;
+      Children[Index] = Child;
+      return getBranch(B->Bitmap, Children);
+    }
+
+    const TreeTy *remove(const TreeTy *N, unsigned Shift, const KeyT &K,
+                         unsigned Hash) {
+      if (!N)
+        return nullptr;
+
+      if (const Leaf *L = asLeaf(N)) {
+        if (L->Hash != Hash)
+          return N;
+        SmallVector<value_type, 2> Entries;
+        for (const Leaf *I = L; I; I = I->Next)
+          Entries.push_back(I->Entry);
+        auto It = std::find_if(
+            Entries.begin(), Entries.end(),
+            [&](const value_type &E) { return E.first == K; });
+        if (It == Entries.end())
+          return N;
+        Entries.erase(It);
+        return getChain(Entries, Hash);
+      }
+
+      const Branch *B = asBranch(N);
+      uint32_t Bit = getBit(Hash, Shift);
+      if (!(B->Bitmap & Bit))
+        return N;
+      unsigned Index = getChildIndex(B, Bit);
+      const TreeTy *Child =
+          remove(B->Children[Index], Shift + BitsPerLevel, K, Hash);
+      if (Child == B->Children[Index])
+        return N;
+
+      SmallVector<const TreeTy *, 8> Children(B->children().begin(),
+                                              B->children().end());
+      uint32_t Bitmap = B->Bitmap;
+      if (Child) {
+        Children[Index] = Child;
+      } else {
+        Children.erase(Children.begin() + Index);
+        Bitmap &= ~Bit;
+      }
+
+      // Entries that all have the same hash are kept in a single chain.
+      if (Children.empty())
+        return nullptr;
+      if (Children.size() == 1 && asLeaf(Children.front()))
+        return Children.front();
+      return getBranch(Bitmap, Children);
+    }
+
+  public:
+    Factory()
+        : OwnedAllocator(new llvm::BumpPtrAllocator()),
+          Allocator(*OwnedAllocator) {}
+
+    explicit Factory(llvm::BumpPtrAllocator &Alloc) : Allocator(Alloc) {}
+
+    Factory(const Factory &) = delete;
+    Factory &operator=(const Factory &) = delete;
+
+    PersistentHashMap getEmptyMap() { return PersistentHashMap(nullptr); }
+
+    PersistentHashMap add(PersistentHashMap Old, const KeyT &K,
+                          const ValT &V) {
+      return PersistentHashMap(insert(Old.Root, 0, K, V, getHash(K)));
+    }
+
+    PersistentHashMap remove(PersistentHashMap Old, const KeyT &K) {
+      return PersistentHashMap(remove(Old.Root, 0, K, getHash(K)));
+    }
+  };
+};
+
+template <typename KeyT, typename ValT>
+void PersistentHashMap<KeyT, ValT>::TreeTy::Profile(
+    llvm::FoldingSetNodeID &ID) const {
+  if (const Leaf *L = asLeaf(this))
+    Leaf::Profile(ID, L->Entry.first, L->Entry.second, L->Next);
+  else
+    Branch::Profile(ID, asBranch(this)->Bitmap, asBranch(this)->children());
+}
+
+} // end namespace ento
+} // end namespace clang
+
+#endif // LLVM_CLANG_STATICANALYZER_CORE_PATHSENSITIVE_PERSISTENTHASHMAP_H
@@ -17,6 +17,7 @@
 #ifndef LLVM_CLANG_STATICANALYZER_CORE_PATHSENSITIVE_PROGRAMSTATETRAIT_H
 #define LLVM_CLANG_STATICANALYZER_CORE_PATHSENSITIVE_PROGRAMSTATETRAIT_H
 
+#include "clang/StaticAnalyzer/Core/PathSensitive/PersistentHashMap.h"
 #include "llvm/ADT/ImmutableList.h"
 #include "llvm/ADT/ImmutableMap.h"
 #include "llvm/ADT/ImmutableSet.h"
@@ -95,6 +96,23 @@ namespace ento {
     REGISTER_FACTORY_WITH_PROGRAMSTATE(Name)
 
 
+  /// Helper for registering a hash map trait, for the same reason as
+  /// CLANG_ENTO_PROGRAMSTATE_MAP.
+  #define CLANG_ENTO_PROGRAMSTATE_HASH_MAP(Key, Value) \
+    clang::ento::PersistentHashMap<Key, Value>
+
+  /// Declares an immutable map of type \p NameTy, suitable for placement into
+  /// the ProgramState, which is used exactly like a map declared with
+  /// REGISTER_MAP_WITH_PROGRAMSTATE. This is implemented using
+  /// PersistentHashMap, whose lookups and updates are faster for large maps,
+  /// but which is iterated in the order of the hashes of its keys.
+  ///
+  /// The macro should not be used inside namespaces, or for traits that must
+  /// be accessible from more than one translation unit.
+  #define REGISTER_HASH_MAP_WITH_PROGRAMSTATE(Name, Key, Value) \
+    REGISTER_TRAIT_WITH_PROGRAMSTATE(Name, \
+                                     CLANG_ENTO_PROGRAMSTATE_HASH_MAP(Key, Value))
+
   /// Declares an immutable set of type \p NameTy, suitable for placement into
   /// the ProgramState. This is implementing using llvm::ImmutableSet.
   ///
@@ -190,6 +208,54 @@ namespace ento {
     }
   };
 
+  // Partial-specialization for PersistentHashMap.
+  template <typename Key, typename Data>
+  struct ProgramStatePartialTrait<PersistentHashMap<Key, Data>> {
+    using data_type = PersistentHashMap<Key, Data>;
+    using context_type = typename data_type::Factory &;
+    using key_type = Key;
+    using value_type = Data;
+    using lookup_type = const value_type *;
+
+    static data_type MakeData(void *const *p) {
+      return p ? data_type((const typename data_type::TreeTy *) *p)
+               : data_type(nullptr);
+    }
+
+    static void *MakeVoidPtr(data_type B) {
+      return const_cast<typename data_type::TreeTy *>(B.getRoot());
+    }
+
+    static lookup_type Lookup(data_type B, key_type K) {
+      return B.lookup(K);
+    }
+
+    static data_type Set(data_type B, key_type K, value_type E,
+                         context_type F) {
+      return F.add(B, K, E);
+    }
+
+    static data_type Remove(data_type B, key_type K, context_type F) {
+      return F.remove(B, K);
+    }
+
+    static bool Contains(data_type B, key_type K) {
+      return B.contains(K);
+    }
+
+    static context_type MakeContext(void *p) {
+      return *((typename data_type::Factory *) p);
+    }
+
+    static void *CreateContext(llvm::BumpPtrAllocator& Alloc) {
+      return new typename data_type::Factory(Alloc);
+    }
+
+    static void DeleteContext(void *Ctx) {
+      delete (typename data_type::Factory *) Ctx;
+    }
+  };
+
   // Partial-specialization for ImmutableSet.
   template <typename Key, typename Info>
   struct ProgramStatePartialTrait<llvm::ImmutableSet<Key, Info>> {
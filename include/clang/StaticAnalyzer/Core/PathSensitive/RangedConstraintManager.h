@@ -17,6 +17,10 @@
 #include "clang/StaticAnalyzer/Core/PathSensitive/ProgramState.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ProgramStateTrait.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/SimpleConstraintManager.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/FoldingSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Allocator.h"
 
 namespace clang {
 
@@ -46,66 +50,78 @@ public:
   }
 };
 
-class RangeTrait : public llvm::ImutContainerInfo<Range> {
-public:
-  // When comparing if one Range is less than another, we should compare
-  // the actual APSInt values instead of their pointers.  This keeps the order
-  // consistent (instead of comparing by pointer values) and can potentially
-  // be used to speed up some of the operations in RangeSet.
-  static inline bool isLess(key_type_ref lhs, key_type_ref rhs) {
-    return *lhs.first < *rhs.first ||
-           (!(*rhs.first < *lhs.first) && *lhs.second < *rhs.second);
-  }
-};
-
 /// RangeSet contains a set of ranges. If the set is empty, then
 ///  there the value of a symbol is overly constrained and there are no
 ///  possible values for that symbol.
+///
+/// The ranges are kept in an array, sorted and disjoint, which is uniqued by
+/// the Factory of the set. Sets with the same ranges share their array, so
+/// they are copied, compared and profiled in constant time, and operations
+/// on sets merge arrays rather than rebuilding a tree range by range.
 class RangeSet {
-  typedef llvm::ImmutableSet<Range, RangeTrait> PrimRangeSet;
-  PrimRangeSet ranges; // no need to make const, since it is an
-                       // ImmutableSet - this allows default operator=
-                       // to work.
 public:
-  typedef PrimRangeSet::Factory Factory;
-  typedef PrimRangeSet::iterator iterator;
+  class Factory;
+
+private:
+  /// The sorted and disjoint ranges of a set.
+  class ContainerType : public llvm::FoldingSetNode {
+  public:
+    const Range *Ranges;
+    unsigned Size;
+
+    ContainerType(const Range *Ranges, unsigned Size)
+        : Ranges(Ranges), Size(Size) {}
+
+    static void Profile(llvm::FoldingSetNodeID &ID, ArrayRef<Range> Ranges) {
+      for (const Range &R : Ranges)
+        R.Profile(ID);
+    }
+
+    void Profile(llvm::FoldingSetNodeID &ID) const {
+      Profile(ID, llvm::makeArrayRef(Ranges, Size));
+    }
+  };
+
+  /// The ranges of the set, or null if it is empty.
+  const ContainerType *Impl = nullptr;
+
+  RangeSet() = default;
+  explicit RangeSet(const ContainerType *Impl) : Impl(Impl) {}
 
-  RangeSet(PrimRangeSet RS) : ranges(RS) {}
+public:
+  typedef const Range *iterator;
 
   /// Create a new set with all ranges of this set and RS.
   /// Possible intersections are not checked here.
-  RangeSet addRange(Factory &F, const RangeSet &RS) {
-    PrimRangeSet Ranges(RS.ranges);
-    for (const auto &range : ranges)
-      Ranges = F.add(Ranges, range);
-    return RangeSet(Ranges);
-  }
+  RangeSet addRange(Factory &F, const RangeSet &RS);
+
+  iterator begin() const { return Impl ? Impl->Ranges : nullptr; }
+  iterator end() const { return Impl ? Impl->Ranges + Impl->Size : nullptr; }
 
-  iterator begin() const { return ranges.begin(); }
-  iterator end() const { return ranges.end(); }
+  unsigned size() const { return Impl ? Impl->Size : 0; }
 
-  bool isEmpty() const { return ranges.isEmpty(); }
+  bool isEmpty() const { return !Impl; }
 
   /// Construct a new RangeSet representing '{ [from, to] }'.
-  RangeSet(Factory &F, const llvm::APSInt &from, const llvm::APSInt &to)
-      : ranges(F.add(F.getEmptySet(), Range(from, to))) {}
+  inline RangeSet(Factory &F, const llvm::APSInt &from,
+                  const llvm::APSInt &to);
 
   /// Profile - Generates a hash profile of this RangeSet for use
   ///  by FoldingSet.
-  void Profile(llvm::FoldingSetNodeID &ID) const { ranges.Profile(ID); }
+  void Profile(llvm::FoldingSetNodeID &ID) const { ID.AddPointer(Impl); }
 
   /// getConcreteValue - If a symbol is contrained to equal a specific integer
   ///  constant then this method returns that value.  Otherwise, it returns
   ///  NULL.
   const llvm::APSInt *getConcreteValue() const {
-    return ranges.isSingleton() ? ranges.begin()->getConcreteValue() : nullptr;
+    return size() == 1 ? begin()->getConcreteValue() : nullptr;
   }
 
 private:
-  void IntersectInRange(BasicValueFactory &BV, Factory &F,
-                        const llvm::APSInt &Lower, const llvm::APSInt &Upper,
-                        PrimRangeSet &newRanges, PrimRangeSet::iterator &i,
-                        PrimRangeSet::iterator &e) const;
+  void IntersectInRange(BasicValueFactory &BV, const llvm::APSInt &Lower,
+                        const llvm::APSInt &Upper,
+                        SmallVectorImpl<Range> &newRanges, iterator &i,
+                        iterator e) const;
 
   const llvm::APSInt &getMinValue() const;
 
@@ -120,10 +136,31 @@ public:
   void print(raw_ostream &os) const;
 
   bool operator==(const RangeSet &other) const {
-    return ranges == other.ranges;
+    return Impl == other.Impl;
   }
 };
 
+/// Creates and uniques the arrays of ranges of RangeSets. The sets live as
+/// long as their factory.
+class RangeSet::Factory {
+  llvm::BumpPtrAllocator Allocator;
+  llvm::FoldingSet<ContainerType> Sets;
+
+public:
+  RangeSet getEmptySet() { return RangeSet(); }
+
+  /// Returns the set of \p Ranges, which must be sorted and disjoint.
+  RangeSet getRangeSet(ArrayRef<Range> Ranges);
+
+  RangeSet getRangeSet(const Range &R) {
+    return getRangeSet(llvm::makeArrayRef(R));
+  }
+};
+
+RangeSet::RangeSet(Factory &F, const llvm::APSInt &from,
+                   const llvm::APSInt &to)
+    : Impl(F.getRangeSet(Range(from, to)).Impl) {}
+
 
 class ConstraintRange {};
 using ConstraintRangeTy = llvm::ImmutableMap<SymbolRef, RangeSet>;
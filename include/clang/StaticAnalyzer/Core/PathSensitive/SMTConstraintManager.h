@@ -119,8 +119,7 @@ public:
       SMTExprRef Exp =
           SMTConv::fromData(Solver, SD->getSymbolID(), Ty, Ctx.getTypeSize(Ty));
 
-      Solver->reset();
-      addStateConstraints(State);
+      assertStateConstraints(State->get<ConstraintSMT>());
 
       // Constraints are unsatisfiable
       Optional<bool> isSat = Solver->check();
@@ -138,9 +137,12 @@ public:
                               : Solver->mkBitvector(Value, Value.getBitWidth()),
           /*isSigned=*/false);
 
+      // Check the other values in a scope of their own, so that the
+      // constraints of the state can still be reused by the next query.
+      Solver->push();
       Solver->addConstraint(NotExp);
-
       Optional<bool> isNotSat = Solver->check();
+      Solver->pop();
       if (!isSat.hasValue() || isNotSat.getValue())
         return nullptr;
 
@@ -279,55 +281,75 @@ protected:
     return nullptr;
   }
 
-  /// Given a program state, construct the logical conjunction and add it to
-  /// the solver
-  virtual void addStateConstraints(ProgramStateRef State) const {
-    // TODO: Don't add all the constraints, only the relevant ones
-    auto CZ = State->get<ConstraintSMT>();
-    auto I = CZ.begin(), IE = CZ.end();
-
-    // Construct the logical AND of all the constraints
-    if (I != IE) {
-      std::vector<SMTExprRef> ASTs;
-
-      SMTExprRef Constraint = Solver->newExprRef(I++->second);
-      while (I != IE) {
-        Constraint = Solver->mkAnd(Constraint, Solver->newExprRef(I++->second));
-      }
-
-      Solver->addConstraint(Constraint);
-    }
-  }
-
   // Generate and check a Z3 model, using the given constraint.
   ConditionTruthVal checkModel(ProgramStateRef State, SymbolRef Sym,
                                const SMTExprRef &Exp) const {
     ProgramStateRef NewState = State->add<ConstraintSMT>(
         std::make_pair(Sym, static_cast<const SMTExprTy &>(*Exp)));
+    ConstraintSetTy CS = NewState->get<ConstraintSMT>();
 
-    llvm::FoldingSetNodeID ID;
-    NewState->get<ConstraintSMT>().Profile(ID);
-
-    unsigned hash = ID.ComputeHash();
-    auto I = Cached.find(hash);
+    auto I = Cached.find(CS.getRootWithoutRetain());
     if (I != Cached.end())
-      return I->second;
+      return I->second.second;
 
-    Solver->reset();
-    addStateConstraints(NewState);
+    assertStateConstraints(CS);
 
     Optional<bool> res = Solver->check();
-    if (!res.hasValue())
-      Cached[hash] = ConditionTruthVal();
-    else
-      Cached[hash] = ConditionTruthVal(res.getValue());
+    ConditionTruthVal Result =
+        res.hasValue() ? ConditionTruthVal(res.getValue()) : ConditionTruthVal();
+    Cached.insert(
+        std::make_pair(CS.getRootWithoutRetain(), std::make_pair(CS, Result)));
+    return Result;
+  }
+
+private:
+  using ConstraintSetTy = typename ProgramStateTrait<ConstraintSMT>::data_type;
 
-    return Cached[hash];
+  /// Returns true if every constraint in \p Inner is also in \p Outer.
+  static bool isSubsetOf(const ConstraintSetTy &Inner,
+                         const ConstraintSetTy &Outer) {
+    if (Inner == Outer)
+      return true;
+    for (const auto &C : Inner)
+      if (!Outer.contains(C))
+        return false;
+    return true;
+  }
+
+  /// Make the solver assert exactly the constraints in \p CS.
+  ///
+  /// The constraints of the states along a path only ever grow, so the
+  /// solver keeps one scope per queried set of constraints, each of them
+  /// asserting only the constraints its enclosing scope did not have. We pop
+  /// back to the longest prefix of the scopes that \p CS still contains, and
+  /// push the rest of \p CS on top of it, instead of asserting everything
+  /// again.
+  void assertStateConstraints(const ConstraintSetTy &CS) const {
+    while (!AssertedScopes.empty() && !isSubsetOf(AssertedScopes.back(), CS)) {
+      Solver->pop();
+      AssertedScopes.pop_back();
+    }
+    if (!AssertedScopes.empty() && AssertedScopes.back() == CS)
+      return;
+
+    Solver->push();
+    for (const auto &C : CS)
+      if (AssertedScopes.empty() || !AssertedScopes.back().contains(C))
+        Solver->addConstraint(Solver->newExprRef(C.second));
+    AssertedScopes.push_back(CS);
   }
 
-  // Cache the result of an SMT query (true, false, unknown). The key is the
-  // hash of the constraints in a state
-  mutable llvm::DenseMap<unsigned, ConditionTruthVal> Cached;
+  // The sets of constraints asserted by the scopes of the solver, outermost
+  // first. Each set contains the ones before it.
+  mutable SmallVector<ConstraintSetTy, 16> AssertedScopes;
+
+  // Cache the result of an SMT query (true, false, unknown). Sets of
+  // constraints are uniqued, so the root of a set identifies its contents.
+  // The set is kept alive along with its result, so that its root cannot be
+  // reused by a different set of constraints.
+  mutable llvm::DenseMap<const void *,
+                         std::pair<ConstraintSetTy, ConditionTruthVal>>
+      Cached;
 }; // end class SMTConstraintManager
 
 } // namespace ento
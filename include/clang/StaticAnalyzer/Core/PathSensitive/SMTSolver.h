@@ -285,6 +285,10 @@ public:
   /// Reset the solver and remove all constraints.
   virtual void reset() = 0;
 
+  /// Limit the time each check may take, in milliseconds. A check that runs
+  /// out of time has an unknown result. Zero means there is no limit.
+  virtual void setTimeout(unsigned Milliseconds) = 0;
+
   /// Checks if the solver supports floating-points.
   virtual bool isFPSupported() = 0;
 
@@ -113,6 +113,11 @@ struct ComparisonOptions {
   /// mapping is computed, unless the size of either subtrees exceeds this.
   int MaxSize = 100;
 
+  /// If either tree has more nodes than this, only the top-down phase is run,
+  /// which takes time roughly linear in the size of the trees. Zero means
+  /// that there is no limit.
+  int MaxNodes = 0;
+
   bool StopAfterTopDown = false;
 
   /// Returns false if the nodes should never be matched.
@@ -23,6 +23,11 @@ namespace tooling {
 
 /// Executes given frontend actions on all files/TUs in the compilation
 /// database.
+///
+/// All TUs read files through a shared \c SharedFileSystemCache, so each
+/// header is stat'ed and read once per execution rather than once per TU.
+/// Files must therefore not change while the actions run. The TUs also share
+/// the executor's \c PCHContainerOperations.
 class AllTUsToolExecutor : public ToolExecutor {
 public:
   static const char *ExecutorName;
@@ -70,6 +75,7 @@ private:
   ExecutionContext Context;
   llvm::StringMap<std::string> OverlayFiles;
   unsigned ThreadCount;
+  std::shared_ptr<PCHContainerOperations> PCHContainerOps;
 };
 
 extern llvm::cl::opt<std::string> Filter;
@@ -26,7 +26,6 @@
 #include "llvm/Support/YAMLParser.h"
 #include <memory>
 #include <string>
-#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -56,6 +55,11 @@ namespace tooling {
 ///
 /// 'arguments' is a list of command line arguments that will not be unescaped.
 ///
+/// A database that is plain JSON is indexed without building a document for
+/// it: only the file names are decoded when it is loaded, and an entry is
+/// parsed when its compile commands are requested. Other databases are read
+/// with the YAML parser, which is slower but more lenient.
+///
 /// JSON compilation databases can for example be generated in CMake projects
 /// by setting the flag -DCMAKE_EXPORT_COMPILE_COMMANDS.
 enum class JSONCommandLineSyntax { Windows, Gnu, AutoDetect };
@@ -106,17 +110,35 @@ private:
   /// failed.
   bool parse(std::string &ErrorMessage);
 
-  // Tuple (directory, filename, commandline, output) where 'commandline'
-  // points to the corresponding scalar nodes in the YAML stream.
+  /// Indexes a database that is plain JSON without building a YAML document
+  /// for it, keeping only the text of each entry.
+  ///
+  /// Returns false, and indexes nothing, if the database is not plain JSON
+  /// or an entry is not valid. \c parse then reads it as YAML, which accepts
+  /// more and explains errors.
+  bool scan();
+
+  // The entry of one compile command. Entries found by scan() only have the
+  // text of their JSON object, which is parsed again when the command is
+  // needed. The others point to the scalar nodes in the YAML stream.
   // If the command line contains a single argument, it is a shell-escaped
   // command line.
   // Otherwise, each entry in the command line vector is a literal
   // argument to the compiler.
   // The output field may be a nullptr.
-  using CompileCommandRef =
-      std::tuple<llvm::yaml::ScalarNode *, llvm::yaml::ScalarNode *,
-                 std::vector<llvm::yaml::ScalarNode *>,
-                 llvm::yaml::ScalarNode *>;
+  struct CompileCommandRef {
+    StringRef Object;
+    llvm::yaml::ScalarNode *Directory = nullptr;
+    llvm::yaml::ScalarNode *File = nullptr;
+    std::vector<llvm::yaml::ScalarNode *> CommandLine;
+    llvm::yaml::ScalarNode *Output = nullptr;
+  };
+
+  /// Fills the nodes of \p Ref from the JSON object \p Value.
+  ///
+  /// Returns whether \p Value is a valid entry. Sets ErrorMessage if not.
+  static bool parseObject(llvm::yaml::Node *Value, CompileCommandRef &Ref,
+                          std::string &ErrorMessage);
 
   /// Converts the given array of CompileCommandRefs to CompileCommands.
   void getCommands(ArrayRef<CompileCommandRef> CommandsRef,
@@ -0,0 +1,76 @@
+//===--- USRIndex.h - Clang refactoring library ---------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Provides an index of the symbols that each translation unit mentions, so
+/// that a rename only needs to parse the translation units that can contain
+/// occurrences of the renamed symbol.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLING_REFACTOR_RENAME_USR_INDEX_H
+#define LLVM_CLANG_TOOLING_REFACTOR_RENAME_USR_INDEX_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/Support/Error.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace clang {
+class FrontendAction;
+
+namespace tooling {
+
+/// Collects the USRs of the symbols that translation units declare or
+/// reference, in their main file or in any header they include, and writes
+/// them as an index.
+///
+/// The index is a text file. Each translation unit starts with a line
+/// "F <absolute path of the main file>", followed by a line "U <USR>" for each
+/// symbol it mentions.
+///
+/// Only symbols that the parsed code mentions are recorded, including those it
+/// mentions through macro expansions. The index is only valid for as long as
+/// none of the files it was built from change.
+class USRIndexBuilder {
+public:
+  /// Returns an action that adds the symbols of the translation unit it is
+  /// run on to the index. Actions may run concurrently.
+  std::unique_ptr<FrontendAction> newIndexingAction();
+
+  /// Adds the \p USRs mentioned by the translation unit of \p MainFile.
+  void addTranslationUnit(StringRef MainFile, std::set<std::string> USRs);
+
+  /// Writes the index to \p OS.
+  void write(llvm::raw_ostream &OS) const;
+
+private:
+  std::mutex Mutex;
+  std::map<std::string, std::set<std::string>> USRsByFile;
+};
+
+/// Selects which of \p Files may contain occurrences of any of the symbols in
+/// \p USRList, according to the index at \p IndexPath.
+///
+/// Files whose translation unit mentions one of the USRs are kept, and so are
+/// files that the index does not cover, since nothing is known about them.
+/// Returns an error if the index cannot be read.
+llvm::Expected<std::vector<std::string>>
+selectFilesFromUSRIndex(StringRef IndexPath, ArrayRef<std::string> Files,
+                        ArrayRef<std::vector<std::string>> USRList);
+
+} // end namespace tooling
+} // end namespace clang
+
+#endif // LLVM_CLANG_TOOLING_REFACTOR_RENAME_USR_INDEX_H
@@ -0,0 +1,123 @@
+//===--- SharedFileSystemCache.h - Cross-TU file cache ----------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file defines a thread-safe cache of file status and contents that can
+//  be shared by every compilation run in one process, together with the
+//  virtual file system that reads through it.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLING_SHAREDFILESYSTEMCACHE_H
+#define LLVM_CLANG_TOOLING_SHAREDFILESYSTEMCACHE_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/VirtualFileSystem.h"
+#include <memory>
+#include <mutex>
+
+namespace clang {
+namespace tooling {
+
+/// A process-wide cache of the status and contents of files, keyed by
+/// absolute path.
+///
+/// Entries are immutable once they have been inserted, and are never removed
+/// for the lifetime of the cache, so callers may hold on to them without
+/// locking.  Only successful lookups are cached; a file that is missing is
+/// looked up again the next time it is asked for.
+///
+/// The cache assumes that the files it has seen do not change while it is
+/// alive.  This holds for tools that analyze or refactor a code base in
+/// memory, which is what it is meant for.
+class SharedFileSystemCache {
+public:
+  /// A cached file system entry.
+  struct Entry {
+    Entry(llvm::vfs::Status Stat) : Stat(std::move(Stat)) {}
+
+    llvm::vfs::Status Stat;
+
+    /// The contents of the file, or null if the entry is not a regular file
+    /// or has not been read yet.  Set at most once, under the shard lock.
+    mutable std::unique_ptr<llvm::MemoryBuffer> Contents;
+  };
+
+  /// Return the entry for \p AbsolutePath, or null if it is not cached.
+  const Entry *lookup(StringRef AbsolutePath);
+
+  /// Cache \p Stat for \p AbsolutePath and return the cached entry.  If
+  /// another thread cached the path first, its entry is returned instead.
+  const Entry *insert(StringRef AbsolutePath, llvm::vfs::Status Stat);
+
+  /// Attach \p Contents to \p E and return the buffer that is now cached.
+  /// If another thread attached contents first, \p Contents is discarded and
+  /// the already cached buffer is returned.
+  const llvm::MemoryBuffer *
+  setContents(const Entry *E, StringRef AbsolutePath,
+              std::unique_ptr<llvm::MemoryBuffer> Contents);
+
+  /// Return the contents of \p E, or null if they have not been read yet.
+  const llvm::MemoryBuffer *getContents(const Entry *E, StringRef AbsolutePath);
+
+private:
+  /// The cache is split into shards, each with its own lock, so that
+  /// threads looking up different files rarely contend.
+  struct Shard {
+    std::mutex Lock;
+    llvm::StringMap<std::unique_ptr<Entry>> Entries;
+  };
+
+  static const unsigned NumShards = 32;
+
+  Shard &getShard(StringRef AbsolutePath);
+
+  Shard Shards[NumShards];
+};
+
+/// A file system that answers status and read requests from a
+/// \c SharedFileSystemCache, and forwards to an underlying file system on a
+/// miss.
+///
+/// Each instance has its own working directory, so instances used by
+/// different threads do not interfere with each other.  Create one instance
+/// per compilation, all sharing the same cache.
+class SharedCachingFileSystem : public llvm::vfs::FileSystem {
+public:
+  SharedCachingFileSystem(std::shared_ptr<SharedFileSystemCache> Cache,
+                          IntrusiveRefCntPtr<llvm::vfs::FileSystem> FS);
+
+  llvm::ErrorOr<llvm::vfs::Status> status(const Twine &Path) override;
+  llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>>
+  openFileForRead(const Twine &Path) override;
+  llvm::vfs::directory_iterator dir_begin(const Twine &Dir,
+                                          std::error_code &EC) override;
+  std::error_code setCurrentWorkingDirectory(const Twine &Path) override;
+  llvm::ErrorOr<std::string> getCurrentWorkingDirectory() const override;
+  std::error_code getRealPath(const Twine &Path,
+                              SmallVectorImpl<char> &Output) const override;
+
+private:
+  /// Make \p Path absolute against this file system's working directory.
+  void makeAbsolutePath(const Twine &Path, SmallVectorImpl<char> &Result) const;
+
+  /// Find or create the cache entry for the absolute path \p Path.
+  llvm::ErrorOr<const SharedFileSystemCache::Entry *>
+  getOrCreateEntry(StringRef Path);
+
+  std::shared_ptr<SharedFileSystemCache> Cache;
+  IntrusiveRefCntPtr<llvm::vfs::FileSystem> FS;
+  std::string WorkingDirectory;
+};
+
+} // end namespace tooling
+} // end namespace clang
+
+#endif // LLVM_CLANG_TOOLING_SHAREDFILESYSTEMCACHE_H
@@ -28,11 +28,16 @@
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Rewrite/Core/Rewriter.h"
 #include "clang/StaticAnalyzer/Core/RetainSummaryManager.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringSet.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/YAMLParser.h"
+#include <map>
+#include <set>
+#include <tuple>
 
 using namespace clang;
 using namespace arcmt;
@@ -1480,23 +1485,25 @@ void ObjCMigrateASTConsumer::AddCFAnnotations(ASTContext &Ctx,
   }
   ArrayRef<ArgEffect> AEArgs = CE.getArgs();
   unsigned i = 0;
+  // The annotations only insert text in front of distinct parameters, so
+  // they can be committed together.
+  SmallVector<edit::Commit, 4> Commits;
   for (FunctionDecl::param_const_iterator pi = FuncDecl->param_begin(),
        pe = FuncDecl->param_end(); pi != pe; ++pi, ++i) {
     const ParmVarDecl *pd = *pi;
     ArgEffect AE = AEArgs[i];
     if (AE == DecRef && !pd->hasAttr<CFConsumedAttr>() &&
         NSAPIObj->isMacroDefined("CF_CONSUMED")) {
-      edit::Commit commit(*Editor);
-      commit.insertBefore(pd->getLocation(), "CF_CONSUMED ");
-      Editor->commit(commit);
+      Commits.emplace_back(*Editor);
+      Commits.back().insertBefore(pd->getLocation(), "CF_CONSUMED ");
     }
     else if (AE == DecRefMsg && !pd->hasAttr<NSConsumedAttr>() &&
              NSAPIObj->isMacroDefined("NS_CONSUMED")) {
-      edit::Commit commit(*Editor);
-      commit.insertBefore(pd->getLocation(), "NS_CONSUMED ");
-      Editor->commit(commit);
+      Commits.emplace_back(*Editor);
+      Commits.back().insertBefore(pd->getLocation(), "NS_CONSUMED ");
     }
   }
+  Editor->commitBatch(Commits);
 }
 
 ObjCMigrateASTConsumer::CF_BRIDGING_KIND
@@ -1606,17 +1613,18 @@ void ObjCMigrateASTConsumer::AddCFAnnotations(ASTContext &Ctx,
   }
   ArrayRef<ArgEffect> AEArgs = CE.getArgs();
   unsigned i = 0;
+  SmallVector<edit::Commit, 4> Commits;
   for (ObjCMethodDecl::param_const_iterator pi = MethodDecl->param_begin(),
        pe = MethodDecl->param_end(); pi != pe; ++pi, ++i) {
     const ParmVarDecl *pd = *pi;
     ArgEffect AE = AEArgs[i];
     if (AE == DecRef && !pd->hasAttr<CFConsumedAttr>() &&
         NSAPIObj->isMacroDefined("CF_CONSUMED")) {
-      edit::Commit commit(*Editor);
-      commit.insertBefore(pd->getLocation(), "CF_CONSUMED ");
-      Editor->commit(commit);
+      Commits.emplace_back(*Editor);
+      Commits.back().insertBefore(pd->getLocation(), "CF_CONSUMED ");
     }
   }
+  Editor->commitBatch(Commits);
 }
 
 void ObjCMigrateASTConsumer::migrateAddMethodAnnotation(
@@ -2235,16 +2243,43 @@ bool arcmt::getFileRemappingsFromFileList(
 
   llvm::DenseSet<EditEntry> EntriesSet;
 
+  // Translation units that include the same header usually make the same
+  // edits to it. Hash the edits that each remap file makes to a file, so that
+  // an edit set that was seen before is skipped as a whole.
+  std::set<std::tuple<const FileEntry *, uint64_t, uint64_t>> EditSetHashes;
+
   for (ArrayRef<StringRef>::iterator
          I = remapFiles.begin(), E = remapFiles.end(); I != E; ++I) {
     SmallVector<EditEntry, 16> Entries;
     if (Parser.parse(*I, Entries))
       continue;
 
+    std::map<const FileEntry *, llvm::MD5> Hashers;
+    for (const EditEntry &Entry : Entries) {
+      if (!Entry.File)
+        continue;
+      llvm::MD5 &Hasher = Hashers[Entry.File];
+      uint32_t Values[] = {Entry.Offset, Entry.RemoveLen,
+                           uint32_t(Entry.Text.size())};
+      Hasher.update(ArrayRef<uint8_t>(
+          reinterpret_cast<const uint8_t *>(Values), sizeof(Values)));
+      Hasher.update(Entry.Text);
+    }
+    llvm::SmallPtrSet<const FileEntry *, 8> SeenEditSets;
+    for (auto &FileAndHasher : Hashers) {
+      llvm::MD5::MD5Result Hash;
+      FileAndHasher.second.final(Hash);
+      if (!EditSetHashes
+               .insert(std::make_tuple(FileAndHasher.first, Hash.high(),
+                                       Hash.low()))
+               .second)
+        SeenEditSets.insert(FileAndHasher.first);
+    }
+
     for (SmallVectorImpl<EditEntry>::iterator
            EI = Entries.begin(), EE = Entries.end(); EI != EE; ++EI) {
       EditEntry &Entry = *EI;
-      if (!Entry.File)
+      if (!Entry.File || SeenEditSets.count(Entry.File))
         continue;
       std::pair<llvm::DenseSet<EditEntry>::iterator, bool>
         Insert = EntriesSet.insert(Entry);
@@ -147,10 +147,29 @@ struct APValue::MemberPointerData : MemberPointerBase {
 
 // FIXME: Reduce the malloc traffic here.
 
-APValue::Arr::Arr(unsigned NumElts, unsigned Size) :
-  Elts(new APValue[NumElts + (NumElts != Size ? 1 : 0)]),
-  NumElts(NumElts), ArrSize(Size) {}
-APValue::Arr::~Arr() { delete [] Elts; }
+APValue::Arr::Arr(unsigned NumElts, unsigned Size)
+    : NumElts(NumElts), ArrSize(Size) {
+  static_assert(ArrUsersOffset >= sizeof(unsigned),
+                "no room for the number of users of an array");
+  unsigned N = getNumStoredElts();
+  char *Mem = static_cast<char *>(
+      ::operator new(ArrUsersOffset + N * sizeof(APValue)));
+  new (Mem) unsigned(1);
+  Elts = reinterpret_cast<APValue *>(Mem + ArrUsersOffset);
+  for (unsigned I = 0; I != N; ++I)
+    new (Elts + I) APValue();
+}
+APValue::Arr::Arr(const Arr &RHS)
+    : Elts(RHS.Elts), NumElts(RHS.NumElts), ArrSize(RHS.ArrSize) {
+  ++getNumUsers();
+}
+APValue::Arr::~Arr() {
+  if (--getNumUsers())
+    return;
+  for (unsigned I = getNumStoredElts(); I != 0; --I)
+    Elts[I - 1].~APValue();
+  ::operator delete(reinterpret_cast<char *>(Elts) - ArrUsersOffset);
+}
 
 APValue::StructData::StructData(unsigned NumBases, unsigned NumFields) :
   Elts(new APValue[NumBases+NumFields]),
@@ -199,11 +218,10 @@ APValue::APValue(const APValue &RHS) : Kind(Uninitialized) {
                 RHS.isNullPointer());
     break;
   case Array:
-    MakeArray(RHS.getArrayInitializedElts(), RHS.getArraySize());
-    for (unsigned I = 0, N = RHS.getArrayInitializedElts(); I != N; ++I)
-      getArrayInitializedElt(I) = RHS.getArrayInitializedElt(I);
-    if (RHS.hasArrayFiller())
-      getArrayFiller() = RHS.getArrayFiller();
+    // Share the elements; they are copied if either array is modified.
+    new ((void*)(char*)Data.buffer)
+        Arr(*(const Arr*)(const char*)RHS.Data.buffer);
+    Kind = Array;
     break;
   case Struct:
     MakeStruct(RHS.getStructNumBases(), RHS.getStructNumFields());
@@ -699,6 +717,15 @@ void APValue::MakeArray(unsigned InitElts, unsigned Size) {
   Kind = Array;
 }
 
+void APValue::unshareArray() {
+  const Arr &Shared = *(const Arr*)(const char*)Data.buffer;
+  APValue Copy(UninitArray(), Shared.NumElts, Shared.ArrSize);
+  Arr &Own = *(Arr*)(char*)Copy.Data.buffer;
+  for (unsigned I = 0, N = Shared.getNumStoredElts(); I != N; ++I)
+    Own.Elts[I] = Shared.Elts[I];
+  swap(Copy);
+}
+
 void APValue::MakeMemberPointer(const ValueDecl *Member, bool IsDerivedMember,
                                 ArrayRef<const CXXRecordDecl*> Path) {
   assert(isUninit() && "Bad state change");
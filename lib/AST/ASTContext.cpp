@@ -12,7 +12,10 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/AST/ASTContext.h"
+#include "ASTMemoryAttribution.h"
 #include "CXXABI.h"
+#include "ConstexprCallMemo.h"
+#include "ConstexprInterpreter.h"
 #include "clang/AST/APValue.h"
 #include "clang/AST/ASTMutationListener.h"
 #include "clang/AST/ASTTypeTraits.h"
@@ -60,6 +63,7 @@
 #include "clang/Basic/Specifiers.h"
 #include "clang/Basic/TargetCXXABI.h"
 #include "clang/Basic/TargetInfo.h"
+#include "clang/Basic/TimeTraceProfiler.h"
 #include "clang/Basic/XRayLists.h"
 #include "llvm/ADT/APInt.h"
 #include "llvm/ADT/APSInt.h"
@@ -797,9 +801,18 @@ ASTContext::ASTContext(LangOptions &LOpts, SourceManager &SM,
       CompCategories(this_()), LastSDM(nullptr, 0) {
   TUDecl = TranslationUnitDecl::Create(*this);
   TraversalScope = {TUDecl};
+
+  // Let the time trace profiler attribute AST allocations to its events.
+  if (timeTraceProfilerEnabled())
+    PrevTimeTraceAllocationCounter = timeTraceProfilerSetAllocationCounter(
+        [this] { return BumpAlloc.getBytesAllocated(); });
 }
 
 ASTContext::~ASTContext() {
+  if (timeTraceProfilerEnabled())
+    timeTraceProfilerSetAllocationCounter(
+        std::move(PrevTimeTraceAllocationCounter));
+
   // Release the DenseMaps associated with DeclContext objects.
   // FIXME: Is this the ideal solution?
   ReleaseDeclContextMaps();
@@ -856,8 +869,41 @@ class ASTContext::ParentMap {
       llvm::PointerUnion4<const Decl *, const Stmt *,
                           ast_type_traits::DynTypedNode *, ParentVector *>>;
 
+  /// A declaration that is traversed as a whole, the first time the parents
+  /// of a node within it are asked for.
+  struct Unit {
+    Decl *D;
+
+    /// The translation unit, namespace, linkage specification or export
+    /// declaration that \c D is traversed from, or null if \c D is part of
+    /// the traversal scope itself.
+    Decl *Parent;
+
+    /// The expansion locations that \c D begins and ends at. These are only
+    /// computed when all units of the traversal scope are enumerated.
+    SourceLocation Begin, End;
+  };
+
+  ASTContext &Ctx;
   ParentMapPointers PointerParents;
   ParentMapOtherNodes OtherParents;
+
+  /// The units that were already traversed.
+  llvm::DenseSet<const Decl *> TraversedUnits;
+
+  /// All units of the traversal scope, once they were needed to find the
+  /// parents of a node by its location.
+  std::vector<Unit> Units;
+  bool UnitsEnumerated = false;
+
+  /// Whether all units of the traversal scope were traversed, so that the
+  /// map is complete.
+  bool AllUnitsTraversed = false;
+
+  /// Parent vectors that were replaced while they might still be referenced
+  /// by a DynTypedNodeList that was handed out.
+  std::vector<std::unique_ptr<ParentVector>> RetiredVectors;
+
   class ASTVisitor;
 
   static ast_type_traits::DynTypedNode
@@ -869,6 +915,13 @@ class ASTContext::ParentMap {
     return *U.get<ast_type_traits::DynTypedNode *>();
   }
 
+  static void deleteParents(ParentMapPointers::mapped_type U) {
+    if (U.is<ast_type_traits::DynTypedNode *>())
+      delete U.get<ast_type_traits::DynTypedNode *>();
+    else if (U.is<ParentVector *>())
+      delete U.get<ParentVector *>();
+  }
+
   template <typename NodeTy, typename MapTy>
   static ASTContext::DynTypedNodeList getDynNodeFromMap(const NodeTy &Node,
                                                         const MapTy &Map) {
@@ -882,30 +935,89 @@ class ASTContext::ParentMap {
     return getSingleDynTypedNodeFromParentMap(I->second);
   }
 
-public:
-  ParentMap(ASTContext &Ctx);
-  ~ParentMap() {
-    for (const auto &Entry : PointerParents) {
-      if (Entry.second.is<ast_type_traits::DynTypedNode *>()) {
-        delete Entry.second.get<ast_type_traits::DynTypedNode *>();
-      } else if (Entry.second.is<ParentVector *>()) {
-        delete Entry.second.get<ParentVector *>();
-      }
-    }
-    for (const auto &Entry : OtherParents) {
-      if (Entry.second.is<ast_type_traits::DynTypedNode *>()) {
-        delete Entry.second.get<ast_type_traits::DynTypedNode *>();
-      } else if (Entry.second.is<ParentVector *>()) {
-        delete Entry.second.get<ParentVector *>();
-      }
-    }
+  template <typename NodeTy, typename MapTy>
+  static void eraseFromMap(const NodeTy &Node, MapTy &Map) {
+    auto I = Map.find(Node);
+    if (I == Map.end())
+      return;
+    deleteParents(I->second);
+    Map.erase(I);
   }
 
-  DynTypedNodeList getParents(const ast_type_traits::DynTypedNode &Node) {
+  DynTypedNodeList lookup(const ast_type_traits::DynTypedNode &Node) const {
     if (Node.getNodeKind().hasPointerIdentity())
       return getDynNodeFromMap(Node.getMemoizationData(), PointerParents);
     return getDynNodeFromMap(Node, OtherParents);
   }
+
+  /// Whether the children of \p D are traversed as separate units. The
+  /// parents of these declarations are not stored in the map.
+  static bool isUnitContainer(const Decl *D) {
+    return isa<TranslationUnitDecl>(D) || isa<NamespaceDecl>(D) ||
+           isa<LinkageSpecDecl>(D) || isa<ExportDecl>(D);
+  }
+
+  bool isInTraversalScope(const Decl *D) const {
+    return llvm::is_contained(Ctx.TraversalScope, D);
+  }
+
+  /// Returns the unit container that the traversal reaches \p D from, or
+  /// null if there is none.
+  Decl *getTraversingContainer(const Decl *D) const {
+    // BlockDecls and CapturedDecls are traversed through their expressions
+    // and statements, like RecursiveASTVisitor does.
+    if (isa<BlockDecl>(D) || isa<CapturedDecl>(D))
+      return nullptr;
+    const DeclContext *DC = D->getLexicalDeclContext();
+    if (!DC)
+      return nullptr;
+    Decl *Container = Decl::castFromDeclContext(DC);
+    if (!isUnitContainer(Container) ||
+        !DC->containsDecl(const_cast<Decl *>(D)))
+      return nullptr;
+    if (isInTraversalScope(Container) || getTraversingContainer(Container))
+      return Container;
+    return nullptr;
+  }
+
+  /// Find the unit that contains \p D by walking its lexical declaration
+  /// contexts.
+  Optional<Unit> findUnit(const Decl *D) const {
+    while (!isUnitContainer(D)) {
+      Decl *Mutable = const_cast<Decl *>(D);
+      if (Decl *Container = getTraversingContainer(D))
+        return Unit{Mutable, Container, SourceLocation(), SourceLocation()};
+      if (isInTraversalScope(D))
+        return Unit{Mutable, nullptr, SourceLocation(), SourceLocation()};
+      const DeclContext *DC = D->getLexicalDeclContext();
+      if (!DC)
+        break;
+      D = Decl::castFromDeclContext(DC);
+    }
+    return None;
+  }
+
+  void enumerateUnits();
+  void addUnits(Decl *D, Decl *Parent);
+  void traverseUnit(const Unit &U);
+  bool traverseUnitsAt(SourceLocation Loc);
+
+public:
+  ParentMap(ASTContext &Ctx) : Ctx(Ctx) {}
+  ~ParentMap() {
+    for (const auto &Entry : PointerParents)
+      deleteParents(Entry.second);
+    for (const auto &Entry : OtherParents)
+      deleteParents(Entry.second);
+  }
+
+  DynTypedNodeList getParents(const ast_type_traits::DynTypedNode &Node);
+
+  void traverseAllUnits();
+
+  /// Drop the parents of the nodes within the unit that contains \p D.
+  /// Returns false if there is no such unit.
+  bool forgetUnitOf(const Decl *D);
 };
 
 void ASTContext::setTraversalScope(const std::vector<Decl *> &TopLevelDecls) {
@@ -975,6 +1087,11 @@ void ASTContext::PrintStats() const {
                << NumImplicitDestructors
                << " implicit destructors created\n";
 
+  if (ConstexprCalls) {
+    llvm::errs() << "\n";
+    ConstexprCalls->PrintStats();
+  }
+
   if (ExternalSource) {
     llvm::errs() << "\n";
     ExternalSource->PrintStats();
@@ -983,6 +1100,43 @@ void ASTContext::PrintStats() const {
   BumpAlloc.PrintStats();
 }
 
+template <typename SetTy>
+static void reserveTypeSet(SetTy &Set, ArrayRef<uint64_t> NumTypesByClass,
+                           Type::TypeClass TC) {
+  if (TC < NumTypesByClass.size() && NumTypesByClass[TC])
+    Set.reserve(Set.size() + NumTypesByClass[TC]);
+}
+
+void ASTContext::reserveTypes(ArrayRef<uint64_t> NumTypesByClass) {
+  // Only some of the types of a class are uniqued (type sugar mostly is not),
+  // so this may overestimate; that costs at most one pointer per two types.
+  reserveTypeSet(ComplexTypes, NumTypesByClass, Type::Complex);
+  reserveTypeSet(PointerTypes, NumTypesByClass, Type::Pointer);
+  reserveTypeSet(BlockPointerTypes, NumTypesByClass, Type::BlockPointer);
+  reserveTypeSet(LValueReferenceTypes, NumTypesByClass, Type::LValueReference);
+  reserveTypeSet(RValueReferenceTypes, NumTypesByClass, Type::RValueReference);
+  reserveTypeSet(MemberPointerTypes, NumTypesByClass, Type::MemberPointer);
+  reserveTypeSet(ConstantArrayTypes, NumTypesByClass, Type::ConstantArray);
+  reserveTypeSet(IncompleteArrayTypes, NumTypesByClass, Type::IncompleteArray);
+  reserveTypeSet(VectorTypes, NumTypesByClass, Type::Vector);
+  reserveTypeSet(FunctionNoProtoTypes, NumTypesByClass, Type::FunctionNoProto);
+  reserveTypeSet(FunctionProtoTypes, NumTypesByClass, Type::FunctionProto);
+  reserveTypeSet(TemplateTypeParmTypes, NumTypesByClass,
+                 Type::TemplateTypeParm);
+  reserveTypeSet(SubstTemplateTypeParmTypes, NumTypesByClass,
+                 Type::SubstTemplateTypeParm);
+  reserveTypeSet(TemplateSpecializationTypes, NumTypesByClass,
+                 Type::TemplateSpecialization);
+  reserveTypeSet(ParenTypes, NumTypesByClass, Type::Paren);
+  reserveTypeSet(ElaboratedTypes, NumTypesByClass, Type::Elaborated);
+  reserveTypeSet(DependentNameTypes, NumTypesByClass, Type::DependentName);
+  reserveTypeSet(DependentTemplateSpecializationTypes, NumTypesByClass,
+                 Type::DependentTemplateSpecialization);
+  reserveTypeSet(PackExpansionTypes, NumTypesByClass, Type::PackExpansion);
+  reserveTypeSet(AttributedTypes, NumTypesByClass, Type::Attributed);
+  reserveTypeSet(AutoTypes, NumTypesByClass, Type::Auto);
+}
+
 void ASTContext::mergeDefinitionIntoModule(NamedDecl *ND, Module *M,
                                            bool NotifyListeners) {
   if (NotifyListeners)
@@ -1099,6 +1253,14 @@ ASTContext::getTypePackElementDecl() const {
   return TypePackElementDecl;
 }
 
+BuiltinTemplateDecl *
+ASTContext::getTypePackSliceDecl() const {
+  if (!TypePackSliceDecl)
+    TypePackSliceDecl = buildBuiltinTemplateDecl(BTK__type_pack_slice,
+                                                 getTypePackSliceName());
+  return TypePackSliceDecl;
+}
+
 RecordDecl *ASTContext::buildImplicitRecord(StringRef Name,
                                             RecordDecl::TagKind TK) const {
   SourceLocation Loc;
@@ -3777,8 +3939,10 @@ QualType ASTContext::getFunctionTypeInternal(
   FunctionProtoType::ExtProtoInfo newEPI = EPI;
   new (FTP) FunctionProtoType(ResultTy, ArgArray, Canonical, newEPI);
   Types.push_back(FTP);
-  if (!Unique)
+  if (!Unique) {
+    FTP->ProfileHash = ID.ComputeHash();
     FunctionProtoTypes.InsertNode(FTP, InsertPos);
+  }
   return QualType(FTP, 0);
 }
 
@@ -4157,6 +4321,7 @@ QualType ASTContext::getCanonicalTemplateSpecializationType(
                                                 CanonArgs,
                                                 QualType(), QualType());
     Types.push_back(Spec);
+    Spec->ProfileHash = ID.ComputeHash();
     TemplateSpecializationTypes.InsertNode(Spec, InsertPos);
   }
 
@@ -4305,6 +4470,7 @@ ASTContext::getDependentTemplateSpecializationType(
   T = new (Mem) DependentTemplateSpecializationType(Keyword, NNS,
                                                     Name, Args, Canon);
   Types.push_back(T);
+  T->ProfileHash = ID.ComputeHash();
   DependentTemplateSpecializationTypes.InsertNode(T, InsertPos);
   return QualType(T, 0);
 }
@@ -9981,6 +10147,18 @@ VTableContextBase *ASTContext::getVTableContext() {
   return VTContext.get();
 }
 
+ConstexprInterpreter &ASTContext::getConstexprInterpreter() {
+  if (!ConstexprInterp)
+    ConstexprInterp.reset(new ConstexprInterpreter(*this));
+  return *ConstexprInterp;
+}
+
+ConstexprCallMemo &ASTContext::getConstexprCallMemo() {
+  if (!ConstexprCalls)
+    ConstexprCalls.reset(new ConstexprCallMemo());
+  return *ConstexprCalls;
+}
+
 MangleContext *ASTContext::createMangleContext() {
   switch (Target->getCXXABI().getKind()) {
   case TargetCXXABI::GenericAArch64:
@@ -10012,11 +10190,26 @@ size_t ASTContext::getSideTableAllocatedMemory() const {
          llvm::capacity_in_bytes(InstantiatedFromUsingShadowDecl) +
          llvm::capacity_in_bytes(InstantiatedFromUnnamedFieldDecl) +
          llvm::capacity_in_bytes(OverriddenMethods) +
+         llvm::capacity_in_bytes(MangledDeclNames) +
          llvm::capacity_in_bytes(Types) +
          llvm::capacity_in_bytes(VariableArrayTypes) +
          llvm::capacity_in_bytes(ClassScopeSpecializationPattern);
 }
 
+void ASTContext::enableMemoryAttribution() {
+  if (!MemoryAttribution)
+    MemoryAttribution = llvm::make_unique<ASTMemoryAttribution>(*this);
+}
+
+void ASTContext::noteAllocation(const void *Ptr, size_t Size) const {
+  MemoryAttribution->noteAllocation(Ptr, Size);
+}
+
+void ASTContext::PrintMemoryReport(raw_ostream &OS) const {
+  assert(MemoryAttribution && "memory attribution is not enabled");
+  MemoryAttribution->print(OS);
+}
+
 /// getIntTypeForBitwidth -
 /// sets integer QualTy according to specified details:
 /// bitwidth, signed/unsigned.
@@ -10071,6 +10264,17 @@ unsigned ASTContext::getStaticLocalNumber(const VarDecl *VD) const {
   return I != StaticLocalNumbers.end() ? I->second : 1;
 }
 
+StringRef ASTContext::setMangledDeclName(const NamedDecl *ND,
+                                         StringRef Name) {
+  StringRef &Entry = MangledDeclNames[ND];
+  if (Entry.empty()) {
+    char *Buffer = static_cast<char *>(Allocate(Name.size(), 1));
+    std::copy(Name.begin(), Name.end(), Buffer);
+    Entry = StringRef(Buffer, Name.size());
+  }
+  return Entry;
+}
+
 MangleNumberingContext &
 ASTContext::getManglingNumberContext(const DeclContext *DC) {
   assert(LangOpts.CPlusPlus);  // We don't need mangling numbers for plain C.
@@ -10191,6 +10395,20 @@ class ASTContext::ParentMap::ASTVisitor
 public:
   ASTVisitor(ParentMap &Map) : Map(Map) {}
 
+  /// Add the parents of the nodes within \p D to the map, with \p Parent as
+  /// the parent of \p D itself.
+  void addParents(Decl *D, Decl *Parent) {
+    if (Parent)
+      ParentStack.push_back(ast_type_traits::DynTypedNode::create(*Parent));
+    TraverseDecl(D);
+  }
+
+  /// Remove the nodes within \p D, and \p D itself, from the map.
+  void removeParents(Decl *D) {
+    Remove = true;
+    TraverseDecl(D);
+  }
+
 private:
   friend class RecursiveASTVisitor<ASTVisitor>;
 
@@ -10206,7 +10424,9 @@ private:
                     MapTy *Parents) {
     if (!Node)
       return true;
-    if (ParentStack.size() > 0) {
+    if (Remove) {
+      eraseFromMap(MapNode, *Parents);
+    } else if (ParentStack.size() > 0) {
       // FIXME: Currently we add the same parent multiple times, but only
       // when no memoization data is available for the type.
       // For example when we visit all subexpressions of template
@@ -10232,9 +10452,19 @@ private:
           delete NodeOrVector
               .template dyn_cast<ast_type_traits::DynTypedNode *>();
           NodeOrVector = Vector;
+          CreatedVectors.insert(Vector);
         }
 
         auto *Vector = NodeOrVector.template get<ParentVector *>();
+        if (!CreatedVectors.count(Vector)) {
+          // The vector was created while traversing another unit, and may be
+          // referenced by a list of parents that is still in use. Leave it
+          // alone and continue with a copy.
+          Map.RetiredVectors.emplace_back(Vector);
+          Vector = new ParentVector(*Vector);
+          NodeOrVector = Vector;
+          CreatedVectors.insert(Vector);
+        }
         // Skip duplicates for types that have memoization data.
         // We must check that the type has memoization data before calling
         // std::find() because DynTypedNode::operator== can't compare all
@@ -10280,21 +10510,135 @@ private:
 
   ParentMap &Map;
   llvm::SmallVector<ast_type_traits::DynTypedNode, 16> ParentStack;
+
+  /// The parent vectors created by this traversal.
+  llvm::SmallPtrSet<ParentVector *, 8> CreatedVectors;
+
+  /// Whether the traversed nodes are removed from the map, rather than
+  /// added to it.
+  bool Remove = false;
 };
 
-ASTContext::ParentMap::ParentMap(ASTContext &Ctx) {
-  ASTVisitor(*this).TraverseAST(Ctx);
+void ASTContext::ParentMap::addUnits(Decl *D, Decl *Parent) {
+  if (!isUnitContainer(D)) {
+    const SourceManager &SM = Ctx.getSourceManager();
+    SourceRange Range = D->getSourceRange();
+    Units.push_back({D, Parent, SM.getExpansionLoc(Range.getBegin()),
+                     SM.getExpansionLoc(Range.getEnd())});
+    return;
+  }
+  for (Decl *Child : Decl::castToDeclContext(D)->decls())
+    if (!isa<BlockDecl>(Child) && !isa<CapturedDecl>(Child))
+      addUnits(Child, D);
+}
+
+void ASTContext::ParentMap::enumerateUnits() {
+  if (UnitsEnumerated)
+    return;
+  UnitsEnumerated = true;
+  for (Decl *D : Ctx.TraversalScope)
+    addUnits(D, nullptr);
+}
+
+void ASTContext::ParentMap::traverseUnit(const Unit &U) {
+  if (TraversedUnits.insert(U.D).second)
+    ASTVisitor(*this).addParents(U.D, U.Parent);
+}
+
+bool ASTContext::ParentMap::traverseUnitsAt(SourceLocation Loc) {
+  if (Loc.isInvalid())
+    return false;
+  enumerateUnits();
+  const SourceManager &SM = Ctx.getSourceManager();
+  Loc = SM.getExpansionLoc(Loc);
+  bool Traversed = false;
+  for (const Unit &U : Units) {
+    if (U.Begin.isInvalid() || U.End.isInvalid() || TraversedUnits.count(U.D))
+      continue;
+    if (SM.isBeforeInTranslationUnit(Loc, U.Begin) ||
+        SM.isBeforeInTranslationUnit(U.End, Loc))
+      continue;
+    traverseUnit(U);
+    Traversed = true;
+  }
+  return Traversed;
+}
+
+void ASTContext::ParentMap::traverseAllUnits() {
+  enumerateUnits();
+  for (const Unit &U : Units)
+    traverseUnit(U);
+  AllUnitsTraversed = true;
+}
+
+ASTContext::DynTypedNodeList ASTContext::ParentMap::getParents(
+    const ast_type_traits::DynTypedNode &Node) {
+  const Decl *D = Node.get<Decl>();
+  if (D && isUnitContainer(D)) {
+    if (const Decl *Container = getTraversingContainer(D))
+      return ast_type_traits::DynTypedNode::create(*Container);
+    return llvm::ArrayRef<ast_type_traits::DynTypedNode>();
+  }
+
+  DynTypedNodeList Result = lookup(Node);
+  if (!Result.empty() || AllUnitsTraversed)
+    return Result;
+
+  // Traverse the unit that the node is expected in: the one that its lexical
+  // declaration contexts lead to for a declaration, or the ones that contain
+  // its location for anything else. A node may also be reached from
+  // elsewhere, for example methods of template instantiations are reached
+  // through their templates, so if that does not find any parents fall back
+  // to traversing everything.
+  if (D) {
+    Optional<Unit> U = findUnit(D);
+    if (U && !TraversedUnits.count(U->D)) {
+      traverseUnit(*U);
+      Result = lookup(Node);
+      if (!Result.empty())
+        return Result;
+    }
+  }
+  if (traverseUnitsAt(Node.getSourceRange().getBegin())) {
+    Result = lookup(Node);
+    if (!Result.empty())
+      return Result;
+  }
+  traverseAllUnits();
+  return lookup(Node);
+}
+
+bool ASTContext::ParentMap::forgetUnitOf(const Decl *D) {
+  Optional<Unit> U = findUnit(D);
+  if (!U)
+    return false;
+  if (TraversedUnits.erase(U->D))
+    ASTVisitor(*this).removeParents(U->D);
+  AllUnitsTraversed = false;
+  return true;
 }
 
 ASTContext::DynTypedNodeList
 ASTContext::getParents(const ast_type_traits::DynTypedNode &Node) {
   if (!Parents)
-    // We build the parent map for the traversal scope (usually whole TU), as
-    // hasAncestor can escape any subtree.
+    // The parent map covers the traversal scope (usually whole TU), as
+    // hasAncestor can escape any subtree, but it is only filled in for the
+    // parts of it that are asked about.
     Parents = llvm::make_unique<ParentMap>(*this);
   return Parents->getParents(Node);
 }
 
+void ASTContext::computeAllParents() {
+  if (!Parents)
+    Parents = llvm::make_unique<ParentMap>(*this);
+  Parents->traverseAllUnits();
+}
+
+void ASTContext::invalidateParents(const DeclContext *DC) {
+  if (Parents && !Parents->forgetUnitOf(Decl::castFromDeclContext(DC)))
+    Parents.reset();
+}
+
 bool
 ASTContext::ObjCMethodsAreEqual(const ObjCMethodDecl *MethodDecl,
                                 const ObjCMethodDecl *MethodImpl) {
@@ -0,0 +1,87 @@
+//===- ASTImporterLookupTable.cpp - Name lookup for the importer ----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the ASTImporterLookupTable class.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/AST/ASTImporterLookupTable.h"
+#include "clang/AST/Decl.h"
+#include "clang/AST/DeclCXX.h"
+#include "clang/AST/DeclFriend.h"
+#include "clang/AST/DeclTemplate.h"
+
+using namespace clang;
+
+/// Returns true if name lookup never finds \p D. This mirrors the check
+/// DeclContext uses when it builds its own lookup table.
+static bool isHiddenFromLookup(NamedDecl *D) {
+  if (!D->getDeclName())
+    return true;
+  if ((D->getIdentifierNamespace() == 0 && !isa<UsingDirectiveDecl>(D)) ||
+      D->isTemplateParameter())
+    return true;
+  if (isa<ClassTemplateSpecializationDecl>(D))
+    return true;
+  if (auto *FD = dyn_cast<FunctionDecl>(D))
+    if (FD->isFunctionTemplateSpecialization())
+      return true;
+  return false;
+}
+
+ASTImporterLookupTable::ASTImporterLookupTable(TranslationUnitDecl &TU) {
+  addDeclsOf(&TU);
+}
+
+void ASTImporterLookupTable::addDeclsOf(DeclContext *DC) {
+  for (Decl *D : DC->decls()) {
+    if (auto *ND = dyn_cast<NamedDecl>(D))
+      add(ND);
+    if (auto *Friend = dyn_cast<FriendDecl>(D))
+      if (NamedDecl *ND = Friend->getFriendDecl())
+        add(ND);
+
+    if (auto *Inner = dyn_cast<DeclContext>(D))
+      addDeclsOf(Inner);
+
+    // The members of templates and of the instantiations of class templates
+    // are not in the contexts enclosing them.
+    if (auto *Template = dyn_cast<TemplateDecl>(D))
+      if (auto *Templated =
+              dyn_cast_or_null<DeclContext>(Template->getTemplatedDecl()))
+        addDeclsOf(Templated);
+    if (auto *ClassTemplate = dyn_cast<ClassTemplateDecl>(D))
+      for (ClassTemplateSpecializationDecl *Spec :
+           ClassTemplate->specializations())
+        addDeclsOf(Spec);
+  }
+}
+
+void ASTImporterLookupTable::add(DeclContext *DC, NamedDecl *ND) {
+  Table[std::make_pair(DC->getPrimaryContext(), ND->getDeclName())].insert(ND);
+}
+
+void ASTImporterLookupTable::add(NamedDecl *ND) {
+  if (isHiddenFromLookup(ND))
+    return;
+  DeclContext *DC = ND->getDeclContext();
+  add(DC, ND);
+  while (DC->isTransparentContext() || DC->isInlineNamespace()) {
+    DC = DC->getParent();
+    add(DC, ND);
+  }
+}
+
+const ASTImporterLookupTable::DeclList &
+ASTImporterLookupTable::lookup(DeclContext *DC, DeclarationName Name) const {
+  auto It = Table.find(std::make_pair(DC->getPrimaryContext(), Name));
+  if (It == Table.end())
+    return NoDecls;
+  return It->second;
+}
@@ -0,0 +1,179 @@
+//===--- ASTMemoryAttribution.cpp - AST memory by node kind ---------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the attribution of AST memory to node kinds and
+//  source files.
+//
+//===----------------------------------------------------------------------===//
+
+#include "ASTMemoryAttribution.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/DeclBase.h"
+#include "clang/AST/Stmt.h"
+#include "clang/AST/Type.h"
+#include "clang/Basic/SourceManager.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+
+using namespace clang;
+
+/// The attribution that statements created on this thread are reported to.
+static LLVM_THREAD_LOCAL ASTMemoryAttribution *ActiveAttribution = nullptr;
+
+ASTMemoryAttribution::ASTMemoryAttribution(const ASTContext &Ctx)
+    : Ctx(Ctx), PrevActive(ActiveAttribution) {
+  ActiveAttribution = this;
+  Stmt::EnableMemoryAttribution();
+}
+
+ASTMemoryAttribution::~ASTMemoryAttribution() {
+  if (ActiveAttribution == this)
+    ActiveAttribution = PrevActive;
+}
+
+void ASTMemoryAttribution::noteStmt(const Stmt *S) {
+  if (ActiveAttribution)
+    ActiveAttribution->noteNode(S, S);
+}
+
+namespace {
+
+/// The memory attributed to one node kind or source file.
+struct Usage {
+  size_t Bytes = 0;
+  unsigned Count = 0;
+};
+
+} // end anonymous namespace
+
+static StringRef getFileName(const SourceManager &SM, SourceLocation Loc) {
+  if (Loc.isInvalid())
+    return "<no location>";
+  FileID FID = SM.getFileID(SM.getExpansionLoc(Loc));
+  if (const FileEntry *FE = SM.getFileEntryForID(FID))
+    return FE->getName();
+  return "<built-in>";
+}
+
+/// Print the entries of \p Usages, largest first, each named \p Prefix
+/// followed by its key. At most \p Limit entries are printed; the rest are
+/// summarized in one line.
+static void printUsages(raw_ostream &OS, const llvm::StringMap<Usage> &Usages,
+                        StringRef Prefix, unsigned Limit = ~0U) {
+  std::vector<const llvm::StringMapEntry<Usage> *> Sorted;
+  for (const auto &Entry : Usages)
+    Sorted.push_back(&Entry);
+  std::sort(Sorted.begin(), Sorted.end(),
+            [](const llvm::StringMapEntry<Usage> *LHS,
+               const llvm::StringMapEntry<Usage> *RHS) {
+              if (LHS->getValue().Bytes != RHS->getValue().Bytes)
+                return LHS->getValue().Bytes > RHS->getValue().Bytes;
+              return LHS->getKey() < RHS->getKey();
+            });
+
+  Usage Rest;
+  for (unsigned I = 0, N = Sorted.size(); I != N; ++I) {
+    const Usage &U = Sorted[I]->getValue();
+    if (I >= Limit) {
+      Rest.Bytes += U.Bytes;
+      Rest.Count += U.Count;
+      continue;
+    }
+    OS << "  " << U.Bytes << " bytes in " << U.Count << " " << Prefix
+       << Sorted[I]->getKey() << "\n";
+  }
+  if (Sorted.size() > Limit)
+    OS << "  " << Rest.Bytes << " bytes in " << Rest.Count << " " << Prefix
+       << (Sorted.size() - Limit) << " others\n";
+}
+
+void ASTMemoryAttribution::print(raw_ostream &OS) const {
+  const SourceManager &SM = Ctx.getSourceManager();
+
+  // Types were not matched to their allocations when they were created, so
+  // look them up now.
+  std::vector<NodePtr> Nodes;
+  Nodes.reserve(Allocations.size());
+  std::vector<unsigned> ByAddress;
+  ByAddress.reserve(Allocations.size());
+  for (unsigned I = 0, N = Allocations.size(); I != N; ++I) {
+    Nodes.push_back(Allocations[I].Node);
+    ByAddress.push_back(I);
+  }
+  std::sort(ByAddress.begin(), ByAddress.end(),
+            [&](unsigned LHS, unsigned RHS) {
+              return Allocations[LHS].Ptr < Allocations[RHS].Ptr;
+            });
+  for (const Type *T : Ctx.getTypes()) {
+    auto It = std::upper_bound(
+        ByAddress.begin(), ByAddress.end(), (const char *)T,
+        [&](const char *P, unsigned I) { return P < Allocations[I].Ptr; });
+    if (It == ByAddress.begin())
+      continue;
+    unsigned I = *--It;
+    if (Allocations[I].contains(T) && Nodes[I].isNull())
+      Nodes[I] = T;
+  }
+
+  llvm::StringMap<Usage> ByKind, ByFile;
+  Usage Other;
+  size_t Tracked = 0;
+  for (unsigned I = 0, N = Allocations.size(); I != N; ++I) {
+    size_t Size = Allocations[I].Size;
+    Tracked += Size;
+
+    if (Nodes[I].isNull()) {
+      Other.Bytes += Size;
+      ++Other.Count;
+      continue;
+    }
+
+    std::string Kind;
+    SourceLocation Loc;
+    if (const auto *D = Nodes[I].dyn_cast<const Decl *>()) {
+      Kind = std::string(D->getDeclKindName()) + "Decl";
+      Loc = D->getLocation();
+    } else if (const auto *S = Nodes[I].dyn_cast<const Stmt *>()) {
+      Kind = S->getStmtClassName();
+      Loc = S->getBeginLoc();
+    } else {
+      Kind = std::string(Nodes[I].get<const Type *>()->getTypeClassName()) +
+             "Type";
+    }
+
+    Usage &K = ByKind[Kind];
+    K.Bytes += Size;
+    ++K.Count;
+    Usage &F = ByFile[getFileName(SM, Loc)];
+    F.Bytes += Size;
+    ++F.Count;
+  }
+
+  size_t Allocated = Ctx.getAllocator().getBytesAllocated();
+
+  OS << "\n*** AST Memory Report:\n";
+  OS << "  " << Ctx.getASTAllocatedMemory() << " bytes in allocator slabs, "
+     << Allocated << " bytes allocated.\n";
+  OS << "  " << Ctx.getSideTableAllocatedMemory()
+     << " bytes in side tables.\n";
+
+  OS << "\nBytes allocated by node kind:\n";
+  printUsages(OS, ByKind, "");
+  OS << "  " << Other.Bytes << " bytes in " << Other.Count
+     << " other allocations\n";
+  if (Allocated > Tracked)
+    OS << "  " << (Allocated - Tracked)
+       << " bytes allocated before attribution began or outside of "
+          "ASTContext::Allocate\n";
+
+  OS << "\nBytes allocated by source file:\n";
+  printUsages(OS, ByFile, "nodes from ", 50);
+}
@@ -0,0 +1,93 @@
+//===--- ASTMemoryAttribution.h - AST memory by node kind -------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file defines the bookkeeping that attributes the memory allocated by
+//  an ASTContext to the kinds of AST nodes, and the source files, it was used
+//  for.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LIB_AST_ASTMEMORYATTRIBUTION_H
+#define LLVM_CLANG_LIB_AST_ASTMEMORYATTRIBUTION_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/PointerUnion.h"
+#include <cstddef>
+#include <vector>
+
+namespace clang {
+
+class ASTContext;
+class Decl;
+class Stmt;
+class Type;
+
+/// Records every allocation that an ASTContext makes through
+/// ASTContext::Allocate, and which declaration, statement or type was placed
+/// in it.
+///
+/// Declarations and statements are matched to an allocation when they are
+/// created, which is right after the allocation for them has been made.
+/// Types are matched when the report is printed, by looking up the
+/// allocation that contains them. The source file of a node is also only
+/// computed then, because declarations and statements read from an AST file
+/// only get their locations after they have been created.
+class ASTMemoryAttribution {
+public:
+  explicit ASTMemoryAttribution(const ASTContext &Ctx);
+  ~ASTMemoryAttribution();
+
+  ASTMemoryAttribution(const ASTMemoryAttribution &) = delete;
+  ASTMemoryAttribution &operator=(const ASTMemoryAttribution &) = delete;
+
+  void noteAllocation(const void *Ptr, size_t Size) {
+    Allocations.push_back({static_cast<const char *>(Ptr), Size, NodePtr()});
+  }
+
+  /// Note that the declaration \p D was placed in the most recent allocation.
+  void noteDecl(const Decl *D) { noteNode(D, D); }
+
+  /// Note that the statement \p S was created, by whichever ASTContext is
+  /// attributing memory on this thread. The statement is ignored unless it
+  /// was placed in that context's most recent allocation.
+  static void noteStmt(const Stmt *S);
+
+  /// Print the bytes allocated per node kind and per source file, largest
+  /// first.
+  void print(raw_ostream &OS) const;
+
+private:
+  using NodePtr = llvm::PointerUnion3<const Decl *, const Stmt *, const Type *>;
+
+  struct Allocation {
+    const char *Ptr;
+    size_t Size;
+    NodePtr Node;
+
+    bool contains(const void *P) const {
+      return P >= Ptr && P < Ptr + Size;
+    }
+  };
+
+  void noteNode(const void *Ptr, NodePtr Node) {
+    if (!Allocations.empty() && Allocations.back().contains(Ptr) &&
+        Allocations.back().Node.isNull())
+      Allocations.back().Node = Node;
+  }
+
+  const ASTContext &Ctx;
+  std::vector<Allocation> Allocations;
+
+  /// The attribution that was active on this thread before this one.
+  ASTMemoryAttribution *PrevActive;
+};
+
+} // end namespace clang
+
+#endif // LLVM_CLANG_LIB_AST_ASTMEMORYATTRIBUTION_H
@@ -24,6 +24,7 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/iterator_range.h"
 #include "llvm/Support/Casting.h"
@@ -89,7 +90,64 @@ void CXXBasePaths::swap(CXXBasePaths &Other) {
   std::swap(DetectedVirtual, Other.DetectedVirtual);
 }
 
+Optional<ArrayRef<const CXXRecordDecl *>> CXXRecordDecl::getAllBases() const {
+  if (!hasDefinition() || isDependentContext())
+    return None;
+
+  const struct DefinitionData &Data = data();
+  if (Data.AllBases)
+    return llvm::makeArrayRef(Data.AllBases, Data.NumAllBases);
+  // Don't cache anything before the base specifiers are attached.
+  if (Data.NumBases == 0)
+    return ArrayRef<const CXXRecordDecl *>();
+
+  llvm::SmallPtrSet<const CXXRecordDecl *, 16> Seen;
+  SmallVector<const CXXRecordDecl *, 16> Bases;
+  SmallVector<const CXXRecordDecl *, 8> Queue;
+  const CXXRecordDecl *Record = this;
+  while (true) {
+    for (const auto &I : Record->bases()) {
+      const RecordType *Ty = I.getType()->getAs<RecordType>();
+      if (!Ty)
+        return None;
+      const CXXRecordDecl *Base =
+          cast_or_null<CXXRecordDecl>(Ty->getDecl()->getDefinition());
+      if (!Base)
+        return None;
+      // A base class that appears more than once in the hierarchy, virtually
+      // or not, only needs to be visited once.
+      if (!Seen.insert(Base->getCanonicalDecl()).second)
+        continue;
+      Bases.push_back(Base->getCanonicalDecl());
+      Queue.push_back(Base);
+    }
+
+    if (Queue.empty())
+      break;
+    Record = Queue.pop_back_val();
+  }
+
+  llvm::sort(Bases);
+  Data.AllBases = new (getASTContext()) const CXXRecordDecl *[Bases.size()];
+  std::copy(Bases.begin(), Bases.end(), Data.AllBases);
+  Data.NumAllBases = Bases.size();
+  return llvm::makeArrayRef(Data.AllBases, Data.NumAllBases);
+}
+
+/// Determine whether the set of bases returned by getAllBases() contains
+/// \p Base, which must be a canonical declaration.
+static bool containsBase(ArrayRef<const CXXRecordDecl *> AllBases,
+                         const CXXRecordDecl *Base) {
+  return std::binary_search(AllBases.begin(), AllBases.end(), Base);
+}
+
 bool CXXRecordDecl::isDerivedFrom(const CXXRecordDecl *Base) const {
+  if (getCanonicalDecl() == Base->getCanonicalDecl())
+    return false;
+
+  if (Optional<ArrayRef<const CXXRecordDecl *>> AllBases = getAllBases())
+    return containsBase(*AllBases, Base->getCanonicalDecl());
+
   CXXBasePaths Paths(/*FindAmbiguities=*/false, /*RecordPaths=*/false,
                      /*DetectVirtual=*/false);
   return isDerivedFrom(Base, Paths);
@@ -103,6 +161,12 @@ bool CXXRecordDecl::isDerivedFrom(const CXXRecordDecl *Base,
   Paths.setOrigin(const_cast<CXXRecordDecl*>(this));
 
   const CXXRecordDecl *BaseDecl = Base->getCanonicalDecl();
+
+  // Only build the paths to a class that is known to be a base.
+  if (Optional<ArrayRef<const CXXRecordDecl *>> AllBases = getAllBases())
+    if (!containsBase(*AllBases, BaseDecl))
+      return false;
+
   // FIXME: Capturing 'this' is a workaround for name lookup bugs in GCC 4.7.
   return lookupInBases(
       [BaseDecl](const CXXBaseSpecifier *Specifier, CXXBasePath &Path) {
@@ -121,9 +185,21 @@ bool CXXRecordDecl::isVirtuallyDerivedFrom(const CXXRecordDecl *Base) const {
   if (getCanonicalDecl() == Base->getCanonicalDecl())
     return false;
 
+  const CXXRecordDecl *BaseDecl = Base->getCanonicalDecl();
+
+  // The virtual bases of a class that is not dependent are already listed
+  // once each, however deep in the hierarchy they are.
+  if (getAllBases()) {
+    for (const CXXBaseSpecifier &VBase : vbases()) {
+      const CXXRecordDecl *VBaseDecl = VBase.getType()->getAsCXXRecordDecl();
+      if (VBaseDecl && VBaseDecl->getCanonicalDecl() == BaseDecl)
+        return true;
+    }
+    return false;
+  }
+
   Paths.setOrigin(const_cast<CXXRecordDecl*>(this));
 
-  const CXXRecordDecl *BaseDecl = Base->getCanonicalDecl();
   // FIXME: Capturing 'this' is a workaround for name lookup bugs in GCC 4.7.
   return lookupInBases(
       [BaseDecl](const CXXBaseSpecifier *Specifier, CXXBasePath &Path) {
@@ -0,0 +1,118 @@
+//===--- ConstexprCallMemo.cpp - Memoized constexpr call results ----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the table of memoized constexpr function calls.
+//
+//===----------------------------------------------------------------------===//
+
+#include "ConstexprCallMemo.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace clang;
+
+bool ConstexprCallMemo::isMemoizableValue(const APValue &V) {
+  switch (V.getKind()) {
+  case APValue::Int:
+  case APValue::Float:
+  case APValue::ComplexInt:
+  case APValue::ComplexFloat:
+    return true;
+  default:
+    return false;
+  }
+}
+
+static llvm::hash_code hashValue(const APValue &V) {
+  switch (V.getKind()) {
+  case APValue::Int:
+    return llvm::hash_value(V.getInt());
+  case APValue::Float:
+    return llvm::hash_value(V.getFloat());
+  case APValue::ComplexInt:
+    return llvm::hash_combine(V.getComplexIntReal(), V.getComplexIntImag());
+  case APValue::ComplexFloat:
+    return llvm::hash_combine(llvm::hash_value(V.getComplexFloatReal()),
+                              llvm::hash_value(V.getComplexFloatImag()));
+  default:
+    llvm_unreachable("value cannot be memoized");
+  }
+}
+
+static bool isSameValue(const APValue &LHS, const APValue &RHS) {
+  if (LHS.getKind() != RHS.getKind())
+    return false;
+  switch (LHS.getKind()) {
+  case APValue::Int:
+    return llvm::APSInt::isSameValue(LHS.getInt(), RHS.getInt());
+  case APValue::Float:
+    return LHS.getFloat().bitwiseIsEqual(RHS.getFloat());
+  case APValue::ComplexInt:
+    return llvm::APSInt::isSameValue(LHS.getComplexIntReal(),
+                                     RHS.getComplexIntReal()) &&
+           llvm::APSInt::isSameValue(LHS.getComplexIntImag(),
+                                     RHS.getComplexIntImag());
+  case APValue::ComplexFloat:
+    return LHS.getComplexFloatReal().bitwiseIsEqual(
+               RHS.getComplexFloatReal()) &&
+           LHS.getComplexFloatImag().bitwiseIsEqual(RHS.getComplexFloatImag());
+  default:
+    llvm_unreachable("value cannot be memoized");
+  }
+}
+
+unsigned ConstexprCallMemo::getHash(const FunctionDecl *FD, unsigned Context,
+                                    ArrayRef<APValue> Args) {
+  llvm::hash_code Hash = llvm::hash_combine(FD, Context);
+  for (const APValue &Arg : Args)
+    Hash = llvm::hash_combine(Hash, hashValue(Arg));
+  unsigned Result = Hash;
+  // Keep clear of the empty and tombstone keys of the DenseMap.
+  return Result >= ~0U - 1 ? 0 : Result;
+}
+
+const ConstexprCallMemo::Entry *
+ConstexprCallMemo::lookup(const FunctionDecl *FD, unsigned Context,
+                          ArrayRef<APValue> Args) {
+  ++NumLookups;
+  auto It = Buckets.find(getHash(FD, Context, Args));
+  if (It == Buckets.end())
+    return nullptr;
+  for (const StoredEntry &E : It->second) {
+    if (E.FD != FD || E.Context != Context || E.Args.size() != Args.size() ||
+        !std::equal(Args.begin(), Args.end(), E.Args.begin(), isSameValue))
+      continue;
+    ++NumHits;
+    return &E.Value;
+  }
+  return nullptr;
+}
+
+void ConstexprCallMemo::insert(const FunctionDecl *FD, unsigned Context,
+                               ArrayRef<APValue> Args, Entry E) {
+  if (NumEntries == MaxEntries) {
+    Buckets.clear();
+    NumEntries = 0;
+    ++NumFlushes;
+  }
+  Buckets[getHash(FD, Context, Args)].push_back(
+      {FD, Context, SmallVector<APValue, 2>(Args.begin(), Args.end()),
+       std::move(E)});
+  ++NumEntries;
+}
+
+void ConstexprCallMemo::PrintStats() const {
+  llvm::errs() << "*** Constexpr Call Memo Stats:\n";
+  llvm::errs() << "  " << NumLookups << " lookups, " << NumHits << " hits";
+  if (NumLookups)
+    llvm::errs() << " (" << (NumHits * 100ULL / NumLookups) << "%)";
+  llvm::errs() << "\n";
+  llvm::errs() << "  " << NumEntries << " calls memoized, table flushed "
+               << NumFlushes << " times\n";
+}
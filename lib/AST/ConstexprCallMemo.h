@@ -0,0 +1,89 @@
+//===--- ConstexprCallMemo.h - Memoized constexpr call results --*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file defines the table in which the constant expression evaluator
+//  remembers the results of constexpr function calls.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LIB_AST_CONSTEXPRCALLMEMO_H
+#define LLVM_CLANG_LIB_AST_CONSTEXPRCALLMEMO_H
+
+#include "clang/AST/APValue.h"
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+
+namespace clang {
+
+class FunctionDecl;
+
+/// A bounded table of the results of constexpr function calls, keyed by the
+/// callee and the values of its arguments.
+///
+/// Only calls whose arguments and result are plain numbers are memoized;
+/// such a call cannot observe or modify any object outside itself, so it
+/// always produces the same result. It is up to the evaluator to only record
+/// calls that completed without diagnostics or side effects.
+class ConstexprCallMemo {
+public:
+  /// A memoized call.
+  struct Entry {
+    APValue Result;
+
+    /// The number of evaluation steps the call took.
+    unsigned Steps;
+
+    /// The number of nested calls the call made, at its deepest point.
+    unsigned Depth;
+  };
+
+  /// Whether a value can be an argument or result of a memoized call.
+  static bool isMemoizableValue(const APValue &V);
+
+  /// Find the entry for a call to \p FD with the arguments \p Args, made from
+  /// an evaluation context described by \p Context. Returns null if the call
+  /// has not been memoized.
+  const Entry *lookup(const FunctionDecl *FD, unsigned Context,
+                      ArrayRef<APValue> Args);
+
+  /// Memoize a call. If the table is full, it is emptied first.
+  void insert(const FunctionDecl *FD, unsigned Context, ArrayRef<APValue> Args,
+              Entry E);
+
+  void PrintStats() const;
+
+private:
+  struct StoredEntry {
+    const FunctionDecl *FD;
+    unsigned Context;
+    SmallVector<APValue, 2> Args;
+    Entry Value;
+  };
+
+  /// The maximum number of memoized calls.
+  static const unsigned MaxEntries = 1 << 14;
+
+  static unsigned getHash(const FunctionDecl *FD, unsigned Context,
+                          ArrayRef<APValue> Args);
+
+  /// The memoized calls, grouped by the hash of their callee, context and
+  /// arguments.
+  llvm::DenseMap<unsigned, SmallVector<StoredEntry, 1>> Buckets;
+  unsigned NumEntries = 0;
+
+  unsigned NumLookups = 0;
+  unsigned NumHits = 0;
+  unsigned NumFlushes = 0;
+};
+
+} // end namespace clang
+
+#endif // LLVM_CLANG_LIB_AST_CONSTEXPRCALLMEMO_H
@@ -0,0 +1,964 @@
+//===--- ConstexprInterpreter.cpp - Bytecode constexpr evaluator ----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements a bytecode interpreter for integer constexpr functions.
+//
+// A function is compiled the first time it is called. The bytecode works on
+// an operand stack of APSInts; local variables, including parameters, live in
+// numbered slots of the current frame. Calls push a new frame rather than
+// recursing, so deep constexpr recursion does not use the native stack.
+//
+// The semantics of every operation mirror those of the tree walker in
+// ExprConstant.cpp. Whenever the tree walker would produce a diagnostic, the
+// interpreter gives up instead and leaves the diagnostic to it.
+//
+//===----------------------------------------------------------------------===//
+
+#include "ConstexprInterpreter.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Decl.h"
+#include "clang/AST/DeclCXX.h"
+#include "clang/AST/Expr.h"
+#include "clang/AST/ExprCXX.h"
+#include "clang/AST/Stmt.h"
+#include "llvm/ADT/SmallVector.h"
+#include <vector>
+
+using namespace clang;
+using llvm::APInt;
+using llvm::APSInt;
+
+namespace {
+
+enum Opcode : unsigned char {
+  OP_Fail,   // Give up.
+  OP_Step,   // Count one evaluation step.
+  OP_Const,  // Push constant Arg.
+  OP_Get,    // Push the value of local Arg.
+  OP_Set,    // Pop a value into local Arg.
+  OP_Dup,    // Push a copy of the top of the stack.
+  OP_Pop,    // Discard the top of the stack.
+
+  // Binary operations. These pop the right operand and replace the left
+  // operand with the result.
+  OP_Add,
+  OP_Sub,
+  OP_Mul,
+  OP_Div,
+  OP_Rem,
+  OP_Shl,
+  OP_Shr,
+  OP_And,
+  OP_Or,
+  OP_Xor,
+
+  // Comparisons. These are like binary operations, and produce a value of
+  // type Arg.
+  OP_LT,
+  OP_GT,
+  OP_LE,
+  OP_GE,
+  OP_EQ,
+  OP_NE,
+
+  // Unary operations on the top of the stack.
+  OP_Neg,
+  OP_BitNot,
+  OP_LNot,   // Produces a value of type Arg.
+  OP_Inc,    // Arg is nonzero if signed overflow is undefined.
+  OP_Dec,    // Arg is nonzero if signed overflow is undefined.
+  OP_Cast,   // Convert to type Arg.
+
+  OP_Jmp,    // Jump to Arg.
+  OP_Jf,     // Pop a value, and jump to Arg if it is zero.
+  OP_Jt,     // Pop a value, and jump to Arg if it is nonzero.
+  OP_Call,   // Call callee Arg, popping its arguments.
+  OP_Ret     // Return the top of the stack to the caller.
+};
+
+struct Instr {
+  Opcode Op;
+  unsigned Arg;
+};
+
+/// An integer type that bytecode converts values to.
+struct IntType {
+  unsigned Width;
+  bool IsUnsigned;
+  bool IsBool;
+};
+
+} // end anonymous namespace
+
+struct ConstexprInterpreter::Function {
+  unsigned NumParams = 0;
+  unsigned NumLocals = 0;
+  std::vector<Instr> Code;
+  std::vector<APSInt> Constants;
+  std::vector<IntType> Types;
+  std::vector<const FunctionDecl *> Callees;
+};
+
+static bool isSupportedType(QualType T) {
+  if (T.isVolatileQualified())
+    return false;
+  if (const auto *ET = T->getAs<EnumType>())
+    return ET->getDecl()->isComplete();
+  return T->isIntegralOrEnumerationType();
+}
+
+static APSInt makeInt(const IntType &T, uint64_t Value) {
+  return APSInt(APInt(T.Width, Value), T.IsUnsigned);
+}
+
+namespace {
+
+/// Compiles the body of one function to bytecode.
+class FunctionCompiler {
+  ASTContext &Ctx;
+  ConstexprInterpreter::Function &F;
+  llvm::DenseMap<const VarDecl *, unsigned> Locals;
+
+  /// The jumps to patch when the innermost enclosing loop is complete.
+  struct Loop {
+    SmallVector<unsigned, 4> Breaks;
+    SmallVector<unsigned, 4> Continues;
+  };
+  SmallVector<Loop, 4> Loops;
+
+public:
+  FunctionCompiler(ASTContext &Ctx, ConstexprInterpreter::Function &F)
+      : Ctx(Ctx), F(F) {}
+
+  bool compileFunction(const FunctionDecl *FD, const Stmt *Body);
+
+private:
+  unsigned emit(Opcode Op, unsigned Arg = 0) {
+    F.Code.push_back({Op, Arg});
+    return F.Code.size() - 1;
+  }
+
+  /// Make the jump at \p Jump go to the next instruction emitted.
+  void patch(unsigned Jump) { F.Code[Jump].Arg = F.Code.size(); }
+
+  void emitConst(const APSInt &Value) {
+    F.Constants.push_back(Value);
+    emit(OP_Const, F.Constants.size() - 1);
+  }
+
+  unsigned getTypeIndex(QualType T);
+  void emitLoop(unsigned Top, unsigned Continue);
+  bool getLocalSlot(const Expr *E, unsigned &Slot);
+
+  bool compileStmt(const Stmt *S);
+  bool compileVarDecl(const VarDecl *VD);
+  bool compileExpr(const Expr *E);
+  bool compileLoad(const Expr *E);
+  bool compileCast(const CastExpr *E);
+  bool compileUnaryOperator(const UnaryOperator *E);
+  bool compileBinaryOperator(const BinaryOperator *E);
+  bool compileCall(const CallExpr *E);
+};
+
+} // end anonymous namespace
+
+unsigned FunctionCompiler::getTypeIndex(QualType T) {
+  IntType Type = {Ctx.getIntWidth(T), T->isUnsignedIntegerOrEnumerationType(),
+                  T->isBooleanType()};
+  for (unsigned I = 0, N = F.Types.size(); I != N; ++I)
+    if (F.Types[I].Width == Type.Width &&
+        F.Types[I].IsUnsigned == Type.IsUnsigned &&
+        F.Types[I].IsBool == Type.IsBool)
+      return I;
+  F.Types.push_back(Type);
+  return F.Types.size() - 1;
+}
+
+bool FunctionCompiler::compileFunction(const FunctionDecl *FD,
+                                       const Stmt *Body) {
+  if (!isSupportedType(FD->getReturnType()))
+    return false;
+  for (const ParmVarDecl *PD : FD->parameters()) {
+    if (!isSupportedType(PD->getType()))
+      return false;
+    Locals[PD] = F.NumLocals++;
+  }
+  F.NumParams = F.NumLocals;
+
+  if (!compileStmt(Body))
+    return false;
+  // Flowing off the end of a function that returns a value is not a
+  // constant expression.
+  emit(OP_Fail);
+  return true;
+}
+
+/// Finish the innermost loop, whose first instruction is \p Top and whose
+/// continue statements jump to \p Continue.
+void FunctionCompiler::emitLoop(unsigned Top, unsigned Continue) {
+  emit(OP_Jmp, Top);
+  Loop L = Loops.pop_back_val();
+  for (unsigned Jump : L.Breaks)
+    patch(Jump);
+  for (unsigned Jump : L.Continues)
+    F.Code[Jump].Arg = Continue;
+}
+
+bool FunctionCompiler::compileStmt(const Stmt *S) {
+  // Every statement counts as one step, as in the tree walker.
+  emit(OP_Step);
+
+  switch (S->getStmtClass()) {
+  case Stmt::NullStmtClass:
+    return true;
+
+  case Stmt::CompoundStmtClass:
+    for (const Stmt *Child : cast<CompoundStmt>(S)->body())
+      if (!compileStmt(Child))
+        return false;
+    return true;
+
+  case Stmt::DeclStmtClass:
+    for (const Decl *D : cast<DeclStmt>(S)->decls()) {
+      // Declarations other than variables have no effect on evaluation.
+      if (const auto *VD = dyn_cast<VarDecl>(D))
+        if (!compileVarDecl(VD))
+          return false;
+    }
+    return true;
+
+  case Stmt::ReturnStmtClass: {
+    const Expr *RetValue = cast<ReturnStmt>(S)->getRetValue();
+    if (!RetValue || !compileExpr(RetValue))
+      return false;
+    emit(OP_Ret);
+    return true;
+  }
+
+  case Stmt::IfStmtClass: {
+    const auto *IS = cast<IfStmt>(S);
+    if (IS->getInit() || IS->getConditionVariable() ||
+        !compileExpr(IS->getCond()))
+      return false;
+    unsigned ToElse = emit(OP_Jf);
+    if (!compileStmt(IS->getThen()))
+      return false;
+    if (const Stmt *Else = IS->getElse()) {
+      unsigned ToEnd = emit(OP_Jmp);
+      patch(ToElse);
+      if (!compileStmt(Else))
+        return false;
+      patch(ToEnd);
+    } else {
+      patch(ToElse);
+    }
+    return true;
+  }
+
+  case Stmt::WhileStmtClass: {
+    const auto *WS = cast<WhileStmt>(S);
+    if (WS->getConditionVariable())
+      return false;
+    unsigned Top = F.Code.size();
+    if (!compileExpr(WS->getCond()))
+      return false;
+    unsigned ToEnd = emit(OP_Jf);
+    Loops.emplace_back();
+    if (!compileStmt(WS->getBody()))
+      return false;
+    emitLoop(Top, Top);
+    patch(ToEnd);
+    return true;
+  }
+
+  case Stmt::DoStmtClass: {
+    const auto *DS = cast<DoStmt>(S);
+    unsigned Top = F.Code.size();
+    Loops.emplace_back();
+    if (!compileStmt(DS->getBody()))
+      return false;
+    unsigned Continue = F.Code.size();
+    if (!compileExpr(DS->getCond()))
+      return false;
+    unsigned ToEnd = emit(OP_Jf);
+    emitLoop(Top, Continue);
+    patch(ToEnd);
+    return true;
+  }
+
+  case Stmt::ForStmtClass: {
+    const auto *FS = cast<ForStmt>(S);
+    if (FS->getConditionVariable())
+      return false;
+    if (FS->getInit() && !compileStmt(FS->getInit()))
+      return false;
+    unsigned Top = F.Code.size();
+    unsigned ToEnd = 0;
+    if (const Expr *Cond = FS->getCond()) {
+      if (!compileExpr(Cond))
+        return false;
+      ToEnd = emit(OP_Jf);
+    }
+    Loops.emplace_back();
+    if (!compileStmt(FS->getBody()))
+      return false;
+    unsigned Continue = F.Code.size();
+    if (const Expr *Inc = FS->getInc()) {
+      if (!compileExpr(Inc))
+        return false;
+      emit(OP_Pop);
+    }
+    emitLoop(Top, Continue);
+    if (FS->getCond())
+      patch(ToEnd);
+    return true;
+  }
+
+  case Stmt::BreakStmtClass:
+    if (Loops.empty())
+      return false;
+    Loops.back().Breaks.push_back(emit(OP_Jmp));
+    return true;
+
+  case Stmt::ContinueStmtClass:
+    if (Loops.empty())
+      return false;
+    Loops.back().Continues.push_back(emit(OP_Jmp));
+    return true;
+
+  default:
+    if (const auto *E = dyn_cast<Expr>(S)) {
+      if (!compileExpr(E))
+        return false;
+      emit(OP_Pop);
+      return true;
+    }
+    return false;
+  }
+}
+
+bool FunctionCompiler::compileVarDecl(const VarDecl *VD) {
+  if (!VD->hasLocalStorage() || !isSupportedType(VD->getType()))
+    return false;
+
+  const Expr *Init = VD->getInit();
+  if (!Init)
+    return false;
+  if (const auto *ILE = dyn_cast<InitListExpr>(Init)) {
+    if (ILE->getNumInits() > 1)
+      return false;
+    if (ILE->getNumInits() == 0) {
+      emitConst(makeInt(F.Types[getTypeIndex(VD->getType())], 0));
+      Init = nullptr;
+    } else {
+      Init = ILE->getInit(0);
+    }
+  }
+  if (Init && !compileExpr(Init))
+    return false;
+
+  unsigned Slot = F.NumLocals++;
+  Locals[VD] = Slot;
+  emit(OP_Set, Slot);
+  return true;
+}
+
+/// Find the slot of the local variable that the lvalue \p E names.
+bool FunctionCompiler::getLocalSlot(const Expr *E, unsigned &Slot) {
+  const auto *DRE = dyn_cast<DeclRefExpr>(E->IgnoreParens());
+  if (!DRE || DRE->refersToEnclosingVariableOrCapture())
+    return false;
+  const auto *VD = dyn_cast<VarDecl>(DRE->getDecl());
+  if (!VD)
+    return false;
+  auto It = Locals.find(VD);
+  if (It == Locals.end())
+    return false;
+  Slot = It->second;
+  return true;
+}
+
+/// Compile the lvalue-to-rvalue conversion of the lvalue \p E.
+bool FunctionCompiler::compileLoad(const Expr *E) {
+  E = E->IgnoreParens();
+  if (!isSupportedType(E->getType()))
+    return false;
+
+  unsigned Slot;
+  if (getLocalSlot(E, Slot)) {
+    emit(OP_Get, Slot);
+    return true;
+  }
+
+  // Assignments and pre-increments produce the value they store.
+  if (isa<BinaryOperator>(E) || isa<UnaryOperator>(E))
+    return compileExpr(E);
+
+  // Constants that are usable in constant expressions are folded.
+  const auto *DRE = dyn_cast<DeclRefExpr>(E);
+  if (!DRE)
+    return false;
+  const auto *VD = dyn_cast<VarDecl>(DRE->getDecl());
+  if (!VD || VD->hasLocalStorage() || VD->isWeak() ||
+      !(VD->isConstexpr() || VD->getType().isConstQualified()))
+    return false;
+  const VarDecl *InitVD;
+  const Expr *Init = VD->getAnyInitializer(InitVD);
+  if (!Init || Init->isValueDependent() || InitVD->isWeak())
+    return false;
+  const APValue *Value = InitVD->evaluateValue();
+  if (!Value || !Value->isInt() || !InitVD->checkInitIsICE())
+    return false;
+  emitConst(Value->getInt());
+  return true;
+}
+
+/// Compile the evaluation of \p E to an integer.
+///
+/// Apart from prvalues, this accepts the lvalues produced by assignments and
+/// pre-increments, whose value is the value they store.
+bool FunctionCompiler::compileExpr(const Expr *E) {
+  if (!isSupportedType(E->getType()))
+    return false;
+
+  switch (E->getStmtClass()) {
+  case Stmt::ParenExprClass:
+    return compileExpr(cast<ParenExpr>(E)->getSubExpr());
+
+  case Stmt::IntegerLiteralClass:
+    emitConst(APSInt(cast<IntegerLiteral>(E)->getValue(),
+                     E->getType()->isUnsignedIntegerOrEnumerationType()));
+    return true;
+
+  case Stmt::CharacterLiteralClass:
+    emitConst(Ctx.MakeIntValue(cast<CharacterLiteral>(E)->getValue(),
+                               E->getType()));
+    return true;
+
+  case Stmt::CXXBoolLiteralExprClass:
+    emitConst(Ctx.MakeIntValue(cast<CXXBoolLiteralExpr>(E)->getValue(),
+                               E->getType()));
+    return true;
+
+  case Stmt::DeclRefExprClass: {
+    const auto *ECD =
+        dyn_cast<EnumConstantDecl>(cast<DeclRefExpr>(E)->getDecl());
+    if (!ECD)
+      return false;
+    // The enumerator's value may differ in width or signedness from the
+    // type of the expression.
+    const IntType &T = F.Types[getTypeIndex(E->getType())];
+    APSInt Value = ECD->getInitVal().extOrTrunc(T.Width);
+    Value.setIsUnsigned(T.IsUnsigned);
+    emitConst(Value);
+    return true;
+  }
+
+  case Stmt::SubstNonTypeTemplateParmExprClass:
+    return compileExpr(
+        cast<SubstNonTypeTemplateParmExpr>(E)->getReplacement());
+
+  case Stmt::CXXDefaultArgExprClass:
+    return compileExpr(cast<CXXDefaultArgExpr>(E)->getExpr());
+
+  case Stmt::ExprWithCleanupsClass:
+    return compileExpr(cast<ExprWithCleanups>(E)->getSubExpr());
+
+  case Stmt::ImplicitCastExprClass:
+  case Stmt::CStyleCastExprClass:
+  case Stmt::CXXStaticCastExprClass:
+  case Stmt::CXXFunctionalCastExprClass:
+    return compileCast(cast<CastExpr>(E));
+
+  case Stmt::UnaryOperatorClass:
+    return compileUnaryOperator(cast<UnaryOperator>(E));
+
+  case Stmt::BinaryOperatorClass:
+  case Stmt::CompoundAssignOperatorClass:
+    return compileBinaryOperator(cast<BinaryOperator>(E));
+
+  case Stmt::ConditionalOperatorClass: {
+    const auto *CO = cast<ConditionalOperator>(E);
+    if (!CO->isRValue() || !compileExpr(CO->getCond()))
+      return false;
+    unsigned ToFalse = emit(OP_Jf);
+    if (!compileExpr(CO->getTrueExpr()))
+      return false;
+    unsigned ToEnd = emit(OP_Jmp);
+    patch(ToFalse);
+    if (!compileExpr(CO->getFalseExpr()))
+      return false;
+    patch(ToEnd);
+    return true;
+  }
+
+  case Stmt::CallExprClass:
+    return compileCall(cast<CallExpr>(E));
+
+  default: {
+    // Anything else that is an integral constant expression, such as a
+    // sizeof, is folded.
+    llvm::APSInt Value;
+    if (!E->isRValue() || E->isValueDependent() ||
+        !E->isIntegerConstantExpr(Value, Ctx))
+      return false;
+    emitConst(Value);
+    return true;
+  }
+  }
+}
+
+bool FunctionCompiler::compileCast(const CastExpr *E) {
+  const Expr *SubExpr = E->getSubExpr();
+  switch (E->getCastKind()) {
+  case CK_LValueToRValue:
+    return compileLoad(SubExpr);
+
+  case CK_NoOp:
+    return SubExpr->isRValue() && compileExpr(SubExpr);
+
+  case CK_IntegralCast:
+  case CK_IntegralToBoolean:
+    if (!compileExpr(SubExpr))
+      return false;
+    emit(OP_Cast, getTypeIndex(E->getType()));
+    return true;
+
+  default:
+    return false;
+  }
+}
+
+bool FunctionCompiler::compileUnaryOperator(const UnaryOperator *E) {
+  switch (E->getOpcode()) {
+  case UO_Plus:
+    return compileExpr(E->getSubExpr());
+
+  case UO_Minus:
+  case UO_Not:
+    if (!compileExpr(E->getSubExpr()))
+      return false;
+    emit(E->getOpcode() == UO_Minus ? OP_Neg : OP_BitNot);
+    return true;
+
+  case UO_LNot:
+    if (!compileExpr(E->getSubExpr()))
+      return false;
+    emit(OP_LNot, getTypeIndex(E->getType()));
+    return true;
+
+  case UO_PreInc:
+  case UO_PreDec:
+  case UO_PostInc:
+  case UO_PostDec: {
+    unsigned Slot;
+    if (E->getSubExpr()->getType()->isBooleanType() ||
+        !getLocalSlot(E->getSubExpr(), Slot))
+      return false;
+    Opcode Op = E->isIncrementOp() ? OP_Inc : OP_Dec;
+    emit(OP_Get, Slot);
+    if (E->isPostfix())
+      emit(OP_Dup);
+    emit(Op, E->canOverflow());
+    if (E->isPrefix())
+      emit(OP_Dup);
+    emit(OP_Set, Slot);
+    return true;
+  }
+
+  default:
+    return false;
+  }
+}
+
+static Opcode getBinaryOpcode(BinaryOperatorKind Op) {
+  switch (Op) {
+  case BO_Mul: return OP_Mul;
+  case BO_Div: return OP_Div;
+  case BO_Rem: return OP_Rem;
+  case BO_Add: return OP_Add;
+  case BO_Sub: return OP_Sub;
+  case BO_Shl: return OP_Shl;
+  case BO_Shr: return OP_Shr;
+  case BO_LT: return OP_LT;
+  case BO_GT: return OP_GT;
+  case BO_LE: return OP_LE;
+  case BO_GE: return OP_GE;
+  case BO_EQ: return OP_EQ;
+  case BO_NE: return OP_NE;
+  case BO_And: return OP_And;
+  case BO_Xor: return OP_Xor;
+  case BO_Or: return OP_Or;
+  default: return OP_Fail;
+  }
+}
+
+bool FunctionCompiler::compileBinaryOperator(const BinaryOperator *E) {
+  BinaryOperatorKind Op = E->getOpcode();
+  const Expr *LHS = E->getLHS();
+  const Expr *RHS = E->getRHS();
+
+  if (Op == BO_Comma) {
+    if (!compileExpr(LHS))
+      return false;
+    emit(OP_Pop);
+    return compileExpr(RHS);
+  }
+
+  if (Op == BO_LAnd || Op == BO_LOr) {
+    // The result is the value of the operand that decides it, or of the
+    // other operand.
+    Opcode Jump = Op == BO_LAnd ? OP_Jf : OP_Jt;
+    if (!compileExpr(LHS))
+      return false;
+    unsigned ShortCircuit = emit(Jump);
+    if (!compileExpr(RHS))
+      return false;
+    unsigned ShortCircuitRHS = emit(Jump);
+    const IntType &T = F.Types[getTypeIndex(E->getType())];
+    emitConst(makeInt(T, Op == BO_LAnd));
+    unsigned ToEnd = emit(OP_Jmp);
+    patch(ShortCircuit);
+    patch(ShortCircuitRHS);
+    emitConst(makeInt(T, Op == BO_LOr));
+    patch(ToEnd);
+    return true;
+  }
+
+  if (Op == BO_Assign) {
+    unsigned Slot;
+    if (!getLocalSlot(LHS, Slot) || !compileExpr(RHS))
+      return false;
+    emit(OP_Dup);
+    emit(OP_Set, Slot);
+    return true;
+  }
+
+  if (const auto *CAO = dyn_cast<CompoundAssignOperator>(E)) {
+    unsigned Slot;
+    Opcode BinOp = getBinaryOpcode(BinaryOperator::getOpForCompoundAssignment(Op));
+    if (BinOp == OP_Fail || !getLocalSlot(LHS, Slot) ||
+        LHS->getType()->isBooleanType() ||
+        !isSupportedType(CAO->getComputationLHSType()) ||
+        !isSupportedType(CAO->getComputationResultType()))
+      return false;
+    emit(OP_Get, Slot);
+    emit(OP_Cast, getTypeIndex(CAO->getComputationLHSType()));
+    if (!compileExpr(RHS))
+      return false;
+    emit(BinOp);
+    emit(OP_Cast, getTypeIndex(LHS->getType()));
+    emit(OP_Dup);
+    emit(OP_Set, Slot);
+    return true;
+  }
+
+  Opcode BinOp = getBinaryOpcode(Op);
+  if (BinOp == OP_Fail || !compileExpr(LHS) || !compileExpr(RHS))
+    return false;
+  if (E->isComparisonOp())
+    emit(BinOp, getTypeIndex(E->getType()));
+  else
+    emit(BinOp);
+  return true;
+}
+
+bool FunctionCompiler::compileCall(const CallExpr *E) {
+  // Only direct calls to free functions and static member functions are
+  // supported.
+  const FunctionDecl *FD = E->getDirectCallee();
+  if (!FD || !isa<DeclRefExpr>(E->getCallee()->IgnoreParenImpCasts()) ||
+      FD->getBuiltinID() || FD->isVariadic() ||
+      E->getNumArgs() != FD->getNumParams())
+    return false;
+  if (const auto *MD = dyn_cast<CXXMethodDecl>(FD))
+    if (!MD->isStatic())
+      return false;
+
+  for (const Expr *Arg : E->arguments())
+    if (!compileExpr(Arg))
+      return false;
+
+  F.Callees.push_back(FD);
+  emit(OP_Call, F.Callees.size() - 1);
+  return true;
+}
+
+ConstexprInterpreter::ConstexprInterpreter(ASTContext &Ctx) : Ctx(Ctx) {}
+
+ConstexprInterpreter::~ConstexprInterpreter() = default;
+
+const ConstexprInterpreter::Function *
+ConstexprInterpreter::getFunction(const FunctionDecl *FD) {
+  const FunctionDecl *Definition = nullptr;
+  const Stmt *Body = FD->getBody(Definition);
+  if (!Body || !Definition->isConstexpr() || Definition->isInvalidDecl() ||
+      Definition->isDependentContext())
+    return nullptr;
+  if (const auto *MD = dyn_cast<CXXMethodDecl>(Definition))
+    if (!MD->isStatic())
+      return nullptr;
+
+  auto It = Functions.find(Definition);
+  if (It != Functions.end())
+    return It->second.get();
+
+  // Compiling may evaluate constant expressions, which can in turn call back
+  // into the interpreter. Map the function to null until it is compiled so
+  // that such calls fall back to the tree walker.
+  Functions[Definition] = nullptr;
+  auto F = llvm::make_unique<Function>();
+  if (!FunctionCompiler(Ctx, *F).compileFunction(Definition, Body))
+    return nullptr;
+  return (Functions[Definition] = std::move(F)).get();
+}
+
+/// Apply the binary operation \p Op to \p LHS and \p RHS, storing the result
+/// in \p LHS. Returns false if the tree walker would diagnose the operation.
+static bool applyBinaryOp(Opcode Op, APSInt &LHS, const APSInt &RHS) {
+  switch (Op) {
+  case OP_Add:
+  case OP_Sub:
+  case OP_Mul: {
+    if (LHS.isUnsigned()) {
+      LHS = Op == OP_Add ? LHS + RHS : Op == OP_Sub ? LHS - RHS : LHS * RHS;
+      return true;
+    }
+    bool Overflow = false;
+    APInt Value = Op == OP_Add ? LHS.sadd_ov(RHS, Overflow)
+                : Op == OP_Sub ? LHS.ssub_ov(RHS, Overflow)
+                               : LHS.smul_ov(RHS, Overflow);
+    if (Overflow)
+      return false;
+    LHS = APSInt(Value, /*isUnsigned=*/false);
+    return true;
+  }
+
+  case OP_Div:
+  case OP_Rem:
+    if (!RHS.getBoolValue() ||
+        (LHS.isSigned() && LHS.isMinSignedValue() && RHS.isAllOnesValue()))
+      return false;
+    LHS = Op == OP_Div ? LHS / RHS : LHS % RHS;
+    return true;
+
+  case OP_Shl:
+  case OP_Shr: {
+    // C++11 [expr.shift]p1: the shift width must be non-negative and less
+    // than the bit width of the shifted type.
+    if ((RHS.isSigned() && RHS.isNegative()) || RHS.uge(LHS.getBitWidth()))
+      return false;
+    unsigned Amount = RHS.getZExtValue();
+    if (Op == OP_Shr) {
+      LHS = LHS >> Amount;
+      return true;
+    }
+    // C++11 [expr.shift]p2: a signed left shift must have a non-negative
+    // operand, and must not overflow the corresponding unsigned type.
+    if (LHS.isSigned() &&
+        (LHS.isNegative() || LHS.countLeadingZeros() < Amount))
+      return false;
+    LHS = LHS << Amount;
+    return true;
+  }
+
+  case OP_And: LHS = LHS & RHS; return true;
+  case OP_Or:  LHS = LHS | RHS; return true;
+  case OP_Xor: LHS = LHS ^ RHS; return true;
+
+  default:
+    llvm_unreachable("not a binary operation");
+  }
+}
+
+static bool applyComparison(Opcode Op, const APSInt &LHS, const APSInt &RHS) {
+  switch (Op) {
+  case OP_LT: return LHS < RHS;
+  case OP_GT: return LHS > RHS;
+  case OP_LE: return LHS <= RHS;
+  case OP_GE: return LHS >= RHS;
+  case OP_EQ: return LHS == RHS;
+  case OP_NE: return LHS != RHS;
+  default:
+    llvm_unreachable("not a comparison");
+  }
+}
+
+bool ConstexprInterpreter::evaluateCall(const FunctionDecl *FD,
+                                        ArrayRef<APSInt> Args,
+                                        unsigned MaxCallDepth,
+                                        unsigned &StepsLeft,
+                                        unsigned &NestedDepth,
+                                        APSInt &Result) {
+  const Function *Entry = getFunction(FD);
+  if (!Entry || Args.size() != Entry->NumParams || !MaxCallDepth)
+    return false;
+
+  struct Frame {
+    const Function *F;
+    unsigned PC;
+    unsigned Base;
+  };
+  SmallVector<Frame, 16> Frames;
+  SmallVector<APSInt, 64> Locals(Args.begin(), Args.end());
+  SmallVector<APSInt, 16> Stack;
+  unsigned Steps = StepsLeft;
+  unsigned MaxFrames = 1;
+
+  Locals.resize(Entry->NumLocals);
+  Frames.push_back({Entry, 0, 0});
+
+  while (true) {
+    Frame &Current = Frames.back();
+    const Function &F = *Current.F;
+    const Instr &I = F.Code[Current.PC++];
+
+    switch (I.Op) {
+    case OP_Fail:
+      return false;
+
+    case OP_Step:
+      if (!Steps)
+        return false;
+      --Steps;
+      break;
+
+    case OP_Const:
+      Stack.push_back(F.Constants[I.Arg]);
+      break;
+
+    case OP_Get:
+      Stack.push_back(Locals[Current.Base + I.Arg]);
+      break;
+
+    case OP_Set:
+      Locals[Current.Base + I.Arg] = Stack.pop_back_val();
+      break;
+
+    case OP_Dup: {
+      APSInt Top = Stack.back();
+      Stack.push_back(std::move(Top));
+      break;
+    }
+
+    case OP_Pop:
+      Stack.pop_back();
+      break;
+
+    case OP_Add:
+    case OP_Sub:
+    case OP_Mul:
+    case OP_Div:
+    case OP_Rem:
+    case OP_Shl:
+    case OP_Shr:
+    case OP_And:
+    case OP_Or:
+    case OP_Xor: {
+      APSInt RHS = Stack.pop_back_val();
+      if (!applyBinaryOp(I.Op, Stack.back(), RHS))
+        return false;
+      break;
+    }
+
+    case OP_LT:
+    case OP_GT:
+    case OP_LE:
+    case OP_GE:
+    case OP_EQ:
+    case OP_NE: {
+      APSInt RHS = Stack.pop_back_val();
+      Stack.back() =
+          makeInt(F.Types[I.Arg], applyComparison(I.Op, Stack.back(), RHS));
+      break;
+    }
+
+    case OP_Neg: {
+      APSInt &Value = Stack.back();
+      if (Value.isSigned() && Value.isMinSignedValue())
+        return false;
+      Value = -Value;
+      break;
+    }
+
+    case OP_BitNot:
+      Stack.back() = ~Stack.back();
+      break;
+
+    case OP_LNot:
+      Stack.back() = makeInt(F.Types[I.Arg], !Stack.back().getBoolValue());
+      break;
+
+    case OP_Inc:
+    case OP_Dec: {
+      APSInt &Value = Stack.back();
+      if (I.Arg && Value.isSigned() &&
+          (I.Op == OP_Inc ? Value.isMaxSignedValue()
+                          : Value.isMinSignedValue()))
+        return false;
+      if (I.Op == OP_Inc)
+        ++Value;
+      else
+        --Value;
+      break;
+    }
+
+    case OP_Cast: {
+      // This follows HandleIntToIntCast in ExprConstant.cpp.
+      const IntType &T = F.Types[I.Arg];
+      APSInt &Value = Stack.back();
+      if (T.IsBool) {
+        Value = makeInt(T, Value.getBoolValue());
+      } else {
+        Value = Value.extOrTrunc(T.Width);
+        Value.setIsUnsigned(T.IsUnsigned);
+      }
+      break;
+    }
+
+    case OP_Jmp:
+      Current.PC = I.Arg;
+      break;
+
+    case OP_Jf:
+    case OP_Jt:
+      if (Stack.pop_back_val().getBoolValue() == (I.Op == OP_Jt))
+        Current.PC = I.Arg;
+      break;
+
+    case OP_Call: {
+      const Function *Callee = getFunction(F.Callees[I.Arg]);
+      if (!Callee || Frames.size() >= MaxCallDepth)
+        return false;
+      // Move the arguments from the stack into the callee's parameters.
+      unsigned Base = Locals.size();
+      auto ArgsBegin = Stack.end() - Callee->NumParams;
+      Locals.append(std::make_move_iterator(ArgsBegin),
+                    std::make_move_iterator(Stack.end()));
+      Stack.erase(ArgsBegin, Stack.end());
+      Locals.resize(Base + Callee->NumLocals);
+      Frames.push_back({Callee, 0, Base});
+      MaxFrames = std::max<unsigned>(MaxFrames, Frames.size());
+      break;
+    }
+
+    case OP_Ret:
+      // The return value is left on the stack for the caller.
+      Locals.resize(Current.Base);
+      Frames.pop_back();
+      if (Frames.empty()) {
+        Result = Stack.pop_back_val();
+        StepsLeft = Steps;
+        NestedDepth = MaxFrames - 1;
+        return true;
+      }
+      break;
+    }
+  }
+}
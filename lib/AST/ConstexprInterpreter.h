@@ -0,0 +1,77 @@
+//===--- ConstexprInterpreter.h - Bytecode constexpr evaluator --*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file defines a bytecode interpreter for calls to constexpr functions
+//  that only compute with integers. The constant expression evaluator uses it
+//  when -fexperimental-new-constant-interpreter is enabled.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LIB_AST_CONSTEXPRINTERPRETER_H
+#define LLVM_CLANG_LIB_AST_CONSTEXPRINTERPRETER_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/APSInt.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include <memory>
+
+namespace clang {
+
+class ASTContext;
+class FunctionDecl;
+
+/// Evaluates calls to constexpr functions by compiling them to bytecode for a
+/// small stack machine.
+///
+/// Only functions whose parameters, local variables and result are of
+/// integral or enumeration type are supported, and only a subset of the
+/// statements and expressions that may appear in them. The interpreter never
+/// produces diagnostics: on any construct it does not support, and on any
+/// operation that the tree-walking evaluator would diagnose (such as signed
+/// overflow or an out-of-range shift), it gives up, and the call should be
+/// evaluated by the tree walker instead.
+class ConstexprInterpreter {
+public:
+  struct Function;
+
+  explicit ConstexprInterpreter(ASTContext &Ctx);
+  ~ConstexprInterpreter();
+
+  /// Evaluate a call to the definition \p FD with the arguments \p Args.
+  ///
+  /// \param MaxCallDepth the number of calls, including this one, that may
+  /// be active at the same time.
+  ///
+  /// \param StepsLeft the number of statements that may be evaluated. It is
+  /// only updated if the call is evaluated.
+  ///
+  /// \param NestedDepth set to the number of nested calls that were active
+  /// at the deepest point of the evaluation.
+  ///
+  /// \returns true, and sets \p Result, if the call was evaluated.
+  bool evaluateCall(const FunctionDecl *FD, ArrayRef<llvm::APSInt> Args,
+                    unsigned MaxCallDepth, unsigned &StepsLeft,
+                    unsigned &NestedDepth, llvm::APSInt &Result);
+
+private:
+  /// Get the compiled form of the function \p FD, compiling it first if
+  /// necessary. Returns null if \p FD cannot be compiled.
+  const Function *getFunction(const FunctionDecl *FD);
+
+  ASTContext &Ctx;
+
+  /// The compiled functions, keyed by their definition. Functions that
+  /// cannot be compiled are mapped to null.
+  llvm::DenseMap<const FunctionDecl *, std::unique_ptr<Function>> Functions;
+};
+
+} // end namespace clang
+
+#endif // LLVM_CLANG_LIB_AST_CONSTEXPRINTERPRETER_H
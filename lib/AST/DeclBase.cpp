@@ -12,6 +12,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/AST/DeclBase.h"
+#include "ASTMemoryAttribution.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/ASTMutationListener.h"
 #include "clang/AST/Attr.h"
@@ -87,6 +88,8 @@ void *Decl::operator new(std::size_t Size, const ASTContext &Context,
   // Store the global declaration ID in the second 4 bytes.
   PrefixPtr[1] = ID;
 
+  if (ASTMemoryAttribution *MA = Context.getMemoryAttribution())
+    MA->noteDecl((Decl *)Result);
   return Result;
 }
 
@@ -106,9 +109,15 @@ void *Decl::operator new(std::size_t Size, const ASTContext &Ctx,
     Buffer += ExtraAlign;
     auto *ParentModule =
         Parent ? cast<Decl>(Parent)->getOwningModule() : nullptr;
-    return new (Buffer) Module*(ParentModule) + 1;
-  }
-  return ::operator new(Size + Extra, Ctx);
+    void *Result = new (Buffer) Module*(ParentModule) + 1;
+    if (ASTMemoryAttribution *MA = Ctx.getMemoryAttribution())
+      MA->noteDecl((Decl *)Result);
+    return Result;
+  }
+  void *Result = ::operator new(Size + Extra, Ctx);
+  if (ASTMemoryAttribution *MA = Ctx.getMemoryAttribution())
+    MA->noteDecl((Decl *)Result);
+  return Result;
 }
 
 Module *Decl::getOwningModuleSlow() const {
@@ -1546,6 +1555,23 @@ StoredDeclsMap *DeclContext::buildLookup() {
       return LookupPtr;
   }
 
+  // When the table is built from scratch, size it for all of the
+  // declarations up front: a namespace such as 'std', which gets reopened by
+  // many headers, can have thousands of names, and growing the table one
+  // rehash at a time moves every entry again each time.
+  if (!LookupPtr || LookupPtr->empty()) {
+    unsigned NumDecls = 0;
+    for (auto *DC : Contexts)
+      for (auto *D : DC->noload_decls())
+        if (isa<NamedDecl>(D) && !D->isFromASTFile())
+          ++NumDecls;
+    if (NumDecls > 4) {
+      if (!LookupPtr)
+        CreateStoredDeclsMap(getParentASTContext());
+      LookupPtr->reserve(NumDecls);
+    }
+  }
+
   for (auto *DC : Contexts)
     buildLookupImpl(DC, hasExternalVisibleStorage());
 
@@ -405,6 +405,25 @@ DeclarationNameLoc::DeclarationNameLoc(DeclarationName Name) {
   }
 }
 
+bool DeclarationNameLoc::isNeededFor(DeclarationName Name) {
+  switch (Name.getNameKind()) {
+  case DeclarationName::CXXConstructorName:
+  case DeclarationName::CXXDestructorName:
+  case DeclarationName::CXXConversionFunctionName:
+  case DeclarationName::CXXOperatorName:
+  case DeclarationName::CXXLiteralOperatorName:
+    return true;
+  case DeclarationName::Identifier:
+  case DeclarationName::CXXDeductionGuideName:
+  case DeclarationName::ObjCZeroArgSelector:
+  case DeclarationName::ObjCOneArgSelector:
+  case DeclarationName::ObjCMultiArgSelector:
+  case DeclarationName::CXXUsingDirective:
+    return false;
+  }
+  llvm_unreachable("unknown name kind");
+}
+
 bool DeclarationNameInfo::containsUnexpandedParameterPack() const {
   switch (Name.getNameKind()) {
   case DeclarationName::Identifier:
@@ -351,7 +351,7 @@ DeclRefExpr::DeclRefExpr(const ASTContext &Ctx,
                          const TemplateArgumentListInfo *TemplateArgs,
                          QualType T, ExprValueKind VK)
   : Expr(DeclRefExprClass, T, VK, OK_Ordinary, false, false, false, false),
-    D(D), DNLoc(NameInfo.getInfo()) {
+    D(D) {
   DeclRefExprBits.Loc = NameInfo.getLoc();
   DeclRefExprBits.HasQualifier = QualifierLoc ? 1 : 0;
   if (QualifierLoc) {
@@ -366,6 +366,11 @@ DeclRefExpr::DeclRefExpr(const ASTContext &Ctx,
   DeclRefExprBits.HasFoundDecl = FoundD ? 1 : 0;
   if (FoundD)
     *getTrailingObjects<NamedDecl *>() = FoundD;
+  DeclRefExprBits.HasNameLoc =
+      DeclarationNameLoc::isNeededFor(NameInfo.getName());
+  if (hasNameLoc())
+    new (getTrailingObjects<DeclarationNameLoc>())
+        DeclarationNameLoc(NameInfo.getInfo());
   DeclRefExprBits.HasTemplateKWAndArgsInfo
     = (TemplateArgs || TemplateKWLoc.isValid()) ? 1 : 0;
   DeclRefExprBits.RefersToEnclosingVariableOrCapture =
@@ -421,9 +426,10 @@ DeclRefExpr *DeclRefExpr::Create(const ASTContext &Context,
 
   bool HasTemplateKWAndArgsInfo = TemplateArgs || TemplateKWLoc.isValid();
   std::size_t Size =
-      totalSizeToAlloc<NestedNameSpecifierLoc, NamedDecl *,
+      totalSizeToAlloc<NestedNameSpecifierLoc, NamedDecl *, DeclarationNameLoc,
                        ASTTemplateKWAndArgsInfo, TemplateArgumentLoc>(
           QualifierLoc ? 1 : 0, FoundD ? 1 : 0,
+          DeclarationNameLoc::isNeededFor(NameInfo.getName()) ? 1 : 0,
           HasTemplateKWAndArgsInfo ? 1 : 0,
           TemplateArgs ? TemplateArgs->size() : 0);
 
@@ -436,14 +442,15 @@ DeclRefExpr *DeclRefExpr::Create(const ASTContext &Context,
 DeclRefExpr *DeclRefExpr::CreateEmpty(const ASTContext &Context,
                                       bool HasQualifier,
                                       bool HasFoundDecl,
+                                      bool HasNameLoc,
                                       bool HasTemplateKWAndArgsInfo,
                                       unsigned NumTemplateArgs) {
   assert(NumTemplateArgs == 0 || HasTemplateKWAndArgsInfo);
   std::size_t Size =
-      totalSizeToAlloc<NestedNameSpecifierLoc, NamedDecl *,
+      totalSizeToAlloc<NestedNameSpecifierLoc, NamedDecl *, DeclarationNameLoc,
                        ASTTemplateKWAndArgsInfo, TemplateArgumentLoc>(
-          HasQualifier ? 1 : 0, HasFoundDecl ? 1 : 0, HasTemplateKWAndArgsInfo,
-          NumTemplateArgs);
+          HasQualifier ? 1 : 0, HasFoundDecl ? 1 : 0, HasNameLoc ? 1 : 0,
+          HasTemplateKWAndArgsInfo, NumTemplateArgs);
   void *Mem = Context.Allocate(Size, alignof(DeclRefExpr));
   return new (Mem) DeclRefExpr(EmptyShell());
 }
@@ -1508,12 +1515,13 @@ MemberExpr *MemberExpr::Create(
                          founddecl.getDecl() != memberdecl ||
                          founddecl.getAccess() != memberdecl->getAccess());
 
+  bool HasNameLoc = DeclarationNameLoc::isNeededFor(nameinfo.getName());
   bool HasTemplateKWAndArgsInfo = targs || TemplateKWLoc.isValid();
   std::size_t Size =
-      totalSizeToAlloc<MemberExprNameQualifier, ASTTemplateKWAndArgsInfo,
-                       TemplateArgumentLoc>(hasQualOrFound ? 1 : 0,
-                                            HasTemplateKWAndArgsInfo ? 1 : 0,
-                                            targs ? targs->size() : 0);
+      totalSizeToAlloc<MemberExprNameQualifier, DeclarationNameLoc,
+                       ASTTemplateKWAndArgsInfo, TemplateArgumentLoc>(
+          hasQualOrFound ? 1 : 0, HasNameLoc ? 1 : 0,
+          HasTemplateKWAndArgsInfo ? 1 : 0, targs ? targs->size() : 0);
 
   void *Mem = C.Allocate(Size, alignof(MemberExpr));
   MemberExpr *E = new (Mem)
@@ -1538,6 +1546,11 @@ MemberExpr *MemberExpr::Create(
     NQ->FoundDecl = founddecl;
   }
 
+  E->MemberExprBits.HasNameLoc = HasNameLoc;
+  if (HasNameLoc)
+    new (E->getTrailingObjects<DeclarationNameLoc>())
+        DeclarationNameLoc(nameinfo.getInfo());
+
   E->MemberExprBits.HasTemplateKWAndArgsInfo =
       (targs || TemplateKWLoc.isValid());
 
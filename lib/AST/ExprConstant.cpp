@@ -33,6 +33,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "ConstexprCallMemo.h"
+#include "ConstexprInterpreter.h"
 #include "clang/AST/APValue.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/ASTDiagnostic.h"
@@ -45,6 +47,7 @@
 #include "clang/AST/TypeLoc.h"
 #include "clang/Basic/Builtins.h"
 #include "clang/Basic/TargetInfo.h"
+#include "clang/Basic/TimeTraceProfiler.h"
 #include "llvm/Support/SaveAndRestore.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cstring>
@@ -655,6 +658,10 @@ namespace {
     /// CallStackDepth - The number of calls in the call stack right now.
     unsigned CallStackDepth;
 
+    /// MaxCallStackDepth - The deepest call stack depth at which a call has
+    /// been permitted so far.
+    unsigned MaxCallStackDepth;
+
     /// NextCallIndex - The next call index to assign.
     unsigned NextCallIndex;
 
@@ -663,6 +670,10 @@ namespace {
     /// we will evaluate.
     unsigned StepsLeft;
 
+    /// NumDiagnostics - The number of fold failures and non-constant
+    /// constructs diagnosed so far, whether or not the notes are collected.
+    unsigned NumDiagnostics;
+
     /// BottomFrame - The frame in which evaluation started. This must be
     /// initialized after CurrentCall and CallStackDepth.
     CallStackFrame BottomFrame;
@@ -781,8 +792,8 @@ namespace {
 
     EvalInfo(const ASTContext &C, Expr::EvalStatus &S, EvaluationMode Mode)
       : Ctx(const_cast<ASTContext &>(C)), EvalStatus(S), CurrentCall(nullptr),
-        CallStackDepth(0), NextCallIndex(1),
-        StepsLeft(getLangOpts().ConstexprStepLimit),
+        CallStackDepth(0), MaxCallStackDepth(0), NextCallIndex(1),
+        StepsLeft(getLangOpts().ConstexprStepLimit), NumDiagnostics(0),
         BottomFrame(*this, SourceLocation(), nullptr, nullptr, nullptr),
         EvaluatingDecl((const ValueDecl *)nullptr),
         EvaluatingDeclValue(nullptr), HasActiveDiagnostic(false),
@@ -807,8 +818,10 @@ namespace {
         FFDiag(Loc, diag::note_constexpr_call_limit_exceeded);
         return false;
       }
-      if (CallStackDepth <= getLangOpts().ConstexprCallDepth)
+      if (CallStackDepth <= getLangOpts().ConstexprCallDepth) {
+        MaxCallStackDepth = std::max(MaxCallStackDepth, CallStackDepth);
         return true;
+      }
       FFDiag(Loc, diag::note_constexpr_depth_limit_exceeded)
         << getLangOpts().ConstexprCallDepth;
       return false;
@@ -898,12 +911,14 @@ namespace {
     FFDiag(SourceLocation Loc,
           diag::kind DiagId = diag::note_invalid_subexpr_in_const_expr,
           unsigned ExtraNotes = 0) {
+      ++NumDiagnostics;
       return Diag(Loc, DiagId, ExtraNotes, false);
     }
 
     OptionalDiagnostic FFDiag(const Expr *E, diag::kind DiagId
                               = diag::note_invalid_subexpr_in_const_expr,
                             unsigned ExtraNotes = 0) {
+      ++NumDiagnostics;
       if (EvalStatus.Diag)
         return Diag(E->getExprLoc(), DiagId, ExtraNotes, /*IsCCEDiag*/false);
       HasActiveDiagnostic = false;
@@ -918,6 +933,7 @@ namespace {
     OptionalDiagnostic CCEDiag(SourceLocation Loc, diag::kind DiagId
                                  = diag::note_invalid_subexpr_in_const_expr,
                                unsigned ExtraNotes = 0) {
+      ++NumDiagnostics;
       // Don't override a previous diagnostic. Don't bother collecting
       // diagnostics if we're evaluating for overflow.
       if (!EvalStatus.Diag || !EvalStatus.Diag->empty()) {
@@ -1097,6 +1113,31 @@ namespace {
     ~IgnoreSideEffectsRAII() { Info.EvalMode = OldMode; }
   };
 
+  /// RAII object used to measure how deep the calls made while evaluating
+  /// one function call go, relative to the depth of that call.
+  class CallDepthTrackerRAII {
+    EvalInfo &Info;
+    unsigned OldMaxDepth;
+    unsigned StartDepth;
+
+  public:
+    explicit CallDepthTrackerRAII(EvalInfo &Info)
+        : Info(Info), OldMaxDepth(Info.MaxCallStackDepth),
+          StartDepth(Info.CallStackDepth) {
+      Info.MaxCallStackDepth = StartDepth;
+    }
+
+    /// The number of calls nested inside the tracked call at its deepest
+    /// point so far.
+    unsigned getNestedDepth() const {
+      return Info.MaxCallStackDepth - StartDepth;
+    }
+
+    ~CallDepthTrackerRAII() {
+      Info.MaxCallStackDepth = std::max(OldMaxDepth, Info.MaxCallStackDepth);
+    }
+  };
+
   /// RAII object used to optionally suppress diagnostics and side-effects from
   /// a speculative evaluation.
   class SpeculativeEvaluationRAII {
@@ -2861,13 +2902,18 @@ findSubobject(EvalInfo &Info, const Expr *E, const CompleteObject &Obj,
           return handler.foundString(*O, ObjType, Index);
       }
 
-      if (O->getArrayInitializedElts() > Index)
-        O = &O->getArrayInitializedElt(Index);
-      else if (handler.AccessKind != AK_Read) {
-        expandArray(*O, Index);
+      if (handler.AccessKind == AK_Read) {
+        // Use the const accessors, so that reading an element does not give
+        // the array its own copy of elements it shares with other arrays.
+        const APValue *Array = O;
+        O = const_cast<APValue *>(Array->getArrayInitializedElts() > Index
+                                      ? &Array->getArrayInitializedElt(Index)
+                                      : &Array->getArrayFiller());
+      } else {
+        if (O->getArrayInitializedElts() <= Index)
+          expandArray(*O, Index);
         O = &O->getArrayInitializedElt(Index);
-      } else
-        O = &O->getArrayFiller();
+      }
     } else if (ObjType->isAnyComplexType()) {
       // Next subobject is a complex number.
       uint64_t Index = Sub.Entries[I].ArrayIndex;
@@ -4399,12 +4445,65 @@ static bool EvaluateArgs(ArrayRef<const Expr*> Args, ArgVector &ArgValues,
   return Success;
 }
 
+/// Try to evaluate a call to \p Callee with the bytecode interpreter.
+/// Returns false, without producing any diagnostics, if the interpreter could
+/// not evaluate the call, in which case the caller should evaluate it by
+/// walking the function body.
+static bool interpretCall(EvalInfo &Info, const FunctionDecl *Callee,
+                          ArrayRef<APValue> ArgValues, APValue &Result) {
+  // The interpreter needs the values of all arguments, and only implements
+  // the C++ rules.
+  if (Info.checkingPotentialConstantExpression() || Info.getLangOpts().OpenCL)
+    return false;
+
+  SmallVector<APSInt, 8> Args;
+  for (const APValue &Arg : ArgValues) {
+    if (!Arg.isInt())
+      return false;
+    Args.push_back(Arg.getInt());
+  }
+
+  // The frame for this call has not been pushed yet.
+  unsigned MaxCallDepth =
+      Info.getLangOpts().ConstexprCallDepth - Info.CallStackDepth + 1;
+  unsigned NestedDepth;
+  APSInt Value;
+  if (!Info.Ctx.getConstexprInterpreter().evaluateCall(
+          Callee, Args, MaxCallDepth, Info.StepsLeft, NestedDepth, Value))
+    return false;
+  Info.MaxCallStackDepth =
+      std::max(Info.MaxCallStackDepth, Info.CallStackDepth + NestedDepth);
+  Result = APValue(Value);
+  return true;
+}
+
+/// Determine whether a call to a function with the arguments \p ArgValues can
+/// be looked up in, and recorded in, the memo table of constexpr calls.
+static bool isMemoizableCall(EvalInfo &Info, const LValue *This,
+                             ArrayRef<APValue> ArgValues) {
+  // Evaluating for overflow reports warnings directly rather than through
+  // notes, so we cannot tell whether such a call was clean.
+  if (This || Info.checkingPotentialConstantExpression() ||
+      Info.checkingForOverflow())
+    return false;
+  return llvm::all_of(ArgValues, ConstexprCallMemo::isMemoizableValue);
+}
+
+/// Get the part of the key of a memoized call that describes the evaluation
+/// it is made from. Results can differ between these contexts.
+static unsigned getMemoizedCallContext(EvalInfo &Info) {
+  return (unsigned)Info.EvalMode << 1 | Info.InConstantContext;
+}
+
 /// Evaluate a function call.
 static bool HandleFunctionCall(SourceLocation CallLoc,
                                const FunctionDecl *Callee, const LValue *This,
                                ArrayRef<const Expr*> Args, const Stmt *Body,
                                EvalInfo &Info, APValue &Result,
                                const LValue *ResultSlot) {
+  auto GetName = [&]() { return Callee->getQualifiedNameAsString(); };
+  TimeTraceScope TimeScope("ConstexprCall", GetName, GetName);
+
   ArgVector ArgValues(Args.size());
   if (!EvaluateArgs(Args, ArgValues, Info))
     return false;
@@ -4412,6 +4511,37 @@ static bool HandleFunctionCall(SourceLocation CallLoc,
   if (!Info.CheckCallLimit(CallLoc))
     return false;
 
+  // A call whose arguments and result are plain numbers, and that completed
+  // without any diagnostics or side effects, produces the same result every
+  // time. Reuse it, charging the steps and call depth it originally took so
+  // that the limits apply just as if it were evaluated again.
+  bool Memoizable = isMemoizableCall(Info, This, ArgValues);
+  if (Memoizable) {
+    if (const ConstexprCallMemo::Entry *Memo =
+            Info.Ctx.getConstexprCallMemo().lookup(
+                Callee, getMemoizedCallContext(Info), ArgValues)) {
+      if (Memo->Steps <= Info.StepsLeft &&
+          Info.CallStackDepth + Memo->Depth <=
+              Info.getLangOpts().ConstexprCallDepth) {
+        Info.StepsLeft -= Memo->Steps;
+        Info.MaxCallStackDepth = std::max(Info.MaxCallStackDepth,
+                                          Info.CallStackDepth + Memo->Depth);
+        Result = Memo->Result;
+        return true;
+      }
+    }
+  }
+
+  if (!This && Info.getLangOpts().EnableNewConstInterp &&
+      interpretCall(Info, Callee, ArgValues, Result))
+    return true;
+
+  unsigned StepsLeft = Info.StepsLeft;
+  unsigned NumDiagnostics = Info.NumDiagnostics;
+  bool WasClean = !Info.EvalStatus.HasSideEffects &&
+                  !Info.EvalStatus.HasUndefinedBehavior;
+  CallDepthTrackerRAII DepthTracker(Info);
+
   CallStackFrame Frame(Info, CallLoc, Callee, This, ArgValues.data());
 
   // For a trivial copy or move assignment, perform an APValue copy. This is
@@ -4456,7 +4586,17 @@ static bool HandleFunctionCall(SourceLocation CallLoc,
       return true;
     Info.FFDiag(Callee->getEndLoc(), diag::note_constexpr_no_return);
   }
-  return ESR == ESR_Returned;
+  if (ESR != ESR_Returned)
+    return false;
+
+  if (Memoizable && WasClean && Info.NumDiagnostics == NumDiagnostics &&
+      !Info.EvalStatus.HasSideEffects &&
+      !Info.EvalStatus.HasUndefinedBehavior &&
+      ConstexprCallMemo::isMemoizableValue(Result))
+    Info.Ctx.getConstexprCallMemo().insert(
+        Callee, getMemoizedCallContext(Info), ArgValues,
+        {Result, StepsLeft - Info.StepsLeft, DepthTracker.getNestedDepth()});
+  return true;
 }
 
 /// Evaluate a constructor call.
@@ -10869,6 +11009,9 @@ bool Expr::EvaluateAsConstantExpr(EvalResult &Result, ConstExprUsage Usage,
 bool Expr::EvaluateAsInitializer(APValue &Value, const ASTContext &Ctx,
                                  const VarDecl *VD,
                             SmallVectorImpl<PartialDiagnosticAt> &Notes) const {
+  TimeTraceScope TimeScope("EvaluateAsInitializer",
+                           [&]() { return VD->getQualifiedNameAsString(); });
+
   // FIXME: Evaluating initializers for large array and record types can cause
   // performance problems. Only do so in C++11 for now.
   if (isRValue() && (getType()->isArrayType() || getType()->isRecordType()) &&
@@ -18,6 +18,7 @@
 #include "clang/AST/DeclObjC.h"
 #include "clang/AST/DeclTemplate.h"
 #include "clang/AST/ExternalASTMerger.h"
+#include "llvm/ADT/SmallPtrSet.h"
 
 using namespace clang;
 
@@ -42,21 +43,36 @@ const DeclContext *CanonicalizeDC(const DeclContext *DC) {
   return DC;
 }
 
+/// Returns false if no declaration in SourceAST can be called Name.
+///
+/// Importing an identifier that a source has never seen adds it to the
+/// identifier table of the source, only for the lookup to find nothing.  With
+/// many sources, every name looked up would end up in every source.  Unless
+/// the source can load identifiers or declarations lazily, an identifier that
+/// is not in its table names nothing in it.  A source with an external AST
+/// source, such as one that gets its declarations from its own
+/// ExternalASTMerger, only learns about most names as they are looked up.
+bool SourceMayDeclareName(ASTContext &SourceAST, DeclarationName Name) {
+  IdentifierInfo *II = Name.getAsIdentifierInfo();
+  if (!II)
+    return true;
+  if (SourceAST.getExternalSource())
+    return true;
+  IdentifierTable &Idents = SourceAST.Idents;
+  if (Idents.getExternalIdentifierLookup())
+    return true;
+  return Idents.find(II->getName()) != Idents.end();
+}
+
+/// Looks up the DeclContext that corresponds to DC in the source DeclContext
+/// that corresponds to the parent of DC.
 Source<const DeclContext *>
-LookupSameContext(Source<TranslationUnitDecl *> SourceTU, const DeclContext *DC,
-                  ASTImporter &ReverseImporter) {
-  DC = CanonicalizeDC(DC);
-  if (DC->isTranslationUnit()) {
-    return SourceTU;
-  }
-  Source<const DeclContext *> SourceParentDC =
-      LookupSameContext(SourceTU, DC->getParent(), ReverseImporter);
-  if (!SourceParentDC) {
-    // If we couldn't find the parent DC in this TranslationUnit, give up.
-    return nullptr;
-  }
+LookupInSourceParent(Source<const DeclContext *> SourceParentDC,
+                     const DeclContext *DC, ASTImporter &ReverseImporter) {
   auto *ND = cast<NamedDecl>(DC);
   DeclarationName Name = ND->getDeclName();
+  if (!SourceMayDeclareName(ReverseImporter.getToContext(), Name))
+    return nullptr;
   Source<DeclarationName> SourceName = ReverseImporter.Import(Name);
   DeclContext::lookup_result SearchResult =
       SourceParentDC.get()->lookup(SourceName.get());
@@ -97,6 +113,10 @@ private:
   ExternalASTMerger &Parent;
   ASTImporter Reverse;
   const ExternalASTMerger::OriginMap &FromOrigins;
+  /// The source DeclContexts that name lookup found for target DeclContexts.
+  /// Only successful lookups are kept, since the source may gain the
+  /// declaration later.
+  llvm::DenseMap<const DeclContext *, const DeclContext *> SameContexts;
 
   llvm::raw_ostream &logs() { return Parent.logs(); }
 public:
@@ -157,6 +177,28 @@ public:
     return To;
   }
   ASTImporter &GetReverse() { return Reverse; }
+
+  /// Returns the DeclContext of the source that has the same name as DC, or
+  /// nullptr if name lookup does not find exactly one.
+  Source<const DeclContext *> LookupSameContext(const DeclContext *DC) {
+    DC = CanonicalizeDC(DC);
+    if (DC->isTranslationUnit())
+      return getFromContext().getTranslationUnitDecl();
+    auto Cached = SameContexts.find(DC);
+    if (Cached != SameContexts.end())
+      return Cached->second;
+    Source<const DeclContext *> SourceParentDC =
+        LookupSameContext(DC->getParent());
+    if (!SourceParentDC) {
+      // If we couldn't find the parent DC in this TranslationUnit, give up.
+      return nullptr;
+    }
+    Source<const DeclContext *> SourceDC =
+        LookupInSourceParent(SourceParentDC, DC, Reverse);
+    if (SourceDC)
+      SameContexts[DC] = SourceDC.get();
+    return SourceDC;
+  }
 };
 
 bool HasDeclOfSameType(llvm::ArrayRef<Candidate> Decls, const Candidate &C) {
@@ -170,10 +212,10 @@ bool HasDeclOfSameType(llvm::ArrayRef<Candidate> Decls, const Candidate &C) {
 } // end namespace
 
 ASTImporter &ExternalASTMerger::ImporterForOrigin(ASTContext &OriginContext) {
-  for (const std::unique_ptr<ASTImporter> &I : Importers)
-    if (&I->getFromContext() == &OriginContext)
-      return *I;
-  llvm_unreachable("We should have an importer for this origin!");
+  auto It = ImporterIndex.find(&OriginContext);
+  assert(It != ImporterIndex.end() &&
+         "We should have an importer for this origin!");
+  return *It->second;
 }
 
 namespace {
@@ -185,10 +227,7 @@ LazyASTImporter &LazyImporterForOrigin(ExternalASTMerger &Merger,
 }
 
 bool ExternalASTMerger::HasImporterForOrigin(ASTContext &OriginContext) {
-  for (const std::unique_ptr<ASTImporter> &I : Importers)
-    if (&I->getFromContext() == &OriginContext)
-      return true;
-  return false;
+  return ImporterIndex.count(&OriginContext);
 }
 
 template <typename CallbackType>
@@ -201,11 +240,9 @@ void ExternalASTMerger::ForEachMatchingDC(const DeclContext *DC,
   } else {
     bool DidCallback = false;
     for (const std::unique_ptr<ASTImporter> &Importer : Importers) {
-      Source<TranslationUnitDecl *> SourceTU =
-          Importer->getFromContext().getTranslationUnitDecl();
-      ASTImporter &Reverse =
-          static_cast<LazyASTImporter *>(Importer.get())->GetReverse();
-      if (auto SourceDC = LookupSameContext(SourceTU, DC, Reverse)) {
+      auto *Lazy = static_cast<LazyASTImporter *>(Importer.get());
+      ASTImporter &Reverse = Lazy->GetReverse();
+      if (auto SourceDC = Lazy->LookupSameContext(DC)) {
         DidCallback = true;
         if (Callback(*Importer, Reverse, SourceDC))
           break;
@@ -284,9 +321,7 @@ bool IsSameDC(const DeclContext *D1, const DeclContext *D2) {
 void ExternalASTMerger::MaybeRecordOrigin(const DeclContext *ToDC,
                                           DCOrigin Origin) {
   LazyASTImporter &Importer = LazyImporterForOrigin(*this, *Origin.AST);
-  ASTImporter &Reverse = Importer.GetReverse();
-  Source<const DeclContext *> FoundFromDC =
-      LookupSameContext(Origin.AST->getTranslationUnitDecl(), ToDC, Reverse);
+  Source<const DeclContext *> FoundFromDC = Importer.LookupSameContext(ToDC);
   const bool DoRecord = !FoundFromDC || !IsSameDC(FoundFromDC.get(), Origin.DC);
   if (DoRecord)
     RecordOriginImpl(ToDC, Origin, Importer);
@@ -317,8 +352,11 @@ ExternalASTMerger::ExternalASTMerger(const ImporterTarget &Target,
 void ExternalASTMerger::AddSources(llvm::ArrayRef<ImporterSource> Sources) {
   for (const ImporterSource &S : Sources) {
     assert(&S.AST != &Target.AST);
+    if (HasImporterForOrigin(S.AST))
+      continue;
     Importers.push_back(llvm::make_unique<LazyASTImporter>(
         *this, Target.AST, Target.FM, S.AST, S.FM, S.OM));
+    ImporterIndex[&S.AST] = Importers.back().get();
   }
 }
 
@@ -328,6 +366,8 @@ void ExternalASTMerger::RemoveSources(llvm::ArrayRef<ImporterSource> Sources) {
       logs() << "(ExternalASTMerger*)" << (void*)this
              << " removing source (ASTContext*)" << (void*)&S.AST
              << "\n";
+  for (const ImporterSource &S : Sources)
+    ImporterIndex.erase(&S.AST);
   Importers.erase(
       std::remove_if(Importers.begin(), Importers.end(),
                      [&Sources](std::unique_ptr<ASTImporter> &Importer) -> bool {
@@ -387,6 +427,8 @@ bool ExternalASTMerger::FindExternalVisibleDeclsByName(const DeclContext *DC,
 
   ForEachMatchingDC(DC, [&](ASTImporter &Forward, ASTImporter &Reverse,
                             Source<const DeclContext *> SourceDC) -> bool {
+    if (!SourceMayDeclareName(Reverse.getToContext(), Name))
+      return false;
     DeclarationName FromName = Reverse.Import(Name);
     DeclContextLookupResult Result = SourceDC.get()->lookup(FromName);
     for (NamedDecl *FromD : Result) {
@@ -398,6 +440,9 @@ bool ExternalASTMerger::FindExternalVisibleDeclsByName(const DeclContext *DC,
   if (Candidates.empty())
     return false;
 
+  // Sources that share declarations, for example through their own
+  // ExternalASTMergers, can yield candidates that import to the same Decl.
+  llvm::SmallPtrSet<NamedDecl *, 4> Imported;
   Decls.reserve(Candidates.size());
   for (const Candidate &C : Candidates) {
     Decl *LookupRes = C.first.get();
@@ -411,7 +456,8 @@ bool ExternalASTMerger::FindExternalVisibleDeclsByName(const DeclContext *DC,
         importSpecializationsIfNeeded(LookupRes, Importer);
     assert(!IsSpecImportFailed);
     (void)IsSpecImportFailed;
-    Decls.push_back(ND);
+    if (Imported.insert(ND).second)
+      Decls.push_back(ND);
   }
   SetExternalVisibleDeclsForName(DC, Name, Decls);
   return true;
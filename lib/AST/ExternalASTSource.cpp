@@ -80,6 +80,11 @@ bool ExternalASTSource::layoutRecordType(
   return false;
 }
 
+const ASTRecordLayout *
+ExternalASTSource::getStoredRecordLayout(const RecordDecl *Record) {
+  return nullptr;
+}
+
 Decl *ExternalASTSource::GetExternalDecl(uint32_t ID) {
   return nullptr;
 }
@@ -21,6 +21,7 @@
 #include "clang/Basic/ABI.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Basic/TargetInfo.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
@@ -114,7 +115,35 @@ bool MangleContext::shouldMangleDeclName(const NamedDecl *D) {
   return shouldMangleCXXName(D);
 }
 
+/// Whether the mangled name of \p D depends only on the declaration, and not
+/// on the discriminators and ids that a mangle context hands out as it
+/// mangles local and unnamed entities.
+static bool isMangledNameShareable(const NamedDecl *D) {
+  if (!isa<FunctionDecl>(D) && !isa<VarDecl>(D))
+    return false;
+  return D->isExternallyVisible() && !D->getParentFunctionOrMethod();
+}
+
 void MangleContext::mangleName(const NamedDecl *D, raw_ostream &Out) {
+  // CodeGen, the indexer and the frontend each create their own mangle
+  // context, so remember the names that all of them would agree on in the
+  // ASTContext instead of mangling them again.
+  if (!isMangledNameShareable(D)) {
+    mangleNameUncached(D, Out);
+    return;
+  }
+
+  StringRef Name = Context.getMangledDeclName(D);
+  if (Name.empty()) {
+    SmallString<256> Buffer;
+    llvm::raw_svector_ostream BufferOS(Buffer);
+    mangleNameUncached(D, BufferOS);
+    Name = Context.setMangledDeclName(D, Buffer);
+  }
+  Out << Name;
+}
+
+void MangleContext::mangleNameUncached(const NamedDecl *D, raw_ostream &Out) {
   // Any decl can be declared with __asm("foo") on it, and this takes precedence
   // over all other naming in the .o file.
   if (const AsmLabelAttr *ALA = D->getAttr<AsmLabelAttr>()) {
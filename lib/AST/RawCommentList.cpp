@@ -276,19 +276,43 @@ void RawCommentList::addComment(const RawComment &RC,
   if (RC.isInvalid())
     return;
 
-  // Check if the comments are not in source order.
-  while (!Comments.empty() &&
-         !SourceMgr.isBeforeInTranslationUnit(Comments.back()->getBeginLoc(),
-                                              RC.getBeginLoc())) {
-    // If they are, just pop a few last comments that don't fit.
-    // This happens if an \#include directive contains comments.
-    Comments.pop_back();
+  // Check if the comments are not in source order.  If they are, just pop a
+  // few last comments that don't fit.  This happens if an \#include directive
+  // contains comments.  A comment can't begin between the parts of a merged
+  // comment, so popping the parts one by one is the same as popping the
+  // merged comment.
+  while (!PendingComments.empty() &&
+         !SourceMgr.isBeforeInTranslationUnit(
+             PendingComments.back().getBeginLoc(), RC.getBeginLoc()))
+    PendingComments.pop_back();
+  if (PendingComments.empty()) {
+    while (!Comments.empty() &&
+           !SourceMgr.isBeforeInTranslationUnit(Comments.back()->getBeginLoc(),
+                                                RC.getBeginLoc()))
+      Comments.pop_back();
   }
 
   // Ordinary comments are not interesting for us.
   if (RC.isOrdinary() && !CommentOpts.ParseAllComments)
     return;
 
+  PendingCommentOpts = &CommentOpts;
+  PendingAllocator = &Allocator;
+  PendingComments.push_back(RC);
+}
+
+void RawCommentList::mergePendingComments() const {
+  for (const RawComment &RC : PendingComments)
+    mergeComment(RC);
+  PendingComments.clear();
+}
+
+/// Append \p RC, which follows all of the comments in Comments, merging it
+/// into the last one if they are adjacent.
+void RawCommentList::mergeComment(const RawComment &RC) const {
+  const CommentOptions &CommentOpts = *PendingCommentOpts;
+  llvm::BumpPtrAllocator &Allocator = *PendingAllocator;
+
   // If this is the first Doxygen comment, save it (because there isn't
   // anything to merge it with).
   if (Comments.empty()) {
@@ -326,6 +350,9 @@ void RawCommentList::addComment(const RawComment &RC,
 }
 
 void RawCommentList::addDeserializedComments(ArrayRef<RawComment *> DeserializedComments) {
+  if (!PendingComments.empty())
+    mergePendingComments();
+
   std::vector<RawComment *> MergedComments;
   MergedComments.reserve(Comments.size() + DeserializedComments.size());
 
@@ -2985,7 +2985,14 @@ ASTContext::getASTRecordLayout(const RecordDecl *D) const {
 
   const ASTRecordLayout *NewEntry = nullptr;
 
-  if (isMsLayout(*this)) {
+  // A record from an AST file may have been laid out when the file was built.
+  if (D->isFromASTFile())
+    if (ExternalASTSource *Source = getExternalSource())
+      NewEntry = Source->getStoredRecordLayout(D);
+
+  if (NewEntry) {
+    // Nothing left to compute.
+  } else if (isMsLayout(*this)) {
     MicrosoftRecordLayoutBuilder Builder(*this);
     if (const auto *RD = dyn_cast<CXXRecordDecl>(D)) {
       Builder.cxxLayout(RD);
@@ -12,6 +12,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/AST/Stmt.h"
+#include "ASTMemoryAttribution.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/ASTDiagnostic.h"
 #include "clang/AST/Decl.h"
@@ -110,6 +111,15 @@ void Stmt::EnableStatistics() {
   StatisticsEnabled = true;
 }
 
+bool Stmt::MemoryAttributionEnabled = false;
+void Stmt::EnableMemoryAttribution() {
+  MemoryAttributionEnabled = true;
+}
+
+void Stmt::noteMemoryAttribution() const {
+  ASTMemoryAttribution::noteStmt(this);
+}
+
 Stmt *Stmt::IgnoreImplicit() {
   Stmt *s = this;
 
@@ -3387,9 +3387,17 @@ static void findPathsToSubobject(ASTContext &Context,
   }
 
   const ASTRecordLayout &Layout = Context.getASTRecordLayout(RD);
+  const CXXRecordDecl *IntroducingRD = IntroducingObject.getBase();
 
   for (const CXXBaseSpecifier &BS : RD->bases()) {
     const CXXRecordDecl *Base = BS.getType()->getAsCXXRecordDecl();
+    // Only bases that are or derive from the introducing class can contain
+    // it. Skipping the others keeps the search from walking every path
+    // through unrelated parts of deep hierarchies, which grows exponentially
+    // with the number of diamonds.
+    if (Base->getCanonicalDecl() != IntroducingRD->getCanonicalDecl() &&
+        !Base->isDerivedFrom(IntroducingRD))
+      continue;
     CharUnits NewOffset = BS.isVirtual()
                               ? MostDerivedLayout.getVBaseClassOffset(Base)
                               : Offset + Layout.getBaseClassOffset(Base);
@@ -21,11 +21,25 @@
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/RecursiveASTVisitor.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringMap.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/Timer.h"
+#include <algorithm>
+#include <atomic>
 #include <deque>
+#include <list>
 #include <memory>
 #include <set>
+#include <unordered_map>
+
+#define DEBUG_TYPE "ast-matchers"
+
+STATISTIC(NumMemoizationHits, "The # of recursive matches found memoized");
+STATISTIC(NumMemoizationMisses,
+          "The # of recursive matches that were not memoized");
+STATISTIC(NumMemoizationEvictions,
+          "The # of memoized matches dropped to make room for others");
 
 namespace clang {
 namespace ast_matchers {
@@ -34,7 +48,8 @@ namespace {
 
 typedef MatchFinder::MatchCallback MatchCallback;
 
-// The maximum number of memoization entries to store.
+// The maximum number of memoization entries to store. Beyond that, the least
+// recently used entry is dropped for every new one.
 // 10k has been experimentally found to give a good trade-off
 // of performance vs. memory consumption by running matcher
 // that match on every statement over a very large codebase.
@@ -61,9 +76,34 @@ struct MatchKey {
   ast_type_traits::DynTypedNode Node;
   BoundNodesTreeBuilder BoundNodes;
 
-  bool operator<(const MatchKey &Other) const {
-    return std::tie(MatcherID, Node, BoundNodes) <
-           std::tie(Other.MatcherID, Other.Node, Other.BoundNodes);
+  bool operator==(const MatchKey &Other) const {
+    return MatcherID.first.isSame(Other.MatcherID.first) &&
+           MatcherID.second == Other.MatcherID.second && Node == Other.Node &&
+           BoundNodes == Other.BoundNodes;
+  }
+};
+
+// Hashes only the matcher and the node of a MatchKey. The bound nodes rarely
+// differ between the keys for one matcher and node, and are only compared
+// when those are equal.
+struct MatchKeyHash {
+  size_t operator()(const MatchKey *Key) const {
+    unsigned NodeHash;
+    if (const QualType *Q = Key->Node.get<QualType>())
+      NodeHash = llvm::hash_value(Q->getAsOpaquePtr());
+    else
+      NodeHash =
+          ast_type_traits::DynTypedNode::DenseMapInfo::getHashValue(Key->Node);
+    return llvm::hash_combine(
+        ast_type_traits::ASTNodeKind::DenseMapInfo::getHashValue(
+            Key->MatcherID.first),
+        Key->MatcherID.second, NodeHash);
+  }
+};
+
+struct MatchKeyEqual {
+  bool operator()(const MatchKey *LHS, const MatchKey *RHS) const {
+    return *LHS == *RHS;
   }
 };
 
@@ -73,6 +113,68 @@ struct MemoizedMatchResult {
   BoundNodesTreeBuilder Nodes;
 };
 
+// The memoized match results, of which the MaxMemoizationEntries most
+// recently used ones are kept.
+class MemoizationCache {
+public:
+  // Returns the result for \p Key, if there is one.
+  const MemoizedMatchResult *lookup(const MatchKey &Key) {
+    auto I = Index.find(&Key);
+    if (I == Index.end()) {
+      ++NumMemoizationMisses;
+      return nullptr;
+    }
+    ++NumMemoizationHits;
+    Entries.splice(Entries.begin(), Entries, I->second);
+    return &I->second->second;
+  }
+
+  // Stores \p Result for \p Key, replacing any result it already has.
+  const MemoizedMatchResult &insert(MatchKey Key, MemoizedMatchResult Result) {
+    auto I = Index.find(&Key);
+    if (I != Index.end()) {
+      EntryList::iterator Entry = I->second;
+      Index.erase(I);
+      Entries.erase(Entry);
+    } else if (Entries.size() >= MaxMemoizationEntries) {
+      ++NumMemoizationEvictions;
+      Index.erase(&Entries.back().first);
+      Entries.pop_back();
+    }
+    Entries.emplace_front(std::move(Key), std::move(Result));
+    Index[&Entries.front().first] = Entries.begin();
+    return Entries.front().second;
+  }
+
+  void clear() {
+    Index.clear();
+    Entries.clear();
+  }
+
+private:
+  typedef std::list<std::pair<MatchKey, MemoizedMatchResult>> EntryList;
+
+  // The entries, most recently used first.
+  EntryList Entries;
+  // The entries by their keys, which are owned by the entries.
+  std::unordered_map<const MatchKey *, EntryList::iterator, MatchKeyHash,
+                     MatchKeyEqual>
+      Index;
+};
+
+// A match whose callback is only run once all threads that match a
+// translation unit in parallel are done.
+struct DeferredMatch {
+  MatchCallback *Callback;
+  BoundNodes Nodes;
+};
+
+// The typedefs in each unit of a translation unit that is matched in
+// parallel, by the canonical type they alias, in the order of the units.
+typedef llvm::DenseMap<
+    const Type *, std::vector<std::pair<unsigned, const TypedefNameDecl *>>>
+    UnitTypeAliases;
+
 // A RecursiveASTVisitor that traverses all children or all descendants of
 // a node.
 class MatchChildASTVisitor
@@ -160,6 +262,8 @@ public:
       return true;
     if (!match(*StmtToTraverse))
       return false;
+    if (shouldMatchDescendantsMemoized(*StmtToTraverse))
+      return matchDescendantsMemoized(*StmtToTraverse);
     return VisitorBase::TraverseStmt(StmtToTraverse, Queue);
   }
   // We assume that the QualType and the contained type are on the same
@@ -221,6 +325,33 @@ private:
     int *Depth;
   };
 
+  // Whether to match the descendants of \p StmtNode through the memoizing
+  // ASTMatchFinder::matchesDescendantOf(), instead of traversing them here.
+  //
+  // When looking for the first match among all descendants, the first match
+  // below a statement is the same no matter which ancestor the search started
+  // at. Memoizing it for the statement avoids searching its subtree again
+  // for every ancestor that the same matcher is tried on, for example with
+  // forEachDescendant(stmt(hasDescendant(...))). Expressions are still
+  // traversed here, as that does not recurse for deeply nested expressions.
+  bool shouldMatchDescendantsMemoized(const Stmt &StmtNode) const {
+    return MaxDepth == INT_MAX && Bind == ASTMatchFinder::BK_First &&
+           Traversal == ASTMatchFinder::TK_AsIs && !isa<Expr>(StmtNode) &&
+           Builder->isComparable();
+  }
+
+  // Matches the descendants of \p StmtNode like match() does for a node.
+  bool matchDescendantsMemoized(const Stmt &StmtNode) {
+    BoundNodesTreeBuilder RecursiveBuilder(*Builder);
+    if (Finder->matchesDescendantOf(StmtNode, *Matcher, &RecursiveBuilder,
+                                    Bind)) {
+      Matches = true;
+      ResultBindings.addMatch(RecursiveBuilder);
+      return false;
+    }
+    return true;
+  }
+
   // Resets the state of this object.
   void reset() {
     Matches = false;
@@ -344,6 +475,39 @@ public:
     ActiveASTContext = NewActiveASTContext;
   }
 
+  // Record the matches found from now on in \p Matches, rather than running
+  // their callbacks.
+  void deferMatchesTo(std::vector<DeferredMatch> *Matches) {
+    DeferredMatches = Matches;
+  }
+
+  // Start matching the unit \p Unit of a translation unit that is matched in
+  // parallel. The typedefs of the units before it are looked up in
+  // \p Aliases, as if they had been traversed by this visitor.
+  void startUnit(const UnitTypeAliases *Aliases, unsigned Unit) {
+    PrecedingAliases = Aliases;
+    CurrentUnit = Unit;
+    TypeAliases.clear();
+    ResultCache.clear();
+  }
+
+  // Run the callbacks of matches that were deferred, in order.
+  void runDeferredMatches(ArrayRef<DeferredMatch> Matches) {
+    const bool EnableCheckProfiling = Options.CheckProfiling.hasValue();
+    TimeBucketRegion Timer;
+    for (const DeferredMatch &M : Matches) {
+      if (EnableCheckProfiling)
+        Timer.setBucket(&TimeByBucket[M.Callback->getID()]);
+      M.Callback->run(MatchFinder::MatchResult(M.Nodes, ActiveASTContext));
+    }
+  }
+
+  // Add the time that \p Other spent on each bucket to this visitor's.
+  void addTimes(const MatchASTVisitor &Other) {
+    for (const auto &Entry : Other.TimeByBucket)
+      TimeByBucket[Entry.getKey()] += Entry.getValue();
+  }
+
   // The following Visit*() and Traverse*() functions "override"
   // methods in RecursiveASTVisitor.
 
@@ -406,10 +570,9 @@ public:
     // Note that we key on the bindings *before* the match.
     Key.BoundNodes = *Builder;
 
-    MemoizationMap::iterator I = ResultCache.find(Key);
-    if (I != ResultCache.end()) {
-      *Builder = I->second.Nodes;
-      return I->second.ResultOfMatch;
+    if (const MemoizedMatchResult *Cached = ResultCache.lookup(Key)) {
+      *Builder = Cached->Nodes;
+      return Cached->ResultOfMatch;
     }
 
     MemoizedMatchResult Result;
@@ -417,8 +580,8 @@ public:
     Result.ResultOfMatch = matchesRecursively(Node, Matcher, &Result.Nodes,
                                               MaxDepth, Traversal, Bind);
 
-    MemoizedMatchResult &CachedResult = ResultCache[Key];
-    CachedResult = std::move(Result);
+    const MemoizedMatchResult &CachedResult =
+        ResultCache.insert(std::move(Key), std::move(Result));
 
     *Builder = CachedResult.Nodes;
     return CachedResult.ResultOfMatch;
@@ -444,8 +607,6 @@ public:
                       BoundNodesTreeBuilder *Builder,
                       TraversalKind Traversal,
                       BindKind Bind) override {
-    if (ResultCache.size() > MaxMemoizationEntries)
-      ResultCache.clear();
     return memoizedMatchesRecursively(Node, Matcher, Builder, 1, Traversal,
                                       Bind);
   }
@@ -454,8 +615,6 @@ public:
                            const DynTypedMatcher &Matcher,
                            BoundNodesTreeBuilder *Builder,
                            BindKind Bind) override {
-    if (ResultCache.size() > MaxMemoizationEntries)
-      ResultCache.clear();
     return memoizedMatchesRecursively(Node, Matcher, Builder, INT_MAX,
                                       TK_AsIs, Bind);
   }
@@ -466,8 +625,6 @@ public:
                          AncestorMatchMode MatchMode) override {
     // Reset the cache outside of the recursive call to make sure we
     // don't invalidate any iterators.
-    if (ResultCache.size() > MaxMemoizationEntries)
-      ResultCache.clear();
     return memoizedMatchesAncestorOfRecursively(Node, Matcher, Builder,
                                                 MatchMode);
   }
@@ -546,7 +703,7 @@ private:
         Timer.setBucket(&TimeByBucket[MP.second->getID()]);
       BoundNodesTreeBuilder Builder;
       if (MP.first.matches(Node, this, &Builder)) {
-        MatchVisitor Visitor(ActiveASTContext, MP.second);
+        MatchVisitor Visitor(ActiveASTContext, MP.second, DeferredMatches);
         Builder.visitMatches(&Visitor);
       }
     }
@@ -570,7 +727,7 @@ private:
         Timer.setBucket(&TimeByBucket[MP.second->getID()]);
       BoundNodesTreeBuilder Builder;
       if (MP.first.matchesNoKindCheck(DynNode, this, &Builder)) {
-        MatchVisitor Visitor(ActiveASTContext, MP.second);
+        MatchVisitor Visitor(ActiveASTContext, MP.second, DeferredMatches);
         Builder.visitMatches(&Visitor);
       }
     }
@@ -644,12 +801,11 @@ private:
     Key.Node = Node;
     Key.BoundNodes = *Builder;
 
-    // Note that we cannot use insert and reuse the iterator, as recursive
-    // calls to match might invalidate the result cache iterators.
-    MemoizationMap::iterator I = ResultCache.find(Key);
-    if (I != ResultCache.end()) {
-      *Builder = I->second.Nodes;
-      return I->second.ResultOfMatch;
+    // Note that we cannot look up the entry to insert into before matching,
+    // as recursive calls to match might evict it.
+    if (const MemoizedMatchResult *Cached = ResultCache.lookup(Key)) {
+      *Builder = Cached->Nodes;
+      return Cached->ResultOfMatch;
     }
 
     MemoizedMatchResult Result;
@@ -657,8 +813,8 @@ private:
     Result.ResultOfMatch =
         matchesAncestorOfRecursively(Node, Matcher, &Result.Nodes, MatchMode);
 
-    MemoizedMatchResult &CachedResult = ResultCache[Key];
-    CachedResult = std::move(Result);
+    const MemoizedMatchResult &CachedResult =
+        ResultCache.insert(std::move(Key), std::move(Result));
 
     *Builder = CachedResult.Nodes;
     return CachedResult.ResultOfMatch;
@@ -731,17 +887,24 @@ private:
   class MatchVisitor : public BoundNodesTreeBuilder::Visitor {
   public:
     MatchVisitor(ASTContext* Context,
-                 MatchFinder::MatchCallback* Callback)
+                 MatchFinder::MatchCallback* Callback,
+                 std::vector<DeferredMatch> *DeferredMatches = nullptr)
       : Context(Context),
-        Callback(Callback) {}
+        Callback(Callback),
+        DeferredMatches(DeferredMatches) {}
 
     void visitMatch(const BoundNodes& BoundNodesView) override {
+      if (DeferredMatches) {
+        DeferredMatches->push_back({Callback, BoundNodesView});
+        return;
+      }
       Callback->run(MatchFinder::MatchResult(BoundNodesView, Context));
     }
 
   private:
     ASTContext* Context;
     MatchFinder::MatchCallback* Callback;
+    std::vector<DeferredMatch> *DeferredMatches;
   };
 
   // Returns true if 'TypeNode' has an alias that matches the given matcher.
@@ -751,6 +914,9 @@ private:
     const Type *const CanonicalType =
       ActiveASTContext->getCanonicalType(TypeNode);
     auto Aliases = TypeAliases.find(CanonicalType);
+    if (PrecedingAliases)
+      return typeHasMatchingPrecedingAlias(CanonicalType, Aliases, Matcher,
+                                           Builder);
     if (Aliases == TypeAliases.end())
       return false;
     for (const TypedefNameDecl *Alias : Aliases->second) {
@@ -763,6 +929,34 @@ private:
     return false;
   }
 
+  // Like typeHasMatchingAlias(), but also considers the typedefs in the units
+  // before the current one of a translation unit that is matched in parallel.
+  // The aliases are tried in the same order a single visitor would try them.
+  bool typeHasMatchingPrecedingAlias(
+      const Type *CanonicalType,
+      llvm::DenseMap<const Type *,
+                     std::set<const TypedefNameDecl *>>::iterator Aliases,
+      const Matcher<NamedDecl> &Matcher, BoundNodesTreeBuilder *Builder) {
+    std::set<const TypedefNameDecl *> AllAliases;
+    if (Aliases != TypeAliases.end())
+      AllAliases = Aliases->second;
+    auto Preceding = PrecedingAliases->find(CanonicalType);
+    if (Preceding != PrecedingAliases->end())
+      for (const auto &UnitAndAlias : Preceding->second) {
+        if (UnitAndAlias.first >= CurrentUnit)
+          break;
+        AllAliases.insert(UnitAndAlias.second);
+      }
+    for (const TypedefNameDecl *Alias : AllAliases) {
+      BoundNodesTreeBuilder Result(*Builder);
+      if (Matcher.matches(*Alias, this, &Result)) {
+        *Builder = std::move(Result);
+        return true;
+      }
+    }
+    return false;
+  }
+
   /// Bucket to record map.
   ///
   /// Used to get the appropriate bucket for each matcher.
@@ -775,7 +969,9 @@ private:
   /// \c Decl and \c Stmt toplevel matchers usually apply to a specific node
   /// kind (and derived kinds) so it is a waste to try every matcher on every
   /// node.
-  /// We precalculate a list of matchers that pass the toplevel restrict check.
+  /// We precalculate a list of matchers that pass the toplevel restrict check,
+  /// and whose inner matchers do not rule out the kind either (for example
+  /// \c stmt(anyOf(ifStmt(), forStmt())) is not tried on a \c WhileStmt).
   /// This also allows us to skip the restrict check at matching time. See
   /// use \c matchesNoKindCheck() above.
   llvm::DenseMap<ast_type_traits::ASTNodeKind, std::vector<unsigned short>>
@@ -787,9 +983,16 @@ private:
   // Maps a canonical type to its TypedefDecls.
   llvm::DenseMap<const Type*, std::set<const TypedefNameDecl*> > TypeAliases;
 
+  // Where matches are recorded instead of being reported, if anywhere.
+  std::vector<DeferredMatch> *DeferredMatches = nullptr;
+
+  // The typedefs of the other units, and the index of the current unit, when
+  // the translation unit is matched in parallel.
+  const UnitTypeAliases *PrecedingAliases = nullptr;
+  unsigned CurrentUnit = 0;
+
   // Maps (matcher, node) -> the match result for memoization.
-  typedef std::map<MatchKey, MemoizedMatchResult> MemoizationMap;
-  MemoizationMap ResultCache;
+  MemoizationCache ResultCache;
 };
 
 static CXXRecordDecl *
@@ -912,6 +1115,110 @@ bool MatchASTVisitor::TraverseConstructorInitializer(
       CtorInit);
 }
 
+// Collects the typedefs that a MatchASTVisitor would visit.
+class TypedefCollector : public RecursiveASTVisitor<TypedefCollector> {
+public:
+  explicit TypedefCollector(std::vector<const TypedefNameDecl *> &Typedefs)
+      : Typedefs(Typedefs) {}
+
+  bool shouldVisitTemplateInstantiations() const { return true; }
+  bool shouldVisitImplicitCode() const { return true; }
+
+  bool VisitTypedefNameDecl(TypedefNameDecl *DeclNode) {
+    Typedefs.push_back(DeclNode);
+    return true;
+  }
+
+private:
+  std::vector<const TypedefNameDecl *> &Typedefs;
+};
+
+// Matches the translation unit with \p NumThreads threads. The units of work
+// are the top-level declarations of the traversal scope. Each thread matches
+// units with its own MatchASTVisitor, which records the matches per unit, and
+// the callbacks are then run on this thread in the order that a single
+// MatchASTVisitor would have run them in.
+void matchInParallel(const MatchFinder::MatchersByType &Matchers,
+                     const MatchFinder::MatchFinderOptions &Options,
+                     ASTContext &Context, unsigned NumThreads) {
+  // A unit is either a declaration that is traversed, or the translation
+  // unit itself, which is only matched; its children are units of their own.
+  struct Unit {
+    Decl *D;
+    bool MatchOnly;
+  };
+  std::vector<Unit> Units;
+  for (Decl *D : Context.getTraversalScope()) {
+    auto *TU = dyn_cast<TranslationUnitDecl>(D);
+    Units.push_back({D, TU != nullptr});
+    if (TU)
+      for (Decl *Child : TU->decls())
+        if (!isa<BlockDecl>(Child) && !isa<CapturedDecl>(Child))
+          Units.push_back({Child, false});
+  }
+
+  // The matchers may ask for parents from any thread, so compute them all
+  // while nothing else runs.
+  Context.computeAllParents();
+
+  // The reporter is destroyed last, so that it is the one that stores the
+  // profiling records.
+  MatchASTVisitor Reporter(&Matchers, Options);
+  Reporter.set_active_ast_context(&Context);
+
+  NumThreads = std::max<size_t>(1, std::min<size_t>(NumThreads, Units.size()));
+  std::vector<std::unique_ptr<MatchASTVisitor>> Workers;
+  for (unsigned I = 0; I != NumThreads; ++I) {
+    Workers.push_back(llvm::make_unique<MatchASTVisitor>(&Matchers, Options));
+    Workers.back()->set_active_ast_context(&Context);
+  }
+
+  auto RunOnUnits = [&](llvm::function_ref<void(unsigned, unsigned)> Fn) {
+    std::atomic<unsigned> NextUnit(0);
+    llvm::ThreadPool Pool(NumThreads);
+    for (unsigned W = 0; W != NumThreads; ++W)
+      Pool.async([&, W] {
+        for (unsigned I = NextUnit++; I < Units.size(); I = NextUnit++)
+          Fn(W, I);
+      });
+    Pool.wait();
+  };
+
+  // A single visitor only knows about the typedefs it has already seen when
+  // it matches isDerivedFrom() against the aliases of a base class. Collect
+  // the typedefs of every unit first, so that the matchers of each unit see
+  // the ones before it too.
+  std::vector<std::vector<const TypedefNameDecl *>> UnitTypedefs(Units.size());
+  RunOnUnits([&](unsigned, unsigned I) {
+    if (!Units[I].MatchOnly)
+      TypedefCollector(UnitTypedefs[I]).TraverseDecl(Units[I].D);
+  });
+  UnitTypeAliases Aliases;
+  for (unsigned I = 0, E = Units.size(); I != E; ++I)
+    for (const TypedefNameDecl *Typedef : UnitTypedefs[I])
+      Aliases[Context.getCanonicalType(
+                  Typedef->getUnderlyingType().getTypePtr())]
+          .push_back({I, Typedef});
+
+  std::vector<std::vector<DeferredMatch>> UnitMatches(Units.size());
+  RunOnUnits([&](unsigned W, unsigned I) {
+    MatchASTVisitor &Visitor = *Workers[W];
+    Visitor.startUnit(&Aliases, I);
+    Visitor.deferMatchesTo(&UnitMatches[I]);
+    if (Units[I].MatchOnly)
+      Visitor.match(*Units[I].D);
+    else
+      Visitor.TraverseDecl(Units[I].D);
+  });
+
+  Reporter.onStartOfTranslationUnit();
+  for (const std::vector<DeferredMatch> &Matches : UnitMatches)
+    Reporter.runDeferredMatches(Matches);
+  Reporter.onEndOfTranslationUnit();
+  for (const auto &Worker : Workers)
+    Reporter.addTimes(*Worker);
+}
+
 class MatchASTConsumer : public ASTConsumer {
 public:
   MatchASTConsumer(MatchFinder *Finder,
@@ -1027,6 +1334,10 @@ void MatchFinder::match(const clang::ast_type_traits::DynTypedNode &Node,
 }
 
 void MatchFinder::matchAST(ASTContext &Context) {
+  if (Options.NumThreads > 1) {
+    internal::matchInParallel(Matchers, Options, Context, Options.NumThreads);
+    return;
+  }
   internal::MatchASTVisitor Visitor(&Matchers, Options);
   Visitor.set_active_ast_context(&Context);
   Visitor.onStartOfTranslationUnit();
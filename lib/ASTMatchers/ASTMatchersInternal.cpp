@@ -95,10 +95,38 @@ public:
     return Func(DynNode, Finder, Builder, InnerMatchers);
   }
 
+  bool canMatchNodesOfKind(ast_type_traits::ASTNodeKind Kind) const override {
+    auto CanMatch = [Kind](const DynTypedMatcher &M) {
+      return M.canMatchNodesOfKind(Kind);
+    };
+    // allOf() needs all of its inner matchers to match, anyOf() and eachOf()
+    // at least one of them. unless() may match anything its inner matcher
+    // does not.
+    if (Func == AllOfVariadicOperator)
+      return llvm::all_of(InnerMatchers, CanMatch);
+    if (Func == AnyOfVariadicOperator || Func == EachOfVariadicOperator)
+      return llvm::any_of(InnerMatchers, CanMatch);
+    return true;
+  }
+
+  bool isCheapToMatch() const override {
+    return llvm::all_of(InnerMatchers, [](const DynTypedMatcher &M) {
+      return M.isCheapToMatch();
+    });
+  }
+
+  const void *dynamicClassID() const override { return &ID; }
+
+  ArrayRef<DynTypedMatcher> getInnerMatchers() const { return InnerMatchers; }
+
+  static char ID;
+
 private:
   std::vector<DynTypedMatcher> InnerMatchers;
 };
 
+template <VariadicOperatorFunction Func> char VariadicMatcher<Func>::ID;
+
 class IdDynMatcher : public DynMatcherInterface {
 public:
   IdDynMatcher(StringRef ID,
@@ -113,11 +141,26 @@ public:
     return Result;
   }
 
+  bool canMatchNodesOfKind(ast_type_traits::ASTNodeKind Kind) const override {
+    return InnerMatcher->canMatchNodesOfKind(Kind);
+  }
+
+  const void *dynamicClassID() const override { return &ClassID; }
+
+  StringRef getBoundID() const { return ID; }
+  const IntrusiveRefCntPtr<DynMatcherInterface> &getInnerMatcher() const {
+    return InnerMatcher;
+  }
+
+  static char ClassID;
+
 private:
   const std::string ID;
   const IntrusiveRefCntPtr<DynMatcherInterface> InnerMatcher;
 };
 
+char IdDynMatcher::ClassID;
+
 /// A matcher that always returns true.
 ///
 /// We only ever need one instance of this matcher, so we create a global one
@@ -133,8 +176,20 @@ public:
                   BoundNodesTreeBuilder *) const override {
     return true;
   }
+
+  bool isCheapToMatch() const override { return true; }
 };
 
+/// Returns the inner matchers of an allOf() or anyOf() implementation.
+ArrayRef<DynTypedMatcher> getInnerMatchers(const DynMatcherInterface &Impl,
+                                           bool IsAllOf) {
+  if (IsAllOf)
+    return static_cast<const VariadicMatcher<AllOfVariadicOperator> &>(Impl)
+        .getInnerMatchers();
+  return static_cast<const VariadicMatcher<AnyOfVariadicOperator> &>(Impl)
+      .getInnerMatchers();
+}
+
 } // namespace
 
 static llvm::ManagedStatic<TrueMatcherImpl> TrueMatcherInstance;
@@ -195,9 +250,74 @@ DynTypedMatcher DynTypedMatcher::trueMatcher(
   return DynTypedMatcher(NodeKind, NodeKind, &*TrueMatcherInstance);
 }
 
+DynTypedMatcher DynTypedMatcher::compile() const {
+  const void *ClassID = Implementation->dynamicClassID();
+  DynTypedMatcher Result = *this;
+
+  // Compile the matcher that is bound, and bind the result instead.
+  if (ClassID == &IdDynMatcher::ClassID) {
+    const auto &Bound = static_cast<const IdDynMatcher &>(*Implementation);
+    DynTypedMatcher Inner = *this;
+    Inner.Implementation = Bound.getInnerMatcher();
+    DynTypedMatcher Compiled = Inner.compile();
+    if (Compiled.Implementation == Inner.Implementation)
+      return Result;
+    Result.Implementation =
+        new IdDynMatcher(Bound.getBoundID(), std::move(Compiled.Implementation));
+    return Result;
+  }
+
+  bool IsAllOf = ClassID == &VariadicMatcher<AllOfVariadicOperator>::ID;
+  if (!IsAllOf && ClassID != &VariadicMatcher<AnyOfVariadicOperator>::ID)
+    return Result;
+
+  std::vector<DynTypedMatcher> InnerMatchers;
+  for (const DynTypedMatcher &Inner :
+       getInnerMatchers(*Implementation, IsAllOf)) {
+    DynTypedMatcher Compiled = Inner.compile();
+    // allOf() checks the kinds of its inner matchers up front, so nested
+    // allOf()s can be folded in, and those that only check the kind dropped.
+    // anyOf() checks them one at a time, so a nested anyOf() can only be
+    // folded in if its own kind check is implied by ours.
+    if (Compiled.Implementation->dynamicClassID() == ClassID &&
+        (IsAllOf || Compiled.RestrictKind.isBaseOf(RestrictKind))) {
+      ArrayRef<DynTypedMatcher> Nested =
+          getInnerMatchers(*Compiled.Implementation, IsAllOf);
+      InnerMatchers.insert(InnerMatchers.end(), Nested.begin(), Nested.end());
+      continue;
+    }
+    if (IsAllOf && Compiled.Implementation.get() == &*TrueMatcherInstance)
+      continue;
+    InnerMatchers.push_back(std::move(Compiled));
+  }
+
+  if (IsAllOf) {
+    if (InnerMatchers.empty()) {
+      Result.Implementation = &*TrueMatcherInstance;
+      return Result;
+    }
+    if (InnerMatchers.size() == 1) {
+      Result.Implementation = InnerMatchers.front().Implementation;
+      return Result;
+    }
+    // The cheap matchers neither bind nor read bound nodes, so the result
+    // does not depend on whether they are matched first.
+    std::stable_partition(
+        InnerMatchers.begin(), InnerMatchers.end(),
+        [](const DynTypedMatcher &M) { return M.isCheapToMatch(); });
+    Result.Implementation =
+        new VariadicMatcher<AllOfVariadicOperator>(std::move(InnerMatchers));
+  } else {
+    Result.Implementation =
+        new VariadicMatcher<AnyOfVariadicOperator>(std::move(InnerMatchers));
+  }
+  return Result;
+}
+
 bool DynTypedMatcher::canMatchNodesOfKind(
     ast_type_traits::ASTNodeKind Kind) const {
-  return RestrictKind.isBaseOf(Kind);
+  return RestrictKind.isBaseOf(Kind) &&
+         Implementation->canMatchNodesOfKind(Kind);
 }
 
 DynTypedMatcher DynTypedMatcher::dynCastTo(
@@ -675,8 +675,11 @@ Parser::parseMatcherExpression(StringRef Code, Sema *S,
   if (!Result.hasValue()) {
     Error->addError(SourceRange(), Error->ET_ParserOverloadedType)
         << Value.getTypeAsString();
+    return Result;
   }
-  return Result;
+  // The matcher is typically matched against every node of many translation
+  // units; simplify it once here.
+  return Result->compile();
 }
 
 } // namespace dynamic
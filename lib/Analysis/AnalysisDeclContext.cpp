@@ -229,6 +229,10 @@ CFG *AnalysisDeclContext::getCFG() {
 }
 
 CFG *AnalysisDeclContext::getUnoptimizedCFG() {
+  // A pruned CFG that did not fold any condition is complete as it is.
+  if (!builtCompleteCFG && builtCFG && cfg && !cfg->mayHavePrunedEdges())
+    return cfg.get();
+
   if (!builtCompleteCFG) {
     SaveAndRestore<bool> NotPrune(cfgBuildOptions.PruneTriviallyFalseEdges,
                                   false);
@@ -0,0 +1,49 @@
+//===- BitVectorDataflow.cpp - Dense dataflow analyses over a CFG ---------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the worklist used by dataflow analyses over
+// source-level CFGs.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Analysis/FlowSensitive/BitVectorDataflow.h"
+
+using namespace clang;
+
+DataflowWorklist::DataflowWorklist(const CFG &Cfg, const PostOrderCFGView &POV,
+                                   DataflowDirection Direction)
+    : EnqueuedBlocks(Cfg.getNumBlockIDs()), Direction(Direction),
+      WorkList(BlockOrderCompare{POV.getComparator(),
+                                 Direction == DataflowDirection::Forward}) {}
+
+void DataflowWorklist::enqueueBlock(const CFGBlock *Block) {
+  if (Block && !EnqueuedBlocks[Block->getBlockID()]) {
+    EnqueuedBlocks[Block->getBlockID()] = true;
+    WorkList.push(Block);
+  }
+}
+
+void DataflowWorklist::enqueueDependents(const CFGBlock *Block) {
+  if (Direction == DataflowDirection::Forward) {
+    for (const CFGBlock *Succ : Block->succs())
+      enqueueBlock(Succ);
+  } else {
+    for (const CFGBlock *Pred : Block->preds())
+      enqueueBlock(Pred);
+  }
+}
+
+const CFGBlock *DataflowWorklist::dequeue() {
+  if (WorkList.empty())
+    return nullptr;
+  const CFGBlock *Block = WorkList.top();
+  WorkList.pop();
+  EnqueuedBlocks[Block->getBlockID()] = false;
+  return Block;
+}
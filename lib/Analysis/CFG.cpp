@@ -1103,14 +1103,25 @@ private:
   bool tryEvaluate(Expr *S, Expr::EvalResult &outResult) {
     if (!BuildOpts.PruneTriviallyFalseEdges)
       return false;
-    return !S->isTypeDependent() &&
-           !S->isValueDependent() &&
-           S->EvaluateAsRValue(outResult, *Context);
+    if (S->isTypeDependent() || S->isValueDependent() ||
+        !S->EvaluateAsRValue(outResult, *Context))
+      return false;
+    cfg->setMayHavePrunedEdges();
+    return true;
   }
 
   /// tryEvaluateBool - Try and evaluate the Stmt and return 0 or 1
   /// if we can evaluate to a known value, otherwise return -1.
   TryResult tryEvaluateBool(Expr *S) {
+    TryResult Result = tryEvaluateBoolNoRecord(S);
+    if (Result.isKnown())
+      cfg->setMayHavePrunedEdges();
+    return Result;
+  }
+
+  /// Like tryEvaluateBool, but does not note in the CFG that a known value
+  /// may have been used to prune edges.
+  TryResult tryEvaluateBoolNoRecord(Expr *S) {
     if (!BuildOpts.PruneTriviallyFalseEdges ||
         S->isTypeDependent() || S->isValueDependent())
       return {};
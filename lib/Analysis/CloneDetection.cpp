@@ -15,8 +15,12 @@
 
 #include "clang/AST/DataCollection.h"
 #include "clang/AST/DeclTemplate.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/MD5.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include <numeric>
 
 using namespace clang;
 
@@ -421,6 +425,175 @@ void RecursiveCloneTypeIIVerifyConstraint::constrain(
       });
 }
 
+/// Computes the hash of the subtree of \p S, like saveHash, and adds the hash
+/// of each statement subtree in it to \p SubtreeHashes.
+static uint64_t
+collectSubtreeHashes(const Stmt *S, ASTContext &Context,
+                     std::vector<uint64_t> &SubtreeHashes) {
+  llvm::MD5 Hash;
+  CloneTypeIIStmtDataCollector<llvm::MD5>(S, Context, Hash);
+  for (const Stmt *Child : S->children()) {
+    uint64_t ChildHash =
+        Child ? collectSubtreeHashes(Child, Context, SubtreeHashes) : 0;
+    Hash.update(
+        StringRef(reinterpret_cast<char *>(&ChildHash), sizeof(ChildHash)));
+  }
+
+  llvm::MD5::MD5Result HashResult;
+  Hash.final(HashResult);
+  uint64_t HashCode = HashResult.low();
+  SubtreeHashes.push_back(HashCode);
+  return HashCode;
+}
+
+/// Mixes the bits of \p X, so that the I-th hash function of a signature can
+/// be computed as this mix of X offset by I.
+static uint64_t mixHash(uint64_t X) {
+  X ^= X >> 30;
+  X *= 0xbf58476d1ce4e5b9ULL;
+  X ^= X >> 27;
+  X *= 0x94d049bb133111ebULL;
+  X ^= X >> 31;
+  return X;
+}
+
+CloneFingerprint::CloneFingerprint(const StmtSequence &Seq,
+                                   unsigned NumHashes) {
+  ASTContext &Context = Seq.getASTContext();
+  const SourceManager &SM = Context.getSourceManager();
+  SourceLocation Begin = SM.getExpansionLoc(Seq.getBeginLoc());
+  SourceLocation End = SM.getExpansionLoc(Seq.getEndLoc());
+  Filename = SM.getFilename(Begin);
+  BeginLine = SM.getExpansionLineNumber(Begin);
+  EndLine = SM.getExpansionLineNumber(End);
+
+  std::vector<uint64_t> SubtreeHashes;
+  for (const Stmt *S : Seq)
+    collectSubtreeHashes(S, Context, SubtreeHashes);
+
+  Signature.assign(NumHashes, UINT64_MAX);
+  for (uint64_t SubtreeHash : SubtreeHashes)
+    for (unsigned I = 0; I != NumHashes; ++I)
+      Signature[I] =
+          std::min(Signature[I],
+                   mixHash(SubtreeHash + I * 0x9e3779b97f4a7c15ULL));
+}
+
+double
+CloneFingerprint::estimateSimilarity(const CloneFingerprint &Other) const {
+  assert(Signature.size() == Other.Signature.size() &&
+         "Comparing signatures of different lengths");
+  if (Signature.empty())
+    return 0;
+  unsigned Equal = 0;
+  for (unsigned I = 0, E = Signature.size(); I != E; ++I)
+    if (Signature[I] == Other.Signature[I])
+      ++Equal;
+  return double(Equal) / Signature.size();
+}
+
+void CloneFingerprint::print(raw_ostream &OS) const {
+  OS << Signature.size();
+  for (uint64_t Entry : Signature)
+    OS << ' ' << llvm::format_hex_no_prefix(Entry, 16);
+  OS << ' ' << BeginLine << ' ' << EndLine << ' ' << Filename;
+}
+
+bool CloneFingerprint::parse(StringRef Line, CloneFingerprint &Result) {
+  auto ConsumeField = [&Line]() {
+    std::pair<StringRef, StringRef> Split = Line.split(' ');
+    Line = Split.second;
+    return Split.first;
+  };
+
+  unsigned NumHashes;
+  if (ConsumeField().getAsInteger(10, NumHashes))
+    return false;
+  Result.Signature.resize(NumHashes);
+  for (uint64_t &Entry : Result.Signature)
+    if (ConsumeField().getAsInteger(16, Entry))
+      return false;
+  if (ConsumeField().getAsInteger(10, Result.BeginLine) ||
+      ConsumeField().getAsInteger(10, Result.EndLine) || Line.empty())
+    return false;
+  Result.Filename = Line;
+  return true;
+}
+
+void MinHashCloneConstraint::constrain(
+    std::vector<CloneDetector::CloneGroup> &CloneGroups) {
+  std::vector<CloneDetector::CloneGroup> Result;
+
+  for (const CloneDetector::CloneGroup &Group : CloneGroups) {
+    std::vector<CloneFingerprint> Fingerprints;
+    Fingerprints.reserve(Group.size());
+    for (const StmtSequence &Seq : Group)
+      Fingerprints.emplace_back(Seq, NumHashes);
+
+    for (const std::vector<unsigned> &Similar : groupSimilar(Fingerprints)) {
+      CloneDetector::CloneGroup NewGroup;
+      for (unsigned Index : Similar)
+        NewGroup.push_back(Group[Index]);
+      Result.push_back(std::move(NewGroup));
+    }
+  }
+
+  CloneGroups = std::move(Result);
+}
+
+std::vector<std::vector<unsigned>> MinHashCloneConstraint::groupSimilar(
+    ArrayRef<CloneFingerprint> Fingerprints) const {
+  // Groups are built as a union-find forest over the fingerprint indices,
+  // whose root is always the smallest index in the group.
+  std::vector<unsigned> Parents(Fingerprints.size());
+  std::iota(Parents.begin(), Parents.end(), 0);
+  auto FindRoot = [&Parents](unsigned I) {
+    while (Parents[I] != I)
+      I = Parents[I] = Parents[Parents[I]];
+    return I;
+  };
+
+  for (unsigned Band = 0; Band != NumHashes / RowsPerBand; ++Band) {
+    // Bucket the fingerprints by the entries in this band. The first
+    // fingerprint in a bucket is compared with the others in it, which keeps
+    // the work linear even when a bucket is large; similar fingerprints that
+    // miss each other in one band are likely to meet in another.
+    llvm::DenseMap<uint64_t, unsigned> FirstInBucket;
+    for (unsigned I = 0, E = Fingerprints.size(); I != E; ++I) {
+      ArrayRef<uint64_t> Signature = Fingerprints[I].Signature;
+      assert(Signature.size() == NumHashes &&
+             "Fingerprint computed with a different number of hashes");
+      uint64_t Key = Band;
+      for (uint64_t Entry : Signature.slice(Band * RowsPerBand, RowsPerBand))
+        Key = mixHash(Key ^ Entry);
+
+      auto Inserted = FirstInBucket.insert(std::make_pair(Key, I));
+      if (Inserted.second)
+        continue;
+      unsigned First = Inserted.first->second;
+      unsigned FirstRoot = FindRoot(First), Root = FindRoot(I);
+      if (FirstRoot == Root ||
+          Fingerprints[First].estimateSimilarity(Fingerprints[I]) <
+              MinSimilarity)
+        continue;
+      Parents[std::max(FirstRoot, Root)] = std::min(FirstRoot, Root);
+    }
+  }
+
+  std::vector<std::vector<unsigned>> Groups;
+  llvm::DenseMap<unsigned, unsigned> GroupOfRoot;
+  for (unsigned I = 0, E = Fingerprints.size(); I != E; ++I) {
+    unsigned Root = FindRoot(I);
+    if (Root == I)
+      continue;
+    auto Inserted = GroupOfRoot.insert(std::make_pair(Root, Groups.size()));
+    if (Inserted.second)
+      Groups.push_back({Root});
+    Groups[Inserted.first->second].push_back(I);
+  }
+  return Groups;
+}
+
 size_t MinComplexityConstraint::calculateStmtComplexity(
     const StmtSequence &Seq, std::size_t Limit,
     const std::string &ParentMacroStack) {
@@ -11,4 +11,26 @@
 
 using namespace clang;
 
-void DominatorTree::anchor() {}
+template <bool IsPostDom>
+void CFGDominatorTreeImpl<IsPostDom>::anchor() {}
+
+template <bool IsPostDom>
+const void *CFGDominatorTreeImpl<IsPostDom>::getTag() {
+  static int x;
+  return &x;
+}
+
+template <bool IsPostDom>
+CFGDominatorTreeImpl<IsPostDom> *
+CFGDominatorTreeImpl<IsPostDom>::create(AnalysisDeclContext &AC) {
+  if (!AC.getCFG())
+    return nullptr;
+  auto *Tree = new CFGDominatorTreeImpl();
+  Tree->buildDominatorTree(AC);
+  return Tree;
+}
+
+namespace clang {
+template class CFGDominatorTreeImpl</*IsPostDom=*/false>;
+template class CFGDominatorTreeImpl</*IsPostDom=*/true>;
+} // namespace clang
@@ -15,10 +15,6 @@ using namespace ast_matchers;
 
 namespace {
 
-AST_MATCHER_P(LambdaExpr, hasCaptureInit, const Expr *, E) {
-  return llvm::is_contained(Node.capture_inits(), E);
-}
-
 AST_MATCHER_P(CXXForRangeStmt, hasRangeStmt,
               ast_matchers::internal::Matcher<DeclStmt>, InnerMatcher) {
   const DeclStmt *const Range = Node.getRangeStmt();
@@ -64,23 +60,26 @@ const auto isMoveOnly = [] {
                                            unless(isDeleted()))))));
 };
 
-template <class T> struct NodeID;
-template <> struct NodeID<Expr> { static const std::string value; };
-template <> struct NodeID<Decl> { static const std::string value; };
-const std::string NodeID<Expr>::value = "expr";
-const std::string NodeID<Decl>::value = "decl";
-
 template <class T, class F = const Stmt *(ExprMutationAnalyzer::*)(const T *)>
-const Stmt *tryEachMatch(ArrayRef<ast_matchers::BoundNodes> Matches,
-                         ExprMutationAnalyzer *Analyzer, F Finder) {
-  const StringRef ID = NodeID<T>::value;
-  for (const auto &Nodes : Matches) {
-    if (const Stmt *S = (Analyzer->*Finder)(Nodes.getNodeAs<T>(ID)))
+const Stmt *tryEach(ArrayRef<const T *> Nodes, ExprMutationAnalyzer *Analyzer,
+                    F Finder) {
+  for (const T *Node : Nodes) {
+    if (const Stmt *S = (Analyzer->*Finder)(Node))
       return S;
   }
   return nullptr;
 }
 
+template <class T>
+ArrayRef<T>
+lookupSites(const llvm::DenseMap<const Expr *, llvm::SmallVector<T, 1>> &Map,
+            const Expr *Exp) {
+  const auto It = Map.find(Exp);
+  if (It == Map.end())
+    return None;
+  return It->second;
+}
+
 } // namespace
 
 const Stmt *ExprMutationAnalyzer::findMutation(const Expr *Exp) {
@@ -127,11 +126,11 @@ const Stmt *ExprMutationAnalyzer::findMutationMemoized(
 
 const Stmt *ExprMutationAnalyzer::tryEachDeclRef(const Decl *Dec,
                                                  MutationFinder Finder) {
-  const auto Refs =
-      match(findAll(declRefExpr(to(equalsNode(Dec))).bind(NodeID<Expr>::value)),
-            Stm, Context);
-  for (const auto &RefNodes : Refs) {
-    const auto *E = RefNodes.getNodeAs<Expr>(NodeID<Expr>::value);
+  const auto &DeclRefs = getSites().DeclRefs;
+  const auto Refs = DeclRefs.find(Dec);
+  if (Refs == DeclRefs.end())
+    return nullptr;
+  for (const Expr *E : Refs->second) {
     if ((this->*Finder)(E))
       return E;
   }
@@ -139,79 +138,58 @@ const Stmt *ExprMutationAnalyzer::tryEachDeclRef(const Decl *Dec,
 }
 
 bool ExprMutationAnalyzer::isUnevaluated(const Expr *Exp) {
-  return selectFirst<Expr>(
-             NodeID<Expr>::value,
-             match(
-                 findAll(
-                     expr(equalsNode(Exp),
-                          anyOf(
-                              // `Exp` is part of the underlying expression of
-                              // decltype/typeof if it has an ancestor of
-                              // typeLoc.
-                              hasAncestor(typeLoc(unless(
-                                  hasAncestor(unaryExprOrTypeTraitExpr())))),
-                              hasAncestor(expr(anyOf(
-                                  // `UnaryExprOrTypeTraitExpr` is unevaluated
-                                  // unless it's sizeof on VLA.
-                                  unaryExprOrTypeTraitExpr(unless(sizeOfExpr(
-                                      hasArgumentOfType(variableArrayType())))),
-                                  // `CXXTypeidExpr` is unevaluated unless it's
-                                  // applied to an expression of glvalue of
-                                  // polymorphic class type.
-                                  cxxTypeidExpr(
-                                      unless(isPotentiallyEvaluated())),
-                                  // The controlling expression of
-                                  // `GenericSelectionExpr` is unevaluated.
-                                  genericSelectionExpr(hasControllingExpr(
-                                      hasDescendant(equalsNode(Exp)))),
-                                  cxxNoexceptExpr())))))
-                         .bind(NodeID<Expr>::value)),
-                 Stm, Context)) != nullptr;
+  // Only the ancestors of `Exp` matter, so match `Exp` itself rather than
+  // searching `Stm` for it.
+  return !match(
+              expr(anyOf(
+                  // `Exp` is part of the underlying expression of
+                  // decltype/typeof if it has an ancestor of typeLoc.
+                  hasAncestor(
+                      typeLoc(unless(hasAncestor(unaryExprOrTypeTraitExpr())))),
+                  hasAncestor(expr(anyOf(
+                      // `UnaryExprOrTypeTraitExpr` is unevaluated unless it's
+                      // sizeof on VLA.
+                      unaryExprOrTypeTraitExpr(unless(sizeOfExpr(
+                          hasArgumentOfType(variableArrayType())))),
+                      // `CXXTypeidExpr` is unevaluated unless it's applied to
+                      // an expression of glvalue of polymorphic class type.
+                      cxxTypeidExpr(unless(isPotentiallyEvaluated())),
+                      // The controlling expression of `GenericSelectionExpr`
+                      // is unevaluated.
+                      genericSelectionExpr(hasControllingExpr(
+                          hasDescendant(equalsNode(Exp)))),
+                      cxxNoexceptExpr()))))),
+              *Exp, Context)
+              .empty();
 }
 
-const Stmt *
-ExprMutationAnalyzer::findExprMutation(ArrayRef<BoundNodes> Matches) {
-  return tryEachMatch<Expr>(Matches, this, &ExprMutationAnalyzer::findMutation);
-}
+const ExprMutationAnalyzer::SiteIndex &ExprMutationAnalyzer::getSites() {
+  if (Sites)
+    return *Sites;
+  Sites = llvm::make_unique<SiteIndex>();
 
-const Stmt *
-ExprMutationAnalyzer::findDeclMutation(ArrayRef<BoundNodes> Matches) {
-  return tryEachMatch<Decl>(Matches, this, &ExprMutationAnalyzer::findMutation);
-}
+  // Each site binds the expression it could mutate as "operand", and itself
+  // under the name of the list it belongs to.
+  const auto Operand = expr().bind("operand");
 
-const Stmt *ExprMutationAnalyzer::findExprPointeeMutation(
-    ArrayRef<ast_matchers::BoundNodes> Matches) {
-  return tryEachMatch<Expr>(Matches, this,
-                            &ExprMutationAnalyzer::findPointeeMutation);
-}
-
-const Stmt *ExprMutationAnalyzer::findDeclPointeeMutation(
-    ArrayRef<ast_matchers::BoundNodes> Matches) {
-  return tryEachMatch<Decl>(Matches, this,
-                            &ExprMutationAnalyzer::findPointeeMutation);
-}
-
-const Stmt *ExprMutationAnalyzer::findDirectMutation(const Expr *Exp) {
   // LHS of any assignment operators.
   const auto AsAssignmentLhs =
-      binaryOperator(isAssignmentOperator(), hasLHS(equalsNode(Exp)));
+      binaryOperator(isAssignmentOperator(), hasLHS(Operand));
 
   // Operand of increment/decrement operators.
   const auto AsIncDecOperand =
       unaryOperator(anyOf(hasOperatorName("++"), hasOperatorName("--")),
-                    hasUnaryOperand(equalsNode(Exp)));
+                    hasUnaryOperand(Operand));
 
   // Invoking non-const member function.
   // A member function is assumed to be non-const when it is unresolved.
   const auto NonConstMethod = cxxMethodDecl(unless(isConst()));
-  const auto AsNonConstThis =
-      expr(anyOf(cxxMemberCallExpr(callee(NonConstMethod), on(equalsNode(Exp))),
-                 cxxOperatorCallExpr(callee(NonConstMethod),
-                                     hasArgument(0, equalsNode(Exp))),
-                 callExpr(callee(expr(anyOf(
-                     unresolvedMemberExpr(hasObjectExpression(equalsNode(Exp))),
-                     cxxDependentScopeMemberExpr(
-                         hasObjectExpression(equalsNode(Exp)))))))));
+  const auto AsNonConstThis = expr(eachOf(
+      cxxMemberCallExpr(callee(NonConstMethod), on(Operand)),
+      cxxOperatorCallExpr(callee(NonConstMethod), hasArgument(0, Operand)),
+      callExpr(callee(expr(
+          anyOf(unresolvedMemberExpr(hasObjectExpression(Operand)),
+                cxxDependentScopeMemberExpr(hasObjectExpression(Operand))))))));
 
   // Taking address of 'Exp'.
   // We're assuming 'Exp' is mutated as soon as its address is taken, though in
@@ -221,10 +199,10 @@ const Stmt *ExprMutationAnalyzer::findDirectMutation(const Expr *Exp) {
       unaryOperator(hasOperatorName("&"),
                     // A NoOp implicit cast is adding const.
                     unless(hasParent(implicitCastExpr(hasCastKind(CK_NoOp)))),
-                    hasUnaryOperand(equalsNode(Exp)));
+                    hasUnaryOperand(Operand));
   const auto AsPointerFromArrayDecay =
       castExpr(hasCastKind(CK_ArrayToPointerDecay),
-               unless(hasParent(arraySubscriptExpr())), has(equalsNode(Exp)));
+               unless(hasParent(arraySubscriptExpr())), has(Operand));
   // Treat calling `operator->()` of move-only classes as taking address.
   // These are typically smart pointers with unique ownership so we treat
   // mutation of pointee as mutation of the smart pointer itself.
@@ -232,7 +210,7 @@ const Stmt *ExprMutationAnalyzer::findDirectMutation(const Expr *Exp) {
       cxxOperatorCallExpr(hasOverloadedOperatorName("->"),
                           callee(cxxMethodDecl(ofClass(isMoveOnly()),
                                                returns(nonConstPointerType()))),
-                          argumentCountIs(1), hasArgument(0, equalsNode(Exp)));
+                          argumentCountIs(1), hasArgument(0, Operand));
 
   // Used as non-const-ref argument when calling a function.
   // An argument is assumed to be non-const-ref when the function is unresolved.
@@ -240,149 +218,214 @@ const Stmt *ExprMutationAnalyzer::findDirectMutation(const Expr *Exp) {
   // findFunctionArgMutation which has additional smarts for handling forwarding
   // references.
   const auto NonConstRefParam = forEachArgumentWithParam(
-      equalsNode(Exp), parmVarDecl(hasType(nonConstReferenceType())));
+      Operand, parmVarDecl(hasType(nonConstReferenceType())));
   const auto NotInstantiated = unless(hasDeclaration(isInstantiated()));
-  const auto AsNonConstRefArg = anyOf(
-      callExpr(NonConstRefParam, NotInstantiated),
-      cxxConstructExpr(NonConstRefParam, NotInstantiated),
-      callExpr(callee(expr(anyOf(unresolvedLookupExpr(), unresolvedMemberExpr(),
-                                 cxxDependentScopeMemberExpr(),
-                                 hasType(templateTypeParmType())))),
-               hasAnyArgument(equalsNode(Exp))),
-      cxxUnresolvedConstructExpr(hasAnyArgument(equalsNode(Exp))));
+  const auto AsNonConstRefArg =
+      expr(eachOf(callExpr(NonConstRefParam, NotInstantiated),
+                  cxxConstructExpr(NonConstRefParam, NotInstantiated)));
+  // Every argument of these is a site; they are added below.
+  const auto WithUnresolvedArgs =
+      expr(anyOf(callExpr(callee(expr(anyOf(
+                     unresolvedLookupExpr(), unresolvedMemberExpr(),
+                     cxxDependentScopeMemberExpr(),
+                     hasType(templateTypeParmType()))))),
+                 cxxUnresolvedConstructExpr()));
 
   // Captured by a lambda by reference.
   // If we're initializing a capture with 'Exp' directly then we're initializing
   // a reference capture.
   // For value captures there will be an ImplicitCastExpr <LValueToRValue>.
-  const auto AsLambdaRefCaptureInit = lambdaExpr(hasCaptureInit(Exp));
+  // Every capture init is a site; they are added below.
 
   // Returned as non-const-ref.
   // If we're returning 'Exp' directly then it's returned as non-const-ref.
   // For returning by value there will be an ImplicitCastExpr <LValueToRValue>.
   // For returning by const-ref there will be an ImplicitCastExpr <NoOp> (for
   // adding const.)
-  const auto AsNonConstRefReturn = returnStmt(hasReturnValue(equalsNode(Exp)));
-
-  const auto Matches =
-      match(findAll(stmt(anyOf(AsAssignmentLhs, AsIncDecOperand, AsNonConstThis,
-                               AsAmpersandOperand, AsPointerFromArrayDecay,
-                               AsOperatorArrowThis, AsNonConstRefArg,
-                               AsLambdaRefCaptureInit, AsNonConstRefReturn))
-                        .bind("stmt")),
-            Stm, Context);
-  return selectFirst<Stmt>("stmt", Matches);
-}
+  const auto AsNonConstRefReturn = returnStmt(hasReturnValue(Operand));
 
-const Stmt *ExprMutationAnalyzer::findMemberMutation(const Expr *Exp) {
   // Check whether any member of 'Exp' is mutated.
-  const auto MemberExprs =
-      match(findAll(expr(anyOf(memberExpr(hasObjectExpression(equalsNode(Exp))),
-                               cxxDependentScopeMemberExpr(
-                                   hasObjectExpression(equalsNode(Exp)))))
-                        .bind(NodeID<Expr>::value)),
-            Stm, Context);
-  return findExprMutation(MemberExprs);
-}
+  const auto AsMemberBase =
+      expr(anyOf(memberExpr(hasObjectExpression(Operand)),
+                 cxxDependentScopeMemberExpr(hasObjectExpression(Operand))));
 
-const Stmt *ExprMutationAnalyzer::findArrayElementMutation(const Expr *Exp) {
   // Check whether any element of an array is mutated.
-  const auto SubscriptExprs = match(
-      findAll(arraySubscriptExpr(hasBase(ignoringImpCasts(equalsNode(Exp))))
-                  .bind(NodeID<Expr>::value)),
-      Stm, Context);
-  return findExprMutation(SubscriptExprs);
-}
+  const auto AsSubscriptBase =
+      arraySubscriptExpr(hasBase(ignoringImpCasts(Operand)));
 
-const Stmt *ExprMutationAnalyzer::findCastMutation(const Expr *Exp) {
   // If 'Exp' is casted to any non-const reference type, check the castExpr.
-  const auto Casts =
-      match(findAll(castExpr(hasSourceExpression(equalsNode(Exp)),
-                             anyOf(explicitCastExpr(hasDestinationType(
-                                       nonConstReferenceType())),
-                                   implicitCastExpr(hasImplicitDestinationType(
-                                       nonConstReferenceType()))))
-                        .bind(NodeID<Expr>::value)),
-            Stm, Context);
-  if (const Stmt *S = findExprMutation(Casts))
-    return S;
+  const auto AsNonConstRefCastSource = castExpr(
+      hasSourceExpression(Operand),
+      anyOf(explicitCastExpr(hasDestinationType(nonConstReferenceType())),
+            implicitCastExpr(
+                hasImplicitDestinationType(nonConstReferenceType()))));
   // Treat std::{move,forward} as cast.
-  const auto Calls =
-      match(findAll(callExpr(callee(namedDecl(
-                                 hasAnyName("::std::move", "::std::forward"))),
-                             hasArgument(0, equalsNode(Exp)))
-                        .bind("expr")),
-            Stm, Context);
-  return findExprMutation(Calls);
-}
+  const auto AsMoveArg =
+      callExpr(callee(namedDecl(hasAnyName("::std::move", "::std::forward"))),
+               hasArgument(0, Operand));
 
-const Stmt *ExprMutationAnalyzer::findRangeLoopMutation(const Expr *Exp) {
   // If range for looping over 'Exp' with a non-const reference loop variable,
   // check all declRefExpr of the loop variable.
-  const auto LoopVars =
-      match(findAll(cxxForRangeStmt(
-                hasLoopVariable(varDecl(hasType(nonConstReferenceType()))
-                                    .bind(NodeID<Decl>::value)),
-                hasRangeInit(equalsNode(Exp)))),
-            Stm, Context);
-  return findDeclMutation(LoopVars);
-}
+  const auto AsNonConstRefRange = cxxForRangeStmt(
+      hasLoopVariable(
+          varDecl(hasType(nonConstReferenceType())).bind("loop-var")),
+      hasRangeInit(Operand));
 
-const Stmt *ExprMutationAnalyzer::findReferenceMutation(const Expr *Exp) {
   // Follow non-const reference returned by `operator*()` of move-only classes.
   // These are typically smart pointers with unique ownership so we treat
   // mutation of pointee as mutation of the smart pointer itself.
-  const auto Ref =
-      match(findAll(cxxOperatorCallExpr(
-                        hasOverloadedOperatorName("*"),
-                        callee(cxxMethodDecl(ofClass(isMoveOnly()),
-                                             returns(nonConstReferenceType()))),
-                        argumentCountIs(1), hasArgument(0, equalsNode(Exp)))
-                        .bind(NodeID<Expr>::value)),
-            Stm, Context);
-  if (const Stmt *S = findExprMutation(Ref))
-    return S;
+  const auto AsOperatorStarThis =
+      cxxOperatorCallExpr(hasOverloadedOperatorName("*"),
+                          callee(cxxMethodDecl(ofClass(isMoveOnly()),
+                                               returns(nonConstReferenceType()))),
+                          argumentCountIs(1), hasArgument(0, Operand));
 
   // If 'Exp' is bound to a non-const reference, check all declRefExpr to that.
-  const auto Refs = match(
-      stmt(forEachDescendant(
-          varDecl(
-              hasType(nonConstReferenceType()),
-              hasInitializer(anyOf(equalsNode(Exp),
-                                   conditionalOperator(anyOf(
-                                       hasTrueExpression(equalsNode(Exp)),
-                                       hasFalseExpression(equalsNode(Exp)))))),
+  const auto AsNonConstRefInit =
+      varDecl(hasType(nonConstReferenceType()),
+              hasInitializer(expr(eachOf(
+                  Operand, conditionalOperator(eachOf(
+                               hasTrueExpression(Operand),
+                               hasFalseExpression(Operand)))))),
               hasParent(declStmt().bind("stmt")),
               // Don't follow the reference in range statement, we've handled
               // that separately.
               unless(hasParent(declStmt(hasParent(
-                  cxxForRangeStmt(hasRangeStmt(equalsBoundNode("stmt"))))))))
-              .bind(NodeID<Decl>::value))),
-      Stm, Context);
-  return findDeclMutation(Refs);
-}
+                  cxxForRangeStmt(hasRangeStmt(equalsBoundNode("stmt"))))))));
 
-const Stmt *ExprMutationAnalyzer::findFunctionArgMutation(const Expr *Exp) {
-  const auto NonConstRefParam = forEachArgumentWithParam(
-      equalsNode(Exp),
-      parmVarDecl(hasType(nonConstReferenceType())).bind("parm"));
+  // Instantiated template functions, whose arguments may be forwarding
+  // references.
+  const auto InstantiatedNonConstRefParam = forEachArgumentWithParam(
+      Operand, parmVarDecl(hasType(nonConstReferenceType())).bind("parm"));
   const auto IsInstantiated = hasDeclaration(isInstantiated());
   const auto FuncDecl = hasDeclaration(functionDecl().bind("func"));
+  const auto AsInstantiatedArg = expr(eachOf(
+      callExpr(InstantiatedNonConstRefParam, IsInstantiated, FuncDecl,
+               unless(callee(
+                   namedDecl(hasAnyName("::std::move", "::std::forward"))))),
+      cxxConstructExpr(InstantiatedNonConstRefParam, IsInstantiated,
+                       FuncDecl)));
+
   const auto Matches = match(
-      findAll(expr(anyOf(callExpr(NonConstRefParam, IsInstantiated, FuncDecl,
-                                  unless(callee(namedDecl(hasAnyName(
-                                      "::std::move", "::std::forward"))))),
-                         cxxConstructExpr(NonConstRefParam, IsInstantiated,
-                                          FuncDecl)))
-                  .bind(NodeID<Expr>::value)),
+      stmt(eachOf(
+          findAll(stmt(eachOf(
+              declRefExpr().bind("decl-ref"),
+              stmt(eachOf(AsAssignmentLhs, AsIncDecOperand, AsNonConstThis,
+                          AsAmpersandOperand, AsPointerFromArrayDecay,
+                          AsOperatorArrowThis, AsNonConstRefArg,
+                          AsNonConstRefReturn))
+                  .bind("direct"),
+              WithUnresolvedArgs.bind("args"), lambdaExpr().bind("lambda"),
+              AsMemberBase.bind("member"), AsSubscriptBase.bind("subscript"),
+              AsNonConstRefCastSource.bind("cast"), AsMoveArg.bind("move"),
+              AsNonConstRefRange.bind("range"),
+              AsOperatorStarThis.bind("deref"),
+              AsInstantiatedArg.bind("call")))),
+          forEachDescendant(AsNonConstRefInit.bind("ref-var")))),
       Stm, Context);
-  for (const auto &Nodes : Matches) {
-    const auto *Exp = Nodes.getNodeAs<Expr>(NodeID<Expr>::value);
-    const auto *Func = Nodes.getNodeAs<FunctionDecl>("func");
+
+  SiteIndex &S = *Sites;
+  for (const BoundNodes &Nodes : Matches) {
+    if (const auto *Ref = Nodes.getNodeAs<DeclRefExpr>("decl-ref")) {
+      S.DeclRefs[Ref->getDecl()].push_back(Ref);
+      continue;
+    }
+    if (const auto *Call = Nodes.getNodeAs<CallExpr>("args")) {
+      for (const Expr *Arg : Call->arguments())
+        S.Direct[Arg].push_back(Call);
+      continue;
+    }
+    if (const auto *Construct =
+            Nodes.getNodeAs<CXXUnresolvedConstructExpr>("args")) {
+      for (const Expr *Arg : Construct->arguments())
+        S.Direct[Arg].push_back(Construct);
+      continue;
+    }
+    if (const auto *Lambda = Nodes.getNodeAs<LambdaExpr>("lambda")) {
+      for (const Expr *Init : Lambda->capture_inits())
+        if (Init)
+          S.Direct[Init].push_back(Lambda);
+      continue;
+    }
+
+    const auto *Op = Nodes.getNodeAs<Expr>("operand");
+    if (const auto *Site = Nodes.getNodeAs<Stmt>("direct"))
+      S.Direct[Op].push_back(Site);
+    else if (const auto *Site = Nodes.getNodeAs<Expr>("member"))
+      S.Members[Op].push_back(Site);
+    else if (const auto *Site = Nodes.getNodeAs<Expr>("subscript"))
+      S.Subscripts[Op].push_back(Site);
+    else if (const auto *Site = Nodes.getNodeAs<Expr>("cast"))
+      S.Casts[Op].push_back(Site);
+    else if (const auto *Site = Nodes.getNodeAs<Expr>("move"))
+      S.Moves[Op].push_back(Site);
+    else if (Nodes.getNodeAs<Stmt>("range"))
+      S.LoopVars[Op].push_back(Nodes.getNodeAs<Decl>("loop-var"));
+    else if (const auto *Site = Nodes.getNodeAs<Expr>("deref"))
+      S.Derefs[Op].push_back(Site);
+    else if (const auto *Site = Nodes.getNodeAs<Decl>("ref-var"))
+      S.RefVars[Op].push_back(Site);
+    else if (const auto *Site = Nodes.getNodeAs<Expr>("call"))
+      S.Args[Op].push_back({Site, Nodes.getNodeAs<FunctionDecl>("func"),
+                            Nodes.getNodeAs<ParmVarDecl>("parm")});
+  }
+  return S;
+}
+
+const Stmt *ExprMutationAnalyzer::findExprMutation(ArrayRef<const Expr *> Exps) {
+  return tryEach<Expr>(Exps, this, &ExprMutationAnalyzer::findMutation);
+}
+
+const Stmt *ExprMutationAnalyzer::findDeclMutation(ArrayRef<const Decl *> Decs) {
+  return tryEach<Decl>(Decs, this, &ExprMutationAnalyzer::findMutation);
+}
+
+const Stmt *
+ExprMutationAnalyzer::findExprPointeeMutation(ArrayRef<const Expr *> Exps) {
+  return tryEach<Expr>(Exps, this, &ExprMutationAnalyzer::findPointeeMutation);
+}
+
+const Stmt *
+ExprMutationAnalyzer::findDeclPointeeMutation(ArrayRef<const Decl *> Decs) {
+  return tryEach<Decl>(Decs, this, &ExprMutationAnalyzer::findPointeeMutation);
+}
+
+const Stmt *ExprMutationAnalyzer::findDirectMutation(const Expr *Exp) {
+  const ArrayRef<const Stmt *> Sites = lookupSites(getSites().Direct, Exp);
+  return Sites.empty() ? nullptr : Sites.front();
+}
+
+const Stmt *ExprMutationAnalyzer::findMemberMutation(const Expr *Exp) {
+  return findExprMutation(lookupSites(getSites().Members, Exp));
+}
+
+const Stmt *ExprMutationAnalyzer::findArrayElementMutation(const Expr *Exp) {
+  return findExprMutation(lookupSites(getSites().Subscripts, Exp));
+}
+
+const Stmt *ExprMutationAnalyzer::findCastMutation(const Expr *Exp) {
+  if (const Stmt *S = findExprMutation(lookupSites(getSites().Casts, Exp)))
+    return S;
+  return findExprMutation(lookupSites(getSites().Moves, Exp));
+}
+
+const Stmt *ExprMutationAnalyzer::findRangeLoopMutation(const Expr *Exp) {
+  return findDeclMutation(lookupSites(getSites().LoopVars, Exp));
+}
+
+const Stmt *ExprMutationAnalyzer::findReferenceMutation(const Expr *Exp) {
+  if (const Stmt *S = findExprMutation(lookupSites(getSites().Derefs, Exp)))
+    return S;
+  return findDeclMutation(lookupSites(getSites().RefVars, Exp));
+}
+
+const Stmt *ExprMutationAnalyzer::findFunctionArgMutation(const Expr *Exp) {
+  for (const SiteIndex::ArgSite &Site : lookupSites(getSites().Args, Exp)) {
+    const auto *Func = Site.Func;
     if (!Func->getBody() || !Func->getPrimaryTemplate())
-      return Exp;
+      return Site.Call;
 
-    const auto *Parm = Nodes.getNodeAs<ParmVarDecl>("parm");
+    const auto *Parm = Site.Parm;
     const ArrayRef<ParmVarDecl *> AllParams =
         Func->getPrimaryTemplate()->getTemplatedDecl()->parameters();
     QualType ParmType =
@@ -402,12 +445,12 @@ const Stmt *ExprMutationAnalyzer::findFunctionArgMutation(const Expr *Exp) {
         if (!Analyzer)
           Analyzer.reset(new FunctionParmMutationAnalyzer(*Func, Context));
         if (Analyzer->findMutation(Parm))
-          return Exp;
+          return Site.Call;
         continue;
       }
     }
     // Not forwarding reference.
-    return Exp;
+    return Site.Call;
   }
   return nullptr;
 }
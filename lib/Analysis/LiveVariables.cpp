@@ -17,89 +17,104 @@
 #include "clang/Analysis/Analyses/PostOrderCFGView.h"
 #include "clang/Analysis/AnalysisDeclContext.h"
 #include "clang/Analysis/CFG.h"
+#include "clang/Analysis/FlowSensitive/BitVectorDataflow.h"
 #include "llvm/ADT/DenseMap.h"
-#include "llvm/ADT/PostOrderIterator.h"
-#include "llvm/ADT/PriorityQueue.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
+#include <memory>
 #include <vector>
 
 using namespace clang;
 
-namespace {
+class LiveVariables::LivenessIndices {
+  llvm::DenseMap<const Stmt *, unsigned> StmtIndices;
+  llvm::DenseMap<const VarDecl *, unsigned> DeclIndices;
+  llvm::DenseMap<const BindingDecl *, unsigned> BindingIndices;
+  unsigned NumIndices = 0;
+
+  template <typename T>
+  static Optional<unsigned> lookup(const llvm::DenseMap<T, unsigned> &Map,
+                                   T Key) {
+    auto I = Map.find(Key);
+    if (I == Map.end())
+      return None;
+    return I->second;
+  }
 
-class DataflowWorklist {
-  llvm::BitVector enqueuedBlocks;
-  PostOrderCFGView *POV;
-  llvm::PriorityQueue<const CFGBlock *, SmallVector<const CFGBlock *, 20>,
-                      PostOrderCFGView::BlockOrderCompare> worklist;
+  template <typename T>
+  unsigned getOrCreate(llvm::DenseMap<T, unsigned> &Map, T Key) {
+    auto Inserted = Map.insert(std::make_pair(Key, NumIndices));
+    if (Inserted.second)
+      ++NumIndices;
+    return Inserted.first->second;
+  }
 
 public:
-  DataflowWorklist(const CFG &cfg, AnalysisDeclContext &Ctx)
-    : enqueuedBlocks(cfg.getNumBlockIDs()),
-      POV(Ctx.getAnalysis<PostOrderCFGView>()),
-      worklist(POV->getComparator()) {}
-
-  void enqueueBlock(const CFGBlock *block);
-  void enqueuePredecessors(const CFGBlock *block);
-
-  const CFGBlock *dequeue();
-};
-
-}
-
-void DataflowWorklist::enqueueBlock(const clang::CFGBlock *block) {
-  if (block && !enqueuedBlocks[block->getBlockID()]) {
-    enqueuedBlocks[block->getBlockID()] = true;
-    worklist.push(block);
+  /// Returns the bit of \p S, or None if it was never live.
+  Optional<unsigned> lookup(const Stmt *S) const {
+    return lookup(StmtIndices, S);
+  }
+  Optional<unsigned> lookup(const VarDecl *D) const {
+    return lookup(DeclIndices, D);
+  }
+  Optional<unsigned> lookup(const BindingDecl *BD) const {
+    return lookup(BindingIndices, BD);
   }
-}
 
-void DataflowWorklist::enqueuePredecessors(const clang::CFGBlock *block) {
-  for (CFGBlock::const_pred_iterator I = block->pred_begin(),
-       E = block->pred_end(); I != E; ++I) {
-    enqueueBlock(*I);
+  /// Returns the bit of \p S, giving it the next free one if it has none.
+  unsigned getOrCreate(const Stmt *S) { return getOrCreate(StmtIndices, S); }
+  unsigned getOrCreate(const VarDecl *D) {
+    return getOrCreate(DeclIndices, D);
+  }
+  unsigned getOrCreate(const BindingDecl *BD) {
+    return getOrCreate(BindingIndices, BD);
   }
-}
 
-const CFGBlock *DataflowWorklist::dequeue() {
-  if (worklist.empty())
-    return nullptr;
-  const CFGBlock *b = worklist.top();
-  worklist.pop();
-  enqueuedBlocks[b->getBlockID()] = false;
-  return b;
-}
+  unsigned size() const { return NumIndices; }
+
+  const llvm::DenseMap<const VarDecl *, unsigned> &getDeclIndices() const {
+    return DeclIndices;
+  }
+};
 
 namespace {
 class LiveVariablesImpl {
 public:
   AnalysisDeclContext &analysisContext;
-  llvm::ImmutableSet<const Stmt *>::Factory SSetFact;
-  llvm::ImmutableSet<const VarDecl *>::Factory DSetFact;
-  llvm::ImmutableSet<const BindingDecl *>::Factory BSetFact;
-  llvm::DenseMap<const CFGBlock *, LiveVariables::LivenessValues> blocksEndToLiveness;
-  llvm::DenseMap<const CFGBlock *, LiveVariables::LivenessValues> blocksBeginToLiveness;
-  llvm::DenseMap<const Stmt *, LiveVariables::LivenessValues> stmtsToLiveness;
+  LiveVariables::LivenessIndices indices;
+  std::unique_ptr<BitVectorDataflow<LiveVariables::LivenessValues>> dataflow;
   llvm::DenseMap<const DeclRefExpr *, unsigned> inAssignment;
   const bool killAtAssign;
 
-  LiveVariables::LivenessValues
-  merge(LiveVariables::LivenessValues valsA,
-        LiveVariables::LivenessValues valsB);
+  /// The block of each statement that is an element of a block.
+  llvm::DenseMap<const Stmt *, const CFGBlock *> stmtsToBlock;
+
+  /// The liveness right before each statement of the blocks which were most
+  /// recently queried. Only a few blocks are kept, since a value must be
+  /// stored for every statement of a block.
+  enum { MaxCachedBlocks = 8 };
+  SmallVector<const CFGBlock *, MaxCachedBlocks> cachedBlocks;
+  llvm::DenseMap<const Stmt *, LiveVariables::LivenessValues> stmtsToLiveness;
 
   LiveVariables::LivenessValues
   runOnBlock(const CFGBlock *block, LiveVariables::LivenessValues val,
-             LiveVariables::Observer *obs = nullptr);
+             LiveVariables::Observer *obs = nullptr,
+             llvm::DenseMap<const Stmt *, LiveVariables::LivenessValues>
+                 *stmtVals = nullptr);
+
+  /// Returns the liveness right before \p S, or null if \p S is not an
+  /// element of a block.
+  const LiveVariables::LivenessValues *getStmtLiveness(const Stmt *S);
+
+  const LiveVariables::LivenessValues &getBlockEndLiveness(
+      const CFGBlock *B) const {
+    return dataflow->getInValue(B);
+  }
 
   void dumpBlockLiveness(const SourceManager& M);
 
   LiveVariablesImpl(AnalysisDeclContext &ac, bool KillAtAssign)
-    : analysisContext(ac),
-      SSetFact(false), // Do not canonicalize ImmutableSets by default.
-      DSetFact(false), // This is a *major* performance win.
-      BSetFact(false),
-      killAtAssign(KillAtAssign) {}
+    : analysisContext(ac), killAtAssign(KillAtAssign) {}
 };
 }
 
@@ -111,67 +126,65 @@ static LiveVariablesImpl &getImpl(void *x) {
 // Operations and queries on LivenessValues.
 //===----------------------------------------------------------------------===//
 
+bool LiveVariables::LivenessValues::test(Optional<unsigned> Index) const {
+  return Index && *Index < Live.size() && Live[*Index];
+}
+
+void LiveVariables::LivenessValues::set(unsigned Index) {
+  // Statements and variables get their bits as they first become live, so
+  // the bits of the values propagated earlier may not cover them yet.
+  if (Index >= Live.size())
+    Live.resize(Indices->size());
+  Live.set(Index);
+}
+
+void LiveVariables::LivenessValues::reset(Optional<unsigned> Index) {
+  if (Index && *Index < Live.size())
+    Live.reset(*Index);
+}
+
 bool LiveVariables::LivenessValues::isLive(const Stmt *S) const {
-  return liveStmts.contains(S);
+  return Indices && test(Indices->lookup(S));
 }
 
 bool LiveVariables::LivenessValues::isLive(const VarDecl *D) const {
   if (const auto *DD = dyn_cast<DecompositionDecl>(D)) {
     bool alive = false;
     for (const BindingDecl *BD : DD->bindings())
-      alive |= liveBindings.contains(BD);
+      alive |= isLive(BD);
     return alive;
   }
-  return liveDecls.contains(D);
+  return Indices && test(Indices->lookup(D));
 }
 
-namespace {
-  template <typename SET>
-  SET mergeSets(SET A, SET B) {
-    if (A.isEmpty())
-      return B;
-
-    for (typename SET::iterator it = B.begin(), ei = B.end(); it != ei; ++it) {
-      A = A.add(*it);
-    }
-    return A;
-  }
+bool LiveVariables::LivenessValues::isLive(const BindingDecl *BD) const {
+  return Indices && test(Indices->lookup(BD));
 }
 
-void LiveVariables::Observer::anchor() { }
-
-LiveVariables::LivenessValues
-LiveVariablesImpl::merge(LiveVariables::LivenessValues valsA,
-                         LiveVariables::LivenessValues valsB) {
-
-  llvm::ImmutableSetRef<const Stmt *>
-    SSetRefA(valsA.liveStmts.getRootWithoutRetain(), SSetFact.getTreeFactory()),
-    SSetRefB(valsB.liveStmts.getRootWithoutRetain(), SSetFact.getTreeFactory());
-
-
-  llvm::ImmutableSetRef<const VarDecl *>
-    DSetRefA(valsA.liveDecls.getRootWithoutRetain(), DSetFact.getTreeFactory()),
-    DSetRefB(valsB.liveDecls.getRootWithoutRetain(), DSetFact.getTreeFactory());
-
-  llvm::ImmutableSetRef<const BindingDecl *>
-    BSetRefA(valsA.liveBindings.getRootWithoutRetain(), BSetFact.getTreeFactory()),
-    BSetRefB(valsB.liveBindings.getRootWithoutRetain(), BSetFact.getTreeFactory());
-
-  SSetRefA = mergeSets(SSetRefA, SSetRefB);
-  DSetRefA = mergeSets(DSetRefA, DSetRefB);
-  BSetRefA = mergeSets(BSetRefA, BSetRefB);
+void LiveVariables::LivenessValues::setLive(const Stmt *S, bool IsLive) {
+  if (IsLive)
+    set(Indices->getOrCreate(S));
+  else
+    reset(Indices->lookup(S));
+}
 
-  // asImmutableSet() canonicalizes the tree, allowing us to do an easy
-  // comparison afterwards.
-  return LiveVariables::LivenessValues(SSetRefA.asImmutableSet(),
-                                       DSetRefA.asImmutableSet(),
-                                       BSetRefA.asImmutableSet());
+void LiveVariables::LivenessValues::setLive(const VarDecl *D, bool IsLive) {
+  if (IsLive)
+    set(Indices->getOrCreate(D));
+  else
+    reset(Indices->lookup(D));
 }
 
-bool LiveVariables::LivenessValues::equals(const LivenessValues &V) const {
-  return liveStmts == V.liveStmts && liveDecls == V.liveDecls;
+void LiveVariables::LivenessValues::setLive(const BindingDecl *BD,
+                                            bool IsLive) {
+  if (IsLive)
+    set(Indices->getOrCreate(BD));
+  else
+    reset(Indices->lookup(BD));
 }
 
+void LiveVariables::Observer::anchor() { }
+
 //===----------------------------------------------------------------------===//
 // Query methods.
 //===----------------------------------------------------------------------===//
@@ -181,15 +194,46 @@ static bool isAlwaysAlive(const VarDecl *D) {
 }
 
 bool LiveVariables::isLive(const CFGBlock *B, const VarDecl *D) {
-  return isAlwaysAlive(D) || getImpl(impl).blocksEndToLiveness[B].isLive(D);
+  return isAlwaysAlive(D) || getImpl(impl).getBlockEndLiveness(B).isLive(D);
 }
 
 bool LiveVariables::isLive(const Stmt *S, const VarDecl *D) {
-  return isAlwaysAlive(D) || getImpl(impl).stmtsToLiveness[S].isLive(D);
+  if (isAlwaysAlive(D))
+    return true;
+  const LivenessValues *Vals = getImpl(impl).getStmtLiveness(S);
+  return Vals && Vals->isLive(D);
 }
 
 bool LiveVariables::isLive(const Stmt *Loc, const Stmt *S) {
-  return getImpl(impl).stmtsToLiveness[Loc].isLive(S);
+  const LivenessValues *Vals = getImpl(impl).getStmtLiveness(Loc);
+  return Vals && Vals->isLive(S);
+}
+
+const LiveVariables::LivenessValues *
+LiveVariablesImpl::getStmtLiveness(const Stmt *S) {
+  auto I = stmtsToLiveness.find(S);
+  if (I != stmtsToLiveness.end())
+    return &I->second;
+
+  const CFGBlock *block = stmtsToBlock.lookup(S);
+  if (!block || llvm::is_contained(cachedBlocks, block))
+    return nullptr;
+
+  // Recompute the values within the block from the value at its end,
+  // forgetting the block that was queried the longest time ago.
+  if (cachedBlocks.size() == MaxCachedBlocks) {
+    const CFGBlock *evicted = cachedBlocks.front();
+    for (const CFGElement &elem : *evicted)
+      if (Optional<CFGStmt> cs = elem.getAs<CFGStmt>())
+        if (stmtsToBlock.lookup(cs->getStmt()) == evicted)
+          stmtsToLiveness.erase(cs->getStmt());
+    cachedBlocks.erase(cachedBlocks.begin());
+  }
+  cachedBlocks.push_back(block);
+  runOnBlock(block, getBlockEndLiveness(block), nullptr, &stmtsToLiveness);
+
+  I = stmtsToLiveness.find(S);
+  return I == stmtsToLiveness.end() ? nullptr : &I->second;
 }
 
 //===----------------------------------------------------------------------===//
@@ -250,10 +294,8 @@ static const Stmt *LookThroughStmt(const Stmt *S) {
   return S;
 }
 
-static void AddLiveStmt(llvm::ImmutableSet<const Stmt *> &Set,
-                        llvm::ImmutableSet<const Stmt *>::Factory &F,
-                        const Stmt *S) {
-  Set = F.add(Set, LookThroughStmt(S));
+static void AddLiveStmt(LiveVariables::LivenessValues &Val, const Stmt *S) {
+  Val.setLive(LookThroughStmt(S));
 }
 
 void TransferFunctions::Visit(Stmt *S) {
@@ -263,7 +305,7 @@ void TransferFunctions::Visit(Stmt *S) {
   StmtVisitor<TransferFunctions>::Visit(S);
 
   if (isa<Expr>(S)) {
-    val.liveStmts = LV.SSetFact.remove(val.liveStmts, S);
+    val.setLive(S, false);
   }
 
   // Mark all children expressions live.
@@ -280,7 +322,7 @@ void TransferFunctions::Visit(Stmt *S) {
       // Include the implicit "this" pointer as being live.
       CXXMemberCallExpr *CE = cast<CXXMemberCallExpr>(S);
       if (Expr *ImplicitObj = CE->getImplicitObjectArgument()) {
-        AddLiveStmt(val.liveStmts, LV.SSetFact, ImplicitObj);
+        AddLiveStmt(val, ImplicitObj);
       }
       break;
     }
@@ -288,8 +330,7 @@ void TransferFunctions::Visit(Stmt *S) {
       // In calls to super, include the implicit "self" pointer as being live.
       ObjCMessageExpr *CE = cast<ObjCMessageExpr>(S);
       if (CE->getReceiverKind() == ObjCMessageExpr::SuperInstance)
-        val.liveDecls = LV.DSetFact.add(val.liveDecls,
-                                        LV.analysisContext.getSelfDecl());
+        val.setLive(LV.analysisContext.getSelfDecl());
       break;
     }
     case Stmt::DeclStmtClass: {
@@ -297,7 +338,7 @@ void TransferFunctions::Visit(Stmt *S) {
       if (const VarDecl *VD = dyn_cast<VarDecl>(DS->getSingleDecl())) {
         for (const VariableArrayType* VA = FindVA(VD->getType());
              VA != nullptr; VA = FindVA(VA->getElementType())) {
-          AddLiveStmt(val.liveStmts, LV.SSetFact, VA->getSizeExpr());
+          AddLiveStmt(val, VA->getSizeExpr());
         }
       }
       break;
@@ -310,7 +351,7 @@ void TransferFunctions::Visit(Stmt *S) {
       if (OpaqueValueExpr *OV = dyn_cast<OpaqueValueExpr>(child))
         child = OV->getSourceExpr();
       child = child->IgnoreParens();
-      val.liveStmts = LV.SSetFact.add(val.liveStmts, child);
+      val.setLive(child);
       return;
     }
 
@@ -331,7 +372,7 @@ void TransferFunctions::Visit(Stmt *S) {
 
   for (Stmt *Child : S->children()) {
     if (Child)
-      AddLiveStmt(val.liveStmts, LV.SSetFact, Child);
+      AddLiveStmt(val, Child);
   }
 }
 
@@ -355,12 +396,11 @@ void TransferFunctions::VisitBinaryOperator(BinaryOperator *B) {
       if (const BindingDecl* BD = dyn_cast<BindingDecl>(D)) {
         Killed = !BD->getType()->isReferenceType();
         if (Killed)
-          val.liveBindings = LV.BSetFact.remove(val.liveBindings, BD);
+          val.setLive(BD, false);
       } else if (const auto *VD = dyn_cast<VarDecl>(D)) {
         Killed = writeShouldKill(VD);
         if (Killed)
-          val.liveDecls = LV.DSetFact.remove(val.liveDecls, VD);
-
+          val.setLive(VD, false);
       }
 
       if (Killed && observer)
@@ -374,7 +414,7 @@ void TransferFunctions::VisitBlockExpr(BlockExpr *BE) {
        LV.analysisContext.getReferencedBlockVars(BE->getBlockDecl())) {
     if (isAlwaysAlive(VD))
       continue;
-    val.liveDecls = LV.DSetFact.add(val.liveDecls, VD);
+    val.setLive(VD);
   }
 }
 
@@ -383,10 +423,10 @@ void TransferFunctions::VisitDeclRefExpr(DeclRefExpr *DR) {
   bool InAssignment = LV.inAssignment[DR];
   if (const auto *BD = dyn_cast<BindingDecl>(D)) {
     if (!InAssignment)
-      val.liveBindings = LV.BSetFact.add(val.liveBindings, BD);
+      val.setLive(BD);
   } else if (const auto *VD = dyn_cast<VarDecl>(D)) {
     if (!InAssignment && !isAlwaysAlive(VD))
-      val.liveDecls = LV.DSetFact.add(val.liveDecls, VD);
+      val.setLive(VD);
   }
 }
 
@@ -394,10 +434,10 @@ void TransferFunctions::VisitDeclStmt(DeclStmt *DS) {
   for (const auto *DI : DS->decls()) {
     if (const auto *DD = dyn_cast<DecompositionDecl>(DI)) {
       for (const auto *BD : DD->bindings())
-        val.liveBindings = LV.BSetFact.remove(val.liveBindings, BD);
+        val.setLive(BD, false);
     } else if (const auto *VD = dyn_cast<VarDecl>(DI)) {
       if (!isAlwaysAlive(VD))
-        val.liveDecls = LV.DSetFact.remove(val.liveDecls, VD);
+        val.setLive(VD, false);
     }
   }
 }
@@ -416,7 +456,7 @@ void TransferFunctions::VisitObjCForCollectionStmt(ObjCForCollectionStmt *OS) {
   }
 
   if (VD) {
-    val.liveDecls = LV.DSetFact.remove(val.liveDecls, VD);
+    val.setLive(VD, false);
     if (observer && DR)
       observer->observerKill(DR);
   }
@@ -434,7 +474,7 @@ VisitUnaryExprOrTypeTraitExpr(UnaryExprOrTypeTraitExpr *UE)
   const Expr *subEx = UE->getArgumentExpr();
   if (subEx->getType()->isVariableArrayType()) {
     assert(subEx->isLValue());
-    val.liveStmts = LV.SSetFact.add(val.liveStmts, subEx->IgnoreParens());
+    val.setLive(subEx->IgnoreParens());
   }
 }
 
@@ -467,7 +507,10 @@ void TransferFunctions::VisitUnaryOperator(UnaryOperator *UO) {
 LiveVariables::LivenessValues
 LiveVariablesImpl::runOnBlock(const CFGBlock *block,
                               LiveVariables::LivenessValues val,
-                              LiveVariables::Observer *obs) {
+                              LiveVariables::Observer *obs,
+                              llvm::DenseMap<const Stmt *,
+                                             LiveVariables::LivenessValues>
+                                  *stmtVals) {
 
   TransferFunctions TF(*this, val, obs, block);
 
@@ -482,7 +525,7 @@ LiveVariablesImpl::runOnBlock(const CFGBlock *block,
 
     if (Optional<CFGAutomaticObjDtor> Dtor =
             elem.getAs<CFGAutomaticObjDtor>()) {
-      val.liveDecls = DSetFact.add(val.liveDecls, Dtor->getVarDecl());
+      val.setLive(Dtor->getVarDecl());
       continue;
     }
 
@@ -491,7 +534,8 @@ LiveVariablesImpl::runOnBlock(const CFGBlock *block,
 
     const Stmt *S = elem.castAs<CFGStmt>().getStmt();
     TF.Visit(const_cast<Stmt*>(S));
-    stmtsToLiveness[S] = val;
+    if (stmtVals && stmtsToBlock.lookup(S) == block)
+      (*stmtVals)[S] = val;
   }
   return val;
 }
@@ -499,7 +543,8 @@ LiveVariablesImpl::runOnBlock(const CFGBlock *block,
 void LiveVariables::runOnAllBlocks(LiveVariables::Observer &obs) {
   const CFG *cfg = getImpl(impl).analysisContext.getCFG();
   for (CFG::const_iterator it = cfg->begin(), ei = cfg->end(); it != ei; ++it)
-    getImpl(impl).runOnBlock(*it, getImpl(impl).blocksEndToLiveness[*it], &obs);
+    getImpl(impl).runOnBlock(*it, getImpl(impl).getBlockEndLiveness(*it),
+                             &obs);
 }
 
 LiveVariables::LiveVariables(void *im) : impl(im) {}
@@ -524,65 +569,36 @@ LiveVariables::computeLiveness(AnalysisDeclContext &AC,
 
   LiveVariablesImpl *LV = new LiveVariablesImpl(AC, killAtAssign);
 
-  // Construct the dataflow worklist.  Enqueue the exit block as the
-  // start of the analysis.
-  DataflowWorklist worklist(*cfg, AC);
-  llvm::BitVector everAnalyzedBlock(cfg->getNumBlockIDs());
-
-  // FIXME: we should enqueue using post order.
-  for (CFG::const_iterator it = cfg->begin(), ei = cfg->end(); it != ei; ++it) {
-    const CFGBlock *block = *it;
-    worklist.enqueueBlock(block);
-
-    // FIXME: Scan for DeclRefExprs using in the LHS of an assignment.
-    // We need to do this because we lack context in the reverse analysis
-    // to determine if a DeclRefExpr appears in such a context, and thus
-    // doesn't constitute a "use".
-    if (killAtAssign)
-      for (CFGBlock::const_iterator bi = block->begin(), be = block->end();
-           bi != be; ++bi) {
-        if (Optional<CFGStmt> cs = bi->getAs<CFGStmt>()) {
-          const Stmt* stmt = cs->getStmt();
-          if (const auto *BO = dyn_cast<BinaryOperator>(stmt)) {
-            if (BO->getOpcode() == BO_Assign) {
-              if (const auto *DR =
-                    dyn_cast<DeclRefExpr>(BO->getLHS()->IgnoreParens())) {
-                LV->inAssignment[DR] = 1;
-              }
-            }
-          }
-        }
-      }
-  }
-
-  while (const CFGBlock *block = worklist.dequeue()) {
-    // Determine if the block's end value has changed.  If not, we
-    // have nothing left to do for this block.
-    LivenessValues &prevVal = LV->blocksEndToLiveness[block];
-
-    // Merge the values of all successor blocks.
-    LivenessValues val;
-    for (CFGBlock::const_succ_iterator it = block->succ_begin(),
-                                       ei = block->succ_end(); it != ei; ++it) {
-      if (const CFGBlock *succ = *it) {
-        val = LV->merge(val, LV->blocksBeginToLiveness[succ]);
-      }
+  for (const CFGBlock *block : *cfg) {
+    for (const CFGElement &elem : *block) {
+      Optional<CFGStmt> cs = elem.getAs<CFGStmt>();
+      if (!cs)
+        continue;
+      const Stmt *stmt = cs->getStmt();
+      LV->stmtsToBlock[stmt] = block;
+
+      // FIXME: Scan for DeclRefExprs using in the LHS of an assignment.
+      // We need to do this because we lack context in the reverse analysis
+      // to determine if a DeclRefExpr appears in such a context, and thus
+      // doesn't constitute a "use".
+      if (killAtAssign)
+        if (const auto *BO = dyn_cast<BinaryOperator>(stmt))
+          if (BO->getOpcode() == BO_Assign)
+            if (const auto *DR =
+                    dyn_cast<DeclRefExpr>(BO->getLHS()->IgnoreParens()))
+              LV->inAssignment[DR] = 1;
     }
-
-    if (!everAnalyzedBlock[block->getBlockID()])
-      everAnalyzedBlock[block->getBlockID()] = true;
-    else if (prevVal.equals(val))
-      continue;
-
-    prevVal = val;
-
-    // Update the dataflow value for the start of this block.
-    LV->blocksBeginToLiveness[block] = LV->runOnBlock(block, val);
-
-    // Enqueue the value to the predecessors.
-    worklist.enqueuePredecessors(block);
   }
 
+  // The values flowing into each block are the ones at its end, and the
+  // values flowing out of it are the ones at its start.
+  LV->dataflow = llvm::make_unique<BitVectorDataflow<LivenessValues>>(
+      *cfg, *AC.getAnalysis<PostOrderCFGView>(), DataflowDirection::Backward,
+      LivenessValues(LV->indices));
+  LV->dataflow->solve([LV](const CFGBlock *block, LivenessValues &val) {
+    val = LV->runOnBlock(block, std::move(val));
+  });
+
   return new LiveVariables(LV);
 }
 
@@ -592,11 +608,9 @@ void LiveVariables::dumpBlockLiveness(const SourceManager &M) {
 
 void LiveVariablesImpl::dumpBlockLiveness(const SourceManager &M) {
   std::vector<const CFGBlock *> vec;
-  for (llvm::DenseMap<const CFGBlock *, LiveVariables::LivenessValues>::iterator
-       it = blocksEndToLiveness.begin(), ei = blocksEndToLiveness.end();
-       it != ei; ++it) {
-    vec.push_back(it->first);
-  }
+  for (const CFGBlock *block : *analysisContext.getCFG())
+    if (dataflow->wasVisited(block))
+      vec.push_back(block);
   llvm::sort(vec, [](const CFGBlock *A, const CFGBlock *B) {
     return A->getBlockID() < B->getBlockID();
   });
@@ -608,14 +622,12 @@ void LiveVariablesImpl::dumpBlockLiveness(const SourceManager &M) {
     llvm::errs() << "\n[ B" << (*it)->getBlockID()
                  << " (live variables at block exit) ]\n";
 
-    LiveVariables::LivenessValues vals = blocksEndToLiveness[*it];
+    const LiveVariables::LivenessValues &vals = getBlockEndLiveness(*it);
     declVec.clear();
 
-    for (llvm::ImmutableSet<const VarDecl *>::iterator si =
-          vals.liveDecls.begin(),
-          se = vals.liveDecls.end(); si != se; ++si) {
-      declVec.push_back(*si);
-    }
+    for (const auto &entry : indices.getDeclIndices())
+      if (vals.isLive(entry.first))
+        declVec.push_back(entry.first);
 
     llvm::sort(declVec, [](const Decl *A, const Decl *B) {
       return A->getBeginLoc() < B->getBeginLoc();
@@ -0,0 +1,56 @@
+//===- SSAView.cpp - SSA form of a CFG ------------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements SSAView, the SSA form of the CFG of a function.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Analysis/Analyses/SSAView.h"
+#include "clang/Analysis/Analyses/ThreadSafetyTraverse.h"
+#include "clang/Analysis/CFG.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace clang;
+using namespace threadSafety;
+
+namespace {
+
+class TILPrinter : public til::PrettyPrinter<TILPrinter, raw_ostream> {};
+
+} // namespace
+
+void SSAView::anchor() {}
+
+SSAView::SSAView() : Builder(til::MemRegionRef(&Arena)) {}
+
+SSAView::~SSAView() = default;
+
+SSAView *SSAView::create(AnalysisDeclContext &AC) {
+  CFGWalker Walker;
+  if (!Walker.init(AC))
+    return nullptr;
+
+  auto *View = new SSAView();
+  View->Graph = View->Builder.buildCFG(Walker);
+  return View;
+}
+
+const void *SSAView::getTag() { static int x; return &x; }
+
+const til::SExpr *SSAView::lookupStmt(const Stmt *S) const {
+  return Builder.lookupStmt(S);
+}
+
+const til::BasicBlock *SSAView::lookupBlock(const CFGBlock *B) const {
+  return Builder.lookupBlock(B);
+}
+
+void SSAView::print(raw_ostream &OS) const {
+  TILPrinter::print(Graph, OS);
+}
@@ -173,13 +173,29 @@ public:
 /// table maintained by a FactManager.  A typical FactSet only holds 1 or 2
 /// locks, so we can get away with doing a linear search for lookup.  Note
 /// that a hashtable or map is inappropriate in this case, because lookups
-/// may involve partial pattern matches, rather than exact matches.
+/// may involve partial pattern matches, rather than exact matches.  Since
+/// capability expressions are interned, lookups first scan for a fact with
+/// the same expression, which only compares pointers, and only then compare
+/// the expressions structurally.
 class FactSet {
 private:
   using FactVec = SmallVector<FactID, 4>;
 
   FactVec FactIDs;
 
+  template <typename IterT>
+  static IterT findMatch(FactManager &FM, IterT Begin, IterT End,
+                         const CapabilityExpr &CapE) {
+    IterT I = std::find_if(Begin, End, [&](FactID ID) {
+      return FM[ID].sexpr() == CapE.sexpr() &&
+             FM[ID].negative() == CapE.negative();
+    });
+    if (I != End)
+      return I;
+    return std::find_if(Begin, End,
+                        [&](FactID ID) { return FM[ID].matches(CapE); });
+  }
+
 public:
   using iterator = FactVec::iterator;
   using const_iterator = FactVec::const_iterator;
@@ -210,34 +226,20 @@ public:
   }
 
   bool removeLock(FactManager& FM, const CapabilityExpr &CapE) {
-    unsigned n = FactIDs.size();
-    if (n == 0)
+    iterator I = findLockIter(FM, CapE);
+    if (I == end())
       return false;
-
-    for (unsigned i = 0; i < n-1; ++i) {
-      if (FM[FactIDs[i]].matches(CapE)) {
-        FactIDs[i] = FactIDs[n-1];
-        FactIDs.pop_back();
-        return true;
-      }
-    }
-    if (FM[FactIDs[n-1]].matches(CapE)) {
-      FactIDs.pop_back();
-      return true;
-    }
-    return false;
+    *I = FactIDs.back();
+    FactIDs.pop_back();
+    return true;
   }
 
   iterator findLockIter(FactManager &FM, const CapabilityExpr &CapE) {
-    return std::find_if(begin(), end(), [&](FactID ID) {
-      return FM[ID].matches(CapE);
-    });
+    return findMatch(FM, begin(), end(), CapE);
   }
 
   const FactEntry *findLock(FactManager &FM, const CapabilityExpr &CapE) const {
-    auto I = std::find_if(begin(), end(), [&](FactID ID) {
-      return FM[ID].matches(CapE);
-    });
+    auto I = findMatch(FM, begin(), end(), CapE);
     return I != end() ? &FM[*I] : nullptr;
   }
 
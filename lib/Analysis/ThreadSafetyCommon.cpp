@@ -101,6 +101,17 @@ CapabilityExpr SExprBuilder::translateAttrExpr(const Expr *AttrExp,
   if (!DeclExp)
     return translateAttrExpr(AttrExp, nullptr);
 
+  // Reuse the translation from another call site if it did not depend on the
+  // arguments of the call. Without arguments, the attribute refers to the
+  // self argument itself.
+  auto Key = std::make_pair(AttrExp, D);
+  if (AttrExp) {
+    auto It = AttrExprTranslations.find(Key);
+    if (It != AttrExprTranslations.end())
+      return It->second;
+  }
+  unsigned PrevContextSubstitutions = NumContextSubstitutions;
+
   CallingContext Ctx(nullptr, D);
 
   // Examine DeclExp to find SelfArg and FunArgs, which are used to substitute
@@ -136,14 +147,27 @@ CapabilityExpr SExprBuilder::translateAttrExpr(const Expr *AttrExp,
     if (!AttrExp)
       return translateAttrExpr(Ctx.SelfArg, nullptr);
     else  // For most attributes.
-      return translateAttrExpr(AttrExp, &Ctx);
+      return translateAndCache(Key, Ctx, PrevContextSubstitutions);
   }
 
   // If the attribute has no arguments, then assume the argument is "this".
   if (!AttrExp)
     return translateAttrExpr(Ctx.SelfArg, nullptr);
   else  // For most attributes.
-    return translateAttrExpr(AttrExp, &Ctx);
+    return translateAndCache(Key, Ctx, PrevContextSubstitutions);
+}
+
+/// Translate the attribute expression in \p Key in the context \p Ctx, and
+/// remember the result for other call sites if nothing was substituted since
+/// there were \p PrevContextSubstitutions substitutions.
+CapabilityExpr
+SExprBuilder::translateAndCache(std::pair<const Expr *, const NamedDecl *> Key,
+                                CallingContext &Ctx,
+                                unsigned PrevContextSubstitutions) {
+  CapabilityExpr Cp = translateAttrExpr(Key.first, &Ctx);
+  if (NumContextSubstitutions == PrevContextSubstitutions)
+    AttrExprTranslations.insert(std::make_pair(Key, Cp));
+  return Cp;
 }
 
 /// Translate a clang expression in an attribute to a til::SExpr.
@@ -157,7 +181,8 @@ CapabilityExpr SExprBuilder::translateAttrExpr(const Expr *AttrExp,
     if (SLit->getString() == StringRef("*"))
       // The "*" expr is a universal lock, which essentially turns off
       // checks until it is removed from the lockset.
-      return CapabilityExpr(new (Arena) til::Wildcard(), false);
+      return CapabilityExpr(internCapability(new (Arena) til::Wildcard()),
+                            false);
     else
       // Ignore other string literals for now.
       return CapabilityExpr(nullptr, false);
@@ -187,9 +212,19 @@ CapabilityExpr SExprBuilder::translateAttrExpr(const Expr *AttrExp,
   // Hack to deal with smart pointers -- strip off top-level pointer casts.
   if (const auto *CE = dyn_cast_or_null<til::Cast>(E)) {
     if (CE->castOpcode() == til::CAST_objToPtr)
-      return CapabilityExpr(CE->expr(), Neg);
+      return CapabilityExpr(internCapability(CE->expr()), Neg);
   }
-  return CapabilityExpr(E, Neg);
+  return CapabilityExpr(internCapability(E), Neg);
+}
+
+const til::SExpr *SExprBuilder::internCapability(const til::SExpr *E) {
+  SmallVectorImpl<const til::SExpr *> &Interned =
+      InternedCapabilities[sx::toString(E)];
+  for (const til::SExpr *Other : Interned)
+    if (sx::equals(Other, E))
+      return Other;
+  Interned.push_back(E);
+  return E;
 }
 
 // Translate a clang statement or expression to a TIL expression.
@@ -283,6 +318,7 @@ til::SExpr *SExprBuilder::translateDeclRefExpr(const DeclRefExpr *DRE,
     if (Ctx && Ctx->FunArgs && FD == Ctx->AttrDecl->getCanonicalDecl()) {
       // Substitute call arguments for references to function parameters
       assert(I < Ctx->NumArgs);
+      ++NumContextSubstitutions;
       return translate(Ctx->FunArgs[I], Ctx->Prev);
     }
     // Map the param back to the param of the original function declaration
@@ -297,8 +333,10 @@ til::SExpr *SExprBuilder::translateDeclRefExpr(const DeclRefExpr *DRE,
 til::SExpr *SExprBuilder::translateCXXThisExpr(const CXXThisExpr *TE,
                                                CallingContext *Ctx) {
   // Substitute for 'this'
-  if (Ctx && Ctx->SelfArg)
+  if (Ctx && Ctx->SelfArg) {
+    ++NumContextSubstitutions;
     return translate(Ctx->SelfArg, Ctx->Prev);
+  }
   assert(SelfVar && "We have no variable for 'this'!");
   return SelfVar;
 }
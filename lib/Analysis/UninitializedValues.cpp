@@ -25,6 +25,7 @@
 #include "clang/Analysis/AnalysisDeclContext.h"
 #include "clang/Analysis/CFG.h"
 #include "clang/Analysis/DomainSpecific/ObjCNoReturn.h"
+#include "clang/Analysis/FlowSensitive/BitVectorDataflow.h"
 #include "clang/Basic/LLVM.h"
 #include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/DenseMap.h"
@@ -117,32 +118,35 @@ namespace {
 using ValueVector = llvm::PackedVector<Value, 2, llvm::SmallBitVector>;
 
 class CFGBlockValues {
-  const CFG &cfg;
-  SmallVector<ValueVector, 8> vals;
+  const BitVectorDataflow<ValueVector> *dataflow = nullptr;
   ValueVector scratch;
   DeclToIndex declToIndex;
 
 public:
-  CFGBlockValues(const CFG &cfg);
+  CFGBlockValues() = default;
 
   unsigned getNumEntries() const { return declToIndex.size(); }
 
   void computeSetOfDeclarations(const DeclContext &dc);
 
-  ValueVector &getValueVector(const CFGBlock *block) {
-    return vals[block->getBlockID()];
+  /// Use the values at the end of each block that \p df computes.
+  void setDataflow(const BitVectorDataflow<ValueVector> &df) {
+    dataflow = &df;
+  }
+
+  const ValueVector &getValueVector(const CFGBlock *block) const {
+    return dataflow->getOutValue(block);
   }
 
   void setAllScratchValues(Value V);
-  void mergeIntoScratch(ValueVector const &source, bool isFirst);
-  bool updateValueVectorWithScratch(const CFGBlock *block);
+
+  /// Exchange the values at the current point of the analysis with \p V.
+  void swapScratch(ValueVector &V) { std::swap(scratch, V); }
 
   bool hasNoDeclarations() const {
     return declToIndex.size() == 0;
   }
 
-  void resetScratch();
-
   ValueVector::reference operator[](const VarDecl *vd);
 
   Value getValue(const CFGBlock *block, const CFGBlock *dstBlock,
@@ -155,18 +159,9 @@ public:
 
 } // namespace
 
-CFGBlockValues::CFGBlockValues(const CFG &c) : cfg(c), vals(0) {}
-
 void CFGBlockValues::computeSetOfDeclarations(const DeclContext &dc) {
   declToIndex.computeMap(dc);
-  unsigned decls = declToIndex.size();
-  scratch.resize(decls);
-  unsigned n = cfg.getNumBlockIDs();
-  if (!n)
-    return;
-  vals.resize(n);
-  for (auto &val : vals)
-    val.resize(decls);
+  scratch.resize(declToIndex.size());
 }
 
 #if DEBUG_LOGGING
@@ -184,97 +179,12 @@ void CFGBlockValues::setAllScratchValues(Value V) {
     scratch[I] = V;
 }
 
-void CFGBlockValues::mergeIntoScratch(ValueVector const &source,
-                                      bool isFirst) {
-  if (isFirst)
-    scratch = source;
-  else
-    scratch |= source;
-}
-
-bool CFGBlockValues::updateValueVectorWithScratch(const CFGBlock *block) {
-  ValueVector &dst = getValueVector(block);
-  bool changed = (dst != scratch);
-  if (changed)
-    dst = scratch;
-#if DEBUG_LOGGING
-  printVector(block, scratch, 0);
-#endif
-  return changed;
-}
-
-void CFGBlockValues::resetScratch() {
-  scratch.reset();
-}
-
 ValueVector::reference CFGBlockValues::operator[](const VarDecl *vd) {
   const Optional<unsigned> &idx = declToIndex.getValueIndex(vd);
   assert(idx.hasValue());
   return scratch[idx.getValue()];
 }
 
-//------------------------------------------------------------------------====//
-// Worklist: worklist for dataflow analysis.
-//====------------------------------------------------------------------------//
-
-namespace {
-
-class DataflowWorklist {
-  PostOrderCFGView::iterator PO_I, PO_E;
-  SmallVector<const CFGBlock *, 20> worklist;
-  llvm::BitVector enqueuedBlocks;
-
-public:
-  DataflowWorklist(const CFG &cfg, PostOrderCFGView &view)
-      : PO_I(view.begin()), PO_E(view.end()),
-        enqueuedBlocks(cfg.getNumBlockIDs(), true) {
-    // Treat the first block as already analyzed.
-    if (PO_I != PO_E) {
-      assert(*PO_I == &cfg.getEntry());
-      enqueuedBlocks[(*PO_I)->getBlockID()] = false;
-      ++PO_I;
-    }
-  }
-
-  void enqueueSuccessors(const CFGBlock *block);
-  const CFGBlock *dequeue();
-};
-
-} // namespace
-
-void DataflowWorklist::enqueueSuccessors(const CFGBlock *block) {
-  for (CFGBlock::const_succ_iterator I = block->succ_begin(),
-       E = block->succ_end(); I != E; ++I) {
-    const CFGBlock *Successor = *I;
-    if (!Successor || enqueuedBlocks[Successor->getBlockID()])
-      continue;
-    worklist.push_back(Successor);
-    enqueuedBlocks[Successor->getBlockID()] = true;
-  }
-}
-
-const CFGBlock *DataflowWorklist::dequeue() {
-  const CFGBlock *B = nullptr;
-
-  // First dequeue from the worklist.  This can represent
-  // updates along backedges that we want propagated as quickly as possible.
-  if (!worklist.empty())
-    B = worklist.pop_back_val();
-
-  // Next dequeue from the initial reverse post order.  This is the
-  // theoretical ideal in the presence of no back edges.
-  else if (PO_I != PO_E) {
-    B = *PO_I;
-    ++PO_I;
-  }
-  else
-    return nullptr;
-
-  assert(enqueuedBlocks[B->getBlockID()] == true);
-  enqueuedBlocks[B->getBlockID()] = false;
-  return B;
-}
-
 //------------------------------------------------------------------------====//
 // Classification of DeclRefExprs as use or initialization.
 //====------------------------------------------------------------------------//
@@ -817,32 +727,22 @@ void TransferFunctions::VisitObjCMessageExpr(ObjCMessageExpr *ME) {
 // High-level "driver" logic for uninitialized values analysis.
 //====------------------------------------------------------------------------//
 
-static bool runOnBlock(const CFGBlock *block, const CFG &cfg,
+/// Apply the transfer function of \p block to \p val, the values at its
+/// start, turning them into the values at its end.
+static void runOnBlock(const CFGBlock *block, const CFG &cfg,
                        AnalysisDeclContext &ac, CFGBlockValues &vals,
-                       const ClassifyRefs &classification,
-                       llvm::BitVector &wasAnalyzed,
+                       ValueVector &val, const ClassifyRefs &classification,
                        UninitVariablesHandler &handler) {
-  wasAnalyzed[block->getBlockID()] = true;
-  vals.resetScratch();
-  // Merge in values of predecessor blocks.
-  bool isFirst = true;
-  for (CFGBlock::const_pred_iterator I = block->pred_begin(),
-       E = block->pred_end(); I != E; ++I) {
-    const CFGBlock *pred = *I;
-    if (!pred)
-      continue;
-    if (wasAnalyzed[pred->getBlockID()]) {
-      vals.mergeIntoScratch(vals.getValueVector(pred), isFirst);
-      isFirst = false;
-    }
-  }
-  // Apply the transfer function.
+  vals.swapScratch(val);
   TransferFunctions tf(vals, cfg, block, ac, classification, handler);
   for (const auto &I : *block) {
     if (Optional<CFGStmt> cs = I.getAs<CFGStmt>())
       tf.Visit(const_cast<Stmt *>(cs->getStmt()));
   }
-  return vals.updateValueVectorWithScratch(block);
+  vals.swapScratch(val);
+#if DEBUG_LOGGING
+  printVector(block, val, 0);
+#endif
 }
 
 namespace {
@@ -888,7 +788,7 @@ void clang::runUninitializedVariablesAnalysis(
     AnalysisDeclContext &ac,
     UninitVariablesHandler &handler,
     UninitVariablesAnalysisStats &stats) {
-  CFGBlockValues vals(cfg);
+  CFGBlockValues vals;
   vals.computeSetOfDeclarations(dc);
   if (vals.hasNoDeclarations())
     return;
@@ -899,33 +799,28 @@ void clang::runUninitializedVariablesAnalysis(
   ClassifyRefs classification(ac);
   cfg.VisitBlockStmts(classification);
 
-  // Mark all variables uninitialized at the entry.
-  const CFGBlock &entry = cfg.getEntry();
-  ValueVector &vec = vals.getValueVector(&entry);
+  // Every variable starts out unknown, which merges with any other value to
+  // that value, except at the entry, where they are all uninitialized.
   const unsigned n = vals.getNumEntries();
-  for (unsigned j = 0; j < n; ++j) {
-    vec[j] = Uninitialized;
-  }
+  ValueVector unknown;
+  unknown.resize(n);
+  ValueVector uninitialized(unknown);
+  for (unsigned j = 0; j < n; ++j)
+    uninitialized[j] = Uninitialized;
+
+  BitVectorDataflow<ValueVector> dataflow(
+      cfg, *ac.getAnalysis<PostOrderCFGView>(), DataflowDirection::Forward,
+      unknown);
+  dataflow.setBoundaryValue(uninitialized);
+  vals.setDataflow(dataflow);
 
   // Proceed with the workist.
-  DataflowWorklist worklist(cfg, *ac.getAnalysis<PostOrderCFGView>());
-  llvm::BitVector previouslyVisited(cfg.getNumBlockIDs());
-  worklist.enqueueSuccessors(&cfg.getEntry());
-  llvm::BitVector wasAnalyzed(cfg.getNumBlockIDs(), false);
-  wasAnalyzed[cfg.getEntry().getBlockID()] = true;
   PruneBlocksHandler PBH(cfg.getNumBlockIDs());
-
-  while (const CFGBlock *block = worklist.dequeue()) {
+  dataflow.solve([&](const CFGBlock *block, ValueVector &val) {
     PBH.currentBlock = block->getBlockID();
-
-    // Did the block change?
-    bool changed = runOnBlock(block, cfg, ac, vals,
-                              classification, wasAnalyzed, PBH);
-    ++stats.NumBlockVisits;
-    if (changed || !previouslyVisited[block->getBlockID()])
-      worklist.enqueueSuccessors(block);
-    previouslyVisited[block->getBlockID()] = true;
-  }
+    runOnBlock(block, cfg, ac, vals, val, classification, PBH);
+  });
+  stats.NumBlockVisits = dataflow.getNumBlockVisits();
 
   if (!PBH.hadAnyUse)
     return;
@@ -933,7 +828,8 @@ void clang::runUninitializedVariablesAnalysis(
   // Run through the blocks one more time, and report uninitialized variables.
   for (const auto *block : cfg)
     if (PBH.hadUse[block->getBlockID()]) {
-      runOnBlock(block, cfg, ac, vals, classification, wasAnalyzed, handler);
+      ValueVector val = dataflow.getInValue(block);
+      runOnBlock(block, cfg, ac, vals, val, classification, handler);
       ++stats.NumBlockVisits;
     }
 }
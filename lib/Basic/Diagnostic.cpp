@@ -157,6 +157,7 @@ void DiagnosticsEngine::DiagStateMap::appendFirst(DiagState *State) {
   assert(Files.empty() && "not first");
   FirstDiagState = CurDiagState = State;
   CurDiagStateLoc = SourceLocation();
+  LastLookupState = nullptr;
 }
 
 void DiagnosticsEngine::DiagStateMap::append(SourceManager &SrcMgr,
@@ -164,6 +165,8 @@ void DiagnosticsEngine::DiagStateMap::append(SourceManager &SrcMgr,
                                              DiagState *State) {
   CurDiagState = State;
   CurDiagStateLoc = Loc;
+  // This can change the state of any file that includes Loc.
+  LastLookupState = nullptr;
 
   std::pair<FileID, unsigned> Decomp = SrcMgr.getDecomposedLoc(Loc);
   unsigned Offset = Decomp.second;
@@ -192,18 +195,35 @@ DiagnosticsEngine::DiagStateMap::lookup(SourceManager &SrcMgr,
     return FirstDiagState;
 
   std::pair<FileID, unsigned> Decomp = SrcMgr.getDecomposedLoc(Loc);
+  if (LastLookupState && Decomp.first == LastLookupFID &&
+      Decomp.second >= LastLookupBegin && Decomp.second < LastLookupEnd)
+    return LastLookupState;
+
   const File *F = getFile(SrcMgr, Decomp.first);
-  return F->lookup(Decomp.second);
+  LastLookupState = F->lookup(Decomp.second, LastLookupBegin, LastLookupEnd);
+  LastLookupFID = Decomp.first;
+  return LastLookupState;
 }
 
 DiagnosticsEngine::DiagState *
 DiagnosticsEngine::DiagStateMap::File::lookup(unsigned Offset) const {
+  unsigned Begin, End;
+  return lookup(Offset, Begin, End);
+}
+
+DiagnosticsEngine::DiagState *
+DiagnosticsEngine::DiagStateMap::File::lookup(unsigned Offset, unsigned &Begin,
+                                              unsigned &End) const {
   auto OnePastIt = std::upper_bound(
       StateTransitions.begin(), StateTransitions.end(), Offset,
       [](unsigned Offset, const DiagStatePoint &P) {
         return Offset < P.Offset;
       });
   assert(OnePastIt != StateTransitions.begin() && "missing initial state");
+  Begin = OnePastIt[-1].Offset;
+  End = OnePastIt == StateTransitions.end()
+            ? std::numeric_limits<unsigned>::max()
+            : OnePastIt->Offset;
   return OnePastIt[-1].State;
 }
 
@@ -492,6 +492,42 @@ DiagnosticIDs::getDiagnosticSeverity(unsigned DiagID, SourceLocation Loc,
   return Result;
 }
 
+/// Determine whether the given diagnostic is ignored in every diagnostic state
+/// that currently exists, and so will be ignored wherever it is reported until
+/// a pragma changes the state.
+///
+/// This only considers the parts of the severity computation that depend on
+/// the state; whatever depends on the location, such as suppression in system
+/// headers, is taken not to ignore the diagnostic.
+bool DiagnosticIDs::isIgnoredInEveryState(unsigned DiagID,
+                                          const DiagnosticsEngine &Diag) const {
+  assert(getBuiltinDiagClass(DiagID) != CLASS_NOTE);
+
+  bool EnabledByDefault = false;
+  bool IsExtensionDiag = isBuiltinExtensionDiag(DiagID, EnabledByDefault);
+  bool IsRemark = getBuiltinDiagClass(DiagID) == CLASS_REMARK;
+
+  for (const DiagnosticsEngine::DiagState &State : Diag.DiagStates) {
+    DiagnosticMapping Mapping = State.lookupMapping((diag::kind)DiagID);
+    if (Mapping.getSeverity() == diag::Severity())
+      Mapping = GetDefaultDiagMapping(DiagID);
+
+    // This mirrors getDiagnosticSeverity.
+    diag::Severity Result = Mapping.getSeverity();
+    if (State.EnableAllWarnings && Result == diag::Severity::Ignored &&
+        !Mapping.isUser() && !IsRemark)
+      Result = diag::Severity::Warning;
+    if (IsExtensionDiag && !Mapping.isUser())
+      Result = std::max(Result, State.ExtBehavior);
+    if (Result == diag::Severity::Ignored)
+      continue;
+    if (Result == diag::Severity::Warning && State.IgnoreAllWarnings)
+      continue;
+    return false;
+  }
+  return true;
+}
+
 #define GET_DIAG_ARRAYS
 #include "clang/Basic/DiagnosticGroups.inc"
 #undef GET_DIAG_ARRAYS
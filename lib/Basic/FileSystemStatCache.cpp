@@ -12,10 +12,20 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Basic/FileSystemStatCache.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/Support/Chrono.h"
+#include "llvm/Support/DJB.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/EndianStream.h"
 #include "llvm/Support/ErrorOr.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/OnDiskHashTable.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/VirtualFileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+#include <cstring>
+#include <limits>
 #include <utility>
 
 using namespace clang;
@@ -129,3 +139,296 @@ MemorizeStatCalls::getStat(StringRef Path, FileData &Data, bool isFile,
 
   return Result;
 }
+
+//===----------------------------------------------------------------------===//
+// Build session stat cache
+//===----------------------------------------------------------------------===//
+
+/// The magic number at the start of a stat cache file.
+static const char StatCacheMagic[4] = {'C', 'S', 'T', 'C'};
+
+/// The stat cache file version.  Bump this whenever the layout changes.
+static const uint32_t StatCacheVersion = 1;
+
+/// Magic, version, build session timestamp and bucket offset.
+static const unsigned StatCacheHeaderSize = 4 + 4 + 8 + 4;
+
+/// Directory modification time recorded for directories that don't exist.
+static const uint64_t MissingDirModTime = ~uint64_t(0);
+
+namespace {
+
+/// Trait used to read and write the path -> entry on-disk hash table.
+class StatCacheTrait {
+public:
+  using Entry = BuildSessionStatCache::Entry;
+
+  using key_type = StringRef;
+  using key_type_ref = StringRef;
+  using external_key_type = StringRef;
+  using internal_key_type = StringRef;
+  using data_type = Entry;
+  using data_type_ref = const Entry &;
+  using hash_value_type = unsigned;
+  using offset_type = unsigned;
+
+  enum : unsigned {
+    /// Kind, directory mtime, size, mtime, device, inode, flags.
+    DataLen = 1 + 8 * 5 + 1
+  };
+
+  static bool EqualKey(StringRef A, StringRef B) { return A == B; }
+  static hash_value_type ComputeHash(StringRef Key) {
+    return llvm::djbHash(Key);
+  }
+  static StringRef GetInternalKey(StringRef Key) { return Key; }
+  static StringRef GetExternalKey(StringRef Key) { return Key; }
+
+  static std::pair<unsigned, unsigned>
+  EmitKeyDataLength(raw_ostream &Out, StringRef Key, const Entry &) {
+    using namespace llvm::support;
+    endian::Writer LE(Out, little);
+    LE.write<uint16_t>(Key.size());
+    return std::make_pair(Key.size(), DataLen);
+  }
+
+  static void EmitKey(raw_ostream &Out, StringRef Key, unsigned) {
+    Out << Key;
+  }
+
+  static void EmitData(raw_ostream &Out, StringRef, const Entry &E,
+                       unsigned) {
+    using namespace llvm::support;
+    endian::Writer LE(Out, little);
+    LE.write<uint8_t>(E.Kind);
+    LE.write<uint64_t>(E.DirModTime);
+    LE.write<uint64_t>(E.Size);
+    LE.write<uint64_t>(static_cast<uint64_t>(E.ModTime));
+    LE.write<uint64_t>(E.UniqueID.getDevice());
+    LE.write<uint64_t>(E.UniqueID.getFile());
+    LE.write<uint8_t>((E.IsDirectory ? 1 : 0) | (E.IsNamedPipe ? 2 : 0));
+  }
+
+  static std::pair<unsigned, unsigned>
+  ReadKeyDataLength(const unsigned char *&D) {
+    using namespace llvm::support;
+    unsigned KeyLen = endian::readNext<uint16_t, little, unaligned>(D);
+    return std::make_pair(KeyLen, DataLen);
+  }
+
+  static StringRef ReadKey(const unsigned char *D, unsigned N) {
+    return StringRef(reinterpret_cast<const char *>(D), N);
+  }
+
+  static Entry ReadData(StringRef, const unsigned char *D, unsigned) {
+    using namespace llvm::support;
+    Entry E;
+    E.Kind = static_cast<Entry::KindType>(*D++);
+    E.DirModTime = endian::readNext<uint64_t, little, unaligned>(D);
+    E.Size = endian::readNext<uint64_t, little, unaligned>(D);
+    E.ModTime = endian::readNext<uint64_t, little, unaligned>(D);
+    uint64_t Device = endian::readNext<uint64_t, little, unaligned>(D);
+    uint64_t File = endian::readNext<uint64_t, little, unaligned>(D);
+    E.UniqueID = llvm::sys::fs::UniqueID(Device, File);
+    E.IsDirectory = *D & 1;
+    E.IsNamedPipe = *D & 2;
+    return E;
+  }
+};
+
+} // namespace
+
+/// The on-disk hash table mapped from the cache file.
+class BuildSessionStatCache::OnDiskTable {
+public:
+  using TableTy = llvm::OnDiskIterableChainedHashTable<StatCacheTrait>;
+  std::unique_ptr<TableTy> Table;
+
+  OnDiskTable(const unsigned char *Buckets, const unsigned char *Payload,
+              const unsigned char *Base)
+      : Table(TableTy::Create(Buckets, Payload, Base)) {}
+};
+
+BuildSessionStatCache::BuildSessionStatCache(StringRef CacheFile,
+                                             uint64_t BuildSessionTimestamp)
+    : CacheFile(CacheFile), BuildSessionTimestamp(BuildSessionTimestamp) {}
+
+BuildSessionStatCache::~BuildSessionStatCache() = default;
+
+std::unique_ptr<BuildSessionStatCache>
+BuildSessionStatCache::create(StringRef CacheFile,
+                              uint64_t BuildSessionTimestamp) {
+  std::unique_ptr<BuildSessionStatCache> Cache(
+      new BuildSessionStatCache(CacheFile, BuildSessionTimestamp));
+
+  // The file is shared with every other process in the build, so map it
+  // rather than reading it.
+  auto BufOrErr = llvm::MemoryBuffer::getFile(
+      CacheFile, /*FileSize=*/-1, /*RequiresNullTerminator=*/false);
+  if (!BufOrErr)
+    return Cache;
+  std::unique_ptr<llvm::MemoryBuffer> Buf = std::move(*BufOrErr);
+
+  using namespace llvm::support;
+  const unsigned char *Base =
+      reinterpret_cast<const unsigned char *>(Buf->getBufferStart());
+  const unsigned char *D = Base;
+  if (Buf->getBufferSize() < StatCacheHeaderSize ||
+      memcmp(D, StatCacheMagic, sizeof(StatCacheMagic)) != 0)
+    return Cache;
+  D += sizeof(StatCacheMagic);
+  if (endian::readNext<uint32_t, little, unaligned>(D) != StatCacheVersion ||
+      endian::readNext<uint64_t, little, unaligned>(D) !=
+          BuildSessionTimestamp)
+    return Cache;
+  uint32_t BucketOffset = endian::readNext<uint32_t, little, unaligned>(D);
+  if (BucketOffset < StatCacheHeaderSize ||
+      BucketOffset + 2 * sizeof(uint32_t) > Buf->getBufferSize() ||
+      BucketOffset % alignof(uint32_t) != 0)
+    return Cache;
+
+  Cache->Table = llvm::make_unique<OnDiskTable>(Base + BucketOffset,
+                                                Base + StatCacheHeaderSize, Base);
+  Cache->Buffer = std::move(Buf);
+  return Cache;
+}
+
+uint64_t BuildSessionStatCache::getDirModTime(StringRef Dir,
+                                              llvm::vfs::FileSystem &FS) {
+  auto Known = DirModTimes.find(Dir);
+  if (Known != DirModTimes.end())
+    return Known->second;
+
+  uint64_t ModTime = MissingDirModTime;
+  llvm::ErrorOr<llvm::vfs::Status> Status = FS.status(Dir);
+  if (Status && Status->isDirectory())
+    ModTime = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  Status->getLastModificationTime().time_since_epoch())
+                  .count();
+  DirModTimes[Dir] = ModTime;
+  return ModTime;
+}
+
+BuildSessionStatCache::LookupResult
+BuildSessionStatCache::getStat(StringRef Path, FileData &Data, bool isFile,
+                               std::unique_ptr<llvm::vfs::File> *F,
+                               llvm::vfs::FileSystem &FS) {
+  if (!llvm::sys::path::is_absolute(Path))
+    return statChained(Path, Data, isFile, F, FS);
+
+  StringRef Dir = llvm::sys::path::parent_path(Path);
+  uint64_t DirModTime = getDirModTime(Dir, FS);
+
+  Optional<Entry> Cached;
+  auto New = NewEntries.find(Path);
+  if (New != NewEntries.end())
+    Cached = New->second;
+  else if (Table) {
+    auto OnDisk = Table->Table->find(Path);
+    if (OnDisk != Table->Table->end())
+      Cached = *OnDisk;
+  }
+
+  // Negative entries only answer the kind of lookup they were made for: a
+  // lookup for a file also fails when the path names a directory.
+  Entry::KindType MissingKind =
+      isFile ? Entry::MissingFile : Entry::MissingDirectory;
+  if (Cached && Cached->DirModTime == DirModTime &&
+      (Cached->Kind == Entry::Exists || Cached->Kind == MissingKind)) {
+    ++NumHits;
+    if (Cached->Kind != Entry::Exists)
+      return CacheMissing;
+
+    Data.Name = Path;
+    Data.Size = Cached->Size;
+    Data.ModTime = Cached->ModTime;
+    Data.UniqueID = Cached->UniqueID;
+    Data.IsDirectory = Cached->IsDirectory;
+    Data.IsNamedPipe = Cached->IsNamedPipe;
+    Data.InPCH = false;
+    Data.IsVFSMapped = false;
+    return CacheExists;
+  }
+
+  ++NumMisses;
+  LookupResult Result = statChained(Path, Data, isFile, F, FS);
+
+  // Don't remember paths that a VFS overlay redirected, since the overlay may
+  // not be the same for every compile in the build, or paths that are too long
+  // for the on-disk format.
+  if ((Result == CacheExists && Data.IsVFSMapped) ||
+      Path.size() > std::numeric_limits<uint16_t>::max())
+    return Result;
+
+  Entry E;
+  E.DirModTime = DirModTime;
+  if (Result == CacheMissing) {
+    E.Kind = MissingKind;
+  } else {
+    E.Kind = Entry::Exists;
+    E.Size = Data.Size;
+    E.ModTime = Data.ModTime;
+    E.UniqueID = Data.UniqueID;
+    E.IsDirectory = Data.IsDirectory;
+    E.IsNamedPipe = Data.IsNamedPipe;
+  }
+  NewEntries[Path] = E;
+  return Result;
+}
+
+bool BuildSessionStatCache::writeToDisk() {
+  if (NewEntries.empty())
+    return false;
+
+  llvm::OnDiskChainedHashTableGenerator<StatCacheTrait> Generator;
+  StatCacheTrait Trait;
+  for (auto &New : NewEntries)
+    Generator.insert(New.getKey(), New.second, Trait);
+
+  // Carry over what other processes learned, unless we have something newer.
+  if (Table) {
+    StatCacheTrait::Entry OnDiskEntry;
+    for (auto I = Table->Table->key_begin(), E = Table->Table->key_end();
+         I != E; ++I) {
+      StringRef Key = *I;
+      if (NewEntries.count(Key))
+        continue;
+      OnDiskEntry = *Table->Table->find(Key);
+      Generator.insert(Key, OnDiskEntry, Trait);
+    }
+  }
+
+  SmallString<4096> Contents;
+  {
+    using namespace llvm::support;
+    llvm::raw_svector_ostream Out(Contents);
+    Out.write(StatCacheMagic, sizeof(StatCacheMagic));
+    endian::Writer LE(Out, little);
+    LE.write<uint32_t>(StatCacheVersion);
+    LE.write<uint64_t>(BuildSessionTimestamp);
+    LE.write<uint32_t>(0); // Placeholder for the bucket offset.
+    uint32_t BucketOffset = Generator.Emit(Out, Trait);
+    endian::write32le(Contents.data() + StatCacheHeaderSize - 4, BucketOffset);
+  }
+
+  // Write to a temporary file and move it into place, so that readers only
+  // ever see a complete cache file.
+  SmallString<128> TmpPath;
+  int TmpFD;
+  if (llvm::sys::fs::createUniqueFile(CacheFile + "-%%%%%%%%", TmpFD, TmpPath))
+    return true;
+  {
+    llvm::raw_fd_ostream Out(TmpFD, /*shouldClose=*/true);
+    Out << Contents;
+    Out.close();
+    if (Out.has_error()) {
+      llvm::sys::fs::remove(TmpPath);
+      return true;
+    }
+  }
+  if (llvm::sys::fs::rename(TmpPath, CacheFile)) {
+    llvm::sys::fs::remove(TmpPath);
+    return true;
+  }
+  return false;
+}
@@ -137,57 +137,93 @@ namespace {
 
 } // namespace
 
+namespace {
+
+  /// The keyword flags from TokenKinds.def that a language mode turns on,
+  /// grouped by the status they give a keyword.  A keyword takes the status
+  /// of the first group, in declaration order, that any of its flags is in.
+  struct KeywordFlagMasks {
+    unsigned Enabled = 0;
+    unsigned Extension = 0;
+    unsigned LateEnabled = 0;
+    unsigned Future = 0;
+
+    /// Flags whose keywords are not added at all.
+    unsigned Excluded = 0;
+  };
+
+} // namespace
+
+/// Compute which keyword flags are turned on in the given language standard.
+static KeywordFlagMasks getKeywordFlagMasks(const LangOptions &LangOpts) {
+  KeywordFlagMasks Masks;
+  if (LangOpts.CPlusPlus) Masks.Enabled |= KEYCXX;
+  if (LangOpts.CPlusPlus11) Masks.Enabled |= KEYCXX11;
+  if (LangOpts.CPlusPlus2a) Masks.Enabled |= KEYCXX2A;
+  if (LangOpts.C99) Masks.Enabled |= KEYC99;
+  if (LangOpts.GNUKeywords) Masks.Extension |= KEYGNU;
+  if (LangOpts.MicrosoftExt) Masks.Extension |= KEYMS;
+  if (LangOpts.Borland) Masks.Extension |= KEYBORLAND;
+  if (LangOpts.Bool) Masks.LateEnabled |= BOOLSUPPORT;
+  if (LangOpts.Half) Masks.LateEnabled |= HALFSUPPORT;
+  if (LangOpts.WChar) Masks.LateEnabled |= WCHARSUPPORT;
+  if (LangOpts.Char8) Masks.LateEnabled |= CHAR8SUPPORT;
+  if (LangOpts.AltiVec) Masks.LateEnabled |= KEYALTIVEC;
+  if (LangOpts.ZVector) Masks.LateEnabled |= KEYZVECTOR;
+  if (LangOpts.OpenCL && !LangOpts.OpenCLCPlusPlus)
+    Masks.LateEnabled |= KEYOPENCLC;
+  if (LangOpts.OpenCLCPlusPlus) Masks.LateEnabled |= KEYOPENCLCXX;
+  if (!LangOpts.CPlusPlus) Masks.LateEnabled |= KEYNOCXX;
+  if (LangOpts.C11) Masks.LateEnabled |= KEYC11;
+  // We treat bridge casts as objective-C keywords so we can warn on them
+  // in non-arc mode.
+  if (LangOpts.ObjC) Masks.LateEnabled |= KEYOBJC;
+  if (LangOpts.ConceptsTS) Masks.LateEnabled |= KEYCONCEPTS;
+  if (LangOpts.CoroutinesTS) Masks.LateEnabled |= KEYCOROUTINES;
+  if (LangOpts.ModulesTS) Masks.LateEnabled |= KEYMODULES;
+  if (LangOpts.CPlusPlus) Masks.Future |= KEYALLCXX;
+
+  // Don't add these keywords under MSVCCompat.
+  if (LangOpts.MSVCCompat &&
+      !LangOpts.isCompatibleWithMSVC(LangOptions::MSVC2015))
+    Masks.Excluded |= KEYNOMS18;
+
+  // Don't add these keywords under OpenCL.
+  if (LangOpts.OpenCL)
+    Masks.Excluded |= KEYNOOPENCL;
+  return Masks;
+}
+
 /// Translates flags as specified in TokenKinds.def into keyword status
-/// in the given language standard.
-static KeywordStatus getKeywordStatus(const LangOptions &LangOpts,
+/// in the language standard described by \p Masks.
+static KeywordStatus getKeywordStatus(const KeywordFlagMasks &Masks,
                                       unsigned Flags) {
   if (Flags == KEYALL) return KS_Enabled;
-  if (LangOpts.CPlusPlus && (Flags & KEYCXX)) return KS_Enabled;
-  if (LangOpts.CPlusPlus11 && (Flags & KEYCXX11)) return KS_Enabled;
-  if (LangOpts.CPlusPlus2a && (Flags & KEYCXX2A)) return KS_Enabled;
-  if (LangOpts.C99 && (Flags & KEYC99)) return KS_Enabled;
-  if (LangOpts.GNUKeywords && (Flags & KEYGNU)) return KS_Extension;
-  if (LangOpts.MicrosoftExt && (Flags & KEYMS)) return KS_Extension;
-  if (LangOpts.Borland && (Flags & KEYBORLAND)) return KS_Extension;
-  if (LangOpts.Bool && (Flags & BOOLSUPPORT)) return KS_Enabled;
-  if (LangOpts.Half && (Flags & HALFSUPPORT)) return KS_Enabled;
-  if (LangOpts.WChar && (Flags & WCHARSUPPORT)) return KS_Enabled;
-  if (LangOpts.Char8 && (Flags & CHAR8SUPPORT)) return KS_Enabled;
-  if (LangOpts.AltiVec && (Flags & KEYALTIVEC)) return KS_Enabled;
-  if (LangOpts.ZVector && (Flags & KEYZVECTOR)) return KS_Enabled;
-  if (LangOpts.OpenCL && !LangOpts.OpenCLCPlusPlus && (Flags & KEYOPENCLC))
-    return KS_Enabled;
-  if (LangOpts.OpenCLCPlusPlus && (Flags & KEYOPENCLCXX)) return KS_Enabled;
-  if (!LangOpts.CPlusPlus && (Flags & KEYNOCXX)) return KS_Enabled;
-  if (LangOpts.C11 && (Flags & KEYC11)) return KS_Enabled;
-  // We treat bridge casts as objective-C keywords so we can warn on them
-  // in non-arc mode.
-  if (LangOpts.ObjC && (Flags & KEYOBJC)) return KS_Enabled;
-  if (LangOpts.ConceptsTS && (Flags & KEYCONCEPTS)) return KS_Enabled;
-  if (LangOpts.CoroutinesTS && (Flags & KEYCOROUTINES)) return KS_Enabled;
-  if (LangOpts.ModulesTS && (Flags & KEYMODULES)) return KS_Enabled;
-  if (LangOpts.CPlusPlus && (Flags & KEYALLCXX)) return KS_Future;
+  if (Flags & Masks.Enabled) return KS_Enabled;
+  if (Flags & Masks.Extension) return KS_Extension;
+  if (Flags & Masks.LateEnabled) return KS_Enabled;
+  if (Flags & Masks.Future) return KS_Future;
   return KS_Disabled;
 }
 
+/// Translates flags as specified in TokenKinds.def into keyword status
+/// in the given language standard.
+static KeywordStatus getKeywordStatus(const LangOptions &LangOpts,
+                                      unsigned Flags) {
+  return getKeywordStatus(getKeywordFlagMasks(LangOpts), Flags);
+}
+
 /// AddKeyword - This method is used to associate a token ID with specific
 /// identifiers because they are language keywords.  This causes the lexer to
 /// automatically map matching identifiers to specialized token codes.
 static void AddKeyword(StringRef Keyword,
                        tok::TokenKind TokenCode, unsigned Flags,
-                       const LangOptions &LangOpts, IdentifierTable &Table) {
-  KeywordStatus AddResult = getKeywordStatus(LangOpts, Flags);
-
-  // Don't add this keyword under MSVCCompat.
-  if (LangOpts.MSVCCompat && (Flags & KEYNOMS18) &&
-      !LangOpts.isCompatibleWithMSVC(LangOptions::MSVC2015))
-    return;
-
-  // Don't add this keyword under OpenCL.
-  if (LangOpts.OpenCL && (Flags & KEYNOOPENCL))
+                       const KeywordFlagMasks &Masks, IdentifierTable &Table) {
+  if (Flags & Masks.Excluded)
     return;
 
   // Don't add this keyword if disabled in this language.
+  KeywordStatus AddResult = getKeywordStatus(Masks, Flags);
   if (AddResult == KS_Disabled) return;
 
   IdentifierInfo &Info =
@@ -213,16 +249,40 @@ static void AddObjCKeyword(StringRef Name,
   Table.get(Name).setObjCKeywordID(ObjCID);
 }
 
+namespace {
+
+  /// A keyword or keyword alias from TokenKinds.def.
+  struct KeywordEntry {
+    const char *Name;
+    unsigned Length;
+    tok::TokenKind TokenCode;
+    unsigned Flags;
+  };
+
+} // namespace
+
+/// Every keyword and keyword alias, so that AddKeywords walks a table
+/// instead of running the language checks inline for each one.
+static const KeywordEntry KeywordTable[] = {
+#define KEYWORD(NAME, FLAGS) \
+  {#NAME, sizeof(#NAME) - 1, tok::kw_ ## NAME, FLAGS},
+#define ALIAS(NAME, TOK, FLAGS) \
+  {NAME, sizeof(NAME) - 1, tok::kw_ ## TOK, FLAGS},
+#define TESTING_KEYWORD(NAME, FLAGS)
+#include "clang/Basic/TokenKinds.def"
+};
+
 /// AddKeywords - Add all keywords to the symbol table.
 ///
 void IdentifierTable::AddKeywords(const LangOptions &LangOpts) {
+  // Work out once which keyword flags this language turns on.
+  KeywordFlagMasks Masks = getKeywordFlagMasks(LangOpts);
+
   // Add keywords and tokens for the current language.
-#define KEYWORD(NAME, FLAGS) \
-  AddKeyword(StringRef(#NAME), tok::kw_ ## NAME,  \
-             FLAGS, LangOpts, *this);
-#define ALIAS(NAME, TOK, FLAGS) \
-  AddKeyword(StringRef(NAME), tok::kw_ ## TOK,  \
-             FLAGS, LangOpts, *this);
+  for (const KeywordEntry &Keyword : KeywordTable)
+    AddKeyword(StringRef(Keyword.Name, Keyword.Length), Keyword.TokenCode,
+               Keyword.Flags, Masks, *this);
+
 #define CXX_KEYWORD_OPERATOR(NAME, ALIAS) \
   if (LangOpts.CXXOperatorNames)          \
     AddCXXOperatorKeyword(StringRef(#NAME), tok::ALIAS, *this);
@@ -234,10 +294,10 @@ void IdentifierTable::AddKeywords(const LangOptions &LangOpts) {
 
   if (LangOpts.ParseUnknownAnytype)
     AddKeyword("__unknown_anytype", tok::kw___unknown_anytype, KEYALL,
-               LangOpts, *this);
+               Masks, *this);
 
   if (LangOpts.DeclSpecKeyword)
-    AddKeyword("__declspec", tok::kw___declspec, KEYALL, LangOpts, *this);
+    AddKeyword("__declspec", tok::kw___declspec, KEYALL, Masks, *this);
 
   // Add the '_experimental_modules_import' contextual keyword.
   get("import").setModulesImport(true);
@@ -304,6 +364,7 @@ tok::PPKeywordKind IdentifierInfo::getPPKeywordID() const {
   CASE( 4, 'e', 's', else);
   CASE( 4, 'l', 'n', line);
   CASE( 4, 's', 'c', sccs);
+  CASE( 5, 'e', 'b', embed);
   CASE( 5, 'e', 'd', endif);
   CASE( 5, 'e', 'r', error);
   CASE( 5, 'i', 'e', ident);
@@ -45,7 +45,32 @@ bool SanitizerBlacklist::isBlacklistedFile(SanitizerMask Mask,
 bool SanitizerBlacklist::isBlacklistedLocation(SanitizerMask Mask,
                                                SourceLocation Loc,
                                                StringRef Category) const {
-  return Loc.isValid() &&
-         isBlacklistedFile(Mask, SM.getFilename(SM.getFileLoc(Loc)), Category);
+  return getBlacklistedLocationKinds(Mask, Loc, Category) != 0;
+}
+
+SanitizerMask
+SanitizerBlacklist::getBlacklistedFunctionKinds(SanitizerMask Mask,
+                                                StringRef FunctionName) const {
+  return SSCL->inSections(Mask, "fun", FunctionName);
+}
+
+SanitizerMask
+SanitizerBlacklist::getBlacklistedLocationKinds(SanitizerMask Mask,
+                                                SourceLocation Loc,
+                                                StringRef Category) const {
+  if (Loc.isInvalid())
+    return 0;
+  FileID FID = SM.getFileID(SM.getFileLoc(Loc));
+  auto &Kinds = FileKinds[Category];
+  auto It = Kinds.find(FID);
+  if (It == Kinds.end()) {
+    // Cache the kinds for all sanitizers, so that queries with other masks
+    // hit the cache too.
+    SanitizerMask All = SSCL->inSections(SanitizerKind::All, "src",
+                                         SM.getFilename(SM.getFileLoc(Loc)),
+                                         Category);
+    It = Kinds.insert({FID, All}).first;
+  }
+  return It->second & Mask;
 }
 
@@ -62,3 +62,16 @@ bool SanitizerSpecialCaseList::inSection(SanitizerMask Mask, StringRef Prefix,
 
   return false;
 }
+
+SanitizerMask SanitizerSpecialCaseList::inSections(SanitizerMask Mask,
+                                                   StringRef Prefix,
+                                                   StringRef Query,
+                                                   StringRef Category) const {
+  SanitizerMask Result = 0;
+  for (auto &S : SanitizerSections)
+    if ((S.Mask & Mask & ~Result) &&
+        SpecialCaseList::inSectionBlame(S.Entries, Prefix, Query, Category))
+      Result |= S.Mask & Mask;
+
+  return Result;
+}
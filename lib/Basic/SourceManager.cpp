@@ -27,6 +27,7 @@
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/Capacity.h"
 #include "llvm/Support/Compiler.h"
+#include "llvm/Support/Endian.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MathExtras.h"
@@ -1192,10 +1193,65 @@ unsigned SourceManager::getPresumedColumnNumber(SourceLocation Loc,
   return PLoc.getColumn();
 }
 
-#ifdef __SSE2__
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
 #include <emmintrin.h>
 #endif
 
+namespace {
+
+/// Finds the '\n' and '\r' bytes in fixed-size blocks of a buffer.
+///
+/// find() returns a mask with one bit (or, without a vector unit, one byte)
+/// per input byte, set for line terminators; bitPos() maps a set bit back to
+/// a byte index within the block.
+struct NewlineScanner {
+#if defined(__AVX2__)
+  static const unsigned Width = 32;
+
+  static uint64_t find(const unsigned char *Ptr) {
+    __m256i Chunk = _mm256_loadu_si256((const __m256i *)Ptr);
+    __m256i Cmp =
+        _mm256_or_si256(_mm256_cmpeq_epi8(Chunk, _mm256_set1_epi8('\n')),
+                        _mm256_cmpeq_epi8(Chunk, _mm256_set1_epi8('\r')));
+    return (uint32_t)_mm256_movemask_epi8(Cmp);
+  }
+
+  static unsigned bitPos(unsigned Bit) { return Bit; }
+#elif defined(__SSE2__)
+  static const unsigned Width = 16;
+
+  static uint64_t find(const unsigned char *Ptr) {
+    __m128i Chunk = _mm_loadu_si128((const __m128i *)Ptr);
+    __m128i Cmp = _mm_or_si128(_mm_cmpeq_epi8(Chunk, _mm_set1_epi8('\n')),
+                               _mm_cmpeq_epi8(Chunk, _mm_set1_epi8('\r')));
+    return (unsigned)_mm_movemask_epi8(Cmp);
+  }
+
+  static unsigned bitPos(unsigned Bit) { return Bit; }
+#else
+  // Eight bytes at a time in a general purpose register.  The zero-byte test
+  // below is exact, so each set high bit marks a line terminator.
+  static const unsigned Width = 8;
+
+  static uint64_t zeroBytes(uint64_t V) {
+    const uint64_t Low7 = 0x7F7F7F7F7F7F7F7FULL;
+    return ~(((V & Low7) + Low7) | V | Low7);
+  }
+
+  static uint64_t find(const unsigned char *Ptr) {
+    uint64_t V = llvm::support::endian::read64le(Ptr);
+    return zeroBytes(V ^ 0x0A0A0A0A0A0A0A0AULL) |
+           zeroBytes(V ^ 0x0D0D0D0D0D0D0D0DULL);
+  }
+
+  static unsigned bitPos(unsigned Bit) { return Bit / 8; }
+#endif
+};
+
+} // end anonymous namespace
+
 static LLVM_ATTRIBUTE_NOINLINE void
 ComputeLineNumbers(DiagnosticsEngine &Diag, ContentCache *FI,
                    llvm::BumpPtrAllocator &Alloc,
@@ -1216,68 +1272,38 @@ static void ComputeLineNumbers(DiagnosticsEngine &Diag, ContentCache *FI,
   LineOffsets.push_back(0);
 
   const unsigned char *Buf = (const unsigned char *)Buffer->getBufferStart();
-  const unsigned char *End = (const unsigned char *)Buffer->getBufferEnd();
-  unsigned Offs = 0;
-  while (true) {
-    // Skip over the contents of the line.
-    const unsigned char *NextBuf = (const unsigned char *)Buf;
-
-#ifdef __SSE2__
-    // Try to skip to the next newline using SSE instructions. This is very
-    // performance sensitive for programs with lots of diagnostics and in -E
-    // mode.
-    __m128i CRs = _mm_set1_epi8('\r');
-    __m128i LFs = _mm_set1_epi8('\n');
-
-    // First fix up the alignment to 16 bytes.
-    while (((uintptr_t)NextBuf & 0xF) != 0) {
-      if (*NextBuf == '\n' || *NextBuf == '\r' || *NextBuf == '\0')
-        goto FoundSpecialChar;
-      ++NextBuf;
-    }
-
-    // Scan 16 byte chunks for '\r' and '\n'. Ignore '\0'.
-    while (NextBuf+16 <= End) {
-      const __m128i Chunk = *(const __m128i*)NextBuf;
-      __m128i Cmp = _mm_or_si128(_mm_cmpeq_epi8(Chunk, CRs),
-                                 _mm_cmpeq_epi8(Chunk, LFs));
-      unsigned Mask = _mm_movemask_epi8(Cmp);
-
-      // If we found a newline, adjust the pointer and jump to the handling code.
-      if (Mask != 0) {
-        NextBuf += llvm::countTrailingZeros(Mask);
-        goto FoundSpecialChar;
-      }
-      NextBuf += 16;
-    }
-#endif
-
-    while (*NextBuf != '\n' && *NextBuf != '\r' && *NextBuf != '\0')
-      ++NextBuf;
+  unsigned Size = Buffer->getBufferSize();
+
+  // The offset of the second character of the last "\r\n" or "\n\r" pair,
+  // which does not end another line.
+  unsigned PairEnd = ~0U;
+
+  // Record the line that starts after the terminator at Offs.  This is very
+  // performance sensitive for files with lots of diagnostics, for -E and for
+  // debug info, so the scan below finds every terminator in a block at once
+  // instead of restarting for each line.
+  auto AddLine = [&](unsigned Offs) {
+    if (Offs == PairEnd)
+      return;
+    unsigned Next = Offs + 1;
+    // If this is \n\r or \r\n, skip both characters.  The buffer is null
+    // terminated, so looking one past the end is fine.
+    if ((Buf[Next] == '\n' || Buf[Next] == '\r') && Buf[Next] != Buf[Offs])
+      PairEnd = Next++;
+    LineOffsets.push_back(Next);
+  };
 
-#ifdef __SSE2__
-FoundSpecialChar:
-#endif
-    Offs += NextBuf-Buf;
-    Buf = NextBuf;
-
-    if (Buf[0] == '\n' || Buf[0] == '\r') {
-      // If this is \n\r or \r\n, skip both characters.
-      if ((Buf[1] == '\n' || Buf[1] == '\r') && Buf[0] != Buf[1]) {
-        ++Offs;
-        ++Buf;
-      }
-      ++Offs;
-      ++Buf;
-      LineOffsets.push_back(Offs);
-    } else {
-      // Otherwise, this is a null.  If end of file, exit.
-      if (Buf == End) break;
-      // Otherwise, skip the null.
-      ++Offs;
-      ++Buf;
-    }
+  unsigned Offs = 0;
+  for (; Offs + NewlineScanner::Width <= Size;
+       Offs += NewlineScanner::Width) {
+    for (uint64_t Mask = NewlineScanner::find(Buf + Offs); Mask;
+         Mask &= Mask - 1)
+      AddLine(Offs +
+              NewlineScanner::bitPos(llvm::countTrailingZeros(Mask)));
   }
+  for (; Offs != Size; ++Offs)
+    if (Buf[Offs] == '\n' || Buf[Offs] == '\r')
+      AddLine(Offs);
 
   // Copy the offsets into the FileInfo structure.
   FI->NumLines = LineOffsets.size();
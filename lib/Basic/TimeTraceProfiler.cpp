@@ -0,0 +1,233 @@
+//===--- TimeTraceProfiler.cpp - Hierarchical compile time trace ----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the time trace profiler.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/TimeTraceProfiler.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <map>
+#include <vector>
+
+using namespace clang;
+
+namespace clang {
+
+TimeTraceProfiler *TimeTraceProfilerInstance = nullptr;
+
+class TimeTraceProfiler {
+  typedef std::chrono::steady_clock ClockType;
+  typedef std::chrono::microseconds DurationType;
+
+  struct Event {
+    ClockType::time_point Start;
+    DurationType Duration;
+
+    /// The time spent in the events directly nested inside this one.
+    DurationType NestedDuration;
+
+    std::string Name;
+    std::string Detail;
+    std::string Group;
+
+    size_t StartBytes;
+    size_t Bytes;
+
+    /// The number of events nested inside this one, at any depth.
+    unsigned NumNested;
+
+    TimeTraceTrack Track;
+  };
+
+  /// The costs attributed to one group of events with the same name.
+  struct Summary {
+    unsigned Count = 0;
+    DurationType Duration{0};
+    DurationType SelfDuration{0};
+    size_t Bytes = 0;
+  };
+
+  ClockType::time_point StartTime;
+  DurationType Granularity;
+  std::function<size_t()> AllocationCounter;
+
+  /// The events on each track that have begun but not ended, innermost last.
+  std::vector<Event> Stacks[TTT_NumTracks];
+
+  /// The ended events that are long enough to be written to the trace.
+  std::vector<Event> Events;
+
+  std::map<std::pair<std::string, std::string>, Summary> Summaries;
+
+  size_t getAllocatedBytes() const {
+    return AllocationCounter ? AllocationCounter() : 0;
+  }
+
+  int64_t getOffset(ClockType::time_point Time) const {
+    return std::chrono::duration_cast<DurationType>(Time - StartTime).count();
+  }
+
+public:
+  explicit TimeTraceProfiler(unsigned GranularityInMicroseconds)
+      : StartTime(ClockType::now()), Granularity(GranularityInMicroseconds) {}
+
+  std::function<size_t()>
+  setAllocationCounter(std::function<size_t()> Counter) {
+    std::swap(AllocationCounter, Counter);
+    return Counter;
+  }
+
+  void begin(StringRef Name, std::string Detail, std::string Group,
+             TimeTraceTrack Track) {
+    Stacks[Track].push_back({ClockType::now(), DurationType(0),
+                             DurationType(0), Name, std::move(Detail),
+                             std::move(Group), getAllocatedBytes(), 0, 0,
+                             Track});
+  }
+
+  void end(TimeTraceTrack Track) {
+    std::vector<Event> &Stack = Stacks[Track];
+    assert(!Stack.empty() && "ending an event that was not begun");
+    Event E = std::move(Stack.back());
+    Stack.pop_back();
+
+    E.Duration =
+        std::chrono::duration_cast<DurationType>(ClockType::now() - E.Start);
+    // The allocation counter may have been replaced while the event was
+    // active, so do not let the difference wrap around.
+    size_t EndBytes = getAllocatedBytes();
+    E.Bytes = EndBytes > E.StartBytes ? EndBytes - E.StartBytes : 0;
+
+    if (!Stack.empty()) {
+      Stack.back().NestedDuration += E.Duration;
+      Stack.back().NumNested += E.NumNested + 1;
+    }
+
+    DurationType SelfDuration =
+        E.Duration - std::min(E.NestedDuration, E.Duration);
+    Summary &S = Summaries[{E.Name, E.Group}];
+    ++S.Count;
+    S.Duration += E.Duration;
+    S.SelfDuration += SelfDuration;
+    S.Bytes += E.Bytes;
+    if (!E.Group.empty()) {
+      // Also keep a total across all groups.
+      Summary &Total = Summaries[{E.Name, std::string()}];
+      ++Total.Count;
+      Total.SelfDuration += SelfDuration;
+      // Only count the outermost event of a recursive chain, so that the
+      // total is not inflated.
+      if (llvm::none_of(Stack, [&](const Event &Outer) {
+            return Outer.Name == E.Name;
+          })) {
+        Total.Duration += E.Duration;
+        Total.Bytes += E.Bytes;
+      }
+    }
+
+    if (E.Duration >= Granularity)
+      Events.push_back(std::move(E));
+  }
+
+  void write(raw_ostream &OS) {
+    // Events can still be active if the compilation stopped early, for
+    // example in the middle of an included file after a fatal error.
+    for (unsigned Track = 0; Track != TTT_NumTracks; ++Track)
+      while (!Stacks[Track].empty())
+        end(TimeTraceTrack(Track));
+
+    llvm::json::Array TraceEvents;
+    for (const Event &E : Events) {
+      llvm::json::Object Args{{"bytes", int64_t(E.Bytes)},
+                              {"nested", int64_t(E.NumNested)}};
+      if (!E.Detail.empty())
+        Args["detail"] = E.Detail;
+      TraceEvents.push_back(llvm::json::Object{
+          {"pid", 1},
+          {"tid", int64_t(E.Track)},
+          {"ph", "X"},
+          {"ts", getOffset(E.Start)},
+          {"dur", int64_t(E.Duration.count())},
+          {"name", E.Name},
+          {"args", std::move(Args)}});
+    }
+
+    // List the most expensive groups first.
+    std::vector<std::pair<const std::pair<std::string, std::string> *,
+                          const Summary *>>
+        SortedSummaries;
+    for (const auto &S : Summaries)
+      SortedSummaries.push_back({&S.first, &S.second});
+    std::stable_sort(SortedSummaries.begin(), SortedSummaries.end(),
+                     [](const decltype(SortedSummaries)::value_type &LHS,
+                        const decltype(SortedSummaries)::value_type &RHS) {
+                       return LHS.second->SelfDuration >
+                              RHS.second->SelfDuration;
+                     });
+
+    llvm::json::Array SummaryEntries;
+    for (const auto &S : SortedSummaries) {
+      llvm::json::Object Entry{
+          {"name", S.first->first},
+          {"count", int64_t(S.second->Count)},
+          {"dur", int64_t(S.second->Duration.count())},
+          {"self", int64_t(S.second->SelfDuration.count())},
+          {"bytes", int64_t(S.second->Bytes)}};
+      if (!S.first->second.empty())
+        Entry["group"] = S.first->second;
+      SummaryEntries.push_back(std::move(Entry));
+    }
+
+    OS << llvm::json::Value(
+              llvm::json::Object{{"traceEvents", std::move(TraceEvents)},
+                                 {"summary", std::move(SummaryEntries)}})
+       << "\n";
+  }
+};
+
+} // end namespace clang
+
+void clang::timeTraceProfilerInitialize(unsigned GranularityInMicroseconds) {
+  assert(!TimeTraceProfilerInstance && "profiler already initialized");
+  TimeTraceProfilerInstance = new TimeTraceProfiler(GranularityInMicroseconds);
+}
+
+void clang::timeTraceProfilerCleanup() {
+  delete TimeTraceProfilerInstance;
+  TimeTraceProfilerInstance = nullptr;
+}
+
+void clang::timeTraceProfilerWrite(raw_ostream &OS) {
+  assert(TimeTraceProfilerInstance && "profiler is not initialized");
+  TimeTraceProfilerInstance->write(OS);
+}
+
+std::function<size_t()> clang::timeTraceProfilerSetAllocationCounter(
+    std::function<size_t()> Counter) {
+  if (!TimeTraceProfilerInstance)
+    return nullptr;
+  return TimeTraceProfilerInstance->setAllocationCounter(std::move(Counter));
+}
+
+void clang::timeTraceProfilerBegin(StringRef Name, std::string Detail,
+                                   std::string Group, TimeTraceTrack Track) {
+  if (TimeTraceProfilerInstance)
+    TimeTraceProfilerInstance->begin(Name, std::move(Detail),
+                                     std::move(Group), Track);
+}
+
+void clang::timeTraceProfilerEnd(TimeTraceTrack Track) {
+  if (TimeTraceProfilerInstance)
+    TimeTraceProfilerInstance->end(Track);
+}
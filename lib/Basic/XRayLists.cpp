@@ -64,6 +64,15 @@ XRayFunctionFilter::shouldImbueLocation(SourceLocation Loc,
                                         StringRef Category) const {
   if (!Loc.isValid())
     return ImbueAttribute::NONE;
-  return this->shouldImbueFunctionsInFile(SM.getFilename(SM.getFileLoc(Loc)),
-                                          Category);
+  // Most functions are in one of a few files, so remember the result for each
+  // file rather than matching its name against the lists every time.
+  SourceLocation FileLoc = SM.getFileLoc(Loc);
+  auto &Attrs = FileAttrs[Category];
+  auto It = Attrs.find(SM.getFileID(FileLoc));
+  if (It != Attrs.end())
+    return It->second;
+  ImbueAttribute Attr =
+      shouldImbueFunctionsInFile(SM.getFilename(FileLoc), Category);
+  Attrs.insert({SM.getFileID(FileLoc), Attr});
+  return Attr;
 }
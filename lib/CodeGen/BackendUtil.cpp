@@ -11,11 +11,13 @@
 #include "clang/Basic/Diagnostic.h"
 #include "clang/Basic/LangOptions.h"
 #include "clang/Basic/TargetOptions.h"
+#include "clang/Basic/TimeTraceProfiler.h"
 #include "clang/Frontend/CodeGenOptions.h"
 #include "clang/Frontend/FrontendDiagnostic.h"
 #include "clang/Frontend/Utils.h"
 #include "clang/Lex/HeaderSearchOptions.h"
 #include "llvm/ADT/SmallSet.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/ADT/Triple.h"
@@ -29,6 +31,7 @@
 #include "llvm/CodeGen/TargetSubtargetInfo.h"
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/IRPrintingPasses.h"
+#include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/ModuleSummaryIndex.h"
@@ -42,6 +45,7 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetMachine.h"
@@ -59,8 +63,11 @@
 #include "llvm/Transforms/Scalar.h"
 #include "llvm/Transforms/Scalar/GVN.h"
 #include "llvm/Transforms/Utils.h"
+#include "llvm/Transforms/Utils/Cloning.h"
 #include "llvm/Transforms/Utils/NameAnonGlobals.h"
+#include "llvm/Transforms/Utils/SplitModule.h"
 #include "llvm/Transforms/Utils/SymbolRewriter.h"
+#include <atomic>
 #include <memory>
 using namespace clang;
 using namespace llvm;
@@ -107,6 +114,11 @@ class EmitAssemblyHelper {
   bool AddEmitPasses(legacy::PassManager &CodeGenPasses, BackendAction Action,
                      raw_pwrite_stream &OS, raw_pwrite_stream *DwoOS);
 
+  /// Generate object code for the module, split into partitions that are
+  /// code generated in parallel. The first partition is written to \p OS,
+  /// the others to CodeGenOpts.ParallelCodeGenOutputs.
+  void EmitObjectPartitions(raw_pwrite_stream &OS);
+
   std::unique_ptr<llvm::ToolOutputFile> openOutputFile(StringRef Path) {
     std::error_code EC;
     auto F = llvm::make_unique<llvm::ToolOutputFile>(Path, EC,
@@ -767,6 +779,83 @@ bool EmitAssemblyHelper::AddEmitPasses(legacy::PassManager &CodeGenPasses,
   return true;
 }
 
+void EmitAssemblyHelper::EmitObjectPartitions(raw_pwrite_stream &OS) {
+  std::vector<std::unique_ptr<llvm::ToolOutputFile>> PartitionFiles;
+  SmallVector<raw_pwrite_stream *, 4> OSs;
+  OSs.push_back(&OS);
+  for (const std::string &Path : CodeGenOpts.ParallelCodeGenOutputs) {
+    PartitionFiles.push_back(openOutputFile(Path));
+    if (!PartitionFiles.back())
+      return;
+    OSs.push_back(&PartitionFiles.back()->os());
+  }
+
+  llvm::Triple TargetTriple(TheModule->getTargetTriple());
+  std::atomic<bool> Failed(false);
+  auto CodeGenPartition = [&](raw_pwrite_stream *PartOS,
+                              const SmallString<0> &BC) {
+    LLVMContext Ctx;
+    Expected<std::unique_ptr<Module>> MOrErr = parseBitcodeFile(
+        MemoryBufferRef(StringRef(BC.data(), BC.size()), "<split-module>"),
+        Ctx);
+    if (!MOrErr)
+      report_fatal_error("Failed to read bitcode");
+    std::unique_ptr<Module> MPart = std::move(MOrErr.get());
+
+    std::unique_ptr<TargetMachine> PartTM(TM->getTarget().createTargetMachine(
+        TM->getTargetTriple().str(), TM->getTargetCPU(),
+        TM->getTargetFeatureString(), TM->Options, TM->getRelocationModel(),
+        TM->getCodeModel(), TM->getOptLevel()));
+
+    // Set up the same code generation passes as AddEmitPasses.
+    legacy::PassManager CodeGenPasses;
+    CodeGenPasses.add(
+        createTargetTransformInfoWrapperPass(PartTM->getTargetIRAnalysis()));
+    std::unique_ptr<TargetLibraryInfoImpl> TLII(
+        createTLII(TargetTriple, CodeGenOpts));
+    CodeGenPasses.add(new TargetLibraryInfoWrapperPass(*TLII));
+    if (CodeGenOpts.OptimizationLevel > 0)
+      CodeGenPasses.add(createObjCARCContractPass());
+    if (PartTM->addPassesToEmitFile(
+            CodeGenPasses, *PartOS, /*DwoOut=*/nullptr,
+            TargetMachine::CGFT_ObjectFile,
+            /*DisableVerify=*/!CodeGenOpts.VerifyModule)) {
+      Failed = true;
+      return;
+    }
+    CodeGenPasses.run(*MPart);
+  };
+
+  // An LLVMContext can't be used from several threads, so, like
+  // llvm::splitCodeGen, hand each partition to its thread as bitcode to be
+  // loaded into a context of its own. SplitModule consumes the module it
+  // splits, and ours belongs to the caller, so split a copy of it. Keep the
+  // local symbols in the partition of their users: promoting them would give
+  // the local symbols of different translation units the same external
+  // names, which the link rejects as duplicates.
+  {
+    PrettyStackTraceString CrashInfo("Parallel code generation");
+    ThreadPool Pool(OSs.size());
+    unsigned Partition = 0;
+    SplitModule(CloneModule(*TheModule), OSs.size(),
+                [&](std::unique_ptr<Module> MPart) {
+                  SmallString<0> BC;
+                  raw_svector_ostream BCOS(BC);
+                  WriteBitcodeToFile(*MPart, BCOS);
+                  Pool.async(CodeGenPartition, OSs[Partition++],
+                             std::move(BC));
+                },
+                /*PreserveLocals=*/true);
+  }
+
+  if (Failed) {
+    Diags.Report(diag::err_fe_unable_to_interface_with_target);
+    return;
+  }
+  for (auto &F : PartitionFiles)
+    F->keep();
+}
+
 void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
                                       std::unique_ptr<raw_pwrite_stream> OS) {
   TimeRegion Region(FrontendTimesIsEnabled ? &CodeGenerationTime : nullptr);
@@ -798,6 +887,8 @@ void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
       createTargetTransformInfoWrapperPass(getTargetIRAnalysis()));
 
   std::unique_ptr<llvm::ToolOutputFile> ThinLinkOS, DwoOS;
+  bool PartitionCodeGen = Action == Backend_EmitObj &&
+                          !CodeGenOpts.ParallelCodeGenOutputs.empty();
 
   switch (Action) {
   case Backend_EmitNothing:
@@ -835,6 +926,8 @@ void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
     break;
 
   default:
+    if (PartitionCodeGen)
+      break;
     if (!CodeGenOpts.SplitDwarfFile.empty() &&
         (CodeGenOpts.getSplitDwarfMode() == CodeGenOptions::SplitFileFission)) {
       DwoOS = openOutputFile(CodeGenOpts.SplitDwarfFile);
@@ -851,9 +944,11 @@ void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
 
   // Run passes. For now we do all passes at once, but eventually we
   // would like to have the option of streaming code generation.
+  auto GetModuleName = [&]() { return TheModule->getModuleIdentifier(); };
 
   {
     PrettyStackTraceString CrashInfo("Per-function optimization");
+    TimeTraceScope TimeScope("OptFunction", GetModuleName);
 
     PerFunctionPasses.doInitialization();
     for (Function &F : *TheModule)
@@ -864,11 +959,16 @@ void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
 
   {
     PrettyStackTraceString CrashInfo("Per-module optimization passes");
+    TimeTraceScope TimeScope("OptModule", GetModuleName);
     PerModulePasses.run(*TheModule);
   }
 
-  {
+  if (PartitionCodeGen) {
+    TimeTraceScope TimeScope("CodeGenPasses", GetModuleName);
+    EmitObjectPartitions(*OS);
+  } else {
     PrettyStackTraceString CrashInfo("Code generation");
+    TimeTraceScope TimeScope("CodeGenPasses", GetModuleName);
     CodeGenPasses.run(*TheModule);
   }
 
@@ -1032,6 +1132,7 @@ void EmitAssemblyHelper::EmitAssemblyWithNewPassManager(
   // create that pass manager here and use it as needed below.
   legacy::PassManager CodeGenPasses;
   bool NeedCodeGen = false;
+  bool PartitionCodeGen = false;
   std::unique_ptr<llvm::ToolOutputFile> ThinLinkOS, DwoOS;
 
   // Append any output we need to the pass manager.
@@ -1071,6 +1172,11 @@ void EmitAssemblyHelper::EmitAssemblyWithNewPassManager(
   case Backend_EmitAssembly:
   case Backend_EmitMCNull:
   case Backend_EmitObj:
+    if (Action == Backend_EmitObj &&
+        !CodeGenOpts.ParallelCodeGenOutputs.empty()) {
+      PartitionCodeGen = true;
+      break;
+    }
     NeedCodeGen = true;
     CodeGenPasses.add(
         createTargetTransformInfoWrapperPass(getTargetIRAnalysis()));
@@ -1090,15 +1196,21 @@ void EmitAssemblyHelper::EmitAssemblyWithNewPassManager(
   cl::PrintOptionValues();
 
   // Now that we have all of the passes ready, run them.
+  auto GetModuleName = [&]() { return TheModule->getModuleIdentifier(); };
   {
     PrettyStackTraceString CrashInfo("Optimizer");
+    TimeTraceScope TimeScope("OptModule", GetModuleName);
     MPM.run(*TheModule, MAM);
   }
 
   // Now if needed, run the legacy PM for codegen.
   if (NeedCodeGen) {
     PrettyStackTraceString CrashInfo("Code generation");
+    TimeTraceScope TimeScope("CodeGenPasses", GetModuleName);
     CodeGenPasses.run(*TheModule);
+  } else if (PartitionCodeGen) {
+    TimeTraceScope TimeScope("CodeGenPasses", GetModuleName);
+    EmitObjectPartitions(*OS);
   }
 
   if (ThinLinkOS)
@@ -1292,6 +1404,8 @@ void clang::EmitBackendOutput(DiagnosticsEngine &Diags,
     }
   }
 
+  TimeTraceScope TimeScope("Backend",
+                           [&]() { return M->getModuleIdentifier(); });
   EmitAssemblyHelper AsmHelper(Diags, HeaderOpts, CGOpts, TOpts, LOpts, M);
 
   if (CGOpts.ExperimentalNewPassManager)
@@ -69,6 +69,35 @@ llvm::Constant *CodeGenModule::getBuiltinLibFunction(const FunctionDecl *FD,
   return GetOrCreateLLVMFunction(Name, Ty, D, /*ForVTable=*/false);
 }
 
+/// getTargetBuiltinIntrinsicID - Given a builtin id for a target builtin,
+/// return the intrinsic of the same name for the target, if there is one.
+/// Most target builtins are lowered by hand instead, and every call to one of
+/// them would otherwise search the GCC and MS builtin name tables and miss,
+/// so the result of the search is kept for each builtin.
+unsigned CodeGenModule::getTargetBuiltinIntrinsicID(unsigned BuiltinID) {
+  auto Insert = TargetBuiltinIntrinsics.insert(
+      std::make_pair(BuiltinID, unsigned(Intrinsic::not_intrinsic)));
+  if (!Insert.second)
+    return Insert.first->second;
+
+  StringRef Prefix =
+      llvm::Triple::getArchTypePrefix(getTarget().getTriple().getArch());
+  if (Prefix.empty())
+    return Intrinsic::not_intrinsic;
+
+  const char *Name = Context.BuiltinInfo.getName(BuiltinID);
+  Intrinsic::ID IntrinsicID =
+      Intrinsic::getIntrinsicForGCCBuiltin(Prefix.data(), Name);
+  // NOTE we don't need to perform a compatibility flag check here since the
+  // intrinsics are declared in Builtins*.def via LANGBUILTIN which filter the
+  // MS builtins via ALL_MS_LANGUAGES and are filtered earlier.
+  if (IntrinsicID == Intrinsic::not_intrinsic)
+    IntrinsicID = Intrinsic::getIntrinsicForMSBuiltin(Prefix.data(), Name);
+
+  // The lookups above don't touch the map, so the entry is still valid.
+  return Insert.first->second = IntrinsicID;
+}
+
 /// Emit the conversions required to turn the given value into an
 /// integer of the given size.
 static Value *EmitToInt(CodeGenFunction &CGF, llvm::Value *V,
@@ -3893,18 +3922,8 @@ RValue CodeGenFunction::EmitBuiltinExpr(const GlobalDecl GD, unsigned BuiltinID,
     LargestVectorWidth = std::max(LargestVectorWidth, VectorWidth);
 
   // See if we have a target specific intrinsic.
-  const char *Name = getContext().BuiltinInfo.getName(BuiltinID);
-  Intrinsic::ID IntrinsicID = Intrinsic::not_intrinsic;
-  StringRef Prefix =
-      llvm::Triple::getArchTypePrefix(getTarget().getTriple().getArch());
-  if (!Prefix.empty()) {
-    IntrinsicID = Intrinsic::getIntrinsicForGCCBuiltin(Prefix.data(), Name);
-    // NOTE we don't need to perform a compatibility flag check here since the
-    // intrinsics are declared in Builtins*.def via LANGBUILTIN which filter the
-    // MS builtins via ALL_MS_LANGUAGES and are filtered earlier.
-    if (IntrinsicID == Intrinsic::not_intrinsic)
-      IntrinsicID = Intrinsic::getIntrinsicForMSBuiltin(Prefix.data(), Name);
-  }
+  Intrinsic::ID IntrinsicID =
+      static_cast<Intrinsic::ID>(CGM.getTargetBuiltinIntrinsicID(BuiltinID));
 
   if (IntrinsicID != Intrinsic::not_intrinsic) {
     SmallVector<Value*, 16> Args;
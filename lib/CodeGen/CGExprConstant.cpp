@@ -701,6 +701,187 @@ EmitArrayConstant(CodeGenModule &CGM, const ConstantArrayType *DestType,
   return llvm::ConstantStruct::get(SType, Elements);
 }
 
+/// Returns the bits of element \p I of a data array, or None if the element
+/// is not a plain integer or floating-point value.
+using DataArrayElementFn = llvm::function_ref<Optional<uint64_t>(unsigned I)>;
+
+template <typename T>
+static llvm::Constant *getDataArray(llvm::LLVMContext &Ctx, bool IsFP,
+                                    ArrayRef<T> Elts) {
+  if (IsFP)
+    return llvm::ConstantDataArray::getFP(Ctx, Elts);
+  return llvm::ConstantDataArray::get(Ctx, Elts);
+}
+
+static llvm::Constant *getDataArray(llvm::LLVMContext &Ctx, bool IsFP,
+                                    ArrayRef<uint8_t> Elts) {
+  return llvm::ConstantDataArray::get(Ctx, Elts);
+}
+
+template <typename T>
+static llvm::Constant *
+emitDataArrayConstant(CodeGenModule &CGM, const ConstantArrayType *DestType,
+                      llvm::Type *ElementType, unsigned NumInitElts,
+                      DataArrayElementFn GetElement, uint64_t FillerBits) {
+  uint64_t ArrayBound = DestType->getSize().getZExtValue();
+  NumInitElts = std::min<uint64_t>(NumInitElts, ArrayBound);
+
+  SmallVector<T, 64> Data;
+  Data.reserve(NumInitElts);
+  for (unsigned I = 0; I != NumInitElts; ++I) {
+    Optional<uint64_t> Bits = GetElement(I);
+    if (!Bits)
+      return nullptr;
+    Data.push_back(T(*Bits));
+  }
+
+  // Lay out the zeroes the same way as EmitArrayConstant.
+  uint64_t NonzeroLength = ArrayBound;
+  if (Data.size() < NonzeroLength && FillerBits == 0)
+    NonzeroLength = Data.size();
+  if (NonzeroLength == Data.size()) {
+    while (NonzeroLength > 0 && Data[NonzeroLength - 1] == 0)
+      --NonzeroLength;
+  }
+
+  if (NonzeroLength == 0)
+    return llvm::ConstantAggregateZero::get(
+        CGM.getTypes().ConvertType(QualType(DestType, 0)));
+
+  auto GetData = [&](ArrayRef<T> Elts) {
+    return getDataArray(CGM.getLLVMContext(),
+                        ElementType->isFloatingPointTy(), Elts);
+  };
+
+  uint64_t TrailingZeroes = ArrayBound - NonzeroLength;
+  if (TrailingZeroes >= 8) {
+    // A short prefix becomes a struct of its elements; leave that to the
+    // generic path.
+    if (NonzeroLength < 8)
+      return nullptr;
+    Data.resize(NonzeroLength);
+    llvm::Constant *Elements[] = {
+        GetData(Data),
+        llvm::ConstantAggregateZero::get(
+            llvm::ArrayType::get(ElementType, TrailingZeroes))};
+    return llvm::ConstantStruct::getAnon(CGM.getLLVMContext(), Elements,
+                                         /*Packed=*/true);
+  }
+
+  Data.resize(ArrayBound, T(FillerBits));
+  return GetData(Data);
+}
+
+/// Try to emit an array of integers or of half, float or double values
+/// straight into a ConstantDataArray, without creating a constant for each
+/// element first. This is what makes large tables, such as embedded binary
+/// data, cheap to emit.
+///
+/// Elements past \p NumInitElts have the bits \p FillerBits. Returns null if
+/// the element type has no data array form, or if \p GetElement fails for
+/// some element.
+static llvm::Constant *
+tryEmitDataArrayConstant(CodeGenModule &CGM, const ConstantArrayType *DestType,
+                         unsigned NumInitElts, DataArrayElementFn GetElement,
+                         uint64_t FillerBits) {
+  if (!DestType)
+    return nullptr;
+  llvm::Type *ElementType =
+      CGM.getTypes().ConvertTypeForMem(DestType->getElementType());
+  if (ElementType->isHalfTy())
+    return emitDataArrayConstant<uint16_t>(CGM, DestType, ElementType,
+                                           NumInitElts, GetElement, FillerBits);
+  if (ElementType->isFloatTy())
+    return emitDataArrayConstant<uint32_t>(CGM, DestType, ElementType,
+                                           NumInitElts, GetElement, FillerBits);
+  if (ElementType->isDoubleTy())
+    return emitDataArrayConstant<uint64_t>(CGM, DestType, ElementType,
+                                           NumInitElts, GetElement, FillerBits);
+  if (!ElementType->isIntegerTy())
+    return nullptr;
+  switch (ElementType->getIntegerBitWidth()) {
+  case 8:
+    return emitDataArrayConstant<uint8_t>(CGM, DestType, ElementType,
+                                          NumInitElts, GetElement, FillerBits);
+  case 16:
+    return emitDataArrayConstant<uint16_t>(CGM, DestType, ElementType,
+                                           NumInitElts, GetElement, FillerBits);
+  case 32:
+    return emitDataArrayConstant<uint32_t>(CGM, DestType, ElementType,
+                                           NumInitElts, GetElement, FillerBits);
+  case 64:
+    return emitDataArrayConstant<uint64_t>(CGM, DestType, ElementType,
+                                           NumInitElts, GetElement, FillerBits);
+  default:
+    return nullptr;
+  }
+}
+
+/// Returns the bits of an integer or floating-point APValue whose width is
+/// \p Bits, or None.
+static Optional<uint64_t> getDataArrayElement(const APValue &Value,
+                                              unsigned Bits) {
+  llvm::APInt Int;
+  if (Value.isInt())
+    Int = Value.getInt();
+  else if (Value.isFloat())
+    Int = Value.getFloat().bitcastToAPInt();
+  else
+    return None;
+  if (Int.getBitWidth() != Bits)
+    return None;
+  return Int.getZExtValue();
+}
+
+/// Returns the bits of an array element initializer that is an integer or
+/// floating-point literal, possibly converted to the element type \p EltType,
+/// or None.
+static Optional<uint64_t> getDataArrayElement(ASTContext &Ctx, const Expr *E,
+                                              QualType EltType,
+                                              unsigned Bits) {
+  E = E->IgnoreParens();
+  if (const auto *ICE = dyn_cast<ImplicitCastExpr>(E)) {
+    if (ICE->getCastKind() != CK_IntegralCast &&
+        ICE->getCastKind() != CK_FloatingCast &&
+        ICE->getCastKind() != CK_NoOp)
+      return None;
+    E = ICE->getSubExpr()->IgnoreParens();
+  }
+
+  if (EltType->isBooleanType())
+    return None;
+  if (EltType->isIntegerType()) {
+    llvm::APSInt Value;
+    if (const auto *IL = dyn_cast<IntegerLiteral>(E))
+      Value = llvm::APSInt(IL->getValue(),
+                           IL->getType()->isUnsignedIntegerType());
+    else if (const auto *CL = dyn_cast<CharacterLiteral>(E))
+      Value = llvm::APSInt(
+          llvm::APInt(Ctx.getIntWidth(CL->getType()), CL->getValue()),
+          CL->getType()->isUnsignedIntegerType());
+    else
+      return None;
+    if (Ctx.getIntWidth(EltType) != Bits)
+      return None;
+    return Value.extOrTrunc(Bits).getZExtValue();
+  }
+
+  if (EltType->isRealFloatingType()) {
+    const auto *FL = dyn_cast<FloatingLiteral>(E);
+    if (!FL)
+      return None;
+    llvm::APFloat Value = FL->getValue();
+    bool LosesInfo;
+    Value.convert(Ctx.getFloatTypeSemantics(EltType),
+                  llvm::APFloat::rmNearestTiesToEven, &LosesInfo);
+    llvm::APInt Int = Value.bitcastToAPInt();
+    if (Int.getBitWidth() != Bits)
+      return None;
+    return Int.getZExtValue();
+  }
+  return None;
+}
+
 /// This class only needs to handle two cases:
 /// 1) Literals (this is used by APValue emission to emit literals).
 /// 2) Arrays, structs and unions (outside C++11 mode, we don't currently
@@ -914,6 +1095,21 @@ public:
 
     QualType EltType = CAT->getElementType();
 
+    // Tables of literals don't need a constant per element.
+    Expr *Filler = ILE->getArrayFiller();
+    if (NumElements >= 8 && (!Filler || isa<ImplicitValueInitExpr>(Filler))) {
+      ASTContext &Ctx = CGM.getContext();
+      unsigned Bits = Ctx.getTypeSize(EltType);
+      if (llvm::Constant *C = tryEmitDataArrayConstant(
+              CGM, CAT, NumInitableElts,
+              [&](unsigned I) {
+                return getDataArrayElement(Ctx, ILE->getInit(I), EltType,
+                                           Bits);
+              },
+              /*FillerBits=*/0))
+        return C;
+    }
+
     // Initialize remaining array elements.
     llvm::Constant *fillC = nullptr;
     if (Expr *filler = ILE->getArrayFiller()) {
@@ -1950,6 +2146,24 @@ llvm::Constant *ConstantEmitter::tryEmitPrivate(const APValue &Value,
     unsigned NumElements = Value.getArraySize();
     unsigned NumInitElts = Value.getArrayInitializedElts();
 
+    // Tables of numbers, such as embedded data, don't need a constant per
+    // element.
+    if (CAT && NumElements >= 8) {
+      unsigned Bits = CGM.getContext().getTypeSize(CAT->getElementType());
+      Optional<uint64_t> FillerBits = 0;
+      if (Value.hasArrayFiller())
+        FillerBits = getDataArrayElement(Value.getArrayFiller(), Bits);
+      if (FillerBits)
+        if (llvm::Constant *C = tryEmitDataArrayConstant(
+                CGM, CAT, NumInitElts,
+                [&](unsigned I) {
+                  return getDataArrayElement(
+                      Value.getArrayInitializedElt(I), Bits);
+                },
+                *FillerBits))
+          return C;
+    }
+
     // Emit array filler, if there is one.
     llvm::Constant *Filler = nullptr;
     if (Value.hasArrayFiller()) {
@@ -2626,13 +2626,11 @@ llvm::Function *CGOpenMPRuntime::emitThreadPrivateVarDefinition(
   return nullptr;
 }
 
-/// Obtain information that uniquely identifies a target entry. This
-/// consists of the file and device IDs as well as line number associated with
-/// the relevant entry source location.
-static void getTargetEntryUniqueInfo(ASTContext &C, SourceLocation Loc,
-                                     unsigned &DeviceID, unsigned &FileID,
-                                     unsigned &LineNum) {
-  SourceManager &SM = C.getSourceManager();
+void CGOpenMPRuntime::getTargetEntryUniqueInfo(SourceLocation Loc,
+                                               unsigned &DeviceID,
+                                               unsigned &FileID,
+                                               unsigned &LineNum) {
+  SourceManager &SM = CGM.getContext().getSourceManager();
 
   // The loc should be always valid and have a file ID (the user cannot use
   // #pragma directives in macros)
@@ -2642,14 +2640,22 @@ static void getTargetEntryUniqueInfo(ASTContext &C, SourceLocation Loc,
   PresumedLoc PLoc = SM.getPresumedLoc(Loc);
   assert(PLoc.isValid() && "Source location is expected to be always valid.");
 
-  llvm::sys::fs::UniqueID ID;
-  if (auto EC = llvm::sys::fs::getUniqueID(PLoc.getFilename(), ID))
-    SM.getDiagnostics().Report(diag::err_cannot_open_file)
-        << PLoc.getFilename() << EC.message();
-
-  DeviceID = ID.getDevice();
-  FileID = ID.getFile();
   LineNum = PLoc.getLine();
+
+  // Files usually have many target regions, so only ask the file system for
+  // the IDs of a file once.
+  auto InsertResult = TargetEntryFileIDs.try_emplace(PLoc.getFilename());
+  std::pair<unsigned, unsigned> &IDs = InsertResult.first->second;
+  if (InsertResult.second) {
+    llvm::sys::fs::UniqueID ID;
+    if (auto EC = llvm::sys::fs::getUniqueID(PLoc.getFilename(), ID))
+      SM.getDiagnostics().Report(diag::err_cannot_open_file)
+          << PLoc.getFilename() << EC.message();
+    IDs = std::make_pair(ID.getDevice(), ID.getFile());
+  }
+
+  DeviceID = IDs.first;
+  FileID = IDs.second;
 }
 
 bool CGOpenMPRuntime::emitDeclareTargetVarDefinition(const VarDecl *VD,
@@ -2672,7 +2678,7 @@ bool CGOpenMPRuntime::emitDeclareTargetVarDefinition(const VarDecl *VD,
   unsigned DeviceID;
   unsigned FileID;
   unsigned Line;
-  getTargetEntryUniqueInfo(CGM.getContext(), Loc, DeviceID, FileID, Line);
+  getTargetEntryUniqueInfo(Loc, DeviceID, FileID, Line);
   SmallString<128> Buffer, Out;
   {
     llvm::raw_svector_ostream OS(Buffer);
@@ -3641,19 +3647,19 @@ void CGOpenMPRuntime::OffloadEntriesInfoManagerTy::
   // If we are emitting code for a target, the entry is already initialized,
   // only has to be registered.
   if (CGM.getLangOpts().OpenMPIsDevice) {
-    if (!hasTargetRegionEntryInfo(DeviceID, FileID, ParentName, LineNum)) {
+    OffloadEntryInfoTargetRegion *Entry =
+        findTargetRegionEntryInfo(DeviceID, FileID, ParentName, LineNum);
+    if (!Entry || Entry->getAddress() || Entry->getID()) {
       unsigned DiagID = CGM.getDiags().getCustomDiagID(
           DiagnosticsEngine::Error,
           "Unable to find target region on line '%0' in the device code.");
       CGM.getDiags().Report(DiagID) << LineNum;
       return;
     }
-    auto &Entry =
-        OffloadEntriesTargetRegion[DeviceID][FileID][ParentName][LineNum];
-    assert(Entry.isValid() && "Entry not initialized!");
-    Entry.setAddress(Addr);
-    Entry.setID(ID);
-    Entry.setFlags(Flags);
+    assert(Entry->isValid() && "Entry not initialized!");
+    Entry->setAddress(Addr);
+    Entry->setID(ID);
+    Entry->setFlags(Flags);
   } else {
     OffloadEntryInfoTargetRegion Entry(OffloadingEntriesNum, Addr, ID, Flags);
     OffloadEntriesTargetRegion[DeviceID][FileID][ParentName][LineNum] = Entry;
@@ -3661,25 +3667,32 @@ void CGOpenMPRuntime::OffloadEntriesInfoManagerTy::
   }
 }
 
-bool CGOpenMPRuntime::OffloadEntriesInfoManagerTy::hasTargetRegionEntryInfo(
+CGOpenMPRuntime::OffloadEntriesInfoManagerTy::OffloadEntryInfoTargetRegion *
+CGOpenMPRuntime::OffloadEntriesInfoManagerTy::findTargetRegionEntryInfo(
     unsigned DeviceID, unsigned FileID, StringRef ParentName,
-    unsigned LineNum) const {
+    unsigned LineNum) {
   auto PerDevice = OffloadEntriesTargetRegion.find(DeviceID);
   if (PerDevice == OffloadEntriesTargetRegion.end())
-    return false;
+    return nullptr;
   auto PerFile = PerDevice->second.find(FileID);
   if (PerFile == PerDevice->second.end())
-    return false;
+    return nullptr;
   auto PerParentName = PerFile->second.find(ParentName);
   if (PerParentName == PerFile->second.end())
-    return false;
+    return nullptr;
   auto PerLine = PerParentName->second.find(LineNum);
   if (PerLine == PerParentName->second.end())
-    return false;
+    return nullptr;
+  return &PerLine->second;
+}
+
+bool CGOpenMPRuntime::OffloadEntriesInfoManagerTy::hasTargetRegionEntryInfo(
+    unsigned DeviceID, unsigned FileID, StringRef ParentName,
+    unsigned LineNum) const {
+  const OffloadEntryInfoTargetRegion *Entry =
+      findTargetRegionEntryInfo(DeviceID, FileID, ParentName, LineNum);
   // Fail if this entry is already registered.
-  if (PerLine->second.getAddress() || PerLine->second.getID())
-    return false;
-  return true;
+  return Entry && !Entry->getAddress() && !Entry->getID();
 }
 
 void CGOpenMPRuntime::OffloadEntriesInfoManagerTy::actOnTargetRegionEntriesInfo(
@@ -6325,7 +6338,7 @@ void CGOpenMPRuntime::emitTargetOutlinedFunctionHelper(
   unsigned DeviceID;
   unsigned FileID;
   unsigned Line;
-  getTargetEntryUniqueInfo(CGM.getContext(), D.getBeginLoc(), DeviceID, FileID,
+  getTargetEntryUniqueInfo(D.getBeginLoc(), DeviceID, FileID,
                            Line);
   SmallString<64> EntryFnName;
   {
@@ -8327,7 +8340,7 @@ void CGOpenMPRuntime::scanForTargetRegionsFunctions(const Stmt *S,
     unsigned DeviceID;
     unsigned FileID;
     unsigned Line;
-    getTargetEntryUniqueInfo(CGM.getContext(), E.getBeginLoc(), DeviceID,
+    getTargetEntryUniqueInfo(E.getBeginLoc(), DeviceID,
                              FileID, Line);
 
     // Is this a target region that should not be emitted as an entry point? If
@@ -8447,6 +8460,16 @@ void CGOpenMPRuntime::scanForTargetRegionsFunctions(const Stmt *S,
     scanForTargetRegionsFunctions(II, ParentName);
 }
 
+void CGOpenMPRuntime::scanFunctionForTargetRegions(const Stmt *Body,
+                                                   StringRef ParentName) {
+  // A function is seen once for each of its declarations, and a constructor
+  // or destructor once for each variable of its class. The target regions in
+  // its body are emitted the first time, so there is no need to walk the
+  // body again.
+  if (Body && ScannedTargetRegionParents.insert(ParentName).second)
+    scanForTargetRegionsFunctions(Body, ParentName);
+}
+
 bool CGOpenMPRuntime::emitTargetFunctions(GlobalDecl GD) {
   // If emitting code for the host, we do not process FD here. Instead we do
   // the normal code generation.
@@ -8457,7 +8480,7 @@ bool CGOpenMPRuntime::emitTargetFunctions(GlobalDecl GD) {
   StringRef Name = CGM.getMangledName(GD);
   // Try to detect target regions in the function.
   if (const auto *FD = dyn_cast<FunctionDecl>(VD))
-    scanForTargetRegionsFunctions(FD->getBody(), Name);
+    scanFunctionForTargetRegions(FD->getBody(), Name);
 
   // Do not to emit function if it is not marked as declare target.
   return !OMPDeclareTargetDeclAttr::isDeclareTargetDeclaration(VD) &&
@@ -8476,12 +8499,12 @@ bool CGOpenMPRuntime::emitTargetGlobalVariable(GlobalDecl GD) {
     for (const CXXConstructorDecl *Ctor : RD->ctors()) {
       StringRef ParentName =
           CGM.getMangledName(GlobalDecl(Ctor, Ctor_Complete));
-      scanForTargetRegionsFunctions(Ctor->getBody(), ParentName);
+      scanFunctionForTargetRegions(Ctor->getBody(), ParentName);
     }
     if (const CXXDestructorDecl *Dtor = RD->getDestructor()) {
       StringRef ParentName =
           CGM.getMangledName(GlobalDecl(Dtor, Dtor_Complete));
-      scanForTargetRegionsFunctions(Dtor->getBody(), ParentName);
+      scanFunctionForTargetRegions(Dtor->getBody(), ParentName);
     }
   }
 
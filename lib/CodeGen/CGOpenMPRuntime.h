@@ -590,6 +590,18 @@ private:
         const OffloadDeviceGlobalVarEntryInfoActTy &Action);
 
   private:
+    /// Return the target region entry with the provided information, or null
+    /// if there is none.
+    OffloadEntryInfoTargetRegion *
+    findTargetRegionEntryInfo(unsigned DeviceID, unsigned FileID,
+                              StringRef ParentName, unsigned LineNum);
+    const OffloadEntryInfoTargetRegion *
+    findTargetRegionEntryInfo(unsigned DeviceID, unsigned FileID,
+                              StringRef ParentName, unsigned LineNum) const {
+      return const_cast<OffloadEntriesInfoManagerTy *>(this)
+          ->findTargetRegionEntryInfo(DeviceID, FileID, ParentName, LineNum);
+    }
+
     // Storage for target region entries kind. The storage is to be indexed by
     // file ID, device ID, parent function name and line number.
     typedef llvm::DenseMap<unsigned, OffloadEntryInfoTargetRegion>
@@ -613,6 +625,12 @@ private:
   bool ShouldMarkAsGlobal = true;
   /// List of the emitted functions.
   llvm::StringSet<> AlreadyEmittedTargetFunctions;
+  /// Mangled names of the functions whose bodies have been scanned for target
+  /// regions.
+  llvm::StringSet<> ScannedTargetRegionParents;
+  /// Device and file IDs of the files that contain target regions, indexed
+  /// by presumed file name.
+  llvm::StringMap<std::pair<unsigned, unsigned>> TargetEntryFileIDs;
   /// List of the global variables with their addresses that should not be
   /// emitted for the target.
   llvm::StringMap<llvm::WeakTrackingVH> EmittedNonTargetVariables;
@@ -648,6 +666,16 @@ private:
   /// \param ParentName Name of the function declaration that is being scanned.
   void scanForTargetRegionsFunctions(const Stmt *S, StringRef ParentName);
 
+  /// Scan \a Body of the function \a ParentName for target regions, unless
+  /// it has been scanned before.
+  void scanFunctionForTargetRegions(const Stmt *Body, StringRef ParentName);
+
+  /// Obtain information that uniquely identifies a target entry. This
+  /// consists of the file and device IDs as well as line number associated
+  /// with the relevant entry source location.
+  void getTargetEntryUniqueInfo(SourceLocation Loc, unsigned &DeviceID,
+                                unsigned &FileID, unsigned &LineNum);
+
   /// Build type kmp_routine_entry_t (if not built yet).
   void emitKmpRoutineEntryT(QualType KmpInt32Ty);
 
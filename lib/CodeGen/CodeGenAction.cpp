@@ -22,6 +22,7 @@
 #include "clang/CodeGen/ModuleBuilder.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/FrontendDiagnostic.h"
+#include "clang/Frontend/HeaderCostCollector.h"
 #include "clang/Lex/Preprocessor.h"
 #include "llvm/Bitcode/BitcodeReader.h"
 #include "llvm/CodeGen/MachineOptimizationRemarkEmitter.h"
@@ -107,6 +108,9 @@ namespace clang {
     // refers to.
     llvm::Module *CurLinkModule = nullptr;
 
+    /// The collector to attribute the generated IR to headers for, if any.
+    HeaderCostCollector *HeaderCosts = nullptr;
+
   public:
     BackendConsumer(BackendAction Action, DiagnosticsEngine &Diags,
                     const HeaderSearchOptions &HeaderSearchOpts,
@@ -130,6 +134,9 @@ namespace clang {
       llvm::TimePassesIsEnabled = TimePasses;
     }
     llvm::Module *getModule() const { return Gen->GetModule(); }
+    void setHeaderCostCollector(HeaderCostCollector *Costs) {
+      HeaderCosts = Costs;
+    }
     std::unique_ptr<llvm::Module> takeModule() {
       return std::unique_ptr<llvm::Module>(Gen->ReleaseModule());
     }
@@ -249,6 +256,14 @@ namespace clang {
       if (!getModule())
         return;
 
+      // Attribute the IR of each function to the header that declares it,
+      // before the backend inlines or removes any.
+      if (HeaderCosts)
+        for (const llvm::Function &F : *getModule())
+          if (!F.isDeclaration())
+            if (const Decl *D = Gen->GetDeclForMangledName(F.getName()))
+              HeaderCosts->addIRInstructions(D, F.getInstructionCount());
+
       // Install an inline asm handler so that diagnostics get printed through
       // our diagnostics hooks.
       LLVMContext &Ctx = getModule()->getContext();
@@ -894,6 +909,7 @@ CodeGenAction::CreateASTConsumer(CompilerInstance &CI, StringRef InFile) {
       CI.getLangOpts(), CI.getFrontendOpts().ShowTimers, InFile,
       std::move(LinkModules), std::move(OS), *VMContext, CoverageInfo));
   BEConsumer = Result.get();
+  BEConsumer->setHeaderCostCollector(CI.getHeaderCostCollector());
 
   // Enable generating macro debug info only when debug info is not disabled and
   // also macro debug info is enabled.
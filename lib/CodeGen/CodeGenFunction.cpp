@@ -29,6 +29,7 @@
 #include "clang/AST/StmtObjC.h"
 #include "clang/Basic/Builtins.h"
 #include "clang/Basic/TargetInfo.h"
+#include "clang/Basic/TimeTraceProfiler.h"
 #include "clang/CodeGen/CGFunctionInfo.h"
 #include "clang/Frontend/CodeGenOptions.h"
 #include "clang/Sema/SemaDiagnostic.h"
@@ -417,6 +418,23 @@ void CodeGenFunction::FinishFunction(SourceLocation EndLoc) {
     I->first->eraseFromParent();
   }
 
+  // If nothing reads the cleanup destination slot, every cleanup that was
+  // branched through had a single destination, and the stores of the
+  // destination indices are dead. Remove them instead of leaving them to the
+  // optimizer, which doesn't run at -O0.
+  if (NormalCleanupDest.isValid()) {
+    auto *Slot = dyn_cast<llvm::AllocaInst>(NormalCleanupDest.getPointer());
+    if (Slot && llvm::all_of(Slot->users(), [&](llvm::User *U) {
+          auto *SI = dyn_cast<llvm::StoreInst>(U);
+          return SI && SI->getPointerOperand() == Slot;
+        })) {
+      while (!Slot->use_empty())
+        cast<llvm::Instruction>(Slot->user_back())->eraseFromParent();
+      Slot->eraseFromParent();
+      NormalCleanupDest = Address::invalid();
+    }
+  }
+
   // Eliminate CleanupDestSlot alloca by replacing it with SSA values and
   // PHIs if the current function is a coroutine. We don't do it for all
   // functions as it may result in slight increase in numbers of instructions
@@ -848,17 +866,8 @@ void CodeGenFunction::StartFunction(GlobalDecl GD,
 
   // If this function has been blacklisted for any of the enabled sanitizers,
   // disable the sanitizer for the function.
-  do {
-#define SANITIZER(NAME, ID)                                                    \
-  if (SanOpts.empty())                                                         \
-    break;                                                                     \
-  if (SanOpts.has(SanitizerKind::ID))                                          \
-    if (CGM.isInSanitizerBlacklist(SanitizerKind::ID, Fn, Loc))                \
-      SanOpts.set(SanitizerKind::ID, false);
-
-#include "clang/Basic/Sanitizers.def"
-#undef SANITIZER
-  } while (0);
+  if (!SanOpts.empty())
+    SanOpts.clear(CGM.getSanitizerBlacklistedKinds(SanOpts.Mask, Fn, Loc));
 
   if (D) {
     // Apply the no_sanitize* attributes to SanOpts.
@@ -1311,6 +1320,9 @@ void CodeGenFunction::GenerateCode(GlobalDecl GD, llvm::Function *Fn,
   const FunctionDecl *FD = cast<FunctionDecl>(GD.getDecl());
   CurGD = GD;
 
+  TimeTraceScope TimeScope("CodeGenFunction",
+                           [&]() { return Fn->getName().str(); });
+
   FunctionArgList Args;
   QualType ResTy = BuildFunctionArgList(GD, Args);
 
@@ -58,6 +58,7 @@
 #include "llvm/Support/ConvertUTF.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
 
 using namespace clang;
 using namespace CodeGen;
@@ -69,6 +70,32 @@ static llvm::cl::opt<bool> LimitedCoverage(
 
 static const char AnnotationSection[] = "llvm.metadata";
 
+/// Open the indexed profile at \p Path, with the optional remapping file at
+/// \p RemappingPath.
+///
+/// The profile is mapped into memory rather than read.  The reader only looks
+/// at the header and at the records of the functions it is asked about, so a
+/// large merged profile only costs us the pages for the functions in this
+/// translation unit.
+static llvm::Expected<std::unique_ptr<llvm::IndexedInstrProfReader>>
+createPGOReader(StringRef Path, StringRef RemappingPath) {
+  auto BufferOrErr = llvm::MemoryBuffer::getFileOrSTDIN(
+      Path, /*FileSize=*/-1, /*RequiresNullTerminator=*/false);
+  if (std::error_code EC = BufferOrErr.getError())
+    return llvm::errorCodeToError(EC);
+
+  std::unique_ptr<llvm::MemoryBuffer> RemappingBuffer;
+  if (!RemappingPath.empty()) {
+    auto RemappingOrErr = llvm::MemoryBuffer::getFileOrSTDIN(RemappingPath);
+    if (std::error_code EC = RemappingOrErr.getError())
+      return llvm::errorCodeToError(EC);
+    RemappingBuffer = std::move(RemappingOrErr.get());
+  }
+
+  return llvm::IndexedInstrProfReader::create(std::move(BufferOrErr.get()),
+                                              std::move(RemappingBuffer));
+}
+
 static CGCXXABI *createCXXABI(CodeGenModule &CGM) {
   switch (CGM.getTarget().getCXXABI().getKind()) {
   case TargetCXXABI::GenericAArch64:
@@ -153,8 +180,8 @@ CodeGenModule::CodeGenModule(ASTContext &C, const HeaderSearchOptions &HSO,
     ObjCData.reset(new ObjCEntrypoints());
 
   if (CodeGenOpts.hasProfileClangUse()) {
-    auto ReaderOrErr = llvm::IndexedInstrProfReader::create(
-        CodeGenOpts.ProfileInstrumentUsePath, CodeGenOpts.ProfileRemappingFile);
+    auto ReaderOrErr = createPGOReader(CodeGenOpts.ProfileInstrumentUsePath,
+                                       CodeGenOpts.ProfileRemappingFile);
     if (auto E = ReaderOrErr.takeError()) {
       unsigned DiagID = Diags.getCustomDiagID(DiagnosticsEngine::Error,
                                               "Could not read profile %0: %1");
@@ -367,6 +394,7 @@ void CodeGenModule::checkAliases() {
 
 void CodeGenModule::clear() {
   DeferredDeclsToEmit.clear();
+  PostponedDeferredDecls.clear();
   if (OpenMPRuntime)
     OpenMPRuntime->clear();
 }
@@ -390,6 +418,8 @@ void InstrProfStats::reportDiagnostics(DiagnosticsEngine &Diags,
 
 void CodeGenModule::Release() {
   EmitDeferred();
+  while (schedulePostponedDeferredDecls())
+    EmitDeferred();
   EmitVTablesOpportunistically();
   applyGlobalValReplacements();
   applyReplacements();
@@ -1825,6 +1855,15 @@ void CodeGenModule::EmitDeferred() {
     if (!GV->isDeclaration())
       continue;
 
+    // The reference that scheduled a function may not have made it into the
+    // IR, e.g. when the address of the function is taken in a discarded
+    // expression. Don't emit such a function, or everything it uses in turn,
+    // unless something refers to it by the end of the translation unit.
+    if (isUnreferencedDeferredFunction(D, GV)) {
+      PostponedDeferredDecls.push_back(D);
+      continue;
+    }
+
     // Otherwise, emit the definition and move on to the next one.
     EmitGlobalDefinition(D, GV);
 
@@ -1838,6 +1877,41 @@ void CodeGenModule::EmitDeferred() {
   }
 }
 
+bool CodeGenModule::isUnreferencedDeferredFunction(GlobalDecl GD,
+                                                   llvm::GlobalValue *GV) {
+  // Offloading and multiversioning refer to functions by other means than
+  // uses of their declarations.
+  const auto *FD = dyn_cast<FunctionDecl>(GD.getDecl());
+  if (!FD || FD->isMultiVersion() || LangOpts.OpenMP || LangOpts.CUDA)
+    return false;
+
+  GV->removeDeadConstantUsers();
+  if (!GV->use_empty())
+    return false;
+
+  return !MustBeEmitted(FD) &&
+         llvm::GlobalValue::isDiscardableIfUnused(getFunctionLinkage(GD));
+}
+
+bool CodeGenModule::schedulePostponedDeferredDecls() {
+  bool Scheduled = false;
+  std::vector<GlobalDecl> StillUnreferenced;
+  for (GlobalDecl &D : PostponedDeferredDecls) {
+    llvm::GlobalValue *GV = GetGlobalValue(getMangledName(D));
+    if (!GV || !GV->isDeclaration())
+      continue;
+    GV->removeDeadConstantUsers();
+    if (GV->use_empty()) {
+      StillUnreferenced.push_back(D);
+      continue;
+    }
+    addDeferredDeclToEmit(D);
+    Scheduled = true;
+  }
+  PostponedDeferredDecls.swap(StillUnreferenced);
+  return Scheduled;
+}
+
 void CodeGenModule::EmitVTablesOpportunistically() {
   // Try to emit external vtables as available_externally if they have emitted
   // all inlined virtual functions.  It runs after EmitDeferred() and therefore
@@ -1930,20 +2004,30 @@ void CodeGenModule::AddGlobalAnnotations(const ValueDecl *D,
 bool CodeGenModule::isInSanitizerBlacklist(SanitizerMask Kind,
                                            llvm::Function *Fn,
                                            SourceLocation Loc) const {
+  return getSanitizerBlacklistedKinds(Kind, Fn, Loc) != 0;
+}
+
+SanitizerMask
+CodeGenModule::getSanitizerBlacklistedKinds(SanitizerMask Kinds,
+                                            llvm::Function *Fn,
+                                            SourceLocation Loc) const {
   const auto &SanitizerBL = getContext().getSanitizerBlacklist();
   // Blacklist by function name.
-  if (SanitizerBL.isBlacklistedFunction(Kind, Fn->getName()))
-    return true;
+  SanitizerMask Blacklisted =
+      SanitizerBL.getBlacklistedFunctionKinds(Kinds, Fn->getName());
+  Kinds &= ~Blacklisted;
+  if (!Kinds)
+    return Blacklisted;
   // Blacklist by location.
   if (Loc.isValid())
-    return SanitizerBL.isBlacklistedLocation(Kind, Loc);
+    return Blacklisted | SanitizerBL.getBlacklistedLocationKinds(Kinds, Loc);
   // If location is unknown, this may be a compiler-generated function. Assume
   // it's located in the main file.
   auto &SM = Context.getSourceManager();
-  if (const auto *MainFile = SM.getFileEntryForID(SM.getMainFileID())) {
-    return SanitizerBL.isBlacklistedFile(Kind, MainFile->getName());
-  }
-  return false;
+  if (SM.getFileEntryForID(SM.getMainFileID()))
+    return Blacklisted | SanitizerBL.getBlacklistedLocationKinds(
+                             Kinds, SM.getLocForStartOfFile(SM.getMainFileID()));
+  return Blacklisted;
 }
 
 bool CodeGenModule::isInSanitizerBlacklist(llvm::GlobalVariable *GV,
@@ -5055,34 +5139,35 @@ void CodeGenModule::EmitDeferredUnusedCoverageMappings() {
     if (!Entry.second)
       continue;
     const Decl *D = Entry.first;
+    GlobalDecl GD;
     switch (D->getKind()) {
     case Decl::CXXConversion:
     case Decl::CXXMethod:
     case Decl::Function:
-    case Decl::ObjCMethod: {
-      CodeGenPGO PGO(*this);
-      GlobalDecl GD(cast<FunctionDecl>(D));
-      PGO.emitEmptyCounterMapping(D, getMangledName(GD),
-                                  getFunctionLinkage(GD));
+    case Decl::ObjCMethod:
+      GD = GlobalDecl(cast<FunctionDecl>(D));
       break;
-    }
-    case Decl::CXXConstructor: {
-      CodeGenPGO PGO(*this);
-      GlobalDecl GD(cast<CXXConstructorDecl>(D), Ctor_Base);
-      PGO.emitEmptyCounterMapping(D, getMangledName(GD),
-                                  getFunctionLinkage(GD));
+    case Decl::CXXConstructor:
+      GD = GlobalDecl(cast<CXXConstructorDecl>(D), Ctor_Base);
       break;
-    }
-    case Decl::CXXDestructor: {
-      CodeGenPGO PGO(*this);
-      GlobalDecl GD(cast<CXXDestructorDecl>(D), Dtor_Base);
-      PGO.emitEmptyCounterMapping(D, getMangledName(GD),
-                                  getFunctionLinkage(GD));
+    case Decl::CXXDestructor:
+      GD = GlobalDecl(cast<CXXDestructorDecl>(D), Dtor_Base);
       break;
-    }
     default:
-      break;
+      continue;
     };
+
+    // An unused linkonce function from a header gets the same empty mapping
+    // in every translation unit that includes the header. If asked to, leave
+    // it to the translation units that use the function.
+    llvm::GlobalValue::LinkageTypes Linkage = getFunctionLinkage(GD);
+    if (CodeGenOpts.CoverageSkipUnusedLinkOnce &&
+        llvm::GlobalValue::isLinkOnceLinkage(Linkage) &&
+        !getContext().getSourceManager().isInMainFile(D->getLocation()))
+      continue;
+
+    CodeGenPGO PGO(*this);
+    PGO.emitEmptyCounterMapping(D, getMangledName(GD), Linkage);
   }
 }
 
@@ -320,6 +320,11 @@ private:
     DeferredDeclsToEmit.emplace_back(GD);
   }
 
+  /// Deferred functions that were scheduled for emission but that nothing
+  /// referred to any more by the time we got to them. They are only emitted
+  /// if code emitted after them refers to them again.
+  std::vector<GlobalDecl> PostponedDeferredDecls;
+
   /// List of alias we have emitted. Used to make sure that what they point to
   /// is defined once we get to the end of the of the translation unit.
   std::vector<GlobalDecl> Aliases;
@@ -392,6 +397,10 @@ private:
   /// Map used to get unique type descriptor constants for sanitizers.
   llvm::DenseMap<QualType, llvm::Constant *> TypeDescriptorMap;
 
+  /// Map from target builtin IDs to the intrinsics that implement them
+  /// directly, or to Intrinsic::not_intrinsic if none does.
+  llvm::DenseMap<unsigned, unsigned> TargetBuiltinIntrinsics;
+
   /// Map used to track internal linkage functions declared within
   /// extern "C" regions.
   typedef llvm::MapVector<IdentifierInfo *,
@@ -944,6 +953,10 @@ public:
   llvm::Constant *getBuiltinLibFunction(const FunctionDecl *FD,
                                         unsigned BuiltinID);
 
+  /// Given a builtin id for a target builtin, return the ID of the intrinsic
+  /// of the same name, or Intrinsic::not_intrinsic if there isn't one.
+  unsigned getTargetBuiltinIntrinsicID(unsigned BuiltinID);
+
   llvm::Function *getIntrinsic(unsigned IID, ArrayRef<llvm::Type*> Tys = None);
 
   /// Emit code for a single top level declaration.
@@ -1178,6 +1191,12 @@ public:
   bool isInSanitizerBlacklist(SanitizerMask Kind, llvm::Function *Fn,
                               SourceLocation Loc) const;
 
+  /// Return the sanitizers in \p Kinds that \p Fn is blacklisted for, looking
+  /// up its name and location once for all of them.
+  SanitizerMask getSanitizerBlacklistedKinds(SanitizerMask Kinds,
+                                             llvm::Function *Fn,
+                                             SourceLocation Loc) const;
+
   bool isInSanitizerBlacklist(llvm::GlobalVariable *GV, SourceLocation Loc,
                               QualType Ty,
                               StringRef Category = StringRef()) const;
@@ -1358,6 +1377,16 @@ private:
   /// Emit any needed decls for which code generation was deferred.
   void EmitDeferred();
 
+  /// Whether the deferred function \p GD, with its declaration \p GV, could
+  /// be dropped if unused and nothing refers to it any more.
+  bool isUnreferencedDeferredFunction(GlobalDecl GD, llvm::GlobalValue *GV);
+
+  /// Schedule the postponed deferred functions that have been referenced
+  /// since they were postponed.
+  ///
+  /// \returns true if any were scheduled.
+  bool schedulePostponedDeferredDecls();
+
   /// Try to emit external vtables as available_externally if they have emitted
   /// all inlined virtual functions.  It runs after EmitDeferred() and therefore
   /// is not allowed to create new references to things that need to be emitted
@@ -279,17 +279,28 @@ CodeGenTBAA::CollectFields(uint64_t BaseOffset,
 
 llvm::MDNode *
 CodeGenTBAA::getTBAAStructInfo(QualType QTy) {
-  const Type *Ty = Context.getCanonicalType(QTy).getTypePtr();
-
-  if (llvm::MDNode *N = StructMetadataCache[Ty])
-    return N;
-
+  // The may_alias attribute is sugar that the canonical type drops, but it
+  // turns every field into a char access.
+  bool MayAlias = TypeHasMayAlias(QTy);
+  llvm::PointerIntPair<const Type *, 1, bool> Key(
+      Context.getCanonicalType(QTy).getTypePtr(), MayAlias);
+
+  // A null entry means we have already found that the type can't be described,
+  // so look the type up rather than testing the entry.
+  auto I = StructMetadataCache.find(Key);
+  if (I != StructMetadataCache.end())
+    return I->second;
+
+  // Collecting the fields walks the whole type and is allowed to add new
+  // nodes to the other caches, so only add the result to the cache once it
+  // has been built.  For now, handle any type that can't be described
+  // conservatively, with no node at all.
+  llvm::MDNode *StructNode = nullptr;
   SmallVector<llvm::MDBuilder::TBAAStructField, 4> Fields;
-  if (CollectFields(0, QTy, Fields, TypeHasMayAlias(QTy)))
-    return MDHelper.createTBAAStructNode(Fields);
+  if (CollectFields(0, QTy, Fields, MayAlias))
+    StructNode = MDHelper.createTBAAStructNode(Fields);
 
-  // For now, handle any other kind of type conservatively.
-  return StructMetadataCache[Ty] = nullptr;
+  return StructMetadataCache[Key] = StructNode;
 }
 
 llvm::MDNode *CodeGenTBAA::getBaseTypeInfoHelper(const Type *Ty) {
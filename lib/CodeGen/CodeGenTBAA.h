@@ -18,6 +18,7 @@
 #include "clang/AST/Type.h"
 #include "clang/Basic/LLVM.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/PointerIntPair.h"
 #include "llvm/IR/MDBuilder.h"
 #include "llvm/IR/Metadata.h"
 
@@ -134,8 +135,11 @@ class CodeGenTBAA {
   llvm::DenseMap<TBAAAccessInfo, llvm::MDNode *> AccessTagMetadataCache;
 
   /// StructMetadataCache - This maps clang::Types to llvm::MDNodes describing
-  /// them for struct assignments.
-  llvm::DenseMap<const Type *, llvm::MDNode *> StructMetadataCache;
+  /// them for struct assignments. A may_alias spelling of a type is described
+  /// differently from the type itself, so the key also says whether the type
+  /// may alias.
+  llvm::DenseMap<llvm::PointerIntPair<const Type *, 1, bool>, llvm::MDNode *>
+      StructMetadataCache;
 
   llvm::MDNode *Root;
   llvm::MDNode *Char;
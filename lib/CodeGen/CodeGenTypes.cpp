@@ -693,7 +693,8 @@ bool CodeGenModule::isPaddedAtomicType(const AtomicType *type) {
 }
 
 /// ConvertRecordDeclType - Lay out a tagged decl type like struct or union.
-llvm::StructType *CodeGenTypes::ConvertRecordDeclType(const RecordDecl *RD) {
+llvm::StructType *CodeGenTypes::ConvertRecordDeclType(const RecordDecl *RD,
+                                                      bool KnownSafeToConvert) {
   // TagDecl's are not necessarily unique, instead use the (clang)
   // type connected to the decl.
   const Type *Key = Context.getTagDeclType(RD).getTypePtr();
@@ -714,7 +715,7 @@ llvm::StructType *CodeGenTypes::ConvertRecordDeclType(const RecordDecl *RD) {
     return Ty;
 
   // If converting this type would cause us to infinitely loop, don't do it!
-  if (!isSafeToConvert(RD, *this)) {
+  if (!KnownSafeToConvert && !isSafeToConvert(RD, *this)) {
     DeferredRecords.push_back(RD);
     return Ty;
   }
@@ -724,12 +725,18 @@ llvm::StructType *CodeGenTypes::ConvertRecordDeclType(const RecordDecl *RD) {
   (void)InsertResult;
   assert(InsertResult && "Recursively compiling a struct?");
 
-  // Force conversion of non-virtual base classes recursively.
+  // Force conversion of non-virtual base classes recursively.  The check
+  // above walked all of the bases, and the only record that has been added to
+  // RecordsBeingLaidOut since then and is still there is this one, which no
+  // base can contain, so they are safe to convert too.  Not checking them
+  // again keeps long chains of bases, as built by template metaprograms, from
+  // being walked once per level.
   if (const CXXRecordDecl *CRD = dyn_cast<CXXRecordDecl>(RD)) {
     for (const auto &I : CRD->bases()) {
       if (I.isVirtual()) continue;
 
-      ConvertRecordDeclType(I.getType()->getAs<RecordType>()->getDecl());
+      ConvertRecordDeclType(I.getType()->getAs<RecordType>()->getDecl(),
+                            /*KnownSafeToConvert=*/true);
     }
   }
 
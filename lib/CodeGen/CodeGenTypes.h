@@ -347,7 +347,12 @@ public:
 
 public:  // These are internal details of CGT that shouldn't be used externally.
   /// ConvertRecordDeclType - Lay out a tagged decl type like struct or union.
-  llvm::StructType *ConvertRecordDeclType(const RecordDecl *TD);
+  ///
+  /// \param KnownSafeToConvert true if the caller has already established
+  /// that laying out \p TD cannot recurse into a record that is currently
+  /// being laid out, so the check can be skipped.
+  llvm::StructType *ConvertRecordDeclType(const RecordDecl *TD,
+                                          bool KnownSafeToConvert = false);
 
   /// getExpandedTypes - Expand the type \arg Ty into the LLVM
   /// argument types it would be passed as. See ABIArgInfo::Expand.
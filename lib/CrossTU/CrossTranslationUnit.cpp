@@ -11,8 +11,11 @@
 //
 //===----------------------------------------------------------------------===//
 #include "clang/CrossTU/CrossTranslationUnit.h"
+#include "clang/AST/ASTContext.h"
 #include "clang/AST/ASTImporter.h"
+#include "clang/AST/ASTImporterLookupTable.h"
 #include "clang/AST/Decl.h"
+#include "clang/Basic/SourceManager.h"
 #include "clang/Basic/TargetInfo.h"
 #include "clang/CrossTU/CrossTUDiagnostic.h"
 #include "clang/Frontend/ASTUnit.h"
@@ -20,14 +23,42 @@
 #include "clang/Frontend/FrontendDiagnostic.h"
 #include "clang/Frontend/TextDiagnosticPrinter.h"
 #include "clang/Index/USRGeneration.h"
+#include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/PreprocessingRecord.h"
+#include "clang/Lex/Preprocessor.h"
+#include "clang/Tooling/ArgumentsAdjusters.h"
+#include "clang/Tooling/CompilationDatabase.h"
+#include "clang/Tooling/JSONCompilationDatabase.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/Triple.h"
+#include "llvm/Support/DJB.h"
+#include "llvm/Support/EndianStream.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/OnDiskHashTable.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
+#include <cstring>
 #include <fstream>
 #include <sstream>
 
+#define DEBUG_TYPE "CrossTranslationUnit"
+
+STATISTIC(NumASTLoaded, "The # of AST files loaded.");
+STATISTIC(NumASTLoadedKB, "The # of kilobytes of AST files loaded.");
+STATISTIC(NumASTUnloaded, "The # of AST files unloaded to save memory.");
+STATISTIC(PercentASTUnloaded,
+          "The % of loaded AST files that were unloaded to save memory.");
+STATISTIC(NumASTParsed, "The # of translation units parsed on demand.");
+STATISTIC(NumASTCacheHits,
+          "The # of translation units loaded from the AST cache instead of "
+          "parsed on demand.");
+STATISTIC(NumFunctionsImported, "The # of function definitions imported.");
+
 namespace clang {
 namespace cross_tu {
 
@@ -55,6 +86,10 @@ public:
       return "Failed to load external AST source.";
     case index_error_code::failed_to_generate_usr:
       return "Failed to generate USR.";
+    case index_error_code::failed_to_load_compilation_database:
+      return "Failed to load the compilation database.";
+    case index_error_code::missing_compile_command:
+      return "Missing compile command from the compilation database.";
     }
     llvm_unreachable("Unrecognized index_error_code.");
   }
@@ -92,8 +127,12 @@ parseCrossTUIndex(StringRef IndexPath, StringRef CrossTUDir) {
         return llvm::make_error<IndexError>(
             index_error_code::multiple_definitions, IndexPath.str(), LineNo);
       StringRef FileName = LineRef.substr(Pos + 1);
+      // Source files parsed on demand are listed with absolute paths.
       SmallString<256> FilePath = CrossTUDir;
-      llvm::sys::path::append(FilePath, FileName);
+      if (llvm::sys::path::is_absolute(FileName))
+        FilePath = FileName;
+      else
+        llvm::sys::path::append(FilePath, FileName);
       Result[FunctionLookupName] = FilePath.str().str();
     } else
       return llvm::make_error<IndexError>(
@@ -111,6 +150,157 @@ createCrossTUIndexString(const llvm::StringMap<std::string> &Index) {
   return Result.str();
 }
 
+/// The magic number at the start of a binary index file.
+static const char BinaryIndexMagic[] = {'C', 'T', 'U', 'I'};
+
+/// The binary index file version. Bump this whenever the layout changes.
+static const uint32_t BinaryIndexVersion = 1;
+
+/// Magic, version and bucket offset.
+static const unsigned BinaryIndexHeaderSize = 4 + 4 + 4;
+
+namespace {
+
+/// Trait used to read and write the USR -> file path on-disk hash table.
+class BinaryIndexTrait {
+public:
+  using key_type = StringRef;
+  using key_type_ref = StringRef;
+  using external_key_type = StringRef;
+  using internal_key_type = StringRef;
+  using data_type = StringRef;
+  using data_type_ref = StringRef;
+  using hash_value_type = uint32_t;
+  using offset_type = uint32_t;
+
+  static bool EqualKey(StringRef A, StringRef B) { return A == B; }
+  static hash_value_type ComputeHash(StringRef Key) {
+    return llvm::djbHash(Key);
+  }
+  static StringRef GetInternalKey(StringRef Key) { return Key; }
+  static StringRef GetExternalKey(StringRef Key) { return Key; }
+
+  static std::pair<unsigned, unsigned>
+  EmitKeyDataLength(raw_ostream &Out, StringRef Key, StringRef Data) {
+    using namespace llvm::support;
+    endian::Writer LE(Out, little);
+    LE.write<uint32_t>(Key.size());
+    LE.write<uint32_t>(Data.size());
+    return std::make_pair(Key.size(), Data.size());
+  }
+
+  static void EmitKey(raw_ostream &Out, StringRef Key, unsigned) {
+    Out << Key;
+  }
+
+  static void EmitData(raw_ostream &Out, StringRef, StringRef Data,
+                       unsigned) {
+    Out << Data;
+  }
+
+  static std::pair<unsigned, unsigned>
+  ReadKeyDataLength(const unsigned char *&D) {
+    using namespace llvm::support;
+    unsigned KeyLen = endian::readNext<uint32_t, little, unaligned>(D);
+    unsigned DataLen = endian::readNext<uint32_t, little, unaligned>(D);
+    return std::make_pair(KeyLen, DataLen);
+  }
+
+  static StringRef ReadKey(const unsigned char *D, unsigned N) {
+    return StringRef(reinterpret_cast<const char *>(D), N);
+  }
+
+  static StringRef ReadData(StringRef, const unsigned char *D, unsigned N) {
+    return StringRef(reinterpret_cast<const char *>(D), N);
+  }
+};
+
+} // end anonymous namespace
+
+llvm::Error writeCrossTUBinaryIndex(const llvm::StringMap<std::string> &Index,
+                                    StringRef IndexPath) {
+  llvm::OnDiskChainedHashTableGenerator<BinaryIndexTrait> Generator;
+  BinaryIndexTrait Trait;
+  for (const auto &E : Index)
+    Generator.insert(E.getKey(), E.getValue(), Trait);
+
+  SmallString<4096> Contents;
+  {
+    using namespace llvm::support;
+    llvm::raw_svector_ostream Out(Contents);
+    Out.write(BinaryIndexMagic, sizeof(BinaryIndexMagic));
+    endian::Writer LE(Out, little);
+    LE.write<uint32_t>(BinaryIndexVersion);
+    LE.write<uint32_t>(0); // Placeholder for the bucket offset.
+    uint32_t BucketOffset = Generator.Emit(Out, Trait);
+    endian::write32le(Contents.data() + BinaryIndexHeaderSize - 4,
+                      BucketOffset);
+  }
+
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(IndexPath, EC, llvm::sys::fs::F_None);
+  if (EC)
+    return llvm::errorCodeToError(EC);
+  OS << Contents;
+  return llvm::Error::success();
+}
+
+/// A binary index file mapped into memory.
+class CrossTUBinaryIndex {
+  using TableTy = llvm::OnDiskChainedHashTable<BinaryIndexTrait>;
+
+  std::unique_ptr<llvm::MemoryBuffer> Buffer;
+  std::unique_ptr<TableTy> Table;
+
+public:
+  /// Maps \p IndexPath into memory. Returns null if it is not a binary index
+  /// file, and an error if it is a damaged one.
+  static llvm::Expected<std::unique_ptr<CrossTUBinaryIndex>>
+  load(StringRef IndexPath) {
+    // The index of a large project does not fit into memory comfortably, so
+    // map it rather than reading it.
+    auto BufOrErr = llvm::MemoryBuffer::getFile(
+        IndexPath, /*FileSize=*/-1, /*RequiresNullTerminator=*/false);
+    if (!BufOrErr)
+      return nullptr;
+    std::unique_ptr<llvm::MemoryBuffer> Buf = std::move(*BufOrErr);
+    if (Buf->getBufferSize() < sizeof(BinaryIndexMagic) ||
+        memcmp(Buf->getBufferStart(), BinaryIndexMagic,
+               sizeof(BinaryIndexMagic)) != 0)
+      return nullptr;
+
+    using namespace llvm::support;
+    const unsigned char *Base =
+        reinterpret_cast<const unsigned char *>(Buf->getBufferStart());
+    const unsigned char *D = Base + sizeof(BinaryIndexMagic);
+    if (Buf->getBufferSize() < BinaryIndexHeaderSize ||
+        endian::readNext<uint32_t, little, unaligned>(D) !=
+            BinaryIndexVersion)
+      return llvm::make_error<IndexError>(
+          index_error_code::invalid_index_format, IndexPath.str());
+    uint32_t BucketOffset = endian::readNext<uint32_t, little, unaligned>(D);
+    if (BucketOffset < BinaryIndexHeaderSize ||
+        BucketOffset + 2 * sizeof(uint32_t) > Buf->getBufferSize() ||
+        BucketOffset % alignof(uint32_t) != 0)
+      return llvm::make_error<IndexError>(
+          index_error_code::invalid_index_format, IndexPath.str());
+
+    std::unique_ptr<CrossTUBinaryIndex> Index(new CrossTUBinaryIndex());
+    Index->Table.reset(TableTy::Create(Base + BucketOffset, Base));
+    Index->Buffer = std::move(Buf);
+    return std::move(Index);
+  }
+
+  /// Returns the file path of the definition of \p LookupName, relative to
+  /// the directory of the CTU files, or None if it is not in the index.
+  Optional<StringRef> lookup(StringRef LookupName) const {
+    auto It = Table->find(LookupName);
+    if (It == Table->end())
+      return None;
+    return *It;
+  }
+};
+
 CrossTranslationUnitContext::CrossTranslationUnitContext(CompilerInstance &CI)
     : CI(CI), Context(CI.getASTContext()) {}
 
@@ -155,6 +345,11 @@ CrossTranslationUnitContext::getCrossTUDefinition(const FunctionDecl *FD,
   if (LookupFnName.empty())
     return llvm::make_error<IndexError>(
         index_error_code::failed_to_generate_usr);
+  // The imported definitions do not depend on the AST file they came from,
+  // which may have been unloaded since.
+  auto ImportedEntry = ImportedFunctionMap.find(LookupFnName);
+  if (ImportedEntry != ImportedFunctionMap.end())
+    return ImportedEntry->second;
   llvm::Expected<ASTUnit *> ASTUnitOrError =
       loadExternalAST(LookupFnName, CrossTUDir, IndexName);
   if (!ASTUnitOrError)
@@ -168,14 +363,20 @@ CrossTranslationUnitContext::getCrossTUDefinition(const FunctionDecl *FD,
 
   TranslationUnitDecl *TU = Unit->getASTContext().getTranslationUnitDecl();
   if (const FunctionDecl *ResultDecl =
-          findFunctionInDeclContext(TU, LookupFnName))
-    return importDefinition(ResultDecl);
+          findFunctionInDeclContext(TU, LookupFnName)) {
+    llvm::Expected<const FunctionDecl *> ToDeclOrError =
+        importDefinition(ResultDecl);
+    if (ToDeclOrError)
+      ImportedFunctionMap[LookupFnName] = *ToDeclOrError;
+    return ToDeclOrError;
+  }
   return llvm::make_error<IndexError>(index_error_code::failed_import);
 }
 
 void CrossTranslationUnitContext::emitCrossTUDiagnostics(const IndexError &IE) {
   switch (IE.getCode()) {
   case index_error_code::missing_index_file:
+  case index_error_code::failed_to_load_compilation_database:
     Context.getDiagnostics().Report(diag::err_fe_error_opening)
         << IE.getFileName() << "required by the CrossTU functionality";
     break;
@@ -192,21 +393,192 @@ void CrossTranslationUnitContext::emitCrossTUDiagnostics(const IndexError &IE) {
   }
 }
 
+/// Returns the memory used by an AST file loaded into \p Unit, apart from the
+/// file itself.
+static uint64_t getASTUnitSize(const ASTUnit &Unit) {
+  const ASTContext &Ctx = Unit.getASTContext();
+  const SourceManager &SM = Unit.getSourceManager();
+  SourceManager::MemoryBufferSizes Buffers = SM.getMemoryBufferSizes();
+  return Ctx.getASTAllocatedMemory() + Ctx.getSideTableAllocatedMemory() +
+         SM.getContentCacheSize() + SM.getDataStructureSizes() +
+         Buffers.malloc_bytes + Buffers.mmap_bytes;
+}
+
+/// Returns the memory that a unit parsed from source holds in place of an AST
+/// file: the state of its preprocessor, which getASTUnitSize() leaves out.
+static uint64_t getParsedUnitFileSize(ASTUnit &Unit) {
+  Preprocessor &PP = Unit.getPreprocessor();
+  uint64_t Size = PP.getTotalMemory() +
+                  PP.getIdentifierTable().getAllocator().getTotalMemory() +
+                  PP.getSelectorTable().getTotalMemory() +
+                  PP.getHeaderSearchInfo().getTotalMemory();
+  if (const PreprocessingRecord *Record = PP.getPreprocessingRecord())
+    Size += Record->getTotalMemory();
+  return Size;
+}
+
+uint64_t CrossTranslationUnitContext::getLoadedASTSize() const {
+  // The units keep growing as declarations are deserialized from them, so
+  // their sizes are measured anew every time.
+  uint64_t Size = 0;
+  for (const auto &Entry : FileASTUnitMap) {
+    const LoadedASTUnit &Loaded = Entry.getValue();
+    Size += Loaded.FileSize;
+    if (Loaded.Unit)
+      Size += getASTUnitSize(*Loaded.Unit);
+  }
+  return Size;
+}
+
+void CrossTranslationUnitContext::unloadLeastRecentlyUsedASTUnits() {
+  uint64_t Size = getLoadedASTSize();
+  // The most recently used unit is never unloaded, since it is the one that
+  // is about to be imported from.
+  while (Size > MaxLoadedASTSize && ASTUnitUseOrder.size() > 1) {
+    auto Entry = FileASTUnitMap.find(ASTUnitUseOrder.back());
+    assert(Entry != FileASTUnitMap.end() && "Unit use order is out of sync");
+    LoadedASTUnit &Loaded = Entry->second;
+    Size -= Loaded.FileSize;
+    if (Loaded.Unit) {
+      Size -= getASTUnitSize(*Loaded.Unit);
+      // The importer refers to the context of the unit.
+      ASTUnitImporterMap.erase(
+          Loaded.Unit->getASTContext().getTranslationUnitDecl());
+    }
+    ASTUnitUseOrder.pop_back();
+    FileASTUnitMap.erase(Entry);
+    ++NumASTUnloaded;
+  }
+  if (NumASTLoaded)
+    PercentASTUnloaded = NumASTUnloaded * 100 / NumASTLoaded;
+}
+
+static IntrusiveRefCntPtr<DiagnosticsEngine>
+createDiagnostics(bool ReportErrors) {
+  IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts = new DiagnosticOptions();
+  DiagnosticConsumer *DiagClient;
+  if (ReportErrors)
+    DiagClient = new TextDiagnosticPrinter(llvm::errs(), &*DiagOpts);
+  else
+    DiagClient = new IgnoringDiagConsumer();
+  IntrusiveRefCntPtr<DiagnosticIDs> DiagID(new DiagnosticIDs());
+  return new DiagnosticsEngine(DiagID, &*DiagOpts, DiagClient);
+}
+
+std::unique_ptr<ASTUnit>
+CrossTranslationUnitContext::loadFromASTFile(StringRef ASTFileName,
+                                             bool ReportErrors) {
+  return std::unique_ptr<ASTUnit>(ASTUnit::LoadFromASTFile(
+      ASTFileName, CI.getPCHContainerOperations()->getRawReader(),
+      ASTUnit::LoadEverything, createDiagnostics(ReportErrors),
+      CI.getFileSystemOpts()));
+}
+
+/// Returns a name for the AST of \p Command in the AST cache, which differs
+/// between the commands and the files they compile.
+static std::string getCachedASTName(const tooling::CompileCommand &Command) {
+  llvm::MD5 Hash;
+  Hash.update(Command.Directory);
+  for (const std::string &Arg : Command.CommandLine) {
+    Hash.update(StringRef("\0", 1));
+    Hash.update(Arg);
+  }
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  return (llvm::sys::path::filename(Command.Filename) + "-" +
+          Result.digest().substr(0, 16) + ".ast")
+      .str();
+}
+
+llvm::Expected<std::unique_ptr<ASTUnit>>
+CrossTranslationUnitContext::parseSourceFile(StringRef SourceFileName,
+                                             uint64_t &ASTFileSize) {
+  if (!CompilationDB) {
+    std::string ErrorMessage;
+    if (llvm::sys::fs::is_directory(CompilationDatabasePath))
+      CompilationDB = tooling::CompilationDatabase::loadFromDirectory(
+          CompilationDatabasePath, ErrorMessage);
+    else
+      CompilationDB = tooling::JSONCompilationDatabase::loadFromFile(
+          CompilationDatabasePath, ErrorMessage,
+          tooling::JSONCommandLineSyntax::AutoDetect);
+    if (!CompilationDB)
+      return llvm::make_error<IndexError>(
+          index_error_code::failed_to_load_compilation_database,
+          CompilationDatabasePath);
+  }
+
+  // A file that is compiled more than once is parsed as its first command
+  // compiles it.
+  std::vector<tooling::CompileCommand> Commands =
+      CompilationDB->getCompileCommands(SourceFileName);
+  if (Commands.empty())
+    return llvm::make_error<IndexError>(
+        index_error_code::missing_compile_command, SourceFileName.str());
+  tooling::CompileCommand &Command = Commands.front();
+
+  // The AST cache is shared by analyzer runs that may be far apart, so only
+  // trust a cached AST that the AST reader finds up to date with its inputs.
+  SmallString<256> CachedASTFileName;
+  if (!ASTCacheDir.empty()) {
+    CachedASTFileName = ASTCacheDir;
+    llvm::sys::path::append(CachedASTFileName, getCachedASTName(Command));
+    if (std::unique_ptr<ASTUnit> Unit =
+            loadFromASTFile(CachedASTFileName, /*ReportErrors=*/false)) {
+      ++NumASTCacheHits;
+      if (llvm::sys::fs::file_size(CachedASTFileName, ASTFileSize))
+        ASTFileSize = 0;
+      return std::move(Unit);
+    }
+  }
+
+  // Relative paths in the command are relative to its directory, which is
+  // passed on to the file manager rather than made the working directory of
+  // the whole analyzer.
+  tooling::CommandLineArguments Args = tooling::getClangSyntaxOnlyAdjuster()(
+      Command.CommandLine, Command.Filename);
+  Args = tooling::getClangStripOutputAdjuster()(Args, Command.Filename);
+  Args = tooling::getClangStripDependencyFileAdjuster()(Args, Command.Filename);
+  Args = tooling::getInsertArgumentAdjuster(
+      {"-working-directory", Command.Directory},
+      tooling::ArgumentInsertPosition::BEGIN)(Args, Command.Filename);
+  std::vector<const char *> ArgPtrs;
+  for (const std::string &Arg : Args)
+    ArgPtrs.push_back(Arg.c_str());
+
+  std::unique_ptr<ASTUnit> Unit(ASTUnit::LoadFromCommandLine(
+      ArgPtrs.data(), ArgPtrs.data() + ArgPtrs.size(),
+      CI.getPCHContainerOperations(), createDiagnostics(/*ReportErrors=*/true),
+      CI.getHeaderSearchOpts().ResourceDir));
+  if (!Unit)
+    return nullptr;
+  ++NumASTParsed;
+  ASTFileSize = getParsedUnitFileSize(*Unit);
+
+  if (!CachedASTFileName.empty() &&
+      !llvm::sys::fs::create_directories(ASTCacheDir))
+    Unit->Save(CachedASTFileName);
+  return std::move(Unit);
+}
+
 llvm::Expected<ASTUnit *> CrossTranslationUnitContext::loadExternalAST(
     StringRef LookupName, StringRef CrossTUDir, StringRef IndexName) {
   // FIXME: The current implementation only supports loading functions with
   //        a lookup name from a single translation unit. If multiple
   //        translation units contains functions with the same lookup name an
   //        error will be returned.
-  ASTUnit *Unit = nullptr;
-  auto FnUnitCacheEntry = FunctionASTUnitMap.find(LookupName);
-  if (FnUnitCacheEntry == FunctionASTUnitMap.end()) {
-    if (FunctionFileMap.empty()) {
-      SmallString<256> IndexFile = CrossTUDir;
-      if (llvm::sys::path::is_absolute(IndexName))
-        IndexFile = IndexName;
-      else
-        llvm::sys::path::append(IndexFile, IndexName);
+  if (FunctionFileMap.empty() && !BinaryIndex) {
+    SmallString<256> IndexFile = CrossTUDir;
+    if (llvm::sys::path::is_absolute(IndexName))
+      IndexFile = IndexName;
+    else
+      llvm::sys::path::append(IndexFile, IndexName);
+    llvm::Expected<std::unique_ptr<CrossTUBinaryIndex>> BinaryIndexOrErr =
+        CrossTUBinaryIndex::load(IndexFile);
+    if (!BinaryIndexOrErr)
+      return BinaryIndexOrErr.takeError();
+    BinaryIndex = std::move(*BinaryIndexOrErr);
+    if (!BinaryIndex) {
       llvm::Expected<llvm::StringMap<std::string>> IndexOrErr =
           parseCrossTUIndex(IndexFile, CrossTUDir);
       if (IndexOrErr)
@@ -214,38 +586,72 @@ llvm::Expected<ASTUnit *> CrossTranslationUnitContext::loadExternalAST(
       else
         return IndexOrErr.takeError();
     }
+  }
 
-    auto It = FunctionFileMap.find(LookupName);
-    if (It == FunctionFileMap.end())
-      return llvm::make_error<IndexError>(index_error_code::missing_definition);
-    StringRef ASTFileName = It->second;
-    auto ASTCacheEntry = FileASTUnitMap.find(ASTFileName);
-    if (ASTCacheEntry == FileASTUnitMap.end()) {
-      IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts = new DiagnosticOptions();
-      TextDiagnosticPrinter *DiagClient =
-          new TextDiagnosticPrinter(llvm::errs(), &*DiagOpts);
-      IntrusiveRefCntPtr<DiagnosticIDs> DiagID(new DiagnosticIDs());
-      IntrusiveRefCntPtr<DiagnosticsEngine> Diags(
-          new DiagnosticsEngine(DiagID, &*DiagOpts, DiagClient));
-
-      std::unique_ptr<ASTUnit> LoadedUnit(ASTUnit::LoadFromASTFile(
-          ASTFileName, CI.getPCHContainerOperations()->getRawReader(),
-          ASTUnit::LoadEverything, Diags, CI.getFileSystemOpts()));
-      Unit = LoadedUnit.get();
-      FileASTUnitMap[ASTFileName] = std::move(LoadedUnit);
+  SmallString<256> ASTFileName;
+  if (BinaryIndex) {
+    Optional<StringRef> FileName = BinaryIndex->lookup(LookupName);
+    if (!FileName)
+      return llvm::make_error<IndexError>(
+          index_error_code::missing_definition);
+    if (llvm::sys::path::is_absolute(*FileName)) {
+      ASTFileName = *FileName;
     } else {
-      Unit = ASTCacheEntry->second.get();
+      ASTFileName = CrossTUDir;
+      llvm::sys::path::append(ASTFileName, *FileName);
     }
-    FunctionASTUnitMap[LookupName] = Unit;
   } else {
-    Unit = FnUnitCacheEntry->second;
+    auto It = FunctionFileMap.find(LookupName);
+    if (It == FunctionFileMap.end())
+      return llvm::make_error<IndexError>(
+          index_error_code::missing_definition);
+    ASTFileName = It->second;
+  }
+  auto ASTCacheEntry = FileASTUnitMap.find(ASTFileName);
+  if (ASTCacheEntry != FileASTUnitMap.end()) {
+    LoadedASTUnit &Loaded = ASTCacheEntry->second;
+    ASTUnitUseOrder.splice(ASTUnitUseOrder.begin(), ASTUnitUseOrder,
+                           Loaded.UsePosition);
+    return Loaded.Unit.get();
   }
+
+  std::unique_ptr<ASTUnit> LoadedUnit;
+  uint64_t FileSize = 0;
+  if (!CompilationDatabasePath.empty() &&
+      llvm::sys::path::extension(ASTFileName) != ".ast") {
+    llvm::Expected<std::unique_ptr<ASTUnit>> UnitOrErr =
+        parseSourceFile(ASTFileName, FileSize);
+    if (!UnitOrErr)
+      return UnitOrErr.takeError();
+    LoadedUnit = std::move(*UnitOrErr);
+  } else {
+    LoadedUnit = loadFromASTFile(ASTFileName, /*ReportErrors=*/true);
+    if (LoadedUnit && llvm::sys::fs::file_size(ASTFileName, FileSize))
+      FileSize = 0;
+  }
+  ASTUnit *Unit = LoadedUnit.get();
+
+  auto &Entry = *FileASTUnitMap.try_emplace(ASTFileName).first;
+  LoadedASTUnit &Loaded = Entry.getValue();
+  Loaded.Unit = std::move(LoadedUnit);
+  Loaded.FileSize = FileSize;
+  if (Unit) {
+    ++NumASTLoaded;
+    NumASTLoadedKB += FileSize / 1024;
+  }
+  ASTUnitUseOrder.push_front(Entry.getKey());
+  Loaded.UsePosition = ASTUnitUseOrder.begin();
+
+  if (MaxLoadedASTSize)
+    unloadLeastRecentlyUsedASTUnits();
   return Unit;
 }
 
 llvm::Expected<const FunctionDecl *>
 CrossTranslationUnitContext::importDefinition(const FunctionDecl *FD) {
+  llvm::TimeRegion Timer(ImportTimer);
   ASTImporter &Importer = getOrCreateASTImporter(FD->getASTContext());
+  ++NumFunctionsImported;
   auto *ToDecl =
       cast<FunctionDecl>(Importer.Import(const_cast<FunctionDecl *>(FD)));
   assert(ToDecl->hasBody());
@@ -258,9 +664,15 @@ CrossTranslationUnitContext::getOrCreateASTImporter(ASTContext &From) {
   auto I = ASTUnitImporterMap.find(From.getTranslationUnitDecl());
   if (I != ASTUnitImporterMap.end())
     return *I->second;
-  ASTImporter *NewImporter =
-      new ASTImporter(Context, Context.getSourceManager().getFileManager(),
-                      From, From.getSourceManager().getFileManager(), false);
+  if (!ImporterLookupTable)
+    ImporterLookupTable = llvm::make_unique<ASTImporterLookupTable>(
+        *Context.getTranslationUnitDecl());
+  ASTImporter *NewImporter = new ASTImporter(
+      Context, Context.getSourceManager().getFileManager(), From,
+      From.getSourceManager().getFileManager(), false,
+      ImporterLookupTable.get());
+  // The analyzer only needs the methods that the imported functions call.
+  NewImporter->setImportOnlyNeededMembers(true);
   ASTUnitImporterMap[From.getTranslationUnitDecl()].reset(NewImporter);
   return *NewImporter;
 }
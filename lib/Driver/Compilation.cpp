@@ -18,12 +18,17 @@
 #include "clang/Driver/Util.h"
 #include "llvm/ADT/None.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/Option/ArgList.h"
 #include "llvm/Option/OptSpecifier.h"
 #include "llvm/Option/Option.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cassert>
 #include <string>
@@ -149,11 +154,10 @@ bool Compilation::CleanupFileMap(const ArgStringMap &Files,
   return Success;
 }
 
-int Compilation::ExecuteCommand(const Command &C,
-                                const Command *&FailingCommand) const {
+bool Compilation::PrintCommand(const Command &C, raw_ostream &DefaultOS) const {
   if ((getDriver().CCPrintOptions ||
        getArgs().hasArg(options::OPT_v)) && !getDriver().CCGenDiagnostics) {
-    raw_ostream *OS = &llvm::errs();
+    raw_ostream *OS = &DefaultOS;
 
     // Follow gcc implementation of CC_PRINT_OPTIONS; we could also cache the
     // output stream.
@@ -165,9 +169,8 @@ int Compilation::ExecuteCommand(const Command &C,
       if (EC) {
         getDriver().Diag(diag::err_drv_cc_print_options_failure)
             << EC.message();
-        FailingCommand = &C;
         delete OS;
-        return 1;
+        return false;
       }
     }
 
@@ -176,9 +179,18 @@ int Compilation::ExecuteCommand(const Command &C,
 
     C.Print(*OS, "\n", /*Quote=*/getDriver().CCPrintOptions);
 
-    if (OS != &llvm::errs())
+    if (OS != &DefaultOS)
       delete OS;
   }
+  return true;
+}
+
+int Compilation::ExecuteCommand(const Command &C,
+                                const Command *&FailingCommand) const {
+  if (!PrintCommand(C, llvm::errs())) {
+    FailingCommand = &C;
+    return 1;
+  }
 
   std::string Error;
   bool ExecutionFailed;
@@ -223,8 +235,157 @@ static bool InputsOk(const Command &C,
   return !ActionFailed(&C.getSource(), FailingCommands);
 }
 
+/// Print the output that a job wrote to \p Path, and remove the file.
+static void replayJobOutput(StringRef Path, raw_ostream &OS) {
+  if (Path.empty())
+    return;
+  if (auto Buf = llvm::MemoryBuffer::getFile(Path))
+    OS << (*Buf)->getBuffer();
+  llvm::sys::fs::remove(Path);
+}
+
+void Compilation::ExecuteJobsInParallel(const JobList &Jobs,
+                                        FailingCommandList &FailingCommands,
+                                        unsigned NumThreads) const {
+  const JobList::list_type &List = Jobs.getJobs();
+  size_t NumJobs = List.size();
+
+  llvm::DenseMap<const Action *, SmallVector<size_t, 1>> JobsForAction;
+  for (size_t I = 0; I != NumJobs; ++I)
+    JobsForAction[&List[I]->getSource()].push_back(I);
+
+  // A job depends on the earlier jobs for the same action, such as the
+  // compile that an objcopy for -gsplit-dwarf reads, and on the jobs for the
+  // nearest actions below its own that have jobs at all. Actions that were
+  // collapsed into a job have none, so look through them.
+  std::vector<SmallVector<size_t, 4>> Deps(NumJobs);
+  for (size_t I = 0; I != NumJobs; ++I) {
+    const Action *Source = &List[I]->getSource();
+    for (size_t J : JobsForAction[Source])
+      if (J < I)
+        Deps[I].push_back(J);
+
+    SmallVector<const Action *, 8> Worklist(Source->input_begin(),
+                                            Source->input_end());
+    llvm::SmallPtrSet<const Action *, 16> Visited;
+    while (!Worklist.empty()) {
+      const Action *A = Worklist.pop_back_val();
+      if (!Visited.insert(A).second)
+        continue;
+      auto It = JobsForAction.find(A);
+      if (It == JobsForAction.end()) {
+        Worklist.append(A->input_begin(), A->input_end());
+        continue;
+      }
+      for (size_t J : It->second)
+        if (J < I)
+          Deps[I].push_back(J);
+    }
+  }
+
+  struct JobState {
+    bool Finished = false;
+    int Res = 0;
+    std::string Error;
+    bool ExecutionFailed = false;
+    std::string Log;
+    SmallString<128> OutFile, ErrFile;
+    std::vector<Optional<StringRef>> Redirects;
+  };
+  std::vector<JobState> States(NumJobs);
+
+  // Run the jobs in waves: each wave starts every job whose dependencies have
+  // finished, and its output is printed once the whole wave is done.
+  llvm::ThreadPool Pool(NumThreads);
+  size_t NumFinished = 0;
+  while (NumFinished != NumJobs) {
+    SmallVector<size_t, 16> Wave;
+    for (size_t I = 0; I != NumJobs; ++I) {
+      JobState &S = States[I];
+      if (S.Finished || !llvm::all_of(Deps[I], [&](size_t D) {
+            return States[D].Finished;
+          }))
+        continue;
+
+      const Command &C = *List[I];
+      if (!InputsOk(C, FailingCommands)) {
+        S.Finished = true;
+        ++NumFinished;
+        continue;
+      }
+
+      llvm::raw_string_ostream LogOS(S.Log);
+      if (!PrintCommand(C, LogOS)) {
+        S.Finished = true;
+        ++NumFinished;
+        FailingCommands.push_back(std::make_pair(1, &C));
+        continue;
+      }
+      LogOS.flush();
+
+      // If the output cannot be captured, let the job write it directly.
+      if (!llvm::sys::fs::createTemporaryFile("clang-job", "out", S.OutFile) &&
+          !llvm::sys::fs::createTemporaryFile("clang-job", "err", S.ErrFile))
+        S.Redirects = {None, StringRef(S.OutFile), StringRef(S.ErrFile)};
+      Wave.push_back(I);
+    }
+    if (Wave.empty())
+      break;
+
+    for (size_t I : Wave)
+      Pool.async([&, I] {
+        JobState &S = States[I];
+        S.Res = List[I]->Execute(S.Redirects, &S.Error, &S.ExecutionFailed);
+      });
+    Pool.wait();
+
+    for (size_t I : Wave) {
+      JobState &S = States[I];
+      S.Finished = true;
+      ++NumFinished;
+
+      // A CUDA or HIP job is not run once another job has failed. If an
+      // earlier job of this wave failed, drop the results of this one as if
+      // it had not run.
+      if (!InputsOk(*List[I], FailingCommands)) {
+        replayJobOutput(S.OutFile, llvm::nulls());
+        replayJobOutput(S.ErrFile, llvm::nulls());
+        continue;
+      }
+
+      llvm::errs() << S.Log;
+      replayJobOutput(S.OutFile, llvm::outs());
+      llvm::outs().flush();
+      replayJobOutput(S.ErrFile, llvm::errs());
+
+      if (!S.Error.empty()) {
+        assert(S.Res && "Error string set with 0 result code!");
+        getDriver().Diag(diag::err_drv_command_failure) << S.Error;
+      }
+      if (int Res = S.ExecutionFailed ? 1 : S.Res)
+        FailingCommands.push_back(std::make_pair(Res, List[I].get()));
+    }
+  }
+}
+
 void Compilation::ExecuteJobs(const JobList &Jobs,
                               FailingCommandList &FailingCommands) const {
+  // Jobs that run at the same time have their output captured, which isn't
+  // possible if it is already redirected. In CL mode, stop at the first
+  // failure as before.
+  //
+  // CUDA and HIP compile the same source once per device architecture, and
+  // those compilations are independent, so they run at once by default.
+  unsigned NumThreads = 1;
+  if (const Arg *A = getArgs().getLastArg(options::OPT_parallel_jobs_EQ))
+    StringRef(A->getValue()).getAsInteger(10, NumThreads);
+  else if (isOffloadingHostKind(Action::OFK_Cuda) ||
+           isOffloadingHostKind(Action::OFK_HIP))
+    NumThreads = llvm::heavyweight_hardware_concurrency();
+  if (NumThreads > 1 && Jobs.size() > 1 && Redirects.empty() &&
+      !TheDriver.IsCLMode())
+    return ExecuteJobsInParallel(Jobs, FailingCommands, NumThreads);
+
   // According to UNIX standard, driver need to continue compiling all the
   // inputs on the command line even one of them failed.
   // In all but CLMode, execute all the jobs unless the necessary inputs for the
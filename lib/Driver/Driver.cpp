@@ -3476,6 +3476,22 @@ void Driver::BuildJobs(Compilation &C) const {
                        /*TargetDeviceOffloadKind*/ Action::OFK_None);
   }
 
+  // A -cc1 job leaks its compiler state on exit and may set process-wide
+  // LLVM options, so only a lone -cc1 job can run in the driver's process.
+  unsigned NumInProcess = llvm::count_if(
+      C.getJobs(), [](const Command &J) { return J.isInProcess(); });
+  if (NumInProcess > 1)
+    for (auto &J : C.getJobs())
+      J.disableInProcess();
+
+  if (Arg *A = C.getArgs().getLastArg(options::OPT_parallel_jobs_EQ)) {
+    unsigned NumThreads;
+    StringRef Value = A->getValue();
+    if (Value.getAsInteger(10, NumThreads) || NumThreads == 0)
+      Diag(clang::diag::err_drv_invalid_int_value)
+          << A->getAsString(C.getArgs()) << Value;
+  }
+
   // If the user passed -Qunused-arguments or there were errors, don't warn
   // about any unused arguments.
   if (Diags.hasErrorOccurred() ||
@@ -3485,9 +3501,12 @@ void Driver::BuildJobs(Compilation &C) const {
   // Claim -### here.
   (void)C.getArgs().hasArg(options::OPT__HASH_HASH_HASH);
 
-  // Claim --driver-mode, --rsp-quoting, it was handled earlier.
+  // Claim --driver-mode, --rsp-quoting, -f[no-]integrated-cc1, they were
+  // handled earlier.
   (void)C.getArgs().hasArg(options::OPT_driver_mode);
   (void)C.getArgs().hasArg(options::OPT_rsp_quoting);
+  (void)C.getArgs().hasArg(options::OPT_fintegrated_cc1,
+                           options::OPT_fno_integrated_cc1);
 
   for (Arg *A : C.getArgs()) {
     // FIXME: It would be nice to be able to send the argument to the
@@ -16,6 +16,7 @@
 #include "Arch/SystemZ.h"
 #include "CommonArgs.h"
 #include "Linux.h"
+#include "clang/Basic/Version.h"
 #include "clang/Config/config.h" // for GCC_INSTALL_PREFIX
 #include "clang/Driver/Compilation.h"
 #include "clang/Driver/Driver.h"
@@ -24,6 +25,8 @@
 #include "clang/Driver/Tool.h"
 #include "llvm/Option/ArgList.h"
 #include "llvm/Support/CodeGen.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/TargetParser.h"
 #include "llvm/Support/VirtualFileSystem.h"
@@ -1740,15 +1743,38 @@ void Generic_GCC::GCCInstallationDetector::init(
       return;
   }
 
+  // With --gcc-install-cache, reuse the result of an earlier search over the
+  // same prefixes if none of the directories it looked at has changed.
+  StringRef CachePath = Args.getLastArgValue(options::OPT_gcc_install_cache_EQ);
+  std::string CacheKey;
+  if (!CachePath.empty()) {
+    llvm::raw_string_ostream KeyOS(CacheKey);
+    KeyOS << "clang " << getClangFullVersion() << "\n";
+    KeyOS << "target " << TargetTriple.str() << "\n";
+    for (StringRef Alias : ExtraTripleAliases)
+      KeyOS << "alias " << Alias << "\n";
+    for (const std::string &Prefix : Prefixes)
+      KeyOS << "prefix " << Prefix << "\n";
+    // Multilib detection, which can reject an installation, depends on these.
+    for (const Arg *A : Args)
+      if (A->getOption().matches(options::OPT_m_Group))
+        KeyOS << "flag " << A->getAsString(Args) << "\n";
+    KeyOS.flush();
+
+    if (loadFromCache(CachePath, CacheKey, TargetTriple, Args))
+      return;
+    RecordSearchedDirs = true;
+  }
+
   // Loop over the various components which exist and select the best GCC
   // installation available. GCC installs are ranked by version number.
   Version = GCCVersion::Parse("0.0.0");
   for (const std::string &Prefix : Prefixes) {
-    if (!D.getVFS().exists(Prefix))
+    if (!searchDir(Prefix))
       continue;
     for (StringRef Suffix : CandidateLibDirs) {
       const std::string LibDir = Prefix + Suffix.str();
-      if (!D.getVFS().exists(LibDir))
+      if (!searchDir(LibDir))
         continue;
       // Try to match the exact target triple first.
       ScanLibDirForGCCTriple(TargetTriple, Args, LibDir, TargetTriple.str());
@@ -1760,13 +1786,123 @@ void Generic_GCC::GCCInstallationDetector::init(
     }
     for (StringRef Suffix : CandidateBiarchLibDirs) {
       const std::string LibDir = Prefix + Suffix.str();
-      if (!D.getVFS().exists(LibDir))
+      if (!searchDir(LibDir))
         continue;
       for (StringRef Candidate : CandidateBiarchTripleAliases)
         ScanLibDirForGCCTriple(TargetTriple, Args, LibDir, Candidate,
                                /*NeedsBiarchSuffix=*/ true);
     }
   }
+
+  if (!CachePath.empty())
+    saveToCache(CachePath, CacheKey);
+}
+
+bool Generic_GCC::GCCInstallationDetector::searchDir(StringRef Dir) {
+  if (!RecordSearchedDirs)
+    return D.getVFS().exists(Dir);
+
+  int64_t Stamp = -1;
+  if (llvm::ErrorOr<llvm::vfs::Status> S = D.getVFS().status(Dir))
+    Stamp = S->getLastModificationTime().time_since_epoch().count();
+  SearchedDirs.emplace_back(Dir.str(), Stamp);
+  return Stamp != -1;
+}
+
+bool Generic_GCC::GCCInstallationDetector::loadFromCache(
+    StringRef CachePath, StringRef Key, const llvm::Triple &TargetTriple,
+    const ArgList &Args) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buf =
+      llvm::MemoryBuffer::getFile(CachePath);
+  if (!Buf)
+    return false;
+  StringRef Contents = (*Buf)->getBuffer();
+  if (!Contents.consume_front(Key))
+    return false;
+
+  std::set<std::string> Candidates;
+  StringRef InstallPath, ParentLibPath, Triple, VersionText;
+  bool Biarch = false;
+  SmallVector<StringRef, 32> Lines;
+  Contents.split(Lines, '\n', /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+  for (StringRef Line : Lines) {
+    StringRef Kind, Value;
+    std::tie(Kind, Value) = Line.split(' ');
+    if (Kind == "dir") {
+      // The entry is stale if any searched directory has since been created,
+      // removed or modified.
+      StringRef StampText, Dir;
+      std::tie(StampText, Dir) = Value.split(' ');
+      int64_t Stamp;
+      if (StampText.getAsInteger(10, Stamp))
+        return false;
+      int64_t CurrentStamp = -1;
+      if (llvm::ErrorOr<llvm::vfs::Status> S = D.getVFS().status(Dir))
+        CurrentStamp = S->getLastModificationTime().time_since_epoch().count();
+      if (CurrentStamp != Stamp)
+        return false;
+    } else if (Kind == "candidate") {
+      Candidates.insert(Value.str());
+    } else if (Kind == "install") {
+      InstallPath = Value;
+    } else if (Kind == "parent") {
+      ParentLibPath = Value;
+    } else if (Kind == "triple") {
+      Triple = Value;
+    } else if (Kind == "version") {
+      VersionText = Value;
+    } else if (Kind == "biarch") {
+      Biarch = Value == "1";
+    } else {
+      return false;
+    }
+  }
+
+  // The multilibs are not cached; detecting them for the one installation
+  // that was selected is cheap.
+  if (!InstallPath.empty()) {
+    if (!ScanGCCForMultilibs(TargetTriple, Args, InstallPath, Biarch))
+      return false;
+    Version = GCCVersion::Parse(VersionText);
+    GCCTriple.setTriple(Triple);
+    GCCInstallPath = InstallPath.str();
+    GCCParentLibPath = ParentLibPath.str();
+    FoundInBiarchLibDir = Biarch;
+    IsValid = true;
+  }
+  CandidateGCCInstallPaths = std::move(Candidates);
+  return true;
+}
+
+void Generic_GCC::GCCInstallationDetector::saveToCache(StringRef CachePath,
+                                                       StringRef Key) const {
+  std::string Contents = Key;
+  llvm::raw_string_ostream OS(Contents);
+  for (const auto &Dir : SearchedDirs)
+    OS << "dir " << Dir.second << " " << Dir.first << "\n";
+  for (const std::string &Candidate : CandidateGCCInstallPaths)
+    OS << "candidate " << Candidate << "\n";
+  if (IsValid) {
+    OS << "install " << GCCInstallPath << "\n";
+    OS << "parent " << GCCParentLibPath << "\n";
+    OS << "triple " << GCCTriple.str() << "\n";
+    OS << "version " << Version.Text << "\n";
+    OS << "biarch " << (FoundInBiarchLibDir ? "1" : "0") << "\n";
+  }
+  OS.flush();
+
+  // Write to a temporary file and rename it, so that concurrent compiles
+  // never read a partial cache. Failures just leave the cache as it was.
+  int FD;
+  SmallString<128> TmpPath;
+  if (llvm::sys::fs::createUniqueFile(CachePath + "-%%%%%%%%", FD, TmpPath))
+    return;
+  {
+    llvm::raw_fd_ostream Out(FD, /*shouldClose=*/true);
+    Out << Contents;
+  }
+  if (llvm::sys::fs::rename(TmpPath, CachePath))
+    llvm::sys::fs::remove(TmpPath);
 }
 
 void Generic_GCC::GCCInstallationDetector::print(raw_ostream &OS) const {
@@ -2267,6 +2403,8 @@ void Generic_GCC::GCCInstallationDetector::ScanLibDirForGCCTriple(
       continue;
 
     StringRef LibSuffix = Suffix.LibSuffix;
+    if (RecordSearchedDirs)
+      searchDir(LibDir + "/" + LibSuffix.str());
     std::error_code EC;
     for (llvm::vfs::directory_iterator
              LI = D.getVFS().dir_begin(LibDir + "/" + LibSuffix, EC),
@@ -2288,6 +2426,7 @@ void Generic_GCC::GCCInstallationDetector::ScanLibDirForGCCTriple(
 
       Version = CandidateVersion;
       GCCTriple.setTriple(CandidateTriple);
+      FoundInBiarchLibDir = NeedsBiarchSuffix;
       // FIXME: We hack together the directory name here instead of
       // using LI to ensure stable path separators across Windows and
       // Linux.
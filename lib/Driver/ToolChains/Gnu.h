@@ -14,6 +14,9 @@
 #include "clang/Driver/Tool.h"
 #include "clang/Driver/ToolChain.h"
 #include <set>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace clang {
 namespace driver {
@@ -208,6 +211,18 @@ public:
     /// The set of multilibs that the detected installation supports.
     MultilibSet Multilibs;
 
+    /// Whether the detected installation was found in a biarch library
+    /// directory.
+    bool FoundInBiarchLibDir = false;
+
+    /// Whether to record the directories the search depends on, so that its
+    /// result can be cached.
+    bool RecordSearchedDirs = false;
+
+    /// The directories whose existence or contents the search depended on,
+    /// with their modification times, or -1 for those that don't exist.
+    std::vector<std::pair<std::string, int64_t>> SearchedDirs;
+
   public:
     explicit GCCInstallationDetector(const Driver &D) : IsValid(false), D(D) {}
     void init(const llvm::Triple &TargetTriple, const llvm::opt::ArgList &Args,
@@ -274,6 +289,19 @@ public:
                              const llvm::opt::ArgList &Args,
                              StringRef CandidateTriple,
                              bool NeedsBiarchSuffix = false);
+
+    /// Check whether \p Dir exists, and record it in SearchedDirs.
+    bool searchDir(StringRef Dir);
+
+    /// Restore the installation found by an earlier search with the same
+    /// \p Key from the cache file \p CachePath, if none of the searched
+    /// directories has changed since.
+    bool loadFromCache(StringRef CachePath, StringRef Key,
+                       const llvm::Triple &TargetTriple,
+                       const llvm::opt::ArgList &Args);
+
+    /// Write the result of the search to the cache file \p CachePath.
+    void saveToCache(StringRef CachePath, StringRef Key) const;
   };
 
 protected:
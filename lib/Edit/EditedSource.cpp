@@ -22,6 +22,8 @@
 #include "llvm/ADT/Twine.h"
 #include <algorithm>
 #include <cassert>
+#include <map>
+#include <string>
 #include <tuple>
 #include <utility>
 
@@ -72,6 +74,18 @@ StringRef EditedSource::copyString(const Twine &twine) {
   return copyString(twine.toStringRef(Data));
 }
 
+bool EditedSource::conflictsWithMacroArgUse(
+    const llvm::DenseMap<unsigned, SmallVector<MacroArgUse, 2>> &Uses,
+    SourceLocation ExpLoc, const MacroArgUse &ArgUse) const {
+  auto I = Uses.find(ExpLoc.getRawEncoding());
+  return I != Uses.end() &&
+         find_if(I->second, [&](const MacroArgUse &U) {
+           return ArgUse.Identifier == U.Identifier &&
+                  std::tie(ArgUse.ImmediateExpansionLoc, ArgUse.UseLoc) !=
+                      std::tie(U.ImmediateExpansionLoc, U.UseLoc);
+         }) != I->second.end();
+}
+
 bool EditedSource::canInsertInOffset(SourceLocation OrigLoc, FileOffset Offs) {
   FileEditsTy::iterator FA = getActionForOffset(Offs);
   if (FA != FileEdits.end()) {
@@ -83,13 +97,7 @@ bool EditedSource::canInsertInOffset(SourceLocation OrigLoc, FileOffset Offs) {
     SourceLocation ExpLoc;
     MacroArgUse ArgUse;
     deconstructMacroArgLoc(OrigLoc, ExpLoc, ArgUse);
-    auto I = ExpansionToArgMap.find(ExpLoc.getRawEncoding());
-    if (I != ExpansionToArgMap.end() &&
-        find_if(I->second, [&](const MacroArgUse &U) {
-          return ArgUse.Identifier == U.Identifier &&
-                 std::tie(ArgUse.ImmediateExpansionLoc, ArgUse.UseLoc) !=
-                     std::tie(U.ImmediateExpansionLoc, U.UseLoc);
-        }) != I->second.end()) {
+    if (conflictsWithMacroArgUse(ExpansionToArgMap, ExpLoc, ArgUse)) {
       // Trying to write in a macro argument input that has already been
       // written by a previous commit for another expansion of the same macro
       // argument name. For example:
@@ -311,6 +319,131 @@ bool EditedSource::commit(const Commit &commit) {
   return true;
 }
 
+bool EditedSource::commitBatch(ArrayRef<Commit> Commits) {
+  if (tryCommitBatchInBulk(Commits))
+    return llvm::all_of(Commits,
+                        [](const Commit &C) { return C.isCommitable(); });
+
+  bool AllCommitted = true;
+  for (const Commit &C : Commits)
+    AllCommitted &= commit(C);
+  return AllCommitted;
+}
+
+/// Commit all of \p Commits at once, if that gives the same result as
+/// committing them one by one.  Returns false, without changing anything, if
+/// it does not.
+bool EditedSource::tryCommitBatchInBulk(ArrayRef<Commit> Commits) {
+  // The edits of the batch, keyed by offset, and the commit each belongs to.
+  struct BatchEdit {
+    unsigned CommitIdx;
+    unsigned RemoveLen = 0;
+    std::string Text;
+  };
+  std::map<FileOffset, BatchEdit> Batch;
+  SmallVector<std::pair<SourceLocation, MacroArgUse>, 8> BatchArgExps;
+  llvm::DenseMap<unsigned, SmallVector<MacroArgUse, 2>> BatchArgUses;
+
+  for (unsigned Idx = 0, N = Commits.size(); Idx != N; ++Idx) {
+    const Commit &C = Commits[Idx];
+    if (!C.isCommitable())
+      continue;
+
+    size_t FirstArgExp = BatchArgExps.size();
+    for (const Commit::Edit &E :
+         llvm::make_range(C.edit_begin(), C.edit_end())) {
+      switch (E.Kind) {
+      case Commit::Act_InsertFromRange:
+        // The inserted text depends on the edits committed before it.
+        return false;
+
+      case Commit::Act_Remove: {
+        if (E.Length == 0)
+          break;
+        // Removing at an offset that already has edits clears or merges them.
+        if (!Batch.insert({E.Offset, BatchEdit{Idx, E.Length, {}}}).second)
+          return false;
+        break;
+      }
+
+      case Commit::Act_Insert: {
+        if (E.Text.empty())
+          break;
+        auto It = Batch.find(E.Offset);
+        if (It != Batch.end() && It->second.CommitIdx != Idx)
+          return false;
+
+        if (SourceMgr.isMacroArgExpansion(E.OrigLoc)) {
+          SourceLocation ExpLoc;
+          MacroArgUse ArgUse;
+          deconstructMacroArgLoc(E.OrigLoc, ExpLoc, ArgUse);
+          if (conflictsWithMacroArgUse(ExpansionToArgMap, ExpLoc, ArgUse) ||
+              conflictsWithMacroArgUse(BatchArgUses, ExpLoc, ArgUse))
+            return false;
+          if (ArgUse.Identifier)
+            BatchArgExps.emplace_back(ExpLoc, ArgUse);
+        }
+
+        if (It == Batch.end()) {
+          Batch.insert({E.Offset, BatchEdit{Idx, 0, E.Text}});
+          break;
+        }
+        std::string &Text = It->second.Text;
+        Text = E.BeforePrev ? (E.Text + Twine(Text)).str()
+                            : (Twine(Text) + E.Text).str();
+        break;
+      }
+      }
+    }
+
+    // Like finishedCommit, the uses only count against later commits.
+    for (size_t I = FirstArgExp, E = BatchArgExps.size(); I != E; ++I) {
+      auto &ArgUses = BatchArgUses[BatchArgExps[I].first.getRawEncoding()];
+      if (!llvm::is_contained(ArgUses, BatchArgExps[I].second))
+        ArgUses.push_back(BatchArgExps[I].second);
+    }
+  }
+
+  // Sweep the sorted edits, checking that none starts inside a removal of
+  // the batch and that none touches an edit that was committed earlier.
+  FileOffset PrevEnd;
+  for (const auto &Entry : Batch) {
+    FileOffset B = Entry.first;
+    FileOffset E = B.getWithOffset(std::max(Entry.second.RemoveLen, 1u));
+    if (B < PrevEnd)
+      return false;
+    PrevEnd = B.getWithOffset(Entry.second.RemoveLen);
+
+    FileEditsTy::iterator I = FileEdits.lower_bound(B);
+    if (I != FileEdits.end() && I->first < E)
+      return false;
+    if (I != FileEdits.begin()) {
+      --I;
+      if (B < I->first.getWithOffset(I->second.RemoveLen))
+        return false;
+    }
+  }
+
+  // Merge the sorted edits into the map; each one goes right before the
+  // first earlier edit that follows it.
+  FileEditsTy::iterator Hint = FileEdits.begin();
+  for (const auto &Entry : Batch) {
+    while (Hint != FileEdits.end() && Hint->first < Entry.first)
+      ++Hint;
+    FileEdit FA;
+    FA.Text = copyString(StringRef(Entry.second.Text));
+    FA.RemoveLen = Entry.second.RemoveLen;
+    FileEdits.emplace_hint(Hint, Entry.first, FA);
+  }
+
+  for (auto &ExpArg : BatchArgExps) {
+    auto &ArgUses = ExpansionToArgMap[ExpArg.first.getRawEncoding()];
+    if (!llvm::is_contained(ArgUses, ExpArg.second))
+      ArgUses.push_back(ExpArg.second);
+  }
+  return true;
+}
+
 // Returns true if it is ok to make the two given characters adjacent.
 static bool canBeJoined(char left, char right, const LangOptions &LangOpts) {
   // FIXME: Should use TokenConcatenation to make sure we don't allow stuff like
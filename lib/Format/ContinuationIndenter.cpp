@@ -2166,6 +2166,35 @@ unsigned ContinuationIndenter::getColumnLimit(const LineState &State) const {
   return Style.ColumnLimit - (State.Line->InPPDirective ? 2 : 0);
 }
 
+unsigned
+ContinuationIndenter::getMinimumRemainingPenalty(const LineState &State) {
+  if (Style.ColumnLimit == 0 || !State.NextToken || canBreak(State))
+    return 0;
+
+  unsigned ColumnLimit = getColumnLimit(State);
+  unsigned Column = State.Column;
+  unsigned Penalty = 0;
+  for (const FormatToken *Tok = State.NextToken; Tok; Tok = Tok->Next) {
+    // canBreak() also allows breaking before closing braces when the
+    // braced list or block was broken after its opening brace.
+    if (Tok != State.NextToken &&
+        (Tok->CanBreakBefore || Tok->MustBreakBefore ||
+         Tok->Decision == FD_Break || Tok->closesBlockOrBlockTypeList(Style)))
+      break;
+    // Stop at tokens that may be broken or reflowed themselves, and at tokens
+    // that move the state along in ways other than adding their width.
+    if (Tok->IsMultiline || Tok->isStringLiteral() || Tok->is(tok::comment) ||
+        Tok->isOneOf(TT_ImplicitStringLiteral, TT_TemplateString) ||
+        Tok->Role || !Tok->Previous || Tok->Previous->Role ||
+        !Tok->Previous->Children.empty())
+      break;
+    Column += Tok->ColumnWidth;
+    if (Column > ColumnLimit)
+      Penalty += Style.PenaltyExcessCharacter * (Column - ColumnLimit);
+  }
+  return Penalty;
+}
+
 bool ContinuationIndenter::nextIsMultilineString(const LineState &State) {
   const FormatToken &Current = *State.NextToken;
   if (!Current.isStringLiteral() || Current.is(TT_ImplicitStringLiteral))
@@ -89,6 +89,14 @@ public:
   /// limit, potentially reduced for preprocessor definitions.
   unsigned getColumnLimit(const LineState &State) const;
 
+  /// Returns a lower bound on the penalty that placing the remaining tokens
+  /// after \p State adds, however the rest of the line is broken.
+  ///
+  /// This is the penalty for the characters beyond the column limit of the
+  /// tokens starting at \c State.NextToken that can neither be put on a new
+  /// line nor be reflowed.
+  unsigned getMinimumRemainingPenalty(const LineState &State);
+
 private:
   /// Mark the next token as consumed in \p State and modify its stacks
   /// accordingly.
@@ -32,6 +32,7 @@
 #include "clang/Lex/Lexer.h"
 #include "clang/Tooling/Inclusions/HeaderIncludes.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/Debug.h"
@@ -40,6 +41,8 @@
 #include "llvm/Support/VirtualFileSystem.h"
 #include "llvm/Support/YAMLTraits.h"
 #include <algorithm>
+#include <limits>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -2244,6 +2247,379 @@ tooling::Replacements reformat(const FormatStyle &Style, StringRef Code,
   return Result;
 }
 
+namespace {
+
+/// A point between two top-level declarations at which a file can be split
+/// without changing how either part is formatted. See IncrementalFormatter.
+struct SplitPoint {
+  /// The offset of the first token of the line that starts at this point.
+  unsigned Offset;
+  /// The offset right after the last token before this point.
+  unsigned WhitespaceOffset;
+  /// The offset of the first token of the line before this point.
+  unsigned PreviousLineOffset;
+  /// The offset right after the last token of the line starting here.
+  unsigned LineEndOffset;
+  /// The number of namespace and linkage blocks this point is in.
+  unsigned Depth;
+};
+
+/// Parses a piece of a file into unwrapped lines and collects the split
+/// points in it.
+class SplitPointFinder : public UnwrappedLineConsumer {
+public:
+  SplitPointFinder(const FormatStyle &Style) : Style(Style) {}
+
+  /// Finds the split points of the code between \p Begin and \p End in
+  /// \p Code. \p Begin must be the start of the file or a split point in
+  /// \p Depth namespaces, and \p End the end of the file or the whitespace
+  /// before a split point. Unless the piece is the whole file, it must be
+  /// balanced: it must not close blocks or preprocessor conditionals it did
+  /// not open, must leave none open, and may only end after a complete
+  /// declaration.
+  ///
+  /// Returns false if the piece does not meet these conditions, or if its
+  /// preprocessor conditionals make it parse in more than one run. Otherwise
+  /// appends the split points to \p Points and sets \p EndDepth to the number
+  /// of namespaces open at \p End.
+  bool find(StringRef Code, unsigned Begin, unsigned End, unsigned Depth,
+            StringRef FileName, std::vector<SplitPoint> &Points,
+            unsigned &EndDepth) {
+    StringRef Piece = Code.slice(Begin, End);
+    Environment Env(Piece, FileName, /*Ranges=*/{});
+    const SourceManager &SM = Env.getSourceManager();
+    FormatTokenLexer Tokens(
+        SM, Env.getFileID(), /*Column=*/0, Style,
+        encoding::detectEncoding(SM.getBufferData(Env.getFileID())));
+    UnwrappedLineParser Parser(Style, Tokens.getKeywords(),
+                               /*FirstStartColumn=*/0, Tokens.lex(), *this);
+    Parser.parse();
+    if (Runs != 1)
+      return false;
+
+    auto getOffset = [&](SourceLocation Loc) {
+      return Begin + SM.getFileOffset(Loc);
+    };
+    auto getEndOffset = [&](const FormatToken *Tok) {
+      return getOffset(Tok->Tok.getLocation()) + Tok->TokenText.size();
+    };
+
+    bool WholeFile = Begin == 0 && End == Code.size();
+    Stack.clear();
+    int PPDepth = 0;
+    const UnwrappedLine *Previous = nullptr;
+    for (const UnwrappedLine &Line : Lines) {
+      const FormatToken *First = Line.Tokens.front().Tok;
+      if (First->is(tok::eof))
+        continue;
+
+      if (Previous && !Line.InPPDirective && !Previous->InPPDirective &&
+          Line.Level == 0 && PPDepth == 0 &&
+          llvm::all_of(Stack, [](bool IsNamespace) { return IsNamespace; }) &&
+          First->NewlinesBefore >= 2 && First->OriginalColumn == 0 &&
+          !First->isOneOf(tok::r_brace, tok::kw_using) &&
+          Previous->Tokens.front().Tok->isNot(tok::kw_using) &&
+          endsDeclaration(*Previous))
+        Points.push_back(
+            {getOffset(First->Tok.getLocation()),
+             getOffset(First->WhitespaceRange.getBegin()),
+             getOffset(Previous->Tokens.front().Tok->Tok.getLocation()),
+             getEndOffset(Line.Tokens.back().Tok), Depth + Stack.size()});
+
+      if (Line.InPPDirective) {
+        const FormatToken *Keyword = getToken(Line, 1);
+        if (First->is(tok::hash) && Keyword &&
+            Keyword->Tok.getIdentifierInfo()) {
+          switch (Keyword->Tok.getIdentifierInfo()->getPPKeywordID()) {
+          case tok::pp_if:
+          case tok::pp_ifdef:
+          case tok::pp_ifndef:
+            ++PPDepth;
+            break;
+          case tok::pp_endif:
+            if (--PPDepth < 0)
+              return false;
+            break;
+          default:
+            break;
+          }
+        }
+      } else if (!countBrackets(Line, Previous)) {
+        return false;
+      }
+      Previous = &Line;
+    }
+
+    if (!WholeFile) {
+      if (!Stack.empty() || PPDepth != 0)
+        return false;
+      // Make sure the piece ends where the declaration before the split point
+      // ends, and not, say, inside a comment that runs on.
+      if (End != Code.size() &&
+          (!Previous || Previous->InPPDirective || !endsDeclaration(*Previous) ||
+           getEndOffset(Previous->Tokens.back().Tok) != End))
+        return false;
+    }
+    EndDepth = Depth + Stack.size();
+    return true;
+  }
+
+private:
+  void consumeUnwrappedLine(const UnwrappedLine &Line) override {
+    if (Runs == 0)
+      Lines.push_back(Line);
+  }
+
+  void finishRun() override { ++Runs; }
+
+  static const FormatToken *getToken(const UnwrappedLine &Line,
+                                     unsigned Index) {
+    for (const UnwrappedLineNode &Node : Line.Tokens)
+      if (Index-- == 0)
+        return Node.Tok;
+    return nullptr;
+  }
+
+  /// Whether \p Line ends with a semicolon or a closing brace, optionally
+  /// followed by a single complete comment.
+  static bool endsDeclaration(const UnwrappedLine &Line) {
+    auto I = Line.Tokens.rbegin(), E = Line.Tokens.rend();
+    if (I->Tok->is(tok::comment)) {
+      StringRef Text = I->Tok->TokenText;
+      bool Complete = Text.startswith("//")
+                          ? !Text.endswith("\\")
+                          : Text.size() >= 4 && Text.endswith("*/");
+      if (!Complete || ++I == E)
+        return false;
+    }
+    return I->Tok->isOneOf(tok::semi, tok::r_brace);
+  }
+
+  /// Updates the stack of open brackets with the tokens of \p Line. Returns
+  /// false if a bracket is closed that was not opened.
+  bool countBrackets(const UnwrappedLine &Line, const UnwrappedLine *Previous) {
+    // The token that decides whether a brace at the end of the line opens a
+    // namespace or linkage block.
+    const UnwrappedLine &Head =
+        Line.Tokens.size() == 1 && Previous ? *Previous : Line;
+    const FormatToken *HeadFirst = getToken(Head, 0);
+    const FormatToken *HeadSecond = getToken(Head, 1);
+    bool EndsWithNamespaceBrace =
+        HeadFirst->is(tok::kw_namespace) ||
+        (HeadFirst->is(tok::kw_inline) && HeadSecond &&
+         HeadSecond->is(tok::kw_namespace)) ||
+        (HeadFirst->is(tok::kw_extern) && HeadSecond &&
+         HeadSecond->isStringLiteral());
+
+    for (const UnwrappedLineNode &Node : Line.Tokens) {
+      const FormatToken *Tok = Node.Tok;
+      if (Tok->isOneOf(tok::l_paren, tok::l_square)) {
+        Stack.push_back(false);
+      } else if (Tok->is(tok::l_brace)) {
+        Stack.push_back(EndsWithNamespaceBrace &&
+                        &Node == &Line.Tokens.back());
+      } else if (Tok->isOneOf(tok::r_paren, tok::r_square, tok::r_brace)) {
+        if (Stack.empty())
+          return false;
+        Stack.pop_back();
+      }
+      for (const UnwrappedLine &Child : Node.Children)
+        if (!countBrackets(Child, nullptr))
+          return false;
+    }
+    return true;
+  }
+
+  const FormatStyle &Style;
+  std::vector<UnwrappedLine> Lines;
+  unsigned Runs = 0;
+  /// For each open bracket, whether it opens a namespace or linkage block.
+  SmallVector<bool, 8> Stack;
+};
+
+} // end anonymous namespace
+
+class IncrementalFormatter::Impl {
+public:
+  Impl(const FormatStyle &Style, StringRef FileName)
+      : Style(Style), Expanded(expandPresets(Style)), FileName(FileName) {
+    Incremental = Expanded.Language == FormatStyle::LK_Cpp &&
+                  !Expanded.DisableFormat && !Expanded.DerivePointerAlignment &&
+                  Expanded.Standard != FormatStyle::LS_Auto &&
+                  Expanded.NamespaceIndentation == FormatStyle::NI_None &&
+                  !Expanded.CompactNamespaces;
+  }
+
+  tooling::Replacements reformat(StringRef Code,
+                                 ArrayRef<tooling::Range> Ranges,
+                                 FormattingAttemptStatus *Status) {
+    if (!Incremental)
+      return format::reformat(Style, Code, Ranges, FileName, Status);
+
+    if (!Ranges.empty() && update(Code)) {
+      tooling::Replacements Result;
+      if (reformatPiece(Code, Ranges, Status, Result)) {
+        LastCode = Code;
+        return Result;
+      }
+    }
+
+    tooling::Replacements Result =
+        format::reformat(Style, Code, Ranges, FileName, Status);
+    std::vector<SplitPoint> Found;
+    unsigned EndDepth = 0;
+    Points.clear();
+    if (SplitPointFinder(Expanded).find(Code, 0, Code.size(), 0, FileName,
+                                        Found, EndDepth)) {
+      Points.push_back({0, 0, 0, 0, 0});
+      Points.insert(Points.end(), Found.begin(), Found.end());
+      unsigned Size = Code.size();
+      Points.push_back({Size, Size, Size, Size, EndDepth});
+    }
+    LastCode = Code;
+    return Result;
+  }
+
+private:
+  /// Brings the split points of the last version up to date with \p Code.
+  /// Returns false if that is not possible.
+  bool update(StringRef Code) {
+    if (Points.empty())
+      return false;
+    StringRef Old = LastCode;
+    if (Code == Old)
+      return true;
+
+    size_t Prefix = 0;
+    size_t MaxCommon = std::min(Code.size(), Old.size());
+    while (Prefix != MaxCommon && Code[Prefix] == Old[Prefix])
+      ++Prefix;
+    size_t Suffix = 0;
+    while (Suffix != MaxCommon - Prefix &&
+           Code[Code.size() - Suffix - 1] == Old[Old.size() - Suffix - 1])
+      ++Suffix;
+    unsigned OldChangeEnd = Old.size() - Suffix;
+    int Delta = int(Code.size()) - int(Old.size());
+
+    // The closest split points around the change whose lines, and the lines
+    // before them, did not change.
+    size_t B = 0;
+    while (B + 1 != Points.size() && Points[B + 1].LineEndOffset < Prefix)
+      ++B;
+    size_t E = B + 1;
+    while (E + 1 != Points.size() &&
+           Points[E].PreviousLineOffset < OldChangeEnd)
+      ++E;
+    if ((B == 0 && E + 1 == Points.size()) ||
+        Points[B].Depth != Points[E].Depth)
+      return false;
+
+    unsigned End = E + 1 == Points.size()
+                       ? Code.size()
+                       : Points[E].WhitespaceOffset + Delta;
+    std::vector<SplitPoint> Found;
+    unsigned EndDepth;
+    if (!SplitPointFinder(Expanded).find(Code, Points[B].Offset, End,
+                                         Points[B].Depth, FileName, Found,
+                                         EndDepth))
+      return false;
+
+    for (size_t I = E, N = Points.size(); I != N; ++I) {
+      Points[I].Offset += Delta;
+      Points[I].WhitespaceOffset += Delta;
+      Points[I].PreviousLineOffset += Delta;
+      Points[I].LineEndOffset += Delta;
+    }
+    Points.erase(Points.begin() + B + 1, Points.begin() + E);
+    Points.insert(Points.begin() + B + 1, Found.begin(), Found.end());
+    LastCode = Code;
+    return true;
+  }
+
+  /// Reformats \p Ranges by reformatting only the code between the split
+  /// points around them. Returns false if that is not possible.
+  bool reformatPiece(StringRef Code, ArrayRef<tooling::Range> Ranges,
+                     FormattingAttemptStatus *Status,
+                     tooling::Replacements &Result) {
+    unsigned RangesBegin = std::numeric_limits<unsigned>::max();
+    unsigned RangesEnd = 0;
+    for (const tooling::Range &R : Ranges) {
+      RangesBegin = std::min(RangesBegin, R.getOffset());
+      RangesEnd = std::max(RangesEnd, R.getOffset() + R.getLength());
+    }
+
+    // The last split point whose line is not affected by the ranges, and the
+    // first one whose line and the whitespace before it are not.
+    size_t B = 0;
+    while (B + 1 != Points.size() &&
+           Points[B + 1].LineEndOffset < RangesBegin)
+      ++B;
+    size_t E = B + 1;
+    while (E + 1 != Points.size() && Points[E].WhitespaceOffset <= RangesEnd)
+      ++E;
+    if ((B == 0 && E + 1 == Points.size()) ||
+        Points[B].Depth != Points[E].Depth)
+      return false;
+
+    unsigned Begin = Points[B].Offset;
+    unsigned End =
+        E + 1 == Points.size() ? Code.size() : Points[E].WhitespaceOffset;
+    std::vector<SplitPoint> Found;
+    unsigned EndDepth;
+    if (!SplitPointFinder(Expanded).find(Code, Begin, End, Points[B].Depth,
+                                         FileName, Found, EndDepth))
+      return false;
+
+    std::vector<tooling::Range> PieceRanges;
+    for (const tooling::Range &R : Ranges) {
+      unsigned RangeBegin = std::max(R.getOffset(), Begin);
+      unsigned RangeEnd = std::min(R.getOffset() + R.getLength(), End);
+      if (RangeBegin <= RangeEnd)
+        PieceRanges.push_back(
+            tooling::Range(RangeBegin - Begin, RangeEnd - RangeBegin));
+    }
+    tooling::Replacements PieceResult = format::reformat(
+        Style, Code.slice(Begin, End), PieceRanges, FileName, Status);
+    for (const tooling::Replacement &R : PieceResult) {
+      if (llvm::Error Err = Result.add(
+              tooling::Replacement(FileName, R.getOffset() + Begin,
+                                   R.getLength(), R.getReplacementText()))) {
+        llvm::consumeError(std::move(Err));
+        return false;
+      }
+    }
+    if (Status && !Status->FormatComplete)
+      Status->Line += Code.take_front(Begin).count('\n');
+
+    Points.erase(Points.begin() + B + 1, Points.begin() + E);
+    Points.insert(Points.begin() + B + 1, Found.begin(), Found.end());
+    return true;
+  }
+
+  FormatStyle Style;
+  FormatStyle Expanded;
+  std::string FileName;
+  /// Whether files can be formatted incrementally with the style.
+  bool Incremental;
+  /// The last version of the file.
+  std::string LastCode;
+  /// The split points of \c LastCode, including its start and its end, or
+  /// none if they are not known.
+  std::vector<SplitPoint> Points;
+};
+
+IncrementalFormatter::IncrementalFormatter(const FormatStyle &Style,
+                                           StringRef FileName)
+    : State(new Impl(Style, FileName)) {}
+
+IncrementalFormatter::~IncrementalFormatter() = default;
+
+tooling::Replacements
+IncrementalFormatter::reformat(StringRef Code, ArrayRef<tooling::Range> Ranges,
+                               FormattingAttemptStatus *Status) {
+  return State->reformat(Code, Ranges, Status);
+}
+
 tooling::Replacements fixNamespaceEndComments(const FormatStyle &Style,
                                               StringRef Code,
                                               ArrayRef<tooling::Range> Ranges,
@@ -2332,10 +2708,38 @@ const char *DefaultFormatStyle = "file";
 
 const char *DefaultFallbackStyle = "LLVM";
 
+struct FormatStyleCache::Entries {
+  /// What is known about a directory.
+  struct Directory {
+    llvm::sys::TimePoint<> ModificationTime;
+    /// The configuration file in the directory, or empty if it has none.
+    std::string ConfigFile;
+  };
+
+  /// What is known about a configuration file.
+  struct ConfigFile {
+    llvm::sys::TimePoint<> ModificationTime;
+    uint64_t Size = 0;
+    std::string Text;
+    /// The result of parsing the file for each language, and the style if
+    /// parsing succeeded.
+    std::map<FormatStyle::LanguageKind, std::pair<std::error_code, FormatStyle>>
+        Parsed;
+  };
+
+  std::mutex Mutex;
+  llvm::StringMap<Directory> Directories;
+  llvm::StringMap<ConfigFile> ConfigFiles;
+};
+
+FormatStyleCache::FormatStyleCache() : Impl(new Entries) {}
+
+FormatStyleCache::~FormatStyleCache() = default;
+
 llvm::Expected<FormatStyle> getStyle(StringRef StyleName, StringRef FileName,
                                      StringRef FallbackStyleName,
-                                     StringRef Code,
-                                     llvm::vfs::FileSystem *FS) {
+                                     StringRef Code, llvm::vfs::FileSystem *FS,
+                                     FormatStyleCache *Cache) {
   if (!FS) {
     FS = llvm::vfs::getRealFileSystem().get();
   }
@@ -2374,31 +2778,102 @@ llvm::Expected<FormatStyle> getStyle(StringRef StyleName, StringRef FileName,
       continue;
     }
 
-    SmallString<128> ConfigFile(Directory);
-
-    llvm::sys::path::append(ConfigFile, ".clang-format");
-    LLVM_DEBUG(llvm::dbgs() << "Trying " << ConfigFile << "...\n");
+    SmallString<128> ConfigFile;
+    bool FoundConfigFile = false;
+    bool KnownDirectory = false;
+    if (Cache) {
+      std::lock_guard<std::mutex> Lock(Cache->Impl->Mutex);
+      auto I = Cache->Impl->Directories.find(Directory);
+      if (I != Cache->Impl->Directories.end() &&
+          I->second.ModificationTime == Status->getLastModificationTime()) {
+        KnownDirectory = true;
+        ConfigFile = I->second.ConfigFile;
+        FoundConfigFile = !ConfigFile.empty();
+      }
+    }
 
-    Status = FS->status(ConfigFile.str());
-    bool FoundConfigFile =
-        Status && (Status->getType() == llvm::sys::fs::file_type::regular_file);
-    if (!FoundConfigFile) {
-      // Try _clang-format too, since dotfiles are not commonly used on Windows.
+    if (!KnownDirectory) {
       ConfigFile = Directory;
-      llvm::sys::path::append(ConfigFile, "_clang-format");
+      llvm::sys::path::append(ConfigFile, ".clang-format");
       LLVM_DEBUG(llvm::dbgs() << "Trying " << ConfigFile << "...\n");
-      Status = FS->status(ConfigFile.str());
-      FoundConfigFile = Status && (Status->getType() ==
-                                   llvm::sys::fs::file_type::regular_file);
+
+      auto FileStatus = FS->status(ConfigFile.str());
+      FoundConfigFile = FileStatus && (FileStatus->getType() ==
+                                       llvm::sys::fs::file_type::regular_file);
+      if (!FoundConfigFile) {
+        // Try _clang-format too, since dotfiles are not commonly used on
+        // Windows.
+        ConfigFile = Directory;
+        llvm::sys::path::append(ConfigFile, "_clang-format");
+        LLVM_DEBUG(llvm::dbgs() << "Trying " << ConfigFile << "...\n");
+        FileStatus = FS->status(ConfigFile.str());
+        FoundConfigFile = FileStatus && (FileStatus->getType() ==
+                                         llvm::sys::fs::file_type::regular_file);
+      }
+
+      if (Cache) {
+        std::lock_guard<std::mutex> Lock(Cache->Impl->Mutex);
+        auto &Entry = Cache->Impl->Directories[Directory];
+        Entry.ModificationTime = Status->getLastModificationTime();
+        Entry.ConfigFile = FoundConfigFile ? ConfigFile.str().str() : "";
+      }
     }
 
     if (FoundConfigFile) {
-      llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Text =
-          FS->getBufferForFile(ConfigFile.str());
-      if (std::error_code EC = Text.getError())
-        return make_string_error(EC.message());
-      if (std::error_code ec =
-              parseConfiguration(Text.get()->getBuffer(), &Style)) {
+      // The file's status, if it can be cached.
+      llvm::ErrorOr<llvm::vfs::Status> FileStatus =
+          std::make_error_code(std::errc::no_such_file_or_directory);
+      if (Cache)
+        FileStatus = FS->status(ConfigFile.str());
+
+      std::error_code ec;
+      bool Parsed = false;
+      std::string Text;
+      bool HaveText = false;
+      if (FileStatus) {
+        std::lock_guard<std::mutex> Lock(Cache->Impl->Mutex);
+        auto I = Cache->Impl->ConfigFiles.find(ConfigFile);
+        if (I != Cache->Impl->ConfigFiles.end() &&
+            I->second.ModificationTime == FileStatus->getLastModificationTime() &&
+            I->second.Size == FileStatus->getSize()) {
+          auto P = I->second.Parsed.find(Style.Language);
+          if (P != I->second.Parsed.end()) {
+            ec = P->second.first;
+            if (!ec)
+              Style = P->second.second;
+            Parsed = true;
+          } else {
+            Text = I->second.Text;
+            HaveText = true;
+          }
+        }
+      }
+
+      if (!Parsed) {
+        if (!HaveText) {
+          llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+              FS->getBufferForFile(ConfigFile.str());
+          if (std::error_code EC = Buffer.getError())
+            return make_string_error(EC.message());
+          Text = Buffer.get()->getBuffer();
+        }
+        ec = parseConfiguration(Text, &Style);
+
+        if (FileStatus) {
+          std::lock_guard<std::mutex> Lock(Cache->Impl->Mutex);
+          auto &Entry = Cache->Impl->ConfigFiles[ConfigFile];
+          if (Entry.ModificationTime != FileStatus->getLastModificationTime() ||
+              Entry.Size != FileStatus->getSize() || Entry.Text != Text) {
+            Entry.ModificationTime = FileStatus->getLastModificationTime();
+            Entry.Size = FileStatus->getSize();
+            Entry.Text = Text;
+            Entry.Parsed.clear();
+          }
+          Entry.Parsed[Style.Language] = {ec, ec ? FormatStyle() : Style};
+        }
+      }
+
+      if (ec) {
         if (ec == ParseError::Unsuitable) {
           if (!UnsuitableConfigFiles.empty())
             UnsuitableConfigFiles.append(", ");
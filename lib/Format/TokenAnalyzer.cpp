@@ -75,11 +75,17 @@ std::pair<tooling::Replacements, unsigned> TokenAnalyzer::process() {
   unsigned Penalty = 0;
   for (unsigned Run = 0, RunE = UnwrappedLines.size(); Run + 1 != RunE; ++Run) {
     LLVM_DEBUG(llvm::dbgs() << "Run " << Run << "...\n");
+    // The lines of a run and their children are all destroyed at once at the
+    // end of the run, which also clears what they left in the tokens.
+    AnnotatedLineAllocator LineAllocator;
     SmallVector<AnnotatedLine *, 16> AnnotatedLines;
+    AnnotatedLines.reserve(UnwrappedLines[Run].size());
 
     TokenAnnotator Annotator(Style, Tokens.getKeywords());
     for (unsigned i = 0, e = UnwrappedLines[Run].size(); i != e; ++i) {
-      AnnotatedLines.push_back(new AnnotatedLine(UnwrappedLines[Run][i]));
+      AnnotatedLines.push_back(new (LineAllocator.Allocate())
+                                   AnnotatedLine(UnwrappedLines[Run][i],
+                                                 LineAllocator));
       Annotator.annotate(*AnnotatedLines.back());
     }
 
@@ -94,10 +100,6 @@ std::pair<tooling::Replacements, unsigned> TokenAnalyzer::process() {
         llvm::dbgs() << I->toString() << "\n";
       }
     });
-    for (unsigned i = 0, e = AnnotatedLines.size(); i != e; ++i) {
-      delete AnnotatedLines[i];
-    }
-
     Penalty += RunResult.second;
     for (const auto &R : RunResult.first) {
       auto Err = Result.add(R);
@@ -18,6 +18,7 @@
 
 #include "UnwrappedLineParser.h"
 #include "clang/Format/Format.h"
+#include "llvm/Support/Allocator.h"
 
 namespace clang {
 class SourceManager;
@@ -35,9 +36,15 @@ enum LineType {
   LT_VirtualFunctionDecl
 };
 
+class AnnotatedLine;
+
+/// The arena that owns the \c AnnotatedLines of a formatting run, including
+/// their children. All lines are destroyed together with the arena.
+typedef llvm::SpecificBumpPtrAllocator<AnnotatedLine> AnnotatedLineAllocator;
+
 class AnnotatedLine {
 public:
-  AnnotatedLine(const UnwrappedLine &Line)
+  AnnotatedLine(const UnwrappedLine &Line, AnnotatedLineAllocator &Allocator)
       : First(Line.Tokens.front().Tok), Level(Line.Level),
         MatchingOpeningBlockLineIndex(Line.MatchingOpeningBlockLineIndex),
         MatchingClosingBlockLineIndex(Line.MatchingClosingBlockLineIndex),
@@ -62,7 +69,8 @@ public:
       Current = Current->Next;
       Current->Children.clear();
       for (const auto &Child : Node.Children) {
-        Children.push_back(new AnnotatedLine(Child));
+        Children.push_back(new (Allocator.Allocate())
+                               AnnotatedLine(Child, Allocator));
         Current->Children.push_back(Children.back());
       }
     }
@@ -70,10 +78,8 @@ public:
     Last->Next = nullptr;
   }
 
+  // The children are owned by the allocator, which destroys them on its own.
   ~AnnotatedLine() {
-    for (unsigned i = 0, e = Children.size(); i != e; ++i) {
-      delete Children[i];
-    }
     FormatToken *Current = First;
     while (Current) {
       Current->Children.clear();
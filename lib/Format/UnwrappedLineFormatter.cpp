@@ -10,8 +10,10 @@
 #include "NamespaceEndCommentsFixer.h"
 #include "UnwrappedLineFormatter.h"
 #include "WhitespaceManager.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/Support/Debug.h"
 #include <queue>
+#include <unordered_map>
 
 #define DEBUG_TYPE "format-formatter"
 
@@ -862,6 +864,30 @@ private:
     }
   };
 
+  /// Hashes the parts of a \c LineState that \c LineStatesEqual compares.
+  struct LineStateHash {
+    size_t operator()(const LineState *State) const {
+      llvm::hash_code Hash = llvm::hash_combine(
+          State->NextToken, State->Column,
+          bool(State->LineContainsContinuedForLoopSection),
+          bool(State->NoContinuation), State->StartOfLineLevel,
+          State->LowestLevelOnLine, State->StartOfStringLiteral,
+          State->Stack.size());
+      for (const ParenState &Paren : State->Stack)
+        Hash = llvm::hash_combine(Hash, Paren.Indent, Paren.LastSpace,
+                                  Paren.NestedBlockIndent);
+      return Hash;
+    }
+  };
+
+  /// Whether two \c LineStates are equivalent, always including their stacks.
+  struct LineStatesEqual {
+    bool operator()(const LineState *A, const LineState *B) const {
+      return !(*A < *B) && !(*B < *A) && !(A->Stack < B->Stack) &&
+             !(B->Stack < A->Stack);
+    }
+  };
+
   /// A pair of <penalty, count> that is used to prioritize the BFS on.
   ///
   /// In case of equal penalties, we want to prefer states that were inserted
@@ -877,10 +903,13 @@ private:
     LineState State;
     bool NewLine;
     StateNode *Previous;
+    /// The penalty of the path to \c State.
+    unsigned Penalty = 0;
   };
 
-  /// An item in the prioritized BFS search queue. The \c StateNode's
-  /// \c State has the given \c OrderedPenalty.
+  /// An item in the prioritized BFS search queue. The \c OrderedPenalty is
+  /// the penalty of the \c StateNode's \c State plus a lower bound on the
+  /// penalty of the rest of the line.
   typedef std::pair<OrderedPenalty, StateNode *> QueueItem;
 
   /// The BFS queue type.
@@ -888,16 +917,28 @@ private:
                               std::greater<QueueItem>>
       QueueType;
 
+  /// The lowest penalty with which each state has been queued.
+  typedef std::unordered_map<const LineState *, unsigned, LineStateHash,
+                             LineStatesEqual>
+      QueuedPenaltyMap;
+
+  /// The number of states queued for a line after which we stop searching
+  /// for the best solution and complete the line greedily.
+  static const unsigned MaxQueuedStates = 250000;
+
   /// Analyze the entire solution space starting from \p InitialState.
   ///
-  /// This implements a variant of Dijkstra's algorithm on the graph that spans
-  /// the solution space (\c LineStates are the nodes). The algorithm tries to
-  /// find the shortest path (the one with lowest penalty) from \p InitialState
-  /// to a state where all tokens are placed. Returns the penalty.
+  /// This implements A* search on the graph that spans the solution space
+  /// (\c LineStates are the nodes), guided by
+  /// \c ContinuationIndenter::getMinimumRemainingPenalty. The algorithm tries
+  /// to find the shortest path (the one with lowest penalty) from
+  /// \p InitialState to a state where all tokens are placed. Returns the
+  /// penalty.
   ///
   /// If \p DryRun is \c false, directly applies the changes.
   unsigned analyzeSolutionSpace(LineState &InitialState, bool DryRun) {
     std::set<LineState *, CompareLineStatePointers> Seen;
+    QueuedPenaltyMap Queued;
 
     // Increasing count of \c StateNode items we have created. This is used to
     // create a deterministic order independent of the container.
@@ -910,17 +951,25 @@ private:
     Queue.push(QueueItem(OrderedPenalty(0, Count), Node));
     ++Count;
 
-    unsigned Penalty = 0;
+    StateNode *Best = nullptr;
+    bool TriedGreedily = false;
 
     // While not empty, take first element and follow edges.
     while (!Queue.empty()) {
-      Penalty = Queue.top().first.first;
       StateNode *Node = Queue.top().second;
       if (!Node->State.NextToken) {
-        LLVM_DEBUG(llvm::dbgs()
-                   << "\n---\nPenalty for line: " << Penalty << "\n");
+        Best = Node;
         break;
       }
+
+      // Give up on finding the best solution if the analysis gets far too
+      // complex, and try to complete the cheapest state so far greedily.
+      if (Count > MaxQueuedStates && !TriedGreedily) {
+        TriedGreedily = true;
+        LLVM_DEBUG(llvm::dbgs() << "Search budget exhausted.\n");
+        if ((Best = completeGreedily(Node)))
+          break;
+      }
       Queue.pop();
 
       // Cut off the analysis of certain solutions if the analysis gets too
@@ -934,51 +983,105 @@ private:
 
       FormatDecision LastFormat = Node->State.NextToken->Decision;
       if (LastFormat == FD_Unformatted || LastFormat == FD_Continue)
-        addNextStateToQueue(Penalty, Node, /*NewLine=*/false, &Count, &Queue);
+        addNextStateToQueue(Node, /*NewLine=*/false, &Count, &Queue, &Queued);
       if (LastFormat == FD_Unformatted || LastFormat == FD_Break)
-        addNextStateToQueue(Penalty, Node, /*NewLine=*/true, &Count, &Queue);
+        addNextStateToQueue(Node, /*NewLine=*/true, &Count, &Queue, &Queued);
     }
 
-    if (Queue.empty()) {
+    if (!Best) {
       // We were unable to find a solution, do nothing.
       // FIXME: Add diagnostic?
       LLVM_DEBUG(llvm::dbgs() << "Could not find a solution.\n");
       return 0;
     }
 
+    LLVM_DEBUG(llvm::dbgs()
+               << "\n---\nPenalty for line: " << Best->Penalty << "\n");
+
     // Reconstruct the solution.
     if (!DryRun)
-      reconstructPath(InitialState, Queue.top().second);
+      reconstructPath(InitialState, Best);
 
     LLVM_DEBUG(llvm::dbgs()
                << "Total number of analyzed states: " << Count << "\n");
     LLVM_DEBUG(llvm::dbgs() << "---\n");
 
-    return Penalty;
+    return Best->Penalty;
   }
 
-  /// Add the following state to the analysis queue \c Queue.
-  ///
-  /// Assume the current state is \p PreviousNode and has been reached with a
-  /// penalty of \p Penalty. Insert a line break if \p NewLine is \c true.
-  void addNextStateToQueue(unsigned Penalty, StateNode *PreviousNode,
-                           bool NewLine, unsigned *Count, QueueType *Queue) {
+  /// Returns the state that follows \p PreviousNode when inserting a line
+  /// break if \p NewLine is \c true, or null if that is not possible.
+  StateNode *createNextState(StateNode *PreviousNode, bool NewLine) {
     if (NewLine && !Indenter->canBreak(PreviousNode->State))
-      return;
+      return nullptr;
     if (!NewLine && Indenter->mustBreak(PreviousNode->State))
-      return;
+      return nullptr;
 
     StateNode *Node = new (Allocator.Allocate())
         StateNode(PreviousNode->State, NewLine, PreviousNode);
+    unsigned Penalty = PreviousNode->Penalty;
     if (!formatChildren(Node->State, NewLine, /*DryRun=*/true, Penalty))
-      return;
+      return nullptr;
 
     Penalty += Indenter->addTokenToState(Node->State, NewLine, true);
+    Node->Penalty = Penalty;
+    return Node;
+  }
+
+  /// Add the following state to the analysis queue \c Queue, unless an
+  /// equivalent state has already been queued with at most the same penalty.
+  ///
+  /// Insert a line break after \p PreviousNode if \p NewLine is \c true.
+  void addNextStateToQueue(StateNode *PreviousNode, bool NewLine,
+                           unsigned *Count, QueueType *Queue,
+                           QueuedPenaltyMap *Queued) {
+    StateNode *Node = createNextState(PreviousNode, NewLine);
+    if (!Node)
+      return;
 
-    Queue->push(QueueItem(OrderedPenalty(Penalty, *Count), Node));
+    auto Inserted = Queued->insert({&Node->State, Node->Penalty});
+    if (!Inserted.second) {
+      if (Inserted.first->second <= Node->Penalty)
+        return;
+      Inserted.first->second = Node->Penalty;
+    }
+
+    unsigned Estimate =
+        Node->Penalty + Indenter->getMinimumRemainingPenalty(Node->State);
+    Queue->push(QueueItem(OrderedPenalty(Estimate, *Count), Node));
     ++(*Count);
   }
 
+  /// Completes the line from \p Node by picking, token by token, whichever
+  /// of breaking or not breaking looks cheaper. Returns the final state, or
+  /// null if this runs into a state that cannot be continued.
+  StateNode *completeGreedily(StateNode *Node) {
+    while (Node->State.NextToken) {
+      FormatDecision LastFormat = Node->State.NextToken->Decision;
+      StateNode *Next = nullptr;
+      unsigned NextEstimate = 0;
+      for (bool NewLine : {false, true}) {
+        if (LastFormat != FD_Unformatted &&
+            LastFormat != (NewLine ? FD_Break : FD_Continue))
+          continue;
+        StateNode *Candidate = createNextState(Node, NewLine);
+        if (!Candidate)
+          continue;
+        unsigned Estimate = Candidate->Penalty +
+                            Indenter->getMinimumRemainingPenalty(
+                                Candidate->State);
+        if (!Next || Estimate < NextEstimate) {
+          Next = Candidate;
+          NextEstimate = Estimate;
+        }
+      }
+      if (!Next)
+        return nullptr;
+      Node = Next;
+    }
+    return Node;
+  }
+
   /// Applies the best formatting by reconstructing the path in the
   /// solution space that leads to \c Best.
   void reconstructPath(LineState &State, StateNode *Best) {
@@ -249,6 +249,10 @@ AlignTokenSequence(unsigned Start, unsigned End, unsigned Column, F &&Matches,
   // 'double z' is indented along with it's owning function 'b'.
   SmallVector<unsigned, 16> ScopeStack;
 
+  // The last non-comment change before the current one, or Start if there is
+  // none. Tracking it as we go keeps long runs of comments linear.
+  unsigned PreviousNonComment = Start;
+
   for (unsigned i = Start; i != End; ++i) {
     if (ScopeStack.size() != 0 &&
         Changes[i].indentAndNestingLevel() <
@@ -257,13 +261,11 @@ AlignTokenSequence(unsigned Start, unsigned End, unsigned Column, F &&Matches,
 
     // Compare current token to previous non-comment token to ensure whether
     // it is in a deeper scope or not.
-    unsigned PreviousNonComment = i - 1;
-    while (PreviousNonComment > Start &&
-           Changes[PreviousNonComment].Tok->is(tok::comment))
-      PreviousNonComment--;
     if (i != Start && Changes[i].indentAndNestingLevel() >
                           Changes[PreviousNonComment].indentAndNestingLevel())
       ScopeStack.push_back(i);
+    if (Changes[i].Tok->isNot(tok::comment))
+      PreviousNonComment = i;
 
     bool InsideNestedScope = ScopeStack.size() != 0;
 
@@ -475,6 +477,9 @@ void WhitespaceManager::alignTrailingComments() {
   unsigned StartOfSequence = 0;
   bool BreakBeforeNext = false;
   unsigned Newlines = 0;
+  // The first non-comment change after the last comment on its own line. All
+  // comments of a wall of comment lines share it, so find it only once.
+  unsigned NextNonComment = 0;
   for (unsigned i = 0, e = Changes.size(); i != e; ++i) {
     if (Changes[i].StartOfBlockComment)
       continue;
@@ -508,18 +513,20 @@ void WhitespaceManager::alignTrailingComments() {
     if (Changes[i].NewlinesBefore == 1) { // A comment on its own line.
       unsigned CommentColumn = SourceMgr.getSpellingColumnNumber(
           Changes[i].OriginalWhitespaceRange.getEnd());
-      for (unsigned j = i + 1; j != e; ++j) {
-        if (Changes[j].Tok->is(tok::comment))
-          continue;
-
+      if (NextNonComment <= i) {
+        NextNonComment = i + 1;
+        while (NextNonComment != e &&
+               Changes[NextNonComment].Tok->is(tok::comment))
+          ++NextNonComment;
+      }
+      if (NextNonComment != e) {
         unsigned NextColumn = SourceMgr.getSpellingColumnNumber(
-            Changes[j].OriginalWhitespaceRange.getEnd());
+            Changes[NextNonComment].OriginalWhitespaceRange.getEnd());
         // The start of the next token was previously aligned with the
         // start of this comment.
         WasAlignedWithStartOfNextLine =
             CommentColumn == NextColumn ||
             CommentColumn == NextColumn + Style.IndentWidth;
-        break;
       }
     }
     if (!Style.AlignTrailingComments || FollowsRBraceInColumn0) {
@@ -66,9 +66,11 @@
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/None.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringMap.h"
@@ -95,6 +97,7 @@
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <map>
 #include <memory>
 #include <string>
 #include <tuple>
@@ -359,6 +362,127 @@ static uint64_t getDeclShowContexts(const NamedDecl *ND,
   return Contexts;
 }
 
+namespace {
+
+/// The allocator of the cached code-completion results of a translation
+/// unit, which also keeps alive the allocators of the module results that
+/// were merged into them.
+struct CachedCompletionAllocators {
+  GlobalCodeCompletionAllocator Local;
+  std::vector<std::shared_ptr<GlobalCodeCompletionAllocator>> Modules;
+};
+
+/// The state for caching the results of one submodule.
+struct ModuleCompletionBuilder {
+  explicit ModuleCompletionBuilder(
+      std::shared_ptr<GlobalCodeCompletionAllocator> Allocator)
+      : CCTUInfo(std::move(Allocator)) {}
+
+  CodeCompletionTUInfo CCTUInfo;
+  llvm::DenseMap<CanQualType, unsigned> CompletionTypes;
+};
+
+} // namespace
+
+/// Translate a global code completion of a declaration into cached
+/// completions, appending them to \p CachedResults.
+static void addCachedDeclarationResults(
+    CodeCompletionResult &R, Sema &S, const CodeCompletionContext &CCContext,
+    GlobalCodeCompletionAllocator &Allocator, CodeCompletionTUInfo &CCTUInfo,
+    bool IncludeBriefComments,
+    llvm::DenseMap<CanQualType, unsigned> &CompletionTypes,
+    llvm::StringMap<unsigned> &CachedCompletionTypes,
+    std::vector<ASTUnit::CachedCodeCompletionResult> &CachedResults) {
+  ASTContext &Ctx = S.Context;
+  bool IsNestedNameSpecifier = false;
+  ASTUnit::CachedCodeCompletionResult CachedResult;
+  CachedResult.Completion = R.CreateCodeCompletionString(
+      S, CCContext, Allocator, CCTUInfo, IncludeBriefComments);
+  CachedResult.ShowInContexts = getDeclShowContexts(
+      R.Declaration, Ctx.getLangOpts(), IsNestedNameSpecifier);
+  CachedResult.Priority = R.Priority;
+  CachedResult.Kind = R.CursorKind;
+  CachedResult.Availability = R.Availability;
+
+  // Keep track of the type of this completion in an ASTContext-agnostic
+  // way.
+  QualType UsageType = getDeclUsageType(Ctx, R.Declaration);
+  if (UsageType.isNull()) {
+    CachedResult.TypeClass = STC_Void;
+    CachedResult.Type = 0;
+  } else {
+    CanQualType CanUsageType
+      = Ctx.getCanonicalType(UsageType.getUnqualifiedType());
+    CachedResult.TypeClass = getSimplifiedTypeClass(CanUsageType);
+
+    // Determine whether we have already seen this type. If so, we save
+    // ourselves the work of formatting the type string by using the
+    // temporary, CanQualType-based hash table to find the associated value.
+    unsigned &TypeValue = CompletionTypes[CanUsageType];
+    if (TypeValue == 0) {
+      TypeValue = CompletionTypes.size();
+      CachedCompletionTypes[QualType(CanUsageType).getAsString()]
+        = TypeValue;
+    }
+
+    CachedResult.Type = TypeValue;
+  }
+
+  CachedResults.push_back(CachedResult);
+
+  /// Handle nested-name-specifiers in C++.
+  if (Ctx.getLangOpts().CPlusPlus && IsNestedNameSpecifier &&
+      !R.StartsNestedNameSpecifier) {
+    // The contexts in which a nested-name-specifier can appear in C++.
+    uint64_t NNSContexts
+      = (1LL << CodeCompletionContext::CCC_TopLevel)
+      | (1LL << CodeCompletionContext::CCC_ObjCIvarList)
+      | (1LL << CodeCompletionContext::CCC_ClassStructUnion)
+      | (1LL << CodeCompletionContext::CCC_Statement)
+      | (1LL << CodeCompletionContext::CCC_Expression)
+      | (1LL << CodeCompletionContext::CCC_ObjCMessageReceiver)
+      | (1LL << CodeCompletionContext::CCC_EnumTag)
+      | (1LL << CodeCompletionContext::CCC_UnionTag)
+      | (1LL << CodeCompletionContext::CCC_ClassOrStructTag)
+      | (1LL << CodeCompletionContext::CCC_Type)
+      | (1LL << CodeCompletionContext::CCC_Symbol)
+      | (1LL << CodeCompletionContext::CCC_SymbolOrNewName)
+      | (1LL << CodeCompletionContext::CCC_ParenthesizedExpression);
+
+    if (isa<NamespaceDecl>(R.Declaration) ||
+        isa<NamespaceAliasDecl>(R.Declaration))
+      NNSContexts |= (1LL << CodeCompletionContext::CCC_Namespace);
+
+    if (uint64_t RemainingContexts
+                            = NNSContexts & ~CachedResult.ShowInContexts) {
+      // If there any contexts where this completion can be a
+      // nested-name-specifier but isn't already an option, create a
+      // nested-name-specifier completion.
+      R.StartsNestedNameSpecifier = true;
+      CachedResult.Completion = R.CreateCodeCompletionString(
+          S, CCContext, Allocator, CCTUInfo, IncludeBriefComments);
+      CachedResult.ShowInContexts = RemainingContexts;
+      CachedResult.Priority = CCP_NestedNameSpecifier;
+      CachedResult.TypeClass = STC_Void;
+      CachedResult.Type = 0;
+      CachedResults.push_back(CachedResult);
+    }
+  }
+}
+
+/// Hash the declarations of the global code completions gathered for one
+/// submodule, in a way that does not depend on the ASTContext.
+static size_t
+hashModuleCompletionDecls(ArrayRef<CodeCompletionResult *> Results) {
+  llvm::hash_code Hash = llvm::hash_value(Results.size());
+  for (const CodeCompletionResult *R : Results)
+    Hash = llvm::hash_combine(Hash, R->Declaration->getKind(),
+                              R->Declaration->getQualifiedNameAsString(),
+                              R->Priority, R->Availability,
+                              R->StartsNestedNameSpecifier);
+  return Hash;
+}
+
 void ASTUnit::CacheCodeCompletionResults() {
   if (!TheSema)
     return;
@@ -372,7 +496,9 @@ void ASTUnit::CacheCodeCompletionResults() {
   // Gather the set of global code completions.
   using Result = CodeCompletionResult;
   SmallVector<Result, 8> Results;
-  CachedCompletionAllocator = std::make_shared<GlobalCodeCompletionAllocator>();
+  auto Allocators = std::make_shared<CachedCompletionAllocators>();
+  CachedCompletionAllocator = std::shared_ptr<GlobalCodeCompletionAllocator>(
+      Allocators, &Allocators->Local);
   CodeCompletionTUInfo CCTUInfo(CachedCompletionAllocator);
   TheSema->GatherGlobalCodeCompletions(*CachedCompletionAllocator,
                                        CCTUInfo, Results);
@@ -381,85 +507,32 @@ void ASTUnit::CacheCodeCompletionResults() {
   llvm::DenseMap<CanQualType, unsigned> CompletionTypes;
   CodeCompletionContext CCContext(CodeCompletionContext::CCC_TopLevel);
 
+  // The submodules whose declarations were among the results, in order, and
+  // the results gathered for each of them.
+  SmallVector<ModuleCompletionCache *, 16> UsedModuleCaches;
+  llvm::SmallPtrSet<ModuleCompletionCache *, 16> UsedModuleCacheSet;
+  llvm::DenseMap<ModuleCompletionCache *, SmallVector<Result *, 16>>
+      ModuleResults;
+
   for (auto &R : Results) {
     switch (R.Kind) {
     case Result::RK_Declaration: {
-      bool IsNestedNameSpecifier = false;
-      CachedCodeCompletionResult CachedResult;
-      CachedResult.Completion = R.CreateCodeCompletionString(
-          *TheSema, CCContext, *CachedCompletionAllocator, CCTUInfo,
-          IncludeBriefCommentsInCodeCompletion);
-      CachedResult.ShowInContexts = getDeclShowContexts(
-          R.Declaration, Ctx->getLangOpts(), IsNestedNameSpecifier);
-      CachedResult.Priority = R.Priority;
-      CachedResult.Kind = R.CursorKind;
-      CachedResult.Availability = R.Availability;
-
-      // Keep track of the type of this completion in an ASTContext-agnostic
-      // way.
-      QualType UsageType = getDeclUsageType(*Ctx, R.Declaration);
-      if (UsageType.isNull()) {
-        CachedResult.TypeClass = STC_Void;
-        CachedResult.Type = 0;
-      } else {
-        CanQualType CanUsageType
-          = Ctx->getCanonicalType(UsageType.getUnqualifiedType());
-        CachedResult.TypeClass = getSimplifiedTypeClass(CanUsageType);
-
-        // Determine whether we have already seen this type. If so, we save
-        // ourselves the work of formatting the type string by using the
-        // temporary, CanQualType-based hash table to find the associated value.
-        unsigned &TypeValue = CompletionTypes[CanUsageType];
-        if (TypeValue == 0) {
-          TypeValue = CompletionTypes.size();
-          CachedCompletionTypes[QualType(CanUsageType).getAsString()]
-            = TypeValue;
-        }
-
-        CachedResult.Type = TypeValue;
+      // The results for the declarations of an imported module only depend
+      // on the module file, so cache them with it.
+      Module *Owner = R.Declaration->getOwningModule();
+      if (!Owner || !Owner->getTopLevelModule()->Signature) {
+        addCachedDeclarationResults(
+            R, *TheSema, CCContext, *CachedCompletionAllocator, CCTUInfo,
+            IncludeBriefCommentsInCodeCompletion, CompletionTypes,
+            CachedCompletionTypes, CachedCompletionResults);
+        break;
       }
 
-      CachedCompletionResults.push_back(CachedResult);
-
-      /// Handle nested-name-specifiers in C++.
-      if (TheSema->Context.getLangOpts().CPlusPlus && IsNestedNameSpecifier &&
-          !R.StartsNestedNameSpecifier) {
-        // The contexts in which a nested-name-specifier can appear in C++.
-        uint64_t NNSContexts
-          = (1LL << CodeCompletionContext::CCC_TopLevel)
-          | (1LL << CodeCompletionContext::CCC_ObjCIvarList)
-          | (1LL << CodeCompletionContext::CCC_ClassStructUnion)
-          | (1LL << CodeCompletionContext::CCC_Statement)
-          | (1LL << CodeCompletionContext::CCC_Expression)
-          | (1LL << CodeCompletionContext::CCC_ObjCMessageReceiver)
-          | (1LL << CodeCompletionContext::CCC_EnumTag)
-          | (1LL << CodeCompletionContext::CCC_UnionTag)
-          | (1LL << CodeCompletionContext::CCC_ClassOrStructTag)
-          | (1LL << CodeCompletionContext::CCC_Type)
-          | (1LL << CodeCompletionContext::CCC_Symbol)
-          | (1LL << CodeCompletionContext::CCC_SymbolOrNewName)
-          | (1LL << CodeCompletionContext::CCC_ParenthesizedExpression);
-
-        if (isa<NamespaceDecl>(R.Declaration) ||
-            isa<NamespaceAliasDecl>(R.Declaration))
-          NNSContexts |= (1LL << CodeCompletionContext::CCC_Namespace);
-
-        if (uint64_t RemainingContexts
-                                = NNSContexts & ~CachedResult.ShowInContexts) {
-          // If there any contexts where this completion can be a
-          // nested-name-specifier but isn't already an option, create a
-          // nested-name-specifier completion.
-          R.StartsNestedNameSpecifier = true;
-          CachedResult.Completion = R.CreateCodeCompletionString(
-              *TheSema, CCContext, *CachedCompletionAllocator, CCTUInfo,
-              IncludeBriefCommentsInCodeCompletion);
-          CachedResult.ShowInContexts = RemainingContexts;
-          CachedResult.Priority = CCP_NestedNameSpecifier;
-          CachedResult.TypeClass = STC_Void;
-          CachedResult.Type = 0;
-          CachedCompletionResults.push_back(CachedResult);
-        }
-      }
+      ModuleCompletionCache &Cache = ModuleCompletionCaches[
+          {Owner->getTopLevelModule()->Signature, Owner->getFullModuleName()}];
+      if (UsedModuleCacheSet.insert(&Cache).second)
+        UsedModuleCaches.push_back(&Cache);
+      ModuleResults[&Cache].push_back(&R);
       break;
     }
 
@@ -499,6 +572,53 @@ void ASTUnit::CacheCodeCompletionResults() {
     }
   }
 
+  // Merge in the results of the submodules, renumbering their types after
+  // those of the other results.
+  unsigned NextType = CompletionTypes.size() + 1;
+  for (ModuleCompletionCache *Cache : UsedModuleCaches) {
+    // Rebuild the results if the declarations gathered for the submodule
+    // are not those the cached results were built for.
+    ArrayRef<Result *> CacheResults = ModuleResults[Cache];
+    size_t DeclsHash = hashModuleCompletionDecls(CacheResults);
+    if (!Cache->Complete || Cache->DeclsHash != DeclsHash) {
+      *Cache = ModuleCompletionCache();
+      Cache->Allocator = std::make_shared<GlobalCodeCompletionAllocator>();
+      ModuleCompletionBuilder Builder(Cache->Allocator);
+      for (Result *R : CacheResults)
+        addCachedDeclarationResults(
+            *R, *TheSema, CCContext, *Cache->Allocator, Builder.CCTUInfo,
+            IncludeBriefCommentsInCodeCompletion, Builder.CompletionTypes,
+            Cache->Types, Cache->Results);
+      Cache->NumTypes = Builder.CompletionTypes.size();
+      Cache->DeclsHash = DeclsHash;
+      Cache->Complete = true;
+    }
+    Allocators->Modules.push_back(Cache->Allocator);
+
+    SmallVector<unsigned, 16> TypeMap(Cache->NumTypes + 1, 0);
+    for (const auto &Type : Cache->Types) {
+      unsigned &TypeValue = CachedCompletionTypes[Type.getKey()];
+      if (TypeValue == 0)
+        TypeValue = NextType++;
+      TypeMap[Type.getValue()] = TypeValue;
+    }
+    for (CachedCodeCompletionResult CachedResult : Cache->Results) {
+      CachedResult.Type = TypeMap[CachedResult.Type];
+      CachedCompletionResults.push_back(CachedResult);
+    }
+  }
+
+  // Forget the submodules that are no longer visible, or whose module files
+  // changed. The results handed out earlier keep their allocators alive.
+  for (auto I = ModuleCompletionCaches.begin(),
+            E = ModuleCompletionCaches.end();
+       I != E;) {
+    if (UsedModuleCacheSet.count(&I->second))
+      ++I;
+    else
+      I = ModuleCompletionCaches.erase(I);
+  }
+
   // Save the current top-level hash value.
   CompletionCacheTopLevelHashValue = CurrentTopLevelHashValue;
 }
@@ -955,6 +1075,7 @@ public:
 
   // We're not interested in "interesting" decls.
   void HandleInterestingDecl(DeclGroupRef) override {}
+  bool wantsInterestingDecls() override { return false; }
 
   void HandleTopLevelDeclInObjCContainer(DeclGroupRef D) override {
     for (auto *TopLevelDecl : D)
@@ -1107,6 +1228,7 @@ bool ASTUnit::Parse(std::shared_ptr<PCHContainerOperations> PCHContainerOps,
     CICleanup(Clang.get());
 
   Clang->setInvocation(CCInvocation);
+  Clang->setCancellationFlag(CancellationFlag);
   OriginalSourceFile = Clang->getFrontendOpts().Inputs[0].getFile();
 
   // Set up diagnostics, capturing any diagnostics that would
@@ -1187,7 +1309,7 @@ bool ASTUnit::Parse(std::shared_ptr<PCHContainerOperations> PCHContainerOps,
   else
     PreambleSrcLocCache.clear();
 
-  if (!Act->Execute())
+  if (!Act->Execute() || (CancellationFlag && *CancellationFlag))
     goto error;
 
   transferASTDataFromCompilerInstance(*Clang);
@@ -1309,8 +1431,15 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
       getDiagnostics().setNumWarnings(NumWarningsInPreamble);
 
       PreambleRebuildCounter = 1;
+      ++NumPreambleReuses;
       return MainFileBuffer;
     } else {
+      // FIXME: When includes were only appended, the old preamble could be
+      // kept as the prefix of a chained PCH that compiles just the new ones.
+      // That needs a storage for in-memory preambles that can hold several
+      // PCHs, and the top-level decls, diagnostics, source locations and
+      // conditional stack of the preamble merged across the chain; until
+      // then the preamble is rebuilt from scratch.
       Preamble.reset();
       PreambleDiagnostics.clear();
       TopLevelDeclsInPreamble.clear();
@@ -1361,6 +1490,7 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
     if (NewPreamble) {
       Preamble = std::move(*NewPreamble);
       PreambleRebuildCounter = 1;
+      ++NumPreambleBuilds;
     } else {
       switch (static_cast<BuildPreambleError>(NewPreamble.getError().value())) {
       case BuildPreambleError::CouldntCreateTempFile:
@@ -1864,6 +1994,34 @@ void ASTUnit::ResetForParse() {
   clearFileLevelDecls();
 }
 
+size_t ASTUnit::getStoredDiagnosticsMemory() const {
+  size_t Size = llvm::capacity_in_bytes(StoredDiagnostics);
+  for (const StoredDiagnostic &SD : StoredDiagnostics) {
+    Size += SD.getMessage().size();
+    Size += SD.range_size() * sizeof(CharSourceRange);
+    for (const FixItHint &FixIt : SD.getFixIts())
+      Size += sizeof(FixItHint) + FixIt.CodeToInsert.size();
+  }
+  return Size;
+}
+
+size_t ASTUnit::getPreambleSize() const {
+  return Preamble ? Preamble->getSize() : 0;
+}
+
+void ASTUnit::compact() {
+  ClearCachedCompletionResults();
+  ModuleCompletionCaches.clear();
+  // Make the next reparse cache the completion results again.
+  CompletionCacheTopLevelHashValue = 0;
+
+  PreambleSrcLocCache.clear();
+  TopLevelDecls.shrink_to_fit();
+
+  if (PP)
+    PP->releaseTokenCaches();
+}
+
 //----------------------------------------------------------------------------//
 // Code completion
 //----------------------------------------------------------------------------//
@@ -1883,6 +2041,9 @@ namespace {
                                   const CodeCompleteOptions &CodeCompleteOpts)
         : CodeCompleteConsumer(CodeCompleteOpts, Next.isOutputBinary()),
           AST(AST), Next(Next) {
+      // Filter the cached results as Sema filters its own.
+      setResultFilter(Next.getResultPrefix(), Next.getMaxResults());
+
       // Compute the set of contexts in which we will look when we don't have
       // any information about the specific context.
       NormalContexts
@@ -2037,6 +2198,11 @@ void AugmentedCodeCompleteConsumer::ProcessCodeCompleteResults(Sema &S,
     if ((C->ShowInContexts & InContexts) == 0)
       continue;
 
+    if (!getResultPrefix().empty() &&
+        !StringRef(C->Completion->getTypedText())
+             .startswith_lower(getResultPrefix()))
+      continue;
+
     // If we haven't added any results previously, do so now.
     if (!AddedResult) {
       CalculateHiddenNames(Context, Results, NumResults, S.Context,
@@ -2101,8 +2267,10 @@ void AugmentedCodeCompleteConsumer::ProcessCodeCompleteResults(Sema &S,
     return;
   }
 
+  // Sema already filtered its own results; keep the best of all of them.
+  unsigned NumAllResults = filterResults(AllResults.data(), AllResults.size());
   Next.ProcessCodeCompleteResults(S, Context, AllResults.data(),
-                                  AllResults.size());
+                                  NumAllResults);
 }
 
 void ASTUnit::CodeComplete(
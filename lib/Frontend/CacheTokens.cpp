@@ -28,6 +28,7 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/OnDiskHashTable.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/xxhash.h"
 
 // FIXME: put this somewhere else?
 #ifndef S_ISDIR
@@ -45,15 +46,17 @@ typedef uint32_t Offset;
 namespace {
 class PTHEntry {
   Offset TokenData, PPCondData;
+  uint64_t ContentHash;
 
 public:
   PTHEntry() {}
 
-  PTHEntry(Offset td, Offset ppcd)
-    : TokenData(td), PPCondData(ppcd) {}
+  PTHEntry(Offset td, Offset ppcd, uint64_t hash)
+    : TokenData(td), PPCondData(ppcd), ContentHash(hash) {}
 
   Offset getTokenOffset() const { return TokenData; }
   Offset getPPCondTableOffset() const { return PPCondData; }
+  uint64_t getContentHash() const { return ContentHash; }
 };
 
 
@@ -140,7 +143,7 @@ public:
     unsigned n = V.getString().size() + 1 + 1;
     LE.write<uint16_t>(n);
 
-    unsigned m = V.getRepresentationLength() + (V.isFile() ? 4 + 4 : 0);
+    unsigned m = V.getRepresentationLength() + (V.isFile() ? 4 + 4 + 8 : 0);
     LE.write<uint8_t>(m);
 
     return std::make_pair(n, m);
@@ -160,10 +163,12 @@ public:
     endian::Writer LE(Out, little);
 
     // For file entries emit the offsets into the PTH file for token data
-    // and the preprocessor blocks table.
+    // and the preprocessor blocks table, and the hash of the contents that
+    // the tokens were lexed from.
     if (V.isFile()) {
       LE.write<uint32_t>(E.getTokenOffset());
       LE.write<uint32_t>(E.getPPCondTableOffset());
+      LE.write<uint64_t>(E.getContentHash());
     }
 
     // Emit any other data associated with the key (i.e., stat information).
@@ -238,7 +243,7 @@ class PTHWriter {
   /// token data.
   Offset EmitFileTable() { return PM.Emit(Out); }
 
-  PTHEntry LexTokens(Lexer& L);
+  PTHEntry LexTokens(Lexer& L, uint64_t ContentHash);
   Offset EmitCachedSpellings();
 
 public:
@@ -294,7 +299,7 @@ void PTHWriter::EmitToken(const Token& T) {
   Emit32(PP.getSourceManager().getFileOffset(T.getLocation()));
 }
 
-PTHEntry PTHWriter::LexTokens(Lexer& L) {
+PTHEntry PTHWriter::LexTokens(Lexer& L, uint64_t ContentHash) {
   // Pad 0's so that we emit tokens to a 4-byte alignment.
   // This speed up reading them back in.
   using namespace llvm::support;
@@ -460,7 +465,7 @@ PTHEntry PTHWriter::LexTokens(Lexer& L) {
     Emit32(x == i ? 0 : x);
   }
 
-  return PTHEntry(TokenOff, PPCondOff);
+  return PTHEntry(TokenOff, PPCondOff, ContentHash);
 }
 
 Offset PTHWriter::EmitCachedSpellings() {
@@ -523,7 +528,7 @@ void PTHWriter::GeneratePTH(StringRef MainFile) {
     FileID FID = SM.createFileID(FE, SourceLocation(), SrcMgr::C_User);
     const llvm::MemoryBuffer *FromFile = SM.getBuffer(FID);
     Lexer L(FID, FromFile, SM, LOpts);
-    PM.insert(FE, LexTokens(L));
+    PM.insert(FE, LexTokens(L, llvm::xxHash64(FromFile->getBuffer())));
   }
 
   // Write out the identifier table.
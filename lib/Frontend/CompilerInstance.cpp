@@ -14,6 +14,7 @@
 #include "clang/Basic/CharInfo.h"
 #include "clang/Basic/Diagnostic.h"
 #include "clang/Basic/FileManager.h"
+#include "clang/Basic/FileSystemStatCache.h"
 #include "clang/Basic/MemoryBufferCache.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Basic/Stack.h"
@@ -24,6 +25,7 @@
 #include "clang/Frontend/FrontendAction.h"
 #include "clang/Frontend/FrontendActions.h"
 #include "clang/Frontend/FrontendDiagnostic.h"
+#include "clang/Frontend/HeaderCostCollector.h"
 #include "clang/Frontend/LogDiagnosticPrinter.h"
 #include "clang/Frontend/SerializedDiagnosticPrinter.h"
 #include "clang/Frontend/TextDiagnosticPrinter.h"
@@ -94,6 +96,7 @@ void CompilerInstance::setAuxTarget(TargetInfo *Value) { AuxTarget = Value; }
 
 void CompilerInstance::setFileManager(FileManager *Value) {
   FileMgr = Value;
+  SessionStatCache = nullptr;
   if (Value)
     VirtualFileSystem = Value->getVirtualFileSystem();
   else
@@ -309,6 +312,18 @@ FileManager *CompilerInstance::createFileManager() {
     setVirtualFileSystem(VFS);
   }
   FileMgr = new FileManager(getFileSystemOpts(), VirtualFileSystem);
+  SessionStatCache = nullptr;
+
+  // The stat cache is keyed on the build session, so it can only be used
+  // when there is one.
+  const std::string &StatCacheFile = getFileSystemOpts().BuildSessionStatCache;
+  uint64_t Session = getHeaderSearchOpts().BuildSessionTimestamp;
+  if (!StatCacheFile.empty() && Session) {
+    std::unique_ptr<BuildSessionStatCache> Cache =
+        BuildSessionStatCache::create(StatCacheFile, Session);
+    SessionStatCache = Cache.get();
+    FileMgr->addStatCache(std::move(Cache));
+  }
   return FileMgr.get();
 }
 
@@ -435,6 +450,12 @@ void CompilerInstance::createPreprocessor(TranslationUnitKind TUKind) {
   if (!DepOpts.DOTOutputFile.empty())
     AttachDependencyGraphGen(*PP, DepOpts.DOTOutputFile,
                              getHeaderSearchOpts().Sysroot);
+  TheHeaderCostCollector.reset();
+  if (!DepOpts.HeaderCostOutputFile.empty()) {
+    TheHeaderCostCollector =
+        llvm::make_unique<HeaderCostCollector>(DepOpts.HeaderCostOutputFile);
+    TheHeaderCostCollector->attachToPreprocessor(*PP);
+  }
 
   // If we don't have a collector, but we are collecting module dependencies,
   // then we're the top level compiler instance and need to create one.
@@ -491,6 +512,8 @@ void CompilerInstance::createASTContext() {
   auto *Context = new ASTContext(getLangOpts(), PP.getSourceManager(),
                                  PP.getIdentifierTable(), PP.getSelectorTable(),
                                  PP.getBuiltinInfo());
+  if (getFrontendOpts().ShowASTMemory)
+    Context->enableMemoryAttribution();
   Context->InitBuiltinTypes(getTarget(), getAuxTarget());
   setASTContext(Context);
 }
@@ -640,6 +663,7 @@ void CompilerInstance::createSema(TranslationUnitKind TUKind,
                                   CodeCompleteConsumer *CompletionConsumer) {
   TheSema.reset(new Sema(getPreprocessor(), getASTContext(), getASTConsumer(),
                          TUKind, CompletionConsumer));
+  TheSema->CancellationFlag = CancellationFlag;
   // Attach the external sema source if there is any.
   if (ExternalSemaSrc) {
     TheSema->addExternalSource(ExternalSemaSrc.get());
@@ -1182,13 +1206,23 @@ static const FileEntry *getPublicModuleMap(const FileEntry *File,
 /// Compile a module file for the given module, using the options
 /// provided by the importing compiler instance. Returns true if the module
 /// was built without errors.
+///
+/// If \p ReportDiagnostics is false, the diagnostics of the module build are
+/// dropped rather than forwarded to the importing instance.
 static bool compileModuleImpl(CompilerInstance &ImportingInstance,
                               SourceLocation ImportLoc,
                               Module *Module,
-                              StringRef ModuleFileName) {
+                              StringRef ModuleFileName,
+                              bool ReportDiagnostics = true) {
   InputKind IK(getLanguageFromOptions(ImportingInstance.getLangOpts()),
                InputKind::ModuleMap);
 
+  auto DropDiagnostics = [&](CompilerInstance &Instance) {
+    if (!ReportDiagnostics)
+      Instance.getDiagnostics().setClient(new IgnoringDiagConsumer,
+                                          /*ShouldOwnClient=*/true);
+  };
+
   // Get or create the module map that we'll use to build this module.
   ModuleMap &ModMap
     = ImportingInstance.getPreprocessor().getHeaderSearchInfo().getModuleMap();
@@ -1207,7 +1241,7 @@ static bool compileModuleImpl(CompilerInstance &ImportingInstance,
         ImportingInstance, ImportLoc, Module->getTopLevelModuleName(),
         FrontendInputFile(ModuleMapFile->getName(), IK, +Module->IsSystem),
         ModMap.getModuleMapFileForUniquing(Module)->getName(),
-        ModuleFileName);
+        ModuleFileName, DropDiagnostics);
   } else {
     // FIXME: We only need to fake up an input file here as a way of
     // transporting the module's directory to the module map parser. We should
@@ -1233,6 +1267,7 @@ static bool compileModuleImpl(CompilerInstance &ImportingInstance,
           FakeModuleMapFile, InferredModuleMapContent.size(), 0);
       Instance.getSourceManager().overrideFileContents(
           ModuleMapFile, std::move(ModuleMapBuffer));
+      DropDiagnostics(Instance);
     });
   }
 
@@ -1245,6 +1280,110 @@ static bool compileModuleImpl(CompilerInstance &ImportingInstance,
   return Result;
 }
 
+/// Get the file in which -fmodules-cooperative-build records the modules
+/// that \p ModuleName imported when it was last built.
+///
+/// The file lives outside of the configuration-specific module cache, so
+/// that the first build in a new configuration can use what earlier
+/// configurations recorded.
+static std::string getModuleImportsHintFile(CompilerInstance &CI,
+                                            StringRef ModuleName) {
+  if (CI.getHeaderSearchOpts().ModuleCachePath.empty())
+    return std::string();
+  SmallString<128> Path(CI.getHeaderSearchOpts().ModuleCachePath);
+  llvm::sys::path::append(Path, ModuleName + ".imports");
+  return Path.str();
+}
+
+/// Record the implicitly-built modules that the just-built module file
+/// \p ModuleFileName imports.
+static void writeModuleImportsHint(CompilerInstance &ImportingInstance,
+                                   StringRef ModuleName,
+                                   StringRef ModuleFileName) {
+  serialization::ModuleFile *MF =
+      ImportingInstance.getModuleManager()->getModuleManager().lookupByFileName(
+          ModuleFileName);
+  if (!MF)
+    return;
+
+  std::string HintFile = getModuleImportsHintFile(ImportingInstance,
+                                                  ModuleName);
+  if (HintFile.empty())
+    return;
+  SmallString<128> TmpPath;
+  int TmpFD;
+  if (llvm::sys::fs::createUniqueFile(HintFile + "-%%%%%%%%", TmpFD, TmpPath))
+    return;
+  {
+    llvm::raw_fd_ostream Out(TmpFD, /*shouldClose=*/true);
+    for (serialization::ModuleFile *Import : MF->Imports)
+      if (Import->Kind == serialization::MK_ImplicitModule)
+        Out << Import->ModuleName << '\n';
+    Out.close();
+    if (Out.has_error()) {
+      Out.clear_error();
+      llvm::sys::fs::remove(TmpPath);
+      return;
+    }
+  }
+  if (llvm::sys::fs::rename(TmpPath, HintFile))
+    llvm::sys::fs::remove(TmpPath);
+}
+
+/// While another process builds \p ModuleName, build the modules that it
+/// imported when it was last built and that are neither built nor being
+/// built by anyone else.  The processes waiting for one module thus build
+/// its independent imports in parallel, instead of leaving them all to the
+/// process that holds the lock.
+///
+/// These builds are only a head start: their diagnostics are dropped, and
+/// their module files are loaded on demand like any other.
+static void buildModuleImportsWhileWaiting(CompilerInstance &ImportingInstance,
+                                           SourceLocation ImportLoc,
+                                           StringRef ModuleName) {
+  std::string HintFile = getModuleImportsHintFile(ImportingInstance,
+                                                  ModuleName);
+  if (HintFile.empty())
+    return;
+  auto Buffer = llvm::MemoryBuffer::getFile(HintFile);
+  if (!Buffer)
+    return;
+
+  SmallVector<StringRef, 16> Imports;
+  (*Buffer)->getBuffer().split(Imports, '\n', /*MaxSplit=*/-1,
+                               /*KeepEmpty=*/false);
+  HeaderSearch &HS = ImportingInstance.getPreprocessor().getHeaderSearchInfo();
+  ModuleBuildStack BuildStack =
+      ImportingInstance.getSourceManager().getModuleBuildStack();
+  for (StringRef ImportName : Imports) {
+    // Building a module that is on the module build stack would be a cycle.
+    if (ImportName == ModuleName ||
+        llvm::any_of(BuildStack,
+                     [&](const std::pair<std::string, FullSourceLoc> &Entry) {
+                       return Entry.first == ImportName;
+                     }))
+      continue;
+
+    Module *Import = HS.lookupModule(ImportName);
+    if (!Import || !Import->isAvailable())
+      continue;
+    std::string ImportFileName = HS.getCachedModuleFileName(Import);
+    if (ImportFileName.empty() || llvm::sys::fs::exists(ImportFileName))
+      continue;
+
+    llvm::sys::fs::create_directories(
+        llvm::sys::path::parent_path(ImportFileName));
+    llvm::LockFileManager Locked(ImportFileName);
+    if (Locked != llvm::LockFileManager::LFS_Owned)
+      continue;
+    // Whoever held the lock before us may have just finished the build.
+    if (llvm::sys::fs::exists(ImportFileName))
+      continue;
+    compileModuleImpl(ImportingInstance, ImportLoc, Import, ImportFileName,
+                      /*ReportDiagnostics=*/false);
+  }
+}
+
 static bool compileAndLoadModule(CompilerInstance &ImportingInstance,
                                  SourceLocation ImportLoc,
                                  SourceLocation ModuleNameLoc, Module *Module,
@@ -1284,8 +1423,11 @@ static bool compileAndLoadModule(CompilerInstance &ImportingInstance,
       break;
 
     case llvm::LockFileManager::LFS_Shared:
-      // Someone else is responsible for building the module. Wait for them to
-      // finish.
+      // Someone else is responsible for building the module. Help them with
+      // its imports, then wait for them to finish.
+      if (ImportingInstance.getHeaderSearchOpts().ModulesCooperativeBuild)
+        buildModuleImportsWhileWaiting(ImportingInstance, ModuleNameLoc,
+                                       Module->Name);
       switch (Locked.waitForUnlock()) {
       case llvm::LockFileManager::Res_Success:
         ModuleLoadCapabilities |= ASTReader::ARR_OutOfDate;
@@ -1324,6 +1466,11 @@ static bool compileAndLoadModule(CompilerInstance &ImportingInstance,
       // The ASTReader didn't diagnose the error, so conservatively report it.
       diagnoseBuildFailure();
     }
+
+    if (ReadResult == ASTReader::Success &&
+        Locked != llvm::LockFileManager::LFS_Shared &&
+        ImportingInstance.getHeaderSearchOpts().ModulesCooperativeBuild)
+      writeModuleImportsHint(ImportingInstance, Module->Name, ModuleFileName);
     return ReadResult == ASTReader::Success;
   }
 }
@@ -204,6 +204,10 @@ public:
                   const FileEntry *File,
                   SrcMgr::CharacteristicKind FileType) override;
 
+  void EmbedDirective(SourceLocation HashLoc, StringRef FileName,
+                      bool IsAngled, const FileEntry *File,
+                      SrcMgr::CharacteristicKind FileType) override;
+
   void EndOfMainFile() override {
     OutputDependencyFile();
   }
@@ -255,6 +259,11 @@ DependencyFileGenerator *DependencyFileGenerator::CreateAndAttachToPreprocessor(
   if (Opts.AddMissingHeaderDeps)
     PP.SetSuppressIncludeNotFoundError(true);
 
+  // Only the directives matter for the dependency file, so don't bother
+  // lexing anything else.
+  if (Opts.DependencyDirectivesOnly)
+    PP.setMinimizeSourceToDependencyDirectives(true);
+
   DFGImpl *Callback = new DFGImpl(&PP, Opts);
   PP.addPPCallbacks(std::unique_ptr<PPCallbacks>(Callback));
   PP.getHeaderSearchInfo().getModuleMap().addModuleMapCallbacks(
@@ -343,6 +352,22 @@ void DFGImpl::HasInclude(SourceLocation Loc, StringRef SpelledFilename,
   AddFilename(llvm::sys::path::remove_leading_dotslash(Filename));
 }
 
+void DFGImpl::EmbedDirective(SourceLocation HashLoc, StringRef FileName,
+                             bool IsAngled, const FileEntry *File,
+                             SrcMgr::CharacteristicKind FileType) {
+  if (!File) {
+    if (AddMissingHeaderDeps)
+      AddFilename(FileName);
+    else
+      SeenMissingHeader = true;
+    return;
+  }
+  StringRef Filename = File->getName();
+  if (!FileMatchesDepCriteria(Filename.data(), FileType))
+    return;
+  AddFilename(llvm::sys::path::remove_leading_dotslash(Filename));
+}
+
 bool DFGImpl::AddFilename(StringRef Filename) {
   if (FilesSet.insert(Filename).second) {
     Files.push_back(Filename);
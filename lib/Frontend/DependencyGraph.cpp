@@ -18,9 +18,10 @@
 #include "clang/Frontend/FrontendDiagnostic.h"
 #include "clang/Lex/PPCallbacks.h"
 #include "clang/Lex/Preprocessor.h"
-#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/Support/GraphWriter.h"
 #include "llvm/Support/raw_ostream.h"
+#include <vector>
 
 using namespace clang;
 namespace DOT = llvm::DOT;
@@ -30,13 +31,15 @@ class DependencyGraphCallback : public PPCallbacks {
   const Preprocessor *PP;
   std::string OutputFile;
   std::string SysRoot;
-  llvm::SetVector<const FileEntry *> AllFiles;
-  typedef llvm::DenseMap<const FileEntry *,
-                         SmallVector<const FileEntry *, 2> > DependencyMap;
-
-  DependencyMap Dependencies;
+  /// The files of the graph, in the order they were first seen.
+  std::vector<const FileEntry *> AllFiles;
+  llvm::DenseMap<const FileEntry *, unsigned> FileIndices;
+  /// The inclusions, in the order they were seen, as (includer, included)
+  /// indices into AllFiles. Nothing is formatted until the graph is written.
+  std::vector<std::pair<unsigned, unsigned>> Dependencies;
 
 private:
+  unsigned getFileIndex(const FileEntry *File);
   raw_ostream &writeNodeReference(raw_ostream &OS,
                                   const FileEntry *Node);
   void OutputGraphFile();
@@ -86,10 +89,15 @@ void DependencyGraphCallback::InclusionDirective(
   if (!FromFile)
     return;
 
-  Dependencies[FromFile].push_back(File);
+  unsigned FromIndex = getFileIndex(FromFile);
+  Dependencies.emplace_back(FromIndex, getFileIndex(File));
+}
 
-  AllFiles.insert(File);
-  AllFiles.insert(FromFile);
+unsigned DependencyGraphCallback::getFileIndex(const FileEntry *File) {
+  auto Inserted = FileIndices.insert({File, AllFiles.size()});
+  if (Inserted.second)
+    AllFiles.push_back(File);
+  return Inserted.first->second;
 }
 
 raw_ostream &
@@ -125,16 +133,12 @@ void DependencyGraphCallback::OutputGraphFile() {
   }
 
   // Write the edges
-  for (DependencyMap::iterator F = Dependencies.begin(),
-                            FEnd = Dependencies.end();
-       F != FEnd; ++F) {
-    for (unsigned I = 0, N = F->second.size(); I != N; ++I) {
-      OS.indent(2);
-      writeNodeReference(OS, F->first);
-      OS << " -> ";
-      writeNodeReference(OS, F->second[I]);
-      OS << ";\n";
-    }
+  for (const auto &Dependency : Dependencies) {
+    OS.indent(2);
+    writeNodeReference(OS, AllFiles[Dependency.first]);
+    OS << " -> ";
+    writeNodeReference(OS, AllFiles[Dependency.second]);
+    OS << ";\n";
   }
   OS << "}\n";
 }
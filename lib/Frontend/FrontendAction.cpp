@@ -11,10 +11,12 @@
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/DeclGroup.h"
+#include "clang/Basic/FileSystemStatCache.h"
 #include "clang/Frontend/ASTUnit.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/FrontendDiagnostic.h"
 #include "clang/Frontend/FrontendPluginRegistry.h"
+#include "clang/Frontend/HeaderCostCollector.h"
 #include "clang/Frontend/LayoutOverrideSource.h"
 #include "clang/Frontend/MultiplexConsumer.h"
 #include "clang/Frontend/Utils.h"
@@ -152,6 +154,14 @@ FrontendAction::CreateWrappedASTConsumer(CompilerInstance &CI,
   if (!Consumer)
     return nullptr;
 
+  // Attribute the declarations and instantiations to headers, if requested.
+  if (HeaderCostCollector *Costs = CI.getHeaderCostCollector()) {
+    std::vector<std::unique_ptr<ASTConsumer>> Consumers;
+    Consumers.push_back(std::move(Consumer));
+    Consumers.push_back(Costs->createASTConsumer());
+    Consumer = llvm::make_unique<MultiplexConsumer>(std::move(Consumers));
+  }
+
   // If there are no registered plugins we don't need to wrap the consumer
   if (FrontendPluginRegistry::begin() == FrontendPluginRegistry::end())
     return Consumer;
@@ -927,6 +937,20 @@ bool FrontendAction::Execute() {
                                     CI.getPCHContainerReader(), Cache);
   }
 
+  // Publish what this compilation learned about the file system to the rest
+  // of the build session.  A failure only costs the other processes stats.
+  if (CI.hasFileManager())
+    if (BuildSessionStatCache *StatCache = CI.getBuildSessionStatCache())
+      StatCache->writeToDisk();
+
+  // Likewise for the #include lookups resolved through the search paths and
+  // the include guards of the headers that were entered.
+  if (CI.hasPreprocessor()) {
+    HeaderSearch &HS = CI.getPreprocessor().getHeaderSearchInfo();
+    HS.writeIncludeMap();
+    HS.writeIncludeGuardDatabase();
+  }
+
   return true;
 }
 
@@ -943,6 +967,12 @@ void FrontendAction::EndSourceFile() {
   // Finalize the action.
   EndSourceFileAction();
 
+  if (HeaderCostCollector *Costs = CI.getHeaderCostCollector())
+    Costs->writeOutput(CI.getDiagnostics());
+
+  if (CI.hasASTContext() && CI.getASTContext().getMemoryAttribution())
+    CI.getASTContext().PrintMemoryReport(llvm::errs());
+
   // Sema references the ast consumer, so reset sema first.
   //
   // FIXME: There is more per-file stuff we could just drop here?
@@ -1016,7 +1046,8 @@ void ASTFrontendAction::ExecuteAction() {
     CI.createSema(getTranslationUnitKind(), CompletionConsumer);
 
   ParseAST(CI.getSema(), CI.getFrontendOpts().ShowStats,
-           CI.getFrontendOpts().SkipFunctionBodies);
+           CI.getFrontendOpts().SkipFunctionBodies,
+           CI.getFrontendOpts().DeferSkippedFunctionBodies);
 }
 
 void PluginASTAction::anchor() { }
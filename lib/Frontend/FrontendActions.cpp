@@ -16,12 +16,16 @@
 #include "clang/Frontend/MultiplexConsumer.h"
 #include "clang/Frontend/Utils.h"
 #include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/Lexer.h"
+#include "clang/Lex/PPCallbacks.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Lex/PreprocessorOptions.h"
 #include "clang/Sema/TemplateInstCallback.h"
 #include "clang/Serialization/ASTReader.h"
 #include "clang/Serialization/ASTWriter.h"
+#include "llvm/Support/Endian.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
@@ -113,7 +117,9 @@ GeneratePCHAction::CreateASTConsumer(CompilerInstance &CI, StringRef InFile) {
                         CI.getPreprocessor(), OutputFile, Sysroot,
                         Buffer, FrontendOpts.ModuleFileExtensions,
                         CI.getPreprocessorOpts().AllowPCHWithCompilerErrors,
-                        FrontendOpts.IncludeTimestamps));
+                        FrontendOpts.IncludeTimestamps,
+                        FrontendOpts.CompressASTFiles,
+                        !FrontendOpts.ModulesEmbedUncompressed));
   Consumers.push_back(CI.getPCHContainerWriter().CreatePCHContainerGenerator(
       CI, InFile, OutputFile, std::move(OS), Buffer));
 
@@ -177,7 +183,9 @@ GenerateModuleAction::CreateASTConsumer(CompilerInstance &CI,
                         Buffer, CI.getFrontendOpts().ModuleFileExtensions,
                         /*AllowASTWithErrors=*/false,
                         /*IncludeTimestamps=*/
-                          +CI.getFrontendOpts().BuildingImplicitModule));
+                          +CI.getFrontendOpts().BuildingImplicitModule,
+                        +CI.getFrontendOpts().CompressASTFiles,
+                        !CI.getFrontendOpts().ModulesEmbedUncompressed));
   Consumers.push_back(CI.getPCHContainerWriter().CreatePCHContainerGenerator(
       CI, InFile, OutputFile, std::move(OS), Buffer));
   return llvm::make_unique<MultiplexConsumer>(std::move(Consumers));
@@ -750,6 +758,158 @@ void DumpTokensAction::ExecuteAction() {
   } while (Tok.isNot(tok::eof));
 }
 
+namespace {
+/// Hashes the text of each pragma, which the preprocessor consumes before
+/// PrintCacheKeyAction sees any tokens.
+class CacheKeyPragmaHasher : public PPCallbacks {
+  Preprocessor &PP;
+  llvm::MD5 &Hasher;
+
+public:
+  CacheKeyPragmaHasher(Preprocessor &PP, llvm::MD5 &Hasher)
+      : PP(PP), Hasher(Hasher) {}
+
+  void PragmaDirective(SourceLocation Loc,
+                       PragmaIntroducerKind Introducer) override {
+    const char *Start;
+    if (Introducer == PIK__Pragma) {
+      // The text of a _Pragma can come from a macro argument, so hash the
+      // destringized text, which the preprocessor has just started to lex
+      // and which ends with a newline.
+      PreprocessorLexer *L = PP.getCurrentLexer();
+      if (!L)
+        return;
+      Start = static_cast<Lexer *>(L)->getBufferLocation();
+    } else {
+      bool Invalid = false;
+      Start = PP.getSourceManager().getCharacterData(Loc, &Invalid);
+      if (Invalid)
+        return;
+    }
+    // Hash up to the end of the line, including any escaped newlines.
+    const char *End = Start;
+    while (*End && *End != '\n' && *End != '\r') {
+      if (*End == '\\' && (End[1] == '\n' || End[1] == '\r'))
+        ++End;
+      ++End;
+    }
+    Hasher.update(StringRef(Start, End - Start));
+    Hasher.update(StringRef("\0", 1));
+  }
+};
+} // end anonymous namespace
+
+void PrintCacheKeyAction::ExecuteAction() {
+  CompilerInstance &CI = getCompilerInstance();
+  Preprocessor &PP = CI.getPreprocessor();
+  SourceManager &SM = PP.getSourceManager();
+  std::unique_ptr<raw_ostream> OS =
+      CI.createDefaultOutputFile(/*Binary=*/false, getCurrentFile());
+  if (!OS)
+    return;
+
+  llvm::MD5 Hasher;
+
+  // Options that affect the preprocessor, the language and the target, as
+  // for the module cache, and every option that affects code generation.
+  Hasher.update(CI.getInvocation().getModuleHash());
+  const CodeGenOptions &CGOpts = CI.getCodeGenOpts();
+  auto HashValue = [&](uint64_t V) {
+    uint8_t Bytes[sizeof(V)];
+    llvm::support::endian::write64le(Bytes, V);
+    Hasher.update(Bytes);
+  };
+#define CODEGENOPT(Name, Bits, Default) HashValue(CGOpts.Name);
+#define ENUM_CODEGENOPT(Name, Type, Bits, Default)                             \
+  HashValue(static_cast<uint64_t>(CGOpts.get##Name()));
+#include "clang/Frontend/CodeGenOptions.def"
+
+  // Pragmas are not tokens of the output, but most of them matter.
+  PP.addPPCallbacks(llvm::make_unique<CacheKeyPragmaHasher>(PP, Hasher));
+  PP.IgnorePragmas();
+
+  // Hash the preprocessed tokens, with the file and line each line of them
+  // is attributed to, since debug information and diagnostics use those.
+  SmallString<128> Spelling;
+  std::string LastFilename;
+  Token Tok;
+  PP.EnterMainSourceFile();
+  while (true) {
+    PP.Lex(Tok);
+    if (Tok.is(tok::eof))
+      break;
+
+    if (Tok.isAtStartOfLine()) {
+      PresumedLoc PLoc = SM.getPresumedLoc(Tok.getLocation());
+      if (PLoc.isValid()) {
+        if (LastFilename != PLoc.getFilename()) {
+          LastFilename = PLoc.getFilename();
+          Hasher.update(LastFilename);
+          HashValue(SrcMgr::isSystem(SM.getFileCharacteristic(
+              SM.getExpansionLoc(Tok.getLocation()))));
+        }
+        HashValue(PLoc.getLine());
+      }
+    }
+
+    HashValue(Tok.getKind());
+    if (Tok.is(tok::annot_module_include) || Tok.is(tok::annot_module_begin) ||
+        Tok.is(tok::annot_module_end)) {
+      Hasher.update(reinterpret_cast<Module *>(Tok.getAnnotationValue())
+                        ->getFullModuleName());
+      continue;
+    }
+    if (Tok.is(tok::annot_embed)) {
+      // The bytes of the file are the tokens this stands for.
+      StringRef Data =
+          static_cast<const llvm::MemoryBuffer *>(Tok.getAnnotationValue())
+              ->getBuffer();
+      HashValue(Data.size());
+      Hasher.update(Data);
+      continue;
+    }
+    if (Tok.isAnnotation())
+      continue;
+    if (IdentifierInfo *II = Tok.getIdentifierInfo())
+      Hasher.update(II->getName());
+    else
+      Hasher.update(PP.getSpelling(Tok, Spelling));
+    Hasher.update(StringRef("\0", 1));
+  }
+
+  // Imported modules and precompiled headers, which stand in for the tokens
+  // of the headers they were built from.
+  std::vector<std::string> Modules;
+  if (IntrusiveRefCntPtr<ASTReader> Reader = CI.getModuleManager()) {
+    for (serialization::ModuleFile &MF : Reader->getModuleManager()) {
+      Hasher.update(MF.FileName);
+      // Files without a signature can only be told apart by their stat data.
+      if (MF.Signature) {
+        for (uint32_t Word : MF.Signature)
+          HashValue(Word);
+      } else if (MF.File) {
+        HashValue(MF.File->getSize());
+        HashValue(MF.File->getModificationTime());
+      }
+      Modules.push_back(MF.FileName);
+    }
+  }
+
+  llvm::MD5::MD5Result Result;
+  Hasher.final(Result);
+  *OS << "key " << Result.digest() << "\n";
+
+  std::vector<StringRef> Inputs;
+  for (auto I = SM.fileinfo_begin(), E = SM.fileinfo_end(); I != E; ++I)
+    Inputs.push_back(I->first->getName());
+  llvm::sort(Inputs);
+  for (StringRef Input : Inputs)
+    *OS << "input " << Input << "\n";
+  llvm::sort(Modules);
+  for (const std::string &M : Modules)
+    *OS << "module " << M << "\n";
+}
+
 void GeneratePTHAction::ExecuteAction() {
   CompilerInstance &CI = getCompilerInstance();
   std::unique_ptr<raw_pwrite_stream> OS =
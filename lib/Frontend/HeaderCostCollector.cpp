@@ -0,0 +1,168 @@
+//===--- HeaderCostCollector.cpp - Attribute compile costs to headers -----===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the HeaderCostCollector, which attributes what
+// compiling a translation unit costs to the files that it includes.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/HeaderCostCollector.h"
+#include "clang/AST/ASTConsumer.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/DeclCXX.h"
+#include "clang/AST/DeclTemplate.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Frontend/FrontendDiagnostic.h"
+#include "clang/Lex/PPCallbacks.h"
+#include "clang/Lex/Preprocessor.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace clang;
+
+namespace clang {
+/// Tracks which file the preprocessor is reading.
+class HeaderCostPPCallbacks : public PPCallbacks {
+  HeaderCostCollector &Collector;
+
+public:
+  explicit HeaderCostPPCallbacks(HeaderCostCollector &Collector)
+      : Collector(Collector) {}
+
+  void FileChanged(SourceLocation Loc, FileChangeReason Reason,
+                   SrcMgr::CharacteristicKind FileType,
+                   FileID PrevFID) override {
+    if (Reason == EnterFile || Reason == ExitFile)
+      Collector.switchToFile(Loc);
+  }
+
+  void EndOfMainFile() override { Collector.switchToFile(SourceLocation()); }
+};
+} // end namespace clang
+
+namespace {
+/// Counts the declarations and the implicit instantiations of a translation
+/// unit.
+///
+/// Function instantiations are counted when Sema queues them, which the
+/// instantiations of constexpr functions and of members of local classes
+/// don't go through.
+class HeaderCostConsumer : public ASTConsumer {
+  HeaderCostCollector &Collector;
+
+public:
+  explicit HeaderCostConsumer(HeaderCostCollector &Collector)
+      : Collector(Collector) {}
+
+  void HandleCXXImplicitFunctionInstantiation(FunctionDecl *D) override {
+    Collector.addInstantiation(D->getPointOfInstantiation());
+  }
+
+  void HandleTagDeclDefinition(TagDecl *D) override {
+    const auto *RD = dyn_cast<CXXRecordDecl>(D);
+    if (!RD ||
+        RD->getTemplateSpecializationKind() != TSK_ImplicitInstantiation)
+      return;
+    if (const auto *Spec = dyn_cast<ClassTemplateSpecializationDecl>(RD))
+      Collector.addInstantiation(Spec->getPointOfInstantiation());
+    else if (MemberSpecializationInfo *MSI = RD->getMemberSpecializationInfo())
+      Collector.addInstantiation(MSI->getPointOfInstantiation());
+  }
+
+  void HandleTranslationUnit(ASTContext &Ctx) override {
+    Collector.addDecls(Ctx.getTranslationUnitDecl());
+  }
+};
+} // end anonymous namespace
+
+void HeaderCostCollector::attachToPreprocessor(Preprocessor &PP) {
+  SM = &PP.getSourceManager();
+  PP.addPPCallbacks(llvm::make_unique<HeaderCostPPCallbacks>(*this));
+  PP.setTokenWatcher([this](const Token &) {
+    if (CurrentFile)
+      ++Files[*CurrentFile].second.Tokens;
+  });
+}
+
+std::unique_ptr<ASTConsumer> HeaderCostCollector::createASTConsumer() {
+  return llvm::make_unique<HeaderCostConsumer>(*this);
+}
+
+Optional<unsigned> HeaderCostCollector::getFileIndex(SourceLocation Loc) {
+  if (!SM || Loc.isInvalid())
+    return None;
+  const FileEntry *File =
+      SM->getFileEntryForID(SM->getFileID(SM->getExpansionLoc(Loc)));
+  if (!File)
+    return None;
+  auto Inserted = FileIndices.insert({File, Files.size()});
+  if (Inserted.second)
+    Files.emplace_back(File, FileCost());
+  return Inserted.first->second;
+}
+
+void HeaderCostCollector::switchToFile(SourceLocation Loc) {
+  auto Now = std::chrono::steady_clock::now();
+  if (CurrentFile)
+    Files[*CurrentFile].second.Seconds +=
+        std::chrono::duration<double>(Now - CurrentFileStart).count();
+  CurrentFile = getFileIndex(Loc);
+  CurrentFileStart = Now;
+}
+
+void HeaderCostCollector::addIRInstructions(const Decl *D, unsigned Count) {
+  if (Optional<unsigned> Index = getFileIndex(D->getLocation()))
+    Files[*Index].second.IRInstructions += Count;
+}
+
+void HeaderCostCollector::addInstantiation(SourceLocation PointOfInstantiation) {
+  if (Optional<unsigned> Index = getFileIndex(PointOfInstantiation))
+    ++Files[*Index].second.Instantiations;
+}
+
+void HeaderCostCollector::addDecls(const Decl *D) {
+  if (Optional<unsigned> Index = getFileIndex(D->getLocation()))
+    ++Files[*Index].second.Decls;
+  if (const auto *DC = dyn_cast<DeclContext>(D))
+    for (const Decl *Child : DC->noload_decls())
+      addDecls(Child);
+}
+
+void HeaderCostCollector::writeOutput(DiagnosticsEngine &Diags) {
+  // Charge the file that was being read when the translation unit stopped
+  // early.
+  if (CurrentFile)
+    switchToFile(SourceLocation());
+
+  llvm::json::Array FileCosts;
+  for (const auto &File : Files) {
+    const FileCost &Cost = File.second;
+    FileCosts.push_back(llvm::json::Object{
+        {"file", File.first->getName()},
+        {"seconds", Cost.Seconds},
+        {"tokens", Cost.Tokens},
+        {"decls", Cost.Decls},
+        {"instantiations", Cost.Instantiations},
+        {"ir-instructions", Cost.IRInstructions}});
+  }
+  llvm::json::Object Output{{"files", std::move(FileCosts)}};
+  if (SM)
+    if (const FileEntry *MainFile = SM->getFileEntryForID(SM->getMainFileID()))
+      Output["main-file"] = MainFile->getName();
+
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(OutputFile, EC, llvm::sys::fs::F_Text);
+  if (EC) {
+    Diags.Report(diag::err_fe_error_opening) << OutputFile << EC.message();
+    return;
+  }
+  OS << llvm::formatv("{0:2}", llvm::json::Value(std::move(Output))) << '\n';
+}
@@ -27,6 +27,14 @@ class HeaderIncludesCallback : public PPCallbacks {
   bool ShowAllHeaders;
   bool ShowDepth;
   bool MSStyle;
+  /// The output of the translation unit, when it goes to a file of our own.
+  /// Such a file is usually shared by all the compilations of a build, so it
+  /// is written once, at the end of the translation unit, rather than a line
+  /// at a time.
+  SmallString<1024> Buffer;
+  llvm::raw_svector_ostream BufferOS;
+
+  void flushBuffer();
 
 public:
   HeaderIncludesCallback(const Preprocessor *PP, bool ShowAllHeaders_,
@@ -36,19 +44,34 @@ public:
       : SM(PP->getSourceManager()), OutputFile(OutputFile_), DepOpts(DepOpts),
         CurrentIncludeDepth(0), HasProcessedPredefines(false),
         OwnsOutputFile(OwnsOutputFile_), ShowAllHeaders(ShowAllHeaders_),
-        ShowDepth(ShowDepth_), MSStyle(MSStyle_) {}
+        ShowDepth(ShowDepth_), MSStyle(MSStyle_), BufferOS(Buffer) {}
 
   ~HeaderIncludesCallback() override {
-    if (OwnsOutputFile)
+    if (OwnsOutputFile) {
+      flushBuffer();
       delete OutputFile;
+    }
   }
 
+  /// The stream that header information is printed to.
+  raw_ostream *getOutput() { return OwnsOutputFile ? &BufferOS : OutputFile; }
+
   void FileChanged(SourceLocation Loc, FileChangeReason Reason,
                    SrcMgr::CharacteristicKind FileType,
                    FileID PrevFID) override;
+
+  void EndOfMainFile() override { flushBuffer(); }
 };
 }
 
+void HeaderIncludesCallback::flushBuffer() {
+  if (Buffer.empty())
+    return;
+  *OutputFile << Buffer;
+  OutputFile->flush();
+  Buffer.clear();
+}
+
 static void PrintHeaderInfo(raw_ostream *OutputFile, StringRef Filename,
                             bool ShowDepth, unsigned CurrentIncludeDepth,
                             bool MSStyle) {
@@ -113,16 +136,18 @@ void clang::AttachHeaderIncludeGen(Preprocessor &PP,
     }
   }
 
+  auto Callback = llvm::make_unique<HeaderIncludesCallback>(
+      &PP, ShowAllHeaders, OutputFile, DepOpts, OwnsOutputFile, ShowDepth,
+      MSStyle);
+
   // Print header info for extra headers, pretending they were discovered by
   // the regular preprocessor. The primary use case is to support proper
   // generation of Make / Ninja file dependencies for implicit includes, such
   // as sanitizer blacklists. It's only important for cl.exe compatibility,
   // the GNU way to generate rules is -M / -MM / -MD / -MMD.
   for (const auto &Header : DepOpts.ExtraDeps)
-    PrintHeaderInfo(OutputFile, Header, ShowDepth, 2, MSStyle);
-  PP.addPPCallbacks(llvm::make_unique<HeaderIncludesCallback>(
-      &PP, ShowAllHeaders, OutputFile, DepOpts, OwnsOutputFile, ShowDepth,
-      MSStyle));
+    PrintHeaderInfo(Callback->getOutput(), Header, ShowDepth, 2, MSStyle);
+  PP.addPPCallbacks(std::move(Callback));
 }
 
 void HeaderIncludesCallback::FileChanged(SourceLocation Loc,
@@ -146,7 +171,7 @@ void HeaderIncludesCallback::FileChanged(SourceLocation Loc,
     // place where we drop back to a nesting depth of 1.
     if (CurrentIncludeDepth == 1 && !HasProcessedPredefines) {
       if (!DepOpts.ShowIncludesPretendHeader.empty()) {
-        PrintHeaderInfo(OutputFile, DepOpts.ShowIncludesPretendHeader,
+        PrintHeaderInfo(getOutput(), DepOpts.ShowIncludesPretendHeader,
                         ShowDepth, 2, MSStyle);
       }
       HasProcessedPredefines = true;
@@ -174,7 +199,7 @@ void HeaderIncludesCallback::FileChanged(SourceLocation Loc,
   // "<command line>" and "<built-in>" in a bunch of places.
   if (ShowHeader && Reason == PPCallbacks::EnterFile &&
       UserLoc.getFilename() != StringRef("<command line>")) {
-    PrintHeaderInfo(OutputFile, UserLoc.getFilename(), ShowDepth, IncludeDepth,
-                    MSStyle);
+    PrintHeaderInfo(getOutput(), UserLoc.getFilename(), ShowDepth,
+                    IncludeDepth, MSStyle);
   }
 }
@@ -26,6 +26,8 @@
 #include "clang/Lex/PreprocessorOptions.h"
 #include "clang/Serialization/ASTReader.h"
 #include "llvm/ADT/APFloat.h"
+#include "llvm/ADT/StringMap.h"
+#include <mutex>
 using namespace clang;
 
 static bool MacroBodyEndsInBackslash(StringRef MacroBody) {
@@ -1099,24 +1101,50 @@ static void InitializePredefinedMacros(const TargetInfo &TI,
   TI.getTargetDefines(LangOpts, Builder);
 }
 
-/// InitializePreprocessor - Initialize the preprocessor getting it and the
-/// environment ready to process a single file. This returns true on error.
-///
-void clang::InitializePreprocessor(
-    Preprocessor &PP, const PreprocessorOptions &InitOpts,
-    const PCHContainerReader &PCHContainerRdr,
-    const FrontendOptions &FEOpts) {
+static void addTargetOptionsToKey(raw_ostream &OS, const TargetOptions &Opts) {
+  OS << Opts.Triple << ';' << Opts.HostTriple << ';' << Opts.CPU << ';'
+     << Opts.FPMath << ';' << Opts.ABI << ';' << unsigned(Opts.EABIVersion)
+     << ';' << Opts.LinkerVersion << ';' << Opts.CodeModel << ';'
+     << Opts.ForceEnableInt128 << Opts.NVPTXUseShortPointers << ';';
+  for (const std::string &Feature : Opts.Features)
+    OS << Feature << ',';
+  OS << ';';
+  for (const std::string &Ext : Opts.OpenCLExtensionsAsWritten)
+    OS << Ext << ',';
+  OS << ';';
+}
+
+/// Compute a key that identifies everything the builtin predefines depend on:
+/// the target and auxiliary target options, the language options, and the
+/// few preprocessor and frontend options that are consulted.
+static std::string getBuiltinPredefinesKey(const Preprocessor &PP,
+                                           const PreprocessorOptions &InitOpts,
+                                           const FrontendOptions &FEOpts) {
   const LangOptions &LangOpts = PP.getLangOpts();
-  std::string PredefineBuffer;
-  PredefineBuffer.reserve(4080);
-  llvm::raw_string_ostream Predefines(PredefineBuffer);
-  MacroBuilder Builder(Predefines);
+  std::string Key;
+  llvm::raw_string_ostream OS(Key);
+  addTargetOptionsToKey(OS, PP.getTargetInfo().getTargetOpts());
+  if (const TargetInfo *Aux = PP.getAuxTargetInfo())
+    addTargetOptionsToKey(OS, Aux->getTargetOpts());
+  OS << '|';
+#define LANGOPT(Name, Bits, Default, Description) OS << LangOpts.Name << ',';
+#define ENUM_LANGOPT(Name, Type, Bits, Default, Description)                   \
+  OS << static_cast<unsigned>(LangOpts.get##Name()) << ',';
+#include "clang/Basic/LangOptions.def"
+  OS << LangOpts.ObjCRuntime << ';' << LangOpts.Sanitize.Mask << '|'
+     << InitOpts.UsePredefines << ';'
+     << static_cast<unsigned>(InitOpts.ObjCXXARCStandardLibrary) << ';'
+     << static_cast<unsigned>(FEOpts.ProgramAction);
+  return OS.str();
+}
 
-  // Emit line markers for various builtin sections of the file.  We don't do
-  // this in asm preprocessor mode, because "# 4" is not a line marker directive
-  // in this mode.
-  if (!PP.getLangOpts().AsmPreprocessor)
-    Builder.append("# 1 \"<built-in>\" 3");
+/// Build the macros that are predefined for the target and language, before
+/// any that come from the command line.
+static void InitializeBuiltinPredefines(const Preprocessor &PP,
+                                        const PreprocessorOptions &InitOpts,
+                                        const FrontendOptions &FEOpts,
+                                        MacroBuilder &Builder) {
+  const LangOptions &LangOpts = PP.getLangOpts();
 
   // Install things like __POWERPC__, __GNUC__, etc into the macro table.
   if (InitOpts.UsePredefines) {
@@ -1149,6 +1177,59 @@ void clang::InitializePreprocessor(
   // current language configuration.
   InitializeStandardPredefinedMacros(PP.getTargetInfo(), PP.getLangOpts(),
                                      FEOpts, Builder);
+}
+
+/// Return the builtin predefines for the configuration of \p PP.
+///
+/// They only depend on the target and the language, so a process that sets
+/// up many preprocessors, such as libclang reparsing a translation unit or
+/// a server running many compiles, builds them once for each configuration.
+static std::string getBuiltinPredefines(const Preprocessor &PP,
+                                        const PreprocessorOptions &InitOpts,
+                                        const FrontendOptions &FEOpts) {
+  static std::mutex CacheMutex;
+  static llvm::StringMap<std::string> Cache;
+
+  std::string Key = getBuiltinPredefinesKey(PP, InitOpts, FEOpts);
+  {
+    std::lock_guard<std::mutex> Lock(CacheMutex);
+    auto Known = Cache.find(Key);
+    if (Known != Cache.end())
+      return Known->second;
+  }
+
+  std::string Buffer;
+  Buffer.reserve(4080);
+  llvm::raw_string_ostream OS(Buffer);
+  MacroBuilder Builder(OS);
+  InitializeBuiltinPredefines(PP, InitOpts, FEOpts, Builder);
+  OS.flush();
+
+  std::lock_guard<std::mutex> Lock(CacheMutex);
+  return Cache.try_emplace(Key, std::move(Buffer)).first->second;
+}
+
+/// InitializePreprocessor - Initialize the preprocessor getting it and the
+/// environment ready to process a single file. This returns true on error.
+///
+void clang::InitializePreprocessor(
+    Preprocessor &PP, const PreprocessorOptions &InitOpts,
+    const PCHContainerReader &PCHContainerRdr,
+    const FrontendOptions &FEOpts) {
+  std::string PredefineBuffer;
+  PredefineBuffer.reserve(4080);
+  llvm::raw_string_ostream Predefines(PredefineBuffer);
+  MacroBuilder Builder(Predefines);
+
+  // Emit line markers for various builtin sections of the file.  We don't do
+  // this in asm preprocessor mode, because "# 4" is not a line marker directive
+  // in this mode.
+  if (!PP.getLangOpts().AsmPreprocessor)
+    Builder.append("# 1 \"<built-in>\" 3");
+
+  // Install things like __POWERPC__, __GNUC__, etc, and the macros that
+  // every configuration predefines.
+  Predefines << getBuiltinPredefines(PP, InitOpts, FEOpts);
 
   // Add on the predefines from the driver.  Wrap in a #line directive to report
   // that they come from the command line.
@@ -340,6 +340,13 @@ void MultiplexConsumer::PrintStats() {
     Consumer->PrintStats();
 }
 
+bool MultiplexConsumer::wantsInterestingDecls() {
+  for (auto &Consumer : Consumers)
+    if (Consumer->wantsInterestingDecls())
+      return true;
+  return false;
+}
+
 bool MultiplexConsumer::shouldSkipFunctionBody(Decl *D) {
   bool Skip = true;
   for (auto &Consumer : Consumers)
@@ -417,9 +417,8 @@ bool PrecompiledPreamble::CanReuse(const CompilerInvocation &Invocation,
       Bounds.Size <= MainFileBuffer->getBufferSize() &&
       "Buffer is too large. Bounds were calculated from a different buffer?");
 
-  auto PreambleInvocation = std::make_shared<CompilerInvocation>(Invocation);
-  PreprocessorOptions &PreprocessorOpts =
-      PreambleInvocation->getPreprocessorOpts();
+  const PreprocessorOptions &PreprocessorOpts =
+      Invocation.getPreprocessorOpts();
 
   // We've previously computed a preamble. Check whether we have the same
   // preamble now that we did before, and that there's enough space in
@@ -449,13 +448,17 @@ bool PrecompiledPreamble::CanReuse(const CompilerInvocation &Invocation,
         Status.getSize(), llvm::sys::toTimeT(Status.getLastModificationTime()));
   }
 
+  // Hashing a buffer means reading all of it, and the unsaved files usually
+  // include the main file, which the preamble doesn't depend on. Only hash the
+  // buffers of files the preamble actually uses, below.
+  std::map<llvm::sys::fs::UniqueID, const llvm::MemoryBuffer *>
+      OverriddenBuffers;
   for (const auto &RB : PreprocessorOpts.RemappedFileBuffers) {
     llvm::vfs::Status Status;
     if (!moveOnNoError(VFS->status(RB.first), Status))
       return false;
 
-    OverriddenFiles[Status.getUniqueID()] =
-        PreambleFileHash::createForMemoryBuffer(RB.second);
+    OverriddenBuffers[Status.getUniqueID()] = RB.second;
   }
 
   // Check whether anything has changed.
@@ -466,6 +469,17 @@ bool PrecompiledPreamble::CanReuse(const CompilerInvocation &Invocation,
       return false;
     }
 
+    // A remapped buffer takes precedence over a remapped file.
+    auto OverriddenBuffer = OverriddenBuffers.find(Status.getUniqueID());
+    if (OverriddenBuffer != OverriddenBuffers.end()) {
+      // This file was remapped; check whether the newly-mapped buffer
+      // matches up with the previous mapping.
+      if (PreambleFileHash::createForMemoryBuffer(OverriddenBuffer->second) !=
+          F.second)
+        return false;
+      continue;
+    }
+
     std::map<llvm::sys::fs::UniqueID, PreambleFileHash>::iterator Overridden =
         OverriddenFiles.find(Status.getUniqueID());
     if (Overridden != OverriddenFiles.end()) {
@@ -17,6 +17,7 @@
 #include "clang/Basic/Diagnostic.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Frontend/PreprocessorOutputOptions.h"
+#include "clang/Lex/Lexer.h"
 #include "clang/Lex/MacroInfo.h"
 #include "clang/Lex/PPCallbacks.h"
 #include "clang/Lex/Pragma.h"
@@ -26,8 +27,11 @@
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cstdio>
+#include <cstring>
 using namespace clang;
 
 /// PrintMacroDefinition - Print a macro definition in a form that will be
@@ -63,12 +67,11 @@ static void PrintMacroDefinition(const IdentifierInfo &II, const MacroInfo &MI,
   if (MI.tokens_empty() || !MI.tokens_begin()->hasLeadingSpace())
     OS << ' ';
 
-  SmallString<128> SpellingBuffer;
   for (const auto &T : MI.tokens()) {
     if (T.hasLeadingSpace())
       OS << ' ';
 
-    OS << PP.getSpelling(T, SpellingBuffer);
+    OS << PP.getSpellingRef(T);
   }
 }
 
@@ -180,6 +183,7 @@ public:
 
   void BeginModule(const Module *M);
   void EndModule(const Module *M);
+  void EmbedFile(StringRef FileName);
 };
 }  // end anonymous namespace
 
@@ -394,6 +398,18 @@ void PrintPPOutputPPCallbacks::EndModule(const Module *M) {
   setEmittedDirectiveOnThisLine();
 }
 
+/// Print a \#embed directive for the file an annot_embed token embeds.
+void PrintPPOutputPPCallbacks::EmbedFile(StringRef FileName) {
+  // The file was found relative to the search paths of this compilation,
+  // which need not be those of the compilation of the output.
+  SmallString<256> Path(FileName);
+  llvm::sys::fs::make_absolute(Path);
+  Lexer::Stringify(Path);
+  startNewLineIfNeeded();
+  OS << "#embed \"" << Path << '"';
+  setEmittedDirectiveOnThisLine();
+}
+
 /// Ident - Handle #ident directives when read by the preprocessor.
 ///
 void PrintPPOutputPPCallbacks::Ident(SourceLocation Loc, StringRef S) {
@@ -577,13 +593,17 @@ PragmaAssumeNonNullEnd(SourceLocation Loc) {
 /// marker is set for spelling lines, not expansion ones.
 bool PrintPPOutputPPCallbacks::HandleFirstTokOnLine(Token &Tok) {
   // Figure out what line we went to and insert the appropriate number of
-  // newline characters.
-  if (!MoveToLine(Tok.getLocation()))
+  // newline characters. This is MoveToLine(SourceLocation), but keeps the
+  // presumed location around, whose column is the expansion column.
+  PresumedLoc PLoc = SM.getPresumedLoc(Tok.getLocation());
+  if (PLoc.isInvalid())
+    return false;
+  if (!MoveToLine(PLoc.getLine()) && PLoc.getLine() != 1)
     return false;
 
   // Print out space characters so that the first token on a line is
   // indented for easy reading.
-  unsigned ColNo = SM.getExpansionColumnNumber(Tok.getLocation());
+  unsigned ColNo = PLoc.getColumn();
 
   // The first token on a line can have a column number of 1, yet still expect
   // leading white space, if a macro expansion in column 1 starts with an empty
@@ -602,8 +622,8 @@ bool PrintPPOutputPPCallbacks::HandleFirstTokOnLine(Token &Tok) {
     OS << ' ';
 
   // Otherwise, indent the appropriate number of spaces.
-  for (; ColNo > 1; --ColNo)
-    OS << ' ';
+  if (ColNo > 1)
+    OS.indent(ColNo - 1);
 
   return true;
 }
@@ -689,13 +709,22 @@ struct UnknownPragmaHandler : public PragmaHandler {
 } // end anonymous namespace
 
 
+/// Get the spelling of \p Tok if it is a punctuator that is written with its
+/// usual spelling, which saves looking its spelling up in the source buffer.
+/// Digraphs are longer than their usual spelling and are left alone.
+static const char *getPunctuatorSpellingAsWritten(const Token &Tok) {
+  const char *Punc = tok::getPunctuatorSpelling(Tok.getKind());
+  if (!Punc || Tok.needsCleaning() || strlen(Punc) != Tok.getLength())
+    return nullptr;
+  return Punc;
+}
+
 static void PrintPreprocessedTokens(Preprocessor &PP, Token &Tok,
                                     PrintPPOutputPPCallbacks *Callbacks,
                                     raw_ostream &OS) {
   bool DropComments = PP.getLangOpts().TraditionalCPP &&
                       !PP.getCommentRetentionState();
 
-  char Buffer[256];
   Token PrevPrevTok, PrevTok;
   PrevPrevTok.startToken();
   PrevTok.startToken();
@@ -750,6 +779,14 @@ static void PrintPreprocessedTokens(Preprocessor &PP, Token &Tok,
           reinterpret_cast<Module *>(Tok.getAnnotationValue()));
       PP.Lex(Tok);
       continue;
+    } else if (Tok.is(tok::annot_embed)) {
+      // No list of integers or character literals initializes every character
+      // type in C++ without narrowing, so print the directive again instead.
+      Callbacks->EmbedFile(
+          static_cast<const llvm::MemoryBuffer *>(Tok.getAnnotationValue())
+              ->getBufferIdentifier());
+      PP.Lex(Tok);
+      continue;
     } else if (Tok.isAnnotation()) {
       // Ignore annotation tokens created by pragmas - the pragmas themselves
       // will be reproduced in the preprocessed output.
@@ -760,23 +797,16 @@ static void PrintPreprocessedTokens(Preprocessor &PP, Token &Tok,
     } else if (Tok.isLiteral() && !Tok.needsCleaning() &&
                Tok.getLiteralData()) {
       OS.write(Tok.getLiteralData(), Tok.getLength());
-    } else if (Tok.getLength() < llvm::array_lengthof(Buffer)) {
-      const char *TokPtr = Buffer;
-      unsigned Len = PP.getSpelling(Tok, TokPtr);
-      OS.write(TokPtr, Len);
-
-      // Tokens that can contain embedded newlines need to adjust our current
-      // line number.
-      if (Tok.getKind() == tok::comment || Tok.getKind() == tok::unknown)
-        Callbacks->HandleNewlinesInToken(TokPtr, Len);
+    } else if (const char *Punc = getPunctuatorSpellingAsWritten(Tok)) {
+      OS.write(Punc, Tok.getLength());
     } else {
-      std::string S = PP.getSpelling(Tok);
-      OS.write(&S[0], S.size());
+      StringRef S = PP.getSpellingRef(Tok);
+      OS << S;
 
       // Tokens that can contain embedded newlines need to adjust our current
       // line number.
       if (Tok.getKind() == tok::comment || Tok.getKind() == tok::unknown)
-        Callbacks->HandleNewlinesInToken(&S[0], S.size());
+        Callbacks->HandleNewlinesInToken(S.data(), S.size());
     }
     Callbacks->setEmittedTokensOnThisLine();
 
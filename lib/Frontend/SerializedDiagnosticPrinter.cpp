@@ -20,9 +20,11 @@
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/raw_ostream.h"
 #include <utility>
+#include <vector>
 
 using namespace clang;
 using namespace clang::serialized_diags;
@@ -51,6 +53,13 @@ typedef SmallVector<uint64_t, 64> RecordData;
 typedef SmallVectorImpl<uint64_t> RecordDataImpl;
 typedef ArrayRef<uint64_t> RecordDataRef;
 
+/// The diagnostics that a merged file read from one of its inputs.
+struct SourceIndexEntry {
+  std::string Source;
+  unsigned FirstDiagnostic;
+  unsigned NumDiagnostics;
+};
+
 class SDiagsWriter;
 
 class SDiagsRenderer : public DiagnosticNoteRenderer {
@@ -91,6 +100,8 @@ class SDiagsMerger : SerializedDiagnosticReader {
   AbbrevLookup FileLookup;
   AbbrevLookup CategoryLookup;
   AbbrevLookup DiagFlagLookup;
+  unsigned Depth = 0;
+  unsigned NumDiagnostics = 0;
 
 public:
   SDiagsMerger(SDiagsWriter &Writer)
@@ -100,6 +111,9 @@ public:
     return readDiagnostics(File);
   }
 
+  /// The number of top-level diagnostics merged so far.
+  unsigned getNumDiagnostics() const { return NumDiagnostics; }
+
 protected:
   std::error_code visitStartOfDiagnostic() override;
   std::error_code visitEndOfDiagnostic() override;
@@ -133,6 +147,9 @@ private:
 class SDiagsWriter : public DiagnosticConsumer {
   friend class SDiagsRenderer;
   friend class SDiagsMerger;
+  friend std::error_code
+  serialized_diags::mergeFiles(ArrayRef<std::string> InputFiles,
+                               StringRef OutputFile);
 
   struct SharedState;
 
@@ -162,6 +179,9 @@ public:
   void finish() override;
 
 private:
+  /// Write the serialized content to the diagnostics file.
+  std::error_code writeToFile();
+
   /// Build a DiagnosticsEngine to emit diagnostics about the diagnostics
   DiagnosticsEngine *getMetaDiags();
 
@@ -179,6 +199,9 @@ private:
   /// Emit the META data block.
   void EmitMetaBlock();
 
+  /// Emit a META data block that indexes the diagnostics of a merged file.
+  void EmitSourceIndexBlock(ArrayRef<SourceIndexEntry> Index);
+
   /// Start a DIAG block.
   void EnterDiagBlock();
 
@@ -208,7 +231,7 @@ private:
   unsigned getEmitDiagnosticFlag(StringRef DiagName);
 
   /// Emit (lazily) the file string and retrieved the file identifier.
-  unsigned getEmitFile(const char *Filename);
+  unsigned getEmitFile(StringRef Filename);
 
   /// Add SourceLocation information the specified record.
   void AddLocToRecord(FullSourceLoc Loc, PresumedLoc PLoc,
@@ -269,13 +292,12 @@ private:
     llvm::DenseSet<unsigned> Categories;
 
     /// The collection of files used.
-    llvm::DenseMap<const char *, unsigned> Files;
+    llvm::StringMap<unsigned> Files;
 
-    typedef llvm::DenseMap<const void *, std::pair<unsigned, StringRef> >
-    DiagFlagsTy;
-
-    /// Map for uniquing strings.
-    DiagFlagsTy DiagFlags;
+    /// The collection of diagnostic flags used. Flags and files are uniqued
+    /// by their text rather than their address, so that the strings of merged
+    /// files are only written once.
+    llvm::StringMap<unsigned> DiagFlags;
 
     /// Whether we have already started emission of any DIAG blocks. Once
     /// this becomes \c true, we never close a DIAG block until we know that we're
@@ -298,6 +320,25 @@ create(StringRef OutputFile, DiagnosticOptions *Diags, bool MergeChildRecords) {
   return llvm::make_unique<SDiagsWriter>(OutputFile, Diags, MergeChildRecords);
 }
 
+std::error_code mergeFiles(ArrayRef<std::string> InputFiles,
+                           StringRef OutputFile) {
+  SDiagsWriter Writer(OutputFile, new DiagnosticOptions(),
+                      /*MergeChildRecords=*/false);
+
+  std::vector<SourceIndexEntry> Index;
+  unsigned NumDiagnostics = 0;
+  for (const std::string &Input : InputFiles) {
+    SDiagsMerger Merger(Writer);
+    if (std::error_code EC = Merger.mergeRecordsFromFile(Input.c_str()))
+      return EC;
+    Index.push_back({Input, NumDiagnostics, Merger.getNumDiagnostics()});
+    NumDiagnostics += Merger.getNumDiagnostics();
+  }
+
+  Writer.EmitSourceIndexBlock(Index);
+  return Writer.writeToFile();
+}
+
 } // end namespace serialized_diags
 } // end namespace clang
 
@@ -367,17 +408,16 @@ void SDiagsWriter::AddCharSourceRangeToRecord(CharSourceRange Range,
   AddLocToRecord(FullSourceLoc(Range.getEnd(), SM), Record, TokSize);
 }
 
-unsigned SDiagsWriter::getEmitFile(const char *FileName){
-  if (!FileName)
+unsigned SDiagsWriter::getEmitFile(StringRef Name) {
+  if (Name.empty())
     return 0;
 
-  unsigned &entry = State->Files[FileName];
+  unsigned &entry = State->Files[Name];
   if (entry)
     return entry;
 
   // Lazily generate the record for the file.
   entry = State->Files.size();
-  StringRef Name(FileName);
   RecordData::value_type Record[] = {RECORD_FILENAME, entry, 0 /* For legacy */,
                                      0 /* For legacy */, Name.size()};
   State->Stream.EmitRecordWithBlob(State->Abbrevs.get(RECORD_FILENAME), Record,
@@ -439,6 +479,16 @@ void SDiagsWriter::EmitBlockInfoBlock() {
   Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 32));
   Abbrevs.set(RECORD_VERSION, Stream.EmitBlockInfoAbbrev(BLOCK_META, Abbrev));
 
+  EmitRecordID(RECORD_SOURCE_INDEX, "SourceIndex", Stream, Record);
+  Abbrev = std::make_shared<BitCodeAbbrev>();
+  Abbrev->Add(BitCodeAbbrevOp(RECORD_SOURCE_INDEX));
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 16)); // First diagnostic.
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 16)); // Diagnostic count.
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 16)); // Text size.
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob));    // Source name text.
+  Abbrevs.set(RECORD_SOURCE_INDEX,
+              Stream.EmitBlockInfoAbbrev(BLOCK_META, Abbrev));
+
   // ==---------------------------------------------------------------------==//
   // The subsequent records and Abbrevs are for the "Diagnostic" block.
   // ==---------------------------------------------------------------------==//
@@ -519,6 +569,27 @@ void SDiagsWriter::EmitMetaBlock() {
   Stream.ExitBlock();
 }
 
+void SDiagsWriter::EmitSourceIndexBlock(ArrayRef<SourceIndexEntry> Index) {
+  llvm::BitstreamWriter &Stream = State->Stream;
+  AbbreviationMap &Abbrevs = State->Abbrevs;
+
+  // The index goes in a second META block at the end of the file, where the
+  // number of diagnostics of each input is known. Readers that don't know the
+  // index only check the version again.
+  Stream.EnterSubblock(BLOCK_META, 3);
+  RecordData::value_type Version[] = {RECORD_VERSION, VersionNumber};
+  Stream.EmitRecordWithAbbrev(Abbrevs.get(RECORD_VERSION), Version);
+  for (const SourceIndexEntry &Entry : Index) {
+    RecordData::value_type Record[] = {RECORD_SOURCE_INDEX,
+                                       Entry.FirstDiagnostic,
+                                       Entry.NumDiagnostics,
+                                       Entry.Source.size()};
+    Stream.EmitRecordWithBlob(Abbrevs.get(RECORD_SOURCE_INDEX), Record,
+                              Entry.Source);
+  }
+  Stream.ExitBlock();
+}
+
 unsigned SDiagsWriter::getEmitCategory(unsigned int category) {
   if (!State->Categories.insert(category).second)
     return category;
@@ -546,22 +617,18 @@ unsigned SDiagsWriter::getEmitDiagnosticFlag(StringRef FlagName) {
   if (FlagName.empty())
     return 0;
 
-  // Here we assume that FlagName points to static data whose pointer
-  // value is fixed.  This allows us to unique by diagnostic groups.
-  const void *data = FlagName.data();
-  std::pair<unsigned, StringRef> &entry = State->DiagFlags[data];
-  if (entry.first == 0) {
-    entry.first = State->DiagFlags.size();
-    entry.second = FlagName;
+  unsigned &entry = State->DiagFlags[FlagName];
+  if (entry == 0) {
+    entry = State->DiagFlags.size();
 
     // Lazily emit the string in a separate record.
-    RecordData::value_type Record[] = {RECORD_DIAG_FLAG, entry.first,
+    RecordData::value_type Record[] = {RECORD_DIAG_FLAG, entry,
                                        FlagName.size()};
     State->Stream.EmitRecordWithBlob(State->Abbrevs.get(RECORD_DIAG_FLAG),
                                      Record, FlagName);
   }
 
-  return entry.first;
+  return entry;
 }
 
 void SDiagsWriter::HandleDiagnostic(DiagnosticsEngine::Level DiagLevel,
@@ -778,26 +845,37 @@ void SDiagsWriter::finish() {
         getMetaDiags()->Report(diag::warn_fe_serialized_diag_merge_failure);
   }
 
+  if (std::error_code EC = writeToFile())
+    getMetaDiags()->Report(diag::warn_fe_serialized_diag_failure)
+        << State->OutputFile << EC.message();
+}
+
+std::error_code SDiagsWriter::writeToFile() {
   std::error_code EC;
   auto OS = llvm::make_unique<llvm::raw_fd_ostream>(State->OutputFile.c_str(),
                                                     EC, llvm::sys::fs::F_None);
-  if (EC) {
-    getMetaDiags()->Report(diag::warn_fe_serialized_diag_failure)
-        << State->OutputFile << EC.message();
-    return;
-  }
+  if (EC)
+    return EC;
 
   // Write the generated bitstream to "Out".
   OS->write((char *)&State->Buffer.front(), State->Buffer.size());
-  OS->flush();
+  OS->close();
+  if (OS->has_error()) {
+    OS->clear_error();
+    return std::make_error_code(std::errc::io_error);
+  }
+  return std::error_code();
 }
 
 std::error_code SDiagsMerger::visitStartOfDiagnostic() {
+  if (Depth++ == 0)
+    ++NumDiagnostics;
   Writer.EnterDiagBlock();
   return std::error_code();
 }
 
 std::error_code SDiagsMerger::visitEndOfDiagnostic() {
+  --Depth;
   Writer.ExitDiagBlock();
   return std::error_code();
 }
@@ -843,7 +921,7 @@ SDiagsMerger::visitFixitRecord(const serialized_diags::Location &Start,
 std::error_code SDiagsMerger::visitFilenameRecord(unsigned ID, unsigned Size,
                                                   unsigned Timestamp,
                                                   StringRef Name) {
-  FileLookup[ID] = Writer.getEmitFile(Name.str().c_str());
+  FileLookup[ID] = Writer.getEmitFile(Name);
   return std::error_code();
 }
 
@@ -8,8 +8,6 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Frontend/SerializedDiagnosticReader.h"
-#include "clang/Basic/FileManager.h"
-#include "clang/Basic/FileSystemOptions.h"
 #include "clang/Frontend/SerializedDiagnostics.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallVector.h"
@@ -20,6 +18,7 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include <cstdint>
 #include <system_error>
 
@@ -27,15 +26,19 @@ using namespace clang;
 using namespace serialized_diags;
 
 std::error_code SerializedDiagnosticReader::readDiagnostics(StringRef File) {
-  // Open the diagnostics file.
-  FileSystemOptions FO;
-  FileManager FileMgr(FO);
-
-  auto Buffer = FileMgr.getBufferForFile(File);
+  // Open the diagnostics file. The bitstream reader does not need a null
+  // terminator, which lets large files be mapped rather than read.
+  auto Buffer = llvm::MemoryBuffer::getFile(File, /*FileSize=*/-1,
+                                            /*RequiresNullTerminator=*/false);
   if (!Buffer)
     return SDError::CouldNotLoad;
 
-  llvm::BitstreamCursor Stream(**Buffer);
+  return readDiagnostics((*Buffer)->getMemBufferRef());
+}
+
+std::error_code
+SerializedDiagnosticReader::readDiagnostics(llvm::MemoryBufferRef Buffer) {
+  llvm::BitstreamCursor Stream(Buffer);
   Optional<llvm::BitstreamBlockInfo> BlockInfo;
 
   if (Stream.AtEndOfStream())
@@ -145,8 +148,9 @@ SerializedDiagnosticReader::readMetaBlock(llvm::BitstreamCursor &Stream) {
       return {};
     }
 
-    SmallVector<uint64_t, 1> Record;
-    unsigned RecordID = Stream.readRecord(BlockOrCode, Record);
+    SmallVector<uint64_t, 2> Record;
+    StringRef Blob;
+    unsigned RecordID = Stream.readRecord(BlockOrCode, Record, &Blob);
 
     if (RecordID == RECORD_VERSION) {
       if (Record.size() < 1)
@@ -154,6 +158,14 @@ SerializedDiagnosticReader::readMetaBlock(llvm::BitstreamCursor &Stream) {
       if (Record[0] > VersionNumber)
         return SDError::VersionMismatch;
       VersionChecked = true;
+    } else if (RecordID == RECORD_SOURCE_INDEX) {
+      // An index entry has the first diagnostic, the number of diagnostics,
+      // and the source name size.
+      if (Record.size() != 3)
+        return SDError::MalformedMetadataBlock;
+      if (std::error_code EC =
+              visitSourceIndexRecord(Record[0], Record[1], Blob))
+        return EC;
     }
   }
 }
@@ -258,6 +270,9 @@ SerializedDiagnosticReader::readDiagnosticBlock(llvm::BitstreamCursor &Stream) {
       if ((EC = visitVersionRecord(Record[0])))
         return EC;
       continue;
+    case RECORD_SOURCE_INDEX:
+      // The index is only read from the metadata block.
+      continue;
     }
   }
 }
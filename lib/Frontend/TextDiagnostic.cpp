@@ -253,8 +253,9 @@ static void columnToByte(StringRef SourceLine, unsigned TabStop,
 
 namespace {
 struct SourceColumnMap {
-  SourceColumnMap(StringRef SourceLine, unsigned TabStop)
-  : m_SourceLine(SourceLine) {
+  SourceColumnMap(StringRef SourceLine, unsigned TabStop,
+                  unsigned WindowStart = 0)
+  : m_SourceLine(SourceLine), m_WindowStart(WindowStart) {
 
     ::byteToColumn(SourceLine, TabStop, m_byteToColumn);
     ::columnToByte(SourceLine, TabStop, m_columnToByte);
@@ -310,8 +311,21 @@ struct SourceColumnMap {
     return m_SourceLine;
   }
 
+  /// The byte offset in the whole line at which the mapped part starts. Only
+  /// a window of very long lines is mapped and rendered.
+  unsigned getWindowStart() const { return m_WindowStart; }
+
+  /// Map a byte offset in the whole line to one in the mapped window,
+  /// clamping offsets outside the window to its ends.
+  unsigned toWindowOffset(unsigned N) const {
+    if (N < m_WindowStart)
+      return 0;
+    return std::min<unsigned>(N - m_WindowStart, m_SourceLine.size());
+  }
+
 private:
   const std::string m_SourceLine;
+  const unsigned m_WindowStart;
   SmallVector<int,200> m_byteToColumn;
   SmallVector<int,200> m_columnToByte;
 };
@@ -670,6 +684,14 @@ TextDiagnostic::TextDiagnostic(raw_ostream &OS,
                                DiagnosticOptions *DiagOpts)
   : DiagnosticRenderer(LangOpts, DiagOpts), OS(OS) {}
 
+struct TextDiagnostic::CachedSourceLine {
+  CachedSourceLine(StringRef Line, unsigned TabStop, unsigned WindowStart)
+      : TabStop(TabStop), Map(Line, TabStop, WindowStart) {}
+
+  unsigned TabStop;
+  SourceColumnMap Map;
+};
+
 TextDiagnostic::~TextDiagnostic() {}
 
 void TextDiagnostic::emitDiagnosticMessage(
@@ -988,6 +1010,7 @@ static void highlightRange(const CharSourceRange &R,
   if (StartLineNo == LineNo) {
     StartColNo = SM.getExpansionColumnNumber(Begin);
     if (StartColNo) --StartColNo;  // Zero base the col #.
+    StartColNo = map.toWindowOffset(StartColNo);
   }
 
   // Compute the column number of the end.
@@ -1001,6 +1024,7 @@ static void highlightRange(const CharSourceRange &R,
       // this is a token range.
       if (R.isTokenRange())
         EndColNo += Lexer::MeasureTokenLength(End, SM, LangOpts);
+      EndColNo = map.toWindowOffset(EndColNo);
     } else {
       EndColNo = CaretLine.size();
     }
@@ -1075,8 +1099,12 @@ static std::string buildFixItInsertionLine(FileID FID,
         unsigned HintByteOffset
           = SM.getColumnNumber(HintLocInfo.first, HintLocInfo.second) - 1;
 
-        // The hint must start inside the source or right at the end
-        assert(HintByteOffset < static_cast<unsigned>(map.bytes())+1);
+        // Hints outside the rendered window of a long line are not shown.
+        if (HintByteOffset < map.getWindowStart() ||
+            HintByteOffset - map.getWindowStart() >
+                static_cast<unsigned>(map.bytes()))
+          continue;
+        HintByteOffset -= map.getWindowStart();
         unsigned HintCol = map.byteToContainingColumn(HintByteOffset);
 
         // If we inserted a long previous hint, push this one forwards, and add
@@ -1149,10 +1177,9 @@ void TextDiagnostic::emitSnippetAndCaret(
   unsigned CaretLineNo = Loc.getLineNumber();
   unsigned CaretColNo = Loc.getColumnNumber();
 
-  // Arbitrarily stop showing snippets when the line is too long.
+  // Only a window of this many bytes is shown of longer lines, such as the
+  // lines of minified or generated sources.
   static const size_t MaxLineLengthToPrint = 4096;
-  if (CaretColNo > MaxLineLengthToPrint)
-    return;
 
   // Find the set of lines to include.
   const unsigned MaxLines = DiagOpts->SnippetLineLimit;
@@ -1179,22 +1206,40 @@ void TextDiagnostic::emitSnippetAndCaret(
     while (*LineEnd != '\n' && *LineEnd != '\r' && LineEnd != BufEnd)
       ++LineEnd;
 
-    // Arbitrarily stop showing snippets when the line is too long.
-    // FIXME: Don't print any lines in this case.
-    if (size_t(LineEnd - LineStart) > MaxLineLengthToPrint)
-      return;
-
     // Trim trailing null-bytes.
     StringRef Line(LineStart, LineEnd - LineStart);
     while (!Line.empty() && Line.back() == '\0' &&
            (LineNo != CaretLineNo || Line.size() > CaretColNo))
       Line = Line.drop_back();
 
-    // Copy the line of code into an std::string for ease of manipulation.
-    std::string SourceLine(Line.begin(), Line.end());
+    // Of a line that is too long, only render the window around the caret,
+    // or the start of the line if the caret is on another line. Neither end
+    // of the window splits a UTF-8 sequence.
+    unsigned WindowStart = 0;
+    if (Line.size() > MaxLineLengthToPrint) {
+      if (LineNo == CaretLineNo && CaretColNo > MaxLineLengthToPrint / 2)
+        WindowStart = std::min<size_t>(CaretColNo - 1 - MaxLineLengthToPrint / 2,
+                                       Line.size() - MaxLineLengthToPrint);
+      while (WindowStart > 0 && (Line[WindowStart] & 0xC0) == 0x80)
+        --WindowStart;
+      size_t WindowEnd = WindowStart + MaxLineLengthToPrint;
+      while (WindowEnd > WindowStart && WindowEnd < Line.size() &&
+             (Line[WindowEnd] & 0xC0) == 0x80)
+        --WindowEnd;
+      Line = Line.slice(WindowStart, WindowEnd);
+    }
+
+    // Build the byte to column map, unless it was built for the same line
+    // already.
+    if (!LastSourceLine || LastSourceLine->TabStop != DiagOpts->TabStop ||
+        LastSourceLine->Map.getWindowStart() != WindowStart ||
+        LastSourceLine->Map.getSourceLine() != Line)
+      LastSourceLine.reset(
+          new CachedSourceLine(Line, DiagOpts->TabStop, WindowStart));
+    const SourceColumnMap &sourceColMap = LastSourceLine->Map;
 
-    // Build the byte to column map.
-    const SourceColumnMap sourceColMap(SourceLine, DiagOpts->TabStop);
+    // Copy the line of code into an std::string for ease of manipulation.
+    std::string SourceLine = sourceColMap.getSourceLine().str();
 
     // Create a line for the caret that is filled with spaces that is the same
     // number of columns as the line of source code.
@@ -1208,7 +1253,8 @@ void TextDiagnostic::emitSnippetAndCaret(
 
     // Next, insert the caret itself.
     if (CaretLineNo == LineNo) {
-      CaretColNo = sourceColMap.byteToContainingColumn(CaretColNo - 1);
+      CaretColNo = sourceColMap.byteToContainingColumn(
+          sourceColMap.toWindowOffset(CaretColNo - 1));
       if (CaretLine.size() < CaretColNo + 1)
         CaretLine.resize(CaretColNo + 1, ' ');
       CaretLine[CaretColNo] = '^';
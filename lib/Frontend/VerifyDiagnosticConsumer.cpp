@@ -27,6 +27,7 @@
 #include "clang/Lex/PPCallbacks.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Lex/Token.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallString.h"
@@ -667,8 +668,18 @@ static bool findDirectives(SourceManager &SM, FileID FID,
   if (FID.isInvalid())
     return false;
 
-  // Create a lexer to lex all the tokens of the main file in raw mode.
+  // Every directive starts with one of the prefixes and a '-', so a file
+  // without any has no directives and need not be lexed.
   const llvm::MemoryBuffer *FromFile = SM.getBuffer(FID);
+  StringRef Text = FromFile->getBuffer();
+  const auto &Prefixes =
+      SM.getDiagnostics().getDiagnosticOptions().VerifyPrefixes;
+  if (llvm::none_of(Prefixes, [&](const std::string &Prefix) {
+        return Text.find(Prefix + "-") != StringRef::npos;
+      }))
+    return false;
+
+  // Create a lexer to lex all the tokens of the main file in raw mode.
   Lexer RawLex(FID, FromFile, SM, LangOpts);
 
   // Return comments as tokens, this is how we find expected diagnostics.
@@ -778,40 +789,67 @@ static unsigned CheckLists(DiagnosticsEngine &Diags, SourceManager &SourceMgr,
                            const_diag_iterator d2_end,
                            bool IgnoreUnexpected) {
   std::vector<Directive *> LeftOnly;
-  DiagList Right(d2_begin, d2_end);
+  unsigned NumSeen = std::distance(d2_begin, d2_end);
+  std::vector<bool> Matched(NumSeen);
+
+  // Index the seen diagnostics by line, so that a directive only looks at the
+  // diagnostics of its own line rather than at all of them. The indices of a
+  // line are in the order the diagnostics were seen.
+  llvm::DenseMap<unsigned, SmallVector<unsigned, 2>> SeenByLine;
+  for (unsigned I = 0; I != NumSeen; ++I)
+    SeenByLine[SourceMgr.getPresumedLineNumber(d2_begin[I].first)]
+        .push_back(I);
+
+  auto Matches = [&](Directive &D, unsigned I) {
+    if (Matched[I])
+      return false;
+    if (!D.DiagnosticLoc.isInvalid() &&
+        !IsFromSameFile(SourceMgr, D.DiagnosticLoc, d2_begin[I].first))
+      return false;
+    return D.match(d2_begin[I].second);
+  };
 
   for (auto &Owner : Left) {
     Directive &D = *Owner;
-    unsigned LineNo1 = SourceMgr.getPresumedLineNumber(D.DiagnosticLoc);
+    ArrayRef<unsigned> OnLine;
+    if (!D.MatchAnyLine) {
+      auto It =
+          SeenByLine.find(SourceMgr.getPresumedLineNumber(D.DiagnosticLoc));
+      if (It != SeenByLine.end())
+        OnLine = It->second;
+    }
 
     for (unsigned i = 0; i < D.Max; ++i) {
-      DiagList::iterator II, IE;
-      for (II = Right.begin(), IE = Right.end(); II != IE; ++II) {
-        if (!D.MatchAnyLine) {
-          unsigned LineNo2 = SourceMgr.getPresumedLineNumber(II->first);
-          if (LineNo1 != LineNo2)
-            continue;
-        }
-
-        if (!D.DiagnosticLoc.isInvalid() &&
-            !IsFromSameFile(SourceMgr, D.DiagnosticLoc, II->first))
-          continue;
-
-        const std::string &RightText = II->second;
-        if (D.match(RightText))
-          break;
+      unsigned Found = NumSeen;
+      if (D.MatchAnyLine) {
+        for (unsigned I = 0; I != NumSeen; ++I)
+          if (Matches(D, I)) {
+            Found = I;
+            break;
+          }
+      } else {
+        for (unsigned I : OnLine)
+          if (Matches(D, I)) {
+            Found = I;
+            break;
+          }
       }
-      if (II == IE) {
+      if (Found == NumSeen) {
         // Not found.
         if (i >= D.Min) break;
         LeftOnly.push_back(&D);
       } else {
         // Found. The same cannot be found twice.
-        Right.erase(II);
+        Matched[Found] = true;
       }
     }
   }
-  // Now all that's left in Right are those that were not matched.
+
+  // Now all that are not matched are left in Right.
+  DiagList Right;
+  for (unsigned I = 0; I != NumSeen; ++I)
+    if (!Matched[I])
+      Right.push_back(d2_begin[I]);
   unsigned num = PrintExpected(Diags, SourceMgr, LeftOnly, Label);
   if (!IgnoreUnexpected)
     num += PrintUnexpected(Diags, &SourceMgr, Right.begin(), Right.end(), Label);
@@ -23,6 +23,8 @@
 #include "clang/Frontend/FrontendPluginRegistry.h"
 #include "clang/Frontend/Utils.h"
 #include "clang/FrontendTool/Utils.h"
+#include "clang/Index/IndexStore.h"
+#include "clang/Index/IndexingAction.h"
 #include "clang/Rewrite/Frontend/FrontendActions.h"
 #include "clang/StaticAnalyzer/Frontend/FrontendActions.h"
 #include "llvm/Option/OptTable.h"
@@ -91,6 +93,7 @@ CreateFrontendBaseAction(CompilerInstance &CI) {
     return nullptr;
   }
 
+  case PrintCacheKey:          return llvm::make_unique<PrintCacheKeyAction>();
   case PrintPreamble:          return llvm::make_unique<PrintPreambleAction>();
   case PrintPreprocessedInput: {
     if (CI.getPreprocessorOutputOpts().RewriteIncludes ||
@@ -177,6 +180,18 @@ CreateFrontendAction(CompilerInstance &CI) {
     Act = llvm::make_unique<ASTMergeAction>(std::move(Act),
                                             FEOpts.ASTMergeFiles);
 
+  // Index the translation unit while it is compiled.
+  if (!FEOpts.IndexStorePath.empty()) {
+    index::IndexingOptions IndexOpts;
+    if (FEOpts.IndexSkipIndexedFiles)
+      IndexOpts.FileOracle =
+          index::createIndexStoreFileOracle(FEOpts.IndexStorePath);
+    Act = index::createIndexingAction(
+        index::createIndexStoreConsumer(FEOpts.IndexStorePath,
+                                        FEOpts.OutputFile),
+        IndexOpts, std::move(Act));
+  }
+
   return Act;
 }
 
@@ -754,6 +754,10 @@ bool IndexingContext::indexTopLevelDecl(const Decl *D) {
   if (isa<ObjCMethodDecl>(D))
     return true; // Wait for the objc container.
 
+  // Everything in an already indexed file is known.
+  if (shouldSkipLocation(D->getLocation()))
+    return true;
+
   return indexDecl(D);
 }
 
@@ -0,0 +1,628 @@
+//===--- IndexStore.cpp - Persistent index data store ---------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Index/IndexStore.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Decl.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Frontend/FrontendDiagnostic.h"
+#include "clang/Index/IndexDataConsumer.h"
+#include "clang/Index/IndexingAction.h"
+#include "clang/Index/USRGeneration.h"
+#include "clang/Lex/MacroInfo.h"
+#include "clang/Lex/Preprocessor.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Chrono.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
+#include <cstring>
+#include <tuple>
+
+using namespace clang;
+using namespace clang::index;
+using namespace llvm::support;
+
+// Every file of the store starts with a magic number and the version of the
+// store. Bump the version whenever the layout of either file changes.
+static const char RecordMagic[] = {'I', 'D', 'X', 'R'};
+static const char UnitMagic[] = {'I', 'D', 'X', 'U'};
+static const uint32_t StoreVersion = 1;
+
+// A string is stored as its offset into the string table at the end of the
+// file, followed by its length.
+static const unsigned StringRefSize = 4 + 4;
+
+// Magic, version, number of symbols and number of occurrences.
+static const unsigned RecordHeaderSize = 4 + 4 + 4 + 4;
+// USR, name, kind, sub-kind, language and one byte of padding.
+static const unsigned RecordSymbolSize = 2 * StringRefSize + 4;
+// Symbol index, roles, line and column.
+static const unsigned RecordOccurrenceSize = 4 + 4 + 4 + 4;
+
+// Magic, version, number of dependencies, main file and output file.
+static const unsigned UnitHeaderSize = 4 + 4 + 4 + 2 * StringRefSize;
+// File path and record name.
+static const unsigned UnitDependencySize = 2 * StringRefSize;
+
+static void getStoreDirectory(StringRef StorePath, StringRef Kind,
+                              SmallVectorImpl<char> &Dir) {
+  Dir.assign(StorePath.begin(), StorePath.end());
+  llvm::sys::path::append(Dir, "v1", Kind);
+}
+
+static std::string getAbsolutePath(StringRef Path) {
+  SmallString<256> AbsolutePath(Path);
+  llvm::sys::fs::make_absolute(AbsolutePath);
+  llvm::sys::path::remove_dots(AbsolutePath, /*remove_dot_dot=*/true);
+  return AbsolutePath.str();
+}
+
+std::string clang::index::getIndexStoreUnitName(StringRef MainFile,
+                                                StringRef OutputFile) {
+  std::string Path = getAbsolutePath(
+      OutputFile.empty() || OutputFile == "-" ? MainFile : OutputFile);
+  return (llvm::sys::path::filename(Path) + "-" +
+          llvm::utohexstr(llvm::xxHash64(Path)))
+      .str();
+}
+
+namespace {
+
+/// The latest record of a file that some unit of the store depends on.
+struct IndexedFile {
+  /// When the unit that depends on the record was written.
+  llvm::sys::TimePoint<> IndexedAt;
+  std::string RecordName;
+};
+
+} // end anonymous namespace
+
+/// Reads the units of the store at \p StorePath, and collects the latest
+/// record of each file that they depend on, by absolute path.
+static void readIndexedFiles(StringRef StorePath,
+                             llvm::StringMap<IndexedFile> &IndexedFiles);
+
+//===----------------------------------------------------------------------===//
+// Writing
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+/// Builds the contents of a file of the store: the fixed-size entries, and
+/// the string table that follows them.
+class StoreFileBuilder {
+  std::string Entries;
+  std::string Strings;
+
+public:
+  StoreFileBuilder(const char *Magic) {
+    Entries.append(Magic, 4);
+    write32(StoreVersion);
+  }
+
+  void write8(uint8_t Value) { Entries += char(Value); }
+
+  void write32(uint32_t Value) {
+    char Buffer[4];
+    endian::write32le(Buffer, Value);
+    Entries.append(Buffer, 4);
+  }
+
+  void writeString(StringRef S) {
+    write32(Strings.size());
+    write32(S.size());
+    Strings += S;
+  }
+
+  std::string take() { return Entries + Strings; }
+};
+
+/// Writes \p Contents to the file \p Name in \p Dir, so that readers see
+/// either all of it or none of it.
+std::error_code writeAtomically(StringRef Dir, StringRef Name,
+                                StringRef Contents,
+                                SmallVectorImpl<char> &Path) {
+  Path.assign(Dir.begin(), Dir.end());
+  llvm::sys::path::append(Path, Name);
+  if (std::error_code EC = llvm::sys::fs::create_directories(Dir))
+    return EC;
+
+  SmallString<256> TempPath;
+  int FD;
+  if (std::error_code EC = llvm::sys::fs::createUniqueFile(
+          Twine(StringRef(Path.data(), Path.size())) + "-%%%%%%%%", FD,
+          TempPath))
+    return EC;
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS << Contents;
+    OS.close();
+    if (OS.has_error()) {
+      OS.clear_error();
+      llvm::sys::fs::remove(TempPath);
+      return std::make_error_code(std::errc::io_error);
+    }
+  }
+  if (std::error_code EC = llvm::sys::fs::rename(TempPath, Path)) {
+    llvm::sys::fs::remove(TempPath);
+    return EC;
+  }
+  return std::error_code();
+}
+
+class IndexStoreConsumer : public IndexDataConsumer {
+public:
+  IndexStoreConsumer(StringRef StorePath, StringRef OutputFile)
+      : StorePath(StorePath), OutputFile(OutputFile) {}
+
+  void initialize(ASTContext &Ctx) override {
+    SM = &Ctx.getSourceManager();
+    Diags = &Ctx.getDiagnostics();
+  }
+
+  void setPreprocessor(std::shared_ptr<Preprocessor> PP) override {
+    SM = &PP->getSourceManager();
+    Diags = &PP->getDiagnostics();
+  }
+
+  bool handleDeclOccurence(const Decl *D, SymbolRoleSet Roles,
+                           ArrayRef<SymbolRelation> Relations,
+                           SourceLocation Loc, ASTNodeInfo ASTNode) override {
+    auto It = DeclSymbols.find(D);
+    if (It == DeclSymbols.end()) {
+      unsigned Symbol = NoSymbol;
+      SmallString<128> USR;
+      if (!generateUSRForDecl(D, USR)) {
+        std::string Name;
+        if (const auto *ND = dyn_cast<NamedDecl>(D))
+          Name = ND->getDeclName().getAsString();
+        Symbol = addSymbol(USR, Name, getSymbolInfo(D));
+      }
+      It = DeclSymbols.insert({D, Symbol}).first;
+    }
+    if (It->second != NoSymbol)
+      addOccurrence(It->second, Roles, Loc);
+    return true;
+  }
+
+  bool handleMacroOccurence(const IdentifierInfo *Name, const MacroInfo *MI,
+                            SymbolRoleSet Roles, SourceLocation Loc) override {
+    if (!MI || !SM)
+      return true;
+    auto It = MacroSymbols.find(MI);
+    if (It == MacroSymbols.end()) {
+      unsigned Symbol = NoSymbol;
+      SmallString<128> USR;
+      if (!generateUSRForMacro(Name->getName(), MI->getDefinitionLoc(), *SM,
+                               USR))
+        Symbol = addSymbol(USR, Name->getName(), getSymbolInfoForMacro(*MI));
+      It = MacroSymbols.insert({MI, Symbol}).first;
+    }
+    if (It->second != NoSymbol)
+      addOccurrence(It->second, Roles, Loc);
+    return true;
+  }
+
+  void handleSkippedFile(const FileEntry &File) override {
+    SkippedFiles.push_back(&File);
+  }
+
+  void finish() override;
+
+private:
+  struct SymbolData {
+    std::string USR;
+    std::string Name;
+    SymbolInfo Info;
+  };
+
+  struct OccurrenceData {
+    unsigned Symbol;
+    SymbolRoleSet Roles;
+    unsigned Line;
+    unsigned Column;
+
+    bool operator<(const OccurrenceData &Other) const {
+      return std::tie(Line, Column, Symbol, Roles) <
+             std::tie(Other.Line, Other.Column, Other.Symbol, Other.Roles);
+    }
+    bool operator==(const OccurrenceData &Other) const {
+      return std::tie(Line, Column, Symbol, Roles) ==
+             std::tie(Other.Line, Other.Column, Other.Symbol, Other.Roles);
+    }
+  };
+
+  static const unsigned NoSymbol = ~0U;
+
+  unsigned addSymbol(StringRef USR, StringRef Name, SymbolInfo Info) {
+    auto Inserted = SymbolsByUSR.insert({USR, Symbols.size()});
+    if (Inserted.second)
+      Symbols.push_back({USR, Name, Info});
+    return Inserted.first->second;
+  }
+
+  void addOccurrence(unsigned Symbol, SymbolRoleSet Roles, SourceLocation Loc) {
+    if (!SM || Loc.isInvalid())
+      return;
+    std::pair<FileID, unsigned> Decomposed =
+        SM->getDecomposedLoc(SM->getFileLoc(Loc));
+    const FileEntry *File = SM->getFileEntryForID(Decomposed.first);
+    if (!File)
+      return;
+    Occurrences[File].push_back(
+        {Symbol, Roles, SM->getLineNumber(Decomposed.first, Decomposed.second),
+         SM->getColumnNumber(Decomposed.first, Decomposed.second)});
+  }
+
+  /// Returns the contents of the record of a file with \p Occurrences.
+  std::string buildRecord(std::vector<OccurrenceData> &Occurrences) const;
+
+  void reportWriteError(StringRef Path, std::error_code EC) {
+    if (Diags)
+      Diags->Report(diag::err_fe_unable_to_open_output) << Path
+                                                         << EC.message();
+  }
+
+  std::string StorePath;
+  std::string OutputFile;
+  const SourceManager *SM = nullptr;
+  DiagnosticsEngine *Diags = nullptr;
+
+  std::vector<SymbolData> Symbols;
+  llvm::StringMap<unsigned> SymbolsByUSR;
+  llvm::DenseMap<const Decl *, unsigned> DeclSymbols;
+  llvm::DenseMap<const MacroInfo *, unsigned> MacroSymbols;
+  llvm::DenseMap<const FileEntry *, std::vector<OccurrenceData>> Occurrences;
+  /// The files whose occurrences were skipped as already indexed.
+  std::vector<const FileEntry *> SkippedFiles;
+};
+
+} // end anonymous namespace
+
+std::string IndexStoreConsumer::buildRecord(
+    std::vector<OccurrenceData> &FileOccurrences) const {
+  // Number the symbols of the record in USR order, so that the record does
+  // not depend on the order in which the translation unit found them.
+  std::vector<unsigned> FileSymbols;
+  for (const OccurrenceData &Occurrence : FileOccurrences)
+    FileSymbols.push_back(Occurrence.Symbol);
+  llvm::sort(FileSymbols, [&](unsigned LHS, unsigned RHS) {
+    return Symbols[LHS].USR < Symbols[RHS].USR;
+  });
+  FileSymbols.erase(std::unique(FileSymbols.begin(), FileSymbols.end()),
+                    FileSymbols.end());
+  llvm::DenseMap<unsigned, unsigned> LocalSymbols;
+  for (unsigned I = 0, E = FileSymbols.size(); I != E; ++I)
+    LocalSymbols[FileSymbols[I]] = I;
+  for (OccurrenceData &Occurrence : FileOccurrences)
+    Occurrence.Symbol = LocalSymbols[Occurrence.Symbol];
+  llvm::sort(FileOccurrences);
+  FileOccurrences.erase(
+      std::unique(FileOccurrences.begin(), FileOccurrences.end()),
+      FileOccurrences.end());
+
+  StoreFileBuilder Builder(RecordMagic);
+  Builder.write32(FileSymbols.size());
+  Builder.write32(FileOccurrences.size());
+  for (unsigned Symbol : FileSymbols) {
+    const SymbolData &Data = Symbols[Symbol];
+    Builder.writeString(Data.USR);
+    Builder.writeString(Data.Name);
+    Builder.write8(uint8_t(Data.Info.Kind));
+    Builder.write8(uint8_t(Data.Info.SubKind));
+    Builder.write8(uint8_t(Data.Info.Lang));
+    Builder.write8(0);
+  }
+  for (const OccurrenceData &Occurrence : FileOccurrences) {
+    Builder.write32(Occurrence.Symbol);
+    Builder.write32(Occurrence.Roles);
+    Builder.write32(Occurrence.Line);
+    Builder.write32(Occurrence.Column);
+  }
+  return Builder.take();
+}
+
+void IndexStoreConsumer::finish() {
+  if (!SM)
+    return;
+  const FileEntry *MainFile = SM->getFileEntryForID(SM->getMainFileID());
+  if (!MainFile)
+    return;
+
+  SmallString<256> RecordDir;
+  getStoreDirectory(StorePath, "records", RecordDir);
+  std::vector<std::pair<std::string, std::string>> Dependencies;
+  for (auto &Entry : Occurrences) {
+    std::string FilePath = getAbsolutePath(Entry.first->getName());
+    std::string Record = buildRecord(Entry.second);
+    std::string RecordName = (llvm::sys::path::filename(FilePath) + "-" +
+                              llvm::utohexstr(llvm::xxHash64(Record)))
+                                 .str();
+    // A record with this name has the same contents.
+    SmallString<256> RecordPath(RecordDir);
+    llvm::sys::path::append(RecordPath, RecordName);
+    if (!llvm::sys::fs::exists(RecordPath)) {
+      if (std::error_code EC =
+              writeAtomically(RecordDir, RecordName, Record, RecordPath)) {
+        reportWriteError(RecordPath, EC);
+        return;
+      }
+    }
+    Dependencies.emplace_back(std::move(FilePath), std::move(RecordName));
+  }
+  // A skipped file still belongs to the unit; it depends on the record that
+  // was written for the file when it was indexed.
+  if (!SkippedFiles.empty()) {
+    llvm::StringMap<IndexedFile> IndexedFiles;
+    readIndexedFiles(StorePath, IndexedFiles);
+    for (const FileEntry *File : SkippedFiles) {
+      std::string FilePath = getAbsolutePath(File->getName());
+      auto It = IndexedFiles.find(FilePath);
+      if (It != IndexedFiles.end() && !Occurrences.count(File))
+        Dependencies.emplace_back(std::move(FilePath), It->second.RecordName);
+    }
+  }
+  llvm::sort(Dependencies);
+
+  std::string MainFilePath = getAbsolutePath(MainFile->getName());
+  StoreFileBuilder Builder(UnitMagic);
+  Builder.write32(Dependencies.size());
+  Builder.writeString(MainFilePath);
+  Builder.writeString(OutputFile.empty() || OutputFile == "-"
+                          ? std::string()
+                          : getAbsolutePath(OutputFile));
+  for (const auto &Dependency : Dependencies) {
+    Builder.writeString(Dependency.first);
+    Builder.writeString(Dependency.second);
+  }
+
+  SmallString<256> UnitDir, UnitPath;
+  getStoreDirectory(StorePath, "units", UnitDir);
+  if (std::error_code EC =
+          writeAtomically(UnitDir, getIndexStoreUnitName(MainFilePath,
+                                                         OutputFile),
+                          Builder.take(), UnitPath))
+    reportWriteError(UnitPath, EC);
+}
+
+std::shared_ptr<IndexDataConsumer>
+clang::index::createIndexStoreConsumer(StringRef StorePath,
+                                       StringRef OutputFile) {
+  return std::make_shared<IndexStoreConsumer>(StorePath, OutputFile);
+}
+
+//===----------------------------------------------------------------------===//
+// Reading
+//===----------------------------------------------------------------------===//
+
+static llvm::Error makeStoreError(StringRef Path, const Twine &Message) {
+  return llvm::make_error<llvm::StringError>(
+      "index store file '" + Path + "' " + Message,
+      llvm::inconvertibleErrorCode());
+}
+
+/// Reads the string at \p Entry from \p Strings, returning false if it is out
+/// of bounds.
+static bool readString(StringRef Strings, const char *Entry, StringRef &S) {
+  uint32_t Offset = endian::read32le(Entry);
+  uint32_t Length = endian::read32le(Entry + 4);
+  if (Offset > Strings.size() || Length > Strings.size() - Offset)
+    return false;
+  S = Strings.substr(Offset, Length);
+  return true;
+}
+
+/// Opens the file \p Name of the given kind, and checks its magic number and
+/// version.
+static llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>>
+openStoreFile(StringRef StorePath, StringRef Kind, StringRef Name,
+              const char *Magic, SmallVectorImpl<char> &Path) {
+  getStoreDirectory(StorePath, Kind, Path);
+  llvm::sys::path::append(Path, Name);
+  StringRef PathStr(Path.data(), Path.size());
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(PathStr, /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
+  if (!Buffer)
+    return llvm::make_error<llvm::StringError>(
+        "cannot open index store file '" + PathStr + "'", Buffer.getError());
+  StringRef Data = (*Buffer)->getBuffer();
+  if (Data.size() < 8 || std::memcmp(Data.data(), Magic, 4) != 0)
+    return makeStoreError(PathStr, "has an unknown format");
+  if (endian::read32le(Data.data() + 4) != StoreVersion)
+    return makeStoreError(PathStr, "has an unsupported version");
+  return std::move(*Buffer);
+}
+
+IndexUnitReader::IndexUnitReader(std::unique_ptr<llvm::MemoryBuffer> Buffer)
+    : Buffer(std::move(Buffer)) {}
+
+IndexUnitReader::~IndexUnitReader() = default;
+
+llvm::Expected<std::unique_ptr<IndexUnitReader>>
+IndexUnitReader::create(StringRef StorePath, StringRef UnitName) {
+  SmallString<256> Path;
+  auto Buffer = openStoreFile(StorePath, "units", UnitName, UnitMagic, Path);
+  if (!Buffer)
+    return Buffer.takeError();
+  std::unique_ptr<IndexUnitReader> Reader(
+      new IndexUnitReader(std::move(*Buffer)));
+
+  StringRef Data = Reader->Buffer->getBuffer();
+  if (Data.size() < UnitHeaderSize)
+    return makeStoreError(Path, "is truncated");
+  uint64_t NumDependencies = endian::read32le(Data.data() + 8);
+  uint64_t StringsOffset =
+      UnitHeaderSize + NumDependencies * UnitDependencySize;
+  if (StringsOffset > Data.size())
+    return makeStoreError(Path, "is truncated");
+  Reader->NumDependencies = NumDependencies;
+  Reader->Dependencies = Data.data() + UnitHeaderSize;
+  Reader->Strings = Data.substr(StringsOffset);
+
+  bool Valid =
+      readString(Reader->Strings, Data.data() + 12, Reader->MainFilePath) &&
+      readString(Reader->Strings, Data.data() + 12 + StringRefSize,
+                 Reader->OutputFile);
+  for (unsigned I = 0; Valid && I != NumDependencies; ++I) {
+    const char *Entry = Reader->Dependencies + I * UnitDependencySize;
+    StringRef S;
+    Valid = readString(Reader->Strings, Entry, S) &&
+            readString(Reader->Strings, Entry + StringRefSize, S);
+  }
+  if (!Valid)
+    return makeStoreError(Path, "is corrupted");
+  return std::move(Reader);
+}
+
+IndexUnitReader::Dependency IndexUnitReader::getDependency(unsigned I) const {
+  assert(I < NumDependencies && "Dependency index out of range.");
+  const char *Entry = Dependencies + I * UnitDependencySize;
+  Dependency Result;
+  readString(Strings, Entry, Result.FilePath);
+  readString(Strings, Entry + StringRefSize, Result.RecordName);
+  return Result;
+}
+
+IndexRecordReader::IndexRecordReader(std::unique_ptr<llvm::MemoryBuffer> Buffer)
+    : Buffer(std::move(Buffer)) {}
+
+IndexRecordReader::~IndexRecordReader() = default;
+
+llvm::Expected<std::unique_ptr<IndexRecordReader>>
+IndexRecordReader::create(StringRef StorePath, StringRef RecordName) {
+  SmallString<256> Path;
+  auto Buffer =
+      openStoreFile(StorePath, "records", RecordName, RecordMagic, Path);
+  if (!Buffer)
+    return Buffer.takeError();
+  std::unique_ptr<IndexRecordReader> Reader(
+      new IndexRecordReader(std::move(*Buffer)));
+
+  StringRef Data = Reader->Buffer->getBuffer();
+  if (Data.size() < RecordHeaderSize)
+    return makeStoreError(Path, "is truncated");
+  uint64_t NumSymbols = endian::read32le(Data.data() + 8);
+  uint64_t NumOccurrences = endian::read32le(Data.data() + 12);
+  uint64_t OccurrencesOffset =
+      RecordHeaderSize + NumSymbols * RecordSymbolSize;
+  uint64_t StringsOffset =
+      OccurrencesOffset + NumOccurrences * RecordOccurrenceSize;
+  if (StringsOffset > Data.size())
+    return makeStoreError(Path, "is truncated");
+  Reader->NumSymbols = NumSymbols;
+  Reader->NumOccurrences = NumOccurrences;
+  Reader->Symbols = Data.data() + RecordHeaderSize;
+  Reader->Occurrences = Data.data() + OccurrencesOffset;
+  Reader->Strings = Data.substr(StringsOffset);
+
+  bool Valid = true;
+  for (unsigned I = 0; Valid && I != NumSymbols; ++I) {
+    const char *Entry = Reader->Symbols + I * RecordSymbolSize;
+    StringRef S;
+    Valid = readString(Reader->Strings, Entry, S) &&
+            readString(Reader->Strings, Entry + StringRefSize, S);
+  }
+  for (unsigned I = 0; Valid && I != NumOccurrences; ++I)
+    Valid = endian::read32le(Reader->Occurrences + I * RecordOccurrenceSize) <
+            NumSymbols;
+  if (!Valid)
+    return makeStoreError(Path, "is corrupted");
+  return std::move(Reader);
+}
+
+IndexRecordReader::Symbol IndexRecordReader::getSymbol(unsigned I) const {
+  assert(I < NumSymbols && "Symbol index out of range.");
+  const char *Entry = Symbols + I * RecordSymbolSize;
+  Symbol Result;
+  readString(Strings, Entry, Result.USR);
+  readString(Strings, Entry + StringRefSize, Result.Name);
+  Result.Kind = SymbolKind(uint8_t(Entry[2 * StringRefSize]));
+  Result.SubKind = SymbolSubKind(uint8_t(Entry[2 * StringRefSize + 1]));
+  Result.Lang = SymbolLanguage(uint8_t(Entry[2 * StringRefSize + 2]));
+  return Result;
+}
+
+IndexRecordReader::Occurrence
+IndexRecordReader::getOccurrence(unsigned I) const {
+  assert(I < NumOccurrences && "Occurrence index out of range.");
+  const char *Entry = Occurrences + I * RecordOccurrenceSize;
+  Occurrence Result;
+  Result.SymbolIndex = endian::read32le(Entry);
+  Result.Roles = endian::read32le(Entry + 4);
+  Result.Line = endian::read32le(Entry + 8);
+  Result.Column = endian::read32le(Entry + 12);
+  return Result;
+}
+
+//===----------------------------------------------------------------------===//
+// File oracle
+//===----------------------------------------------------------------------===//
+
+static void readIndexedFiles(StringRef StorePath,
+                             llvm::StringMap<IndexedFile> &IndexedFiles) {
+  SmallString<256> UnitDir;
+  getStoreDirectory(StorePath, "units", UnitDir);
+  std::error_code EC;
+  for (llvm::sys::fs::directory_iterator It(UnitDir, EC), End;
+       It != End && !EC; It.increment(EC)) {
+    llvm::ErrorOr<llvm::sys::fs::basic_file_status> Status = It->status();
+    if (!Status)
+      continue;
+    auto Unit = IndexUnitReader::create(
+        StorePath, llvm::sys::path::filename(It->path()));
+    if (!Unit) {
+      llvm::consumeError(Unit.takeError());
+      continue;
+    }
+    llvm::sys::TimePoint<> Written = Status->getLastModificationTime();
+    for (unsigned I = 0, E = (*Unit)->getNumDependencies(); I != E; ++I) {
+      IndexUnitReader::Dependency Dep = (*Unit)->getDependency(I);
+      IndexedFile &File = IndexedFiles[Dep.FilePath];
+      if (File.RecordName.empty() || File.IndexedAt < Written) {
+        File.IndexedAt = Written;
+        File.RecordName = Dep.RecordName;
+      }
+    }
+  }
+}
+
+namespace {
+
+class IndexStoreFileOracle : public IndexedFileOracle {
+public:
+  IndexStoreFileOracle(StringRef StorePath) {
+    readIndexedFiles(StorePath, IndexedFiles);
+  }
+
+  bool isFileIndexed(const FileEntry &File) override {
+    auto It = IndexedFiles.find(getAbsolutePath(File.getName()));
+    return It != IndexedFiles.end() &&
+           llvm::sys::toTimePoint(File.getModificationTime()) <=
+               It->second.IndexedAt;
+  }
+
+private:
+  llvm::StringMap<IndexedFile> IndexedFiles;
+};
+
+} // end anonymous namespace
+
+std::shared_ptr<IndexedFileOracle>
+clang::index::createIndexStoreFileOracle(StringRef StorePath) {
+  return std::make_shared<IndexStoreFileOracle>(StorePath);
+}
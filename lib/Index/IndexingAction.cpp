@@ -22,6 +22,8 @@
 using namespace clang;
 using namespace clang::index;
 
+IndexedFileOracle::~IndexedFileOracle() {}
+
 bool IndexDataConsumer::handleDeclOccurence(const Decl *D, SymbolRoleSet Roles,
                                             ArrayRef<SymbolRelation> Relations,
                                             SourceLocation Loc,
@@ -69,6 +71,8 @@ protected:
     // Ignore deserialized decls.
   }
 
+  bool wantsInterestingDecls() override { return false; }
+
   void HandleTopLevelDeclInObjCContainer(DeclGroupRef DG) override {
     IndexCtx->indexDeclGroupRef(DG);
   }
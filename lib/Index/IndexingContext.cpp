@@ -29,6 +29,30 @@ bool IndexingContext::shouldIndex(const Decl *D) {
   return !isGeneratedDecl(D);
 }
 
+bool IndexingContext::shouldSkipLocation(SourceLocation Loc) {
+  if (!IndexOpts.FileOracle || !Ctx || Loc.isInvalid())
+    return false;
+  SourceManager &SM = Ctx->getSourceManager();
+  FileID FID = SM.getFileID(SM.getFileLoc(Loc));
+  return FID.isValid() && shouldSkipFile(FID);
+}
+
+bool IndexingContext::shouldSkipFile(FileID FID) {
+  if (!IndexOpts.FileOracle || !Ctx)
+    return false;
+  auto Cached = SkippedFiles.find(FID);
+  if (Cached != SkippedFiles.end())
+    return Cached->second;
+  SourceManager &SM = Ctx->getSourceManager();
+  bool Skip = false;
+  if (FID != SM.getMainFileID())
+    if (const FileEntry *File = SM.getFileEntryForID(FID))
+      if ((Skip = IndexOpts.FileOracle->isFileIndexed(*File)))
+        DataConsumer.handleSkippedFile(*File);
+  SkippedFiles[FID] = Skip;
+  return Skip;
+}
+
 const LangOptions &IndexingContext::getLangOpts() const {
   return Ctx->getLangOpts();
 }
@@ -106,7 +130,7 @@ bool IndexingContext::importedModule(const ImportDecl *ImportD) {
 
   SourceManager &SM = Ctx->getSourceManager();
   FileID FID = SM.getFileID(SM.getFileLoc(Loc));
-  if (FID.isInvalid())
+  if (FID.isInvalid() || shouldSkipFile(FID))
     return true;
 
   bool Invalid = false;
@@ -351,7 +375,7 @@ bool IndexingContext::handleDeclOccurrence(const Decl *D, SourceLocation Loc,
 
   SourceManager &SM = Ctx->getSourceManager();
   FileID FID = SM.getFileID(SM.getFileLoc(Loc));
-  if (FID.isInvalid())
+  if (FID.isInvalid() || shouldSkipFile(FID))
     return true;
 
   bool Invalid = false;
@@ -438,6 +462,8 @@ bool IndexingContext::handleDeclOccurrence(const Decl *D, SourceLocation Loc,
 void IndexingContext::handleMacroDefined(const IdentifierInfo &Name,
                                          SourceLocation Loc,
                                          const MacroInfo &MI) {
+  if (shouldSkipLocation(Loc))
+    return;
   SymbolRoleSet Roles = (unsigned)SymbolRole::Definition;
   DataConsumer.handleMacroOccurence(&Name, &MI, Roles, Loc);
 }
@@ -445,6 +471,8 @@ void IndexingContext::handleMacroDefined(const IdentifierInfo &Name,
 void IndexingContext::handleMacroUndefined(const IdentifierInfo &Name,
                                            SourceLocation Loc,
                                            const MacroInfo &MI) {
+  if (shouldSkipLocation(Loc))
+    return;
   SymbolRoleSet Roles = (unsigned)SymbolRole::Undefinition;
   DataConsumer.handleMacroOccurence(&Name, &MI, Roles, Loc);
 }
@@ -452,6 +480,8 @@ void IndexingContext::handleMacroUndefined(const IdentifierInfo &Name,
 void IndexingContext::handleMacroReference(const IdentifierInfo &Name,
                                            SourceLocation Loc,
                                            const MacroInfo &MI) {
+  if (shouldSkipLocation(Loc))
+    return;
   SymbolRoleSet Roles = (unsigned)SymbolRole::Reference;
   DataConsumer.handleMacroOccurence(&Name, &MI, Roles, Loc);
 }
@@ -12,10 +12,12 @@
 
 #include "clang/Basic/IdentifierTable.h"
 #include "clang/Basic/LLVM.h"
+#include "clang/Basic/SourceLocation.h"
 #include "clang/Index/IndexSymbol.h"
 #include "clang/Index/IndexingAction.h"
 #include "clang/Lex/MacroInfo.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
 
 namespace clang {
   class ASTContext;
@@ -31,7 +33,6 @@ namespace clang {
   class Stmt;
   class Expr;
   class TypeLoc;
-  class SourceLocation;
 
 namespace index {
   class IndexDataConsumer;
@@ -40,6 +41,8 @@ class IndexingContext {
   IndexingOptions IndexOpts;
   IndexDataConsumer &DataConsumer;
   ASTContext *Ctx = nullptr;
+  /// The answers of the file oracle, by file.
+  llvm::DenseMap<FileID, bool> SkippedFiles;
 
 public:
   IndexingContext(IndexingOptions IndexOpts, IndexDataConsumer &DataConsumer)
@@ -52,6 +55,9 @@ public:
 
   bool shouldIndex(const Decl *D);
 
+  /// Whether \p Loc is in a file that the file oracle says is indexed.
+  bool shouldSkipLocation(SourceLocation Loc);
+
   const LangOptions &getLangOpts() const;
 
   bool shouldSuppressRefs() const {
@@ -121,6 +127,8 @@ public:
 private:
   bool shouldIgnoreIfImplicit(const Decl *D);
 
+  bool shouldSkipFile(FileID FID);
+
   bool handleDeclOccurrence(const Decl *D, SourceLocation Loc,
                             bool IsRef, const Decl *Parent,
                             SymbolRoleSet Roles,
@@ -12,8 +12,12 @@
 #include "clang/AST/DeclTemplate.h"
 #include "clang/AST/DeclVisitor.h"
 #include "clang/Lex/PreprocessingRecord.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/StringSaver.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
 
 using namespace clang;
 using namespace clang::index;
@@ -55,6 +59,25 @@ static StringRef GetExternalSourceContainer(const NamedDecl *D) {
   return StringRef();
 }
 
+class USRCache::Impl {
+public:
+  struct Entry {
+    StringRef USR;
+    uint64_t Hash;
+  };
+
+  Impl(ASTContext &Ctx) : Ctx(Ctx), Saver(Alloc) {}
+
+  ASTContext &Ctx;
+  llvm::BumpPtrAllocator Alloc;
+  llvm::StringSaver Saver;
+  /// The interned USRs, by declaration.
+  llvm::DenseMap<const Decl *, Entry> USRs;
+  /// The USR fragments of enclosing contexts, without the USR prefix. None
+  /// for contexts whose fragment can't be reused, see VisitDeclContext().
+  llvm::DenseMap<const NamedDecl *, Optional<StringRef>> ContextFragments;
+};
+
 namespace {
 class USRGenerator : public ConstDeclVisitor<USRGenerator> {
   SmallVectorImpl<char> &Buf;
@@ -62,16 +85,25 @@ class USRGenerator : public ConstDeclVisitor<USRGenerator> {
   bool IgnoreResults;
   ASTContext *Context;
   bool generatedLoc;
+  USRCache::Impl *Cache;
 
   llvm::DenseMap<const Type *, unsigned> TypeSubstitutions;
 
+  /// Whether a context fragment generated now would look the same as it
+  /// would in any other USR.
+  bool isInInitialState() const {
+    return !IgnoreResults && !generatedLoc && TypeSubstitutions.empty();
+  }
+
 public:
-  explicit USRGenerator(ASTContext *Ctx, SmallVectorImpl<char> &Buf)
+  explicit USRGenerator(ASTContext *Ctx, SmallVectorImpl<char> &Buf,
+                        USRCache::Impl *Cache = nullptr)
   : Buf(Buf),
     Out(Buf),
     IgnoreResults(false),
     Context(Ctx),
-    generatedLoc(false)
+    generatedLoc(false),
+    Cache(Cache)
   {
     // Add the USR space prefix.
     Out << getUSRSpacePrefix();
@@ -191,7 +223,29 @@ bool USRGenerator::ShouldGenerateLocation(const NamedDecl *D) {
 }
 
 void USRGenerator::VisitDeclContext(const DeclContext *DC) {
-  if (const NamedDecl *D = dyn_cast<NamedDecl>(DC))
+  const NamedDecl *D = dyn_cast<NamedDecl>(DC);
+  if (D && Cache && isInInitialState()) {
+    // A context's fragment only depends on the state of the generator through
+    // its location and type substitutions. It can be shared if it was
+    // generated from the initial state and left that state unchanged.
+    auto Cached = Cache->ContextFragments.find(D);
+    if (Cached != Cache->ContextFragments.end()) {
+      if (Cached->second)
+        Out << *Cached->second;
+      else
+        Visit(D);
+      return;
+    }
+    const unsigned StartSize = Buf.size();
+    Visit(D);
+    Optional<StringRef> Fragment;
+    if (isInInitialState())
+      Fragment = Cache->Saver.save(
+          StringRef(Buf.data() + StartSize, Buf.size() - StartSize));
+    Cache->ContextFragments[D] = Fragment;
+    return;
+  }
+  if (D)
     Visit(D);
   else if (isa<LinkageSpecDecl>(DC)) // Linkage specs are transparent in USRs.
     VisitDeclContext(DC->getParent());
@@ -1074,6 +1128,41 @@ bool clang::index::generateUSRForDecl(const Decl *D,
   return UG.ignoreResults();
 }
 
+USRCache::USRCache(ASTContext &Ctx) : TheImpl(llvm::make_unique<Impl>(Ctx)) {}
+
+USRCache::~USRCache() = default;
+
+ASTContext &USRCache::getASTContext() const { return TheImpl->Ctx; }
+
+StringRef USRCache::getUSR(const Decl *D) {
+  if (!D)
+    return StringRef();
+  assert(&D->getASTContext() == &TheImpl->Ctx &&
+         "Declaration from another ASTContext.");
+  auto Cached = TheImpl->USRs.find(D);
+  if (Cached != TheImpl->USRs.end())
+    return Cached->second.USR;
+
+  Impl::Entry Result = {StringRef(), 0};
+  SmallString<128> Buf;
+  USRGenerator UG(&TheImpl->Ctx, Buf, TheImpl.get());
+  UG.Visit(D);
+  if (!UG.ignoreResults()) {
+    Result.USR = TheImpl->Saver.save(StringRef(Buf));
+    Result.Hash = hashUSR(Result.USR);
+  }
+  TheImpl->USRs[D] = Result;
+  return Result.USR;
+}
+
+uint64_t USRCache::getUSRHash(const Decl *D) {
+  getUSR(D);
+  auto Cached = TheImpl->USRs.find(D);
+  return Cached == TheImpl->USRs.end() ? 0 : Cached->second.Hash;
+}
+
+uint64_t clang::index::hashUSR(StringRef USR) { return llvm::xxHash64(USR); }
+
 bool clang::index::generateUSRForMacro(const MacroDefinitionRecord *MD,
                                        const SourceManager &SM,
                                        SmallVectorImpl<char> &Buf) {
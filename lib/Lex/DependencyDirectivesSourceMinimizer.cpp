@@ -0,0 +1,554 @@
+//===- DependencyDirectivesSourceMinimizer.cpp - Minimize source ----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file
+/// This is the implementation of the source minimizer used by the
+/// dependency-directives-only scanning mode.  It makes a single forward pass
+/// over the raw bytes of the file without building tokens: code is skipped
+/// with just enough understanding of comments and literals to find the start
+/// of each logical line, and the directives that matter are copied out.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/DependencyDirectivesSourceMinimizer.h"
+#include "clang/Basic/CharInfo.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringSwitch.h"
+
+using namespace clang;
+
+namespace {
+
+/// What to do with a directive, based on its name.
+enum DirectiveAction {
+  /// Drop the directive.
+  DA_Skip,
+  /// Keep the directive, copying the rest of the line as-is.
+  DA_Keep,
+  /// Keep the directive; its operand may be an angled header name.
+  DA_KeepInclude,
+  /// Look at the pragma name to decide.
+  DA_Pragma
+};
+
+class Minimizer {
+  const char *Cur;
+  const char *const End;
+  SmallVectorImpl<char> &Out;
+  bool Failed = false;
+
+public:
+  Minimizer(StringRef Input, SmallVectorImpl<char> &Out)
+      : Cur(Input.begin()), End(Input.end()), Out(Out) {}
+
+  bool minimize();
+
+private:
+  static bool isNewline(char C) { return C == '\n' || C == '\r'; }
+
+  /// If there is a line splice (a backslash, optional horizontal whitespace,
+  /// and a newline) at \p P, return the pointer just past it.  Otherwise
+  /// return \p P.
+  const char *skipSplice(const char *P) const;
+
+  /// Skip horizontal whitespace, line splices and block comments.
+  void skipHorizontalSpace();
+
+  /// Skip a newline sequence ("\n", "\r", "\r\n" or "\n\r") at Cur.
+  void skipNewline();
+
+  /// Return the character at Cur after any line splices, and advance Cur
+  /// past it.
+  char getAndAdvance();
+  /// Return the character at \p P after any line splices, or 0 at the end
+  /// of the input.
+  char peekAt(const char *P) const {
+    P = skipSplice(P);
+    return P == End ? 0 : *P;
+  }
+
+  /// Skip a "/*" comment starting at Cur.
+  void skipBlockComment();
+  /// Skip to the newline that ends a "//" comment starting at Cur.
+  void skipLineComment();
+  /// Skip a quoted literal starting with the quote at Cur.  Unterminated
+  /// literals end at the end of the line, which keeps stray apostrophes in
+  /// '#if 0' blocks from eating the rest of the file.
+  void skipQuoted(bool Copy);
+  /// Skip a raw string literal whose opening quote is at Cur.
+  void skipRawString();
+  /// Lex an identifier at Cur, joining line splices.
+  StringRef lexIdentifier(SmallVectorImpl<char> &Storage);
+
+  /// Skip to the start of the next logical line, treating the rest of the
+  /// current one as code.
+  void skipLine();
+
+  /// Handle a directive; Cur points just past the '#'.
+  void lexDirective();
+  /// Copy the rest of the logical line, normalizing whitespace and dropping
+  /// comments.
+  void copyRestOfLine(bool AllowAngledHeader);
+  /// Handle an '@import' or C++ 'module'/'import' declaration: copy it
+  /// through the terminating semicolon or the end of the line, whichever
+  /// comes first.
+  void copyThroughSemi();
+
+  void emit(StringRef S) { Out.append(S.begin(), S.end()); }
+  void emitSpaceIfNeeded() {
+    if (!Out.empty() && Out.back() != ' ' && Out.back() != '\n')
+      Out.push_back(' ');
+  }
+  void endLine() {
+    while (!Out.empty() && Out.back() == ' ')
+      Out.pop_back();
+    Out.push_back('\n');
+  }
+};
+
+} // end anonymous namespace
+
+const char *Minimizer::skipSplice(const char *P) const {
+  while (P != End && *P == '\\') {
+    const char *Q = P + 1;
+    while (Q != End && isHorizontalWhitespace(*Q))
+      ++Q;
+    if (Q == End || !isNewline(*Q))
+      return P;
+    char C = *Q++;
+    if (Q != End && isNewline(*Q) && *Q != C)
+      ++Q;
+    P = Q;
+  }
+  return P;
+}
+
+void Minimizer::skipNewline() {
+  assert(Cur != End && isNewline(*Cur));
+  char C = *Cur++;
+  if (Cur != End && isNewline(*Cur) && *Cur != C)
+    ++Cur;
+}
+
+char Minimizer::getAndAdvance() {
+  Cur = skipSplice(Cur);
+  if (Cur == End)
+    return 0;
+  return *Cur++;
+}
+
+void Minimizer::skipHorizontalSpace() {
+  while (true) {
+    Cur = skipSplice(Cur);
+    if (Cur == End)
+      return;
+    if (isHorizontalWhitespace(*Cur)) {
+      ++Cur;
+      continue;
+    }
+    if (*Cur == '/' && peekAt(Cur + 1) == '*') {
+      skipBlockComment();
+      continue;
+    }
+    return;
+  }
+}
+
+void Minimizer::skipBlockComment() {
+  getAndAdvance(); // '/'
+  getAndAdvance(); // '*'
+  char Prev = 0;
+  while (Cur != End) {
+    char C = getAndAdvance();
+    if (Prev == '*' && C == '/')
+      return;
+    Prev = C;
+  }
+  // Unterminated comment; let the real lexer diagnose it.
+  Failed = true;
+}
+
+void Minimizer::skipLineComment() {
+  while (Cur != End) {
+    Cur = skipSplice(Cur);
+    if (Cur == End || isNewline(*Cur))
+      return;
+    ++Cur;
+  }
+}
+
+void Minimizer::skipQuoted(bool Copy) {
+  char Quote = getAndAdvance();
+  if (Copy)
+    Out.push_back(Quote);
+  while (true) {
+    Cur = skipSplice(Cur);
+    if (Cur == End || isNewline(*Cur))
+      return;
+    char C = *Cur++;
+    if (Copy)
+      Out.push_back(C);
+    if (C == Quote)
+      return;
+    if (C == '\\') {
+      Cur = skipSplice(Cur);
+      if (Cur != End && !isNewline(*Cur)) {
+        if (Copy)
+          Out.push_back(*Cur);
+        ++Cur;
+      }
+    }
+  }
+}
+
+void Minimizer::skipRawString() {
+  assert(*Cur == '"');
+  const char *DelimStart = ++Cur;
+  while (Cur != End && *Cur != '(' && !isNewline(*Cur) && *Cur != '"' &&
+         Cur - DelimStart <= 16)
+    ++Cur;
+  if (Cur == End || *Cur != '(') {
+    // Not a valid raw string; treat it as an ordinary one.
+    Cur = DelimStart - 1;
+    skipQuoted(/*Copy=*/false);
+    return;
+  }
+  StringRef Delim(DelimStart, Cur - DelimStart);
+  ++Cur;
+  // Line splices are reverted inside raw strings, so look at the raw bytes.
+  while (Cur != End) {
+    if (*Cur++ != ')')
+      continue;
+    if (StringRef(Cur, End - Cur).startswith(Delim) &&
+        Cur + Delim.size() != End && Cur[Delim.size()] == '"') {
+      Cur += Delim.size() + 1;
+      return;
+    }
+  }
+  Failed = true;
+}
+
+StringRef Minimizer::lexIdentifier(SmallVectorImpl<char> &Storage) {
+  Storage.clear();
+  while (true) {
+    Cur = skipSplice(Cur);
+    if (Cur == End || !isIdentifierBody(*Cur, /*AllowDollar=*/true))
+      break;
+    Storage.push_back(*Cur++);
+  }
+  return StringRef(Storage.data(), Storage.size());
+}
+
+void Minimizer::skipLine() {
+  SmallString<16> Ident;
+  while (true) {
+    Cur = skipSplice(Cur);
+    if (Cur == End)
+      return;
+    char C = *Cur;
+    if (isNewline(C)) {
+      skipNewline();
+      return;
+    }
+
+    if (C == '/') {
+      char Next = peekAt(Cur + 1);
+      if (Next == '*') {
+        skipBlockComment();
+        if (Failed)
+          return;
+        continue;
+      }
+      if (Next == '/') {
+        skipLineComment();
+        continue;
+      }
+      ++Cur;
+      continue;
+    }
+
+    if (C == '"' || C == '\'') {
+      skipQuoted(/*Copy=*/false);
+      continue;
+    }
+
+    if (isIdentifierHead(C, /*AllowDollar=*/true)) {
+      StringRef Name = lexIdentifier(Ident);
+      if (Cur != End && *Cur == '"' &&
+          (Name == "R" || Name == "u8R" || Name == "uR" || Name == "UR" ||
+           Name == "LR")) {
+        skipRawString();
+        if (Failed)
+          return;
+      }
+      continue;
+    }
+
+    if (isDigit(C)) {
+      // Skip a pp-number, so that a digit separator isn't taken for the
+      // start of a character literal.
+      char Prev = 0;
+      while (true) {
+        Cur = skipSplice(Cur);
+        if (Cur == End)
+          break;
+        C = *Cur;
+        if (isPreprocessingNumberBody(C) ||
+            ((C == '+' || C == '-') &&
+             (Prev == 'e' || Prev == 'E' || Prev == 'p' || Prev == 'P')) ||
+            (C == '\'' && Cur + 1 != End && isIdentifierBody(Cur[1]))) {
+          Prev = C;
+          ++Cur;
+          continue;
+        }
+        break;
+      }
+      continue;
+    }
+
+    ++Cur;
+  }
+}
+
+static DirectiveAction getDirectiveAction(StringRef Name) {
+  return llvm::StringSwitch<DirectiveAction>(Name)
+      .Cases("include", "include_next", "import", "__include_macros",
+             DA_KeepInclude)
+      .Cases("define", "undef", DA_Keep)
+      .Cases("if", "ifdef", "ifndef", "elif", "else", "endif", DA_Keep)
+      .Case("pragma", DA_Pragma)
+      .Default(DA_Skip);
+}
+
+void Minimizer::copyRestOfLine(bool AllowAngledHeader) {
+  SmallString<16> Ident;
+  bool First = true;
+  while (true) {
+    Cur = skipSplice(Cur);
+    if (Cur == End)
+      break;
+    char C = *Cur;
+    if (isNewline(C)) {
+      skipNewline();
+      break;
+    }
+
+    if (isHorizontalWhitespace(C)) {
+      ++Cur;
+      emitSpaceIfNeeded();
+      continue;
+    }
+
+    if (C == '/') {
+      char Next = peekAt(Cur + 1);
+      if (Next == '*') {
+        skipBlockComment();
+        if (Failed)
+          return;
+        emitSpaceIfNeeded();
+        continue;
+      }
+      if (Next == '/') {
+        skipLineComment();
+        continue;
+      }
+    }
+
+    if (C == '"' || C == '\'') {
+      skipQuoted(/*Copy=*/true);
+      First = false;
+      continue;
+    }
+
+    if (C == '<' && AllowAngledHeader && First) {
+      // An angled header name is a single token; '//' and '/*' inside it
+      // don't start comments.
+      while (Cur != End) {
+        C = getAndAdvance();
+        if (isNewline(C)) {
+          --Cur;
+          break;
+        }
+        Out.push_back(C);
+        if (C == '>')
+          break;
+      }
+      First = false;
+      continue;
+    }
+
+    if (isIdentifierBody(C, /*AllowDollar=*/true)) {
+      emit(lexIdentifier(Ident));
+      First = false;
+      continue;
+    }
+
+    Out.push_back(C);
+    ++Cur;
+    First = false;
+  }
+  endLine();
+}
+
+void Minimizer::lexDirective() {
+  skipHorizontalSpace();
+  SmallString<16> Storage;
+  StringRef Name = lexIdentifier(Storage);
+  DirectiveAction Action = getDirectiveAction(Name);
+
+  if (Action == DA_Pragma) {
+    // Peek at the pragma name without consuming it.
+    const char *Saved = Cur;
+    skipHorizontalSpace();
+    SmallString<16> PragmaStorage;
+    StringRef Pragma = lexIdentifier(PragmaStorage);
+    if (Pragma == "GCC" || Pragma == "clang") {
+      skipHorizontalSpace();
+      SmallString<16> NSStorage;
+      Pragma = lexIdentifier(NSStorage);
+      Action = (Pragma == "system_header" || Pragma == "module") ? DA_Keep
+                                                                  : DA_Skip;
+    } else {
+      Action = llvm::StringSwitch<DirectiveAction>(Pragma)
+                   .Cases("once", "system_header", "push_macro", "pop_macro",
+                          "include_alias", DA_Keep)
+                   .Default(DA_Skip);
+    }
+    Cur = Saved;
+  }
+
+  if (Action == DA_Skip) {
+    skipLine();
+    return;
+  }
+
+  Out.push_back('#');
+  emit(Name);
+  emitSpaceIfNeeded();
+  skipHorizontalSpace();
+  copyRestOfLine(Action == DA_KeepInclude);
+}
+
+void Minimizer::copyThroughSemi() {
+  SmallString<16> Ident;
+  while (true) {
+    Cur = skipSplice(Cur);
+    if (Cur == End)
+      break;
+    char C = *Cur;
+    if (isNewline(C))
+      break;
+    if (isHorizontalWhitespace(C)) {
+      ++Cur;
+      emitSpaceIfNeeded();
+      continue;
+    }
+    if (C == '/') {
+      char Next = peekAt(Cur + 1);
+      if (Next == '*') {
+        skipBlockComment();
+        if (Failed)
+          return;
+        emitSpaceIfNeeded();
+        continue;
+      }
+      if (Next == '/') {
+        skipLineComment();
+        continue;
+      }
+    }
+    if (C == '"' || C == '\'') {
+      skipQuoted(/*Copy=*/true);
+      continue;
+    }
+    if (isIdentifierBody(C, /*AllowDollar=*/true)) {
+      emit(lexIdentifier(Ident));
+      continue;
+    }
+    Out.push_back(C);
+    ++Cur;
+    if (C == ';')
+      break;
+  }
+  endLine();
+  // Drop whatever else is on the line.
+  skipLine();
+}
+
+bool Minimizer::minimize() {
+  SmallString<16> Ident;
+  while (Cur != End && !Failed) {
+    skipHorizontalSpace();
+    if (Failed || Cur == End)
+      break;
+
+    char C = *Cur;
+    if (isNewline(C)) {
+      skipNewline();
+      continue;
+    }
+
+    if (C == '#') {
+      ++Cur;
+      lexDirective();
+      continue;
+    }
+
+    // The '%:' digraph.
+    if (C == '%' && peekAt(Cur + 1) == ':') {
+      getAndAdvance();
+      getAndAdvance();
+      lexDirective();
+      continue;
+    }
+
+    if (C == '@') {
+      const char *Saved = Cur;
+      getAndAdvance();
+      if (lexIdentifier(Ident) == "import") {
+        emit("@import");
+        copyThroughSemi();
+        continue;
+      }
+      Cur = Saved;
+      skipLine();
+      continue;
+    }
+
+    if (isIdentifierHead(C)) {
+      // C++ module declarations: [export] module ...; and [export] import ...;
+      const char *Saved = Cur;
+      StringRef Word = lexIdentifier(Ident);
+      bool IsExport = Word == "export";
+      if (IsExport) {
+        skipHorizontalSpace();
+        Word = lexIdentifier(Ident);
+      }
+      if ((Word == "module" || Word == "import") &&
+          (Cur == End || isWhitespace(*Cur) || *Cur == ';' || *Cur == '"' ||
+           *Cur == '<')) {
+        if (IsExport)
+          emit("export ");
+        emit(Word);
+        copyThroughSemi();
+        continue;
+      }
+      Cur = Saved;
+    }
+
+    skipLine();
+  }
+  return Failed;
+}
+
+bool clang::minimizeSourceToDependencyDirectives(
+    StringRef Input, SmallVectorImpl<char> &Output) {
+  Output.clear();
+  return Minimizer(Input, Output).minimize();
+}
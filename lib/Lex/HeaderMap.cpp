@@ -208,36 +208,76 @@ const FileEntry *HeaderMap::LookupFile(
   return FM.getFile(Dest);
 }
 
-StringRef HeaderMapImpl::lookupFilename(StringRef Filename,
-                                        SmallVectorImpl<char> &DestPath) const {
+void HeaderMapImpl::buildKeyIndex() const {
+  KeyIndexBuilt = true;
+
   const HMapHeader &Hdr = getHeader();
   unsigned NumBuckets = getEndianAdjustedWord(Hdr.NumBuckets);
-
-  // Don't probe infinitely.  This should be checked before constructing.
   assert(llvm::isPowerOf2_32(NumBuckets) && "Expected power of 2");
+  unsigned Mask = NumBuckets - 1;
+
+  // A key is only found by probing if no empty bucket lies between its home
+  // bucket and the bucket that holds it.  Track the closest preceding empty
+  // bucket, starting from the last one in the table since probing wraps.
+  Optional<unsigned> LastEmpty;
+  for (unsigned I = NumBuckets; I != 0; --I)
+    if (getBucket(I - 1).Key == HMAP_EmptyBucketKey) {
+      LastEmpty = I - 1;
+      break;
+    }
 
-  // Linearly probe the hash table.
-  for (unsigned Bucket = HashHMapKey(Filename);; ++Bucket) {
-    HMapBucket B = getBucket(Bucket & (NumBuckets-1));
-    if (B.Key == HMAP_EmptyBucketKey) return StringRef(); // Hash miss.
+  SmallString<256> LowerKey;
+  for (unsigned I = 0; I != NumBuckets; ++I) {
+    HMapBucket B = getBucket(I);
+    if (B.Key == HMAP_EmptyBucketKey) {
+      LastEmpty = I;
+      continue;
+    }
 
-    // See if the key matches.  If not, probe on.
     Optional<StringRef> Key = getString(B.Key);
     if (LLVM_UNLIKELY(!Key))
       continue;
-    if (!Filename.equals_lower(*Key))
+
+    unsigned Distance = (I - HashHMapKey(*Key)) & Mask;
+    if (LastEmpty && Distance >= ((I - *LastEmpty) & Mask))
       continue;
 
-    // If so, we have a match in the hash table.  Construct the destination
-    // path.
-    Optional<StringRef> Prefix = getString(B.Prefix);
-    Optional<StringRef> Suffix = getString(B.Suffix);
+    LowerKey.clear();
+    for (char C : *Key)
+      LowerKey.push_back(toLowercase(C));
 
-    DestPath.clear();
-    if (LLVM_LIKELY(Prefix && Suffix)) {
-      DestPath.append(Prefix->begin(), Prefix->end());
-      DestPath.append(Suffix->begin(), Suffix->end());
-    }
-    return StringRef(DestPath.begin(), DestPath.size());
+    // Keys that differ only in case share a home bucket; probing finds the
+    // one closest to it.
+    auto Result = KeyIndex.insert(std::make_pair(LowerKey, I));
+    if (!Result.second &&
+        Distance < ((Result.first->second - HashHMapKey(*Key)) & Mask))
+      Result.first->second = I;
+  }
+}
+
+StringRef HeaderMapImpl::lookupFilename(StringRef Filename,
+                                        SmallVectorImpl<char> &DestPath) const {
+  if (!KeyIndexBuilt)
+    buildKeyIndex();
+
+  SmallString<256> LowerFilename;
+  LowerFilename.reserve(Filename.size());
+  for (char C : Filename)
+    LowerFilename.push_back(toLowercase(C));
+
+  auto Known = KeyIndex.find(LowerFilename);
+  if (Known == KeyIndex.end())
+    return StringRef(); // Hash miss.
+
+  // We have a match in the hash table.  Construct the destination path.
+  HMapBucket B = getBucket(Known->second);
+  Optional<StringRef> Prefix = getString(B.Prefix);
+  Optional<StringRef> Suffix = getString(B.Suffix);
+
+  DestPath.clear();
+  if (LLVM_LIKELY(Prefix && Suffix)) {
+    DestPath.append(Prefix->begin(), Prefix->end());
+    DestPath.append(Suffix->begin(), Suffix->end());
   }
+  return StringRef(DestPath.begin(), DestPath.size());
 }
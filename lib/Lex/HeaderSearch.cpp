@@ -27,14 +27,20 @@
 #include "llvm/ADT/APInt.h"
 #include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/Capacity.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/EndianStream.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/VirtualFileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
 #include <algorithm>
 #include <cassert>
 #include <cstddef>
@@ -95,6 +101,10 @@ void HeaderSearch::PrintStats() {
 
   fprintf(stderr, "%d framework lookups.\n", NumFrameworkLookups);
   fprintf(stderr, "%d subframework lookups.\n", NumSubFrameworkLookups);
+  fprintf(stderr, "%d include map hits, %d stale.\n", NumIncludeMapHits,
+          NumIncludeMapStaleHits);
+  fprintf(stderr, "%d #includes skipped using the include guard database.\n",
+          NumIncludeGuardDatabaseSkips);
 }
 
 /// CreateHeaderMap - This method returns a HeaderMap for the specified
@@ -821,12 +831,14 @@ const FileEntry *HeaderSearch::LookupFile(
   // file was found in.
   if (FromDir)
     i = FromDir-&SearchDirs[0];
+  unsigned StartIdx = i;
 
   // Cache all of the lookups performed by this method.  Many headers are
   // multiply included, and the "pragma once" optimization prevents them from
   // being relex/pp'd, but they would still have to search through a
   // (potentially huge) series of SearchDirs to find it.
   LookupFileCacheInfo &CacheLookup = LookupFileCache[Filename];
+  bool FromIncludeMap = false;
 
   // If the entry has been previously looked up, the first value will be
   // non-zero.  If the value is equal to i (the start point of our search), then
@@ -844,6 +856,15 @@ const FileEntry *HeaderSearch::LookupFile(
     // our search start.  We will fill in our found location below, so prime the
     // start point value.
     CacheLookup.reset(/*StartIdx=*/i+1);
+
+    // An earlier compilation with the same search paths may already know
+    // where this search ends.  That is only a hint: if the file is no longer
+    // there, we fall back to searching from the start.
+    if (!SkipCache)
+      if (const IncludeMapEntry *Hint = lookupIncludeMap(Filename, i)) {
+        i = Hint->HitIdx;
+        FromIncludeMap = true;
+      }
   }
 
   SmallString<64> MappedName;
@@ -862,8 +883,19 @@ const FileEntry *HeaderSearch::LookupFile(
       if (IsMapped)
         *IsMapped = true;
     }
-    if (!FE) continue;
+    if (!FE) {
+      if (FromIncludeMap) {
+        // The include map is stale; search the whole path.  The loop
+        // increment brings us back to StartIdx.
+        ++NumIncludeMapStaleHits;
+        FromIncludeMap = false;
+        i = StartIdx - 1;
+      }
+      continue;
+    }
 
+    if (FromIncludeMap)
+      ++NumIncludeMapHits;
     CurDir = &SearchDirs[i];
 
     // This file is a system header or C++ unfriendly if the dir is.
@@ -909,8 +941,11 @@ const FileEntry *HeaderSearch::LookupFile(
                                Includers.front().second->getName(), Filename,
                                FE, isAngled, FoundByHeaderMap);
 
-    // Remember this location for the next lookup we do.
+    // Remember this location for the next lookup we do, and for the next
+    // compilation if the result does not depend on a header map.
     CacheLookup.HitIdx = i;
+    if (!CacheLookup.MappedName)
+      recordIncludeMap(Filename, StartIdx, i);
     return FE;
   }
 
@@ -956,6 +991,375 @@ const FileEntry *HeaderSearch::LookupFile(
   return nullptr;
 }
 
+//===----------------------------------------------------------------------===//
+// Include map
+//===----------------------------------------------------------------------===//
+
+// The include map file is laid out as follows, with all integers stored
+// little-endian:
+//
+//   magic "CIMP", version (u32), build session timestamp (u64),
+//   number of entries (u32)
+//
+// followed by that many entries of
+//
+//   start index (u32), hit index (u32), filename length (u32), filename
+static const char IncludeMapMagic[] = {'C', 'I', 'M', 'P'};
+static const uint32_t IncludeMapVersion = 1;
+static const unsigned IncludeMapHeaderSize = sizeof(IncludeMapMagic) + 16;
+
+/// Read the include map file at \p Path, passing each entry to \p AddEntry.
+///
+/// \returns true if the file is missing, malformed or from another build
+/// session.
+static bool readIncludeMapFile(
+    StringRef Path, uint64_t BuildSessionTimestamp,
+    llvm::function_ref<void(StringRef, unsigned, unsigned)> AddEntry) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(Path);
+  if (!Buffer)
+    return true;
+
+  using namespace llvm::support;
+  StringRef Data = (*Buffer)->getBuffer();
+  if (Data.size() < IncludeMapHeaderSize ||
+      memcmp(Data.data(), IncludeMapMagic, sizeof(IncludeMapMagic)) != 0)
+    return true;
+  const char *Ptr = Data.data() + sizeof(IncludeMapMagic);
+  const char *End = Data.end();
+  if (endian::read32le(Ptr) != IncludeMapVersion ||
+      endian::read64le(Ptr + 4) != BuildSessionTimestamp)
+    return true;
+  uint32_t NumEntries = endian::read32le(Ptr + 12);
+  Ptr += 16;
+
+  for (; NumEntries; --NumEntries) {
+    if (End - Ptr < 12)
+      return true;
+    uint32_t StartIdx = endian::read32le(Ptr);
+    uint32_t HitIdx = endian::read32le(Ptr + 4);
+    uint32_t Length = endian::read32le(Ptr + 8);
+    Ptr += 12;
+    if (size_t(End - Ptr) < Length)
+      return true;
+    AddEntry(StringRef(Ptr, Length), StartIdx, HitIdx);
+    Ptr += Length;
+  }
+  return false;
+}
+
+/// Write \p Contents to a temporary file and move it to \p Path, so that
+/// readers only ever see a complete file.
+///
+/// \returns true if an error occurred.
+static bool writeFileAtomically(StringRef Path, StringRef Contents) {
+  SmallString<128> TmpPath;
+  int TmpFD;
+  if (llvm::sys::fs::createUniqueFile(Path + "-%%%%%%%%", TmpFD, TmpPath))
+    return true;
+  {
+    llvm::raw_fd_ostream Out(TmpFD, /*shouldClose=*/true);
+    Out << Contents;
+    Out.close();
+    if (Out.has_error()) {
+      llvm::sys::fs::remove(TmpPath);
+      return true;
+    }
+  }
+  if (llvm::sys::fs::rename(TmpPath, Path)) {
+    llvm::sys::fs::remove(TmpPath);
+    return true;
+  }
+  return false;
+}
+
+std::string HeaderSearch::getIncludeMapFile() const {
+  // Entries are only trusted for the duration of a build session, during
+  // which headers are assumed not to appear earlier in the search path.
+  if (HSOpts->IncludeMapPath.empty() || !HSOpts->BuildSessionTimestamp)
+    return std::string();
+
+  // The file name is a hash of everything that decides which entry of
+  // SearchDirs satisfies a lookup.
+  llvm::hash_code Hash = llvm::hash_value(SearchDirs.size());
+  for (const DirectoryLookup &DL : SearchDirs)
+    Hash = llvm::hash_combine(Hash, DL.getName(), unsigned(DL.getLookupType()),
+                              unsigned(DL.getDirCharacteristic()),
+                              DL.isIndexHeaderMap());
+  for (const std::string &Overlay : HSOpts->VFSOverlayFiles)
+    Hash = llvm::hash_combine(Hash, Overlay);
+
+  // Relative search directories are resolved against the working directory.
+  Hash = llvm::hash_combine(Hash, FileMgr.getFileSystemOpts().WorkingDir);
+  if (llvm::ErrorOr<std::string> CWD =
+          FileMgr.getVirtualFileSystem()->getCurrentWorkingDirectory())
+    Hash = llvm::hash_combine(Hash, *CWD);
+
+  SmallString<128> Path(HSOpts->IncludeMapPath);
+  llvm::sys::path::append(Path, "include-map-" +
+                                    llvm::APInt(64, size_t(Hash))
+                                        .toString(36, /*Signed=*/false));
+  return Path.str();
+}
+
+const HeaderSearch::IncludeMapEntry *
+HeaderSearch::lookupIncludeMap(StringRef Filename, unsigned StartIdx) {
+  if (!IncludeMapLoaded) {
+    IncludeMapLoaded = true;
+    std::string Path = getIncludeMapFile();
+    if (!Path.empty() &&
+        readIncludeMapFile(Path, HSOpts->BuildSessionTimestamp,
+                           [&](StringRef Name, unsigned Start, unsigned Hit) {
+                             IncludeMapEntry &Entry = IncludeMap[Name];
+                             Entry.StartIdx = Start;
+                             Entry.HitIdx = Hit;
+                           }))
+      IncludeMap.clear();
+  }
+
+  auto Known = IncludeMap.find(Filename);
+  if (Known == IncludeMap.end())
+    return nullptr;
+  const IncludeMapEntry &Entry = Known->second;
+  if (Entry.StartIdx != StartIdx || Entry.HitIdx < StartIdx ||
+      Entry.HitIdx >= SearchDirs.size())
+    return nullptr;
+  return &Entry;
+}
+
+void HeaderSearch::recordIncludeMap(StringRef Filename, unsigned StartIdx,
+                                    unsigned HitIdx) {
+  if (HSOpts->IncludeMapPath.empty() || !HSOpts->BuildSessionTimestamp)
+    return;
+
+  auto Result = IncludeMap.insert(std::make_pair(Filename, IncludeMapEntry()));
+  IncludeMapEntry &Entry = Result.first->second;
+  if (!Result.second && Entry.StartIdx == StartIdx && Entry.HitIdx == HitIdx)
+    return;
+  Entry.StartIdx = StartIdx;
+  Entry.HitIdx = HitIdx;
+  IncludeMapChanged = true;
+}
+
+bool HeaderSearch::writeIncludeMap() {
+  if (!IncludeMapChanged)
+    return false;
+  std::string Path = getIncludeMapFile();
+  if (Path.empty())
+    return false;
+  uint64_t Session = HSOpts->BuildSessionTimestamp;
+
+  // Keep the lookups that other compilations wrote in the meantime, unless
+  // this one knows better.
+  llvm::StringMap<IncludeMapEntry> Merged;
+  if (readIncludeMapFile(Path, Session,
+                         [&](StringRef Name, unsigned Start, unsigned Hit) {
+                           IncludeMapEntry &Entry = Merged[Name];
+                           Entry.StartIdx = Start;
+                           Entry.HitIdx = Hit;
+                         }))
+    Merged.clear();
+  for (const auto &Entry : IncludeMap)
+    Merged[Entry.getKey()] = Entry.second;
+
+  SmallString<4096> Contents;
+  {
+    using namespace llvm::support;
+    llvm::raw_svector_ostream Out(Contents);
+    Out.write(IncludeMapMagic, sizeof(IncludeMapMagic));
+    endian::Writer LE(Out, little);
+    LE.write<uint32_t>(IncludeMapVersion);
+    LE.write<uint64_t>(Session);
+    LE.write<uint32_t>(Merged.size());
+    for (const auto &Entry : Merged) {
+      LE.write<uint32_t>(Entry.second.StartIdx);
+      LE.write<uint32_t>(Entry.second.HitIdx);
+      LE.write<uint32_t>(Entry.getKey().size());
+      Out << Entry.getKey();
+    }
+  }
+
+  if (llvm::sys::fs::create_directories(HSOpts->IncludeMapPath) ||
+      writeFileAtomically(Path, Contents))
+    return true;
+  IncludeMapChanged = false;
+  return false;
+}
+
+//===----------------------------------------------------------------------===//
+// Include guard database
+//===----------------------------------------------------------------------===//
+
+// The include guard database is laid out as follows, with all integers stored
+// little-endian:
+//
+//   magic "CIGD", version (u32), number of entries (u32)
+//
+// followed by that many entries of
+//
+//   size (u64), modification time (u64), content hash (u64),
+//   path length (u32), macro length (u32), path, macro
+static const char IncludeGuardDatabaseMagic[] = {'C', 'I', 'G', 'D'};
+static const uint32_t IncludeGuardDatabaseVersion = 1;
+
+bool HeaderSearch::readIncludeGuardDatabase(
+    StringRef Path, llvm::StringMap<IncludeGuardEntry> &Entries) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(Path);
+  if (!Buffer)
+    return true;
+
+  using namespace llvm::support;
+  StringRef Data = (*Buffer)->getBuffer();
+  if (Data.size() < sizeof(IncludeGuardDatabaseMagic) + 8 ||
+      memcmp(Data.data(), IncludeGuardDatabaseMagic,
+             sizeof(IncludeGuardDatabaseMagic)) != 0)
+    return true;
+  const char *Ptr = Data.data() + sizeof(IncludeGuardDatabaseMagic);
+  const char *End = Data.end();
+  if (endian::read32le(Ptr) != IncludeGuardDatabaseVersion)
+    return true;
+  uint32_t NumEntries = endian::read32le(Ptr + 4);
+  Ptr += 8;
+
+  for (; NumEntries; --NumEntries) {
+    if (End - Ptr < 32)
+      return true;
+    IncludeGuardEntry Entry;
+    Entry.Size = endian::read64le(Ptr);
+    Entry.ModTime = endian::read64le(Ptr + 8);
+    Entry.ContentHash = endian::read64le(Ptr + 16);
+    uint32_t PathLength = endian::read32le(Ptr + 24);
+    uint32_t MacroLength = endian::read32le(Ptr + 28);
+    Ptr += 32;
+    if (size_t(End - Ptr) < uint64_t(PathLength) + MacroLength)
+      return true;
+    StringRef Header(Ptr, PathLength);
+    Entry.ControllingMacro = StringRef(Ptr + PathLength, MacroLength);
+    Ptr += PathLength + MacroLength;
+    Entries[Header] = std::move(Entry);
+  }
+  return false;
+}
+
+/// Compute the key of \p File in the include guard database.
+static void getIncludeGuardKey(FileManager &FileMgr, const FileEntry *File,
+                               SmallVectorImpl<char> &Key) {
+  Key.assign(File->getName().begin(), File->getName().end());
+  FileMgr.makeAbsolutePath(Key);
+  llvm::sys::path::remove_dots(Key, /*remove_dot_dot=*/true);
+}
+
+void HeaderSearch::loadIncludeGuardDatabase() {
+  if (IncludeGuardsLoaded)
+    return;
+  IncludeGuardsLoaded = true;
+  if (readIncludeGuardDatabase(HSOpts->IncludeGuardDatabasePath,
+                               IncludeGuards))
+    IncludeGuards.clear();
+}
+
+const IdentifierInfo *HeaderSearch::lookupIncludeGuard(Preprocessor &PP,
+                                                       const FileEntry *File) {
+  if (HSOpts->IncludeGuardDatabasePath.empty())
+    return nullptr;
+  loadIncludeGuardDatabase();
+  if (IncludeGuards.empty())
+    return nullptr;
+
+  SmallString<256> Key;
+  getIncludeGuardKey(FileMgr, File, Key);
+  auto Known = IncludeGuards.find(Key);
+  if (Known == IncludeGuards.end())
+    return nullptr;
+  IncludeGuardEntry &Entry = Known->second;
+  if (Entry.Size != uint64_t(File->getSize())) {
+    IncludeGuards.erase(Known);
+    IncludeGuardsChanged = true;
+    return nullptr;
+  }
+
+  // A header that was touched but not changed keeps its guard.  Checking
+  // that means reading it, which is still far cheaper than lexing it.
+  if (Entry.ModTime != uint64_t(File->getModificationTime())) {
+    auto Buffer = FileMgr.getBufferForFile(File);
+    if (!Buffer ||
+        llvm::xxHash64((*Buffer)->getBuffer()) != Entry.ContentHash) {
+      IncludeGuards.erase(Known);
+      IncludeGuardsChanged = true;
+      return nullptr;
+    }
+    Entry.ModTime = File->getModificationTime();
+    IncludeGuardsChanged = true;
+  }
+
+  return PP.getIdentifierInfo(Entry.ControllingMacro);
+}
+
+void HeaderSearch::recordIncludeGuard(const FileEntry *File,
+                                      const IdentifierInfo *ControllingMacro,
+                                      StringRef Contents) {
+  if (HSOpts->IncludeGuardDatabasePath.empty())
+    return;
+  loadIncludeGuardDatabase();
+
+  SmallString<256> Key;
+  getIncludeGuardKey(FileMgr, File, Key);
+  IncludeGuardEntry &Entry = IncludeGuards[Key];
+  uint64_t Size = File->getSize();
+  uint64_t ModTime = File->getModificationTime();
+  uint64_t ContentHash = llvm::xxHash64(Contents);
+  if (Entry.ControllingMacro == ControllingMacro->getName() &&
+      Entry.Size == Size && Entry.ModTime == ModTime &&
+      Entry.ContentHash == ContentHash)
+    return;
+  Entry.ControllingMacro = ControllingMacro->getName();
+  Entry.Size = Size;
+  Entry.ModTime = ModTime;
+  Entry.ContentHash = ContentHash;
+  IncludeGuardsChanged = true;
+}
+
+bool HeaderSearch::writeIncludeGuardDatabase() {
+  if (!IncludeGuardsChanged)
+    return false;
+  StringRef Path = HSOpts->IncludeGuardDatabasePath;
+
+  // Keep the guards that other compilations wrote in the meantime.  Entries
+  // this compilation dropped as stale may come back that way; they are
+  // caught again by the size and content checks.
+  llvm::StringMap<IncludeGuardEntry> Merged;
+  if (readIncludeGuardDatabase(Path, Merged))
+    Merged.clear();
+  for (const auto &Entry : IncludeGuards)
+    Merged[Entry.getKey()] = Entry.second;
+
+  SmallString<4096> Contents;
+  {
+    using namespace llvm::support;
+    llvm::raw_svector_ostream Out(Contents);
+    Out.write(IncludeGuardDatabaseMagic, sizeof(IncludeGuardDatabaseMagic));
+    endian::Writer LE(Out, little);
+    LE.write<uint32_t>(IncludeGuardDatabaseVersion);
+    LE.write<uint32_t>(Merged.size());
+    for (const auto &Entry : Merged) {
+      LE.write<uint64_t>(Entry.second.Size);
+      LE.write<uint64_t>(Entry.second.ModTime);
+      LE.write<uint64_t>(Entry.second.ContentHash);
+      LE.write<uint32_t>(Entry.getKey().size());
+      LE.write<uint32_t>(Entry.second.ControllingMacro.size());
+      Out << Entry.getKey() << Entry.second.ControllingMacro;
+    }
+  }
+
+  StringRef Dir = llvm::sys::path::parent_path(Path);
+  if ((!Dir.empty() && llvm::sys::fs::create_directories(Dir)) ||
+      writeFileAtomically(Path, Contents))
+    return true;
+  IncludeGuardsChanged = false;
+  return false;
+}
+
 /// LookupSubframeworkHeader - Look up a subframework for the specified
 /// \#include file.  For example, if \#include'ing <HIToolbox/HIToolbox.h> from
 /// within ".../Carbon.framework/Headers/Carbon.h", check to see if HIToolbox
@@ -1249,14 +1653,24 @@ bool HeaderSearch::ShouldEnterIncludeFile(Preprocessor &PP,
 
   // Next, check to see if the file is wrapped with #ifndef guards.  If so, and
   // if the macro that guards it is defined, we know the #include has no effect.
-  if (const IdentifierInfo *ControllingMacro
-      = FileInfo.getControllingMacro(ExternalLookup)) {
+  // For a header this compilation has not entered yet, the guard may be known
+  // from an earlier compilation.
+  const IdentifierInfo *ControllingMacro =
+      FileInfo.getControllingMacro(ExternalLookup);
+  bool FromIncludeGuardDatabase = false;
+  if (!ControllingMacro && !FileInfo.NumIncludes && !M) {
+    ControllingMacro = lookupIncludeGuard(PP, File);
+    FromIncludeGuardDatabase = ControllingMacro;
+  }
+  if (ControllingMacro) {
     // If the header corresponds to a module, check whether the macro is already
     // defined in that module rather than checking in the current set of visible
     // modules.
     if (M ? PP.isMacroDefinedInLocalModule(ControllingMacro, M)
           : PP.isMacroDefined(ControllingMacro)) {
       ++NumMultiIncludeFileOptzn;
+      if (FromIncludeGuardDatabase)
+        ++NumIncludeGuardDatabaseSkips;
       return false;
     }
   }
@@ -1405,6 +1405,267 @@ Slash:
   return *Ptr;
 }
 
+//===----------------------------------------------------------------------===//
+// Vectorized byte scanning
+//===----------------------------------------------------------------------===//
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__ALTIVEC__)
+#include <altivec.h>
+#undef bool
+#endif
+
+namespace {
+
+/// A fixed-width vector of bytes, using the widest byte vector the host
+/// compiler targets.  The comment and whitespace skipping routines below are
+/// written against this interface only, so they don't care about the width or
+/// the instruction set.  Loads are unaligned and never read past the end pointer
+/// handed to scanForward.
+struct ByteVector {
+#if defined(__AVX2__)
+  static const unsigned Width = 32;
+  __m256i V;
+
+  static ByteVector load(const char *Ptr) {
+    return {_mm256_loadu_si256(reinterpret_cast<const __m256i *>(Ptr))};
+  }
+  static ByteVector splat(char C) { return {_mm256_set1_epi8(C)}; }
+  ByteVector operator==(ByteVector RHS) const {
+    return {_mm256_cmpeq_epi8(V, RHS.V)};
+  }
+  ByteVector operator|(ByteVector RHS) const {
+    return {_mm256_or_si256(V, RHS.V)};
+  }
+  ByteVector operator&(ByteVector RHS) const {
+    return {_mm256_and_si256(V, RHS.V)};
+  }
+  /// Lane-wise signed comparison.
+  ByteVector operator>(ByteVector RHS) const {
+    return {_mm256_cmpgt_epi8(V, RHS.V)};
+  }
+  ByteVector operator~() const {
+    return {_mm256_xor_si256(V, _mm256_set1_epi8(-1))};
+  }
+  uint32_t mask() const {
+    return static_cast<uint32_t>(_mm256_movemask_epi8(V));
+  }
+  bool any() const { return mask() != 0; }
+  unsigned firstSet() const { return llvm::countTrailingZeros(mask()); }
+#elif defined(__SSE2__)
+  static const unsigned Width = 16;
+  __m128i V;
+
+  static ByteVector load(const char *Ptr) {
+    return {_mm_loadu_si128(reinterpret_cast<const __m128i *>(Ptr))};
+  }
+  static ByteVector splat(char C) { return {_mm_set1_epi8(C)}; }
+  ByteVector operator==(ByteVector RHS) const {
+    return {_mm_cmpeq_epi8(V, RHS.V)};
+  }
+  ByteVector operator|(ByteVector RHS) const {
+    return {_mm_or_si128(V, RHS.V)};
+  }
+  ByteVector operator&(ByteVector RHS) const {
+    return {_mm_and_si128(V, RHS.V)};
+  }
+  /// Lane-wise signed comparison.
+  ByteVector operator>(ByteVector RHS) const {
+    return {_mm_cmpgt_epi8(V, RHS.V)};
+  }
+  ByteVector operator~() const {
+    return {_mm_xor_si128(V, _mm_set1_epi8(-1))};
+  }
+  uint32_t mask() const { return static_cast<uint32_t>(_mm_movemask_epi8(V)); }
+  bool any() const { return mask() != 0; }
+  unsigned firstSet() const { return llvm::countTrailingZeros(mask()); }
+#elif defined(__ARM_NEON)
+  static const unsigned Width = 16;
+  uint8x16_t V;
+
+  static ByteVector load(const char *Ptr) {
+    return {vld1q_u8(reinterpret_cast<const uint8_t *>(Ptr))};
+  }
+  static ByteVector splat(char C) {
+    return {vdupq_n_u8(static_cast<uint8_t>(C))};
+  }
+  ByteVector operator==(ByteVector RHS) const { return {vceqq_u8(V, RHS.V)}; }
+  ByteVector operator|(ByteVector RHS) const { return {vorrq_u8(V, RHS.V)}; }
+  ByteVector operator&(ByteVector RHS) const { return {vandq_u8(V, RHS.V)}; }
+  /// Lane-wise signed comparison.
+  ByteVector operator>(ByteVector RHS) const {
+    return {vcgtq_s8(vreinterpretq_s8_u8(V), vreinterpretq_s8_u8(RHS.V))};
+  }
+  ByteVector operator~() const { return {vmvnq_u8(V)}; }
+  /// NEON has no movemask; narrow each byte lane to a nibble instead, giving
+  /// four mask bits per byte.
+  uint64_t mask() const {
+    uint8x8_t Narrowed = vshrn_n_u16(vreinterpretq_u16_u8(V), 4);
+    return vget_lane_u64(vreinterpret_u64_u8(Narrowed), 0);
+  }
+  bool any() const { return mask() != 0; }
+  unsigned firstSet() const { return llvm::countTrailingZeros(mask()) / 4; }
+#elif defined(__ALTIVEC__)
+  static const unsigned Width = 16;
+  __vector unsigned char V;
+
+  static ByteVector load(const char *Ptr) {
+    return {vec_vsx_ld(0, reinterpret_cast<const unsigned char *>(Ptr))};
+  }
+  static ByteVector splat(char C) {
+    return {vec_splats(static_cast<unsigned char>(C))};
+  }
+  ByteVector operator==(ByteVector RHS) const {
+    return {(__vector unsigned char)vec_cmpeq(V, RHS.V)};
+  }
+  ByteVector operator|(ByteVector RHS) const { return {vec_or(V, RHS.V)}; }
+  ByteVector operator&(ByteVector RHS) const { return {vec_and(V, RHS.V)}; }
+  /// Lane-wise signed comparison.
+  ByteVector operator>(ByteVector RHS) const {
+    return {(__vector unsigned char)vec_cmpgt((__vector signed char)V,
+                                              (__vector signed char)RHS.V)};
+  }
+  ByteVector operator~() const { return {vec_nor(V, V)}; }
+  bool any() const { return !vec_all_eq(V, vec_splats((unsigned char)0)); }
+  unsigned firstSet() const {
+    alignas(16) unsigned char Lanes[Width];
+    vec_st(V, 0, Lanes);
+    unsigned I = 0;
+    while (!Lanes[I])
+      ++I;
+    return I;
+  }
+#else
+  // No vector unit: a single-lane "vector" keeps the scanners below generic,
+  // and scanForward skips the chunked loop entirely.
+  static const unsigned Width = 1;
+  unsigned char V;
+
+  static ByteVector load(const char *Ptr) {
+    return {static_cast<unsigned char>(*Ptr)};
+  }
+  static ByteVector splat(char C) { return {static_cast<unsigned char>(C)}; }
+  ByteVector operator==(ByteVector RHS) const {
+    return {static_cast<unsigned char>(V == RHS.V ? 0xFF : 0)};
+  }
+  ByteVector operator|(ByteVector RHS) const {
+    return {static_cast<unsigned char>(V | RHS.V)};
+  }
+  ByteVector operator&(ByteVector RHS) const {
+    return {static_cast<unsigned char>(V & RHS.V)};
+  }
+  ByteVector operator>(ByteVector RHS) const {
+    return {static_cast<unsigned char>(
+        static_cast<signed char>(V) > static_cast<signed char>(RHS.V) ? 0xFF
+                                                                      : 0)};
+  }
+  ByteVector operator~() const { return {static_cast<unsigned char>(~V)}; }
+  bool any() const { return V != 0; }
+  unsigned firstSet() const { return 0; }
+#endif
+};
+
+} // namespace
+
+/// Return a pointer to the first byte in [Ptr, End) for which the scalar
+/// predicate \p IsStop holds, or End if there is none.  \p VecIsStop is the
+/// vector form of the same predicate; it is applied to whole ByteVector::Width
+/// sized chunks and must return a vector with all bits set in the lanes that
+/// hold a stop byte.
+template <typename VectorPredicate, typename ScalarPredicate>
+static inline const char *scanForward(const char *Ptr, const char *End,
+                                      VectorPredicate VecIsStop,
+                                      ScalarPredicate IsStop) {
+  if (ByteVector::Width > 1) {
+    // Most runs are short, so check a few bytes before going wide.
+    for (unsigned I = 0; I != 4; ++I, ++Ptr)
+      if (Ptr == End || IsStop(*Ptr))
+        return Ptr;
+
+    while (End - Ptr >= (ptrdiff_t)ByteVector::Width) {
+      ByteVector Stops = VecIsStop(ByteVector::load(Ptr));
+      if (Stops.any())
+        return Ptr + Stops.firstSet();
+      Ptr += ByteVector::Width;
+    }
+  }
+  while (Ptr != End && !IsStop(*Ptr))
+    ++Ptr;
+  return Ptr;
+}
+
+/// Skip horizontal whitespace (' ', '\\t', '\\f', '\\v') starting at Ptr.
+static const char *skipHorizontalWhitespace(const char *Ptr, const char *End) {
+  return scanForward(
+      Ptr, End,
+      [](ByteVector V) {
+        return ~((V == ByteVector::splat(' ')) |
+                 (V == ByteVector::splat('\t')) |
+                 (V == ByteVector::splat('\f')) |
+                 (V == ByteVector::splat('\v')));
+      },
+      [](char C) { return !isHorizontalWhitespace(C); });
+}
+
+/// Find the end of the current physical line: the first '\\n', '\\r' or nul
+/// at or after Ptr.  Escaped newlines are left to the caller.
+static const char *findEndOfPhysicalLine(const char *Ptr, const char *End) {
+  return scanForward(
+      Ptr, End,
+      [](ByteVector V) {
+        return (V == ByteVector::splat('\n')) |
+               (V == ByteVector::splat('\r')) | (V == ByteVector::splat('\0'));
+      },
+      [](char C) { return C == '\n' || C == '\r' || C == '\0'; });
+}
+
+/// Find the first '/' at or after Ptr.  This is the candidate terminator of a
+/// block comment; note that nul bytes are not stop characters.
+static const char *findSlash(const char *Ptr, const char *End) {
+  return scanForward(
+      Ptr, End, [](ByteVector V) { return V == ByteVector::splat('/'); },
+      [](char C) { return C == '/'; });
+}
+
+/// Return all bits set in the lanes of \p V that hold a byte in [Lo, Hi].
+/// Both bounds must be ASCII; non-ASCII bytes compare as negative and are
+/// never in range.
+static inline ByteVector inRange(ByteVector V, char Lo, char Hi) {
+  return (V > ByteVector::splat(Lo - 1)) & (ByteVector::splat(Hi + 1) > V);
+}
+
+/// Vector form of isIdentifierBody: [a-zA-Z0-9_].  Folding to lowercase by
+/// setting bit 5 only maps other bytes onto letters if they were already
+/// letters, so one range check covers both cases.
+static inline ByteVector isIdentifierBodyVector(ByteVector V) {
+  return inRange(V | ByteVector::splat(0x20), 'a', 'z') |
+         inRange(V, '0', '9') | (V == ByteVector::splat('_'));
+}
+
+/// Find the end of the run of [a-zA-Z0-9_] starting at Ptr.  Anything else,
+/// including '$', '\\', '?' and non-ASCII bytes, stops the scan so that the
+/// caller's slow path can decide what to do with it.
+static const char *findEndOfIdentifierBody(const char *Ptr, const char *End) {
+  return scanForward(
+      Ptr, End, [](ByteVector V) { return ~isIdentifierBodyVector(V); },
+      [](char C) { return !isIdentifierBody(C); });
+}
+
+/// Find the end of the run of [a-zA-Z0-9_.] starting at Ptr.
+static const char *findEndOfNumberBody(const char *Ptr, const char *End) {
+  return scanForward(
+      Ptr, End,
+      [](ByteVector V) {
+        return ~(isIdentifierBodyVector(V) | (V == ByteVector::splat('.')));
+      },
+      [](char C) { return !isPreprocessingNumberBody(C); });
+}
+
 //===----------------------------------------------------------------------===//
 // Helper methods for lexing.
 //===----------------------------------------------------------------------===//
@@ -1630,11 +1891,8 @@ bool Lexer::tryConsumeIdentifierUTF8Char(const char *&CurPtr) {
 bool Lexer::LexIdentifier(Token &Result, const char *CurPtr) {
   // Match [_A-Za-z0-9]*, we have already matched [_A-Za-z$]
   unsigned Size;
-  unsigned char C = *CurPtr++;
-  while (isIdentifierBody(C))
-    C = *CurPtr++;
-
-  --CurPtr;   // Back up over the skipped character.
+  CurPtr = findEndOfIdentifierBody(CurPtr, BufferEnd);
+  unsigned char C = *CurPtr;
 
   // Fast path, no $,\,? in identifier found.  '\' might be an escaped newline
   // or UCN, and ? might be a trigraph for '\', an escaped newline or UCN.
@@ -1742,8 +2000,17 @@ bool Lexer::isHexaLiteral(const char *Start, const LangOptions &LangOpts) {
 /// constant.
 bool Lexer::LexNumericConstant(Token &Result, const char *CurPtr) {
   unsigned Size;
-  char C = getCharAndSize(CurPtr, Size);
   char PrevCh = 0;
+
+  // Skip the plain part of the number in one go.  None of these characters
+  // can start a trigraph or an escaped newline, so they're all single-byte.
+  const char *RunEnd = findEndOfNumberBody(CurPtr, BufferEnd);
+  if (RunEnd != CurPtr) {
+    PrevCh = RunEnd[-1];
+    CurPtr = RunEnd;
+  }
+
+  char C = getCharAndSize(CurPtr, Size);
   while (isPreprocessingNumberBody(C)) {
     CurPtr = ConsumeChar(CurPtr, Size, Result);
     PrevCh = C;
@@ -2185,8 +2452,8 @@ bool Lexer::SkipWhitespace(Token &Result, const char *CurPtr,
   // Skip consecutive spaces efficiently.
   while (true) {
     // Skip horizontal whitespace very aggressively.
-    while (isHorizontalWhitespace(Char))
-      Char = *++CurPtr;
+    CurPtr = skipHorizontalWhitespace(CurPtr, BufferEnd);
+    Char = *CurPtr;
 
     // Otherwise if we have something other than whitespace, we're done.
     if (!isVerticalWhitespace(Char))
@@ -2254,11 +2521,10 @@ bool Lexer::SkipLineComment(Token &Result, const char *CurPtr,
   // character that ends the line comment.
   char C;
   while (true) {
+    // Skip over characters in the fast loop, stopping at a newline, a DOS-style
+    // newline, or a nul that is potentially EOF.
+    CurPtr = findEndOfPhysicalLine(CurPtr, BufferEnd);
     C = *CurPtr;
-    // Skip over characters in the fast loop.
-    while (C != 0 &&                // Potentially EOF.
-           C != '\n' && C != '\r')  // Newline or DOS-style newline.
-      C = *++CurPtr;
 
     const char *NextLine = CurPtr;
     if (C != 0) {
@@ -2461,13 +2727,6 @@ static bool isEndOfBlockCommentWithEscapedNewLine(const char *CurPtr,
   return true;
 }
 
-#ifdef __SSE2__
-#include <emmintrin.h>
-#elif __ALTIVEC__
-#include <altivec.h>
-#undef bool
-#endif
-
 /// We have just read from input the / and * characters that started a comment.
 /// Read until we find the * and / characters that terminate the comment.
 /// Note that we don't bother decoding trigraphs or escaped newlines in block
@@ -2518,44 +2777,10 @@ bool Lexer::SkipBlockComment(Token &Result, const char *CurPtr,
         // If there is a code-completion point avoid the fast scan because it
         // doesn't check for '\0'.
         !(PP && PP->getCodeCompletionFileLoc() == FileLoc)) {
-      // While not aligned to a 16-byte boundary.
-      while (C != '/' && ((intptr_t)CurPtr & 0x0F) != 0)
-        C = *CurPtr++;
-
       if (C == '/') goto FoundSlash;
 
-#ifdef __SSE2__
-      __m128i Slashes = _mm_set1_epi8('/');
-      while (CurPtr+16 <= BufferEnd) {
-        int cmp = _mm_movemask_epi8(_mm_cmpeq_epi8(*(const __m128i*)CurPtr,
-                                    Slashes));
-        if (cmp != 0) {
-          // Adjust the pointer to point directly after the first slash. It's
-          // not necessary to set C here, it will be overwritten at the end of
-          // the outer loop.
-          CurPtr += llvm::countTrailingZeros<unsigned>(cmp) + 1;
-          goto FoundSlash;
-        }
-        CurPtr += 16;
-      }
-#elif __ALTIVEC__
-      __vector unsigned char Slashes = {
-        '/', '/', '/', '/',  '/', '/', '/', '/',
-        '/', '/', '/', '/',  '/', '/', '/', '/'
-      };
-      while (CurPtr+16 <= BufferEnd &&
-             !vec_any_eq(*(const vector unsigned char*)CurPtr, Slashes))
-        CurPtr += 16;
-#else
       // Scan for '/' quickly.  Many block comments are very large.
-      while (CurPtr[0] != '/' &&
-             CurPtr[1] != '/' &&
-             CurPtr[2] != '/' &&
-             CurPtr[3] != '/' &&
-             CurPtr+4 < BufferEnd) {
-        CurPtr += 4;
-      }
-#endif
+      CurPtr = findSlash(CurPtr, BufferEnd);
 
       // It has to be one of the bytes scanned, increment to it and read one.
       C = *CurPtr++;
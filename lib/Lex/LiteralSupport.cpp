@@ -27,6 +27,7 @@
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Support/ConvertUTF.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/MathExtras.h"
 #include <algorithm>
 #include <cassert>
 #include <cstddef>
@@ -973,6 +974,23 @@ static bool alwaysFitsInto64Bits(unsigned Radix, unsigned NumDigits) {
   }
 }
 
+/// The number of digits in this radix that are converted to a uint64_t at a
+/// time. Radix to this power still fits into a uint64_t.
+static unsigned getDigitsPerChunk(unsigned Radix) {
+  switch (Radix) {
+  case 2:
+    return 63;
+  case 8:
+    return 21;
+  case 10:
+    return 19;
+  case 16:
+    return 15;
+  default:
+    llvm_unreachable("impossible Radix");
+  }
+}
+
 /// GetIntegerValue - Convert this numeric literal value to an APInt that
 /// matches Val's input width.  If there is an overflow, set Val to the low bits
 /// of the result and return true.  Otherwise, return false.
@@ -996,40 +1014,54 @@ bool NumericLiteralParser::GetIntegerValue(llvm::APInt &Val) {
     return Val.getZExtValue() != N;
   }
 
-  Val = 0;
-  const char *Ptr = DigitsBegin;
-
-  llvm::APInt RadixVal(Val.getBitWidth(), radix);
-  llvm::APInt CharVal(Val.getBitWidth(), 0);
-  llvm::APInt OldVal = Val;
+  // Values that still fit into a uint64_t, such as those close to its maximum
+  // or those with digit separators or leading zeros, only need the overflow
+  // checks of uint64_t arithmetic.
+  uint64_t N = 0;
+  bool Overflowed = false;
+  for (const char *Ptr = DigitsBegin; Ptr != SuffixBegin && !Overflowed; ++Ptr)
+    if (!isDigitSeparator(*Ptr))
+      N = llvm::SaturatingMultiplyAdd<uint64_t>(
+          N, radix, llvm::hexDigitValue(*Ptr), &Overflowed);
+  if (!Overflowed) {
+    Val = N;
+    return Val.getZExtValue() != N;
+  }
 
+  // Otherwise, convert a chunk of digits at a time into a uint64_t, and only
+  // do APInt arithmetic once per chunk. The conversion is done in at least 64
+  // bits so that a chunk always fits, and truncated to Val's width at the end.
+  const unsigned Width = std::max(Val.getBitWidth(), 64u);
+  const unsigned DigitsPerChunk = getDigitsPerChunk(radix);
+  llvm::APInt Result(Width, 0);
   bool OverflowOccurred = false;
-  while (Ptr < SuffixBegin) {
-    if (isDigitSeparator(*Ptr)) {
-      ++Ptr;
-      continue;
+  const char *Ptr = DigitsBegin;
+  while (Ptr != SuffixBegin) {
+    uint64_t Chunk = 0;
+    uint64_t Scale = 1;
+    for (unsigned Digits = 0; Ptr != SuffixBegin && Digits != DigitsPerChunk;
+         ++Ptr) {
+      if (isDigitSeparator(*Ptr))
+        continue;
+      unsigned C = llvm::hexDigitValue(*Ptr);
+
+      // If this letter is out of bound for this radix, reject it.
+      assert(C < radix && "NumericLiteralParser ctor should have rejected this");
+
+      Chunk = Chunk * radix + C;
+      Scale *= radix;
+      ++Digits;
     }
 
-    unsigned C = llvm::hexDigitValue(*Ptr++);
-
-    // If this letter is out of bound for this radix, reject it.
-    assert(C < radix && "NumericLiteralParser ctor should have rejected this");
-
-    CharVal = C;
-
-    // Add the digit to the value in the appropriate radix.  If adding in digits
-    // made the value smaller, then this overflowed.
-    OldVal = Val;
-
-    // Multiply by radix, did overflow occur on the multiply?
-    Val *= RadixVal;
-    OverflowOccurred |= Val.udiv(RadixVal) != OldVal;
-
-    // Add value, did overflow occur on the value?
-    //   (a + b) ult b  <=> overflow
-    Val += CharVal;
-    OverflowOccurred |= Val.ult(CharVal);
+    bool Overflow;
+    Result = Result.umul_ov(llvm::APInt(Width, Scale), Overflow);
+    OverflowOccurred |= Overflow;
+    Result = Result.uadd_ov(llvm::APInt(Width, Chunk), Overflow);
+    OverflowOccurred |= Overflow;
   }
+
+  OverflowOccurred |= !Result.isIntN(Val.getBitWidth());
+  Val = Result.zextOrTrunc(Val.getBitWidth());
   return OverflowOccurred;
 }
 
@@ -1469,6 +1501,7 @@ void StringLiteralParser::init(ArrayRef<Token> StringToks){
   // literal, the result is a wide-string literal [C99 6.4.5p4].
   assert(!StringToks.empty() && "expected at least one token");
   MaxTokenLength = StringToks[0].getLength();
+  bool AnyNeedsCleaning = StringToks[0].needsCleaning();
   assert(StringToks[0].getLength() >= 2 && "literal token is invalid!");
   SizeBound = StringToks[0].getLength()-2;  // -2 for "".
   Kind = StringToks[0].getKind();
@@ -1489,6 +1522,7 @@ void StringLiteralParser::init(ArrayRef<Token> StringToks){
     // Remember maximum string piece length.
     if (StringToks[i].getLength() > MaxTokenLength)
       MaxTokenLength = StringToks[i].getLength();
+    AnyNeedsCleaning |= StringToks[i].needsCleaning();
 
     // Remember if we see any wide or utf-8/16/32 strings.
     // Also check for illegal concatenations.
@@ -1521,9 +1555,11 @@ void StringLiteralParser::init(ArrayRef<Token> StringToks){
   // Size the temporary buffer to hold the result string data.
   ResultBuf.resize(SizeBound);
 
-  // Likewise, but for each string piece.
+  // Likewise, but for each string piece. The spelling of a piece that needs
+  // no cleaning is read from the source buffer, without a copy.
   SmallString<512> TokenBuf;
-  TokenBuf.resize(MaxTokenLength);
+  if (AnyNeedsCleaning)
+    TokenBuf.resize(MaxTokenLength);
 
   // Loop over all the strings, getting their spelling, and expanding them to
   // wide strings as appropriate.
@@ -1534,7 +1570,7 @@ void StringLiteralParser::init(ArrayRef<Token> StringToks){
   SourceLocation UDSuffixTokLoc;
 
   for (unsigned i = 0, e = StringToks.size(); i != e; ++i) {
-    const char *ThisTokBuf = &TokenBuf[0];
+    const char *ThisTokBuf = TokenBuf.data();
     // Get the spelling of the token, which eliminates trigraphs, etc.  We know
     // that ThisTokBuf points to a buffer that is big enough for the whole token
     // and 'spelled' tokens can only shrink.
@@ -1657,9 +1693,10 @@ void StringLiteralParser::init(ArrayRef<Token> StringToks){
         // Is this a span of non-escape characters?
         if (ThisTokBuf[0] != '\\') {
           const char *InStart = ThisTokBuf;
-          do {
-            ++ThisTokBuf;
-          } while (ThisTokBuf != ThisTokEnd && ThisTokBuf[0] != '\\');
+          ThisTokBuf = static_cast<const char *>(
+              memchr(ThisTokBuf, '\\', ThisTokEnd - ThisTokBuf));
+          if (!ThisTokBuf)
+            ThisTokBuf = ThisTokEnd;
 
           // Copy the character span over.
           if (CopyStringFragment(StringToks[i], ThisTokBegin,
@@ -1750,12 +1787,36 @@ static const char *resyncUTF8(const char *Err, const char *End) {
   return Err;
 }
 
+/// Returns true if every character of \p Str is ASCII, testing eight of them
+/// at a time.
+static bool isAllASCII(StringRef Str) {
+  const char *Ptr = Str.begin(), *End = Str.end();
+  for (; End - Ptr >= 8; Ptr += 8) {
+    uint64_t Word;
+    memcpy(&Word, Ptr, sizeof(Word));
+    if (Word & UINT64_C(0x8080808080808080))
+      return false;
+  }
+  for (; Ptr != End; ++Ptr)
+    if (!isASCII(*Ptr))
+      return false;
+  return true;
+}
+
 /// This function copies from Fragment, which is a sequence of bytes
 /// within Tok's contents (which begin at TokBegin) into ResultPtr.
 /// Performs widening for multi-byte characters.
 bool StringLiteralParser::CopyStringFragment(const Token &Tok,
                                              const char *TokBegin,
                                              StringRef Fragment) {
+  // ASCII is valid UTF-8 that a narrow string holds as is, which is the
+  // common case of generated tables.
+  if (CharByteWidth == 1 && isAllASCII(Fragment)) {
+    memcpy(ResultPtr, Fragment.data(), Fragment.size());
+    ResultPtr += Fragment.size();
+    return false;
+  }
+
   const llvm::UTF8 *ErrorPtrTmp;
   if (ConvertUTF8toWide(CharByteWidth, Fragment, ResultPtr, ErrorPtrTmp))
     return false;
@@ -71,6 +71,8 @@ MacroArgs *MacroArgs::create(const MacroInfo *MI,
               Result->getTrailingObjects<Token>());
   }
 
+  PP.MaxNumLiveMacroArgs =
+      std::max(PP.MaxNumLiveMacroArgs, ++PP.NumLiveMacroArgs);
   return Result;
 }
 
@@ -78,15 +80,17 @@ MacroArgs *MacroArgs::create(const MacroInfo *MI,
 ///
 void MacroArgs::destroy(Preprocessor &PP) {
   StringifiedArgs.clear();
-
-  // Don't clear PreExpArgTokens, just clear the entries.  Clearing the entries
-  // would deallocate the element vectors.
-  for (unsigned i = 0, e = PreExpArgTokens.size(); i != e; ++i)
-    PreExpArgTokens[i].clear();
+  PreExpArgTokens.clear();
 
   // Add this to the preprocessor's free list.
   ArgCache = PP.MacroArgCache;
   PP.MacroArgCache = this;
+
+  // Once the outermost function-like macro expansion is done, nothing refers
+  // to the pre-expanded arguments any more; recycle their memory.
+  assert(PP.NumLiveMacroArgs && "Unbalanced MacroArgs create/destroy");
+  if (--PP.NumLiveMacroArgs == 0)
+    PP.MacroArgArena.Reset();
 }
 
 /// deallocate - This should only be called by the Preprocessor when managing
@@ -164,35 +168,38 @@ bool MacroArgs::ArgNeedsPreexpansion(const Token *ArgTok,
 
 /// getPreExpArgument - Return the pre-expanded form of the specified
 /// argument.
-const std::vector<Token> &MacroArgs::getPreExpArgument(unsigned Arg,
-                                                       Preprocessor &PP) {
+ArrayRef<Token> MacroArgs::getPreExpArgument(unsigned Arg, Preprocessor &PP) {
   assert(Arg < getNumMacroArguments() && "Invalid argument number!");
 
   // If we have already computed this, return it.
   if (PreExpArgTokens.size() < getNumMacroArguments())
     PreExpArgTokens.resize(getNumMacroArguments());
 
-  std::vector<Token> &Result = PreExpArgTokens[Arg];
-  if (!Result.empty()) return Result;
+  if (!PreExpArgTokens[Arg].empty())
+    return PreExpArgTokens[Arg];
 
   SaveAndRestore<bool> PreExpandingMacroArgs(PP.InMacroArgPreExpansion, true);
 
   const Token *AT = getUnexpArgument(Arg);
   unsigned NumToks = getArgLength(AT)+1;  // Include the EOF.
 
-  // Otherwise, we have to pre-expand this argument, populating Result.  To do
-  // this, we set up a fake TokenLexer to lex from the unexpanded argument
-  // list.  With this installed, we lex expanded tokens until we hit the EOF
-  // token at the end of the unexp list.
+  // Otherwise, we have to pre-expand this argument.  To do this, we set up a
+  // fake TokenLexer to lex from the unexpanded argument list.  With this
+  // installed, we lex expanded tokens until we hit the EOF token at the end of
+  // the unexp list.
   PP.EnterTokenStream(AT, NumToks, false /*disable expand*/,
                       false /*owns tokens*/);
 
-  // Lex all of the macro-expanded tokens into Result.
+  // Lex all of the macro-expanded tokens onto the end of the scratch buffer.
+  // Pre-expansions of nested macro arguments append after ours and are gone
+  // again before we see our EOF, so nothing is moved from under us.
+  SmallVectorImpl<Token> &Scratch = PP.MacroArgPreExpansionBuffer;
+  size_t ScratchStart = Scratch.size();
+  Token Tok;
   do {
-    Result.push_back(Token());
-    Token &Tok = Result.back();
     PP.Lex(Tok);
-  } while (Result.back().isNot(tok::eof));
+    Scratch.push_back(Tok);
+  } while (Tok.isNot(tok::eof));
 
   // Pop the token stream off the top of the stack.  We know that the internal
   // pointer inside of it is to the "end" of the token stream, but the stack
@@ -202,7 +209,17 @@ const std::vector<Token> &MacroArgs::getPreExpArgument(unsigned Arg,
   if (PP.InCachingLexMode())
     PP.ExitCachingLexMode();
   PP.RemoveTopOfLexerStack();
-  return Result;
+
+  // Move the tokens into the arena, which keeps them for as long as the
+  // outermost macro expansion is in progress.
+  size_t NumExpanded = Scratch.size() - ScratchStart;
+  Token *Result = PP.MacroArgArena.Allocate<Token>(NumExpanded);
+  std::copy(Scratch.begin() + ScratchStart, Scratch.end(), Result);
+  Scratch.resize(ScratchStart);
+  PP.NumPreExpandedArgTokens += NumExpanded;
+
+  PreExpArgTokens[Arg] = makeArrayRef(Result, NumExpanded);
+  return PreExpArgTokens[Arg];
 }
 
 
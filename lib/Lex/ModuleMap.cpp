@@ -761,9 +761,11 @@ ModuleMap::isHeaderUnavailableInModule(const FileEntry *Header,
 }
 
 Module *ModuleMap::findModule(StringRef Name) const {
-  llvm::StringMap<Module *>::const_iterator Known = Modules.find(Name);
-  if (Known != Modules.end())
-    return Known->getValue();
+  do {
+    llvm::StringMap<Module *>::const_iterator Known = Modules.find(Name);
+    if (Known != Modules.end())
+      return Known->getValue();
+  } while (parsePendingModuleDecls(Name));
 
   return nullptr;
 }
@@ -1137,6 +1139,8 @@ void ModuleMap::addUnresolvedHeader(Module *Mod,
 }
 
 void ModuleMap::resolveHeaderDirectives(const FileEntry *File) const {
+  parsePendingModuleDeclsForHeader(File);
+
   auto BySize = LazyHeadersBySize.find(File->getSize());
   if (BySize != LazyHeadersBySize.end()) {
     for (auto *M : BySize->second)
@@ -1451,6 +1455,9 @@ namespace clang {
     }
 
     bool parseModuleMapFile();
+    bool scanModuleMapFile(
+        SmallVectorImpl<std::pair<std::string, SourceLocation>> &Decls);
+    bool parseTopLevelModuleDecl();
 
     bool terminatedByDirective() { return false; }
     SourceLocation getLocation() { return Tok.getLocation(); }
@@ -2939,6 +2946,224 @@ bool ModuleMapParser::parseModuleMapFile() {
   } while (true);
 }
 
+/// Scan a module map file without parsing it, recording the location of each
+/// top-level module declaration along with the name of the module it
+/// declares.  Declarations that cannot be found by name, or whose headers
+/// might live outside the module map's directory, are recorded with an empty
+/// name and must be parsed right away.
+///
+/// \returns false if the file contains something other than well-formed
+/// module declarations, or a token that cannot be lexed, in which case it must be parsed eagerly so that the
+/// problem is diagnosed.
+bool ModuleMapParser::scanModuleMapFile(
+    SmallVectorImpl<std::pair<std::string, SourceLocation>> &Decls) {
+  while (!Tok.is(MMToken::EndOfFile)) {
+    SourceLocation DeclLoc = Tok.getLocation();
+
+    // 'extern module' pulls in another module map file, which may declare
+    // any module; read it now so its own declarations get indexed.
+    bool Eager = Tok.is(MMToken::ExternKeyword);
+    if (Eager)
+      consumeToken();
+    else if (Tok.is(MMToken::FrameworkKeyword))
+      consumeToken();
+
+    if (!Tok.is(MMToken::ModuleKeyword))
+      return false;
+    consumeToken();
+
+    // Inferred framework modules ('module *') have no name to look up.
+    std::string Name;
+    if (Tok.is(MMToken::Identifier) || Tok.is(MMToken::StringLiteral))
+      Name = Tok.getString();
+    else if (!Tok.is(MMToken::Star))
+      return false;
+    consumeToken();
+
+    if (Eager) {
+      if (!Tok.is(MMToken::StringLiteral))
+        return false;
+      consumeToken();
+      Decls.emplace_back(std::string(), DeclLoc);
+      continue;
+    }
+
+    // Skip the rest of the module-id and the attributes.
+    while (!Tok.is(MMToken::LBrace)) {
+      if (Tok.is(MMToken::EndOfFile) || Tok.is(MMToken::RBrace))
+        return false;
+      consumeToken();
+    }
+
+    // Skip the module body.
+    unsigned Depth = 0;
+    do {
+      switch (Tok.Kind) {
+      case MMToken::LBrace:
+        ++Depth;
+        break;
+      case MMToken::RBrace:
+        --Depth;
+        break;
+      case MMToken::EndOfFile:
+        return false;
+      case MMToken::StringLiteral: {
+        // A header that is not below the module map's directory would not be
+        // found by parsePendingModuleDeclsForHeader.
+        StringRef FileName = Tok.getString();
+        if (llvm::sys::path::is_absolute(FileName) || FileName.contains(".."))
+          Eager = true;
+        break;
+      }
+      default:
+        break;
+      }
+      consumeToken();
+    } while (Depth);
+
+    Decls.emplace_back(Eager ? std::string() : Name, DeclLoc);
+  }
+
+  return !HadError;
+}
+
+/// Parse the single module declaration that starts at the current token.
+bool ModuleMapParser::parseTopLevelModuleDecl() {
+  assert((Tok.is(MMToken::ExternKeyword) ||
+          Tok.is(MMToken::FrameworkKeyword) ||
+          Tok.is(MMToken::ModuleKeyword)) &&
+         "not at a module declaration");
+  parseModuleDecl();
+  return HadError;
+}
+
+bool ModuleMap::indexModuleMapFile(const FileEntry *File, bool IsSystem,
+                                   const DirectoryEntry *Dir, FileID ID) {
+  const llvm::MemoryBuffer *Buffer = SourceMgr.getBuffer(ID);
+  Lexer L(SourceMgr.getLocForStartOfFile(ID), MMapLangOpts,
+          Buffer->getBufferStart(), Buffer->getBufferStart(),
+          Buffer->getBufferEnd());
+  SmallVector<std::pair<std::string, SourceLocation>, 8> Decls;
+  {
+    // A malformed token makes us fall back to an eager parse, which reports
+    // it; don't report it twice.
+    bool SuppressedDiags = Diags.getSuppressAllDiagnostics();
+    Diags.setSuppressAllDiagnostics(true);
+    ModuleMapParser Parser(L, SourceMgr, Target, Diags, *this, File, Dir,
+                           IsSystem);
+    bool Indexed = Parser.scanModuleMapFile(Decls);
+    Diags.setSuppressAllDiagnostics(SuppressedDiags);
+    if (!Indexed)
+      return false;
+  }
+
+  ParsedModuleMap[File] = false;
+  SmallVector<unsigned, 2> EagerDecls;
+  for (const auto &D : Decls) {
+    unsigned Index = PendingModuleDecls.size();
+    PendingModuleDecl Pending;
+    Pending.Loc = D.second;
+    Pending.ModuleMapFile = File;
+    Pending.Directory = Dir;
+    Pending.ScopeID = CurrentModuleScopeID;
+    Pending.IsSystem = IsSystem;
+    Pending.Parsed = false;
+    PendingModuleDecls.push_back(Pending);
+
+    if (D.first.empty()) {
+      EagerDecls.push_back(Index);
+      continue;
+    }
+    PendingModuleDeclsByName[D.first].push_back(Index);
+    PendingModuleDeclsByDir[Dir].push_back(Index);
+  }
+
+  for (unsigned Index : EagerDecls)
+    parsePendingModuleDecl(Index);
+  return true;
+}
+
+void ModuleMap::parsePendingModuleDecl(unsigned Index) const {
+  // Parsing may read more module map files; don't hold on to a reference.
+  PendingModuleDecl Decl = PendingModuleDecls[Index];
+  if (Decl.Parsed)
+    return;
+  PendingModuleDecls[Index].Parsed = true;
+
+  FileID ID;
+  unsigned Offset;
+  std::tie(ID, Offset) = SourceMgr.getDecomposedLoc(Decl.Loc);
+  const llvm::MemoryBuffer *Buffer = SourceMgr.getBuffer(ID);
+  Lexer L(SourceMgr.getLocForStartOfFile(ID), MMapLangOpts,
+          Buffer->getBufferStart(), Buffer->getBufferStart() + Offset,
+          Buffer->getBufferEnd());
+
+  // This operation is logically const; the module map file has already been
+  // read, we're only materializing the modules it declares.
+  ModuleMap &Self = *const_cast<ModuleMap *>(this);
+  ModuleMapParser Parser(L, SourceMgr, Target, Diags, Self,
+                         Decl.ModuleMapFile, Decl.Directory, Decl.IsSystem);
+
+  // Declare the module in the scope of its module map file, so that it
+  // shadows and is shadowed just as if it had been parsed eagerly.
+  unsigned SavedScopeID = Self.CurrentModuleScopeID;
+  Self.CurrentModuleScopeID = Decl.ScopeID;
+  if (Parser.parseTopLevelModuleDecl())
+    Self.ParsedModuleMap[Decl.ModuleMapFile] = true;
+  Self.CurrentModuleScopeID = SavedScopeID;
+}
+
+bool ModuleMap::parsePendingModuleDecls(StringRef Name) const {
+  auto Known = PendingModuleDeclsByName.find(Name);
+  if (Known == PendingModuleDeclsByName.end())
+    return false;
+
+  SmallVector<unsigned, 1> Indices = std::move(Known->second);
+  PendingModuleDeclsByName.erase(Known);
+  for (unsigned Index : Indices)
+    parsePendingModuleDecl(Index);
+  return true;
+}
+
+void ModuleMap::parsePendingModuleDeclsForHeader(const FileEntry *File) const {
+  if (PendingModuleDeclsByDir.empty())
+    return;
+
+  // Any module map may name a builtin header.
+  const DirectoryEntry *Dir = File->getDir();
+  if (Dir == BuiltinIncludeDir) {
+    parseAllPendingModuleDecls();
+    return;
+  }
+
+  // Otherwise only the modules declared by module map files in this
+  // directory or one of its parents can own the header.
+  StringRef DirName = Dir->getName();
+  do {
+    auto Known = PendingModuleDeclsByDir.find(Dir);
+    if (Known != PendingModuleDeclsByDir.end()) {
+      SmallVector<unsigned, 2> Indices = std::move(Known->second);
+      PendingModuleDeclsByDir.erase(Known);
+      for (unsigned Index : Indices)
+        parsePendingModuleDecl(Index);
+    }
+
+    DirName = llvm::sys::path::parent_path(DirName);
+    if (DirName.empty())
+      break;
+
+    Dir = SourceMgr.getFileManager().getDirectory(DirName);
+  } while (Dir);
+}
+
+void ModuleMap::parseAllPendingModuleDecls() const {
+  // Parsing may append more declarations; they are handled too.
+  for (unsigned Index = 0; Index != PendingModuleDecls.size(); ++Index)
+    parsePendingModuleDecl(Index);
+  PendingModuleDeclsByName.clear();
+  PendingModuleDeclsByDir.clear();
+}
+
 bool ModuleMap::parseModuleMapFile(const FileEntry *File, bool IsSystem,
                                    const DirectoryEntry *Dir, FileID ID,
                                    unsigned *Offset,
@@ -2963,6 +3188,17 @@ bool ModuleMap::parseModuleMapFile(const FileEntry *File, bool IsSystem,
   assert((!Offset || *Offset <= Buffer->getBufferSize()) &&
          "invalid buffer offset");
 
+  // In lazy mode, only record where the module declarations are.  A module
+  // map embedded in another file (Offset != nullptr) is always parsed, since
+  // the caller needs to know where it ends.
+  if (HeaderInfo.getHeaderSearchOpts().LazyModuleMaps && !Offset &&
+      indexModuleMapFile(File, IsSystem, Dir, ID)) {
+    for (const auto &Cb : Callbacks)
+      Cb->moduleMapFileRead(SourceMgr.getLocForStartOfFile(ID), *File,
+                            IsSystem);
+    return false;
+  }
+
   // Parse this module map file.
   Lexer L(SourceMgr.getLocForStartOfFile(ID), MMapLangOpts,
           Buffer->getBufferStart(),
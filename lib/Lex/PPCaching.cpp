@@ -24,6 +24,7 @@ using namespace clang;
 // be called multiple times and CommitBacktrackedTokens/Backtrack calls will
 // be combined with the EnableBacktrackAtThisPos calls in reverse order.
 void Preprocessor::EnableBacktrackAtThisPos() {
+  compactCachedTokens();
   BacktrackPositions.push_back(CachedLexPos);
   EnterCachingLexMode();
 }
@@ -104,6 +105,27 @@ void Preprocessor::CachingLex(Token &Result) {
   }
 }
 
+// Drop the cached tokens that have already been consumed and that no
+// backtrack position can return to.  This keeps the cache from growing
+// without bound when the parser keeps looking ahead, or keeps starting
+// tentative parses, without ever consuming all cached tokens.
+//
+// The most recently consumed token is kept, since IsPreviousCachedToken and
+// friends inspect it.  The unconsumed tokens are only moved when there are
+// no more of them than there are dropped tokens, so the cost of compacting
+// is amortized over the tokens that were consumed.
+void Preprocessor::compactCachedTokens() {
+  if (isBacktrackEnabled() || CachedTokenRangeToErase || CachedLexPos < 2)
+    return;
+
+  CachedTokensTy::size_type NumDropped = CachedLexPos - 1;
+  if (CachedTokens.size() - CachedLexPos > NumDropped)
+    return;
+
+  CachedTokens.erase(CachedTokens.begin(), CachedTokens.begin() + NumDropped);
+  CachedLexPos -= NumDropped;
+}
+
 void Preprocessor::EnterCachingLexMode() {
   if (InCachingLexMode()) {
     assert(CurLexerKind == CLK_CachingLexer && "Unexpected lexer kind");
@@ -117,6 +139,7 @@ void Preprocessor::EnterCachingLexMode() {
 
 const Token &Preprocessor::PeekAhead(unsigned N) {
   assert(CachedLexPos + N > CachedTokens.size() && "Confused caching.");
+  compactCachedTokens();
   ExitCachingLexMode();
   for (size_t C = CachedLexPos + N - CachedTokens.size(); C > 0; --C) {
     CachedTokens.push_back(Token());
@@ -961,6 +961,7 @@ void Preprocessor::HandleDirective(Token &Result) {
       case tok::pp_include_next:
       case tok::pp___include_macros:
       case tok::pp_pragma:
+      case tok::pp_embed:
         Diag(Result, diag::err_embedded_directive) << II->getName();
         DiscardUntilEndOfDirective();
         return;
@@ -1069,6 +1070,9 @@ void Preprocessor::HandleDirective(Token &Result) {
       if (getLangOpts().Modules)
         return HandleMacroPrivateDirective();
       break;
+
+    case tok::pp_embed:
+      return HandleEmbedDirective(SavedHash.getLocation(), Result);
     }
     break;
   }
@@ -2250,6 +2254,89 @@ void Preprocessor::HandleIncludeMacrosDirective(SourceLocation HashLoc,
   } while (TmpTok.isNot(tok::hashhash));
 }
 
+/// HandleEmbedDirective - Handle \#embed "file" and \#embed <file>.  The file
+/// is found the same way as an included one, but instead of being lexed, its
+/// bytes become an annot_embed token, which the parser turns into a character
+/// array.  The bytes stay in the source manager's buffer for the file, so they
+/// are neither copied nor turned into tokens.
+void Preprocessor::HandleEmbedDirective(SourceLocation HashLoc,
+                                        Token &EmbedTok) {
+  Diag(EmbedTok, diag::ext_pp_embed_directive);
+
+  Token FilenameTok;
+  CurPPLexer->LexIncludeFilename(FilenameTok);
+
+  SmallString<128> FilenameBuffer;
+  StringRef Filename;
+  SourceLocation End;
+
+  switch (FilenameTok.getKind()) {
+  case tok::eod:
+    // If the token kind is EOD, the error has already been diagnosed.
+    return;
+
+  case tok::angle_string_literal:
+  case tok::string_literal:
+    Filename = getSpelling(FilenameTok, FilenameBuffer);
+    End = FilenameTok.getLocation();
+    break;
+
+  case tok::less:
+    // This could be a <foo/bar.bin> file coming from a macro expansion.
+    FilenameBuffer.push_back('<');
+    if (ConcatenateIncludeName(FilenameBuffer, End))
+      return;   // Found <eod> but no ">"?  Diagnostic already emitted.
+    Filename = FilenameBuffer;
+    break;
+  default:
+    Diag(FilenameTok.getLocation(), diag::err_pp_expects_filename);
+    DiscardUntilEndOfDirective();
+    return;
+  }
+
+  StringRef OriginalFilename = Filename;
+  bool IsAngled =
+    GetIncludeFilenameSpelling(FilenameTok.getLocation(), Filename);
+  // If GetIncludeFilenameSpelling set the start ptr to null, there was an
+  // error.
+  if (Filename.empty()) {
+    DiscardUntilEndOfDirective();
+    return;
+  }
+
+  CheckEndOfDirective(EmbedTok.getIdentifierInfo()->getNameStart(), true);
+
+  const DirectoryLookup *CurDir;
+  const FileEntry *File =
+      LookupFile(FilenameTok.getLocation(), Filename, IsAngled, nullptr,
+                 nullptr, CurDir, nullptr, nullptr, nullptr, nullptr);
+
+  if (Callbacks) {
+    SrcMgr::CharacteristicKind FileType = SrcMgr::C_User;
+    if (File)
+      FileType = HeaderInfo.getFileDirFlavor(File);
+    Callbacks->EmbedDirective(HashLoc, Filename, IsAngled, File, FileType);
+  }
+
+  if (!File) {
+    Diag(FilenameTok, diag::err_pp_file_not_found) << OriginalFilename;
+    return;
+  }
+
+  // Give the file a FileID of its own, as if it were included, so that it is
+  // an input of any AST file written from this compilation. The source
+  // manager diagnoses a file that cannot be read.
+  FileID FID = SourceMgr.createFileID(File, HashLoc,
+                                      HeaderInfo.getFileDirFlavor(File));
+  bool Invalid = false;
+  const llvm::MemoryBuffer *Buffer = SourceMgr.getBuffer(FID, &Invalid);
+  if (Invalid)
+    return;
+
+  EnterAnnotationToken(SourceRange(HashLoc, End), tok::annot_embed,
+                       const_cast<llvm::MemoryBuffer *>(Buffer));
+}
+
 //===----------------------------------------------------------------------===//
 // Preprocessor Macro Directive Handling.
 //===----------------------------------------------------------------------===//
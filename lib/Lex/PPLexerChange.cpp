@@ -16,10 +16,12 @@
 #include "clang/Lex/PreprocessorOptions.h"
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/SourceManager.h"
+#include "clang/Lex/DependencyDirectivesSourceMinimizer.h"
 #include "clang/Lex/HeaderSearch.h"
 #include "clang/Lex/LexDiagnostic.h"
 #include "clang/Lex/MacroInfo.h"
 #include "clang/Lex/PTHManager.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -94,6 +96,9 @@ bool Preprocessor::EnterSourceFile(FileID FID, const DirectoryLookup *CurDir,
     return true;
   }
 
+  if (MinimizeSourceToDependencyDirectives)
+    InputFile = getDependencyDirectivesBuffer(FID, InputFile);
+
   if (isCodeCompletionEnabled() &&
       SourceMgr.getFileEntryForID(FID) == CodeCompletionFile) {
     CodeCompletionFileLoc = SourceMgr.getLocForStartOfFile(FID);
@@ -105,6 +110,27 @@ bool Preprocessor::EnterSourceFile(FileID FID, const DirectoryLookup *CurDir,
   return false;
 }
 
+/// Reduce the file FID refers to down to its dependency directives the first
+/// time it is entered.  The result replaces the file's contents in the
+/// SourceManager, so every later inclusion of the same FileEntry reuses it.
+/// If minimization fails, the file is lexed as-is.
+const llvm::MemoryBuffer *
+Preprocessor::getDependencyDirectivesBuffer(FileID FID,
+                                            const llvm::MemoryBuffer *InputFile) {
+  const FileEntry *FE = SourceMgr.getFileEntryForID(FID);
+  if (!FE || !MinimizedFiles.insert(FE).second)
+    return InputFile;
+
+  SmallString<1024> Minimized;
+  if (minimizeSourceToDependencyDirectives(InputFile->getBuffer(), Minimized))
+    return InputFile;
+
+  SourceMgr.overrideFileContents(
+      FE, llvm::MemoryBuffer::getMemBufferCopy(
+              Minimized, InputFile->getBufferIdentifier()));
+  return SourceMgr.getBuffer(FID);
+}
+
 /// EnterSourceFileWithLexer - Add a source file to the top of the include stack
 ///  and start lexing tokens from it instead of the current buffer.
 void Preprocessor::EnterSourceFileWithLexer(Lexer *TheLexer,
@@ -365,6 +391,11 @@ bool Preprocessor::HandleEndOfFile(Token &Result, bool isEndOfMacro) {
       // Okay, this has a controlling macro, remember in HeaderFileInfo.
       if (const FileEntry *FE = CurPPLexer->getFileEntry()) {
         HeaderInfo.SetFileControllingMacro(FE, ControllingMacro);
+        // Only the contents on disk are worth sharing with other
+        // compilations.
+        if (CurLexer && !SourceMgr.isFileOverridden(FE))
+          HeaderInfo.recordIncludeGuard(FE, ControllingMacro,
+                                        CurLexer->getBuffer());
         if (MacroInfo *MI =
               getMacroInfo(const_cast<IdentifierInfo*>(ControllingMacro)))
           MI->setUsedForHeaderGuard(true);
@@ -592,11 +623,14 @@ bool Preprocessor::HandleEndOfTokenLexer(Token &Result) {
       MacroExpandingLexersStack.back().first == CurTokenLexer.get())
     removeCachedMacroExpandedTokensOfLastLexer();
 
-  // Delete or cache the now-dead macro expander.
+  // Delete or cache the now-dead macro expander.  A cached one gives back
+  // its arguments right away rather than when it is reused.
   if (NumCachedTokenLexers == TokenLexerCacheSize)
     CurTokenLexer.reset();
-  else
+  else {
+    CurTokenLexer->destroy();
     TokenLexerCache[NumCachedTokenLexers++] = std::move(CurTokenLexer);
+  }
 
   // Handle this like a #include file being popped off the stack.
   return HandleEndOfFile(Result, true);
@@ -612,8 +646,10 @@ void Preprocessor::RemoveTopOfLexerStack() {
     // Delete or cache the now-dead macro expander.
     if (NumCachedTokenLexers == TokenLexerCacheSize)
       CurTokenLexer.reset();
-    else
+    else {
+      CurTokenLexer->destroy();
       TokenLexerCache[NumCachedTokenLexers++] = std::move(CurTokenLexer);
+    }
   }
 
   PopIncludeMacroStack();
@@ -1031,6 +1031,7 @@ Token *Preprocessor::cacheMacroExpandedTokens(TokenLexer *tokLexer,
   bool cacheNeedsToGrow = tokens.size() >
                       MacroExpandedTokens.capacity()-MacroExpandedTokens.size();
   MacroExpandedTokens.append(tokens.begin(), tokens.end());
+  NumExpandedArgTokens += tokens.size();
 
   if (cacheNeedsToGrow) {
     // Go through all the TokenLexers whose 'Tokens' pointer points in the
@@ -1631,6 +1632,7 @@ void Preprocessor::ExpandBuiltinMacro(Token &Tok) {
           return llvm::StringSwitch<bool>(II->getName())
                       .Case("__make_integer_seq", LangOpts.CPlusPlus)
                       .Case("__type_pack_element", LangOpts.CPlusPlus)
+                      .Case("__type_pack_slice", LangOpts.CPlusPlus)
                       .Case("__builtin_available", true)
                       .Case("__is_target_arch", true)
                       .Case("__is_target_vendor", true)
@@ -30,6 +30,7 @@
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/OnDiskHashTable.h"
+#include "llvm/Support/xxhash.h"
 #include <cassert>
 #include <cstdint>
 #include <cstdlib>
@@ -320,13 +321,15 @@ namespace {
 class PTHFileData {
   const uint32_t TokenOff;
   const uint32_t PPCondOff;
+  const uint64_t ContentHash;
 
 public:
-  PTHFileData(uint32_t tokenOff, uint32_t ppCondOff)
-      : TokenOff(tokenOff), PPCondOff(ppCondOff) {}
+  PTHFileData(uint32_t tokenOff, uint32_t ppCondOff, uint64_t contentHash)
+      : TokenOff(tokenOff), PPCondOff(ppCondOff), ContentHash(contentHash) {}
 
   uint32_t getTokenOffset() const { return TokenOff; }
   uint32_t getPPCondOffset() const { return PPCondOff; }
+  uint64_t getContentHash() const { return ContentHash; }
 };
 
 class PTHFileLookupCommonTrait {
@@ -377,7 +380,8 @@ public:
     assert(k.first == 0x1 && "Only file lookups can match!");
     uint32_t x = endian::readNext<uint32_t, little, unaligned>(d);
     uint32_t y = endian::readNext<uint32_t, little, unaligned>(d);
-    return PTHFileData(x, y);
+    uint64_t h = endian::readNext<uint64_t, little, unaligned>(d);
+    return PTHFileData(x, y, h);
   }
 };
 
@@ -626,6 +630,16 @@ PTHLexer *PTHManager::CreateLexer(FileID FID) {
 
   const PTHFileData& FileData = *I;
 
+  // The cached tokens are only good for the contents they were lexed from.
+  // Hashing the file is much cheaper than lexing it, and unlike its
+  // modification time it catches every edit.
+  bool Invalid = false;
+  const llvm::MemoryBuffer *Contents =
+      PP->getSourceManager().getBuffer(FID, &Invalid);
+  if (Invalid ||
+      llvm::xxHash64(Contents->getBuffer()) != FileData.getContentHash())
+    return nullptr;
+
   const unsigned char *BufStart = (const unsigned char *)Buf->getBufferStart();
   // Compute the offset of the token data within the buffer.
   const unsigned char* data = BufStart + FileData.getTokenOffset();
@@ -682,7 +696,7 @@ public:
       bool IsDirectory = true;
       if (k.first == 0x1 /* File */) {
         IsDirectory = false;
-        d += 4 * 2; // Skip the first 2 words.
+        d += 4 * 2 + 8; // Skip the token offsets and the content hash.
       }
 
       using namespace llvm::support;
@@ -729,6 +743,11 @@ public:
     if (!D.HasData)
       return CacheMissing;
 
+    // Files are validated by their contents when they are lexed, so their
+    // stat information has to be current.
+    if (!D.IsDirectory)
+      return statChained(Path, Data, isFile, F, FS);
+
     Data.Name = Path;
     Data.Size = D.Size;
     Data.ModTime = D.ModTime;
@@ -75,19 +75,23 @@ PreprocessingRecord::getPreprocessedEntitiesInRange(SourceRange Range) {
                           iterator(this, Res.second));
 }
 
-static bool isPreprocessedEntityIfInFileID(PreprocessedEntity *PPE, FileID FID,
+static bool isPreprocessedEntityIfInFileID(SourceRange Range, FileID FID,
                                            SourceManager &SM) {
   assert(FID.isValid());
-  if (!PPE)
-    return false;
-
-  SourceLocation Loc = PPE->getSourceRange().getBegin();
+  SourceLocation Loc = Range.getBegin();
   if (Loc.isInvalid())
     return false;
 
   return SM.isInFileID(SM.getFileLoc(Loc), FID);
 }
 
+static bool isPreprocessedEntityIfInFileID(PreprocessedEntity *PPE, FileID FID,
+                                           SourceManager &SM) {
+  if (!PPE)
+    return false;
+  return isPreprocessedEntityIfInFileID(PPE->getSourceRange(), FID, SM);
+}
+
 /// Returns true if the preprocessed entity that \arg PPEI iterator
 /// points to is coming from the file \arg FID.
 ///
@@ -124,12 +128,12 @@ bool PreprocessingRecord::isEntityInFileID(iterator PPEI, FileID FID) {
                                           FID, SourceMgr);
   }
 
-  if (unsigned(Pos) >= PreprocessedEntities.size()) {
+  if (unsigned(Pos) >= LocalEntityRanges.size()) {
     assert(0 && "Out-of bounds local preprocessed entity");
     return false;
   }
-  return isPreprocessedEntityIfInFileID(PreprocessedEntities[Pos],
-                                        FID, SourceMgr);
+  return isPreprocessedEntityIfInFileID(LocalEntityRanges[Pos], FID,
+                                        SourceMgr);
 }
 
 /// Returns a pair of [Begin, End) iterators of preprocessed entities
@@ -184,24 +188,23 @@ struct PPEntityComp {
 
   explicit PPEntityComp(const SourceManager &SM) : SM(SM) {}
 
-  bool operator()(PreprocessedEntity *L, PreprocessedEntity *R) const {
+  bool operator()(SourceRange L, SourceRange R) const {
     SourceLocation LHS = getLoc(L);
     SourceLocation RHS = getLoc(R);
     return SM.isBeforeInTranslationUnit(LHS, RHS);
   }
 
-  bool operator()(PreprocessedEntity *L, SourceLocation RHS) const {
+  bool operator()(SourceRange L, SourceLocation RHS) const {
     SourceLocation LHS = getLoc(L);
     return SM.isBeforeInTranslationUnit(LHS, RHS);
   }
 
-  bool operator()(SourceLocation LHS, PreprocessedEntity *R) const {
+  bool operator()(SourceLocation LHS, SourceRange R) const {
     SourceLocation RHS = getLoc(R);
     return SM.isBeforeInTranslationUnit(LHS, RHS);
   }
 
-  SourceLocation getLoc(PreprocessedEntity *PPE) const {
-    SourceRange Range = PPE->getSourceRange();
+  SourceLocation getLoc(SourceRange Range) const {
     return (Range.*getRangeLoc)();
   }
 };
@@ -213,11 +216,10 @@ unsigned PreprocessingRecord::findBeginLocalPreprocessedEntity(
   if (SourceMgr.isLoadedSourceLocation(Loc))
     return 0;
 
-  size_t Count = PreprocessedEntities.size();
+  size_t Count = LocalEntityRanges.size();
   size_t Half;
-  std::vector<PreprocessedEntity *>::const_iterator
-    First = PreprocessedEntities.begin();
-  std::vector<PreprocessedEntity *>::const_iterator I;
+  std::vector<SourceRange>::const_iterator First = LocalEntityRanges.begin();
+  std::vector<SourceRange>::const_iterator I;
 
   // Do a binary search manually instead of using std::lower_bound because
   // The end locations of entities may be unordered (when a macro expansion
@@ -227,8 +229,7 @@ unsigned PreprocessingRecord::findBeginLocalPreprocessedEntity(
     Half = Count/2;
     I = First;
     std::advance(I, Half);
-    if (SourceMgr.isBeforeInTranslationUnit((*I)->getSourceRange().getEnd(),
-                                            Loc)){
+    if (SourceMgr.isBeforeInTranslationUnit(I->getEnd(), Loc)) {
       First = I;
       ++First;
       Count = Count - Half - 1;
@@ -236,7 +237,7 @@ unsigned PreprocessingRecord::findBeginLocalPreprocessedEntity(
       Count = Half;
   }
 
-  return First - PreprocessedEntities.begin();
+  return First - LocalEntityRanges.begin();
 }
 
 unsigned PreprocessingRecord::findEndLocalPreprocessedEntity(
@@ -244,35 +245,44 @@ unsigned PreprocessingRecord::findEndLocalPreprocessedEntity(
   if (SourceMgr.isLoadedSourceLocation(Loc))
     return 0;
 
-  std::vector<PreprocessedEntity *>::const_iterator
-  I = std::upper_bound(PreprocessedEntities.begin(),
-                       PreprocessedEntities.end(),
+  std::vector<SourceRange>::const_iterator
+  I = std::upper_bound(LocalEntityRanges.begin(),
+                       LocalEntityRanges.end(),
                        Loc,
                        PPEntityComp<&SourceRange::getBegin>(SourceMgr));
-  return I - PreprocessedEntities.begin();
+  return I - LocalEntityRanges.begin();
 }
 
 PreprocessingRecord::PPEntityID
 PreprocessingRecord::addPreprocessedEntity(PreprocessedEntity *Entity) {
   assert(Entity);
-  SourceLocation BeginLoc = Entity->getSourceRange().getBegin();
+  return addLocalEntity(Entity->getSourceRange(), Entity,
+                        isa<MacroDefinitionRecord>(Entity));
+}
 
-  if (isa<MacroDefinitionRecord>(Entity)) {
-    assert((PreprocessedEntities.empty() ||
+PreprocessingRecord::PPEntityID
+PreprocessingRecord::addLocalEntity(SourceRange Range,
+                                    LocalEntityPayload Payload,
+                                    bool IsMacroDefinition) {
+  SourceLocation BeginLoc = Range.getBegin();
+
+  if (IsMacroDefinition) {
+    assert((LocalEntityRanges.empty() ||
             !SourceMgr.isBeforeInTranslationUnit(
-                BeginLoc,
-                PreprocessedEntities.back()->getSourceRange().getBegin())) &&
+                BeginLoc, LocalEntityRanges.back().getBegin())) &&
            "a macro definition was encountered out-of-order");
-    PreprocessedEntities.push_back(Entity);
-    return getPPEntityID(PreprocessedEntities.size()-1, /*isLoaded=*/false);
+    LocalEntityRanges.push_back(Range);
+    LocalEntityPayloads.push_back(Payload);
+    return getPPEntityID(LocalEntityRanges.size()-1, /*isLoaded=*/false);
   }
 
   // Check normal case, this entity begin location is after the previous one.
-  if (PreprocessedEntities.empty() ||
+  if (LocalEntityRanges.empty() ||
       !SourceMgr.isBeforeInTranslationUnit(BeginLoc,
-                   PreprocessedEntities.back()->getSourceRange().getBegin())) {
-    PreprocessedEntities.push_back(Entity);
-    return getPPEntityID(PreprocessedEntities.size()-1, /*isLoaded=*/false);
+                                       LocalEntityRanges.back().getBegin())) {
+    LocalEntityRanges.push_back(Range);
+    LocalEntityPayloads.push_back(Payload);
+    return getPPEntityID(LocalEntityRanges.size()-1, /*isLoaded=*/false);
   }
 
   // The entity's location is not after the previous one; this can happen with
@@ -287,32 +297,33 @@ PreprocessingRecord::addPreprocessedEntity(PreprocessedEntity *Entity) {
   //  FM(M1, M2)
   // \endcode
 
-  using pp_iter = std::vector<PreprocessedEntity *>::iterator;
+  using range_iter = std::vector<SourceRange>::iterator;
+
+  auto InsertAt = [&](range_iter I) {
+    unsigned Index = I - LocalEntityRanges.begin();
+    LocalEntityRanges.insert(I, Range);
+    LocalEntityPayloads.insert(LocalEntityPayloads.begin() + Index, Payload);
+    return getPPEntityID(Index, /*isLoaded=*/false);
+  };
 
   // Usually there are few macro expansions when defining the filename, do a
   // linear search for a few entities.
   unsigned count = 0;
-  for (pp_iter RI    = PreprocessedEntities.end(),
-               Begin = PreprocessedEntities.begin();
+  for (range_iter RI    = LocalEntityRanges.end(),
+                  Begin = LocalEntityRanges.begin();
        RI != Begin && count < 4; --RI, ++count) {
-    pp_iter I = RI;
+    range_iter I = RI;
     --I;
-    if (!SourceMgr.isBeforeInTranslationUnit(BeginLoc,
-                                           (*I)->getSourceRange().getBegin())) {
-      pp_iter insertI = PreprocessedEntities.insert(RI, Entity);
-      return getPPEntityID(insertI - PreprocessedEntities.begin(),
-                           /*isLoaded=*/false);
-    }
+    if (!SourceMgr.isBeforeInTranslationUnit(BeginLoc, I->getBegin()))
+      return InsertAt(RI);
   }
 
   // Linear search unsuccessful. Do a binary search.
-  pp_iter I = std::upper_bound(PreprocessedEntities.begin(),
-                               PreprocessedEntities.end(),
-                               BeginLoc,
+  range_iter I = std::upper_bound(LocalEntityRanges.begin(),
+                                  LocalEntityRanges.end(),
+                                  BeginLoc,
                                PPEntityComp<&SourceRange::getBegin>(SourceMgr));
-  pp_iter insertI = PreprocessedEntities.insert(I, Entity);
-  return getPPEntityID(insertI - PreprocessedEntities.begin(),
-                       /*isLoaded=*/false);
+  return InsertAt(I);
 }
 
 void PreprocessingRecord::SetExternalSource(
@@ -363,9 +374,24 @@ PreprocessedEntity *PreprocessingRecord::getPreprocessedEntity(PPEntityID PPID){
   if (PPID.ID == 0)
     return nullptr;
   unsigned Index = PPID.ID - 1;
-  assert(Index < PreprocessedEntities.size() &&
+  assert(Index < LocalEntityRanges.size() &&
          "Out-of bounds local preprocessed entity");
-  return PreprocessedEntities[Index];
+  return getLocalPreprocessedEntity(Index);
+}
+
+/// Retrieve the local preprocessed entity at the given index.
+PreprocessedEntity *
+PreprocessingRecord::getLocalPreprocessedEntity(unsigned Index) {
+  LocalEntityPayload &Payload = LocalEntityPayloads[Index];
+  if (PreprocessedEntity *Entity = Payload.dyn_cast<PreprocessedEntity *>())
+    return Entity;
+
+  // Create the macro expansion now that somebody wants it, and keep it so
+  // that it has a stable address from now on.
+  MacroExpansion *Expansion = new (*this) MacroExpansion(
+      Payload.get<MacroDefinitionRecord *>(), LocalEntityRanges[Index]);
+  Payload = Expansion;
+  return Expansion;
 }
 
 /// Retrieve the loaded preprocessed entity at the given index.
@@ -398,14 +424,16 @@ void PreprocessingRecord::addMacroExpansion(const Token &Id,
                                             const MacroInfo *MI,
                                             SourceRange Range) {
   // We don't record nested macro expansions.
-  if (Id.getLocation().isMacroID())
+  if (!RecordMacroExpansions || Id.getLocation().isMacroID())
     return;
 
+  // Expansions of builtin macros are rare; for the others, the
+  // MacroExpansion object is only created on demand.
   if (MI->isBuiltinMacro())
     addPreprocessedEntity(new (*this)
                               MacroExpansion(Id.getIdentifierInfo(), Range));
   else if (MacroDefinitionRecord *Def = findMacroDefinition(MI))
-    addPreprocessedEntity(new (*this) MacroExpansion(Def, Range));
+    addLocalEntity(Range, Def, /*IsMacroDefinition=*/false);
 }
 
 void PreprocessingRecord::Ifdef(SourceLocation Loc, const Token &MacroNameTok,
@@ -515,7 +543,8 @@ void PreprocessingRecord::InclusionDirective(
 size_t PreprocessingRecord::getTotalMemory() const {
   return BumpAlloc.getTotalMemory()
     + llvm::capacity_in_bytes(MacroDefinitions)
-    + llvm::capacity_in_bytes(PreprocessedEntities)
+    + llvm::capacity_in_bytes(LocalEntityRanges)
+    + llvm::capacity_in_bytes(LocalEntityPayloads)
     + llvm::capacity_in_bytes(LoadedPreprocessedEntities)
     + llvm::capacity_in_bytes(SkippedRanges);
 }
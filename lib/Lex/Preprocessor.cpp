@@ -100,6 +100,7 @@ Preprocessor::Preprocessor(std::shared_ptr<PreprocessorOptions> PPOpts,
   KeepComments = false;
   KeepMacroComments = false;
   SuppressIncludeNotFoundError = false;
+  MinimizeSourceToDependencyDirectives = false;
 
   // Macro expansion is enabled.
   DisableMacroExpansion = false;
@@ -286,12 +287,19 @@ void Preprocessor::PrintStats() {
   llvm::errs() << (NumFastTokenPaste+NumTokenPaste)
              << " token paste (##) operations performed, "
              << NumFastTokenPaste << " on the fast path.\n";
+  llvm::errs() << MaxNumLiveMacroArgs
+               << " max nested function-like macro expansions, "
+               << NumPreExpandedArgTokens << " argument tokens pre-expanded, "
+               << NumExpandedArgTokens
+               << " tokens copied into argument substitutions.\n";
 
   llvm::errs() << "\nPreprocessor Memory: " << getTotalMemory() << "B total";
 
   llvm::errs() << "\n  BumpPtr: " << BP.getTotalMemory();
   llvm::errs() << "\n  Macro Expanded Tokens: "
                << llvm::capacity_in_bytes(MacroExpandedTokens);
+  llvm::errs() << "\n  Macro Argument Arena: "
+               << MacroArgArena.getTotalMemory();
   llvm::errs() << "\n  Predefines Buffer: " << Predefines.capacity();
   // FIXME: List information for all submodules.
   llvm::errs() << "\n  Macros: "
@@ -322,6 +330,7 @@ Preprocessor::macro_begin(bool IncludeExternalMacros) const {
 size_t Preprocessor::getTotalMemory() const {
   return BP.getTotalMemory()
     + llvm::capacity_in_bytes(MacroExpandedTokens)
+    + MacroArgArena.getTotalMemory()
     + Predefines.capacity() /* Predefines buffer. */
     // FIXME: Include sizes from all submodules, and include MacroInfo sizes,
     // and ModuleMacros.
@@ -331,6 +340,37 @@ size_t Preprocessor::getTotalMemory() const {
     + llvm::capacity_in_bytes(CommentHandlers);
 }
 
+size_t Preprocessor::getTokenCacheMemory() const {
+  return llvm::capacity_in_bytes(CachedTokens)
+    + llvm::capacity_in_bytes(MacroExpandedTokens)
+    + llvm::capacity_in_bytes(MacroArgPreExpansionBuffer)
+    + MacroArgArena.getTotalMemory()
+    + NumCachedTokenLexers * sizeof(TokenLexer);
+}
+
+void Preprocessor::releaseTokenCaches() {
+  // Only release the caches when nothing is being lexed; the tokens of any
+  // lexer in progress may live in them.
+  if (CurLexer || CurPTHLexer || CurTokenLexer || !IncludeMacroStack.empty() ||
+      isBacktrackEnabled() || !MacroExpandingLexersStack.empty() ||
+      NumLiveMacroArgs)
+    return;
+
+  CachedTokensTy().swap(CachedTokens);
+  CachedLexPos = 0;
+  decltype(MacroExpandedTokens)().swap(MacroExpandedTokens);
+  decltype(MacroArgPreExpansionBuffer)().swap(MacroArgPreExpansionBuffer);
+
+  // Destroying a token lexer releases its macro arguments into
+  // MacroArgCache, so free the token lexers first.
+  std::fill(TokenLexerCache, TokenLexerCache + NumCachedTokenLexers, nullptr);
+  NumCachedTokenLexers = 0;
+  for (MacroArgs *ArgList = MacroArgCache; ArgList;)
+    ArgList = ArgList->deallocate();
+  MacroArgCache = nullptr;
+  MacroArgArena.Reset();
+}
+
 Preprocessor::macro_iterator
 Preprocessor::macro_end(bool IncludeExternalMacros) const {
   if (IncludeExternalMacros && ExternalSource &&
@@ -471,15 +511,55 @@ StringRef Preprocessor::getSpelling(const Token &Tok,
       return II->getName();
   }
 
-  // Resize the buffer if we need to copy into it.
+  // Tokens that need cleaning are spelled once, into the cache.
   if (Tok.needsCleaning())
-    Buffer.resize(Tok.getLength());
+    return getSpellingRef(Tok, Invalid);
 
   const char *Ptr = Buffer.data();
   unsigned Len = getSpelling(Tok, Ptr, Invalid);
   return StringRef(Ptr, Len);
 }
 
+StringRef Preprocessor::getSpellingRef(const Token &Tok, bool *Invalid) const {
+  const char *Ptr = nullptr;
+  if (!Tok.needsCleaning()) {
+    unsigned Len = getSpelling(Tok, Ptr, Invalid);
+    return StringRef(Ptr, Len);
+  }
+
+  // NOTE: this has to be checked *before* testing for an IdentifierInfo.
+  if (Tok.isNot(tok::raw_identifier) && !Tok.hasUCN()) {
+    if (const IdentifierInfo *II = Tok.getIdentifierInfo())
+      return II->getName();
+  }
+
+  // A token lexed at a given location always has the same characters, so its
+  // location and length identify its spelling.
+  SourceLocation Loc = Tok.getLocation();
+  std::pair<unsigned, unsigned> Key(Loc.getRawEncoding(), Tok.getLength());
+  if (Loc.isValid()) {
+    auto Cached = CleanedSpellings.find(Key);
+    if (Cached != CleanedSpellings.end())
+      return Cached->second;
+  }
+
+  // Leave room for a terminator; the numeric literal parser reads the
+  // character after the spelling.
+  char *Buffer = CleanedSpellingArena.Allocate<char>(Tok.getLength() + 1);
+  Ptr = Buffer;
+  bool SpellingInvalid = false;
+  unsigned Len = getSpelling(Tok, Ptr, &SpellingInvalid);
+  if (Invalid)
+    *Invalid = SpellingInvalid;
+  if (Ptr == Buffer)
+    Buffer[Len] = '\0';
+
+  StringRef Spelling(Ptr, Len);
+  if (Loc.isValid() && !SpellingInvalid)
+    CleanedSpellings[Key] = Spelling;
+  return Spelling;
+}
+
 /// CreateString - Plop the specified string into a scratch buffer and return a
 /// location for it.  If specified, the source location provides a source
 /// location for the token.
@@ -904,6 +984,9 @@ void Preprocessor::Lex(Token &Result) {
   }
 
   LastTokenWasAt = Result.is(tok::at);
+
+  if (OnToken)
+    OnToken(Result);
 }
 
 /// Lex a token following the 'import' contextual keyword.
@@ -1088,5 +1171,7 @@ void Preprocessor::createPreprocessingRecord() {
     return;
 
   Record = new PreprocessingRecord(getSourceManager());
+  Record->setRecordMacroExpansions(
+      getPreprocessorOpts().DetailedRecordMacroExpansions);
   addPPCallbacks(std::unique_ptr<PPCallbacks>(Record));
 }
@@ -57,14 +57,7 @@ bool TokenConcatenation::IsIdentifierStringPrefix(const Token &Tok) const {
                           LangOpts.CPlusPlus11);
   }
 
-  if (Tok.getLength() < 256) {
-    char Buffer[256];
-    const char *TokPtr = Buffer;
-    unsigned length = PP.getSpelling(Tok, TokPtr);
-    return IsStringPrefix(StringRef(TokPtr, length), LangOpts.CPlusPlus11);
-  }
-
-  return IsStringPrefix(StringRef(PP.getSpelling(Tok)), LangOpts.CPlusPlus11);
+  return IsStringPrefix(PP.getSpellingRef(Tok), LangOpts.CPlusPlus11);
 }
 
 TokenConcatenation::TokenConcatenation(const Preprocessor &pp) : PP(pp) {
@@ -137,13 +130,8 @@ static char GetFirstChar(const Preprocessor &PP, const Token &Tok) {
       SourceManager &SM = PP.getSourceManager();
       return *SM.getCharacterData(SM.getSpellingLoc(Tok.getLocation()));
     }
-  } else if (Tok.getLength() < 256) {
-    char Buffer[256];
-    const char *TokPtr = Buffer;
-    PP.getSpelling(Tok, TokPtr);
-    return TokPtr[0];
   } else {
-    return PP.getSpelling(Tok)[0];
+    return PP.getSpellingRef(Tok)[0];
   }
 }
 
@@ -189,7 +177,7 @@ bool TokenConcatenation::AvoidConcat(const Token &PrevPrevTok,
   if (Tok.isAnnotation()) {
     // Modules annotation can show up when generated automatically for includes.
     assert(Tok.isOneOf(tok::annot_module_include, tok::annot_module_begin,
-                       tok::annot_module_end) &&
+                       tok::annot_module_end, tok::annot_embed) &&
            "unexpected annotation in AvoidConcat");
     ConcatInfo = 0;
   }
@@ -129,6 +129,7 @@ void TokenLexer::destroy() {
 
   // TokenLexer owns its formal arguments.
   if (ActualArgs) ActualArgs->destroy(PP);
+  ActualArgs = nullptr;
 }
 
 bool TokenLexer::MaybeRemoveCommaBeforeVaArgs(
@@ -432,7 +433,7 @@ void TokenLexer::ExpandFunctionArguments() {
       // avoids some work in common cases.
       const Token *ArgTok = ActualArgs->getUnexpArgument(ArgNo);
       if (ActualArgs->ArgNeedsPreexpansion(ArgTok, PP))
-        ResultArgToks = &ActualArgs->getPreExpArgument(ArgNo, PP)[0];
+        ResultArgToks = ActualArgs->getPreExpArgument(ArgNo, PP).data();
       else
         ResultArgToks = ArgTok;  // Use non-preexpanded tokens.
 
@@ -99,6 +99,12 @@ NamedDecl *Parser::ParseCXXInlineMethodDef(
     return FnD;
   }
 
+  if (SkipFunctionBodies && DeferSkippedFunctionBodies &&
+      tryDeferringFunctionBody(FnD)) {
+    Actions.ActOnSkippedFunctionBody(FnD);
+    return FnD;
+  }
+
   if (SkipFunctionBodies && (!FnD || Actions.canSkipFunctionBody(FnD)) &&
       trySkippingFunctionBody()) {
     Actions.ActOnSkippedFunctionBody(FnD);
@@ -1092,6 +1092,14 @@ ExprResult Parser::ParseCastExpression(bool isUnaryExpression,
   case tok::utf32_string_literal:
     Res = ParseStringLiteralExpression(true);
     break;
+  case tok::annot_embed: {  // primary-expression: #embed "file"
+    auto *Buffer =
+        static_cast<const llvm::MemoryBuffer *>(Tok.getAnnotationValue());
+    Res = Actions.ActOnEmbedExpr(Tok.getAnnotationRange(),
+                                 Buffer->getBuffer());
+    ConsumeAnnotationToken();
+    break;
+  }
   case tok::kw__Generic:   // primary-expression: generic-selection [C11 6.5.1]
     Res = ParseGenericSelectionExpression();
     break;
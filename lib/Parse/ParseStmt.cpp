@@ -2115,6 +2115,24 @@ bool Parser::trySkippingFunctionBody() {
   return true;
 }
 
+bool Parser::tryDeferringFunctionBody(Decl *D) {
+  assert(SkipFunctionBodies && DeferSkippedFunctionBodies &&
+         "Should only be called when deferring skipped function bodies");
+  FunctionDecl *FD = D ? D->getAsFunction() : nullptr;
+
+  // Templated functions are instantiated from their bodies, and functions in
+  // local classes can only be parsed within their enclosing function. Leave
+  // code completion to trySkippingFunctionBody.
+  if (!FD || FD->isDependentContext() || FD->getParentFunctionOrMethod() ||
+      PP.isCodeCompletionEnabled() || !Actions.canSkipFunctionBody(D))
+    return false;
+
+  CachedTokens Toks;
+  LexTemplateFunctionForLateParsing(Toks);
+  Actions.MarkAsLateParsedTemplate(FD, D, Toks);
+  return true;
+}
+
 /// ParseCXXTryBlock - Parse a C++ try-block.
 ///
 ///       try-block:
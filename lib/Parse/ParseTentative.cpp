@@ -17,6 +17,38 @@
 #include "clang/Sema/ParsedTemplate.h"
 using namespace clang;
 
+uint64_t Parser::getTentativeParseMemoKey(unsigned Query) const {
+  assert(Query < 16 && "query does not fit in the key");
+  uint64_t Key = Tok.getLocation().getRawEncoding();
+  Key |= uint64_t(Query) << 32;
+  Key |= uint64_t(GreaterThanIsOperator) << 36;
+  Key |= uint64_t(ColonIsSacred) << 37;
+  Key |= uint64_t(InMessageExpression) << 38;
+  Key |= uint64_t(TentativelyDeclaredIdentifiers.size()) << 39;
+  return Key;
+}
+
+bool Parser::lookupTentativeParseMemo(uint64_t Key, bool &Result,
+                                      bool &IsAmbiguous) {
+  if (!TentativeParsingDepth)
+    return false;
+  auto Known = TentativeParseMemo.find(Key);
+  if (Known == TentativeParseMemo.end())
+    return false;
+  ++NumTentativeParsesAvoided;
+  Result = Known->second & 1;
+  IsAmbiguous = Known->second & 2;
+  return true;
+}
+
+void Parser::recordTentativeParseMemo(uint64_t Key, bool Result,
+                                      bool IsAmbiguous) {
+  // Outside a tentative parse the tokens may be annotated or consumed before
+  // the same position is queried again.
+  if (TentativeParsingDepth)
+    TentativeParseMemo[Key] = unsigned(Result) | (unsigned(IsAmbiguous) << 1);
+}
+
 /// isCXXDeclarationStatement - C++-specialized function that disambiguates
 /// between a declaration or an expression statement, when parsing function
 /// bodies. Returns true for declaration, false for expression.
@@ -543,7 +575,18 @@ Parser::isCXXConditionDeclarationOrInitStatement(bool CanBeInitStatement,
   ///   type-specifier-seq abstract-declarator[opt]
   ///
 bool Parser::isCXXTypeId(TentativeCXXTypeIdContext Context, bool &isAmbiguous) {
+  uint64_t Key = getTentativeParseMemoKey(TPMQ_TypeId + Context);
+  bool Result;
+  if (lookupTentativeParseMemo(Key, Result, isAmbiguous))
+    return Result;
+
+  Result = isCXXTypeIdImpl(Context, isAmbiguous);
+  recordTentativeParseMemo(Key, Result, isAmbiguous);
+  return Result;
+}
 
+bool Parser::isCXXTypeIdImpl(TentativeCXXTypeIdContext Context,
+                             bool &isAmbiguous) {
   isAmbiguous = false;
 
   // C++ 8.2p2:
@@ -1760,7 +1803,18 @@ Parser::TPResult Parser::TryParseProtocolQualifiers() {
 ///         exception-specification[opt]
 ///
 bool Parser::isCXXFunctionDeclarator(bool *IsAmbiguous) {
+  uint64_t Key = getTentativeParseMemoKey(TPMQ_FunctionDeclarator);
+  bool Result, Ambiguous = false;
+  if (!lookupTentativeParseMemo(Key, Result, Ambiguous)) {
+    Result = isCXXFunctionDeclaratorImpl(&Ambiguous);
+    recordTentativeParseMemo(Key, Result, Ambiguous);
+  }
+  if (IsAmbiguous && Ambiguous)
+    *IsAmbiguous = true;
+  return Result;
+}
 
+bool Parser::isCXXFunctionDeclaratorImpl(bool *IsAmbiguous) {
   // C++ 8.2p1:
   // The ambiguity arising from the similarity between a function-style cast and
   // a declaration mentioned in 6.8 can also occur in the context of a
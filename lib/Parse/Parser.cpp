@@ -15,12 +15,14 @@
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/DeclTemplate.h"
+#include "clang/Basic/TimeTraceProfiler.h"
 #include "clang/Parse/ParseDiagnostic.h"
 #include "clang/Parse/RAIIObjectsForParser.h"
 #include "clang/Sema/DeclSpec.h"
 #include "clang/Sema/ParsedTemplate.h"
 #include "clang/Sema/Scope.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
 using namespace clang;
 
 
@@ -419,6 +421,10 @@ Parser::~Parser() {
 
   PP.removeCommentHandler(CommentSemaHandler.get());
 
+  // Late parsing is no longer possible.
+  if (Actions.OpaqueParser == this)
+    Actions.SetLateTemplateParser(nullptr, nullptr, nullptr);
+
   PP.clearCodeCompletionHandler();
 
   if (getLangOpts().DelayedTemplateParsing &&
@@ -433,6 +439,14 @@ Parser::~Parser() {
   assert(TemplateIds.empty() && "Still alive TemplateIdAnnotations around?");
 }
 
+/// Print out statistics about the parser.
+void Parser::PrintStats() const {
+  llvm::errs() << "\n*** Parser Stats:\n";
+  llvm::errs() << NumTentativeParses << " tentative parses.\n";
+  llvm::errs() << NumTentativeParsesAvoided
+               << " disambiguation queries answered from the memo table.\n";
+}
+
 /// Initialize - Warm up the parser.
 ///
 void Parser::Initialize() {
@@ -589,8 +603,9 @@ bool Parser::ParseTopLevelDecl(DeclGroupPtrTy &Result) {
     return false;
 
   case tok::eof:
-    // Late template parsing can begin.
-    if (getLangOpts().DelayedTemplateParsing)
+    // Late template parsing, and parsing of deferred function bodies, can
+    // begin.
+    if (getLangOpts().DelayedTemplateParsing || DeferSkippedFunctionBodies)
       Actions.SetLateTemplateParser(LateTemplateParserCallback,
                                     PP.isIncrementalProcessingEnabled() ?
                                     LateTemplateParserCleanupCallback : nullptr,
@@ -1049,6 +1064,10 @@ Parser::ParseDeclarationOrFunctionDefinition(ParsedAttributesWithRange &attrs,
 Decl *Parser::ParseFunctionDefinition(ParsingDeclarator &D,
                                       const ParsedTemplateInfo &TemplateInfo,
                                       LateParsedAttrList *LateParsedAttrs) {
+  TimeTraceScope TimeScope("ParseFunctionDefinition", [&]() {
+    return Actions.GetNameForDeclarator(D).getName().getAsString();
+  });
+
   // Poison SEH identifiers so they are flagged as illegal in function bodies.
   PoisonSEHIdentifiersRAIIObject PoisonSEHIdentifiers(*this, true);
   const DeclaratorChunk::FunctionTypeInfo &FTI = D.getFunctionTypeInfo();
@@ -1215,6 +1234,13 @@ Decl *Parser::ParseFunctionDefinition(ParsingDeclarator &D,
     return Res;
   }
 
+  if (SkipFunctionBodies && DeferSkippedFunctionBodies &&
+      tryDeferringFunctionBody(Res)) {
+    BodyScope.Exit();
+    Actions.ActOnSkippedFunctionBody(Res);
+    return Actions.ActOnFinishFunctionBody(Res, nullptr, false);
+  }
+
   if (SkipFunctionBodies && (!Res || Actions.canSkipFunctionBody(Res)) &&
       trySkippingFunctionBody()) {
     BodyScope.Exit();
@@ -21,7 +21,9 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
+#include <map>
 #include <memory>
+#include <vector>
 using namespace clang;
 
 
@@ -420,12 +422,68 @@ input.spoilerhider:checked + label + .spoiler{
   R.InsertTextAfter(EndLoc, "</body></html>\n");
 }
 
+namespace clang {
+namespace html {
+
+struct RelexRewriteCache {
+  /// A range highlighted by html::HighlightRange.
+  struct Highlight {
+    unsigned B, E;
+    std::string StartTag, EndTag;
+  };
+  using HighlightList = std::vector<Highlight>;
+
+  std::map<FileID, HighlightList> SyntaxHighlights, MacroHighlights;
+};
+
+} // end html namespace
+} // end clang namespace
+
+html::RelexRewriteCacheRef html::instantiateRelexRewriteCache() {
+  return std::make_shared<RelexRewriteCache>();
+}
+
+/// Look up the highlighting of \p FID in \p Highlights.  If it is there,
+/// apply it to \p R and return null; otherwise return the list that the
+/// caller should fill in.
+static html::RelexRewriteCache::HighlightList *
+applyCachedHighlights(Rewriter &R, FileID FID, const Preprocessor &PP,
+                      std::map<FileID, html::RelexRewriteCache::HighlightList>
+                          &Highlights) {
+  auto Inserted = Highlights.insert({FID, {}});
+  if (Inserted.second)
+    return &Inserted.first->second;
+
+  RewriteBuffer &RB = R.getEditBuffer(FID);
+  const char *BufferStart = PP.getSourceManager().getBuffer(FID)->
+                                getBufferStart();
+  for (const auto &H : Inserted.first->second)
+    html::HighlightRange(RB, H.B, H.E, BufferStart, H.StartTag.c_str(),
+                         H.EndTag.c_str());
+  return nullptr;
+}
+
 /// SyntaxHighlight - Relex the specified FileID and annotate the HTML with
 /// information about keywords, macro expansions etc.  This uses the macro
 /// table state from the end of the file, so it won't be perfectly perfect,
 /// but it will be reasonably close.
-void html::SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP) {
+void html::SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP,
+                           RelexRewriteCacheRef Cache) {
+  RelexRewriteCache::HighlightList *Highlights = nullptr;
+  if (Cache) {
+    Highlights = applyCachedHighlights(R, FID, PP, Cache->SyntaxHighlights);
+    if (!Highlights)
+      return;
+  }
+
   RewriteBuffer &RB = R.getEditBuffer(FID);
+  auto HighlightRangeCallback = [&](unsigned B, unsigned E,
+                                    const char *BufferStart,
+                                    const char *StartTag, const char *EndTag) {
+    HighlightRange(RB, B, E, BufferStart, StartTag, EndTag);
+    if (Highlights)
+      Highlights->push_back({B, E, StartTag, EndTag});
+  };
 
   const SourceManager &SM = PP.getSourceManager();
   const llvm::MemoryBuffer *FromFile = SM.getBuffer(FID);
@@ -457,13 +515,13 @@ void html::SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP) {
 
       // If this is a pp-identifier, for a keyword, highlight it as such.
       if (Tok.isNot(tok::identifier))
-        HighlightRange(RB, TokOffs, TokOffs+TokLen, BufferStart,
-                       "<span class='keyword'>", "</span>");
+        HighlightRangeCallback(TokOffs, TokOffs+TokLen, BufferStart,
+                             "<span class='keyword'>", "</span>");
       break;
     }
     case tok::comment:
-      HighlightRange(RB, TokOffs, TokOffs+TokLen, BufferStart,
-                     "<span class='comment'>", "</span>");
+      HighlightRangeCallback(TokOffs, TokOffs+TokLen, BufferStart,
+                             "<span class='comment'>", "</span>");
       break;
     case tok::utf8_string_literal:
       // Chop off the u part of u8 prefix
@@ -480,8 +538,8 @@ void html::SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP) {
       LLVM_FALLTHROUGH;
     case tok::string_literal:
       // FIXME: Exclude the optional ud-suffix from the highlighted range.
-      HighlightRange(RB, TokOffs, TokOffs+TokLen, BufferStart,
-                     "<span class='string_literal'>", "</span>");
+      HighlightRangeCallback(TokOffs, TokOffs+TokLen, BufferStart,
+                             "<span class='string_literal'>", "</span>");
       break;
     case tok::hash: {
       // If this is a preprocessor directive, all tokens to end of line are too.
@@ -498,8 +556,8 @@ void html::SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP) {
       }
 
       // Find end of line.  This is a hack.
-      HighlightRange(RB, TokOffs, TokEnd, BufferStart,
-                     "<span class='directive'>", "</span>");
+      HighlightRangeCallback(TokOffs, TokEnd, BufferStart,
+                             "<span class='directive'>", "</span>");
 
       // Don't skip the next token.
       continue;
@@ -514,13 +572,23 @@ void html::SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP) {
 /// file, to re-expand macros and insert (into the HTML) information about the
 /// macro expansions.  This won't be perfectly perfect, but it will be
 /// reasonably close.
-void html::HighlightMacros(Rewriter &R, FileID FID, const Preprocessor& PP) {
+void html::HighlightMacros(Rewriter &R, FileID FID, const Preprocessor& PP,
+                           RelexRewriteCacheRef Cache) {
+  RelexRewriteCache::HighlightList *Highlights = nullptr;
+  if (Cache) {
+    Highlights = applyCachedHighlights(R, FID, PP, Cache->MacroHighlights);
+    if (!Highlights)
+      return;
+  }
+
   // Re-lex the raw token stream into a token buffer.
   const SourceManager &SM = PP.getSourceManager();
   std::vector<Token> TokenStream;
 
   const llvm::MemoryBuffer *FromFile = SM.getBuffer(FID);
   Lexer L(FID, FromFile, SM, PP.getLangOpts());
+  RewriteBuffer &RB = R.getEditBuffer(FID);
+  const char *BufferStart = FromFile->getBufferStart();
 
   // Lex all the tokens in raw mode, to avoid entering #includes or expanding
   // macros.
@@ -642,8 +710,15 @@ void html::HighlightMacros(Rewriter &R, FileID FID, const Preprocessor& PP) {
     // highlighted.
     Expansion = "<span class='expansion'>" + Expansion + "</span></span>";
 
-    HighlightRange(R, LLoc.getBegin(), LLoc.getEnd(), "<span class='macro'>",
-                   Expansion.c_str(), LLoc.isTokenRange());
+    unsigned BOffset = SM.getFileOffset(LLoc.getBegin());
+    unsigned EOffset = SM.getFileOffset(LLoc.getEnd());
+    if (LLoc.isTokenRange())
+      EOffset += Lexer::MeasureTokenLength(LLoc.getEnd(), SM, R.getLangOpts());
+    HighlightRange(RB, BOffset, EOffset, BufferStart, "<span class='macro'>",
+                   Expansion.c_str());
+    if (Highlights)
+      Highlights->push_back({BOffset, EOffset, "<span class='macro'>",
+                             Expansion});
   }
 
   // Restore the preprocessor's old state.
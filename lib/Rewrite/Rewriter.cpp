@@ -21,6 +21,8 @@
 #include "clang/Lex/Lexer.h"
 #include "clang/Rewrite/Core/RewriteBuffer.h"
 #include "clang/Rewrite/Core/RewriteRope.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
@@ -126,6 +128,30 @@ void RewriteBuffer::ReplaceText(unsigned OrigOffset, unsigned OrigLength,
     AddReplaceDelta(OrigOffset, NewStr.size() - OrigLength);
 }
 
+void RewriteBuffer::ReplaceTextInBulk(StringRef Original,
+                                      ArrayRef<Edit> Edits) {
+  assert(Buffer.size() == 0 && "Buffer was already initialized");
+  std::string Result;
+  size_t ResultSize = Original.size();
+  for (const Edit &E : Edits)
+    ResultSize += E.Text.size() - E.Length;
+  Result.reserve(ResultSize);
+
+  unsigned Pos = 0;
+  for (const Edit &E : Edits) {
+    Result.append(Original.begin() + Pos, Original.begin() + E.Offset);
+    Result.append(E.Text.begin(), E.Text.end());
+    Pos = E.Offset + E.Length;
+  }
+  Result.append(Original.begin() + Pos, Original.end());
+  Buffer.assign(Result.data(), Result.data() + Result.size());
+
+  // Record the same deltas that ReplaceText would have.
+  for (const Edit &E : Edits)
+    if (E.Length != E.Text.size())
+      AddReplaceDelta(E.Offset, E.Text.size() - E.Length);
+}
+
 //===----------------------------------------------------------------------===//
 // Rewriter class
 //===----------------------------------------------------------------------===//
@@ -314,6 +340,37 @@ bool Rewriter::ReplaceText(SourceLocation Start, unsigned OrigLength,
   return false;
 }
 
+bool Rewriter::ReplaceTextInBulk(FileID FID,
+                                 ArrayRef<RewriteBuffer::Edit> Edits) {
+  if (Edits.empty())
+    return false;
+  if (FID.isInvalid())
+    return true;
+
+  StringRef Original = SourceMgr->getBufferData(FID);
+  unsigned End = 0;
+  for (const RewriteBuffer::Edit &E : Edits) {
+    if (E.Offset < End || E.Offset > Original.size() ||
+        E.Length > Original.size() - E.Offset)
+      return true;
+    End = E.Offset + E.Length;
+  }
+
+  // Once a file has been edited, offsets into the original file have to be
+  // mapped through its deltas, so apply the edits one at a time.
+  std::map<FileID, RewriteBuffer>::iterator I =
+    RewriteBuffers.lower_bound(FID);
+  if (I != RewriteBuffers.end() && I->first == FID) {
+    for (const RewriteBuffer::Edit &E : llvm::reverse(Edits))
+      I->second.ReplaceText(E.Offset, E.Length, E.Text);
+    return false;
+  }
+
+  I = RewriteBuffers.insert(I, std::make_pair(FID, RewriteBuffer()));
+  I->second.ReplaceTextInBulk(Original, Edits);
+  return false;
+}
+
 bool Rewriter::ReplaceText(SourceRange range, SourceRange replacementRange) {
   if (!isRewritable(range.getBegin())) return true;
   if (!isRewritable(range.getEnd())) return true;
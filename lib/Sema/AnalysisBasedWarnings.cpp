@@ -2027,6 +2027,12 @@ AnalysisBasedWarnings::IssueWarnings(sema::AnalysisBasedWarnings::Policy P,
   const Stmt *Body = D->getBody();
   assert(Body);
 
+  // FIXME: These analyses are not read-only, so they cannot be moved off the
+  // parsing thread. Building the CFG evaluates constants, which allocates
+  // from the ASTContext; the fix-its query the Lexer and the SourceManager
+  // caches; the thread safety analysis shares Sema's attribute cache; and
+  // the function scope is destroyed as soon as we return.
+
   // Construct the analysis context with the specified CFG build options.
   AnalysisDeclContext AC(/* AnalysisDeclContextManager */ nullptr, D);
 
@@ -517,6 +517,26 @@ CodeCompleteConsumer::OverloadCandidate::getFunctionType() const {
 
 CodeCompleteConsumer::~CodeCompleteConsumer() = default;
 
+unsigned CodeCompleteConsumer::filterResults(CodeCompletionResult *Results,
+                                             unsigned NumResults) const {
+  if (!ResultPrefix.empty())
+    NumResults = std::remove_if(Results, Results + NumResults,
+                                [&](const CodeCompletionResult &R) {
+                                  return !R.matchesTypedPrefix(ResultPrefix);
+                                }) -
+                 Results;
+
+  if (MaxResults && NumResults > MaxResults) {
+    std::stable_sort(
+        Results, Results + NumResults,
+        [](const CodeCompletionResult &X, const CodeCompletionResult &Y) {
+          return X.Priority < Y.Priority;
+        });
+    NumResults = MaxResults;
+  }
+  return NumResults;
+}
+
 bool PrintingCodeCompleteConsumer::isResultFilteredOut(StringRef Filter,
                                                 CodeCompletionResult Result) {
   switch (Result.Kind) {
@@ -751,6 +771,39 @@ StringRef CodeCompletionResult::getOrderedName(std::string &Saved) const {
   return Saved;
 }
 
+bool CodeCompletionResult::matchesTypedPrefix(StringRef Prefix) const {
+  if (Prefix.empty())
+    return true;
+
+  StringRef TypedText;
+  switch (Kind) {
+  case RK_Keyword:
+    TypedText = Keyword;
+    break;
+  case RK_Pattern:
+    if (!Pattern->getTypedText())
+      return true;
+    TypedText = Pattern->getTypedText();
+    break;
+  case RK_Macro:
+    TypedText = Macro->getName();
+    break;
+  case RK_Declaration: {
+    // Only simple identifiers are typed as they are spelled; constructors,
+    // operators and selectors with arguments may be typed differently.
+    DeclarationName Name = Declaration->getDeclName();
+    IdentifierInfo *Id = Name.getAsIdentifierInfo();
+    if (!Id && Name.isObjCZeroArgSelector())
+      Id = Name.getObjCSelector().getIdentifierInfoForSlot(0);
+    if (!Id)
+      return true;
+    TypedText = Id->getName();
+    break;
+  }
+  }
+  return TypedText.startswith_lower(Prefix);
+}
+
 bool clang::operator<(const CodeCompletionResult &X,
                       const CodeCompletionResult &Y) {
   std::string XSaved, YSaved;
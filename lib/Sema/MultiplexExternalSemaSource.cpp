@@ -191,6 +191,15 @@ bool MultiplexExternalSemaSource::layoutRecordType(const RecordDecl *Record,
   return false;
 }
 
+const ASTRecordLayout *
+MultiplexExternalSemaSource::getStoredRecordLayout(const RecordDecl *Record) {
+  for (size_t i = 0; i < Sources.size(); ++i)
+    if (const ASTRecordLayout *Layout =
+            Sources[i]->getStoredRecordLayout(Record))
+      return Layout;
+  return nullptr;
+}
+
 void MultiplexExternalSemaSource::
 getMemoryBufferSizes(MemoryBufferSizes &sizes) const {
   for(size_t i = 0; i < Sources.size(); ++i)
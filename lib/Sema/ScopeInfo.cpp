@@ -50,6 +50,7 @@ void FunctionScopeInfo::Clear() {
 
   SwitchStack.clear();
   Returns.clear();
+  CompoundScopes.clear();
   ErrorTrap.reset();
   PossiblyUnreachableDiags.clear();
   WeakObjectUses.clear();
@@ -58,6 +59,35 @@ void FunctionScopeInfo::Clear() {
   ByrefBlockVars.clear();
 }
 
+void LambdaScopeInfo::Clear() {
+  FunctionScopeInfo::Clear();
+
+  ImpCaptureStyle = ImpCap_None;
+  CaptureMap.clear();
+  CXXThisCaptureIndex = 0;
+  Captures.clear();
+  HasImplicitReturnType = false;
+  ReturnType = QualType();
+
+  Lambda = nullptr;
+  CallOperator = nullptr;
+  IntroducerRange = SourceRange();
+  CaptureDefaultLoc = SourceLocation();
+  NumExplicitCaptures = 0;
+  Mutable = false;
+  ExplicitParams = false;
+  Cleanup = CleanupInfo();
+  ContainsUnexpandedParameterPack = false;
+  AutoTemplateParameterDepth = 0;
+  AutoTemplateParams.clear();
+  GLTemplateParameterList = nullptr;
+  PotentiallyCapturingExprs.clear();
+  NonODRUsedCapturingExprs.clear();
+  ExplicitCaptureRanges.clear();
+  ShadowingDecls.clear();
+  PotentialThisCaptureLocation = SourceLocation();
+}
+
 static const NamedDecl *getBestPropertyDecl(const ObjCPropertyRefExpr *PropE) {
   if (PropE->isExplicitProperty())
     return PropE->getExplicitProperty();
@@ -17,6 +17,7 @@
 #include "clang/AST/DeclCXX.h"
 #include "clang/AST/DeclFriend.h"
 #include "clang/AST/DeclObjC.h"
+#include "clang/AST/DeclTemplate.h"
 #include "clang/AST/Expr.h"
 #include "clang/AST/ExprCXX.h"
 #include "clang/AST/PrettyDeclStackTrace.h"
@@ -24,6 +25,7 @@
 #include "clang/Basic/DiagnosticOptions.h"
 #include "clang/Basic/PartialDiagnostic.h"
 #include "clang/Basic/TargetInfo.h"
+#include "clang/Basic/TimeTraceProfiler.h"
 #include "clang/Lex/HeaderSearch.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Sema/CXXFieldCollector.h"
@@ -39,6 +41,7 @@
 #include "clang/Sema/TemplateDeduction.h"
 #include "clang/Sema/TemplateInstCallback.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallSet.h"
 using namespace clang;
 using namespace sema;
@@ -93,6 +96,12 @@ public:
       SourceManager &SM = S->getSourceManager();
       SourceLocation IncludeLoc = SM.getIncludeLoc(SM.getFileID(Loc));
       if (IncludeLoc.isValid()) {
+        if (timeTraceProfilerEnabled()) {
+          const FileEntry *FE = SM.getFileEntryForID(SM.getFileID(Loc));
+          std::string Name = FE ? FE->getName().str() : std::string();
+          timeTraceProfilerBegin("Source", Name, Name, TTT_Sources);
+        }
+
         IncludeStack.push_back(IncludeLoc);
         S->DiagnoseNonDefaultPragmaPack(
             Sema::PragmaPackDiagnoseKind::NonDefaultStateAtInclude, IncludeLoc);
@@ -100,10 +109,13 @@ public:
       break;
     }
     case ExitFile:
-      if (!IncludeStack.empty())
+      if (!IncludeStack.empty()) {
         S->DiagnoseNonDefaultPragmaPack(
             Sema::PragmaPackDiagnoseKind::ChangedStateAtExit,
             IncludeStack.pop_back_val());
+
+        timeTraceProfilerEnd(TTT_Sources);
+      }
       break;
     default:
       break;
@@ -137,7 +149,9 @@ Sema::Sema(Preprocessor &pp, ASTContext &ctxt, ASTConsumer &consumer,
       ValueWithBytesObjCTypeMethod(nullptr), NSArrayDecl(nullptr),
       ArrayWithObjectsMethod(nullptr), NSDictionaryDecl(nullptr),
       DictionaryWithObjectsMethod(nullptr), GlobalNewDeleteDeclared(false),
-      TUKind(TUKind), NumSFINAEErrors(0),
+      TUKind(TUKind), NumSFINAEErrors(0), NumCandidatesRejectedEarly(0),
+      NumPendingInstantiationsPerformed(0), NumPendingInstantiationWaves(0),
+      MaxPendingInstantiationWave(0),
       FullyCheckedComparisonCategories(
           static_cast<unsigned>(ComparisonCategoryType::Last) + 1),
       AccessCheckingSFINAE(false), InNonInstantiationSFINAEContext(false),
@@ -420,10 +434,94 @@ void Sema::addExternalSource(ExternalSemaSource *E) {
   }
 }
 
+namespace {
+/// Counts the implicit special members that were declared in the classes of
+/// a translation unit, and how many of them were never referenced, so were
+/// declared only because a lookup or a check forced them.
+class ImplicitSpecialMemberStats {
+  unsigned Declared[Sema::CXXInvalid] = {};
+  unsigned Unreferenced[Sema::CXXInvalid] = {};
+  llvm::SmallPtrSet<const CXXRecordDecl *, 32> Visited;
+
+  static Sema::CXXSpecialMember classify(const CXXMethodDecl *MD) {
+    if (const auto *Ctor = dyn_cast<CXXConstructorDecl>(MD)) {
+      if (Ctor->isDefaultConstructor())
+        return Sema::CXXDefaultConstructor;
+      if (Ctor->isCopyConstructor())
+        return Sema::CXXCopyConstructor;
+      if (Ctor->isMoveConstructor())
+        return Sema::CXXMoveConstructor;
+      return Sema::CXXInvalid;
+    }
+    if (isa<CXXDestructorDecl>(MD))
+      return Sema::CXXDestructor;
+    if (MD->isCopyAssignmentOperator())
+      return Sema::CXXCopyAssignment;
+    if (MD->isMoveAssignmentOperator())
+      return Sema::CXXMoveAssignment;
+    return Sema::CXXInvalid;
+  }
+
+  void addClass(const CXXRecordDecl *RD) {
+    if (Visited.insert(RD).second)
+      addContext(RD);
+  }
+
+public:
+  /// Counts the implicit members of the classes in \p DC and in the contexts
+  /// nested in it, without deserializing any declarations.
+  void addContext(const DeclContext *DC) {
+    for (const Decl *D : DC->noload_decls()) {
+      if (const auto *MD = dyn_cast<CXXMethodDecl>(D)) {
+        if (!MD->isImplicit())
+          continue;
+        Sema::CXXSpecialMember Kind = classify(MD);
+        if (Kind == Sema::CXXInvalid)
+          continue;
+        ++Declared[Kind];
+        if (!MD->isReferenced())
+          ++Unreferenced[Kind];
+      } else if (const auto *RD = dyn_cast<CXXRecordDecl>(D)) {
+        addClass(RD);
+      } else if (const auto *CTD = dyn_cast<ClassTemplateDecl>(D)) {
+        // Implicit instantiations are not in any context's list.
+        for (const ClassTemplateSpecializationDecl *Spec :
+             CTD->noload_specializations())
+          addClass(Spec);
+      } else if (isa<NamespaceDecl>(D) || isa<LinkageSpecDecl>(D) ||
+                 isa<ExportDecl>(D)) {
+        addContext(cast<DeclContext>(D));
+      }
+    }
+  }
+
+  void print(raw_ostream &OS) const {
+    static const char *const Names[Sema::CXXInvalid] = {
+        "default constructors",      "copy constructors",
+        "move constructors",         "copy assignment operators",
+        "move assignment operators", "destructors"};
+    for (unsigned I = 0; I != Sema::CXXInvalid; ++I)
+      OS << Unreferenced[I] << "/" << Declared[I] << " implicit " << Names[I]
+         << " declared but never referenced.\n";
+  }
+};
+} // end anonymous namespace
+
 /// Print out statistics about the semantic analysis.
 void Sema::PrintStats() const {
   llvm::errs() << "\n*** Semantic Analysis Stats:\n";
   llvm::errs() << NumSFINAEErrors << " SFINAE diagnostics trapped.\n";
+  llvm::errs() << NumCandidatesRejectedEarly
+               << " overload candidates rejected on arity.\n";
+  llvm::errs() << NumPendingInstantiationsPerformed
+               << " pending instantiations performed in "
+               << NumPendingInstantiationWaves << " waves, at most "
+               << MaxPendingInstantiationWave << " in one wave.\n";
+  if (getLangOpts().CPlusPlus) {
+    ImplicitSpecialMemberStats ImplicitMembers;
+    ImplicitMembers.addContext(Context.getTranslationUnitDecl());
+    ImplicitMembers.print(llvm::errs());
+  }
 
   BumpAlloc.PrintStats();
   AnalysisWarnings.PrintStats();
@@ -865,9 +963,9 @@ void Sema::ActOnEndOfTranslationUnit() {
   assert(DelayedDiagnostics.getCurrentPool() == nullptr
          && "reached end of translation unit with a pool attached?");
 
-  // If code completion is enabled, don't perform any end-of-translation-unit
-  // work.
-  if (PP.isCodeCompletionEnabled())
+  // If code completion is enabled, or the translation unit is being
+  // abandoned, don't perform any end-of-translation-unit work.
+  if (PP.isCodeCompletionEnabled() || isCancellationRequested())
     return;
 
   // Transfer late parsed template instantiations over to the pending template
@@ -924,6 +1022,12 @@ void Sema::ActOnEndOfTranslationUnit() {
       LateTemplateParserCleanup(OpaqueParser);
 
     CheckDelayedMemberExceptionSpecs();
+  } else if (LangOpts.PCHInstantiateTemplates) {
+    // Instantiate what the PCH itself uses now, so that the instantiations
+    // are serialized with it rather than redone by every translation unit
+    // that includes it. Instantiations that are only triggered later still
+    // happen at the end of those translation units.
+    PerformPendingInstantiations();
   }
 
   DiagnoseUnterminatedPragmaPack();
@@ -1228,6 +1332,10 @@ void Sema::EmitCurrentDiagnostic(unsigned DiagID) {
   // issue I am not seeing yet), then there should at least be a clarifying
   // comment somewhere.
   if (Optional<TemplateDeductionInfo*> Info = isSFINAEContext()) {
+    bool IsNote = DiagnosticIDs::isBuiltinNote(Diags.getCurrentDiagID());
+    if (!IsNote)
+      DroppedSuppressedDiagnostic = false;
+
     switch (DiagnosticIDs::getDiagnosticSFINAEResponse(
               Diags.getCurrentDiagID())) {
     case DiagnosticIDs::SFINAE_Report:
@@ -1287,11 +1395,19 @@ void Sema::EmitCurrentDiagnostic(unsigned DiagID) {
 
     case DiagnosticIDs::SFINAE_Suppress:
       // Make a copy of this suppressed diagnostic and store it with the
-      // template-deduction information;
+      // template-deduction information, unless it would be ignored when it
+      // is emitted later: most of the warnings that code in templates runs
+      // into are off by default, and copying their arguments is wasted work.
       if (*Info) {
-        Diagnostic DiagInfo(&Diags);
-        (*Info)->addSuppressedDiagnostic(DiagInfo.getLocation(),
+        if (!IsNote)
+          DroppedSuppressedDiagnostic =
+              Diags.isIgnored(Diags.getCurrentDiagID(),
+                              Diags.getCurrentDiagLoc());
+        if (!DroppedSuppressedDiagnostic) {
+          Diagnostic DiagInfo(&Diags);
+          (*Info)->addSuppressedDiagnostic(DiagInfo.getLocation(),
                        PartialDiagnostic(DiagInfo, Context.getDiagAllocator()));
+        }
       }
 
       // Suppress this diagnostic.
@@ -1381,6 +1497,10 @@ void Sema::PushFunctionScope() {
     // Use PreallocatedFunctionScope to avoid allocating memory when possible.
     PreallocatedFunctionScope->Clear();
     FunctionScopes.push_back(PreallocatedFunctionScope.get());
+  } else if (!FunctionScopePool.empty()) {
+    FunctionScopeInfo *FSI = FunctionScopePool.pop_back_val().release();
+    FSI->Clear();
+    FunctionScopes.push_back(FSI);
   } else {
     FunctionScopes.push_back(new FunctionScopeInfo(getDiagnostics()));
   }
@@ -1394,7 +1514,13 @@ void Sema::PushBlockScope(Scope *BlockScope, BlockDecl *Block) {
 }
 
 LambdaScopeInfo *Sema::PushLambdaScope() {
-  LambdaScopeInfo *const LSI = new LambdaScopeInfo(getDiagnostics());
+  LambdaScopeInfo *LSI;
+  if (!LambdaScopePool.empty()) {
+    LSI = LambdaScopePool.pop_back_val().release();
+    LSI->Clear();
+  } else {
+    LSI = new LambdaScopeInfo(getDiagnostics());
+  }
   FunctionScopes.push_back(LSI);
   return LSI;
 }
@@ -1482,9 +1608,23 @@ void Sema::PopFunctionScopeInfo(const AnalysisBasedWarnings::Policy *WP,
     for (const auto &PUD : Scope->PossiblyUnreachableDiags)
       Diag(PUD.Loc, PUD.PD);
 
-  // Delete the scope unless its our preallocated scope.
-  if (Scope != PreallocatedFunctionScope.get())
-    delete Scope;
+  // Keep the scope for reuse, unless it's our preallocated scope. Only a few
+  // are ever needed at once; delete the rest.
+  const unsigned MaxPooledScopes = 8;
+  if (Scope == PreallocatedFunctionScope.get())
+    return;
+  if (auto *LSI = dyn_cast<LambdaScopeInfo>(Scope)) {
+    if (LambdaScopePool.size() < MaxPooledScopes) {
+      LambdaScopePool.emplace_back(LSI);
+      return;
+    }
+  } else if (!isa<CapturingScopeInfo>(Scope)) {
+    if (FunctionScopePool.size() < MaxPooledScopes) {
+      FunctionScopePool.emplace_back(Scope);
+      return;
+    }
+  }
+  delete Scope;
 }
 
 void Sema::PushCompoundScope(bool IsStmtExpr) {
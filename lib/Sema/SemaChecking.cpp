@@ -12038,7 +12038,10 @@ void Sema::CheckUnsequencedOperations(Expr *E) {
 void Sema::CheckCompletedExpr(Expr *E, SourceLocation CheckLoc,
                               bool IsConstexpr) {
   CheckImplicitConversions(E, CheckLoc);
-  if (!E->isInstantiationDependent())
+  // Skip the walk over the expression when nothing it finds can be reported.
+  if (!E->isInstantiationDependent() &&
+      !(Diags.isIgnoredEverywhere(diag::warn_unsequenced_mod_mod) &&
+        Diags.isIgnoredEverywhere(diag::warn_unsequenced_mod_use)))
     CheckUnsequencedOperations(E);
   if (!IsConstexpr && !E->isValueDependent())
     CheckForIntOverflow(E);
@@ -280,6 +280,13 @@ public:
   bool CheckHiddenResult(Result &R, DeclContext *CurContext,
                          const NamedDecl *Hiding);
 
+  /// Check whether the code-completion consumer does not want the result,
+  /// because it does not match the prefix that the consumer filters by.
+  bool isFilteredOut(const Result &R) const {
+    return SemaRef.CodeCompleter &&
+           !R.matchesTypedPrefix(SemaRef.CodeCompleter->getResultPrefix());
+  }
+
   /// Add a new result to this result set (if it isn't already in one
   /// of the shadow maps), or replace an existing result (for, e.g., a
   /// redeclaration).
@@ -838,6 +845,9 @@ static bool isConstructor(const Decl *ND) {
 void ResultBuilder::MaybeAddResult(Result R, DeclContext *CurContext) {
   assert(!ShadowMaps.empty() && "Must enter into a results scope");
 
+  if (isFilteredOut(R))
+    return;
+
   if (R.Kind != Result::RK_Declaration) {
     // For non-declaration results, just add the result.
     Results.push_back(R);
@@ -961,6 +971,9 @@ static void setInBaseClass(ResultBuilder::Result &R) {
 
 void ResultBuilder::AddResult(Result R, DeclContext *CurContext,
                               NamedDecl *Hiding, bool InBaseClass = false) {
+  if (isFilteredOut(R))
+    return;
+
   if (R.Kind != Result::RK_Declaration) {
     // For non-declaration results, just add the result.
     Results.push_back(R);
@@ -1048,6 +1061,8 @@ void ResultBuilder::AddResult(Result R, DeclContext *CurContext,
 void ResultBuilder::AddResult(Result R) {
   assert(R.Kind != Result::RK_Declaration &&
          "Declaration results need more context");
+  if (isFilteredOut(R))
+    return;
   Results.push_back(R);
 }
 
@@ -3482,8 +3497,10 @@ static void HandleCodeCompleteResults(Sema *S,
                                       CodeCompletionContext Context,
                                       CodeCompletionResult *Results,
                                       unsigned NumResults) {
-  if (CodeCompleter)
+  if (CodeCompleter) {
+    NumResults = CodeCompleter->filterResults(Results, NumResults);
     CodeCompleter->ProcessCodeCompleteResults(*S, Context, Results, NumResults);
+  }
 }
 
 static enum CodeCompletionContext::Kind
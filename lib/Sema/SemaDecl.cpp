@@ -13020,6 +13020,46 @@ Decl *Sema::ActOnSkippedFunctionBody(Decl *Decl) {
   return Decl;
 }
 
+bool Sema::ParseDeferredFunctionBody(FunctionDecl *FD) {
+  if (!FD->isLateTemplateParsed() || FD->isDependentContext() ||
+      !LateTemplateParser)
+    return false;
+
+  if (FD->isFromASTFile())
+    ExternalSource->ReadLateParsedTemplates(LateParsedTemplateMap);
+
+  auto LPTIter = LateParsedTemplateMap.find(FD);
+  if (LPTIter == LateParsedTemplateMap.end())
+    return false;
+
+  LateTemplateParser(OpaqueParser, *LPTIter->second);
+
+  // The end of the translation unit has already been processed; instantiate
+  // whatever the new body needs now.
+  PerformPendingInstantiations();
+  return true;
+}
+
+void Sema::ParseDeferredFunctionBodies(SourceRange Range) {
+  SmallVector<FunctionDecl *, 8> Overlapping;
+  for (auto &LPT : LateParsedTemplateMap) {
+    FunctionDecl *FD = const_cast<FunctionDecl *>(LPT.first);
+    const CachedTokens &Toks = LPT.second->Toks;
+    if (!FD->isLateTemplateParsed() || FD->isDependentContext() ||
+        Toks.empty())
+      continue;
+    if (SourceMgr.isBeforeInTranslationUnit(Toks.back().getLocation(),
+                                            Range.getBegin()) ||
+        SourceMgr.isBeforeInTranslationUnit(Range.getEnd(),
+                                            Toks.front().getLocation()))
+      continue;
+    Overlapping.push_back(FD);
+  }
+
+  for (FunctionDecl *FD : Overlapping)
+    ParseDeferredFunctionBody(FD);
+}
+
 Decl *Sema::ActOnFinishFunctionBody(Decl *D, Stmt *BodyArg) {
   return ActOnFinishFunctionBody(D, BodyArg, false);
 }
@@ -13034,9 +13074,15 @@ Decl *Sema::ActOnFinishFunctionBody(Decl *dcl, Stmt *Body,
   if (getLangOpts().CoroutinesTS && getCurFunction()->isCoroutine())
     CheckCompletedCoroutineBody(FD, Body);
 
+  // A deferred body that is parsed now was skipped, and diagnosed as such,
+  // when its definition was first seen.
+  bool ParsedDeferredBody = FD && Body && FD->hasSkippedBody();
+
   if (FD) {
     FD->setBody(Body);
     FD->setWillHaveBody(false);
+    if (ParsedDeferredBody)
+      FD->setHasSkippedBody(false);
 
     if (getLangOpts().CPlusPlus14) {
       if (!FD->isInvalidDecl() && Body && !FD->isDependentContext() &&
@@ -13113,7 +13159,8 @@ Decl *Sema::ActOnFinishFunctionBody(Decl *dcl, Stmt *Body,
     //   definition itself provides a prototype. The aim is to detect
     //   global functions that fail to be declared in header files.
     const FunctionDecl *PossibleZeroParamPrototype = nullptr;
-    if (ShouldWarnAboutMissingPrototype(FD, PossibleZeroParamPrototype)) {
+    if (!ParsedDeferredBody &&
+        ShouldWarnAboutMissingPrototype(FD, PossibleZeroParamPrototype)) {
       Diag(FD->getLocation(), diag::warn_missing_prototype) << FD;
 
       if (PossibleZeroParamPrototype) {
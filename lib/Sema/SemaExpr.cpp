@@ -1675,6 +1675,21 @@ Sema::ActOnStringLiteral(ArrayRef<Token> StringToks, Scope *UDLScope) {
   llvm_unreachable("unexpected literal operator lookup result");
 }
 
+ExprResult Sema::ActOnEmbedExpr(SourceRange Range, StringRef Data) {
+  // The bytes are a string literal without a nul terminator, so that an array
+  // of unknown bound that they initialize gets exactly one element per byte.
+  QualType CharTy = Context.CharTy;
+  if (getLangOpts().CPlusPlus || getLangOpts().ConstStrings)
+    CharTy.addConst();
+  CharTy = Context.adjustStringLiteralBaseType(CharTy);
+
+  QualType StrTy = Context.getConstantArrayType(
+      CharTy, llvm::APInt(32, Data.size()), ArrayType::Normal, 0);
+  SourceLocation Loc = Range.getBegin();
+  return StringLiteral::Create(Context, Data, StringLiteral::Ascii,
+                               /*Pascal=*/false, StrTy, &Loc, 1);
+}
+
 ExprResult
 Sema::BuildDeclRefExpr(ValueDecl *D, QualType Ty, ExprValueKind VK,
                        SourceLocation Loc,
@@ -3264,8 +3279,10 @@ ExprResult Sema::ActOnNumericConstant(const Token &Tok, Scope *UDLScope) {
   // NumericLiteralParser wants to overread by one character.  Add padding to
   // the buffer in case the token is copied to the buffer.  If getSpelling()
   // returns a StringRef to the memory buffer, it should have a null char at
-  // the EOF, so it is also safe.
-  SpellingBuffer.resize(Tok.getLength() + 1);
+  // the EOF, so it is also safe. That is the common case, so only clear the
+  // buffer for a token that is copied.
+  if (Tok.needsCleaning())
+    SpellingBuffer.resize(Tok.getLength() + 1);
 
   // Get the spelling of the token, which eliminates trigraphs, etc.
   bool Invalid = false;
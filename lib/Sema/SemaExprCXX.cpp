@@ -4708,6 +4708,10 @@ static bool EvaluateUnaryTypeTrait(Sema &Self, TypeTrait UTT,
     //   expression std::declval<U&>().~U() is well-formed when treated as an
     //   unevaluated operand (Clause 5), then is_destructible<T>::value is true
     if (auto *RD = C.getBaseElementType(T)->getAsCXXRecordDecl()) {
+      // A trivial implicit destructor is public and noexcept; don't declare
+      // it only to check that.
+      if (Self.hasTrivialUsableDestructor(RD))
+        return true;
       CXXDestructorDecl *Destructor = Self.LookupDestructor(RD);
       if (!Destructor)
         return false;
@@ -4865,9 +4869,13 @@ static bool EvaluateUnaryTypeTrait(Sema &Self, TypeTrait UTT,
     // http://gcc.gnu.org/onlinedocs/gcc/Type-Traits.html:
     //   If type is a class type with a virtual destructor ([class.dtor])
     //   then the trait is true, else it is false.
-    if (CXXRecordDecl *RD = T->getAsCXXRecordDecl())
+    if (CXXRecordDecl *RD = T->getAsCXXRecordDecl()) {
+      // A class with a virtual destructor is polymorphic.
+      if (RD->hasDefinition() && !RD->isPolymorphic())
+        return false;
       if (CXXDestructorDecl *Destructor = Self.LookupDestructor(RD))
         return Destructor->isVirtual();
+    }
     return false;
 
     // These type trait expressions are modeled on the specifications for the
@@ -6453,6 +6461,11 @@ ExprResult Sema::MaybeBindToTemporary(Expr *E) {
 
   bool IsDecltype = ExprEvalContexts.back().ExprContext ==
                     ExpressionEvaluationContextRecord::EK_Decltype;
+
+  // A temporary with a trivial, accessible destructor needs no binding.
+  if (!IsDecltype && hasTrivialUsableDestructor(RD))
+    return E;
+
   CXXDestructorDecl *Destructor = IsDecltype ? nullptr : LookupDestructor(RD);
 
   if (Destructor) {
@@ -1862,7 +1862,7 @@ bool InitListChecker::CheckFlexibleArrayInit(const InitializedEntity &Entity,
 static bool hasAccessibleDestructor(QualType ElementType, SourceLocation Loc,
                                     Sema &SemaRef) {
   auto *CXXRD = ElementType->getAsCXXRecordDecl();
-  if (!CXXRD)
+  if (!CXXRD || SemaRef.hasTrivialUsableDestructor(CXXRD))
     return false;
 
   CXXDestructorDecl *Destructor = SemaRef.LookupDestructor(CXXRD);
@@ -5650,6 +5650,35 @@ void InitializationSequence::InitializeFrom(Sema &S,
   //      initializer expression to the cv-unqualified version of the
   //      destination type; no user-defined conversions are considered.
 
+  // If the initializer already has the destination type, the only standard
+  // conversion that can apply is lvalue-to-rvalue, so build the sequence
+  // directly instead of searching for one. This is by far the most common
+  // case for the elements of large scalar initializer lists. Retainable
+  // Objective-C types are left to the general path, since their ownership
+  // qualifiers take part in the conversion.
+  if (DestType->isScalarType() && !DestType->isObjCRetainableType() &&
+      Context.hasSameUnqualifiedType(SourceType, DestType)) {
+    ImplicitConversionSequence ICS;
+    ICS.setStandard();
+    ICS.Standard.setAsIdentityConversion();
+    ICS.Standard.IncompatibleObjC = false;
+    ICS.Standard.setFromType(SourceType);
+    if (Initializer->isGLValue()) {
+      ICS.Standard.First = ICK_Lvalue_To_Rvalue;
+      SourceType = SourceType.getUnqualifiedType();
+    }
+    ICS.Standard.setToType(0, SourceType);
+    ICS.Standard.setToType(1, SourceType);
+    // Differences in top-level cv-qualifiers are subsumed by the
+    // initialization itself, as in IsStandardConversion.
+    if (!Context.hasSameType(SourceType, DestType))
+      SourceType = DestType;
+    ICS.Standard.setToType(2, SourceType);
+
+    AddConversionSequenceStep(ICS, DestType, TopLevelOfInitList);
+    return;
+  }
+
   ImplicitConversionSequence ICS
     = S.TryImplicitConversion(Initializer, DestType,
                               /*SuppressUserConversions*/true,
@@ -7644,7 +7673,9 @@ ExprResult InitializationSequence::Perform(Sema &S,
         // FIXME: It makes no sense to do this here. This should happen
         // regardless of how we initialized the entity.
         QualType T = CurInit.get()->getType();
-        if (const RecordType *Record = T->getAs<RecordType>()) {
+        const RecordType *Record = T->getAs<RecordType>();
+        if (Record && !S.hasTrivialUsableDestructor(
+                          cast<CXXRecordDecl>(Record->getDecl()))) {
           CXXDestructorDecl *Destructor
             = S.LookupDestructor(cast<CXXRecordDecl>(Record->getDecl()));
           S.CheckDestructorAccess(CurInit.get()->getBeginLoc(), Destructor,
@@ -686,6 +686,9 @@ static bool LookupBuiltin(Sema &S, LookupResult &R) {
         } else if (II == S.getASTContext().getTypePackElementName()) {
           R.addDecl(S.getASTContext().getTypePackElementDecl());
           return true;
+        } else if (II == S.getASTContext().getTypePackSliceName()) {
+          R.addDecl(S.getASTContext().getTypePackSliceDecl());
+          return true;
         }
       }
 
@@ -2120,6 +2123,18 @@ bool Sema::LookupQualifiedName(LookupResult &R, DeclContext *LookupCtx,
   }
 
   DeclarationName Name = R.getLookupName();
+
+  // Most names that are not members of the class are not members of any of
+  // its bases either. Rule that out by looking into each base class once,
+  // rather than once per path to it.
+  if (Optional<ArrayRef<const CXXRecordDecl *>> AllBases =
+          LookupRec->getAllBases()) {
+    if (llvm::none_of(*AllBases, [&](const CXXRecordDecl *Base) {
+          return !Base->lookup(Name).empty();
+        }))
+      return false;
+  }
+
   if (!LookupRec->lookupInBases(
           [=](const CXXBaseSpecifier *Specifier, CXXBasePath &Path) {
             return BaseCallback(Specifier, Path, Name);
@@ -3141,6 +3156,20 @@ CXXDestructorDecl *Sema::LookupDestructor(CXXRecordDecl *Class) {
                                                      false, false).getMethod());
 }
 
+/// Determine whether the definition data of the given class shows that its
+/// destructor is trivial, accessible and not deleted.
+///
+/// Using such a destructor needs no check and no cleanup, so the callers
+/// that only look it up for those can skip the lookup, which would declare
+/// an implicit destructor that is never referenced.
+bool Sema::hasTrivialUsableDestructor(const CXXRecordDecl *Class) {
+  // CUDA checks the target of every destructor that is used.
+  if (getLangOpts().CUDA)
+    return false;
+  return Class->hasDefinition() && Class->hasKnownSimpleDestructor() &&
+         Class->hasTrivialDestructor();
+}
+
 /// LookupLiteralOperator - Determine which literal operator should be used for
 /// a user-defined literal, per C++11 [lex.ext].
 ///
@@ -3967,6 +3996,28 @@ void TypoCorrectionConsumer::FoundDecl(NamedDecl *ND, NamedDecl *Hiding,
   FoundName(Name->getName());
 }
 
+void TypoCorrectionNameIndex::update(IdentifierInfoLookup &External,
+                                     uint32_t Generation) {
+  if (IsBuilt && this->Generation == Generation)
+    return;
+
+  NamesByLength.clear();
+  Allocator.Reset();
+  std::unique_ptr<IdentifierIterator> Iter(External.getIdentifiers());
+  while (true) {
+    StringRef Name = Iter->Next();
+    if (Name.empty())
+      break;
+    if (Name.size() >= NamesByLength.size())
+      NamesByLength.resize(Name.size() + 1);
+    // The iterator does not guarantee that the names it returns remain valid.
+    NamesByLength[Name.size()].push_back(Name.copy(Allocator));
+  }
+
+  this->Generation = Generation;
+  IsBuilt = true;
+}
+
 void TypoCorrectionConsumer::FoundName(StringRef Name) {
   // Compute the edit distance between the typo and the name of this
   // entity, and add the identifier to the list of results.
@@ -4662,18 +4713,25 @@ std::unique_ptr<TypoCorrectionConsumer> Sema::makeTypoCorrectionConsumer(
     for (const auto &I : Context.Idents)
       Consumer->FoundName(I.getKey());
 
-    // Walk through identifiers in external identifier sources.
-    // FIXME: Re-add the ability to skip very unlikely potential corrections.
+    // Walk through identifiers in external identifier sources. Only names
+    // whose length differs from the typo's by at most a third of it can be
+    // accepted by TypoCorrectionConsumer::addName, so skip the others.
     if (IdentifierInfoLookup *External
                             = Context.Idents.getExternalIdentifierLookup()) {
-      std::unique_ptr<IdentifierIterator> Iter(External->getIdentifiers());
-      do {
-        StringRef Name = Iter->Next();
-        if (Name.empty())
-          break;
-
-        Consumer->FoundName(Name);
-      } while (true);
+      if (!ExternalTypoCorrectionNames)
+        ExternalTypoCorrectionNames =
+            llvm::make_unique<TypoCorrectionNameIndex>();
+      ExternalASTSource *Source = Context.getExternalSource();
+      ExternalTypoCorrectionNames->update(*External,
+                                          Source ? Source->getGeneration() : 0);
+
+      unsigned TypoLength = Typo->getLength();
+      for (unsigned Length = TypoLength - TypoLength / 3,
+                    MaxLength = TypoLength + TypoLength / 3;
+           Length <= MaxLength; ++Length)
+        for (StringRef Name :
+             ExternalTypoCorrectionNames->getNamesOfLength(Length))
+          Consumer->FoundName(Name);
     }
   }
 
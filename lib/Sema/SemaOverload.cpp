@@ -23,6 +23,7 @@
 #include "clang/Basic/DiagnosticOptions.h"
 #include "clang/Basic/PartialDiagnostic.h"
 #include "clang/Basic/TargetInfo.h"
+#include "clang/Basic/TimeTraceProfiler.h"
 #include "clang/Sema/Initialization.h"
 #include "clang/Sema/Lookup.h"
 #include "clang/Sema/SemaInternal.h"
@@ -63,8 +64,11 @@ CreateFunctionRefExpr(Sema &S, FunctionDecl *Fn, NamedDecl *FoundDecl,
     return ExprError();
   if (auto *FPT = Fn->getType()->getAs<FunctionProtoType>())
     S.ResolveExceptionSpec(Loc, FPT);
-  DeclRefExpr *DRE = new (S.Context) DeclRefExpr(Fn, false, Fn->getType(),
-                                                 VK_LValue, Loc, LocInfo);
+  DeclRefExpr *DRE = DeclRefExpr::Create(
+      S.Context, NestedNameSpecifierLoc(), SourceLocation(), Fn,
+      /*RefersToEnclosingVariableOrCapture=*/false,
+      DeclarationNameInfo(Fn->getDeclName(), Loc, LocInfo), Fn->getType(),
+      VK_LValue);
   if (HadMultipleCandidates)
     DRE->setHadMultipleCandidates(true);
 
@@ -6069,6 +6073,7 @@ Sema::AddOverloadCandidate(FunctionDecl *Function,
       !Proto->isVariadic()) {
     Candidate.Viable = false;
     Candidate.FailureKind = ovl_fail_too_many_arguments;
+    ++NumCandidatesRejectedEarly;
     return;
   }
 
@@ -6082,6 +6087,7 @@ Sema::AddOverloadCandidate(FunctionDecl *Function,
     // Not enough arguments.
     Candidate.Viable = false;
     Candidate.FailureKind = ovl_fail_too_few_arguments;
+    ++NumCandidatesRejectedEarly;
     return;
   }
 
@@ -6551,6 +6557,7 @@ Sema::AddMethodCandidate(CXXMethodDecl *Method, DeclAccessPair FoundDecl,
       !Proto->isVariadic()) {
     Candidate.Viable = false;
     Candidate.FailureKind = ovl_fail_too_many_arguments;
+    ++NumCandidatesRejectedEarly;
     return;
   }
 
@@ -6564,6 +6571,7 @@ Sema::AddMethodCandidate(CXXMethodDecl *Method, DeclAccessPair FoundDecl,
     // Not enough arguments.
     Candidate.Viable = false;
     Candidate.FailureKind = ovl_fail_too_few_arguments;
+    ++NumCandidatesRejectedEarly;
     return;
   }
 
@@ -6676,6 +6684,9 @@ Sema::AddMethodTemplateCandidate(FunctionTemplateDecl *MethodTmpl,
                 SuppressUserConversions, ActingContext, ObjectType,
                 ObjectClassification);
           })) {
+    // Deduction checks the number of arguments before deducing anything.
+    if (Result == TDK_TooFewArguments || Result == TDK_TooManyArguments)
+      ++NumCandidatesRejectedEarly;
     OverloadCandidate &Candidate =
         CandidateSet.addCandidate(Conversions.size(), Conversions);
     Candidate.FoundDecl = FoundDecl;
@@ -6740,6 +6751,9 @@ Sema::AddTemplateOverloadCandidate(FunctionTemplateDecl *FunctionTemplate,
                                                 Args, CandidateSet, Conversions,
                                                 SuppressUserConversions);
           })) {
+    // Deduction checks the number of arguments before deducing anything.
+    if (Result == TDK_TooFewArguments || Result == TDK_TooManyArguments)
+      ++NumCandidatesRejectedEarly;
     OverloadCandidate &Candidate =
         CandidateSet.addCandidate(Conversions.size(), Conversions);
     Candidate.FoundDecl = FoundDecl;
@@ -12098,6 +12112,9 @@ ExprResult Sema::BuildOverloadedCallExpr(Scope *S, Expr *Fn,
                                          Expr *ExecConfig,
                                          bool AllowTypoCorrection,
                                          bool CalleesAddressIsTaken) {
+  auto GetName = [&]() { return ULE->getName().getAsString(); };
+  TimeTraceScope TimeScope("OverloadResolution", GetName, GetName);
+
   OverloadCandidateSet CandidateSet(Fn->getExprLoc(),
                                     OverloadCandidateSet::CSK_Normal);
   ExprResult result;
@@ -12151,6 +12168,9 @@ Sema::CreateOverloadedUnaryOp(SourceLocation OpLoc, UnaryOperatorKind Opc,
   // TODO: provide better source location info.
   DeclarationNameInfo OpNameInfo(OpName, OpLoc);
 
+  auto GetName = [&]() { return OpName.getAsString(); };
+  TimeTraceScope TimeScope("OverloadResolution", GetName, GetName);
+
   if (checkPlaceholderForOverload(*this, Input))
     return ExprError();
 
@@ -12345,6 +12365,9 @@ Sema::CreateOverloadedBinOp(SourceLocation OpLoc,
   OverloadedOperatorKind Op = BinaryOperator::getOverloadedOperator(Opc);
   DeclarationName OpName = Context.DeclarationNames.getCXXOperatorName(Op);
 
+  auto GetName = [&]() { return OpName.getAsString(); };
+  TimeTraceScope TimeScope("OverloadResolution", GetName, GetName);
+
   // If either side is type-dependent, create an appropriate dependent
   // expression.
   if (Args[0]->isTypeDependent() || Args[1]->isTypeDependent()) {
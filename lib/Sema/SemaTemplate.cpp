@@ -2970,7 +2970,7 @@ checkBuiltinTemplateIdType(Sema &SemaRef, BuiltinTemplateDecl *BTD,
                                        TemplateLoc, SyntheticTemplateArgs);
   }
 
-  case BTK__type_pack_element:
+  case BTK__type_pack_element: {
     // Specializations of
     //    __type_pack_element<Index, T_1, ..., T_N>
     // are treated like T_Index.
@@ -2992,6 +2992,36 @@ checkBuiltinTemplateIdType(Sema &SemaRef, BuiltinTemplateDecl *BTD,
     auto Nth = std::next(Ts.pack_begin(), Index.getExtValue());
     return Nth->getAsType();
   }
+
+  case BTK__type_pack_slice: {
+    // Specializations of
+    //    __type_pack_slice<Seq, Begin, End, T_0, ..., T_N-1>
+    // are treated like Seq<T_Begin, ..., T_End-1>.
+    assert(Converted.size() == 4 &&
+           "__type_pack_slice should be given a template, two indices and a "
+           "parameter pack");
+
+    // If the slice does not lie within the pack, the program is ill-formed.
+    llvm::APSInt Begin = Converted[1].getAsIntegral();
+    llvm::APSInt End = Converted[2].getAsIntegral();
+    TemplateArgument Ts = Converted[3];
+    if (Begin > End || End > Ts.pack_size()) {
+      SemaRef.Diag(TemplateArgs[1].getLocation(),
+                   diag::err_type_pack_slice_out_of_bounds)
+          << Begin.toString(10) << End.toString(10) << Ts.pack_size();
+      return QualType();
+    }
+
+    TemplateArgumentListInfo SyntheticTemplateArgs;
+    for (const TemplateArgument &T :
+         Ts.pack_elements().slice(Begin.getZExtValue(),
+                                  End.getZExtValue() - Begin.getZExtValue()))
+      SyntheticTemplateArgs.addArgument(SemaRef.getTrivialTemplateArgumentLoc(
+          T, QualType(), TemplateArgs[2].getLocation()));
+    return SemaRef.CheckTemplateIdType(Converted[0].getAsTemplate(),
+                                       TemplateLoc, SyntheticTemplateArgs);
+  }
+  }
   llvm_unreachable("unexpected BuiltinTemplateDecl!");
 }
 
@@ -5083,7 +5113,10 @@ bool Sema::CheckTemplateArgumentList(
         // The template parameter was a template parameter pack, so take the
         // deduced argument and place it on the argument pack. Note that we
         // stay on the same template parameter so that we can deduce more
-        // arguments.
+        // arguments. Packs can be very long, so make room for all of the
+        // remaining arguments up front.
+        if (ArgumentPack.empty())
+          ArgumentPack.reserve(NumArgs - ArgIdx + 1);
         ArgumentPack.push_back(Converted.pop_back_val());
       } else {
         // Move to the next template parameter.
@@ -20,6 +20,7 @@
 #include "clang/AST/Expr.h"
 #include "clang/AST/PrettyDeclStackTrace.h"
 #include "clang/Basic/LangOptions.h"
+#include "clang/Basic/TimeTraceProfiler.h"
 #include "clang/Sema/DeclSpec.h"
 #include "clang/Sema/Initialization.h"
 #include "clang/Sema/Lookup.h"
@@ -2028,6 +2029,16 @@ Sema::InstantiateClass(SourceLocation PointOfInstantiation,
   assert(!Inst.isAlreadyInstantiating() && "should have been caught by caller");
   PrettyDeclStackTraceEntry CrashInfo(Context, Instantiation, SourceLocation(),
                                       "instantiating class definition");
+  TimeTraceScope TimeScope(
+      "InstantiateClass",
+      [&]() {
+        std::string Name;
+        llvm::raw_string_ostream OS(Name);
+        Instantiation->getNameForDiagnostic(OS, getPrintingPolicy(),
+                                            /*Qualified=*/true);
+        return OS.str();
+      },
+      [&]() { return Pattern->getQualifiedNameAsString(); });
 
   // Enter the scope of this instantiation. We don't use
   // PushDeclContext because we don't have a scope.
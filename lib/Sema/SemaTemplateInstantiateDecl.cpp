@@ -20,6 +20,7 @@
 #include "clang/AST/ExprCXX.h"
 #include "clang/AST/PrettyDeclStackTrace.h"
 #include "clang/AST/TypeLoc.h"
+#include "clang/Basic/TimeTraceProfiler.h"
 #include "clang/Sema/Initialization.h"
 #include "clang/Sema/Lookup.h"
 #include "clang/Sema/Template.h"
@@ -3913,6 +3914,16 @@ void Sema::InstantiateFunctionDefinition(SourceLocation PointOfInstantiation,
     return;
   PrettyDeclStackTraceEntry CrashInfo(Context, Function, SourceLocation(),
                                       "instantiating function definition");
+  TimeTraceScope TimeScope(
+      "InstantiateFunction",
+      [&]() {
+        std::string Name;
+        llvm::raw_string_ostream OS(Name);
+        Function->getNameForDiagnostic(OS, getPrintingPolicy(),
+                                       /*Qualified=*/true);
+        return OS.str();
+      },
+      [&]() { return PatternDecl->getQualifiedNameAsString(); });
 
   // The instantiation is visible here, even if it was first declared in an
   // unimported module.
@@ -5191,11 +5202,24 @@ NamedDecl *Sema::FindInstantiatedDecl(SourceLocation Loc, NamedDecl *D,
 /// Performs template instantiation for all implicit template
 /// instantiations we have seen until this point.
 void Sema::PerformPendingInstantiations(bool LocalOnly) {
+  // The number of instantiations left in the current wave of the queue of
+  // pending instantiations.
+  size_t WaveRemaining = 0;
+
   while (!PendingLocalImplicitInstantiations.empty() ||
          (!LocalOnly && !PendingInstantiations.empty())) {
     PendingImplicitInstantiation Inst;
 
     if (PendingLocalImplicitInstantiations.empty()) {
+      if (!WaveRemaining) {
+        WaveRemaining = PendingInstantiations.size();
+        ++NumPendingInstantiationWaves;
+        MaxPendingInstantiationWave =
+            std::max<unsigned>(MaxPendingInstantiationWave, WaveRemaining);
+      }
+      --WaveRemaining;
+      ++NumPendingInstantiationsPerformed;
+
       Inst = PendingInstantiations.front();
       PendingInstantiations.pop_front();
     } else {
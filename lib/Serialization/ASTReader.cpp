@@ -14,6 +14,7 @@
 #include "clang/Serialization/ASTReader.h"
 #include "ASTCommon.h"
 #include "ASTReaderInternals.h"
+#include "IdentifierFilter.h"
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/ASTMutationListener.h"
@@ -32,6 +33,7 @@
 #include "clang/AST/NestedNameSpecifier.h"
 #include "clang/AST/ODRHash.h"
 #include "clang/AST/RawCommentList.h"
+#include "clang/AST/RecordLayout.h"
 #include "clang/AST/TemplateBase.h"
 #include "clang/AST/TemplateName.h"
 #include "clang/AST/Type.h"
@@ -59,6 +61,7 @@
 #include "clang/Basic/Specifiers.h"
 #include "clang/Basic/TargetInfo.h"
 #include "clang/Basic/TargetOptions.h"
+#include "clang/Basic/TimeTraceProfiler.h"
 #include "clang/Basic/TokenKinds.h"
 #include "clang/Basic/Version.h"
 #include "clang/Frontend/PCHContainerOperations.h"
@@ -107,6 +110,7 @@
 #include "llvm/Support/Compression.h"
 #include "llvm/Support/DJB.h"
 #include "llvm/Support/Endian.h"
+#include "llvm/Support/EndianStream.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
@@ -121,6 +125,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
 #include <ctime>
 #include <iterator>
 #include <limits>
@@ -1384,15 +1389,29 @@ bool ASTReader::ReadSLocEntry(int ID) {
         Error("zlib is not available");
         return nullptr;
       }
-      SmallString<0> Uncompressed;
-      if (llvm::Error E =
-              llvm::zlib::uncompress(Blob, Uncompressed, Record[0])) {
+      // Decompress straight into the buffer's own storage rather than into a
+      // temporary that is then copied.
+      size_t UncompressedSize = Record[0];
+      auto Uncompressed =
+          llvm::WritableMemoryBuffer::getNewUninitMemBuffer(UncompressedSize,
+                                                            Name);
+      if (!Uncompressed) {
+        Error("could not allocate memory for embedded file contents");
+        return nullptr;
+      }
+      if (llvm::Error E = llvm::zlib::uncompress(
+              Blob, Uncompressed->getBufferStart(), UncompressedSize)) {
         Error("could not decompress embedded file contents: " +
               llvm::toString(std::move(E)));
         return nullptr;
       }
-      return llvm::MemoryBuffer::getMemBufferCopy(Uncompressed, Name);
+      if (UncompressedSize != Record[0]) {
+        Error("embedded file contents have the wrong size");
+        return nullptr;
+      }
+      return std::move(Uncompressed);
     } else if (RecCode == SM_SLOC_BUFFER_BLOB) {
+      // The blob lives as long as the module file, so refer to it in place.
       return llvm::MemoryBuffer::getMemBuffer(Blob.drop_back(1), Name, true);
     } else {
       Error("AST record has invalid code");
@@ -1876,16 +1895,19 @@ namespace {
     unsigned PriorGeneration;
     unsigned &NumIdentifierLookups;
     unsigned &NumIdentifierLookupHits;
+    unsigned &NumIdentifierLookupsFiltered;
     IdentifierInfo *Found = nullptr;
 
   public:
     IdentifierLookupVisitor(StringRef Name, unsigned PriorGeneration,
                             unsigned &NumIdentifierLookups,
-                            unsigned &NumIdentifierLookupHits)
+                            unsigned &NumIdentifierLookupHits,
+                            unsigned &NumIdentifierLookupsFiltered)
       : Name(Name), NameHash(ASTIdentifierLookupTrait::ComputeHash(Name)),
         PriorGeneration(PriorGeneration),
         NumIdentifierLookups(NumIdentifierLookups),
-        NumIdentifierLookupHits(NumIdentifierLookupHits) {}
+        NumIdentifierLookupHits(NumIdentifierLookupHits),
+        NumIdentifierLookupsFiltered(NumIdentifierLookupsFiltered) {}
 
     bool operator()(ModuleFile &M) {
       // If we've already searched this module file, skip it now.
@@ -1897,6 +1919,13 @@ namespace {
       if (!IdTable)
         return false;
 
+      // Most module files don't know most identifiers; rule this one out
+      // without probing the hash table if we can.
+      if (!IdentifierFilter(M.IdentifierFilterData).mayContain(NameHash)) {
+        ++NumIdentifierLookupsFiltered;
+        return false;
+      }
+
       ASTIdentifierLookupTrait Trait(IdTable->getInfoObj().getReader(), M,
                                      Found);
       ++NumIdentifierLookups;
@@ -1940,7 +1969,8 @@ void ASTReader::updateOutOfDateIdentifier(IdentifierInfo &II) {
 
   IdentifierLookupVisitor Visitor(II.getName(), PriorGeneration,
                                   NumIdentifierLookups,
-                                  NumIdentifierLookupHits);
+                                  NumIdentifierLookupHits,
+                                  NumIdentifierLookupsFiltered);
   ModuleMgr.visit(Visitor, HitsPtr);
   markIdentifierUpToDate(&II);
 }
@@ -2093,6 +2123,156 @@ ASTReader::readInputFileInfo(ModuleFile &F, unsigned ID) {
   return R;
 }
 
+//===----------------------------------------------------------------------===//
+// Input validation manifest
+//===----------------------------------------------------------------------===//
+
+// The manifest file consists of a header
+//
+//   magic "CIVM", version (u32), build session timestamp (u64),
+//   number of entries (u32)
+//
+// followed by that many entries of
+//
+//   size (u64), modification time (u64), flags (u32), path length (u32), path
+//
+// where bit 0 of the flags says whether the system input files were
+// validated.
+static const char ValidationManifestMagic[] = {'C', 'I', 'V', 'M'};
+static const uint32_t ValidationManifestVersion = 1;
+
+InputValidationManifest::InputValidationManifest(
+    StringRef ManifestFile, uint64_t BuildSessionTimestamp)
+    : ManifestFile(ManifestFile), BuildSessionTimestamp(BuildSessionTimestamp) {
+  if (read(Entries))
+    Entries.clear();
+}
+
+bool InputValidationManifest::read(llvm::StringMap<Entry> &Entries) const {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(ManifestFile);
+  if (!Buffer)
+    return true;
+
+  using namespace llvm::support;
+  StringRef Data = (*Buffer)->getBuffer();
+  if (Data.size() < sizeof(ValidationManifestMagic) + 16 ||
+      memcmp(Data.data(), ValidationManifestMagic,
+             sizeof(ValidationManifestMagic)) != 0)
+    return true;
+  const char *Ptr = Data.data() + sizeof(ValidationManifestMagic);
+  const char *End = Data.end();
+  if (endian::read32le(Ptr) != ValidationManifestVersion ||
+      endian::read64le(Ptr + 4) != BuildSessionTimestamp)
+    return true;
+  uint32_t NumEntries = endian::read32le(Ptr + 12);
+  Ptr += 16;
+
+  for (; NumEntries; --NumEntries) {
+    if (End - Ptr < 24)
+      return true;
+    Entry E;
+    E.Size = endian::read64le(Ptr);
+    E.ModTime = endian::read64le(Ptr + 8);
+    E.IncludesSystemInputs = endian::read32le(Ptr + 16) & 1;
+    uint32_t PathLength = endian::read32le(Ptr + 20);
+    Ptr += 24;
+    if (size_t(End - Ptr) < PathLength)
+      return true;
+    Entries[StringRef(Ptr, PathLength)] = E;
+    Ptr += PathLength;
+  }
+  return false;
+}
+
+bool InputValidationManifest::isValidated(const FileEntry *ASTFile,
+                                          bool IncludesSystemInputs) const {
+  auto Known = Entries.find(ASTFile->getName());
+  if (Known == Entries.end())
+    return false;
+  const Entry &E = Known->second;
+  return E.Size == uint64_t(ASTFile->getSize()) &&
+         E.ModTime == uint64_t(ASTFile->getModificationTime()) &&
+         (E.IncludesSystemInputs || !IncludesSystemInputs);
+}
+
+void InputValidationManifest::noteValidated(const FileEntry *ASTFile,
+                                            bool IncludesSystemInputs) {
+  if (isValidated(ASTFile, IncludesSystemInputs))
+    return;
+  Entry &E = Entries[ASTFile->getName()];
+  E.Size = ASTFile->getSize();
+  E.ModTime = ASTFile->getModificationTime();
+  E.IncludesSystemInputs = IncludesSystemInputs;
+  Changed = true;
+}
+
+void InputValidationManifest::writeToDisk() {
+  if (!Changed)
+    return;
+  Changed = false;
+
+  // Keep what other compilations recorded since we read the manifest, unless
+  // we know better.
+  llvm::StringMap<Entry> Merged;
+  if (read(Merged))
+    Merged.clear();
+  for (auto &E : Entries)
+    Merged[E.getKey()] = E.second;
+
+  SmallString<4096> Contents;
+  {
+    using namespace llvm::support;
+    llvm::raw_svector_ostream Out(Contents);
+    endian::Writer LE(Out, little);
+    Out.write(ValidationManifestMagic, sizeof(ValidationManifestMagic));
+    LE.write<uint32_t>(ValidationManifestVersion);
+    LE.write<uint64_t>(BuildSessionTimestamp);
+    LE.write<uint32_t>(Merged.size());
+    for (auto &E : Merged) {
+      LE.write<uint64_t>(E.second.Size);
+      LE.write<uint64_t>(E.second.ModTime);
+      LE.write<uint32_t>(E.second.IncludesSystemInputs ? 1 : 0);
+      LE.write<uint32_t>(E.getKey().size());
+      Out << E.getKey();
+    }
+  }
+
+  // Write to a temporary file and move it into place, so that readers only
+  // ever see a complete manifest.  Failing to update the manifest only means
+  // that later compilations validate their inputs themselves.
+  SmallString<128> TmpPath;
+  int TmpFD;
+  if (llvm::sys::fs::createUniqueFile(ManifestFile + "-%%%%%%%%", TmpFD,
+                                      TmpPath))
+    return;
+  {
+    llvm::raw_fd_ostream Out(TmpFD, /*shouldClose=*/true);
+    Out << Contents;
+    Out.close();
+    if (Out.has_error()) {
+      Out.clear_error();
+      llvm::sys::fs::remove(TmpPath);
+      return;
+    }
+  }
+  if (llvm::sys::fs::rename(TmpPath, ManifestFile))
+    llvm::sys::fs::remove(TmpPath);
+}
+
+InputValidationManifest *ASTReader::getInputValidationManifest() {
+  if (!ValidationManifest) {
+    const HeaderSearchOptions &HSOpts =
+        PP.getHeaderSearchInfo().getHeaderSearchOpts();
+    if (HSOpts.ModulesValidationManifest.empty() ||
+        !HSOpts.BuildSessionTimestamp)
+      return nullptr;
+    ValidationManifest = llvm::make_unique<InputValidationManifest>(
+        HSOpts.ModulesValidationManifest, HSOpts.BuildSessionTimestamp);
+  }
+  return ValidationManifest.get();
+}
+
 static unsigned moduleKindForDiagnostic(ModuleKind Kind);
 InputFile ASTReader::getInputFile(ModuleFile &F, unsigned ID, bool Complain) {
   // If this ID is bogus, just return an empty input file.
@@ -2395,11 +2575,21 @@ ASTReader::ReadControlBlock(ModuleFile &F,
              F.Kind == MK_ImplicitModule))
           N = NumInputs;
 
+        // If another compilation of this build session already validated
+        // the input files of this very AST file, don't stat them again.
+        InputValidationManifest *Manifest =
+            F.File ? getInputValidationManifest() : nullptr;
+        if (Manifest && Manifest->isValidated(F.File, N == NumInputs))
+          N = 0;
+
         for (unsigned I = 0; I < N; ++I) {
           InputFile IF = getInputFile(F, I+1, Complain);
           if (!IF.getFile() || IF.isOutOfDate())
             return OutOfDate;
         }
+
+        if (Manifest && N)
+          Manifest->noteValidated(F.File, N == NumInputs);
       }
 
       if (Listener)
@@ -2530,40 +2720,59 @@ ASTReader::ReadControlBlock(ModuleFile &F,
       if (ASTReadResult Result = readUnhashedControlBlockOnce())
         return Result;
 
-      // Load each of the imported PCH files.
+      // Read information about the imported AST files.
+      struct ImportedFileInfo {
+        ModuleKind Kind;
+        SourceLocation ImportLoc;
+        off_t StoredSize;
+        time_t StoredModTime;
+        ASTFileSignature StoredSignature;
+        std::string File;
+      };
+      SmallVector<ImportedFileInfo, 8> Imports;
+      std::vector<std::string> ImportedFiles;
       unsigned Idx = 0, N = Record.size();
       while (Idx < N) {
-        // Read information about the AST file.
-        ModuleKind ImportedKind = (ModuleKind)Record[Idx++];
+        ImportedFileInfo Import;
+        Import.Kind = (ModuleKind)Record[Idx++];
         // The import location will be the local one for now; we will adjust
         // all import locations of module imports after the global source
         // location info are setup, in ReadAST.
-        SourceLocation ImportLoc =
-            ReadUntranslatedSourceLocation(Record[Idx++]);
-        off_t StoredSize = (off_t)Record[Idx++];
-        time_t StoredModTime = (time_t)Record[Idx++];
-        ASTFileSignature StoredSignature = {
+        Import.ImportLoc = ReadUntranslatedSourceLocation(Record[Idx++]);
+        Import.StoredSize = (off_t)Record[Idx++];
+        Import.StoredModTime = (time_t)Record[Idx++];
+        Import.StoredSignature = {
             {{(uint32_t)Record[Idx++], (uint32_t)Record[Idx++],
               (uint32_t)Record[Idx++], (uint32_t)Record[Idx++],
               (uint32_t)Record[Idx++]}}};
 
         std::string ImportedName = ReadString(Record, Idx);
-        std::string ImportedFile;
 
         // For prebuilt and explicit modules first consult the file map for
         // an override. Note that here we don't search prebuilt module
         // directories, only the explicit name to file mappings. Also, we will
         // still verify the size/signature making sure it is essentially the
         // same file but perhaps in a different location.
-        if (ImportedKind == MK_PrebuiltModule || ImportedKind == MK_ExplicitModule)
-          ImportedFile = PP.getHeaderSearchInfo().getPrebuiltModuleFileName(
+        if (Import.Kind == MK_PrebuiltModule ||
+            Import.Kind == MK_ExplicitModule)
+          Import.File = PP.getHeaderSearchInfo().getPrebuiltModuleFileName(
             ImportedName, /*FileMapOnly*/ true);
 
-        if (ImportedFile.empty())
-          ImportedFile = ReadPath(F, Record, Idx);
+        if (Import.File.empty())
+          Import.File = ReadPath(F, Record, Idx);
         else
           SkipPath(Record, Idx);
 
+        ImportedFiles.push_back(Import.File);
+        Imports.push_back(std::move(Import));
+      }
+
+      // Read the imported files in the background while the first ones are
+      // loaded.
+      ModuleMgr.prefetchModuleFiles(ImportedFiles);
+
+      // Load each of the imported PCH files.
+      for (const ImportedFileInfo &Import : Imports) {
         // If our client can't cope with us being out of date, we can't cope with
         // our dependency being missing.
         unsigned Capabilities = ClientLoadCapabilities;
@@ -2571,9 +2780,10 @@ ASTReader::ReadControlBlock(ModuleFile &F,
           Capabilities &= ~ARR_Missing;
 
         // Load the AST file.
-        auto Result = ReadASTCore(ImportedFile, ImportedKind, ImportLoc, &F,
-                                  Loaded, StoredSize, StoredModTime,
-                                  StoredSignature, Capabilities);
+        auto Result = ReadASTCore(Import.File, Import.Kind, Import.ImportLoc,
+                                  &F, Loaded, Import.StoredSize,
+                                  Import.StoredModTime, Import.StoredSignature,
+                                  Capabilities);
 
         // If we diagnosed a problem, produce a backtrace.
         if (isDiagnosedResult(Result, Capabilities))
@@ -2792,6 +3002,7 @@ ASTReader::ReadASTBlock(ModuleFile &F, unsigned ClientLoadCapabilities) {
     if (!ContextObj) {
       switch (RecordType) {
       case IDENTIFIER_TABLE:
+      case IDENTIFIER_FILTER:
       case IDENTIFIER_OFFSET:
       case INTERESTING_IDENTIFIERS:
       case STATISTICS:
@@ -2839,6 +3050,12 @@ ASTReader::ReadASTBlock(ModuleFile &F, unsigned ClientLoadCapabilities) {
       break;
     }
 
+    case TYPE_CLASS_COUNTS:
+      // Presize the sets that unique types for the types this module may
+      // deserialize, so that they do not rehash as the types are loaded.
+      ContextObj->reserveTypes(Record);
+      break;
+
     case DECL_OFFSET: {
       if (F.LocalNumDecls != 0) {
         Error("duplicate DECL_OFFSET record in AST file");
@@ -2906,6 +3123,10 @@ ASTReader::ReadASTBlock(ModuleFile &F, unsigned ClientLoadCapabilities) {
       }
       break;
 
+    case IDENTIFIER_FILTER:
+      F.IdentifierFilterData = Blob;
+      break;
+
     case IDENTIFIER_OFFSET: {
       if (F.LocalNumIdentifiers != 0) {
         Error("duplicate IDENTIFIER_OFFSET record in AST file");
@@ -2939,8 +3160,9 @@ ASTReader::ReadASTBlock(ModuleFile &F, unsigned ClientLoadCapabilities) {
       break;
 
     case EAGERLY_DESERIALIZED_DECLS:
-      // FIXME: Skip reading this record if our ASTConsumer doesn't care
-      // about "interesting" decls (for instance, if we're building a module).
+      // FIXME: Skip reading this record while building a module, too.
+      if (!ConsumerWantsInterestingDecls)
+        break;
       for (unsigned I = 0, N = Record.size(); I != N; ++I)
         EagerlyDeserializedDecls.push_back(getGlobalDeclID(F, Record[I]));
       break;
@@ -2948,11 +3170,21 @@ ASTReader::ReadASTBlock(ModuleFile &F, unsigned ClientLoadCapabilities) {
     case MODULAR_CODEGEN_DECLS:
       // FIXME: Skip reading this record if our ASTConsumer doesn't care about
       // them (ie: if we're not codegenerating this module).
-      if (F.Kind == MK_MainFile)
+      if (providesExternalDefinitions(F) && ConsumerWantsInterestingDecls)
         for (unsigned I = 0, N = Record.size(); I != N; ++I)
           EagerlyDeserializedDecls.push_back(getGlobalDeclID(F, Record[I]));
       break;
 
+    case IMPORTED_REDECLARATIONS:
+      if (Record.size() % 2 != 0) {
+        Error("invalid IMPORTED_REDECLARATIONS block in AST file");
+        return Failure;
+      }
+      for (unsigned I = 0, N = Record.size(); I != N; I += 2)
+        ImportedRedecls[getGlobalDeclID(F, Record[I])].push_back(
+            getGlobalDeclID(F, Record[I + 1]));
+      break;
+
     case SPECIAL_TYPES:
       if (SpecialTypes.empty()) {
         for (unsigned I = 0, N = Record.size(); I != N; ++I)
@@ -3283,6 +3515,14 @@ ASTReader::ReadASTBlock(ModuleFile &F, unsigned ClientLoadCapabilities) {
       F.ObjCCategories.swap(Record);
       break;
 
+    case RECORD_LAYOUTS:
+      F.RecordLayouts.swap(Record);
+      for (unsigned I = 0, N = F.RecordLayouts.size(); I + 1 < N;
+           I += F.RecordLayouts[I + 1] + 2)
+        UnreadRecordLayouts[getGlobalDeclID(F, F.RecordLayouts[I])] =
+            std::make_pair(&F, I);
+      break;
+
     case CUDA_SPECIAL_DECL_REFS:
       // Later tables overwrite earlier ones.
       // FIXME: Modules will have trouble with this.
@@ -3870,6 +4110,11 @@ ASTReader::ASTReadResult ASTReader::ReadAST(StringRef FileName,
   llvm::SaveAndRestore<SourceLocation>
     SetCurImportLocRAII(CurrentImportLoc, ImportLoc);
 
+  // This also covers the AST files it imports, and the pending actions that
+  // are run once it has been read.
+  auto GetFileName = [&]() { return FileName.str(); };
+  TimeTraceScope TimeScope("ReadAST", GetFileName, GetFileName);
+
   // Defer any pending actions until we get to the end of reading the AST file.
   Deserializing AnASTFile(this);
 
@@ -3880,10 +4125,15 @@ ASTReader::ASTReadResult ASTReader::ReadAST(StringRef FileName,
 
   unsigned NumModules = ModuleMgr.size();
   SmallVector<ImportedModule, 4> Loaded;
-  switch (ASTReadResult ReadResult =
-              ReadASTCore(FileName, Type, ImportLoc,
-                          /*ImportedBy=*/nullptr, Loaded, 0, 0,
-                          ASTFileSignature(), ClientLoadCapabilities)) {
+  ASTReadResult ReadResult =
+      ReadASTCore(FileName, Type, ImportLoc, /*ImportedBy=*/nullptr, Loaded, 0,
+                  0, ASTFileSignature(), ClientLoadCapabilities);
+
+  // The whole import graph has been loaded; the files that were read ahead
+  // but not loaded are of no further use.
+  ModuleMgr.clearPrefetchedModuleFiles();
+
+  switch (ReadResult) {
   case Failure:
   case Missing:
   case OutOfDate:
@@ -4094,6 +4344,9 @@ ASTReader::ASTReadResult ASTReader::ReadAST(StringRef FileName,
     }
   }
 
+  if (ValidationManifest)
+    ValidationManifest->writeToDisk();
+
   return Success;
 }
 
@@ -4177,8 +4430,8 @@ ASTReader::ReadASTCore(StringRef FileName,
 
   ModuleFile &F = *M;
   BitstreamCursor &Stream = F.Stream;
-  Stream = BitstreamCursor(PCHContainerRdr.ExtractPCH(*F.Buffer));
-  F.SizeInBits = F.Buffer->getBufferSize() * 8;
+  Stream = BitstreamCursor(F.Data);
+  F.SizeInBits = F.Data.size() * 8;
 
   // Sniff for the signature.
   if (!startsWithASTFileMagic(Stream)) {
@@ -4590,6 +4843,40 @@ void ASTReader::finalizeForWriting() {
   // Nothing to do for now.
 }
 
+StringRef
+ASTReader::decompressASTFile(StringRef Bytes,
+                             std::unique_ptr<llvm::MemoryBuffer> &Decompressed) {
+  const size_t HeaderSize = sizeof(COMPRESSED_AST_FILE_MAGIC) + 12;
+  if (Bytes.size() < HeaderSize ||
+      memcmp(Bytes.data(), COMPRESSED_AST_FILE_MAGIC,
+             sizeof(COMPRESSED_AST_FILE_MAGIC)) != 0)
+    return Bytes;
+
+  using namespace llvm::support;
+  const char *Header = Bytes.data() + sizeof(COMPRESSED_AST_FILE_MAGIC);
+  if (endian::read32le(Header) != COMPRESSED_AST_FILE_VERSION ||
+      !llvm::zlib::isAvailable())
+    return StringRef();
+  size_t Size = endian::read64le(Header + 4);
+
+  std::unique_ptr<llvm::WritableMemoryBuffer> Buffer =
+      llvm::WritableMemoryBuffer::getNewUninitMemBuffer(Size);
+  if (!Buffer)
+    return StringRef();
+  size_t DecompressedSize = Size;
+  if (llvm::Error E = llvm::zlib::uncompress(
+          Bytes.drop_front(HeaderSize), Buffer->getBufferStart(),
+          DecompressedSize)) {
+    llvm::consumeError(std::move(E));
+    return StringRef();
+  }
+  if (DecompressedSize != Size)
+    return StringRef();
+
+  Decompressed = std::move(Buffer);
+  return Decompressed->getBuffer();
+}
+
 /// Reads and return the signature record from \p PCH's control block, or
 /// else returns 0.
 static ASTFileSignature readASTFileSignature(StringRef PCH) {
@@ -4631,7 +4918,9 @@ std::string ASTReader::getOriginalSourceFile(
   }
 
   // Initialize the stream
-  BitstreamCursor Stream(PCHContainerRdr.ExtractPCH(**Buffer));
+  std::unique_ptr<llvm::MemoryBuffer> Decompressed;
+  BitstreamCursor Stream(
+      decompressASTFile(PCHContainerRdr.ExtractPCH(**Buffer), Decompressed));
 
   // Sniff for the signature.
   if (!startsWithASTFileMagic(Stream)) {
@@ -4729,7 +5018,9 @@ bool ASTReader::readASTFileControlBlock(
   }
 
   // Initialize the stream
-  StringRef Bytes = PCHContainerRdr.ExtractPCH(**Buffer);
+  std::unique_ptr<llvm::MemoryBuffer> Decompressed;
+  StringRef Bytes =
+      decompressASTFile(PCHContainerRdr.ExtractPCH(**Buffer), Decompressed);
   BitstreamCursor Stream(Bytes);
 
   // Sniff for the signature.
@@ -5842,6 +6133,9 @@ void ASTReader::ReadPragmaDiagnosticMappings(DiagnosticsEngine &Diag) {
         T[0].State = CurState;
     }
 
+    // The transitions read above may apply to locations looked up before.
+    Diag.DiagStatesByLoc.LastLookupState = nullptr;
+
     // Don't try to read these mappings again.
     Record.clear();
   }
@@ -6436,8 +6730,15 @@ class TypeLocReader : public TypeLocVisitor<TypeLocReader> {
   const ASTReader::RecordData &Record;
   unsigned &Idx;
 
+  /// The locations of a TypeLoc chain are written as one sequence.
+  SourceLocationSequence Seq;
+
   SourceLocation ReadSourceLocation() {
-    return Reader->ReadSourceLocation(*F, Record, Idx);
+    return Reader->ReadSourceLocation(*F, Record, Idx, &Seq);
+  }
+
+  SourceRange ReadSourceRange() {
+    return Reader->ReadSourceRange(*F, Record, Idx, &Seq);
   }
 
   TypeSourceInfo *GetTypeSourceInfo() {
@@ -6577,8 +6878,7 @@ void TypeLocReader::VisitFunctionTypeLoc(FunctionTypeLoc TL) {
   TL.setLocalRangeBegin(ReadSourceLocation());
   TL.setLParenLoc(ReadSourceLocation());
   TL.setRParenLoc(ReadSourceLocation());
-  TL.setExceptionSpecRange(SourceRange(Reader->ReadSourceLocation(*F, Record, Idx),
-                                       Reader->ReadSourceLocation(*F, Record, Idx)));
+  TL.setExceptionSpecRange(ReadSourceRange());
   TL.setLocalRangeEnd(ReadSourceLocation());
   for (unsigned i = 0, e = TL.getNumParams(); i != e; ++i) {
     TL.setParam(i, Reader->ReadDeclAs<ParmVarDecl>(*F, Record, Idx));
@@ -7122,14 +7422,18 @@ void ASTReader::CompleteRedeclChain(const Decl *D) {
   const DeclContext *DC = D->getDeclContext()->getRedeclContext();
 
   // If this is a named declaration, complete it by looking it up
-  // within its context.
+  // within its context, unless the index of imported redeclarations already
+  // had all of its redeclarations.
   //
   // FIXME: Merging a function definition should merge
   // all mergeable entities within it.
   if (isa<TranslationUnitDecl>(DC) || isa<NamespaceDecl>(DC) ||
       isa<CXXRecordDecl>(DC) || isa<EnumDecl>(DC)) {
     if (DeclarationName Name = cast<NamedDecl>(D)->getDeclName()) {
-      if (!getContext().getLangOpts().CPlusPlus &&
+      if (completeRedeclChainFromIndex(D)) {
+        // Every module that could redeclare it is related to the module of a
+        // key declaration, so the index had all of its redeclarations.
+      } else if (!getContext().getLangOpts().CPlusPlus &&
           isa<TranslationUnitDecl>(DC)) {
         // Outside of C++, we don't have a lookup table for the TU, so update
         // the identifier instead. (For C++ modules, we don't store decls
@@ -7161,6 +7465,88 @@ void ASTReader::CompleteRedeclChain(const Decl *D) {
   }
 }
 
+const llvm::BitVector &ASTReader::getRelatedModuleFiles(ModuleFile &M) {
+  auto &Related = RelatedModuleFiles[&M];
+  if (Related.first == ModuleMgr.size())
+    return Related.second;
+
+  Related.first = ModuleMgr.size();
+  Related.second.clear();
+  Related.second.resize(ModuleMgr.size());
+  // Walk the modules that import M, and then the modules that M imports.
+  for (bool Importers : {true, false}) {
+    SmallVector<ModuleFile *, 16> Worklist(1, &M);
+    while (!Worklist.empty()) {
+      ModuleFile *Current = Worklist.pop_back_val();
+      for (ModuleFile *Next :
+           Importers ? Current->ImportedBy : Current->Imports) {
+        if (Next->Index < Related.second.size() &&
+            !Related.second.test(Next->Index)) {
+          Related.second.set(Next->Index);
+          Worklist.push_back(Next);
+        }
+      }
+    }
+  }
+  return Related.second;
+}
+
+bool ASTReader::completeRedeclChainFromIndex(const Decl *D) {
+  const Decl *Canon = D->getCanonicalDecl();
+
+  // A module that imports the module of a key declaration of the entity
+  // redeclares it, if at all, either by adding to that key declaration's
+  // chain or by merging it into a declaration that it made before the import.
+  // Either way it lists its first redeclaration under the key declaration in
+  // its IMPORTED_REDECLARATIONS record. Load them directly. A module that the module of a key declaration imports
+  // cannot redeclare it either, or that would not be a key declaration.
+  SmallVector<const Decl *, 4> Keys;
+  forEachImportedKeyDecl(Canon, [&](const Decl *Key) { Keys.push_back(Key); });
+  for (const Decl *Key : Keys) {
+    auto It = ImportedRedecls.find(Key->getGlobalID());
+    if (It == ImportedRedecls.end())
+      continue;
+    // Loading a redeclaration can add to the index; copy the IDs first.
+    SmallVector<serialization::DeclID, 4> IDs(It->second.begin(),
+                                              It->second.end());
+    for (serialization::DeclID ID : IDs)
+      GetDecl(ID);
+  }
+
+  // Any other module can declare the entity independently, and we must look
+  // up its name to merge those declarations. Only the modules that were
+  // loaded since the chain was last completed need to be checked.
+  unsigned NumModules = ModuleMgr.size();
+  unsigned FirstModule = 0;
+  auto Completed = CompletedRedeclChains.find(Canon);
+  if (Completed != CompletedRedeclChains.end())
+    FirstModule = std::min(Completed->second, NumModules);
+  CompletedRedeclChains[Canon] = NumModules;
+
+  SmallVector<ModuleFile *, 4> Owners;
+  for (const Decl *Key : Keys)
+    if (ModuleFile *Owner = getOwningModuleFile(Key))
+      Owners.push_back(Owner);
+  if (Owners.empty())
+    return false;
+
+  // Compute all of the sets before taking their addresses.
+  for (ModuleFile *Owner : Owners)
+    getRelatedModuleFiles(*Owner);
+  SmallVector<const llvm::BitVector *, 4> Related;
+  for (ModuleFile *Owner : Owners)
+    Related.push_back(&getRelatedModuleFiles(*Owner));
+
+  for (unsigned I = FirstModule; I != NumModules; ++I) {
+    bool SeesKeyDecl = false;
+    for (unsigned J = 0, N = Owners.size(); J != N && !SeesKeyDecl; ++J)
+      SeesKeyDecl = Owners[J]->Index == I || Related[J]->test(I);
+    if (!SeesKeyDecl)
+      return false;
+  }
+  return true;
+}
+
 CXXCtorInitializer **
 ASTReader::GetExternalCXXCtorInitializers(uint64_t Offset) {
   RecordLocation Loc = getLocalBitOffset(Offset);
@@ -7311,6 +7697,9 @@ static Decl *getPredefinedDecl(ASTContext &Context, PredefinedDeclIDs ID) {
 
   case PREDEF_DECL_TYPE_PACK_ELEMENT_ID:
     return Context.getTypePackElementDecl();
+
+  case PREDEF_DECL_TYPE_PACK_SLICE_ID:
+    return Context.getTypePackSliceDecl();
   }
   llvm_unreachable("PredefinedDeclIDs unknown enum value");
 }
@@ -7606,6 +7995,13 @@ void ASTReader::PassInterestingDeclToConsumer(Decl *D) {
 void ASTReader::StartTranslationUnit(ASTConsumer *Consumer) {
   this->Consumer = Consumer;
 
+  // Drop what we collected for a consumer that turns out not to want it.
+  if (Consumer && !Consumer->wantsInterestingDecls()) {
+    ConsumerWantsInterestingDecls = false;
+    EagerlyDeserializedDecls.clear();
+    PotentiallyInterestingDecls.clear();
+  }
+
   if (Consumer)
     PassInterestingDeclsToConsumer();
 
@@ -7613,6 +8009,78 @@ void ASTReader::StartTranslationUnit(ASTConsumer *Consumer) {
     DeserializationListener->ReaderInitialized(this);
 }
 
+const ASTRecordLayout *
+ASTReader::getStoredRecordLayout(const RecordDecl *Record) {
+  auto Pos = UnreadRecordLayouts.find(Record->getGlobalID());
+  if (Pos == UnreadRecordLayouts.end())
+    return nullptr;
+  ModuleFile &F = *Pos->second.first;
+  unsigned Idx = Pos->second.second + 2;
+  UnreadRecordLayouts.erase(Pos);
+
+  ASTContext &Context = *ContextObj;
+  ArrayRef<uint64_t> Layout = F.RecordLayouts;
+  auto ReadCharUnits = [&] {
+    return CharUnits::fromQuantity(static_cast<int64_t>(Layout[Idx++]));
+  };
+  auto ReadRecordDecl = [&]() -> const CXXRecordDecl * {
+    auto *D = cast_or_null<CXXRecordDecl>(
+        GetDecl(getGlobalDeclID(F, Layout[Idx++])));
+    return D ? D->getDefinition() : nullptr;
+  };
+
+  CharUnits Size = ReadCharUnits();
+  CharUnits DataSize = ReadCharUnits();
+  CharUnits Alignment = ReadCharUnits();
+  CharUnits UnadjustedAlignment = ReadCharUnits();
+  CharUnits RequiredAlignment = ReadCharUnits();
+  unsigned NumFields = Layout[Idx++];
+  ArrayRef<uint64_t> FieldOffsets = Layout.slice(Idx, NumFields);
+  Idx += NumFields;
+
+  // The fields of a record that was merged with a definition from another
+  // AST file may not match; lay out such a record again.
+  if (NumFields != static_cast<unsigned>(std::distance(Record->field_begin(),
+                                                       Record->field_end())))
+    return nullptr;
+
+  const auto *CXXRD = dyn_cast<CXXRecordDecl>(Record);
+  if (!CXXRD)
+    return new (Context)
+        ASTRecordLayout(Context, Size, Alignment, UnadjustedAlignment,
+                        RequiredAlignment, DataSize, FieldOffsets);
+
+  CharUnits NonVirtualSize = ReadCharUnits();
+  CharUnits NonVirtualAlignment = ReadCharUnits();
+  CharUnits SizeOfLargestEmptySubobject = ReadCharUnits();
+  CharUnits VBPtrOffset = ReadCharUnits();
+  uint64_t Flags = Layout[Idx++];
+  const CXXRecordDecl *PrimaryBase = ReadRecordDecl();
+  const CXXRecordDecl *BaseSharingVBPtr = ReadRecordDecl();
+
+  ASTRecordLayout::BaseOffsetsMapTy Bases;
+  for (unsigned I = 0, N = Layout[Idx++]; I != N; ++I) {
+    const CXXRecordDecl *Base = ReadRecordDecl();
+    Bases[Base] = ReadCharUnits();
+  }
+
+  ASTRecordLayout::VBaseOffsetsMapTy VBases;
+  for (unsigned I = 0, N = Layout[Idx++]; I != N; ++I) {
+    const CXXRecordDecl *VBase = ReadRecordDecl();
+    CharUnits Offset = ReadCharUnits();
+    VBases[VBase] = ASTRecordLayout::VBaseInfo(Offset, Layout[Idx++]);
+  }
+
+  return new (Context) ASTRecordLayout(
+      Context, Size, Alignment, UnadjustedAlignment, RequiredAlignment,
+      /*hasOwnVFPtr=*/Flags & 0x1, /*hasExtendableVFPtr=*/Flags & 0x2,
+      VBPtrOffset, DataSize, FieldOffsets, NonVirtualSize,
+      NonVirtualAlignment, SizeOfLargestEmptySubobject, PrimaryBase,
+      /*IsPrimaryBaseVirtual=*/Flags & 0x10, BaseSharingVBPtr,
+      /*EndsWithZeroSizedObject=*/Flags & 0x4,
+      /*LeadsWithZeroSizedBase=*/Flags & 0x8, Bases, VBases);
+}
+
 void ASTReader::PrintStats() {
   std::fprintf(stderr, "*** AST File Statistics:\n");
 
@@ -7696,6 +8164,10 @@ void ASTReader::PrintStats() {
                  "  %u / %u identifier table lookups succeeded (%f%%)\n",
                  NumIdentifierLookupHits, NumIdentifierLookups,
                  (double)NumIdentifierLookupHits*100.0/NumIdentifierLookups);
+  if (NumIdentifierLookupsFiltered)
+    std::fprintf(stderr,
+                 "  %u identifier table lookups avoided by identifier "
+                 "filters\n", NumIdentifierLookupsFiltered);
 
   if (GlobalIndex) {
     std::fprintf(stderr, "\n");
@@ -7854,7 +8326,8 @@ IdentifierInfo *ASTReader::get(StringRef Name) {
 
   IdentifierLookupVisitor Visitor(Name, /*PriorGeneration=*/0,
                                   NumIdentifierLookups,
-                                  NumIdentifierLookupHits);
+                                  NumIdentifierLookupHits,
+                                  NumIdentifierLookupsFiltered);
 
   // We don't need to do identifier table lookups in C++ modules (we preload
   // all interesting declarations, and don't need to use the scope for name
@@ -8478,6 +8951,11 @@ Module *ASTReader::getModule(unsigned ID) {
   return getSubmodule(ID);
 }
 
+bool ASTReader::providesExternalDefinitions(const ModuleFile &F) const {
+  return F.Kind == MK_MainFile ||
+         (F.Kind == MK_PCH && PP.getLangOpts().BuildingPCHWithObjectFile);
+}
+
 bool ASTReader::DeclIsFromPCHWithObjectFile(const Decl *D) {
   ModuleFile *MF = getOwningModuleFile(D);
   return MF && MF->PCHHasObjectFile;
@@ -9052,9 +9530,9 @@ ASTReader::ReadNestedNameSpecifierLoc(ModuleFile &F, const RecordData &Record,
 
 SourceRange
 ASTReader::ReadSourceRange(ModuleFile &F, const RecordData &Record,
-                           unsigned &Idx) {
-  SourceLocation beg = ReadSourceLocation(F, Record, Idx);
-  SourceLocation end = ReadSourceLocation(F, Record, Idx);
+                           unsigned &Idx, SourceLocationSequence *Seq) {
+  SourceLocation beg = ReadSourceLocation(F, Record, Idx, Seq);
+  SourceLocation end = ReadSourceLocation(F, Record, Idx, Seq);
   return SourceRange(beg, end);
 }
 
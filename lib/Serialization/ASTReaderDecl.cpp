@@ -506,7 +506,7 @@ uint64_t ASTDeclReader::GetCurrentCursorOffset() {
 
 void ASTDeclReader::ReadFunctionDefinition(FunctionDecl *FD) {
   if (Record.readInt())
-    Reader.DefinitionSource[FD] = Loc.F->Kind == ModuleKind::MK_MainFile;
+    Reader.DefinitionSource[FD] = Reader.providesExternalDefinitions(*Loc.F);
   if (auto *CD = dyn_cast<CXXConstructorDecl>(FD)) {
     CD->setNumCtorInitializers(Record.readInt());
     if (CD->getNumCtorInitializers())
@@ -745,8 +745,9 @@ void ASTDeclReader::VisitEnumDecl(EnumDecl *ED) {
   ED->setScopedUsingClassTag(Record.readInt());
   ED->setFixed(Record.readInt());
 
-  ED->setHasODRHash(true);
+  // A hash of zero means that the writer did not compute it.
   ED->ODRHash = Record.readInt();
+  ED->setHasODRHash(ED->ODRHash != 0);
 
   // If this is a definition subject to the ODR, and we already have a
   // definition, merge this one into it.
@@ -878,8 +879,9 @@ void ASTDeclReader::VisitFunctionDecl(FunctionDecl *FD) {
   FD->setCachedLinkage(static_cast<Linkage>(Record.readInt()));
   FD->EndRangeLoc = ReadSourceLocation();
 
+  // A hash of zero means that the writer did not compute it.
   FD->ODRHash = Record.readInt();
-  FD->setHasODRHash(true);
+  FD->setHasODRHash(FD->ODRHash != 0);
 
   switch ((FunctionDecl::TemplatedKind)Record.readInt()) {
   case FunctionDecl::TK_NonTemplate:
@@ -1391,7 +1393,7 @@ ASTDeclReader::RedeclarableResult ASTDeclReader::VisitVarDeclImpl(VarDecl *VD) {
   }
 
   if (VD->getStorageDuration() == SD_Static && Record.readInt())
-    Reader.DefinitionSource[VD] = Loc.F->Kind == ModuleKind::MK_MainFile;
+    Reader.DefinitionSource[VD] = Reader.providesExternalDefinitions(*Loc.F);
 
   enum VarKind {
     VarNotTemplate = 0, VarTemplate, StaticDataMemberSpecialization
@@ -1688,11 +1690,12 @@ void ASTDeclReader::ReadCXXDefinitionData(
   Data.ImplicitCopyAssignmentHasConstParam = Record.readInt();
   Data.HasDeclaredCopyConstructorWithConstParam = Record.readInt();
   Data.HasDeclaredCopyAssignmentWithConstParam = Record.readInt();
+  // A hash of zero means that the writer did not compute it.
   Data.ODRHash = Record.readInt();
-  Data.HasODRHash = true;
+  Data.HasODRHash = Data.ODRHash != 0;
 
   if (Record.readInt())
-    Reader.DefinitionSource[D] = Loc.F->Kind == ModuleKind::MK_MainFile;
+    Reader.DefinitionSource[D] = Reader.providesExternalDefinitions(*Loc.F);
 
   Data.NumBases = Record.readInt();
   if (Data.NumBases)
@@ -1853,7 +1856,7 @@ void ASTDeclReader::MergeDefinitionData(
     // when they occur within the body of a function template specialization).
   }
 
-  if (D->getODRHash() != MergeDD.ODRHash) {
+  if (MergeDD.HasODRHash && D->getODRHash() != MergeDD.ODRHash) {
     DetectedOdrViolation = true;
   }
 
@@ -3905,8 +3908,9 @@ Decl *ASTReader::ReadDeclRecord(DeclID ID) {
   // AST consumer might need to know about, queue it.
   // We don't pass it to the consumer immediately because we may be in recursive
   // loading, and some declarations may still be initializing.
-  PotentiallyInterestingDecls.push_back(
-      InterestingDecl(D, Reader.hasPendingBody()));
+  if (ConsumerWantsInterestingDecls)
+    PotentiallyInterestingDecls.push_back(
+        InterestingDecl(D, Reader.hasPendingBody()));
 
   return D;
 }
@@ -3955,8 +3959,8 @@ void ASTReader::loadDeclUpdateRecords(PendingUpdateRecord &Record) {
     // the declaration, then we know it was interesting and we skip the call
     // to isConsumerInterestedIn because it is unsafe to call in the
     // current ASTReader state.
-    bool WasInteresting =
-        Record.JustLoaded || isConsumerInterestedIn(getContext(), D, false);
+    bool WasInteresting = !ConsumerWantsInterestingDecls || Record.JustLoaded ||
+                          isConsumerInterestedIn(getContext(), D, false);
     for (auto &FileAndOffset : UpdateOffsets) {
       ModuleFile *F = FileAndOffset.first;
       uint64_t Offset = FileAndOffset.second;
@@ -20,6 +20,7 @@
 #include "clang/Serialization/ASTBitCodes.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/OnDiskHashTable.h"
 #include <ctime>
@@ -284,6 +285,54 @@ public:
 using HeaderFileInfoLookupTable =
     llvm::OnDiskChainedHashTable<HeaderFileInfoTrait>;
 
+/// The AST files whose input files were already found to be up to date
+/// during the current build session.
+///
+/// The manifest lives in the file named by -fmodules-validation-manifest and
+/// is shared by all compilations of one build session.  An AST file is
+/// identified by its path, size and modification time, so an AST file that
+/// is rebuilt during the session is validated again.  As with
+/// -fmodules-validate-once-per-build-session, the input files themselves are
+/// assumed not to change during the session.
+class InputValidationManifest {
+  struct Entry {
+    uint64_t Size = 0;
+    uint64_t ModTime = 0;
+
+    /// Whether the system input files were validated too.
+    bool IncludesSystemInputs = false;
+  };
+
+  std::string ManifestFile;
+  uint64_t BuildSessionTimestamp;
+  llvm::StringMap<Entry> Entries;
+
+  /// Whether Entries has anything that is not in the manifest file yet.
+  bool Changed = false;
+
+  /// Read the entries of the manifest file into \p Entries.
+  ///
+  /// \returns true if the file is missing, malformed or left over from a
+  /// different build session.
+  bool read(llvm::StringMap<Entry> &Entries) const;
+
+public:
+  InputValidationManifest(StringRef ManifestFile,
+                          uint64_t BuildSessionTimestamp);
+
+  /// Whether the input files of \p ASTFile were validated earlier in this
+  /// build session, including the system input files if
+  /// \p IncludesSystemInputs.
+  bool isValidated(const FileEntry *ASTFile, bool IncludesSystemInputs) const;
+
+  /// Record that the input files of \p ASTFile are up to date.
+  void noteValidated(const FileEntry *ASTFile, bool IncludesSystemInputs);
+
+  /// Merge the new entries with the ones in the manifest file, and
+  /// atomically replace the manifest file with the result.
+  void writeToDisk();
+};
+
 } // namespace reader
 
 } // namespace serialization
@@ -547,6 +547,7 @@ void ASTStmtReader::VisitDeclRefExpr(DeclRefExpr *E) {
   E->DeclRefExprBits.HasTemplateKWAndArgsInfo = Record.readInt();
   E->DeclRefExprBits.HadMultipleCandidates = Record.readInt();
   E->DeclRefExprBits.RefersToEnclosingVariableOrCapture = Record.readInt();
+  E->DeclRefExprBits.HasNameLoc = Record.readInt();
   unsigned NumTemplateArgs = 0;
   if (E->hasTemplateKWAndArgsInfo())
     NumTemplateArgs = Record.readInt();
@@ -565,7 +566,11 @@ void ASTStmtReader::VisitDeclRefExpr(DeclRefExpr *E) {
 
   E->setDecl(ReadDeclAs<ValueDecl>());
   E->setLocation(ReadSourceLocation());
-  ReadDeclarationNameLoc(E->DNLoc, E->getDecl()->getDeclName());
+  if (E->hasNameLoc()) {
+    DeclarationNameLoc *DNLoc =
+        new (E->getTrailingObjects<DeclarationNameLoc>()) DeclarationNameLoc();
+    ReadDeclarationNameLoc(*DNLoc, E->getDecl()->getDeclName());
+  }
 }
 
 void ASTStmtReader::VisitIntegerLiteral(IntegerLiteral *E) {
@@ -2417,9 +2422,10 @@ Stmt *ASTReader::ReadStmtFromStream(ModuleFile &F) {
         Context,
         /*HasQualifier=*/Record[ASTStmtReader::NumExprFields],
         /*HasFoundDecl=*/Record[ASTStmtReader::NumExprFields + 1],
+        /*HasNameLoc=*/Record[ASTStmtReader::NumExprFields + 5],
         /*HasTemplateKWAndArgsInfo=*/Record[ASTStmtReader::NumExprFields + 2],
         /*NumTemplateArgs=*/Record[ASTStmtReader::NumExprFields + 2] ?
-          Record[ASTStmtReader::NumExprFields + 5] : 0);
+          Record[ASTStmtReader::NumExprFields + 6] : 0);
       break;
 
     case EXPR_INTEGER_LITERAL:
@@ -2525,8 +2531,11 @@ Stmt *ASTReader::ReadStmtFromStream(ModuleFile &F) {
                              TemplateKWLoc, MemberD, FoundDecl, MemberNameInfo,
                              HasTemplateKWAndArgsInfo ? &ArgInfo : nullptr, T,
                              VK, OK);
-      Record.readDeclarationNameLoc(cast<MemberExpr>(S)->MemberDNLoc,
-                                    MemberD->getDeclName());
+      DeclarationNameLoc MemberDNLoc;
+      Record.readDeclarationNameLoc(MemberDNLoc, MemberD->getDeclName());
+      if (cast<MemberExpr>(S)->hasNameLoc())
+        *cast<MemberExpr>(S)->getTrailingObjects<DeclarationNameLoc>() =
+            MemberDNLoc;
       if (HadMultipleCandidates)
         cast<MemberExpr>(S)->setHadMultipleCandidates(true);
       break;
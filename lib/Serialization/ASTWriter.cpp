@@ -14,6 +14,7 @@
 #include "clang/Serialization/ASTWriter.h"
 #include "ASTCommon.h"
 #include "ASTReaderInternals.h"
+#include "IdentifierFilter.h"
 #include "MultiOnDiskHashTable.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/ASTUnresolvedSet.h"
@@ -31,6 +32,7 @@
 #include "clang/AST/LambdaCapture.h"
 #include "clang/AST/NestedNameSpecifier.h"
 #include "clang/AST/RawCommentList.h"
+#include "clang/AST/RecordLayout.h"
 #include "clang/AST/TemplateName.h"
 #include "clang/AST/Type.h"
 #include "clang/AST/TypeLocVisitor.h"
@@ -97,9 +99,12 @@
 #include "llvm/Support/OnDiskHashTable.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/SHA1.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/VersionTuple.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstdint>
 #include <cstdlib>
@@ -580,6 +585,14 @@ namespace {
 class TypeLocWriter : public TypeLocVisitor<TypeLocWriter> {
   ASTRecordWriter &Record;
 
+  /// The locations of a TypeLoc chain are written as one sequence.
+  SourceLocationSequence Seq;
+
+  void addSourceLocation(SourceLocation Loc) {
+    Record.AddSourceLocation(Loc, &Seq);
+  }
+  void addSourceRange(SourceRange Range) { Record.AddSourceRange(Range, &Seq); }
+
 public:
   TypeLocWriter(ASTRecordWriter &Record) : Record(Record) {}
 
@@ -599,7 +612,7 @@ void TypeLocWriter::VisitQualifiedTypeLoc(QualifiedTypeLoc TL) {
 }
 
 void TypeLocWriter::VisitBuiltinTypeLoc(BuiltinTypeLoc TL) {
-  Record.AddSourceLocation(TL.getBuiltinLoc());
+  addSourceLocation(TL.getBuiltinLoc());
   if (TL.needsExtraLocalData()) {
     Record.push_back(TL.getWrittenTypeSpec());
     Record.push_back(TL.getWrittenSignSpec());
@@ -609,11 +622,11 @@ void TypeLocWriter::VisitBuiltinTypeLoc(BuiltinTypeLoc TL) {
 }
 
 void TypeLocWriter::VisitComplexTypeLoc(ComplexTypeLoc TL) {
-  Record.AddSourceLocation(TL.getNameLoc());
+  addSourceLocation(TL.getNameLoc());
 }
 
 void TypeLocWriter::VisitPointerTypeLoc(PointerTypeLoc TL) {
-  Record.AddSourceLocation(TL.getStarLoc());
+  addSourceLocation(TL.getStarLoc());
 }
 
 void TypeLocWriter::VisitDecayedTypeLoc(DecayedTypeLoc TL) {
@@ -625,25 +638,25 @@ void TypeLocWriter::VisitAdjustedTypeLoc(AdjustedTypeLoc TL) {
 }
 
 void TypeLocWriter::VisitBlockPointerTypeLoc(BlockPointerTypeLoc TL) {
-  Record.AddSourceLocation(TL.getCaretLoc());
+  addSourceLocation(TL.getCaretLoc());
 }
 
 void TypeLocWriter::VisitLValueReferenceTypeLoc(LValueReferenceTypeLoc TL) {
-  Record.AddSourceLocation(TL.getAmpLoc());
+  addSourceLocation(TL.getAmpLoc());
 }
 
 void TypeLocWriter::VisitRValueReferenceTypeLoc(RValueReferenceTypeLoc TL) {
-  Record.AddSourceLocation(TL.getAmpAmpLoc());
+  addSourceLocation(TL.getAmpAmpLoc());
 }
 
 void TypeLocWriter::VisitMemberPointerTypeLoc(MemberPointerTypeLoc TL) {
-  Record.AddSourceLocation(TL.getStarLoc());
+  addSourceLocation(TL.getStarLoc());
   Record.AddTypeSourceInfo(TL.getClassTInfo());
 }
 
 void TypeLocWriter::VisitArrayTypeLoc(ArrayTypeLoc TL) {
-  Record.AddSourceLocation(TL.getLBracketLoc());
-  Record.AddSourceLocation(TL.getRBracketLoc());
+  addSourceLocation(TL.getLBracketLoc());
+  addSourceLocation(TL.getRBracketLoc());
   Record.push_back(TL.getSizeExpr() ? 1 : 0);
   if (TL.getSizeExpr())
     Record.AddStmt(TL.getSizeExpr());
@@ -668,37 +681,37 @@ void TypeLocWriter::VisitDependentSizedArrayTypeLoc(
 
 void TypeLocWriter::VisitDependentAddressSpaceTypeLoc(
     DependentAddressSpaceTypeLoc TL) {
-  Record.AddSourceLocation(TL.getAttrNameLoc());
+  addSourceLocation(TL.getAttrNameLoc());
   SourceRange range = TL.getAttrOperandParensRange();
-  Record.AddSourceLocation(range.getBegin());
-  Record.AddSourceLocation(range.getEnd());
+  addSourceLocation(range.getBegin());
+  addSourceLocation(range.getEnd());
   Record.AddStmt(TL.getAttrExprOperand());
 }
 
 void TypeLocWriter::VisitDependentSizedExtVectorTypeLoc(
                                         DependentSizedExtVectorTypeLoc TL) {
-  Record.AddSourceLocation(TL.getNameLoc());
+  addSourceLocation(TL.getNameLoc());
 }
 
 void TypeLocWriter::VisitVectorTypeLoc(VectorTypeLoc TL) {
-  Record.AddSourceLocation(TL.getNameLoc());
+  addSourceLocation(TL.getNameLoc());
 }
 
 void TypeLocWriter::VisitDependentVectorTypeLoc(
     DependentVectorTypeLoc TL) {
-  Record.AddSourceLocation(TL.getNameLoc());
+  addSourceLocation(TL.getNameLoc());
 }
 
 void TypeLocWriter::VisitExtVectorTypeLoc(ExtVectorTypeLoc TL) {
-  Record.AddSourceLocation(TL.getNameLoc());
+  addSourceLocation(TL.getNameLoc());
 }
 
 void TypeLocWriter::VisitFunctionTypeLoc(FunctionTypeLoc TL) {
-  Record.AddSourceLocation(TL.getLocalRangeBegin());
-  Record.AddSourceLocation(TL.getLParenLoc());
-  Record.AddSourceLocation(TL.getRParenLoc());
-  Record.AddSourceRange(TL.getExceptionSpecRange());
-  Record.AddSourceLocation(TL.getLocalRangeEnd());
+  addSourceLocation(TL.getLocalRangeBegin());
+  addSourceLocation(TL.getLParenLoc());
+  addSourceLocation(TL.getRParenLoc());
+  addSourceRange(TL.getExceptionSpecRange());
+  addSourceLocation(TL.getLocalRangeEnd());
   for (unsigned i = 0, e = TL.getNumParams(); i != e; ++i)
     Record.AddDeclRef(TL.getParam(i));
 }
@@ -712,61 +725,61 @@ void TypeLocWriter::VisitFunctionNoProtoTypeLoc(FunctionNoProtoTypeLoc TL) {
 }
 
 void TypeLocWriter::VisitUnresolvedUsingTypeLoc(UnresolvedUsingTypeLoc TL) {
-  Record.AddSourceLocation(TL.getNameLoc());
+  addSourceLocation(TL.getNameLoc());
 }
 
 void TypeLocWriter::VisitTypedefTypeLoc(TypedefTypeLoc TL) {
-  Record.AddSourceLocation(TL.getNameLoc());
+  addSourceLocation(TL.getNameLoc());
 }
 
 void TypeLocWriter::VisitObjCTypeParamTypeLoc(ObjCTypeParamTypeLoc TL) {
   if (TL.getNumProtocols()) {
-    Record.AddSourceLocation(TL.getProtocolLAngleLoc());
-    Record.AddSourceLocation(TL.getProtocolRAngleLoc());
+    addSourceLocation(TL.getProtocolLAngleLoc());
+    addSourceLocation(TL.getProtocolRAngleLoc());
   }
   for (unsigned i = 0, e = TL.getNumProtocols(); i != e; ++i)
-    Record.AddSourceLocation(TL.getProtocolLoc(i));
+    addSourceLocation(TL.getProtocolLoc(i));
 }
 
 void TypeLocWriter::VisitTypeOfExprTypeLoc(TypeOfExprTypeLoc TL) {
-  Record.AddSourceLocation(TL.getTypeofLoc());
-  Record.AddSourceLocation(TL.getLParenLoc());
-  Record.AddSourceLocation(TL.getRParenLoc());
+  addSourceLocation(TL.getTypeofLoc());
+  addSourceLocation(TL.getLParenLoc());
+  addSourceLocation(TL.getRParenLoc());
 }
 
 void TypeLocWriter::VisitTypeOfTypeLoc(TypeOfTypeLoc TL) {
-  Record.AddSourceLocation(TL.getTypeofLoc());
-  Record.AddSourceLocation(TL.getLParenLoc());
-  Record.AddSourceLocation(TL.getRParenLoc());
+  addSourceLocation(TL.getTypeofLoc());
+  addSourceLocation(TL.getLParenLoc());
+  addSourceLocation(TL.getRParenLoc());
   Record.AddTypeSourceInfo(TL.getUnderlyingTInfo());
 }
 
 void TypeLocWriter::VisitDecltypeTypeLoc(DecltypeTypeLoc TL) {
-  Record.AddSourceLocation(TL.getNameLoc());
+  addSourceLocation(TL.getNameLoc());
 }
 
 void TypeLocWriter::VisitUnaryTransformTypeLoc(UnaryTransformTypeLoc TL) {
-  Record.AddSourceLocation(TL.getKWLoc());
-  Record.AddSourceLocation(TL.getLParenLoc());
-  Record.AddSourceLocation(TL.getRParenLoc());
+  addSourceLocation(TL.getKWLoc());
+  addSourceLocation(TL.getLParenLoc());
+  addSourceLocation(TL.getRParenLoc());
   Record.AddTypeSourceInfo(TL.getUnderlyingTInfo());
 }
 
 void TypeLocWriter::VisitAutoTypeLoc(AutoTypeLoc TL) {
-  Record.AddSourceLocation(TL.getNameLoc());
+  addSourceLocation(TL.getNameLoc());
 }
 
 void TypeLocWriter::VisitDeducedTemplateSpecializationTypeLoc(
     DeducedTemplateSpecializationTypeLoc TL) {
-  Record.AddSourceLocation(TL.getTemplateNameLoc());
+  addSourceLocation(TL.getTemplateNameLoc());
 }
 
 void TypeLocWriter::VisitRecordTypeLoc(RecordTypeLoc TL) {
-  Record.AddSourceLocation(TL.getNameLoc());
+  addSourceLocation(TL.getNameLoc());
 }
 
 void TypeLocWriter::VisitEnumTypeLoc(EnumTypeLoc TL) {
-  Record.AddSourceLocation(TL.getNameLoc());
+  addSourceLocation(TL.getNameLoc());
 }
 
 void TypeLocWriter::VisitAttributedTypeLoc(AttributedTypeLoc TL) {
@@ -774,95 +787,95 @@ void TypeLocWriter::VisitAttributedTypeLoc(AttributedTypeLoc TL) {
 }
 
 void TypeLocWriter::VisitTemplateTypeParmTypeLoc(TemplateTypeParmTypeLoc TL) {
-  Record.AddSourceLocation(TL.getNameLoc());
+  addSourceLocation(TL.getNameLoc());
 }
 
 void TypeLocWriter::VisitSubstTemplateTypeParmTypeLoc(
                                             SubstTemplateTypeParmTypeLoc TL) {
-  Record.AddSourceLocation(TL.getNameLoc());
+  addSourceLocation(TL.getNameLoc());
 }
 
 void TypeLocWriter::VisitSubstTemplateTypeParmPackTypeLoc(
                                           SubstTemplateTypeParmPackTypeLoc TL) {
-  Record.AddSourceLocation(TL.getNameLoc());
+  addSourceLocation(TL.getNameLoc());
 }
 
 void TypeLocWriter::VisitTemplateSpecializationTypeLoc(
                                            TemplateSpecializationTypeLoc TL) {
-  Record.AddSourceLocation(TL.getTemplateKeywordLoc());
-  Record.AddSourceLocation(TL.getTemplateNameLoc());
-  Record.AddSourceLocation(TL.getLAngleLoc());
-  Record.AddSourceLocation(TL.getRAngleLoc());
+  addSourceLocation(TL.getTemplateKeywordLoc());
+  addSourceLocation(TL.getTemplateNameLoc());
+  addSourceLocation(TL.getLAngleLoc());
+  addSourceLocation(TL.getRAngleLoc());
   for (unsigned i = 0, e = TL.getNumArgs(); i != e; ++i)
     Record.AddTemplateArgumentLocInfo(TL.getArgLoc(i).getArgument().getKind(),
                                       TL.getArgLoc(i).getLocInfo());
 }
 
 void TypeLocWriter::VisitParenTypeLoc(ParenTypeLoc TL) {
-  Record.AddSourceLocation(TL.getLParenLoc());
-  Record.AddSourceLocation(TL.getRParenLoc());
+  addSourceLocation(TL.getLParenLoc());
+  addSourceLocation(TL.getRParenLoc());
 }
 
 void TypeLocWriter::VisitElaboratedTypeLoc(ElaboratedTypeLoc TL) {
-  Record.AddSourceLocation(TL.getElaboratedKeywordLoc());
+  addSourceLocation(TL.getElaboratedKeywordLoc());
   Record.AddNestedNameSpecifierLoc(TL.getQualifierLoc());
 }
 
 void TypeLocWriter::VisitInjectedClassNameTypeLoc(InjectedClassNameTypeLoc TL) {
-  Record.AddSourceLocation(TL.getNameLoc());
+  addSourceLocation(TL.getNameLoc());
 }
 
 void TypeLocWriter::VisitDependentNameTypeLoc(DependentNameTypeLoc TL) {
-  Record.AddSourceLocation(TL.getElaboratedKeywordLoc());
+  addSourceLocation(TL.getElaboratedKeywordLoc());
   Record.AddNestedNameSpecifierLoc(TL.getQualifierLoc());
-  Record.AddSourceLocation(TL.getNameLoc());
+  addSourceLocation(TL.getNameLoc());
 }
 
 void TypeLocWriter::VisitDependentTemplateSpecializationTypeLoc(
        DependentTemplateSpecializationTypeLoc TL) {
-  Record.AddSourceLocation(TL.getElaboratedKeywordLoc());
+  addSourceLocation(TL.getElaboratedKeywordLoc());
   Record.AddNestedNameSpecifierLoc(TL.getQualifierLoc());
-  Record.AddSourceLocation(TL.getTemplateKeywordLoc());
-  Record.AddSourceLocation(TL.getTemplateNameLoc());
-  Record.AddSourceLocation(TL.getLAngleLoc());
-  Record.AddSourceLocation(TL.getRAngleLoc());
+  addSourceLocation(TL.getTemplateKeywordLoc());
+  addSourceLocation(TL.getTemplateNameLoc());
+  addSourceLocation(TL.getLAngleLoc());
+  addSourceLocation(TL.getRAngleLoc());
   for (unsigned I = 0, E = TL.getNumArgs(); I != E; ++I)
     Record.AddTemplateArgumentLocInfo(TL.getArgLoc(I).getArgument().getKind(),
                                       TL.getArgLoc(I).getLocInfo());
 }
 
 void TypeLocWriter::VisitPackExpansionTypeLoc(PackExpansionTypeLoc TL) {
-  Record.AddSourceLocation(TL.getEllipsisLoc());
+  addSourceLocation(TL.getEllipsisLoc());
 }
 
 void TypeLocWriter::VisitObjCInterfaceTypeLoc(ObjCInterfaceTypeLoc TL) {
-  Record.AddSourceLocation(TL.getNameLoc());
+  addSourceLocation(TL.getNameLoc());
 }
 
 void TypeLocWriter::VisitObjCObjectTypeLoc(ObjCObjectTypeLoc TL) {
   Record.push_back(TL.hasBaseTypeAsWritten());
-  Record.AddSourceLocation(TL.getTypeArgsLAngleLoc());
-  Record.AddSourceLocation(TL.getTypeArgsRAngleLoc());
+  addSourceLocation(TL.getTypeArgsLAngleLoc());
+  addSourceLocation(TL.getTypeArgsRAngleLoc());
   for (unsigned i = 0, e = TL.getNumTypeArgs(); i != e; ++i)
     Record.AddTypeSourceInfo(TL.getTypeArgTInfo(i));
-  Record.AddSourceLocation(TL.getProtocolLAngleLoc());
-  Record.AddSourceLocation(TL.getProtocolRAngleLoc());
+  addSourceLocation(TL.getProtocolLAngleLoc());
+  addSourceLocation(TL.getProtocolRAngleLoc());
   for (unsigned i = 0, e = TL.getNumProtocols(); i != e; ++i)
-    Record.AddSourceLocation(TL.getProtocolLoc(i));
+    addSourceLocation(TL.getProtocolLoc(i));
 }
 
 void TypeLocWriter::VisitObjCObjectPointerTypeLoc(ObjCObjectPointerTypeLoc TL) {
-  Record.AddSourceLocation(TL.getStarLoc());
+  addSourceLocation(TL.getStarLoc());
 }
 
 void TypeLocWriter::VisitAtomicTypeLoc(AtomicTypeLoc TL) {
-  Record.AddSourceLocation(TL.getKWLoc());
-  Record.AddSourceLocation(TL.getLParenLoc());
-  Record.AddSourceLocation(TL.getRParenLoc());
+  addSourceLocation(TL.getKWLoc());
+  addSourceLocation(TL.getLParenLoc());
+  addSourceLocation(TL.getRParenLoc());
 }
 
 void TypeLocWriter::VisitPipeTypeLoc(PipeTypeLoc TL) {
-  Record.AddSourceLocation(TL.getKWLoc());
+  addSourceLocation(TL.getKWLoc());
 }
 
 void ASTWriter::WriteTypeAbbrevs() {
@@ -1110,6 +1123,10 @@ void ASTWriter::WriteBlockInfoBlock() {
   RECORD(PPD_ENTITIES_OFFSETS);
   RECORD(VTABLE_USES);
   RECORD(PPD_SKIPPED_RANGES);
+  RECORD(TYPE_CLASS_COUNTS);
+  RECORD(RECORD_LAYOUTS);
+  RECORD(IDENTIFIER_FILTER);
+  RECORD(IMPORTED_REDECLARATIONS);
   RECORD(REFERENCED_SELECTOR_POOL);
   RECORD(TU_UPDATE_LEXICAL);
   RECORD(SEMA_DECL_REFS);
@@ -2188,30 +2205,108 @@ void ASTWriter::WriteHeaderSearch(const HeaderSearch &HS) {
     free(const_cast<char *>(SavedStrings[I]));
 }
 
+/// Compress the contents of a source buffer, without its terminating null
+/// character, for a SM_SLOC_BUFFER_BLOB_COMPRESSED record.
+///
+/// \returns true if the buffer was compressed into \p CompressedBuffer.
+static bool compressBlob(StringRef Blob, SmallString<0> &CompressedBuffer) {
+  if (!llvm::zlib::isAvailable())
+    return false;
+  llvm::Error E = llvm::zlib::compress(Blob.drop_back(1), CompressedBuffer);
+  if (!E)
+    return true;
+  llvm::consumeError(std::move(E));
+  CompressedBuffer.clear();
+  return false;
+}
+
 static void emitBlob(llvm::BitstreamWriter &Stream, StringRef Blob,
+                     const Optional<SmallString<0>> &CompressedBuffer,
                      unsigned SLocBufferBlobCompressedAbbrv,
                      unsigned SLocBufferBlobAbbrv) {
   using RecordDataType = ASTWriter::RecordData::value_type;
 
-  // Compress the buffer if possible. We expect that almost all PCM
+  // Use the compressed buffer if there is one. We expect that almost all PCM
   // consumers will not want its contents.
-  SmallString<0> CompressedBuffer;
-  if (llvm::zlib::isAvailable()) {
-    llvm::Error E = llvm::zlib::compress(Blob.drop_back(1), CompressedBuffer);
-    if (!E) {
-      RecordDataType Record[] = {SM_SLOC_BUFFER_BLOB_COMPRESSED,
-                                 Blob.size() - 1};
-      Stream.EmitRecordWithBlob(SLocBufferBlobCompressedAbbrv, Record,
-                                CompressedBuffer);
-      return;
-    }
-    llvm::consumeError(std::move(E));
+  if (CompressedBuffer) {
+    RecordDataType Record[] = {SM_SLOC_BUFFER_BLOB_COMPRESSED,
+                               Blob.size() - 1};
+    Stream.EmitRecordWithBlob(SLocBufferBlobCompressedAbbrv, Record,
+                              *CompressedBuffer);
+    return;
   }
 
   RecordDataType Record[] = {SM_SLOC_BUFFER_BLOB};
   Stream.EmitRecordWithBlob(SLocBufferBlobAbbrv, Record, Blob);
 }
 
+/// Whether the source location entry for \p Content carries the contents of
+/// its buffer.
+static bool shouldEmitSLocBlob(const SrcMgr::ContentCache *Content) {
+  return !Content->OrigEntry || Content->BufferOverridden ||
+         Content->IsTransient;
+}
+
+/// Compress the buffers that are stored in the source manager block.
+///
+/// Compression is by far the most expensive part of writing that block when
+/// a module embeds its files, and each buffer is compressed independently,
+/// so do it on a thread pool before the block is written. zlib's output only
+/// depends on its input, so the resulting file is the same however many
+/// threads are used.
+///
+/// \returns the compressed buffer for each local source location entry that
+/// has a blob, indexed by the entry's index. Entries whose buffer couldn't be
+/// compressed have no value.
+static std::vector<Optional<SmallString<0>>>
+compressSLocBlobs(SourceManager &SourceMgr, const Preprocessor &PP) {
+  std::vector<Optional<SmallString<0>>> Compressed(
+      SourceMgr.local_sloc_entry_size());
+  if (!llvm::zlib::isAvailable())
+    return Compressed;
+
+  // Getting at the buffers may have to read files and diagnose problems
+  // doing so, so do it here rather than on the pool.
+  std::vector<std::pair<unsigned, StringRef>> Blobs;
+  for (unsigned I = 1, N = SourceMgr.local_sloc_entry_size(); I != N; ++I) {
+    const SrcMgr::SLocEntry &SLoc = SourceMgr.getLocalSLocEntry(I);
+    if (!SLoc.isFile())
+      continue;
+    const SrcMgr::ContentCache *Content = SLoc.getFile().getContentCache();
+    if (!shouldEmitSLocBlob(Content))
+      continue;
+    const llvm::MemoryBuffer *Buffer =
+        Content->getBuffer(PP.getDiagnostics(), PP.getSourceManager());
+    Blobs.push_back(
+        {I, StringRef(Buffer->getBufferStart(), Buffer->getBufferSize() + 1)});
+  }
+
+  auto Compress = [&](unsigned BlobIndex) {
+    SmallString<0> CompressedBuffer;
+    if (compressBlob(Blobs[BlobIndex].second, CompressedBuffer))
+      Compressed[Blobs[BlobIndex].first] = std::move(CompressedBuffer);
+  };
+
+  unsigned NumThreads =
+      std::min<size_t>(llvm::hardware_concurrency(), Blobs.size());
+  if (NumThreads <= 1) {
+    for (unsigned I = 0, N = Blobs.size(); I != N; ++I)
+      Compress(I);
+    return Compressed;
+  }
+
+  // Each task writes only its own elements of Compressed.
+  std::atomic<unsigned> NextBlob(0);
+  llvm::ThreadPool Pool(NumThreads);
+  for (unsigned T = 0; T != NumThreads; ++T)
+    Pool.async([&] {
+      for (unsigned I = NextBlob++; I < Blobs.size(); I = NextBlob++)
+        Compress(I);
+    });
+  Pool.wait();
+  return Compressed;
+}
+
 /// Writes the block containing the serialized form of the
 /// source manager.
 ///
@@ -2235,6 +2330,12 @@ void ASTWriter::WriteSourceManagerBlock(SourceManager &SourceMgr,
       CreateSLocBufferBlobAbbrev(Stream, true);
   unsigned SLocExpansionAbbrv = CreateSLocExpansionAbbrev(Stream);
 
+  std::vector<Optional<SmallString<0>>> CompressedBlobs;
+  if (CompressEmbeddedBuffers)
+    CompressedBlobs = compressSLocBlobs(SourceMgr, PP);
+  else
+    CompressedBlobs.resize(SourceMgr.local_sloc_entry_size());
+
   // Write out the source location entry table. We skip the first
   // entry, which is always the same dummy entry.
   std::vector<uint32_t> SLocEntryOffsets;
@@ -2294,8 +2395,7 @@ void ASTWriter::WriteSourceManagerBlock(SourceManager &SourceMgr,
 
         Stream.EmitRecordWithAbbrev(SLocFileAbbrv, Record);
 
-        if (Content->BufferOverridden || Content->IsTransient)
-          EmitBlob = true;
+        EmitBlob = shouldEmitSLocBlob(Content);
       } else {
         // The source location entry is a buffer. The blob associated
         // with this entry contains the contents of the buffer.
@@ -2320,8 +2420,8 @@ void ASTWriter::WriteSourceManagerBlock(SourceManager &SourceMgr,
         const llvm::MemoryBuffer *Buffer =
             Content->getBuffer(PP.getDiagnostics(), PP.getSourceManager());
         StringRef Blob(Buffer->getBufferStart(), Buffer->getBufferSize() + 1);
-        emitBlob(Stream, Blob, SLocBufferBlobCompressedAbbrv,
-                 SLocBufferBlobAbbrv);
+        emitBlob(Stream, Blob, CompressedBlobs[I],
+                 SLocBufferBlobCompressedAbbrv, SLocBufferBlobAbbrv);
       }
     } else {
       // The source location entry is a macro expansion.
@@ -3154,6 +3254,14 @@ void ASTWriter::WriteType(QualType T) {
   W.Visit(T);
   uint64_t Offset = W.Emit();
 
+  // Count the type, so that a reader can presize the set that uniques it.
+  if (!T.hasLocalNonFastQualifiers()) {
+    unsigned TC = T->getTypeClass();
+    if (NumTypesByClass.size() <= TC)
+      NumTypesByClass.resize(TC + 1);
+    ++NumTypesByClass[TC];
+  }
+
   // Record the offset for this type.
   unsigned Index = Idx.getIndex() - FirstTypeID;
   if (TypeOffsets.size() == Index)
@@ -3210,6 +3318,10 @@ void ASTWriter::WriteTypeDeclOffsets() {
     Stream.EmitRecordWithBlob(TypeOffsetAbbrev, Record, bytes(TypeOffsets));
   }
 
+  // Write the number of types of each type class.
+  if (!NumTypesByClass.empty())
+    Stream.EmitRecord(TYPE_CLASS_COUNTS, NumTypesByClass);
+
   // Write the declaration offsets array
   Abbrev = std::make_shared<BitCodeAbbrev>();
   Abbrev->Add(BitCodeAbbrevOp(DECL_OFFSET));
@@ -3742,6 +3854,7 @@ void ASTWriter::WriteIdentifierTable(Preprocessor &PP,
 
     // Create the on-disk hash table representation. We only store offsets
     // for identifiers that appear here for the first time.
+    IdentifierFilter::Builder Filter;
     IdentifierOffsets.resize(NextIdentID - FirstIdentID);
     for (auto IdentIDPair : IdentifierIDs) {
       auto *II = const_cast<IdentifierInfo *>(IdentIDPair.first);
@@ -3752,8 +3865,10 @@ void ASTWriter::WriteIdentifierTable(Preprocessor &PP,
       if (ID >= FirstIdentID || !Chain || !II->isFromAST()
           || II->hasChangedSinceDeserialization() ||
           (Trait.needDecls() &&
-           II->hasFETokenInfoChangedSinceDeserialization()))
+           II->hasFETokenInfoChangedSinceDeserialization())) {
         Generator.insert(II, ID, Trait);
+        Filter.insert(Trait.ComputeHash(II));
+      }
     }
 
     // Create the on-disk hash table in a buffer.
@@ -3778,6 +3893,20 @@ void ASTWriter::WriteIdentifierTable(Preprocessor &PP,
     // Write the identifier table
     RecordData::value_type Record[] = {IDENTIFIER_TABLE, BucketOffset};
     Stream.EmitRecordWithBlob(IDTableAbbrev, Record, IdentifierTable);
+
+    // Write the filter that lets identifier lookups skip the table.
+    if (!Filter.empty()) {
+      SmallString<1024> FilterData;
+      Filter.emit(FilterData);
+
+      Abbrev = std::make_shared<BitCodeAbbrev>();
+      Abbrev->Add(BitCodeAbbrevOp(IDENTIFIER_FILTER));
+      Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob));
+      unsigned FilterAbbrev = Stream.EmitAbbrev(std::move(Abbrev));
+
+      RecordData::value_type FilterRecord[] = {IDENTIFIER_FILTER};
+      Stream.EmitRecordWithBlob(FilterAbbrev, FilterRecord, FilterData);
+    }
   }
 
   // Write the offsets table for identifier IDs.
@@ -4363,6 +4492,111 @@ void ASTWriter::WriteObjCCategories() {
   Stream.EmitRecord(OBJC_CATEGORIES, Categories);
 }
 
+void ASTWriter::WriteRecordLayouts() {
+  // Only store the layouts of records written to this file, and only if
+  // every declaration the layout refers to has been written as well.
+  auto GetWrittenDeclID = [&](const Decl *D) -> serialization::DeclID {
+    return D ? DeclIDs.lookup(D) : 0;
+  };
+
+  SmallVector<std::pair<serialization::DeclID, const RecordDecl *>, 16>
+      Records;
+  for (const auto &Entry : Context->ASTRecordLayouts) {
+    const RecordDecl *RD = Entry.first;
+    if (!Entry.second || RD->isFromASTFile() || RD->isInvalidDecl())
+      continue;
+    if (serialization::DeclID ID = GetWrittenDeclID(RD))
+      Records.push_back(std::make_pair(ID, RD));
+  }
+  if (Records.empty())
+    return;
+
+  // Sort the layouts by declaration ID, so that the AST file does not depend
+  // on the order of the layout cache.
+  llvm::sort(Records, llvm::less_first());
+
+  RecordData Layouts;
+  for (const auto &Entry : Records) {
+    const RecordDecl *RD = Entry.second;
+    const ASTRecordLayout &Layout = *Context->ASTRecordLayouts[RD];
+    unsigned StartIndex = Layouts.size();
+    bool Complete = true;
+    auto AddDecl = [&](const Decl *D) {
+      serialization::DeclID ID = GetWrittenDeclID(D);
+      if (D && !ID)
+        Complete = false;
+      Layouts.push_back(ID);
+    };
+    auto AddCharUnits = [&](CharUnits C) {
+      Layouts.push_back(static_cast<uint64_t>(C.getQuantity()));
+    };
+
+    Layouts.push_back(Entry.first);
+    // Allocate space for the length.
+    Layouts.push_back(0);
+
+    AddCharUnits(Layout.getSize());
+    AddCharUnits(Layout.getDataSize());
+    AddCharUnits(Layout.getAlignment());
+    AddCharUnits(Layout.getUnadjustedAlignment());
+    AddCharUnits(Layout.getRequiredAlignment());
+    Layouts.push_back(Layout.getFieldCount());
+    for (unsigned I = 0, N = Layout.getFieldCount(); I != N; ++I)
+      Layouts.push_back(Layout.getFieldOffset(I));
+
+    if (const auto *CXXRD = dyn_cast<CXXRecordDecl>(RD)) {
+      AddCharUnits(Layout.getNonVirtualSize());
+      AddCharUnits(Layout.getNonVirtualAlignment());
+      AddCharUnits(Layout.getSizeOfLargestEmptySubobject());
+      AddCharUnits(Layout.getVBPtrOffset());
+      Layouts.push_back(Layout.hasOwnVFPtr() |
+                        Layout.hasExtendableVFPtr() << 1 |
+                        Layout.endsWithZeroSizedObject() << 2 |
+                        Layout.leadsWithZeroSizedBase() << 3 |
+                        Layout.isPrimaryBaseVirtual() << 4);
+      AddDecl(Layout.getPrimaryBase());
+      AddDecl(Layout.getBaseSharingVBPtr());
+
+      unsigned NumBasesIndex = Layouts.size();
+      Layouts.push_back(0);
+      for (const CXXBaseSpecifier &Base : CXXRD->bases()) {
+        if (Base.isVirtual())
+          continue;
+        const CXXRecordDecl *BaseDecl = Base.getType()->getAsCXXRecordDecl();
+        AddDecl(BaseDecl);
+        AddCharUnits(Layout.getBaseClassOffset(BaseDecl));
+        ++Layouts[NumBasesIndex];
+      }
+
+      SmallVector<std::pair<serialization::DeclID, const CXXRecordDecl *>, 4>
+          VBases;
+      for (const auto &VBase : Layout.getVBaseOffsetsMap())
+        VBases.push_back(
+            std::make_pair(GetWrittenDeclID(VBase.first), VBase.first));
+      llvm::sort(VBases, llvm::less_first());
+      Layouts.push_back(VBases.size());
+      for (const auto &VBase : VBases) {
+        const ASTRecordLayout::VBaseInfo &Info =
+            Layout.getVBaseOffsetsMap().find(VBase.second)->second;
+        AddDecl(VBase.second);
+        AddCharUnits(Info.VBaseOffset);
+        Layouts.push_back(Info.hasVtorDisp());
+      }
+    }
+
+    if (!Complete) {
+      Layouts.resize(StartIndex);
+      continue;
+    }
+
+    // Update the length.
+    Layouts[StartIndex + 1] = Layouts.size() - StartIndex - 2;
+  }
+
+  if (!Layouts.empty())
+    Stream.EmitRecord(RECORD_LAYOUTS, Layouts);
+}
+
 void ASTWriter::WriteLateParsedTemplates(Sema &SemaRef) {
   Sema::LateParsedTemplateMapT &LPTMap = SemaRef.LateParsedTemplateMap;
 
@@ -4571,9 +4805,10 @@ void ASTWriter::SetSelectorOffset(Selector Sel, uint32_t Offset) {
 ASTWriter::ASTWriter(llvm::BitstreamWriter &Stream,
                      SmallVectorImpl<char> &Buffer, MemoryBufferCache &PCMCache,
                      ArrayRef<std::shared_ptr<ModuleFileExtension>> Extensions,
-                     bool IncludeTimestamps)
+                     bool IncludeTimestamps, bool CompressEmbeddedBuffers)
     : Stream(Stream), Buffer(Buffer), PCMCache(PCMCache),
-      IncludeTimestamps(IncludeTimestamps) {
+      IncludeTimestamps(IncludeTimestamps),
+      CompressEmbeddedBuffers(CompressEmbeddedBuffers) {
   for (const auto &Ext : Extensions) {
     if (auto Writer = Ext->createExtensionWriter(*this))
       ModuleFileExtensionWriters.push_back(std::move(Writer));
@@ -4629,6 +4864,30 @@ ASTFileSignature ASTWriter::WriteAST(Sema &SemaRef,
   return Signature;
 }
 
+bool clang::compressASTFile(SmallVectorImpl<char> &Data) {
+  if (!llvm::zlib::isAvailable())
+    return true;
+
+  SmallString<0> Compressed;
+  {
+    using namespace llvm::support;
+    llvm::raw_svector_ostream Out(Compressed);
+    endian::Writer LE(Out, little);
+    Out.write(COMPRESSED_AST_FILE_MAGIC, sizeof(COMPRESSED_AST_FILE_MAGIC));
+    LE.write<uint32_t>(COMPRESSED_AST_FILE_VERSION);
+    LE.write<uint64_t>(Data.size());
+  }
+  SmallString<0> Contents;
+  if (llvm::Error E = llvm::zlib::compress(StringRef(Data.data(), Data.size()),
+                                           Contents)) {
+    llvm::consumeError(std::move(E));
+    return true;
+  }
+  Compressed += Contents;
+  Data.assign(Compressed.begin(), Compressed.end());
+  return false;
+}
+
 template<typename Vector>
 static void AddLazyVectorDecls(ASTWriter &Writer, Vector &Vec,
                                ASTWriter::RecordData &Record) {
@@ -4683,6 +4942,8 @@ ASTFileSignature ASTWriter::WriteASTCore(Sema &SemaRef, StringRef isysroot,
                      PREDEF_DECL_CF_CONSTANT_STRING_TAG_ID);
   RegisterPredefDecl(Context.TypePackElementDecl,
                      PREDEF_DECL_TYPE_PACK_ELEMENT_ID);
+  RegisterPredefDecl(Context.TypePackSliceDecl,
+                     PREDEF_DECL_TYPE_PACK_SLICE_ID);
 
   // Build a record containing all of the tentative definitions in this file, in
   // TentativeDefinitions order.  Generally, this record will be empty for
@@ -5033,6 +5294,9 @@ ASTFileSignature ASTWriter::WriteASTCore(Sema &SemaRef, StringRef isysroot,
   if (!ModularCodegenDecls.empty())
     Stream.EmitRecord(MODULAR_CODEGEN_DECLS, ModularCodegenDecls);
 
+  if (!ImportedRedeclarations.empty())
+    Stream.EmitRecord(IMPORTED_REDECLARATIONS, ImportedRedeclarations);
+
   // Write the record containing tentative definitions.
   if (!TentativeDefinitions.empty())
     Stream.EmitRecord(TENTATIVE_DEFINITIONS, TentativeDefinitions);
@@ -5131,6 +5395,7 @@ ASTFileSignature ASTWriter::WriteASTCore(Sema &SemaRef, StringRef isysroot,
   }
 
   WriteObjCCategories();
+  WriteRecordLayouts();
   if(!WritingModule) {
     WriteOptimizePragmaOptions(SemaRef);
     WriteMSStructPragmaOptions(SemaRef);
@@ -5318,14 +5583,15 @@ void ASTWriter::WriteDeclUpdatesBlocks(RecordDataImpl &OffsetsRecord) {
   }
 }
 
-void ASTWriter::AddSourceLocation(SourceLocation Loc, RecordDataImpl &Record) {
-  uint32_t Raw = Loc.getRawEncoding();
-  Record.push_back((Raw << 1) | (Raw >> 31));
+void ASTWriter::AddSourceLocation(SourceLocation Loc, RecordDataImpl &Record,
+                                  SourceLocationSequence *Seq) {
+  Record.push_back(Seq ? Seq->encode(Loc) : SourceLocationEncoding::encode(Loc));
 }
 
-void ASTWriter::AddSourceRange(SourceRange Range, RecordDataImpl &Record) {
-  AddSourceLocation(Range.getBegin(), Record);
-  AddSourceLocation(Range.getEnd(), Record);
+void ASTWriter::AddSourceRange(SourceRange Range, RecordDataImpl &Record,
+                               SourceLocationSequence *Seq) {
+  AddSourceLocation(Range.getBegin(), Record, Seq);
+  AddSourceLocation(Range.getEnd(), Record, Seq);
 }
 
 void ASTRecordWriter::AddAPInt(const llvm::APInt &Value) {
@@ -6062,9 +6328,14 @@ void ASTRecordWriter::AddCXXDefinitionData(const CXXRecordDecl *D) {
   Record->push_back(Data.HasDeclaredCopyAssignmentWithConstParam);
 
   // getODRHash will compute the ODRHash if it has not been previously computed.
-  Record->push_back(D->getODRHash());
-  bool ModulesDebugInfo = Writer->Context->getLangOpts().ModulesDebugInfo &&
-                          Writer->WritingModule && !D->isDependentType();
+  Record->push_back(Data.HasODRHash || Writer->needsODRHashes()
+                        ? D->getODRHash()
+                        : 0);
+  bool ModulesDebugInfo =
+      Writer->Context->getLangOpts().ModulesDebugInfo &&
+      (Writer->WritingModule ||
+       Writer->Context->getLangOpts().BuildingPCHWithObjectFile) &&
+      !D->isDependentType();
   Record->push_back(ModulesDebugInfo);
   if (ModulesDebugInfo)
     Writer->ModularCodegenDecls.push_back(Writer->GetDeclRef(D));
@@ -181,6 +181,22 @@ namespace clang {
         Record.AddDeclRef(F.second);
     }
 
+    /// Add the first local declaration \p D to the index of imported
+    /// redeclarations, under the first declaration of each module in its
+    /// chain. That covers both an imported declaration that we redeclare and
+    /// an imported declaration that was merged into one that we declared
+    /// before importing it.
+    void AddToImportedRedeclarations(const Decl *D) {
+      llvm::MapVector<ModuleFile*, const Decl*> Firsts;
+      for (const Decl *R = D->getMostRecentDecl(); R; R = R->getPreviousDecl())
+        if (R->isFromASTFile())
+          Firsts[Writer.Chain->getOwningModuleFile(R)] = R;
+      for (const auto &F : Firsts) {
+        Writer.ImportedRedeclarations.push_back(Writer.GetDeclRef(F.second));
+        Writer.ImportedRedeclarations.push_back(Writer.GetDeclRef(D));
+      }
+    }
+
     /// Get the specialization decl from an entry in the specialization list.
     template <typename EntryType>
     typename RedeclarableTemplateDecl::SpecEntryTraits<EntryType>::DeclType *
@@ -433,7 +449,8 @@ void ASTDeclWriter::VisitEnumDecl(EnumDecl *D) {
   Record.push_back(D->isScoped());
   Record.push_back(D->isScopedUsingClassTag());
   Record.push_back(D->isFixed());
-  Record.push_back(D->getODRHash());
+  Record.push_back(D->hasODRHash() || Writer.needsODRHashes() ? D->getODRHash()
+                                                               : 0);
 
   if (MemberSpecializationInfo *MemberInfo = D->getMemberSpecializationInfo()) {
     Record.AddDeclRef(MemberInfo->getInstantiatedFrom());
@@ -553,7 +570,8 @@ void ASTDeclWriter::VisitFunctionDecl(FunctionDecl *D) {
   Record.push_back(D->getLinkageInternal());
   Record.AddSourceLocation(D->getEndLoc());
 
-  Record.push_back(D->getODRHash());
+  Record.push_back(D->hasODRHash() || Writer.needsODRHashes() ? D->getODRHash()
+                                                               : 0);
 
   Record.push_back(D->getTemplatedKind());
   switch (D->getTemplatedKind()) {
@@ -1691,6 +1709,11 @@ void ASTDeclWriter::VisitRedeclarable(Redeclarable<T> *D) {
     // first local declaration in the chain.
     const Decl *FirstLocal = Writer.getFirstLocalDecl(DAsT);
     if (DAsT == FirstLocal) {
+      // Index the redeclarations of imported declarations, so that a reader
+      // can complete their chains without looking up their names.
+      if (Writer.Chain)
+        AddToImportedRedeclarations(DAsT);
+
       // Emit a list of all imported first declarations so that we can be sure
       // that all redeclarations visible to this module are before D in the
       // redecl chain.
@@ -2166,6 +2189,7 @@ void ASTWriter::WriteDeclAbbrevs() {
   Abv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 1)); //HadMultipleCandidates
   Abv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed,
                            1)); // RefersToEnclosingVariableOrCapture
+  Abv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 1)); // HasNameLoc
   Abv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6)); // DeclRef
   Abv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6)); // Location
   DeclRefExprAbbrev = Stream.EmitAbbrev(std::move(Abv));
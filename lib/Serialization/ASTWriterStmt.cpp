@@ -452,6 +452,7 @@ void ASTStmtWriter::VisitDeclRefExpr(DeclRefExpr *E) {
   Record.push_back(E->hasTemplateKWAndArgsInfo());
   Record.push_back(E->hadMultipleCandidates());
   Record.push_back(E->refersToEnclosingVariableOrCapture());
+  Record.push_back(E->hasNameLoc());
 
   if (E->hasTemplateKWAndArgsInfo()) {
     unsigned NumTemplateArgs = E->getNumTemplateArgs();
@@ -478,7 +479,9 @@ void ASTStmtWriter::VisitDeclRefExpr(DeclRefExpr *E) {
 
   Record.AddDeclRef(E->getDecl());
   Record.AddSourceLocation(E->getLocation());
-  Record.AddDeclarationNameLoc(E->DNLoc, E->getDecl()->getDeclName());
+  if (E->hasNameLoc())
+    Record.AddDeclarationNameLoc(*E->getTrailingObjects<DeclarationNameLoc>(),
+                                 E->getDecl()->getDeclName());
   Code = serialization::EXPR_DECL_REF;
 }
 
@@ -686,7 +689,7 @@ void ASTStmtWriter::VisitMemberExpr(MemberExpr *E) {
   Record.AddSourceLocation(E->getMemberLoc());
   Record.push_back(E->isArrow());
   Record.AddSourceLocation(E->getOperatorLoc());
-  Record.AddDeclarationNameLoc(E->MemberDNLoc,
+  Record.AddDeclarationNameLoc(E->getMemberNameInfo().getInfo(),
                                E->getMemberDecl()->getDeclName());
   Code = serialization::EXPR_MEMBER;
 }
@@ -25,18 +25,36 @@ PCHGenerator::PCHGenerator(
     const Preprocessor &PP, StringRef OutputFile, StringRef isysroot,
     std::shared_ptr<PCHBuffer> Buffer,
     ArrayRef<std::shared_ptr<ModuleFileExtension>> Extensions,
-    bool AllowASTWithErrors, bool IncludeTimestamps)
+    bool AllowASTWithErrors, bool IncludeTimestamps, bool CompressAST,
+    bool CompressEmbeddedBuffers)
     : PP(PP), OutputFile(OutputFile), isysroot(isysroot.str()),
       SemaPtr(nullptr), Buffer(std::move(Buffer)), Stream(this->Buffer->Data),
       Writer(Stream, this->Buffer->Data, PP.getPCMCache(), Extensions,
-             IncludeTimestamps),
-      AllowASTWithErrors(AllowASTWithErrors) {
+             IncludeTimestamps, CompressEmbeddedBuffers),
+      AllowASTWithErrors(AllowASTWithErrors), CompressAST(CompressAST) {
   this->Buffer->IsComplete = false;
 }
 
 PCHGenerator::~PCHGenerator() {
 }
 
+/// Lay out the complete, non-dependent records defined in this translation
+/// unit, so that the translation units using the AST file can load their
+/// layouts instead of computing them again.
+static void layoutRecords(ASTContext &Ctx) {
+  // Laying out a record may create types, so don't hold on to the list.
+  for (unsigned I = 0; I != Ctx.getTypes().size(); ++I) {
+    const auto *RT = dyn_cast<RecordType>(Ctx.getTypes()[I]);
+    if (!RT)
+      continue;
+    const RecordDecl *RD = RT->getDecl();
+    if (RD->isFromASTFile() || RD->isInvalidDecl() ||
+        !RD->isCompleteDefinition() || RD->isDependentType())
+      continue;
+    Ctx.getASTRecordLayout(RD);
+  }
+}
+
 void PCHGenerator::HandleTranslationUnit(ASTContext &Ctx) {
   // Don't create a PCH if there were fatal failures during module loading.
   if (PP.getModuleLoader().HadFatalFailure)
@@ -56,6 +74,11 @@ void PCHGenerator::HandleTranslationUnit(ASTContext &Ctx) {
     }
   }
 
+  // Don't dump the layout of every record when asked to dump the ones that
+  // the translation unit needs.
+  if (!hasErrors && !Ctx.getLangOpts().DumpRecordLayouts)
+    layoutRecords(Ctx);
+
   // Emit the PCH file to the Buffer.
   assert(SemaPtr && "No Sema?");
   Buffer->Signature =
@@ -64,6 +87,11 @@ void PCHGenerator::HandleTranslationUnit(ASTContext &Ctx) {
                       // only warn-as-error kind.
                       PP.getDiagnostics().hasUncompilableErrorOccurred());
 
+  // The PCM cache keeps the uncompressed AST for this process; only what
+  // reaches the disk is compressed.
+  if (CompressAST)
+    compressASTFile(Buffer->Data);
+
   Buffer->IsComplete = true;
 }
 
@@ -16,6 +16,7 @@
 #include "clang/Basic/FileManager.h"
 #include "clang/Lex/HeaderSearch.h"
 #include "clang/Serialization/ASTBitCodes.h"
+#include "clang/Serialization/ASTReader.h"
 #include "clang/Serialization/GlobalModuleIndex.h"
 #include "clang/Serialization/Module.h"
 #include "llvm/ADT/DenseMap.h"
@@ -58,7 +59,7 @@ namespace {
 static const char * const IndexFileName = "modules.idx";
 
 /// The global index file version.
-static const unsigned CurrentVersion = 1;
+static const unsigned CurrentVersion = 2;
 
 //----------------------------------------------------------------------------//
 // Global module index reader.
@@ -202,6 +203,10 @@ GlobalModuleIndex::GlobalModuleIndex(std::unique_ptr<llvm::MemoryBuffer> Buffer,
                                       Record.begin() + Idx + NumDeps);
       Idx += NumDeps;
 
+      // Signature
+      for (unsigned I = 0; I != Modules[ID].Signature.size(); ++I)
+        Modules[ID].Signature[I] = Record[Idx++];
+
       // Make sure we're at the end of the record.
       assert(Idx == Record.size() && "More module info?");
 
@@ -414,6 +419,9 @@ namespace {
     /// files in which those identifiers are considered interesting.
     InterestingIdentifierMap InterestingIdentifiers;
 
+    /// The module files that were taken over from an existing index.
+    llvm::SmallPtrSet<const FileEntry *, 16> IndexedModuleFiles;
+
     /// Write the block-info block for the global module index file.
     void emitBlockInfoBlock(llvm::BitstreamWriter &Stream);
 
@@ -440,6 +448,31 @@ namespace {
     /// \returns true if an error occurred, false otherwise.
     bool loadModuleFile(const FileEntry *File);
 
+    /// Whether the given module file was taken over from an existing index,
+    /// so that it doesn't need to be loaded.
+    bool isIndexedModuleFile(const FileEntry *File) const {
+      return IndexedModuleFiles.count(File);
+    }
+
+    /// Take over a module file that an existing index describes, instead
+    /// of loading it.
+    void addIndexedModuleFile(const FileEntry *File,
+                              const ASTFileSignature &Signature,
+                              ArrayRef<const FileEntry *> Dependencies) {
+      IndexedModuleFiles.insert(File);
+      getModuleFileInfo(File).Signature = Signature;
+      for (const FileEntry *Dep : Dependencies) {
+        unsigned DependsOnID = getModuleFileInfo(Dep).ID;
+        getModuleFileInfo(File).Dependencies.push_back(DependsOnID);
+      }
+    }
+
+    /// Take over an identifier that an existing index records as
+    /// interesting in the given module file.
+    void addIndexedIdentifier(StringRef Name, const FileEntry *File) {
+      InterestingIdentifiers[Name].push_back(getModuleFileInfo(File).ID);
+    }
+
     /// Write the index to the given bitstream.
     /// \returns true if an error occurred, false otherwise.
     bool writeIndex(llvm::BitstreamWriter &Stream);
@@ -518,7 +551,9 @@ bool GlobalModuleIndexBuilder::loadModuleFile(const FileEntry *File) {
   }
 
   // Initialize the input stream
-  llvm::BitstreamCursor InStream(PCHContainerRdr.ExtractPCH(**Buffer));
+  std::unique_ptr<llvm::MemoryBuffer> Decompressed;
+  llvm::BitstreamCursor InStream(ASTReader::decompressASTFile(
+      PCHContainerRdr.ExtractPCH(**Buffer), Decompressed));
 
   // Sniff for the signature.
   if (InStream.Read(8) != 'C' ||
@@ -775,6 +810,9 @@ bool GlobalModuleIndexBuilder::writeIndex(llvm::BitstreamWriter &Stream) {
     // Dependencies
     Record.push_back(M->second.Dependencies.size());
     Record.append(M->second.Dependencies.begin(), M->second.Dependencies.end());
+
+    // Signature
+    Record.append(M->second.Signature.begin(), M->second.Signature.end());
     Stream.EmitRecord(MODULE, Record);
   }
 
@@ -845,6 +883,65 @@ GlobalModuleIndex::writeIndex(FileManager &FileMgr,
   // The module index builder.
   GlobalModuleIndexBuilder Builder(FileMgr, PCHContainerRdr);
 
+  // Start from the existing index, if there is one. A module file it
+  // describes can be taken over as long as neither it nor anything it
+  // depends on has changed since the index was written; everything else is
+  // loaded below.
+  std::unique_ptr<GlobalModuleIndex> OldIndex(readIndex(Path).first);
+  if (OldIndex && OldIndex->IdentifierIndex) {
+    SmallVector<const FileEntry *, 16> Files(OldIndex->Modules.size());
+    SmallVector<bool, 16> Unchanged(OldIndex->Modules.size());
+    for (unsigned I = 0, N = OldIndex->Modules.size(); I != N; ++I) {
+      const ModuleInfo &Info = OldIndex->Modules[I];
+      if (Info.FileName.empty())
+        continue;
+      Files[I] = FileMgr.getFile(Info.FileName, /*openFile=*/false,
+                                 /*cacheFailure=*/false);
+      Unchanged[I] = Files[I] && Files[I]->getSize() == Info.Size &&
+                     Files[I]->getModificationTime() == Info.ModTime;
+    }
+
+    // A module file that imports a changed one is out of date, too.
+    for (bool Changed = true; Changed;) {
+      Changed = false;
+      for (unsigned I = 0, N = OldIndex->Modules.size(); I != N; ++I) {
+        if (!Unchanged[I])
+          continue;
+        for (unsigned Dep : OldIndex->Modules[I].Dependencies) {
+          if (Dep >= N || !Unchanged[Dep]) {
+            Unchanged[I] = false;
+            Changed = true;
+            break;
+          }
+        }
+      }
+    }
+
+    for (unsigned I = 0, N = OldIndex->Modules.size(); I != N; ++I) {
+      if (!Unchanged[I])
+        continue;
+      SmallVector<const FileEntry *, 4> Dependencies;
+      for (unsigned Dep : OldIndex->Modules[I].Dependencies)
+        Dependencies.push_back(Files[Dep]);
+      Builder.addIndexedModuleFile(Files[I], OldIndex->Modules[I].Signature,
+                                   Dependencies);
+    }
+
+    // Identifiers known only to module files that changed are dropped; the
+    // new versions of those files put back the ones they still have.
+    IdentifierIndexTable &Table =
+        *static_cast<IdentifierIndexTable *>(OldIndex->IdentifierIndex);
+    for (auto Key = Table.key_begin(), KeyEnd = Table.key_end(); Key != KeyEnd;
+         ++Key) {
+      auto Known = Table.find(*Key);
+      if (Known == Table.end())
+        continue;
+      for (unsigned ID : *Known)
+        if (ID < OldIndex->Modules.size() && Unchanged[ID])
+          Builder.addIndexedIdentifier(*Key, Files[ID]);
+    }
+  }
+
   // Load each of the module files.
   std::error_code EC;
   for (llvm::sys::fs::directory_iterator D(Path, EC), DEnd;
@@ -861,9 +958,10 @@ GlobalModuleIndex::writeIndex(FileManager &FileMgr,
       continue;
     }
 
-    // If we can't find the module file, skip it.
+    // If we can't find the module file, or the existing index already
+    // told us about it, skip it.
     const FileEntry *ModuleFile = FileMgr.getFile(D->path());
-    if (!ModuleFile)
+    if (!ModuleFile || Builder.isIndexedModuleFile(ModuleFile))
       continue;
 
     // Load this module file.
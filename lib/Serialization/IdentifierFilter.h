@@ -0,0 +1,112 @@
+//===- IdentifierFilter.h - Bloom filter over AST file identifiers -*- C++ -*-//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file defines the Bloom filter that an AST file stores over the keys
+//  of its identifier table, so that looking up an identifier that a module
+//  file doesn't know can usually skip its hash table.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LIB_SERIALIZATION_IDENTIFIERFILTER_H
+#define LLVM_CLANG_LIB_SERIALIZATION_IDENTIFIERFILTER_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/MathExtras.h"
+#include <cstdint>
+
+namespace clang {
+namespace serialization {
+
+/// A blocked Bloom filter over the 32-bit hashes of the keys of an on-disk
+/// hash table.
+///
+/// Each key sets four bits of a single 64-bit word, so that a query touches
+/// one word of the filter however large the table is.  The filter has a
+/// power of two number of words and uses about 12 bits per key, which gives
+/// a false positive rate of a few percent.
+///
+/// The serialized form is the array of words, in little-endian order.
+class IdentifierFilter {
+  /// The serialized words, or empty if there is no filter.
+  StringRef Words;
+
+  static unsigned getWordIndex(uint32_t Hash, size_t NumWords) {
+    return Hash & (NumWords - 1);
+  }
+
+  static uint64_t getWordMask(uint32_t Hash) {
+    // The word index uses the low bits of the hash; spread the rest over the
+    // bits that are set within the word.
+    uint64_t H = (uint64_t(Hash) | (uint64_t(Hash) << 32)) *
+                 0x9E3779B97F4A7C15ULL;
+    return (uint64_t(1) << ((H >> 40) & 63)) |
+           (uint64_t(1) << ((H >> 46) & 63)) |
+           (uint64_t(1) << ((H >> 52) & 63)) |
+           (uint64_t(1) << ((H >> 58) & 63));
+  }
+
+public:
+  IdentifierFilter() = default;
+
+  /// Use the serialized filter in \p Blob.  A blob that is not a valid
+  /// filter yields an empty filter, which rules nothing out.
+  explicit IdentifierFilter(StringRef Blob) {
+    if (Blob.size() % 8 == 0 && llvm::isPowerOf2_64(Blob.size() / 8))
+      Words = Blob;
+  }
+
+  /// Whether there is a filter at all.
+  explicit operator bool() const { return !Words.empty(); }
+
+  /// Whether a key with the given hash may be in the table.  If there is no
+  /// filter, any key may be.
+  bool mayContain(uint32_t Hash) const {
+    if (Words.empty())
+      return true;
+    size_t NumWords = Words.size() / 8;
+    uint64_t Word = llvm::support::endian::read<uint64_t, llvm::support::little,
+                                                llvm::support::unaligned>(
+        Words.data() + 8 * getWordIndex(Hash, NumWords));
+    uint64_t Mask = getWordMask(Hash);
+    return (Word & Mask) == Mask;
+  }
+
+  /// Builds the serialized form of a filter.
+  class Builder {
+    SmallVector<uint32_t, 128> Hashes;
+
+  public:
+    void insert(uint32_t Hash) { Hashes.push_back(Hash); }
+
+    bool empty() const { return Hashes.empty(); }
+
+    /// Write the filter over the inserted hashes to \p Out.
+    void emit(SmallVectorImpl<char> &Out) const {
+      size_t NumWords = llvm::NextPowerOf2((Hashes.size() * 12) / 64);
+      SmallVector<uint64_t, 64> Bits(NumWords, 0);
+      for (uint32_t Hash : Hashes)
+        Bits[getWordIndex(Hash, NumWords)] |= getWordMask(Hash);
+
+      size_t Start = Out.size();
+      Out.resize(Start + NumWords * 8);
+      for (size_t I = 0; I != NumWords; ++I)
+        llvm::support::endian::write<uint64_t, llvm::support::little,
+                                     llvm::support::unaligned>(
+            Out.data() + Start + 8 * I, Bits[I]);
+    }
+  };
+};
+
+} // namespace serialization
+} // namespace clang
+
+#endif // LLVM_CLANG_LIB_SERIALIZATION_IDENTIFIERFILTER_H
@@ -19,11 +19,13 @@
 #include "clang/Frontend/PCHContainerOperations.h"
 #include "clang/Lex/HeaderSearch.h"
 #include "clang/Lex/ModuleMap.h"
+#include "clang/Serialization/ASTReader.h"
 #include "clang/Serialization/GlobalModuleIndex.h"
 #include "clang/Serialization/Module.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/iterator.h"
@@ -32,6 +34,9 @@
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/GraphWriter.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/VirtualFileSystem.h"
 #include <algorithm>
 #include <cassert>
@@ -169,6 +174,11 @@ ModuleManager::addModule(StringRef FileName, ModuleKind Type,
     NewModule->Buffer = Buffer;
     // As above, the file descriptor is no longer needed.
     Entry->closeFile();
+  } else if (std::unique_ptr<llvm::MemoryBuffer> Buffer =
+                 takePrefetchedBuffer(FileName, Entry)) {
+    NewModule->Buffer = &PCMCache->addBuffer(FileName, std::move(Buffer));
+    // As above, the file descriptor is no longer needed.
+    Entry->closeFile();
   } else {
     // Open the AST file.
     llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buf((std::error_code()));
@@ -190,7 +200,9 @@ ModuleManager::addModule(StringRef FileName, ModuleKind Type,
   }
 
   // Initialize the stream.
-  NewModule->Data = PCHContainerRdr.ExtractPCH(*NewModule->Buffer);
+  NewModule->Data = ASTReader::decompressASTFile(
+      PCHContainerRdr.ExtractPCH(*NewModule->Buffer),
+      NewModule->DecompressedBuffer);
 
   // Read the signature eagerly now so that we can check it.  Avoid calling
   // ReadSignature unless there's something to check though.
@@ -217,6 +229,70 @@ ModuleManager::addModule(StringRef FileName, ModuleKind Type,
   return NewlyLoaded;
 }
 
+void ModuleManager::prefetchModuleFiles(ArrayRef<std::string> FileNames) {
+  SmallVector<StringRef, 16> ToRead;
+  for (const std::string &FileName : FileNames)
+    if (FileName != "-" && !PCMCache->lookupBuffer(FileName) &&
+        !PrefetchedModuleFiles.count(FileName) &&
+        !llvm::is_contained(ToRead, FileName))
+      ToRead.push_back(FileName);
+
+  // The first file is loaded right away; reading it in the background would
+  // not save anything.
+  if (ToRead.size() < 2)
+    return;
+
+  if (!PrefetchPool)
+    PrefetchPool = llvm::make_unique<llvm::ThreadPool>(
+        std::min(llvm::hardware_concurrency(), 8u));
+
+  IntrusiveRefCntPtr<llvm::vfs::FileSystem> FS = FileMgr.getVirtualFileSystem();
+  unsigned PageSize = llvm::sys::Process::getPageSize();
+  for (StringRef FileName : makeArrayRef(ToRead).drop_front()) {
+    SmallString<128> Path(FileName);
+    FileMgr.FixupRelativePath(Path);
+
+    // The entries of a StringMap don't move when it grows.
+    PrefetchedModuleFile &File = PrefetchedModuleFiles[FileName];
+    File.Ready = PrefetchPool->async([FS, PageSize, &File](std::string Path) {
+      auto Buf = FS->getBufferForFile(Path, /*FileSize=*/-1,
+                                      /*RequiresNullTerminator=*/false);
+      if (!Buf)
+        return;
+      // The file is likely to be mapped into memory. Touch each page so that
+      // it is read in now, rather than when the AST reader first gets to it.
+      const volatile char *Data = (*Buf)->getBufferStart();
+      for (size_t I = 0, N = (*Buf)->getBufferSize(); I < N; I += PageSize)
+        (void)Data[I];
+      File.Buffer = std::move(*Buf);
+    }, Path.str().str());
+  }
+}
+
+std::unique_ptr<llvm::MemoryBuffer>
+ModuleManager::takePrefetchedBuffer(StringRef FileName,
+                                    const FileEntry *Entry) {
+  auto Known = PrefetchedModuleFiles.find(FileName);
+  if (Known == PrefetchedModuleFiles.end())
+    return nullptr;
+
+  Known->second.Ready.wait();
+  std::unique_ptr<llvm::MemoryBuffer> Buffer = std::move(Known->second.Buffer);
+  PrefetchedModuleFiles.erase(Known);
+
+  // If the file changed after it was read, read it again. The signature
+  // checks catch a change that leaves the size alone.
+  if (Buffer && Buffer->getBufferSize() != (uint64_t)Entry->getSize())
+    return nullptr;
+  return Buffer;
+}
+
+void ModuleManager::clearPrefetchedModuleFiles() {
+  for (auto &File : PrefetchedModuleFiles)
+    File.second.Ready.wait();
+  PrefetchedModuleFiles.clear();
+}
+
 void ModuleManager::removeModules(
     ModuleIterator First,
     llvm::SmallPtrSetImpl<ModuleFile *> &LoadedSuccessfully,
@@ -334,7 +410,10 @@ ModuleManager::ModuleManager(FileManager &FileMgr, MemoryBufferCache &PCMCache,
     : FileMgr(FileMgr), PCMCache(&PCMCache), PCHContainerRdr(PCHContainerRdr),
       HeaderSearchInfo(HeaderSearchInfo) {}
 
-ModuleManager::~ModuleManager() { delete FirstVisitState; }
+ModuleManager::~ModuleManager() {
+  clearPrefetchedModuleFiles();
+  delete FirstVisitState;
+}
 
 void ModuleManager::visit(llvm::function_ref<bool(ModuleFile &M)> Visitor,
                           llvm::SmallPtrSetImpl<ModuleFile *> *ModuleFilesHit) {
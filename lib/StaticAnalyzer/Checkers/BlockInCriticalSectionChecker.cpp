@@ -53,6 +53,9 @@ public:
   bool isLockFunction(const CallEvent &Call) const;
   bool isUnlockFunction(const CallEvent &Call) const;
 
+  /// Only calls to the functions above are of interest.
+  bool handlesCall(const CallEvent &Call) const;
+
   /// Process unlock.
   /// Process lock.
   /// Process blocking functions (sleep, getc, fgets, read, recv)
@@ -141,15 +144,14 @@ bool BlockInCriticalSectionChecker::isUnlockFunction(const CallEvent &Call) cons
   return false;
 }
 
+bool BlockInCriticalSectionChecker::handlesCall(const CallEvent &Call) const {
+  initIdentifierInfo(Call.getState()->getStateManager().getContext());
+  return isBlockingFunction(Call) || isLockFunction(Call) ||
+         isUnlockFunction(Call);
+}
+
 void BlockInCriticalSectionChecker::checkPostCall(const CallEvent &Call,
                                                   CheckerContext &C) const {
-  initIdentifierInfo(C.getASTContext());
-
-  if (!isBlockingFunction(Call)
-      && !isLockFunction(Call)
-      && !isUnlockFunction(Call))
-    return;
-
   ProgramStateRef State = C.getState();
   unsigned mutexCount = State->get<MutexCounter>();
   if (isUnlockFunction(Call) && mutexCount > 0) {
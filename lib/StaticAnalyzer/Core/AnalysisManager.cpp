@@ -35,7 +35,9 @@ AnalysisManager::AnalysisManager(ASTContext &ASTCtx, DiagnosticsEngine &diags,
       Ctx(ASTCtx), Diags(diags), LangOpts(ASTCtx.getLangOpts()),
       PathConsumers(PDC), CreateStoreMgr(storemgr),
       CreateConstraintMgr(constraintmgr), CheckerMgr(checkerMgr),
-      options(Options) {
+      FunctionTimeBudget(Options.getMaxFunctionTime()),
+      TUTimeBudget(Options.getMaxTUTime()), TUStartTime(BudgetClock::now()),
+      FunctionStartTime(TUStartTime), options(Options) {
   AnaCtxMgr.getCFGBuildOptions().setAllAlwaysAdd();
 }
 
@@ -47,6 +49,17 @@ AnalysisManager::~AnalysisManager() {
   }
 }
 
+constexpr double AnalysisManager::TimeBudgetHardLimit;
+
+double AnalysisManager::getTimeUsage(BudgetClock::time_point Start,
+                                     unsigned Budget) const {
+  if (!Budget)
+    return 0;
+  std::chrono::duration<double, std::milli> Elapsed =
+      BudgetClock::now() - Start;
+  return Elapsed.count() / Budget;
+}
+
 void AnalysisManager::FlushDiagnostics() {
   PathDiagnosticConsumer::FilesMade filesMade;
   for (PathDiagnosticConsumers::iterator I = PathConsumers.begin(),
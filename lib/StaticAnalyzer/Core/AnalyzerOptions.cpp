@@ -81,6 +81,8 @@ AnalyzerOptions::getExplorationStrategy() {
                 ExplorationStrategyKind::UnexploredFirstLocationQueue)
           .Case("bfs_block_dfs_contents",
                 ExplorationStrategyKind::BFSBlockDFSContents)
+          .Case("coverage_guided_queue",
+                ExplorationStrategyKind::CoverageGuidedQueue)
           .Default(None);
   assert(K.hasValue() && "User mode is invalid.");
   return K.getValue();
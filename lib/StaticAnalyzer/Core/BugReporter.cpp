@@ -2227,8 +2227,6 @@ PathDiagnosticLocation BugReport::getLocation(const SourceManager &SM) const {
 
 BugReportEquivClass::~BugReportEquivClass() = default;
 
-GRBugReporter::~GRBugReporter() = default;
-
 BugReporterData::~BugReporterData() = default;
 
 ExplodedGraph &GRBugReporter::getGraph() { return Eng.getGraph(); }
@@ -2279,8 +2277,14 @@ public:
   size_t Index;
 };
 
+} // namespace
+
+namespace clang {
+namespace ento {
+
 /// A wrapper around a trimmed graph and its node maps.
 class TrimmedGraph {
+  InterExplodedGraphMap ForwardMap;
   InterExplodedGraphMap InverseMap;
 
   using PriorityMapTy = llvm::DenseMap<const ExplodedNode *, unsigned>;
@@ -2324,33 +2328,41 @@ public:
   TrimmedGraph(const ExplodedGraph *OriginalGraph,
                ArrayRef<const ExplodedNode *> Nodes);
 
+  /// Returns true if the trimmed graph contains the error node \p N of the
+  /// original graph.
+  bool contains(const ExplodedNode *N) const { return ForwardMap.count(N); }
+
+  /// Start popping the report graphs of \p Nodes, which must be in the
+  /// trimmed graph, from the shortest path to the longest one.
+  void setReportNodes(ArrayRef<const ExplodedNode *> Nodes);
+
   bool popNextReportGraph(ReportGraph &GraphWrapper);
 };
 
-} // namespace
+} // namespace ento
+} // namespace clang
 
 TrimmedGraph::TrimmedGraph(const ExplodedGraph *OriginalGraph,
                            ArrayRef<const ExplodedNode *> Nodes) {
   // The trimmed graph is created in the body of the constructor to ensure
   // that the DenseMaps have been initialized already.
-  InterExplodedGraphMap ForwardMap;
   G = OriginalGraph->trim(Nodes, &ForwardMap, &InverseMap);
 
-  // Find the (first) error node in the trimmed graph.  We just need to consult
+  // Find the error nodes in the trimmed graph.  We just need to consult
   // the node map which maps from nodes in the original graph to nodes
   // in the new graph.
   llvm::SmallPtrSet<const ExplodedNode *, 32> RemainingNodes;
 
-  for (unsigned i = 0, count = Nodes.size(); i < count; ++i) {
-    if (const ExplodedNode *NewNode = ForwardMap.lookup(Nodes[i])) {
-      ReportNodes.push_back(std::make_pair(NewNode, i));
+  for (const ExplodedNode *N : Nodes)
+    if (const ExplodedNode *NewNode = ForwardMap.lookup(N))
       RemainingNodes.insert(NewNode);
-    }
-  }
 
   assert(!RemainingNodes.empty() && "No error node found in the trimmed graph");
 
-  // Perform a forward BFS to find all the shortest paths.
+  // Perform a forward BFS to find all the shortest paths. The successors are
+  // visited in their order in the original graph, so that the shortest path
+  // to an error node does not depend on the other error nodes the graph was
+  // trimmed to.
   std::queue<const ExplodedNode *> WS;
 
   assert(G->num_roots() == 1);
@@ -2376,16 +2388,52 @@ TrimmedGraph::TrimmedGraph(const ExplodedGraph *OriginalGraph,
       if (RemainingNodes.empty())
         break;
 
-    for (ExplodedNode::const_pred_iterator I = Node->succ_begin(),
-                                           E = Node->succ_end();
+    const ExplodedNode *OrigNode = InverseMap.lookup(Node);
+    for (ExplodedNode::const_succ_iterator I = OrigNode->succ_begin(),
+                                           E = OrigNode->succ_end();
          I != E; ++I)
-      WS.push(*I);
+      if (const ExplodedNode *Succ = ForwardMap.lookup(*I))
+        WS.push(Succ);
   }
+}
+
+void TrimmedGraph::setReportNodes(ArrayRef<const ExplodedNode *> Nodes) {
+  ReportNodes.clear();
+  for (unsigned i = 0, count = Nodes.size(); i < count; ++i)
+    if (const ExplodedNode *NewNode = ForwardMap.lookup(Nodes[i]))
+      ReportNodes.push_back(std::make_pair(NewNode, i));
 
   // Sort the error paths from longest to shortest.
   llvm::sort(ReportNodes, PriorityCompare<true>(PriorityMap));
 }
 
+GRBugReporter::GRBugReporter(BugReporterData &d, ExprEngine &eng)
+    : BugReporter(d, GRBugReporterKind), Eng(eng) {}
+
+GRBugReporter::~GRBugReporter() = default;
+
+TrimmedGraph &
+GRBugReporter::getTrimmedGraph(ArrayRef<const ExplodedNode *> ErrorNodes) {
+  if (SharedTrimmedGraph && SharedTrimmedGraphSize == getGraph().size() &&
+      llvm::all_of(ErrorNodes, [this](const ExplodedNode *N) {
+        return !N || SharedTrimmedGraph->contains(N);
+      }))
+    return *SharedTrimmedGraph;
+
+  // Trim the graph to the error nodes of all the valid reports at once.
+  SmallVector<const ExplodedNode *, 32> AllErrorNodes;
+  for (BugReportEquivClass *EQ : getEquivalenceClasses())
+    for (BugReport &R : *EQ)
+      if (R.isValid())
+        if (const ExplodedNode *N = R.getErrorNode())
+          AllErrorNodes.push_back(N);
+
+  SharedTrimmedGraph = llvm::make_unique<TrimmedGraph>(&getGraph(),
+                                                       AllErrorNodes);
+  SharedTrimmedGraphSize = getGraph().size();
+  return *SharedTrimmedGraph;
+}
+
 bool TrimmedGraph::popNextReportGraph(ReportGraph &GraphWrapper) {
   if (ReportNodes.empty())
     return false;
@@ -2595,7 +2643,8 @@ std::pair<BugReport*, std::unique_ptr<VisitorsDiagnosticsTy>> findValidReport(
   ReportGraph &ErrorGraph,
   ArrayRef<BugReport *> &bugReports,
   AnalyzerOptions &Opts,
-  GRBugReporter &Reporter) {
+  GRBugReporter &Reporter,
+  VisitorResultCache &Cache) {
 
   while (TrimG.popNextReportGraph(ErrorGraph)) {
     // Find the BugReport with the original location.
@@ -2614,7 +2663,7 @@ std::pair<BugReport*, std::unique_ptr<VisitorsDiagnosticsTy>> findValidReport(
     R->addVisitor(llvm::make_unique<ConditionBRVisitor>());
     R->addVisitor(llvm::make_unique<CXXSelfAssignmentBRVisitor>());
 
-    BugReporterContext BRC(Reporter, ErrorGraph.BackMap);
+    BugReporterContext BRC(Reporter, ErrorGraph.BackMap, &Cache);
 
     // Run all visitors on a given graph, once.
     std::unique_ptr<VisitorsDiagnosticsTy> visitorNotes =
@@ -2665,10 +2714,12 @@ GRBugReporter::generatePathDiagnostics(
   if (!HasValid)
     return Out;
 
-  TrimmedGraph TrimG(&getGraph(), errorNodes);
+  TrimmedGraph &TrimG = getTrimmedGraph(errorNodes);
+  TrimG.setReportNodes(errorNodes);
   ReportGraph ErrorGraph;
+  VisitorResultCache Cache;
   auto ReportInfo = findValidReport(TrimG, ErrorGraph, bugReports,
-                  getAnalyzerOptions(), *this);
+                  getAnalyzerOptions(), *this, Cache);
   BugReport *R = ReportInfo.first;
 
   if (R && R->isValid()) {
@@ -1183,14 +1183,25 @@ FindLastStoreBRVisitor::VisitNode(const ExplodedNode *Succ,
   //     where the binding first occurred.
   // (2) Succ has this binding and is a PostStore node for this region, i.e.
   //     the same binding was re-assigned here.
+  // Whether it is only depends on the nodes, so the other reports of the
+  // equivalence class do not need to look the bindings up again.
   if (!StoreSite) {
-    if (Succ->getState()->getSVal(R) != V)
+    VisitorResultCache *Cache = BRC.getVisitorCache();
+    const ExplodedNode *OrigSucc =
+        Cache ? BRC.getNodeResolver().getOriginalNode(Succ) : nullptr;
+    if (OrigSucc && Cache->hasNoStoreOf(OrigSucc, R, V))
       return nullptr;
 
-    if (Pred->getState()->getSVal(R) == V) {
+    bool IsStoreSite = Succ->getState()->getSVal(R) == V;
+    if (IsStoreSite && Pred->getState()->getSVal(R) == V) {
       Optional<PostStore> PS = Succ->getLocationAs<PostStore>();
-      if (!PS || PS->getLocationValue() != R)
-        return nullptr;
+      IsStoreSite = PS && PS->getLocationValue() == R;
+    }
+
+    if (!IsStoreSite) {
+      if (OrigSucc)
+        Cache->noteNoStoreOf(OrigSucc, R, V);
+      return nullptr;
     }
 
     StoreSite = Succ;
@@ -1785,11 +1796,22 @@ const char *ConditionBRVisitor::getTag() {
 std::shared_ptr<PathDiagnosticPiece>
 ConditionBRVisitor::VisitNode(const ExplodedNode *N,
                               BugReporterContext &BRC, BugReport &BR) {
+  // Whether there is a condition to explain at a node does not depend on the
+  // report, only the pieces explaining it do, so only the nodes without any
+  // are remembered for the other reports of the equivalence class.
+  VisitorResultCache *Cache = BRC.getVisitorCache();
+  const ExplodedNode *OrigN =
+      Cache ? BRC.getNodeResolver().getOriginalNode(N) : nullptr;
+  if (OrigN && Cache->hasNoCondition(OrigN))
+    return nullptr;
+
   auto piece = VisitNodeImpl(N, BRC, BR);
   if (piece) {
     piece->setTag(getTag());
     if (auto *ev = dyn_cast<PathDiagnosticEventPiece>(piece.get()))
       ev->setPrunable(true, /* override */ false);
+  } else if (OrigN) {
+    Cache->noteNoCondition(OrigN);
   }
   return piece;
 }
@@ -2422,6 +2444,7 @@ void FalsePositiveRefutationBRVisitor::finalizeVisitor(
 
   // Create a refutation manager
   SMTSolverRef RefutationSolver = CreateZ3Solver();
+  RefutationSolver->setTimeout(BRC.getAnalyzerOptions().getZ3QueryTimeout());
   ASTContext &Ctx = BRC.getASTContext();
 
   // Add constraints to the solver
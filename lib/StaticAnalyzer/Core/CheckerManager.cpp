@@ -22,9 +22,13 @@
 #include "clang/StaticAnalyzer/Core/PathSensitive/CoreEngine.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ExprEngine.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/SVals.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 #include <cassert>
 #include <vector>
 
@@ -59,6 +63,143 @@ void CheckerManager::finishedCheckerRegistration() {
 #endif
 }
 
+//===----------------------------------------------------------------------===//
+// Checker profiling.
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+/// Charges the time and memory spent while it is alive to the profile of a
+/// checker, if checker profiling is enabled. The time spent in the scopes
+/// nested in it is charged to their own checkers only.
+class ProfileScope {
+  CheckerManager &Mgr;
+  CheckerManager::CheckerProfile *Profile;
+  llvm::TimeRecord Start;
+  llvm::TimeRecord NestedTime;
+  llvm::TimeRecord *ParentNestedTime = nullptr;
+
+public:
+  ProfileScope(CheckerManager &Mgr, const CheckerBase *Checker,
+               unsigned NumCallbacks = 1)
+      : Mgr(Mgr), Profile(Mgr.getProfile(Checker)) {
+    if (!Profile)
+      return;
+    Profile->NumCallbacks += NumCallbacks;
+    ParentNestedTime = Mgr.NestedProfileTime;
+    Mgr.NestedProfileTime = &NestedTime;
+    Start = llvm::TimeRecord::getCurrentTime(/*Start=*/true);
+  }
+
+  /// Note that the callback turned the state \p Before into \p After.
+  void noteStateChange(const ProgramStateRef &Before,
+                       const ProgramStateRef &After) {
+    if (Profile && Before != After)
+      ++Profile->NumStateChanges;
+  }
+
+  ~ProfileScope() {
+    if (!Profile)
+      return;
+    llvm::TimeRecord Elapsed =
+        llvm::TimeRecord::getCurrentTime(/*Start=*/false);
+    Elapsed -= Start;
+    llvm::TimeRecord Own = Elapsed;
+    Own -= NestedTime;
+    Profile->Time += Own;
+
+    Mgr.NestedProfileTime = ParentNestedTime;
+    if (ParentNestedTime)
+      *ParentNestedTime += Elapsed;
+  }
+};
+
+} // namespace
+
+/// Count the nodes of \p Dst that a checker added when it was run on the
+/// nodes of \p Src.
+static void countNewNodes(CheckerManager::CheckerProfile &Profile,
+                          const ExplodedNodeSet &Src,
+                          const ExplodedNodeSet &Dst) {
+  llvm::SmallPtrSet<const ExplodedNode *, 8> Preds(Src.begin(), Src.end());
+  for (const ExplodedNode *N : Dst) {
+    if (Preds.count(N))
+      continue;
+    ++Profile.NumNodes;
+    const ExplodedNode *Pred = N->getFirstPred();
+    if (!Pred || Pred->getState() != N->getState())
+      ++Profile.NumStateChanges;
+  }
+}
+
+static StringRef getCheckerName(const CheckerBase *Checker) {
+  StringRef Name = Checker->getTagDescription();
+  return Name.empty() ? "<unnamed>" : Name;
+}
+
+/// Print \p Str as the contents of a JSON string.
+static void printJSONEscaped(raw_ostream &OS, StringRef Str) {
+  for (unsigned char C : Str) {
+    if (C == '"' || C == '\\')
+      OS << '\\' << C;
+    else if (C < 0x20)
+      OS << llvm::format("\\u%04x", C);
+    else
+      OS << C;
+  }
+}
+
+void CheckerManager::printProfile(raw_ostream &OS, bool AsJSON) const {
+  using ProfileEntry = std::pair<const CheckerBase *, const CheckerProfile *>;
+  std::vector<ProfileEntry> Sorted;
+  for (const auto &P : Profiles)
+    Sorted.emplace_back(P.first, &P.second);
+  std::sort(Sorted.begin(), Sorted.end(),
+            [](const ProfileEntry &LHS, const ProfileEntry &RHS) {
+              double LHSTime = LHS.second->Time.getWallTime();
+              double RHSTime = RHS.second->Time.getWallTime();
+              if (LHSTime != RHSTime)
+                return LHSTime > RHSTime;
+              return getCheckerName(LHS.first) < getCheckerName(RHS.first);
+            });
+
+  if (AsJSON) {
+    OS << "{\n  \"checkers\": [";
+    for (unsigned I = 0, E = Sorted.size(); I != E; ++I) {
+      const CheckerProfile &P = *Sorted[I].second;
+      OS << (I ? ",\n" : "\n") << "    { \"name\": \"";
+      printJSONEscaped(OS, getCheckerName(Sorted[I].first));
+      OS << "\", \"wall_time\": "
+         << llvm::format("%.6f", P.Time.getWallTime())
+         << ", \"user_time\": "
+         << llvm::format("%.6f", P.Time.getUserTime())
+         << ", \"system_time\": "
+         << llvm::format("%.6f", P.Time.getSystemTime())
+         << ", \"memory\": " << P.Time.getMemUsed()
+         << ", \"callbacks\": " << P.NumCallbacks
+         << ", \"nodes\": " << P.NumNodes
+         << ", \"state_changes\": " << P.NumStateChanges << " }";
+    }
+    OS << "\n  ]\n}\n";
+    return;
+  }
+
+  OS << "===" << std::string(73, '-') << "===\n"
+     << "                          Checker Profile\n"
+     << "===" << std::string(73, '-') << "===\n"
+     << "   Wall Time    User Time       Memory  Callbacks      Nodes"
+        "     States  Checker\n";
+  for (const auto &S : Sorted) {
+    const CheckerProfile &P = *S.second;
+    OS << llvm::format("%12.4f %12.4f %12lld %10u %10u %10u  ",
+                       P.Time.getWallTime(), P.Time.getUserTime(),
+                       (long long)P.Time.getMemUsed(), P.NumCallbacks,
+                       P.NumNodes, P.NumStateChanges)
+       << getCheckerName(S.first) << '\n';
+  }
+  OS << '\n';
+}
+
 //===----------------------------------------------------------------------===//
 // Functions for running checkers for AST traversing..
 //===----------------------------------------------------------------------===//
@@ -81,16 +222,20 @@ void CheckerManager::runCheckersOnASTDecl(const Decl *D, AnalysisManager& mgr,
   }
 
   assert(checkers);
-  for (const auto checker : *checkers)
+  for (const auto checker : *checkers) {
+    ProfileScope P(*this, checker.Checker);
     checker(D, mgr, BR);
+  }
 }
 
 void CheckerManager::runCheckersOnASTBody(const Decl *D, AnalysisManager& mgr,
                                           BugReporter &BR) {
   assert(D && D->hasBody());
 
-  for (const auto BodyChecker : BodyCheckers)
+  for (const auto BodyChecker : BodyCheckers) {
+    ProfileScope P(*this, BodyChecker.Checker);
     BodyChecker(D, mgr, BR);
+  }
 }
 
 //===----------------------------------------------------------------------===//
@@ -112,6 +257,7 @@ static void expandGraphWithCheckers(CHECK_CTX checkCtx,
     return;
   }
 
+  CheckerManager &Mgr = checkCtx.Eng.getCheckerManager();
   ExplodedNodeSet Tmp1, Tmp2;
   const ExplodedNodeSet *PrevSet = &Src;
 
@@ -124,9 +270,14 @@ static void expandGraphWithCheckers(CHECK_CTX checkCtx,
       CurrSet->clear();
     }
 
-    NodeBuilder B(*PrevSet, *CurrSet, BldrCtx);
-    for (const auto &NI : *PrevSet)
-      checkCtx.runChecker(*I, B, NI);
+    {
+      ProfileScope P(Mgr, I->Checker, PrevSet->size());
+      NodeBuilder B(*PrevSet, *CurrSet, BldrCtx);
+      for (const auto &NI : *PrevSet)
+        checkCtx.runChecker(*I, B, NI);
+    }
+    if (CheckerManager::CheckerProfile *Profile = Mgr.getProfile(I->Checker))
+      countNewNodes(*Profile, *PrevSet, *CurrSet);
 
     // If all the produced transitions are sinks, stop.
     if (CurrSet->empty())
@@ -257,7 +408,7 @@ namespace {
   // FIXME: This has all the same signatures as CheckObjCMessageContext.
   // Is there a way we can merge the two?
   struct CheckCallContext {
-    using CheckersTy = std::vector<CheckerManager::CheckCallFunc>;
+    using CheckersTy = SmallVectorImpl<CheckerManager::CheckCallFunc>;
 
     bool IsPreVisit, WasInlined;
     const CheckersTy &Checkers;
@@ -291,10 +442,14 @@ void CheckerManager::runCheckersForCallEvent(bool isPreVisit,
                                              const CallEvent &Call,
                                              ExprEngine &Eng,
                                              bool WasInlined) {
-  CheckCallContext C(isPreVisit,
-                     isPreVisit ? PreCallCheckers
-                                : PostCallCheckers,
-                     Call, Eng, WasInlined);
+  // Leave out the checkers that do not handle this call before expanding the
+  // graph, so that they are not run for every node.
+  SmallVector<CheckCallFunc, 8> Checkers;
+  for (const auto &Info : isPreVisit ? PreCallCheckers : PostCallCheckers)
+    if (!Info.IsForCallFn || (*Info.IsForCallFn)(Call))
+      Checkers.push_back(Info.CheckFn);
+
+  CheckCallContext C(isPreVisit, Checkers, Call, Eng, WasInlined);
   expandGraphWithCheckers(C, Dst, Src);
 }
 
@@ -392,8 +547,10 @@ void CheckerManager::runCheckersForBind(ExplodedNodeSet &Dst,
 void CheckerManager::runCheckersForEndAnalysis(ExplodedGraph &G,
                                                BugReporter &BR,
                                                ExprEngine &Eng) {
-  for (const auto EndAnalysisChecker : EndAnalysisCheckers)
+  for (const auto EndAnalysisChecker : EndAnalysisCheckers) {
+    ProfileScope P(*this, EndAnalysisChecker.Checker);
     EndAnalysisChecker(G, BR, Eng);
+  }
 }
 
 namespace {
@@ -446,6 +603,7 @@ void CheckerManager::runCheckersForEndFunction(NodeBuilderContext &BC,
   // autotransition for it.
   NodeBuilder Bldr(Pred, Dst, BC);
   for (const auto checkFn : EndFunctionCheckers) {
+    ProfileScope P(*this, checkFn.Checker);
     const ProgramPoint &L =
         FunctionExitPoint(RS, Pred->getLocationContext(), checkFn.Checker);
     CheckerContext C(Bldr, Eng, Pred, L);
@@ -532,8 +690,10 @@ void CheckerManager::runCheckersForNewAllocator(
 /// Run checkers for live symbols.
 void CheckerManager::runCheckersForLiveSymbols(ProgramStateRef state,
                                                SymbolReaper &SymReaper) {
-  for (const auto LiveSymbolsChecker : LiveSymbolsCheckers)
+  for (const auto LiveSymbolsChecker : LiveSymbolsCheckers) {
+    ProfileScope P(*this, LiveSymbolsChecker.Checker);
     LiveSymbolsChecker(state, SymReaper);
+  }
 }
 
 namespace {
@@ -594,8 +754,11 @@ CheckerManager::runCheckersForRegionChanges(ProgramStateRef state,
     // bail out.
     if (!state)
       return nullptr;
-    state = RegionChangesChecker(state, invalidated, ExplicitRegions, Regions,
-                                 LCtx, Call);
+    ProfileScope P(*this, RegionChangesChecker.Checker);
+    ProgramStateRef NewState = RegionChangesChecker(
+        state, invalidated, ExplicitRegions, Regions, LCtx, Call);
+    P.noteStateChange(state, NewState);
+    state = NewState;
   }
   return state;
 }
@@ -616,7 +779,11 @@ CheckerManager::runCheckersForPointerEscape(ProgramStateRef State,
     //  way), bail out.
     if (!State)
       return nullptr;
-    State = PointerEscapeChecker(State, Escaped, Call, Kind, ETraits);
+    ProfileScope P(*this, PointerEscapeChecker.Checker);
+    ProgramStateRef NewState =
+        PointerEscapeChecker(State, Escaped, Call, Kind, ETraits);
+    P.noteStateChange(State, NewState);
+    State = NewState;
   }
   return State;
 }
@@ -630,7 +797,10 @@ CheckerManager::runCheckersForEvalAssume(ProgramStateRef state,
     // bail out.
     if (!state)
       return nullptr;
-    state = EvalAssumeChecker(state, Cond, Assumption);
+    ProfileScope P(*this, EvalAssumeChecker.Checker);
+    ProgramStateRef NewState = EvalAssumeChecker(state, Cond, Assumption);
+    P.noteStateChange(state, NewState);
+    state = NewState;
   }
   return state;
 }
@@ -658,6 +828,7 @@ void CheckerManager::runCheckersForEvalCall(ExplodedNodeSet &Dst,
       { // CheckerContext generates transitions(populates checkDest) on
         // destruction, so introduce the scope to make sure it gets properly
         // populated.
+        ProfileScope P(*this, EvalCallChecker.Checker);
         CheckerContext C(B, Eng, Pred, L);
         evaluated = EvalCallChecker(CE, C);
       }
@@ -685,8 +856,10 @@ void CheckerManager::runCheckersOnEndOfTranslationUnit(
                                                   const TranslationUnitDecl *TU,
                                                   AnalysisManager &mgr,
                                                   BugReporter &BR) {
-  for (const auto EndOfTranslationUnitChecker : EndOfTranslationUnitCheckers)
+  for (const auto EndOfTranslationUnitChecker : EndOfTranslationUnitCheckers) {
+    ProfileScope P(*this, EndOfTranslationUnitChecker.Checker);
     EndOfTranslationUnitChecker(TU, mgr, BR);
+  }
 }
 
 void CheckerManager::runCheckersForPrintState(raw_ostream &Out,
@@ -738,11 +911,15 @@ void CheckerManager::_registerForPostObjCMessage(CheckObjCMessageFunc checkfn) {
   PostObjCMessageCheckers.push_back(checkfn);
 }
 
-void CheckerManager::_registerForPreCall(CheckCallFunc checkfn) {
-  PreCallCheckers.push_back(checkfn);
+void CheckerManager::_registerForPreCall(
+    CheckCallFunc checkfn, Optional<HandlesCallFunc> isForCallFn) {
+  CallCheckerInfo info = { checkfn, isForCallFn };
+  PreCallCheckers.push_back(info);
 }
-void CheckerManager::_registerForPostCall(CheckCallFunc checkfn) {
-  PostCallCheckers.push_back(checkfn);
+void CheckerManager::_registerForPostCall(
+    CheckCallFunc checkfn, Optional<HandlesCallFunc> isForCallFn) {
+  CallCheckerInfo info = { checkfn, isForCallFn };
+  PostCallCheckers.push_back(info);
 }
 
 void CheckerManager::_registerForLocation(CheckLocationFunc checkfn) {
@@ -816,17 +993,20 @@ const CheckerManager::CachedStmtCheckers &
 CheckerManager::getCachedStmtCheckersFor(const Stmt *S, bool isPreVisit) {
   assert(S);
 
+  if (CachedStmtCheckersTable.empty())
+    CachedStmtCheckersTable.resize((Stmt::lastStmtConstant + 1) * 2);
+
   unsigned Key = (S->getStmtClass() << 1) | unsigned(isPreVisit);
-  CachedStmtCheckersMapTy::iterator CCI = CachedStmtCheckersMap.find(Key);
-  if (CCI != CachedStmtCheckersMap.end())
-    return CCI->second;
+  Optional<CachedStmtCheckers> &Entry = CachedStmtCheckersTable[Key];
+  if (Entry)
+    return *Entry;
 
   // Find the checkers that should run for this Stmt and cache them.
-  CachedStmtCheckers &Checkers = CachedStmtCheckersMap[Key];
+  Entry.emplace();
   for (const auto &Info : StmtCheckers)
     if (Info.IsPreVisit == isPreVisit && Info.IsForStmtFn(S))
-      Checkers.push_back(Info.CheckFn);
-  return Checkers;
+      Entry->push_back(Info.CheckFn);
+  return *Entry;
 }
 
 CheckerManager::~CheckerManager() {
@@ -22,6 +22,7 @@
 #include "clang/Analysis/ProgramPoint.h"
 #include "clang/Basic/LLVM.h"
 #include "clang/StaticAnalyzer/Core/AnalyzerOptions.h"
+#include "clang/StaticAnalyzer/Core/PathSensitive/AnalysisManager.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/BlockCounter.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ExplodedGraph.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/FunctionSummary.h"
@@ -46,6 +47,8 @@ STATISTIC(NumSteps,
             "The # of steps executed.");
 STATISTIC(NumReachedMaxSteps,
             "The # of times we reached the max number of steps.");
+STATISTIC(NumReachedTimeBudget,
+            "The # of times we reached the hard limit of the time budget.");
 STATISTIC(NumPathsExplored,
             "The # of paths explored by the analyzer.");
 
@@ -68,6 +71,8 @@ static std::unique_ptr<WorkList> generateWorkList(AnalyzerOptions &Opts,
       return WorkList::makeUnexploredFirstPriorityQueue();
     case ExplorationStrategyKind::UnexploredFirstLocationQueue:
       return WorkList::makeUnexploredFirstPriorityLocationQueue();
+    case ExplorationStrategyKind::CoverageGuidedQueue:
+      return WorkList::makeCoverageGuidedQueue();
   }
   llvm_unreachable("Unknown AnalyzerOptions::ExplorationStrategyKind");
 }
@@ -127,6 +132,7 @@ bool CoreEngine::ExecuteWorkList(const LocationContext *L, unsigned Steps,
   if(!UnlimitedSteps)
     G.reserve(std::min(Steps,PreReservationCap));
 
+  unsigned NumStepsTaken = 0;
   while (WList->hasWork()) {
     if (!UnlimitedSteps) {
       if (Steps == 0) {
@@ -136,6 +142,14 @@ bool CoreEngine::ExecuteWorkList(const LocationContext *L, unsigned Steps,
       --Steps;
     }
 
+    // Checking the clock on every step would be needlessly slow.
+    if (NumStepsTaken++ % 1024 == 0 &&
+        SubEng.getAnalysisManager().getTimeBudgetUsage() >=
+            AnalysisManager::TimeBudgetHardLimit) {
+      NumReachedTimeBudget++;
+      break;
+    }
+
     NumSteps++;
 
     const WorkListUnit& WU = WList->dequeue();
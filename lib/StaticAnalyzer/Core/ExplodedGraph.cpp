@@ -85,6 +85,9 @@ bool ExplodedGraph::shouldCollect(const ExplodedNode *node) {
   //      PreImplicitCall (so that we would be able to find it when retrying a
   //      call with no inlining).
   // FIXME: It may be safe to reclaim PreCall and PostCall nodes as well.
+  //
+  // Conditions 8 and 9 only keep nodes around for the precision of path
+  // diagnostics, so they are dropped when reclaiming nodes aggressively.
 
   // Conditions 1 and 2.
   if (node->pred_size() != 1 || node->succ_size() != 1)
@@ -128,16 +131,18 @@ bool ExplodedGraph::shouldCollect(const ExplodedNode *node) {
   // Condition 8.
   // Do not collect nodes for "interesting" lvalue expressions since they are
   // used extensively for generating path diagnostics.
-  if (isInterestingLValueExpr(Ex))
+  if (!AggressiveReclamation && isInterestingLValueExpr(Ex))
     return false;
 
   // Condition 9.
   // Do not collect nodes for non-consumed Stmt or Expr to ensure precise
   // diagnostic generation; specifically, so that we could anchor arrows
   // pointing to the beginning of statements (as written in code).
-  ParentMap &PM = progPoint.getLocationContext()->getParentMap();
-  if (!PM.isConsumedExpr(Ex))
-    return false;
+  if (!AggressiveReclamation) {
+    ParentMap &PM = progPoint.getLocationContext()->getParentMap();
+    if (!PM.isConsumedExpr(Ex))
+      return false;
+  }
 
   // Condition 10.
   const ProgramPoint SuccLoc = succ->getLocation();
@@ -196,7 +196,8 @@ ExprEngine::ExprEngine(cross_tu::CrossTranslationUnitContext &CTU,
   unsigned TrimInterval = mgr.options.getGraphTrimInterval();
   if (TrimInterval != 0) {
     // Enable eager node reclaimation when constructing the ExplodedGraph.
-    G.enableNodeReclamation(TrimInterval);
+    G.enableNodeReclamation(TrimInterval,
+                            mgr.options.shouldTrimGraphAggressively());
   }
 }
 
@@ -614,6 +615,10 @@ static bool shouldRemoveDeadBindings(AnalysisManager &AMgr,
   if (Pred->getLocation().getAs<BlockEntrance>())
     return true;
 
+  // Are we only purging state values at the beginning of basic blocks?
+  if (AMgr.options.AnalysisPurgeOpt == PurgeBlock)
+    return false;
+
   // Is this on a non-expression?
   if (!isa<Expr>(S))
     return true;
@@ -655,6 +660,12 @@ void ExprEngine::removeDead(ExplodedNode *Pred, ExplodedNodeSet &Out,
     LC = LC->getParent();
   }
 
+  // FIXME: Every purge scans the whole Environment, store and GDM to find
+  // the live symbols. Tracking liveness incrementally, with reference counts
+  // or generation marks on symbols, would need every update of these
+  // immutable maps to maintain the marks, and the maps are shared between
+  // exploded nodes on different paths. Until then, -analyzer-purge=block is
+  // the way to purge less often.
   const StackFrameContext *SFC = LC ? LC->getStackFrame() : nullptr;
   SymbolReaper SymReaper(SFC, ReferenceStmt, SymMgr, getStoreManager());
 
@@ -37,6 +37,9 @@ STATISTIC(NumInlinedCalls,
 STATISTIC(NumReachedInlineCountMax,
   "The # of times we reached inline count maximum");
 
+STATISTIC(NumNotInlinedForTimeBudget,
+  "The # of times we did not inline a call to stay within the time budget");
+
 void ExprEngine::processCallEnter(NodeBuilderContext& BC, CallEnter CE,
                                   ExplodedNode *Pred) {
   // Get the entry block in the CFG of the callee.
@@ -909,6 +912,14 @@ bool ExprEngine::shouldInlineCall(const CallEvent &Call, const Decl *D,
   if (!AMgr.shouldInlineCall())
     return false;
 
+  // Stop inlining once the time budget has run out, and evaluate the remaining
+  // calls conservatively.
+  double BudgetUsage = AMgr.getTimeBudgetUsage();
+  if (BudgetUsage >= 1.0) {
+    NumNotInlinedForTimeBudget++;
+    return false;
+  }
+
   // Check if this function has been marked as non-inlinable.
   Optional<bool> MayInline = Engine.FunctionSummaries->mayInline(D);
   if (MayInline.hasValue()) {
@@ -964,6 +975,19 @@ bool ExprEngine::shouldInlineCall(const CallEvent &Call, const Decl *D,
       || IsRecursive))
     return false;
 
+  // Past half of the time budget, lower the bound on the size of inlined
+  // functions gradually, down to the size of the ones always inlined.
+  if (BudgetUsage > 0.5) {
+    unsigned MinSize = Opts.getAlwaysInlineSize();
+    unsigned MaxSize = std::max(Opts.getMaxInlinableSize(), MinSize);
+    unsigned SizeBound =
+        MinSize + (MaxSize - MinSize) * (1.0 - BudgetUsage) * 2;
+    if (CalleeCFG->getNumBlockIDs() > SizeBound) {
+      NumNotInlinedForTimeBudget++;
+      return false;
+    }
+  }
+
   return true;
 }
 
@@ -994,6 +1018,17 @@ void ExprEngine::defaultEvalCall(NodeBuilder &Bldr, ExplodedNode *Pred,
     return;
   }
 
+  // A function that no path was found to return from ends the path.
+  if (const Decl *D = Call->getDecl()) {
+    if (Engine.FunctionSummaries->neverReturns(D->getCanonicalDecl())) {
+      static SimpleProgramPointTag Tag("ExprEngine",
+                                       "Call to a function that never returns");
+      Bldr.generateSink(Call->getProgramPoint(/*IsPreVisit=*/false, &Tag),
+                        State, Pred);
+      return;
+    }
+  }
+
   // Try to inline the call.
   // The origin expression here is just used as a kind of checksum;
   // this should still be safe even for CallEvents that don't come from exprs.
@@ -1010,14 +1045,17 @@ void ExprEngine::defaultEvalCall(NodeBuilder &Bldr, ExplodedNode *Pred,
       if (RD.mayHaveOtherDefinitions()) {
         AnalyzerOptions &Options = getAnalysisManager().options;
 
-        // Explore with and without inlining the call.
-        if (Options.getIPAMode() == IPAK_DynamicDispatchBifurcate) {
+        // Explore with and without inlining the call, unless more than half
+        // of the time budget has been used.
+        if (Options.getIPAMode() == IPAK_DynamicDispatchBifurcate &&
+            getAnalysisManager().getTimeBudgetUsage() <= 0.5) {
           BifurcateCall(RD.getDispatchRegion(), *Call, D, Bldr, Pred);
           return;
         }
 
         // Don't inline if we're not in any dynamic dispatch mode.
-        if (Options.getIPAMode() != IPAK_DynamicDispatch) {
+        if (Options.getIPAMode() != IPAK_DynamicDispatch &&
+            Options.getIPAMode() != IPAK_DynamicDispatchBifurcate) {
           conservativeEvalCall(*Call, Bldr, Pred, State);
           return;
         }
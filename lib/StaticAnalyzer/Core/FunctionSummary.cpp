@@ -12,6 +12,11 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/StaticAnalyzer/Core/PathSensitive/FunctionSummary.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/LineIterator.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
 
 using namespace clang;
 using namespace ento;
@@ -29,3 +34,79 @@ unsigned FunctionSummariesTy::getTotalNumVisitedBasicBlocks() {
     Total += I.second.VisitedBasicBlocks.count();
   return Total;
 }
+
+// The summary file starts with a header line holding the configuration hash,
+// followed by one line per function:
+//   <hash> <flags> <lookup name>
+// The hashes are written in hexadecimal. The name comes last, because it may
+// contain spaces.
+static const char SummaryFileHeader[] = "clang-analyzer-function-summaries";
+
+enum SummaryFlags : unsigned { SF_NeverReturns = 1 };
+
+bool PersistentFunctionSummaries::load(StringRef Path) {
+  auto BufferOrErr = llvm::MemoryBuffer::getFile(Path);
+  if (!BufferOrErr)
+    return BufferOrErr.getError() == std::errc::no_such_file_or_directory;
+
+  llvm::StringMap<Summary> Loaded;
+  llvm::line_iterator Line(**BufferOrErr, /*SkipBlanks=*/true);
+  StringRef Header, Config;
+  if (Line.is_at_eof())
+    return false;
+  std::tie(Header, Config) = Line->split(' ');
+  uint64_t FileConfigHash;
+  if (Header != SummaryFileHeader || Config.getAsInteger(16, FileConfigHash))
+    return false;
+  if (FileConfigHash != ConfigHash)
+    return false;
+
+  for (++Line; !Line.is_at_eof(); ++Line) {
+    StringRef HashStr, Rest, FlagsStr, Name;
+    std::tie(HashStr, Rest) = Line->split(' ');
+    std::tie(FlagsStr, Name) = Rest.split(' ');
+    Summary S;
+    unsigned Flags;
+    if (Name.empty() || HashStr.getAsInteger(16, S.Hash) ||
+        FlagsStr.getAsInteger(10, Flags))
+      return false;
+    S.NeverReturns = Flags & SF_NeverReturns;
+    Loaded[Name] = S;
+  }
+
+  Summaries = std::move(Loaded);
+  return true;
+}
+
+bool PersistentFunctionSummaries::save(StringRef Path) const {
+  // Write to a temporary file first, so that an invocation that reads the
+  // summaries at the same time never sees a partial file.
+  int FD;
+  SmallString<128> TempPath;
+  if (llvm::sys::fs::createUniqueFile(Path + ".tmp-%%%%%%", FD, TempPath))
+    return false;
+
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS << SummaryFileHeader << ' ';
+    OS.write_hex(ConfigHash);
+    OS << '\n';
+    for (const auto &I : Summaries) {
+      OS.write_hex(I.second.Hash);
+      OS << ' ' << (I.second.NeverReturns ? SF_NeverReturns : 0) << ' '
+         << I.getKey() << '\n';
+    }
+    OS.close();
+    if (OS.has_error()) {
+      OS.clear_error();
+      llvm::sys::fs::remove(TempPath);
+      return false;
+    }
+  }
+
+  if (llvm::sys::fs::rename(TempPath, Path)) {
+    llvm::sys::fs::remove(TempPath);
+    return false;
+  }
+  return true;
+}
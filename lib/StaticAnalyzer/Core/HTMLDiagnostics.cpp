@@ -65,6 +65,11 @@ class HTMLDiagnostics : public PathDiagnosticConsumer {
   const Preprocessor &PP;
   AnalyzerOptions &AnalyzerOpts;
   const bool SupportsCrossFileDiagnostics;
+  /// The syntax and macro highlighting of the files that reports have been
+  /// generated for, so that many reports in one file highlight it once.
+  html::RelexRewriteCacheRef RewriterCache;
+  /// Shared by the issue hashes of all the reports.
+  IssueHashCache HashCache;
 
 public:
   HTMLDiagnostics(AnalyzerOptions &AnalyzerOpts,
@@ -72,7 +77,8 @@ public:
                   const Preprocessor &pp,
                   bool supportsMultipleFiles)
       : Directory(prefix), PP(pp), AnalyzerOpts(AnalyzerOpts),
-        SupportsCrossFileDiagnostics(supportsMultipleFiles) {}
+        SupportsCrossFileDiagnostics(supportsMultipleFiles),
+        RewriterCache(html::instantiateRelexRewriteCache()) {}
 
   ~HTMLDiagnostics() override { FlushDiagnostics(nullptr); }
 
@@ -556,7 +562,7 @@ void HTMLDiagnostics::FinalizeHTML(const PathDiagnostic& D, Rewriter &R,
 
     os << "\n<!-- ISSUEHASHCONTENTOFLINEINCONTEXT "
        << GetIssueHash(SMgr, L, D.getCheckName(), D.getBugType(), DeclWithIssue,
-                       PP.getLangOpts()) << " -->\n";
+                       PP.getLangOpts(), &HashCache) << " -->\n";
 
     os << "\n<!-- BUGLINE "
        << LineNumber
@@ -643,8 +649,8 @@ void HTMLDiagnostics::RewriteFile(Rewriter &R,
   // We might not have a preprocessor if we come from a deserialized AST file,
   // for example.
 
-  html::SyntaxHighlight(R, FID, PP);
-  html::HighlightMacros(R, FID, PP);
+  html::SyntaxHighlight(R, FID, PP, RewriterCache);
+  html::HighlightMacros(R, FID, PP, RewriterCache);
 }
 
 void HTMLDiagnostics::HandlePiece(Rewriter& R, FileID BugFileID,
@@ -16,7 +16,6 @@
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Twine.h"
-#include "llvm/Support/LineIterator.h"
 #include "llvm/Support/MD5.h"
 #include "llvm/Support/Path.h"
 
@@ -121,22 +120,27 @@ static std::string GetEnclosingDeclContextSignature(const Decl *D) {
   return "";
 }
 
-static StringRef GetNthLineOfFile(llvm::MemoryBuffer *Buffer, int Line) {
-  if (!Buffer)
+static StringRef GetNthLineOfFile(const SourceManager &SM, FileID FID,
+                                  unsigned Line) {
+  bool Invalid = false;
+  StringRef Buffer = SM.getBufferData(FID, &Invalid);
+  if (Invalid)
     return "";
 
-  llvm::line_iterator LI(*Buffer, false);
-  for (; !LI.is_at_eof() && LI.line_number() != Line; ++LI)
-    ;
-
-  return *LI;
+  // Use the line table of the file rather than scanning it from the start.
+  SourceLocation LineStart = SM.translateLineCol(FID, Line, 1);
+  StringRef Str = Buffer.substr(SM.getFileOffset(LineStart));
+  Str = Str.substr(0, Str.find('\n'));
+  if (Str.endswith("\r"))
+    Str = Str.drop_back();
+  return Str;
 }
 
 static std::string NormalizeLine(const SourceManager &SM, FullSourceLoc &L,
                                  const LangOptions &LangOpts) {
   static StringRef Whitespaces = " \t\n";
 
-  StringRef Str = GetNthLineOfFile(SM.getBuffer(L.getFileID(), L),
+  StringRef Str = GetNthLineOfFile(SM, L.getFileID(),
                                    L.getExpansionLineNumber());
   StringRef::size_type col = Str.find_first_not_of(Whitespaces);
   if (col == StringRef::npos)
@@ -184,13 +188,30 @@ std::string clang::GetIssueString(const SourceManager &SM,
                                   FullSourceLoc &IssueLoc,
                                   StringRef CheckerName, StringRef BugType,
                                   const Decl *D,
-                                  const LangOptions &LangOpts) {
+                                  const LangOptions &LangOpts,
+                                  IssueHashCache *Cache) {
   static StringRef Delimiter = "$";
 
-  return (llvm::Twine(CheckerName) + Delimiter +
-          GetEnclosingDeclContextSignature(D) + Delimiter +
-          Twine(IssueLoc.getExpansionColumnNumber()) + Delimiter +
-          NormalizeLine(SM, IssueLoc, LangOpts) + Delimiter + BugType)
+  if (!Cache)
+    return (llvm::Twine(CheckerName) + Delimiter +
+            GetEnclosingDeclContextSignature(D) + Delimiter +
+            Twine(IssueLoc.getExpansionColumnNumber()) + Delimiter +
+            NormalizeLine(SM, IssueLoc, LangOpts) + Delimiter + BugType)
+        .str();
+
+  auto Sig = Cache->DeclSignatures.insert({D, std::string()});
+  if (Sig.second)
+    Sig.first->second = GetEnclosingDeclContextSignature(D);
+
+  auto Line = Cache->NormalizedLines.insert(
+      {{IssueLoc.getFileID(), IssueLoc.getExpansionLineNumber()},
+       std::string()});
+  if (Line.second)
+    Line.first->second = NormalizeLine(SM, IssueLoc, LangOpts);
+
+  return (llvm::Twine(CheckerName) + Delimiter + Sig.first->second +
+          Delimiter + Twine(IssueLoc.getExpansionColumnNumber()) + Delimiter +
+          Line.first->second + Delimiter + BugType)
       .str();
 }
 
@@ -198,8 +219,9 @@ SmallString<32> clang::GetIssueHash(const SourceManager &SM,
                                     FullSourceLoc &IssueLoc,
                                     StringRef CheckerName, StringRef BugType,
                                     const Decl *D,
-                                    const LangOptions &LangOpts) {
+                                    const LangOptions &LangOpts,
+                                    IssueHashCache *Cache) {
 
-  return GetHashOfContent(
-      GetIssueString(SM, IssueLoc, CheckerName, BugType, D, LangOpts));
+  return GetHashOfContent(GetIssueString(SM, IssueLoc, CheckerName, BugType,
+                                         D, LangOpts, Cache));
 }
@@ -280,6 +280,12 @@ void PathDiagnosticConsumer::HandlePathDiagnostic(
   // Profile the node to see if we already have something matching it
   llvm::FoldingSetNodeID profile;
   D->Profile(profile);
+
+  if (isStreaming()) {
+    if (StreamedProfiles.insert(profile.Intern(StreamedProfileAlloc)).second)
+      StreamDiagnostic(*D);
+    return;
+  }
   void *InsertPos = nullptr;
 
   if (PathDiagnostic *orig = Diags.FindNodeOrInsertPos(profile, InsertPos)) {
@@ -41,6 +41,27 @@ namespace {
     const Preprocessor &PP;
     AnalyzerOptions &AnOpts;
     const bool SupportsCrossFileDiagnostics;
+    const bool Streaming;
+
+    /// The state of the output file while diagnostics are streamed into it.
+    std::unique_ptr<llvm::raw_fd_ostream> StreamOS;
+    bool StreamFailed = false;
+    FIDMap StreamFM;
+    SmallVector<FileID, 10> StreamFids;
+
+    /// Shared by the issue hashes of all the diagnostics.
+    IssueHashCache HashCache;
+
+    /// Open the output file and write the start of the root object, or
+    /// return null after warning that the file could not be created.
+    std::unique_ptr<llvm::raw_fd_ostream> openOutputFile();
+
+    void printDiagnostic(llvm::raw_fd_ostream &o, const PathDiagnostic &D,
+                         SmallVectorImpl<FileID> &Fids, FIDMap &FM,
+                         FilesMade *filesMade);
+
+    /// Close the root object, writing the file table of \p Fids.
+    void printTrailer(llvm::raw_fd_ostream &o, ArrayRef<FileID> Fids);
   public:
     PlistDiagnostics(AnalyzerOptions &AnalyzerOpts,
                      const std::string& prefix,
@@ -52,6 +73,10 @@ namespace {
     void FlushDiagnosticsImpl(std::vector<const PathDiagnostic *> &Diags,
                               FilesMade *filesMade) override;
 
+    bool isStreaming() const override { return Streaming; }
+
+    void StreamDiagnostic(const PathDiagnostic &D) override;
+
     StringRef getName() const override {
       return "PlistDiagnostics";
     }
@@ -489,7 +514,8 @@ PlistDiagnostics::PlistDiagnostics(AnalyzerOptions &AnalyzerOpts,
                                    const Preprocessor &PP,
                                    bool supportsMultipleFiles)
   : OutputFile(output), PP(PP), AnOpts(AnalyzerOpts),
-    SupportsCrossFileDiagnostics(supportsMultipleFiles) {}
+    SupportsCrossFileDiagnostics(supportsMultipleFiles),
+    Streaming(AnalyzerOpts.shouldStreamDiagnostics()) {}
 
 void ento::createPlistDiagnosticConsumer(AnalyzerOptions &AnalyzerOpts,
                                          PathDiagnosticConsumers &C,
@@ -506,16 +532,10 @@ void ento::createPlistMultiFileDiagnosticConsumer(AnalyzerOptions &AnalyzerOpts,
   C.push_back(new PlistDiagnostics(AnalyzerOpts, s, PP,
                                    /*supportsMultipleFiles*/ true));
 }
-void PlistDiagnostics::FlushDiagnosticsImpl(
-                                    std::vector<const PathDiagnostic *> &Diags,
-                                    FilesMade *filesMade) {
-  // Build up a set of FIDs that we use by scanning the locations and
-  // ranges of the diagnostics.
-  FIDMap FM;
-  SmallVector<FileID, 10> Fids;
-  const SourceManager& SM = PP.getSourceManager();
-  const LangOptions &LangOpts = PP.getLangOpts();
-
+/// Add the files that the locations and ranges of \p D refer to to \p FM.
+static void addDiagnosticFIDs(const PathDiagnostic &D, FIDMap &FM,
+                              SmallVectorImpl<FileID> &Fids,
+                              const SourceManager &SM) {
   auto AddPieceFID = [&FM, &Fids, &SM](const PathDiagnosticPiece &Piece) {
     AddFID(FM, Fids, SM, Piece.getLocation().asLocation());
     ArrayRef<SourceRange> Ranges = Piece.getRanges();
@@ -525,176 +545,184 @@ void PlistDiagnostics::FlushDiagnosticsImpl(
     }
   };
 
-  for (const PathDiagnostic *D : Diags) {
+  SmallVector<const PathPieces *, 5> WorkList;
+  WorkList.push_back(&D.path);
 
-    SmallVector<const PathPieces *, 5> WorkList;
-    WorkList.push_back(&D->path);
+  while (!WorkList.empty()) {
+    const PathPieces &Path = *WorkList.pop_back_val();
 
-    while (!WorkList.empty()) {
-      const PathPieces &Path = *WorkList.pop_back_val();
+    for (const auto &Iter : Path) {
+      const PathDiagnosticPiece &Piece = *Iter;
+      AddPieceFID(Piece);
 
-      for (const auto &Iter : Path) {
-        const PathDiagnosticPiece &Piece = *Iter;
-        AddPieceFID(Piece);
+      if (const PathDiagnosticCallPiece *Call =
+              dyn_cast<PathDiagnosticCallPiece>(&Piece)) {
+        if (auto CallEnterWithin = Call->getCallEnterWithinCallerEvent())
+          AddPieceFID(*CallEnterWithin);
 
-        if (const PathDiagnosticCallPiece *Call =
-                dyn_cast<PathDiagnosticCallPiece>(&Piece)) {
-          if (auto CallEnterWithin = Call->getCallEnterWithinCallerEvent())
-            AddPieceFID(*CallEnterWithin);
+        if (auto CallEnterEvent = Call->getCallEnterEvent())
+          AddPieceFID(*CallEnterEvent);
 
-          if (auto CallEnterEvent = Call->getCallEnterEvent())
-            AddPieceFID(*CallEnterEvent);
-
-          WorkList.push_back(&Call->path);
-        } else if (const PathDiagnosticMacroPiece *Macro =
-                       dyn_cast<PathDiagnosticMacroPiece>(&Piece)) {
-          WorkList.push_back(&Macro->subPieces);
-        }
+        WorkList.push_back(&Call->path);
+      } else if (const PathDiagnosticMacroPiece *Macro =
+                     dyn_cast<PathDiagnosticMacroPiece>(&Piece)) {
+        WorkList.push_back(&Macro->subPieces);
       }
     }
   }
+}
 
-  // Open the file.
+std::unique_ptr<llvm::raw_fd_ostream> PlistDiagnostics::openOutputFile() {
   std::error_code EC;
-  llvm::raw_fd_ostream o(OutputFile, EC, llvm::sys::fs::F_Text);
+  auto o = llvm::make_unique<llvm::raw_fd_ostream>(OutputFile, EC,
+                                                   llvm::sys::fs::F_Text);
   if (EC) {
     llvm::errs() << "warning: could not create file: " << EC.message() << '\n';
-    return;
+    return nullptr;
   }
 
-  EmitPlistHeader(o);
+  EmitPlistHeader(*o);
 
   // Write the root object: a <dict> containing...
   //  - "clang_version", the string representation of clang version
   //  - "files", an <array> mapping from FIDs to file names
   //  - "diagnostics", an <array> containing the path diagnostics
-  o << "<dict>\n" <<
-       " <key>clang_version</key>\n";
-  EmitString(o, getClangFullVersion()) << '\n';
-  o << " <key>diagnostics</key>\n"
-       " <array>\n";
+  *o << "<dict>\n" <<
+        " <key>clang_version</key>\n";
+  EmitString(*o, getClangFullVersion()) << '\n';
+  *o << " <key>diagnostics</key>\n"
+        " <array>\n";
+  return o;
+}
 
-  for (std::vector<const PathDiagnostic*>::iterator DI=Diags.begin(),
-       DE = Diags.end(); DI!=DE; ++DI) {
-
-    o << "  <dict>\n";
-
-    const PathDiagnostic *D = *DI;
-    printBugPath(o, FM, AnOpts, PP, D->path);
-
-    // Output the bug type and bug category.
-    o << "   <key>description</key>";
-    EmitString(o, D->getShortDescription()) << '\n';
-    o << "   <key>category</key>";
-    EmitString(o, D->getCategory()) << '\n';
-    o << "   <key>type</key>";
-    EmitString(o, D->getBugType()) << '\n';
-    o << "   <key>check_name</key>";
-    EmitString(o, D->getCheckName()) << '\n';
-
-    o << "   <!-- This hash is experimental and going to change! -->\n";
-    o << "   <key>issue_hash_content_of_line_in_context</key>";
-    PathDiagnosticLocation UPDLoc = D->getUniqueingLoc();
-    FullSourceLoc L(SM.getExpansionLoc(UPDLoc.isValid()
-                                            ? UPDLoc.asLocation()
-                                            : D->getLocation().asLocation()),
-                    SM);
-    const Decl *DeclWithIssue = D->getDeclWithIssue();
-    EmitString(o, GetIssueHash(SM, L, D->getCheckName(), D->getBugType(),
-                               DeclWithIssue, LangOpts))
-        << '\n';
-
-    // Output information about the semantic context where
-    // the issue occurred.
-    if (const Decl *DeclWithIssue = D->getDeclWithIssue()) {
-      // FIXME: handle blocks, which have no name.
-      if (const NamedDecl *ND = dyn_cast<NamedDecl>(DeclWithIssue)) {
-        StringRef declKind;
-        switch (ND->getKind()) {
-          case Decl::CXXRecord:
-            declKind = "C++ class";
-            break;
-          case Decl::CXXMethod:
-            declKind = "C++ method";
-            break;
-          case Decl::ObjCMethod:
-            declKind = "Objective-C method";
-            break;
-          case Decl::Function:
-            declKind = "function";
-            break;
-          default:
-            break;
-        }
-        if (!declKind.empty()) {
-          const std::string &declName = ND->getDeclName().getAsString();
-          o << "  <key>issue_context_kind</key>";
-          EmitString(o, declKind) << '\n';
-          o << "  <key>issue_context</key>";
-          EmitString(o, declName) << '\n';
-        }
+void PlistDiagnostics::printDiagnostic(llvm::raw_fd_ostream &o,
+                                       const PathDiagnostic &D,
+                                       SmallVectorImpl<FileID> &Fids,
+                                       FIDMap &FM, FilesMade *filesMade) {
+  const SourceManager& SM = PP.getSourceManager();
+  const LangOptions &LangOpts = PP.getLangOpts();
 
-        // Output the bug hash for issue unique-ing. Currently, it's just an
-        // offset from the beginning of the function.
-        if (const Stmt *Body = DeclWithIssue->getBody()) {
-
-          // If the bug uniqueing location exists, use it for the hash.
-          // For example, this ensures that two leaks reported on the same line
-          // will have different issue_hashes and that the hash will identify
-          // the leak location even after code is added between the allocation
-          // site and the end of scope (leak report location).
-          if (UPDLoc.isValid()) {
-            FullSourceLoc UFunL(
-                SM.getExpansionLoc(
-                    D->getUniqueingDecl()->getBody()->getBeginLoc()),
-                SM);
-            o << "  <key>issue_hash_function_offset</key><string>"
-              << L.getExpansionLineNumber() - UFunL.getExpansionLineNumber()
-              << "</string>\n";
-
-          // Otherwise, use the location on which the bug is reported.
-          } else {
-            FullSourceLoc FunL(SM.getExpansionLoc(Body->getBeginLoc()), SM);
-            o << "  <key>issue_hash_function_offset</key><string>"
-              << L.getExpansionLineNumber() - FunL.getExpansionLineNumber()
-              << "</string>\n";
-          }
+  o << "  <dict>\n";
+
+  printBugPath(o, FM, AnOpts, PP, D.path);
+
+  // Output the bug type and bug category.
+  o << "   <key>description</key>";
+  EmitString(o, D.getShortDescription()) << '\n';
+  o << "   <key>category</key>";
+  EmitString(o, D.getCategory()) << '\n';
+  o << "   <key>type</key>";
+  EmitString(o, D.getBugType()) << '\n';
+  o << "   <key>check_name</key>";
+  EmitString(o, D.getCheckName()) << '\n';
+
+  o << "   <!-- This hash is experimental and going to change! -->\n";
+  o << "   <key>issue_hash_content_of_line_in_context</key>";
+  PathDiagnosticLocation UPDLoc = D.getUniqueingLoc();
+  FullSourceLoc L(SM.getExpansionLoc(UPDLoc.isValid()
+                                          ? UPDLoc.asLocation()
+                                          : D.getLocation().asLocation()),
+                  SM);
+  const Decl *DeclWithIssue = D.getDeclWithIssue();
+  EmitString(o, GetIssueHash(SM, L, D.getCheckName(), D.getBugType(),
+                             DeclWithIssue, LangOpts, &HashCache))
+      << '\n';
+
+  // Output information about the semantic context where
+  // the issue occurred.
+  if (const Decl *DeclWithIssue = D.getDeclWithIssue()) {
+    // FIXME: handle blocks, which have no name.
+    if (const NamedDecl *ND = dyn_cast<NamedDecl>(DeclWithIssue)) {
+      StringRef declKind;
+      switch (ND->getKind()) {
+        case Decl::CXXRecord:
+          declKind = "C++ class";
+          break;
+        case Decl::CXXMethod:
+          declKind = "C++ method";
+          break;
+        case Decl::ObjCMethod:
+          declKind = "Objective-C method";
+          break;
+        case Decl::Function:
+          declKind = "function";
+          break;
+        default:
+          break;
+      }
+      if (!declKind.empty()) {
+        const std::string &declName = ND->getDeclName().getAsString();
+        o << "  <key>issue_context_kind</key>";
+        EmitString(o, declKind) << '\n';
+        o << "  <key>issue_context</key>";
+        EmitString(o, declName) << '\n';
+      }
 
+      // Output the bug hash for issue unique-ing. Currently, it's just an
+      // offset from the beginning of the function.
+      if (const Stmt *Body = DeclWithIssue->getBody()) {
+
+        // If the bug uniqueing location exists, use it for the hash.
+        // For example, this ensures that two leaks reported on the same line
+        // will have different issue_hashes and that the hash will identify
+        // the leak location even after code is added between the allocation
+        // site and the end of scope (leak report location).
+        if (UPDLoc.isValid()) {
+          FullSourceLoc UFunL(
+              SM.getExpansionLoc(
+                  D.getUniqueingDecl()->getBody()->getBeginLoc()),
+              SM);
+          o << "  <key>issue_hash_function_offset</key><string>"
+            << L.getExpansionLineNumber() - UFunL.getExpansionLineNumber()
+            << "</string>\n";
+
+        // Otherwise, use the location on which the bug is reported.
+        } else {
+          FullSourceLoc FunL(SM.getExpansionLoc(Body->getBeginLoc()), SM);
+          o << "  <key>issue_hash_function_offset</key><string>"
+            << L.getExpansionLineNumber() - FunL.getExpansionLineNumber()
+            << "</string>\n";
         }
+
       }
     }
+  }
 
-    // Output the location of the bug.
-    o << "  <key>location</key>\n";
-    EmitLocation(o, SM, D->getLocation().asLocation(), FM, 2);
-
-    // Output the diagnostic to the sub-diagnostic client, if any.
-    if (!filesMade->empty()) {
-      StringRef lastName;
-      PDFileEntry::ConsumerFiles *files = filesMade->getFiles(*D);
-      if (files) {
-        for (PDFileEntry::ConsumerFiles::const_iterator CI = files->begin(),
-                CE = files->end(); CI != CE; ++CI) {
-          StringRef newName = CI->first;
-          if (newName != lastName) {
-            if (!lastName.empty()) {
-              o << "  </array>\n";
-            }
-            lastName = newName;
-            o <<  "  <key>" << lastName << "_files</key>\n";
-            o << "  <array>\n";
+  // Output the location of the bug.
+  o << "  <key>location</key>\n";
+  EmitLocation(o, SM, D.getLocation().asLocation(), FM, 2);
+
+  // Output the diagnostic to the sub-diagnostic client, if any.
+  if (filesMade && !filesMade->empty()) {
+    StringRef lastName;
+    PDFileEntry::ConsumerFiles *files = filesMade->getFiles(D);
+    if (files) {
+      for (PDFileEntry::ConsumerFiles::const_iterator CI = files->begin(),
+              CE = files->end(); CI != CE; ++CI) {
+        StringRef newName = CI->first;
+        if (newName != lastName) {
+          if (!lastName.empty()) {
+            o << "  </array>\n";
           }
-          o << "   <string>" << CI->second << "</string>\n";
+          lastName = newName;
+          o <<  "  <key>" << lastName << "_files</key>\n";
+          o << "  <array>\n";
         }
-        o << "  </array>\n";
+        o << "   <string>" << CI->second << "</string>\n";
       }
+      o << "  </array>\n";
     }
+  }
 
-    printCoverage(D, /*IndentLevel=*/2, Fids, FM, o);
+  printCoverage(&D, /*IndentLevel=*/2, Fids, FM, o);
 
-    // Close up the entry.
-    o << "  </dict>\n";
-  }
+  // Close up the entry.
+  o << "  </dict>\n";
+}
+
+void PlistDiagnostics::printTrailer(llvm::raw_fd_ostream &o,
+                                    ArrayRef<FileID> Fids) {
+  const SourceManager& SM = PP.getSourceManager();
 
   o << " </array>\n";
 
@@ -717,6 +745,55 @@ void PlistDiagnostics::FlushDiagnosticsImpl(
   o << "</dict>\n</plist>";
 }
 
+void PlistDiagnostics::StreamDiagnostic(const PathDiagnostic &D) {
+  if (StreamFailed)
+    return;
+  if (!StreamOS) {
+    StreamOS = openOutputFile();
+    if (!StreamOS) {
+      StreamFailed = true;
+      return;
+    }
+  }
+
+  // The files of earlier diagnostics keep their indices, so the file table
+  // can be written once all the diagnostics are.
+  addDiagnosticFIDs(D, StreamFM, StreamFids, PP.getSourceManager());
+  printDiagnostic(*StreamOS, D, StreamFids, StreamFM, /*filesMade=*/nullptr);
+}
+
+void PlistDiagnostics::FlushDiagnosticsImpl(
+                                    std::vector<const PathDiagnostic *> &Diags,
+                                    FilesMade *filesMade) {
+  if (isStreaming()) {
+    assert(Diags.empty() && "Streamed diagnostics are not kept");
+    if (StreamFailed)
+      return;
+    if (!StreamOS)
+      StreamOS = openOutputFile();
+    if (StreamOS)
+      printTrailer(*StreamOS, StreamFids);
+    StreamOS.reset();
+    return;
+  }
+
+  // Build up a set of FIDs that we use by scanning the locations and
+  // ranges of the diagnostics.
+  FIDMap FM;
+  SmallVector<FileID, 10> Fids;
+  for (const PathDiagnostic *D : Diags)
+    addDiagnosticFIDs(*D, FM, Fids, PP.getSourceManager());
+
+  std::unique_ptr<llvm::raw_fd_ostream> o = openOutputFile();
+  if (!o)
+    return;
+
+  for (const PathDiagnostic *D : Diags)
+    printDiagnostic(*o, *D, Fids, FM, filesMade);
+
+  printTrailer(*o, Fids);
+}
+
 //===----------------------------------------------------------------------===//
 // Declarations of helper functions and data structures for expanding macros.
 //===----------------------------------------------------------------------===//
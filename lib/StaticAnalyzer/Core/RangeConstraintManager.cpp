@@ -17,16 +17,52 @@
 #include "clang/StaticAnalyzer/Core/PathSensitive/ProgramStateTrait.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/RangedConstraintManager.h"
 #include "llvm/ADT/FoldingSet.h"
-#include "llvm/ADT/ImmutableSet.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <iterator>
+#include <memory>
 
 using namespace clang;
 using namespace ento;
 
-void RangeSet::IntersectInRange(BasicValueFactory &BV, Factory &F,
-                      const llvm::APSInt &Lower, const llvm::APSInt &Upper,
-                      PrimRangeSet &newRanges, PrimRangeSet::iterator &i,
-                      PrimRangeSet::iterator &e) const {
+RangeSet RangeSet::Factory::getRangeSet(ArrayRef<Range> Ranges) {
+  if (Ranges.empty())
+    return getEmptySet();
+
+  llvm::FoldingSetNodeID ID;
+  ContainerType::Profile(ID, Ranges);
+  void *InsertPos;
+  if (ContainerType *Existing = Sets.FindNodeOrInsertPos(ID, InsertPos))
+    return RangeSet(Existing);
+
+  Range *Storage = Allocator.Allocate<Range>(Ranges.size());
+  std::uninitialized_copy(Ranges.begin(), Ranges.end(), Storage);
+  auto *New = new (Allocator.Allocate<ContainerType>())
+      ContainerType(Storage, Ranges.size());
+  Sets.InsertNode(New, InsertPos);
+  return RangeSet(New);
+}
+
+/// Orders ranges by their values, rather than by the addresses of their
+/// bounds.
+static bool isLess(const Range &LHS, const Range &RHS) {
+  return LHS.From() < RHS.From() ||
+         (!(RHS.From() < LHS.From()) && LHS.To() < RHS.To());
+}
+
+RangeSet RangeSet::addRange(Factory &F, const RangeSet &RS) {
+  SmallVector<Range, 8> Ranges;
+  std::set_union(begin(), end(), RS.begin(), RS.end(),
+                 std::back_inserter(Ranges), isLess);
+  return F.getRangeSet(Ranges);
+}
+
+void RangeSet::IntersectInRange(BasicValueFactory &BV,
+                                const llvm::APSInt &Lower,
+                                const llvm::APSInt &Upper,
+                                SmallVectorImpl<Range> &newRanges,
+                                iterator &i, iterator e) const {
   // There are six cases for each range R in the set:
   //   1. R is entirely before the intersection range.
   //   2. R is entirely after the intersection range.
@@ -34,35 +70,34 @@ void RangeSet::IntersectInRange(BasicValueFactory &BV, Factory &F,
   //   4. R starts before the intersection range and ends in the middle.
   //   5. R starts in the middle of the intersection range and ends after it.
   //   6. R is entirely contained in the intersection range.
-  // These correspond to each of the conditions below.
+  // These correspond to each of the conditions below. The ranges of the
+  // first case are skipped with a binary search.
+  i = std::partition_point(i, e,
+                           [&](const Range &R) { return R.To() < Lower; });
   for (/* i = begin(), e = end() */; i != e; ++i) {
-    if (i->To() < Lower) {
-      continue;
-    }
     if (i->From() > Upper) {
       break;
     }
 
     if (i->Includes(Lower)) {
       if (i->Includes(Upper)) {
-        newRanges =
-            F.add(newRanges, Range(BV.getValue(Lower), BV.getValue(Upper)));
+        newRanges.push_back(Range(BV.getValue(Lower), BV.getValue(Upper)));
         break;
       } else
-        newRanges = F.add(newRanges, Range(BV.getValue(Lower), i->To()));
+        newRanges.push_back(Range(BV.getValue(Lower), i->To()));
     } else {
       if (i->Includes(Upper)) {
-        newRanges = F.add(newRanges, Range(i->From(), BV.getValue(Upper)));
+        newRanges.push_back(Range(i->From(), BV.getValue(Upper)));
         break;
       } else
-        newRanges = F.add(newRanges, *i);
+        newRanges.push_back(*i);
     }
   }
 }
 
 const llvm::APSInt &RangeSet::getMinValue() const {
   assert(!isEmpty());
-  return ranges.begin()->From();
+  return begin()->From();
 }
 
 bool RangeSet::pin(llvm::APSInt &Lower, llvm::APSInt &Upper) const {
@@ -158,52 +193,55 @@ RangeSet RangeSet::Intersect(BasicValueFactory &BV, Factory &F,
   if (!pin(Lower, Upper))
     return F.getEmptySet();
 
-  PrimRangeSet newRanges = F.getEmptySet();
+  SmallVector<Range, 8> newRanges;
 
-  PrimRangeSet::iterator i = begin(), e = end();
+  iterator i = begin(), e = end();
   if (Lower <= Upper)
-    IntersectInRange(BV, F, Lower, Upper, newRanges, i, e);
+    IntersectInRange(BV, Lower, Upper, newRanges, i, e);
   else {
     // The order of the next two statements is important!
     // IntersectInRange() does not reset the iteration state for i and e.
     // Therefore, the lower range most be handled first.
-    IntersectInRange(BV, F, BV.getMinValue(Upper), Upper, newRanges, i, e);
-    IntersectInRange(BV, F, Lower, BV.getMaxValue(Lower), newRanges, i, e);
+    IntersectInRange(BV, BV.getMinValue(Upper), Upper, newRanges, i, e);
+    IntersectInRange(BV, Lower, BV.getMaxValue(Lower), newRanges, i, e);
   }
 
-  return newRanges;
+  return F.getRangeSet(newRanges);
 }
 
 // Turn all [A, B] ranges to [-B, -A]. Ranges [MIN, B] are turned to range set
 // [MIN, MIN] U [-B, MAX], when MIN and MAX are the minimal and the maximal
 // signed values of the type.
 RangeSet RangeSet::Negate(BasicValueFactory &BV, Factory &F) const {
-  PrimRangeSet newRanges = F.getEmptySet();
+  SmallVector<Range, 8> newRanges;
+
+  // The range [MIN, MIN] that a range [MIN, B] turns into, if any. It always
+  // comes from the first range, and is merged with the range [-A, MAX] would
+  // turn into, which always comes from the last one.
+  Optional<unsigned> MinRange;
 
   for (iterator i = begin(), e = end(); i != e; ++i) {
     const llvm::APSInt &from = i->From(), &to = i->To();
     const llvm::APSInt &newTo = (from.isMinSignedValue() ?
                                  BV.getMaxValue(from) :
                                  BV.getValue(- from));
-    if (to.isMaxSignedValue() && !newRanges.isEmpty() &&
-        newRanges.begin()->From().isMinSignedValue()) {
-      assert(newRanges.begin()->To().isMinSignedValue() &&
+    if (to.isMaxSignedValue() && MinRange) {
+      assert(newRanges[*MinRange].To().isMinSignedValue() &&
              "Ranges should not overlap");
       assert(!from.isMinSignedValue() && "Ranges should not overlap");
-      const llvm::APSInt &newFrom = newRanges.begin()->From();
-      newRanges =
-        F.add(F.remove(newRanges, *newRanges.begin()), Range(newFrom, newTo));
+      newRanges[*MinRange] = Range(newRanges[*MinRange].From(), newTo);
     } else if (!to.isMinSignedValue()) {
       const llvm::APSInt &newFrom = BV.getValue(- to);
-      newRanges = F.add(newRanges, Range(newFrom, newTo));
+      newRanges.push_back(Range(newFrom, newTo));
     }
     if (from.isMinSignedValue()) {
-      newRanges = F.add(newRanges, Range(BV.getMinValue(from),
-                                         BV.getMinValue(from)));
+      MinRange = newRanges.size();
+      newRanges.push_back(Range(BV.getMinValue(from), BV.getMinValue(from)));
     }
   }
 
-  return newRanges;
+  llvm::sort(newRanges.begin(), newRanges.end(), isLess);
+  return F.getRangeSet(newRanges);
 }
 
 void RangeSet::print(raw_ostream &os) const {
@@ -326,6 +326,10 @@ private:
                          SValListTy> LazyBindingsMapTy;
   LazyBindingsMapTy LazyBindingsMap;
 
+  typedef llvm::DenseMap<const CompoundValData *,
+                         SValListTy> ChunkElementsMapTy;
+  ChunkElementsMapTy ChunkElementsMap;
+
   /// The largest number of fields a struct can have and still be
   /// considered "small".
   ///
@@ -336,6 +340,17 @@ private:
   /// To disable all small-struct-dependent behavior, set the option to "0".
   unsigned SmallStructLimit;
 
+  /// The smallest number of integer constants in an array initializer that
+  /// are bound to the array as a single chunk.
+  ///
+  /// A chunk is a CompoundVal default-bound to the array. Storing an element
+  /// adds a direct binding over it, so the chunk itself is never modified and
+  /// stays shared by all the states that have it.
+  ///
+  /// This is controlled by 'region-store-min-chunked-array-size' option.
+  /// To disable chunks, set the option to "0".
+  unsigned MinChunkedArraySize;
+
   /// A helper used to populate the work list with the given set of
   /// regions.
   void populateWorkList(InvalidateRegionsWorker &W,
@@ -346,11 +361,12 @@ public:
   RegionStoreManager(ProgramStateManager& mgr, const RegionStoreFeatures &f)
     : StoreManager(mgr), Features(f),
       RBFactory(mgr.getAllocator()), CBFactory(mgr.getAllocator()),
-      SmallStructLimit(0) {
+      SmallStructLimit(0), MinChunkedArraySize(0) {
     if (SubEngine *Eng = StateMgr.getOwningEngine()) {
       AnalyzerOptions &Options = Eng->getAnalysisManager().options;
       SmallStructLimit =
         Options.getRegionStoreSmallStructLimit();
+      MinChunkedArraySize = Options.getRegionStoreMinChunkedArraySize();
     }
   }
 
@@ -573,6 +589,19 @@ public: // Part of public interface to class.
   /// symbols, but may omit constants and other kinds of SVal.
   const SValListTy &getInterestingValues(nonloc::LazyCompoundVal LCV);
 
+  /// Returns true if the array initializer \p CV should be bound to an array
+  /// of \p Size elements of type \p ElementTy as a single chunk.
+  bool shouldBindAsChunk(nonloc::CompoundVal CV, QualType ElementTy,
+                         Optional<uint64_t> Size);
+
+  /// Returns the value of the element \p R of the array \p ArrayR that has the
+  /// chunk \p CV default-bound to it, or None if \p R is out of the bounds of
+  /// the array.
+  Optional<SVal> getBindingForChunkElement(nonloc::CompoundVal CV,
+                                           const TypedValueRegion *ArrayR,
+                                           const TypedValueRegion *R,
+                                           QualType Ty);
+
   //===------------------------------------------------------------------===//
   // State pruning.
   //===------------------------------------------------------------------===//
@@ -1784,6 +1813,12 @@ RegionStoreManager::getBindingForDerivedDefaultValue(RegionBindingsConstRef B,
     if (val.isUnknownOrUndef())
       return val;
 
+    // A compound value bound to an array is a chunk of its elements.
+    if (Optional<nonloc::CompoundVal> CV = val.getAs<nonloc::CompoundVal>())
+      if (const auto *ArrayR = dyn_cast<TypedValueRegion>(superR))
+        if (ArrayR->getValueType()->isArrayType())
+          return getBindingForChunkElement(*CV, ArrayR, R, Ty);
+
     // Lazy bindings are usually handled through getExistingLazyBinding().
     // We should unify these two code paths at some point.
     if (val.getAs<nonloc::LazyCompoundVal>() ||
@@ -1796,6 +1831,57 @@ RegionStoreManager::getBindingForDerivedDefaultValue(RegionBindingsConstRef B,
   return None;
 }
 
+bool RegionStoreManager::shouldBindAsChunk(nonloc::CompoundVal CV,
+                                           QualType ElementTy,
+                                           Optional<uint64_t> Size) {
+  if (!MinChunkedArraySize || !Size ||
+      !ElementTy->isIntegralOrEnumerationType())
+    return false;
+
+  uint64_t NumElements = 0;
+  for (SVal V : CV) {
+    if (!V.getAs<nonloc::ConcreteInt>())
+      return false;
+    ++NumElements;
+  }
+  return NumElements >= MinChunkedArraySize && NumElements <= *Size;
+}
+
+Optional<SVal>
+RegionStoreManager::getBindingForChunkElement(nonloc::CompoundVal CV,
+                                              const TypedValueRegion *ArrayR,
+                                              const TypedValueRegion *R,
+                                              QualType Ty) {
+  // Only the elements themselves can be read from the chunk, not parts of
+  // them or other types placed over them.
+  const auto *ER = dyn_cast<ElementRegion>(R);
+  const ConstantArrayType *CAT = Ctx.getAsConstantArrayType(
+      ArrayR->getValueType());
+  if (!ER || ER->getSuperRegion() != ArrayR || !CAT ||
+      !Ctx.hasSameUnqualifiedType(CAT->getElementType(), ER->getElementType()))
+    return SVal(UnknownVal());
+
+  Optional<nonloc::ConcreteInt> Idx =
+      ER->getIndex().getAs<nonloc::ConcreteInt>();
+  if (!Idx)
+    return SVal(UnknownVal());
+  int64_t I = Idx->getValue().getSExtValue();
+  if (I < 0 || CAT->getSize().ule(I))
+    return None;
+
+  // Index the elements once, as the ImmutableList in the CompoundVal can only
+  // be walked from the front.
+  SValListTy &Elements = ChunkElementsMap[CV.getValue()];
+  if (Elements.empty())
+    for (SVal V : CV)
+      Elements.push_back(V);
+
+  // The elements past the end of the initializer are zero-initialized.
+  if (static_cast<uint64_t>(I) >= Elements.size())
+    return svalBuilder.makeZeroVal(Ty);
+  return Elements[I];
+}
+
 SVal RegionStoreManager::getLazyBinding(const SubRegion *LazyBindingRegion,
                                         RegionBindingsRef LazyBinding) {
   SVal Result;
@@ -2199,6 +2285,11 @@ RegionStoreManager::bindArray(RegionBindingsConstRef B,
 
   // Remaining case: explicit compound values.
   const nonloc::CompoundVal& CV = Init.castAs<nonloc::CompoundVal>();
+
+  // Bind long lists of integer constants, such as the initializers of lookup
+  // tables, as a single chunk instead of one binding per element.
+  if (shouldBindAsChunk(CV, ElementTy, Size))
+    return bindAggregate(B, R, CV);
   nonloc::CompoundVal::iterator VI = CV.begin(), VE = CV.end();
   uint64_t i = 0;
 
@@ -27,15 +27,33 @@ using namespace ento;
 namespace {
 class SarifDiagnostics : public PathDiagnosticConsumer {
   std::string OutputFile;
+  const bool Streaming;
+
+  /// The state of the output file while results are streamed into it. The
+  /// files and rules that the results refer to are written at the end.
+  std::unique_ptr<raw_fd_ostream> StreamOS;
+  bool StreamFailed = false;
+  bool StreamedAnyResult = false;
+  json::Object StreamFiles;
+  json::Object StreamRules;
+  StringSet<> StreamSeenRules;
+
+  /// Open the output file, or return null after warning that it could not
+  /// be created.
+  std::unique_ptr<raw_fd_ostream> openOutputFile();
 
 public:
-  SarifDiagnostics(AnalyzerOptions &, const std::string &Output)
-      : OutputFile(Output) {}
+  SarifDiagnostics(AnalyzerOptions &AnalyzerOpts, const std::string &Output)
+      : OutputFile(Output),
+        Streaming(AnalyzerOpts.shouldStreamDiagnostics()) {}
   ~SarifDiagnostics() override = default;
 
   void FlushDiagnosticsImpl(std::vector<const PathDiagnostic *> &Diags,
                             FilesMade *FM) override;
 
+  bool isStreaming() const override { return Streaming; }
+  void StreamDiagnostic(const PathDiagnostic &D) override;
+
   StringRef getName() const override { return "SarifDiagnostics"; }
   PathGenerationScheme getGenerationScheme() const override { return Minimal; }
   bool supportsLogicalOpControlFlow() const override { return true; }
@@ -251,15 +269,20 @@ static json::Object createRule(const PathDiagnostic &Diag) {
       {"name", createMessage(CheckName)}};
 }
 
+static void addRule(const PathDiagnostic &D, json::Object &Rules,
+                    llvm::StringSet<> &Seen) {
+  StringRef RuleID = D.getCheckName();
+  std::pair<llvm::StringSet<>::iterator, bool> P = Seen.insert(RuleID);
+  if (P.second)
+    Rules[RuleID] = createRule(D);
+}
+
 static json::Object createRules(std::vector<const PathDiagnostic *> &Diags) {
   json::Object Rules;
   llvm::StringSet<> Seen;
 
   llvm::for_each(Diags, [&](const PathDiagnostic *D) {
-    StringRef RuleID = D->getCheckName();
-    std::pair<llvm::StringSet<>::iterator, bool> P = Seen.insert(RuleID);
-    if (P.second)
-      Rules[RuleID] = createRule(*D);
+    addRule(*D, Rules, Seen);
   });
 
   return Rules;
@@ -284,23 +307,86 @@ static json::Object createRun(std::vector<const PathDiagnostic *> &Diags) {
                       {"files", std::move(Files)}};
 }
 
-void SarifDiagnostics::FlushDiagnosticsImpl(
-    std::vector<const PathDiagnostic *> &Diags, FilesMade *) {
+static const char SarifSchema[] =
+    "http://json.schemastore.org/sarif-2.0.0-csd.2.beta.2018-10-10";
+static const char SarifVersion[] = "2.0.0-csd.2.beta.2018-10-10";
+
+/// Write the streamed document up to the results of its run. The members of
+/// each object are written in the order that the non-streaming output sorts
+/// them in, except for "results", which has to come first.
+static void writeStreamPrologue(raw_ostream &OS) {
+  OS << "{\n  \"$schema\": " << json::Value(SarifSchema)
+     << ",\n  \"runs\": [\n    {\n      \"results\": [";
+}
+
+std::unique_ptr<raw_fd_ostream> SarifDiagnostics::openOutputFile() {
   // We currently overwrite the file if it already exists. However, it may be
   // useful to add a feature someday that allows the user to append a run to an
   // existing SARIF file. One danger from that approach is that the size of the
   // file can become large very quickly, so decoding into JSON to append a run
   // may be an expensive operation.
   std::error_code EC;
-  llvm::raw_fd_ostream OS(OutputFile, EC, llvm::sys::fs::F_Text);
+  auto OS = llvm::make_unique<raw_fd_ostream>(OutputFile, EC,
+                                              llvm::sys::fs::F_Text);
   if (EC) {
     llvm::errs() << "warning: could not create file: " << EC.message() << '\n';
+    return nullptr;
+  }
+  return OS;
+}
+
+void SarifDiagnostics::StreamDiagnostic(const PathDiagnostic &D) {
+  if (StreamFailed)
     return;
+  if (!StreamOS) {
+    StreamOS = openOutputFile();
+    if (!StreamOS) {
+      StreamFailed = true;
+      return;
+    }
+    writeStreamPrologue(*StreamOS);
   }
+
+  *StreamOS << (StreamedAnyResult ? ",\n" : "\n")
+            << llvm::formatv("{0:2}",
+                             json::Value(createResult(D, StreamFiles)));
+  StreamedAnyResult = true;
+  addRule(D, StreamRules, StreamSeenRules);
+}
+
+void SarifDiagnostics::FlushDiagnosticsImpl(
+    std::vector<const PathDiagnostic *> &Diags, FilesMade *) {
+  if (isStreaming()) {
+    assert(Diags.empty() && "Streamed diagnostics are not kept");
+    if (StreamFailed)
+      return;
+    if (!StreamOS) {
+      // Nothing was streamed; write a run without results.
+      StreamOS = openOutputFile();
+      if (!StreamOS)
+        return;
+      writeStreamPrologue(*StreamOS);
+    }
+    *StreamOS
+        << "\n      ],\n      \"files\": "
+        << llvm::formatv("{0:2}", json::Value(std::move(StreamFiles)))
+        << ",\n      \"resources\": "
+        << llvm::formatv("{0:2}", json::Value(json::Object{
+                                      {"rules", std::move(StreamRules)}}))
+        << ",\n      \"tool\": "
+        << llvm::formatv("{0:2}", json::Value(createTool()))
+        << "\n    }\n  ],\n  \"version\": " << json::Value(SarifVersion)
+        << "\n}";
+    StreamOS.reset();
+    return;
+  }
+
+  std::unique_ptr<raw_fd_ostream> OS = openOutputFile();
+  if (!OS)
+    return;
   json::Object Sarif{
-      {"$schema",
-       "http://json.schemastore.org/sarif-2.0.0-csd.2.beta.2018-10-10"},
-      {"version", "2.0.0-csd.2.beta.2018-10-10"},
+      {"$schema", SarifSchema},
+      {"version", SarifVersion},
       {"runs", json::Array{createRun(Diags)}}};
-  OS << llvm::formatv("{0:2}", json::Value(std::move(Sarif)));
+  *OS << llvm::formatv("{0:2}", json::Value(std::move(Sarif)));
 }
@@ -14,8 +14,10 @@
 
 #include "clang/StaticAnalyzer/Core/PathSensitive/SimpleConstraintManager.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/APSIntType.h"
+#include "clang/StaticAnalyzer/Core/PathSensitive/AnalysisManager.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ExprEngine.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ProgramState.h"
+#include "llvm/Support/Timer.h"
 
 namespace clang {
 
@@ -23,6 +25,15 @@ namespace ento {
 
 SimpleConstraintManager::~SimpleConstraintManager() {}
 
+/// Returns the timer for the assumptions, unless it is already running for an
+/// assumption that the current one is a part of.
+static llvm::Timer *getAssumptionTimer(SubEngine *SU) {
+  if (!SU)
+    return nullptr;
+  llvm::Timer *T = SU->getAnalysisManager().getConstraintTimer();
+  return T && !T->isRunning() ? T : nullptr;
+}
+
 ProgramStateRef SimpleConstraintManager::assume(ProgramStateRef State,
                                                 DefinedSVal Cond,
                                                 bool Assumption) {
@@ -44,7 +55,10 @@ ProgramStateRef SimpleConstraintManager::assume(ProgramStateRef State,
 
 ProgramStateRef SimpleConstraintManager::assume(ProgramStateRef State,
                                                 NonLoc Cond, bool Assumption) {
-  State = assumeAux(State, Cond, Assumption);
+  {
+    llvm::TimeRegion Timer(getAssumptionTimer(SU));
+    State = assumeAux(State, Cond, Assumption);
+  }
   if (NotifyAssumeClients && SU)
     return SU->processAssume(State, Cond, Assumption);
   return State;
@@ -100,6 +114,8 @@ ProgramStateRef SimpleConstraintManager::assumeInclusiveRange(
          From.getBitWidth() == To.getBitWidth() &&
          "Values should have same types!");
 
+  llvm::TimeRegion Timer(getAssumptionTimer(SU));
+
   if (!canReasonAbout(Value)) {
     // Just add the constraint to the expression without trying to simplify.
     SymbolRef Sym = Value.getAsSymExpr();
@@ -12,12 +12,14 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/StaticAnalyzer/Core/PathSensitive/WorkList.h"
+#include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/PriorityQueue.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/Statistic.h"
 #include <deque>
+#include <tuple>
 #include <vector>
 
 using namespace clang;
@@ -27,6 +29,8 @@ using namespace ento;
 
 STATISTIC(MaxQueueSize, "Maximum size of the worklist");
 STATISTIC(MaxReachableSize, "Maximum size of auxiliary worklist set");
+STATISTIC(NumSimilarStatesDeferred,
+          "The # of nodes deferred because a similar state was seen before");
 
 //===----------------------------------------------------------------------===//
 // Worklist classes for exploration of reachable states.
@@ -312,3 +316,97 @@ public:
 std::unique_ptr<WorkList> WorkList::makeUnexploredFirstPriorityLocationQueue() {
   return llvm::make_unique<UnexploredFirstPriorityLocationQueue>();
 }
+
+namespace {
+/// Prefers the nodes that enter a block no path has entered before, then the
+/// nodes whose path has gone around loops the fewest times, then the nodes at
+/// the locations reached the fewest times.
+///
+/// A node entering a block in the same stack frame and with the same store as
+/// a node that entered it before differs from it only in its constraints and
+/// checker state, and is unlikely to reach code the other one has not. Such
+/// nodes are explored after all the others, so that they only use up the node
+/// budget once nothing else is left.
+class CoverageGuidedQueue : public WorkList {
+  using LocIdentifier = std::pair<unsigned, const StackFrameContext *>;
+
+  enum Tier { SimilarState, Explored, Unexplored };
+
+  // Compare by tier first, then by the number of times the path has entered
+  // the block and the number of times the location was reached (both negated
+  // to prefer smaller ones), then by insertion time (prefer expanding nodes
+  // inserted later first, as in DFS).
+  using QueuePriority = std::tuple<int, int, int, unsigned long>;
+  using QueueItem = std::pair<WorkListUnit, QueuePriority>;
+
+  struct ExplorationComparator {
+    bool operator() (const QueueItem &LHS, const QueueItem &RHS) {
+      return LHS.second < RHS.second;
+    }
+  };
+
+  unsigned long Counter = 0;
+
+  /// The blocks of each CFG entered so far, indexed by block ID.
+  llvm::DenseMap<const CFG *, llvm::BitVector> Covered;
+
+  /// Number of times each location was reached.
+  llvm::DenseMap<LocIdentifier, int> NumReached;
+
+  /// The locations and stores of the block entrances seen so far.
+  llvm::DenseSet<std::pair<LocIdentifier, Store>> SeenStates;
+
+  llvm::PriorityQueue<QueueItem, std::vector<QueueItem>, ExplorationComparator>
+      queue;
+
+public:
+  bool hasWork() const override {
+    return !queue.empty();
+  }
+
+  void enqueue(const WorkListUnit &U) override {
+    const ExplodedNode *N = U.getNode();
+    Tier T = Explored;
+    int NumPathVisits = 0;
+    int NumVisited = 0;
+    if (auto BE = N->getLocation().getAs<BlockEntrance>()) {
+      const CFGBlock *Block = BE->getBlock();
+      const StackFrameContext *SFC = N->getLocationContext()->getStackFrame();
+      unsigned ID = Block->getBlockID();
+      LocIdentifier LocId = std::make_pair(ID, SFC);
+
+      llvm::BitVector &Blocks = Covered[Block->getParent()];
+      if (Blocks.empty())
+        Blocks.resize(Block->getParent()->getNumBlockIDs());
+      bool IsNewBlock = !Blocks.test(ID);
+      Blocks.set(ID);
+      bool IsNewState =
+          SeenStates.insert(std::make_pair(LocId, N->getState()->getStore()))
+              .second;
+      if (IsNewBlock) {
+        T = Unexplored;
+      } else if (!IsNewState) {
+        T = SimilarState;
+        NumSimilarStatesDeferred++;
+      }
+
+      NumPathVisits = U.getBlockCounter().getNumVisited(SFC, ID);
+      NumVisited = NumReached[LocId]++;
+    }
+
+    queue.push(std::make_pair(
+        U, std::make_tuple(T, -NumPathVisits, -NumVisited, ++Counter)));
+    MaxQueueSize.updateMax(queue.size());
+  }
+
+  WorkListUnit dequeue() override {
+    QueueItem U = queue.top();
+    queue.pop();
+    return U.first;
+  }
+};
+} // namespace
+
+std::unique_ptr<WorkList> WorkList::makeCoverageGuidedQueue() {
+  return llvm::make_unique<CoverageGuidedQueue>();
+}
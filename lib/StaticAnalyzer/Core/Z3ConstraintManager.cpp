@@ -36,8 +36,6 @@ public:
     Z3_set_param_value(Config, "model", "true");
     // Disable proof generation
     Z3_set_param_value(Config, "proof", "false");
-    // Set timeout to 15000ms = 15s
-    Z3_set_param_value(Config, "timeout", "15000");
   }
 
   ~Z3Config() { Z3_del_config(Config); }
@@ -865,6 +863,17 @@ public:
   /// Reset the solver and remove all constraints.
   void reset() override { Z3_solver_reset(Context.Context, Solver); }
 
+  void setTimeout(unsigned Milliseconds) override {
+    Z3_params Params = Z3_mk_params(Context.Context);
+    Z3_params_inc_ref(Context.Context, Params);
+    // Z3 treats a timeout of zero as expired, and UINT_MAX as no timeout.
+    Z3_params_set_uint(Context.Context, Params,
+                       Z3_mk_string_symbol(Context.Context, "timeout"),
+                       Milliseconds ? Milliseconds : UINT_MAX);
+    Z3_solver_set_params(Context.Context, Solver, Params);
+    Z3_params_dec_ref(Context.Context, Params);
+  }
+
   void print(raw_ostream &OS) const override {
     OS << Z3_solver_to_string(Context.Context, Solver);
   }
@@ -875,7 +884,11 @@ class Z3ConstraintManager : public SMTConstraintManager<ConstraintZ3, Z3Expr> {
 
 public:
   Z3ConstraintManager(SubEngine *SE, SValBuilder &SB)
-      : SMTConstraintManager(SE, SB, Solver) {}
+      : SMTConstraintManager(SE, SB, Solver) {
+    if (SE)
+      Solver->setTimeout(
+          SE->getAnalysisManager().getAnalyzerOptions().getZ3QueryTimeout());
+  }
 }; // end class Z3ConstraintManager
 
 } // end anonymous namespace
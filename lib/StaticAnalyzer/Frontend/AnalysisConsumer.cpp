@@ -16,12 +16,14 @@
 #include "clang/AST/Decl.h"
 #include "clang/AST/DeclCXX.h"
 #include "clang/AST/DeclObjC.h"
+#include "clang/AST/ODRHash.h"
 #include "clang/AST/RecursiveASTVisitor.h"
 #include "clang/Analysis/Analyses/LiveVariables.h"
 #include "clang/Analysis/CFG.h"
 #include "clang/Analysis/CallGraph.h"
 #include "clang/Analysis/CodeInjector.h"
 #include "clang/Basic/SourceManager.h"
+#include "clang/Basic/Version.h"
 #include "clang/CrossTU/CrossTranslationUnit.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Lex/Preprocessor.h"
@@ -34,13 +36,17 @@
 #include "clang/StaticAnalyzer/Core/PathSensitive/AnalysisManager.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ExprEngine.h"
 #include "clang/StaticAnalyzer/Frontend/CheckerRegistration.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/ADT/SCCIterator.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Program.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 #include <memory>
 #include <queue>
 #include <utility>
@@ -60,6 +66,11 @@ STATISTIC(NumVisitedBlocksInAnalyzedFunctions,
           "The # of visited basic blocks in the analyzed functions.");
 STATISTIC(PercentReachableBlocks, "The % of reachable basic blocks.");
 STATISTIC(MaxCFGSize, "The maximum number of basic blocks in a function.");
+STATISTIC(NumFunctionsOverTimeBudget,
+          "The # of functions that ran out of their time budget.");
+STATISTIC(NumFunctionsUnchanged,
+          "The # of functions not analyzed again because neither they nor "
+          "their callees changed.");
 
 //===----------------------------------------------------------------------===//
 // Special PathDiagnosticConsumers.
@@ -142,6 +153,27 @@ public:
 };
 } // end anonymous namespace
 
+/// Hash the parts of the configuration that may change the results of
+/// analyzing a function, so that persistent function summaries are only
+/// reused by invocations with the same configuration.
+static uint64_t getConfigHash(const AnalyzerOptions &Opts) {
+  std::vector<std::string> Entries;
+  for (const auto &Entry : Opts.Config)
+    if (Entry.getKey() != "function-summary-file")
+      Entries.push_back((Entry.getKey() + "=" + Entry.getValue()).str());
+  llvm::sort(Entries.begin(), Entries.end());
+
+  llvm::hash_code Hash = llvm::hash_combine(
+      getClangFullVersion(), Opts.AnalysisStoreOpt,
+      Opts.AnalysisConstraintsOpt, Opts.InliningMode,
+      Opts.maxBlockVisitOnPath);
+  for (const auto &Checker : Opts.CheckersControlList)
+    Hash = llvm::hash_combine(Hash, Checker.first, Checker.second);
+  for (const std::string &Entry : Entries)
+    Hash = llvm::hash_combine(Hash, Entry);
+  return Hash;
+}
+
 //===----------------------------------------------------------------------===//
 // AnalysisConsumer declaration.
 //===----------------------------------------------------------------------===//
@@ -192,23 +224,47 @@ public:
   /// Time the analyzes time of each translation unit.
   std::unique_ptr<llvm::TimerGroup> AnalyzerTimers;
   std::unique_ptr<llvm::Timer> TUTotalTimer;
+  std::unique_ptr<llvm::Timer> ConstraintTimer;
+  std::unique_ptr<llvm::Timer> CTUImportTimer;
 
   /// The information about analyzed functions shared throughout the
   /// translation unit.
   FunctionSummariesTy FunctionSummaries;
 
+  /// The summaries of functions kept across invocations of the analyzer, if
+  /// a summary file was given.
+  std::unique_ptr<PersistentFunctionSummaries> PersistentSummaries;
+
+  /// Whether the translation unit ran out of its time budget, which is only
+  /// reported once.
+  bool ReportedTUTimeBudget = false;
+
   AnalysisConsumer(CompilerInstance &CI, const std::string &outdir,
                    AnalyzerOptionsRef opts, ArrayRef<std::string> plugins,
                    CodeInjector *injector)
       : RecVisitorMode(0), RecVisitorBR(nullptr), Ctx(nullptr),
         PP(CI.getPreprocessor()), OutDir(outdir), Opts(std::move(opts)),
         Plugins(plugins), Injector(injector), CTU(CI) {
+    // Hash the configuration before any option is looked up, since looking
+    // one up adds its default value to the configuration.
+    uint64_t ConfigHash = getConfigHash(*Opts);
     DigestAnalyzerOptions();
+    CTU.setMaxLoadedASTSize(uint64_t(Opts->getCTUMaxLoadedASTSize()) << 20);
+    CTU.setOnDemandParsing(Opts->getCTUCompilationDatabase(),
+                           Opts->getCTUASTCacheDir());
+    if (!Opts->getFunctionSummaryFile().empty())
+      PersistentSummaries =
+          llvm::make_unique<PersistentFunctionSummaries>(ConfigHash);
     if (Opts->PrintStats || Opts->shouldSerializeStats()) {
       AnalyzerTimers = llvm::make_unique<llvm::TimerGroup>(
           "analyzer", "Analyzer timers");
       TUTotalTimer = llvm::make_unique<llvm::Timer>(
           "time", "Analyzer total time", *AnalyzerTimers);
+      ConstraintTimer = llvm::make_unique<llvm::Timer>(
+          "constraints", "Analyzer constraint manager time", *AnalyzerTimers);
+      CTUImportTimer = llvm::make_unique<llvm::Timer>(
+          "ctu-import", "Analyzer CTU import time", *AnalyzerTimers);
+      CTU.setImportTimer(CTUImportTimer.get());
       llvm::EnableStatistics(/* PrintOnExit= */ false);
     }
   }
@@ -295,10 +351,13 @@ public:
     Ctx = &Context;
     checkerMgr = createCheckerManager(
         *Ctx, *Opts, Plugins, CheckerRegistrationFns, PP.getDiagnostics());
+    if (Opts->getCheckerProfile() != "none")
+      checkerMgr->enableProfiling();
 
     Mgr = llvm::make_unique<AnalysisManager>(
         *Ctx, PP.getDiagnostics(), PathConsumers, CreateStoreMgr,
         CreateConstraintMgr, checkerMgr.get(), *Opts, Injector);
+    Mgr->setConstraintTimer(ConstraintTimer.get());
   }
 
   /// Store the top level decls in the set to be processed later on.
@@ -332,6 +391,10 @@ public:
                               ExprEngine::InliningModes IMode,
                               SetOfConstDecls *VisitedCallees);
 
+  /// Record the persistent summary of \p D, if it has a hash in \p Hashes.
+  void recordPersistentSummary(
+      const Decl *D, const llvm::DenseMap<const Decl *, uint64_t> &Hashes);
+
   /// Visitors for the RecursiveASTVisitor.
   bool shouldWalkTypesOfTypeLocs() const { return false; }
 
@@ -466,6 +529,174 @@ AnalysisConsumer::getInliningModeForFunction(const Decl *D,
   return ExprEngine::Inline_Regular;
 }
 
+/// Split the functions in a call graph into \p NumShards shards, such that
+/// functions which call each other, directly or indirectly, are in the same
+/// shard. Analyzing a function only inlines functions from its own shard, so
+/// each shard can be analyzed on its own, and the shards are filled evenly
+/// with the groups of functions that are connected by calls.
+///
+/// \p Order must list the nodes of the call graph in a deterministic order,
+/// which then also determines the shard of each function.
+static llvm::DenseMap<const CallGraphNode *, unsigned>
+assignShards(ArrayRef<const CallGraphNode *> Order, unsigned NumShards) {
+  llvm::DenseMap<const CallGraphNode *, unsigned> Indices;
+  for (const CallGraphNode *N : Order)
+    Indices.insert({N, Indices.size()});
+
+  // Union the nodes that are connected by calls into groups.
+  std::vector<unsigned> Leaders(Order.size());
+  for (unsigned I = 0, E = Order.size(); I != E; ++I)
+    Leaders[I] = I;
+  auto FindLeader = [&](unsigned I) {
+    while (Leaders[I] != I)
+      I = Leaders[I] = Leaders[Leaders[I]];
+    return I;
+  };
+  for (unsigned I = 0, E = Order.size(); I != E; ++I) {
+    for (const CallGraphNode *Callee : *Order[I]) {
+      auto It = Indices.find(Callee);
+      if (It == Indices.end())
+        continue;
+      unsigned A = FindLeader(I), B = FindLeader(It->second);
+      // Keep the earliest node as the leader, so that the groups are ordered
+      // by their first node.
+      if (A != B)
+        Leaders[std::max(A, B)] = std::min(A, B);
+    }
+  }
+
+  std::vector<unsigned> GroupSizes(Order.size());
+  for (unsigned I = 0, E = Order.size(); I != E; ++I)
+    ++GroupSizes[FindLeader(I)];
+
+  // Hand out the largest groups first, each to the shard with the fewest
+  // functions so far.
+  std::vector<unsigned> Groups;
+  for (unsigned I = 0, E = Order.size(); I != E; ++I)
+    if (Leaders[I] == I)
+      Groups.push_back(I);
+  std::stable_sort(Groups.begin(), Groups.end(), [&](unsigned A, unsigned B) {
+    return GroupSizes[A] > GroupSizes[B];
+  });
+  std::vector<unsigned> ShardOfGroup(Order.size());
+  std::vector<unsigned> ShardSizes(NumShards);
+  for (unsigned G : Groups) {
+    unsigned Shard =
+        std::min_element(ShardSizes.begin(), ShardSizes.end()) -
+        ShardSizes.begin();
+    ShardOfGroup[G] = Shard;
+    ShardSizes[Shard] += GroupSizes[G];
+  }
+
+  llvm::DenseMap<const CallGraphNode *, unsigned> Shards;
+  for (unsigned I = 0, E = Order.size(); I != E; ++I)
+    Shards[Order[I]] = ShardOfGroup[FindLeader(I)];
+  return Shards;
+}
+
+/// Hash the signature and the body of a function or an Objective-C method.
+///
+/// Unlike the ODR hash, which is empty for the members of explicit class
+/// template specializations and only covers the pattern of instantiated
+/// members, this hashes the body that is actually analyzed, so it applies to
+/// template instantiations as well.
+static Optional<unsigned> getBodyHash(const Decl *D) {
+  const Stmt *Body = D->getBody();
+  if (!Body)
+    return None;
+
+  ODRHash Hash;
+  if (const auto *FD = dyn_cast<FunctionDecl>(D)) {
+    Hash.AddDeclarationName(FD->getDeclName());
+    Hash.AddQualType(FD->getType());
+    for (const ParmVarDecl *Param : FD->parameters()) {
+      Hash.AddDeclarationName(Param->getDeclName());
+      if (Param->hasDefaultArg() && !Param->hasUnparsedDefaultArg() &&
+          !Param->hasUninstantiatedDefaultArg())
+        Hash.AddStmt(Param->getDefaultArg());
+    }
+  } else if (const auto *MD = dyn_cast<ObjCMethodDecl>(D)) {
+    Hash.AddDeclarationName(MD->getDeclName());
+    Hash.AddQualType(MD->getReturnType());
+    for (const ParmVarDecl *Param : MD->parameters()) {
+      Hash.AddDeclarationName(Param->getDeclName());
+      Hash.AddQualType(Param->getType());
+    }
+  } else {
+    return None;
+  }
+  Hash.AddStmt(Body);
+  return Hash.CalculateHash();
+}
+
+/// Hash each function of the call graph together with all the functions it
+/// may call, so that the hash changes whenever a change to any of them may
+/// change the results of analyzing the function.
+///
+/// Nodes that are neither functions nor Objective-C methods, such as blocks,
+/// get no hash, and neither do the functions calling them.
+static llvm::DenseMap<const Decl *, uint64_t> getSummaryHashes(CallGraph &CG) {
+  llvm::DenseMap<const CallGraphNode *, uint64_t> NodeHashes;
+  llvm::DenseMap<const Decl *, uint64_t> Hashes;
+
+  // The strongly connected components come callees first, and the functions
+  // within one are hashed together.
+  for (auto I = llvm::scc_begin(&CG); !I.isAtEnd(); ++I) {
+    const std::vector<CallGraphNode *> &SCC = *I;
+    llvm::SmallPtrSet<const CallGraphNode *, 4> Members(SCC.begin(),
+                                                        SCC.end());
+    SmallVector<uint64_t, 16> Parts;
+    bool Hashable = true;
+    for (CallGraphNode *N : SCC) {
+      Optional<unsigned> BodyHash =
+          N->getDecl() ? getBodyHash(N->getDecl()) : None;
+      if (!BodyHash) {
+        Hashable = false;
+        break;
+      }
+      Parts.push_back(*BodyHash);
+      for (const CallGraphNode *Callee : *N) {
+        if (Members.count(Callee))
+          continue;
+        auto It = NodeHashes.find(Callee);
+        if (It == NodeHashes.end()) {
+          Hashable = false;
+          break;
+        }
+        Parts.push_back(It->second);
+      }
+      if (!Hashable)
+        break;
+    }
+    if (!Hashable)
+      continue;
+
+    llvm::sort(Parts.begin(), Parts.end());
+    uint64_t Hash = llvm::hash_combine_range(Parts.begin(), Parts.end());
+    for (CallGraphNode *N : SCC) {
+      NodeHashes[N] = Hash;
+      Hashes[N->getDecl()] = Hash;
+    }
+  }
+  return Hashes;
+}
+
+static std::string getSummaryName(const Decl *D) {
+  return cross_tu::CrossTranslationUnitContext::getLookupName(
+      cast<NamedDecl>(D));
+}
+
+void AnalysisConsumer::recordPersistentSummary(
+    const Decl *D, const llvm::DenseMap<const Decl *, uint64_t> &Hashes) {
+  auto I = Hashes.find(D);
+  if (I == Hashes.end())
+    return;
+  PersistentFunctionSummaries::Summary S;
+  S.Hash = I->second;
+  S.NeverReturns = FunctionSummaries.neverReturns(D);
+  PersistentSummaries->insert(getSummaryName(D), S);
+}
+
 void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
   // Build the Call Graph by adding all the top level declarations to the graph.
   // Note: CallGraph can trigger deserialization of more items from a pch
@@ -485,6 +716,43 @@ void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
   SetOfConstDecls Visited;
   SetOfConstDecls VisitedAsTopLevel;
   llvm::ReversePostOrderTraversal<clang::CallGraph*> RPOT(&CG);
+
+  // When the functions are split into shards, only analyze the ones in this
+  // shard. The shards do not depend on the order in which the call graph
+  // stores its nodes, since they are assigned in topological order.
+  unsigned NumShards = std::max(Mgr->options.getShardCount(), 1U);
+  unsigned ShardIndex = NumShards > 1 ? Mgr->options.getShardIndex() : 0;
+  llvm::DenseMap<const CallGraphNode *, unsigned> Shards;
+  if (NumShards > 1) {
+    SmallVector<const CallGraphNode *, 32> Order;
+    for (const CallGraphNode *N : RPOT)
+      if (N->getDecl())
+        Order.push_back(N);
+    Shards = assignShards(Order, NumShards);
+  }
+
+  // Load the summaries of the functions analyzed by earlier invocations. The
+  // functions whose summary still applies are not analyzed again, and calls
+  // to the ones that never return end the path.
+  StringRef SummaryFile = Mgr->options.getFunctionSummaryFile();
+  llvm::DenseMap<const Decl *, uint64_t> SummaryHashes;
+  llvm::DenseSet<const Decl *> Summarized;
+  if (PersistentSummaries) {
+    if (!PersistentSummaries->load(SummaryFile))
+      reportAnalyzerProgress("Ignoring the function summaries in " +
+                             SummaryFile.str() + "\n");
+    SummaryHashes = getSummaryHashes(CG);
+    for (const auto &H : SummaryHashes) {
+      const PersistentFunctionSummaries::Summary *S =
+          PersistentSummaries->lookup(getSummaryName(H.first), H.second);
+      if (!S)
+        continue;
+      Summarized.insert(H.first);
+      if (S->NeverReturns)
+        FunctionSummaries.markNeverReturns(H.first);
+    }
+  }
+
   for (llvm::ReversePostOrderTraversal<clang::CallGraph*>::rpo_iterator
          I = RPOT.begin(), E = RPOT.end(); I != E; ++I) {
     NumFunctionTopLevel++;
@@ -496,17 +764,33 @@ void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
     if (!D)
       continue;
 
+    // Skip the functions that another shard analyzes.
+    if (NumShards > 1 && Shards.lookup(N) != ShardIndex)
+      continue;
+
     // Skip the functions which have been processed already or previously
     // inlined.
     if (shouldSkipFunction(D, Visited, VisitedAsTopLevel))
       continue;
 
+    // Skip the functions that have not changed since they were analyzed.
+    if (Summarized.count(D)) {
+      ++NumFunctionsUnchanged;
+      continue;
+    }
+
     // Analyze the function.
     SetOfConstDecls VisitedCallees;
 
     HandleCode(D, AM_Path, getInliningModeForFunction(D, Visited),
                (Mgr->options.InliningMode == All ? nullptr : &VisitedCallees));
 
+    if (PersistentSummaries) {
+      recordPersistentSummary(D, SummaryHashes);
+      for (const Decl *Callee : VisitedCallees)
+        recordPersistentSummary(Callee->getCanonicalDecl(), SummaryHashes);
+    }
+
     // Add the visited callees to the global visited set.
     for (const Decl *Callee : VisitedCallees)
       // Decls from CallGraph are already canonical. But Decls coming from
@@ -515,6 +799,14 @@ void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
                                                  : Callee->getCanonicalDecl());
     VisitedAsTopLevel.insert(D);
   }
+
+  if (PersistentSummaries && !PersistentSummaries->save(SummaryFile)) {
+    DiagnosticsEngine &Diags = PP.getDiagnostics();
+    Diags.Report(Diags.getCustomDiagID(
+        DiagnosticsEngine::Warning,
+        "could not write the function summaries to '%0'"))
+        << SummaryFile;
+  }
 }
 
 static bool isBisonFile(ASTContext &C) {
@@ -527,9 +819,18 @@ static bool isBisonFile(ASTContext &C) {
 }
 
 void AnalysisConsumer::runAnalysisOnTranslationUnit(ASTContext &C) {
+  // The time budget of the translation unit is for its analysis, not for
+  // the parsing that came before it.
+  Mgr->startTUTimeBudget();
   BugReporter BR(*Mgr);
   TranslationUnitDecl *TU = C.getTranslationUnitDecl();
-  checkerMgr->runCheckersOnASTDecl(TU, *Mgr, BR);
+
+  // Only the first shard runs the checks that are not path-sensitive, so
+  // that their reports are not duplicated by the other shards.
+  bool IsFirstShard = Mgr->options.getShardCount() <= 1 ||
+                      Mgr->options.getShardIndex() == 0;
+  if (IsFirstShard)
+    checkerMgr->runCheckersOnASTDecl(TU, *Mgr, BR);
 
   // Run the AST-only checks using the order in which functions are defined.
   // If inlining is not turned on, use the simplest function order for path
@@ -546,15 +847,18 @@ void AnalysisConsumer::runAnalysisOnTranslationUnit(ASTContext &C) {
   // random access.  By doing so, we automatically compensate for iterators
   // possibly being invalidated, although this is a bit slower.
   const unsigned LocalTUDeclsSize = LocalTUDecls.size();
-  for (unsigned i = 0 ; i < LocalTUDeclsSize ; ++i) {
-    TraverseDecl(LocalTUDecls[i]);
+  if (IsFirstShard) {
+    for (unsigned i = 0 ; i < LocalTUDeclsSize ; ++i) {
+      TraverseDecl(LocalTUDecls[i]);
+    }
   }
 
   if (Mgr->shouldInlineCall())
     HandleDeclsCallGraph(LocalTUDeclsSize);
 
   // After all decls handled, run checkers on the entire TranslationUnit.
-  checkerMgr->runCheckersOnEndOfTranslationUnit(TU, *Mgr, BR);
+  if (IsFirstShard)
+    checkerMgr->runCheckersOnEndOfTranslationUnit(TU, *Mgr, BR);
 
   RecVisitorBR = nullptr;
 }
@@ -587,6 +891,10 @@ void AnalysisConsumer::HandleTranslationUnit(ASTContext &C) {
 
   if (TUTotalTimer) TUTotalTimer->stopTimer();
 
+  StringRef CheckerProfile = Opts->getCheckerProfile();
+  if (CheckerProfile != "none")
+    checkerMgr->printProfile(llvm::errs(), CheckerProfile == "json");
+
   // Count how many basic blocks we have not covered.
   NumBlocksInAnalyzedFunctions = FunctionSummaries.getTotalNumBasicBlocks();
   NumVisitedBlocksInAnalyzedFunctions =
@@ -738,9 +1046,38 @@ void AnalysisConsumer::RunPathSensitiveChecks(Decl *D,
   ExprEngine Eng(CTU, *Mgr, VisitedCallees, &FunctionSummaries, IMode);
 
   // Execute the worklist algorithm.
+  Mgr->startFunctionTimeBudget();
   Eng.ExecuteWorkList(Mgr->getAnalysisDeclContextManager().getStackFrame(D),
                       Mgr->options.getMaxNodesPerTopLevelFunction());
 
+  // Report the functions whose analysis was cut short by the time budget.
+  DiagnosticsEngine &Diags = PP.getDiagnostics();
+  if (Mgr->getFunctionTimeUsage() >= 1.0) {
+    NumFunctionsOverTimeBudget++;
+    Diags.Report(D->getLocation(),
+                 Diags.getCustomDiagID(DiagnosticsEngine::Remark,
+                                       "analysis of '%0' exceeded its time "
+                                       "budget"))
+        << getFunctionName(D);
+  } else if (!ReportedTUTimeBudget && Mgr->getTUTimeUsage() >= 1.0) {
+    ReportedTUTimeBudget = true;
+    Diags.Report(D->getLocation(),
+                 Diags.getCustomDiagID(DiagnosticsEngine::Remark,
+                                       "the translation unit ran out of its "
+                                       "time budget while analyzing '%0'"))
+        << getFunctionName(D);
+  }
+
+  // If every path through the function was explored, and none of them
+  // reached its exit, the function never returns. The blocks are recorded for
+  // the declaration that has the body.
+  if (PersistentSummaries && !Eng.hasWorkRemaining()) {
+    const Decl *BodyD = Mgr->getAnalysisDeclContext(D)->getDecl();
+    unsigned ExitID = Mgr->getCFG(D)->getExit().getBlockID();
+    if (!FunctionSummaries.isBasicBlockVisited(ExitID, BodyD))
+      FunctionSummaries.markNeverReturns(D->getCanonicalDecl());
+  }
+
   if (!Mgr->options.DumpExplodedGraphTo.empty())
     Eng.DumpGraph(Mgr->options.TrimGraph, Mgr->options.DumpExplodedGraphTo);
 
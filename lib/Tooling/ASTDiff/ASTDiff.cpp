@@ -15,6 +15,9 @@
 
 #include "clang/AST/RecursiveASTVisitor.h"
 #include "clang/Lex/Lexer.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/PriorityQueue.h"
 
 #include <limits>
@@ -76,7 +79,14 @@ public:
     return TheMapping.getSrc(Id);
   }
 
+  // The values of the nodes, which are compared many times while matching.
+  const std::string &getSrcValue(NodeId Id1) const { return Values1[Id1]; }
+  const std::string &getDstValue(NodeId Id2) const { return Values2[Id2]; }
+
 private:
+  // Computes the node values and subtree hashes of both trees.
+  void computeNodeInfo();
+
   // Returns true if the two subtrees are identical.
   bool identical(NodeId Id1, NodeId Id2) const;
 
@@ -105,6 +115,11 @@ private:
 
   const ComparisonOptions &Options;
 
+  std::vector<std::string> Values1, Values2;
+  // Hashes of the type and value of every node of a subtree. Identical
+  // subtrees have the same hash.
+  std::vector<size_t> Hashes1, Hashes2;
+
   friend class ZhangShashaMatcher;
 };
 
@@ -516,9 +531,6 @@ public:
   NodeId getPostorderOffset() const {
     return Tree.PostorderIds[getIdInRoot(SNodeId(1))];
   }
-  std::string getNodeValue(SNodeId Id) const {
-    return Tree.getNodeValue(getIdInRoot(Id));
-  }
 
 private:
   /// Returns the number of leafs in the subtree.
@@ -645,7 +657,8 @@ private:
   double getUpdateCost(SNodeId Id1, SNodeId Id2) {
     if (!DiffImpl.isMatchingPossible(S1.getIdInRoot(Id1), S2.getIdInRoot(Id2)))
       return std::numeric_limits<double>::max();
-    return S1.getNodeValue(Id1) != S2.getNodeValue(Id2);
+    return DiffImpl.getSrcValue(S1.getIdInRoot(Id1)) !=
+           DiffImpl.getDstValue(S2.getIdInRoot(Id2));
   }
 
   void computeTreeDist() {
@@ -760,8 +773,7 @@ bool ASTDiff::Impl::identical(NodeId Id1, NodeId Id2) const {
   const Node &N1 = T1.getNode(Id1);
   const Node &N2 = T2.getNode(Id2);
   if (N1.Children.size() != N2.Children.size() ||
-      !isMatchingPossible(Id1, Id2) ||
-      T1.getNodeValue(Id1) != T2.getNodeValue(Id2))
+      !isMatchingPossible(Id1, Id2) || getSrcValue(Id1) != getDstValue(Id2))
     return false;
   for (size_t Id = 0, E = N1.Children.size(); Id < E; ++Id)
     if (!identical(N1.Children[Id], N2.Children[Id]))
@@ -816,9 +828,24 @@ double ASTDiff::Impl::getJaccardSimilarity(const Mapping &M, NodeId Id1,
 }
 
 NodeId ASTDiff::Impl::findCandidate(const Mapping &M, NodeId Id1) const {
+  // Only nodes that contain a node mapped to a descendant of Id1 have a
+  // non-zero similarity, so those are the only ones worth looking at.
+  std::vector<NodeId> Candidates;
+  llvm::DenseSet<int> Seen;
+  const Node &N1 = T1.getNode(Id1);
+  for (NodeId Src = Id1 + 1; Src <= N1.RightMostDescendant; ++Src) {
+    for (NodeId Id2 = M.getDst(Src); Id2.isValid();
+         Id2 = T2.getNode(Id2).Parent) {
+      if (!Seen.insert(Id2).second)
+        break;
+      Candidates.push_back(Id2);
+    }
+  }
+  llvm::sort(Candidates);
+
   NodeId Candidate;
   double HighestSimilarity = 0.0;
-  for (NodeId Id2 : T2) {
+  for (NodeId Id2 : Candidates) {
     if (!isMatchingPossible(Id1, Id2))
       continue;
     if (M.hasDst(Id2))
@@ -882,8 +909,15 @@ Mapping ASTDiff::Impl::matchTopDown() const {
     std::vector<NodeId> H1, H2;
     H1 = L1.pop();
     H2 = L2.pop();
+    // Only subtrees with the same hash can be identical.
+    llvm::DenseMap<size_t, SmallVector<NodeId, 2>> H2ByHash;
+    for (NodeId Id2 : H2)
+      H2ByHash[Hashes2[Id2]].push_back(Id2);
     for (NodeId Id1 : H1) {
-      for (NodeId Id2 : H2) {
+      auto It = H2ByHash.find(Hashes1[Id1]);
+      if (It == H2ByHash.end())
+        continue;
+      for (NodeId Id2 : It->second) {
         if (identical(Id1, Id2) && !M.hasSrc(Id1) && !M.hasDst(Id2)) {
           for (int I = 0, E = T1.getNumberOfDescendants(Id1); I < E; ++I)
             M.link(Id1 + I, Id2 + I);
@@ -905,14 +939,40 @@ Mapping ASTDiff::Impl::matchTopDown() const {
 ASTDiff::Impl::Impl(SyntaxTree::Impl &T1, SyntaxTree::Impl &T2,
                     const ComparisonOptions &Options)
     : T1(T1), T2(T2), Options(Options) {
+  computeNodeInfo();
   computeMapping();
   computeChangeKinds(TheMapping);
 }
 
+static void computeValuesAndHashes(const SyntaxTree::Impl &Tree,
+                                   std::vector<std::string> &Values,
+                                   std::vector<size_t> &Hashes) {
+  Values.resize(Tree.getSize());
+  Hashes.resize(Tree.getSize());
+  // Children come after their parent in preorder.
+  for (int Id = Tree.getSize() - 1; Id >= 0; --Id) {
+    const Node &N = Tree.getNode(Id);
+    Values[Id] = Tree.getNodeValue(N);
+    llvm::hash_code Hash =
+        llvm::hash_combine(N.getTypeLabel(), Values[Id], N.Children.size());
+    for (NodeId Child : N.Children)
+      Hash = llvm::hash_combine(Hash, Hashes[Child]);
+    Hashes[Id] = Hash;
+  }
+}
+
+void ASTDiff::Impl::computeNodeInfo() {
+  computeValuesAndHashes(T1, Values1, Hashes1);
+  computeValuesAndHashes(T2, Values2, Hashes2);
+}
+
 void ASTDiff::Impl::computeMapping() {
   TheMapping = matchTopDown();
   if (Options.StopAfterTopDown)
     return;
+  if (Options.MaxNodes > 0 &&
+      std::max(T1.getSize(), T2.getSize()) > Options.MaxNodes)
+    return;
   matchBottomUp(TheMapping);
 }
 
@@ -953,7 +1013,7 @@ void ASTDiff::Impl::computeChangeKinds(Mapping &M) {
             T2.findPositionInParent(Id2, true)) {
       N1.Change = N2.Change = Move;
     }
-    if (T1.getNodeValue(Id1) != T2.getNodeValue(Id2)) {
+    if (getSrcValue(Id1) != getDstValue(Id2)) {
       N1.Change = N2.Change = (N1.Change == Move ? UpdateMove : Update);
     }
   }
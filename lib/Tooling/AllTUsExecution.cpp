@@ -8,8 +8,11 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Tooling/AllTUsExecution.h"
+#include "clang/Tooling/SharedFileSystemCache.h"
 #include "clang/Tooling/ToolExecutorPluginRegistry.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/ThreadPool.h"
+#include <chrono>
 
 namespace clang {
 namespace tooling {
@@ -59,11 +62,18 @@ llvm::cl::opt<std::string>
                           "This flag only applies to all-TUs."),
            llvm::cl::init(".*"));
 
+static llvm::cl::opt<bool> PrintTUTimes(
+    "print-tu-times",
+    llvm::cl::desc("Print how long the action took on each file. "
+                   "This flag only applies to all-TUs."),
+    llvm::cl::init(false));
+
 AllTUsToolExecutor::AllTUsToolExecutor(
     const CompilationDatabase &Compilations, unsigned ThreadCount,
     std::shared_ptr<PCHContainerOperations> PCHContainerOps)
     : Compilations(Compilations), Results(new ThreadSafeToolResults),
-      Context(Results.get()), ThreadCount(ThreadCount) {}
+      Context(Results.get()), ThreadCount(ThreadCount),
+      PCHContainerOps(std::move(PCHContainerOps)) {}
 
 AllTUsToolExecutor::AllTUsToolExecutor(
     CommonOptionsParser Options, unsigned ThreadCount,
@@ -71,7 +81,7 @@ AllTUsToolExecutor::AllTUsToolExecutor(
     : OptionsParser(std::move(Options)),
       Compilations(OptionsParser->getCompilations()),
       Results(new ThreadSafeToolResults), Context(Results.get()),
-      ThreadCount(ThreadCount) {}
+      ThreadCount(ThreadCount), PCHContainerOps(std::move(PCHContainerOps)) {}
 
 llvm::Error AllTUsToolExecutor::execute(
     llvm::ArrayRef<
@@ -112,6 +122,9 @@ llvm::Error AllTUsToolExecutor::execute(
 
   auto &Action = Actions.front();
 
+  // Headers are shared by most TUs; read and stat each of them only once.
+  auto FileCache = std::make_shared<SharedFileSystemCache>();
+
   {
     llvm::ThreadPool Pool(ThreadCount == 0 ? llvm::hardware_concurrency()
                                            : ThreadCount);
@@ -124,9 +137,13 @@ llvm::Error AllTUsToolExecutor::execute(
     for (std::string File : Files) {
       Pool.async(
           [&](std::string Path) {
-            Log("[" + std::to_string(Count()) + "/" + TotalNumStr +
-                "] Processing file " + Path);
-            ClangTool Tool(Compilations, {Path});
+            std::string Progress =
+                "[" + std::to_string(Count()) + "/" + TotalNumStr + "]";
+            Log(Progress + " Processing file " + Path);
+            auto Start = std::chrono::steady_clock::now();
+            ClangTool Tool(Compilations, {Path}, PCHContainerOps,
+                           new SharedCachingFileSystem(
+                               FileCache, llvm::vfs::getRealFileSystem()));
             Tool.appendArgumentsAdjuster(Action.second);
             Tool.appendArgumentsAdjuster(getDefaultArgumentsAdjusters());
             for (const auto &FileAndContent : OverlayFiles)
@@ -137,6 +154,15 @@ llvm::Error AllTUsToolExecutor::execute(
             if (Tool.run(Action.first.get()))
               AppendError(llvm::Twine("Failed to run action on ") + Path +
                           "\n");
+            if (PrintTUTimes) {
+              std::chrono::duration<double> Elapsed =
+                  std::chrono::steady_clock::now() - Start;
+              std::string Seconds;
+              llvm::raw_string_ostream(Seconds)
+                  << llvm::format("%.3f", Elapsed.count());
+              Log(Progress + " Processed file " + Path + " in " + Seconds +
+                  "s");
+            }
           },
           File);
     }
@@ -24,6 +24,7 @@
 #include "clang/Rewrite/Core/Rewriter.h"
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/ErrorHandling.h"
@@ -210,8 +211,11 @@ Replacements Replacements::getCanonicalReplacements() const {
       Prev = NewR;
     }
   }
-  ReplacementsImpl NewReplacesImpl(NewReplaces.begin(), NewReplaces.end());
-  return Replacements(NewReplacesImpl.begin(), NewReplacesImpl.end());
+  // The replacements are still in order, so each one goes at the end.
+  Replacements Result;
+  for (auto &R : NewReplaces)
+    Result.Replaces.insert(Result.Replaces.end(), std::move(R));
+  return Result;
 }
 
 // `R` and `Replaces` are order-independent if applying them in either order
@@ -228,6 +232,7 @@ Replacements::mergeIfOrderIndependent(const Replacement &R) const {
   Replacements ReplacesShiftedByRs;
   for (const auto &Replace : Replaces)
     ReplacesShiftedByRs.Replaces.insert(
+        ReplacesShiftedByRs.Replaces.end(),
         Rs.getReplacementInChangedCode(Replace));
   // This is equivalent to applying `Replaces` first and then `R`.
   auto MergeShiftedRs = merge(RsShiftedByReplaces);
@@ -450,7 +455,7 @@ Replacements Replacements::merge(const Replacements &ReplacesToMerge) const {
   // Delta is the amount of characters that replacements from 'Second' need to
   // be shifted so that their offsets refer to the original text.
   int Delta = 0;
-  ReplacementsImpl Result;
+  Replacements Result;
 
   // Iterate over both sets and always add the next element (smallest total
   // Offset) from either 'First' or 'Second'. Merge that element with
@@ -474,9 +479,11 @@ Replacements Replacements::merge(const Replacements &ReplacesToMerge) const {
       ++I;
     }
     Delta -= Merged.deltaFirst();
-    Result.insert(Merged.asReplacement());
+    // Merged replacements are produced in order, so inserting each one at the
+    // end keeps the whole merge linear.
+    Result.Replaces.insert(Result.Replaces.end(), Merged.asReplacement());
   }
-  return Replacements(Result.begin(), Result.end());
+  return Result;
 }
 
 // Combines overlapping ranges in \p Ranges and sorts the combined ranges.
@@ -566,7 +573,35 @@ unsigned Replacements::getShiftedCodePosition(unsigned Position) const {
 namespace clang {
 namespace tooling {
 
+/// Convert \p Replaces, which all apply to one file, into edits for
+/// Rewriter::ReplaceTextInBulk.
+static void
+getRewriteEdits(const Replacements &Replaces,
+                SmallVectorImpl<RewriteBuffer::Edit> &Edits) {
+  Edits.reserve(Replaces.size());
+  for (const Replacement &R : Replaces)
+    Edits.push_back({R.getOffset(), R.getLength(), R.getReplacementText()});
+}
+
 bool applyAllReplacements(const Replacements &Replaces, Rewriter &Rewrite) {
+  if (Replaces.empty())
+    return true;
+
+  // All replacements are in the same file, and Replacements keeps them sorted
+  // and free of conflicts, so they can usually be applied in a single pass.
+  if (std::all_of(Replaces.begin(), Replaces.end(),
+                  [](const Replacement &R) { return R.isApplicable(); })) {
+    SourceManager &SM = Rewrite.getSourceMgr();
+    if (const FileEntry *Entry =
+            SM.getFileManager().getFile(Replaces.begin()->getFilePath())) {
+      SmallVector<RewriteBuffer::Edit, 16> Edits;
+      getRewriteEdits(Replaces, Edits);
+      FileID ID = SM.getOrCreateFileID(Entry, SrcMgr::C_User);
+      if (!Rewrite.ReplaceTextInBulk(ID, Edits))
+        return true;
+    }
+  }
+
   bool Result = true;
   for (auto I = Replaces.rbegin(), E = Replaces.rend(); I != E; ++I) {
     if (I->isApplicable()) {
@@ -595,12 +630,17 @@ llvm::Expected<std::string> applyAllReplacements(StringRef Code,
       "<stdin>", 0, llvm::MemoryBuffer::getMemBuffer(Code, "<stdin>"));
   FileID ID = SourceMgr.createFileID(Files.getFile("<stdin>"), SourceLocation(),
                                      clang::SrcMgr::C_User);
-  for (auto I = Replaces.rbegin(), E = Replaces.rend(); I != E; ++I) {
-    Replacement Replace("<stdin>", I->getOffset(), I->getLength(),
-                        I->getReplacementText());
-    if (!Replace.apply(Rewrite))
-      return llvm::make_error<ReplacementError>(
-          replacement_error::fail_to_apply, Replace);
+  SmallVector<RewriteBuffer::Edit, 16> Edits;
+  getRewriteEdits(Replaces, Edits);
+  if (Rewrite.ReplaceTextInBulk(ID, Edits)) {
+    // Report the first replacement that does not fit into the code.
+    for (const Replacement &R : Replaces)
+      if (R.getOffset() + R.getLength() > Code.size())
+        return llvm::make_error<ReplacementError>(
+            replacement_error::fail_to_apply,
+            Replacement("<stdin>", R.getOffset(), R.getLength(),
+                        R.getReplacementText()));
+    llvm_unreachable("sorted replacements without conflicts must apply");
   }
   std::string Result;
   llvm::raw_string_ostream OS(Result);
@@ -49,7 +49,9 @@
 #include "clang/Tooling/CompilationDatabase.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Optional.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Option/ArgList.h"
 #include "llvm/Option/OptTable.h"
@@ -58,6 +60,8 @@
 #include "llvm/Support/StringSaver.h"
 #include "llvm/Support/raw_ostream.h"
 #include <memory>
+#include <mutex>
+#include <tuple>
 
 namespace clang {
 namespace tooling {
@@ -323,12 +327,14 @@ public:
     // Sort commands by filename for determinism (index is a tiebreaker later).
     llvm::sort(OriginalPaths);
     Paths.reserve(OriginalPaths.size());
+    LowerPaths.reserve(OriginalPaths.size());
     Types.reserve(OriginalPaths.size());
     Stems.reserve(OriginalPaths.size());
     for (size_t I = 0; I < OriginalPaths.size(); ++I) {
       StringRef Path = Strings.save(StringRef(OriginalPaths[I]).lower());
 
       Paths.emplace_back(Path, I);
+      LowerPaths.push_back(Path);
       Types.push_back(foldType(guessType(Path)));
       Stems.emplace_back(sys::path::stem(Path), I);
       auto Dir = ++sys::path::rbegin(Path), DirEnd = sys::path::rend(Path);
@@ -350,9 +356,10 @@ public:
                         types::ID PreferLanguage) const {
     assert(!empty() && "need at least one candidate!");
     std::string Filename = OriginalFilename.lower();
-    auto Candidates = scoreCandidates(Filename);
+    ArrayRef<SubstringAndIndex> PrefixMatches;
+    auto Candidates = scoreCandidates(Filename, PrefixMatches);
     std::pair<size_t, int> Best =
-        pickWinner(Candidates, Filename, PreferLanguage);
+        pickWinner(Candidates, PrefixMatches, Filename, PreferLanguage);
 
     DEBUG_WITH_TYPE(
         "interpolate",
@@ -376,7 +383,12 @@ private:
 
   // Award points to candidate entries that should be considered for the file.
   // Returned keys are indexes into paths, and the values are (nonzero) scores.
-  DenseMap<size_t, int> scoreCandidates(StringRef Filename) const {
+  // The candidates whose whole path up to the queried directories matches get
+  // one more point. Usually that is most of the project, so only those that
+  // also scored otherwise are returned; PrefixMatches is set to all of them.
+  DenseMap<size_t, int>
+  scoreCandidates(StringRef Filename,
+                  ArrayRef<SubstringAndIndex> &PrefixMatches) const {
     // Decompose Filename into the parts we care about.
     // /some/path/complicated/project/Interesting.h
     // [-prefix--][---dir---] [-dir-] [--stem---]
@@ -406,16 +418,24 @@ private:
     for (StringRef Dir : Dirs)
       Award(1, indexLookup</*Prefix=*/false>(Dir, Components));
     // Award one more point if the whole rest of the path matches.
-    if (sys::path::root_directory(Prefix) != Prefix)
-      Award(1, indexLookup</*Prefix=*/true>(Prefix, Paths));
+    PrefixMatches = {};
+    if (sys::path::root_directory(Prefix) != Prefix) {
+      PrefixMatches = indexLookup</*Prefix=*/true>(Prefix, Paths);
+      if (!PrefixMatches.empty())
+        for (auto &Candidate : Candidates)
+          if (LowerPaths[Candidate.first].startswith(Prefix))
+            ++Candidate.second;
+    }
     return Candidates;
   }
 
-  // Pick a single winner from the set of scored candidates.
+  // Pick a single winner from the set of scored candidates, and from the
+  // PrefixMatches that are not among them, which have one point each.
   // Returns (index, score).
-  std::pair<size_t, int> pickWinner(const DenseMap<size_t, int> &Candidates,
-                                    StringRef Filename,
-                                    types::ID PreferredLanguage) const {
+  std::pair<size_t, int>
+  pickWinner(const DenseMap<size_t, int> &Candidates,
+             ArrayRef<SubstringAndIndex> PrefixMatches, StringRef Filename,
+             types::ID PreferredLanguage) const {
     struct ScoredCandidate {
       size_t Index;
       bool Preferred;
@@ -436,7 +456,7 @@ private:
         if (S.Points < Best.Points)
           continue;
         if (S.Points == Best.Points) {
-          S.PrefixLength = matchingPrefix(Filename, Paths[S.Index].first);
+          S.PrefixLength = matchingPrefix(Filename, LowerPaths[S.Index]);
           if (S.PrefixLength < Best.PrefixLength)
             continue;
           // hidden heuristics should at least be deterministic!
@@ -447,9 +467,38 @@ private:
       }
       // PrefixLength was only set above if actually needed for a tiebreak.
       // But it definitely needs to be set to break ties in the future.
-      S.PrefixLength = matchingPrefix(Filename, Paths[S.Index].first);
+      S.PrefixLength = matchingPrefix(Filename, LowerPaths[S.Index]);
       Best = S;
     }
+
+    // A candidate with a single point for its prefix can only win if the best
+    // one so far has no more points, or is not preferred. Look for the one
+    // with the longest common prefix, first among the preferred ones.
+    if (!PrefixMatches.empty() && (!Best.Preferred || Best.Points <= 1)) {
+      auto IsPrefixOnly = [&](size_t Index) { return !Candidates.count(Index); };
+      ScoredCandidate S;
+      S.Points = 1;
+      S.Preferred = true;
+      bool Found = closestMatch(
+          Filename, PrefixMatches,
+          [&](size_t Index) {
+            return IsPrefixOnly(Index) &&
+                   (PreferredLanguage == types::TY_INVALID ||
+                    PreferredLanguage == Types[Index]);
+          },
+          S.Index, S.PrefixLength);
+      if (!Found && !Best.Preferred && Best.Points <= 1) {
+        S.Preferred = false;
+        Found = closestMatch(Filename, PrefixMatches, IsPrefixOnly, S.Index,
+                             S.PrefixLength);
+      }
+      if (Found &&
+          std::make_tuple(S.Preferred, S.Points, S.PrefixLength,
+                          size_t(-1) - S.Index) >
+              std::make_tuple(Best.Preferred, Best.Points, Best.PrefixLength,
+                              size_t(-1) - Best.Index))
+        Best = S;
+    }
     // Edge case: no candidate got any points.
     // We ignore PreferredLanguage at this point (not ideal).
     if (Best.Index == size_t(-1))
@@ -468,6 +517,45 @@ private:
     return {Range.first, Range.second};
   }
 
+  // Finds the entry of a sorted index that has the longest common prefix with
+  // Key among those whose index is accepted by Accept, and the lowest index
+  // among those with that prefix. The length of the common prefix decreases
+  // on both sides of Key's position, so we walk outwards, one prefix length at
+  // a time, and stop at the first length that has an accepted entry.
+  // Returns false if none is accepted.
+  bool closestMatch(StringRef Key, ArrayRef<SubstringAndIndex> Idx,
+                    llvm::function_ref<bool(size_t)> Accept, size_t &Index,
+                    size_t &PrefixLength) const {
+    size_t Right =
+        std::lower_bound(Idx.begin(), Idx.end(), SubstringAndIndex{Key, 0}) -
+        Idx.begin();
+    size_t Left = Right;
+    while (Left != 0 || Right != Idx.size()) {
+      size_t Length = 0;
+      if (Left != 0)
+        Length = matchingPrefix(Key, Idx[Left - 1].first);
+      if (Right != Idx.size())
+        Length = std::max(Length, matchingPrefix(Key, Idx[Right].first));
+      bool Found = false;
+      auto Visit = [&](const SubstringAndIndex &Entry) {
+        if (Accept(Entry.second) && (!Found || Entry.second < Index)) {
+          Found = true;
+          Index = Entry.second;
+        }
+      };
+      while (Left != 0 && matchingPrefix(Key, Idx[Left - 1].first) == Length)
+        Visit(Idx[--Left]);
+      while (Right != Idx.size() &&
+             matchingPrefix(Key, Idx[Right].first) == Length)
+        Visit(Idx[Right++]);
+      if (Found) {
+        PrefixLength = Length;
+        return true;
+      }
+    }
+    return false;
+  }
+
   // Performs a point lookup into a nonempty index, returning a longest match.
   SubstringAndIndex longestMatch(StringRef Key,
                                  ArrayRef<SubstringAndIndex> Idx) const {
@@ -492,6 +580,8 @@ private:
   // Indexes of candidates by certain substrings.
   // String is lowercase and sorted, index points into OriginalPaths.
   std::vector<SubstringAndIndex> Paths;      // Full path.
+  // The lowercase path of each candidate, by index into OriginalPaths.
+  std::vector<StringRef> LowerPaths;
   // Lang types obtained by guessing on the corresponding path. I-th element is
   // a type for the I-th path.
   std::vector<types::ID> Types;
@@ -512,12 +602,7 @@ public:
     auto Known = Inner->getCompileCommands(Filename);
     if (Index.empty() || !Known.empty())
       return Known;
-    bool TypeCertain;
-    auto Lang = guessType(Filename, &TypeCertain);
-    if (!TypeCertain)
-      Lang = types::TY_INVALID;
-    auto ProxyCommands =
-        Inner->getCompileCommands(Index.chooseProxy(Filename, foldType(Lang)));
+    auto ProxyCommands = Inner->getCompileCommands(chooseProxy(Filename));
     if (ProxyCommands.empty())
       return {};
     return {TransferableCommand(ProxyCommands[0]).transferTo(Filename)};
@@ -532,8 +617,27 @@ public:
   }
 
 private:
+  // Editors ask about the same headers over and over, so remember the proxy
+  // that was chosen for each file.
+  StringRef chooseProxy(StringRef Filename) const {
+    std::lock_guard<std::mutex> Lock(ProxiesMutex);
+    auto It = Proxies.find(Filename);
+    if (It != Proxies.end())
+      return It->second;
+    bool TypeCertain;
+    auto Lang = guessType(Filename, &TypeCertain);
+    if (!TypeCertain)
+      Lang = types::TY_INVALID;
+    StringRef Proxy = Index.chooseProxy(Filename, foldType(Lang));
+    Proxies[Filename] = Proxy;
+    return Proxy;
+  }
+
   std::unique_ptr<CompilationDatabase> Inner;
   FileIndex Index;
+  // Filename -> the file in Index whose command it borrows.
+  mutable llvm::StringMap<StringRef> Proxies;
+  mutable std::mutex ProxiesMutex;
 };
 
 } // namespace
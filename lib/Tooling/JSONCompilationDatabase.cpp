@@ -17,6 +17,7 @@
 #include "clang/Tooling/CompilationDatabasePluginRegistry.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Triple.h"
@@ -34,7 +35,6 @@
 #include <memory>
 #include <string>
 #include <system_error>
-#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -266,116 +266,334 @@ void JSONCompilationDatabase::getCommands(
     ArrayRef<CompileCommandRef> CommandsRef,
     std::vector<CompileCommand> &Commands) const {
   for (const auto &CommandRef : CommandsRef) {
+    // An entry that was only scanned is parsed on its own now; scan() made
+    // sure that it is valid.
+    llvm::SourceMgr EntrySM;
+    llvm::Optional<llvm::yaml::Stream> EntryStream;
+    CompileCommandRef Parsed;
+    const CompileCommandRef *Ref = &CommandRef;
+    if (!CommandRef.Object.empty()) {
+      EntryStream.emplace(CommandRef.Object, EntrySM);
+      std::string ErrorMessage;
+      llvm::yaml::document_iterator I = EntryStream->begin();
+      if (I == EntryStream->end() ||
+          !parseObject(I->getRoot(), Parsed, ErrorMessage))
+        continue;
+      Ref = &Parsed;
+    }
     SmallString<8> DirectoryStorage;
     SmallString<32> FilenameStorage;
     SmallString<32> OutputStorage;
-    auto Output = std::get<3>(CommandRef);
     Commands.emplace_back(
-        std::get<0>(CommandRef)->getValue(DirectoryStorage),
-        std::get<1>(CommandRef)->getValue(FilenameStorage),
-        nodeToCommandLine(Syntax, std::get<2>(CommandRef)),
-        Output ? Output->getValue(OutputStorage) : "");
+        Ref->Directory->getValue(DirectoryStorage),
+        Ref->File->getValue(FilenameStorage),
+        nodeToCommandLine(Syntax, Ref->CommandLine),
+        Ref->Output ? Ref->Output->getValue(OutputStorage) : "");
   }
 }
 
-bool JSONCompilationDatabase::parse(std::string &ErrorMessage) {
-  llvm::yaml::document_iterator I = YAMLStream.begin();
-  if (I == YAMLStream.end()) {
-    ErrorMessage = "Error while parsing YAML.";
+static void getNativeFilePath(StringRef Directory, StringRef FileName,
+                              SmallVectorImpl<char> &NativeFilePath) {
+  if (llvm::sys::path::is_relative(FileName)) {
+    SmallString<128> AbsolutePath(Directory);
+    llvm::sys::path::append(AbsolutePath, FileName);
+    llvm::sys::path::native(AbsolutePath, NativeFilePath);
+  } else {
+    llvm::sys::path::native(FileName, NativeFilePath);
+  }
+}
+
+bool JSONCompilationDatabase::parseObject(llvm::yaml::Node *Value,
+                                          CompileCommandRef &Ref,
+                                          std::string &ErrorMessage) {
+  auto *Object = dyn_cast_or_null<llvm::yaml::MappingNode>(Value);
+  if (!Object) {
+    ErrorMessage = "Expected object.";
     return false;
   }
-  llvm::yaml::Node *Root = I->getRoot();
-  if (!Root) {
-    ErrorMessage = "Error while parsing YAML.";
+  llvm::yaml::ScalarNode *Directory = nullptr;
+  llvm::Optional<std::vector<llvm::yaml::ScalarNode *>> Command;
+  llvm::yaml::ScalarNode *File = nullptr;
+  llvm::yaml::ScalarNode *Output = nullptr;
+  for (auto& NextKeyValue : *Object) {
+    auto *KeyString = dyn_cast<llvm::yaml::ScalarNode>(NextKeyValue.getKey());
+    if (!KeyString) {
+      ErrorMessage = "Expected strings as key.";
+      return false;
+    }
+    SmallString<10> KeyStorage;
+    StringRef KeyValue = KeyString->getValue(KeyStorage);
+    llvm::yaml::Node *Value = NextKeyValue.getValue();
+    if (!Value) {
+      ErrorMessage = "Expected value.";
+      return false;
+    }
+    auto *ValueString = dyn_cast<llvm::yaml::ScalarNode>(Value);
+    auto *SequenceString = dyn_cast<llvm::yaml::SequenceNode>(Value);
+    if (KeyValue == "arguments" && !SequenceString) {
+      ErrorMessage = "Expected sequence as value.";
+      return false;
+    } else if (KeyValue != "arguments" && !ValueString) {
+      ErrorMessage = "Expected string as value.";
+      return false;
+    }
+    if (KeyValue == "directory") {
+      Directory = ValueString;
+    } else if (KeyValue == "arguments") {
+      Command = std::vector<llvm::yaml::ScalarNode *>();
+      for (auto &Argument : *SequenceString) {
+        auto *Scalar = dyn_cast<llvm::yaml::ScalarNode>(&Argument);
+        if (!Scalar) {
+          ErrorMessage = "Only strings are allowed in 'arguments'.";
+          return false;
+        }
+        Command->push_back(Scalar);
+      }
+    } else if (KeyValue == "command") {
+      if (!Command)
+        Command = std::vector<llvm::yaml::ScalarNode *>(1, ValueString);
+    } else if (KeyValue == "file") {
+      File = ValueString;
+    } else if (KeyValue == "output") {
+      Output = ValueString;
+    } else {
+      ErrorMessage = ("Unknown key: \"" +
+                      KeyString->getRawValue() + "\"").str();
+      return false;
+    }
+  }
+  if (!File) {
+    ErrorMessage = "Missing key: \"file\".";
     return false;
   }
-  auto *Array = dyn_cast<llvm::yaml::SequenceNode>(Root);
-  if (!Array) {
-    ErrorMessage = "Expected array.";
+  if (!Command) {
+    ErrorMessage = "Missing key: \"command\" or \"arguments\".";
     return false;
   }
-  for (auto &NextObject : *Array) {
-    auto *Object = dyn_cast<llvm::yaml::MappingNode>(&NextObject);
-    if (!Object) {
-      ErrorMessage = "Expected object.";
+  if (!Directory) {
+    ErrorMessage = "Missing key: \"directory\".";
+    return false;
+  }
+  Ref.Directory = Directory;
+  Ref.File = File;
+  Ref.CommandLine = std::move(*Command);
+  Ref.Output = Output;
+  return true;
+}
+
+namespace {
+
+/// Reads a compilation database that is plain JSON, an array of objects whose
+/// values are strings or, for "arguments", arrays of strings.
+///
+/// The reader only decodes the strings that the index needs and otherwise
+/// just finds where each object starts and ends, so that reading a large
+/// database needs neither a document in memory nor time for the command
+/// lines. Anything outside of plain JSON, or outside of what a valid entry
+/// can hold, stops the reader.
+class JSONDatabaseScanner {
+public:
+  explicit JSONDatabaseScanner(StringRef Buffer) : Buffer(Buffer) {}
+
+  /// Calls \p Callback with the text, the directory and the file of each
+  /// entry. Returns false if the database cannot be read this way.
+  bool scan(llvm::function_ref<void(StringRef Object, StringRef Directory,
+                                    StringRef File)>
+                Callback) {
+    skipWhitespace();
+    if (!consume('['))
       return false;
+    skipWhitespace();
+    if (!consume(']')) {
+      do {
+        skipWhitespace();
+        if (!scanObject(Callback))
+          return false;
+        skipWhitespace();
+      } while (consume(','));
+      if (!consume(']'))
+        return false;
     }
-    llvm::yaml::ScalarNode *Directory = nullptr;
-    llvm::Optional<std::vector<llvm::yaml::ScalarNode *>> Command;
-    llvm::yaml::ScalarNode *File = nullptr;
-    llvm::yaml::ScalarNode *Output = nullptr;
-    for (auto& NextKeyValue : *Object) {
-      auto *KeyString = dyn_cast<llvm::yaml::ScalarNode>(NextKeyValue.getKey());
-      if (!KeyString) {
-        ErrorMessage = "Expected strings as key.";
+    skipWhitespace();
+    return Pos == Buffer.size();
+  }
+
+private:
+  bool consume(char C) {
+    if (Pos == Buffer.size() || Buffer[Pos] != C)
+      return false;
+    ++Pos;
+    return true;
+  }
+
+  void skipWhitespace() {
+    while (Pos != Buffer.size() &&
+           (Buffer[Pos] == ' ' || Buffer[Pos] == '\t' || Buffer[Pos] == '\n' ||
+            Buffer[Pos] == '\r'))
+      ++Pos;
+  }
+
+  /// Reads a string, and decodes it into \p Value if that is not null.
+  bool scanString(std::string *Value) {
+    if (!consume('"'))
+      return false;
+    if (Value)
+      Value->clear();
+    while (Pos != Buffer.size()) {
+      // Copy the characters that need no decoding at once.
+      size_t End = Pos;
+      while (End != Buffer.size() && Buffer[End] != '"' &&
+             Buffer[End] != '\\' && (unsigned char)Buffer[End] >= 0x20)
+        ++End;
+      if (Value)
+        Value->append(Buffer.data() + Pos, End - Pos);
+      Pos = End;
+      if (consume('"'))
+        return true;
+      if (!consume('\\') || Pos == Buffer.size())
         return false;
-      }
-      SmallString<10> KeyStorage;
-      StringRef KeyValue = KeyString->getValue(KeyStorage);
-      llvm::yaml::Node *Value = NextKeyValue.getValue();
-      if (!Value) {
-        ErrorMessage = "Expected value.";
+      char Escaped = Buffer[Pos++];
+      char Decoded;
+      switch (Escaped) {
+      case '"':
+      case '\\':
+      case '/':
+        Decoded = Escaped;
+        break;
+      case 'b':
+        Decoded = '\b';
+        break;
+      case 'f':
+        Decoded = '\f';
+        break;
+      case 'n':
+        Decoded = '\n';
+        break;
+      case 'r':
+        Decoded = '\r';
+        break;
+      case 't':
+        Decoded = '\t';
+        break;
+      default:
+        // Leave \u escapes, which are rare in file names, to the YAML parser.
         return false;
       }
-      auto *ValueString = dyn_cast<llvm::yaml::ScalarNode>(Value);
-      auto *SequenceString = dyn_cast<llvm::yaml::SequenceNode>(Value);
-      if (KeyValue == "arguments" && !SequenceString) {
-        ErrorMessage = "Expected sequence as value.";
+      if (Value)
+        Value->push_back(Decoded);
+    }
+    return false;
+  }
+
+  bool scanObject(llvm::function_ref<void(StringRef Object, StringRef Directory,
+                                          StringRef File)>
+                      Callback) {
+    size_t Start = Pos;
+    if (!consume('{'))
+      return false;
+    bool HasCommand = false, HasDirectory = false, HasFile = false;
+    do {
+      skipWhitespace();
+      if (!scanString(&Key))
         return false;
-      } else if (KeyValue != "arguments" && !ValueString) {
-        ErrorMessage = "Expected string as value.";
+      skipWhitespace();
+      if (!consume(':'))
         return false;
-      }
-      if (KeyValue == "directory") {
-        Directory = ValueString;
-      } else if (KeyValue == "arguments") {
-        Command = std::vector<llvm::yaml::ScalarNode *>();
-        for (auto &Argument : *SequenceString) {
-          auto *Scalar = dyn_cast<llvm::yaml::ScalarNode>(&Argument);
-          if (!Scalar) {
-            ErrorMessage = "Only strings are allowed in 'arguments'.";
+      skipWhitespace();
+      if (Key == "arguments") {
+        if (!consume('['))
+          return false;
+        skipWhitespace();
+        if (!consume(']')) {
+          do {
+            skipWhitespace();
+            if (!scanString(nullptr))
+              return false;
+            skipWhitespace();
+          } while (consume(','));
+          if (!consume(']'))
             return false;
-          }
-          Command->push_back(Scalar);
         }
-      } else if (KeyValue == "command") {
-        if (!Command)
-          Command = std::vector<llvm::yaml::ScalarNode *>(1, ValueString);
-      } else if (KeyValue == "file") {
-        File = ValueString;
-      } else if (KeyValue == "output") {
-        Output = ValueString;
+        HasCommand = true;
+      } else if (Key == "directory") {
+        if (!scanString(&Directory))
+          return false;
+        HasDirectory = true;
+      } else if (Key == "file") {
+        if (!scanString(&File))
+          return false;
+        HasFile = true;
+      } else if (Key == "command" || Key == "output") {
+        if (!scanString(nullptr))
+          return false;
+        HasCommand |= Key == "command";
       } else {
-        ErrorMessage = ("Unknown key: \"" +
-                        KeyString->getRawValue() + "\"").str();
         return false;
       }
-    }
-    if (!File) {
-      ErrorMessage = "Missing key: \"file\".";
-      return false;
-    }
-    if (!Command) {
-      ErrorMessage = "Missing key: \"command\" or \"arguments\".";
+      skipWhitespace();
+    } while (consume(','));
+    if (!consume('}') || !HasCommand || !HasDirectory || !HasFile)
       return false;
-    }
-    if (!Directory) {
-      ErrorMessage = "Missing key: \"directory\".";
+    Callback(Buffer.slice(Start, Pos), Directory, File);
+    return true;
+  }
+
+  StringRef Buffer;
+  size_t Pos = 0;
+  std::string Key, Directory, File;
+};
+
+} // namespace
+
+bool JSONCompilationDatabase::scan() {
+  std::vector<std::pair<std::string, StringRef>> Entries;
+  JSONDatabaseScanner Scanner(Database->getBuffer());
+  if (!Scanner.scan([&](StringRef Object, StringRef Directory, StringRef File) {
+        SmallString<128> NativeFilePath;
+        getNativeFilePath(Directory, File, NativeFilePath);
+        Entries.emplace_back(NativeFilePath.str(), Object);
+      }))
+    return false;
+
+  AllCommands.reserve(Entries.size());
+  for (const auto &Entry : Entries) {
+    CompileCommandRef Cmd;
+    Cmd.Object = Entry.second;
+    IndexByFile[Entry.first].push_back(Cmd);
+    AllCommands.push_back(Cmd);
+    MatchTrie.insert(Entry.first);
+  }
+  return true;
+}
+
+bool JSONCompilationDatabase::parse(std::string &ErrorMessage) {
+  if (scan())
+    return true;
+
+  llvm::yaml::document_iterator I = YAMLStream.begin();
+  if (I == YAMLStream.end()) {
+    ErrorMessage = "Error while parsing YAML.";
+    return false;
+  }
+  llvm::yaml::Node *Root = I->getRoot();
+  if (!Root) {
+    ErrorMessage = "Error while parsing YAML.";
+    return false;
+  }
+  auto *Array = dyn_cast<llvm::yaml::SequenceNode>(Root);
+  if (!Array) {
+    ErrorMessage = "Expected array.";
+    return false;
+  }
+  for (auto &NextObject : *Array) {
+    CompileCommandRef Cmd;
+    if (!parseObject(&NextObject, Cmd, ErrorMessage))
       return false;
-    }
+    SmallString<8> DirectoryStorage;
     SmallString<8> FileStorage;
-    StringRef FileName = File->getValue(FileStorage);
     SmallString<128> NativeFilePath;
-    if (llvm::sys::path::is_relative(FileName)) {
-      SmallString<8> DirectoryStorage;
-      SmallString<128> AbsolutePath(
-          Directory->getValue(DirectoryStorage));
-      llvm::sys::path::append(AbsolutePath, FileName);
-      llvm::sys::path::native(AbsolutePath, NativeFilePath);
-    } else {
-      llvm::sys::path::native(FileName, NativeFilePath);
-    }
-    auto Cmd = CompileCommandRef(Directory, File, *Command, Output);
+    getNativeFilePath(Cmd.Directory->getValue(DirectoryStorage),
+                      Cmd.File->getValue(FileStorage), NativeFilePath);
     IndexByFile[NativeFilePath].push_back(Cmd);
     AllCommands.push_back(Cmd);
     MatchTrie.insert(NativeFilePath);
@@ -0,0 +1,148 @@
+//===--- USRIndex.cpp - Clang refactoring library -------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Provides an index of the symbols that each translation unit mentions.
+///
+//===----------------------------------------------------------------------===//
+
+#include "clang/Tooling/Refactoring/Rename/USRIndex.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Frontend/FrontendAction.h"
+#include "clang/Index/IndexDataConsumer.h"
+#include "clang/Index/IndexingAction.h"
+#include "clang/Tooling/Refactoring/Rename/USRFinder.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/LineIterator.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace clang {
+namespace tooling {
+
+namespace {
+
+// Collects the USRs of all declarations that a translation unit declares or
+// references, and hands them to the builder once the translation unit is done.
+class USRCollector : public index::IndexDataConsumer {
+public:
+  USRCollector(USRIndexBuilder &Builder) : Builder(Builder) {}
+
+  void initialize(ASTContext &Ctx) override { Context = &Ctx; }
+
+  bool handleDeclOccurence(const Decl *D, index::SymbolRoleSet Roles,
+                           ArrayRef<index::SymbolRelation> Relations,
+                           SourceLocation Loc, ASTNodeInfo ASTNode) override {
+    std::string USR = getUSRForDecl(D);
+    if (!USR.empty())
+      USRs.insert(std::move(USR));
+    return true;
+  }
+
+  void finish() override {
+    if (!Context)
+      return;
+    const SourceManager &SM = Context->getSourceManager();
+    const FileEntry *MainFile = SM.getFileEntryForID(SM.getMainFileID());
+    if (!MainFile)
+      return;
+    SmallString<256> Path(MainFile->getName());
+    llvm::sys::fs::make_absolute(Path);
+    Builder.addTranslationUnit(Path, std::move(USRs));
+  }
+
+private:
+  USRIndexBuilder &Builder;
+  ASTContext *Context = nullptr;
+  std::set<std::string> USRs;
+};
+
+// Makes a path absolute, as the index records them.
+std::string makeAbsolute(StringRef File) {
+  SmallString<256> Path(File);
+  llvm::sys::fs::make_absolute(Path);
+  return Path.str();
+}
+
+} // end anonymous namespace
+
+std::unique_ptr<FrontendAction> USRIndexBuilder::newIndexingAction() {
+  index::IndexingOptions Opts;
+  // A rename also touches locals and symbols declared in system headers.
+  Opts.SystemSymbolFilter = index::IndexingOptions::SystemSymbolFilterKind::All;
+  Opts.IndexFunctionLocals = true;
+  return index::createIndexingAction(std::make_shared<USRCollector>(*this),
+                                     Opts, /*WrappedAction=*/nullptr);
+}
+
+void USRIndexBuilder::addTranslationUnit(StringRef MainFile,
+                                         std::set<std::string> USRs) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  std::set<std::string> &Existing = USRsByFile[MainFile];
+  if (Existing.empty())
+    Existing = std::move(USRs);
+  else
+    Existing.insert(USRs.begin(), USRs.end());
+}
+
+void USRIndexBuilder::write(llvm::raw_ostream &OS) const {
+  for (const auto &Entry : USRsByFile) {
+    OS << "F " << Entry.first << '\n';
+    for (const std::string &USR : Entry.second)
+      OS << "U " << USR << '\n';
+  }
+}
+
+llvm::Expected<std::vector<std::string>>
+selectFilesFromUSRIndex(StringRef IndexPath, ArrayRef<std::string> Files,
+                        ArrayRef<std::vector<std::string>> USRList) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(IndexPath);
+  if (!Buffer)
+    return llvm::make_error<llvm::StringError>(
+        "failed to read USR index " + IndexPath, Buffer.getError());
+
+  llvm::StringSet<> USRs;
+  for (const auto &USRsOfSymbol : USRList)
+    for (const std::string &USR : USRsOfSymbol)
+      USRs.insert(USR);
+
+  // The files the index covers, and whether each of them mentions a USR.
+  llvm::StringMap<bool> Covered;
+  bool *Current = nullptr;
+  for (llvm::line_iterator Line(**Buffer, /*SkipBlanks=*/true);
+       !Line.is_at_end(); ++Line) {
+    StringRef Text = *Line;
+    if (Text.startswith("F ")) {
+      Current = &Covered[Text.drop_front(2)];
+    } else if (Text.startswith("U ") && Current) {
+      if (!*Current && USRs.count(Text.drop_front(2)))
+        *Current = true;
+    } else {
+      return llvm::make_error<llvm::StringError>(
+          "malformed USR index " + IndexPath + " at line " +
+              Twine(Line.line_number()),
+          llvm::inconvertibleErrorCode());
+    }
+  }
+
+  std::vector<std::string> Result;
+  for (const std::string &File : Files) {
+    auto It = Covered.find(makeAbsolute(File));
+    if (It == Covered.end() || It->second)
+      Result.push_back(File);
+  }
+  return Result;
+}
+
+} // end namespace tooling
+} // end namespace clang
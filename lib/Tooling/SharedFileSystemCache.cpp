@@ -0,0 +1,181 @@
+//===--- SharedFileSystemCache.cpp - Cross-TU file cache ------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Tooling/SharedFileSystemCache.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/Path.h"
+
+using namespace clang;
+using namespace tooling;
+
+SharedFileSystemCache::Shard &
+SharedFileSystemCache::getShard(StringRef AbsolutePath) {
+  return Shards[llvm::hash_value(AbsolutePath) % NumShards];
+}
+
+const SharedFileSystemCache::Entry *
+SharedFileSystemCache::lookup(StringRef AbsolutePath) {
+  Shard &S = getShard(AbsolutePath);
+  std::lock_guard<std::mutex> LockGuard(S.Lock);
+  auto It = S.Entries.find(AbsolutePath);
+  return It == S.Entries.end() ? nullptr : It->second.get();
+}
+
+const SharedFileSystemCache::Entry *
+SharedFileSystemCache::insert(StringRef AbsolutePath, llvm::vfs::Status Stat) {
+  Shard &S = getShard(AbsolutePath);
+  std::lock_guard<std::mutex> LockGuard(S.Lock);
+  std::unique_ptr<Entry> &E = S.Entries[AbsolutePath];
+  if (!E)
+    E = llvm::make_unique<Entry>(std::move(Stat));
+  return E.get();
+}
+
+const llvm::MemoryBuffer *
+SharedFileSystemCache::setContents(const Entry *E, StringRef AbsolutePath,
+                                   std::unique_ptr<llvm::MemoryBuffer> Contents) {
+  Shard &S = getShard(AbsolutePath);
+  std::lock_guard<std::mutex> LockGuard(S.Lock);
+  if (!E->Contents)
+    E->Contents = std::move(Contents);
+  return E->Contents.get();
+}
+
+const llvm::MemoryBuffer *
+SharedFileSystemCache::getContents(const Entry *E, StringRef AbsolutePath) {
+  Shard &S = getShard(AbsolutePath);
+  std::lock_guard<std::mutex> LockGuard(S.Lock);
+  return E->Contents.get();
+}
+
+namespace {
+
+/// A file whose contents live in a \c SharedFileSystemCache.
+class CachedFile : public llvm::vfs::File {
+  llvm::vfs::Status Stat;
+  const llvm::MemoryBuffer *Contents;
+
+public:
+  CachedFile(llvm::vfs::Status Stat, const llvm::MemoryBuffer *Contents)
+      : Stat(std::move(Stat)), Contents(Contents) {}
+
+  llvm::ErrorOr<llvm::vfs::Status> status() override { return Stat; }
+
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>
+  getBuffer(const Twine &Name, int64_t FileSize, bool RequiresNullTerminator,
+            bool IsVolatile) override {
+    // The cached buffer is always null terminated, and outlives every file
+    // system that refers to the cache.
+    return llvm::MemoryBuffer::getMemBuffer(Contents->getBuffer(), Name.str(),
+                                            RequiresNullTerminator);
+  }
+
+  std::error_code close() override { return std::error_code(); }
+};
+
+} // end anonymous namespace
+
+SharedCachingFileSystem::SharedCachingFileSystem(
+    std::shared_ptr<SharedFileSystemCache> Cache,
+    IntrusiveRefCntPtr<llvm::vfs::FileSystem> FS)
+    : Cache(std::move(Cache)), FS(std::move(FS)) {
+  if (auto CWD = this->FS->getCurrentWorkingDirectory())
+    WorkingDirectory = *CWD;
+}
+
+void SharedCachingFileSystem::makeAbsolutePath(
+    const Twine &Path, SmallVectorImpl<char> &Result) const {
+  Path.toVector(Result);
+  if (!llvm::sys::path::is_absolute(Result) && !WorkingDirectory.empty()) {
+    SmallString<256> Absolute(WorkingDirectory);
+    llvm::sys::path::append(Absolute, Result);
+    Result.assign(Absolute.begin(), Absolute.end());
+  }
+  llvm::sys::path::remove_dots(Result, /*remove_dot_dot=*/false);
+}
+
+llvm::ErrorOr<const SharedFileSystemCache::Entry *>
+SharedCachingFileSystem::getOrCreateEntry(StringRef Path) {
+  if (const SharedFileSystemCache::Entry *E = Cache->lookup(Path))
+    return E;
+
+  llvm::ErrorOr<llvm::vfs::Status> Stat = FS->status(Path);
+  if (!Stat)
+    return Stat.getError();
+  return Cache->insert(Path, std::move(*Stat));
+}
+
+llvm::ErrorOr<llvm::vfs::Status>
+SharedCachingFileSystem::status(const Twine &Path) {
+  SmallString<256> AbsPath;
+  makeAbsolutePath(Path, AbsPath);
+  auto E = getOrCreateEntry(AbsPath);
+  if (!E)
+    return E.getError();
+  return llvm::vfs::Status::copyWithNewName((*E)->Stat, Path.str());
+}
+
+llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>>
+SharedCachingFileSystem::openFileForRead(const Twine &Path) {
+  SmallString<256> AbsPath;
+  makeAbsolutePath(Path, AbsPath);
+  auto E = getOrCreateEntry(AbsPath);
+  if (!E)
+    return E.getError();
+
+  // Only the contents of regular files are shared.
+  if (!(*E)->Stat.isRegularFile())
+    return FS->openFileForRead(AbsPath);
+
+  const llvm::MemoryBuffer *Contents = Cache->getContents(*E, AbsPath);
+  if (!Contents) {
+    auto File = FS->openFileForRead(AbsPath);
+    if (!File)
+      return File.getError();
+    auto Buffer = (*File)->getBuffer(AbsPath);
+    if (!Buffer)
+      return Buffer.getError();
+    Contents = Cache->setContents(*E, AbsPath, std::move(*Buffer));
+  }
+
+  return std::unique_ptr<llvm::vfs::File>(new CachedFile(
+      llvm::vfs::Status::copyWithNewName((*E)->Stat, Path.str()), Contents));
+}
+
+llvm::vfs::directory_iterator
+SharedCachingFileSystem::dir_begin(const Twine &Dir, std::error_code &EC) {
+  SmallString<256> AbsPath;
+  makeAbsolutePath(Dir, AbsPath);
+  return FS->dir_begin(AbsPath, EC);
+}
+
+std::error_code
+SharedCachingFileSystem::setCurrentWorkingDirectory(const Twine &Path) {
+  // The working directory is kept here rather than forwarded, so that
+  // instances sharing the underlying file system across threads do not race
+  // on it.
+  SmallString<256> AbsPath;
+  makeAbsolutePath(Path, AbsPath);
+  WorkingDirectory = AbsPath.str();
+  return std::error_code();
+}
+
+llvm::ErrorOr<std::string>
+SharedCachingFileSystem::getCurrentWorkingDirectory() const {
+  return WorkingDirectory;
+}
+
+std::error_code
+SharedCachingFileSystem::getRealPath(const Twine &Path,
+                                     SmallVectorImpl<char> &Output) const {
+  SmallString<256> AbsPath;
+  makeAbsolutePath(Path, AbsPath);
+  return FS->getRealPath(AbsPath, Output);
+}
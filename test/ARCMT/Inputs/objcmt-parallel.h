@@ -0,0 +1,13 @@
+@interface NSObject
+@end
+
+@interface NSNumber : NSObject
+@end
+
+@interface NSNumber (NSNumberCreation)
++ (NSNumber *)numberWithInt:(int)value;
+@end
+
+static inline NSNumber *one(void) {
+  return [NSNumber numberWithInt:1];
+}
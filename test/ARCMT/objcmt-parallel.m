@@ -0,0 +1,8 @@
+// REQUIRES: shell
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: echo '[{"directory": "%/S/Inputs", "command": "clang -target x86_64-apple-macosx10.9 -x objective-c -objcmt-migrate-literals -c objcmt-parallel1.m.in", "file": "objcmt-parallel1.m.in"}, {"directory": "%/S/Inputs", "command": "clang -target x86_64-apple-macosx10.9 -x objective-c -objcmt-migrate-literals -c objcmt-parallel2.m.in", "file": "objcmt-parallel2.m.in"}]' > %t/compile_commands.json
+// RUN: clang-objcmt -executor=all-TUs -execute-concurrency=2 -migrate-directory=%t/migrated %t/compile_commands.json
+// RUN: c-arcmt-test -mt-migrate-directory %t/migrated | arcmt-test -verify-transformed-files %S/Inputs/objcmt-parallel1.m.in.result %S/Inputs/objcmt-parallel2.m.in.result %S/Inputs/objcmt-parallel.h.result
+
+// Both translation units migrate the literal in the shared header the same
+// way; the merged remappings rewrite it once.
@@ -0,0 +1,32 @@
+// RUN: %clang_analyze_cc1 -analyzer-checker=core,debug.ExprInspection -analyzer-config graph-trim-interval=1,aggressive-graph-trimming=true -verify %s
+
+void clang_analyzer_eval(int);
+
+struct S {
+  int X, Y;
+};
+
+int sum(struct S *P) {
+  // The nodes for the lvalues in the middle of the path may be reclaimed,
+  // but the values loaded from them must not be lost.
+  int A = P->X;
+  int B = P->Y;
+  return A + B;
+}
+
+void testValuesSurviveTrimming() {
+  struct S S = {1, 2};
+  int Arr[4] = {0};
+  for (int I = 0; I != 4; ++I)
+    Arr[I] = sum(&S) + I;
+  clang_analyzer_eval(Arr[3] == 6); // expected-warning{{TRUE}}
+  clang_analyzer_eval(S.X == 1 && S.Y == 2); // expected-warning{{TRUE}}
+}
+
+void testNullDereference(int *P) {
+  int *Q = P;
+  (void)Q;
+  if (P)
+    return;
+  *Q = 1; // expected-warning{{Dereference of null pointer}}
+}
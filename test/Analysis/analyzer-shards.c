@@ -0,0 +1,39 @@
+// RUN: %clang_analyze_cc1 -analyzer-checker=core,deadcode.DeadStores -verify -DSHARD0 -DSHARD1 %s
+// RUN: %clang_analyze_cc1 -analyzer-checker=core,deadcode.DeadStores -analyzer-config shard-count=2,shard-index=0 -verify -DSHARD0 %s
+// RUN: %clang_analyze_cc1 -analyzer-checker=core,deadcode.DeadStores -analyzer-config shard-count=2,shard-index=1 -verify -DSHARD1 %s
+
+// The two functions that call each other are the largest group and go to the
+// first shard. The unrelated functions then both go to the second shard,
+// which has fewer functions. Syntax-based checks only run in the first shard.
+
+static void derefCallee(int *p) {
+  *p = 1;
+#ifdef SHARD0
+  // expected-warning@-2 {{Dereference of null pointer}}
+#endif
+}
+
+void derefCaller() {
+  derefCallee(0);
+}
+
+void unrelated1() {
+  int *p = 0;
+  *p = 2;
+#ifdef SHARD1
+  // expected-warning@-2 {{Dereference of null pointer}}
+#endif
+}
+
+void unrelated2(int *p) {
+  int x = 1;
+#ifdef SHARD0
+  // expected-warning@-2 {{never read}}
+#endif
+  if (p)
+    return;
+  *p = 3;
+#ifdef SHARD1
+  // expected-warning@-2 {{Dereference of null pointer}}
+#endif
+}
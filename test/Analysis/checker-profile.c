@@ -0,0 +1,29 @@
+// RUN: %clang_analyze_cc1 -analyzer-checker=core,unix.Malloc -analyzer-config checker-profile=text %s 2>&1 | FileCheck %s --check-prefix=TEXT
+// RUN: %clang_analyze_cc1 -analyzer-checker=core,unix.Malloc -analyzer-config checker-profile=json %s 2>&1 | FileCheck %s --check-prefix=JSON
+// RUN: %clang_analyze_cc1 -analyzer-checker=core,unix.Malloc %s 2>&1 | FileCheck %s --check-prefix=NONE --allow-empty
+
+void *malloc(unsigned long);
+void free(void *);
+
+int test(int X) {
+  int *P = malloc(sizeof(int));
+  if (!P)
+    return 0;
+  *P = X;
+  int Y = *P;
+  free(P);
+  return Y;
+}
+
+// TEXT: Checker Profile
+// TEXT: Wall Time    User Time       Memory  Callbacks      Nodes     States  Checker
+// TEXT-DAG: {{[0-9.]+ +[0-9.]+ +-?[0-9]+ +[1-9][0-9]* +[0-9]+ +[0-9]+}}  core.NullDereference
+// TEXT-DAG: {{[0-9.]+ +[0-9.]+ +-?[0-9]+ +[1-9][0-9]* +[1-9][0-9]* +[1-9][0-9]*}}  unix.Malloc
+
+// JSON: {
+// JSON-NEXT: "checkers": [
+// JSON-DAG: { "name": "unix.Malloc", "wall_time": {{[0-9.]+}}, "user_time": {{[0-9.]+}}, "system_time": {{[0-9.]+}}, "memory": {{-?[0-9]+}}, "callbacks": {{[1-9][0-9]*}}, "nodes": {{[1-9][0-9]*}}, "state_changes": {{[1-9][0-9]*}} }
+// JSON-DAG: { "name": "core.NullDereference",
+
+// NONE-NOT: Checker Profile
+// NONE-NOT: "checkers"
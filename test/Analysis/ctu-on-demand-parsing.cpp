@@ -0,0 +1,31 @@
+// REQUIRES: shell
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: sed 's| \(.*\)\.ast$| %S/Inputs/\1|' %S/Inputs/externalFnMap.txt > %t/externalFnMap.txt
+// RUN: echo '[{"directory": "%S/Inputs", "command": "clang++ --target=x86_64-pc-linux-gnu -c ctu-other.cpp", "file": "ctu-other.cpp"}, {"directory": "%S/Inputs", "command": "clang++ --target=x86_64-pc-linux-gnu -c ctu-chain.cpp", "file": "ctu-chain.cpp"}]' > %t/compile_commands.json
+// RUN: %clang_cc1 -triple x86_64-pc-linux-gnu -fsyntax-only -analyze -analyzer-checker=core,debug.ExprInspection -analyzer-config experimental-enable-naive-ctu-analysis=true -analyzer-config ctu-dir=%t -analyzer-config ctu-compilation-database=%t -analyzer-config ctu-ast-cache-dir=%t/cache -verify %s
+// RUN: ls %t/cache | FileCheck -check-prefix=CACHE %s
+// Load the translation units from the AST cache this time.
+// RUN: %clang_cc1 -triple x86_64-pc-linux-gnu -fsyntax-only -analyze -analyzer-checker=core,debug.ExprInspection -analyzer-config experimental-enable-naive-ctu-analysis=true -analyzer-config ctu-dir=%t -analyzer-config ctu-compilation-database=%t -analyzer-config ctu-ast-cache-dir=%t/cache -verify %s
+
+// CACHE: ctu-chain.cpp-{{[0-9a-f]+}}.ast
+// CACHE: ctu-other.cpp-{{[0-9a-f]+}}.ast
+
+void clang_analyzer_eval(int);
+
+int f(int);
+int g(int);
+int h(int);
+
+int callback_to_main(int x) { return x + 1; }
+
+namespace chns {
+int chf1(int x);
+}
+
+int main() {
+  clang_analyzer_eval(f(3) == 2); // expected-warning{{TRUE}}
+  clang_analyzer_eval(f(5) == 3); // expected-warning{{FALSE}}
+  clang_analyzer_eval(g(4) == 6); // expected-warning{{TRUE}}
+  clang_analyzer_eval(h(2) == 8); // expected-warning{{TRUE}}
+  clang_analyzer_eval(chns::chf1(4) == 12); // expected-warning{{TRUE}}
+}
@@ -0,0 +1,42 @@
+// RUN: rm -f %t.plist
+// RUN: %clang_analyze_cc1 -analyzer-checker=core -analyzer-config stream-diagnostics=true -analyzer-output=plist -o %t.plist %s
+// RUN: FileCheck --input-file=%t.plist -check-prefix=PLIST %s
+// RUN: %clang_analyze_cc1 -analyzer-checker=core -analyzer-config stream-diagnostics=true -analyzer-output=sarif -o - %s | FileCheck -check-prefix=SARIF %s
+
+// With stream-diagnostics, each report is written as soon as it is found and
+// the file table follows all of them.
+
+int first(void) {
+  int *p = 0;
+  return *p;
+}
+
+int second(void) {
+  int *p = 0;
+  return *p + 1;
+}
+
+// PLIST: <key>diagnostics</key>
+// PLIST: <key>description</key><string>Dereference of null pointer (loaded from variable &apos;p&apos;)</string>
+// PLIST: <key>check_name</key><string>core.NullDereference</string>
+// PLIST: <key>description</key><string>Dereference of null pointer (loaded from variable &apos;p&apos;)</string>
+// PLIST: <key>check_name</key><string>core.NullDereference</string>
+// PLIST: <key>files</key>
+// PLIST-NEXT: <array>
+// PLIST-NEXT: <string>{{.*}}stream-diagnostics.c</string>
+// PLIST-NEXT: </array>
+// PLIST: </plist>
+
+// SARIF: "$schema": "http://json.schemastore.org/sarif-2.0.0-csd.2.beta.2018-10-10",
+// SARIF: "runs": [
+// SARIF: "results": [
+// SARIF: "ruleId": "core.NullDereference"
+// SARIF: "ruleId": "core.NullDereference"
+// SARIF: "files": {
+// SARIF: stream-diagnostics.c": {
+// SARIF: "resources": {
+// SARIF-NEXT: "rules": {
+// SARIF-NEXT: "core.NullDereference": {
+// SARIF: "tool": {
+// SARIF: "name": "clang"
+// SARIF: "version": "2.0.0-csd.2.beta.2018-10-10"
@@ -1,6 +1,8 @@
 // RUN: rm -f %t
 // RUN: %clang_analyze_cc1 -analyzer-checker=debug.DumpDominators %s > %t 2>&1
 // RUN: FileCheck --input-file=%t %s
+// RUN: %clang_analyze_cc1 -analyzer-checker=debug.DumpPostDominators %s > %t.post 2>&1
+// RUN: FileCheck --check-prefix=POSTDOM --input-file=%t.post %s
 
 // Test the DominatorsTree implementation with various control flows
 int test1()
@@ -36,6 +38,18 @@ int test1()
 // CHECK: (8,9)
 // CHECK: (9,9)
 
+// POSTDOM: Immediate post dominance tree (Node#,IDom#):
+// POSTDOM: (0,0)
+// POSTDOM: (1,0)
+// POSTDOM: (2,7)
+// POSTDOM: (3,2)
+// POSTDOM: (4,3)
+// POSTDOM: (5,3)
+// POSTDOM: (6,3)
+// POSTDOM: (7,1)
+// POSTDOM: (8,7)
+// POSTDOM: (9,8)
+
 int test2()
 {
   int x,y,z;
@@ -165,4 +179,56 @@ int test5()
 // CHECK: (10,11)
 // CHECK: (11,11)
 
+// The edges that are known never to be taken are null successors and
+// predecessors, which the builder of the trees must skip.
+int test6(int x)
+{
+  while (1) {
+    if (x > 5)
+      break;
+    x++;
+  }
+  return x;
+}
 
+// CHECK: Immediate dominance tree (Node#,IDom#):
+// CHECK-NEXT: (0,1)
+// CHECK-NEXT: (1,4)
+// CHECK-NEXT: (2,3)
+// CHECK-NEXT: (3,5)
+// CHECK-NEXT: (4,5)
+// CHECK-NEXT: (5,6)
+// CHECK-NEXT: (6,7)
+// CHECK-NEXT: (7,7)
+
+// POSTDOM: Immediate post dominance tree (Node#,IDom#):
+// POSTDOM-NEXT: (0,0)
+// POSTDOM-NEXT: (1,0)
+// POSTDOM-NEXT: (2,6)
+// POSTDOM-NEXT: (3,2)
+// POSTDOM-NEXT: (4,1)
+// POSTDOM-NEXT: (5,4)
+// POSTDOM-NEXT: (6,5)
+// POSTDOM-NEXT: (7,6)
+
+// The then branch is unreachable from the entry, so it is not in the
+// dominators tree.
+int test7(int x)
+{
+  if (0)
+    x = 1;
+  return x;
+}
+
+// CHECK: Immediate dominance tree (Node#,IDom#):
+// CHECK-NEXT: (0,1)
+// CHECK-NEXT: (1,3)
+// CHECK-NEXT: (3,4)
+// CHECK-NEXT: (4,4)
+
+// POSTDOM: Immediate post dominance tree (Node#,IDom#):
+// POSTDOM-NEXT: (0,0)
+// POSTDOM-NEXT: (1,0)
+// POSTDOM-NEXT: (2,1)
+// POSTDOM-NEXT: (3,1)
+// POSTDOM-NEXT: (4,3)
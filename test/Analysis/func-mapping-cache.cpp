@@ -0,0 +1,18 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: cp %s %t/cached.cpp
+// RUN: %clang_func_map -cache-dir=%t/cache %t/cached.cpp -- 2>%t/first.err | FileCheck %s
+// RUN: FileCheck -check-prefix=MAPPED -input-file=%t/first.err %s
+// RUN: %clang_func_map -cache-dir=%t/cache %t/cached.cpp -- 2>%t/second.err | FileCheck %s
+// RUN: count 0 < %t/second.err
+// RUN: echo 'int g() { return 1; }' >> %t/cached.cpp
+// RUN: %clang_func_map -cache-dir=%t/cache %t/cached.cpp -- 2>%t/third.err | FileCheck -check-prefix=CHANGED %s
+// RUN: FileCheck -check-prefix=MAPPED -input-file=%t/third.err %s
+
+int f(int) {
+  return 0;
+}
+
+// CHECK: c:@F@f#I#
+// CHANGED-DAG: c:@F@f#I#
+// CHANGED-DAG: c:@F@g#
+// MAPPED: Processing file {{.*}}cached.cpp
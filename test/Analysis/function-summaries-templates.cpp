@@ -0,0 +1,32 @@
+// RUN: rm -f %t.summaries
+// RUN: %clang_analyze_cc1 -analyzer-checker=core -verify=warn %s \
+// RUN:   -analyzer-config function-summary-file=%t.summaries
+// RUN: FileCheck --input-file=%t.summaries %s
+// RUN: %clang_analyze_cc1 -analyzer-checker=core -verify=none %s \
+// RUN:   -analyzer-config function-summary-file=%t.summaries
+// RUN: %clang_analyze_cc1 -analyzer-checker=core -verify=warn %s -DCHANGED \
+// RUN:   -analyzer-config function-summary-file=%t.summaries
+
+// Functions that call template instantiations are summarized too, and are
+// analyzed again once the body of the instantiation changes.
+
+// none-no-diagnostics
+
+// CHECK: clang-analyzer-function-summaries
+// CHECK-DAG: c:@F@derefNull
+// CHECK-DAG: c:@F@get
+
+#ifdef CHANGED
+#define EXTRA (void)0;
+#else
+#define EXTRA
+#endif
+
+template <typename T> int get(T *P) {
+  EXTRA return *P; // warn-warning {{Dereference of null pointer}}
+}
+
+int derefNull() {
+  int *P = 0;
+  return get(P);
+}
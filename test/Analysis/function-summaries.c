@@ -0,0 +1,27 @@
+// RUN: rm -f %t.summaries
+// RUN: %clang_analyze_cc1 -analyzer-checker=core -verify %s \
+// RUN:   -analyzer-config function-summary-file=%t.summaries
+// RUN: FileCheck --input-file=%t.summaries %s
+// RUN: %clang_analyze_cc1 -analyzer-checker=core -verify %s -DSECOND \
+// RUN:   -analyzer-config function-summary-file=%t.summaries
+
+// The second invocation sees the same functions, so it skips them and reports
+// nothing.
+
+// CHECK: clang-analyzer-function-summaries
+// CHECK-DAG: c:@F@derefNull
+// CHECK-DAG: c:@F@callee
+
+int callee(int *P) {
+  return *P;
+}
+
+int derefNull() {
+  int *P = 0;
+  return callee(P);
+#ifndef SECOND
+  // expected-warning@-7 {{Dereference of null pointer}}
+#else
+  // expected-no-diagnostics
+#endif
+}
@@ -0,0 +1,25 @@
+// Every report in a file gets the same syntax and macro highlighting, even
+// though the highlighting is only computed for the first one.
+
+#define DEREF(p) (*(p))
+
+int first(void) {
+  int *p = 0;
+  return DEREF(p);
+}
+
+int second(void) {
+  int *q = 0;
+  return DEREF(q);
+}
+
+// RUN: rm -rf %t.output
+// RUN: %clang_analyze_cc1 -analyze -analyzer-checker=core -analyzer-output html -o %t.output %s
+// RUN: ls %t.output | count 2
+// RUN: cat %t.output/* | FileCheck %s
+// CHECK: <span class='keyword'>int</span> first
+// CHECK: <span class='macro'>DEREF(p)<span class='expansion'>(*(p))</span></span>
+// CHECK: <span class='macro'>DEREF(q)<span class='expansion'>(*(q))</span></span>
+// CHECK: <span class='keyword'>int</span> first
+// CHECK: <span class='macro'>DEREF(p)<span class='expansion'>(*(p))</span></span>
+// CHECK: <span class='macro'>DEREF(q)<span class='expansion'>(*(q))</span></span>
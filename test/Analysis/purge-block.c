@@ -0,0 +1,19 @@
+// RUN: %clang_analyze_cc1 -analyzer-checker=debug.ExprInspection -verify=stmt %s
+// RUN: %clang_analyze_cc1 -analyzer-checker=debug.ExprInspection -analyzer-purge=statement -verify=stmt %s
+// RUN: %clang_analyze_cc1 -analyzer-checker=debug.ExprInspection -analyzer-purge=block -verify=block %s
+
+void clang_analyzer_warnOnDeadSymbol(int);
+int conjure();
+void use();
+
+// With -analyzer-purge=block, symbols die at the beginning of the next basic
+// block rather than before the next statement.
+void test_purge_point(int c) {
+  int x = conjure();
+  clang_analyzer_warnOnDeadSymbol(x);
+  use(); // stmt-warning{{SYMBOL DEAD}}
+  if (c)
+    use(); // block-warning{{SYMBOL DEAD}}
+  else
+    use(); // block-warning{{SYMBOL DEAD}}
+}
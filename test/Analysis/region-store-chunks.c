@@ -0,0 +1,42 @@
+// RUN: %clang_analyze_cc1 -analyzer-checker=core,debug.ExprInspection -verify %s
+// RUN: %clang_analyze_cc1 -analyzer-checker=core,debug.ExprInspection -verify %s \
+// RUN:   -analyzer-config region-store-min-chunked-array-size=0
+
+// Long initializers of integer constants are bound as a single chunk. Check
+// that elements read from a chunk have the same values as elements bound one
+// by one.
+
+void clang_analyzer_eval(int);
+
+void table() {
+  int T[20] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17};
+  clang_analyzer_eval(T[0] == 0); // expected-warning{{TRUE}}
+  clang_analyzer_eval(T[17] == 17); // expected-warning{{TRUE}}
+  clang_analyzer_eval(T[19] == 0); // expected-warning{{TRUE}}
+
+  T[5] = 42;
+  clang_analyzer_eval(T[5] == 42); // expected-warning{{TRUE}}
+  clang_analyzer_eval(T[4] == 4); // expected-warning{{TRUE}}
+  clang_analyzer_eval(T[6] == 6); // expected-warning{{TRUE}}
+}
+
+void nested() {
+  char T[2][16] = {{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16},
+                   {'a'}};
+  clang_analyzer_eval(T[0][15] == 16); // expected-warning{{TRUE}}
+  clang_analyzer_eval(T[1][0] == 'a'); // expected-warning{{TRUE}}
+  clang_analyzer_eval(T[1][1] == 0); // expected-warning{{TRUE}}
+}
+
+struct Table {
+  int Entries[16];
+};
+
+void copy() {
+  struct Table X = {{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16}};
+  struct Table Y = X;
+  X.Entries[3] = 0;
+  clang_analyzer_eval(X.Entries[3] == 0); // expected-warning{{TRUE}}
+  clang_analyzer_eval(Y.Entries[3] == 4); // expected-warning{{TRUE}}
+  clang_analyzer_eval(Y.Entries[15] == 16); // expected-warning{{TRUE}}
+}
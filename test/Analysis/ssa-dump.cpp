@@ -0,0 +1,18 @@
+// RUN: %clang_analyze_cc1 -analyzer-checker=debug.DumpSSA %s 2>&1 | FileCheck %s
+
+int sum(int n) {
+  int x = 0;
+  while (n > 0) {
+    x = x + n;
+    n = n - 1;
+  }
+  return x;
+}
+
+// The loop header merges the values of 'x' and 'n' from the entry and the
+// back edge.
+// CHECK-LABEL: CFG {
+// CHECK: phi(
+// CHECK: branch (
+// CHECK: goto BB_
+// CHECK: }
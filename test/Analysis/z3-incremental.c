@@ -0,0 +1,44 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,debug.ExprInspection -analyzer-constraints=z3 -verify %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,debug.ExprInspection -analyzer-constraints=z3 -analyzer-config z3-query-timeout=0 -verify %s
+// REQUIRES: z3
+
+// The Z3 solver keeps the constraints of the previous query asserted, and
+// only adds or removes the ones that differ. Check that the constraints of
+// one path do not leak into the queries made on a sibling path.
+
+void clang_analyzer_eval(int);
+
+void siblings(int x, int y) {
+  if (x > 10) {
+    if (y == x)
+      clang_analyzer_eval(y > 10); // expected-warning{{TRUE}}
+    else
+      clang_analyzer_eval(y > 10); // expected-warning{{UNKNOWN}}
+  } else {
+    clang_analyzer_eval(x > 10); // expected-warning{{FALSE}}
+    if (y == x)
+      clang_analyzer_eval(y <= 10); // expected-warning{{TRUE}}
+  }
+}
+
+void nested(int a, int b, int c) {
+  if (a < b) {
+    if (b < c) {
+      clang_analyzer_eval(a < c); // expected-warning{{TRUE}}
+      return;
+    }
+    clang_analyzer_eval(a < c); // expected-warning{{UNKNOWN}}
+  }
+  if (b < c)
+    clang_analyzer_eval(a < c); // expected-warning{{UNKNOWN}}
+}
+
+int onlyValue(int x) {
+  if (x >= 3 && x <= 3) {
+    int *p = 0;
+    if (x != 3)
+      return *p; // no-warning
+    return x;
+  }
+  return 0;
+}
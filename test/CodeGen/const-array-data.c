@@ -0,0 +1,32 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm %s -o - | FileCheck %s
+
+// Tables of numeric literals are emitted as data arrays, including the
+// zeroes at their ends.
+
+// CHECK: @bytes = global [10 x i8] c"\01\02\03\04\05\06\07\08\FF\00", align 1
+unsigned char bytes[10] = {1, 2, 3, 4, 5, 6, 7, 8, -1};
+
+// CHECK: @chars = global [8 x i8] c"abcdefgh", align 1
+char chars[8] = {'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h'};
+
+// CHECK: @shorts = global [8 x i16] [i16 1, i16 -1, i16 3, i16 4, i16 5, i16 6, i16 7, i16 8], align 16
+short shorts[8] = {1, 65535, 3, 4, 5, 6, 7, 8};
+
+// CHECK: @longs = global [8 x i64] [i64 1, i64 2, i64 3, i64 4, i64 5, i64 6, i64 7, i64 -8], align 16
+long longs[8] = {1, 2, 3, 4, 5, 6, 7, -8};
+
+// CHECK: @floats = global [8 x float] [float 1.000000e+00, float 2.500000e+00, float 0.000000e+00, float -0.000000e+00, float 5.000000e+00, float 6.000000e+00, float 7.000000e+00, float 8.000000e+00], align 16
+float floats[8] = {1.0, 2.5f, 0.0, -0.0, 5, 6, 7, 8};
+
+// CHECK: @doubles = global [8 x double] [double 1.000000e+00, double 2.000000e+00, double 3.000000e+00, double 4.000000e+00, double 5.000000e+00, double 6.000000e+00, double 7.000000e+00, double 8.000000e+00], align 16
+double doubles[8] = {1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0};
+
+// CHECK: @zeroes = global [16 x i32] zeroinitializer, align 16
+int zeroes[16] = {0, 0, 0};
+
+// CHECK: @padded = global <{ [8 x i32], [24 x i32] }> <{ [8 x i32] [i32 1, i32 2, i32 3, i32 4, i32 5, i32 6, i32 7, i32 8], [24 x i32] zeroinitializer }>, align 16
+int padded[32] = {1, 2, 3, 4, 5, 6, 7, 8};
+
+// So are folded initializers.
+// CHECK: @folded = global [8 x i32] [i32 2, i32 4, i32 6, i32 8, i32 10, i32 12, i32 14, i32 16], align 16
+int folded[8] = {1 + 1, 2 * 2, 6, 8, 10, 12, 14, 16};
@@ -0,0 +1,11 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -I %S/Inputs %s -o - | FileCheck %s
+
+// CHECK: @data = global [6 x i8] c"embed\0A", align 1
+unsigned char data[] = {
+#embed "embed.txt"
+};
+
+// CHECK: @padded = global [8 x i8] c"embed\0A\00\00", align 1
+char padded[8] = {
+#embed "embed.txt"
+};
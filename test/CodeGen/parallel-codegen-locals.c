@@ -0,0 +1,24 @@
+// REQUIRES: x86-registered-target
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -O1 -emit-obj -parallel-codegen-output %t.a1.o -o %t.a0.o %s
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -O1 -emit-obj -parallel-codegen-output %t.b1.o -o %t.b0.o -DSECOND %s
+// RUN: llvm-nm --defined-only --extern-only %t.a0.o %t.a1.o %t.b0.o %t.b1.o | FileCheck --implicit-check-not=helper --implicit-check-not=counter %s
+
+// Both translation units have a static helper of the same name. It stays
+// local in the partitions of each of them, so that the objects of both link
+// together.
+// CHECK-DAG: T first1
+// CHECK-DAG: T first2
+// CHECK-DAG: T second1
+// CHECK-DAG: T second2
+
+#ifdef SECOND
+#define NAME(N) second##N
+#else
+#define NAME(N) first##N
+#endif
+
+static int counter;
+__attribute__((noinline)) static int helper(int x) { return x + counter++; }
+
+int NAME(1)(int x) { return helper(x) * 2; }
+int NAME(2)(int x) { return helper(x) - 1; }
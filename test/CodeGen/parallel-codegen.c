@@ -0,0 +1,21 @@
+// REQUIRES: x86-registered-target
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -O1 -emit-obj -parallel-codegen-output %t.1.o -parallel-codegen-output %t.2.o -o %t.0.o %s
+// RUN: llvm-nm %t.0.o %t.1.o %t.2.o | FileCheck %s
+//
+// RUN: not %clang_cc1 -triple x86_64-unknown-linux-gnu -S -parallel-codegen-output %t.1.s -o %t.0.s %s 2>&1 | FileCheck --check-prefix=CHECK-ASM %s
+// RUN: not %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-obj -split-dwarf-file %t.dwo -parallel-codegen-output %t.1.o -o %t.0.o %s 2>&1 | FileCheck --check-prefix=CHECK-DWO %s
+
+// Every function is defined in exactly one of the partitions.
+// CHECK-DAG: T f1
+// CHECK-DAG: T f2
+// CHECK-DAG: T f3
+// CHECK-DAG: T f4
+
+// CHECK-ASM: invalid argument '-parallel-codegen-output' only allowed with '-emit-obj'
+// CHECK-DWO: invalid argument '-parallel-codegen-output' not allowed with '-split-dwarf-file'
+
+int g;
+int f1(int x) { return x + g; }
+int f2(int x) { return f1(x) * 2; }
+int f3(int x) { return f2(x) - 1; }
+int f4(int x) { return f3(x) / 3; }
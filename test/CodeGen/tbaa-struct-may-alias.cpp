@@ -0,0 +1,39 @@
+// RUN: %clang_cc1 -triple x86_64-apple-darwin -emit-llvm -o - -O1 %s | \
+// RUN:     FileCheck %s
+//
+// Check that copies of a struct and of a may_alias spelling of it get
+// different tbaa.struct nodes, whichever of them is copied first.
+
+struct A {
+  short s;
+  int i;
+};
+
+typedef A __attribute__((may_alias)) AA;
+
+void copyAA(AA *a1, AA *a2) {
+// CHECK-LABEL: _Z6copyAAP1AS0_
+// CHECK: call void @llvm.memcpy.p0i8.p0i8.i64({{.*}}), !tbaa.struct [[TS_AA:![0-9]*]]
+  *a1 = *a2;
+}
+
+void copyA(A *a1, A *a2) {
+// CHECK-LABEL: _Z5copyAP1AS0_
+// CHECK: call void @llvm.memcpy.p0i8.p0i8.i64({{.*}}), !tbaa.struct [[TS_A:![0-9]*]]
+  *a1 = *a2;
+}
+
+void copyAAAgain(AA *a1, AA *a2) {
+// CHECK-LABEL: _Z11copyAAAgainP1AS0_
+// CHECK: call void @llvm.memcpy.p0i8.p0i8.i64({{.*}}), !tbaa.struct [[TS_AA]]
+  *a1 = *a2;
+}
+
+// CHECK-DAG: [[TS_AA]] = !{i64 0, i64 2, [[TAG_CHAR:![0-9]*]], i64 4, i64 4, [[TAG_CHAR]]}
+// CHECK-DAG: [[TS_A]] = !{i64 0, i64 2, [[TAG_SHORT:![0-9]*]], i64 4, i64 4, [[TAG_INT:![0-9]*]]}
+// CHECK-DAG: [[TAG_CHAR]] = !{[[CHAR:![0-9]*]], [[CHAR]], i64 0}
+// CHECK-DAG: [[CHAR]] = !{!"omnipotent char", {{.*}}}
+// CHECK-DAG: [[TAG_SHORT]] = !{[[SHORT:![0-9]*]], [[SHORT]], i64 0}
+// CHECK-DAG: [[SHORT]] = !{!"short", [[CHAR]], i64 0}
+// CHECK-DAG: [[TAG_INT]] = !{[[INT:![0-9]*]], [[INT]], i64 0}
+// CHECK-DAG: [[INT]] = !{!"int", [[CHAR]], i64 0}
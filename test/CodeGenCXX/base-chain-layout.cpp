@@ -0,0 +1,27 @@
+// RUN: %clang_cc1 %s -triple x86_64-unknown-linux-gnu -emit-llvm -o - | FileCheck %s
+
+// A chain of bases converted while another record is being laid out, with
+// pointers from each level back to the outer record.
+
+struct Outer;
+
+template <int N> struct Chain : Chain<N - 1> {
+  Outer *Back;
+  int Value;
+};
+
+template <> struct Chain<0> {
+  Outer *Back;
+};
+
+struct Outer {
+  Chain<4> *Link;
+  int Count;
+} O;
+
+// CHECK-DAG: %struct.Outer = type { %struct.Chain*, i32 }
+// CHECK-DAG: %struct.Chain = type { %struct.Chain.0, %struct.Outer*, i32 }
+// CHECK-DAG: %struct.Chain.0 = type { %struct.Chain.1, %struct.Outer*, i32 }
+// CHECK-DAG: %struct.Chain.{{[0-9]+}} = type { %struct.Outer* }
+
+int use() { return O.Link->Value + O.Link->Chain<1>::Value; }
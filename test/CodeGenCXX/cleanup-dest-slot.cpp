@@ -0,0 +1,36 @@
+// RUN: %clang_cc1 -std=c++11 -triple x86_64-linux-gnu -emit-llvm -o - %s | FileCheck %s
+
+struct A { ~A(); };
+void g();
+
+// Both returns leave through the same cleanup to the same place, so the
+// cleanup destination is never read and no slot is left behind.
+// CHECK-LABEL: define i32 @_Z3twob(
+// CHECK-NOT: cleanup.dest
+// CHECK: call void @_ZN1AD1Ev(
+// CHECK-NOT: cleanup.dest
+// CHECK: ret i32
+int two(bool c) {
+  A a;
+  if (c)
+    return 1;
+  g();
+  return 2;
+}
+
+// The cleanup of the loop body is left either by falling through or by the
+// break, so it has to dispatch on the slot.
+// CHECK-LABEL: define void @_Z3onebi(
+// CHECK: %cleanup.dest.slot = alloca i32
+// CHECK: store i32 {{[0-9]+}}, i32* %cleanup.dest.slot
+// CHECK: call void @_ZN1AD1Ev(
+// CHECK: load i32, i32* %cleanup.dest.slot
+// CHECK: ret void
+void one(bool c, int n) {
+  for (int i = 0; i < n; ++i) {
+    A a;
+    if (c)
+      break;
+    g();
+  }
+}
@@ -0,0 +1,27 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-llvm -o - %s | FileCheck %s \
+// RUN:   --implicit-check-not='define linkonce_odr void @_Z9discardedv' \
+// RUN:   --implicit-check-not='define linkonce_odr void @_Z6calleev' \
+// RUN:   --implicit-check-not='define linkonce_odr void @_Z4tmplIiEvv'
+
+// Taking the address of an inline function in a discarded expression doesn't
+// leave a reference in the IR, so neither it nor what it calls is emitted.
+inline void callee() {}
+inline void discarded() { callee(); }
+
+// A function that is set aside like this is still emitted if code emitted
+// later refers to it.
+inline void late() {}
+inline void late_user() { late(); }
+
+void f() {
+  (void)&discarded;
+  (void)&late;
+  late_user();
+}
+
+template <typename T> void tmpl() { callee(); }
+void g() { (void)&tmpl<int>; }
+
+// CHECK-LABEL: define void @_Z1fv()
+// CHECK-DAG: define linkonce_odr void @_Z9late_userv()
+// CHECK-DAG: define linkonce_odr void @_Z4latev()
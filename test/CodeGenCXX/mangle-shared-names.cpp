@@ -0,0 +1,31 @@
+// RUN: %clang_cc1 -std=c++14 -triple i386-pc-win32 -fms-extensions -emit-llvm %s -o - | FileCheck %s
+// RUN: %clang_cc1 -std=c++14 -triple x86_64-linux-gnu -emit-llvm %s -o - | FileCheck %s --check-prefix=ITANIUM
+
+// The mangle context that computes __FUNCDNAME__ and the one that CodeGen
+// uses share the names of declarations with external linkage. Local entities
+// are still mangled by each context on its own.
+
+// CHECK: c"?name@@YAPBDXZ\00"
+// CHECK: define {{.*}} @"?name@@YAPBDXZ"()
+const char *name() { return __FUNCDNAME__; }
+
+namespace ns {
+template <typename T> struct S {
+  static int get() { return 1; }
+};
+}
+
+// ITANIUM-LABEL: define {{.*}}i32 @_Z5firstv()
+// ITANIUM: call i32 @_ZZ5firstvEN5Local3getEv()
+int first() {
+  struct Local { static int get() { return 2; } };
+  return Local::get();
+}
+
+// ITANIUM-LABEL: define {{.*}}i32 @_Z6secondv()
+// ITANIUM: call i32 @_ZZ6secondvEN5Local3getEv()
+// ITANIUM: call i32 @_ZN2ns1SIiE3getEv()
+int second() {
+  struct Local { static int get() { return 3; } };
+  return Local::get() + ns::S<int>::get();
+}
@@ -0,0 +1,40 @@
+// RUN: %clang_cc1 -std=c++11 -fms-extensions -fno-rtti -emit-llvm -o %t.ll -fdump-vtable-layouts %s -triple=i386-pc-win32 >%t
+// RUN: FileCheck %s < %t
+
+// Every class is declared before it is defined, so the paths to the
+// subobjects that introduce vfptrs have to be found by canonical declaration.
+struct A;
+struct X;
+struct Y;
+struct Z;
+struct W;
+struct V;
+
+struct A {
+  virtual void f();
+  virtual void z();
+};
+
+struct X { int x; };
+
+struct Y : X, A { };
+
+struct Z : virtual Y {
+  Z();
+  // CHECK-LABEL: VFTable for 'A' in 'Y' in 'Z' (2 entries).
+  // CHECK-NEXT: 0 | void A::f()
+  // CHECK-NEXT: 1 | void A::z()
+};
+
+Z::Z() {}
+
+struct W : virtual A { };
+
+struct V : virtual W {
+  V();
+  // CHECK-LABEL: VFTable for 'A' in 'W' in 'V' (2 entries).
+  // CHECK-NEXT: 0 | void A::f()
+  // CHECK-NEXT: 1 | void A::z()
+};
+
+V::V() {}
@@ -0,0 +1,37 @@
+// Build a PCH with an object file that owns the debug info for its types.
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-pch -building-pch-with-obj -fmodules-debuginfo -o %t %s
+//
+// The object file built along with the PCH describes the types in full...
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-llvm -debug-info-kind=limited -include-pch %t -building-pch-with-obj -fmodules-debuginfo -o - %s | FileCheck -check-prefix=OBJ %s
+//
+// ... and its other users only refer to them.
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-llvm -debug-info-kind=limited -include-pch %t -o - %s | FileCheck -check-prefix=USER %s
+//
+// Without -fmodules-debuginfo, every user describes the types it uses.
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-pch -building-pch-with-obj -o %t.plain %s
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-llvm -debug-info-kind=limited -include-pch %t.plain -o - %s | FileCheck -check-prefix=PLAIN %s
+
+#ifndef IN_HEADER
+#define IN_HEADER
+
+struct InHeader {
+  int Member;
+};
+
+// The object file describes types from the header even if it doesn't use
+// them.
+struct UnusedInHeader {
+  int Member;
+};
+
+#else
+
+InHeader Var;
+
+// OBJ-DAG: !DICompositeType(tag: DW_TAG_structure_type, name: "InHeader",{{.*}} elements:
+// OBJ-DAG: !DICompositeType(tag: DW_TAG_structure_type, name: "UnusedInHeader",{{.*}} elements:
+// USER: !DICompositeType(tag: DW_TAG_structure_type, name: "InHeader",{{.*}} flags: DIFlagFwdDecl
+// USER-NOT: UnusedInHeader
+// PLAIN: !DICompositeType(tag: DW_TAG_structure_type, name: "InHeader",{{.*}} elements:
+
+#endif
@@ -0,0 +1,6 @@
+inline int used_inline(int i) { return i + 1; }
+inline int unused_inline(int i) { return i - 1; }
+static int unused_static(int i) { return i * 2; }
+struct S {
+  int unused_method() { return 0; }
+};
@@ -0,0 +1,23 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -fprofile-instrument=clang -fcoverage-mapping -dump-coverage-mapping -emit-llvm-only -main-file-name unused-linkonce.cpp %s | FileCheck %s --check-prefix=ALL
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -fprofile-instrument=clang -fcoverage-mapping -coverage-skip-unused-linkonce -dump-coverage-mapping -emit-llvm-only -main-file-name unused-linkonce.cpp %s > %t.skip
+// RUN: FileCheck -input-file %t.skip %s --check-prefix=SKIP
+// RUN: FileCheck -input-file %t.skip %s --check-prefix=DROPPED
+
+#include "Inputs/unused-linkonce.h"
+
+inline int unused_main_inline() { return 0; }
+
+int main() { return used_inline(0); }
+
+// ALL-DAG: _Z11used_inlinei:
+// ALL-DAG: _Z13unused_inlinei:
+// ALL-DAG: _ZN1S13unused_methodEv:
+// ALL-DAG: {{.*}}_ZL13unused_statici:
+// ALL-DAG: _Z18unused_main_inlinev:
+
+// SKIP-DAG: _Z11used_inlinei:
+// SKIP-DAG: {{.*}}_ZL13unused_statici:
+// SKIP-DAG: _Z18unused_main_inlinev:
+
+// DROPPED-NOT: _Z13unused_inlinei:
+// DROPPED-NOT: _ZN1S13unused_methodEv:
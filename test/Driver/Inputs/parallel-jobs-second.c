@@ -0,0 +1,2 @@
+int second_marker;
+int y = second_undeclared;
@@ -0,0 +1,57 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: printf '%%s\n' \
+// RUN:   '-cc1 -triple x86_64-unknown-unknown -emit-llvm -o %t/a.ll %s' \
+// RUN:   '' \
+// RUN:   '-triple x86_64-unknown-unknown -DBROKEN -fsyntax-only %s' \
+// RUN:   '-triple x86_64-unknown-unknown -disable-free -DOTHER -emit-llvm -o %t/b.ll %s' \
+// RUN:   '-triple x86_64-unknown-unknown -mllvm -debug-pass=Structure -fsyntax-only %s' \
+// RUN:   '-triple x86_64-unknown-unknown -mdebug-pass Structure -fsyntax-only %s' \
+// RUN:   '-triple x86_64-unknown-unknown -mlimit-float-precision 8 -fsyntax-only %s' \
+// RUN:   '-triple x86_64-unknown-unknown -no-such-option -fsyntax-only %s' \
+// RUN:   '-triple x86_64-unknown-unknown -DOTHER -emit-llvm -o - %s' \
+// RUN:   | %clang -cc1server -status-file %t/status > %t/out 2> %t/err
+// RUN: FileCheck %s < %t/status
+// RUN: FileCheck --check-prefix=ERR %s < %t/err
+// RUN: FileCheck --check-prefix=A %s < %t/a.ll
+// RUN: FileCheck --check-prefix=B %s < %t/b.ll
+// RUN: FileCheck --check-prefix=OUT %s < %t/out
+
+// CHECK: exit 0
+// CHECK-NEXT: exit 1
+// CHECK-NEXT: exit 0
+// CHECK-NEXT: exit 1
+// CHECK-NEXT: exit 1
+// CHECK-NEXT: exit 1
+// CHECK-NEXT: exit 1
+// CHECK-NEXT: exit 0
+// CHECK-NOT: exit
+
+// ERR: error: use of undeclared identifier 'broken'
+// ERR: error: '-mllvm' is not supported by '-cc1server'
+// ERR: error: '-mdebug-pass' is not supported by '-cc1server'
+// ERR: error: '-mlimit-float-precision' is not supported by '-cc1server'
+// ERR: error: unknown argument: '-no-such-option'
+
+// A: define {{.*}}i32 @f()
+// A-NOT: @g
+// B: define {{.*}}i32 @g()
+
+// The output of a command that writes to standard output is not mixed with
+// the statuses.
+// OUT-NOT: exit
+// OUT: define {{.*}}i32 @g()
+// OUT-NOT: exit
+
+// RUN: not %clang -cc1server 2>&1 | FileCheck --check-prefix=ARGS %s
+// RUN: not %clang -cc1server extra 2>&1 | FileCheck --check-prefix=ARGS %s
+// ARGS: error: '-cc1server' takes only '-status-file <path>'
+
+#ifdef BROKEN
+int x = broken;
+#endif
+
+#ifdef OTHER
+int g(void) { return 1; }
+#else
+int f(void) { return 0; }
+#endif
@@ -19,6 +19,18 @@
 // CHECK-YC: -include-pch
 // CHECK-YC: pchfile.pch
 
+// /Yc -fpch-debuginfo
+// RUN: %clang_cl -Werror /Ycpchfile.h /FIpchfile.h -fpch-debuginfo /c -### -- %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHECK-YC-DEBUGINFO %s
+// CHECK-YC-DEBUGINFO: cc1
+// CHECK-YC-DEBUGINFO: -emit-pch
+// CHECK-YC-DEBUGINFO: -building-pch-with-obj
+// CHECK-YC-DEBUGINFO: -fmodules-debuginfo
+// CHECK-YC-DEBUGINFO: cc1
+// CHECK-YC-DEBUGINFO: -emit-obj
+// CHECK-YC-DEBUGINFO: -building-pch-with-obj
+// CHECK-YC-DEBUGINFO: -fmodules-debuginfo
+
 // /Yc /Fo
 // /Fo overrides the .obj output filename, but not the .pch filename
 // RUN: %clang_cl -Werror /Fomyobj.obj /Ycpchfile.h /FIpchfile.h /c -### -- %s 2>&1 \
@@ -50,5 +50,14 @@
 // RUN:   --cuda-gpu-arch=sm_60 %s 2>&1 | FileCheck %s
 
 
+// The device compilations run at once by default; only the first failure is
+// reported either way.
+// RUN: not %clang -target powerpc64le-ibm-linux-gnu -fsyntax-only -nocudalib \
+// RUN:   -nocudainc -DERROR_SM35 -DERROR_SM60 --cuda-gpu-arch=sm_35 \
+// RUN:   --cuda-gpu-arch=sm_60 -parallel-jobs=1 %s 2>&1 | FileCheck %s
+// RUN: not %clang -target powerpc64le-ibm-linux-gnu -fsyntax-only -nocudalib \
+// RUN:   -nocudainc -DERROR_SM35 -DERROR_SM60 --cuda-gpu-arch=sm_35 \
+// RUN:   --cuda-gpu-arch=sm_60 -parallel-jobs=4 %s 2>&1 | FileCheck %s
+
 // CHECK: error: compilation failed
 // CHECK-NOT: error: compilation failed
@@ -0,0 +1,33 @@
+// Check that --gcc-install-cache remembers the detected GCC installation and
+// notices when the searched directories change.
+//
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: cp -R %S/Inputs/basic_linux_tree %t/tree
+// RUN: %clang -### -v %s --target=x86_64-unknown-linux --sysroot=%t/tree \
+// RUN:   --gcc-install-cache=%t/cache 2>&1 \
+// RUN:   | FileCheck --check-prefix=FIRST %s
+// FIRST-NOT: argument unused
+// FIRST: Selected GCC installation: {{.*}}tree/usr/lib/gcc/x86_64-unknown-linux/4.6.0
+//
+// RUN: FileCheck --check-prefix=CACHE %s < %t/cache
+// CACHE: target x86_64-unknown-linux
+// CACHE: dir {{[0-9]+}} {{.*}}tree/usr/lib/gcc/x86_64-unknown-linux
+// CACHE: install {{.*}}tree/usr/lib/gcc/x86_64-unknown-linux/4.6.0
+// CACHE: triple x86_64-unknown-linux
+// CACHE: version 4.6.0
+//
+// A cached installation is used without searching again.
+// RUN: cp -R %t/tree/usr/lib/gcc/x86_64-unknown-linux/4.6.0 %t/other
+// RUN: sed -e 's|^install .*$|install %/t/other|' %t/cache > %t/cache.new
+// RUN: mv %t/cache.new %t/cache
+// RUN: %clang -### -v %s --target=x86_64-unknown-linux --sysroot=%t/tree \
+// RUN:   --gcc-install-cache=%t/cache 2>&1 \
+// RUN:   | FileCheck --check-prefix=CACHED %s
+// CACHED: Selected GCC installation: {{.*}}other
+//
+// A new installation makes the cache stale.
+// RUN: cp -R %t/other %t/tree/usr/lib/gcc/x86_64-unknown-linux/4.7.0
+// RUN: %clang -### -v %s --target=x86_64-unknown-linux --sysroot=%t/tree \
+// RUN:   --gcc-install-cache=%t/cache 2>&1 \
+// RUN:   | FileCheck --check-prefix=STALE %s
+// STALE: Selected GCC installation: {{.*}}tree/usr/lib/gcc/x86_64-unknown-linux/4.7.0
@@ -0,0 +1,5 @@
+// RUN: %clang -### -c -index-store-path %t/idx %s 2>&1 | FileCheck %s
+// CHECK: "-cc1"{{.*}} "-index-store-path" "{{.*}}idx"
+
+// RUN: %clang -### -c %s 2>&1 | FileCheck -check-prefix=NO-STORE %s
+// NO-STORE-NOT: "-index-store-path"
@@ -0,0 +1,33 @@
+// RUN: %clang -fintegrated-cc1 -fsyntax-only %s
+// RUN: not %clang -fintegrated-cc1 -fsyntax-only -DERROR %s 2>&1 \
+// RUN:   | FileCheck --check-prefix=ERROR %s
+// RUN: %clang -fintegrated-cc1 -fno-integrated-cc1 -### -fsyntax-only %s 2>&1 \
+// RUN:   | FileCheck --check-prefix=UNUSED %s
+// RUN: %clang -fintegrated-cc1 -### -fsyntax-only %s 2>&1 \
+// RUN:   | FileCheck --check-prefix=UNUSED %s
+
+// ERROR: error: use of undeclared identifier 'error'
+// ERROR-NOT: clang frontend command failed
+// UNUSED: "-cc1"
+// UNUSED-NOT: argument unused during compilation
+
+// RUN: rm -rf %t && mkdir %t
+// RUN: env TMPDIR=%t TEMP=%t TMP=%t                                 \
+// RUN:   not %clang -fintegrated-cc1 -fsyntax-only -DCRASH %s 2>&1   \
+// RUN:   | FileCheck --check-prefix=CRASH %s
+// RUN: cat %t/integrated-cc1-*.c | FileCheck --check-prefix=CRASHSRC %s
+// REQUIRES: crash-recovery
+
+// CRASH: clang frontend command failed due to signal
+// CRASH: Preprocessed source(s) and associated run script(s) are located at:
+// CRASH-NEXT: note: diagnostic msg: {{.*}}integrated-cc1-{{.*}}.c
+// CRASHSRC: int crash_marker;
+
+#ifdef ERROR
+int x = error;
+#endif
+
+#ifdef CRASH
+int crash_marker;
+#pragma clang __debug parser_crash
+#endif
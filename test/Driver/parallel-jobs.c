@@ -0,0 +1,24 @@
+// RUN: %clang -parallel-jobs=2 -E %s %S/Inputs/parallel-jobs-second.c \
+// RUN:   | FileCheck --check-prefix=PP %s
+// PP: int first_marker;
+// PP: int second_marker;
+
+// The output of each job is printed in order, after its command line.
+// RUN: not %clang -v -parallel-jobs=2 -fsyntax-only %s \
+// RUN:   %S/Inputs/parallel-jobs-second.c 2>&1 \
+// RUN:   | FileCheck --check-prefix=DIAG %s
+// DIAG: "-main-file-name" "parallel-jobs.c"
+// DIAG: error: use of undeclared identifier 'first_undeclared'
+// DIAG: "-main-file-name" "parallel-jobs-second.c"
+// DIAG: error: use of undeclared identifier 'second_undeclared'
+
+// RUN: %clang -parallel-jobs=2 -### -fsyntax-only %s 2>&1 \
+// RUN:   | FileCheck --check-prefix=UNUSED %s
+// UNUSED-NOT: argument unused during compilation
+
+// RUN: not %clang -parallel-jobs=0 -fsyntax-only %s 2>&1 \
+// RUN:   | FileCheck --check-prefix=INVALID %s
+// INVALID: error: invalid integral value '0' in '-parallel-jobs=0'
+
+int first_marker;
+int x = first_undeclared;
@@ -0,0 +1,34 @@
+// RUN: rm -rf %t && mkdir -p %t/a %t/b
+// RUN: printf "BasedOnStyle: LLVM\nIndentWidth: 3\n" > %t/a/.clang-format
+// RUN: printf "BasedOnStyle: LLVM\nIndentWidth: 5\n" > %t/b/.clang-format
+// RUN: cp %s %t/a/1.cpp
+// RUN: cp %s %t/b/2.cpp
+// RUN: cp %s %t/a/3.cpp
+// RUN: clang-format -j 3 -style=file %t/a/1.cpp %t/b/2.cpp %t/a/3.cpp \
+// RUN:   | FileCheck -strict-whitespace %s
+// RUN: not clang-format -j 2 -verbose -style=file %t/a/1.cpp %t/missing.cpp \
+// RUN:   %t/b/2.cpp 2>&1 >/dev/null | FileCheck -check-prefix=ERRORS %s
+// RUN: clang-format -j 2 -i -style=file %t/a/1.cpp %t/b/2.cpp
+// RUN: FileCheck -strict-whitespace -check-prefix=INPLACE-A \
+// RUN:   -input-file=%t/a/1.cpp %s
+// RUN: FileCheck -strict-whitespace -check-prefix=INPLACE-B \
+// RUN:   -input-file=%t/b/2.cpp %s
+
+// CHECK: {{^void f\(\) {$}}
+// CHECK-NEXT: {{^   g\(\);$}}
+// CHECK: {{^void f\(\) {$}}
+// CHECK-NEXT: {{^     g\(\);$}}
+// CHECK: {{^void f\(\) {$}}
+// CHECK-NEXT: {{^   g\(\);$}}
+
+// ERRORS: Formatting {{.*}}1.cpp
+// ERRORS-NEXT: Formatting {{.*}}missing.cpp
+// ERRORS-NEXT: {{.*}}o such file or directory
+// ERRORS-NEXT: Formatting {{.*}}2.cpp
+
+// INPLACE-A: {{^   g\(\);$}}
+// INPLACE-B: {{^     g\(\);$}}
+
+void f() {
+  g();
+}
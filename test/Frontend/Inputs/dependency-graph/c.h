@@ -0,0 +1 @@
+// Included twice, so it has no include guard.
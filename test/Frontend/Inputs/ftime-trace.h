@@ -0,0 +1,3 @@
+struct Header {
+  int Value;
+};
@@ -0,0 +1,5 @@
+template <typename T> T twice(T X) { return X + X; }
+
+struct S {
+  int A;
+};
@@ -0,0 +1,38 @@
+// RUN: rm -rf %t.dir
+// RUN: mkdir -p %t.dir/a %t.dir/b
+// RUN: echo "#pragma once" > %t.dir/a/once.h
+// RUN: echo "#include \"b/guarded.h\"" >> %t.dir/a/once.h
+// RUN: echo "#ifndef GUARDED_H" > %t.dir/b/guarded.h
+// RUN: echo "#define GUARDED_H" >> %t.dir/b/guarded.h
+// RUN: echo "int f(void) { return '#'; }" >> %t.dir/b/guarded.h
+// RUN: echo "#endif" >> %t.dir/b/guarded.h
+// RUN: echo "" > %t.dir/b/selected.h
+
+// RUN: %clang_cc1 -E -o /dev/null -dependency-directives-only \
+// RUN:   -dependency-file %t.dir/file.deps -MT %s.o %s -I %t.dir
+// RUN: FileCheck -input-file=%t.dir/file.deps %s
+// CHECK: dependency-directives-only.c.o:
+// CHECK-NEXT: dependency-directives-only.c
+// CHECK-NEXT: a{{[/\\]}}once.h
+// CHECK-NEXT: b{{[/\\]}}guarded.h
+// CHECK-NEXT: b{{[/\\]}}selected.h
+// CHECK-NOT: missing.h
+
+/* Includes in comments don't count.
+#include "missing.h"
+*/
+const char *S = "\
+#include \"missing.h\"";
+
+#include "a/once.h"
+#include "a/once.h"
+#include "b/guarded.h"
+
+#define SELECT(X) \
+  X
+#if defined(GUARDED_H) && \
+    SELECT(1)
+#include SELECT("b/selected.h")
+#else
+#include "missing.h"
+#endif
@@ -0,0 +1,20 @@
+// RUN: %clang_cc1 -E -dependency-dot %t.dot -I %S/Inputs/dependency-graph %s -o /dev/null
+// RUN: FileCheck %s < %t.dot
+
+// The files are listed in the order they were first seen, so an includer
+// comes before the files it includes, and the inclusions in the order they
+// were seen.
+
+#include "a.h"
+#include "b.h"
+
+// CHECK: digraph "dependencies" {
+// CHECK-NEXT: [[MAIN:header_[0-9]+]] [ shape="box", label="{{.*}}dependency-graph.c"];
+// CHECK-NEXT: [[A:header_[0-9]+]] [ shape="box", label="{{.*}}a.h"];
+// CHECK-NEXT: [[C:header_[0-9]+]] [ shape="box", label="{{.*}}c.h"];
+// CHECK-NEXT: [[B:header_[0-9]+]] [ shape="box", label="{{.*}}b.h"];
+// CHECK-NEXT: [[MAIN]] -> [[A]];
+// CHECK-NEXT: [[A]] -> [[C]];
+// CHECK-NEXT: [[MAIN]] -> [[B]];
+// CHECK-NEXT: [[B]] -> [[C]];
+// CHECK-NEXT: }
@@ -0,0 +1,47 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: %clang_cc1 -std=c++14 -fsyntax-only -ftime-trace -ftime-trace-granularity=0 -o %t/out.o %s
+// RUN: FileCheck %s < %t/out.json
+// RUN: %clang_cc1 -std=c++14 -triple x86_64-unknown-linux-gnu -emit-llvm -ftime-trace -ftime-trace-granularity=0 -o %t/ir.ll %s
+// RUN: FileCheck --check-prefix=CODEGEN %s < %t/ir.json
+// RUN: %clang -### -c -ftime-trace -ftime-trace-granularity=10 %s 2>&1 \
+// RUN:   | FileCheck --check-prefix=DRIVER %s
+
+// CHECK: "summary":[
+// CHECK-DAG: "group":"Vector","name":"InstantiateClass"
+// CHECK-DAG: "group":"sum","name":"InstantiateFunction"
+// CHECK-DAG: "group":"operator+","name":"OverloadResolution"
+// CHECK-DAG: "group":"triangle","name":"ConstexprCall"
+// CHECK: "traceEvents":[
+// CHECK-DAG: "detail":"Vector<int>"
+// CHECK-DAG: "detail":"sum<int>"
+// CHECK-DAG: "name":"ExecuteCompiler"
+// CHECK-DAG: "name":"Frontend"
+// CHECK-DAG: "detail":"Header","nested":{{[0-9]+}}},"dur":{{[0-9]+}},"name":"ParseClass"
+// CHECK-DAG: "detail":"use","nested":{{[0-9]+}}},"dur":{{[0-9]+}},"name":"ParseFunctionDefinition"
+// CHECK-DAG: "detail":"{{[^"]*}}ftime-trace.h","nested":0},"dur":{{[0-9]+}},"name":"Source","ph":"X","pid":1,"tid":1
+
+// CODEGEN-DAG: "detail":"_Z3use5ValueS_","nested":{{[0-9]+}}},"dur":{{[0-9]+}},"name":"CodeGenFunction"
+// CODEGEN-DAG: "name":"Backend"
+// CODEGEN-DAG: "name":"OptModule"
+
+// DRIVER: "-ftime-trace" "-ftime-trace-granularity=10"
+
+#include "Inputs/ftime-trace.h"
+
+template <typename T> struct Vector { T Elements[4]; };
+
+struct Value {};
+Value operator+(Value, Value);
+
+template <typename T> T sum(const Vector<T> &V) {
+  return V.Elements[0] + V.Elements[1];
+}
+
+int use(Value A, Value B) {
+  Vector<int> V = {{1, 2, 3, 4}};
+  A + B;
+  return sum(V);
+}
+
+constexpr int triangle(int N) { return N ? N + triangle(N - 1) : 0; }
+static_assert(triangle(10) == 55, "");
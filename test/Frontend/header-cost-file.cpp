@@ -0,0 +1,22 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -I %S/Inputs -emit-llvm -o /dev/null -header-cost-file %t.json %s
+// RUN: FileCheck %s < %t.json
+
+#include "header-cost.h"
+
+int f(S Val) { return twice(Val.A) + twice(2L); }
+
+// The main file triggers both instantiations, and the header declares them.
+// CHECK: "files": [
+// CHECK: "decls": {{[1-9][0-9]*}},
+// CHECK-NEXT: "file": "{{.*}}header-cost-file.cpp",
+// CHECK-NEXT: "instantiations": 2,
+// CHECK-NEXT: "ir-instructions": {{[1-9][0-9]*}},
+// CHECK-NEXT: "seconds": {{.*}},
+// CHECK-NEXT: "tokens": {{[1-9][0-9]*}}
+// CHECK: "decls": {{[1-9][0-9]*}},
+// CHECK-NEXT: "file": "{{.*}}header-cost.h",
+// CHECK-NEXT: "instantiations": 0,
+// CHECK-NEXT: "ir-instructions": {{[1-9][0-9]*}},
+// CHECK-NEXT: "seconds": {{.*}},
+// CHECK-NEXT: "tokens": {{[1-9][0-9]*}}
+// CHECK: "main-file": "{{.*}}header-cost-file.cpp"
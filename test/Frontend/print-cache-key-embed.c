@@ -0,0 +1,19 @@
+// RUN: rm -rf %t && mkdir -p %t/a %t/b
+// RUN: cp %s %t/a/t.c && echo one > %t/a/data.txt
+// RUN: cp %s %t/b/t.c && echo two > %t/b/data.txt
+// RUN: cd %t/a && %clang_cc1 -print-cache-key t.c -o %t/a.key
+// RUN: cd %t/b && %clang_cc1 -print-cache-key t.c -o %t/b.key
+// RUN: FileCheck %s < %t/a.key
+
+// The contents of an embedded file are part of the key, and the file is an
+// input.
+// RUN: not diff %t/a.key %t/b.key
+
+// CHECK: key {{[0-9a-f]+}}
+// CHECK-NEXT: input data.txt
+// CHECK-NEXT: input t.c
+// CHECK-NOT: input
+
+const char data[] = {
+#embed "data.txt"
+};
@@ -0,0 +1,36 @@
+// RUN: rm -rf %t && mkdir -p %t/a %t/b %t/c %t/d %t/e
+// RUN: cp %s %t/a/t.c
+// RUN: sed -e 's/^int  value = VALUE ;$/int value=VALUE;/' %s > %t/b/t.c
+// RUN: sed -e 's/^int  value = VALUE ;$/int value = VALUE + 1;/' %s > %t/c/t.c
+// RUN: sed -e 's/^#pragma pack(4)$/#pragma pack(8)/' %s > %t/d/t.c
+// RUN: sed -e 's/^P(pack(2))$/P(pack(1))/' %s > %t/e/t.c
+// RUN: cd %t/a && %clang_cc1 -print-cache-key -I %S/Inputs t.c -o %t/a.key
+// RUN: cd %t/b && %clang_cc1 -print-cache-key -I %S/Inputs t.c -o %t/b.key
+// RUN: cd %t/c && %clang_cc1 -print-cache-key -I %S/Inputs t.c -o %t/c.key
+// RUN: cd %t/d && %clang_cc1 -print-cache-key -I %S/Inputs t.c -o %t/d.key
+// RUN: cd %t/e && %clang_cc1 -print-cache-key -I %S/Inputs t.c -o %t/e.key
+// RUN: cd %t/a && %clang_cc1 -print-cache-key -I %S/Inputs t.c -O2 \
+// RUN:   -o %t/o2.key
+// RUN: FileCheck %s < %t/a.key
+
+// Whitespace within a line doesn't matter; tokens, pragmas and options do.
+// RUN: diff %t/a.key %t/b.key
+// RUN: not diff %t/a.key %t/c.key
+// RUN: not diff %t/a.key %t/d.key
+// RUN: not diff %t/a.key %t/e.key
+// RUN: not diff %t/a.key %t/o2.key
+
+// CHECK: key {{[0-9a-f]+}}
+// CHECK-NEXT: input {{.*}}print-cache-key.h
+// CHECK-NEXT: input t.c
+// CHECK-NOT: input
+
+#include "print-cache-key.h"
+
+#pragma pack(4)
+
+// The text of this pragma comes from the macro argument.
+#define P(x) _Pragma(#x)
+P(pack(2))
+
+int  value = VALUE ;
@@ -29,4 +29,16 @@
 // MS-BLACKLIST: Note: including file:  {{[^ ]*test2.h}}
 // MS-BLACKLIST-NOT: Note
 
+// Compilations append to a shared header include file, one whole translation
+// unit at a time.
+// RUN: rm -f %t.headers
+// RUN: %clang_cc1 -I%S -include Inputs/test3.h -E -H -header-include-file %t.headers -o /dev/null %s
+// RUN: %clang_cc1 -I%S -include Inputs/test3.h -E -H -header-include-file %t.headers -o /dev/null %s
+// RUN: FileCheck --check-prefix=FILE < %t.headers %s
+// FILE: . {{.*test.h}}
+// FILE-NEXT: .. {{.*test2.h}}
+// FILE-NEXT: . {{.*test.h}}
+// FILE-NEXT: .. {{.*test2.h}}
+// FILE-NOT: test
+
 #include "Inputs/test.h"
@@ -0,0 +1,6 @@
+namespace N {
+  struct Lazy {
+    int member;
+  };
+  int lazyFunction(Lazy L);
+}
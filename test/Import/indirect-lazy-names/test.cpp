@@ -0,0 +1,15 @@
+// RUN: clang-import-test -dump-ast -import %S/Inputs/S.cpp -expression %s | FileCheck %s
+// RUN: clang-import-test -dump-ast -direct -import %S/Inputs/S.cpp -expression %s | FileCheck %s
+
+// In the default indirect mode, each source gets its declarations lazily
+// through its own ExternalASTMerger, so its identifier table does not know
+// the names yet when they are first looked up.
+
+// CHECK: CXXRecordDecl {{.*}} struct Lazy definition
+// CHECK: FieldDecl {{.*}} member 'int'
+// CHECK: FunctionDecl {{.*}} lazyFunction 'int ({{.*}}Lazy)'
+
+void expr() {
+  N::Lazy L;
+  L.member = N::lazyFunction(L);
+}
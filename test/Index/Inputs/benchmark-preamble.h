@@ -0,0 +1,3 @@
+struct bench_point { int x, y; };
+
+int bench_area(struct bench_point p);
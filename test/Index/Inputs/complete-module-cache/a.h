@@ -0,0 +1,2 @@
+int a_only(void);
+int shared(int);
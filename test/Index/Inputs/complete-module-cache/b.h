@@ -0,0 +1,2 @@
+int b_only(void);
+int shared(int);
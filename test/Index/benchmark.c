@@ -0,0 +1,24 @@
+#include "Inputs/benchmark-preamble.h"
+
+void bench_user(void) {
+  struct bench_point p = { 1, 2 };
+  bench_area(p);
+}
+
+// The preamble is built by the first reparse, and reused by the later
+// reparses and the code completions.
+// RUN: c-index-test -benchmark 3 -benchmark-complete-at=%s:5:3 %s | FileCheck %s
+// CHECK: "file": "{{.*}}benchmark.c",
+// CHECK: "iterations": 3,
+// CHECK: "parse_ms": {{[0-9.]+}},
+// CHECK: "reparse": {"count": 3, "min_ms": {{[0-9.]+}}, "mean_ms": {{[0-9.]+}}, "p50_ms": {{[0-9.]+}}, "p90_ms": {{[0-9.]+}}, "p99_ms": {{[0-9.]+}}, "max_ms": {{[0-9.]+}}},
+// CHECK: "completion": [
+// CHECK-NEXT: {"file": "{{.*}}benchmark.c", "line": 5, "column": 3, "results": {{[1-9][0-9]*}}, "latency": {"count": 3,
+// CHECK: "preamble": {"builds": 1, "reuses": {{[1-9][0-9]*}}, "hit_rate": {{0\.[0-9]+}}},
+// CHECK: "memory": {
+// CHECK: "ASTUnit: precompiled preamble": {{[0-9]+}},
+// CHECK: "total": {{[0-9]+}}
+
+// RUN: c-index-test -benchmark 0 %s | FileCheck -check-prefix=CHECK-NONE %s
+// CHECK-NONE: "reparse": {"count": 0},
+// CHECK-NONE: "completion": [],
@@ -0,0 +1,33 @@
+// Compacting a translation unit after each parse must keep it usable.
+
+#define COMPACT_MAX(a, b) ((a) > (b) ? (a) : (b))
+
+struct compact_point { int x, y; };
+
+int compact_area(struct compact_point p) {
+  return COMPACT_MAX(p.x, p.y);
+}
+
+void compact_user(void) {
+  struct compact_point p = { 1, 2 };
+  compact_area(p);
+}
+
+// RUN: env CINDEXTEST_COMPACT_AFTER_PARSE=1 c-index-test -test-load-source-memory-usage local %s 2>&1 | FileCheck -check-prefix=CHECK-USAGE %s
+// CHECK-USAGE: Preprocessor: token caches : {{[0-9]+}} bytes
+// CHECK-USAGE: ASTUnit: stored diagnostics : {{[0-9]+}} bytes
+// CHECK-USAGE: TOTAL =
+
+// RUN: env CINDEXTEST_EDITING=1 CINDEXTEST_COMPACT_AFTER_PARSE=1 c-index-test -test-load-source local %s | FileCheck -check-prefix=CHECK-LOAD %s
+// RUN: env CINDEXTEST_COMPACT_AFTER_PARSE=1 c-index-test -test-reparse-source 3 local %s | FileCheck -check-prefix=CHECK-LOAD %s
+// CHECK-LOAD: compact-after-parse.c:5:8: StructDecl=compact_point:5:8 (Definition)
+// CHECK-LOAD: compact-after-parse.c:7:5: FunctionDecl=compact_area:7:5 (Definition)
+// CHECK-LOAD: compact-after-parse.c:8:3: ReturnStmt=
+// CHECK-LOAD: compact-after-parse.c:13:3: CallExpr=compact_area:7:5
+
+// The cached completion results are dropped, so code completion has to ask
+// Sema for the global results.
+// RUN: env CINDEXTEST_EDITING=1 CINDEXTEST_COMPLETION_CACHING=1 CINDEXTEST_COMPACT_AFTER_PARSE=1 c-index-test -code-completion-at=%s:13:3 %s | FileCheck -check-prefix=CHECK-CC %s
+// CHECK-CC: FunctionDecl:{ResultType int}{TypedText compact_area}{LeftParen (}{Placeholder struct compact_point p}{RightParen )}
+// CHECK-CC: macro definition:{TypedText COMPACT_MAX}{LeftParen (}{Placeholder a}{Comma , }{Placeholder b}{RightParen )}
+// CHECK-CC: FunctionDecl:{ResultType void}{TypedText compact_user}{LeftParen (}{RightParen )}
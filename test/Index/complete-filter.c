@@ -0,0 +1,24 @@
+// Note: the run lines follow their respective tests, since line/column
+// matter in this test.
+
+#define APPLE_MACRO 1
+int apple, banana;
+
+void f(void) {
+  int apricot;
+  apple;
+}
+
+// RUN: env CINDEXTEST_COMPLETION_PREFIX=ap c-index-test -code-completion-at=%s:9:3 %s | FileCheck -check-prefix=CHECK-PREFIX %s
+// RUN: env CINDEXTEST_EDITING=1 CINDEXTEST_COMPLETION_CACHING=1 CINDEXTEST_COMPLETION_PREFIX=ap c-index-test -code-completion-at=%s:9:3 %s | FileCheck -check-prefix=CHECK-PREFIX %s
+// CHECK-PREFIX-DAG: VarDecl:{ResultType int}{TypedText apple}
+// CHECK-PREFIX-DAG: macro definition:{TypedText APPLE_MACRO}
+// CHECK-PREFIX-DAG: VarDecl:{ResultType int}{TypedText apricot}
+// CHECK-PREFIX-NOT: banana
+// CHECK-PREFIX-NOT: NotImplemented:{TypedText int}
+
+// RUN: env CINDEXTEST_COMPLETION_PREFIX=ap CINDEXTEST_COMPLETION_MAX_RESULTS=1 c-index-test -code-completion-at=%s:9:3 %s | FileCheck -check-prefix=CHECK-MAX %s
+// RUN: env CINDEXTEST_EDITING=1 CINDEXTEST_COMPLETION_CACHING=1 CINDEXTEST_COMPLETION_PREFIX=ap CINDEXTEST_COMPLETION_MAX_RESULTS=1 c-index-test -code-completion-at=%s:9:3 %s | FileCheck -check-prefix=CHECK-MAX %s
+// CHECK-MAX-NOT: apple
+// CHECK-MAX: VarDecl:{ResultType int}{TypedText apricot}
+// CHECK-MAX-NOT: apple
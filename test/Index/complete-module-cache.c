@@ -0,0 +1,17 @@
+// Both submodules declare 'shared'; whichever of them owns the declaration
+// found when the results are cached, it must be offered exactly once, on
+// every reparse.
+
+#include "a.h"
+#include "b.h"
+
+void test(void) {
+
+}
+
+// RUN: rm -rf %t
+// RUN: env CINDEXTEST_EDITING=1 c-index-test -code-completion-at=%s:9:1 -fmodules -fmodules-cache-path=%t -I %S/Inputs/complete-module-cache %s | FileCheck %s
+// CHECK: FunctionDecl:{ResultType int}{TypedText a_only}{LeftParen (}{RightParen )} (50)
+// CHECK: FunctionDecl:{ResultType int}{TypedText b_only}{LeftParen (}{RightParen )} (50)
+// CHECK: FunctionDecl:{ResultType int}{TypedText shared}{LeftParen (}{Placeholder int}{RightParen )} (50)
+// CHECK-NOT: {TypedText shared}
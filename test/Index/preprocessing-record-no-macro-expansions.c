@@ -0,0 +1,14 @@
+#define M(x) x
+#include "a.h"
+int y = M(1);
+
+// RUN: c-index-test -test-load-source all -I%S/Inputs %s | FileCheck %s
+// CHECK: macro definition=M
+// CHECK: inclusion directive=a.h
+// CHECK: macro expansion=M:1:9
+
+// RUN: env CINDEXTEST_SKIP_MACRO_EXPANSIONS_IN_PPREC=1 \
+// RUN:   c-index-test -test-load-source all -I%S/Inputs %s | FileCheck %s --check-prefix=NOEXP
+// NOEXP: macro definition=M
+// NOEXP: inclusion directive=a.h
+// NOEXP-NOT: macro expansion=M
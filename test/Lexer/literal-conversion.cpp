@@ -0,0 +1,25 @@
+// RUN: %clang_cc1 -std=c++14 -triple x86_64-unknown-linux-gnu -verify %s
+
+// Integer literals that are too long to always fit into 64 bits, but do.
+static_assert(18446744073709551615ull == ~0ull, "");
+static_assert(00000000000000000000000000000001 == 1, "");
+static_assert(0x00000000000000000000ffffffffffffffffull == ~0ull, "");
+static_assert(01777777777777777777777ull == ~0ull, "");
+static_assert(0b00001111111111111111111111111111111111111111111111111111111111111111ull == ~0ull, "");
+static_assert(18'446'744'073'709'551'615ull == ~0ull, "");
+static_assert(0xffff'ffff'ffff'ffffull == ~0ull, "");
+
+// And those that don't.
+unsigned long long a = 18446744073709551616ull; // expected-error {{integer literal is too large to be represented in any integer type}}
+unsigned long long b = 0x10000000000000000ull; // expected-error {{integer literal is too large to be represented in any integer type}}
+unsigned long long c = 123456789012345678901234567890123456789012345678901234567890ull; // expected-error {{integer literal is too large to be represented in any integer type}}
+
+// String literals that are copied a word at a time, or not.
+constexpr char Ascii[] = "0123456789abcdef0123456789ABCDEF";
+static_assert(sizeof(Ascii) == 33 && Ascii[16] == '0' && Ascii[31] == 'F', "");
+constexpr char Escapes[] = "0123456789\x41\n0123456789abcdef\\";
+static_assert(sizeof(Escapes) == 30 && Escapes[10] == 'A' && Escapes[11] == '\n' && Escapes[28] == '\\', "");
+constexpr char Utf8[] = "0123456789éabc";
+static_assert(sizeof(Utf8) == 16 && Utf8[10] == '\xc3' && Utf8[12] == 'a', "");
+constexpr char Concat[] = "01234567" "89abcdef" "\\";
+static_assert(sizeof(Concat) == 18 && Concat[16] == '\\', "");
@@ -0,0 +1,3 @@
+struct FromHeader {
+  int member(int X) { return X + 1; }
+};
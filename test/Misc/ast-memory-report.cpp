@@ -0,0 +1,20 @@
+// RUN: %clang_cc1 -fsyntax-only -print-ast-memory -I %S/Inputs %s 2>&1 | FileCheck %s
+
+#include "ast-memory-report.h"
+
+int f(int A, int B) { return A * B + FromHeader().member(A); }
+
+// CHECK: *** AST Memory Report:
+// CHECK-NEXT: {{[0-9]+}} bytes in allocator slabs, {{[0-9]+}} bytes allocated.
+// CHECK-NEXT: {{[0-9]+}} bytes in side tables.
+
+// CHECK: Bytes allocated by node kind:
+// CHECK-DAG: {{[0-9]+}} bytes in {{[0-9]+}} CXXMethodDecl
+// CHECK-DAG: {{[0-9]+}} bytes in {{[0-9]+}} ParmVarDecl
+// CHECK-DAG: {{[0-9]+}} bytes in 3 BinaryOperator{{$}}
+// CHECK-DAG: {{[0-9]+}} bytes in {{[0-9]+}} BuiltinType
+// CHECK: {{[0-9]+}} bytes in {{[0-9]+}} other allocations
+
+// CHECK: Bytes allocated by source file:
+// CHECK-DAG: {{[0-9]+}} bytes in {{[0-9]+}} nodes from {{.*}}ast-memory-report.cpp
+// CHECK-DAG: {{[0-9]+}} bytes in {{[0-9]+}} nodes from {{.*}}Inputs{{/|\\}}ast-memory-report.h
@@ -0,0 +1,29 @@
+// RUN: rm -f %t.first.dia %t.second.dia %t.dia
+// RUN: %clang_cc1 -Wall -fsyntax-only -DFIRST %s -serialize-diagnostic-file %t.first.dia
+// RUN: %clang_cc1 -Wall -fsyntax-only %s -serialize-diagnostic-file %t.second.dia
+// RUN: diagtool merge-serialized -o %t.dia %t.first.dia %t.second.dia
+// RUN: c-index-test -read-diagnostics %t.dia 2>&1 | FileCheck %s
+// RUN: llvm-bcanalyzer -dump %t.dia | FileCheck --check-prefix=DUMP %s
+// RUN: not diagtool merge-serialized -o %t.dia %t.missing.dia 2>&1 \
+// RUN:   | FileCheck --check-prefix=ERROR %s
+
+#ifdef FIRST
+void first() { int unused_first; }
+#else
+void second() { int unused_second; }
+#endif
+
+// CHECK: serialized-diags-merge.c:11:20: warning: unused variable 'unused_first' [-Wunused-variable]
+// CHECK: serialized-diags-merge.c:13:21: warning: unused variable 'unused_second' [-Wunused-variable]
+// CHECK: Number of diagnostics: 2
+
+// The strings that both inputs use are only written once.
+// DUMP: <FileName {{.*}}serialized-diags-merge.c'
+// DUMP-NOT: <FileName
+// DUMP: <DiagFlag {{.*}}unused-variable'
+// DUMP-NOT: <DiagFlag
+// DUMP-NOT: <FileName
+// DUMP: <SourceIndex op0=0 op1=1 {{.*}}.first.dia'
+// DUMP: <SourceIndex op0=1 op1=1 {{.*}}.second.dia'
+
+// ERROR: error: could not merge the diagnostics into
@@ -0,0 +1,17 @@
+// REQUIRES: zlib
+// RUN: rm -rf %t
+// RUN: %clang_cc1 -fdisable-module-hash -fmodules-cache-path=%t/cache -fmodules -fimplicit-module-maps -I %S/Inputs/Modified -fcompress-ast-files %s -verify
+// RUN: head -c 4 %t/cache/ModA.pcm | FileCheck -check-prefix=MAGIC %s
+// MAGIC: CPCZ
+
+// The compressed module files are read back from the module cache rather
+// than rebuilt, which -Rmodule-build would report.
+// RUN: %clang_cc1 -fdisable-module-hash -fmodules-cache-path=%t/cache -fmodules -fimplicit-module-maps -I %S/Inputs/Modified %s -verify -Rmodule-build
+// RUN: %clang_cc1 -module-file-info %t/cache/ModB.pcm | FileCheck -check-prefix=INFO %s
+// INFO: Module name: ModB
+
+// expected-no-diagnostics
+
+@import ModB;
+
+int getValue() { return getA() + getB(); }
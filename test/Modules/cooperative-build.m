@@ -0,0 +1,13 @@
+// Building a module records the modules it imports, for the compilations
+// that wait for it to be built next time.
+// RUN: rm -rf %t
+// RUN: %clang_cc1 -fmodules-cache-path=%t/cache -fmodules -fimplicit-module-maps -I %S/Inputs/Modified -fmodules-cooperative-build %s -verify
+// RUN: cat %t/cache/ModB.imports | FileCheck -check-prefix=IMPORTS-B %s
+// RUN: cat %t/cache/ModA.imports | count 0
+// IMPORTS-B: ModA
+
+// expected-no-diagnostics
+
+@import ModB;
+
+int getValue() { return getA() + getB(); }
@@ -0,0 +1,23 @@
+// REQUIRES: zlib
+// REQUIRES: shell
+//
+// The embedded files of a module are compressed in parallel; check that
+// building the same module twice produces the same file.
+//
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: echo 'module a { header "a.h" header "b.h" header "c.h" header "d.h" }' > %t/modulemap
+// RUN: echo 'int a1, a2, a3;' > %t/a.h
+// RUN: echo '#include "a.h"' > %t/b.h
+// RUN: echo 'struct B { int b; };' >> %t/b.h
+// RUN: cat %t/a.h %t/b.h > %t/c.h
+// RUN: echo 'inline int d() { return 0; }' > %t/d.h
+//
+// RUN: %clang_cc1 -fmodules -I%t -fmodule-name=a -x c++ -emit-module %t/modulemap -fmodules-embed-all-files -o %t/a1.pcm
+// RUN: %clang_cc1 -fmodules -I%t -fmodule-name=a -x c++ -emit-module %t/modulemap -fmodules-embed-all-files -o %t/a2.pcm
+// RUN: cmp %t/a1.pcm %t/a2.pcm
+//
+// RUN: %clang_cc1 -fmodules -I%t -fmodule-map-file=%t/modulemap -fmodule-file=%t/a1.pcm %s -verify
+// expected-no-diagnostics
+#include "d.h"
+int x = d() + a1;
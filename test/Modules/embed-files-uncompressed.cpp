@@ -0,0 +1,18 @@
+// REQUIRES: shell
+//
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: echo 'module a { header "a.h" }' > %t/modulemap
+// RUN: echo 'extern int t;' > %t/a.h
+//
+// RUN: %clang_cc1 -fmodules -I%t -fmodule-name=a -x c++ -emit-module %t/modulemap -fmodules-embed-all-files -fmodules-embed-uncompressed -o %t/a.pcm
+// RUN: llvm-bcanalyzer -dump %t/a.pcm | FileCheck %s
+// CHECK: <SM_SLOC_BUFFER_BLOB
+// CHECK-NOT: <SM_SLOC_BUFFER_BLOB_COMPRESSED
+//
+// The embedded contents are used when the file is gone.
+// RUN: rm %t/a.h
+// RUN: %clang_cc1 -fmodules -I%t -fmodule-map-file=%t/modulemap -fmodule-file=%t/a.pcm %s -verify
+#include "a.h"
+char t; // expected-error {{different type}}
+// expected-note@a.h:1 {{here}}
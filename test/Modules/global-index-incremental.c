@@ -0,0 +1,36 @@
+// RUN: rm -rf %t
+// RUN: mkdir -p %t/include
+// RUN: echo 'module A { header "a.h" } module B { header "b.h" } module C { header "c.h" }' > %t/include/module.modulemap
+// RUN: echo 'int from_a(void);' > %t/include/a.h
+// RUN: echo '#include "a.h"' > %t/include/b.h
+// RUN: echo 'int from_b(void);' >> %t/include/b.h
+// RUN: echo 'int from_c(void);' > %t/include/c.h
+//
+// Build A and C, and an index of them.
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t/cache -fdisable-module-hash -I %t/include %s -DUSE_C -verify
+// RUN: ls %t/cache | grep modules.idx
+//
+// Build B, which updates the index; A and C are taken over from the old one.
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t/cache -fdisable-module-hash -I %t/include %s -DUSE_B -verify
+//
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t/cache -fdisable-module-hash -I %t/include %s -DUSE_B -DUSE_C -verify -print-stats 2>&1 | FileCheck %s
+// CHECK: *** Global Module Index Statistics:
+
+// expected-no-diagnostics
+#ifdef USE_B
+#include "b.h"
+#endif
+#ifdef USE_C
+#include "a.h"
+#include "c.h"
+#endif
+
+int f(void) {
+#ifdef USE_B
+  from_b();
+#endif
+#ifdef USE_C
+  from_c();
+#endif
+  return from_a();
+}
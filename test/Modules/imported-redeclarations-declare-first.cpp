@@ -0,0 +1,41 @@
+// REQUIRES: shell
+//
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: echo 'module a { header "a.h" }' > %t/modulemap
+// RUN: echo 'module b { header "b.h" export * }' >> %t/modulemap
+// RUN: echo 'module c { header "c.h" }' >> %t/modulemap
+// RUN: echo 'module m { module x { header "x.h" } module y { header "y.h" export * } }' >> %t/modulemap
+// RUN: echo 'struct S; int f(int);' > %t/a.h
+// RUN: echo 'struct S { int n; }; int f(int = 1);' > %t/b.h
+// RUN: echo '#include "a.h"' >> %t/b.h
+// RUN: echo 'struct T; int h(int);' > %t/c.h
+// RUN: echo 'int unrelated;' > %t/x.h
+// RUN: echo 'struct T { int n; }; int h(int = 2);' > %t/y.h
+// RUN: echo '#include "c.h"' >> %t/y.h
+//
+// The modules declare the entities before importing their other declarations,
+// so the imported declarations are merged into the local ones. The local
+// declarations are still indexed under the imported ones.
+// RUN: %clang_cc1 -fmodules -I%t -fmodule-name=a -x c++ -emit-module %t/modulemap -o %t/a.pcm
+// RUN: %clang_cc1 -fmodules -I%t -fmodule-name=b -x c++ -emit-module %t/modulemap -fmodule-file=%t/a.pcm -o %t/b.pcm
+// RUN: %clang_cc1 -fmodules -fmodules-local-submodule-visibility -I%t -fmodule-name=c -x c++ -emit-module %t/modulemap -o %t/c.pcm
+// RUN: %clang_cc1 -fmodules -fmodules-local-submodule-visibility -I%t -fmodule-name=m -x c++ -emit-module %t/modulemap -fmodule-file=%t/c.pcm -o %t/m.pcm
+// RUN: llvm-bcanalyzer -dump %t/b.pcm | FileCheck %s
+// RUN: llvm-bcanalyzer -dump %t/m.pcm | FileCheck %s
+// CHECK: <IMPORTED_REDECLARATIONS
+//
+// RUN: %clang_cc1 -fmodules -I%t -fmodule-map-file=%t/modulemap -fmodule-file=%t/a.pcm -fmodule-file=%t/b.pcm %s -verify
+// RUN: %clang_cc1 -fmodules -fmodules-local-submodule-visibility -I%t -fmodule-map-file=%t/modulemap -fmodule-file=%t/c.pcm -fmodule-file=%t/m.pcm %s -verify -DLOCAL_VISIBILITY
+// expected-no-diagnostics
+#ifndef LOCAL_VISIBILITY
+#include "a.h"
+#include "b.h"
+
+int x = f() + sizeof(S);
+#else
+#include "c.h"
+#include "y.h"
+
+int y = h() + sizeof(T);
+#endif
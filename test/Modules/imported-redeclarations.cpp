@@ -0,0 +1,30 @@
+// REQUIRES: shell
+//
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: echo 'module a { header "a.h" }' > %t/modulemap
+// RUN: echo 'module b { header "b.h" export * }' >> %t/modulemap
+// RUN: echo 'module c { header "c.h" }' >> %t/modulemap
+// RUN: echo 'struct S; int f(int); int g(int);' > %t/a.h
+// RUN: echo '#include "a.h"' > %t/b.h
+// RUN: echo 'struct S { int n; }; int f(int = 1);' >> %t/b.h
+// RUN: echo 'int g(int = 2);' > %t/c.h
+//
+// RUN: %clang_cc1 -fmodules -I%t -fmodule-name=a -x c++ -emit-module %t/modulemap -o %t/a.pcm
+// RUN: %clang_cc1 -fmodules -I%t -fmodule-name=b -x c++ -emit-module %t/modulemap -fmodule-file=%t/a.pcm -o %t/b.pcm
+// RUN: %clang_cc1 -fmodules -I%t -fmodule-name=c -x c++ -emit-module %t/modulemap -o %t/c.pcm
+// RUN: llvm-bcanalyzer -dump %t/a.pcm | FileCheck %s --check-prefix=NO-INDEX
+// RUN: llvm-bcanalyzer -dump %t/b.pcm | FileCheck %s --check-prefix=INDEX
+// RUN: llvm-bcanalyzer -dump %t/c.pcm | FileCheck %s --check-prefix=NO-INDEX
+// NO-INDEX-NOT: <IMPORTED_REDECLARATIONS
+// INDEX: <IMPORTED_REDECLARATIONS
+//
+// The redeclarations in b are found through its index, and the independent
+// declaration in c by looking up its name.
+// RUN: %clang_cc1 -fmodules -I%t -fmodule-map-file=%t/modulemap -fmodule-file=%t/a.pcm -fmodule-file=%t/b.pcm -fmodule-file=%t/c.pcm %s -verify
+// expected-no-diagnostics
+#include "a.h"
+#include "b.h"
+#include "c.h"
+
+int x = f() + g() + sizeof(S);
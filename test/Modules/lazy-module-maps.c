@@ -0,0 +1,35 @@
+// RUN: rm -rf %t
+// RUN: mkdir -p %t/used %t/broken
+// RUN: echo 'int used(void);' > %t/used/used.h
+// RUN: echo 'module Used { header "used.h" }' > %t/used/module.modulemap
+// RUN: echo 'int broken(void);' > %t/broken/broken.h
+// RUN: echo 'module Broken { requires }' > %t/broken/module.modulemap
+
+// When module maps are parsed eagerly, the error in the unused module map is
+// diagnosed.
+// RUN: not %clang_cc1 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t/cache \
+// RUN:   -fmodule-map-file=%t/broken/module.modulemap -I %t/used \
+// RUN:   -fsyntax-only %s 2>&1 | FileCheck %s --check-prefix=CHECK-BROKEN
+
+// When they are parsed lazily, only the modules the compilation needs are
+// parsed.
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t/cache \
+// RUN:   -fmodules-lazy-module-maps \
+// RUN:   -fmodule-map-file=%t/broken/module.modulemap -I %t/used \
+// RUN:   -fsyntax-only %s -verify -Rmodule-build
+
+// Including a header below the broken module map's directory parses it.
+// RUN: not %clang_cc1 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t/cache \
+// RUN:   -fmodules-lazy-module-maps \
+// RUN:   -fmodule-map-file=%t/broken/module.modulemap -I %t/used -I %t/broken \
+// RUN:   -fsyntax-only %s -DINCLUDE_BROKEN 2>&1 | FileCheck %s --check-prefix=CHECK-BROKEN
+
+// CHECK-BROKEN: module.modulemap:1:{{[0-9]+}}: error: expected a feature name
+
+#include "used.h" // expected-remark{{building module 'Used' as}} expected-remark{{finished building module 'Used'}}
+
+#ifdef INCLUDE_BROKEN
+#include "broken.h"
+#endif
+
+int test(void) { return used(); }
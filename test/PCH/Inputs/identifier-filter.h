@@ -0,0 +1 @@
+extern int known_to_the_pch;
@@ -0,0 +1,22 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: echo one > %t/data.txt
+// RUN: cp %s %t/embed.h
+// RUN: %clang_cc1 -x c-header -I %t -emit-pch -o %t/embed.pch %t/embed.h
+// RUN: %clang_cc1 -include-pch %t/embed.pch -fsyntax-only %s
+//
+// The embedded file is an input of the PCH, which is stale once it changes.
+// RUN: llvm-bcanalyzer -dump %t/embed.pch | FileCheck %s
+// CHECK: data.txt
+// RUN: sleep 1 && echo three > %t/data.txt
+// RUN: not %clang_cc1 -include-pch %t/embed.pch -fsyntax-only %s 2>&1 \
+// RUN:   | FileCheck --check-prefix=STALE %s
+// STALE: file '{{.*}}data.txt' has been modified since the precompiled header
+
+#ifndef HEADER
+#define HEADER
+const char data[] = {
+#embed "data.txt"
+};
+#else
+_Static_assert(sizeof(data) == 4, "embedded when the PCH was built");
+#endif
@@ -0,0 +1,16 @@
+// Identifiers that the PCH doesn't know are ruled out by its identifier
+// filter instead of being looked up in its identifier table.
+
+// RUN: %clang_cc1 -x c-header -emit-pch -o %t.pch %S/Inputs/identifier-filter.h
+// RUN: %clang_cc1 -include-pch %t.pch -fsyntax-only -print-stats %s 2>&1 \
+// RUN:   | FileCheck %s
+
+// CHECK: identifier table lookups succeeded
+// CHECK: identifier table lookups avoided by identifier filters
+
+int unknown_to_the_pch_1 = 1;
+int unknown_to_the_pch_2 = 2;
+int unknown_to_the_pch_3 = 3;
+int unknown_to_the_pch_4 = 4;
+
+int use(void) { return known_to_the_pch + unknown_to_the_pch_1; }
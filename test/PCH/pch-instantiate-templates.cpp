@@ -0,0 +1,22 @@
+// Without -fpch-instantiate-templates the instantiation is left to the
+// translation unit that uses the PCH.
+// RUN: %clang_cc1 -x c++-header -std=c++11 -emit-pch -o %t.pch %s
+// RUN: not %clang_cc1 -std=c++11 -include-pch %t.pch -fsyntax-only %s 2>&1 \
+// RUN:   | FileCheck --check-prefix=CHECK-USE %s
+
+// With it, the instantiation is performed while building the PCH.
+// RUN: %clang_cc1 -x c++-header -std=c++11 -emit-pch -verify \
+// RUN:   -fpch-instantiate-templates -o %t.inst.pch %s
+
+// CHECK-USE: error: static_assert failed "instantiated"
+
+#ifndef HEADER
+#define HEADER
+
+template <typename T> void f() {
+  static_assert(sizeof(T) == 0, "instantiated"); // expected-error {{instantiated}}
+}
+
+inline void g() { f<int>(); } // expected-note {{in instantiation of}}
+
+#endif
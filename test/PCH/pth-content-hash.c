@@ -0,0 +1,13 @@
+// Cached tokens are validated against the contents of the file they were
+// lexed from, not its size or modification time.
+//
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: echo 'int stale_decl;' > %t/header.h
+// RUN: %clang_cc1 -triple i386-unknown-unknown -emit-pth -o %t/header.pth %t/header.h
+// RUN: echo 'int fresh_decl;' > %t/header.h
+// RUN: %clang_cc1 -triple i386-unknown-unknown -include-pth %t/header.pth -E %s | FileCheck %s
+
+// CHECK-NOT: stale_decl
+// CHECK: int fresh_decl;
+// CHECK-NOT: stale_decl
+int main_decl;
@@ -0,0 +1,83 @@
+// Test that a PCH file stores the layouts of the records it defines, and that
+// the translation units using it get the same layouts from it.
+
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -std=c++11 -x c++-header -emit-pch -o %t.itanium %s
+// RUN: llvm-bcanalyzer -dump %t.itanium | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -std=c++11 -DITANIUM -include-pch %t.itanium -fsyntax-only -verify %s
+
+// RUN: %clang_cc1 -triple i686-pc-win32 -std=c++11 -x c++-header -emit-pch -o %t.ms %s
+// RUN: llvm-bcanalyzer -dump %t.ms | FileCheck %s
+// RUN: %clang_cc1 -triple i686-pc-win32 -std=c++11 -include-pch %t.ms -fsyntax-only -verify %s
+
+// CHECK: <RECORD_LAYOUTS
+
+#ifndef HEADER
+#define HEADER
+
+struct Empty {};
+struct A {
+  int a;
+  virtual ~A();
+};
+struct B : virtual A {
+  char b;
+};
+struct C : Empty, B {
+  short c;
+};
+struct Bits {
+  int x : 3;
+  int y : 5;
+  char z;
+};
+template <typename T> struct Wrapper : C {
+  T t;
+};
+typedef char InstantiateWrapper[sizeof(Wrapper<double>)];
+
+#else
+// expected-no-diagnostics
+
+// The same records, laid out in this translation unit.
+struct A2 {
+  int a;
+  virtual ~A2();
+};
+struct B2 : virtual A2 {
+  char b;
+};
+struct C2 : Empty, B2 {
+  short c;
+};
+struct Bits2 {
+  int x : 3;
+  int y : 5;
+  char z;
+};
+struct Wrapper2 : C2 {
+  double t;
+};
+
+static_assert(sizeof(A) == sizeof(A2) && alignof(A) == alignof(A2), "");
+static_assert(sizeof(B) == sizeof(B2) && alignof(B) == alignof(B2), "");
+static_assert(sizeof(C) == sizeof(C2) && alignof(C) == alignof(C2), "");
+static_assert(sizeof(Bits) == sizeof(Bits2), "");
+static_assert(__builtin_offsetof(Bits, z) == __builtin_offsetof(Bits2, z), "");
+static_assert(sizeof(Wrapper<double>) == sizeof(Wrapper2), "");
+
+// A record that derives from one laid out in the PCH.
+struct D : C {
+  char d;
+};
+struct D2 : C2 {
+  char d;
+};
+static_assert(sizeof(D) == sizeof(D2), "");
+
+#ifdef ITANIUM
+static_assert(sizeof(A) == 16, "");
+static_assert(sizeof(B) == 32, "");
+static_assert(sizeof(C) == 32, "");
+static_assert(sizeof(Bits) == 4 && __builtin_offsetof(Bits, z) == 1, "");
+#endif
+#endif
@@ -0,0 +1,44 @@
+// Test that a PCH file records how many types of each class it contains, and
+// that types which are uniqued by their profile hash are still found when
+// the PCH is loaded.
+
+// RUN: %clang_cc1 -std=c++17 -x c++-header -emit-pch -o %t %s
+// RUN: llvm-bcanalyzer -dump %t | FileCheck %s
+// RUN: %clang_cc1 -std=c++17 -include-pch %t -fsyntax-only -verify %s
+
+// CHECK: <TYPE_CLASS_COUNTS
+
+#ifndef HEADER
+#define HEADER
+
+template <typename... T> struct List {};
+template <typename T, typename U> struct Pair {};
+
+using Types = List<int, char, Pair<int, List<long, short>>>;
+using Fn = int (*)(Pair<int, char>, List<>, long) noexcept;
+
+template <typename T> struct Outer {
+  template <typename U> struct Inner {};
+  using Dependent = typename T::template Inner<T, Pair<T, int>>;
+};
+
+#else
+// expected-no-diagnostics
+
+template <typename T, typename U> struct SameType {
+  static const bool value = false;
+};
+template <typename T> struct SameType<T, T> {
+  static const bool value = true;
+};
+
+static_assert(
+    SameType<Types, List<int, char, Pair<int, List<long, short>>>>::value, "");
+static_assert(
+    SameType<Fn, int (*)(Pair<int, char>, List<>, long) noexcept>::value, "");
+
+template <typename T> struct Outer2 {
+  using Dependent = typename T::template Inner<T, Pair<T, int>>;
+};
+static_assert(SameType<Outer<int>, Outer<int>>::value, "");
+#endif
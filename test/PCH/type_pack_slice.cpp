@@ -0,0 +1,19 @@
+// RUN: %clang_cc1 -std=c++14 -x c++-header %s -emit-pch -o %t.pch
+// RUN: %clang_cc1 -std=c++14 -x c++ /dev/null -include-pch %t.pch
+
+template <int i>
+struct X { };
+
+template <typename ...T>
+struct List { };
+
+using SizeT = decltype(sizeof(int));
+
+template <SizeT Begin, SizeT End, typename ...T>
+using Slice = __type_pack_slice<List, Begin, End, T...>;
+
+void fn1() {
+  List<X<0>> x0 = Slice<0, 1, X<0>, X<1>, X<2>>{};
+  List<X<1>, X<2>> x1 = Slice<1, 3, X<0>, X<1>, X<2>>{};
+  List<> x2 = Slice<2, 2, X<0>, X<1>, X<2>>{};
+}
@@ -0,0 +1,23 @@
+// Test this without pch.
+// RUN: %clang_cc1 -std=c++11 -include %s -fsyntax-only -ast-dump -ast-dump-filter typelocs %s | FileCheck %s
+
+// Test with pch. The locations of a TypeLoc are written as the differences
+// between consecutive locations; they must read back the same.
+// RUN: %clang_cc1 -std=c++11 -emit-pch -o %t %s
+// RUN: %clang_cc1 -std=c++11 -include-pch %t -fsyntax-only -ast-dump-all -ast-dump-filter typelocs %s | FileCheck %s
+
+#ifndef HEADER
+#define HEADER
+
+#define PTR(T) T *
+void typelocs(const int *P, int (&A)[4], PTR(char) M, void (*G)(int));
+
+#else
+
+// CHECK: FunctionDecl {{.*}} <{{.*}}:13:1, col:68> col:6{{( imported)?}} typelocs 'void (const int *, int (&)[4], char *, void (*)(int))'
+// CHECK-NEXT: ParmVarDecl {{.*}} <col:15, col:26> col:26{{( imported)?}} P 'const int *'
+// CHECK-NEXT: ParmVarDecl {{.*}} <col:29, col:39> col:35{{( imported)?}} A 'int (&)[4]'
+// CHECK-NEXT: ParmVarDecl {{.*}} col:52{{( imported)?}} M 'char *'
+// CHECK-NEXT: ParmVarDecl {{.*}} <col:55, col:68> col:62{{( imported)?}} G 'void (*)(int)'
+
+#endif
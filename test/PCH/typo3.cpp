@@ -0,0 +1,18 @@
+// RUN: %clang_cc1 -emit-pch %s -o %t.pch
+// RUN: %clang_cc1 -include-pch %t.pch %s -verify
+
+// Typo correction finds names of different lengths in the PCH, reusing its
+// index of the PCH's identifiers after the first correction.
+
+#ifndef HEADER_INCLUDED
+#define HEADER_INCLUDED
+
+int counter; // expected-note {{'counter' declared here}}
+int accumulatedTotal; // expected-note {{'accumulatedTotal' declared here}}
+
+#else
+
+int a = countr; // expected-error {{use of undeclared identifier 'countr'; did you mean 'counter'?}}
+int b = acumulatedTotals; // expected-error {{use of undeclared identifier 'acumulatedTotals'; did you mean 'accumulatedTotal'?}}
+
+#endif
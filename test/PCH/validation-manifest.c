@@ -0,0 +1,32 @@
+// RUN: rm -rf %t.dir
+// RUN: mkdir -p %t.dir
+// RUN: echo 'int x;' > %t.dir/header.h
+// RUN: %clang_cc1 -x c-header %t.dir/header.h -emit-pch -o %t.dir/header.pch
+
+// The first compilation of the build session validates the input files of
+// the PCH and records it in the manifest.
+// RUN: %clang_cc1 %s -include-pch %t.dir/header.pch -fsyntax-only -verify \
+// RUN:   -fbuild-session-timestamp=1000 \
+// RUN:   -fmodules-validation-manifest=%t.dir/manifest
+// RUN: ls %t.dir | FileCheck -check-prefix=MANIFEST %s
+// MANIFEST: manifest
+
+// Later compilations of the same session trust the manifest and don't look
+// at the header again.
+// RUN: echo 'int x, y;' > %t.dir/header.h
+// RUN: %clang_cc1 %s -include-pch %t.dir/header.pch -fsyntax-only -verify \
+// RUN:   -fbuild-session-timestamp=1000 \
+// RUN:   -fmodules-validation-manifest=%t.dir/manifest
+
+// A new session validates the input files again.
+// RUN: not %clang_cc1 %s -include-pch %t.dir/header.pch -fsyntax-only \
+// RUN:   -fbuild-session-timestamp=2000 \
+// RUN:   -fmodules-validation-manifest=%t.dir/manifest 2>&1 \
+// RUN:   | FileCheck -check-prefix=MODIFIED %s
+// RUN: not %clang_cc1 %s -include-pch %t.dir/header.pch -fsyntax-only 2>&1 \
+// RUN:   | FileCheck -check-prefix=MODIFIED %s
+// MODIFIED: fatal error: file {{.*}}header.h' has been modified since the precompiled header {{.*}} was built
+
+// expected-no-diagnostics
+
+int *p = &x;
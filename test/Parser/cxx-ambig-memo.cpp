@@ -0,0 +1,31 @@
+// RUN: %clang_cc1 -fsyntax-only -verify %s
+// RUN: %clang_cc1 -fsyntax-only -print-stats %s 2>&1 | FileCheck %s
+// expected-no-diagnostics
+
+// Disambiguation inside nested declarators and template argument lists is
+// answered from the tentative parse memo table; make sure the answers are
+// the same as when they are computed afresh.
+
+template <int N> struct A { static const int value = N; };
+template <class T> struct B { typedef T type; };
+
+int n;
+
+A<(((((1)))))> a1;
+B<int(int(int(int)))>::type *f1;
+B<A<((1 + 2))> > b1;
+int f2(int(int(int(int))));
+
+static_assert(A<((((2))))>::value == 2, "");
+static_assert(sizeof(B<int(int(int))>) == sizeof(B<int (*)(int (*)(int))>), "");
+
+void g() {
+  B<int(int(int))>::type *p = 0;
+  A<((3))> a2;
+  (void)p;
+  (void)a2;
+}
+
+// CHECK: *** Parser Stats:
+// CHECK-NEXT: {{[0-9]+}} tentative parses.
+// CHECK-NEXT: {{[0-9]+}} disambiguation queries answered from the memo table.
@@ -0,0 +1,48 @@
+// RUN: %clang_cc1 -E -I %S/Inputs %s | FileCheck %s
+//
+// The preprocessed output embeds the same files, even from elsewhere, and
+// bytes that don't fit in a signed char still initialize a char array in C++.
+// RUN: %clang_cc1 -E -I %S/Inputs -x c++ %s -o %t.ii
+// RUN: cd %T && %clang_cc1 -fsyntax-only -Wno-embed-preprocessor-directive-pedantic -x c++ %t.ii
+// RUN: %clang_cc1 -E -I %S/Inputs -dependency-file %t.d -MT embed.o %s -o /dev/null
+// RUN: FileCheck -check-prefix=DEPS %s < %t.d
+// RUN: %clang_cc1 -fsyntax-only -verify -Wembed-preprocessor-directive-pedantic -I %S/Inputs -DVERIFY %s
+// RUN: %clang_cc1 -fsyntax-only -verify -Wembed-preprocessor-directive-pedantic -I %S/Inputs -DVERIFY -x c++ %s
+
+#if !__has_extension(embed_directive)
+#error "#embed is not supported"
+#endif
+
+// The bytes of the file are not lexed, so the unmatched quote is fine.
+const char text[] = {
+#embed "embed.txt" // expected-warning {{#embed is a Clang extension}}
+};
+// CHECK: {{^}}#embed "{{.*}}Inputs{{/|\\\\}}embed.txt"{{$}}
+// DEPS: embed.o:
+// DEPS: Inputs{{/|\\}}embed.txt
+
+const unsigned char angled[] = {
+#embed <embed.txt> // expected-warning {{#embed is a Clang extension}}
+};
+
+const char utf8[] = {
+#embed "embed-utf8.txt" // expected-warning {{#embed is a Clang extension}}
+};
+// CHECK: {{^}}#embed "{{.*}}Inputs{{/|\\\\}}embed-utf8.txt"{{$}}
+
+_Static_assert(sizeof(text) == 5, "one element per byte");
+_Static_assert(sizeof(angled) == 5, "one element per byte");
+_Static_assert(sizeof(utf8) == 6, "one element per byte");
+
+#ifdef VERIFY
+const char extra[] = {
+#embed "embed.txt" extra // expected-warning {{#embed is a Clang extension}} expected-warning {{extra tokens at end of #embed directive}}
+};
+
+#define ID(x) x
+ID(
+#embed "embed.txt" // expected-error {{embedding a #embed directive within macro arguments is not supported}}
+)
+
+#embed "missing.txt" // expected-warning {{#embed is a Clang extension}} expected-error {{'missing.txt' file not found}}
+#endif
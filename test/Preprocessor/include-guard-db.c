@@ -0,0 +1,22 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: printf '#ifndef GUARDED_H\n#define GUARDED_H\nint guarded;\n#endif\n' > %t/guarded.h
+
+// The first compilation enters the header and records its guard.
+// RUN: %clang_cc1 -fsyntax-only -print-stats -I %t -finclude-guard-db=%t/guards.db %s 2>&1 \
+// RUN:   | FileCheck %s --check-prefix=FIRST
+// FIRST: 0 #includes skipped using the include guard database.
+
+// A compilation that already defines the guard skips the header without
+// entering it.
+// RUN: %clang_cc1 -fsyntax-only -print-stats -I %t -finclude-guard-db=%t/guards.db -DGUARDED_H %s 2>&1 \
+// RUN:   | FileCheck %s --check-prefix=SKIP
+// SKIP: 1 #includes skipped using the include guard database.
+
+// Once the header's contents change, the recorded guard is not trusted.
+// RUN: printf '#ifndef OTHER_H\n#define OTHER_H\nint guarded;\n#endif\n' > %t/guarded.h
+// RUN: %clang_cc1 -fsyntax-only -print-stats -I %t -finclude-guard-db=%t/guards.db -DGUARDED_H %s 2>&1 \
+// RUN:   | FileCheck %s --check-prefix=FIRST
+
+#include "guarded.h"
+
+int x;
@@ -0,0 +1,16 @@
+// RUN: %clang_cc1 -E -print-stats %s 2> %t.stats | FileCheck %s
+// RUN: FileCheck -check-prefix=STATS %s < %t.stats
+
+#define ID(x) x
+#define ONE 1
+
+// Pre-expanded arguments of nested expansions share one arena.
+// CHECK: int a = 1;
+int a = ID(ONE);
+// CHECK: int b = 1;
+int b = ID(ID(ONE));
+// CHECK: int c = 1 + 1;
+int c = ID(ID(ONE) + ID(ONE));
+
+// STATS: 2 max nested function-like macro expansions, {{[0-9]+}} argument tokens pre-expanded, {{[0-9]+}} tokens copied into argument substitutions.
+// STATS: Macro Argument Arena:
@@ -0,0 +1,10 @@
+// RUN: %clang_cc1 -E %s | FileCheck -strict-whitespace %s
+
+// Digraphs and punctuators split across lines keep their spelling.
+int a<::> = <% 1 %>;
+// CHECK: {{^}}int a<::> = <% 1 %>;
+int b = 1 <\
+<= 2 -> c ... d;
+// CHECK: {{^}}int b = 1 <<= 2 -> c ... d;
+    int e = b [0] ;
+// CHECK: {{^}}    int e = b [0] ;
@@ -0,0 +1,21 @@
+// RUN: %clang_cc1 -fsyntax-only -verify %s
+// RUN: %clang_cc1 -fsyntax-only -verify=ignored -Wno-unsequenced %s
+
+// ignored-no-diagnostics
+
+// The unsequenced check is skipped only while the warning is ignored in every
+// diagnostic state; a pragma that enables it again must bring it back.
+
+void f(int i) {
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunsequenced"
+  i = i++;
+#pragma clang diagnostic pop
+  i = i++; // expected-warning {{multiple unsequenced modifications to 'i'}}
+}
+
+#pragma clang diagnostic ignored "-Wunsequenced"
+
+void g(int i) {
+  i = i++;
+}
@@ -0,0 +1,31 @@
+// RUN: %clang_cc1 -fsyntax-only -verify %s
+
+// Derived-to-base checks and member lookup in the bases of a class that is
+// not dependent use the set of all of its bases, which is computed once.
+
+struct A { int a; static int s; }; // expected-note {{member found by ambiguous name lookup}}
+struct B1 : A {};
+struct B2 : A {};
+struct D : B1, B2 {};
+struct VB1 : virtual A {};
+struct VB2 : virtual A {};
+struct VD : VB1, VB2 {};
+struct Unrelated {};
+
+void test(D *d, VD *vd) {
+  (void)d->a; // expected-error {{non-static member 'a' found in multiple base-class subobjects of type 'A':}}
+  (void)d->s;
+  (void)vd->a;
+  A *pa = d; // expected-error {{ambiguous conversion from derived class 'D' to base class 'A':}}
+  A *pva = vd;
+  Unrelated *pu = vd; // expected-error {{cannot initialize a variable of type 'Unrelated *' with an lvalue of type 'VD *'}}
+  (void)d->missing; // expected-error {{no member named 'missing' in 'D'}}
+}
+
+// A deep chain of bases, as built by CRTP and mixins.
+template <int N> struct Chain : Chain<N - 1> { int get(); };
+template <> struct Chain<0> { int base; };
+
+int deep(Chain<64> &c) { return c.base + c.get(); }
+Chain<0> &up(Chain<64> &c) { return c; }
+Chain<64> &down(Chain<0> &c) { return c; } // expected-error {{non-const lvalue reference to type 'Chain<64>' cannot bind to a value of unrelated type 'Chain<0>'}}
@@ -0,0 +1,67 @@
+// RUN: %clang_cc1 -std=c++14 -fsyntax-only -verify %s
+// expected-no-diagnostics
+
+// Copies of an array value share their elements until one of them is
+// modified. Check that modifying a copy never changes the original, and the
+// other way around.
+
+struct Arr {
+  int Elts[8];
+};
+
+struct Nested {
+  Arr Rows[3];
+  int Filler[100];
+};
+
+constexpr Arr modified(Arr A, int I, int V) {
+  A.Elts[I] = V;
+  return A;
+}
+
+constexpr bool copyIsIndependent() {
+  Arr A = {{1, 2, 3}};
+  Arr B = A;
+  B.Elts[0] = 10;
+  Arr C = B;
+  C.Elts[7] = 20;
+  A.Elts[1] = 30;
+  return A.Elts[0] == 1 && A.Elts[1] == 30 && A.Elts[7] == 0 &&
+         B.Elts[0] == 10 && B.Elts[1] == 2 && B.Elts[7] == 0 &&
+         C.Elts[0] == 10 && C.Elts[1] == 2 && C.Elts[7] == 20;
+}
+static_assert(copyIsIndependent(), "");
+
+constexpr Arr Original = {{1, 2, 3, 4}};
+constexpr Arr Changed = modified(Original, 2, 42);
+static_assert(Original.Elts[2] == 3 && Changed.Elts[2] == 42, "");
+static_assert(Original.Elts[3] == 4 && Changed.Elts[3] == 4, "");
+
+constexpr bool nestedCopyIsIndependent() {
+  Nested N = {};
+  N.Rows[1].Elts[5] = 5;
+  Nested M = N;
+  M.Rows[1].Elts[5] = 6;
+  M.Rows[2] = N.Rows[1];
+  M.Filler[99] = 7;
+  Nested O = M;
+  O.Rows[2].Elts[5] += 10;
+  return N.Rows[1].Elts[5] == 5 && N.Rows[2].Elts[5] == 0 &&
+         N.Filler[99] == 0 && M.Rows[1].Elts[5] == 6 &&
+         M.Rows[2].Elts[5] == 5 && M.Filler[99] == 7 &&
+         O.Rows[2].Elts[5] == 15 && O.Filler[99] == 7 && O.Filler[0] == 0;
+}
+static_assert(nestedCopyIsIndependent(), "");
+
+constexpr int sumAfterCopies(int N) {
+  Arr A = {};
+  int Sum = 0;
+  for (int I = 0; I != N; ++I) {
+    Arr B = A;
+    B.Elts[I % 8] += I;
+    Sum += B.Elts[I % 8] + A.Elts[I % 8];
+    A = B;
+  }
+  return Sum;
+}
+static_assert(sumAfterCopies(16) == 176, "");
@@ -0,0 +1,39 @@
+// RUN: %clang_cc1 -std=c++14 -fsyntax-only -verify %s
+// RUN: %clang_cc1 -std=c++14 -fsyntax-only -verify %s -DDEPTH -fconstexpr-depth 15
+// RUN: %clang_cc1 -std=c++14 -fsyntax-only -verify %s -DSTEPS -fconstexpr-steps 100
+// RUN: %clang_cc1 -std=c++14 -fsyntax-only -print-stats %s 2>&1 | FileCheck %s
+
+// CHECK: *** Constexpr Call Memo Stats:
+// CHECK-NEXT: {{[0-9]+}} lookups, {{[1-9][0-9]*}} hits
+
+#if !defined(DEPTH) && !defined(STEPS)
+// expected-no-diagnostics
+
+// Without memoization, this would take far more than the default step limit.
+constexpr long long fib(int N) { return N < 2 ? N : fib(N - 1) + fib(N - 2); }
+static_assert(fib(60) == 1548008755920LL, "");
+
+constexpr double power(double X, int N) {
+  return N == 0 ? 1 : N % 2 ? X * power(X, N - 1) : power(X * X, N / 2);
+}
+static_assert(power(2, 10) == 1024, "");
+static_assert(power(2, 10) + power(2, 11) == 3072, "");
+#endif
+
+#ifdef DEPTH
+// A memoized call still counts as deep as the call it replaces.
+constexpr int depth(int N) { return N ? 1 + depth(N - 1) : 0; } // expected-note {{exceeded maximum depth of 15 calls}} expected-note +{{}}
+static_assert(depth(10) == 10, "");
+
+constexpr int wrap(int K, int N) { return K ? wrap(K - 1, N) : depth(N); } // expected-note +{{}}
+static_assert(wrap(3, 10) == 10, "");
+static_assert(wrap(10, 10) == 10, ""); // expected-error {{not an integral constant expression}} expected-note {{in call to}}
+#endif
+
+#ifdef STEPS
+// A memoized call still takes as many steps as the call it replaces.
+// Each call to count(30) takes 34 steps.
+constexpr int count(int N) { int R = 0; for (int I = 0; I != N; ++I) ++R; return R; } // expected-note {{step limit}}
+static_assert(count(30) + count(30) == 60, "");
+static_assert(count(30) + count(30) + count(30) == 90, ""); // expected-error {{not an integral constant expression}} expected-note {{in call to}}
+#endif
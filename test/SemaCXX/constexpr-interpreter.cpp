@@ -0,0 +1,104 @@
+// RUN: %clang_cc1 -std=c++14 -fsyntax-only -verify %s
+// RUN: %clang_cc1 -std=c++14 -fsyntax-only -verify %s -fexperimental-new-constant-interpreter
+// RUN: %clang -std=c++14 -fsyntax-only -Xclang -verify %s -fexperimental-new-constant-interpreter
+
+// Functions that the interpreter can evaluate.
+
+constexpr unsigned crc32Byte(unsigned C) {
+  for (int K = 0; K < 8; ++K)
+    C = C & 1 ? 0xEDB88320u ^ (C >> 1) : C >> 1;
+  return C;
+}
+static_assert(crc32Byte(1) == 0x77073096, "");
+static_assert(crc32Byte(255) == 0x2D02EF8D, "");
+
+constexpr int fib(int N) { return N < 2 ? N : fib(N - 1) + fib(N - 2); }
+static_assert(fib(20) == 6765, "");
+
+constexpr int collatz(long long N) {
+  int Steps = 0;
+  while (N != 1) {
+    N = N % 2 ? 3 * N + 1 : N / 2;
+    ++Steps;
+  }
+  return Steps;
+}
+static_assert(collatz(27) == 111, "");
+
+constexpr int sumNonMultiplesOf3(int N) {
+  int Sum = 0;
+  for (int I = 1; I <= N; I++) {
+    if (I % 3 == 0)
+      continue;
+    if (I > 100)
+      break;
+    Sum += I;
+  }
+  return Sum;
+}
+static_assert(sumNonMultiplesOf3(10) == 37, "");
+static_assert(sumNonMultiplesOf3(1000) == sumNonMultiplesOf3(100), "");
+
+constexpr int digits(unsigned long long N) {
+  int D = 0;
+  do {
+    N /= 10;
+    ++D;
+  } while (N && D < 100);
+  return D;
+}
+static_assert(digits(0) == 1, "");
+static_assert(digits(18446744073709551615ull) == 20, "");
+
+constexpr int incr(int X) {
+  int Y = X++;
+  return ++X + Y;
+}
+static_assert(incr(1) == 4, "");
+
+constexpr signed char wrap(signed char C) { return ++C; }
+static_assert(wrap(127) == -128, "");
+
+constexpr bool both(int A, int B) { return A && !B; }
+static_assert(both(1, 0) && !both(0, 0) && !both(1, 1), "");
+
+constexpr int K = 7;
+constexpr int addK(int X, int Y = K) { return X + Y + sizeof(long long); }
+static_assert(addK(1) == 16, "");
+
+enum class Flags : unsigned char { A = 1, B = 2, C = 4 };
+constexpr Flags operator|(Flags L, Flags R) {
+  return Flags((unsigned char)L | (unsigned char)R);
+}
+static_assert((Flags::A | Flags::C) == Flags(5), "");
+
+template <int N> struct S {
+  static constexpr int twice(int X) { return N * X; }
+};
+static_assert(S<2>::twice(21) == 42, "");
+
+// Functions that the interpreter falls back on the tree walker for.
+
+constexpr int arraySum() {
+  int A[3] = {1, 2, 3};
+  int Sum = 0;
+  for (int X : A)
+    Sum += X;
+  return Sum;
+}
+static_assert(arraySum() == 6, "");
+
+constexpr int twice(int N) {
+  return N * 2; // expected-note {{value 4294967294 is outside the range of representable values of type 'int'}}
+}
+static_assert(twice(0x7fffffff), ""); // expected-error {{static_assert expression is not an integral constant expression}} expected-note {{in call to 'twice(2147483647)'}}
+
+constexpr int shl(int A, int B) {
+  return A << B; // expected-note {{shift count 32 >= width of type 'int'}}
+}
+static_assert(shl(1, 32), ""); // expected-error {{static_assert expression is not an integral constant expression}} expected-note {{in call to 'shl(1, 32)'}}
+
+constexpr int divide(int A, int B) {
+  return A / B; // expected-note {{division by zero}}
+}
+static_assert(divide(1, 0), ""); // expected-error {{static_assert expression is not an integral constant expression}} expected-note {{in call to 'divide(1, 0)'}}
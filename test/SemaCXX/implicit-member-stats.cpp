@@ -0,0 +1,60 @@
+// RUN: %clang_cc1 -std=c++11 -fsyntax-only -verify %s
+// RUN: %clang_cc1 -std=c++11 -fsyntax-only -print-stats -DSTATS %s 2>&1 | FileCheck %s
+
+// Neither the temporaries nor the type traits below need the implicit
+// destructors to be declared; the copy constructor of Trivial is declared by
+// the lookup of its constructors, but the move constructor is the one used.
+
+// CHECK: 1/1 implicit default constructors declared but never referenced.
+// CHECK: 1/1 implicit copy constructors declared but never referenced.
+// CHECK: 0/1 implicit move constructors declared but never referenced.
+// CHECK: 0/0 implicit destructors declared but never referenced.
+
+struct Trivial {
+  int X;
+};
+Trivial make();
+
+void test() {
+  make();
+  Trivial T = make();
+  (void)T;
+  Trivial Array[2] = {make(), make()};
+  (void)Array;
+}
+
+static_assert(__is_destructible(Trivial), "");
+static_assert(__is_trivially_destructible(Trivial), "");
+static_assert(__is_nothrow_destructible(Trivial), "");
+static_assert(!__has_virtual_destructor(Trivial), "");
+
+#ifndef STATS
+struct Deleted {
+  ~Deleted() = delete;
+};
+struct HasDeleted {
+  Deleted D;
+};
+static_assert(!__is_destructible(Deleted), "");
+static_assert(!__is_destructible(HasDeleted), "");
+
+struct Base {
+  virtual ~Base();
+};
+struct Derived : Base {};
+struct Polymorphic {
+  virtual void f();
+};
+static_assert(__has_virtual_destructor(Derived), "");
+static_assert(!__has_virtual_destructor(Polymorphic), "");
+
+struct NonTrivial {
+  ~NonTrivial();
+};
+struct HasNonTrivial {
+  NonTrivial N;
+};
+static_assert(__is_destructible(HasNonTrivial), "");
+static_assert(!__is_trivially_destructible(HasNonTrivial), "");
+static_assert(__is_nothrow_destructible(HasNonTrivial), "");
+#endif
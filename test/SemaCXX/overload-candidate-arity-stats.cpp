@@ -0,0 +1,25 @@
+// RUN: %clang_cc1 -fsyntax-only -verify %s
+// RUN: not %clang_cc1 -fsyntax-only -print-stats %s 2>&1 | FileCheck %s
+
+// CHECK: {{[1-9][0-9]*}} overload candidates rejected on arity.
+
+// Candidates rejected on arity alone are still noted when no candidate is
+// viable.
+template <typename T> void f(T x); // expected-note {{requires single argument 'x', but 2 arguments were provided}}
+template <typename T, typename U> void f(T, U, int); // expected-note {{requires 3 arguments, but 2 were provided}}
+void f(int, int, int, int); // expected-note {{requires 4 arguments, but 2 were provided}}
+
+struct S {
+  template <typename T> void g(T, T); // expected-note {{requires 2 arguments, but 1 was provided}}
+  template <typename T> void g(T, T, T);
+  void g(); // expected-note {{requires 0 arguments, but 1 was provided}}
+  template <typename... Ts> void h(Ts...);
+  template <typename T> void h(T, T);
+};
+
+void test(S s) {
+  f(1, 2); // expected-error {{no matching function for call to 'f'}}
+  s.g(1); // expected-error {{no matching member function for call to 'g'}}
+  s.h(1);
+  s.h(1, 2, 3);
+}
@@ -0,0 +1,66 @@
+// RUN: %clang_cc1 -fsyntax-only -verify -std=c++11 %s
+
+static_assert(__has_builtin(__type_pack_slice), "");
+
+using SizeT = decltype(sizeof(int));
+
+template <typename ...T> struct List;
+
+template <SizeT Begin, SizeT End, typename ...T>
+using Slice = __type_pack_slice<List, Begin, End, T...>;
+
+template <int i>
+struct X;
+
+static_assert(__is_same(Slice<0, 0>, List<>), "");
+static_assert(__is_same(Slice<0, 0, X<0>>, List<>), "");
+static_assert(__is_same(Slice<0, 1, X<0>>, List<X<0>>), "");
+
+static_assert(__is_same(Slice<0, 3, X<0>, X<1>, X<2>>, List<X<0>, X<1>, X<2>>), "");
+static_assert(__is_same(Slice<0, 2, X<0>, X<1>, X<2>>, List<X<0>, X<1>>), "");
+static_assert(__is_same(Slice<1, 3, X<0>, X<1>, X<2>>, List<X<1>, X<2>>), "");
+static_assert(__is_same(Slice<1, 2, X<0>, X<1>, X<2>>, List<X<1>>), "");
+static_assert(__is_same(Slice<2, 2, X<0>, X<1>, X<2>>, List<>), "");
+static_assert(__is_same(Slice<3, 3, X<0>, X<1>, X<2>>, List<>), "");
+
+// Test __type_pack_slice with more than 4 top-level template arguments.
+static_assert(__is_same(__type_pack_slice<List, 1, 3, X<0>, X<1>, X<2>, X<3>>,
+                        List<X<1>, X<2>>), "");
+
+// The result is checked like any other template-id.
+template <typename T, typename U> struct Pair;
+static_assert(__is_same(__type_pack_slice<Pair, 1, 3, X<0>, X<1>, X<2>>,
+                        Pair<X<1>, X<2>>), "");
+using illformed0 = __type_pack_slice<Pair, 0, 1, X<0>>; // expected-error{{too few template arguments for class template 'Pair'}}
+// expected-note@-4{{template is declared here}}
+
+template <SizeT Begin, SizeT End, typename ...T>
+using ErrorSlice1 = __type_pack_slice<List, Begin, End, T...>; // expected-error 2{{is out of bounds for a parameter pack}}
+using illformed1 = ErrorSlice1<1, 3, X<0>, X<1>>;  // expected-note{{in instantiation}}
+using illformed2 = ErrorSlice1<2, 1, X<0>, X<1>>;  // expected-note{{in instantiation}}
+
+namespace huge_packs {
+// Slicing should take time linear in the length of the pack. The pack below
+// is large enough that a quadratic algorithm would time out.
+template <SizeT> struct I;
+template <typename T, T ...N> using Is = List<I<N>...>;
+template <SizeT N> using MakeIs = __make_integer_seq<Is, SizeT, N>;
+
+template <typename L, SizeT Begin, SizeT End> struct SliceOf;
+template <typename ...T, SizeT Begin, SizeT End>
+struct SliceOf<List<T...>, Begin, End> {
+  using type = __type_pack_slice<List, Begin, End, T...>;
+};
+
+template <typename L, typename R> struct Concat;
+template <typename ...L, typename ...R> struct Concat<List<L...>, List<R...>> {
+  using type = List<L..., R...>;
+};
+
+using Big = MakeIs<20000>;
+using Left = SliceOf<Big, 0, 10000>::type;
+using Right = SliceOf<Big, 10000, 20000>::type;
+static_assert(__is_same(Left, MakeIs<10000>), "");
+static_assert(__is_same(Concat<Left, Right>::type, Big), "");
+static_assert(__is_same(SliceOf<Big, 19999, 20000>::type, List<I<19999>>), "");
+}
@@ -0,0 +1,16 @@
+// RUN: %clang_cc1 -fsyntax-only -print-stats %s 2>&1 | FileCheck %s
+
+// f<3>, g<int> and g<char> are queued first; f<2> is only queued while f<3>
+// is instantiated, and f<1> while f<2> is.
+// CHECK: 5 pending instantiations performed in 3 waves, at most 3 in one wave.
+
+template <int N> void f() { f<N - 1>(); }
+template <> void f<0>() {}
+
+template <typename T> void g() {}
+
+void use() {
+  f<3>();
+  g<int>();
+  g<char>();
+}
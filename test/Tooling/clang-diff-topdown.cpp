@@ -1,8 +1,10 @@
 // RUN: %clang_cc1 -E %s > %t.src.cpp
 // RUN: %clang_cc1 -E %s > %t.dst.cpp -DDEST
 // RUN: clang-diff -dump-matches -stop-diff-after=topdown %t.src.cpp %t.dst.cpp -- -std=c++11 | FileCheck %s
+// RUN: clang-diff -dump-matches -max-nodes=1 %t.src.cpp %t.dst.cpp -- -std=c++11 | FileCheck %s
 //
-// Test the top-down matching of identical subtrees only.
+// Test the top-down matching of identical subtrees only, which is all that is
+// done for trees larger than -max-nodes.
 
 #ifndef DEST
 
@@ -0,0 +1,25 @@
+// RUN: clang-layout-audit -derived-from=Base %s -- --target=x86_64-unknown-linux-gnu | FileCheck %s
+// RUN: clang-layout-audit -derived-from=Base -sort=name %s -- --target=x86_64-unknown-linux-gnu | FileCheck -check-prefix=NAME %s
+
+struct Base {
+  void *P;
+  char C;
+};
+
+struct Derived : Base {
+  int I;
+};
+
+struct Unrelated {
+  char C;
+  int I;
+};
+
+// CHECK: size align padding total padding class
+// CHECK-NEXT: 24 8 4 11 Derived
+// CHECK-NEXT: 16 8 7 7 Base
+// CHECK-NOT: Unrelated
+
+// NAME: class
+// NAME-NEXT: Base
+// NAME-NEXT: Derived
@@ -0,0 +1 @@
+int unrelated() { return 0; }
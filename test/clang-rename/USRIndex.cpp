@@ -0,0 +1,18 @@
+class Foo {             // CHECK: class Bar {
+public:
+  Foo() {}              // CHECK: Bar() {}
+};
+
+int main() {
+  Foo F;                // CHECK: Bar F;
+  return 0;
+}
+
+// RUN: clang-rename -write-usr-index=%t.idx %s %S/Inputs/USRIndexUnrelated.cpp --
+// RUN: FileCheck -check-prefix=INDEX %s < %t.idx
+// RUN: clang-rename -usr-index=%t.idx -qualified-name=Foo -new-name=Bar %s %S/Inputs/USRIndexUnrelated.cpp -- | sed 's,//.*,,' | FileCheck %s
+
+// INDEX: F {{.*}}USRIndexUnrelated.cpp
+// INDEX-NOT: c:@S@Foo
+// INDEX: F {{.*}}USRIndex.cpp
+// INDEX: U c:@S@Foo
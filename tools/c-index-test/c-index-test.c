@@ -10,6 +10,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <assert.h>
+#include <time.h>
 
 #ifdef CLANG_HAVE_LIBXML
 #include <libxml/parser.h>
@@ -88,6 +89,10 @@ static unsigned getDefaultParsingOptions() {
     options |= CXTranslationUnit_IncludeAttributedTypes;
   if (getenv("CINDEXTEST_VISIT_IMPLICIT_ATTRIBUTES"))
     options |= CXTranslationUnit_VisitImplicitAttributes;
+  if (getenv("CINDEXTEST_SKIP_MACRO_EXPANSIONS_IN_PPREC"))
+    options |= CXTranslationUnit_SkipMacroExpansionsInPreprocessingRecord;
+  if (getenv("CINDEXTEST_COMPACT_AFTER_PARSE"))
+    options |= CXTranslationUnit_CompactAfterParse;
 
   return options;
 }
@@ -2579,6 +2584,8 @@ int perform_code_completion(int argc, const char **argv, int timing_only) {
   unsigned I, Repeats = 1;
   unsigned completionOptions = clang_defaultCodeCompleteOptions();
   const char *InvocationPath;
+  const char *TypedPrefix = getenv("CINDEXTEST_COMPLETION_PREFIX");
+  const char *MaxResults = getenv("CINDEXTEST_COMPLETION_MAX_RESULTS");
 
   if (getenv("CINDEXTEST_CODE_COMPLETE_PATTERNS"))
     completionOptions |= CXCodeComplete_IncludeCodePatterns;
@@ -2630,9 +2637,15 @@ int perform_code_completion(int argc, const char **argv, int timing_only) {
   }
 
   for (I = 0; I != Repeats; ++I) {
-    results = clang_codeCompleteAt(TU, filename, line, column,
-                                   unsaved_files, num_unsaved_files,
-                                   completionOptions);
+    if (TypedPrefix || MaxResults)
+      results = clang_codeCompleteAtWithFilter(
+          TU, filename, line, column, unsaved_files, num_unsaved_files,
+          completionOptions, TypedPrefix,
+          MaxResults ? (unsigned)atoi(MaxResults) : 0);
+    else
+      results = clang_codeCompleteAt(TU, filename, line, column,
+                                     unsaved_files, num_unsaved_files,
+                                     completionOptions);
     if (!results) {
       fprintf(stderr, "Unable to perform code completion!\n");
       return 1;
@@ -4681,6 +4694,211 @@ static int perform_print_build_session_timestamp(void) {
   return 0;
 }
 
+/******************************************************************************/
+/* Benchmarking.                                                              */
+/******************************************************************************/
+
+/* Returns a point in time, in seconds. */
+static double benchmark_now(void) {
+  struct timespec Now;
+#ifdef _WIN32
+  timespec_get(&Now, TIME_UTC);
+#else
+  clock_gettime(CLOCK_MONOTONIC, &Now);
+#endif
+  return Now.tv_sec + Now.tv_nsec / 1e9;
+}
+
+static int benchmark_compare_times(const void *LHS, const void *RHS) {
+  double L = *(const double *)LHS, R = *(const double *)RHS;
+  return L < R ? -1 : L > R ? 1 : 0;
+}
+
+static void benchmark_print_string(const char *Str) {
+  putchar('"');
+  for (; *Str; ++Str) {
+    if (*Str == '"' || *Str == '\\')
+      printf("\\%c", *Str);
+    else if ((unsigned char)*Str < 0x20)
+      printf("\\u%04x", (unsigned char)*Str);
+    else
+      putchar(*Str);
+  }
+  putchar('"');
+}
+
+/* Prints the latency percentiles of \p Count samples of \p Times, in
+ * milliseconds. The samples are sorted in place. */
+static void benchmark_print_latencies(double *Times, unsigned Count) {
+  double Total = 0;
+  unsigned I;
+  printf("{\"count\": %u", Count);
+  if (Count) {
+    qsort(Times, Count, sizeof(double), benchmark_compare_times);
+    for (I = 0; I != Count; ++I)
+      Total += Times[I];
+    /* Nearest-rank percentiles. */
+    printf(", \"min_ms\": %.3f, \"mean_ms\": %.3f, \"p50_ms\": %.3f, "
+           "\"p90_ms\": %.3f, \"p99_ms\": %.3f, \"max_ms\": %.3f",
+           Times[0] * 1e3, Total / Count * 1e3,
+           Times[(50 * Count + 99) / 100 - 1] * 1e3,
+           Times[(90 * Count + 99) / 100 - 1] * 1e3,
+           Times[(99 * Count + 99) / 100 - 1] * 1e3,
+           Times[Count - 1] * 1e3);
+  }
+  printf("}");
+}
+
+/* Parses a translation unit the way an editor does, then reparses it and
+ * completes at the given sites a number of times, and prints the latencies,
+ * preamble usage and memory use as JSON. */
+static int perform_benchmark(int argc, const char **argv) {
+  CXIndex Idx;
+  CXTranslationUnit TU;
+  struct CXUnsavedFile *unsaved_files = 0;
+  int num_unsaved_files = 0;
+  CursorSourceLocation *Sites = 0;
+  unsigned *NumResults = 0;
+  unsigned NumSites = 0, Site, Iterations, I;
+  unsigned PreambleBuilds = 0, PreambleReuses = 0;
+  double Start, ParseTime;
+  double *ReparseTimes = 0, *CompletionTimes = 0;
+  unsigned long TotalMemory = 0;
+  CXTUResourceUsage Usage;
+  CXString Spelling;
+  enum CXErrorCode Err;
+  int errorCode, compiler_arg_idx, result = 0;
+
+  Iterations = (unsigned)atoi(argv[2]);
+
+  /* Parse the completion sites. */
+  while (3 + NumSites < (unsigned)argc &&
+         strstr(argv[3 + NumSites], "-benchmark-complete-at=") ==
+             argv[3 + NumSites])
+    ++NumSites;
+  Sites = (CursorSourceLocation *)malloc(
+      (NumSites ? NumSites : 1) * sizeof(CursorSourceLocation));
+  NumResults = (unsigned *)calloc(NumSites ? NumSites : 1, sizeof(unsigned));
+  for (Site = 0; Site != NumSites; ++Site) {
+    const char *input = argv[3 + Site] + strlen("-benchmark-complete-at=");
+    if ((errorCode = parse_file_line_column(input, &Sites[Site].filename,
+                                            &Sites[Site].line,
+                                            &Sites[Site].column, 0, 0)))
+      return errorCode;
+  }
+
+  if (parse_remapped_files(argc, argv, 3 + NumSites, &unsaved_files,
+                           &num_unsaved_files))
+    return -1;
+  compiler_arg_idx = 3 + NumSites + num_unsaved_files;
+
+  Idx = clang_createIndex(/* excludeDeclsFromPCH */0,
+                          /* displayDiagnostics=*/0);
+  Start = benchmark_now();
+  Err = clang_parseTranslationUnit2(
+      Idx, 0, argv + compiler_arg_idx, argc - compiler_arg_idx, unsaved_files,
+      num_unsaved_files,
+      clang_defaultEditingTranslationUnitOptions() | getDefaultParsingOptions(),
+      &TU);
+  ParseTime = benchmark_now() - Start;
+  if (Err != CXError_Success) {
+    fprintf(stderr, "Unable to load translation unit!\n");
+    describeLibclangFailure(Err);
+    free_remapped_files(unsaved_files, num_unsaved_files);
+    clang_disposeIndex(Idx);
+    return 1;
+  }
+
+  ReparseTimes = (double *)malloc((Iterations ? Iterations : 1) *
+                                  sizeof(double));
+  CompletionTimes = (double *)malloc(
+      (Iterations && NumSites ? Iterations * NumSites : 1) * sizeof(double));
+  for (I = 0; I != Iterations && !result; ++I) {
+    Start = benchmark_now();
+    Err = clang_reparseTranslationUnit(TU, num_unsaved_files, unsaved_files,
+                                       clang_defaultReparseOptions(TU));
+    ReparseTimes[I] = benchmark_now() - Start;
+    if (Err != CXError_Success) {
+      fprintf(stderr, "Unable to reparse translation unit!\n");
+      describeLibclangFailure(Err);
+      result = 1;
+      break;
+    }
+
+    for (Site = 0; Site != NumSites; ++Site) {
+      CXCodeCompleteResults *Results;
+      Start = benchmark_now();
+      Results = clang_codeCompleteAt(TU, Sites[Site].filename,
+                                     Sites[Site].line, Sites[Site].column,
+                                     unsaved_files, num_unsaved_files,
+                                     clang_defaultCodeCompleteOptions());
+      CompletionTimes[Site * Iterations + I] = benchmark_now() - Start;
+      if (!Results) {
+        fprintf(stderr, "Unable to perform code completion!\n");
+        result = 1;
+        break;
+      }
+      NumResults[Site] = Results->NumResults;
+      clang_disposeCodeCompleteResults(Results);
+    }
+  }
+
+  if (!result) {
+    clang_getTranslationUnitPreambleUsage(TU, &PreambleBuilds,
+                                          &PreambleReuses);
+
+    Spelling = clang_getTranslationUnitSpelling(TU);
+    printf("{\n  \"file\": ");
+    benchmark_print_string(clang_getCString(Spelling));
+    clang_disposeString(Spelling);
+    printf(",\n  \"iterations\": %u,\n", Iterations);
+    printf("  \"parse_ms\": %.3f,\n", ParseTime * 1e3);
+    printf("  \"reparse\": ");
+    benchmark_print_latencies(ReparseTimes, Iterations);
+    printf(",\n  \"completion\": [");
+    for (Site = 0; Site != NumSites; ++Site) {
+      printf("%s\n    {\"file\": ", Site ? "," : "");
+      benchmark_print_string(Sites[Site].filename);
+      printf(", \"line\": %u, \"column\": %u, \"results\": %u, \"latency\": ",
+             Sites[Site].line, Sites[Site].column, NumResults[Site]);
+      benchmark_print_latencies(CompletionTimes + Site * Iterations,
+                                Iterations);
+      printf("}");
+    }
+    printf("%s],\n", NumSites ? "\n  " : "");
+    printf("  \"preamble\": {\"builds\": %u, \"reuses\": %u, "
+           "\"hit_rate\": %.3f},\n",
+           PreambleBuilds, PreambleReuses,
+           PreambleBuilds + PreambleReuses
+               ? (double)PreambleReuses / (PreambleBuilds + PreambleReuses)
+               : 0.0);
+
+    Usage = clang_getCXTUResourceUsage(TU);
+    printf("  \"memory\": {");
+    for (I = 0; I != Usage.numEntries; ++I) {
+      printf("%s\n    ", I ? "," : "");
+      benchmark_print_string(
+          clang_getTUResourceUsageName(Usage.entries[I].kind));
+      printf(": %lu", Usage.entries[I].amount);
+      TotalMemory += Usage.entries[I].amount;
+    }
+    printf("%s\n    \"total\": %lu\n  }\n}\n", Usage.numEntries ? "," : "",
+           TotalMemory);
+    clang_disposeCXTUResourceUsage(Usage);
+  }
+
+  for (Site = 0; Site != NumSites; ++Site)
+    free(Sites[Site].filename);
+  free(Sites);
+  free(NumResults);
+  free(ReparseTimes);
+  free(CompletionTimes);
+  clang_disposeTranslationUnit(TU);
+  free_remapped_files(unsaved_files, num_unsaved_files);
+  clang_disposeIndex(Idx);
+  return result;
+}
+
 /******************************************************************************/
 /* Command line processing.                                                   */
 /******************************************************************************/
@@ -4742,7 +4960,9 @@ static void print_usage(void) {
     "       c-index-test -write-pch <file> <compiler arguments>\n"
     "       c-index-test -compilation-db [lookup <filename>] database\n");
   fprintf(stderr,
-    "       c-index-test -print-build-session-timestamp\n");
+    "       c-index-test -print-build-session-timestamp\n"
+    "       c-index-test -benchmark <iterations> "
+          "[-benchmark-complete-at=<site>]* {<args>}*\n");
   fprintf(stderr,
     "       c-index-test -read-diagnostics <file>\n\n");
   fprintf(stderr,
@@ -4767,6 +4987,8 @@ int cindextest_main(int argc, const char **argv) {
     return perform_code_completion(argc, argv, 0);
   if (argc > 2 && strstr(argv[1], "-code-completion-timing=") == argv[1])
     return perform_code_completion(argc, argv, 1);
+  if (argc > 2 && strcmp(argv[1], "-benchmark") == 0)
+    return perform_benchmark(argc, argv);
   if (argc > 2 && strstr(argv[1], "-cursor-at=") == argv[1])
     return inspect_cursor_at(argc, argv, "-cursor-at=", inspect_print_cursor);
   if (argc > 2 && strstr(argv[1], "-evaluate-cursor-at=") == argv[1])
@@ -58,6 +58,11 @@ static cl::opt<std::string> StopAfter("stop-diff-after",
 static cl::opt<int> MaxSize("s", cl::desc("<maxsize>"), cl::Optional,
                             cl::init(-1), cl::cat(ClangDiffCategory));
 
+static cl::opt<int> MaxNodes(
+    "max-nodes",
+    cl::desc("Only match top-down if either tree has more nodes than this."),
+    cl::Optional, cl::init(0), cl::cat(ClangDiffCategory));
+
 static cl::opt<std::string> BuildPath("p", cl::desc("Build path"), cl::init(""),
                                       cl::Optional, cl::cat(ClangDiffCategory));
 
@@ -489,6 +494,7 @@ int main(int argc, const char **argv) {
   diff::ComparisonOptions Options;
   if (MaxSize != -1)
     Options.MaxSize = MaxSize;
+  Options.MaxNodes = MaxNodes;
   if (!StopAfter.empty()) {
     if (StopAfter == "topdown")
       Options.StopAfterTopDown = true;
@@ -24,6 +24,8 @@
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/InitLLVM.h"
 #include "llvm/Support/Process.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 
 using namespace llvm;
 using clang::tooling::Replacements;
@@ -108,6 +110,13 @@ static cl::opt<bool>
     Verbose("verbose", cl::desc("If set, shows the list of processed files"),
             cl::cat(ClangFormatCategory));
 
+static cl::opt<unsigned>
+    NumThreads("j",
+               cl::desc("Format the <file>s using this many threads, or one\n"
+                        "thread per core if 0. The output is the same as\n"
+                        "when formatting the files one after another."),
+               cl::init(1), cl::cat(ClangFormatCategory));
+
 static cl::list<std::string> FileNames(cl::Positional, cl::desc("[<file> ...]"),
                                        cl::cat(ClangFormatCategory));
 
@@ -131,8 +140,8 @@ static bool parseLineRange(StringRef Input, unsigned &FromLine,
          LineRange.second.getAsInteger(0, ToLine);
 }
 
-static bool fillRanges(MemoryBuffer *Code,
-                       std::vector<tooling::Range> &Ranges) {
+static bool fillRanges(MemoryBuffer *Code, std::vector<tooling::Range> &Ranges,
+                       raw_ostream &ErrOS) {
   IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> InMemoryFileSystem(
       new llvm::vfs::InMemoryFileSystem);
   FileManager Files(FileSystemOptions(), InMemoryFileSystem);
@@ -144,18 +153,18 @@ static bool fillRanges(MemoryBuffer *Code,
                                  InMemoryFileSystem.get());
   if (!LineRanges.empty()) {
     if (!Offsets.empty() || !Lengths.empty()) {
-      errs() << "error: cannot use -lines with -offset/-length\n";
+      ErrOS << "error: cannot use -lines with -offset/-length\n";
       return true;
     }
 
     for (unsigned i = 0, e = LineRanges.size(); i < e; ++i) {
       unsigned FromLine, ToLine;
       if (parseLineRange(LineRanges[i], FromLine, ToLine)) {
-        errs() << "error: invalid <start line>:<end line> pair\n";
+        ErrOS << "error: invalid <start line>:<end line> pair\n";
         return true;
       }
       if (FromLine > ToLine) {
-        errs() << "error: start line should be less than end line\n";
+        ErrOS << "error: start line should be less than end line\n";
         return true;
       }
       SourceLocation Start = Sources.translateLineCol(ID, FromLine, 1);
@@ -169,26 +178,28 @@ static bool fillRanges(MemoryBuffer *Code,
     return false;
   }
 
-  if (Offsets.empty())
-    Offsets.push_back(0);
-  if (Offsets.size() != Lengths.size() &&
-      !(Offsets.size() == 1 && Lengths.empty())) {
-    errs() << "error: number of -offset and -length arguments must match.\n";
+  // Without -offset, format from the start of the file.
+  std::vector<unsigned> StartOffsets(Offsets.begin(), Offsets.end());
+  if (StartOffsets.empty())
+    StartOffsets.push_back(0);
+  if (StartOffsets.size() != Lengths.size() &&
+      !(StartOffsets.size() == 1 && Lengths.empty())) {
+    ErrOS << "error: number of -offset and -length arguments must match.\n";
     return true;
   }
-  for (unsigned i = 0, e = Offsets.size(); i != e; ++i) {
-    if (Offsets[i] >= Code->getBufferSize()) {
-      errs() << "error: offset " << Offsets[i] << " is outside the file\n";
+  for (unsigned i = 0, e = StartOffsets.size(); i != e; ++i) {
+    if (StartOffsets[i] >= Code->getBufferSize()) {
+      ErrOS << "error: offset " << StartOffsets[i] << " is outside the file\n";
       return true;
     }
     SourceLocation Start =
-        Sources.getLocForStartOfFile(ID).getLocWithOffset(Offsets[i]);
+        Sources.getLocForStartOfFile(ID).getLocWithOffset(StartOffsets[i]);
     SourceLocation End;
     if (i < Lengths.size()) {
-      if (Offsets[i] + Lengths[i] > Code->getBufferSize()) {
-        errs() << "error: invalid length " << Lengths[i]
-               << ", offset + length (" << Offsets[i] + Lengths[i]
-               << ") is outside the file.\n";
+      if (StartOffsets[i] + Lengths[i] > Code->getBufferSize()) {
+        ErrOS << "error: invalid length " << Lengths[i]
+              << ", offset + length (" << StartOffsets[i] + Lengths[i]
+              << ") is outside the file.\n";
         return true;
       }
       End = Start.getLocWithOffset(Lengths[i]);
@@ -202,48 +213,51 @@ static bool fillRanges(MemoryBuffer *Code,
   return false;
 }
 
-static void outputReplacementXML(StringRef Text) {
+static void outputReplacementXML(StringRef Text, raw_ostream &OS) {
   // FIXME: When we sort includes, we need to make sure the stream is correct
   // utf-8.
   size_t From = 0;
   size_t Index;
   while ((Index = Text.find_first_of("\n\r<&", From)) != StringRef::npos) {
-    outs() << Text.substr(From, Index - From);
+    OS << Text.substr(From, Index - From);
     switch (Text[Index]) {
     case '\n':
-      outs() << "&#10;";
+      OS << "&#10;";
       break;
     case '\r':
-      outs() << "&#13;";
+      OS << "&#13;";
       break;
     case '<':
-      outs() << "&lt;";
+      OS << "&lt;";
       break;
     case '&':
-      outs() << "&amp;";
+      OS << "&amp;";
       break;
     default:
       llvm_unreachable("Unexpected character encountered!");
     }
     From = Index + 1;
   }
-  outs() << Text.substr(From);
+  OS << Text.substr(From);
 }
 
-static void outputReplacementsXML(const Replacements &Replaces) {
+static void outputReplacementsXML(const Replacements &Replaces,
+                                  raw_ostream &OS) {
   for (const auto &R : Replaces) {
-    outs() << "<replacement "
-           << "offset='" << R.getOffset() << "' "
-           << "length='" << R.getLength() << "'>";
-    outputReplacementXML(R.getReplacementText());
-    outs() << "</replacement>\n";
+    OS << "<replacement "
+       << "offset='" << R.getOffset() << "' "
+       << "length='" << R.getLength() << "'>";
+    outputReplacementXML(R.getReplacementText(), OS);
+    OS << "</replacement>\n";
   }
 }
 
+// Formats FileName, writing the result to OS and any errors to ErrOS.
 // Returns true on error.
-static bool format(StringRef FileName) {
+static bool format(StringRef FileName, FormatStyleCache &Styles,
+                   raw_ostream &OS, raw_ostream &ErrOS) {
   if (!OutputXML && Inplace && FileName == "-") {
-    errs() << "error: cannot use -i when reading from stdin.\n";
+    ErrOS << "error: cannot use -i when reading from stdin.\n";
     return false;
   }
   // On Windows, overwriting a file with an open file mapping doesn't work,
@@ -252,21 +266,22 @@ static bool format(StringRef FileName) {
       !OutputXML && Inplace ? MemoryBuffer::getFileAsStream(FileName) :
                               MemoryBuffer::getFileOrSTDIN(FileName);
   if (std::error_code EC = CodeOrErr.getError()) {
-    errs() << EC.message() << "\n";
+    ErrOS << EC.message() << "\n";
     return true;
   }
   std::unique_ptr<llvm::MemoryBuffer> Code = std::move(CodeOrErr.get());
   if (Code->getBufferSize() == 0)
     return false; // Empty files are formatted correctly.
   std::vector<tooling::Range> Ranges;
-  if (fillRanges(Code.get(), Ranges))
+  if (fillRanges(Code.get(), Ranges, ErrOS))
     return true;
   StringRef AssumedFileName = (FileName == "-") ? AssumeFileName : FileName;
 
   llvm::Expected<FormatStyle> FormatStyle =
-      getStyle(Style, AssumedFileName, FallbackStyle, Code->getBuffer());
+      getStyle(Style, AssumedFileName, FallbackStyle, Code->getBuffer(),
+               /*FS=*/nullptr, &Styles);
   if (!FormatStyle) {
-    llvm::errs() << llvm::toString(FormatStyle.takeError()) << "\n";
+    ErrOS << llvm::toString(FormatStyle.takeError()) << "\n";
     return true;
   }
 
@@ -277,7 +292,7 @@ static bool format(StringRef FileName) {
                                        AssumedFileName, &CursorPosition);
   auto ChangedCode = tooling::applyAllReplacements(Code->getBuffer(), Replaces);
   if (!ChangedCode) {
-    llvm::errs() << llvm::toString(ChangedCode.takeError()) << "\n";
+    ErrOS << llvm::toString(ChangedCode.takeError()) << "\n";
     return true;
   }
   // Get new affected ranges after sorting `#includes`.
@@ -287,19 +302,18 @@ static bool format(StringRef FileName) {
                                         AssumedFileName, &Status);
   Replaces = Replaces.merge(FormatChanges);
   if (OutputXML) {
-    outs() << "<?xml version='1.0'?>\n<replacements "
-              "xml:space='preserve' incomplete_format='"
-           << (Status.FormatComplete ? "false" : "true") << "'";
+    OS << "<?xml version='1.0'?>\n<replacements "
+          "xml:space='preserve' incomplete_format='"
+       << (Status.FormatComplete ? "false" : "true") << "'";
     if (!Status.FormatComplete)
-      outs() << " line='" << Status.Line << "'";
-    outs() << ">\n";
+      OS << " line='" << Status.Line << "'";
+    OS << ">\n";
     if (Cursor.getNumOccurrences() != 0)
-      outs() << "<cursor>"
-             << FormatChanges.getShiftedCodePosition(CursorPosition)
-             << "</cursor>\n";
+      OS << "<cursor>" << FormatChanges.getShiftedCodePosition(CursorPosition)
+         << "</cursor>\n";
 
-    outputReplacementsXML(Replaces);
-    outs() << "</replacements>\n";
+    outputReplacementsXML(Replaces, OS);
+    OS << "</replacements>\n";
   } else {
     IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> InMemoryFileSystem(
         new llvm::vfs::InMemoryFileSystem);
@@ -317,15 +331,15 @@ static bool format(StringRef FileName) {
         return true;
     } else {
       if (Cursor.getNumOccurrences() != 0) {
-        outs() << "{ \"Cursor\": "
-               << FormatChanges.getShiftedCodePosition(CursorPosition)
-               << ", \"IncompleteFormat\": "
-               << (Status.FormatComplete ? "false" : "true");
+        OS << "{ \"Cursor\": "
+           << FormatChanges.getShiftedCodePosition(CursorPosition)
+           << ", \"IncompleteFormat\": "
+           << (Status.FormatComplete ? "false" : "true");
         if (!Status.FormatComplete)
-          outs() << ", \"Line\": " << Status.Line;
-        outs() << " }\n";
+          OS << ", \"Line\": " << Status.Line;
+        OS << " }\n";
       }
-      Rewrite.getEditBuffer(ID).write(outs());
+      Rewrite.getEditBuffer(ID).write(OS);
     }
   }
   return false;
@@ -390,8 +404,9 @@ int main(int argc, const char **argv) {
   }
 
   bool Error = false;
+  clang::format::FormatStyleCache Styles;
   if (FileNames.empty()) {
-    Error = clang::format::format("-");
+    Error = clang::format::format("-", Styles, outs(), errs());
     return Error ? 1 : 0;
   }
   if (FileNames.size() != 1 && (!Offsets.empty() || !Lengths.empty() || !LineRanges.empty())) {
@@ -399,10 +414,41 @@ int main(int argc, const char **argv) {
               "single file.\n";
     return 1;
   }
-  for (const auto &FileName : FileNames) {
+  if (NumThreads == 1 || FileNames.size() == 1) {
+    for (const auto &FileName : FileNames) {
+      if (Verbose)
+        errs() << "Formatting " << FileName << "\n";
+      Error |= clang::format::format(FileName, Styles, outs(), errs());
+    }
+    return Error ? 1 : 0;
+  }
+
+  // Format the files concurrently, but write out each file's output and
+  // errors in the order of the files on the command line.
+  struct FileResult {
+    std::string Output;
+    std::string Errors;
+    bool Error = false;
+  };
+  std::vector<FileResult> Results(FileNames.size());
+  std::vector<std::shared_future<void>> Done;
+  unsigned Threads = NumThreads;
+  llvm::ThreadPool Pool(Threads ? Threads : llvm::hardware_concurrency());
+  for (unsigned I = 0, E = FileNames.size(); I != E; ++I)
+    Done.push_back(Pool.async([&Results, &Styles, I] {
+      raw_string_ostream OS(Results[I].Output);
+      raw_string_ostream ErrOS(Results[I].Errors);
+      Results[I].Error =
+          clang::format::format(FileNames[I], Styles, OS, ErrOS);
+    }));
+  for (unsigned I = 0, E = FileNames.size(); I != E; ++I) {
+    Done[I].wait();
     if (Verbose)
-      errs() << "Formatting " << FileName << "\n";
-    Error |= clang::format::format(FileName);
+      errs() << "Formatting " << FileNames[I] << "\n";
+    errs() << Results[I].Errors;
+    outs() << Results[I].Output;
+    Error |= Results[I].Error;
+    Results[I] = FileResult();
   }
   return Error ? 1 : 0;
 }
@@ -10,6 +10,11 @@
 // Clang tool which creates a list of defined functions and the files in which
 // they are defined.
 //
+// The translation units are mapped in parallel. With '-cache-dir', the list of
+// each translation unit is kept on disk together with the files it read, and
+// only translation units whose command, main file or included files changed
+// since their list was written are mapped again.
+//
 //===--------------------------------------------------------------------===//
 
 #include "clang/AST/ASTConsumer.h"
@@ -18,12 +23,23 @@
 #include "clang/CrossTU/CrossTranslationUnit.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/FrontendActions.h"
+#include "clang/Tooling/AllTUsExecution.h"
 #include "clang/Tooling/CommonOptionsParser.h"
 #include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Support/Chrono.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/Signals.h"
 #include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 
 using namespace llvm;
 using namespace clang;
@@ -32,28 +48,260 @@ using namespace clang::tooling;
 
 static cl::OptionCategory ClangFnMapGenCategory("clang-fnmapgen options");
 
-class MapFunctionNamesConsumer : public ASTConsumer {
+static cl::opt<std::string> BinaryIndexFile(
+    "binary-index", cl::value_desc("file"),
+    cl::desc("Write the functions of all input files into <file> as a binary "
+             "index, instead of printing them to the standard output. "
+             "Functions defined in more than one file are left out"),
+    cl::cat(ClangFnMapGenCategory));
+
+static cl::list<std::string> MergedIndexFiles(
+    "merge-index", cl::value_desc("file"),
+    cl::desc("Add the functions of the text index <file> to the binary index"),
+    cl::cat(ClangFnMapGenCategory));
+
+static cl::opt<std::string> CacheDir(
+    "cache-dir", cl::value_desc("directory"),
+    cl::desc("Keep the functions of each input file in <directory>, and only "
+             "map the files again whose command or inputs changed since"),
+    cl::cat(ClangFnMapGenCategory));
+
+static cl::opt<unsigned>
+    NumThreads("num-threads", cl::init(0),
+               cl::desc("The number of files to map in parallel. Set to 0 "
+                        "for hardware concurrency"),
+               cl::cat(ClangFnMapGenCategory));
+
+/// Calls \p Callback with the lookup name and file name of each line of the
+/// text index \p Text.
+static void
+forEachIndexEntry(StringRef Text,
+                  llvm::function_ref<void(StringRef, StringRef)> Callback) {
+  SmallVector<StringRef, 64> Lines;
+  Text.split(Lines, '\n', /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+  for (StringRef Line : Lines) {
+    std::pair<StringRef, StringRef> Entry = Line.split(' ');
+    if (!Entry.second.empty())
+      Callback(Entry.first, Entry.second);
+  }
+}
+
+/// The functions collected for the binary index.
+class GlobalFunctionIndex {
 public:
-  MapFunctionNamesConsumer(ASTContext &Context)
-      : SM(Context.getSourceManager()) {}
+  void insert(StringRef LookupName, StringRef FileName) {
+    if (Ambiguous.count(LookupName))
+      return;
+    auto Inserted = Index.try_emplace(LookupName, FileName);
+    if (!Inserted.second && Inserted.first->second != FileName) {
+      Index.erase(Inserted.first);
+      Ambiguous.insert(LookupName);
+    }
+  }
+
+  const llvm::StringMap<std::string> &get() const { return Index; }
+
+private:
+  llvm::StringMap<std::string> Index;
+  llvm::StringSet<> Ambiguous;
+};
+
+/// The lists of functions of earlier runs, in the files of a cache directory.
+///
+/// An entry is named after a hash of the compile command and the contents of
+/// the main file of a translation unit, and lists the files that the
+/// translation unit read with their size and modification time, followed by
+/// the text index of the translation unit. An entry is used as long as none
+/// of the files it lists changed.
+class FunctionMapCache {
+public:
+  explicit FunctionMapCache(StringRef Dir) : Dir(Dir) {}
+
+  /// Computes the key of the translation unit of \p MainFile. Files that have
+  /// several compile commands are not cached, since each command may define
+  /// different functions. This must be called for all translation units before
+  /// any of them is mapped.
+  void addTranslationUnit(StringRef MainFile, const CompilationDatabase &DB);
+
+  /// Returns the text index stored for \p MainFile, if it is up to date.
+  llvm::Optional<std::string> lookup(StringRef MainFile) const;
+
+  /// Stores \p Index as the text index of the main file of \p SM. Returns
+  /// false if it could not be stored.
+  bool store(const SourceManager &SM, StringRef MainFile,
+             StringRef Index) const;
 
-  ~MapFunctionNamesConsumer() {
-    // Flush results to standard output.
-    llvm::outs() << createCrossTUIndexString(Index);
+private:
+  std::string getEntryPath(StringRef MainFile) const;
+
+  std::string Dir;
+  /// The key of each cached translation unit, by the real path of its main
+  /// file.
+  llvm::StringMap<std::string> Keys;
+};
+
+void FunctionMapCache::addTranslationUnit(StringRef MainFile,
+                                          const CompilationDatabase &DB) {
+  std::vector<CompileCommand> Commands = DB.getCompileCommands(MainFile);
+  if (Commands.size() != 1)
+    return;
+  SmallString<256> RealPath;
+  if (llvm::sys::fs::real_path(MainFile, RealPath))
+    return;
+  auto Contents = llvm::MemoryBuffer::getFile(RealPath);
+  if (!Contents)
+    return;
+
+  llvm::MD5 Hasher;
+  Hasher.update(Commands.front().Directory);
+  for (const std::string &Arg : Commands.front().CommandLine)
+    Hasher.update(StringRef(Arg.c_str(), Arg.size() + 1));
+  Hasher.update((*Contents)->getBuffer());
+  llvm::MD5::MD5Result Result;
+  Hasher.final(Result);
+  Keys[RealPath] = Result.digest().str();
+}
+
+std::string FunctionMapCache::getEntryPath(StringRef MainFile) const {
+  auto It = Keys.find(MainFile);
+  if (It == Keys.end())
+    return std::string();
+  SmallString<256> Path(Dir);
+  llvm::sys::path::append(Path, It->second + ".fnmap");
+  return Path.str();
+}
+
+llvm::Optional<std::string>
+FunctionMapCache::lookup(StringRef MainFile) const {
+  std::string EntryPath = getEntryPath(MainFile);
+  if (EntryPath.empty())
+    return llvm::None;
+  auto Buffer = llvm::MemoryBuffer::getFile(EntryPath);
+  if (!Buffer)
+    return llvm::None;
+
+  StringRef Contents = (*Buffer)->getBuffer();
+  StringRef Line;
+  std::tie(Line, Contents) = Contents.split('\n');
+  unsigned NumInputs;
+  if (Line.getAsInteger(10, NumInputs))
+    return llvm::None;
+  for (unsigned I = 0; I != NumInputs; ++I) {
+    std::tie(Line, Contents) = Contents.split('\n');
+    StringRef ModTimeStr, SizeStr, Path;
+    std::tie(ModTimeStr, Line) = Line.split(' ');
+    std::tie(SizeStr, Path) = Line.split(' ');
+    long long ModTime;
+    uint64_t Size;
+    llvm::sys::fs::file_status Status;
+    if (ModTimeStr.getAsInteger(10, ModTime) ||
+        SizeStr.getAsInteger(10, Size) || Path.empty() ||
+        llvm::sys::fs::status(Path, Status) || Status.getSize() != Size ||
+        llvm::sys::toTimeT(Status.getLastModificationTime()) != ModTime)
+      return llvm::None;
+  }
+  return Contents.str();
+}
+
+bool FunctionMapCache::store(const SourceManager &SM, StringRef MainFile,
+                             StringRef Index) const {
+  std::string EntryPath = getEntryPath(MainFile);
+  if (EntryPath.empty())
+    return false;
+
+  std::string Entry;
+  llvm::raw_string_ostream OS(Entry);
+  OS << std::distance(SM.fileinfo_begin(), SM.fileinfo_end()) << '\n';
+  for (auto I = SM.fileinfo_begin(), E = SM.fileinfo_end(); I != E; ++I) {
+    const FileEntry *FE = I->first;
+    StringRef Path = FE->tryGetRealPathName();
+    if (Path.empty())
+      Path = FE->getName();
+    OS << static_cast<long long>(FE->getModificationTime()) << ' '
+       << FE->getSize() << ' ' << Path << '\n';
+  }
+  OS << Index;
+  OS.flush();
+
+  // Write the entry under a temporary name first, so that a concurrent or
+  // later run never reads a partial entry.
+  if (llvm::sys::fs::create_directories(Dir))
+    return false;
+  SmallString<256> TempPath;
+  int FD;
+  if (llvm::sys::fs::createUniqueFile(EntryPath + "-%%%%%%%%", FD, TempPath))
+    return false;
+  {
+    llvm::raw_fd_ostream TempOS(FD, /*shouldClose=*/true);
+    TempOS << Entry;
+    TempOS.close();
+    if (TempOS.has_error()) {
+      TempOS.clear_error();
+      llvm::sys::fs::remove(TempPath);
+      return false;
+    }
   }
+  if (llvm::sys::fs::rename(TempPath, EntryPath)) {
+    llvm::sys::fs::remove(TempPath);
+    return false;
+  }
+  return true;
+}
+
+/// Exposes only some of the files of a compilation database, so that the
+/// files with an up-to-date cache entry are not mapped again.
+class FileListCompilationDatabase : public CompilationDatabase {
+public:
+  FileListCompilationDatabase(const CompilationDatabase &Base,
+                              std::vector<std::string> Files)
+      : Base(Base), Files(std::move(Files)) {}
 
-  void HandleTranslationUnit(ASTContext &Ctx) override {
-    handleDecl(Ctx.getTranslationUnitDecl());
+  std::vector<CompileCommand>
+  getCompileCommands(StringRef FilePath) const override {
+    return Base.getCompileCommands(FilePath);
   }
 
+  std::vector<std::string> getAllFiles() const override { return Files; }
+
+private:
+  const CompilationDatabase &Base;
+  std::vector<std::string> Files;
+};
+
+/// Collects the functions of a translation unit, and reports their text index
+/// as the result for the main file.
+class MapFunctionNamesConsumer : public ASTConsumer {
+public:
+  MapFunctionNamesConsumer(ASTContext &Context, ExecutionContext &Results,
+                           const FunctionMapCache *Cache)
+      : SM(Context.getSourceManager()), Results(Results), Cache(Cache) {}
+
+  void HandleTranslationUnit(ASTContext &Ctx) override;
+
 private:
   void handleDecl(const Decl *D);
 
   SourceManager &SM;
+  ExecutionContext &Results;
+  const FunctionMapCache *Cache;
   llvm::StringMap<std::string> Index;
   std::string CurrentFileName;
 };
 
+void MapFunctionNamesConsumer::HandleTranslationUnit(ASTContext &Ctx) {
+  const FileEntry *MainFile = SM.getFileEntryForID(SM.getMainFileID());
+  CurrentFileName = MainFile ? MainFile->tryGetRealPathName() : "";
+  if (CurrentFileName.empty())
+    CurrentFileName = "invalid_file";
+
+  handleDecl(Ctx.getTranslationUnitDecl());
+
+  std::string IndexString = createCrossTUIndexString(Index);
+  if (Cache && !Ctx.getDiagnostics().hasErrorOccurred())
+    Cache->store(SM, CurrentFileName, IndexString);
+  Results.reportResult(CurrentFileName, IndexString);
+}
+
 void MapFunctionNamesConsumer::handleDecl(const Decl *D) {
   if (!D)
     return;
@@ -61,13 +309,6 @@ void MapFunctionNamesConsumer::handleDecl(const Decl *D) {
   if (const auto *FD = dyn_cast<FunctionDecl>(D)) {
     if (FD->isThisDeclarationADefinition()) {
       if (const Stmt *Body = FD->getBody()) {
-        if (CurrentFileName.empty()) {
-          CurrentFileName =
-              SM.getFileEntryForID(SM.getMainFileID())->tryGetRealPathName();
-          if (CurrentFileName.empty())
-            CurrentFileName = "invalid_file";
-        }
-
         switch (FD->getLinkageInternal()) {
         case ExternalLinkage:
         case VisibleNoLinkage:
@@ -91,11 +332,36 @@ void MapFunctionNamesConsumer::handleDecl(const Decl *D) {
 }
 
 class MapFunctionNamesAction : public ASTFrontendAction {
+public:
+  MapFunctionNamesAction(ExecutionContext &Results,
+                         const FunctionMapCache *Cache)
+      : Results(Results), Cache(Cache) {}
+
 protected:
   std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &CI,
                                                  llvm::StringRef) {
-    return llvm::make_unique<MapFunctionNamesConsumer>(CI.getASTContext());
+    return llvm::make_unique<MapFunctionNamesConsumer>(CI.getASTContext(),
+                                                       Results, Cache);
   }
+
+private:
+  ExecutionContext &Results;
+  const FunctionMapCache *Cache;
+};
+
+class MapFunctionNamesActionFactory : public FrontendActionFactory {
+public:
+  MapFunctionNamesActionFactory(ExecutionContext &Results,
+                                const FunctionMapCache *Cache)
+      : Results(Results), Cache(Cache) {}
+
+  FrontendAction *create() override {
+    return new MapFunctionNamesAction(Results, Cache);
+  }
+
+private:
+  ExecutionContext &Results;
+  const FunctionMapCache *Cache;
 };
 
 static cl::extrahelp CommonHelp(CommonOptionsParser::HelpMessage);
@@ -110,9 +376,87 @@ int main(int argc, const char **argv) {
                          "(excluding headers).\n";
   CommonOptionsParser OptionsParser(argc, argv, ClangFnMapGenCategory,
                                     cl::ZeroOrMore, Overview);
+  const CompilationDatabase &Compilations = OptionsParser.getCompilations();
+
+  // Without explicit source files, map every file of the database.
+  std::vector<std::string> Files = OptionsParser.getSourcePathList();
+  if (Files.empty())
+    Files = Compilations.getAllFiles();
+
+  // The text index of each translation unit, by main file.
+  std::vector<std::pair<std::string, std::string>> TUIndexes;
+  std::unique_ptr<FunctionMapCache> Cache;
+  std::vector<std::string> ChangedFiles;
+  if (!CacheDir.empty()) {
+    Cache = llvm::make_unique<FunctionMapCache>(CacheDir);
+    for (const std::string &File : Files)
+      Cache->addTranslationUnit(File, Compilations);
+    for (const std::string &File : Files) {
+      SmallString<256> RealPath;
+      llvm::Optional<std::string> Cached;
+      if (!llvm::sys::fs::real_path(File, RealPath))
+        Cached = Cache->lookup(RealPath);
+      if (Cached)
+        TUIndexes.emplace_back(RealPath.str(), std::move(*Cached));
+      else
+        ChangedFiles.push_back(File);
+    }
+  } else {
+    ChangedFiles = Files;
+  }
+
+  int Result = 0;
+  if (!ChangedFiles.empty()) {
+    FileListCompilationDatabase ChangedCompilations(Compilations,
+                                                    std::move(ChangedFiles));
+    AllTUsToolExecutor Executor(ChangedCompilations, NumThreads);
+    if (llvm::Error Err =
+            Executor.execute(llvm::make_unique<MapFunctionNamesActionFactory>(
+                *Executor.getExecutionContext(), Cache.get()))) {
+      llvm::errs() << llvm::toString(std::move(Err));
+      Result = 1;
+    }
+    Executor.getToolResults()->forEachResult(
+        [&](StringRef MainFile, StringRef Index) {
+          TUIndexes.emplace_back(MainFile, Index);
+        });
+  }
+  // Translation units finish in any order; keep the output stable.
+  std::stable_sort(TUIndexes.begin(), TUIndexes.end(),
+                   [](const std::pair<std::string, std::string> &LHS,
+                      const std::pair<std::string, std::string> &RHS) {
+                     return LHS.first < RHS.first;
+                   });
 
-  ClangTool Tool(OptionsParser.getCompilations(),
-                 OptionsParser.getSourcePathList());
+  if (BinaryIndexFile.empty()) {
+    for (const auto &TUIndex : TUIndexes)
+      llvm::outs() << TUIndex.second;
+    return Result;
+  }
 
-  return Tool.run(newFrontendActionFactory<MapFunctionNamesAction>().get());
+  GlobalFunctionIndex Global;
+  for (const std::string &MergedIndexFile : MergedIndexFiles) {
+    llvm::Expected<llvm::StringMap<std::string>> IndexOrErr =
+        parseCrossTUIndex(MergedIndexFile, "");
+    if (!IndexOrErr) {
+      llvm::errs() << "error: cannot read index '" << MergedIndexFile
+                   << "': " << llvm::toString(IndexOrErr.takeError());
+      return 1;
+    }
+    for (const auto &E : *IndexOrErr)
+      Global.insert(E.getKey(), E.getValue());
+  }
+  for (const auto &TUIndex : TUIndexes)
+    forEachIndexEntry(TUIndex.second, [&](StringRef LookupName,
+                                          StringRef FileName) {
+      Global.insert(LookupName, FileName);
+    });
+
+  if (llvm::Error Err =
+          writeCrossTUBinaryIndex(Global.get(), BinaryIndexFile)) {
+    llvm::errs() << "error: cannot write index '" << BinaryIndexFile
+                 << "': " << llvm::toString(std::move(Err)) << "\n";
+    return 1;
+  }
+  return Result;
 }
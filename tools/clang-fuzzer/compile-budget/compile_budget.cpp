@@ -0,0 +1,188 @@
+//==-- compile_budget.cpp - Compile-time budget for Clang fuzzers ----------==//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Implements RunWithinBudget for use by the Clang fuzzers.
+//
+//===----------------------------------------------------------------------===//
+
+#include "compile_budget.h"
+
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/raw_ostream.h"
+#include <cstdint>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace clang_fuzzer;
+
+namespace {
+/// Counts the user-space instructions retired by the thread that created it.
+/// The count can be read from any thread.
+class InstructionCounter {
+public:
+  InstructionCounter() {
+#ifdef __linux__
+    perf_event_attr Attr;
+    memset(&Attr, 0, sizeof(Attr));
+    Attr.type = PERF_TYPE_HARDWARE;
+    Attr.size = sizeof(Attr);
+    Attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+    Attr.disabled = 1;
+    Attr.exclude_kernel = 1;
+    Attr.exclude_hv = 1;
+    FD = syscall(__NR_perf_event_open, &Attr, /*pid=*/0, /*cpu=*/-1,
+                 /*group_fd=*/-1, /*flags=*/0);
+#endif
+  }
+
+  ~InstructionCounter() {
+#ifdef __linux__
+    if (FD >= 0)
+      close(FD);
+#endif
+  }
+
+  bool isAvailable() const { return FD >= 0; }
+
+  void start() {
+#ifdef __linux__
+    ioctl(FD, PERF_EVENT_IOC_RESET, 0);
+    ioctl(FD, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+  }
+
+  void stop() {
+#ifdef __linux__
+    ioctl(FD, PERF_EVENT_IOC_DISABLE, 0);
+#endif
+  }
+
+  uint64_t read() const {
+    uint64_t Count = 0;
+#ifdef __linux__
+    if (::read(FD, &Count, sizeof(Count)) != sizeof(Count))
+      return 0;
+#endif
+    return Count;
+  }
+
+private:
+  int FD = -1;
+};
+
+/// Stays the same for the lifetime of the process once it is set up by the
+/// first input.
+struct BudgetState {
+  uint64_t Budget = 0;
+  bool PrintCounts = false;
+  InstructionCounter *Counter = nullptr;
+
+  /// Guards the state of the running input, which the watchdog reads.
+  std::mutex InputMutex;
+  /// Whether an input is being compiled.
+  bool Compiling = false;
+  /// The size of the running input. The watchdog copies what it reports, as
+  /// the input may be gone by the time it looks.
+  size_t InputSize = 0;
+};
+} // namespace
+
+static BudgetState &getState() {
+  static BudgetState State;
+  return State;
+}
+
+LLVM_ATTRIBUTE_NORETURN static void
+reportBudgetExceeded(uint64_t Count, uint64_t Budget, size_t InputSize) {
+  static std::mutex ReportMutex;
+  std::lock_guard<std::mutex> Lock(ReportMutex);
+  llvm::errs() << "==ERROR: compile-time budget exceeded: " << Count
+               << " instructions, the budget is " << Budget
+               << " (CLANG_FUZZER_INSTRUCTION_BUDGET); the input is "
+               << InputSize << " bytes\n";
+  llvm::errs().flush();
+  // libFuzzer writes the input that was running out as a crash artifact.
+  std::abort();
+}
+
+/// Checks the budget of the running input every few milliseconds, so that
+/// the inputs whose compilation never finishes are caught too.
+static void watchBudget() {
+  BudgetState &State = getState();
+  while (true) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    std::lock_guard<std::mutex> Lock(State.InputMutex);
+    if (!State.Compiling)
+      continue;
+    uint64_t Count = State.Counter->read();
+    if (Count > State.Budget)
+      reportBudgetExceeded(Count, State.Budget, State.InputSize);
+  }
+}
+
+/// Reads the configuration, and starts counting in the calling thread.
+static BudgetState &initializeState() {
+  BudgetState &State = getState();
+  // A second or so of compilation on current hardware.
+  State.Budget = 2000000000;
+  if (const char *Budget = getenv("CLANG_FUZZER_INSTRUCTION_BUDGET"))
+    State.Budget = strtoull(Budget, nullptr, 10);
+  State.PrintCounts = getenv("CLANG_FUZZER_PRINT_INSTRUCTIONS") != nullptr;
+
+  // The counter counts the instructions of the thread that creates it, which
+  // is the thread that runs the inputs.
+  State.Counter = new InstructionCounter;
+  if (!State.Counter->isAvailable()) {
+    llvm::errs() << "warning: hardware instruction counters are not "
+                    "available; the compile-time budget is not enforced\n";
+    return State;
+  }
+  if (State.Budget)
+    std::thread(watchBudget).detach();
+  return State;
+}
+
+void clang_fuzzer::RunWithinBudget(const std::string &Input,
+                                   llvm::function_ref<void()> Compile) {
+  static BudgetState &State = initializeState();
+  if (!State.Counter->isAvailable()) {
+    Compile();
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> Lock(State.InputMutex);
+    State.Counter->start();
+    State.Compiling = true;
+    State.InputSize = Input.size();
+  }
+  Compile();
+  {
+    std::lock_guard<std::mutex> Lock(State.InputMutex);
+    State.Compiling = false;
+    State.Counter->stop();
+  }
+  uint64_t Count = State.Counter->read();
+
+  if (State.PrintCounts)
+    llvm::errs() << "instructions: " << Count << "\n";
+  // The watchdog may not have looked since the budget was exceeded.
+  if (State.Budget && Count > State.Budget)
+    reportBudgetExceeded(Count, State.Budget, Input.size());
+}
@@ -0,0 +1,41 @@
+//==-- compile_budget.h - Compile-time budget for Clang fuzzers ------------==//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Defines RunWithinBudget, which makes the Clang fuzzers find inputs that are
+// slow to compile as well as inputs that crash.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLS_CLANG_FUZZER_COMPILE_BUDGET_COMPILEBUDGET_H
+#define LLVM_CLANG_TOOLS_CLANG_FUZZER_COMPILE_BUDGET_COMPILEBUDGET_H
+
+#include "llvm/ADT/STLExtras.h"
+#include <string>
+
+namespace clang_fuzzer {
+/// Runs \p Compile, which compiles \p Input, and counts the instructions
+/// that it retires.
+///
+/// When the count exceeds the budget given by the environment variable
+/// CLANG_FUZZER_INSTRUCTION_BUDGET, the process aborts with a report of the
+/// count, so that libFuzzer keeps the input as a crash artifact. The budget is
+/// checked while \p Compile runs, so inputs that would never finish are
+/// caught as well. A budget of 0 disables the check.
+///
+/// If CLANG_FUZZER_PRINT_INSTRUCTIONS is set, the count of each input is
+/// printed to standard error, which lets a corpus of slow inputs be used as a
+/// regression benchmark.
+///
+/// Instructions are counted with the hardware performance counters, which are
+/// only used on Linux. Without them, no budget is enforced.
+void RunWithinBudget(const std::string &Input,
+                     llvm::function_ref<void()> Compile);
+} // namespace clang_fuzzer
+
+#endif
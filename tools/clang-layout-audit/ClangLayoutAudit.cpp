@@ -0,0 +1,241 @@
+//===--- tools/clang-layout-audit/ClangLayoutAudit.cpp --------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements a tool that reports the size, alignment and padding
+//  of the classes that a set of translation units defines, for example of the
+//  Stmt and Expr node classes of Clang's own AST:
+//
+//    clang-layout-audit -derived-from=clang::Stmt -p build \
+//      lib/AST/Stmt.cpp
+//
+//  The padding of a class is the part of it that none of its fields, bases
+//  or its virtual table pointer occupies. The padding inside its bases is
+//  reported separately, and is also part of the total padding of the class.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/AST/ASTConsumer.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/DeclCXX.h"
+#include "clang/AST/RecordLayout.h"
+#include "clang/AST/RecursiveASTVisitor.h"
+#include "clang/Frontend/FrontendActions.h"
+#include "clang/Tooling/CommonOptionsParser.h"
+#include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace clang;
+using namespace clang::tooling;
+using namespace llvm;
+
+static cl::extrahelp CommonHelp(CommonOptionsParser::HelpMessage);
+
+static cl::OptionCategory LayoutAuditCategory("clang-layout-audit options");
+
+static cl::opt<std::string> DerivedFrom(
+    "derived-from",
+    cl::desc("Only report the classes derived from this class, given by its "
+             "fully qualified name, and the class itself"),
+    cl::cat(LayoutAuditCategory));
+
+enum SortOrder { SortByPadding, SortBySize, SortByName };
+
+static cl::opt<SortOrder> Sort(
+    "sort", cl::desc("The order to report the classes in"),
+    cl::values(clEnumValN(SortByPadding, "padding",
+                          "The most total padding first (default)"),
+               clEnumValN(SortBySize, "size", "The largest first"),
+               clEnumValN(SortByName, "name", "By qualified name")),
+    cl::init(SortByPadding), cl::cat(LayoutAuditCategory));
+
+namespace {
+
+struct RecordLayoutInfo {
+  uint64_t Size = 0;
+  uint64_t Align = 0;
+  /// The bits of the class itself that nothing occupies.
+  uint64_t OwnPaddingBits = 0;
+  /// OwnPaddingBits plus the padding of all the bases.
+  uint64_t TotalPaddingBits = 0;
+};
+
+/// The layouts of the classes seen so far, by qualified name. A class that
+/// is defined in a header is seen by many translation units.
+typedef std::map<std::string, RecordLayoutInfo> LayoutMap;
+
+class LayoutAuditVisitor : public RecursiveASTVisitor<LayoutAuditVisitor> {
+  ASTContext &Ctx;
+  LayoutMap &Layouts;
+
+  /// Returns true if the class is to be reported.
+  bool isAudited(const CXXRecordDecl *RD) {
+    if (DerivedFrom.empty() || RD->getQualifiedNameAsString() == DerivedFrom)
+      return true;
+    return !RD->forallBases([](const CXXRecordDecl *Base) {
+      return Base->getQualifiedNameAsString() != DerivedFrom;
+    });
+  }
+
+  uint64_t getTotalPaddingBits(const CXXRecordDecl *RD,
+                               uint64_t OwnPaddingBits) {
+    uint64_t Bits = OwnPaddingBits;
+    for (const CXXBaseSpecifier &Base : RD->bases())
+      if (const CXXRecordDecl *BaseRD = Base.getType()->getAsCXXRecordDecl())
+        Bits += getTotalPaddingBits(BaseRD, getOwnPaddingBits(BaseRD));
+    return Bits;
+  }
+
+  uint64_t getOwnPaddingBits(const CXXRecordDecl *RD) {
+    const ASTRecordLayout &Layout = Ctx.getASTRecordLayout(RD);
+    uint64_t SizeInBits = Ctx.toBits(Layout.getSize());
+    BitVector Used(SizeInBits);
+    auto Occupy = [&](uint64_t Begin, uint64_t Width) {
+      uint64_t End = std::min(Begin + Width, SizeInBits);
+      if (Begin < End)
+        Used.set(Begin, End);
+    };
+
+    if (Layout.hasOwnVFPtr())
+      Occupy(0, Ctx.getTargetInfo().getPointerWidth(0));
+    if (Layout.hasOwnVBPtr())
+      Occupy(Ctx.toBits(Layout.getVBPtrOffset()),
+             Ctx.getTargetInfo().getPointerWidth(0));
+
+    for (const CXXBaseSpecifier &Base : RD->bases()) {
+      const CXXRecordDecl *BaseRD = Base.getType()->getAsCXXRecordDecl();
+      if (!BaseRD || BaseRD->isEmpty())
+        continue;
+      CharUnits Offset = Base.isVirtual() ? Layout.getVBaseClassOffset(BaseRD)
+                                          : Layout.getBaseClassOffset(BaseRD);
+      Occupy(Ctx.toBits(Offset),
+             Ctx.toBits(Ctx.getASTRecordLayout(BaseRD).getDataSize()));
+    }
+
+    for (const FieldDecl *FD : RD->fields()) {
+      uint64_t Width = 0;
+      if (FD->isBitField())
+        Width = FD->getBitWidthValue(Ctx);
+      else if (!FD->getType()->isIncompleteArrayType())
+        Width = Ctx.getTypeSize(FD->getType());
+      Occupy(Layout.getFieldOffset(FD->getFieldIndex()), Width);
+    }
+
+    return SizeInBits - Used.count();
+  }
+
+public:
+  LayoutAuditVisitor(ASTContext &Ctx, LayoutMap &Layouts)
+      : Ctx(Ctx), Layouts(Layouts) {}
+
+  bool shouldVisitTemplateInstantiations() const { return true; }
+
+  bool VisitCXXRecordDecl(CXXRecordDecl *RD) {
+    if (!RD->isThisDeclarationADefinition() || RD->isDependentType() ||
+        RD->isInvalidDecl() || isa<ClassTemplatePartialSpecializationDecl>(RD))
+      return true;
+    if (!isAudited(RD))
+      return true;
+
+    std::string Name = RD->getQualifiedNameAsString();
+    if (isa<ClassTemplateSpecializationDecl>(RD))
+      Name = Ctx.getRecordType(RD).getAsString(Ctx.getPrintingPolicy());
+    if (Layouts.count(Name))
+      return true;
+
+    const ASTRecordLayout &Layout = Ctx.getASTRecordLayout(RD);
+    RecordLayoutInfo &Info = Layouts[Name];
+    Info.Size = Layout.getSize().getQuantity();
+    Info.Align = Layout.getAlignment().getQuantity();
+    Info.OwnPaddingBits = getOwnPaddingBits(RD);
+    Info.TotalPaddingBits = getTotalPaddingBits(RD, Info.OwnPaddingBits);
+    return true;
+  }
+};
+
+class LayoutAuditConsumer : public ASTConsumer {
+  LayoutMap &Layouts;
+
+public:
+  explicit LayoutAuditConsumer(LayoutMap &Layouts) : Layouts(Layouts) {}
+
+  void HandleTranslationUnit(ASTContext &Ctx) override {
+    LayoutAuditVisitor(Ctx, Layouts).TraverseDecl(Ctx.getTranslationUnitDecl());
+  }
+};
+
+class LayoutAuditAction : public ASTFrontendAction {
+  LayoutMap &Layouts;
+
+public:
+  explicit LayoutAuditAction(LayoutMap &Layouts) : Layouts(Layouts) {}
+
+  std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &,
+                                                 StringRef) override {
+    return llvm::make_unique<LayoutAuditConsumer>(Layouts);
+  }
+};
+
+class LayoutAuditActionFactory : public FrontendActionFactory {
+  LayoutMap &Layouts;
+
+public:
+  explicit LayoutAuditActionFactory(LayoutMap &Layouts) : Layouts(Layouts) {}
+
+  FrontendAction *create() override { return new LayoutAuditAction(Layouts); }
+};
+
+} // end anonymous namespace
+
+int main(int argc, const char **argv) {
+  sys::PrintStackTraceOnErrorSignal(argv[0]);
+
+  CommonOptionsParser OptionsParser(argc, argv, LayoutAuditCategory);
+  ClangTool Tool(OptionsParser.getCompilations(),
+                 OptionsParser.getSourcePathList());
+
+  LayoutMap Layouts;
+  LayoutAuditActionFactory Factory(Layouts);
+  int Result = Tool.run(&Factory);
+
+  std::vector<LayoutMap::const_iterator> Rows;
+  for (auto I = Layouts.begin(), E = Layouts.end(); I != E; ++I)
+    Rows.push_back(I);
+  // The map keeps the rows sorted by name; stable sorts keep that order for
+  // the rows that compare equal.
+  if (Sort == SortByPadding)
+    std::stable_sort(Rows.begin(), Rows.end(), [](LayoutMap::const_iterator A,
+                                                  LayoutMap::const_iterator B) {
+      return A->second.TotalPaddingBits > B->second.TotalPaddingBits;
+    });
+  else if (Sort == SortBySize)
+    std::stable_sort(Rows.begin(), Rows.end(), [](LayoutMap::const_iterator A,
+                                                  LayoutMap::const_iterator B) {
+      return A->second.Size > B->second.Size;
+    });
+
+  outs() << "    size   align  padding  total padding  class\n";
+  for (LayoutMap::const_iterator Row : Rows) {
+    const RecordLayoutInfo &Info = Row->second;
+    outs() << format("%8llu %7llu %8llu %14llu  ", (unsigned long long)Info.Size,
+                     (unsigned long long)Info.Align,
+                     (unsigned long long)(Info.OwnPaddingBits / 8),
+                     (unsigned long long)(Info.TotalPaddingBits / 8))
+           << Row->first << '\n';
+  }
+  return Result;
+}
@@ -0,0 +1,168 @@
+//===--- tools/clang-objcmt/ClangObjCMT.cpp - ObjC migrator tool ----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements a tool that runs the Objective-C migrator (enabled by
+//  the '-objcmt-migrate-*' options) on the translation units of a compilation
+//  database, and writes the file remappings of all of them to one migrate
+//  directory, in the format that '-mt-migrate-directory' produces.
+//
+//  With '-executor=all-TUs' the translation units are migrated in parallel,
+//  and read the headers that they share only once. Each translation unit
+//  writes its edits to an edit file of its own rather than rewriting files,
+//  and the edit files are merged once all translation units are done, so a
+//  header that many translation units rewrite the same way is rewritten once.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/ARCMigrate/ARCMT.h"
+#include "clang/ARCMigrate/ARCMTActions.h"
+#include "clang/ARCMigrate/FileRemapper.h"
+#include "clang/Basic/Diagnostic.h"
+#include "clang/Basic/DiagnosticOptions.h"
+#include "clang/Frontend/CompilerInvocation.h"
+#include "clang/Frontend/TextDiagnosticPrinter.h"
+#include "clang/Tooling/CommonOptionsParser.h"
+#include "clang/Tooling/Execution.h"
+#include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/raw_ostream.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace clang;
+using namespace clang::tooling;
+using namespace llvm;
+
+static cl::extrahelp CommonHelp(CommonOptionsParser::HelpMessage);
+static cl::extrahelp MoreHelp(
+    "\tThe migrations to run are selected with the '-objcmt-migrate-*'\n"
+    "\tcompiler options, given in the compilation database or with\n"
+    "\t'-extra-arg'. Without any, literals and subscripting are migrated.\n"
+    "\n"
+    "\tFor example, to migrate all files of a project in parallel, use:\n"
+    "\n"
+    "\t  clang-objcmt -executor=all-TUs -p build/path \\\n"
+    "\t    -migrate-directory=migrated -extra-arg=-objcmt-migrate-all\n"
+    "\n");
+
+static cl::OptionCategory ObjCMTCategory("clang-objcmt options");
+
+static cl::opt<std::string>
+    MigrateDir("migrate-directory",
+               cl::desc("Directory to write the file remappings to. "
+                        "Remappings that it already has are kept."),
+               cl::Required, cl::cat(ObjCMTCategory));
+
+namespace {
+
+/// Migrates a translation unit, writing its edits to a new edit file. The
+/// path of the edit file is reported as the result for the main file.
+class MigrateActionFactory : public FrontendActionFactory {
+  ExecutionContext &Context;
+
+public:
+  explicit MigrateActionFactory(ExecutionContext &Context)
+      : Context(Context) {}
+
+  bool runInvocation(std::shared_ptr<CompilerInvocation> Invocation,
+                     FileManager *Files,
+                     std::shared_ptr<PCHContainerOperations> PCHContainerOps,
+                     DiagnosticConsumer *DiagConsumer) override {
+    FrontendOptions &Opts = Invocation->getFrontendOpts();
+    if (Opts.Inputs.empty())
+      return false;
+    std::string MainFile = Opts.Inputs.front().getFile();
+
+    SmallString<128> EditFile;
+    if (std::error_code EC =
+            sys::fs::createTemporaryFile("objcmt", "remap", EditFile)) {
+      errs() << "error: could not create an edit file for " << MainFile
+             << ": " << EC.message() << "\n";
+      return false;
+    }
+    Opts.OutputFile = EditFile.str();
+
+    bool Success = FrontendActionFactory::runInvocation(
+        std::move(Invocation), Files, std::move(PCHContainerOps),
+        DiagConsumer);
+    Context.reportResult(MainFile, EditFile);
+    return Success;
+  }
+
+  FrontendAction *create() override { return new arcmt::MigrateSourceAction; }
+};
+
+} // end anonymous namespace
+
+int main(int argc, const char **argv) {
+  sys::PrintStackTraceOnErrorSignal(argv[0]);
+
+  auto Executor =
+      createExecutorFromCommandLineArgs(argc, argv, ObjCMTCategory);
+  if (!Executor) {
+    errs() << toString(Executor.takeError()) << "\n";
+    return 1;
+  }
+
+  // Keep going if some translation units fail; the edits of the others are
+  // still worth merging.
+  bool Failed = false;
+  if (auto Err = (*Executor)->execute(make_unique<MigrateActionFactory>(
+          *(*Executor)->getExecutionContext()))) {
+    errs() << toString(std::move(Err)) << "\n";
+    Failed = true;
+  }
+
+  std::vector<std::string> EditFiles;
+  (*Executor)->getToolResults()->forEachResult(
+      [&](StringRef, StringRef EditFile) {
+        if (!EditFile.empty())
+          EditFiles.push_back(EditFile);
+      });
+
+  IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts = new DiagnosticOptions();
+  TextDiagnosticPrinter DiagClient(errs(), &*DiagOpts);
+  DiagnosticsEngine Diags(IntrusiveRefCntPtr<DiagnosticIDs>(new DiagnosticIDs),
+                          &*DiagOpts, &DiagClient, /*ShouldOwnClient=*/false);
+
+  // Merge the edits of all translation units once. Identical edits that many
+  // translation units made to a shared header are only applied once.
+  std::vector<StringRef> EditFileRefs(EditFiles.begin(), EditFiles.end());
+  std::vector<std::pair<std::string, std::string>> Remappings;
+  if (arcmt::getFileRemappingsFromFileList(Remappings, EditFileRefs,
+                                           &DiagClient))
+    Failed = true;
+
+  arcmt::FileRemapper Remapper;
+  Remapper.initFromDisk(MigrateDir, Diags, /*ignoreIfFilesChanged=*/true);
+  for (const auto &Remapping : Remappings) {
+    auto NewText = MemoryBuffer::getFile(Remapping.second);
+    if (!NewText) {
+      errs() << "error: could not read the migrated " << Remapping.first
+             << ": " << NewText.getError().message() << "\n";
+      Failed = true;
+      continue;
+    }
+    Remapper.remap(Remapping.first, std::move(*NewText));
+  }
+  if (Remapper.flushToDisk(MigrateDir, Diags))
+    Failed = true;
+
+  for (const auto &Remapping : Remappings)
+    sys::fs::remove(Remapping.second);
+  for (const std::string &EditFile : EditFiles)
+    sys::fs::remove(EditFile);
+
+  return Failed ? 1 : 0;
+}
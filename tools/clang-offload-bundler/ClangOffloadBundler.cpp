@@ -40,6 +40,7 @@
 #include "llvm/Support/Program.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/ThreadPool.h"
 #include <algorithm>
 #include <cassert>
 #include <cstddef>
@@ -89,6 +90,12 @@ static cl::opt<bool>
              cl::desc("Unbundle bundled file into several output files.\n"),
              cl::init(false), cl::cat(ClangOffloadBundlerCategory));
 
+static cl::opt<unsigned>
+    NumThreads("num-threads",
+               cl::desc("Number of output files to write at once when "
+                        "unbundling (0 = number of hardware threads).\n"),
+               cl::init(1), cl::cat(ClangOffloadBundlerCategory));
+
 static cl::opt<bool> PrintExternalCommands(
     "###",
     cl::desc("Print any external commands that are to be executed "
@@ -149,8 +156,9 @@ public:
   /// Read the marker that closes the current bundle.
   virtual void ReadBundleEnd(MemoryBuffer &Input) = 0;
 
-  /// Read the current bundle and write the result into the stream \a OS.
-  virtual void ReadBundle(raw_fd_ostream &OS, MemoryBuffer &Input) = 0;
+  /// Read the current bundle. The returned contents point into \a Input, so
+  /// the bundle is not copied before it is written out.
+  virtual StringRef ReadBundle(MemoryBuffer &Input) = 0;
 
   /// Write the header of the bundled file to \a OS based on the information
   /// gathered from \a Inputs.
@@ -316,11 +324,10 @@ public:
     ++CurBundleInfo;
   }
 
-  void ReadBundle(raw_fd_ostream &OS, MemoryBuffer &Input) final {
+  StringRef ReadBundle(MemoryBuffer &Input) final {
     assert(CurBundleInfo != BundlesInfo.end() && "Invalid reader info!");
     StringRef FC = Input.getBuffer();
-    OS.write(FC.data() + CurBundleInfo->second.Offset,
-             CurBundleInfo->second.Size);
+    return FC.substr(CurBundleInfo->second.Offset, CurBundleInfo->second.Size);
   }
 
   void WriteHeader(raw_fd_ostream &OS,
@@ -455,7 +462,7 @@ public:
 
   void ReadBundleEnd(MemoryBuffer &Input) final {}
 
-  void ReadBundle(raw_fd_ostream &OS, MemoryBuffer &Input) final {
+  StringRef ReadBundle(MemoryBuffer &Input) final {
     // If the current section has size one, that means that the content we are
     // interested in is the file itself. Otherwise it is the content of the
     // section.
@@ -467,9 +474,8 @@ public:
     CurrentSection->getContents(Content);
 
     if (Content.size() < 2)
-      OS.write(Input.getBufferStart(), Input.getBufferSize());
-    else
-      OS.write(Content.data(), Content.size());
+      return Input.getBuffer();
+    return Content;
   }
 
   void WriteHeader(raw_fd_ostream &OS,
@@ -670,15 +676,14 @@ protected:
     ++ReadChars;
   }
 
-  void ReadBundle(raw_fd_ostream &OS, MemoryBuffer &Input) final {
+  StringRef ReadBundle(MemoryBuffer &Input) final {
     StringRef FC = Input.getBuffer();
     size_t BundleStart = ReadChars;
 
     // Find end of the bundle.
     size_t BundleEnd = ReadChars = FC.find(BundleEndString, ReadChars);
 
-    StringRef Bundle(&FC.data()[BundleStart], BundleEnd - BundleStart);
-    OS << Bundle;
+    return StringRef(&FC.data()[BundleStart], BundleEnd - BundleStart);
   }
 
   void WriteHeader(raw_fd_ostream &OS,
@@ -776,7 +781,8 @@ static bool BundleFiles() {
   unsigned Idx = 0;
   for (auto &I : InputFileNames) {
     ErrorOr<std::unique_ptr<MemoryBuffer>> CodeOrErr =
-        MemoryBuffer::getFileOrSTDIN(I);
+        MemoryBuffer::getFileOrSTDIN(I, /*FileSize=*/-1,
+                                     /*RequiresNullTerminator=*/false);
     if (std::error_code EC = CodeOrErr.getError()) {
       errs() << "error: Can't open file " << I << ": " << EC.message() << "\n";
       return true;
@@ -809,11 +815,47 @@ static bool BundleFiles() {
   return false;
 }
 
+/// Write each of \a Outputs, given as pairs of file name and contents, using
+/// up to NumThreads threads. Return true if an error was found.
+static bool
+WriteOutputFiles(ArrayRef<std::pair<StringRef, StringRef>> Outputs) {
+  std::vector<std::string> Errors(Outputs.size());
+  auto WriteOutput = [&](size_t I) {
+    std::error_code EC;
+    raw_fd_ostream OutputFile(Outputs[I].first, EC, sys::fs::F_None);
+    if (EC) {
+      Errors[I] = ("error: Can't open file " + Outputs[I].first + ": " +
+                   EC.message() + "\n").str();
+      return;
+    }
+    OutputFile.write(Outputs[I].second.data(), Outputs[I].second.size());
+  };
+
+  if (NumThreads == 1 || Outputs.size() < 2) {
+    for (size_t I = 0, E = Outputs.size(); I != E; ++I)
+      WriteOutput(I);
+  } else {
+    ThreadPool Pool(NumThreads ? NumThreads : hardware_concurrency());
+    for (size_t I = 0, E = Outputs.size(); I != E; ++I)
+      Pool.async(WriteOutput, I);
+    Pool.wait();
+  }
+
+  bool Failed = false;
+  for (const std::string &Error : Errors) {
+    errs() << Error;
+    Failed |= !Error.empty();
+  }
+  return Failed;
+}
+
 // Unbundle the files. Return true if an error was found.
 static bool UnbundleFiles() {
-  // Open Input file.
+  // Open Input file. The bundles are written straight from its contents, so
+  // map it rather than read it when that is possible.
   ErrorOr<std::unique_ptr<MemoryBuffer>> CodeOrErr =
-      MemoryBuffer::getFileOrSTDIN(InputFileNames.front());
+      MemoryBuffer::getFileOrSTDIN(InputFileNames.front(), /*FileSize=*/-1,
+                                   /*RequiresNullTerminator=*/false);
   if (std::error_code EC = CodeOrErr.getError()) {
     errs() << "error: Can't open file " << InputFileNames.front() << ": "
            << EC.message() << "\n";
@@ -843,6 +885,7 @@ static bool UnbundleFiles() {
 
   // Read all the bundles that are in the work list. If we find no bundles we
   // assume the file is meant for the host target.
+  std::vector<std::pair<StringRef, StringRef>> Outputs;
   bool FoundHostBundle = false;
   while (!Worklist.empty()) {
     StringRef CurTriple = FH.get()->ReadBundleStart(Input);
@@ -858,15 +901,8 @@ static bool UnbundleFiles() {
       continue;
     }
 
-    // Check if the output file can be opened and copy the bundle to it.
-    std::error_code EC;
-    raw_fd_ostream OutputFile(Output->second, EC, sys::fs::F_None);
-    if (EC) {
-      errs() << "error: Can't open file " << Output->second << ": "
-             << EC.message() << "\n";
-      return true;
-    }
-    FH.get()->ReadBundle(OutputFile, Input);
+    // Record the bundle for its output file.
+    Outputs.emplace_back(Output->second, FH.get()->ReadBundle(Input));
     FH.get()->ReadBundleEnd(Input);
     Worklist.erase(Output);
 
@@ -878,40 +914,25 @@ static bool UnbundleFiles() {
   // If no bundles were found, assume the input file is the host bundle and
   // create empty files for the remaining targets.
   if (Worklist.size() == TargetNames.size()) {
-    for (auto &E : Worklist) {
-      std::error_code EC;
-      raw_fd_ostream OutputFile(E.second, EC, sys::fs::F_None);
-      if (EC) {
-        errs() << "error: Can't open file " << E.second << ": " << EC.message()
-               << "\n";
-        return true;
-      }
-
+    for (auto &E : Worklist)
       // If this entry has a host kind, copy the input file to the output file.
-      if (hasHostKind(E.first()))
-        OutputFile.write(Input.getBufferStart(), Input.getBufferSize());
-    }
-    return false;
+      Outputs.emplace_back(E.second, hasHostKind(E.first()) ? Input.getBuffer()
+                                                            : StringRef());
+    return WriteOutputFiles(Outputs);
   }
 
   // If we found elements, we emit an error if none of those were for the host.
   if (!FoundHostBundle) {
+    WriteOutputFiles(Outputs);
     errs() << "error: Can't find bundle for the host target\n";
     return true;
   }
 
   // If we still have any elements in the worklist, create empty files for them.
-  for (auto &E : Worklist) {
-    std::error_code EC;
-    raw_fd_ostream OutputFile(E.second, EC, sys::fs::F_None);
-    if (EC) {
-      errs() << "error: Can't open file " << E.second << ": "  << EC.message()
-             << "\n";
-      return true;
-    }
-  }
+  for (auto &E : Worklist)
+    Outputs.emplace_back(E.second, StringRef());
 
-  return false;
+  return WriteOutputFiles(Outputs);
 }
 
 static void PrintVersion(raw_ostream &OS) {
@@ -26,6 +26,7 @@
 #include "clang/Tooling/Refactoring.h"
 #include "clang/Tooling/Refactoring/Rename/RenamingAction.h"
 #include "clang/Tooling/Refactoring/Rename/USRFindingAction.h"
+#include "clang/Tooling/Refactoring/Rename/USRIndex.h"
 #include "clang/Tooling/ReplacementsYaml.h"
 #include "clang/Tooling/Tooling.h"
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
@@ -97,9 +98,53 @@ static cl::opt<std::string>
 static cl::opt<bool> Force("force",
                            cl::desc("Ignore nonexistent qualified names."),
                            cl::cat(ClangRenameOptions));
+static cl::opt<std::string> WriteUSRIndex(
+    "write-usr-index",
+    cl::desc("Index the symbols that each <source> mentions into <file>, for "
+             "later use with -usr-index, instead of renaming."),
+    cl::value_desc("file"), cl::cat(ClangRenameOptions));
+static cl::opt<std::string> USRIndex(
+    "usr-index",
+    cl::desc("Only rename in the <source>s that the index written by "
+             "-write-usr-index finds the symbols in, or that it does not "
+             "cover. The symbols are looked up in the first <source>."),
+    cl::value_desc("file"), cl::cat(ClangRenameOptions));
+
+namespace {
+/// Creates the actions that add translation units to a USR index.
+class USRIndexingActionFactory : public tooling::FrontendActionFactory {
+public:
+  USRIndexingActionFactory(tooling::USRIndexBuilder &Builder)
+      : Builder(Builder) {}
+
+  FrontendAction *create() override {
+    return Builder.newIndexingAction().release();
+  }
+
+private:
+  tooling::USRIndexBuilder &Builder;
+};
+} // end anonymous namespace
 
 int main(int argc, const char **argv) {
   tooling::CommonOptionsParser OP(argc, argv, ClangRenameOptions);
+  auto Files = OP.getSourcePathList();
+
+  if (!WriteUSRIndex.empty()) {
+    tooling::USRIndexBuilder Builder;
+    tooling::ClangTool IndexTool(OP.getCompilations(), Files);
+    USRIndexingActionFactory Factory(Builder);
+    int ExitCode = IndexTool.run(&Factory);
+
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(WriteUSRIndex, EC, llvm::sys::fs::F_None);
+    if (EC) {
+      llvm::errs() << "Error opening output file: " << EC.message() << '\n';
+      return 1;
+    }
+    Builder.write(OS);
+    return ExitCode;
+  }
 
   if (!Input.empty()) {
     // Populate QualifiedNames and NewNames from a YAML file.
@@ -157,10 +202,14 @@ int main(int argc, const char **argv) {
     return 1;
   }
 
-  auto Files = OP.getSourcePathList();
-  tooling::RefactoringTool Tool(OP.getCompilations(), Files);
+  // With an index, the symbols are looked up in the first file only, and
+  // every other file is only parsed if the index can't rule it out.
+  std::vector<std::string> FindingFiles = Files;
+  if (!USRIndex.empty())
+    FindingFiles.resize(1);
+  tooling::ClangTool FindingTool(OP.getCompilations(), FindingFiles);
   tooling::USRFindingAction FindingAction(SymbolOffsets, QualifiedNames, Force);
-  Tool.run(tooling::newFrontendActionFactory(&FindingAction).get());
+  FindingTool.run(tooling::newFrontendActionFactory(&FindingAction).get());
   const std::vector<std::vector<std::string>> &USRList =
       FindingAction.getUSRList();
   const std::vector<std::string> &PrevNames = FindingAction.getUSRSpellings();
@@ -175,7 +224,20 @@ int main(int argc, const char **argv) {
     return 1;
   }
 
+  std::vector<std::string> RenameFiles = Files;
+  if (!USRIndex.empty()) {
+    auto SelectedFiles =
+        tooling::selectFilesFromUSRIndex(USRIndex, Files, USRList);
+    if (!SelectedFiles) {
+      errs() << "clang-rename: " << toString(SelectedFiles.takeError())
+             << "\n";
+      return 1;
+    }
+    RenameFiles = std::move(*SelectedFiles);
+  }
+
   // Perform the renaming.
+  tooling::RefactoringTool Tool(OP.getCompilations(), RenameFiles);
   tooling::RenamingAction RenameAction(NewNames, PrevNames, USRList,
                                        Tool.getReplacements(), PrintLocations);
   std::unique_ptr<tooling::FrontendActionFactory> Factory =
@@ -0,0 +1,53 @@
+//===- MergeSerializedDiagnostics.cpp - diagtool tool for merging .dia ----===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "DiagTool.h"
+#include "clang/Frontend/SerializedDiagnosticPrinter.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/raw_ostream.h"
+#include <string>
+#include <vector>
+
+DEF_DIAGTOOL("merge-serialized",
+             "Merge serialized diagnostics files into one indexed file",
+             MergeSerializedDiagnostics)
+
+using namespace clang;
+
+int MergeSerializedDiagnostics::run(unsigned int argc, char **argv,
+                                    llvm::raw_ostream &OS) {
+  static llvm::cl::OptionCategory MergeSerializedOptions(
+      "diagtool merge-serialized options");
+
+  static llvm::cl::list<std::string> InputFiles(
+      llvm::cl::Positional, llvm::cl::desc("<input .dia files>"),
+      llvm::cl::OneOrMore, llvm::cl::cat(MergeSerializedOptions));
+
+  static llvm::cl::opt<std::string> OutputFile(
+      "o", llvm::cl::desc("The merged diagnostics file"),
+      llvm::cl::value_desc("file"), llvm::cl::Required,
+      llvm::cl::cat(MergeSerializedOptions));
+
+  std::vector<const char *> Args;
+  Args.push_back("diagtool merge-serialized");
+  for (const char *A : llvm::makeArrayRef(argv, argc))
+    Args.push_back(A);
+
+  llvm::cl::HideUnrelatedOptions(MergeSerializedOptions);
+  llvm::cl::ParseCommandLineOptions((int)Args.size(), Args.data(),
+                                    "Serialized diagnostics merging utility");
+
+  std::vector<std::string> Inputs(InputFiles.begin(), InputFiles.end());
+  if (std::error_code EC = serialized_diags::mergeFiles(Inputs, OutputFile)) {
+    llvm::errs() << "error: could not merge the diagnostics into '"
+                 << OutputFile << "': " << EC.message() << "\n";
+    return 1;
+  }
+  return 0;
+}
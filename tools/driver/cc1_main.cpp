@@ -14,6 +14,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Basic/Stack.h"
+#include "clang/Basic/TimeTraceProfiler.h"
 #include "clang/CodeGen/ObjectFilePCHContainerOperations.h"
 #include "clang/Config/config.h"
 #include "clang/Driver/DriverDiagnostic.h"
@@ -35,6 +36,7 @@
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/Timer.h"
@@ -215,8 +217,39 @@ int cc1_main(ArrayRef<const char *> Argv, const char *Argv0, void *MainAddr) {
   if (!Success)
     return 1;
 
+  const FrontendOptions &FrontendOpts = Clang->getFrontendOpts();
+  if (FrontendOpts.TimeTrace)
+    timeTraceProfilerInitialize(FrontendOpts.TimeTraceGranularity);
+
   // Execute the frontend actions.
-  Success = ExecuteCompilerInvocation(Clang.get());
+  {
+    TimeTraceScope TimeScope("ExecuteCompiler", [&]() {
+      return FrontendOpts.Inputs.empty()
+                 ? std::string()
+                 : FrontendOpts.Inputs[0].getFile().str();
+    });
+    Success = ExecuteCompilerInvocation(Clang.get());
+  }
+
+  // Write the time trace next to the output, or for -fsyntax-only and
+  // similar actions, to the current directory as <input>.json.
+  if (timeTraceProfilerEnabled()) {
+    SmallString<128> Path(FrontendOpts.OutputFile);
+    if ((Path.empty() || Path == "-") && !FrontendOpts.Inputs.empty() &&
+        FrontendOpts.Inputs[0].isFile())
+      Path = llvm::sys::path::filename(FrontendOpts.Inputs[0].getFile());
+    if (!Path.empty() && Path != "-") {
+      llvm::sys::path::replace_extension(Path, "json");
+      std::error_code EC;
+      llvm::raw_fd_ostream OS(Path, EC, llvm::sys::fs::F_Text);
+      if (EC)
+        Clang->getDiagnostics().Report(diag::err_fe_unable_to_open_output)
+            << Path << EC.message();
+      else
+        timeTraceProfilerWrite(OS);
+    }
+    timeTraceProfilerCleanup();
+  }
 
   // If any timers were active but haven't been destroyed yet, print their
   // results now.  This happens in -disable-free mode.
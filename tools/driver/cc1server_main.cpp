@@ -0,0 +1,121 @@
+//===-- cc1server_main.cpp - Clang persistent CC1 server ------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This is the entry point to the clang -cc1server functionality, which runs
+// many -cc1 invocations in one process so that build systems issuing lots of
+// small compiles pay for process startup, dynamic linking, static
+// initialization and target registration only once.
+//
+// The server is run as 'clang -cc1server -status-file <path>' and reads one
+// -cc1 command line per line of standard input, using GNU quoting rules. A
+// leading '-cc1' is optional. Each command runs in a fresh CompilerInstance,
+// exactly as 'clang -cc1' would run it; its output and diagnostics go to
+// standard output and standard error as usual, and when the command finishes
+// the server writes 'exit <status>' on a line of its own to the status file,
+// which is typically a pipe. The server stops at the end of its input.
+//
+// Nothing that depends on the contents of the file system, such as the file
+// manager's stat cache or loaded modules, is kept across commands, so a
+// command sees the same inputs it would see in a fresh process. Options that
+// set process-wide LLVM command line options are rejected, since those could
+// not be reset for the following commands.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/ScopeExit.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/StringSaver.h"
+#include "llvm/Support/raw_ostream.h"
+#include <iostream>
+#include <string>
+
+using namespace clang;
+
+extern int cc1_main(ArrayRef<const char *> Argv, const char *Argv0,
+                    void *MainAddr);
+
+/// The -cc1 options that set LLVM command line options, which are global to
+/// the process and cannot be reset, so they would leak into every later
+/// command. These are the options that setCommandLineOpts in BackendUtil.cpp
+/// and ExecuteCompilerInvocation pass to cl::ParseCommandLineOptions.
+static const char *const ProcessGlobalOptions[] = {
+    "-mllvm", "-mdebug-pass", "-mlimit-float-precision"};
+
+/// Run one command read by the server, returning its exit status.
+static int runServerCommand(StringRef Line, const char *Argv0,
+                            void *MainAddr) {
+  // cc1_main installs a fatal error handler that refers to the diagnostics of
+  // the command, and only removes it if the command gets that far. Make sure
+  // that the next command can install its own.
+  auto RemoveHandler =
+      llvm::make_scope_exit([] { llvm::remove_fatal_error_handler(); });
+
+  llvm::BumpPtrAllocator A;
+  llvm::StringSaver Saver(A);
+  SmallVector<const char *, 64> Tokens;
+  llvm::cl::TokenizeGNUCommandLine(Line, Saver, Tokens);
+
+  SmallVector<const char *, 64> Args;
+  for (const char *Tok : Tokens) {
+    StringRef Arg(Tok);
+    if (Args.empty() && Arg == "-cc1")
+      continue;
+    if (llvm::is_contained(ProcessGlobalOptions, Arg)) {
+      llvm::errs() << "error: '" << Arg
+                   << "' is not supported by '-cc1server'\n";
+      return 1;
+    }
+    // -disable-free leaks the whole compiler instance on purpose, which a
+    // long-lived process cannot afford.
+    if (Arg == "-disable-free")
+      continue;
+    Args.push_back(Tok);
+  }
+
+  return cc1_main(Args, Argv0, MainAddr);
+}
+
+int cc1server_main(ArrayRef<const char *> Argv, const char *Argv0,
+                   void *MainAddr) {
+  // The statuses go to a channel of their own, so that they can't be confused
+  // with the output of commands that write to standard output.
+  if (Argv.size() != 2 || StringRef(Argv[0]) != "-status-file") {
+    llvm::errs() << "error: '-cc1server' takes only '-status-file <path>'; "
+                    "commands are read from standard input\n";
+    return 1;
+  }
+
+  std::error_code EC;
+  llvm::raw_fd_ostream StatusOS(Argv[1], EC, llvm::sys::fs::F_Text);
+  if (EC) {
+    llvm::errs() << "error: unable to open status file '" << Argv[1]
+                 << "': " << EC.message() << '\n';
+    return 1;
+  }
+
+  std::string Line;
+  while (std::getline(std::cin, Line)) {
+    if (StringRef(Line).trim().empty())
+      continue;
+    int Status = runServerCommand(Line, Argv0, MainAddr);
+    llvm::outs().flush();
+    llvm::errs().flush();
+    StatusOS << "exit " << Status << '\n';
+    StatusOS.flush();
+  }
+  return 0;
+}
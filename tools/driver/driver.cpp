@@ -30,6 +30,7 @@
 #include "llvm/Option/OptTable.h"
 #include "llvm/Option/Option.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Host.h"
@@ -205,6 +206,8 @@ extern int cc1as_main(ArrayRef<const char *> Argv, const char *Argv0,
                       void *MainAddr);
 extern int cc1gen_reproducer_main(ArrayRef<const char *> Argv,
                                   const char *Argv0, void *MainAddr);
+extern int cc1server_main(ArrayRef<const char *> Argv, const char *Argv0,
+                          void *MainAddr);
 
 static void insertTargetAndModeArgs(const ParsedClangName &NameParts,
                                     SmallVectorImpl<const char *> &ArgVector,
@@ -312,13 +315,20 @@ static int ExecuteCC1Tool(ArrayRef<const char *> argv, StringRef Tool) {
     return cc1as_main(argv.slice(2), argv[0], GetExecutablePathVP);
   if (Tool == "gen-reproducer")
     return cc1gen_reproducer_main(argv.slice(2), argv[0], GetExecutablePathVP);
+  if (Tool == "server")
+    return cc1server_main(argv.slice(2), argv[0], GetExecutablePathVP);
 
   // Reject unknown tools.
   llvm::errs() << "error: unknown integrated tool '" << Tool << "'. "
-               << "Valid tools include '-cc1' and '-cc1as'.\n";
+               << "Valid tools include '-cc1', '-cc1as' and '-cc1server'.\n";
   return 1;
 }
 
+/// Run a -cc1 job in the driver's process; see Driver::CC1Main.
+static int ExecuteCC1ToolInProcess(ArrayRef<const char *> argv) {
+  return ExecuteCC1Tool(argv, StringRef(argv[1]).drop_front(4));
+}
+
 int main(int argc_, const char **argv_) {
   llvm::InitLLVM X(argc_, argv_);
   SmallVector<const char *, 256> argv(argv_, argv_ + argc_);
@@ -393,6 +403,19 @@ int main(int argc_, const char **argv_) {
     }
   }
 
+  // Whether to run -cc1 jobs in the driver's process, which saves the cost of
+  // creating and initializing a process for each one. The last flag wins.
+  bool IntegratedCC1 = false;
+  for (int i = 1, size = argv.size(); i < size; ++i) {
+    if (argv[i] == nullptr)
+      continue;
+    StringRef Arg(argv[i]);
+    if (Arg == "-fintegrated-cc1")
+      IntegratedCC1 = true;
+    else if (Arg == "-fno-integrated-cc1")
+      IntegratedCC1 = false;
+  }
+
   // Handle CL and _CL_ which permits additional command line options to be
   // prepended or appended.
   if (ClangCLMode) {
@@ -455,6 +478,13 @@ int main(int argc_, const char **argv_) {
 
   SetBackdoorDriverOutputsFromEnvVars(TheDriver);
 
+  if (IntegratedCC1) {
+    TheDriver.CC1Main = &ExecuteCC1ToolInProcess;
+    // Let CC1Command catch crashes in the job, so that the driver can still
+    // write a reproducer for them.
+    llvm::CrashRecoveryContext::Enable();
+  }
+
   std::unique_ptr<Compilation> C(TheDriver.BuildCompilation(argv));
   int Res = 1;
   if (C && !C->containsError()) {
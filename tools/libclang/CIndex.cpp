@@ -39,8 +39,10 @@
 #include "clang/Lex/PreprocessingRecord.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Serialization/SerializationDiagnostic.h"
+#include "clang/Tooling/SharedFileSystemCache.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/ScopeExit.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Config/llvm-config.h"
 #include "llvm/Support/Compiler.h"
@@ -55,6 +57,7 @@
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/Threading.h"
 #include "llvm/Support/Timer.h"
+#include "llvm/Support/thread.h"
 #include "llvm/Support/raw_ostream.h"
 
 #if LLVM_ENABLE_THREADS != 0 && defined(__APPLE__)
@@ -82,6 +85,7 @@ CXTranslationUnit cxtu::MakeCXTranslationUnit(CIndexer *CIdx,
   D->Diagnostics = nullptr;
   D->OverridenCursorsPool = createOverridenCXCursorsPool();
   D->CommentToXML = nullptr;
+  D->USRs = nullptr;
   D->ParsingOptions = 0;
   D->Arguments = {};
   return D;
@@ -3398,8 +3402,11 @@ clang_parseTranslationUnit_Impl(CXIndex CIdx, const char *source_filename,
   TranslationUnitKind TUKind
     = (options & (CXTranslationUnit_Incomplete |
                   CXTranslationUnit_SingleFileParse))? TU_Prefix : TU_Complete;
+  // A compacted translation unit does not keep cached completion results, so
+  // there is no point in building them.
   bool CacheCodeCompletionResults
-    = options & CXTranslationUnit_CacheCompletionResults;
+    = (options & CXTranslationUnit_CacheCompletionResults) &&
+      !(options & CXTranslationUnit_CompactAfterParse);
   bool IncludeBriefCommentsInCodeCompletion
     = options & CXTranslationUnit_IncludeBriefCommentsInCodeCompletion;
   bool SingleFileParse = options & CXTranslationUnit_SingleFileParse;
@@ -3475,6 +3482,10 @@ clang_parseTranslationUnit_Impl(CXIndex CIdx, const char *source_filename,
   if (options & CXTranslationUnit_DetailedPreprocessingRecord) {
     Args->push_back("-Xclang");
     Args->push_back("-detailed-preprocessing-record");
+    if (options & CXTranslationUnit_SkipMacroExpansionsInPreprocessingRecord) {
+      Args->push_back("-Xclang");
+      Args->push_back("-detailed-preprocessing-record-no-macro-expansions");
+    }
   }
 
   // Suppress any editor placeholder diagnostics.
@@ -3492,6 +3503,13 @@ clang_parseTranslationUnit_Impl(CXIndex CIdx, const char *source_filename,
       *CXXIdx, LibclangInvocationReporter::OperationKind::ParseOperation,
       options, llvm::makeArrayRef(*Args), /*InvocationArgs=*/None,
       unsaved_files);
+  // Each translation unit gets its own file system, so that it has its own
+  // working directory, but they all share the index's cache. The unit keeps
+  // using this file system when it is reparsed.
+  IntrusiveRefCntPtr<llvm::vfs::FileSystem> VFS;
+  if (auto Cache = CXXIdx->getFileSystemCache())
+    VFS = new tooling::SharedCachingFileSystem(std::move(Cache),
+                                               llvm::vfs::getRealFileSystem());
   std::unique_ptr<ASTUnit> Unit(ASTUnit::LoadFromCommandLine(
       Args->data(), Args->data() + Args->size(),
       CXXIdx->getPCHContainerOperations(), Diags,
@@ -3502,7 +3520,7 @@ clang_parseTranslationUnit_Impl(CXIndex CIdx, const char *source_filename,
       /*AllowPCHWithCompilerErrors=*/true, SkipFunctionBodies, SingleFileParse,
       /*UserFilesAreVolatile=*/true, ForSerialization,
       CXXIdx->getPCHContainerOperations()->getRawReader().getFormat(),
-      &ErrUnit));
+      &ErrUnit, std::move(VFS)));
 
   // Early failures in LoadFromCommandLine may return with ErrUnit unset.
   if (!Unit && !ErrUnit)
@@ -3523,6 +3541,8 @@ clang_parseTranslationUnit_Impl(CXIndex CIdx, const char *source_filename,
     TU->Arguments.reserve(Args->size());
     for (const char *Arg : *Args)
       TU->Arguments.push_back(Arg);
+    if (options & CXTranslationUnit_CompactAfterParse)
+      cxtu::getASTUnit(TU)->compact();
     return CXError_Success;
   }
   return CXError_Failure;
@@ -4030,6 +4050,7 @@ void clang_disposeTranslationUnit(CXTranslationUnit CTUnit) {
     delete static_cast<CXDiagnosticSetImpl *>(CTUnit->Diagnostics);
     disposeOverridenCXCursorsPool(CTUnit->OverridenCursorsPool);
     delete CTUnit->CommentToXML;
+    delete CTUnit->USRs;
     delete CTUnit;
   }
 }
@@ -4042,6 +4063,8 @@ unsigned clang_suspendTranslationUnit(CXTranslationUnit CTUnit) {
       return false;
 
     Unit->ResetForParse();
+    delete CTUnit->USRs;
+    CTUnit->USRs = nullptr;
     return true;
   }
 
@@ -4066,6 +4089,10 @@ clang_reparseTranslationUnit_Impl(CXTranslationUnit TU,
   delete static_cast<CXDiagnosticSetImpl*>(TU->Diagnostics);
   TU->Diagnostics = nullptr;
 
+  // The USRs belong to the AST that is about to be replaced.
+  delete TU->USRs;
+  TU->USRs = nullptr;
+
   CIndexer *CXXIdx = TU->CIdx;
   if (CXXIdx->isOptEnabled(CXGlobalOpt_ThreadBackgroundPriorityForEditing))
     setThreadBackgroundPriority();
@@ -4087,42 +4114,182 @@ clang_reparseTranslationUnit_Impl(CXTranslationUnit TU,
   }
 
   if (!CXXUnit->Reparse(CXXIdx->getPCHContainerOperations(),
-                        *RemappedFiles.get()))
+                        *RemappedFiles.get())) {
+    if (TU->ParsingOptions & CXTranslationUnit_CompactAfterParse)
+      CXXUnit->compact();
     return CXError_Success;
+  }
   if (isASTReadError(CXXUnit))
     return CXError_ASTReadError;
   return CXError_Failure;
 }
 
-int clang_reparseTranslationUnit(CXTranslationUnit TU,
-                                 unsigned num_unsaved_files,
-                                 struct CXUnsavedFile *unsaved_files,
-                                 unsigned options) {
-  LOG_FUNC_SECTION {
-    *Log << TU;
-  }
+/// Start a reparse of \p TU, which makes the results of the earlier ones
+/// stale: cancel the latest reparse task, make \p Cancellation the flag of the
+/// latest one, and return the generation of the new reparse.
+static unsigned long long startReparse(CXTranslationUnit TU,
+                                       std::atomic<bool> *Cancellation) {
+  std::lock_guard<std::mutex> Lock(TU->ReparseTaskMutex);
+  if (TU->LatestReparseCancellation)
+    *TU->LatestReparseCancellation = true;
+  TU->LatestReparseCancellation = Cancellation;
+  return ++TU->RequestedGeneration;
+}
 
-  if (num_unsaved_files && !unsaved_files)
-    return CXError_InvalidArguments;
+/// Reparse \p TU once the reparses that are running on it have finished,
+/// giving up at the next top-level declaration once \p Cancellation is set.
+static int reparseTranslationUnit(CXTranslationUnit TU,
+                                  ArrayRef<CXUnsavedFile> unsaved_files,
+                                  unsigned options,
+                                  unsigned long long Generation,
+                                  const std::atomic<bool> *Cancellation) {
+  std::lock_guard<std::mutex> Lock(TU->ReparseMutex);
+  if (Cancellation && *Cancellation)
+    return CXError_Cancelled;
+  // A reparse that started later may have taken the lock first; its result
+  // is the newer one, so don't replace it.
+  if (Generation < TU->Generation)
+    return CXError_Cancelled;
+
+  ASTUnit *CXXUnit = cxtu::getASTUnit(TU);
+  CXXUnit->setCancellationFlag(Cancellation);
+  // The flag belongs to the caller; don't leave it behind, even if the
+  // reparse crashes.
+  auto ResetCancellation = llvm::make_scope_exit(
+      [CXXUnit] { CXXUnit->setCancellationFlag(nullptr); });
+  TU->Generation = Generation;
 
   CXErrorCode result;
   auto ReparseTranslationUnitImpl = [=, &result]() {
-    result = clang_reparseTranslationUnit_Impl(
-        TU, llvm::makeArrayRef(unsaved_files, num_unsaved_files), options);
+    result = clang_reparseTranslationUnit_Impl(TU, unsaved_files, options);
   };
 
   llvm::CrashRecoveryContext CRC;
 
   if (!RunSafely(CRC, ReparseTranslationUnitImpl)) {
     fprintf(stderr, "libclang: crash detected during reparsing\n");
-    cxtu::getASTUnit(TU)->setUnsafeToFree(true);
+    CXXUnit->setUnsafeToFree(true);
     return CXError_Crashed;
   } else if (getenv("LIBCLANG_RESOURCE_USAGE"))
     PrintLibclangResourceUsage(TU);
 
+  if (result != CXError_Success && Cancellation && *Cancellation)
+    return CXError_Cancelled;
   return result;
 }
 
+int clang_reparseTranslationUnit(CXTranslationUnit TU,
+                                 unsigned num_unsaved_files,
+                                 struct CXUnsavedFile *unsaved_files,
+                                 unsigned options) {
+  LOG_FUNC_SECTION {
+    *Log << TU;
+  }
+
+  if (num_unsaved_files && !unsaved_files)
+    return CXError_InvalidArguments;
+  if (isNotUsableTU(TU)) {
+    LOG_BAD_TU(TU);
+    return CXError_InvalidArguments;
+  }
+
+  return reparseTranslationUnit(
+      TU, llvm::makeArrayRef(unsaved_files, num_unsaved_files), options,
+      startReparse(TU, /*Cancellation=*/nullptr), /*Cancellation=*/nullptr);
+}
+
+struct CXReparseTaskImpl {
+  CXTranslationUnit TU;
+  unsigned Options;
+  unsigned long long Generation;
+  /// The names and contents of the unsaved files, which the client may free
+  /// as soon as the task is created.
+  std::vector<std::pair<std::string, std::string>> UnsavedFileData;
+  std::vector<CXUnsavedFile> UnsavedFiles;
+  std::atomic<bool> Cancelled{false};
+  std::atomic<bool> Finished{false};
+  int Result = CXError_Success;
+  /// Runs the reparse; without thread support, it has already done so.
+  std::unique_ptr<llvm::thread> Thread;
+};
+
+CXReparseTask clang_reparseTranslationUnitAsync(
+    CXTranslationUnit TU, unsigned num_unsaved_files,
+    struct CXUnsavedFile *unsaved_files, unsigned options) {
+  LOG_FUNC_SECTION {
+    *Log << TU;
+  }
+
+  if (num_unsaved_files && !unsaved_files)
+    return nullptr;
+  if (isNotUsableTU(TU)) {
+    LOG_BAD_TU(TU);
+    return nullptr;
+  }
+
+  auto *Task = new CXReparseTaskImpl();
+  Task->TU = TU;
+  Task->Options = options;
+  for (const CXUnsavedFile &UF :
+       llvm::makeArrayRef(unsaved_files, num_unsaved_files))
+    Task->UnsavedFileData.emplace_back(UF.Filename, getContents(UF));
+  for (const auto &Data : Task->UnsavedFileData)
+    Task->UnsavedFiles.push_back(
+        {Data.first.c_str(), Data.second.data(),
+         static_cast<unsigned long>(Data.second.size())});
+
+  // Whatever the earlier reparses would produce is stale now.
+  Task->Generation = startReparse(TU, &Task->Cancelled);
+
+  Task->Thread = llvm::make_unique<llvm::thread>([Task] {
+    Task->Result =
+        reparseTranslationUnit(Task->TU, Task->UnsavedFiles, Task->Options,
+                               Task->Generation, &Task->Cancelled);
+    {
+      std::lock_guard<std::mutex> Lock(Task->TU->ReparseTaskMutex);
+      if (Task->TU->LatestReparseCancellation == &Task->Cancelled)
+        Task->TU->LatestReparseCancellation = nullptr;
+    }
+    Task->Finished = true;
+  });
+  return Task;
+}
+
+void clang_ReparseTask_cancel(CXReparseTask Task) {
+  if (Task)
+    Task->Cancelled = true;
+}
+
+unsigned clang_ReparseTask_isFinished(CXReparseTask Task) {
+  return Task ? Task->Finished.load() : 1;
+}
+
+int clang_ReparseTask_wait(CXReparseTask Task) {
+  if (!Task)
+    return CXError_InvalidArguments;
+  if (Task->Thread->joinable())
+    Task->Thread->join();
+  return Task->Result;
+}
+
+unsigned long long clang_ReparseTask_getGeneration(CXReparseTask Task) {
+  return Task ? Task->Generation : 0;
+}
+
+void clang_ReparseTask_dispose(CXReparseTask Task) {
+  if (!Task)
+    return;
+  clang_ReparseTask_wait(Task);
+  delete Task;
+}
+
+unsigned long long clang_getTranslationUnitGeneration(CXTranslationUnit TU) {
+  if (isNotUsableTU(TU)) {
+    LOG_BAD_TU(TU);
+    return 0;
+  }
+  return TU->Generation;
+}
 
 CXString clang_getTranslationUnitSpelling(CXTranslationUnit CTUnit) {
   if (isNotUsableTU(CTUnit)) {
@@ -8495,6 +8662,15 @@ const char *clang_getTUResourceUsageName(CXTUResourceUsageKind kind) {
     case CXTUResourceUsage_Preprocessor_HeaderSearch:
       str = "Preprocessor: header search tables";
       break;
+    case CXTUResourceUsage_Preprocessor_TokenCaches:
+      str = "Preprocessor: token caches";
+      break;
+    case CXTUResourceUsage_StoredDiagnostics:
+      str = "ASTUnit: stored diagnostics";
+      break;
+    case CXTUResourceUsage_Preamble:
+      str = "ASTUnit: precompiled preamble";
+      break;
   }
   return str;
 }
@@ -8585,6 +8761,20 @@ CXTUResourceUsage clang_getCXTUResourceUsage(CXTranslationUnit TU) {
                                CXTUResourceUsage_Preprocessor_HeaderSearch,
                                pp.getHeaderSearchInfo().getTotalMemory());
 
+  createCXTUResourceUsageEntry(*entries,
+                               CXTUResourceUsage_Preprocessor_TokenCaches,
+                               pp.getTokenCacheMemory());
+
+  // How much memory is used by the diagnostics kept for the client?
+  createCXTUResourceUsageEntry(*entries,
+                               CXTUResourceUsage_StoredDiagnostics,
+                               astUnit->getStoredDiagnosticsMemory());
+
+  // How large is the precompiled preamble, in memory or on disk?
+  if (size_t preambleSize = astUnit->getPreambleSize())
+    createCXTUResourceUsageEntry(*entries, CXTUResourceUsage_Preamble,
+                                 preambleSize);
+
   CXTUResourceUsage usage = { (void*) entries.get(),
                             (unsigned) entries->size(),
                             !entries->empty() ? &(*entries)[0] : nullptr };
@@ -8597,6 +8787,36 @@ void clang_disposeCXTUResourceUsage(CXTUResourceUsage usage) {
     delete (MemUsageEntries*) usage.data;
 }
 
+int clang_compactTranslationUnit(CXTranslationUnit TU) {
+  if (isNotUsableTU(TU)) {
+    LOG_BAD_TU(TU);
+    return CXError_InvalidArguments;
+  }
+
+  // Wait for the reparses that are running on the unit.
+  std::lock_guard<std::mutex> Lock(TU->ReparseMutex);
+  ASTUnit *CXXUnit = cxtu::getASTUnit(TU);
+  ASTUnit::ConcurrencyCheck Check(*CXXUnit);
+  CXXUnit->compact();
+  return CXError_Success;
+}
+
+int clang_getTranslationUnitPreambleUsage(CXTranslationUnit TU,
+                                          unsigned *builds, unsigned *reuses) {
+  if (isNotUsableTU(TU)) {
+    LOG_BAD_TU(TU);
+    return CXError_InvalidArguments;
+  }
+  if (!builds || !reuses)
+    return CXError_InvalidArguments;
+
+  std::lock_guard<std::mutex> Lock(TU->ReparseMutex);
+  ASTUnit *CXXUnit = cxtu::getASTUnit(TU);
+  *builds = CXXUnit->getNumPreambleBuilds();
+  *reuses = CXXUnit->getNumPreambleReuses();
+  return CXError_Success;
+}
+
 CXSourceRangeList *clang_getSkippedRanges(CXTranslationUnit TU, CXFile file) {
   CXSourceRangeList *skipped = new CXSourceRangeList;
   skipped->count = 0;
@@ -8688,7 +8908,7 @@ void clang::PrintLibclangResourceUsage(CXTranslationUnit TU) {
 //===----------------------------------------------------------------------===//
 
 /// Default to using our desired 8 MB stack size on "safety" threads.
-static unsigned SafetyStackThreadSize = DesiredStackSize;
+static std::atomic<unsigned> SafetyStackThreadSize = DesiredStackSize;
 
 namespace clang {
 
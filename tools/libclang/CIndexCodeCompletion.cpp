@@ -695,7 +695,8 @@ static CXCodeCompleteResults *
 clang_codeCompleteAt_Impl(CXTranslationUnit TU, const char *complete_filename,
                           unsigned complete_line, unsigned complete_column,
                           ArrayRef<CXUnsavedFile> unsaved_files,
-                          unsigned options) {
+                          unsigned options, StringRef TypedPrefix,
+                          unsigned MaxResults) {
   bool IncludeBriefComments = options & CXCodeComplete_IncludeBriefComments;
   bool SkipPreamble = options & CXCodeComplete_SkipPreamble;
   bool IncludeFixIts = options & CXCodeComplete_IncludeCompletionsWithFixIts;
@@ -747,6 +748,7 @@ clang_codeCompleteAt_Impl(CXTranslationUnit TU, const char *complete_filename,
   Opts.LoadExternal = !SkipPreamble;
   Opts.IncludeFixIts = IncludeFixIts;
   CaptureCompletionResults Capture(Opts, *Results, &TU);
+  Capture.setResultFilter(TypedPrefix, MaxResults);
 
   // Perform completion.
   std::vector<const char *> CArgs;
@@ -852,13 +854,11 @@ clang_codeCompleteAt_Impl(CXTranslationUnit TU, const char *complete_filename,
   return Results;
 }
 
-CXCodeCompleteResults *clang_codeCompleteAt(CXTranslationUnit TU,
-                                            const char *complete_filename,
-                                            unsigned complete_line,
-                                            unsigned complete_column,
-                                            struct CXUnsavedFile *unsaved_files,
-                                            unsigned num_unsaved_files,
-                                            unsigned options) {
+static CXCodeCompleteResults *
+codeCompleteAt(CXTranslationUnit TU, const char *complete_filename,
+               unsigned complete_line, unsigned complete_column,
+               struct CXUnsavedFile *unsaved_files, unsigned num_unsaved_files,
+               unsigned options, StringRef TypedPrefix, unsigned MaxResults) {
   LOG_FUNC_SECTION {
     *Log << TU << ' '
          << complete_filename << ':' << complete_line << ':' << complete_column;
@@ -871,7 +871,8 @@ CXCodeCompleteResults *clang_codeCompleteAt(CXTranslationUnit TU,
   auto CodeCompleteAtImpl = [=, &result]() {
     result = clang_codeCompleteAt_Impl(
         TU, complete_filename, complete_line, complete_column,
-        llvm::makeArrayRef(unsaved_files, num_unsaved_files), options);
+        llvm::makeArrayRef(unsaved_files, num_unsaved_files), options,
+        TypedPrefix, MaxResults);
   };
 
   llvm::CrashRecoveryContext CRC;
@@ -886,6 +887,28 @@ CXCodeCompleteResults *clang_codeCompleteAt(CXTranslationUnit TU,
   return result;
 }
 
+CXCodeCompleteResults *clang_codeCompleteAt(CXTranslationUnit TU,
+                                            const char *complete_filename,
+                                            unsigned complete_line,
+                                            unsigned complete_column,
+                                            struct CXUnsavedFile *unsaved_files,
+                                            unsigned num_unsaved_files,
+                                            unsigned options) {
+  return codeCompleteAt(TU, complete_filename, complete_line, complete_column,
+                        unsaved_files, num_unsaved_files, options,
+                        /*TypedPrefix=*/StringRef(), /*MaxResults=*/0);
+}
+
+CXCodeCompleteResults *clang_codeCompleteAtWithFilter(
+    CXTranslationUnit TU, const char *complete_filename,
+    unsigned complete_line, unsigned complete_column,
+    struct CXUnsavedFile *unsaved_files, unsigned num_unsaved_files,
+    unsigned options, const char *typed_prefix, unsigned max_results) {
+  return codeCompleteAt(TU, complete_filename, complete_line, complete_column,
+                        unsaved_files, num_unsaved_files, options,
+                        typed_prefix ? typed_prefix : "", max_results);
+}
+
 unsigned clang_defaultCodeCompleteOptions(void) {
   return CXCodeComplete_IncludeMacros;
 }
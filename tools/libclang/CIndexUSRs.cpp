@@ -48,20 +48,12 @@ CXString clang_getCursorUSR(CXCursor C) {
     if (!TU)
       return cxstring::createEmpty();
 
-    cxstring::CXStringBuf *buf = cxstring::getCXStringBuf(TU);
-    if (!buf)
-      return cxstring::createEmpty();
-
-    bool Ignore = cxcursor::getDeclCursorUSR(D, buf->Data);
-    if (Ignore) {
-      buf->dispose();
-      return cxstring::createEmpty();
-    }
-
-    // Return the C-string, but don't make a copy since it is already in
-    // the string buffer.
-    buf->Data.push_back('\0');
-    return createCXString(buf);
+    // Clients tend to ask for the USRs of the same declarations many times.
+    if (!TU->USRs)
+      TU->USRs = new USRCache(D->getASTContext());
+    assert(&TU->USRs->getASTContext() == &D->getASTContext() &&
+           "USR cache of another AST.");
+    return cxstring::createDup(TU->USRs->getUSR(D));
   }
 
   if (K == CXCursor_MacroDefinition) {
@@ -15,6 +15,7 @@
 #include "CXString.h"
 #include "clang/Basic/LLVM.h"
 #include "clang/Basic/Version.h"
+#include "clang/Tooling/SharedFileSystemCache.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/MD5.h"
@@ -38,8 +39,25 @@
 
 using namespace clang;
 
+void CIndexer::setCXGlobalOptFlags(unsigned options) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  Options = options;
+  // Translation units that already use the cache keep it alive; new ones
+  // start from a fresh cache if the option is enabled again.
+  if (!(options & CXGlobalOpt_ShareFileSystemCache))
+    FileSystemCache.reset();
+  else if (!FileSystemCache)
+    FileSystemCache = std::make_shared<tooling::SharedFileSystemCache>();
+}
+
 const std::string &CIndexer::getClangResourcesPath() {
-  // Did we already compute the path?
+  std::lock_guard<std::mutex> Lock(Mutex);
+  return getClangResourcesPathLocked();
+}
+
+const std::string &CIndexer::getClangResourcesPathLocked() {
+  // Did we already compute the path? Once computed, it never changes, so the
+  // returned reference stays valid without the lock.
   if (!ResourcesPath.empty())
     return ResourcesPath;
 
@@ -82,9 +100,10 @@ const std::string &CIndexer::getClangResourcesPath() {
 }
 
 StringRef CIndexer::getClangToolchainPath() {
+  std::lock_guard<std::mutex> Lock(Mutex);
   if (!ToolchainPath.empty())
     return ToolchainPath;
-  StringRef ResourcePath = getClangResourcesPath();
+  StringRef ResourcePath = getClangResourcesPathLocked();
   ToolchainPath = llvm::sys::path::parent_path(
       llvm::sys::path::parent_path(llvm::sys::path::parent_path(ResourcePath)));
   return ToolchainPath;
@@ -95,7 +114,7 @@ LibclangInvocationReporter::LibclangInvocationReporter(
     llvm::ArrayRef<const char *> Args,
     llvm::ArrayRef<std::string> InvocationArgs,
     llvm::ArrayRef<CXUnsavedFile> UnsavedFiles) {
-  StringRef Path = Idx.getInvocationEmissionPath();
+  std::string Path = Idx.getInvocationEmissionPath();
   if (Path.empty())
     return;
 
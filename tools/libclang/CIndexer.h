@@ -19,6 +19,8 @@
 #include "clang/Frontend/PCHContainerOperations.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/Mutex.h"
+#include <atomic>
+#include <mutex>
 #include <utility>
 
 namespace llvm {
@@ -33,18 +35,37 @@ class SourceLocation;
 class Token;
 class IdentifierInfo;
 
+namespace tooling {
+class SharedFileSystemCache;
+}
+
+/// The state behind a CXIndex.
+///
+/// Translation units created from the same index may be used concurrently
+/// from different threads, so everything here is either immutable, atomic,
+/// or guarded by \c Mutex.
 class CIndexer {
-  bool OnlyLocalDecls;
-  bool DisplayDiagnostics;
-  unsigned Options; // CXGlobalOptFlags.
+  std::atomic<bool> OnlyLocalDecls;
+  std::atomic<bool> DisplayDiagnostics;
+  std::atomic<unsigned> Options; // CXGlobalOptFlags.
 
-  std::string ResourcesPath;
   std::shared_ptr<PCHContainerOperations> PCHContainerOps;
 
+  /// Guards the members below.
+  mutable std::mutex Mutex;
+
+  std::string ResourcesPath;
+
   std::string ToolchainPath;
 
   std::string InvocationEmissionPath;
 
+  /// The cache shared by the translation units of this index, if
+  /// CXGlobalOpt_ShareFileSystemCache is set.
+  std::shared_ptr<tooling::SharedFileSystemCache> FileSystemCache;
+
+  const std::string &getClangResourcesPathLocked();
+
 public:
   CIndexer(std::shared_ptr<PCHContainerOperations> PCHContainerOps =
                std::make_shared<PCHContainerOperations>())
@@ -68,7 +89,7 @@ public:
   }
 
   unsigned getCXGlobalOptFlags() const { return Options; }
-  void setCXGlobalOptFlags(unsigned options) { Options = options; }
+  void setCXGlobalOptFlags(unsigned options);
 
   bool isOptEnabled(CXGlobalOptFlags opt) const {
     return Options & opt;
@@ -80,10 +101,21 @@ public:
   StringRef getClangToolchainPath();
 
   void setInvocationEmissionPath(StringRef Str) {
+    std::lock_guard<std::mutex> Lock(Mutex);
     InvocationEmissionPath = Str;
   }
 
-  StringRef getInvocationEmissionPath() const { return InvocationEmissionPath; }
+  std::string getInvocationEmissionPath() const {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    return InvocationEmissionPath;
+  }
+
+  /// Get the file system cache that new translation units should share, or
+  /// null if they should not share one.
+  std::shared_ptr<tooling::SharedFileSystemCache> getFileSystemCache() const {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    return FileSystemCache;
+  }
 };
 
 /// Logs information about a particular libclang operation like parsing to
@@ -0,0 +1,143 @@
+//===- CXCursorTree.cpp - Flattened cursor subtrees -----------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements clang_getCursorTree() and the routines that access
+// the flat tree it builds.
+//
+//===----------------------------------------------------------------------===//
+
+#include "CXCursor.h"
+#include "CXString.h"
+#include "clang-c/Index.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include <string>
+#include <vector>
+
+using namespace clang;
+
+struct CXCursorTreeImpl {
+  std::vector<CXCursorTreeNode> Nodes;
+  std::vector<CXCursor> Cursors;
+  std::vector<CXFile> Files;
+  /// Null-terminated strings; offset 0 is the empty string.
+  std::string Strings;
+};
+
+namespace {
+class CursorTreeBuilder {
+  CXCursorTreeImpl &Tree;
+  bool IncludeUSRs;
+  llvm::DenseMap<CXFile, unsigned> FileIndices;
+
+public:
+  /// The cursors from the root to the last visited one, with their indices.
+  SmallVector<std::pair<CXCursor, unsigned>, 32> Path;
+
+  CursorTreeBuilder(CXCursorTreeImpl &Tree, bool IncludeUSRs)
+      : Tree(Tree), IncludeUSRs(IncludeUSRs) {
+    Tree.Strings.push_back('\0');
+  }
+
+  unsigned addString(CXString Str) {
+    const char *S = clang_getCString(Str);
+    unsigned Offset = 0;
+    if (S && *S) {
+      Offset = Tree.Strings.size();
+      Tree.Strings.append(S);
+      Tree.Strings.push_back('\0');
+    }
+    clang_disposeString(Str);
+    return Offset;
+  }
+
+  unsigned getFileIndex(CXFile File) {
+    if (!File)
+      return ~0U;
+    auto Known = FileIndices.insert({File, Tree.Files.size()});
+    if (Known.second)
+      Tree.Files.push_back(File);
+    return Known.first->second;
+  }
+
+  unsigned addNode(CXCursor C, unsigned Parent) {
+    CXCursorTreeNode Node;
+    Node.kind = C.kind;
+    Node.parent = Parent;
+
+    CXSourceRange Extent = clang_getCursorExtent(C);
+    CXFile File;
+    clang_getExpansionLocation(clang_getRangeStart(Extent), &File,
+                               &Node.begin_line, &Node.begin_column,
+                               &Node.begin_offset);
+    Node.file = getFileIndex(File);
+    clang_getExpansionLocation(clang_getRangeEnd(Extent), nullptr, nullptr,
+                               nullptr, &Node.end_offset);
+
+    Node.spelling = addString(clang_getCursorSpelling(C));
+    Node.usr = IncludeUSRs ? addString(clang_getCursorUSR(C)) : 0;
+
+    Tree.Nodes.push_back(Node);
+    Tree.Cursors.push_back(C);
+    return Tree.Nodes.size() - 1;
+  }
+};
+} // end anonymous namespace
+
+static CXChildVisitResult visitCursorTreeNode(CXCursor C, CXCursor Parent,
+                                              CXClientData Data) {
+  auto &Builder = *static_cast<CursorTreeBuilder *>(Data);
+  // The traversal is in preorder, so the parent is on the path to the
+  // previous cursor.
+  while (Builder.Path.size() > 1 &&
+         !clang_equalCursors(Builder.Path.back().first, Parent))
+    Builder.Path.pop_back();
+  unsigned Index = Builder.addNode(C, Builder.Path.back().second);
+  Builder.Path.push_back({C, Index});
+  return CXChildVisit_Recurse;
+}
+
+CXCursorTree clang_getCursorTree(CXCursor Root, unsigned Options) {
+  if (clang_Cursor_isNull(Root) || clang_isInvalid(Root.kind))
+    return nullptr;
+
+  auto *Tree = new CXCursorTreeImpl();
+  CursorTreeBuilder Builder(*Tree, Options & CXCursorTree_IncludeUSRs);
+  Builder.Path.push_back({Root, Builder.addNode(Root, ~0U)});
+  clang_visitChildren(Root, visitCursorTreeNode, &Builder);
+  return Tree;
+}
+
+void clang_disposeCursorTree(CXCursorTree Tree) { delete Tree; }
+
+unsigned clang_CursorTree_getNumNodes(CXCursorTree Tree) {
+  return Tree ? Tree->Nodes.size() : 0;
+}
+
+const CXCursorTreeNode *clang_CursorTree_getNodes(CXCursorTree Tree) {
+  return Tree ? Tree->Nodes.data() : nullptr;
+}
+
+const char *clang_CursorTree_getStrings(CXCursorTree Tree, unsigned *Size) {
+  if (Size)
+    *Size = Tree ? Tree->Strings.size() : 0;
+  return Tree ? Tree->Strings.data() : nullptr;
+}
+
+CXFile clang_CursorTree_getFile(CXCursorTree Tree, unsigned Index) {
+  if (!Tree || Index >= Tree->Files.size())
+    return nullptr;
+  return Tree->Files[Index];
+}
+
+CXCursor clang_CursorTree_getCursor(CXCursorTree Tree, unsigned Index) {
+  if (!Tree || Index >= Tree->Cursors.size())
+    return clang_getNullCursor();
+  return Tree->Cursors[Index];
+}
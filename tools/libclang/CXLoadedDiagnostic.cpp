@@ -20,9 +20,13 @@
 #include "clang/Frontend/SerializedDiagnostics.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/Bitcode/BitstreamReader.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <mutex>
 
 using namespace clang;
 
@@ -30,30 +34,45 @@ using namespace clang;
 // Extend CXDiagnosticSetImpl which contains strings for diagnostics.
 //===----------------------------------------------------------------------===//
 
-typedef llvm::DenseMap<unsigned, const char *> Strings;
+typedef llvm::DenseMap<unsigned, StringRef> Strings;
 
 namespace {
+/// The category and flag names of all loaded diagnostic sets.
+///
+/// The diagnostics files of a build mostly name the same categories and
+/// flags, so they are interned once for the process rather than copied into
+/// every set that is loaded.
+class LoadedDiagnosticNames {
+  std::mutex Mutex;
+  llvm::StringSet<> Names;
+
+public:
+  StringRef intern(StringRef Name) {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    return Names.insert(Name).first->getKey();
+  }
+};
+
+llvm::ManagedStatic<LoadedDiagnosticNames> SharedNames;
+
 class CXLoadedDiagnosticSetImpl : public CXDiagnosticSetImpl {
 public:
   CXLoadedDiagnosticSetImpl() : CXDiagnosticSetImpl(true), FakeFiles(FO) {}
   ~CXLoadedDiagnosticSetImpl() override {}
 
+  /// The diagnostics file, which the diagnostic and fix-it texts point into.
+  std::unique_ptr<llvm::MemoryBuffer> Buffer;
+
   llvm::BumpPtrAllocator Alloc;
   Strings Categories;
   Strings WarningFlags;
-  Strings FileNames;
-  
-  FileSystemOptions FO;
-  FileManager FakeFiles;
   llvm::DenseMap<unsigned, const FileEntry *> Files;
 
-  /// Copy the string into our own allocator.
-  const char *copyString(StringRef Blob) {
-    char *mem = Alloc.Allocate<char>(Blob.size() + 1);
-    memcpy(mem, Blob.data(), Blob.size());
-    mem[Blob.size()] = '\0';
-    return mem;
-  }
+  /// The files of the set. A set records the size and modification time of
+  /// each file as they were when it was written, so the sets loaded in one
+  /// process must not share them.
+  FileSystemOptions FO;
+  FileManager FakeFiles;
 };
 } // end anonymous namespace
 
@@ -103,8 +122,19 @@ CXSourceLocation CXLoadedDiagnostic::getLocation() const {
   return makeLocation(&DiagLoc);
 }
 
+/// Returns a string for text that points into the diagnostics file. The
+/// bitstream pads blobs with zeros, so only the texts whose size is a
+/// multiple of four need a terminated copy.
+static CXString createBlobRef(StringRef Blob) {
+  if (Blob.empty())
+    return cxstring::createEmpty();
+  if (Blob.size() % 4 == 0)
+    return cxstring::createDup(Blob);
+  return cxstring::createRef(Blob);
+}
+
 CXString CXLoadedDiagnostic::getSpelling() const {
-  return cxstring::createRef(Spelling);
+  return createBlobRef(Spelling);
 }
 
 CXString CXLoadedDiagnostic::getDiagnosticOption(CXString *Disable) const {
@@ -143,7 +173,7 @@ CXString CXLoadedDiagnostic::getFixIt(unsigned FixIt,
   assert(FixIt < FixIts.size());
   if (ReplacementRange)
     *ReplacementRange = FixIts[FixIt].first;
-  return cxstring::createRef(FixIts[FixIt].second);
+  return createBlobRef(FixIts[FixIt].second);
 }
 
 void CXLoadedDiagnostic::decodeLocation(CXSourceLocation location,
@@ -250,7 +280,17 @@ public:
 CXDiagnosticSet DiagLoader::load(const char *file) {
   TopDiags = llvm::make_unique<CXLoadedDiagnosticSetImpl>();
 
-  std::error_code EC = readDiagnostics(file);
+  // Map the file rather than reading it, since the set keeps it for as long
+  // as it lives.
+  auto Buffer = llvm::MemoryBuffer::getFile(file, /*FileSize=*/-1,
+                                            /*RequiresNullTerminator=*/false);
+  std::error_code EC;
+  if (!Buffer)
+    EC = serialized_diags::SDError::CouldNotLoad;
+  else {
+    TopDiags->Buffer = std::move(*Buffer);
+    EC = readDiagnostics(TopDiags->Buffer->getMemBufferRef());
+  }
   if (EC) {
     switch (EC.value()) {
     case static_cast<int>(serialized_diags::SDError::HandlerFailed):
@@ -324,7 +364,7 @@ std::error_code DiagLoader::visitCategoryRecord(unsigned ID, StringRef Name) {
   // FIXME: Why do we care about long strings?
   if (Name.size() > 65536)
     return reportInvalidFile("Out-of-bounds string in category");
-  TopDiags->Categories[ID] = TopDiags->copyString(Name);
+  TopDiags->Categories[ID] = SharedNames->intern(Name);
   return std::error_code();
 }
 
@@ -332,7 +372,7 @@ std::error_code DiagLoader::visitDiagFlagRecord(unsigned ID, StringRef Name) {
   // FIXME: Why do we care about long strings?
   if (Name.size() > 65536)
     return reportInvalidFile("Out-of-bounds string in warning flag");
-  TopDiags->WarningFlags[ID] = TopDiags->copyString(Name);
+  TopDiags->WarningFlags[ID] = SharedNames->intern(Name);
   return std::error_code();
 }
 
@@ -342,9 +382,8 @@ std::error_code DiagLoader::visitFilenameRecord(unsigned ID, unsigned Size,
   // FIXME: Why do we care about long strings?
   if (Name.size() > 65536)
     return reportInvalidFile("Out-of-bounds string in filename");
-  TopDiags->FileNames[ID] = TopDiags->copyString(Name);
-  TopDiags->Files[ID] =
-      TopDiags->FakeFiles.getVirtualFile(Name, Size, Timestamp);
+  TopDiags->Files[ID] = TopDiags->FakeFiles.getVirtualFile(Name, Size,
+                                                           Timestamp);
   return std::error_code();
 }
 
@@ -369,7 +408,7 @@ DiagLoader::visitFixitRecord(const serialized_diags::Location &Start,
   if (CodeToInsert.size() > 65536)
     return reportInvalidFile("Out-of-bounds string in FIXIT");
   CurrentDiags.back()->FixIts.push_back(
-      std::make_pair(SR, TopDiags->copyString(CodeToInsert)));
+      std::make_pair(SR, CodeToInsert));
   return std::error_code();
 }
 
@@ -383,7 +422,7 @@ std::error_code DiagLoader::visitDiagnosticRecord(
   D.category = Category;
   D.DiagOption = Flag ? TopDiags->WarningFlags[Flag] : "";
   D.CategoryText = Category ? TopDiags->Categories[Category] : "";
-  D.Spelling = TopDiags->copyString(Message);
+  D.Spelling = Message;
   return std::error_code();
 }
 
@@ -81,8 +81,10 @@ public:
   Location DiagLoc;
 
   std::vector<CXSourceRange> Ranges;
-  std::vector<std::pair<CXSourceRange, const char *> > FixIts;
-  const char *Spelling;
+  // The texts of the diagnostic and its fix-its point into the mapped
+  // diagnostics file, which the diagnostic set keeps alive.
+  std::vector<std::pair<CXSourceRange, llvm::StringRef> > FixIts;
+  llvm::StringRef Spelling;
   llvm::StringRef DiagOption;
   llvm::StringRef CategoryText;
   unsigned severity;
@@ -17,12 +17,15 @@
 #include "CLog.h"
 #include "CXString.h"
 #include "clang-c/Index.h"
+#include <atomic>
+#include <mutex>
 
 namespace clang {
   class ASTUnit;
   class CIndexer;
 namespace index {
 class CommentToXMLConverter;
+class USRCache;
 } // namespace index
 } // namespace clang
 
@@ -33,8 +36,20 @@ struct CXTranslationUnitImpl {
   void *Diagnostics;
   void *OverridenCursorsPool;
   clang::index::CommentToXMLConverter *CommentToXML;
+  /// The USRs of the declarations of the current AST, created on demand.
+  clang::index::USRCache *USRs;
   unsigned ParsingOptions;
   std::vector<std::string> Arguments;
+  /// Held while the unit is reparsed, so that reparses run one at a time.
+  std::mutex ReparseMutex;
+  /// Guards LatestReparseCancellation.
+  std::mutex ReparseTaskMutex;
+  /// The cancellation flag of the latest reparse task, until it finishes.
+  std::atomic<bool> *LatestReparseCancellation = nullptr;
+  /// The generation of the latest reparse that was started.
+  std::atomic<unsigned long long> RequestedGeneration{0};
+  /// The generation of the latest reparse that ran.
+  std::atomic<unsigned long long> Generation{0};
 };
 
 struct CXTargetInfoImpl {
@@ -579,6 +579,9 @@ static CXErrorCode clang_indexSourceFile_Impl(
 
   if (TU_options & CXTranslationUnit_DetailedPreprocessingRecord) {
     PPOpts.DetailedRecord = true;
+    PPOpts.DetailedRecordMacroExpansions =
+        !(TU_options &
+          CXTranslationUnit_SkipMacroExpansionsInPreprocessingRecord);
   }
 
   if (!requestedToGetTU && !CInvok->getLangOpts()->Modules)
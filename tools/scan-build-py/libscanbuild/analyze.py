@@ -31,11 +31,14 @@ from libscanbuild import command_entry_point, compiler_wrapper, \
 from libscanbuild.arguments import parse_args_for_scan_build, \
     parse_args_for_analyze_build
 from libscanbuild.intercept import capture
-from libscanbuild.report import document
+from libscanbuild.report import document, create_bug_collector
 from libscanbuild.compilation import split_command, classify_source, \
     compiler_language
 from libscanbuild.clang import get_version, get_arguments, get_triple_arch
 from libscanbuild.shell import decode
+from libscanbuild.benchmark import run_measured, parse_analyzer_stats, \
+    count_reports, write_benchmark, read_benchmark, compare_benchmarks, \
+    longest_first
 
 __all__ = ['scan_build', 'analyze_build', 'analyze_compiler_wrapper']
 
@@ -80,12 +83,28 @@ def analyze_build():
     args = parse_args_for_analyze_build()
     # will re-assign the report directory as new output
     with report_directory(args.output, args.keep_empty) as args.output:
-        # Run the analyzer against a compilation db.
-        govern_analyzer_runs(args)
+        # Run the analyzer against a compilation db, and merge the reports
+        # as they are written.
+        collector = create_bug_collector(
+            args.output, args.output_format in {'html', 'plist-html'})
+        govern_analyzer_runs(args, collector)
         # Cover report generation and bug counting.
-        number_of_bugs = document(args)
+        number_of_bugs = document(args, collector)
+        # Compare the costs of the analysis with an earlier run.
+        regressions = check_benchmark(args)
         # Set exit status as it was requested.
-        return number_of_bugs if args.status_bugs else 0
+        return number_of_bugs if args.status_bugs else int(bool(regressions))
+
+
+def check_benchmark(args):
+    """ Compare the benchmark of this run with the baseline benchmark, when
+    both were requested. Returns the list of regressions. """
+
+    if not args.benchmark or not args.benchmark_baseline:
+        return []
+    return compare_benchmarks(read_benchmark(args.benchmark_baseline),
+                              read_benchmark(args.benchmark),
+                              args.benchmark_threshold)
 
 
 def need_analyzer(args):
@@ -203,8 +222,11 @@ def merge_ctu_func_maps(ctudir):
             shutil.rmtree(fnmap_dir, ignore_errors=True)
 
 
-def run_analyzer_parallel(args):
-    """ Runs the analyzer against the given compilation database. """
+def run_analyzer_parallel(args, collector=None):
+    """ Runs the analyzer against the given compilation database.
+
+    When a bug collector is given, it is called each time a translation unit
+    is done, to merge the new reports while the others are analyzed. """
 
     def exclude(filename):
         """ Return true when any excluded directory prefix the filename. """
@@ -218,13 +240,20 @@ def run_analyzer_parallel(args):
         'output_failures': args.output_failures,
         'direct_args': analyzer_params(args),
         'force_debug': args.force_debug,
-        'ctu': get_ctu_config_from_args(args)
+        'ctu': get_ctu_config_from_args(args),
+        'benchmark': bool(args.benchmark)
     }
 
     logging.debug('run analyzer against compilation database')
+    benchmarks = []
     with open(args.cdb, 'r') as handle:
+        entries = json.load(handle)
+        # start with the ones which took the longest in an earlier run.
+        schedule = args.schedule or args.benchmark_baseline
+        if schedule:
+            entries = longest_first(entries, read_benchmark(schedule))
         generator = (dict(cmd, **consts)
-                     for cmd in json.load(handle) if not exclude(cmd['file']))
+                     for cmd in entries if not exclude(cmd['file']))
         # when verbose output requested execute sequentially
         pool = multiprocessing.Pool(1 if args.verbose > 2 else None)
         for current in pool.imap_unordered(run, generator):
@@ -232,11 +261,16 @@ def run_analyzer_parallel(args):
                 # display error message from the static analyzer
                 for line in current['error_output']:
                     logging.info(line.rstrip())
+                if 'benchmark' in current:
+                    benchmarks.append(current['benchmark'])
+            if collector is not None:
+                collector()
         pool.close()
         pool.join()
+    return benchmarks
 
 
-def govern_analyzer_runs(args):
+def govern_analyzer_runs(args, collector=None):
     """ Governs multiple runs in CTU mode or runs once in normal mode. """
 
     ctu_config = get_ctu_config_from_args(args)
@@ -259,14 +293,18 @@ def govern_analyzer_runs(args):
         merge_ctu_func_maps(ctu_config.dir)
         args.ctu_phases = CtuConfig(collect=False, analyze=True,
                                     dir='', func_map_cmd='')
-        run_analyzer_parallel(args)
+        benchmarks = run_analyzer_parallel(args, collector)
         shutil.rmtree(ctu_config.dir, ignore_errors=True)
     else:
         # Single runs (collect or analyze) are launched from here.
-        run_analyzer_parallel(args)
+        benchmarks = run_analyzer_parallel(args, collector)
         if ctu_config.collect:
             merge_ctu_func_maps(ctu_config.dir)
 
+    # Only the analyzer runs are measured, not the collect phase of CTU.
+    if args.benchmark:
+        write_benchmark(args.benchmark, args.clang, benchmarks)
+
 
 def setup_environment(args):
     """ Set up environment for build command to interpose compiler wrapper. """
@@ -373,7 +411,7 @@ def analyzer_params(args):
     if args.constraints_model:
         result.append('-analyzer-constraints={0}'.format(
             args.constraints_model))
-    if args.internal_stats:
+    if args.internal_stats or args.benchmark:
         result.append('-analyzer-stats')
     if args.analyze_headers:
         result.append('-analyzer-opt-analyze-headers')
@@ -530,10 +568,13 @@ def run_analyzer(opts, continuation=report_failure):
 
     try:
         cwd = opts['directory']
+        report = target()
         cmd = get_arguments([opts['clang'], '--analyze'] +
                             opts['direct_args'] + opts['flags'] +
-                            [opts['file'], '-o', target()],
+                            [opts['file'], '-o', report],
                             cwd)
+        if opts.get('benchmark', False):
+            return run_analyzer_measured(opts, cmd, report, continuation)
         output = run_command(cmd, cwd=cwd)
         return {'error_output': output, 'exit_code': 0}
     except subprocess.CalledProcessError as ex:
@@ -544,6 +585,27 @@ def run_analyzer(opts, continuation=report_failure):
         return result
 
 
+def run_analyzer_measured(opts, cmd, report, continuation):
+    """ Execute the analysis command line, like 'run_analyzer' does, and
+    also return what the analysis of the translation unit cost. """
+
+    exit_code, output, benchmark = run_measured(cmd, cwd=opts['directory'])
+    benchmark.update({
+        'directory': opts['directory'],
+        'file': opts['file'],
+        'exit_code': exit_code,
+        'stats': parse_analyzer_stats(output),
+        'checkers': count_reports(report if report.endswith('.plist')
+                                  else None)
+    })
+    result = {'error_output': output, 'exit_code': exit_code,
+              'benchmark': benchmark}
+    if exit_code != 0 and opts.get('output_failures', False):
+        opts.update(result)
+        continuation(opts)
+    return result
+
+
 def func_map_list_src_to_ast(func_src_list):
     """ Turns textual function map list with source files into a
     function map list with ast files. """
@@ -97,6 +97,10 @@ def normalize_args_for_analyze(args, from_build_command):
     if from_build_command:
         # add cdb parameter invisibly to make report module working.
         args.cdb = 'compile_commands.json'
+        # benchmarking needs a compilation database.
+        args.benchmark = None
+        args.benchmark_baseline = None
+        args.schedule = None
 
     # Make ctu_dir an abspath as it is needed inside clang
     if not from_build_command and hasattr(args, 'ctu_phases') \
@@ -126,6 +130,9 @@ def validate_args_for_analyze(parser, args, from_build_command):
         parser.error(message='missing build command')
     elif not from_build_command and not os.path.exists(args.cdb):
         parser.error(message='compilation database is missing')
+    elif not from_build_command and args.benchmark_baseline \
+            and not args.benchmark:
+        parser.error(message='--benchmark-baseline requires --benchmark')
 
     # If the user wants CTU mode
     if not from_build_command and hasattr(args, 'ctu_phases') \
@@ -359,6 +366,35 @@ def create_analyze_parser(from_build_command):
         parser.add_argument(
             dest='build', nargs=argparse.REMAINDER, help="""Command to run.""")
     else:
+        benchmark = parser.add_argument_group('benchmark options')
+        benchmark.add_argument(
+            '--benchmark',
+            metavar='<file>',
+            help="""Measure the analysis of each translation unit: its wall
+            and processor time, peak memory use, '-analyzer-stats' counters
+            and the number of reports per checker. The measurements are
+            written into this JSON file.""")
+        benchmark.add_argument(
+            '--benchmark-baseline',
+            metavar='<file>',
+            help="""Compare the measurements with the ones in this file,
+            written by an earlier '--benchmark' run (eg.: with another clang
+            build), and report the regressions. The exit status is non zero
+            if there are any.""")
+        benchmark.add_argument(
+            '--benchmark-threshold',
+            metavar='<ratio>',
+            type=float,
+            default=1.5,
+            help="""A measurement regressed when it grew more than this
+            many times.""")
+        benchmark.add_argument(
+            '--schedule',
+            metavar='<file>',
+            help="""Analyze the translation units that took the longest in
+            this file, written by an earlier '--benchmark' run, first. It
+            defaults to the '--benchmark-baseline' file.""")
+
         ctu = parser.add_argument_group('cross translation unit analysis')
         ctu_mutex_group = ctu.add_mutually_exclusive_group()
         ctu_mutex_group.add_argument(
@@ -0,0 +1,216 @@
+# -*- coding: utf-8 -*-
+#                     The LLVM Compiler Infrastructure
+#
+# This file is distributed under the University of Illinois Open Source
+# License. See LICENSE.TXT for details.
+""" This module implements the benchmarking mode of 'analyze-build'.
+
+In this mode every analyzer run is measured: its wall and processor time,
+its peak memory use, the internal statistics of the analyzer and the number
+of reports per checker. The measurements of a whole compilation database are
+written into a JSON file, and can be compared with the file of an earlier
+run, eg.: one made with another clang build, to flag regressions. """
+
+import os
+import re
+import json
+import time
+import logging
+import plistlib
+import subprocess
+
+__all__ = ['run_measured', 'parse_analyzer_stats', 'count_reports',
+           'write_benchmark', 'read_benchmark', 'compare_benchmarks',
+           'longest_first']
+
+# Differences below these are noise, whatever their ratio is.
+MINIMUM_DIFFERENCE = {
+    'cpu_time': 0.5,  # seconds
+    'max_rss': 16 * 1024 * 1024,  # bytes
+    'stats': 1000  # counted events
+}
+
+
+def run_measured(command, cwd=None):
+    """ Run a given command and measure what it costs.
+
+    :param command: array of tokens
+    :param cwd: the working directory where the command will be executed
+    :return: a tuple of the exit code, the output lines of the command and a
+    dictionary of measurements. The exit code follows the convention of
+    subprocess: it is negative when the command was terminated by a signal.
+    """
+    directory = os.path.abspath(cwd) if cwd else os.getcwd()
+    logging.debug('exec measured command %s in %s', command, directory)
+    start = time.time()
+    child = subprocess.Popen(command,
+                             cwd=directory,
+                             stdout=subprocess.PIPE,
+                             stderr=subprocess.STDOUT)
+    output = child.stdout.read()
+    child.stdout.close()
+    # Unlike 'wait', 'wait4' reports the resources used by the child and the
+    # processes it waited for, which includes the cc1 process of the driver.
+    _, status, usage = os.wait4(child.pid, 0)
+    elapsed = time.time() - start
+    if os.WIFSIGNALED(status):
+        child.returncode = -os.WTERMSIG(status)
+    else:
+        child.returncode = os.WEXITSTATUS(status)
+
+    output = output.decode('utf-8') if isinstance(output, bytes) else output
+    # 'ru_maxrss' is in kilobytes, except on Darwin where it is in bytes.
+    max_rss = usage.ru_maxrss
+    if os.uname()[0] != 'Darwin':
+        max_rss *= 1024
+    return child.returncode, output.splitlines(), {
+        'wall_time': elapsed,
+        'cpu_time': usage.ru_utime + usage.ru_stime,
+        'max_rss': max_rss
+    }
+
+
+def parse_analyzer_stats(lines):
+    """ Collect the statistics that '-analyzer-stats' prints.
+
+    Statistics are printed as '<value> <component> - <description>' lines.
+    (They are only collected when clang was built with assertions or with
+    statistics enabled.)
+
+    :param lines: the output lines of the analyzer
+    :return: a dictionary from '<component>: <description>' to value """
+
+    pattern = re.compile(r'^\s*(\d+)\s+(\S+)\s+-\s+(.+?)\s*$')
+    stats = dict()
+    for line in lines:
+        match = pattern.match(line)
+        if match:
+            key = '{0}: {1}'.format(match.group(2), match.group(3))
+            stats[key] = int(match.group(1))
+    return stats
+
+
+def count_reports(filename):
+    """ Count the reports of each checker in a .plist output file.
+
+    :param filename: the .plist file the analyzer wrote
+    :return: a dictionary from checker name to the number of its reports """
+
+    counts = dict()
+    if not filename or not os.path.isfile(filename):
+        return counts
+    try:
+        content = plistlib.readPlist(filename)
+    except Exception:
+        logging.warning('Parsing reports from "%s" failed', filename)
+        return counts
+    for bug in content.get('diagnostics', []):
+        checker = bug.get('check_name', bug.get('type', 'unknown'))
+        counts[checker] = counts.get(checker, 0) + 1
+    return counts
+
+
+def write_benchmark(filename, clang, records):
+    """ Write the measurements of the translation units into a file.
+
+    :param filename: the output JSON file
+    :param clang: the analyzer executable that was measured
+    :param records: the measurements of each translation unit """
+
+    records = sorted(records, key=lambda record: (record['directory'],
+                                                  record['file']))
+    with open(filename, 'w') as handle:
+        json.dump({
+            'clang': clang,
+            'translation_units': records
+        }, handle, sort_keys=True, indent=2)
+    logging.info('Benchmark of %d translation units written to %s',
+                 len(records), filename)
+
+
+def read_benchmark(filename):
+    """ Read back a file that 'write_benchmark' wrote. """
+
+    with open(filename, 'r') as handle:
+        return json.load(handle)
+
+
+def longest_first(entries, benchmark):
+    """ Order the entries of a compilation database by the processor time
+    their analysis took in an earlier benchmark, longest first.
+
+    Starting the longest analyses first keeps all the workers busy until the
+    end, instead of leaving a few giant translation units to run alone.
+    Entries that are not in the benchmark go first, since nothing is known
+    about them. Otherwise the order of the compilation database is kept.
+
+    :param entries: the entries of the compilation database
+    :param benchmark: the benchmark that 'read_benchmark' returned
+    :return: the list of entries in the order to analyze them """
+
+    times = dict(((entry['directory'], entry['file']), entry['cpu_time'])
+                 for entry in benchmark['translation_units'])
+
+    def cost(entry):
+        return times.get((entry['directory'], entry['file']), float('inf'))
+
+    return sorted(entries, key=cost, reverse=True)
+
+
+def compare_benchmarks(baseline, current, threshold):
+    """ Find the translation units that got slower or bigger.
+
+    A measurement regressed when it grew more than 'threshold' times, and by
+    more than its minimum difference. Translation units that are only in one
+    of the benchmarks are ignored, since their costs can't be compared.
+
+    :param baseline: the benchmark to compare with
+    :param current: the benchmark to check
+    :param threshold: the ratio of growth that counts as a regression
+    :return: a list of regressions, each a dictionary with the file and
+    directory of the translation unit, the name of the measurement, and its
+    value in the baseline and the current benchmark. """
+
+    def regressed(before, after, minimum):
+        return after > before * threshold and after - before > minimum
+
+    def regression(entry, metric, before, after):
+        return {
+            'directory': entry['directory'],
+            'file': entry['file'],
+            'metric': metric,
+            'baseline': before,
+            'current': after
+        }
+
+    known = dict(((entry['directory'], entry['file']), entry)
+                 for entry in baseline['translation_units'])
+    result = []
+    total_before, total_after = 0.0, 0.0
+    for entry in current['translation_units']:
+        old = known.get((entry['directory'], entry['file']))
+        if old is None:
+            continue
+        total_before += old['cpu_time']
+        total_after += entry['cpu_time']
+        for metric in ['cpu_time', 'max_rss']:
+            if regressed(old[metric], entry[metric],
+                         MINIMUM_DIFFERENCE[metric]):
+                result.append(
+                    regression(entry, metric, old[metric], entry[metric]))
+        old_stats = old.get('stats', dict())
+        for key, value in sorted(entry.get('stats', dict()).items()):
+            if key in old_stats and regressed(old_stats[key], value,
+                                              MINIMUM_DIFFERENCE['stats']):
+                result.append(regression(entry, key, old_stats[key], value))
+        if entry.get('exit_code', 0) != 0 and old.get('exit_code', 0) == 0:
+            result.append(regression(entry, 'exit_code', 0,
+                                     entry['exit_code']))
+
+    logging.warning('Analysis took %.1fs of processor time, %.1fs in the '
+                    'baseline', total_after, total_before)
+    for entry in result:
+        logging.warning('Regression in %s: %s went from %s to %s',
+                        entry['file'], entry['metric'], entry['baseline'],
+                        entry['current'])
+    return result
@@ -18,21 +18,29 @@ import glob
 import json
 import logging
 import datetime
+import time
 from libscanbuild import duplicate_check
 from libscanbuild.clang import get_version
 
-__all__ = ['document']
+__all__ = ['document', 'create_bug_collector']
 
 
-def document(args):
-    """ Generates cover report and returns the number of bugs/crashes. """
+def document(args, collector=None):
+    """ Generates cover report and returns the number of bugs/crashes.
+
+    The bugs are read from the output directory, unless a collector made by
+    'create_bug_collector' already read them while the analysis was running.
+    """
 
     html_reports_available = args.output_format in {'html', 'plist-html'}
 
     logging.debug('count crashes and bugs')
     crash_count = sum(1 for _ in read_crashes(args.output))
+    if collector is None:
+        collector = create_bug_collector(args.output, html_reports_available)
+    bugs = collector(final=True)
     bug_counter = create_counters()
-    for bug in read_bugs(args.output, html_reports_available):
+    for bug in bugs:
         bug_counter(bug)
     result = crash_count + bug_counter.total
 
@@ -47,7 +55,7 @@ def document(args):
         try:
             if bug_counter.total:
                 fragments.append(bug_summary(args.output, bug_counter))
-                fragments.append(bug_report(args.output, prefix))
+                fragments.append(bug_report(args.output, prefix, bugs))
             if crash_count:
                 fragments.append(crash_report(args.output, prefix))
             assemble_cover(args, prefix, fragments)
@@ -160,11 +168,11 @@ def bug_summary(output_dir, bug_counter):
     return name
 
 
-def bug_report(output_dir, prefix):
+def bug_report(output_dir, prefix, bugs):
     """ Creates a fragment from the analyzer reports. """
 
     pretty = prettify_bug(prefix, output_dir)
-    bugs = (pretty(bug) for bug in read_bugs(output_dir, True))
+    bugs = (pretty(bug) for bug in bugs)
 
     name = os.path.join(output_dir, 'bugs.html.fragment')
     with open(name, 'w') as handle:
@@ -261,22 +269,76 @@ def read_bugs(output_dir, html):
     times with different compiler options. These would be better to show in
     the final report (cover) only once. """
 
-    def empty(file_name):
-        return os.stat(file_name).st_size == 0
+    return iter(create_bug_collector(output_dir, html)(final=True))
+
+
+def create_bug_collector(output_dir, html):
+    """ Create a collector of the bugs in the given output directory.
+
+    The collector can be called any number of times while the analyzer is
+    still writing reports. Each call parses the report files that appeared
+    since the previous one, so the reports are merged as the analysis goes
+    on, instead of in one pass at the end. A report that is not complete yet
+    is left for a later call. The last call is made with 'final=True': it
+    parses every remaining report, and returns the unique sequence of bugs
+    that 'read_bugs' would return.
+
+    The output directory is only listed again when it has changed since the
+    previous listing, and only the new and the incomplete reports are read
+    again. Since most translation units have no reports, a call then costs
+    a single 'stat'. The final call always lists the directory. """
+
+    def complete(file_name):
+        # The analyzer writes the meta data of an html report first, and a
+        # plist report has to be well formed to be parsed at all.
+        if not html:
+            return True
+        with open(file_name) as handle:
+            return any(re.match(r'<!-- BUGMETAEND -->', line)
+                       for line in handle)
+
+    def changed():
+        # A listing is only trusted when it was taken well after the last
+        # change of the directory: files created in the same tick of a coarse
+        # file system clock would not change its time stamp again.
+        mtime = os.stat(output_dir).st_mtime
+        if mtime == collector.mtime and mtime < collector.listed - 2:
+            return False
+        collector.mtime = mtime
+        collector.listed = time.time()
+        return True
+
+    def collector(final=False):
+        if final or changed():
+            pattern = os.path.join(output_dir, '*.html' if html else '*.plist')
+            collector.pending.update(bug_file
+                                     for bug_file in glob.iglob(pattern)
+                                     if bug_file not in collector.seen)
+        for bug_file in sorted(collector.pending):
+            if os.stat(bug_file).st_size == 0:
+                continue
+            try:
+                if not final and not complete(bug_file):
+                    continue
+                bugs = list(parser(bug_file))
+            except Exception:
+                if final:
+                    raise
+                continue
+            collector.pending.discard(bug_file)
+            collector.seen.add(bug_file)
+            collector.bugs.extend(bug for bug in bugs if not duplicate(bug))
+        return collector.bugs
 
     duplicate = duplicate_check(
         lambda bug: '{bug_line}.{bug_path_length}:{bug_file}'.format(**bug))
-
-    # get the right parser for the job.
     parser = parse_bug_html if html else parse_bug_plist
-    # get the input files, which are not empty.
-    pattern = os.path.join(output_dir, '*.html' if html else '*.plist')
-    bug_files = (file for file in glob.iglob(pattern) if not empty(file))
-
-    for bug_file in bug_files:
-        for bug in parser(bug_file):
-            if not duplicate(bug):
-                yield bug
+    collector.seen = set()
+    collector.pending = set()
+    collector.bugs = []
+    collector.mtime = None
+    collector.listed = 0
+    return collector
 
 
 def parse_bug_plist(filename):
@@ -11,6 +11,7 @@ from . import test_report
 from . import test_analyze
 from . import test_intercept
 from . import test_shell
+from . import test_benchmark
 
 
 def load_tests(loader, suite, _):
@@ -21,4 +22,5 @@ def load_tests(loader, suite, _):
     suite.addTests(loader.loadTestsFromModule(test_analyze))
     suite.addTests(loader.loadTestsFromModule(test_intercept))
     suite.addTests(loader.loadTestsFromModule(test_shell))
+    suite.addTests(loader.loadTestsFromModule(test_benchmark))
     return suite
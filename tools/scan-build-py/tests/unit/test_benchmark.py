@@ -0,0 +1,121 @@
+# -*- coding: utf-8 -*-
+#                     The LLVM Compiler Infrastructure
+#
+# This file is distributed under the University of Illinois Open Source
+# License. See LICENSE.TXT for details.
+
+import libear
+import libscanbuild.benchmark as sut
+import unittest
+import os.path
+import sys
+
+
+class ParseAnalyzerStatsTest(unittest.TestCase):
+
+    def test_statistics_are_parsed(self):
+        lines = [
+            'warning: Dereference of null pointer',
+            '===-----------------------------------------------------===',
+            '                 ... Statistics Collected ...',
+            '===-----------------------------------------------------===',
+            '',
+            '   12 AnalysisConsumer - The # of functions analyzed',
+            ' 3456 CoreEngine       - The # of paths explored by the analyzer.',
+        ]
+        self.assertEqual({
+            'AnalysisConsumer: The # of functions analyzed': 12,
+            'CoreEngine: The # of paths explored by the analyzer.': 3456
+        }, sut.parse_analyzer_stats(lines))
+
+    def test_no_statistics(self):
+        self.assertEqual({}, sut.parse_analyzer_stats([]))
+        self.assertEqual({}, sut.parse_analyzer_stats(['1 error generated.']))
+
+
+class RunMeasuredTest(unittest.TestCase):
+
+    def test_exit_code_and_output(self):
+        exit_code, output, cost = sut.run_measured(
+            [sys.executable, '-c', 'print("hello"); exit(3)'])
+        self.assertEqual(3, exit_code)
+        self.assertEqual(['hello'], output)
+        self.assertTrue(cost['wall_time'] >= 0)
+        self.assertTrue(cost['cpu_time'] >= 0)
+        self.assertTrue(cost['max_rss'] > 0)
+
+
+class CompareBenchmarksTest(unittest.TestCase):
+
+    @staticmethod
+    def benchmark(cpu_time, max_rss, paths, exit_code=0):
+        return {'translation_units': [{
+            'directory': '/src',
+            'file': 'a.c',
+            'cpu_time': cpu_time,
+            'max_rss': max_rss,
+            'exit_code': exit_code,
+            'stats': {'CoreEngine: The # of paths explored': paths}
+        }]}
+
+    def compare(self, baseline, current):
+        regressions = sut.compare_benchmarks(baseline, current, 1.5)
+        return sorted(entry['metric'] for entry in regressions)
+
+    def test_no_regression(self):
+        base = self.benchmark(10.0, 100 << 20, 10000)
+        self.assertEqual([], self.compare(base, base))
+        # faster and smaller is fine
+        self.assertEqual([], self.compare(base,
+                                          self.benchmark(5.0, 50 << 20, 10)))
+
+    def test_small_differences_are_noise(self):
+        self.assertEqual([], self.compare(self.benchmark(0.1, 1 << 20, 10),
+                                          self.benchmark(0.5, 8 << 20, 900)))
+
+    def test_regressions(self):
+        self.assertEqual(
+            ['CoreEngine: The # of paths explored', 'cpu_time', 'max_rss'],
+            self.compare(self.benchmark(10.0, 100 << 20, 10000),
+                         self.benchmark(30.0, 300 << 20, 30000)))
+
+    def test_new_failure_is_regression(self):
+        self.assertEqual(
+            ['exit_code'],
+            self.compare(self.benchmark(10.0, 100 << 20, 10000),
+                         self.benchmark(10.0, 100 << 20, 10000, -11)))
+
+    def test_unknown_translation_units_are_ignored(self):
+        base = self.benchmark(10.0, 100 << 20, 10000)
+        current = self.benchmark(30.0, 300 << 20, 30000)
+        current['translation_units'][0]['file'] = 'b.c'
+        self.assertEqual([], self.compare(base, current))
+
+
+class WriteBenchmarkTest(unittest.TestCase):
+
+    def test_write_and_read_back(self):
+        records = [{'directory': '/src', 'file': 'b.c'},
+                   {'directory': '/src', 'file': 'a.c'}]
+        with libear.TemporaryDirectory() as tmpdir:
+            filename = os.path.join(tmpdir, 'benchmark.json')
+            sut.write_benchmark(filename, 'clang', records)
+            content = sut.read_benchmark(filename)
+        self.assertEqual('clang', content['clang'])
+        self.assertEqual(['a.c', 'b.c'],
+                         [entry['file']
+                          for entry in content['translation_units']])
+
+
+class LongestFirstTest(unittest.TestCase):
+
+    def test_order(self):
+        benchmark = {'translation_units': [
+            {'directory': '/src', 'file': 'small.c', 'cpu_time': 1.0},
+            {'directory': '/src', 'file': 'huge.c', 'cpu_time': 100.0},
+            {'directory': '/src', 'file': 'medium.c', 'cpu_time': 10.0}]}
+        entries = [{'directory': '/src', 'file': name}
+                   for name in ['small.c', 'medium.c', 'new.c', 'huge.c']]
+        self.assertEqual(['new.c', 'huge.c', 'medium.c', 'small.c'],
+                         [entry['file'] for entry in
+                          sut.longest_first(entries, benchmark)])
@@ -9,6 +9,7 @@ import libscanbuild.report as sut
 import unittest
 import os
 import os.path
+import time
 
 
 def run_bug_parse(content):
@@ -28,6 +29,56 @@ def run_crash_parse(content, preproc):
         return sut.parse_crash(file_name)
 
 
+class BugCollectorTest(unittest.TestCase):
+
+    @staticmethod
+    def write_report(tmpdir, name, line, complete=True):
+        content = ["<!-- BUGTYPE Division by zero -->\n",
+                   "<!-- BUGFILE xx -->\n",
+                   "<!-- BUGLINE {0} -->\n".format(line)]
+        if complete:
+            content.append("<!-- BUGMETAEND -->\n")
+        with open(os.path.join(tmpdir, name), 'w') as handle:
+            handle.writelines(content)
+
+    def test_reports_are_merged_as_they_appear(self):
+        with libear.TemporaryDirectory() as tmpdir:
+            collector = sut.create_bug_collector(tmpdir, True)
+            self.assertEqual([], collector())
+            self.write_report(tmpdir, 'report-1.html', 1)
+            self.assertEqual([1], [bug['bug_line'] for bug in collector()])
+            # a report which is still being written is left for later
+            self.write_report(tmpdir, 'report-2.html', 2, complete=False)
+            self.assertEqual([1], [bug['bug_line'] for bug in collector()])
+            self.write_report(tmpdir, 'report-2.html', 2)
+            # duplicates are only reported once
+            self.write_report(tmpdir, 'report-3.html', 1)
+            self.assertEqual([1, 2], [bug['bug_line']
+                                      for bug in collector(final=True)])
+
+    def test_final_call_reads_incomplete_reports(self):
+        with libear.TemporaryDirectory() as tmpdir:
+            collector = sut.create_bug_collector(tmpdir, True)
+            self.write_report(tmpdir, 'report-1.html', 1, complete=False)
+            self.assertEqual([], collector())
+            self.assertEqual([1], [bug['bug_line']
+                                   for bug in collector(final=True)])
+
+    def test_unchanged_directory_is_not_listed_again(self):
+        with libear.TemporaryDirectory() as tmpdir:
+            past = time.time() - 10
+            collector = sut.create_bug_collector(tmpdir, True)
+            self.write_report(tmpdir, 'report-1.html', 1)
+            os.utime(tmpdir, (past, past))
+            self.assertEqual([1], [bug['bug_line'] for bug in collector()])
+            # a report which the listing missed is found by the final call
+            self.write_report(tmpdir, 'report-2.html', 2)
+            os.utime(tmpdir, (past, past))
+            self.assertEqual([1], [bug['bug_line'] for bug in collector()])
+            self.assertEqual([1, 2], [bug['bug_line']
+                                      for bug in collector(final=True)])
+
+
 class ParseFileTest(unittest.TestCase):
 
     def test_parse_bug(self):
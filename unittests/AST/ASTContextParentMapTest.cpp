@@ -106,5 +106,43 @@ TEST(GetParents, RespectsTraversalScope) {
   EXPECT_THAT(Ctx.getParents(Foo), ElementsAre(DynTypedNode::create(TU)));
 }
 
+TEST(GetParents, ReturnsParentsWithinNamespaces) {
+  MatchVerifier<Stmt> Verifier;
+  auto InNamespace =
+      namespaceDecl(hasName("n"), hasParent(translationUnitDecl()));
+  EXPECT_TRUE(Verifier.match(
+      "namespace n { extern \"C\" { void f() { int x = 0; } } }",
+      integerLiteral(hasAncestor(functionDecl(
+          hasName("f"), hasParent(linkageSpecDecl(hasParent(InNamespace))))))));
+}
+
+TEST(GetParents, RecomputesInvalidatedParents) {
+  auto AST = tooling::buildASTFromCode(
+      "namespace n { struct foo { int bar; }; struct baz {}; }", "foo.cpp",
+      std::make_shared<PCHContainerOperations>());
+  auto &Ctx = AST->getASTContext();
+  auto &TU = *Ctx.getTranslationUnitDecl();
+  auto &N = *TU.lookup(&Ctx.Idents.get("n")).front();
+  auto &Foo = *cast<DeclContext>(N).lookup(&Ctx.Idents.get("foo")).front();
+  auto &Baz = *cast<DeclContext>(N).lookup(&Ctx.Idents.get("baz")).front();
+  auto &Bar = *cast<DeclContext>(Foo).lookup(&Ctx.Idents.get("bar")).front();
+
+  using ast_type_traits::DynTypedNode;
+  EXPECT_THAT(Ctx.getParents(Bar), ElementsAre(DynTypedNode::create(Foo)));
+  EXPECT_THAT(Ctx.getParents(Foo), ElementsAre(DynTypedNode::create(N)));
+  EXPECT_THAT(Ctx.getParents(N), ElementsAre(DynTypedNode::create(TU)));
+
+  // Forgetting the parents within one declaration leaves the others alone,
+  // and gives the same results once they are computed again.
+  Ctx.invalidateParents(cast<DeclContext>(&Foo));
+  EXPECT_THAT(Ctx.getParents(Baz), ElementsAre(DynTypedNode::create(N)));
+  EXPECT_THAT(Ctx.getParents(Bar), ElementsAre(DynTypedNode::create(Foo)));
+  EXPECT_THAT(Ctx.getParents(Foo), ElementsAre(DynTypedNode::create(N)));
+
+  Ctx.invalidateParents(&TU);
+  EXPECT_THAT(Ctx.getParents(Bar), ElementsAre(DynTypedNode::create(Foo)));
+  EXPECT_THAT(Ctx.getParents(Baz), ElementsAre(DynTypedNode::create(N)));
+}
+
 } // end namespace ast_matchers
 } // end namespace clang
@@ -14,6 +14,7 @@
 #include "MatchVerifier.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/ASTImporter.h"
+#include "clang/AST/ASTImporterLookupTable.h"
 #include "clang/ASTMatchers/ASTMatchFinder.h"
 #include "clang/ASTMatchers/ASTMatchers.h"
 #include "clang/Tooling/Tooling.h"
@@ -299,6 +300,9 @@ class ASTImporterTestBase : public ParameterizedTestsFixture {
     std::unique_ptr<ASTUnit> Unit;
     TranslationUnitDecl *TUDecl = nullptr;
     std::unique_ptr<ASTImporter> Importer;
+    // Options of the importer, set before it is created.
+    ASTImporterLookupTable *LookupTable = nullptr;
+    bool OnlyNeededMembers = false;
     TU(StringRef Code, StringRef FileName, ArgVector Args)
         : Code(Code), FileName(FileName),
           Unit(tooling::buildASTFromCodeWithArgs(this->Code, Args,
@@ -312,7 +316,9 @@ class ASTImporterTestBase : public ParameterizedTestsFixture {
       if (!Importer) {
         Importer.reset(new ASTImporter(
             ToAST->getASTContext(), ToAST->getFileManager(),
-            Unit->getASTContext(), Unit->getFileManager(), false));
+            Unit->getASTContext(), Unit->getFileManager(), false,
+            LookupTable));
+        Importer->setImportOnlyNeededMembers(OnlyNeededMembers);
       }
       assert(&ToAST->getASTContext() == &Importer->getToContext());
       createVirtualFileIfNeeded(ToAST, FileName, Code);
@@ -358,6 +364,13 @@ class ASTImporterTestBase : public ParameterizedTestsFixture {
     return &*It;
   }
 
+protected:
+  // If set, the importers of all From contexts share a lookup table of the To
+  // context.
+  bool UseLookupTable = false;
+  std::unique_ptr<ASTImporterLookupTable> LookupTable;
+  bool ImportOnlyNeededMembers = false;
+
 public:
   // We may have several From context but only one To context.
   std::unique_ptr<ASTUnit> ToAST;
@@ -432,7 +445,12 @@ public:
   // The different instances of the param From may have different ASTContext.
   Decl *Import(Decl *From, Language ToLang) {
     lazyInitToAST(ToLang);
+    if (UseLookupTable && !LookupTable)
+      LookupTable = llvm::make_unique<ASTImporterLookupTable>(
+          *ToAST->getASTContext().getTranslationUnitDecl());
     TU *FromTU = findFromTU(From);
+    FromTU->LookupTable = LookupTable.get();
+    FromTU->OnlyNeededMembers = ImportOnlyNeededMembers;
     return FromTU->import(ToAST.get(), From);
   }
 
@@ -2158,6 +2176,79 @@ TEST_P(ImportFunctions,
             }).match(ToTU, functionDecl()));
 }
 
+struct ImportWithLookupTable : ASTImporterTestBase {
+  ImportWithLookupTable() { UseLookupTable = true; }
+};
+
+TEST_P(ImportWithLookupTable, DefinitionIsMergedWithExistingPrototype) {
+  auto Pattern = functionDecl(hasName("f"));
+  Decl *ToTU = getToTuDecl("namespace N { void f(); }", Lang_CXX);
+  Decl *FromTU = getTuDecl("namespace N { void f() {} }", Lang_CXX);
+  auto *FromD = FirstDeclMatcher<FunctionDecl>().match(FromTU, Pattern);
+  auto *ToProto = FirstDeclMatcher<FunctionDecl>().match(ToTU, Pattern);
+
+  auto *ToD = cast<FunctionDecl>(Import(FromD, Lang_CXX));
+  EXPECT_EQ(ToD->getPreviousDecl(), ToProto);
+  EXPECT_EQ(DeclCounter<NamespaceDecl>().match(ToTU, namespaceDecl()), 1u);
+}
+
+TEST_P(ImportWithLookupTable, ImportedDeclsAreFoundByLaterImports) {
+  auto Pattern = cxxRecordDecl(hasName("X"), isDefinition());
+  Decl *FromTU0 = getTuDecl("struct X { int a; };", Lang_CXX, "input0.cc");
+  Decl *FromTU1 = getTuDecl("struct X { int a; };", Lang_CXX, "input1.cc");
+  auto *FromX0 = FirstDeclMatcher<CXXRecordDecl>().match(FromTU0, Pattern);
+  auto *FromX1 = FirstDeclMatcher<CXXRecordDecl>().match(FromTU1, Pattern);
+
+  Decl *ToX0 = Import(FromX0, Lang_CXX);
+  Decl *ToX1 = Import(FromX1, Lang_CXX);
+  EXPECT_EQ(ToX0, ToX1);
+}
+
+TEST_P(ImportWithLookupTable, DeclsInTransparentContextsAreFound) {
+  auto Pattern = enumConstantDecl(hasName("A"));
+  Decl *ToTU = getToTuDecl("extern \"C\" { enum E { A }; }", Lang_CXX);
+  Decl *FromTU = getTuDecl("extern \"C\" { enum E { A }; }", Lang_CXX);
+  auto *FromA = FirstDeclMatcher<EnumConstantDecl>().match(FromTU, Pattern);
+
+  Import(FromA, Lang_CXX);
+  EXPECT_EQ(DeclCounter<EnumDecl>().match(ToTU, enumDecl()), 1u);
+}
+
+struct ImportNeededMembersOnly : ASTImporterTestBase {
+  ImportNeededMembersOnly() { ImportOnlyNeededMembers = true; }
+};
+
+TEST_P(ImportNeededMembersOnly, UnusedMethodsAreLeftOut) {
+  Decl *FromTU = getTuDecl(
+      R"(
+      struct X {
+        X();
+        ~X();
+        virtual void v();
+        void unused();
+        void used();
+        int a;
+      };
+      void f() { X().used(); }
+      )",
+      Lang_CXX);
+  auto *FromF = FirstDeclMatcher<FunctionDecl>().match(
+      FromTU, functionDecl(hasName("f")));
+
+  Import(FromF, Lang_CXX);
+  Decl *ToTU = ToAST->getASTContext().getTranslationUnitDecl();
+  auto MemberOfX = [](StringRef Name) {
+    return namedDecl(hasName(Name), hasParent(cxxRecordDecl(hasName("X"))));
+  };
+  EXPECT_EQ(DeclCounter<CXXMethodDecl>().match(ToTU, MemberOfX("unused")),
+            0u);
+  EXPECT_EQ(DeclCounter<CXXMethodDecl>().match(ToTU, MemberOfX("used")), 1u);
+  EXPECT_EQ(DeclCounter<CXXMethodDecl>().match(ToTU, MemberOfX("v")), 1u);
+  EXPECT_EQ(DeclCounter<CXXDestructorDecl>().match(ToTU, MemberOfX("~X")),
+            1u);
+  EXPECT_EQ(DeclCounter<FieldDecl>().match(ToTU, MemberOfX("a")), 1u);
+}
+
 struct ImportFriendFunctions : ImportFunctions {};
 
 TEST_P(ImportFriendFunctions, ImportFriendFunctionRedeclChainProto) {
@@ -3750,6 +3841,12 @@ INSTANTIATE_TEST_CASE_P(ParameterizedTests, ImportDecl,
 INSTANTIATE_TEST_CASE_P(ParameterizedTests, ASTImporterTestBase,
                         DefaultTestValuesForRunOptions, );
 
+INSTANTIATE_TEST_CASE_P(ParameterizedTests, ImportWithLookupTable,
+                        DefaultTestValuesForRunOptions, );
+
+INSTANTIATE_TEST_CASE_P(ParameterizedTests, ImportNeededMembersOnly,
+                        DefaultTestValuesForRunOptions, );
+
 INSTANTIATE_TEST_CASE_P(ParameterizedTests, ImportFunctions,
                         DefaultTestValuesForRunOptions, );
 
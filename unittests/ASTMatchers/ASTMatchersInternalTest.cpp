@@ -52,6 +52,91 @@ TEST(ConstructVariadic, MismatchedTypes_Regression) {
                   .convertTo<QualType>()));
 }
 
+TEST(ConstructVariadic, CanMatchNodesOfKindLooksAtInnerMatchers) {
+  using ast_type_traits::ASTNodeKind;
+  ASTNodeKind If = ASTNodeKind::getFromNodeKind<IfStmt>();
+  ASTNodeKind For = ASTNodeKind::getFromNodeKind<ForStmt>();
+  ASTNodeKind While = ASTNodeKind::getFromNodeKind<WhileStmt>();
+
+  internal::DynTypedMatcher AnyOf = stmt(anyOf(ifStmt(), forStmt()));
+  EXPECT_TRUE(AnyOf.canMatchNodesOfKind(If));
+  EXPECT_TRUE(AnyOf.canMatchNodesOfKind(For));
+  EXPECT_FALSE(AnyOf.canMatchNodesOfKind(While));
+
+  internal::DynTypedMatcher Bound =
+      stmt(eachOf(ifStmt(), forStmt())).bind("loop");
+  EXPECT_TRUE(Bound.canMatchNodesOfKind(For));
+  EXPECT_FALSE(Bound.canMatchNodesOfKind(While));
+
+  internal::DynTypedMatcher Unless = stmt(unless(ifStmt()));
+  EXPECT_TRUE(Unless.canMatchNodesOfKind(While));
+
+  EXPECT_TRUE(matches("void f() { while (true) {} for (;;) {} }",
+                      stmt(anyOf(ifStmt(), forStmt()))));
+  EXPECT_TRUE(notMatches("void f() { while (true) {} }",
+                         stmt(anyOf(ifStmt(), forStmt()))));
+}
+
+static unsigned NumExpensiveMatches;
+AST_MATCHER(Decl, countsMatches) {
+  ++NumExpensiveMatches;
+  return true;
+}
+
+TEST(DynTypedMatcherCompile, MatchesCheapInnerMatchersFirst) {
+  internal::DynTypedMatcher Compiled =
+      internal::DynTypedMatcher(namedDecl(countsMatches(), hasName("y")))
+          .compile();
+  NumExpensiveMatches = 0;
+  EXPECT_TRUE(notMatches("int x;", Compiled.unconditionalConvertTo<Decl>()));
+  EXPECT_EQ(0u, NumExpensiveMatches);
+  EXPECT_TRUE(matches("int y;", Compiled.unconditionalConvertTo<Decl>()));
+  EXPECT_NE(0u, NumExpensiveMatches);
+
+  internal::DynTypedMatcher Bound =
+      internal::DynTypedMatcher(
+          namedDecl(countsMatches(), hasName("y")).bind("y"))
+          .compile();
+  NumExpensiveMatches = 0;
+  EXPECT_TRUE(notMatches("int x;", Bound.unconditionalConvertTo<Decl>()));
+  EXPECT_EQ(0u, NumExpensiveMatches);
+  EXPECT_TRUE(matchAndVerifyResultTrue(
+      "int y;", Bound.unconditionalConvertTo<Decl>(),
+      llvm::make_unique<VerifyIdIsBoundTo<VarDecl>>("y")));
+}
+
+TEST(DynTypedMatcherCompile, FoldsNestedOperators) {
+  internal::DynTypedMatcher AllOf =
+      internal::DynTypedMatcher(
+          namedDecl(allOf(decl(), allOf(hasName("y"), hasName("::y")))))
+          .compile();
+  EXPECT_TRUE(AllOf.isCheapToMatch());
+  EXPECT_TRUE(matches("int y;", AllOf.unconditionalConvertTo<Decl>()));
+  EXPECT_TRUE(notMatches("int x;", AllOf.unconditionalConvertTo<Decl>()));
+
+  internal::DynTypedMatcher AnyOf =
+      internal::DynTypedMatcher(
+          namedDecl(anyOf(hasName("x"), anyOf(hasName("y"), hasName("z")))))
+          .compile();
+  EXPECT_TRUE(AnyOf.isCheapToMatch());
+  EXPECT_TRUE(matches("int z;", AnyOf.unconditionalConvertTo<Decl>()));
+  EXPECT_TRUE(notMatches("int w;", AnyOf.unconditionalConvertTo<Decl>()));
+
+  // The kind check of a nested anyOf() is narrower, and has to stay.
+  internal::DynTypedMatcher Narrower =
+      internal::DynTypedMatcher(
+          decl(anyOf(recordDecl(), varDecl(anyOf(hasName("x"), hasName("y"))))))
+          .compile();
+  EXPECT_TRUE(matches("int y;", Narrower.unconditionalConvertTo<Decl>()));
+  EXPECT_TRUE(notMatches("void y();", Narrower.unconditionalConvertTo<Decl>()));
+
+  // Matchers that recurse into the AST are not cheap.
+  EXPECT_FALSE(
+      internal::DynTypedMatcher(varDecl(hasName("y"), has(expr())))
+          .compile()
+          .isCheapToMatch());
+}
+
 // For testing AST_MATCHER_P().
 AST_MATCHER_P(Decl, just, internal::Matcher<Decl>, AMatcher) {
   // Make sure all special variables are used: node, match_finder,
@@ -119,6 +204,56 @@ TEST(MatchFinder, CheckProfiling) {
   EXPECT_EQ("MyID", Records.begin()->getKey());
 }
 
+class RecordMatchedNames : public MatchFinder::MatchCallback {
+public:
+  void run(const MatchFinder::MatchResult &Result) override {
+    if (const auto *D = Result.Nodes.getNodeAs<NamedDecl>("name"))
+      Names.push_back(D->getNameAsString());
+    if (const auto *E = Result.Nodes.getNodeAs<DeclRefExpr>("ref"))
+      Names.push_back("ref " + E->getDecl()->getNameAsString());
+  }
+  std::vector<std::string> Names;
+};
+
+TEST(MatchFinder, MatchesInParallelInOrder) {
+  std::unique_ptr<ASTUnit> AST(tooling::buildASTFromCode(
+      "struct Base {}; typedef Base Alias;"
+      "namespace n { struct A : Alias {}; int f() { return 0; } }"
+      "struct B : Base {}; int g() { return n::f(); }"
+      "template <typename T> struct C : T {}; C<Base> c;"));
+  ASSERT_TRUE(AST.get());
+
+  auto Matchers = [](MatchFinder &Finder, RecordMatchedNames &Callback) {
+    Finder.addMatcher(
+        cxxRecordDecl(isDerivedFrom("Alias"), isDefinition()).bind("name"),
+        &Callback);
+    Finder.addMatcher(functionDecl(isDefinition()).bind("name"), &Callback);
+    Finder.addMatcher(declRefExpr(hasAncestor(functionDecl(hasName("g"))))
+                          .bind("ref"),
+                      &Callback);
+  };
+
+  MatchFinder SingleThreaded;
+  RecordMatchedNames Expected;
+  Matchers(SingleThreaded, Expected);
+  SingleThreaded.matchAST(AST->getASTContext());
+
+  MatchFinder::MatchFinderOptions Options;
+  Options.NumThreads = 4;
+  MatchFinder Parallel(std::move(Options));
+  RecordMatchedNames Actual;
+  Matchers(Parallel, Actual);
+  Parallel.matchAST(AST->getASTContext());
+
+  // A is only derived from Alias through a typedef in another top-level
+  // declaration.
+  EXPECT_NE(Expected.Names.end(),
+            std::find(Expected.Names.begin(), Expected.Names.end(), "A"));
+  EXPECT_NE(Expected.Names.end(),
+            std::find(Expected.Names.begin(), Expected.Names.end(), "ref f"));
+  EXPECT_EQ(Expected.Names, Actual.Names);
+}
+
 class VerifyStartOfTranslationUnit : public MatchFinder::MatchCallback {
 public:
   VerifyStartOfTranslationUnit() : Called(false) {}
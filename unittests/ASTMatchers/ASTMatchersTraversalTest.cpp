@@ -1681,6 +1681,18 @@ TEST(ForEachDescendant, BindsCombinations) {
     llvm::make_unique<VerifyIdIsBoundTo<IfStmt>>("if", 6)));
 }
 
+TEST(ForEachDescendant, BindsFirstMatchOfNestedHasDescendant) {
+  EXPECT_TRUE(matchAndVerifyResultTrue(
+    "void f() { { { int a; } int b; } { int c; } }",
+    functionDecl(forEachDescendant(
+      compoundStmt(hasDescendant(varDecl().bind("v"))))),
+    llvm::make_unique<VerifyIdIsBoundTo<VarDecl>>("v", "c", 4)));
+  EXPECT_TRUE(matchAndVerifyResultTrue(
+    "void f() { if (true) { { int a; } int b; } }",
+    functionDecl(hasDescendant(ifStmt(hasDescendant(varDecl().bind("v"))))),
+    llvm::make_unique<VerifyIdIsBoundTo<VarDecl>>("v", "a")));
+}
+
 TEST(Has, DoesNotDeleteBindings) {
   EXPECT_TRUE(matchAndVerifyResultTrue(
     "class X { int a; };", recordDecl(decl().bind("x"), has(fieldDecl())),
@@ -28,6 +28,7 @@ enum BuildResult {
 class CFGCallback : public ast_matchers::MatchFinder::MatchCallback {
 public:
   BuildResult TheBuildResult = ToolRan;
+  bool MayHavePrunedEdges = false;
 
   void run(const ast_matchers::MatchFinder::MatchResult &Result) override {
     const auto *Func = Result.Nodes.getNodeAs<FunctionDecl>("func");
@@ -37,12 +38,15 @@ public:
     TheBuildResult = SawFunctionBody;
     CFG::BuildOptions Options;
     Options.AddImplicitDtors = true;
-    if (CFG::buildCFG(nullptr, Body, Result.Context, Options))
-        TheBuildResult = BuiltCFG;
+    if (std::unique_ptr<CFG> Cfg =
+            CFG::buildCFG(nullptr, Body, Result.Context, Options)) {
+      TheBuildResult = BuiltCFG;
+      MayHavePrunedEdges = Cfg->mayHavePrunedEdges();
+    }
   }
 };
 
-BuildResult BuildCFG(const char *Code) {
+BuildResult BuildCFG(const char *Code, bool *MayHavePrunedEdges = nullptr) {
   CFGCallback Callback;
 
   ast_matchers::MatchFinder Finder;
@@ -52,6 +56,8 @@ BuildResult BuildCFG(const char *Code) {
   std::vector<std::string> Args = {"-std=c++11", "-fno-delayed-template-parsing"};
   if (!tooling::runToolOnCodeWithArgs(Factory->create(), Code, Args))
     return ToolFailed;
+  if (MayHavePrunedEdges)
+    *MayHavePrunedEdges = Callback.MayHavePrunedEdges;
   return Callback.TheBuildResult;
 }
 
@@ -87,6 +93,30 @@ TEST(CFG, VariableOfIncompleteType) {
   EXPECT_EQ(BuiltCFG, BuildCFG(Code));
 }
 
+// A CFG notes whether a condition was folded while it was built, so that it
+// can stand in for the unpruned CFG when none was.
+TEST(CFG, NotesPrunedEdges) {
+  bool MayHavePrunedEdges = true;
+  EXPECT_EQ(BuiltCFG, BuildCFG("void f(int x) {\n"
+                               "  if (x) {}\n"
+                               "  while (x--) {}\n"
+                               "}\n",
+                               &MayHavePrunedEdges));
+  EXPECT_FALSE(MayHavePrunedEdges);
+
+  EXPECT_EQ(BuiltCFG, BuildCFG("void f(int x) {\n"
+                               "  if (0) { x++; }\n"
+                               "}\n",
+                               &MayHavePrunedEdges));
+  EXPECT_TRUE(MayHavePrunedEdges);
+
+  EXPECT_EQ(BuiltCFG, BuildCFG("void f(int x) {\n"
+                               "  switch (2) { case 1: x++; }\n"
+                               "}\n",
+                               &MayHavePrunedEdges));
+  EXPECT_TRUE(MayHavePrunedEdges);
+}
+
 } // namespace
 } // namespace analysis
 } // namespace clang
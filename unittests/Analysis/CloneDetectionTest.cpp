@@ -107,6 +107,71 @@ TEST(CloneDetector, FilterFunctionsByName) {
   // We should have found the two functions bar1 and bar2.
   ASSERT_EQ(FoundFunctionsWithBarPrefix, 2);
 }
+
+TEST(CloneDetector, GroupSimilarFunctionsByMinHash) {
+  auto ASTUnit = clang::tooling::buildASTFromCode(
+      "int foo1(int *a, int n) {\n"
+      "  int s = 0;\n"
+      "  for (int i = 0; i < n; ++i) { if (a[i] > 0) s += a[i]; }\n"
+      "  return s;\n"
+      "}\n"
+      "int foo2(int *b, int m) {\n"
+      "  int t = 0;\n"
+      "  for (int j = 0; j < m; ++j) { if (b[j] > 0) t += b[j]; }\n"
+      "  t *= 2;\n"
+      "  return t;\n"
+      "}\n"
+      "void bar(const char *p) { while (*p) p++; }\n");
+  auto TU = ASTUnit->getASTContext().getTranslationUnitDecl();
+
+  CloneDetector Detector;
+  CloneDetectionVisitor Visitor(Detector);
+  Visitor.TraverseTranslationUnitDecl(TU);
+
+  // foo2 is not a type II clone of foo1, but most of their subtrees are.
+  std::vector<CloneDetector::CloneGroup> CloneGroups;
+  Detector.findClones(CloneGroups, MinHashCloneConstraint(0.5, 64, 2));
+  ASSERT_EQ(CloneGroups.size(), 1u);
+  ASSERT_EQ(CloneGroups.front().size(), 2u);
+  for (auto &Clone : CloneGroups.front()) {
+    const auto ND = dyn_cast<const FunctionDecl>(Clone.getContainingDecl());
+    ASSERT_TRUE(ND != nullptr);
+    EXPECT_EQ(ND->getNameAsString().find("foo"), 0u);
+  }
+}
+
+TEST(CloneDetector, FingerprintRoundTrip) {
+  auto ASTUnit = clang::tooling::buildASTFromCode("void foo(int &a) {\n"
+                                                  "  a++;\n"
+                                                  "}\n",
+                                                  "input file.cc");
+  const FunctionDecl *Foo = nullptr;
+  auto TU = ASTUnit->getASTContext().getTranslationUnitDecl();
+  for (const Decl *D : TU->decls())
+    if (const auto *FD = dyn_cast<FunctionDecl>(D))
+      Foo = FD;
+  ASSERT_TRUE(Foo != nullptr);
+
+  CloneFingerprint Written(StmtSequence(Foo->getBody(), Foo), 16);
+  EXPECT_EQ(Written.Filename, "input file.cc");
+  EXPECT_EQ(Written.BeginLine, 1u);
+  EXPECT_EQ(Written.EndLine, 3u);
+
+  std::string Line;
+  llvm::raw_string_ostream OS(Line);
+  Written.print(OS);
+  OS.flush();
+
+  CloneFingerprint Read;
+  ASSERT_TRUE(CloneFingerprint::parse(Line, Read));
+  EXPECT_EQ(Read.Filename, Written.Filename);
+  EXPECT_EQ(Read.BeginLine, Written.BeginLine);
+  EXPECT_EQ(Read.EndLine, Written.EndLine);
+  EXPECT_EQ(Read.Signature, Written.Signature);
+  EXPECT_EQ(Read.estimateSimilarity(Written), 1.0);
+
+  EXPECT_FALSE(CloneFingerprint::parse("2 1 2 3", Read));
+}
 } // namespace
 } // namespace analysis
 } // namespace clang
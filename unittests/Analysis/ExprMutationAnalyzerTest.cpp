@@ -1106,4 +1106,29 @@ TEST(ExprMutationAnalyzerTest, UniquePtr) {
   EXPECT_THAT(mutatedBy(Results, AST.get()), ElementsAre("x->mf()"));
 }
 
+TEST(ExprMutationAnalyzerTest, ManyQueriesOnOneAnalyzer) {
+  const auto AST = buildASTFromCode(
+      "void g(int&); struct S { int m; void mf(); };"
+      "void f() { int a = 0; int b = 0; int c[2]; S s; S t;"
+      "  int &r = a; r = 1; g(c[0]); t.mf(); (void)(b + s.m); }");
+  ASTContext &Context = AST->getASTContext();
+  const auto *Body =
+      selectFirst<Stmt>("stmt", match(functionDecl(hasName("f"),
+                                                   hasBody(stmt().bind("stmt"))),
+                                      Context));
+  const auto decl = [&](StringRef Name) {
+    return selectFirst<Decl>(
+        "decl", match(varDecl(hasName(Name)).bind("decl"), Context));
+  };
+  // Every query after the first is answered from the sites that the first
+  // one indexed.
+  ExprMutationAnalyzer Analyzer(*Body, Context);
+  EXPECT_TRUE(Analyzer.isMutated(decl("a")));
+  EXPECT_FALSE(Analyzer.isMutated(decl("b")));
+  EXPECT_TRUE(Analyzer.isMutated(decl("c")));
+  EXPECT_FALSE(Analyzer.isMutated(decl("s")));
+  EXPECT_TRUE(Analyzer.isMutated(decl("t")));
+  EXPECT_TRUE(Analyzer.isMutated(decl("a")));
+}
+
 } // namespace clang
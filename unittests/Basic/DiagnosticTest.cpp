@@ -73,6 +73,24 @@ TEST(DiagnosticTest, suppressAfterFatalError) {
   }
 }
 
+// Check that isIgnoredEverywhere follows the mapping and -w.
+TEST(DiagnosticTest, ignoredEverywhere) {
+  DiagnosticsEngine Diags(new DiagnosticIDs(), new DiagnosticOptions,
+                          new IgnoringDiagConsumer());
+  EXPECT_FALSE(Diags.isIgnoredEverywhere(diag::warn_mt_message));
+
+  Diags.setSeverity(diag::warn_mt_message, diag::Severity::Ignored,
+                    SourceLocation());
+  EXPECT_TRUE(Diags.isIgnoredEverywhere(diag::warn_mt_message));
+
+  Diags.setSeverity(diag::warn_mt_message, diag::Severity::Warning,
+                    SourceLocation());
+  EXPECT_FALSE(Diags.isIgnoredEverywhere(diag::warn_mt_message));
+
+  Diags.setIgnoreAllWarnings(true);
+  EXPECT_TRUE(Diags.isIgnoredEverywhere(diag::warn_mt_message));
+}
+
 TEST(DiagnosticTest, diagnosticError) {
   DiagnosticsEngine Diags(new DiagnosticIDs(), new DiagnosticOptions,
                           new IgnoringDiagConsumer());
@@ -13,6 +13,7 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/VirtualFileSystem.h"
+#include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
 
 using namespace llvm;
@@ -353,4 +354,79 @@ TEST_F(FileManagerTest, makeAbsoluteUsesVFS) {
   EXPECT_EQ(Path, ExpectedResult);
 }
 
+TEST(BuildSessionStatCacheTest, PersistsAcrossProcesses) {
+  SmallString<128> Dir, CacheDir;
+  ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("stat-cache", Dir));
+  // Keep the cache file out of the directory being looked at, since writing
+  // it changes the directory's modification time.
+  ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("stat-cache", CacheDir));
+  SmallString<128> Header(Dir), Missing(Dir), CacheFile(CacheDir), Late(Dir);
+  llvm::sys::path::append(Header, "header.h");
+  llvm::sys::path::append(Missing, "missing.h");
+  llvm::sys::path::append(CacheFile, "stat.cache");
+  llvm::sys::path::append(Late, "sub", "deeper", "late.h");
+  {
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(Header, EC, llvm::sys::fs::F_None);
+    ASSERT_FALSE(EC);
+    OS << "int x;\n";
+  }
+
+  // Each "process" gets a fresh FileManager and loads the cache file anew.
+  unsigned Hits, Misses;
+  bool HeaderFound, MissingFound, LateFound;
+  auto Lookup = [&](uint64_t Session) {
+    FileSystemOptions Opts;
+    FileManager Manager(Opts);
+    auto Cache = BuildSessionStatCache::create(CacheFile, Session);
+    BuildSessionStatCache *CachePtr = Cache.get();
+    Manager.addStatCache(std::move(Cache));
+    HeaderFound = Manager.getFile(Header) != nullptr;
+    MissingFound = Manager.getFile(Missing) != nullptr;
+    LateFound = Manager.getFile(Late) != nullptr;
+    Hits = CachePtr->getNumHits();
+    Misses = CachePtr->getNumMisses();
+    EXPECT_FALSE(CachePtr->writeToDisk());
+  };
+
+  // The directory, header.h, missing.h and sub/deeper are looked up.
+  Lookup(42);
+  EXPECT_EQ(0u, Hits);
+  EXPECT_EQ(4u, Misses);
+  EXPECT_TRUE(HeaderFound);
+  EXPECT_FALSE(MissingFound);
+  EXPECT_FALSE(LateFound);
+
+  // Same session: both the positive and the negative lookups are cached.
+  Lookup(42);
+  EXPECT_EQ(4u, Hits);
+  EXPECT_EQ(0u, Misses);
+  EXPECT_TRUE(HeaderFound);
+  EXPECT_FALSE(MissingFound);
+  EXPECT_FALSE(LateFound);
+
+  // Creating the missing parent directory invalidates the negative entry.
+  SmallString<128> LateDir = llvm::sys::path::parent_path(Late);
+  ASSERT_FALSE(llvm::sys::fs::create_directories(LateDir));
+  {
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(Late, EC, llvm::sys::fs::F_None);
+    ASSERT_FALSE(EC);
+  }
+  Lookup(42);
+  EXPECT_TRUE(HeaderFound);
+  EXPECT_FALSE(MissingFound);
+  EXPECT_TRUE(LateFound);
+  EXPECT_LE(2u, Misses);
+
+  // A cache file from another build session is ignored.
+  Lookup(43);
+  EXPECT_EQ(0u, Hits);
+  EXPECT_TRUE(HeaderFound);
+  EXPECT_TRUE(LateFound);
+
+  llvm::sys::fs::remove_directories(Dir);
+  llvm::sys::fs::remove_directories(CacheDir);
+}
+
 } // anonymous namespace
@@ -155,6 +155,35 @@ TEST_F(SourceManagerTest, getColumnNumber) {
   EXPECT_EQ(1U, SourceMgr.getColumnNumber(MainFileID, 0, nullptr));
 }
 
+TEST_F(SourceManagerTest, getLineNumberMixedLineEndings) {
+  // Long lines and every kind of line ending, so that terminators (and the
+  // two halves of "\r\n") land on both sides of block boundaries.
+  std::string Source;
+  std::vector<unsigned> LineStarts = {0};
+  const char *const Endings[] = {"\n", "\r\n", "\r", "\n\r"};
+  for (unsigned I = 0; I != 40; ++I) {
+    Source.append(I % 37 + 1, 'x');
+    Source += Endings[I % 4];
+    LineStarts.push_back(Source.size());
+  }
+  Source += "int x;";
+
+  FileID MainFileID =
+      SourceMgr.createFileID(llvm::MemoryBuffer::getMemBuffer(Source));
+  SourceMgr.setMainFileID(MainFileID);
+
+  for (unsigned Line = 0; Line != LineStarts.size(); ++Line) {
+    bool Invalid = false;
+    EXPECT_EQ(Line + 1, SourceMgr.getLineNumber(MainFileID, LineStarts[Line],
+                                                &Invalid));
+    EXPECT_FALSE(Invalid);
+    EXPECT_EQ(1U, SourceMgr.getColumnNumber(MainFileID, LineStarts[Line]));
+  }
+  EXPECT_EQ(LineStarts.size(),
+            SourceMgr.getLineNumber(MainFileID, Source.size()));
+  EXPECT_EQ(7U, SourceMgr.getColumnNumber(MainFileID, Source.size()));
+}
+
 TEST_F(SourceManagerTest, locationPrintTest) {
   const char *header = "#define IDENTITY(x) x\n";
 
@@ -98,6 +98,93 @@ private:
   bool *Success;
 };
 
+/// Saves the AST of \p SourceText into a temporary file, which is listed in
+/// \p Index as the file defining \p LookupName.
+void emitASTFile(StringRef SourceText, StringRef LookupName, raw_ostream &Index,
+                 std::vector<std::unique_ptr<llvm::ToolOutputFile>> &Files) {
+  int SourceFD;
+  llvm::SmallString<256> SourceFileName;
+  ASSERT_FALSE(llvm::sys::fs::createTemporaryFile("input", "cpp", SourceFD,
+                                                  SourceFileName));
+  Files.push_back(
+      llvm::make_unique<llvm::ToolOutputFile>(SourceFileName, SourceFD));
+  Files.back()->os() << SourceText;
+  Files.back()->os().flush();
+
+  int ASTFD;
+  llvm::SmallString<256> ASTFileName;
+  ASSERT_FALSE(
+      llvm::sys::fs::createTemporaryFile("ast", "ast", ASTFD, ASTFileName));
+  Files.push_back(llvm::make_unique<llvm::ToolOutputFile>(ASTFileName, ASTFD));
+  tooling::buildASTFromCode(SourceText, SourceFileName)->Save(ASTFileName);
+  Index << LookupName << " " << ASTFileName << "\n";
+}
+
+class CTUUnloadASTConsumer : public clang::ASTConsumer {
+public:
+  explicit CTUUnloadASTConsumer(clang::CompilerInstance &CI, bool *Success)
+      : CTU(CI), Success(Success) {}
+
+  void HandleTranslationUnit(ASTContext &Ctx) {
+    const FunctionDecl *F = nullptr, *G = nullptr;
+    for (const Decl *D : Ctx.getTranslationUnitDecl()->decls()) {
+      if (const auto *FD = dyn_cast<FunctionDecl>(D)) {
+        if (FD->getName() == "f")
+          F = FD;
+        else if (FD->getName() == "g")
+          G = FD;
+      }
+    }
+    assert(F && G);
+
+    std::vector<std::unique_ptr<llvm::ToolOutputFile>> Files;
+    int IndexFD;
+    llvm::SmallString<256> IndexFileName;
+    ASSERT_FALSE(llvm::sys::fs::createTemporaryFile("index", "txt", IndexFD,
+                                                    IndexFileName));
+    llvm::ToolOutputFile IndexFile(IndexFileName, IndexFD);
+    emitASTFile("int f(int) { return 0; }\n", "c:@F@f#I#", IndexFile.os(),
+                Files);
+    emitASTFile("int g(int) { return 1; }\n", "c:@F@g#I#", IndexFile.os(),
+                Files);
+    IndexFile.os().flush();
+
+    // Every AST file exceeds the limit, so loading the one defining g unloads
+    // the one defining f.
+    CTU.setMaxLoadedASTSize(1);
+    llvm::Expected<const FunctionDecl *> NewF =
+        CTU.getCrossTUDefinition(F, "", IndexFileName);
+    ASSERT_TRUE((bool)NewF);
+    llvm::Expected<const FunctionDecl *> NewG =
+        CTU.getCrossTUDefinition(G, "", IndexFileName);
+    ASSERT_TRUE((bool)NewG);
+    llvm::Expected<const FunctionDecl *> NewFAgain =
+        CTU.getCrossTUDefinition(F, "", IndexFileName);
+    ASSERT_TRUE((bool)NewFAgain);
+
+    *Success = *NewF && (*NewF)->hasBody() && *NewG && (*NewG)->hasBody() &&
+               *NewFAgain == *NewF;
+  }
+
+private:
+  CrossTranslationUnitContext CTU;
+  bool *Success;
+};
+
+class CTUUnloadASTAction : public clang::ASTFrontendAction {
+public:
+  CTUUnloadASTAction(bool *Success) : Success(Success) {}
+
+protected:
+  std::unique_ptr<clang::ASTConsumer>
+  CreateASTConsumer(clang::CompilerInstance &CI, StringRef) override {
+    return llvm::make_unique<CTUUnloadASTConsumer>(CI, Success);
+  }
+
+private:
+  bool *Success;
+};
+
 } // end namespace
 
 TEST(CrossTranslationUnit, CanLoadFunctionDefinition) {
@@ -106,6 +193,13 @@ TEST(CrossTranslationUnit, CanLoadFunctionDefinition) {
   EXPECT_TRUE(Success);
 }
 
+TEST(CrossTranslationUnit, KeepsDefinitionsOfUnloadedASTFiles) {
+  bool Success = false;
+  EXPECT_TRUE(tooling::runToolOnCode(new CTUUnloadASTAction(&Success),
+                                     "int f(int); int g(int);"));
+  EXPECT_TRUE(Success);
+}
+
 TEST(CrossTranslationUnit, IndexFormatCanBeParsed) {
   llvm::StringMap<std::string> Index;
   Index["a"] = "/b/f1";
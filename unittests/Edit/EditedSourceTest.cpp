@@ -0,0 +1,206 @@
+//===- unittests/Edit/EditedSourceTest.cpp - EditedSource tests -----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Edit/EditedSource.h"
+#include "clang/Basic/Diagnostic.h"
+#include "clang/Basic/DiagnosticOptions.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/LangOptions.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Edit/Commit.h"
+#include "clang/Edit/EditsReceiver.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "gtest/gtest.h"
+#include <functional>
+#include <vector>
+
+using namespace clang;
+using namespace edit;
+
+namespace {
+
+const char Source[] = "int a = 1; int b = 2; int c = 3;\n";
+
+/// Applies the edits, which arrive in source order, to a copy of the source.
+class StringReceiver : public EditsReceiver {
+  const SourceManager &SM;
+  std::string Result;
+  unsigned Copied = 0;
+
+  void copyUpTo(SourceLocation Loc) {
+    unsigned Offset = SM.getFileOffset(Loc);
+    Result.append(Source + Copied, Source + Offset);
+    Copied = Offset;
+  }
+
+public:
+  explicit StringReceiver(const SourceManager &SM) : SM(SM) {}
+
+  void insert(SourceLocation Loc, StringRef Text) override {
+    copyUpTo(Loc);
+    Result += Text;
+  }
+
+  void replace(CharSourceRange Range, StringRef Text) override {
+    copyUpTo(Range.getBegin());
+    Result += Text;
+    Copied = SM.getFileOffset(Range.getEnd());
+  }
+
+  std::string finish() {
+    Result += Source + Copied;
+    return Result;
+  }
+};
+
+// The test fixture.
+class EditedSourceTest : public ::testing::Test {
+protected:
+  /// Builds the commits to be committed, against an editor on which it may
+  /// first commit other edits.
+  using CommitBuilder =
+      std::function<void(EditedSource &Editor, std::vector<Commit> &Commits)>;
+
+  EditedSourceTest()
+      : FileMgr(FileMgrOpts), DiagID(new DiagnosticIDs()),
+        Diags(DiagID, new DiagnosticOptions, new IgnoringDiagConsumer()),
+        SourceMgr(Diags, FileMgr) {
+    MainFID = SourceMgr.createFileID(llvm::MemoryBuffer::getMemBuffer(Source));
+    SourceMgr.setMainFileID(MainFID);
+  }
+
+  SourceLocation loc(unsigned Offset) {
+    return SourceMgr.getLocForStartOfFile(MainFID).getLocWithOffset(Offset);
+  }
+
+  CharSourceRange range(unsigned Begin, unsigned End) {
+    return CharSourceRange::getCharRange(loc(Begin), loc(End));
+  }
+
+  /// Commits the commits of \p Build, in a batch or one by one, and returns
+  /// the edited source.
+  std::string edit(const CommitBuilder &Build, bool Batched, bool &Committed) {
+    EditedSource Editor(SourceMgr, LangOpts);
+    std::vector<Commit> Commits;
+    Build(Editor, Commits);
+    if (Batched) {
+      Committed = Editor.commitBatch(Commits);
+    } else {
+      Committed = true;
+      for (const Commit &C : Commits)
+        Committed &= Editor.commit(C);
+    }
+    StringReceiver Receiver(SourceMgr);
+    Editor.applyRewrites(Receiver, /*adjustRemovals=*/false);
+    return Receiver.finish();
+  }
+
+  /// Checks that committing the commits of \p Build in a batch has the same
+  /// result as committing them one by one, which is \p Expected.
+  void expectBatchSameAsOneByOne(const CommitBuilder &Build,
+                                 StringRef Expected,
+                                 bool ExpectedCommitted = true) {
+    bool CommittedOneByOne, CommittedBatch;
+    EXPECT_EQ(Expected, edit(Build, /*Batched=*/false, CommittedOneByOne));
+    EXPECT_EQ(ExpectedCommitted, CommittedOneByOne);
+    EXPECT_EQ(Expected, edit(Build, /*Batched=*/true, CommittedBatch));
+    EXPECT_EQ(ExpectedCommitted, CommittedBatch);
+  }
+
+  FileSystemOptions FileMgrOpts;
+  FileManager FileMgr;
+  IntrusiveRefCntPtr<DiagnosticIDs> DiagID;
+  DiagnosticsEngine Diags;
+  SourceManager SourceMgr;
+  LangOptions LangOpts;
+  FileID MainFID;
+};
+
+TEST_F(EditedSourceTest, CommitBatchOfIndependentEdits) {
+  expectBatchSameAsOneByOne(
+      [&](EditedSource &Editor, std::vector<Commit> &Commits) {
+        Commits.emplace_back(Editor);
+        Commits.back().insert(loc(0), "const ");
+        Commits.emplace_back(Editor);
+        Commits.back().remove(range(9, 10));
+        Commits.back().insert(loc(26), "*");
+        Commits.emplace_back(Editor);
+        Commits.back().replace(range(19, 20), "42");
+      },
+      "const int a = 1 int b = 42; int *c = 3;\n");
+}
+
+TEST_F(EditedSourceTest, CommitBatchOfOverlappingRemovals) {
+  expectBatchSameAsOneByOne(
+      [&](EditedSource &Editor, std::vector<Commit> &Commits) {
+        Commits.emplace_back(Editor);
+        Commits.back().remove(range(4, 9));
+        Commits.emplace_back(Editor);
+        Commits.back().remove(range(8, 15));
+      },
+      "int b = 2; int c = 3;\n");
+}
+
+TEST_F(EditedSourceTest, CommitBatchOfInsertionIntoRemoval) {
+  // The insertion goes into text that the first commit removes.
+  expectBatchSameAsOneByOne(
+      [&](EditedSource &Editor, std::vector<Commit> &Commits) {
+        Commits.emplace_back(Editor);
+        Commits.back().remove(range(4, 9));
+        Commits.emplace_back(Editor);
+        Commits.back().insert(loc(6), "x");
+      },
+      "int ; int b = 2; int c = 3;\n");
+}
+
+TEST_F(EditedSourceTest, CommitBatchOfRemovalAtInsertion) {
+  // A removal that starts where an earlier commit inserted keeps the text.
+  expectBatchSameAsOneByOne(
+      [&](EditedSource &Editor, std::vector<Commit> &Commits) {
+        Commits.emplace_back(Editor);
+        Commits.back().insert(loc(4), "x, ");
+        Commits.emplace_back(Editor);
+        Commits.back().remove(range(4, 9));
+      },
+      "int x, ; int b = 2; int c = 3;\n");
+}
+
+TEST_F(EditedSourceTest, CommitBatchOfInsertionsAtTheSameOffset) {
+  expectBatchSameAsOneByOne(
+      [&](EditedSource &Editor, std::vector<Commit> &Commits) {
+        Commits.emplace_back(Editor);
+        Commits.back().insert(loc(4), "x");
+        Commits.emplace_back(Editor);
+        Commits.back().insert(loc(4), "y");
+        Commits.emplace_back(Editor);
+        Commits.back().insert(loc(4), "z", /*afterToken=*/false,
+                              /*beforePreviousInsertions=*/true);
+      },
+      "int zxya = 1; int b = 2; int c = 3;\n");
+}
+
+TEST_F(EditedSourceTest, CommitBatchTouchingEarlierEdits) {
+  expectBatchSameAsOneByOne(
+      [&](EditedSource &Editor, std::vector<Commit> &Commits) {
+        Commit Earlier(Editor);
+        Earlier.remove(range(15, 20));
+        ASSERT_TRUE(Editor.commit(Earlier));
+        // Removing text that overlaps the earlier removal merges with it.
+        Commits.emplace_back(Editor);
+        Commits.back().remove(range(12, 17));
+        // Inserting into the earlier removal makes the commit uncommitable.
+        Commits.emplace_back(Editor);
+        Commits.back().insert(loc(17), "x");
+        Commits.emplace_back(Editor);
+        Commits.back().insert(loc(0), "const ");
+      },
+      "const int a = 1; i; int c = 3;\n", /*ExpectedCommitted=*/false);
+}
+
+} // anonymous namespace
@@ -4067,6 +4067,28 @@ TEST_F(FormatTest, MemoizationTests) {
   input += "           a) {}";
   verifyFormat(input, OnePerLine);
 }
+
+TEST_F(FormatTest, CompletesLinesThatExhaustTheSearchBudget) {
+  // Once too many states are queued, the line is completed greedily. It
+  // must still be formatted, and keep all of its tokens.
+  std::string Code = "int i = ";
+  for (unsigned i = 0; i != 40; ++i)
+    Code += "aaaaa(bbbbb, ccccc, ";
+  Code += "ddddd";
+  for (unsigned i = 0; i != 40; ++i)
+    Code += ")";
+  Code += ";";
+  std::string Result = format(Code, getLLVMStyleWithColumns(40));
+  EXPECT_NE(Code, Result);
+  auto WithoutSpaces = [](StringRef S) {
+    std::string Tokens;
+    for (char C : S)
+      if (C != ' ' && C != '\n')
+        Tokens += C;
+    return Tokens;
+  };
+  EXPECT_EQ(WithoutSpaces(Code), WithoutSpaces(Result));
+}
 #endif
 
 TEST_F(FormatTest, BreaksAsHighAsPossible) {
@@ -7270,6 +7292,15 @@ TEST_F(FormatTest, LayoutCxx11BraceInitializers) {
                "  { \"ccccccccccccccccccccc\", 2 }\n"
                "};",
                ExtraSpaces);
+  // The last element fills the column limit. The closing brace is broken
+  // before, so it does not count against the line of that element.
+  verifyFormat("const std::unordered_map<std::string, int> MyHashTable = {\n"
+               "  { \"aaaaaaaaaaaaaaaaaaaaa\", 0 },\n"
+               "  { \"bbbbbbbbbbbbbbbbbbbbb\", 1 },\n"
+               "  { \"cccccccccccccccccccccccccccccccccccccccccccccccccccccc"
+               "cccccccccc\", 2 }\n"
+               "};",
+               ExtraSpaces);
 
   FormatStyle SpaceBeforeBrace = getLLVMStyle();
   SpaceBeforeBrace.SpaceBeforeCpp11BracedList = true;
@@ -12529,6 +12560,38 @@ TEST(FormatStyle, GetStyleOfFile) {
   llvm::consumeError(Style7.takeError());
 }
 
+TEST(FormatStyle, GetStyleOfFileWithCache) {
+  llvm::vfs::InMemoryFileSystem FS;
+  FormatStyleCache Cache;
+  ASSERT_TRUE(FS.addFile("/a/.clang-format", 0,
+                         llvm::MemoryBuffer::getMemBuffer(
+                             "---\nLanguage: Cpp\nIndentWidth: 3\n"
+                             "---\nLanguage: JavaScript\nIndentWidth: 5\n")));
+  ASSERT_TRUE(
+      FS.addFile("/a/b/test.cpp", 0, llvm::MemoryBuffer::getMemBuffer("")));
+  ASSERT_TRUE(
+      FS.addFile("/a/b/test.js", 0, llvm::MemoryBuffer::getMemBuffer("")));
+  ASSERT_TRUE(
+      FS.addFile("/a/b/test.proto", 0, llvm::MemoryBuffer::getMemBuffer("")));
+
+  // The second lookup of each language comes from the cache.
+  for (int I = 0; I != 2; ++I) {
+    auto CppStyle = getStyle("file", "/a/b/test.cpp", "LLVM", "", &FS, &Cache);
+    ASSERT_TRUE((bool)CppStyle);
+    EXPECT_EQ(3u, CppStyle->IndentWidth);
+    EXPECT_EQ(*CppStyle, *getStyle("file", "/a/b/test.cpp", "LLVM", "", &FS));
+
+    auto JSStyle = getStyle("file", "/a/b/test.js", "LLVM", "", &FS, &Cache);
+    ASSERT_TRUE((bool)JSStyle);
+    EXPECT_EQ(5u, JSStyle->IndentWidth);
+
+    auto ProtoStyle =
+        getStyle("file", "/a/b/test.proto", "LLVM", "", &FS, &Cache);
+    ASSERT_FALSE((bool)ProtoStyle);
+    llvm::consumeError(ProtoStyle.takeError());
+  }
+}
+
 TEST_F(ReplacementTest, FormatCodeAfterReplacements) {
   // Column limit is 20.
   std::string Code = "Type *a =\n"
@@ -12592,6 +12655,65 @@ TEST_F(ReplacementTest, SortIncludesAfterReplacement) {
   EXPECT_EQ(Expected, *Result);
 }
 
+TEST_F(FormatTest, IncrementalFormatterMatchesReformat) {
+  FormatStyle Style = getLLVMStyle();
+  IncrementalFormatter Formatter(Style);
+  auto check = [&](llvm::StringRef Code, unsigned Offset, unsigned Length) {
+    std::vector<tooling::Range> Ranges(1, tooling::Range(Offset, Length));
+    FormattingAttemptStatus Expected, Actual;
+    auto ExpectedCode = applyAllReplacements(
+        Code, reformat(Style, Code, Ranges, "<stdin>", &Expected));
+    auto ActualCode = applyAllReplacements(
+        Code, Formatter.reformat(Code, Ranges, &Actual));
+    EXPECT_TRUE(static_cast<bool>(ExpectedCode));
+    EXPECT_TRUE(static_cast<bool>(ActualCode));
+    EXPECT_EQ(*ExpectedCode, *ActualCode) << Code;
+    EXPECT_EQ(Expected.FormatComplete, Actual.FormatComplete) << Code;
+    if (!Expected.FormatComplete)
+      EXPECT_EQ(Expected.Line, Actual.Line) << Code;
+    return *ActualCode;
+  };
+
+  std::string Code = "namespace n {\n"
+                     "\n"
+                     "int   a;\n"
+                     "\n"
+                     "void f() {\n"
+                     "  g( );\n"
+                     "}\n"
+                     "\n"
+                     "struct S {\n"
+                     "  int  x;\n"
+                     "};\n"
+                     "\n"
+                     "} // namespace n\n";
+  Code = check(Code, 0, Code.size());
+
+  // Reformat a declaration after an edit in it.
+  size_t Pos = Code.find("g();");
+  Code.insert(Pos, "h(1,2);   ");
+  Code = check(Code, Pos, 10);
+
+  // An edit that opens a block turns the rest of the file into its body.
+  Pos = Code.find("struct S");
+  Code.insert(Pos, "void k() {\n");
+  Code = check(Code, Pos, 11);
+  Code.erase(Pos, 11);
+  Code = check(Code, Pos, 0);
+
+  // Edits in two declarations at once.
+  size_t Begin = Code.find("int a;");
+  Code.insert(Begin, "int  b;\n");
+  Pos = Code.find("int x;");
+  Code.insert(Pos, "int  y;\n");
+  Code = check(Code, Begin, Pos + 8 - Begin);
+
+  // Status lines count from the start of the file.
+  Pos = Code.find("struct S");
+  Code.insert(Pos, "int c = ;\n");
+  check(Code, Pos, 9);
+}
+
 TEST_F(FormatTest, FormatSortsUsingDeclarations) {
   EXPECT_EQ("using std::cin;\n"
             "using std::cout;",
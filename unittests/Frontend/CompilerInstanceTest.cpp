@@ -7,8 +7,11 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "clang/Basic/TargetInfo.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/CompilerInvocation.h"
+#include "clang/Lex/Preprocessor.h"
+#include "clang/Lex/PreprocessorOptions.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/ToolOutputFile.h"
@@ -71,4 +74,41 @@ TEST(CompilerInstance, DefaultVFSOverlayFromInvocation) {
   ASSERT_TRUE(Instance.getFileManager().getFile("vfs-virtual.file"));
 }
 
+// Returns the predefines of a preprocessor for Triple, in C or C++, with the
+// given command line macros.
+static std::string getPredefines(StringRef Triple, bool CPlusPlus,
+                                 ArrayRef<const char *> Macros = None) {
+  CompilerInstance Instance;
+  Instance.createDiagnostics();
+  Instance.getLangOpts().CPlusPlus = CPlusPlus;
+  Instance.getTargetOpts().Triple = Triple;
+  for (const char *Macro : Macros)
+    Instance.getPreprocessorOpts().addMacroDef(Macro);
+  Instance.setTarget(TargetInfo::CreateTargetInfo(
+      Instance.getDiagnostics(),
+      std::make_shared<clang::TargetOptions>(Instance.getTargetOpts())));
+  Instance.createFileManager();
+  Instance.createSourceManager(Instance.getFileManager());
+  Instance.createPreprocessor(TU_Complete);
+  return Instance.getPreprocessor().getPredefines();
+}
+
+TEST(CompilerInstance, CachesBuiltinPredefinesPerConfiguration) {
+  std::string X86_64 = getPredefines("x86_64-unknown-linux-gnu", false);
+  std::string I386 = getPredefines("i386-unknown-linux-gnu", false);
+  std::string CXX = getPredefines("x86_64-unknown-linux-gnu", true);
+
+  EXPECT_NE(std::string::npos, X86_64.find("#define __x86_64__ 1\n"));
+  EXPECT_EQ(std::string::npos, I386.find("#define __x86_64__ 1\n"));
+  EXPECT_EQ(std::string::npos, X86_64.find("#define __cplusplus "));
+  EXPECT_NE(std::string::npos, CXX.find("#define __cplusplus "));
+  EXPECT_EQ(X86_64, getPredefines("x86_64-unknown-linux-gnu", false));
+
+  // The macros from the command line are not part of the cached predefines.
+  std::string WithMacro =
+      getPredefines("x86_64-unknown-linux-gnu", false, {"MACRO=1"});
+  EXPECT_NE(std::string::npos, WithMacro.find("#define MACRO 1\n"));
+  EXPECT_EQ(X86_64, getPredefines("x86_64-unknown-linux-gnu", false));
+}
+
 } // anonymous namespace
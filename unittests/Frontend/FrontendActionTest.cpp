@@ -17,9 +17,13 @@
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Lex/PreprocessorOptions.h"
 #include "clang/Sema/Sema.h"
+#include "clang/Serialization/ASTDeserializationListener.h"
 #include "llvm/ADT/Triple.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FileUtilities.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "gtest/gtest.h"
+#include <algorithm>
 
 using namespace llvm;
 using namespace clang;
@@ -254,4 +258,226 @@ TEST(ASTFrontendAction, ExternalSemaSource) {
   EXPECT_EQ("This is a note", TDC->Note.str().str());
 }
 
+class DeferredBodiesFrontendAction : public ASTFrontendAction {
+public:
+  std::vector<std::string> BodiesBefore, BodiesAfter;
+
+  std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &CI,
+                                                 StringRef InFile) override {
+    return llvm::make_unique<Consumer>(CI, *this);
+  }
+
+private:
+  class Consumer : public ASTConsumer, public RecursiveASTVisitor<Consumer> {
+  public:
+    Consumer(CompilerInstance &CI, DeferredBodiesFrontendAction &Action)
+        : CI(CI), Action(Action) {}
+
+    void HandleTranslationUnit(ASTContext &Context) override {
+      Bodies = &Action.BodiesBefore;
+      TraverseDecl(Context.getTranslationUnitDecl());
+
+      // Ask for the body of 'f' and for everything on the line of 'g'.
+      Sema &S = CI.getSema();
+      S.ParseDeferredFunctionBody(F);
+      SourceLocation GLoc = G->getLocation();
+      S.ParseDeferredFunctionBodies(
+          SourceRange(GLoc, GLoc.getLocWithOffset(12)));
+
+      Bodies = &Action.BodiesAfter;
+      TraverseDecl(Context.getTranslationUnitDecl());
+    }
+
+    bool VisitFunctionDecl(FunctionDecl *FD) {
+      if (FD->getName() == "f")
+        F = FD;
+      else if (FD->getName() == "g")
+        G = FD;
+      if (FD->getBody())
+        Bodies->push_back(FD->getQualifiedNameAsString());
+      return true;
+    }
+
+  private:
+    CompilerInstance &CI;
+    DeferredBodiesFrontendAction &Action;
+    std::vector<std::string> *Bodies = nullptr;
+    FunctionDecl *F = nullptr;
+    FunctionDecl *G = nullptr;
+  };
+};
+
+TEST(ASTFrontendAction, DeferSkippedFunctionBodies) {
+  auto Invocation = std::make_shared<CompilerInvocation>();
+  Invocation->getLangOpts()->CPlusPlus = true;
+  Invocation->getPreprocessorOpts().addRemappedFile(
+      "test.cc", MemoryBuffer::getMemBuffer(
+                     "namespace n { int f(int x) { return x; } }\n"
+                     "struct S { int g() { return n::f(1); } };\n"
+                     "int h() { return 0; }\n"
+                     "constexpr int k() { return 1; }\n")
+                     .release());
+  Invocation->getFrontendOpts().Inputs.push_back(
+      FrontendInputFile("test.cc", InputKind::CXX));
+  Invocation->getFrontendOpts().ProgramAction = frontend::ParseSyntaxOnly;
+  Invocation->getFrontendOpts().SkipFunctionBodies = true;
+  Invocation->getFrontendOpts().DeferSkippedFunctionBodies = true;
+  Invocation->getTargetOpts().Triple = "i386-unknown-linux-gnu";
+  CompilerInstance Compiler;
+  Compiler.setInvocation(std::move(Invocation));
+  Compiler.createDiagnostics();
+
+  DeferredBodiesFrontendAction TestAction;
+  ASSERT_TRUE(Compiler.ExecuteAction(TestAction));
+  EXPECT_FALSE(Compiler.getDiagnostics().hasErrorOccurred());
+
+  // Constexpr bodies are never skipped.
+  ASSERT_EQ(1U, TestAction.BodiesBefore.size());
+  EXPECT_EQ("k", TestAction.BodiesBefore[0]);
+
+  // 'h' was not asked for and stays unparsed.
+  ASSERT_EQ(3U, TestAction.BodiesAfter.size());
+  EXPECT_EQ("n::f", TestAction.BodiesAfter[0]);
+  EXPECT_EQ("S::g", TestAction.BodiesAfter[1]);
+  EXPECT_EQ("k", TestAction.BodiesAfter[2]);
+}
+
+struct WarningCollector : public DiagnosticConsumer {
+  void HandleDiagnostic(DiagnosticsEngine::Level DiagLevel,
+                        const Diagnostic &Info) override {
+    if (DiagLevel != DiagnosticsEngine::Warning)
+      return;
+    SmallString<64> Message;
+    Info.FormatDiagnostic(Message);
+    Warnings.push_back(Message.str());
+  }
+  std::vector<std::string> Warnings;
+};
+
+TEST(ASTFrontendAction, DeferSkippedFunctionBodiesDiagnostics) {
+  auto Invocation = std::make_shared<CompilerInvocation>();
+  Invocation->getLangOpts()->CPlusPlus = true;
+  Invocation->getPreprocessorOpts().addRemappedFile(
+      "test.cc", MemoryBuffer::getMemBuffer(
+                     "int f(int x) { return 0; }\n"
+                     "struct S { int g(int y) { return 0; } };\n"
+                     "int h(int z) { return 0; }\n")
+                     .release());
+  Invocation->getFrontendOpts().Inputs.push_back(
+      FrontendInputFile("test.cc", InputKind::CXX));
+  Invocation->getFrontendOpts().ProgramAction = frontend::ParseSyntaxOnly;
+  Invocation->getFrontendOpts().SkipFunctionBodies = true;
+  Invocation->getFrontendOpts().DeferSkippedFunctionBodies = true;
+  Invocation->getDiagnosticOpts().Warnings.push_back("unused-parameter");
+  Invocation->getDiagnosticOpts().Warnings.push_back("missing-prototypes");
+  Invocation->getTargetOpts().Triple = "i386-unknown-linux-gnu";
+  CompilerInstance Compiler;
+  Compiler.setInvocation(std::move(Invocation));
+  auto *WC = new WarningCollector;
+  Compiler.createDiagnostics(WC, /*ShouldOwnClient=*/true);
+
+  DeferredBodiesFrontendAction TestAction;
+  ASSERT_TRUE(Compiler.ExecuteAction(TestAction));
+
+  // Deferred bodies are diagnosed like skipped ones when they are seen, and
+  // their parameters only once the bodies are parsed. 'h' is never parsed.
+  ASSERT_EQ(4U, WC->Warnings.size());
+  EXPECT_EQ("no previous prototype for function 'f'", WC->Warnings[0]);
+  EXPECT_EQ("no previous prototype for function 'h'", WC->Warnings[1]);
+  EXPECT_EQ("unused parameter 'x'", WC->Warnings[2]);
+  EXPECT_EQ("unused parameter 'y'", WC->Warnings[3]);
+}
+
+class DeserializedDeclsAction : public ASTFrontendAction {
+public:
+  explicit DeserializedDeclsAction(bool WantsInterestingDecls)
+      : WantsInterestingDecls(WantsInterestingDecls) {}
+
+  bool WantsInterestingDecls;
+  std::vector<std::string> DeclsRead;
+
+  std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &CI,
+                                                 StringRef InFile) override {
+    return llvm::make_unique<Consumer>(*this);
+  }
+
+private:
+  class Consumer : public ASTConsumer, public ASTDeserializationListener {
+  public:
+    explicit Consumer(DeserializedDeclsAction &Action) : Action(Action) {}
+
+    bool wantsInterestingDecls() override {
+      return Action.WantsInterestingDecls;
+    }
+
+    ASTDeserializationListener *GetASTDeserializationListener() override {
+      return this;
+    }
+
+    void DeclRead(serialization::DeclID ID, const Decl *D) override {
+      if (const auto *ND = dyn_cast<NamedDecl>(D))
+        Action.DeclsRead.push_back(ND->getNameAsString());
+    }
+
+  private:
+    DeserializedDeclsAction &Action;
+  };
+};
+
+const char EagerHeader[] = "void eager() {}\n";
+
+std::vector<std::string> readDeclsFromPCH(StringRef PCHFile,
+                                          bool WantsInterestingDecls) {
+  auto Invocation = std::make_shared<CompilerInvocation>();
+  Invocation->getLangOpts()->CPlusPlus = true;
+  Invocation->getPreprocessorOpts().addRemappedFile(
+      "eager.h", MemoryBuffer::getMemBuffer(EagerHeader).release());
+  Invocation->getPreprocessorOpts().addRemappedFile(
+      "test.cc", MemoryBuffer::getMemBuffer("int main() { return 0; }\n")
+                     .release());
+  Invocation->getPreprocessorOpts().ImplicitPCHInclude = PCHFile;
+  Invocation->getPreprocessorOpts().DisablePCHValidation = true;
+  Invocation->getFrontendOpts().Inputs.push_back(
+      FrontendInputFile("test.cc", InputKind::CXX));
+  Invocation->getFrontendOpts().ProgramAction = frontend::ParseSyntaxOnly;
+  Invocation->getTargetOpts().Triple = "i386-unknown-linux-gnu";
+  CompilerInstance Compiler;
+  Compiler.setInvocation(std::move(Invocation));
+  Compiler.createDiagnostics();
+
+  DeserializedDeclsAction TestAction(WantsInterestingDecls);
+  EXPECT_TRUE(Compiler.ExecuteAction(TestAction));
+  return TestAction.DeclsRead;
+}
+
+TEST(ASTFrontendAction, SkipsEagerlyDeserializedDecls) {
+  SmallString<128> PCHFile;
+  ASSERT_FALSE(sys::fs::createTemporaryFile("eager", "pch", PCHFile));
+  FileRemover PCHFileRemover(PCHFile);
+
+  // The definition of 'eager' must be emitted, so the PCH lists it among the
+  // eagerly deserialized decls.
+  auto Invocation = std::make_shared<CompilerInvocation>();
+  Invocation->getLangOpts()->CPlusPlus = true;
+  Invocation->getPreprocessorOpts().addRemappedFile(
+      "eager.h", MemoryBuffer::getMemBuffer(EagerHeader).release());
+  Invocation->getFrontendOpts().Inputs.push_back(
+      FrontendInputFile("eager.h", InputKind::CXX));
+  Invocation->getFrontendOpts().ProgramAction = frontend::GeneratePCH;
+  Invocation->getFrontendOpts().OutputFile = PCHFile.str();
+  Invocation->getTargetOpts().Triple = "i386-unknown-linux-gnu";
+  CompilerInstance Compiler;
+  Compiler.setInvocation(std::move(Invocation));
+  Compiler.createDiagnostics();
+  GeneratePCHAction PCHAction;
+  ASSERT_TRUE(Compiler.ExecuteAction(PCHAction));
+
+  std::vector<std::string> Wanted = readDeclsFromPCH(PCHFile, true);
+  EXPECT_NE(Wanted.end(), std::find(Wanted.begin(), Wanted.end(), "eager"));
+
+  // A consumer that opts out of interesting decls never sees 'eager' read.
+  std::vector<std::string> Skipped = readDeclsFromPCH(PCHFile, false);
+  EXPECT_EQ(Skipped.end(), std::find(Skipped.begin(), Skipped.end(), "eager"));
+}
+
 } // anonymous namespace
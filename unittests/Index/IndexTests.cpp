@@ -9,14 +9,21 @@
 
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/Decl.h"
+#include "clang/AST/RecursiveASTVisitor.h"
+#include "clang/Frontend/ASTUnit.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/FrontendAction.h"
 #include "clang/Index/IndexDataConsumer.h"
+#include "clang/Index/IndexStore.h"
 #include "clang/Index/IndexSymbol.h"
 #include "clang/Index/IndexingAction.h"
+#include "clang/Index/USRGeneration.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/VirtualFileSystem.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -120,6 +127,173 @@ TEST(IndexTest, IndexPreprocessorMacros) {
   EXPECT_THAT(Index->Symbols, UnorderedElementsAre());
 }
 
+TEST(USRCacheTest, MatchesGeneratedUSRs) {
+  std::unique_ptr<ASTUnit> AST = tooling::buildASTFromCode(R"cpp(
+    namespace ns {
+    template <typename T> struct Outer {
+      struct Inner { T member(T, int *); };
+    };
+    template <> struct Outer<int> { void special(); };
+    static void helper(int Param) {
+      struct Local { int field; };
+      int Var = Param;
+    }
+    typedef struct { int anon; } Named;
+    namespace { int hidden; }
+    void overloaded(int);
+    void overloaded(Outer<int>);
+    }
+  )cpp");
+  ASSERT_TRUE(AST);
+
+  struct DeclCollector : RecursiveASTVisitor<DeclCollector> {
+    std::vector<const Decl *> Decls;
+    bool shouldVisitTemplateInstantiations() const { return true; }
+    bool VisitDecl(Decl *D) {
+      Decls.push_back(D);
+      return true;
+    }
+  } Collector;
+  Collector.TraverseDecl(AST->getASTContext().getTranslationUnitDecl());
+
+  USRCache Cache(AST->getASTContext());
+  // Twice, so that the second round only sees cached USRs.
+  for (int Round = 0; Round != 2; ++Round) {
+    for (const Decl *D : Collector.Decls) {
+      SmallString<128> USR;
+      bool Ignore = generateUSRForDecl(D, USR);
+      EXPECT_EQ(Ignore ? "" : USR.str(), Cache.getUSR(D));
+      EXPECT_EQ(Ignore ? 0 : hashUSR(USR), Cache.getUSRHash(D));
+    }
+  }
+}
+
+// Says that skipped.h was already indexed.
+class SkipHeader : public IndexedFileOracle {
+public:
+  bool isFileIndexed(const FileEntry &File) override {
+    return llvm::sys::path::filename(File.getName()) == "skipped.h";
+  }
+};
+
+TEST(IndexTest, SkipsIndexedFiles) {
+  auto Index = std::make_shared<Indexer>();
+  IndexingOptions Opts;
+  Opts.FileOracle = std::make_shared<SkipHeader>();
+  tooling::FileContentMappings Headers = {
+      {"skipped.h", "#define SKIPPED_MACRO 1\n"
+                    "int skipped();\n"
+                    "class SkippedClass { void method(); };"}};
+  tooling::runToolOnCodeWithArgs(
+      createIndexingAction(Index, Opts, nullptr).release(),
+      "#include \"skipped.h\"\n"
+      "int indexed() { return skipped(); }",
+      {}, "input.cc", "clang-tool",
+      std::make_shared<PCHContainerOperations>(), Headers);
+  // The reference to skipped() is in the main file, its declaration isn't.
+  EXPECT_THAT(Index->Symbols,
+              UnorderedElementsAre(QName("indexed"), QName("skipped")));
+}
+
+// Compiles Code into the index store at StorePath, and returns the unit that
+// the compilation wrote.
+static std::unique_ptr<IndexUnitReader>
+indexIntoStore(StringRef StorePath, StringRef MainFile, StringRef Code,
+               StringRef OutputFile, IndexingOptions Opts = IndexingOptions(),
+               StringRef SharedHeader = "int shared(int X);") {
+  tooling::FileContentMappings Headers = {{"shared.h", SharedHeader}};
+  tooling::runToolOnCodeWithArgs(
+      createIndexingAction(createIndexStoreConsumer(StorePath, OutputFile),
+                           Opts, nullptr)
+          .release(),
+      Code, {}, MainFile, "clang-tool",
+      std::make_shared<PCHContainerOperations>(), Headers);
+  auto Unit = IndexUnitReader::create(StorePath, getIndexStoreUnitName(
+                                                     MainFile, OutputFile));
+  if (!Unit) {
+    ADD_FAILURE() << llvm::toString(Unit.takeError());
+    return nullptr;
+  }
+  return std::move(*Unit);
+}
+
+static std::string getRecordName(const IndexUnitReader &Unit,
+                                 StringRef FileName) {
+  for (unsigned I = 0, E = Unit.getNumDependencies(); I != E; ++I) {
+    IndexUnitReader::Dependency Dep = Unit.getDependency(I);
+    if (llvm::sys::path::filename(Dep.FilePath) == FileName)
+      return Dep.RecordName;
+  }
+  return "";
+}
+
+TEST(IndexStoreTest, SharesHeaderRecordsBetweenUnits) {
+  SmallString<128> StorePath;
+  ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("index-store", StorePath));
+
+  auto Unit1 = indexIntoStore(StorePath, "a.cc",
+                              "#include \"shared.h\"\n"
+                              "int a() { return shared(1); }",
+                              "a.o");
+  auto Unit2 = indexIntoStore(StorePath, "b.cc",
+                              "#include \"shared.h\"\n"
+                              "int b() { return shared(2); }",
+                              "b.o");
+  ASSERT_TRUE(Unit1 && Unit2);
+  EXPECT_EQ("a.cc", llvm::sys::path::filename(Unit1->getMainFilePath()));
+  EXPECT_EQ("b.o", llvm::sys::path::filename(Unit2->getOutputFile()));
+
+  std::string Header1 = getRecordName(*Unit1, "shared.h");
+  ASSERT_NE("", Header1);
+  EXPECT_EQ(Header1, getRecordName(*Unit2, "shared.h"));
+  EXPECT_NE(getRecordName(*Unit1, "a.cc"), getRecordName(*Unit2, "b.cc"));
+
+  auto Record = IndexRecordReader::create(StorePath, Header1);
+  ASSERT_TRUE(bool(Record)) << llvm::toString(Record.takeError());
+  std::vector<std::string> Names;
+  for (unsigned I = 0, E = (*Record)->getNumSymbols(); I != E; ++I)
+    Names.push_back((*Record)->getSymbol(I).Name);
+  EXPECT_THAT(Names, UnorderedElementsAre("shared"));
+  ASSERT_EQ(1u, (*Record)->getNumOccurrences());
+  IndexRecordReader::Occurrence Occurrence = (*Record)->getOccurrence(0);
+  EXPECT_EQ(1u, Occurrence.Line);
+  EXPECT_EQ(5u, Occurrence.Column);
+  EXPECT_TRUE(Occurrence.Roles & unsigned(SymbolRole::Declaration));
+
+  llvm::sys::fs::remove_directories(StorePath);
+}
+
+TEST(IndexStoreTest, SkipsHeadersIndexedInTheStore) {
+  SmallString<128> StorePath;
+  ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("index-store", StorePath));
+
+  auto Unit1 = indexIntoStore(StorePath, "a.cc",
+                              "#include \"shared.h\"\n"
+                              "int a() { return shared(1); }",
+                              "a.o");
+  ASSERT_TRUE(Unit1);
+
+  // The mapped header keeps its modification time when its contents change,
+  // so the oracle still reports it as indexed. The second unit depends on
+  // the record of the first compilation instead of a new one.
+  IndexingOptions Opts;
+  Opts.FileOracle = createIndexStoreFileOracle(StorePath);
+  auto Unit2 = indexIntoStore(StorePath, "b.cc",
+                              "#include \"shared.h\"\n"
+                              "int b() { return shared(2); }",
+                              "b.o", Opts,
+                              "int shared(int X);\n"
+                              "int unindexed();");
+  ASSERT_TRUE(Unit2);
+
+  std::string Header1 = getRecordName(*Unit1, "shared.h");
+  ASSERT_NE("", Header1);
+  EXPECT_EQ(Header1, getRecordName(*Unit2, "shared.h"));
+  EXPECT_NE("", getRecordName(*Unit2, "b.cc"));
+
+  llvm::sys::fs::remove_directories(StorePath);
+}
+
 } // namespace
 } // namespace index
 } // namespace clang
@@ -0,0 +1,110 @@
+//===- unittests/Lex/DependencyDirectivesSourceMinimizerTest.cpp ----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/DependencyDirectivesSourceMinimizer.h"
+#include "llvm/ADT/SmallString.h"
+#include "gtest/gtest.h"
+
+using namespace clang;
+
+namespace {
+
+std::string minimize(StringRef Input) {
+  SmallString<128> Out;
+  EXPECT_FALSE(minimizeSourceToDependencyDirectives(Input, Out));
+  return Out.str().str();
+}
+
+TEST(MinimizeSourceToDependencyDirectivesTest, Empty) {
+  EXPECT_EQ("", minimize(""));
+  EXPECT_EQ("", minimize("int x;\n// comment\n/* comment */\n"));
+}
+
+TEST(MinimizeSourceToDependencyDirectivesTest, KeptDirectives) {
+  EXPECT_EQ("#include <a.h>\n"
+            "#include_next \"b.h\"\n"
+            "#import <c.h>\n"
+            "#define X 1\n"
+            "#undef X\n"
+            "#ifdef X\n"
+            "#elif X\n"
+            "#else\n"
+            "#endif\n",
+            minimize("#include <a.h>\n"
+                     "#include_next \"b.h\"\n"
+                     "#import <c.h>\n"
+                     "#define X 1\n"
+                     "#undef X\n"
+                     "#ifdef X\n"
+                     "#elif X\n"
+                     "#else\n"
+                     "#endif\n"));
+}
+
+TEST(MinimizeSourceToDependencyDirectivesTest, DroppedDirectives) {
+  EXPECT_EQ("", minimize("#error don't\n"
+                         "#warning x\n"
+                         "#line 4\n"
+                         "#pragma mark x\n"
+                         "#ident \"x\"\n"
+                         "#\n"));
+}
+
+TEST(MinimizeSourceToDependencyDirectivesTest, Pragmas) {
+  EXPECT_EQ("#pragma once\n"
+            "#pragma GCC system_header\n"
+            "#pragma clang module import Foo\n"
+            "#pragma push_macro(\"X\")\n",
+            minimize("#pragma once\n"
+                     "#pragma GCC system_header\n"
+                     "#pragma clang diagnostic push\n"
+                     "#pragma clang module import Foo\n"
+                     "#pragma push_macro(\"X\")\n"
+                     "#pragma pack(1)\n"));
+}
+
+TEST(MinimizeSourceToDependencyDirectivesTest, WhitespaceAndComments) {
+  EXPECT_EQ("#define X(a) a\n"
+            "#define Y (a)\n"
+            "#include <a//b.h>\n"
+            "#include \"c.h\"\n",
+            minimize("  #  define X(a) \\\n   a // comment\n"
+                     "#define Y/**/(a)\n"
+                     "/* lead */ #include <a//b.h>\n"
+                     "#include \"c.h\" /* trailing\n comment */\n"));
+}
+
+TEST(MinimizeSourceToDependencyDirectivesTest, NotDirectives) {
+  EXPECT_EQ("#include \"real.h\"\n",
+            minimize("/*\n#include \"comment.h\"\n*/\n"
+                     "const char *S = \"\\\n#include \\\"string.h\\\"\";\n"
+                     "const char *R = R\"x(\n#include \"raw.h\"\n)x\";\n"
+                     "int N = 1'000; #include \"mid-line.h\"\n"
+                     "#include \"real.h\"\n"));
+}
+
+TEST(MinimizeSourceToDependencyDirectivesTest, ModuleDeclarations) {
+  EXPECT_EQ("@import Foo.Bar;\n"
+            "export module M;\n"
+            "import N;\n",
+            minimize("@import Foo.Bar; int x;\n"
+                     "@interface I\n"
+                     "export module M;\n"
+                     "import N;\n"
+                     "int module = 0;\n"));
+}
+
+TEST(MinimizeSourceToDependencyDirectivesTest, Failures) {
+  SmallString<128> Out;
+  EXPECT_TRUE(minimizeSourceToDependencyDirectives("/* unterminated", Out));
+  EXPECT_TRUE(
+      minimizeSourceToDependencyDirectives("auto S = R\"(unterminated", Out));
+}
+
+} // end anonymous namespace
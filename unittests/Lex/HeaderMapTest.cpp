@@ -180,6 +180,35 @@ TEST(HeaderMapTest, lookupFilename) {
   ASSERT_EQ("bc", Map.lookupFilename("a", DestPath));
 }
 
+TEST(HeaderMapTest, lookupFilenameCollisions) {
+  typedef MapFile<8, 64> FileTy;
+  FileTy File;
+  File.init();
+
+  // "ab" and "ba" share a hash, as do keys that differ only in case.
+  FileMaker<FileTy> Maker(File);
+  auto ab = Maker.addString("ab");
+  auto AB = Maker.addString("AB");
+  auto ba = Maker.addString("ba");
+  auto x = Maker.addString("x/");
+  auto y = Maker.addString("y/");
+  auto file = Maker.addString("file.h");
+  Maker.addBucket(getHash("ab"), ab, x, file);
+  Maker.addBucket(getHash("AB"), AB, y, file);
+  Maker.addBucket(getHash("ba"), ba, y, file);
+
+  bool NeedsSwap;
+  ASSERT_TRUE(HeaderMapImpl::checkHeader(*File.getBuffer(), NeedsSwap));
+  ASSERT_FALSE(NeedsSwap);
+  HeaderMapImpl Map(File.getBuffer(), NeedsSwap);
+
+  SmallString<16> DestPath;
+  EXPECT_EQ("x/file.h", Map.lookupFilename("ab", DestPath));
+  EXPECT_EQ("x/file.h", Map.lookupFilename("aB", DestPath));
+  EXPECT_EQ("y/file.h", Map.lookupFilename("BA", DestPath));
+  EXPECT_EQ("", Map.lookupFilename("abc", DestPath));
+}
+
 template <class FileTy, class PaddingTy> struct PaddedFile {
   FileTy File;
   PaddingTy Padding;
@@ -18,6 +18,7 @@
 #include "clang/Basic/TargetOptions.h"
 #include "clang/Lex/HeaderSearch.h"
 #include "clang/Lex/HeaderSearchOptions.h"
+#include "llvm/Support/FileSystem.h"
 #include "gtest/gtest.h"
 
 namespace clang {
@@ -92,5 +93,52 @@ TEST_F(HeaderSearchTest, Dots) {
             "z");
 }
 
+TEST_F(HeaderSearchTest, IncludeMap) {
+  SmallString<128> MapDir;
+  ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("include-map", MapDir));
+
+  for (StringRef Dir : {"/a", "/b"})
+    VFS->addFile(Dir, 0, llvm::MemoryBuffer::getMemBuffer(""), /*User=*/None,
+                 /*Group=*/None, llvm::sys::fs::file_type::directory_file);
+  VFS->addFile("/b/x.h", 0, llvm::MemoryBuffer::getMemBuffer(""));
+
+  // Look up "x.h" the way a new compilation in the given build session
+  // would, with its own file manager.
+  auto LookupInNewCompilation = [&](uint64_t BuildSession) {
+    FileManager FM(FileMgrOpts, VFS);
+    SourceManager SM(Diags, FM);
+    auto Opts = std::make_shared<HeaderSearchOptions>();
+    Opts->IncludeMapPath = MapDir.str();
+    Opts->BuildSessionTimestamp = BuildSession;
+    HeaderSearch HS(Opts, SM, Diags, LangOpts, Target.get());
+    for (StringRef Dir : {"/a", "/b"})
+      HS.AddSearchPath(DirectoryLookup(FM.getDirectory(Dir), SrcMgr::C_User,
+                                       /*isFramework=*/false),
+                       /*isAngled=*/false);
+
+    const DirectoryLookup *CurDir = nullptr;
+    const FileEntry *FE = HS.LookupFile(
+        "x.h", SourceLocation(), /*isAngled=*/false, /*FromDir=*/nullptr,
+        CurDir, /*Includers=*/None, /*SearchPath=*/nullptr,
+        /*RelativePath=*/nullptr, /*RequestingModule=*/nullptr,
+        /*SuggestedModule=*/nullptr, /*IsMapped=*/nullptr);
+    EXPECT_FALSE(HS.writeIncludeMap());
+    return FE ? FE->getName().str() : std::string();
+  };
+
+  EXPECT_EQ(LookupInNewCompilation(42), "/b/x.h");
+
+  // Within the build session the include map is trusted, so a header that
+  // appears earlier in the search path goes unnoticed...
+  VFS->addFile("/a/x.h", 0, llvm::MemoryBuffer::getMemBuffer(""));
+  EXPECT_EQ(LookupInNewCompilation(42), "/b/x.h");
+
+  // ...but the next build session searches again.
+  EXPECT_EQ(LookupInNewCompilation(43), "/a/x.h");
+  EXPECT_EQ(LookupInNewCompilation(43), "/a/x.h");
+
+  llvm::sys::fs::remove_directories(MapDir);
+}
+
 } // namespace
 } // namespace clang
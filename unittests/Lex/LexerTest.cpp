@@ -516,4 +516,79 @@ TEST_F(LexerTest, StringizingRasString) {
   EXPECT_EQ(String6, R"(a\\\n\n\n    \\\\b)");
 }
 
+TEST_F(LexerTest, SkipLongCommentsAndWhitespace) {
+  // Exercise the vectorized scanners at every offset relative to a vector
+  // chunk, and make sure escaped newlines are still honored in // comments.
+  for (unsigned Pad = 0; Pad != 70; ++Pad) {
+    std::string Source = std::string(Pad, ' ') + "// " +
+                         std::string(Pad, 'x') + "\\\n continued\n" +
+                         "a /*" + std::string(Pad, '*') + " / " +
+                         std::string(Pad, '-') + "*/ b" +
+                         std::string(Pad, '\t') + "\f c\n" +
+                         std::string(Pad, '\n') + "d";
+    std::vector<Token> Toks =
+        CheckLex(Source, {tok::identifier, tok::identifier, tok::identifier,
+                          tok::identifier});
+    if (Toks.size() != 4)
+      continue;
+    EXPECT_TRUE(Toks[0].isAtStartOfLine());
+    EXPECT_TRUE(Toks[1].hasLeadingSpace());
+    EXPECT_TRUE(Toks[2].hasLeadingSpace());
+    EXPECT_FALSE(Toks[2].isAtStartOfLine());
+    EXPECT_TRUE(Toks[3].isAtStartOfLine());
+    EXPECT_EQ("d", getSourceText(Toks[3], Toks[3]));
+  }
+}
+
+TEST_F(LexerTest, LongIdentifiersAndNumbers) {
+  LangOpts.C99 = true;
+  LangOpts.DollarIdents = true;
+  for (unsigned Len = 1; Len != 70; ++Len) {
+    std::string Ident(Len, 'x');
+    for (unsigned I = 0; I != Len; ++I)
+      Ident[I] = "aZ_09"[I % 5];
+    Ident[0] = 'i';
+
+    // The fast scan must hand '$' and UCNs over to the slow path.
+    std::string Source = Ident + "$" + Ident + "\\u00e9" + Ident + " " +
+                         "1" + Ident + ".e+" + Ident + " " + Ident;
+    std::vector<Token> Toks = CheckLex(
+        Source, {tok::identifier, tok::numeric_constant, tok::identifier});
+    if (Toks.size() != 3)
+      continue;
+    EXPECT_EQ(Ident + "$" + Ident + "\\u00e9" + Ident,
+              getSourceText(Toks[0], Toks[0]));
+    EXPECT_EQ("1" + Ident + ".e+" + Ident, getSourceText(Toks[1], Toks[1]));
+    EXPECT_EQ(Ident, getSourceText(Toks[2], Toks[2]));
+  }
+}
+
+TEST_F(LexerTest, GetSpellingRefCachesCleanedTokens) {
+  TrivialModuleLoader ModLoader;
+  auto PP = CreatePP("1\\\n23 \"a\\\nb\" c", ModLoader);
+
+  Token Number, String, Ident;
+  PP->Lex(Number);
+  PP->Lex(String);
+  PP->Lex(Ident);
+  ASSERT_TRUE(Number.needsCleaning());
+  ASSERT_TRUE(String.needsCleaning());
+  ASSERT_FALSE(Ident.needsCleaning());
+
+  StringRef NumberSpelling = PP->getSpellingRef(Number);
+  EXPECT_EQ("123", NumberSpelling);
+  EXPECT_EQ('\0', NumberSpelling.end()[0]);
+  EXPECT_EQ(NumberSpelling.data(), PP->getSpellingRef(Number).data());
+
+  SmallVector<char, 8> Buffer;
+  StringRef StringSpelling = PP->getSpelling(String, Buffer);
+  EXPECT_EQ("\"ab\"", StringSpelling);
+  EXPECT_EQ(StringSpelling.data(), PP->getSpellingRef(String).data());
+
+  StringRef IdentSpelling = PP->getSpellingRef(Ident);
+  EXPECT_EQ("c", IdentSpelling);
+  EXPECT_EQ(SourceMgr.getCharacterData(Ident.getLocation()),
+            IdentSpelling.data());
+}
+
 } // anonymous namespace
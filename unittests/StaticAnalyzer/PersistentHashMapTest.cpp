@@ -0,0 +1,102 @@
+//===- unittest/StaticAnalyzer/PersistentHashMapTest.cpp ------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/StaticAnalyzer/Core/PathSensitive/PersistentHashMap.h"
+#include "gtest/gtest.h"
+#include <set>
+
+namespace clang {
+namespace ento {
+namespace {
+
+using IntMap = PersistentHashMap<unsigned, unsigned>;
+
+TEST(PersistentHashMap, AddLookupRemove) {
+  IntMap::Factory F;
+  IntMap Empty = F.getEmptyMap();
+  EXPECT_TRUE(Empty.isEmpty());
+  EXPECT_EQ(nullptr, Empty.lookup(1));
+
+  IntMap M1 = F.add(Empty, 1, 10);
+  IntMap M2 = F.add(M1, 2, 20);
+  IntMap M3 = F.add(M2, 1, 11);
+  EXPECT_TRUE(Empty.isEmpty());
+  ASSERT_NE(nullptr, M1.lookup(1));
+  EXPECT_EQ(10U, *M1.lookup(1));
+  EXPECT_FALSE(M1.contains(2));
+  EXPECT_EQ(10U, *M2.lookup(1));
+  EXPECT_EQ(20U, *M2.lookup(2));
+  EXPECT_EQ(11U, *M3.lookup(1));
+  EXPECT_EQ(20U, *M3.lookup(2));
+
+  IntMap M4 = F.remove(M3, 1);
+  EXPECT_FALSE(M4.contains(1));
+  EXPECT_EQ(20U, *M4.lookup(2));
+  EXPECT_EQ(M4, F.remove(M4, 1));
+  EXPECT_EQ(Empty, F.remove(M4, 2));
+}
+
+TEST(PersistentHashMap, MapsWithTheSameContentsAreUniqued) {
+  IntMap::Factory F;
+  const unsigned N = 5000;
+
+  IntMap Forward = F.getEmptyMap();
+  for (unsigned I = 0; I != N; ++I)
+    Forward = F.add(Forward, I, I * 3);
+  IntMap Backward = F.getEmptyMap();
+  for (unsigned I = N; I != 0; --I)
+    Backward = F.add(Backward, I - 1, I * 7);
+  for (unsigned I = N; I != 0; --I)
+    Backward = F.add(Backward, I - 1, (I - 1) * 3);
+  EXPECT_EQ(Forward, Backward);
+  EXPECT_EQ(Forward, F.add(Forward, 42, 42 * 3));
+  EXPECT_NE(Forward, F.add(Forward, 42, 0));
+
+  for (unsigned I = 0; I != N; ++I) {
+    ASSERT_NE(nullptr, Forward.lookup(I));
+    EXPECT_EQ(I * 3, *Forward.lookup(I));
+  }
+  EXPECT_FALSE(Forward.contains(N));
+
+  // Removing the entries in any order brings back the maps they were added
+  // to.
+  IntMap Half = F.getEmptyMap();
+  for (unsigned I = 0; I != N; I += 2)
+    Half = F.add(Half, I, I * 3);
+  IntMap Removed = Forward;
+  for (unsigned I = N - 1; I < N; I -= 2)
+    Removed = F.remove(Removed, I);
+  EXPECT_EQ(Half, Removed);
+  for (unsigned I = 0; I != N; I += 2)
+    Removed = F.remove(Removed, I);
+  EXPECT_TRUE(Removed.isEmpty());
+}
+
+TEST(PersistentHashMap, IterateAllEntries) {
+  IntMap::Factory F;
+  IntMap M = F.getEmptyMap();
+  EXPECT_TRUE(M.begin() == M.end());
+
+  std::set<unsigned> Keys;
+  for (unsigned I = 0; I != 1000; ++I) {
+    M = F.add(M, I * 17, I);
+    Keys.insert(I * 17);
+  }
+
+  std::set<unsigned> Seen;
+  for (const auto &Entry : M) {
+    EXPECT_EQ(Entry.first, Entry.second * 17);
+    EXPECT_TRUE(Seen.insert(Entry.first).second);
+  }
+  EXPECT_EQ(Keys, Seen);
+}
+
+} // namespace
+} // namespace ento
+} // namespace clang
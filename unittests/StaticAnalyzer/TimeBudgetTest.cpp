@@ -0,0 +1,79 @@
+//===- unittests/StaticAnalyzer/TimeBudgetTest.cpp ------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/MultiplexConsumer.h"
+#include "clang/StaticAnalyzer/Core/Checker.h"
+#include "clang/StaticAnalyzer/Core/CheckerRegistry.h"
+#include "clang/StaticAnalyzer/Core/PathSensitive/AnalysisManager.h"
+#include "clang/StaticAnalyzer/Core/PathSensitive/CheckerContext.h"
+#include "clang/StaticAnalyzer/Frontend/AnalysisConsumer.h"
+#include "clang/Tooling/Tooling.h"
+#include "gtest/gtest.h"
+#include <chrono>
+#include <thread>
+
+namespace clang {
+namespace ento {
+namespace {
+
+/// Records the share of the time budget of the translation unit that was
+/// used when the analysis of the first function ended.
+class TimeUsageChecker : public Checker<check::EndFunction> {
+public:
+  static double TUTimeUsage;
+
+  void checkEndFunction(const ReturnStmt *RS, CheckerContext &C) const {
+    if (TUTimeUsage < 0)
+      TUTimeUsage = C.getAnalysisManager().getTUTimeUsage();
+  }
+};
+
+double TimeUsageChecker::TUTimeUsage = -1;
+
+/// Stands in for a translation unit that takes long to parse.
+class SlowParseConsumer : public ASTConsumer {
+public:
+  bool HandleTopLevelDecl(DeclGroupRef D) override {
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    return true;
+  }
+};
+
+class TimeBudgetAction : public ASTFrontendAction {
+public:
+  std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &Compiler,
+                                                 StringRef File) override {
+    std::unique_ptr<AnalysisASTConsumer> AnalysisConsumer =
+        CreateAnalysisConsumer(Compiler);
+    Compiler.getAnalyzerOpts()->CheckersControlList = {
+        {"custom.TimeUsageChecker", true}};
+    Compiler.getAnalyzerOpts()->Config["max-tu-time"] = "1000";
+    AnalysisConsumer->AddCheckerRegistrationFn([](CheckerRegistry &Registry) {
+      Registry.addChecker<TimeUsageChecker>("custom.TimeUsageChecker",
+                                            "Description");
+    });
+    std::vector<std::unique_ptr<ASTConsumer>> Consumers;
+    Consumers.push_back(llvm::make_unique<SlowParseConsumer>());
+    Consumers.push_back(std::move(AnalysisConsumer));
+    return llvm::make_unique<MultiplexConsumer>(std::move(Consumers));
+  }
+};
+
+TEST(TimeBudget, TranslationUnitBudgetStartsAfterParsing) {
+  TimeUsageChecker::TUTimeUsage = -1;
+  EXPECT_TRUE(tooling::runToolOnCode(new TimeBudgetAction, "void f() {;}"));
+  // Parsing took half of the budget, none of which counts.
+  ASSERT_GE(TimeUsageChecker::TUTimeUsage, 0.0);
+  EXPECT_LT(TimeUsageChecker::TUTimeUsage, 0.5);
+}
+
+}
+}
+}
@@ -195,6 +195,24 @@ TEST(JSONCompilationDatabase, ArgumentsPreferredOverCommand) {
    EXPECT_EQ(Arguments, FoundCommand.CommandLine[0]) << ErrorMessage;
 }
 
+TEST(JSONCompilationDatabase, ReadsEscapesInPlainAndExtendedJSON) {
+  // The first database is plain JSON and is only scanned when loaded; the
+  // second one has a \u escape, which makes it go through the YAML parser.
+  for (StringRef Escape : {"\\t", "\\u0009"}) {
+    std::string ErrorMessage;
+    CompileCommand FoundCommand = findCompileArgsInJsonDatabase(
+        "//net/dir/file\"name",
+        ("[ {\"directory\": \"//net/dir\",\n"
+         "    \"arguments\": [\"clang\", \"-DA=\\\"" + Escape + "\\\"\"],\n"
+         "    \"file\": \"file\\\"name\"} ]").str(),
+        ErrorMessage);
+    EXPECT_EQ("//net/dir", FoundCommand.Directory) << ErrorMessage;
+    EXPECT_EQ("file\"name", FoundCommand.Filename) << ErrorMessage;
+    ASSERT_EQ(2u, FoundCommand.CommandLine.size()) << ErrorMessage;
+    EXPECT_EQ("-DA=\"\t\"", FoundCommand.CommandLine[1]) << ErrorMessage;
+  }
+}
+
 struct FakeComparator : public PathComparator {
   ~FakeComparator() override {}
   bool equivalent(StringRef FileA, StringRef FileB) const override {
@@ -708,6 +726,14 @@ TEST_F(InterpolateTest, Nearby) {
             "clang -D an/other/foo.cpp");
 }
 
+TEST_F(InterpolateTest, TiesBrokenByLowercasePrefix) {
+  add("Bbb/x.cpp");
+  add("aaa/x.cpp");
+  // Uppercase paths sort first, but the common prefix is still measured
+  // against the candidate's own path.
+  EXPECT_EQ(getCommand("aa/x.cpp"), "clang -D aaa/x.cpp");
+}
+
 TEST_F(InterpolateTest, Language) {
   add("dir/foo.cpp", "-std=c++17");
   add("dir/bar.c", "");
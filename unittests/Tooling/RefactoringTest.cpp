@@ -465,6 +465,53 @@ TEST_F(ReplacementTest, AdjacentReplacements) {
   EXPECT_EQ("xy", Context.getRewrittenText(ID));
 }
 
+TEST_F(ReplacementTest, ManyReplacements) {
+  std::string Code, Expected;
+  for (unsigned I = 0; I < 1000; ++I) {
+    Code += "int x;\n";
+    Expected += "long y" + std::to_string(I) + ";\n";
+  }
+  FileID ID = Context.createInMemoryFile("input.cpp", Code);
+  Replacements Replaces;
+  for (unsigned I = 0; I < 1000; ++I) {
+    auto Err = Replaces.add(Replacement(
+        Context.Sources, Context.getLocation(ID, I + 1, 1), 5,
+        "long y" + std::to_string(I)));
+    EXPECT_TRUE(!Err);
+    llvm::consumeError(std::move(Err));
+  }
+  EXPECT_TRUE(applyAllReplacements(Replaces, Context.Rewrite));
+  EXPECT_EQ(Expected, Context.getRewrittenText(ID));
+}
+
+// Verifies that locations in the original file still map correctly after all
+// replacements have been applied at once.
+TEST_F(ReplacementTest, EditAfterApplyingReplacements) {
+  FileID ID = Context.createInMemoryFile("input.cpp",
+                                         "line1\nline2\nline3\nline4");
+  Replacements Replaces = toReplacements(
+      {Replacement(Context.Sources, Context.getLocation(ID, 1, 1), 5, "l1"),
+       Replacement(Context.Sources, Context.getLocation(ID, 2, 1), 0, "new\n"),
+       Replacement(Context.Sources, Context.getLocation(ID, 3, 1), 5,
+                   "third")});
+  EXPECT_TRUE(applyAllReplacements(Replaces, Context.Rewrite));
+  EXPECT_FALSE(Context.Rewrite.InsertTextBefore(Context.getLocation(ID, 4, 1),
+                                                "// "));
+  EXPECT_EQ("l1\nnew\nline2\nthird\n// line4", Context.getRewrittenText(ID));
+}
+
+TEST_F(ReplacementTest, ApplyReplacementsToEditedFile) {
+  FileID ID = Context.createInMemoryFile("input.cpp",
+                                         "line1\nline2\nline3\nline4");
+  EXPECT_FALSE(Context.Rewrite.ReplaceText(Context.getLocation(ID, 1, 1), 5,
+                                           "first"));
+  Replacements Replaces = toReplacements(
+      {Replacement(Context.Sources, Context.getLocation(ID, 2, 1), 5, "two"),
+       Replacement(Context.Sources, Context.getLocation(ID, 4, 1), 0, "x")});
+  EXPECT_TRUE(applyAllReplacements(Replaces, Context.Rewrite));
+  EXPECT_EQ("first\ntwo\nline3\nxline4", Context.getRewrittenText(ID));
+}
+
 TEST_F(ReplacementTest, AddDuplicateReplacements) {
   FileID ID = Context.createInMemoryFile("input.cpp",
                                          "line1\nline2\nline3\nline4");
@@ -1030,6 +1077,21 @@ TEST_F(MergeReplacementsTest, OverlappingRanges) {
       toReplacements({{"", 0, 3, "cc"}, {"", 3, 3, "dd"}}));
 }
 
+TEST_F(MergeReplacementsTest, ManyReplacements) {
+  // Replace each 'a' with "bb", then the first 'b' of each pair with 'c'.
+  const unsigned N = 100000;
+  std::string Code(N, 'a'), Intermediate, Result;
+  std::set<Replacement> First, Second;
+  for (unsigned I = 0; I < N; ++I) {
+    First.insert({"", I, 1, "bb"});
+    Second.insert({"", 2 * I, 1, "c"});
+    Intermediate += "bb";
+    Result += "cb";
+  }
+  mergeAndTestRewrite(Code, Intermediate, Result, toReplacements(First),
+                      toReplacements(Second));
+}
+
 TEST(DeduplicateByFileTest, PathsWithDots) {
   std::map<std::string, Replacements> FileToReplaces;
   llvm::IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> VFS(
@@ -0,0 +1,83 @@
+//===- unittest/Tooling/SharedFileSystemCacheTest.cpp ---------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Tooling/SharedFileSystemCache.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "gtest/gtest.h"
+
+namespace clang {
+namespace tooling {
+
+namespace {
+
+class SharedFileSystemCacheTest : public ::testing::Test {
+protected:
+  SharedFileSystemCacheTest()
+      : Cache(std::make_shared<SharedFileSystemCache>()),
+        InMemoryFS(new llvm::vfs::InMemoryFileSystem) {
+    InMemoryFS->setCurrentWorkingDirectory("/");
+    InMemoryFS->addFile("/include/header.h", 0,
+                        llvm::MemoryBuffer::getMemBuffer("int x;"));
+    InMemoryFS->addFile("/src/main.cpp", 0,
+                        llvm::MemoryBuffer::getMemBuffer("#include \"h\""));
+  }
+
+  std::shared_ptr<SharedFileSystemCache> Cache;
+  IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> InMemoryFS;
+};
+
+TEST_F(SharedFileSystemCacheTest, SharesContentsAcrossFileSystems) {
+  SharedCachingFileSystem FS1(Cache, InMemoryFS);
+  SharedCachingFileSystem FS2(Cache, InMemoryFS);
+
+  auto Buffer1 = FS1.getBufferForFile("/include/header.h");
+  ASSERT_TRUE(bool(Buffer1));
+  auto Buffer2 = FS2.getBufferForFile("/include/header.h");
+  ASSERT_TRUE(bool(Buffer2));
+  EXPECT_EQ("int x;", (*Buffer2)->getBuffer());
+  EXPECT_EQ((*Buffer1)->getBufferStart(), (*Buffer2)->getBufferStart());
+}
+
+TEST_F(SharedFileSystemCacheTest, WorkingDirectoryIsPerFileSystem) {
+  SharedCachingFileSystem FS1(Cache, InMemoryFS);
+  SharedCachingFileSystem FS2(Cache, InMemoryFS);
+  ASSERT_FALSE(FS1.setCurrentWorkingDirectory("/include"));
+  ASSERT_FALSE(FS2.setCurrentWorkingDirectory("/src"));
+
+  auto Stat1 = FS1.status("header.h");
+  ASSERT_TRUE(bool(Stat1));
+  EXPECT_EQ("header.h", Stat1->getName());
+  EXPECT_FALSE(bool(FS2.status("header.h")));
+
+  auto Buffer1 = FS1.getBufferForFile("header.h");
+  auto Buffer2 = FS2.getBufferForFile("../include/header.h");
+  ASSERT_TRUE(bool(Buffer1));
+  ASSERT_TRUE(bool(Buffer2));
+  EXPECT_EQ("int x;", (*Buffer2)->getBuffer());
+
+  auto CWD = InMemoryFS->getCurrentWorkingDirectory();
+  ASSERT_TRUE(bool(CWD));
+  EXPECT_EQ("/", *CWD);
+}
+
+TEST_F(SharedFileSystemCacheTest, MissesAreNotCached) {
+  SharedCachingFileSystem FS(Cache, InMemoryFS);
+  EXPECT_FALSE(bool(FS.status("/include/new.h")));
+
+  InMemoryFS->addFile("/include/new.h", 0,
+                      llvm::MemoryBuffer::getMemBuffer("int y;"));
+  auto Buffer = FS.getBufferForFile("/include/new.h");
+  ASSERT_TRUE(bool(Buffer));
+  EXPECT_EQ("int y;", (*Buffer)->getBuffer());
+}
+
+} // end anonymous namespace
+
+} // end namespace tooling
+} // end namespace clang
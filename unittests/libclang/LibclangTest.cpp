@@ -9,6 +9,7 @@
 
 #include "clang-c/Index.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Config/llvm-config.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
@@ -19,6 +20,7 @@
 #include <map>
 #include <memory>
 #include <set>
+#include <thread>
 #define DEBUG_TYPE "libclang-test"
 
 TEST(libclang, clang_parseTranslationUnit2_InvalidArgs) {
@@ -461,6 +463,61 @@ TEST_F(LibclangParseTest, AllSkippedRanges) {
   clang_disposeSourceRangeList(Ranges);
 }
 
+#if LLVM_ENABLE_THREADS
+TEST_F(LibclangParseTest, ConcurrentTranslationUnitsShareFileSystemCache) {
+  clang_CXIndex_setGlobalOptions(Index, clang_CXIndex_getGlobalOptions(Index) |
+                                            CXGlobalOpt_ShareFileSystemCache);
+  EXPECT_TRUE(clang_CXIndex_getGlobalOptions(Index) &
+              CXGlobalOpt_ShareFileSystemCache);
+
+  std::string Header = "shared.h";
+  WriteFile(Header, "struct Shared { int member; };\n");
+
+  const unsigned NumTUs = 8;
+  std::vector<std::string> Mains;
+  for (unsigned I = 0; I != NumTUs; ++I) {
+    std::string Main = "main" + std::to_string(I) + ".c";
+    WriteFile(Main, "#include \"shared.h\"\n"
+                    "int f(struct Shared *S) { return S->member; }\n");
+    Mains.push_back(Main);
+  }
+
+  // Parse, reparse and code-complete every translation unit on its own
+  // thread, all from the same index.
+  std::vector<CXTranslationUnit> TUs(NumTUs);
+  std::vector<unsigned> NumDiags(NumTUs), NumResults(NumTUs);
+  std::vector<std::thread> Threads;
+  for (unsigned I = 0; I != NumTUs; ++I)
+    Threads.emplace_back([&, I] {
+      CXTranslationUnit TU = clang_parseTranslationUnit(
+          Index, Mains[I].c_str(), nullptr, 0, nullptr, 0, TUFlags);
+      if (!TU)
+        return;
+      TUs[I] = TU;
+      if (clang_reparseTranslationUnit(TU, 0, nullptr,
+                                       clang_defaultReparseOptions(TU)))
+        return;
+      NumDiags[I] = clang_getNumDiagnostics(TU);
+      CXCodeCompleteResults *Results = clang_codeCompleteAt(
+          TU, Mains[I].c_str(), 2, 37, nullptr, 0,
+          clang_defaultCodeCompleteOptions());
+      if (Results) {
+        NumResults[I] = Results->NumResults;
+        clang_disposeCodeCompleteResults(Results);
+      }
+    });
+  for (std::thread &T : Threads)
+    T.join();
+
+  for (unsigned I = 0; I != NumTUs; ++I) {
+    ASSERT_TRUE(TUs[I]);
+    EXPECT_EQ(0U, NumDiags[I]);
+    EXPECT_EQ(1U, NumResults[I]);
+    clang_disposeTranslationUnit(TUs[I]);
+  }
+}
+#endif
+
 class LibclangReparseTest : public LibclangParseTest {
 public:
   void DisplayDiagnostics() {
@@ -529,6 +586,79 @@ TEST_F(LibclangReparseTest, Reparse) {
   EXPECT_EQ(0U, clang_getNumDiagnostics(ClangTU));
 }
 
+TEST_F(LibclangReparseTest, AsyncReparseCancelsStaleReparses) {
+  std::string CppName = "main.cpp";
+  WriteFile(CppName, "int main() { return undeclared; }\n");
+  ClangTU = clang_parseTranslationUnit(Index, CppName.c_str(), nullptr, 0,
+                                       nullptr, 0, TUFlags);
+  ASSERT_TRUE(ClangTU);
+  EXPECT_EQ(1U, clang_getNumDiagnostics(ClangTU));
+  EXPECT_EQ(0U, clang_getTranslationUnitGeneration(ClangTU));
+
+  std::string Fixed = "int undeclared;\nint main() { return undeclared; }\n";
+  CXUnsavedFile Unsaved = {CppName.c_str(), Fixed.c_str(), Fixed.size()};
+
+  // The second reparse makes the first one stale, so the first one either
+  // finished before it was cancelled or reports the cancellation.
+  CXReparseTask First = clang_reparseTranslationUnitAsync(
+      ClangTU, 0, nullptr, clang_defaultReparseOptions(ClangTU));
+  CXReparseTask Second = clang_reparseTranslationUnitAsync(
+      ClangTU, 1, &Unsaved, clang_defaultReparseOptions(ClangTU));
+  ASSERT_TRUE(First);
+  ASSERT_TRUE(Second);
+  EXPECT_LT(clang_ReparseTask_getGeneration(First),
+            clang_ReparseTask_getGeneration(Second));
+
+  int FirstResult = clang_ReparseTask_wait(First);
+  EXPECT_TRUE(FirstResult == CXError_Success ||
+              FirstResult == CXError_Cancelled);
+  EXPECT_EQ(CXError_Success, clang_ReparseTask_wait(Second));
+  EXPECT_TRUE(clang_ReparseTask_isFinished(Second));
+  EXPECT_EQ(clang_ReparseTask_getGeneration(Second),
+            clang_getTranslationUnitGeneration(ClangTU));
+  EXPECT_EQ(0U, clang_getNumDiagnostics(ClangTU));
+  clang_ReparseTask_dispose(First);
+  clang_ReparseTask_dispose(Second);
+
+  // A reparse that is cancelled before it starts running leaves the unit as
+  // it was, and a cancelled unit can still be reparsed.
+  CXReparseTask Cancelled = clang_reparseTranslationUnitAsync(
+      ClangTU, 1, &Unsaved, clang_defaultReparseOptions(ClangTU));
+  clang_ReparseTask_cancel(Cancelled);
+  int CancelledResult = clang_ReparseTask_wait(Cancelled);
+  EXPECT_TRUE(CancelledResult == CXError_Success ||
+              CancelledResult == CXError_Cancelled);
+  clang_ReparseTask_dispose(Cancelled);
+  ASSERT_TRUE(ReparseTU(1, &Unsaved));
+  EXPECT_EQ(0U, clang_getNumDiagnostics(ClangTU));
+}
+
+TEST_F(LibclangReparseTest, SyncReparseCancelsStaleReparses) {
+  std::string CppName = "main.cpp";
+  WriteFile(CppName, "int main() { return undeclared; }\n");
+  ClangTU = clang_parseTranslationUnit(Index, CppName.c_str(), nullptr, 0,
+                                       nullptr, 0, TUFlags);
+  ASSERT_TRUE(ClangTU);
+  EXPECT_EQ(1U, clang_getNumDiagnostics(ClangTU));
+
+  std::string Fixed = "int undeclared;\nint main() { return undeclared; }\n";
+  CXUnsavedFile Unsaved = {CppName.c_str(), Fixed.c_str(), Fixed.size()};
+
+  // Whichever of them takes the unit first, the result of the synchronous
+  // reparse, which was started last, is the one that's left.
+  CXReparseTask Stale = clang_reparseTranslationUnitAsync(
+      ClangTU, 0, nullptr, clang_defaultReparseOptions(ClangTU));
+  ASSERT_TRUE(Stale);
+  ASSERT_TRUE(ReparseTU(1, &Unsaved));
+  int StaleResult = clang_ReparseTask_wait(Stale);
+  EXPECT_TRUE(StaleResult == CXError_Success ||
+              StaleResult == CXError_Cancelled);
+  EXPECT_LT(clang_ReparseTask_getGeneration(Stale),
+            clang_getTranslationUnitGeneration(ClangTU));
+  EXPECT_EQ(0U, clang_getNumDiagnostics(ClangTU));
+  clang_ReparseTask_dispose(Stale);
+}
+
 TEST_F(LibclangReparseTest, ReparseWithModule) {
   const char *HeaderTop = "#ifndef H\n#define H\nstruct Foo { int bar;";
   const char *HeaderBottom = "\n};\n#endif\n";
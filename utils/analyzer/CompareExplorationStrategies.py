@@ -0,0 +1,94 @@
+#!/usr/bin/env python
+
+"""
+Script to compare the coverage that the exploration strategies of the static
+analyzer reach within the same node budgets.
+
+Each source file is analyzed once for every strategy and every budget, and the
+share of the basic blocks of the analyzed functions that were visited is
+reported. The statistics are only available from builds of clang with
+assertions enabled (or LLVM_ENABLE_STATS).
+
+Usage:
+
+    CompareExplorationStrategies.py [--clang PATH] [--max-nodes N,N,...]
+        [--strategies S,S,...] file... [-- compiler arguments]
+"""
+
+from __future__ import print_function
+
+import argparse
+import subprocess
+import sys
+
+Strategies = [
+    "dfs",
+    "bfs",
+    "bfs_block_dfs_contents",
+    "unexplored_first",
+    "unexplored_first_queue",
+    "unexplored_first_location_queue",
+    "coverage_guided_queue",
+]
+
+Statistics = {
+    "Blocks": "The # of basic blocks in the analyzed functions.",
+    "Visited": "The # of visited basic blocks in the analyzed functions.",
+    "Steps": "The # of steps executed.",
+}
+
+
+def runAnalyzer(Clang, File, Strategy, MaxNodes, ExtraArgs):
+    """Analyze File and return the sums of the statistics we compare."""
+    Cmd = [Clang, "--analyze", "-o", "/dev/null",
+           "-Xclang", "-analyzer-stats",
+           "-Xclang", "-analyzer-config",
+           "-Xclang", "exploration_strategy=%s,max-nodes=%d" % (Strategy,
+                                                                MaxNodes),
+           File] + ExtraArgs
+    Output = subprocess.check_output(Cmd, stderr=subprocess.STDOUT)
+    Totals = dict((Name, 0) for Name in Statistics)
+    for Line in Output.decode("utf-8", "replace").splitlines():
+        for Name, Description in Statistics.items():
+            if Line.strip().endswith(Description):
+                Totals[Name] += int(Line.split()[0])
+    return Totals
+
+
+def main():
+    Args = sys.argv[1:]
+    ExtraArgs = []
+    if "--" in Args:
+        ExtraArgs = Args[Args.index("--") + 1:]
+        Args = Args[:Args.index("--")]
+
+    Parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    Parser.add_argument("--clang", default="clang",
+                        help="the clang binary to run")
+    Parser.add_argument("--max-nodes", default="1000,10000,100000",
+                        help="comma separated node budgets")
+    Parser.add_argument("--strategies", default=",".join(Strategies),
+                        help="comma separated exploration strategies")
+    Parser.add_argument("files", nargs="+")
+    Opts = Parser.parse_args(Args)
+
+    Budgets = [int(N) for N in Opts.max_nodes.split(",")]
+    print("%-34s %10s %10s %10s %10s" % ("Strategy", "Max nodes", "Blocks",
+                                         "Coverage", "Steps"))
+    for Strategy in Opts.strategies.split(","):
+        for MaxNodes in Budgets:
+            Totals = dict((Name, 0) for Name in Statistics)
+            for File in Opts.files:
+                for Name, Value in runAnalyzer(Opts.clang, File, Strategy,
+                                               MaxNodes, ExtraArgs).items():
+                    Totals[Name] += Value
+            Coverage = 0.0
+            if Totals["Blocks"]:
+                Coverage = 100.0 * Totals["Visited"] / Totals["Blocks"]
+            print("%-34s %10d %10d %9.2f%% %10d" % (
+                Strategy, MaxNodes, Totals["Blocks"], Coverage,
+                Totals["Steps"]))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,109 @@
+#!/usr/bin/env python
+
+"""Report what the headers of a build cost, from the header lists that clang
+prints with -H, or with /showIncludes.
+
+To collect the header lists of a whole build, have every compilation append
+its list to one file, eg.:
+
+  CC_PRINT_HEADERS=1 CC_PRINT_HEADERS_FILE=/tmp/headers make
+
+and then run:
+
+  header-cost.py /tmp/headers
+
+For each header, this prints how many times it was included, how many of
+those inclusions were direct ones from a main file, its size in bytes and
+lines, and the bytes that the build read for it in total. The headers that
+cost the most come first, since they are the ones worth cleaning up first."""
+
+from __future__ import print_function
+
+import argparse
+import os
+import re
+import sys
+
+# '. path', '.. path', ... as printed by -H, or 'Note: including file: path'
+# with one more space of indentation for each level, as by /showIncludes.
+GNU_LINE = re.compile(r'^(\.+) (.*)$')
+MS_LINE = re.compile(r'^Note: including file:( +)(.*)$')
+
+
+def parse_line(line):
+    """Returns the depth and path of a header list line, or None."""
+    match = GNU_LINE.match(line)
+    if not match:
+        match = MS_LINE.match(line)
+    if not match:
+        return None
+    return len(match.group(1)), match.group(2).strip()
+
+
+class Header(object):
+    def __init__(self, path):
+        self.path = path
+        self.times_included = 0
+        self.times_included_directly = 0
+        self.bytes = 0
+        self.lines = 0
+        try:
+            with open(path, 'rb') as handle:
+                contents = handle.read()
+            self.bytes = len(contents)
+            self.lines = contents.count(b'\n')
+        except (IOError, OSError):
+            pass
+
+    def total_bytes(self):
+        return self.bytes * self.times_included
+
+
+def collect(files):
+    headers = dict()
+    for name in files:
+        with open(name, 'r') as handle:
+            for line in handle:
+                parsed = parse_line(line.rstrip('\r\n'))
+                if not parsed:
+                    continue
+                depth, path = parsed
+                path = os.path.normpath(path)
+                header = headers.get(path)
+                if header is None:
+                    header = headers[path] = Header(path)
+                header.times_included += 1
+                if depth == 1:
+                    header.times_included_directly += 1
+    return headers
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('files', metavar='FILE', nargs='+',
+                        help='a file with the header lists of compilations')
+    parser.add_argument('-n', '--max-headers', type=int, default=50,
+                        help='the number of headers to report (default: 50, '
+                             '0 to report all of them)')
+    args = parser.parse_args()
+
+    headers = sorted(collect(args.files).values(),
+                     key=lambda header: (-header.total_bytes(), header.path))
+    if args.max_headers:
+        headers = headers[:args.max_headers]
+
+    print('%12s %8s %8s %10s %8s  %s' % ('total bytes', 'included',
+                                         'directly', 'bytes', 'lines',
+                                         'header'))
+    for header in headers:
+        print('%12d %8d %8d %10d %8d  %s' % (header.total_bytes(),
+                                             header.times_included,
+                                             header.times_included_directly,
+                                             header.bytes, header.lines,
+                                             header.path))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
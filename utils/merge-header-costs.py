@@ -0,0 +1,82 @@
+#!/usr/bin/env python
+
+"""Merge the header costs that clang writes with -header-cost-file, one file
+per translation unit, into the costs of a whole build.
+
+For each file, this sums the preprocessing time, tokens, declarations,
+instantiations and IR instructions over all translation units, and counts the
+translation units that include it. The files that cost the most in total come
+first: a header that is expensive and included by many translation units is a
+good candidate for a precompiled header or a module.
+
+For example, to collect the costs of a build and report the worst headers:
+
+  make CXXFLAGS='-Xclang -header-cost-file -Xclang $@.cost.json'
+  merge-header-costs.py $(find . -name '*.cost.json')"""
+
+from __future__ import print_function
+
+import argparse
+import json
+import sys
+
+COSTS = ['seconds', 'tokens', 'decls', 'instantiations', 'ir-instructions']
+
+
+def merge(files):
+    merged = dict()
+    for name in files:
+        with open(name, 'r') as handle:
+            unit = json.load(handle)
+        main_file = unit.get('main-file')
+        for cost in unit.get('files', []):
+            path = cost['file']
+            total = merged.get(path)
+            if total is None:
+                total = merged[path] = dict((key, 0) for key in COSTS)
+                total['file'] = path
+                total['translation-units'] = 0
+            for key in COSTS:
+                total[key] += cost.get(key, 0)
+            if path != main_file:
+                total['translation-units'] += 1
+    return merged
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('files', metavar='FILE', nargs='+',
+                        help='a file that -header-cost-file wrote')
+    parser.add_argument('-o', '--output', metavar='FILE',
+                        help='write the merged costs to FILE, in JSON, '
+                             'instead of reporting them')
+    parser.add_argument('-s', '--sort', choices=COSTS, default='seconds',
+                        help='the cost to sort by (default: seconds)')
+    parser.add_argument('-n', '--max-files', type=int, default=50,
+                        help='the number of files to report (default: 50, '
+                             '0 to report all of them)')
+    args = parser.parse_args()
+
+    costs = sorted(merge(args.files).values(),
+                   key=lambda cost: (-cost[args.sort], cost['file']))
+    if args.output:
+        with open(args.output, 'w') as handle:
+            json.dump({'files': costs}, handle, indent=2, sort_keys=True)
+        return 0
+
+    if args.max_files:
+        costs = costs[:args.max_files]
+    print('%10s %10s %8s %8s %10s %6s  %s' % ('seconds', 'tokens', 'decls',
+                                              'insts', 'ir-insts', 'TUs',
+                                              'file'))
+    for cost in costs:
+        print('%10.3f %10d %8d %8d %10d %6d  %s' % (
+              cost['seconds'], cost['tokens'], cost['decls'],
+              cost['instantiations'], cost['ir-instructions'],
+              cost['translation-units'], cost['file']))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
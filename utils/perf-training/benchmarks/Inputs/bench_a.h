@@ -0,0 +1,18 @@
+#ifndef BENCH_A_H
+#define BENCH_A_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace bench_a {
+template <int N> int total() {
+  std::vector<int> V(N);
+  int S = 0;
+  for (int I : V)
+    S += I;
+  return S;
+}
+}
+
+#endif
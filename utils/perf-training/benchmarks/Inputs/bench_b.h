@@ -0,0 +1,14 @@
+#ifndef BENCH_B_H
+#define BENCH_B_H
+
+#include "bench_a.h"
+#include <set>
+
+namespace bench_b {
+inline int count() {
+  std::set<std::string> S = {"a", "b"};
+  return static_cast<int>(S.size()) + bench_a::total<8>();
+}
+}
+
+#endif
@@ -0,0 +1,73 @@
+// RUN: %bench --name=analyzer %clang --analyze -Xclang -analyzer-checker=core,unix,deadcode %s -o %t.plist
+
+// Path-sensitive analysis of branchy code, where the number of paths grows
+// quickly with the number of conditions.
+
+#include <stdlib.h>
+#include <string.h>
+
+struct buffer {
+  char *data;
+  size_t size;
+  size_t capacity;
+};
+
+static int grow(struct buffer *B, size_t Needed) {
+  if (B->capacity >= Needed)
+    return 0;
+  size_t NewCapacity = B->capacity ? B->capacity * 2 : 16;
+  while (NewCapacity < Needed)
+    NewCapacity *= 2;
+  char *NewData = realloc(B->data, NewCapacity);
+  if (!NewData)
+    return -1;
+  B->data = NewData;
+  B->capacity = NewCapacity;
+  return 0;
+}
+
+int append(struct buffer *B, const char *S, int Flags) {
+  size_t Len = strlen(S);
+  if (Flags & 1)
+    Len /= 2;
+  if (Flags & 2)
+    ++Len;
+  if (Flags & 4)
+    Len += B->size;
+  if (grow(B, B->size + Len + 1))
+    return -1;
+  for (size_t I = 0; I != Len; ++I) {
+    char C = S[I % (strlen(S) + 1)];
+    if (Flags & 8)
+      C = C >= 'a' && C <= 'z' ? C - 'a' + 'A' : C;
+    if (Flags & 16)
+      C = C == ' ' ? '_' : C;
+    if (Flags & 32 && C == '\0')
+      break;
+    B->data[B->size++] = C;
+  }
+  B->data[B->size] = '\0';
+  return 0;
+}
+
+int process(const char **Strings, int N, int Flags) {
+  struct buffer B = {0, 0, 0};
+  int Result = 0;
+  for (int I = 0; I < N; ++I) {
+    int F = Flags;
+    if (I % 2)
+      F ^= 1;
+    if (I % 3)
+      F ^= 2;
+    if (I % 5)
+      F ^= 8;
+    if (append(&B, Strings[I], F)) {
+      Result = -1;
+      break;
+    }
+  }
+  if (B.data && Result == 0)
+    Result = (int)B.size;
+  free(B.data);
+  return Result;
+}
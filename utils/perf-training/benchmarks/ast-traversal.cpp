@@ -0,0 +1,11 @@
+// RUN: %gen_bench_input expressions 4000 > %t.h
+// RUN: %bench --name=ast-traversal-syntax %clang_cpp -fsyntax-only -include %t.h %s
+// RUN: %bench --name=ast-traversal-dump %clang_cpp -fsyntax-only -Xclang -ast-dump -include %t.h %s
+// RUN: %bench --name=ast-traversal-index %c_index_test -index-file %s -include %t.h
+
+// Walk a large translation unit whose function bodies are long operator
+// chains and deeply nested calls. The -fsyntax-only run is the baseline that
+// the AST dump and the RecursiveASTVisitor-based indexer are measured
+// against.
+
+int main() { return sum0(0, V()); }
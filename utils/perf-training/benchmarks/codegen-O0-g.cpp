@@ -0,0 +1,49 @@
+// RUN: %bench --name=codegen-O0-g %clang_cpp -std=c++14 -O0 -g -c %s -o %t.o
+
+// Debug builds spend most of their time in IR and debug info generation for
+// the many small functions that templates instantiate.
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+template <int N> struct Node {
+  std::vector<std::unique_ptr<Node<N - 1>>> Children;
+  std::map<std::string, int> Attributes;
+  int sum() const {
+    int S = 0;
+    for (const auto &C : Children)
+      S += C->sum();
+    for (const auto &A : Attributes)
+      S += A.second;
+    return S;
+  }
+};
+template <> struct Node<0> {
+  int sum() const { return 0; }
+};
+
+template <class K, class V> V lookup(const std::unordered_map<K, V> &M, K Key) {
+  auto I = M.find(Key);
+  return I == M.end() ? V() : I->second;
+}
+
+int run(int Argc) {
+  Node<8> Root;
+  std::unordered_map<std::string, std::function<int(int)>> Handlers;
+  Handlers["double"] = [](int X) { return 2 * X; };
+  Handlers["square"] = [](int X) { return X * X; };
+  std::vector<std::string> Names = {"double", "square"};
+  std::sort(Names.begin(), Names.end());
+  int R = Root.sum();
+  for (const std::string &Name : Names)
+    if (auto F = lookup(Handlers, Name))
+      R += F(Argc);
+  std::unordered_map<int, std::string> Rev;
+  Rev[R] = "result";
+  return R + static_cast<int>(lookup(Rev, R).size());
+}
@@ -0,0 +1,5 @@
+// RUN: %gen_bench_input macros 20000 > %t.h
+// RUN: %bench --name=lexer-macros-E %clang -E -include %t.h %s -o %t.i
+// RUN: %bench --name=lexer-macros-syntax %clang -fsyntax-only -include %t.h %s
+
+int main(void) { return M63(V63) != 0; }
@@ -0,0 +1,8 @@
+// RUN: rm -rf %t.cache
+// RUN: %bench --name=modules-build %clang_cpp -std=c++14 -fsyntax-only -fmodules -fimplicit-module-maps -fmodules-cache-path=%t.cache -I %S/Inputs %s
+// RUN: %bench --name=modules-load %clang_cpp -std=c++14 -fsyntax-only -fmodules -fimplicit-module-maps -fmodules-cache-path=%t.cache -I %S/Inputs %s
+
+#include "bench_a.h"
+#include "bench_b.h"
+
+int main() { return bench_a::total<64>() + bench_b::count(); }
@@ -0,0 +1,8 @@
+// RUN: %bench --name=pch-build %clang_cpp -std=c++14 -x c++-header %S/Inputs/pch.h -o %t.pch
+// RUN: %bench --name=pch-load %clang_cpp -std=c++14 -fsyntax-only -include-pch %t.pch %s
+
+int main() {
+  std::vector<std::string> V = {"a", "b"};
+  std::sort(V.begin(), V.end());
+  return static_cast<int>(V.size());
+}
@@ -0,0 +1,43 @@
+// RUN: %bench --name=sema-constexpr %clang_cpp -std=c++14 -fsyntax-only -fconstexpr-steps=100000000 %s
+
+// Constant evaluation of loops, arrays and recursion.
+
+constexpr unsigned count_primes(unsigned N) {
+  bool Composite[20000] = {};
+  unsigned Count = 0;
+  for (unsigned I = 2; I < N; ++I) {
+    if (Composite[I])
+      continue;
+    ++Count;
+    for (unsigned J = I * 2; J < N; J += I)
+      Composite[J] = true;
+  }
+  return Count;
+}
+
+constexpr unsigned long long collatz_steps(unsigned long long N) {
+  unsigned long long Steps = 0;
+  while (N != 1) {
+    N = N % 2 ? 3 * N + 1 : N / 2;
+    ++Steps;
+  }
+  return Steps;
+}
+
+constexpr unsigned long long longest_collatz(unsigned Limit) {
+  unsigned long long Best = 0;
+  for (unsigned I = 1; I < Limit; ++I)
+    if (collatz_steps(I) > Best)
+      Best = collatz_steps(I);
+  return Best;
+}
+
+constexpr unsigned ackermann(unsigned M, unsigned N) {
+  return M == 0 ? N + 1
+                : N == 0 ? ackermann(M - 1, 1)
+                         : ackermann(M - 1, ackermann(M, N - 1));
+}
+
+static_assert(count_primes(20000) == 2262, "");
+static_assert(longest_collatz(20000) == 278, "");
+static_assert(ackermann(2, 200) == 403, "");
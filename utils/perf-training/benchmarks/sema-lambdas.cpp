@@ -0,0 +1,76 @@
+// RUN: %bench --name=sema-lambdas %clang_cpp -std=c++17 -fsyntax-only %s
+
+// Range pipelines in the style of range-v3: every stage is a generic lambda
+// that returns more lambdas, so Sema keeps entering and leaving lambda and
+// function scopes, most of them nested.
+
+template <class F> struct view {
+  F Gen;
+  template <class G> auto operator|(G Stage) const { return Stage(*this); }
+};
+
+template <class F> view<F> make_view(F Gen) { return view<F>{Gen}; }
+
+inline auto iota(int N) {
+  return make_view([N](auto Sink) {
+    for (int I = 0; I != N; ++I)
+      if (!Sink(I))
+        return false;
+    return true;
+  });
+}
+
+inline auto transform = [](auto Fn) {
+  return [Fn](auto V) {
+    return make_view([Fn, V](auto Sink) {
+      return V.Gen([&](auto X) { return Sink(Fn(X)); });
+    });
+  };
+};
+
+inline auto filter = [](auto Pred) {
+  return [Pred](auto V) {
+    return make_view([Pred, V](auto Sink) {
+      return V.Gen([&](auto X) { return !Pred(X) || Sink(X); });
+    });
+  };
+};
+
+inline auto take = [](int N) {
+  return [N](auto V) {
+    return make_view([N, V](auto Sink) {
+      int Left = N;
+      return V.Gen([&](auto X) { return Left-- > 0 && Sink(X); });
+    });
+  };
+};
+
+template <class V> int sum(V View) {
+  int Total = 0;
+  View.Gen([&](auto X) {
+    Total += X;
+    return true;
+  });
+  return Total;
+}
+
+#define PIPELINE(K)                                                            \
+  int pipeline##K() {                                                          \
+    auto Square = [](auto X) { return X * X + K; };                            \
+    auto Odd = [](auto X) { return X % 2 != 0; };                              \
+    return sum(iota(100 + K) | transform(Square) | filter(Odd) |               \
+               transform([](auto X) { return [X] { return X; }(); }) |         \
+               take(K) | transform([](auto X) { return X / 3; }));             \
+  }
+#define PIPELINES10(K)                                                         \
+  PIPELINE(K##0) PIPELINE(K##1) PIPELINE(K##2) PIPELINE(K##3)                  \
+  PIPELINE(K##4) PIPELINE(K##5) PIPELINE(K##6) PIPELINE(K##7)                  \
+  PIPELINE(K##8) PIPELINE(K##9)
+#define PIPELINES100(K)                                                        \
+  PIPELINES10(K##0) PIPELINES10(K##1) PIPELINES10(K##2) PIPELINES10(K##3)      \
+  PIPELINES10(K##4) PIPELINES10(K##5) PIPELINES10(K##6) PIPELINES10(K##7)      \
+  PIPELINES10(K##8) PIPELINES10(K##9)
+
+PIPELINES100(1)
+PIPELINES100(2)
+PIPELINES100(3)
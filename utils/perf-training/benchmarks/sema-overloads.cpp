@@ -0,0 +1,10 @@
+// RUN: %gen_bench_input overloads 2000 > %t.h
+// RUN: %bench --name=sema-overloads %clang_cpp -std=c++11 -fsyntax-only -include %t.h %s
+
+// Resolve an overload set with thousands of candidates, most of which are
+// only viable through a user-defined conversion.
+
+void more_calls() {
+  for (int I = 0; I != 100; ++I)
+    f(I, I);
+}
@@ -0,0 +1,74 @@
+// RUN: %bench --name=sema-templates %clang_cpp -std=c++14 -fsyntax-only -ftemplate-depth=2048 %s
+
+// Template metaprogramming in the style of type list and tuple libraries:
+// deep recursive instantiation, large packs and many specializations.
+
+#include <cstddef>
+
+template <std::size_t... I> struct index_sequence {};
+
+template <std::size_t N, std::size_t... I>
+struct make_index_sequence_impl
+    : make_index_sequence_impl<N - 1, N - 1, I...> {};
+template <std::size_t... I> struct make_index_sequence_impl<0, I...> {
+  using type = index_sequence<I...>;
+};
+template <std::size_t N>
+using make_index_sequence = typename make_index_sequence_impl<N>::type;
+
+template <class... T> struct type_list {};
+
+template <std::size_t I, class T> struct leaf { T value; };
+
+template <class Seq, class... T> struct tuple_impl;
+template <std::size_t... I, class... T>
+struct tuple_impl<index_sequence<I...>, T...> : leaf<I, T>... {};
+
+template <class... T>
+struct tuple : tuple_impl<make_index_sequence<sizeof...(T)>, T...> {};
+
+template <std::size_t I, class T> T &get(leaf<I, T> &L) { return L.value; }
+
+template <std::size_t N> struct tag {};
+
+template <class Seq> struct tags_for;
+template <std::size_t... I> struct tags_for<index_sequence<I...>> {
+  using type = tuple<tag<I>...>;
+};
+
+template <std::size_t N> struct fib {
+  static constexpr std::size_t value = fib<N - 1>::value + fib<N - 2>::value;
+};
+template <> struct fib<1> { static constexpr std::size_t value = 1; };
+template <> struct fib<0> { static constexpr std::size_t value = 0; };
+
+template <class L, template <class> class F> struct transform;
+template <class... T, template <class> class F>
+struct transform<type_list<T...>, F> {
+  using type = type_list<typename F<T>::type...>;
+};
+
+template <class T> struct add_pointer { using type = T *; };
+
+template <class Seq> struct list_for;
+template <std::size_t... I> struct list_for<index_sequence<I...>> {
+  using type = type_list<tag<I>...>;
+};
+
+template <std::size_t N> using big_list = typename list_for<make_index_sequence<N>>::type;
+
+template <std::size_t... N> void instantiate_all(index_sequence<N...>) {
+  int dummy[] = {(static_cast<void>(
+                      typename tags_for<make_index_sequence<N % 64 + 1>>::type()),
+                  0)...};
+  (void)dummy;
+}
+
+void use() {
+  typename tags_for<make_index_sequence<512>>::type T;
+  get<511>(T);
+  static_assert(fib<90>::value != 0, "");
+  typename transform<big_list<1024>, add_pointer>::type L;
+  (void)L;
+  instantiate_all(make_index_sequence<256>());
+}
@@ -0,0 +1,14 @@
+// RUN: %bench --name=slow-constexpr-loop %clang_cpp -std=c++14 -fsyntax-only -fconstexpr-steps=100000000 %s
+
+// Every step of a constant-evaluated loop is interpreted on the AST.
+
+constexpr unsigned long long mix(unsigned N) {
+  unsigned long long H = 1469598103934665603ULL;
+  for (unsigned I = 0; I != N; ++I) {
+    H ^= I;
+    H *= 1099511628211ULL;
+  }
+  return H;
+}
+
+static_assert(mix(500000) != 0, "");
@@ -0,0 +1,29 @@
+// RUN: %bench --name=slow-tentative-parsing %clang_cpp -std=c++14 -fsyntax-only %s
+
+// Statements that start like declarations have to be parsed tentatively
+// before they turn out to be expressions, and deeply nested parentheses make
+// the parser look far ahead before it can decide.
+
+#define P1(x) (x)
+#define P2(x) P1(P1(x))
+#define P4(x) P2(P2(x))
+#define P8(x) P4(P4(x))
+#define P16(x) P8(P8(x))
+#define P32(x) P16(P16(x))
+#define P64(x) P32(P32(x))
+
+struct S {
+  S();
+  S(int);
+};
+int operator+(S, int);
+
+void run(int a) {
+  // Declarations of a local 'a'.
+  { S P64(a); }
+  { S P64(a) = 1; }
+  // Expressions, found after the whole declarator has been looked at.
+  S P64(a) + 1;
+  S(P64(a)) + 1;
+  (void)(S(P64(a)) + P64(a));
+}
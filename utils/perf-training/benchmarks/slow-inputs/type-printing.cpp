@@ -0,0 +1,16 @@
+// RUN: %bench --name=slow-type-printing %clang_cpp -std=c++14 -O2 -c %s -o %t.o
+
+// A type with few distinct parts prints to a name that is exponentially long.
+// Uniquing keeps the type cheap, but __PRETTY_FUNCTION__ and diagnostics have
+// to spell it out in full.
+
+template <class A, class B> struct Pair {};
+
+template <class T, int N> struct Grow {
+  using type = typename Grow<Pair<T, T>, N - 1>::type;
+};
+template <class T> struct Grow<T, 0> { using type = T; };
+
+template <class T> const char *name() { return __PRETTY_FUNCTION__; }
+
+const char *run() { return name<Grow<int, 13>::type>(); }
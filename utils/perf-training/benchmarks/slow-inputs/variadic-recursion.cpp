@@ -0,0 +1,17 @@
+// RUN: %bench --name=slow-variadic-recursion %clang_cpp -std=c++14 -fsyntax-only -ftemplate-depth=2048 %s
+
+// Peeling one element off a parameter pack per instantiation copies the pack
+// each time, so the work is quadratic in its length, and overload resolution
+// sees every candidate at each step.
+
+template <int... Is> struct List {};
+
+template <int N, int... Is> struct Make : Make<N - 1, N - 1, Is...> {};
+template <int... Is> struct Make<0, Is...> { using type = List<Is...>; };
+
+constexpr int sum(List<>) { return 0; }
+template <int I, int... Is> constexpr int sum(List<I, Is...>) {
+  return I + sum(List<Is...>());
+}
+
+static_assert(sum(Make<400>::type()) == 400 * 399 / 2, "");
@@ -0,0 +1,33 @@
+// RUN: %bench --name=stdlib-headers %clang_cpp -std=c++14 -fsyntax-only %s
+
+// The standard library headers are the real-world code that nearly every
+// C++ translation unit parses.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+int main() {
+  std::map<std::string, std::vector<int>> M;
+  M["a"].push_back(1);
+  std::sort(M["a"].begin(), M["a"].end());
+  std::cout << M.size() << '\n';
+}
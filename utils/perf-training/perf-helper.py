@@ -17,6 +17,8 @@ import time
 import bisect
 import shlex
 import tempfile
+import json
+import re
 
 test_env = { 'PATH'    : os.environ['PATH'] }
 
@@ -161,6 +163,177 @@ def cc1(args):
   subprocess.check_call(cc1_cmd)
   return 0
 
+def parse_print_stats(output):
+  # -print-stats prints sections that start with a '*** <Title>:' line (or a
+  # title of their own on the AST and file manager side), followed by lines
+  # that are either '<count> <description>' or '<description>: <count>'.
+  stats = {}
+  section = ''
+  for ln in output.splitlines():
+    ln = ln.strip()
+    if not ln:
+      continue
+    m = re.match(r'^\*\*\*\s*(.*?):?$', ln)
+    if m:
+      section = m.group(1)
+      continue
+    m = re.match(r'^(\d+)\s+([^\d].*?)[.:]?$', ln)
+    if m:
+      stats['%s: %s' % (section, m.group(2))] = int(m.group(1))
+      continue
+    m = re.match(r'^([^\d].*?):\s*(\d+)$', ln)
+    if m:
+      stats['%s: %s' % (section, m.group(1))] = int(m.group(2))
+  return stats
+
+def have_program(name):
+  return any(os.access(os.path.join(d, name), os.X_OK)
+             for d in os.environ['PATH'].split(os.pathsep))
+
+def run_measured(cmd, count_instructions):
+  # Run cmd once, returning its exit code, its standard error, and what it
+  # cost. The peak RSS is the largest of the command and the processes it
+  # waited for, such as the cc1 process that the driver starts.
+  perf_output = None
+  if count_instructions and have_program('perf'):
+    perf_output = tempfile.NamedTemporaryFile(suffix='.perf', delete=False)
+    perf_output.close()
+    cmd = ['perf', 'stat', '-x,', '-e', 'instructions:u',
+           '-o', perf_output.name, '--'] + cmd
+
+  with tempfile.TemporaryFile() as err:
+    start_time = time.time()
+    p = subprocess.Popen(cmd, stdout=subprocess.PIPE, stderr=err)
+    # The output of the compile is not interesting, but it must not block
+    # the command when it is large.
+    p.stdout.read()
+    _, status, rusage = os.wait4(p.pid, 0)
+    elapsed = time.time() - start_time
+    err.seek(0)
+    stderr = err.read().decode('utf-8', 'replace')
+
+  # ru_maxrss is in kilobytes everywhere but on Darwin.
+  max_rss = rusage.ru_maxrss
+  if sys.platform != 'darwin':
+    max_rss *= 1024
+
+  run = { 'wall_time' : elapsed,
+          'user_time' : rusage.ru_utime,
+          'sys_time' : rusage.ru_stime,
+          'max_rss' : max_rss }
+
+  if perf_output:
+    with open(perf_output.name) as f:
+      for ln in f:
+        fields = ln.strip().split(',')
+        if len(fields) > 2 and fields[2].startswith('instructions'):
+          try:
+            run['instructions'] = int(fields[0])
+          except ValueError:
+            pass
+    os.remove(perf_output.name)
+
+  exit_code = os.WEXITSTATUS(status) if os.WIFEXITED(status) else 1
+  return exit_code, stderr, run
+
+def bench(args):
+  parser = argparse.ArgumentParser(prog='perf-helper bench',
+    description='Run a compile and append what it cost to a JSON lines file')
+  parser.add_argument('--name', required=True,
+    help='Name of the benchmark in the results')
+  parser.add_argument('--output', required=True,
+    help='File to append the JSON record of the benchmark to')
+  parser.add_argument('--repeat', type=int, default=1,
+    help='Number of times to run the command (default 1)')
+  parser.add_argument('--instructions', action='store_true',
+    help='Count the instructions executed, using perf')
+  parser.add_argument('--stats', action='store_true',
+    help='Pass -print-stats to the frontend and record its counters')
+  parser.add_argument('cmd', nargs='*', help='')
+
+  # Use python's arg parser to handle all leading option arguments, but pass
+  # everything else through as the command to measure.
+  first_cmd = next(arg for arg in args if not arg.startswith("--"))
+  last_arg_idx = args.index(first_cmd)
+
+  opts = parser.parse_args(args[:last_arg_idx])
+  cmd = args[last_arg_idx:]
+  if opts.stats:
+    cmd = cmd + ['-Xclang', '-print-stats']
+
+  runs = []
+  stats = {}
+  for i in range(max(opts.repeat, 1)):
+    exit_code, stderr, run = run_measured(cmd, opts.instructions)
+    if exit_code != 0:
+      sys.stderr.write(stderr)
+      print('Fatal error: %s exited with %d' % (opts.name, exit_code))
+      return exit_code
+    runs.append(run)
+    if opts.stats:
+      stats = parse_print_stats(stderr)
+
+  record = { 'name' : opts.name,
+             'command' : cmd,
+             'wall_time' : min(run['wall_time'] for run in runs),
+             'max_rss' : max(run['max_rss'] for run in runs),
+             'runs' : runs }
+  if all('instructions' in run for run in runs):
+    record['instructions'] = min(run['instructions'] for run in runs)
+  if opts.stats:
+    record['stats'] = stats
+
+  with open(opts.output, 'a') as f:
+    f.write(json.dumps(record, sort_keys=True) + '\n')
+  print('%s: %.4fs, %d KB peak RSS' % (opts.name, record['wall_time'],
+                                      record['max_rss'] // 1024))
+  return 0
+
+def gen_bench_input(args):
+  if len(args) != 2 or args[0] not in ('macros', 'overloads', 'expressions'):
+    print('Usage: %s gen-bench-input macros|overloads|expressions <count>\n'
+      % __file__ +
+      '\tPrints a synthetic benchmark header with <count> entities.')
+    return 1
+  count = int(args[1])
+  out = sys.stdout
+  if args[0] == 'macros':
+    # Many object-like and function-like macros, each of which expands the
+    # one before it, and a use of each so that they are all expanded.
+    out.write('#define M0(x) (x)\n#define V0 0\n')
+    for i in range(1, count):
+      out.write('#define M%d(x) M%d((x) + %d)\n' % (i, i - 1, i))
+      out.write('#define V%d (V%d + M%d(%d))\n' % (i, i - 1, i % 16, i))
+    for i in range(0, count, 8):
+      out.write('static const int use%d = M%d(V%d);\n' % (i, i % 64,
+                                                         i % 64))
+  elif args[0] == 'overloads':
+    # One overload set with many candidates, and calls that have to rank
+    # them all.
+    out.write('struct Base {};\n')
+    for i in range(count):
+      out.write('struct T%d : Base { T%d(int); };\n' % (i, i))
+      out.write('int f(T%d, long);\n' % i)
+      out.write('int f(T%d *, const char *);\n' % i)
+    out.write('int f(int, int);\n')
+    out.write('void calls() {\n')
+    for i in range(count):
+      out.write('  f(%d, %d);\n' % (i, i))
+      out.write('  f((T%d *)nullptr, "");\n' % i)
+    out.write('}\n')
+  elif args[0] == 'expressions':
+    # Many functions whose bodies are long chains of operators and deeply
+    # nested calls, which makes for a large and deep AST to walk.
+    out.write('struct V { int X; V operator+(V) const; V f(V) const; };\n')
+    for i in range(count):
+      out.write('int sum%d(int A, V B) {\n' % i)
+      out.write('  int S = A%s;\n' % ''.join(' + A * %d' % j
+                                              for j in range(64)))
+      out.write('  V W = B%s;\n' % ''.join(' + B' for j in range(32)))
+      out.write('  return S + %sW%s.X;\n' % ('B.f(' * 32, ')' * 32))
+      out.write('}\n')
+  return 0
+
 def parse_dtrace_symbol_file(path, all_symbols, all_symbols_set,
                              missing_symbols, opts):
   def fix_mangling(symbol):
@@ -398,6 +571,8 @@ commands = {'clean' : clean,
   'merge' : merge, 
   'dtrace' : dtrace,
   'cc1' : cc1,
+  'bench' : bench,
+  'gen-bench-input' : gen_bench_input,
   'gen-order-file' : genOrderFile}
 
 def main():